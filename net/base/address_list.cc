@@ -4,6 +4,8 @@
 
 #include "net/base/address_list.h"
 
+#include <utility>
+
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/values.h"
@@ -35,6 +37,20 @@ AddressList::AddressList() {}
 
 AddressList::~AddressList() {}
 
+AddressList::AddressList(const AddressList& other) = default;
+
+AddressList& AddressList::operator=(const AddressList& other) = default;
+
+AddressList::AddressList(AddressList&& other)
+    : std::vector<IPEndPoint>(std::move(other)),
+      canonical_name_(std::move(other.canonical_name_)) {}
+
+AddressList& AddressList::operator=(AddressList&& other) {
+  std::vector<IPEndPoint>::operator=(std::move(other));
+  canonical_name_ = std::move(other.canonical_name_);
+  return *this;
+}
+
 AddressList::AddressList(const IPEndPoint& endpoint) {
   push_back(endpoint);
 }
@@ -25,6 +25,15 @@ class NET_EXPORT AddressList
   AddressList();
   ~AddressList();
 
+  AddressList(const AddressList& other);
+  AddressList& operator=(const AddressList& other);
+
+  // Movable.  Results are assigned through resolver callbacks and connect
+  // job plumbing on every connection setup; stealing the endpoint storage
+  // there avoids an allocation-plus-copy pair each time.
+  AddressList(AddressList&& other);
+  AddressList& operator=(AddressList&& other);
+
   // Creates an address list for a single IP literal.
   explicit AddressList(const IPEndPoint& endpoint);
 
@@ -4,6 +4,8 @@
 
 #include "net/base/address_list.h"
 
+#include <utility>
+
 #include "base/strings/string_util.h"
 #include "base/sys_byteorder.h"
 #include "net/base/net_util.h"
@@ -134,5 +136,23 @@ TEST(AddressListTest, CreateFromIPAddressList) {
   EXPECT_EQ(arraysize(tests), test_list.size());
 }
 
+TEST(AddressListTest, MoveTransfersEndpointsAndCanonicalName) {
+  IPAddressNumber address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.1", &address));
+  AddressList list = AddressList::CreateFromIPAddress(address, 80);
+  list.set_canonical_name("canonical.example.com");
+
+  AddressList moved_to(std::move(list));
+  ASSERT_EQ(1u, moved_to.size());
+  EXPECT_EQ("192.168.1.1:80", moved_to[0].ToString());
+  EXPECT_EQ("canonical.example.com", moved_to.canonical_name());
+
+  AddressList move_assigned;
+  move_assigned = std::move(moved_to);
+  ASSERT_EQ(1u, move_assigned.size());
+  EXPECT_EQ("192.168.1.1:80", move_assigned[0].ToString());
+  EXPECT_EQ("canonical.example.com", move_assigned.canonical_name());
+}
+
 }  // namespace
 }  // namespace net
@@ -4,6 +4,8 @@
 
 #include "net/base/chunked_upload_data_stream.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
@@ -12,9 +14,11 @@ namespace net {
 
 ChunkedUploadDataStream::ChunkedUploadDataStream(int64_t identifier)
     : UploadDataStream(true, identifier),
+      discarded_chunks_(0),
       read_index_(0),
       read_offset_(0),
       all_data_appended_(false),
+      discard_read_chunks_(false),
       read_buffer_len_(0) {
 }
 
@@ -23,12 +27,25 @@ ChunkedUploadDataStream::~ChunkedUploadDataStream() {
 
 void ChunkedUploadDataStream::AppendData(
     const char* data, int data_len, bool is_done) {
-  DCHECK(!all_data_appended_);
-  DCHECK(data_len > 0 || is_done);
+  scoped_refptr<IOBuffer> buffer;
   if (data_len > 0) {
     DCHECK(data);
-    upload_data_.push_back(
-        make_scoped_ptr(new std::vector<char>(data, data + data_len)));
+    buffer = new IOBufferWithSize(data_len);
+    memcpy(buffer->data(), data, data_len);
+  }
+  AppendBuffer(buffer, data_len, is_done);
+}
+
+void ChunkedUploadDataStream::AppendBuffer(
+    const scoped_refptr<IOBuffer>& buffer, int buffer_len, bool is_done) {
+  DCHECK(!all_data_appended_);
+  DCHECK(buffer_len > 0 || is_done);
+  if (buffer_len > 0) {
+    DCHECK(buffer.get());
+    Chunk chunk;
+    chunk.buffer = buffer;
+    chunk.length = buffer_len;
+    upload_data_.push_back(chunk);
   }
   all_data_appended_ = is_done;
 
@@ -46,6 +63,10 @@ void ChunkedUploadDataStream::AppendData(
 int ChunkedUploadDataStream::InitInternal() {
   // ResetInternal should already have been called.
   DCHECK(!read_buffer_.get());
+  // Once read chunks have been dropped, the stream cannot be replayed from
+  // the beginning.
+  if (discarded_chunks_ > 0)
+    return ERR_UPLOAD_STREAM_REWIND_NOT_SUPPORTED;
   DCHECK_EQ(0u, read_index_);
   DCHECK_EQ(0u, read_offset_);
   return OK;
@@ -74,23 +95,30 @@ int ChunkedUploadDataStream::ReadChunk(IOBuffer* buf, int buf_len) {
   // Copy as much data as possible from |upload_data_| to |buf|.
   int bytes_read = 0;
   while (read_index_ < upload_data_.size() && bytes_read < buf_len) {
-    std::vector<char>* data = upload_data_[read_index_].get();
+    const Chunk& chunk = upload_data_[read_index_];
+    size_t chunk_length = static_cast<size_t>(chunk.length);
     size_t bytes_to_read =
         std::min(static_cast<size_t>(buf_len - bytes_read),
-                 data->size() - read_offset_);
-    memcpy(buf->data() + bytes_read, data->data() + read_offset_,
+                 chunk_length - read_offset_);
+    memcpy(buf->data() + bytes_read, chunk.buffer->data() + read_offset_,
            bytes_to_read);
     bytes_read += bytes_to_read;
     read_offset_ += bytes_to_read;
-    if (read_offset_ == data->size()) {
-      read_index_++;
+    if (read_offset_ == chunk_length) {
       read_offset_ = 0;
+      if (discard_read_chunks_) {
+        upload_data_.pop_front();
+        discarded_chunks_++;
+      } else {
+        read_index_++;
+      }
     }
   }
   DCHECK_LE(bytes_read, buf_len);
 
   // If no data was written, and not all data has been appended, return
-  // ERR_IO_PENDING. The read will be completed in the next call to AppendData.
+  // ERR_IO_PENDING. The read will be completed in the next call to
+  // AppendBuffer.
   if (bytes_read == 0 && !all_data_appended_)
     return ERR_IO_PENDING;
 
@@ -5,7 +5,7 @@
 #ifndef NET_BASE_CHUNKED_UPLOAD_DATA_STREAM_H_
 #define NET_BASE_CHUNKED_UPLOAD_DATA_STREAM_H_
 
-#include <vector>
+#include <deque>
 
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -17,22 +17,49 @@ namespace net {
 
 class IOBuffer;
 
-// Class with a push-based interface for uploading data. Buffers all data until
-// the request is completed. Not recommended for uploading large amounts of
-// seekable data, due to this buffering behavior.
+// Class with a push-based interface for uploading data. By default buffers
+// all data until the request is completed, so the upload can be replayed on
+// a request retry; see set_discard_read_chunks() for bounding memory use on
+// large streaming uploads instead.
 class NET_EXPORT ChunkedUploadDataStream : public UploadDataStream {
  public:
   explicit ChunkedUploadDataStream(int64_t identifier);
 
   ~ChunkedUploadDataStream() override;
 
+  // Makes the stream drop each chunk once it has been fully read, bounding
+  // memory use to the not-yet-read chunks instead of the whole upload. The
+  // stream then cannot be rewound: once any chunk has been dropped,
+  // re-initializing the stream (as done on a request retry) fails with
+  // ERR_UPLOAD_STREAM_REWIND_NOT_SUPPORTED. Must be set before reading
+  // starts.
+  void set_discard_read_chunks(bool discard_read_chunks) {
+    discard_read_chunks_ = discard_read_chunks;
+  }
+
   // Adds data to the stream. |is_done| should be true if this is the last
   // data to be appended. |data_len| must not be 0 unless |is_done| is true.
   // Once called with |is_done| being true, must never be called again.
-  // TODO(mmenke):  Consider using IOBuffers instead, to reduce data copies.
+  // Copies the data; use AppendBuffer() to avoid the copy.
   void AppendData(const char* data, int data_len, bool is_done);
 
+  // Like AppendData(), but takes a reference to |buffer| instead of copying
+  // its data. |buffer|'s contents must not be modified afterwards; the
+  // stream reads from it directly until it has been fully uploaded (or, if
+  // chunks are retained for rewinding, until the stream is destroyed).
+  void AppendBuffer(const scoped_refptr<IOBuffer>& buffer,
+                    int buffer_len,
+                    bool is_done);
+
  private:
+  // A chunk of upload data, shared with the appender.
+  struct Chunk {
+    Chunk() : length(0) {}
+
+    scoped_refptr<IOBuffer> buffer;
+    int length;
+  };
+
   // UploadDataStream implementation.
   int InitInternal() override;
   int ReadInternal(IOBuffer* buf, int buf_len) override;
@@ -40,14 +67,23 @@ class NET_EXPORT ChunkedUploadDataStream : public UploadDataStream {
 
   int ReadChunk(IOBuffer* buf, int buf_len);
 
-  // Index and offset of next element of |upload_data_| to be read.
+  // Chunks not yet dropped, oldest first. When dropping read chunks, fully
+  // read chunks are popped from the front, making this a segmented ring over
+  // the in-flight portion of the upload.
+  std::deque<Chunk> upload_data_;
+
+  // Number of fully read chunks popped off |upload_data_|. Always 0 unless
+  // |discard_read_chunks_| is set.
+  size_t discarded_chunks_;
+
+  // Index and offset into |upload_data_| of the next data to be read.
   size_t read_index_;
   size_t read_offset_;
 
   // True once all data has been appended to the stream.
   bool all_data_appended_;
 
-  std::vector<scoped_ptr<std::vector<char>>> upload_data_;
+  bool discard_read_chunks_;
 
   // Buffer to write the next read's data to. Only set when a call to
   // ReadInternal reads no data.
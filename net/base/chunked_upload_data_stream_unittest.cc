@@ -272,6 +272,61 @@ TEST(ChunkedUploadDataStreamTest, RewindAfterComplete) {
   ASSERT_TRUE(stream.IsEOF());
 }
 
+TEST(ChunkedUploadDataStreamTest, AppendBuffer) {
+  scoped_refptr<StringIOBuffer> buffer1 =
+      new StringIOBuffer(std::string(kTestData, 4));
+  scoped_refptr<StringIOBuffer> buffer2 =
+      new StringIOBuffer(std::string(kTestData + 4, kTestDataSize - 4));
+
+  ChunkedUploadDataStream stream(0);
+  stream.AppendBuffer(buffer1, buffer1->size(), false);
+
+  ASSERT_EQ(OK, stream.Init(TestCompletionCallback().callback()));
+  EXPECT_FALSE(stream.IsInMemory());
+  EXPECT_EQ(0u, stream.size());  // Content-Length is 0 for chunked data.
+  EXPECT_EQ(0u, stream.position());
+  EXPECT_FALSE(stream.IsEOF());
+
+  TestCompletionCallback callback;
+  scoped_refptr<IOBuffer> buf = new IOBuffer(kTestBufferSize);
+  int result = stream.Read(buf.get(), kTestBufferSize, callback.callback());
+  ASSERT_EQ(4, result);
+  EXPECT_EQ(std::string(kTestData, 4), std::string(buf->data(), 4));
+
+  result = stream.Read(buf.get(), kTestBufferSize, callback.callback());
+  ASSERT_EQ(ERR_IO_PENDING, result);
+  stream.AppendBuffer(buffer2, buffer2->size(), true);
+  int read = callback.WaitForResult();
+  ASSERT_GE(read, 0);
+  EXPECT_EQ(std::string(kTestData + 4), std::string(buf->data(), read));
+  EXPECT_EQ(kTestDataSize, stream.position());
+  EXPECT_TRUE(stream.IsEOF());
+}
+
+TEST(ChunkedUploadDataStreamTest, DiscardReadChunks) {
+  ChunkedUploadDataStream stream(0);
+  stream.set_discard_read_chunks(true);
+  stream.AppendData(kTestData, kTestDataSize, false);
+
+  // Rewinding is still possible while nothing has been read.
+  ASSERT_EQ(OK, stream.Init(TestCompletionCallback().callback()));
+  ASSERT_EQ(OK, stream.Init(TestCompletionCallback().callback()));
+
+  std::string data = ReadSync(&stream, kTestBufferSize);
+  EXPECT_EQ(kTestData, data);
+  EXPECT_FALSE(stream.IsEOF());
+
+  stream.AppendData(kTestData, kTestDataSize, true);
+  data = ReadSync(&stream, kTestBufferSize);
+  EXPECT_EQ(kTestData, data);
+  EXPECT_EQ(2 * kTestDataSize, stream.position());
+  EXPECT_TRUE(stream.IsEOF());
+
+  // Fully read chunks have been dropped, so the stream cannot be replayed.
+  ASSERT_EQ(ERR_UPLOAD_STREAM_REWIND_NOT_SUPPORTED,
+            stream.Init(TestCompletionCallback().callback()));
+}
+
 TEST(ChunkedUploadDataStreamTest, RewindWhileReading) {
   ChunkedUploadDataStream stream(0);
 
@@ -45,22 +45,59 @@ std::string Escape(const std::string& text,
                    const Charmap& charmap,
                    bool use_plus,
                    bool keep_escaped = false) {
+  const size_t len = text.length();
+
+  // First pass: count the characters that will be hex-escaped, so the output
+  // can be sized exactly instead of reserving 3x the input length.  Each
+  // escaped character adds two bytes; '+' substitution and kept escapes are
+  // one-to-one.
+  size_t escaped_count = 0;
+  for (size_t i = 0; i < len; ++i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (use_plus && ' ' == c)
+      continue;
+    if (keep_escaped && '%' == c && i + 2 < len &&
+        base::IsHexDigit(text[i + 1]) && base::IsHexDigit(text[i + 2])) {
+      continue;
+    }
+    if (charmap.Contains(c))
+      ++escaped_count;
+  }
+
+  // Nothing needs rewriting (and no space-to-plus conversion is possible).
+  if (escaped_count == 0 && !use_plus)
+    return text;
+
   std::string escaped;
-  escaped.reserve(text.length() * 3);
-  for (unsigned int i = 0; i < text.length(); ++i) {
+  escaped.reserve(len + 2 * escaped_count);
+
+  size_t i = 0;
+  while (i < len) {
+    // Bulk-copy the run of characters that pass through unmodified rather
+    // than appending them one at a time.
+    const size_t run_begin = i;
+    while (i < len) {
+      unsigned char c = static_cast<unsigned char>(text[i]);
+      if (charmap.Contains(c) || (use_plus && ' ' == c))
+        break;
+      ++i;
+    }
+    escaped.append(text, run_begin, i - run_begin);
+    if (i == len)
+      break;
+
     unsigned char c = static_cast<unsigned char>(text[i]);
     if (use_plus && ' ' == c) {
       escaped.push_back('+');
-    } else if (keep_escaped && '%' == c && i + 2 < text.length() &&
+    } else if (keep_escaped && '%' == c && i + 2 < len &&
                base::IsHexDigit(text[i + 1]) && base::IsHexDigit(text[i + 2])) {
       escaped.push_back('%');
-    } else if (charmap.Contains(c)) {
+    } else {
       escaped.push_back('%');
       escaped.push_back(IntToHex(c >> 4));
       escaped.push_back(IntToHex(c & 0xf));
-    } else {
-      escaped.push_back(c);
     }
+    ++i;
   }
   return escaped;
 }
@@ -212,6 +249,16 @@ STR UnescapeURLWithAdjustmentsImpl(
   if (rules == UnescapeRule::NONE)
     return escaped_text;
 
+  const bool replace_plus =
+      (rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE) != 0;
+
+  // Fast path: if there is nothing to rewrite, return the input unchanged.
+  // Most URL components contain no escape sequences at all.
+  if (escaped_text.find('%') == STR::npos &&
+      (!replace_plus || escaped_text.find('+') == STR::npos)) {
+    return escaped_text;
+  }
+
   // The output of the unescaping is always smaller than the input, so we can
   // reserve the input size to make sure we have enough buffer and don't have
   // to allocate in the loop below.
@@ -219,10 +266,26 @@ STR UnescapeURLWithAdjustmentsImpl(
   result.reserve(escaped_text.length());
 
   // Locations of adjusted text.
-  for (size_t i = 0, max = escaped_text.size(); i < max; ++i) {
-    if (static_cast<unsigned char>(escaped_text[i]) >= 128) {
-      // Non ASCII character, append as is.
-      result.push_back(escaped_text[i]);
+  size_t i = 0;
+  const size_t max = escaped_text.size();
+  while (i < max) {
+    // Bulk-copy the run up to the next character that may need rewriting.
+    // Only '%' (and '+' when replacing pluses) are ever transformed; all
+    // other characters, including non-ASCII ones, are copied through as-is.
+    const size_t run_begin = i;
+    while (i < max) {
+      const typename STR::value_type c = escaped_text[i];
+      if (c == '%' || (replace_plus && c == '+'))
+        break;
+      ++i;
+    }
+    result.append(escaped_text, run_begin, i - run_begin);
+    if (i == max)
+      break;
+
+    if (escaped_text[i] == '+') {
+      result.push_back(' ');
+      ++i;
       continue;
     }
 
@@ -266,19 +329,19 @@ STR UnescapeURLWithAdjustmentsImpl(
         if (HasArabicLanguageMarkAtIndex(escaped_text, first_byte, i)) {
           // Keep Arabic Language Mark escaped.
           result.append(escaped_text, i, 6);
-          i += 5;
+          i += 6;
           continue;
         }
         if (HasThreeByteBidiControlCharAtIndex(escaped_text, first_byte, i)) {
           // Keep BiDi control char escaped.
           result.append(escaped_text, i, 9);
-          i += 8;
+          i += 9;
           continue;
         }
         if (HasFourByteBannedCharAtIndex(escaped_text, first_byte, i)) {
           // Keep banned char escaped.
           result.append(escaped_text, i, 12);
-          i += 11;
+          i += 12;
           continue;
         }
       }
@@ -298,18 +361,18 @@ STR UnescapeURLWithAdjustmentsImpl(
         if (adjustments)
           adjustments->push_back(base::OffsetAdjuster::Adjustment(i, 3, 1));
         result.push_back(first_byte);
-        i += 2;
+        i += 3;
       } else {
-        // Keep escaped. Append a percent and we'll get the following two
-        // digits on the next loops through.
+        // Keep escaped. Append a percent; the following two digits are
+        // copied through as part of the next run.
         result.push_back('%');
+        ++i;
       }
-    } else if ((rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE) &&
-               escaped_text[i] == '+') {
-      result.push_back(' ');
     } else {
-      // Normal case for unescaped characters.
-      result.push_back(escaped_text[i]);
+      // A '%' that doesn't introduce a valid escape sequence; copy it
+      // through verbatim.
+      result.push_back('%');
+      ++i;
     }
   }
 
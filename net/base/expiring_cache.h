@@ -5,8 +5,10 @@
 #ifndef NET_BASE_EXPIRING_CACHE_H_
 #define NET_BASE_EXPIRING_CACHE_H_
 
+#include <algorithm>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
@@ -136,6 +138,21 @@ class ExpiringCache {
     return &it->second.first;
   }
 
+  // Returns the value matching |key| regardless of whether it has expired,
+  // or NULL if the item is not found. Unlike Get(), expired entries are
+  // left in the cache. If |expiration| is non-NULL, it receives the entry's
+  // expiration.
+  const ValueType* GetStale(const KeyType& key,
+                            ExpirationType* expiration) const {
+    typename EntryMap::const_iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+
+    if (expiration)
+      *expiration = it->second.second;
+    return &it->second.first;
+  }
+
   // Updates or replaces the value associated with |key|.
   void Put(const KeyType& key,
            const ValueType& value,
@@ -213,6 +230,201 @@ class ExpiringCache {
   DISALLOW_COPY_AND_ASSIGN(ExpiringCache);
 };
 
+// Variant of ExpiringCache that additionally keeps a min-heap of entry
+// expirations, so that clearing out expired entries only touches entries that
+// are actually due instead of scanning the whole map.  In exchange,
+// ExpirationCompare must be a strict weak ordering over ExpirationType (e.g.
+// std::less<base::TimeTicks>) such that |comp(a, b)| means |a| expires
+// strictly before |b|; an entry is valid at |now| iff |comp(now, expiration)|,
+// exactly as with ExpiringCache instantiated with std::less.  Arbitrary
+// validity functors (see the ComplexExpirationFunctor example above) are not
+// supported; use ExpiringCache for those.
+//
+// Heap records left behind by Put() overwrites and Get() evictions are
+// discarded lazily, and the heap is rebuilt from the map if the stale records
+// outnumber the live entries.
+template <typename KeyType,
+          typename ValueType,
+          typename ExpirationType,
+          typename ExpirationCompare,
+          typename EvictionHandler = NoopEvictionHandler<KeyType,
+                                                         ValueType,
+                                                         ExpirationType> >
+class OrderedExpiringCache {
+ private:
+  // See the comment in ExpiringCache about dependent types.
+  typedef std::pair<ValueType, ExpirationType> Entry;
+  typedef std::map<KeyType, Entry> EntryMap;
+
+  // Expiration first so that heap ordering only looks at the first member.
+  typedef std::pair<ExpirationType, KeyType> HeapEntry;
+
+ public:
+  typedef KeyType key_type;
+  typedef ValueType value_type;
+  typedef ExpirationType expiration_type;
+
+  // Constructs an OrderedExpiringCache that stores up to |max_entries|.
+  explicit OrderedExpiringCache(size_t max_entries)
+      : max_entries_(max_entries) {}
+  ~OrderedExpiringCache() {}
+
+  // Returns the value matching |key|, which must be valid at the time |now|,
+  // or NULL if the item is not found or has expired.  Expired entries are
+  // immediately removed from the cache, as with ExpiringCache::Get().
+  const ValueType* Get(const KeyType& key, const ExpirationType& now) {
+    typename EntryMap::iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+
+    if (!expiration_comp_(now, it->second.second)) {
+      // The entry's heap record is discarded lazily.
+      Evict(it, now, true);
+      return NULL;
+    }
+
+    return &it->second.first;
+  }
+
+  // Returns the value matching |key| regardless of whether it has expired,
+  // or NULL if the item is not found.  If |expiration| is non-NULL, it
+  // receives the entry's expiration.
+  const ValueType* GetStale(const KeyType& key,
+                            ExpirationType* expiration) const {
+    typename EntryMap::const_iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+
+    if (expiration)
+      *expiration = it->second.second;
+    return &it->second.first;
+  }
+
+  // Updates or replaces the value associated with |key|.
+  void Put(const KeyType& key,
+           const ValueType& value,
+           const ExpirationType& now,
+           const ExpirationType& expiration) {
+    typename EntryMap::iterator it = entries_.find(key);
+    if (it == entries_.end()) {
+      if (entries_.size() == max_entries_)
+        Compact(now);
+      entries_.insert(std::make_pair(key, Entry(value, expiration)));
+    } else {
+      // The overwritten expiration's heap record becomes stale.
+      it->second.first = value;
+      it->second.second = expiration;
+    }
+    PushHeap(HeapEntry(expiration, key));
+  }
+
+  // Runs the eviction handler for every entry and empties the cache in a
+  // single pass.  Intended for wholesale invalidation, e.g. on network
+  // change.
+  void ExpireAll(const ExpirationType& now) {
+    for (typename EntryMap::iterator it = entries_.begin();
+         it != entries_.end(); ++it) {
+      eviction_handler_.Handle(it->first, it->second.first, it->second.second,
+                               now, false);
+    }
+    entries_.clear();
+    expiry_heap_.clear();
+  }
+
+  // Empties the cache without running the eviction handler.
+  void Clear() {
+    entries_.clear();
+    expiry_heap_.clear();
+  }
+
+  // Returns the number of entries in the cache.
+  size_t size() const { return entries_.size(); }
+
+  // Returns the maximum number of entries in the cache.
+  size_t max_entries() const { return max_entries_; }
+
+  bool empty() const { return entries_.empty(); }
+
+ private:
+  FRIEND_TEST_ALL_PREFIXES(OrderedExpiringCacheTest, StaleHeapRecords);
+
+  // Min-heap ordering: the entry expiring first is at the front.
+  struct HeapGreater {
+    bool operator()(const HeapEntry& lhs, const HeapEntry& rhs) const {
+      ExpirationCompare comp;
+      return comp(rhs.first, lhs.first);
+    }
+  };
+
+  bool ExpirationsDiffer(const ExpirationType& a,
+                         const ExpirationType& b) const {
+    return expiration_comp_(a, b) || expiration_comp_(b, a);
+  }
+
+  void PushHeap(const HeapEntry& heap_entry) {
+    expiry_heap_.push_back(heap_entry);
+    std::push_heap(expiry_heap_.begin(), expiry_heap_.end(), HeapGreater());
+
+    // Rebuild if lazily discarded records dominate the heap.
+    if (expiry_heap_.size() > 2 * entries_.size() + 16) {
+      expiry_heap_.clear();
+      for (typename EntryMap::const_iterator it = entries_.begin();
+           it != entries_.end(); ++it) {
+        expiry_heap_.push_back(HeapEntry(it->second.second, it->first));
+      }
+      std::make_heap(expiry_heap_.begin(), expiry_heap_.end(), HeapGreater());
+    }
+  }
+
+  // Prunes entries from the cache to bring it below |max_entries()|.  Unlike
+  // ExpiringCache::Compact(), only entries that are actually due (plus any
+  // stale heap records in front of them) are touched.
+  void Compact(const ExpirationType& now) {
+    while (!expiry_heap_.empty()) {
+      const HeapEntry& top = expiry_heap_.front();
+      typename EntryMap::iterator it = entries_.find(top.second);
+      const bool stale = it == entries_.end() ||
+                         ExpirationsDiffer(it->second.second, top.first);
+      // The heap is ordered by expiration, so once the earliest live record
+      // is still valid, all later ones are too.
+      if (!stale && expiration_comp_(now, top.first))
+        break;
+      std::pop_heap(expiry_heap_.begin(), expiry_heap_.end(), HeapGreater());
+      expiry_heap_.pop_back();
+      if (!stale)
+        Evict(it, now, false);
+    }
+
+    if (entries_.size() < max_entries_)
+      return;
+
+    // If the cache is still too full, start deleting items 'randomly'.  The
+    // evicted entries' heap records are discarded lazily.
+    for (typename EntryMap::iterator it = entries_.begin();
+         it != entries_.end() && entries_.size() >= max_entries_;) {
+      Evict(it++, now, false);
+    }
+  }
+
+  void Evict(typename EntryMap::iterator it,
+             const ExpirationType& now,
+             bool on_get) {
+    eviction_handler_.Handle(it->first, it->second.first, it->second.second,
+                             now, on_get);
+    entries_.erase(it);
+  }
+
+  // Bound on total size of the cache.
+  size_t max_entries_;
+
+  EntryMap entries_;
+  std::vector<HeapEntry> expiry_heap_;
+  ExpirationCompare expiration_comp_;
+  EvictionHandler eviction_handler_;
+
+  DISALLOW_COPY_AND_ASSIGN(OrderedExpiringCache);
+};
+
 }  // namespace net
 
 #endif  // NET_BASE_EXPIRING_CACHE_H_
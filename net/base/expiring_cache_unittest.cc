@@ -23,6 +23,8 @@ namespace {
 const int kMaxCacheEntries = 10;
 typedef ExpiringCache<std::string, std::string, base::TimeTicks,
                       std::less<base::TimeTicks> > Cache;
+typedef OrderedExpiringCache<std::string, std::string, base::TimeTicks,
+                             std::less<base::TimeTicks> > OrderedCache;
 
 struct TestFunctor {
   bool operator()(const std::string& now,
@@ -254,6 +256,41 @@ TEST(ExpiringCacheTest, GetTruncatesExpiredEntries) {
   EXPECT_EQ(6U, cache.size());
 }
 
+TEST(ExpiringCacheTest, GetStaleReturnsExpiredEntries) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  Cache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+  const base::TimeTicks expiration = now + kTTL;
+
+  cache.Put("entry1", "test1", now, expiration);
+
+  // A missing key misses regardless of expiration.
+  EXPECT_FALSE(cache.GetStale("entry2", NULL));
+
+  // While the entry is fresh, GetStale() returns it along with its
+  // expiration.
+  base::TimeTicks returned_expiration;
+  EXPECT_THAT(cache.GetStale("entry1", &returned_expiration),
+              Pointee(StrEq("test1")));
+  EXPECT_EQ(expiration, returned_expiration);
+
+  // Advance to t=15, past the entry's expiration. Get() misses (and evicts),
+  // but GetStale() called first still returns the entry and does not remove
+  // it from the cache.
+  now += base::TimeDelta::FromSeconds(15);
+  EXPECT_THAT(cache.GetStale("entry1", &returned_expiration),
+              Pointee(StrEq("test1")));
+  EXPECT_EQ(expiration, returned_expiration);
+  EXPECT_EQ(1U, cache.size());
+
+  EXPECT_FALSE(cache.Get("entry1", now));
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_FALSE(cache.GetStale("entry1", NULL));
+}
+
 TEST(ExpiringCacheTest, CustomFunctor) {
   ExpiringCache<std::string, std::string, std::string, TestFunctor> cache(5);
 
@@ -308,4 +345,99 @@ TEST(ExpiringCacheTest, CustomFunctor) {
   EXPECT_FALSE(cache.Get("test7", kMuchLater));
 }
 
+TEST(OrderedExpiringCacheTest, Basic) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  OrderedCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+  EXPECT_EQ(0U, cache.size());
+
+  // Add an entry at t=0 that expires at t=10.
+  EXPECT_FALSE(cache.Get("entry1", now));
+  cache.Put("entry1", "test1", now, now + kTTL);
+  EXPECT_THAT(cache.Get("entry1", now), Pointee(StrEq("test1")));
+  EXPECT_EQ(1U, cache.size());
+
+  // GetStale() returns the entry along with its expiration.
+  base::TimeTicks returned_expiration;
+  EXPECT_THAT(cache.GetStale("entry1", &returned_expiration),
+              Pointee(StrEq("test1")));
+  EXPECT_EQ(now + kTTL, returned_expiration);
+
+  // Advance to t=15; the entry has expired and Get() evicts it.
+  now += base::TimeDelta::FromSeconds(15);
+  EXPECT_FALSE(cache.Get("entry1", now));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(OrderedExpiringCacheTest, CompactEvictsOnlyDueEntries) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  OrderedCache cache(kMaxCacheEntries);
+
+  // Start at t=0. Fill the cache: five entries expiring at t=10 and five at
+  // t=20.
+  base::TimeTicks now;
+  for (int i = 0; i < 5; ++i) {
+    std::string name = base::StringPrintf("early%d", i);
+    cache.Put(name, name, now, now + kTTL);
+  }
+  for (int i = 0; i < 5; ++i) {
+    std::string name = base::StringPrintf("late%d", i);
+    cache.Put(name, name, now, now + 2 * kTTL);
+  }
+  EXPECT_EQ(10U, cache.size());
+
+  // At t=15 the cache is full, so inserting a new entry compacts it; only
+  // the due entries should go.
+  now += base::TimeDelta::FromSeconds(15);
+  cache.Put("extra", "extra", now, now + kTTL);
+  EXPECT_EQ(6U, cache.size());
+  for (int i = 0; i < 5; ++i) {
+    std::string name = base::StringPrintf("late%d", i);
+    EXPECT_THAT(cache.Get(name, now), Pointee(StrEq(name)));
+  }
+  EXPECT_THAT(cache.Get("extra", now), Pointee(StrEq("extra")));
+}
+
+TEST(OrderedExpiringCacheTest, StaleHeapRecords) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  OrderedCache cache(kMaxCacheEntries);
+
+  // Overwrite the same entry repeatedly; the stale heap records should be
+  // pruned rather than accumulating without bound.
+  base::TimeTicks now;
+  for (int i = 0; i < 100; ++i)
+    cache.Put("entry1", "test1", now, now + kTTL);
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_LE(cache.expiry_heap_.size(), 2 * cache.size() + 16);
+
+  // The overwritten expirations must not evict the live entry.
+  cache.Put("entry2", "test2", now, now + 2 * kTTL);
+  now += base::TimeDelta::FromSeconds(15);
+  cache.Put("entry3", "test3", now, now + kTTL);
+  EXPECT_FALSE(cache.Get("entry1", now));
+  EXPECT_THAT(cache.Get("entry2", now), Pointee(StrEq("test2")));
+  EXPECT_THAT(cache.Get("entry3", now), Pointee(StrEq("test3")));
+}
+
+TEST(OrderedExpiringCacheTest, ExpireAll) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  OrderedCache cache(kMaxCacheEntries);
+
+  base::TimeTicks now;
+  cache.Put("entry1", "test1", now, now + kTTL);
+  cache.Put("entry2", "test2", now, now + kTTL);
+  EXPECT_EQ(2U, cache.size());
+
+  cache.ExpireAll(now);
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_FALSE(cache.Get("entry1", now));
+  EXPECT_FALSE(cache.Get("entry2", now));
+}
+
 }  // namespace net
@@ -10,6 +10,49 @@
 
 namespace net {
 
+#if defined(OS_POSIX)
+
+FileStream::Batch::Operation::Operation()
+    : is_write(false), buf_len(0), offset(0) {
+}
+
+FileStream::Batch::Operation::~Operation() {
+}
+
+FileStream::Batch::Batch() {
+}
+
+FileStream::Batch::~Batch() {
+}
+
+void FileStream::Batch::AddReadAt(IOBuffer* buf,
+                                  int buf_len,
+                                  int64_t offset,
+                                  const CompletionCallback& callback) {
+  Operation op;
+  op.is_write = false;
+  op.buf = buf;
+  op.buf_len = buf_len;
+  op.offset = offset;
+  op.callback = callback;
+  operations_.push_back(op);
+}
+
+void FileStream::Batch::AddWriteAt(IOBuffer* buf,
+                                   int buf_len,
+                                   int64_t offset,
+                                   const CompletionCallback& callback) {
+  Operation op;
+  op.is_write = true;
+  op.buf = buf;
+  op.buf_len = buf_len;
+  op.offset = offset;
+  op.callback = callback;
+  operations_.push_back(op);
+}
+
+#endif  // defined(OS_POSIX)
+
 FileStream::FileStream(const scoped_refptr<base::TaskRunner>& task_runner)
     : context_(new Context(task_runner)) {
 }
@@ -78,6 +121,46 @@ int FileStream::Write(IOBuffer* buf,
   return context_->Write(buf, buf_len, callback);
 }
 
+#if defined(OS_POSIX)
+
+int FileStream::ReadAt(IOBuffer* buf,
+                       int buf_len,
+                       int64_t offset,
+                       const CompletionCallback& callback) {
+  if (!IsOpen())
+    return ERR_UNEXPECTED;
+
+  // read(..., 0) will return 0, which indicates end-of-file.
+  DCHECK_GT(buf_len, 0);
+  DCHECK_GE(offset, 0);
+
+  return context_->ReadAt(buf, buf_len, offset, callback);
+}
+
+int FileStream::WriteAt(IOBuffer* buf,
+                        int buf_len,
+                        int64_t offset,
+                        const CompletionCallback& callback) {
+  if (!IsOpen())
+    return ERR_UNEXPECTED;
+
+  DCHECK_GE(buf_len, 0);
+  DCHECK_GE(offset, 0);
+
+  return context_->WriteAt(buf, buf_len, offset, callback);
+}
+
+int FileStream::SubmitBatch(scoped_ptr<Batch> batch,
+                            const CompletionCallback& callback) {
+  if (!IsOpen())
+    return ERR_UNEXPECTED;
+
+  DCHECK(!batch->empty());
+  return context_->SubmitBatch(batch.Pass(), callback);
+}
+
+#endif  // defined(OS_POSIX)
+
 int FileStream::Flush(const CompletionCallback& callback) {
   if (!IsOpen())
     return ERR_UNEXPECTED;
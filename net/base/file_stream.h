@@ -10,7 +10,11 @@
 #ifndef NET_BASE_FILE_STREAM_H_
 #define NET_BASE_FILE_STREAM_H_
 
+#include <vector>
+
 #include "base/files/file.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 
@@ -25,6 +29,50 @@ class IOBuffer;
 
 class NET_EXPORT FileStream {
  public:
+#if defined(OS_POSIX)
+  // A batch of read/write operations at explicit file offsets, submitted to
+  // the worker pool as a single task by SubmitBatch(). Collecting sequential
+  // I/O into a batch avoids one thread hop per operation.
+  class NET_EXPORT Batch {
+   public:
+    // A single queued operation. Public for FileStream::Context's use.
+    struct Operation {
+      Operation();
+      ~Operation();
+
+      bool is_write;
+      scoped_refptr<IOBuffer> buf;
+      int buf_len;
+      int64_t offset;
+      CompletionCallback callback;
+    };
+
+    Batch();
+    ~Batch();
+
+    // Appends a read (write) of up to |buf_len| bytes at file offset
+    // |offset|. |callback| may be null; if it is not, it is run with the
+    // operation's result when the batch completes.
+    void AddReadAt(IOBuffer* buf,
+                   int buf_len,
+                   int64_t offset,
+                   const CompletionCallback& callback);
+    void AddWriteAt(IOBuffer* buf,
+                    int buf_len,
+                    int64_t offset,
+                    const CompletionCallback& callback);
+
+    bool empty() const { return operations_.empty(); }
+
+    std::vector<Operation>* operations() { return &operations_; }
+
+   private:
+    std::vector<Operation> operations_;
+
+    DISALLOW_COPY_AND_ASSIGN(Batch);
+  };
+#endif  // defined(OS_POSIX)
+
   // Creates a FileStream.
   // Uses |task_runner| for asynchronous operations.
   explicit FileStream(const scoped_refptr<base::TaskRunner>& task_runner);
@@ -118,6 +166,31 @@ class NET_EXPORT FileStream {
   virtual int Write(IOBuffer* buf, int buf_len,
                     const CompletionCallback& callback);
 
+#if defined(OS_POSIX)
+  // Reads up to |buf_len| bytes at file offset |offset| without moving the
+  // stream position (pread() semantics). Otherwise behaves like Read().
+  virtual int ReadAt(IOBuffer* buf,
+                     int buf_len,
+                     int64_t offset,
+                     const CompletionCallback& callback);
+
+  // Writes up to |buf_len| bytes at file offset |offset| without moving the
+  // stream position (pwrite() semantics). Otherwise behaves like Write().
+  virtual int WriteAt(IOBuffer* buf,
+                      int buf_len,
+                      int64_t offset,
+                      const CompletionCallback& callback);
+
+  // Submits all operations queued on |batch| to the worker pool as a single
+  // task. Operations run in order; after the first failure the remaining
+  // operations are skipped. Each operation's callback is run with its own
+  // result (skipped operations get the error), then |callback| is run with
+  // OK or the first error. Returns ERR_IO_PENDING, or an error code if the
+  // batch could not be submitted. |batch| must not be empty.
+  virtual int SubmitBatch(scoped_ptr<Batch> batch,
+                          const CompletionCallback& callback);
+#endif  // defined(OS_POSIX)
+
   // Forces out a filesystem sync on this file to make sure that the file was
   // written out to disk and is not currently sitting in the buffer. This does
   // not have to be called, it just forces one to happen at the time of
@@ -27,6 +27,8 @@
 #ifndef NET_BASE_FILE_STREAM_CONTEXT_H_
 #define NET_BASE_FILE_STREAM_CONTEXT_H_
 
+#include <vector>
+
 #include "base/files/file.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop/message_loop.h"
@@ -75,6 +77,25 @@ class FileStream::Context {
             int buf_len,
             const CompletionCallback& callback);
 
+#if defined(OS_POSIX)
+  // At-offset counterparts of Read() and Write(), using pread()/pwrite()
+  // semantics so the stream position is left alone.
+  int ReadAt(IOBuffer* buf,
+             int buf_len,
+             int64_t offset,
+             const CompletionCallback& callback);
+
+  int WriteAt(IOBuffer* buf,
+              int buf_len,
+              int64_t offset,
+              const CompletionCallback& callback);
+
+  // Runs all operations queued on |batch| in a single worker pool task. See
+  // FileStream::SubmitBatch().
+  int SubmitBatch(scoped_ptr<FileStream::Batch> batch,
+                  const CompletionCallback& callback);
+#endif
+
   bool async_in_progress() const { return async_in_progress_; }
 
   ////////////////////////////////////////////////////////////////////////////
@@ -209,6 +230,27 @@ class FileStream::Context {
   // signals and calls MapSystemError() to map errno to net error codes.
   // It tries to write to completion.
   IOResult WriteFileImpl(scoped_refptr<IOBuffer> buf, int buf_len);
+
+  // At-offset counterparts of ReadFileImpl() and WriteFileImpl(), built on
+  // pread() and pwrite().
+  IOResult ReadAtFileImpl(scoped_refptr<IOBuffer> buf,
+                          int buf_len,
+                          int64_t offset);
+  IOResult WriteAtFileImpl(scoped_refptr<IOBuffer> buf,
+                           int buf_len,
+                           int64_t offset);
+
+  // Runs every operation in |batch| in order on the worker pool, appending
+  // one result per executed operation to |results|. Stops after the first
+  // operation that fails.
+  void RunBatchImpl(FileStream::Batch* batch, std::vector<IOResult>* results);
+
+  // Fans |results| out to the per-operation callbacks, then runs |callback|
+  // with OK or the first error. Operations that were skipped report the
+  // first error too.
+  void OnBatchCompleted(const CompletionCallback& callback,
+                        FileStream::Batch* batch,
+                        std::vector<IOResult>* results);
 #endif
 
   base::File file_;
@@ -77,6 +77,68 @@ int FileStream::Context::Write(IOBuffer* in_buf,
   return ERR_IO_PENDING;
 }
 
+int FileStream::Context::ReadAt(IOBuffer* in_buf,
+                                int buf_len,
+                                int64_t offset,
+                                const CompletionCallback& callback) {
+  DCHECK(!async_in_progress_);
+
+  scoped_refptr<IOBuffer> buf = in_buf;
+  const bool posted = base::PostTaskAndReplyWithResult(
+      task_runner_.get(),
+      FROM_HERE,
+      base::Bind(&Context::ReadAtFileImpl, base::Unretained(this), buf, buf_len,
+                 offset),
+      base::Bind(&Context::OnAsyncCompleted,
+                 base::Unretained(this),
+                 IntToInt64(callback)));
+  DCHECK(posted);
+
+  async_in_progress_ = true;
+  return ERR_IO_PENDING;
+}
+
+int FileStream::Context::WriteAt(IOBuffer* in_buf,
+                                 int buf_len,
+                                 int64_t offset,
+                                 const CompletionCallback& callback) {
+  DCHECK(!async_in_progress_);
+
+  scoped_refptr<IOBuffer> buf = in_buf;
+  const bool posted = base::PostTaskAndReplyWithResult(
+      task_runner_.get(),
+      FROM_HERE,
+      base::Bind(&Context::WriteAtFileImpl, base::Unretained(this), buf,
+                 buf_len, offset),
+      base::Bind(&Context::OnAsyncCompleted,
+                 base::Unretained(this),
+                 IntToInt64(callback)));
+  DCHECK(posted);
+
+  async_in_progress_ = true;
+  return ERR_IO_PENDING;
+}
+
+int FileStream::Context::SubmitBatch(scoped_ptr<FileStream::Batch> batch,
+                                     const CompletionCallback& callback) {
+  DCHECK(!async_in_progress_);
+
+  // The batch and the results are owned by the reply callback, which always
+  // runs after RunBatchImpl() has finished with them.
+  FileStream::Batch* raw_batch = batch.release();
+  std::vector<IOResult>* results = new std::vector<IOResult>;
+  const bool posted = task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&Context::RunBatchImpl, base::Unretained(this), raw_batch,
+                 results),
+      base::Bind(&Context::OnBatchCompleted, base::Unretained(this), callback,
+                 base::Owned(raw_batch), base::Owned(results)));
+  DCHECK(posted);
+
+  async_in_progress_ = true;
+  return ERR_IO_PENDING;
+}
+
 FileStream::Context::IOResult FileStream::Context::SeekFileImpl(
     int64_t offset) {
   int64_t res = file_.Seek(base::File::FROM_BEGIN, offset);
@@ -113,4 +175,73 @@ FileStream::Context::IOResult FileStream::Context::WriteFileImpl(
   return IOResult(res, 0);
 }
 
+FileStream::Context::IOResult FileStream::Context::ReadAtFileImpl(
+    scoped_refptr<IOBuffer> buf,
+    int buf_len,
+    int64_t offset) {
+  int res = file_.Read(offset, buf->data(), buf_len);
+  if (res == -1)
+    return IOResult::FromOSError(errno);
+
+  return IOResult(res, 0);
+}
+
+FileStream::Context::IOResult FileStream::Context::WriteAtFileImpl(
+    scoped_refptr<IOBuffer> buf,
+    int buf_len,
+    int64_t offset) {
+  int res = file_.Write(offset, buf->data(), buf_len);
+  if (res == -1)
+    return IOResult::FromOSError(errno);
+
+  return IOResult(res, 0);
+}
+
+void FileStream::Context::RunBatchImpl(FileStream::Batch* batch,
+                                       std::vector<IOResult>* results) {
+  std::vector<FileStream::Batch::Operation>* operations = batch->operations();
+  for (size_t i = 0; i < operations->size(); ++i) {
+    const FileStream::Batch::Operation& op = (*operations)[i];
+    IOResult result = op.is_write
+                          ? WriteAtFileImpl(op.buf, op.buf_len, op.offset)
+                          : ReadAtFileImpl(op.buf, op.buf_len, op.offset);
+    results->push_back(result);
+    if (result.result < 0)
+      break;
+  }
+}
+
+void FileStream::Context::OnBatchCompleted(const CompletionCallback& callback,
+                                           FileStream::Batch* batch,
+                                           std::vector<IOResult>* results) {
+  // Reset this before running any callback, as a callback may issue a new
+  // async operation or delete the FileStream (orphaning this context).
+  async_in_progress_ = false;
+  if (orphaned_) {
+    CloseAndDelete();
+    return;
+  }
+
+  // Fan the results out to the per-operation callbacks. Operations after the
+  // first failure did not run and report that failure. |batch| and |results|
+  // are owned by the currently running reply callback, so they stay valid
+  // even if an operation's callback deletes the FileStream; members of this
+  // context must not be touched after the first callback runs.
+  std::vector<FileStream::Batch::Operation>* operations = batch->operations();
+  int error = OK;
+  for (size_t i = 0; i < operations->size(); ++i) {
+    int result;
+    if (i < results->size()) {
+      result = static_cast<int>((*results)[i].result);
+      if (result < 0 && error == OK)
+        error = result;
+    } else {
+      result = error;
+    }
+    if (!(*operations)[i].callback.is_null())
+      (*operations)[i].callback.Run(result);
+  }
+  callback.Run(error);
+}
+
 }  // namespace net
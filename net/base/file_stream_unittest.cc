@@ -834,6 +834,86 @@ TEST_F(FileStreamTest, ContentUriRead) {
 }
 #endif
 
+#if defined(OS_POSIX)
+
+TEST_F(FileStreamTest, ReadAt) {
+  FileStream stream(base::ThreadTaskRunnerHandle::Get());
+  int flags = base::File::FLAG_OPEN | base::File::FLAG_READ |
+              base::File::FLAG_ASYNC;
+  TestCompletionCallback callback;
+  int rv = stream.Open(temp_file_path(), flags, callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+
+  const int64_t kOffset = 3;
+  scoped_refptr<IOBufferWithSize> buf = new IOBufferWithSize(4);
+  rv = stream.ReadAt(buf.get(), buf->size(), kOffset, callback.callback());
+  rv = callback.GetResult(rv);
+  ASSERT_EQ(buf->size(), rv);
+  EXPECT_EQ(std::string(kTestData + kOffset, rv),
+            std::string(buf->data(), rv));
+
+  // ReadAt() must not move the stream position.
+  scoped_refptr<IOBufferWithSize> seq_buf = new IOBufferWithSize(kTestDataSize);
+  rv = stream.Read(seq_buf.get(), seq_buf->size(), callback.callback());
+  rv = callback.GetResult(rv);
+  ASSERT_EQ(kTestDataSize, rv);
+  EXPECT_EQ(kTestData, std::string(seq_buf->data(), rv));
+}
+
+TEST_F(FileStreamTest, WriteAt) {
+  FileStream stream(base::ThreadTaskRunnerHandle::Get());
+  int flags = base::File::FLAG_OPEN | base::File::FLAG_WRITE |
+              base::File::FLAG_ASYNC;
+  TestCompletionCallback callback;
+  int rv = stream.Open(temp_file_path(), flags, callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+
+  const int64_t kOffset = 2;
+  scoped_refptr<StringIOBuffer> buf = new StringIOBuffer("WXYZ");
+  rv = stream.WriteAt(buf.get(), buf->size(), kOffset, callback.callback());
+  rv = callback.GetResult(rv);
+  ASSERT_EQ(buf->size(), rv);
+
+  base::RunLoop().RunUntilIdle();
+
+  std::string data_read;
+  EXPECT_TRUE(base::ReadFileToString(temp_file_path(), &data_read));
+  EXPECT_EQ("01WXYZ6789", data_read);
+}
+
+TEST_F(FileStreamTest, SubmitBatch) {
+  FileStream stream(base::ThreadTaskRunnerHandle::Get());
+  int flags = base::File::FLAG_OPEN | base::File::FLAG_READ |
+              base::File::FLAG_WRITE | base::File::FLAG_ASYNC;
+  TestCompletionCallback callback;
+  int rv = stream.Open(temp_file_path(), flags, callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+
+  // Queue a write appending a second copy of the test data and a read of the
+  // doubled file; operations run in order, so the read sees the write.
+  scoped_refptr<IOBuffer> write_buf = CreateTestDataBuffer();
+  scoped_refptr<IOBufferWithSize> read_buf =
+      new IOBufferWithSize(2 * kTestDataSize);
+  TestCompletionCallback write_callback;
+  TestCompletionCallback read_callback;
+
+  scoped_ptr<FileStream::Batch> batch(new FileStream::Batch);
+  batch->AddWriteAt(write_buf.get(), kTestDataSize, kTestDataSize,
+                    write_callback.callback());
+  batch->AddReadAt(read_buf.get(), read_buf->size(), 0,
+                   read_callback.callback());
+
+  rv = stream.SubmitBatch(batch.Pass(), callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+
+  EXPECT_EQ(kTestDataSize, write_callback.WaitForResult());
+  EXPECT_EQ(2 * kTestDataSize, read_callback.WaitForResult());
+  EXPECT_EQ(std::string(kTestData) + kTestData,
+            std::string(read_buf->data(), 2 * kTestDataSize));
+}
+
+#endif  // defined(OS_POSIX)
+
 }  // namespace
 
 }  // namespace net
@@ -4,7 +4,13 @@
 
 #include "net/base/host_mapping_rules.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "base/containers/hash_tables.h"
 #include "base/logging.h"
+#include "base/stl_util.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_tokenizer.h"
@@ -14,6 +20,89 @@
 
 namespace net {
 
+namespace {
+
+// Marker for "no rule matched" in the compiled structures below.
+const size_t kNoMatch = static_cast<size_t>(-1);
+
+// How a rule's hostname pattern is matched. Patterns without wildcards are
+// looked up in a hash map. Patterns of the form "*<suffix>" with no other
+// wildcards walk a trie over the reversed suffix. Everything else falls back
+// to a linear MatchPattern() scan. Patterns containing a backslash are
+// conservatively treated as general so MatchPattern() keeps full authority
+// over escaping.
+enum PatternClass {
+  PATTERN_EXACT,
+  PATTERN_SUFFIX,
+  PATTERN_GENERAL,
+};
+
+PatternClass ClassifyPattern(const std::string& pattern) {
+  if (pattern.find_first_of("*?\\") == std::string::npos)
+    return PATTERN_EXACT;
+  if (pattern.size() > 1 && pattern[0] == '*' &&
+      pattern.find_first_of("*?\\", 1) == std::string::npos)
+    return PATTERN_SUFFIX;
+  return PATTERN_GENERAL;
+}
+
+// A trie over the characters of reversed pattern suffixes. Matching walks
+// the target string backwards; every node visited that terminates a suffix
+// corresponds to a "*<suffix>" pattern matching the target.
+class SuffixTrie {
+ public:
+  SuffixTrie() {}
+  ~SuffixTrie() {}
+
+  void Insert(const std::string& suffix, size_t rule_index) {
+    Node* node = &root_;
+    for (std::string::const_reverse_iterator it = suffix.rbegin();
+         it != suffix.rend(); ++it) {
+      Node*& child = node->children[*it];
+      if (!child)
+        child = new Node;
+      node = child;
+    }
+    // The first matching rule wins, so keep the lowest index.
+    node->rule_index = std::min(node->rule_index, rule_index);
+  }
+
+  // Returns the lowest index of a rule whose suffix matches the end of
+  // |text|, or kNoMatch.
+  size_t Match(const std::string& text) const {
+    size_t best = kNoMatch;
+    const Node* node = &root_;
+    for (std::string::const_reverse_iterator it = text.rbegin();
+         it != text.rend(); ++it) {
+      std::map<char, Node*>::const_iterator child = node->children.find(*it);
+      if (child == node->children.end())
+        break;
+      node = child->second;
+      if (node->rule_index < best)
+        best = node->rule_index;
+    }
+    return best;
+  }
+
+ private:
+  struct Node {
+    Node() : rule_index(kNoMatch) {}
+    ~Node() {
+      STLDeleteContainerPairSecondPointers(children.begin(), children.end());
+    }
+
+    // Lowest index of a rule whose pattern suffix ends at this node.
+    size_t rule_index;
+    std::map<char, Node*> children;
+  };
+
+  Node root_;
+
+  DISALLOW_COPY_AND_ASSIGN(SuffixTrie);
+};
+
+}  // namespace
+
 struct HostMappingRules::MapRule {
   MapRule() : replacement_port(-1) {}
 
@@ -26,44 +115,116 @@ struct HostMappingRules::ExclusionRule {
   std::string hostname_pattern;
 };
 
-HostMappingRules::HostMappingRules() {}
-
-HostMappingRules::~HostMappingRules() {}
+// Compiled form of the rule lists, built as rules are added. Looking up a
+// host consults the hash maps and suffix tries first and only scans the
+// general lists for patterns too complex to index.
+struct HostMappingRules::CompiledRules {
+  void AddExclusion(const std::string& pattern) {
+    switch (ClassifyPattern(pattern)) {
+      case PATTERN_EXACT:
+        exact_exclusions.insert(pattern);
+        break;
+      case PATTERN_SUFFIX:
+        suffix_exclusions.Insert(pattern.substr(1), 0);
+        break;
+      case PATTERN_GENERAL:
+        general_exclusions.push_back(pattern);
+        break;
+    }
+  }
 
-bool HostMappingRules::RewriteHost(HostPortPair* host_port) const {
-  // Check if the hostname was excluded.
-  for (ExclusionRuleList::const_iterator it = exclusion_rules_.begin();
-       it != exclusion_rules_.end(); ++it) {
-    const ExclusionRule& rule = *it;
-    if (base::MatchPattern(host_port->host(), rule.hostname_pattern))
-      return false;
+  void AddMap(const std::string& pattern, size_t rule_index) {
+    switch (ClassifyPattern(pattern)) {
+      case PATTERN_EXACT:
+        // insert() keeps an existing entry, so a duplicate pattern keeps the
+        // lowest rule index, matching first-rule-wins semantics.
+        exact_maps.insert(std::make_pair(pattern, rule_index));
+        break;
+      case PATTERN_SUFFIX:
+        suffix_maps.Insert(pattern.substr(1), rule_index);
+        break;
+      case PATTERN_GENERAL:
+        general_maps.push_back(std::make_pair(pattern, rule_index));
+        break;
+    }
   }
 
-  // Check if the hostname was remapped.
-  for (MapRuleList::const_iterator it = map_rules_.begin();
-       it != map_rules_.end(); ++it) {
-    const MapRule& rule = *it;
-
-    // The rule's hostname_pattern will be something like:
-    //     www.foo.com
-    //     *.foo.com
-    //     www.foo.com:1234
-    //     *.foo.com:1234
-    // First, we'll check for a match just on hostname.
-    // If that fails, we'll check for a match with both hostname and port.
-    if (!base::MatchPattern(host_port->host(), rule.hostname_pattern)) {
-      std::string host_port_string = host_port->ToString();
-      if (!base::MatchPattern(host_port_string, rule.hostname_pattern))
-        continue;  // This rule doesn't apply.
+  // Returns true if an exclusion pattern matches |host|.
+  bool MatchesExclusion(const std::string& host) const {
+    if (exact_exclusions.count(host) > 0)
+      return true;
+    if (suffix_exclusions.Match(host) != kNoMatch)
+      return true;
+    for (size_t i = 0; i < general_exclusions.size(); ++i) {
+      if (base::MatchPattern(host, general_exclusions[i]))
+        return true;
     }
+    return false;
+  }
 
-    host_port->set_host(rule.replacement_hostname);
-    if (rule.replacement_port != -1)
-      host_port->set_port(static_cast<uint16_t>(rule.replacement_port));
-    return true;
+  // Returns the lowest index of a map rule whose pattern matches |host| or
+  // |host_port_string|, or kNoMatch.
+  size_t FindMapRule(const std::string& host,
+                     const std::string& host_port_string) const {
+    size_t best = kNoMatch;
+    base::hash_map<std::string, size_t>::const_iterator it =
+        exact_maps.find(host);
+    if (it != exact_maps.end())
+      best = std::min(best, it->second);
+    it = exact_maps.find(host_port_string);
+    if (it != exact_maps.end())
+      best = std::min(best, it->second);
+    best = std::min(best, suffix_maps.Match(host));
+    best = std::min(best, suffix_maps.Match(host_port_string));
+    for (size_t i = 0; i < general_maps.size(); ++i) {
+      if (general_maps[i].second < best &&
+          (base::MatchPattern(host, general_maps[i].first) ||
+           base::MatchPattern(host_port_string, general_maps[i].first))) {
+        best = general_maps[i].second;
+      }
+    }
+    return best;
   }
 
-  return false;
+  base::hash_set<std::string> exact_exclusions;
+  base::hash_map<std::string, size_t> exact_maps;
+
+  SuffixTrie suffix_exclusions;
+  SuffixTrie suffix_maps;
+
+  std::vector<std::string> general_exclusions;
+  std::vector<std::pair<std::string, size_t> > general_maps;
+};
+
+HostMappingRules::HostMappingRules() : compiled_rules_(new CompiledRules) {}
+
+HostMappingRules::~HostMappingRules() {}
+
+bool HostMappingRules::RewriteHost(HostPortPair* host_port) const {
+  std::string host_port_string = host_port->ToString();
+
+  // Check if the hostname was excluded.
+  if (compiled_rules_->MatchesExclusion(host_port->host()))
+    return false;
+
+  // Check if the hostname was remapped. Rules' hostname_patterns will be
+  // something like:
+  //     www.foo.com
+  //     *.foo.com
+  //     www.foo.com:1234
+  //     *.foo.com:1234
+  // A rule matches on the hostname alone or on hostname and port; of all
+  // matching rules the one added first wins.
+  size_t rule_index =
+      compiled_rules_->FindMapRule(host_port->host(), host_port_string);
+  if (rule_index == kNoMatch)
+    return false;
+
+  const MapRule& rule = map_rules_[rule_index];
+  host_port->set_host(rule.replacement_hostname);
+  if (rule.replacement_port != -1)
+    host_port->set_port(static_cast<uint16_t>(rule.replacement_port));
+  return true;
 }
 
 bool HostMappingRules::AddRuleFromString(const std::string& rule_string) {
@@ -76,6 +237,7 @@ bool HostMappingRules::AddRuleFromString(const std::string& rule_string) {
     ExclusionRule rule;
     rule.hostname_pattern = base::ToLowerASCII(parts[1]);
     exclusion_rules_.push_back(rule);
+    compiled_rules_->AddExclusion(rule.hostname_pattern);
     return true;
   }
 
@@ -90,6 +252,7 @@ bool HostMappingRules::AddRuleFromString(const std::string& rule_string) {
     }
 
     map_rules_.push_back(rule);
+    compiled_rules_->AddMap(rule.hostname_pattern, map_rules_.size() - 1);
     return true;
   }
 
@@ -99,6 +262,7 @@ bool HostMappingRules::AddRuleFromString(const std::string& rule_string) {
 void HostMappingRules::SetRulesFromString(const std::string& rules_string) {
   exclusion_rules_.clear();
   map_rules_.clear();
+  compiled_rules_.reset(new CompiledRules);
 
   base::StringTokenizer rules(rules_string, ",");
   while (rules.GetNext()) {
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "net/base/net_export.h"
 
 namespace net {
@@ -39,6 +40,7 @@ class NET_EXPORT_PRIVATE HostMappingRules {
  private:
   struct MapRule;
   struct ExclusionRule;
+  struct CompiledRules;
 
   typedef std::vector<MapRule> MapRuleList;
   typedef std::vector<ExclusionRule> ExclusionRuleList;
@@ -46,6 +48,10 @@ class NET_EXPORT_PRIVATE HostMappingRules {
   MapRuleList map_rules_;
   ExclusionRuleList exclusion_rules_;
 
+  // Pattern matching structures derived from the rules above, kept in sync
+  // as rules are added so RewriteHost() does not have to walk every rule.
+  scoped_ptr<CompiledRules> compiled_rules_;
+
   DISALLOW_COPY_AND_ASSIGN(HostMappingRules);
 };
 
@@ -67,6 +67,56 @@ TEST(HostMappingRulesTest, PortSpecificMatching) {
   EXPECT_EQ(443u, host_port.port());
 }
 
+TEST(HostMappingRulesTest, FirstMatchingRuleWins) {
+  HostMappingRules rules;
+  rules.SetRulesFromString("map *.com suffix:100 , map chrome.com exact:200");
+
+  // Both patterns match; the rule listed first wins.
+  HostPortPair host_port("chrome.com", 80);
+  EXPECT_TRUE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("suffix", host_port.host());
+  EXPECT_EQ(100u, host_port.port());
+
+  rules.SetRulesFromString("map chrome.com exact:200 , map *.com suffix:100");
+
+  host_port = HostPortPair("chrome.com", 80);
+  EXPECT_TRUE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("exact", host_port.host());
+  EXPECT_EQ(200u, host_port.port());
+}
+
+TEST(HostMappingRulesTest, ExactAndGenericPatterns) {
+  HostMappingRules rules;
+  rules.SetRulesFromString(
+      "map www.chromium.org cr:100 , map gw?.corp.example goo:200 , "
+      "map *.google.com g:300 , EXCLUDE www.google.com");
+
+  // A pattern without wildcards matches the full hostname only.
+  HostPortPair host_port("www.chromium.org", 80);
+  EXPECT_TRUE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("cr", host_port.host());
+  EXPECT_EQ(100u, host_port.port());
+
+  host_port = HostPortPair("xwww.chromium.org", 80);
+  EXPECT_FALSE(rules.RewriteHost(&host_port));
+
+  // "?" patterns take the generic matching path.
+  host_port = HostPortPair("gw1.corp.example", 80);
+  EXPECT_TRUE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("goo", host_port.host());
+  EXPECT_EQ(200u, host_port.port());
+
+  // Excluded by an exact pattern despite matching a map rule.
+  host_port = HostPortPair("www.google.com", 80);
+  EXPECT_FALSE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("www.google.com", host_port.host());
+
+  host_port = HostPortPair("mail.google.com", 80);
+  EXPECT_TRUE(rules.RewriteHost(&host_port));
+  EXPECT_EQ("g", host_port.host());
+  EXPECT_EQ(300u, host_port.port());
+}
+
 // Parsing bad rules should silently discard the rule (and never crash).
 TEST(HostMappingRulesTest, ParseInvalidRules) {
   HostMappingRules rules;
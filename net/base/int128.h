@@ -11,6 +11,13 @@
 
 #include "net/base/net_export.h"
 
+// When the compiler provides a native 128-bit integer type, the arithmetic
+// operators below use it instead of the portable 64-bit limb code.  The
+// class layout and results are identical either way.
+#if defined(__SIZEOF_INT128__)
+#define NET_HAVE_INTRINSIC_INT128 1
+#endif
+
 struct uint128_pod;
 
 // An unsigned 128-bit integer type. Thread-compatible.
@@ -127,6 +134,13 @@ inline void uint128::Initialize(uint64_t top, uint64_t bottom) {
   lo_ = bottom;
 }
 
+#if defined(NET_HAVE_INTRINSIC_INT128)
+inline unsigned __int128 Uint128ToIntrinsic(const uint128& v) {
+  return (static_cast<unsigned __int128>(Uint128High64(v)) << 64) |
+         Uint128Low64(v);
+}
+#endif
+
 // Comparison operators.
 
 #define CMP128(op)                                                \
@@ -277,23 +291,41 @@ inline uint128 operator*(const uint128& lhs, const uint128& rhs) {
 }
 
 inline uint128& uint128::operator+=(const uint128& b) {
+#if defined(NET_HAVE_INTRINSIC_INT128)
+  unsigned __int128 sum = Uint128ToIntrinsic(*this) + Uint128ToIntrinsic(b);
+  hi_ = static_cast<uint64_t>(sum >> 64);
+  lo_ = static_cast<uint64_t>(sum);
+#else
   hi_ += b.hi_;
   uint64_t lolo = lo_ + b.lo_;
   if (lolo < lo_)
     ++hi_;
   lo_ = lolo;
+#endif
   return *this;
 }
 
 inline uint128& uint128::operator-=(const uint128& b) {
+#if defined(NET_HAVE_INTRINSIC_INT128)
+  unsigned __int128 diff = Uint128ToIntrinsic(*this) - Uint128ToIntrinsic(b);
+  hi_ = static_cast<uint64_t>(diff >> 64);
+  lo_ = static_cast<uint64_t>(diff);
+#else
   hi_ -= b.hi_;
   if (b.lo_ > lo_)
     --hi_;
   lo_ -= b.lo_;
+#endif
   return *this;
 }
 
 inline uint128& uint128::operator*=(const uint128& b) {
+#if defined(NET_HAVE_INTRINSIC_INT128)
+  unsigned __int128 product = Uint128ToIntrinsic(*this) * Uint128ToIntrinsic(b);
+  hi_ = static_cast<uint64_t>(product >> 64);
+  lo_ = static_cast<uint64_t>(product);
+  return *this;
+#else
   uint64_t a96 = hi_ >> 32;
   uint64_t a64 = hi_ & 0xffffffffu;
   uint64_t a32 = lo_ >> 32;
@@ -314,6 +346,7 @@ inline uint128& uint128::operator*=(const uint128& b) {
   *this += uint128(a00 * b32) << 32;
   *this += a00 * b00;
   return *this;
+#endif
 }
 
 inline uint128 uint128::operator++(int) {
@@ -4,8 +4,12 @@
 
 #include "net/base/io_buffer.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "base/logging.h"
 #include "base/numerics/safe_math.h"
+#include "net/base/net_allocation_tracker.h"
 
 namespace net {
 
@@ -28,20 +32,24 @@ void AssertValidBufferSize(int size) {
 
 IOBuffer::IOBuffer()
     : data_(NULL) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_IO_BUFFER);
 }
 
 IOBuffer::IOBuffer(int buffer_size) {
   AssertValidBufferSize(buffer_size);
   data_ = new char[buffer_size];
+  NET_TRACK_ALLOCATION(ALLOC_SITE_IO_BUFFER);
 }
 
 IOBuffer::IOBuffer(size_t buffer_size) {
   AssertValidBufferSize(buffer_size);
   data_ = new char[buffer_size];
+  NET_TRACK_ALLOCATION(ALLOC_SITE_IO_BUFFER);
 }
 
 IOBuffer::IOBuffer(char* data)
     : data_(data) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_IO_BUFFER);
 }
 
 IOBuffer::~IOBuffer() {
@@ -131,6 +139,9 @@ DrainableIOBuffer::~DrainableIOBuffer() {
   data_ = NULL;
 }
 
+// static
+const int GrowableIOBuffer::kInlineCapacity;
+
 GrowableIOBuffer::GrowableIOBuffer()
     : IOBuffer(),
       capacity_(0),
@@ -139,8 +150,23 @@ GrowableIOBuffer::GrowableIOBuffer()
 
 void GrowableIOBuffer::SetCapacity(int capacity) {
   DCHECK_GE(capacity, 0);
-  // realloc will crash if it fails.
-  real_data_.reset(static_cast<char*>(realloc(real_data_.release(), capacity)));
+  if (capacity <= kInlineCapacity) {
+    // Small capacities are stored inline; release any heap block, keeping
+    // the bytes that still fit.
+    if (real_data_) {
+      memcpy(inline_data_, real_data_.get(), capacity);
+      real_data_.reset();
+    }
+  } else if (!real_data_) {
+    // malloc will crash if it fails.
+    char* heap_data = static_cast<char*>(malloc(capacity));
+    memcpy(heap_data, inline_data_, capacity_);
+    real_data_.reset(heap_data);
+  } else {
+    // realloc will crash if it fails.
+    real_data_.reset(
+        static_cast<char*>(realloc(real_data_.release(), capacity)));
+  }
   capacity_ = capacity;
   if (offset_ > capacity)
     set_offset(capacity);
@@ -148,11 +174,16 @@ void GrowableIOBuffer::SetCapacity(int capacity) {
     set_offset(offset_);  // The pointer may have changed.
 }
 
+void GrowableIOBuffer::ShrinkToFit() {
+  if (capacity_ > offset_)
+    SetCapacity(offset_);
+}
+
 void GrowableIOBuffer::set_offset(int offset) {
   DCHECK_GE(offset, 0);
   DCHECK_LE(offset, capacity_);
   offset_ = offset;
-  data_ = real_data_.get() + offset;
+  data_ = StartOfBuffer() + offset;
 }
 
 int GrowableIOBuffer::RemainingCapacity() {
@@ -160,7 +191,7 @@ int GrowableIOBuffer::RemainingCapacity() {
 }
 
 char* GrowableIOBuffer::StartOfBuffer() {
-  return real_data_.get();
+  return real_data_ ? real_data_.get() : inline_data_;
 }
 
 GrowableIOBuffer::~GrowableIOBuffer() {
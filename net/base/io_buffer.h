@@ -196,14 +196,25 @@ class NET_EXPORT DrainableIOBuffer : public IOBuffer {
 //   buf->set_offset(buf->offset() + bytes_read);
 // }
 //
+// Capacities up to kInlineCapacity are stored inline in the object rather
+// than on the heap, so small buffers never touch the allocator.  Note that
+// SetCapacity() may move the data regardless of the storage used, so
+// pointers into the buffer must not be held across calls to it.
 class NET_EXPORT GrowableIOBuffer : public IOBuffer {
  public:
+  // Largest capacity served from inline storage.
+  static const int kInlineCapacity = 256;
+
   GrowableIOBuffer();
 
   // realloc memory to the specified capacity.
   void SetCapacity(int capacity);
   int capacity() { return capacity_; }
 
+  // Releases any excess backing memory, reducing the capacity to |offset|.
+  // Useful once a buffer's final size is known, e.g. after header parsing.
+  void ShrinkToFit();
+
   // |offset| moves the |data_| pointer, allowing "seeking" in the data.
   void set_offset(int offset);
   int offset() { return offset_; }
@@ -215,6 +226,7 @@ class NET_EXPORT GrowableIOBuffer : public IOBuffer {
   ~GrowableIOBuffer() override;
 
   scoped_ptr<char, base::FreeDeleter> real_data_;
+  char inline_data_[kInlineCapacity];
   int capacity_;
   int offset_;
 };
@@ -0,0 +1,111 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "net/base/io_buffer.h"
+
+namespace net {
+
+namespace {
+
+// Keeps a reference so the default pool is never torn down while pooled
+// buffers are still in flight on other threads.
+struct DefaultPoolHolder {
+  DefaultPoolHolder() : pool(new IOBufferPool()) {}
+  scoped_refptr<IOBufferPool> pool;
+};
+
+base::LazyInstance<DefaultPoolHolder>::Leaky g_default_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+const size_t IOBufferPool::kClassSizes[IOBufferPool::kNumClasses] = {
+    4 * 1024, 16 * 1024, 64 * 1024};
+
+// An IOBufferWithSize whose backing memory belongs to an IOBufferPool.  The
+// destructor hands the slab back instead of letting ~IOBuffer delete it.
+class IOBufferPool::PooledBuffer : public IOBufferWithSize {
+ public:
+  PooledBuffer(IOBufferPool* pool, char* data, size_t class_index)
+      : IOBufferWithSize(data, kClassSizes[class_index]),
+        pool_(pool),
+        class_index_(class_index) {}
+
+ private:
+  ~PooledBuffer() override {
+    pool_->Release(data_, class_index_);
+    // ~IOBuffer must not delete memory the pool now owns.
+    data_ = NULL;
+  }
+
+  scoped_refptr<IOBufferPool> pool_;
+  const size_t class_index_;
+};
+
+IOBufferPool::IOBufferPool() {
+}
+
+IOBufferPool::~IOBufferPool() {
+  for (size_t i = 0; i < kNumClasses; ++i) {
+    for (size_t j = 0; j < free_lists_[i].size(); ++j)
+      delete[] free_lists_[i][j];
+  }
+}
+
+// static
+IOBufferPool* IOBufferPool::Default() {
+  return g_default_pool.Get().pool.get();
+}
+
+scoped_refptr<IOBufferWithSize> IOBufferPool::Allocate(size_t size) {
+  size_t class_index = kNumClasses;
+  for (size_t i = 0; i < kNumClasses; ++i) {
+    if (size <= kClassSizes[i]) {
+      class_index = i;
+      break;
+    }
+  }
+  // Too big for any class; fall through to the heap.
+  if (class_index == kNumClasses)
+    return new IOBufferWithSize(size);
+
+  char* data = NULL;
+  {
+    base::AutoLock auto_lock(lock_);
+    std::vector<char*>* free_list = &free_lists_[class_index];
+    if (!free_list->empty()) {
+      data = free_list->back();
+      free_list->pop_back();
+    }
+  }
+  if (!data)
+    data = new char[kClassSizes[class_index]];
+  return new PooledBuffer(this, data, class_index);
+}
+
+size_t IOBufferPool::BytesFreeForTesting() const {
+  base::AutoLock auto_lock(lock_);
+  size_t total = 0;
+  for (size_t i = 0; i < kNumClasses; ++i)
+    total += free_lists_[i].size() * kClassSizes[i];
+  return total;
+}
+
+void IOBufferPool::Release(char* data, size_t class_index) {
+  DCHECK_LT(class_index, kNumClasses);
+  {
+    base::AutoLock auto_lock(lock_);
+    if (free_lists_[class_index].size() < kMaxFreePerClass) {
+      free_lists_[class_index].push_back(data);
+      return;
+    }
+  }
+  delete[] data;
+}
+
+}  // namespace net
@@ -0,0 +1,70 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_IO_BUFFER_POOL_H_
+#define NET_BASE_IO_BUFFER_POOL_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class IOBufferWithSize;
+
+// A size-classed slab allocator for IOBuffers.  Allocate() hands out a buffer
+// from the smallest class (4K, 16K or 64K) that fits the request; when the
+// last reference to the buffer is dropped, its backing memory returns to the
+// pool's free list instead of the heap.  Requests larger than the largest
+// class fall through to a plain heap-backed IOBufferWithSize.
+//
+// Hot read/write paths (HttpStreamParser, SpdySession's read loop, UDP
+// sockets) allocate a fresh buffer per operation; drawing those from the pool
+// removes the allocator round trip from the IO thread.  The pool is
+// thread-safe because the last reference to a buffer may be dropped on a
+// worker thread.
+class NET_EXPORT IOBufferPool : public base::RefCountedThreadSafe<IOBufferPool> {
+ public:
+  IOBufferPool();
+
+  // Returns the process-wide pool shared by net's IO paths.
+  static IOBufferPool* Default();
+
+  // Returns a buffer whose capacity is at least |size| bytes.  The buffer's
+  // size() reflects the capacity of its size class, not |size|.
+  scoped_refptr<IOBufferWithSize> Allocate(size_t size);
+
+  // Total bytes currently sitting in the free lists.
+  size_t BytesFreeForTesting() const;
+
+ private:
+  class PooledBuffer;
+  friend class PooledBuffer;
+  friend class base::RefCountedThreadSafe<IOBufferPool>;
+
+  ~IOBufferPool();
+
+  // Returns |data|, a slab of kClassSizes[class_index] bytes, to the free
+  // list, or frees it if the class already holds kMaxFreePerClass slabs.
+  void Release(char* data, size_t class_index);
+
+  static const size_t kNumClasses = 3;
+  static const size_t kClassSizes[kNumClasses];
+
+  // Cap on retained slabs per class so an I/O burst cannot pin memory
+  // indefinitely.
+  static const size_t kMaxFreePerClass = 32;
+
+  mutable base::Lock lock_;
+  std::vector<char*> free_lists_[kNumClasses];
+
+  DISALLOW_COPY_AND_ASSIGN(IOBufferPool);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_IO_BUFFER_POOL_H_
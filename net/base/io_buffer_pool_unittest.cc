@@ -0,0 +1,58 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include <string.h>
+
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(IOBufferPoolTest, RoundsUpToSizeClass) {
+  scoped_refptr<IOBufferPool> pool(new IOBufferPool());
+
+  scoped_refptr<IOBufferWithSize> small = pool->Allocate(100);
+  EXPECT_EQ(4 * 1024, small->size());
+
+  scoped_refptr<IOBufferWithSize> medium = pool->Allocate(5 * 1024);
+  EXPECT_EQ(16 * 1024, medium->size());
+
+  scoped_refptr<IOBufferWithSize> large = pool->Allocate(20 * 1024);
+  EXPECT_EQ(64 * 1024, large->size());
+
+  // Requests beyond the largest class are heap-backed and keep their size.
+  scoped_refptr<IOBufferWithSize> huge = pool->Allocate(100 * 1024);
+  EXPECT_EQ(100 * 1024, huge->size());
+}
+
+TEST(IOBufferPoolTest, RecyclesReleasedBuffers) {
+  scoped_refptr<IOBufferPool> pool(new IOBufferPool());
+  EXPECT_EQ(0u, pool->BytesFreeForTesting());
+
+  scoped_refptr<IOBufferWithSize> buffer = pool->Allocate(1024);
+  char* data = buffer->data();
+  buffer = NULL;
+  EXPECT_EQ(4u * 1024, pool->BytesFreeForTesting());
+
+  // The next same-class allocation reuses the released slab.
+  buffer = pool->Allocate(2048);
+  EXPECT_EQ(data, buffer->data());
+  EXPECT_EQ(0u, pool->BytesFreeForTesting());
+}
+
+TEST(IOBufferPoolTest, BuffersAreUsableAfterPoolReleased) {
+  scoped_refptr<IOBufferPool> pool(new IOBufferPool());
+  scoped_refptr<IOBufferWithSize> buffer = pool->Allocate(1024);
+  pool = NULL;  // The buffer keeps the pool alive.
+  memset(buffer->data(), 'a', 1024);
+  EXPECT_EQ('a', buffer->data()[1023]);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,70 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer.h"
+
+#include <string.h>
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(GrowableIOBufferTest, SmallCapacityIsStoredInline) {
+  scoped_refptr<GrowableIOBuffer> buffer(new GrowableIOBuffer());
+
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity);
+  EXPECT_EQ(GrowableIOBuffer::kInlineCapacity, buffer->capacity());
+
+  // Growing within the inline capacity must not move the data.
+  const std::string kData("hello");
+  memcpy(buffer->StartOfBuffer(), kData.data(), kData.size());
+  char* start_of_buffer = buffer->StartOfBuffer();
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity / 2);
+  EXPECT_EQ(start_of_buffer, buffer->StartOfBuffer());
+  EXPECT_EQ(kData, std::string(buffer->StartOfBuffer(), kData.size()));
+}
+
+TEST(GrowableIOBufferTest, DataSurvivesInlineToHeapTransitions) {
+  scoped_refptr<GrowableIOBuffer> buffer(new GrowableIOBuffer());
+
+  const std::string kData("some test data");
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity);
+  memcpy(buffer->StartOfBuffer(), kData.data(), kData.size());
+  buffer->set_offset(kData.size());
+
+  // Inline to heap.
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity * 16);
+  EXPECT_EQ(GrowableIOBuffer::kInlineCapacity * 16, buffer->capacity());
+  EXPECT_EQ(kData, std::string(buffer->StartOfBuffer(), kData.size()));
+  EXPECT_EQ(static_cast<int>(kData.size()), buffer->offset());
+
+  // Heap back to inline.
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity);
+  EXPECT_EQ(GrowableIOBuffer::kInlineCapacity, buffer->capacity());
+  EXPECT_EQ(kData, std::string(buffer->StartOfBuffer(), kData.size()));
+  EXPECT_EQ(static_cast<int>(kData.size()), buffer->offset());
+}
+
+TEST(GrowableIOBufferTest, ShrinkToFit) {
+  scoped_refptr<GrowableIOBuffer> buffer(new GrowableIOBuffer());
+
+  const std::string kData("headers done");
+  buffer->SetCapacity(GrowableIOBuffer::kInlineCapacity * 16);
+  memcpy(buffer->StartOfBuffer(), kData.data(), kData.size());
+  buffer->set_offset(kData.size());
+
+  buffer->ShrinkToFit();
+  EXPECT_EQ(static_cast<int>(kData.size()), buffer->capacity());
+  EXPECT_EQ(static_cast<int>(kData.size()), buffer->offset());
+  EXPECT_EQ(0, buffer->RemainingCapacity());
+  EXPECT_EQ(kData, std::string(buffer->StartOfBuffer(), kData.size()));
+}
+
+}  // namespace
+
+}  // namespace net
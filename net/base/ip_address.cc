@@ -4,40 +4,46 @@
 
 #include "net/base/ip_address.h"
 
+#include <string.h>
+
+#include "base/logging.h"
 #include "net/base/ip_address_number.h"
 #include "url/gurl.h"
 #include "url/url_canon_ip.h"
 
 namespace net {
 
-const size_t IPAddress::kIPv4AddressSize = 4;
-const size_t IPAddress::kIPv6AddressSize = 16;
+const size_t IPAddress::kIPv4AddressSize;
+const size_t IPAddress::kIPv6AddressSize;
 
-IPAddress::IPAddress() {}
+IPAddress::IPAddress() : size_(0) {}
 
 IPAddress::~IPAddress() {}
 
 IPAddress::IPAddress(const uint8_t* address, size_t address_len)
-    : ip_address_(address, address + address_len) {}
+    : size_(address_len) {
+  CHECK_LE(address_len, kIPv6AddressSize);
+  memcpy(bytes_, address, address_len);
+}
 
 bool IPAddress::IsIPv4() const {
-  return ip_address_.size() == kIPv4AddressSize;
+  return size_ == kIPv4AddressSize;
 }
 
 bool IPAddress::IsIPv6() const {
-  return ip_address_.size() == kIPv6AddressSize;
+  return size_ == kIPv6AddressSize;
 }
 
 bool IPAddress::IsReserved() const {
-  return IsIPAddressReserved(ip_address_);
+  return IsIPAddressReserved(bytes());
 }
 
 bool IPAddress::IsIPv4Mapped() const {
-  return net::IsIPv4Mapped(ip_address_);
+  return net::IsIPv4Mapped(bytes());
 }
 
 std::string IPAddress::ToString() const {
-  return IPAddressToString(ip_address_);
+  return IPAddressToString(bytes_, size_);
 }
 
 // static
@@ -47,21 +53,20 @@ bool IPAddress::FromIPLiteral(const base::StringPiece& ip_literal,
   if (!ParseIPLiteralToNumber(ip_literal, &number))
     return false;
 
-  std::swap(number, ip_address->ip_address_);
+  *ip_address = IPAddress(number.data(), number.size());
   return true;
 }
 
 bool IPAddress::operator==(const IPAddress& that) const {
-  return ip_address_ == that.ip_address_;
+  return size_ == that.size_ && memcmp(bytes_, that.bytes_, size_) == 0;
 }
 
 bool IPAddress::operator<(const IPAddress& that) const {
   // Sort IPv4 before IPv6.
-  if (ip_address_.size() != that.ip_address_.size()) {
-    return ip_address_.size() < that.ip_address_.size();
-  }
+  if (size_ != that.size_)
+    return size_ < that.size_;
 
-  return ip_address_ < that.ip_address_;
+  return memcmp(bytes_, that.bytes_, size_) < 0;
 }
 
 }  // namespace net
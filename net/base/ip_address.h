@@ -16,14 +16,15 @@ namespace net {
 
 class NET_EXPORT IPAddress {
  public:
-  static const size_t kIPv4AddressSize;
-  static const size_t kIPv6AddressSize;
+  static const size_t kIPv4AddressSize = 4;
+  static const size_t kIPv6AddressSize = 16;
 
   // Creates a zero-sized, invalid address.
   IPAddress();
 
-  // Copies the input address to |ip_address_|. The input is expected to be in
-  // network byte order.
+  // Copies the input address into the inline storage. The input is expected
+  // to be in network byte order, and |address_len| must be at most
+  // kIPv6AddressSize.
   IPAddress(const uint8_t* address, size_t address_len);
   ~IPAddress();
 
@@ -41,8 +42,9 @@ class NET_EXPORT IPAddress {
   // Returns true if |ip_address_| is an IPv4-mapped IPv6 address.
   bool IsIPv4Mapped() const;
 
-  // The size in bytes of |ip_address_|.
-  size_t size() const { return ip_address_.size(); }
+  // The size in bytes of the address: kIPv4AddressSize, kIPv6AddressSize or
+  // 0 for an invalid address.  This doubles as the family tag.
+  size_t size() const { return size_; }
 
   // Returns the canonical string representation of an IP address.
   // For example: "192.168.0.1" or "::1". The IP address must be
@@ -54,16 +56,28 @@ class NET_EXPORT IPAddress {
   static bool FromIPLiteral(const base::StringPiece& ip_literal,
                             IPAddress* ip_address) WARN_UNUSED_RESULT;
 
-  // Returns the underlying byte vector.
-  const std::vector<uint8_t>& bytes() const { return ip_address_; };
+  // The raw address bytes, in network byte order; only the first size()
+  // bytes are meaningful.
+  const uint8_t* data() const { return bytes_; }
+
+  // Conversion shim for code that still works in IPAddressNumber terms.
+  // Returns a copy of the address bytes; prefer data()/size() in new code.
+  std::vector<uint8_t> bytes() const {
+    return std::vector<uint8_t>(bytes_, bytes_ + size_);
+  }
 
   bool operator==(const IPAddress& that) const;
   bool operator<(const IPAddress& that) const;
 
  private:
+  // The address is stored inline rather than on the heap: IP addresses are
+  // copied liberally through endpoint and sorting code, and a 16-byte array
+  // keeps each copy allocation-free.
+  uint8_t bytes_[kIPv6AddressSize];
+
   // IPv4 addresses will have length kIPv4AddressSize, whereas IPv6 address
   // will have length kIPv6AddressSize.
-  std::vector<uint8_t> ip_address_;
+  size_t size_;
 };
 
 }  // namespace net
@@ -4,6 +4,9 @@
 
 #include "net/base/ip_address_number.h"
 
+#include <stdint.h>
+#include <string.h>
+
 #include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
@@ -39,6 +42,173 @@ bool IPNumberPrefixCheck(const IPAddressNumber& ip_number,
   return true;
 }
 
+// Parses [|begin|, |end|) as one component of an IPv4 literal. Components
+// may be decimal, octal (leading zero) or hexadecimal ("0x" prefix),
+// matching the forms the URL canonicalizer accepts. Returns false on a
+// malformed component or one that overflows 32 bits.
+bool ParseIPv4Component(const char* begin, const char* end, uint32_t* value) {
+  int base = 10;
+  if (end - begin >= 2 && begin[0] == '0' &&
+      (begin[1] == 'x' || begin[1] == 'X')) {
+    base = 16;
+    begin += 2;
+  } else if (begin != end && begin[0] == '0') {
+    base = 8;
+  }
+
+  // An empty component after a hex prefix ("0x") is zero.
+  uint64_t result = 0;
+  for (const char* p = begin; p != end; ++p) {
+    if (!base::IsHexDigit(*p))
+      return false;
+    int digit = base::HexDigitToInt(*p);
+    if (digit >= base)
+      return false;
+    result = result * base + digit;
+    if (result > 0xFFFFFFFFu)
+      return false;
+  }
+  *value = static_cast<uint32_t>(result);
+  return true;
+}
+
+// Parses [|begin|, |end|) as an IPv4 literal in a single pass, writing the
+// four bytes to |address|. As with the URL canonicalizer, fewer than four
+// components are allowed, in which case the last component fills all the
+// remaining low-order bytes (e.g. "192.168.1" is 192.168.0.1), and a single
+// trailing dot is ignored.
+bool ParseIPv4Literal(const char* begin,
+                      const char* end,
+                      unsigned char* address) {
+  if (begin != end && end[-1] == '.')
+    --end;
+  if (begin == end)
+    return false;
+
+  uint32_t components[4];
+  size_t num_components = 0;
+  const char* component_begin = begin;
+  for (const char* p = begin;; ++p) {
+    if (p == end || *p == '.') {
+      if (p == component_begin || num_components == 4)
+        return false;
+      if (!ParseIPv4Component(component_begin, p,
+                              &components[num_components]))
+        return false;
+      ++num_components;
+      if (p == end)
+        break;
+      component_begin = p + 1;
+    }
+  }
+
+  // All but the last component must fit in one byte; the last fills the
+  // remaining low-order bytes.
+  for (size_t i = 0; i < num_components - 1; ++i) {
+    if (components[i] > 0xFF)
+      return false;
+    address[i] = static_cast<unsigned char>(components[i]);
+  }
+  size_t num_remaining = 4 - (num_components - 1);
+  uint32_t last = components[num_components - 1];
+  if (num_remaining < 4 && last >= (1u << (num_remaining * 8)))
+    return false;
+  for (size_t i = 4; i > num_components - 1; --i) {
+    address[i - 1] = static_cast<unsigned char>(last & 0xFF);
+    last >>= 8;
+  }
+  return true;
+}
+
+// Parses [|begin|, |end|) as an IPv6 literal in a single pass, writing the
+// sixteen bytes to |address|. Handles "::" compression and a trailing
+// embedded IPv4 literal (e.g. "::ffff:192.168.0.1").
+bool ParseIPv6Literal(const char* begin,
+                      const char* end,
+                      unsigned char* address) {
+  uint16_t groups[8];
+  int num_groups = 0;
+  int contraction = -1;  // Number of groups preceding the "::", or -1.
+  bool has_ipv4 = false;
+  unsigned char ipv4[4];
+
+  const char* p = begin;
+  // "::" may open the literal; a single leading colon is malformed.
+  if (p != end && *p == ':') {
+    if (end - p < 2 || p[1] != ':')
+      return false;
+    contraction = 0;
+    p += 2;
+  }
+
+  while (p != end) {
+    // Scan one group of up to four hex digits, or an embedded IPv4 literal
+    // if the group contains a dot.
+    const char* group_begin = p;
+    bool is_ipv4 = false;
+    while (p != end && *p != ':') {
+      if (*p == '.')
+        is_ipv4 = true;
+      ++p;
+    }
+
+    if (is_ipv4) {
+      // The embedded IPv4 literal must be the last component.
+      if (p != end)
+        return false;
+      if (!ParseIPv4Literal(group_begin, p, ipv4))
+        return false;
+      has_ipv4 = true;
+      break;
+    }
+
+    if (p == group_begin || p - group_begin > 4 || num_groups == 8)
+      return false;
+    uint16_t group = 0;
+    for (const char* digit = group_begin; digit != p; ++digit) {
+      if (!base::IsHexDigit(*digit))
+        return false;
+      group = group * 16 + base::HexDigitToInt(*digit);
+    }
+    groups[num_groups++] = group;
+
+    if (p == end)
+      break;
+    ++p;  // Skip over the ':' separator.
+    if (p == end)
+      return false;
+    if (*p == ':') {
+      // A second contraction is malformed.
+      if (contraction != -1)
+        return false;
+      contraction = num_groups;
+      ++p;
+    }
+  }
+
+  // Without a contraction the groups must fill the address exactly; with one
+  // it must stand for at least one zero group.
+  int total_groups = num_groups + (has_ipv4 ? 2 : 0);
+  if (contraction == -1 ? total_groups != 8 : total_groups >= 8)
+    return false;
+
+  unsigned char* out = address;
+  for (int i = 0; i <= num_groups; ++i) {
+    if (i == contraction) {
+      size_t zero_fill = 2 * (8 - total_groups);
+      memset(out, 0, zero_fill);
+      out += zero_fill;
+    }
+    if (i == num_groups)
+      break;
+    *out++ = static_cast<unsigned char>(groups[i] >> 8);
+    *out++ = static_cast<unsigned char>(groups[i] & 0xFF);
+  }
+  if (has_ipv4)
+    memcpy(out, ipv4, sizeof(ipv4));
+  return true;
+}
+
 }  // namespace
 
 // Don't compare IPv4 and IPv6 addresses (they have different range
@@ -160,26 +330,22 @@ bool ParseIPLiteralToNumber(const base::StringPiece& ip_literal,
                             IPAddressNumber* ip_number) {
   // |ip_literal| could be either a IPv4 or an IPv6 literal. If it contains
   // a colon however, it must be an IPv6 address.
+  const char* begin = ip_literal.data();
+  const char* end = begin + ip_literal.size();
   if (ip_literal.find(':') != base::StringPiece::npos) {
-    // GURL expects IPv6 hostnames to be surrounded with brackets.
-    std::string host_brackets = "[";
-    ip_literal.AppendToString(&host_brackets);
-    host_brackets.push_back(']');
-    url::Component host_comp(0, host_brackets.size());
-
-    // Try parsing the hostname as an IPv6 literal.
-    ip_number->resize(16);  // 128 bits.
-    return url::IPv6AddressToNumber(host_brackets.data(), host_comp,
-                                    &(*ip_number)[0]);
+    unsigned char address[kIPv6AddressSize];
+    if (!ParseIPv6Literal(begin, end, address))
+      return false;
+    ip_number->assign(address, address + kIPv6AddressSize);
+    return true;
   }
 
   // Otherwise the string is an IPv4 address.
-  ip_number->resize(4);  // 32 bits.
-  url::Component host_comp(0, ip_literal.size());
-  int num_components;
-  url::CanonHostInfo::Family family = url::IPv4AddressToNumber(
-      ip_literal.data(), host_comp, &(*ip_number)[0], &num_components);
-  return family == url::CanonHostInfo::IPV4;
+  unsigned char address[kIPv4AddressSize];
+  if (!ParseIPv4Literal(begin, end, address))
+    return false;
+  ip_number->assign(address, address + kIPv4AddressSize);
+  return true;
 }
 
 namespace {
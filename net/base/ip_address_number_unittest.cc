@@ -77,6 +77,51 @@ TEST(IpAddressNumberTest, ParseIPLiteralToNumber_IPv6) {
   EXPECT_EQ("1:abcd::3:4:ff", IPAddressToString(number));
 }
 
+// Test parsing the non-canonical IPv4 component forms that URL hosts allow:
+// shorthand, octal, hexadecimal, and a bare 32-bit value.
+TEST(IpAddressNumberTest, ParseIPLiteralToNumber_IPv4NonCanonical) {
+  IPAddressNumber number;
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("192.168.1", &number));
+  EXPECT_EQ("192,168,0,1", DumpIPNumber(number));
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("0177.0.0.01", &number));
+  EXPECT_EQ("127,0,0,1", DumpIPNumber(number));
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("0x7F.0.0.0x1", &number));
+  EXPECT_EQ("127,0,0,1", DumpIPNumber(number));
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("3232235521", &number));
+  EXPECT_EQ("192,168,0,1", DumpIPNumber(number));
+
+  EXPECT_FALSE(ParseIPLiteralToNumber("1.2.3.4.5", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("1.2.3.256", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("1..3.4", &number));
+}
+
+// Test parsing the remaining IPv6 literal forms: full grouping, a trailing
+// contraction, and an embedded IPv4 literal.
+TEST(IpAddressNumberTest, ParseIPLiteralToNumber_IPv6Forms) {
+  IPAddressNumber number;
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("::ffff:192.168.0.1", &number));
+  EXPECT_EQ("0,0,0,0,0,0,0,0,0,0,255,255,192,168,0,1", DumpIPNumber(number));
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("0:0:0:0:0:0:0:1", &number));
+  EXPECT_EQ("0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1", DumpIPNumber(number));
+
+  EXPECT_TRUE(ParseIPLiteralToNumber("1:2:3:4:5:6:7::", &number));
+  EXPECT_EQ("0,1,0,2,0,3,0,4,0,5,0,6,0,7,0,0", DumpIPNumber(number));
+
+  EXPECT_FALSE(ParseIPLiteralToNumber("1::2::3", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("12345::1", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("1:2:3:4:5:6:7:8:9", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("1:2:3:4:5:6:7:1.2.3.4", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber(":::", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber("1:", &number));
+  EXPECT_FALSE(ParseIPLiteralToNumber(":1", &number));
+}
+
 // Test mapping an IPv4 address to an IPv6 address.
 TEST(IpAddressNumberTest, ConvertIPv4NumberToIPv6Number) {
   IPAddressNumber ipv4_number;
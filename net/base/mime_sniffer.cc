@@ -98,6 +98,7 @@
 #include "net/base/mime_sniffer.h"
 
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/metrics/histogram.h"
 #include "base/strings/string_util.h"
 #include "url/gurl.h"
@@ -325,8 +326,12 @@ static bool MagicMaskCmp(const char* magic_entry,
   return true;
 }
 
+// |content_strlen| is the length of |content| up to its first '\0' byte, if
+// any; see ContentStrlen().  It is passed in so callers that try many magic
+// entries against the same content only compute it once.
 static bool MatchMagicNumber(const char* content,
                              size_t size,
+                             size_t content_strlen,
                              const MagicNumber& magic_entry,
                              std::string* result) {
   const size_t len = magic_entry.magic_len;
@@ -334,13 +339,6 @@ static bool MatchMagicNumber(const char* content,
   // Keep kBytesRequiredForMagic honest.
   DCHECK_LE(len, kBytesRequiredForMagic);
 
-  // To compare with magic strings, we need to compute strlen(content), but
-  // content might not actually have a null terminator.  In that case, we
-  // pretend the length is content_size.
-  const char* end = static_cast<const char*>(memchr(content, '\0', size));
-  const size_t content_strlen =
-      (end != NULL) ? static_cast<size_t>(end - content) : size;
-
   bool match = false;
   if (magic_entry.is_string) {
     if (content_strlen >= len) {
@@ -366,12 +364,21 @@ static bool MatchMagicNumber(const char* content,
   return false;
 }
 
+// To compare with magic strings, we need to compute strlen(content), but
+// content might not actually have a null terminator.  In that case, we
+// pretend the length is content_size.
+static size_t ContentStrlen(const char* content, size_t size) {
+  const char* end = static_cast<const char*>(memchr(content, '\0', size));
+  return (end != NULL) ? static_cast<size_t>(end - content) : size;
+}
+
 static bool CheckForMagicNumbers(const char* content, size_t size,
                                  const MagicNumber* magic, size_t magic_len,
                                  base::HistogramBase* counter,
                                  std::string* result) {
+  const size_t content_strlen = ContentStrlen(content, size);
   for (size_t i = 0; i < magic_len; ++i) {
-    if (MatchMagicNumber(content, size, magic[i], result)) {
+    if (MatchMagicNumber(content, size, content_strlen, magic[i], result)) {
       if (counter) counter->Add(static_cast<int>(i));
       return true;
     }
@@ -379,6 +386,74 @@ static bool CheckForMagicNumbers(const char* content, size_t size,
   return false;
 }
 
+// A first-byte-dispatched view of a MagicNumber table.  For each possible
+// value of the first content byte it precomputes a bitmask of the entries
+// whose magic could begin with that byte, so checking content that matches
+// nothing (e.g. JSON, plain text) costs a single table load, and content that
+// does match only runs the candidate comparisons.  Entries are still tried in
+// table order, so first-match-wins semantics and histogram indices are
+// unchanged.
+class MagicNumberIndex {
+ public:
+  MagicNumberIndex(const MagicNumber* magic, size_t magic_len)
+      : magic_(magic), magic_len_(magic_len) {
+    // Each entry occupies one bit of the per-byte candidate masks.
+    CHECK_LE(magic_len, 32u);
+    memset(candidates_, 0, sizeof(candidates_));
+    for (size_t i = 0; i < magic_len; ++i) {
+      const MagicNumber& entry = magic[i];
+      const uint32_t bit = 1u << i;
+      const char first = entry.magic[0];
+      if (!entry.is_string && first == '.') {
+        // Leading wildcard: candidate for every first byte.
+        for (int value = 0; value < 256; ++value)
+          candidates_[value] |= bit;
+      } else if (entry.is_string) {
+        // Magic strings match case-insensitively.
+        candidates_[static_cast<uint8_t>(base::ToLowerASCII(first))] |= bit;
+        candidates_[static_cast<uint8_t>(base::ToUpperASCII(first))] |= bit;
+      } else if (entry.mask) {
+        const char mask = entry.mask[0];
+        for (int value = 0; value < 256; ++value) {
+          if ((static_cast<char>(value) & mask) == first)
+            candidates_[value] |= bit;
+        }
+      } else {
+        candidates_[static_cast<uint8_t>(first)] |= bit;
+      }
+    }
+  }
+
+  // Equivalent to CheckForMagicNumbers() over the wrapped table.
+  bool Check(const char* content,
+             size_t size,
+             base::HistogramBase* counter,
+             std::string* result) const {
+    if (size == 0)
+      return false;
+    const uint32_t bits = candidates_[static_cast<uint8_t>(content[0])];
+    if (bits == 0)
+      return false;
+    const size_t content_strlen = ContentStrlen(content, size);
+    for (size_t i = 0; i < magic_len_; ++i) {
+      if (!(bits & (1u << i)))
+        continue;
+      if (MatchMagicNumber(content, size, content_strlen, magic_[i], result)) {
+        if (counter) counter->Add(static_cast<int>(i));
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const MagicNumber* const magic_;
+  const size_t magic_len_;
+  uint32_t candidates_[256];
+
+  DISALLOW_COPY_AND_ASSIGN(MagicNumberIndex);
+};
+
 // Truncates |size| to |max_size| and returns true if |size| is at least
 // |max_size|.
 static bool TruncateSize(const size_t max_size, size_t* size) {
@@ -415,10 +490,11 @@ static bool SniffForHTML(const char* content,
     counter = UMASnifferHistogramGet("mime_sniffer.kSniffableTags2",
                                      arraysize(kSniffableTags));
   }
+  static MagicNumberIndex* index(NULL);
+  if (!index)
+    index = new MagicNumberIndex(kSniffableTags, arraysize(kSniffableTags));
   // |pos| now points to first non-whitespace character (or at end).
-  return CheckForMagicNumbers(pos, end - pos,
-                              kSniffableTags, arraysize(kSniffableTags),
-                              counter, result);
+  return index->Check(pos, end - pos, counter, result);
 }
 
 // Returns true and sets result if the content matches any of kMagicNumbers.
@@ -435,9 +511,10 @@ static bool SniffForMagicNumbers(const char* content,
     counter = UMASnifferHistogramGet("mime_sniffer.kMagicNumbers2",
                                      arraysize(kMagicNumbers));
   }
-  return CheckForMagicNumbers(content, size,
-                              kMagicNumbers, arraysize(kMagicNumbers),
-                              counter, result);
+  static MagicNumberIndex* index(NULL);
+  if (!index)
+    index = new MagicNumberIndex(kMagicNumbers, arraysize(kMagicNumbers));
+  return index->Check(content, size, counter, result);
 }
 
 // Returns true and sets result if the content matches any of
@@ -937,13 +1014,20 @@ bool SniffMimeType(const char* content,
 bool SniffMimeTypeFromLocalData(const char* content,
                                 size_t size,
                                 std::string* result) {
+  static MagicNumberIndex* extra_index(NULL);
+  if (!extra_index) {
+    extra_index =
+        new MagicNumberIndex(kExtraMagicNumbers, arraysize(kExtraMagicNumbers));
+  }
+  static MagicNumberIndex* index(NULL);
+  if (!index)
+    index = new MagicNumberIndex(kMagicNumbers, arraysize(kMagicNumbers));
+
   // First check the extra table.
-  if (CheckForMagicNumbers(content, size, kExtraMagicNumbers,
-                           arraysize(kExtraMagicNumbers), NULL, result))
+  if (extra_index->Check(content, size, NULL, result))
     return true;
   // Finally check the original table.
-  return CheckForMagicNumbers(content, size, kMagicNumbers,
-                              arraysize(kMagicNumbers), NULL, result);
+  return index->Check(content, size, NULL, result);
 }
 
 bool LooksLikeBinary(const char* content, size_t size) {
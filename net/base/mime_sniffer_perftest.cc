@@ -9,6 +9,7 @@
 #include "base/bits.h"
 #include "base/logging.h"
 #include "base/timer/elapsed_timer.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -98,9 +99,13 @@ TEST(MimeSnifferTest, PlainTextPerfTest) {
   RunLooksLikeBinary(plaintext, kWarmupIterations);
   base::ElapsedTimer elapsed_timer;
   RunLooksLikeBinary(plaintext, kMeasuredIterations);
-  LOG(INFO) << (elapsed_timer.Elapsed().InMicroseconds() * 1000 * 1024 /
-                (static_cast<int64_t>(plaintext.size()) * kMeasuredIterations))
-            << "ns per KB";
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+  test::BenchmarkReporter reporter("Mime_sniffer_plain_text");
+  reporter.set_wall_time(elapsed);
+  reporter.set_iterations(kMeasuredIterations);
+  reporter.SetThroughput(
+      "KB", plaintext.size() * kMeasuredIterations / 1024.0 /
+                elapsed.InSecondsF());
 }
 
 }  // namespace net
@@ -0,0 +1,99 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_allocation_tracker.h"
+
+#include "base/logging.h"
+#include "base/values.h"
+
+namespace net {
+
+// static
+base::subtle::AtomicWord
+    NetAllocationTracker::counts_[NetAllocationTracker::NUM_ALLOC_SITES];
+
+// static
+base::subtle::AtomicWord NetAllocationTracker::completed_requests_;
+
+// static
+void NetAllocationTracker::RecordAllocation(AllocationSite site) {
+  DCHECK_GE(site, 0);
+  DCHECK_LT(site, NUM_ALLOC_SITES);
+  base::subtle::NoBarrier_AtomicIncrement(&counts_[site], 1);
+}
+
+// static
+void NetAllocationTracker::OnRequestCompleted() {
+  base::subtle::NoBarrier_AtomicIncrement(&completed_requests_, 1);
+}
+
+// static
+int64 NetAllocationTracker::GetAllocationCount(AllocationSite site) {
+  DCHECK_GE(site, 0);
+  DCHECK_LT(site, NUM_ALLOC_SITES);
+  return base::subtle::NoBarrier_Load(&counts_[site]);
+}
+
+// static
+int64 NetAllocationTracker::GetCompletedRequestCount() {
+  return base::subtle::NoBarrier_Load(&completed_requests_);
+}
+
+// static
+double NetAllocationTracker::AllocationsPerRequest() {
+  int64 requests = GetCompletedRequestCount();
+  if (requests == 0)
+    return 0;
+  int64 total = 0;
+  for (int i = 0; i < NUM_ALLOC_SITES; ++i)
+    total += GetAllocationCount(static_cast<AllocationSite>(i));
+  return static_cast<double>(total) / requests;
+}
+
+// static
+bool NetAllocationTracker::ExceedsBudget(double budget) {
+  return AllocationsPerRequest() > budget;
+}
+
+// static
+const char* NetAllocationTracker::AllocationSiteName(AllocationSite site) {
+  switch (site) {
+    case ALLOC_SITE_IO_BUFFER:
+      return "io_buffer";
+    case ALLOC_SITE_SPDY_BUFFER:
+      return "spdy_buffer";
+    case ALLOC_SITE_RESPONSE_HEADERS:
+      return "response_headers";
+    case ALLOC_SITE_CANONICAL_COOKIE:
+      return "canonical_cookie";
+    case NUM_ALLOC_SITES:
+      break;
+  }
+  NOTREACHED();
+  return "";
+}
+
+// static
+scoped_ptr<base::Value> NetAllocationTracker::ToValue() {
+  scoped_ptr<base::DictionaryValue> dict(new base::DictionaryValue());
+  for (int i = 0; i < NUM_ALLOC_SITES; ++i) {
+    AllocationSite site = static_cast<AllocationSite>(i);
+    // Stored as double; counts are well below 2^53 so this is exact.
+    dict->SetDouble(AllocationSiteName(site),
+                    static_cast<double>(GetAllocationCount(site)));
+  }
+  dict->SetDouble("completed_requests",
+                  static_cast<double>(GetCompletedRequestCount()));
+  dict->SetDouble("allocations_per_request", AllocationsPerRequest());
+  return dict.Pass();
+}
+
+// static
+void NetAllocationTracker::ResetForTesting() {
+  for (int i = 0; i < NUM_ALLOC_SITES; ++i)
+    base::subtle::NoBarrier_Store(&counts_[i], 0);
+  base::subtle::NoBarrier_Store(&completed_requests_, 0);
+}
+
+}  // namespace net
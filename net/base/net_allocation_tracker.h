@@ -0,0 +1,87 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_NET_ALLOCATION_TRACKER_H_
+#define NET_BASE_NET_ALLOCATION_TRACKER_H_
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class Value;
+}
+
+namespace net {
+
+// Process-wide counters of hot-path object allocations on the IO thread,
+// used to catch per-request allocations sneaking into the request path.
+// The tracked constructors call RecordAllocation() through the
+// NET_TRACK_ALLOCATION() macro below, which compiles to nothing unless the
+// build defines ENABLE_NET_ALLOCATION_TRACKING, so shipping builds pay
+// nothing.  URLRequest reports completions so counts can be normalized to
+// allocations per completed request.
+//
+// All methods are static and thread safe; counters are only ever
+// incremented, so concurrent snapshots may be slightly stale but never
+// torn.
+class NET_EXPORT NetAllocationTracker {
+ public:
+  enum AllocationSite {
+    ALLOC_SITE_IO_BUFFER,
+    ALLOC_SITE_SPDY_BUFFER,
+    ALLOC_SITE_RESPONSE_HEADERS,
+    ALLOC_SITE_CANONICAL_COOKIE,
+    NUM_ALLOC_SITES
+  };
+
+  // Records one allocation at |site|.
+  static void RecordAllocation(AllocationSite site);
+
+  // Records that a URLRequest ran to completion.
+  static void OnRequestCompleted();
+
+  static int64 GetAllocationCount(AllocationSite site);
+  static int64 GetCompletedRequestCount();
+
+  // Total allocations across all sites divided by completed requests.
+  // Returns 0 if no request has completed yet.
+  static double AllocationsPerRequest();
+
+  // Returns true if AllocationsPerRequest() exceeds |budget|.  Perf tests
+  // assert this stays false for their chosen budget.
+  static bool ExceedsBudget(double budget);
+
+  // Returns the site name used as the key in ToValue(), e.g. "io_buffer".
+  static const char* AllocationSiteName(AllocationSite site);
+
+  // Returns a dictionary with one entry per site plus "completed_requests"
+  // and "allocations_per_request", for the HttpNetworkSession counter
+  // surface.
+  static scoped_ptr<base::Value> ToValue();
+
+  // Zeroes all counters so a test can measure a single scenario.
+  static void ResetForTesting();
+
+ private:
+  static base::subtle::AtomicWord counts_[NUM_ALLOC_SITES];
+  static base::subtle::AtomicWord completed_requests_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(NetAllocationTracker);
+};
+
+}  // namespace net
+
+#if defined(ENABLE_NET_ALLOCATION_TRACKING)
+#define NET_TRACK_ALLOCATION(site) \
+  net::NetAllocationTracker::RecordAllocation(net::NetAllocationTracker::site)
+#define NET_TRACK_REQUEST_COMPLETED() \
+  net::NetAllocationTracker::OnRequestCompleted()
+#else
+#define NET_TRACK_ALLOCATION(site)
+#define NET_TRACK_REQUEST_COMPLETED()
+#endif
+
+#endif  // NET_BASE_NET_ALLOCATION_TRACKER_H_
@@ -0,0 +1,75 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_allocation_tracker.h"
+
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class NetAllocationTrackerTest : public testing::Test {
+ public:
+  NetAllocationTrackerTest() { NetAllocationTracker::ResetForTesting(); }
+  ~NetAllocationTrackerTest() override {
+    NetAllocationTracker::ResetForTesting();
+  }
+};
+
+TEST_F(NetAllocationTrackerTest, RecordsPerSite) {
+  NetAllocationTracker::RecordAllocation(
+      NetAllocationTracker::ALLOC_SITE_IO_BUFFER);
+  NetAllocationTracker::RecordAllocation(
+      NetAllocationTracker::ALLOC_SITE_IO_BUFFER);
+  NetAllocationTracker::RecordAllocation(
+      NetAllocationTracker::ALLOC_SITE_RESPONSE_HEADERS);
+
+  EXPECT_EQ(2, NetAllocationTracker::GetAllocationCount(
+                   NetAllocationTracker::ALLOC_SITE_IO_BUFFER));
+  EXPECT_EQ(1, NetAllocationTracker::GetAllocationCount(
+                   NetAllocationTracker::ALLOC_SITE_RESPONSE_HEADERS));
+  EXPECT_EQ(0, NetAllocationTracker::GetAllocationCount(
+                   NetAllocationTracker::ALLOC_SITE_SPDY_BUFFER));
+}
+
+TEST_F(NetAllocationTrackerTest, AllocationsPerRequestAndBudget) {
+  // No completed requests yet; the ratio must not divide by zero.
+  EXPECT_EQ(0, NetAllocationTracker::AllocationsPerRequest());
+
+  for (int i = 0; i < 6; ++i) {
+    NetAllocationTracker::RecordAllocation(
+        NetAllocationTracker::ALLOC_SITE_SPDY_BUFFER);
+  }
+  NetAllocationTracker::OnRequestCompleted();
+  NetAllocationTracker::OnRequestCompleted();
+
+  EXPECT_EQ(3, NetAllocationTracker::AllocationsPerRequest());
+  EXPECT_FALSE(NetAllocationTracker::ExceedsBudget(3));
+  EXPECT_TRUE(NetAllocationTracker::ExceedsBudget(2.5));
+}
+
+TEST_F(NetAllocationTrackerTest, ToValueContainsAllSites) {
+  NetAllocationTracker::RecordAllocation(
+      NetAllocationTracker::ALLOC_SITE_CANONICAL_COOKIE);
+  NetAllocationTracker::OnRequestCompleted();
+
+  scoped_ptr<base::Value> value(NetAllocationTracker::ToValue());
+  const base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(value->GetAsDictionary(&dict));
+  EXPECT_EQ(static_cast<size_t>(NetAllocationTracker::NUM_ALLOC_SITES) + 2,
+            dict->size());
+
+  double cookies = 0;
+  ASSERT_TRUE(dict->GetDouble("canonical_cookie", &cookies));
+  EXPECT_EQ(1, cookies);
+  double per_request = 0;
+  ASSERT_TRUE(dict->GetDouble("allocations_per_request", &per_request));
+  EXPECT_EQ(1, per_request);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -937,6 +937,19 @@ void NetworkChangeNotifier::NotifyObserversOfMaxBandwidthChangeForTests(
   }
 }
 
+// static
+void NetworkChangeNotifier::SetIPAddressDebounceWindow(base::TimeDelta window) {
+  if (g_network_change_notifier)
+    g_network_change_notifier->ip_address_debounce_window_ = window;
+}
+
+// static
+void NetworkChangeNotifier::SetNetworkChangeDebounceWindow(
+    base::TimeDelta window) {
+  if (g_network_change_notifier)
+    g_network_change_notifier->network_change_debounce_window_ = window;
+}
+
 // static
 void NetworkChangeNotifier::SetTestNotificationsOnly(bool test_only) {
   DCHECK(!g_network_change_notifier);
@@ -965,7 +978,8 @@ NetworkChangeNotifier::NetworkChangeNotifier(
       network_observer_list_(new base::ObserverListThreadSafe<NetworkObserver>(
           base::ObserverListBase<NetworkObserver>::NOTIFY_EXISTING_ONLY)),
       network_state_(new NetworkState()),
-      network_change_calculator_(new NetworkChangeCalculator(params)) {
+      network_change_calculator_(new NetworkChangeCalculator(params)),
+      pending_network_change_type_(CONNECTION_NONE) {
   DCHECK(!g_network_change_notifier);
   g_network_change_notifier = this;
   network_change_calculator_->Init();
@@ -1098,6 +1112,18 @@ void NetworkChangeNotifier::SetInitialDnsConfig(const DnsConfig& config) {
 }
 
 void NetworkChangeNotifier::NotifyObserversOfIPAddressChangeImpl() {
+  if (ip_address_debounce_window_ > base::TimeDelta()) {
+    // (Re)starting the timer coalesces a burst of changes into a single
+    // notification once the signal has been quiet for the window.
+    ip_address_debounce_timer_.Start(
+        FROM_HERE, ip_address_debounce_window_, this,
+        &NetworkChangeNotifier::NotifyObserversOfIPAddressChangeNow);
+    return;
+  }
+  NotifyObserversOfIPAddressChangeNow();
+}
+
+void NetworkChangeNotifier::NotifyObserversOfIPAddressChangeNow() {
   ip_address_observer_list_->Notify(FROM_HERE,
                                     &IPAddressObserver::OnIPAddressChanged);
 }
@@ -1110,10 +1136,26 @@ void NetworkChangeNotifier::NotifyObserversOfConnectionTypeChangeImpl(
 
 void NetworkChangeNotifier::NotifyObserversOfNetworkChangeImpl(
     ConnectionType type) {
+  if (network_change_debounce_window_ > base::TimeDelta()) {
+    // Deliver only the final state of a burst: intermediate types (such as
+    // the offline signal emitted just before an online transition) are
+    // dropped when a newer state arrives within the window.
+    pending_network_change_type_ = type;
+    network_change_debounce_timer_.Start(
+        FROM_HERE, network_change_debounce_window_, this,
+        &NetworkChangeNotifier::NotifyObserversOfNetworkChangeNow);
+    return;
+  }
   network_change_observer_list_->Notify(
       FROM_HERE, &NetworkChangeObserver::OnNetworkChanged, type);
 }
 
+void NetworkChangeNotifier::NotifyObserversOfNetworkChangeNow() {
+  network_change_observer_list_->Notify(
+      FROM_HERE, &NetworkChangeObserver::OnNetworkChanged,
+      pending_network_change_type_);
+}
+
 void NetworkChangeNotifier::NotifyObserversOfDNSChangeImpl() {
   resolver_state_observer_list_->Notify(FROM_HERE, &DNSObserver::OnDNSChanged);
 }
@@ -11,6 +11,7 @@
 #include "base/macros.h"
 #include "base/observer_list_threadsafe.h"
 #include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "net/base/net_export.h"
 
 class GURL;
@@ -384,6 +385,19 @@ class NET_EXPORT NetworkChangeNotifier {
   static void RemoveMaxBandwidthObserver(MaxBandwidthObserver* observer);
   static void RemoveNetworkObserver(NetworkObserver* observer);
 
+  // Sets the coalescing window for fan-out to IPAddressObservers or
+  // NetworkChangeObservers. By default the window is zero and every change is
+  // delivered to observers immediately. With a non-zero window, changes
+  // arriving within the window are combined: observers are notified once,
+  // after the signal has been quiet for the window's duration, and network
+  // change observers see only the final connection type of the burst. This
+  // keeps a flapping network from repeatedly tearing down socket pools, host
+  // caches and QUIC sessions; each subsystem pays its reconfiguration cost
+  // once per stable transition. Must be called on the thread that produces
+  // the change signals. Does nothing if Create() has not been called.
+  static void SetIPAddressDebounceWindow(base::TimeDelta window);
+  static void SetNetworkChangeDebounceWindow(base::TimeDelta window);
+
   // Allow unit tests to trigger notifications.
   static void NotifyObserversOfIPAddressChangeForTests();
   static void NotifyObserversOfConnectionTypeChangeForTests(
@@ -525,6 +539,9 @@ class NET_EXPORT NetworkChangeNotifier {
   class NetworkChangeCalculator;
 
   void NotifyObserversOfIPAddressChangeImpl();
+  // Fans out to the observer lists immediately, bypassing any debouncing.
+  void NotifyObserversOfIPAddressChangeNow();
+  void NotifyObserversOfNetworkChangeNow();
   void NotifyObserversOfConnectionTypeChangeImpl(ConnectionType type);
   void NotifyObserversOfDNSChangeImpl();
   void NotifyObserversOfInitialDNSConfigReadImpl();
@@ -556,6 +573,16 @@ class NET_EXPORT NetworkChangeNotifier {
   // Computes NetworkChange signal from IPAddress and ConnectionType signals.
   scoped_ptr<NetworkChangeCalculator> network_change_calculator_;
 
+  // Debounce state, see SetIPAddressDebounceWindow(). Only accessed on the
+  // thread that produces the change signals.
+  base::TimeDelta ip_address_debounce_window_;
+  base::TimeDelta network_change_debounce_window_;
+  base::OneShotTimer ip_address_debounce_timer_;
+  base::OneShotTimer network_change_debounce_timer_;
+  // Final connection type to deliver when |network_change_debounce_timer_|
+  // fires.
+  ConnectionType pending_network_change_type_;
+
   // Set true to disable non-test notifications (to prevent flakes in tests).
   static bool test_notifications_only_;
 
@@ -4,6 +4,9 @@
 
 #include "net/base/network_change_notifier.h"
 
+#include "base/callback.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/run_loop.h"
 #include "net/base/network_interfaces.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -123,4 +126,102 @@ TEST(NetworkChangeNotifierTest, IgnoreVMInterfaces) {
             NetworkChangeNotifier::ConnectionTypeFromInterfaceList(list));
 }
 
+namespace {
+
+// Counts notifications and quits the current run loop on each one.
+class CountingObserver : public NetworkChangeNotifier::IPAddressObserver,
+                         public NetworkChangeNotifier::NetworkChangeObserver {
+ public:
+  CountingObserver()
+      : num_notifications_(0),
+        last_type_(NetworkChangeNotifier::CONNECTION_NONE) {}
+
+  void OnIPAddressChanged() override {
+    num_notifications_++;
+    if (!quit_closure_.is_null())
+      quit_closure_.Run();
+  }
+
+  void OnNetworkChanged(
+      NetworkChangeNotifier::ConnectionType type) override {
+    num_notifications_++;
+    last_type_ = type;
+    if (!quit_closure_.is_null())
+      quit_closure_.Run();
+  }
+
+  void set_quit_closure(const base::Closure& quit_closure) {
+    quit_closure_ = quit_closure;
+  }
+
+  int num_notifications() const { return num_notifications_; }
+  NetworkChangeNotifier::ConnectionType last_type() const {
+    return last_type_;
+  }
+
+ private:
+  int num_notifications_;
+  NetworkChangeNotifier::ConnectionType last_type_;
+  base::Closure quit_closure_;
+};
+
+// Replaces the test suite's notifier with one local to the test, so the
+// debounce windows configured here don't leak into other tests.
+class NetworkChangeNotifierDebounceTest : public testing::Test {
+ public:
+  NetworkChangeNotifierDebounceTest()
+      : notifier_(NetworkChangeNotifier::CreateMock()) {}
+
+ private:
+  NetworkChangeNotifier::DisableForTest disable_for_test_;
+  scoped_ptr<NetworkChangeNotifier> notifier_;
+};
+
+}  // namespace
+
+TEST_F(NetworkChangeNotifierDebounceTest, DebouncesIPAddressChanges) {
+  NetworkChangeNotifier::SetIPAddressDebounceWindow(
+      base::TimeDelta::FromMilliseconds(1));
+  CountingObserver observer;
+  NetworkChangeNotifier::AddIPAddressObserver(&observer);
+
+  // A burst of changes produces a single notification.
+  NetworkChangeNotifier::NotifyObserversOfIPAddressChangeForTests();
+  NetworkChangeNotifier::NotifyObserversOfIPAddressChangeForTests();
+  NetworkChangeNotifier::NotifyObserversOfIPAddressChangeForTests();
+
+  base::RunLoop run_loop;
+  observer.set_quit_closure(run_loop.QuitClosure());
+  run_loop.Run();
+  observer.set_quit_closure(base::Closure());
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(1, observer.num_notifications());
+  NetworkChangeNotifier::RemoveIPAddressObserver(&observer);
+}
+
+TEST_F(NetworkChangeNotifierDebounceTest, DeliversFinalNetworkChangeState) {
+  NetworkChangeNotifier::SetNetworkChangeDebounceWindow(
+      base::TimeDelta::FromMilliseconds(1));
+  CountingObserver observer;
+  NetworkChangeNotifier::AddNetworkChangeObserver(&observer);
+
+  // The offline signal preceding an online transition is dropped; only the
+  // final state is delivered.
+  NetworkChangeNotifier::NotifyObserversOfNetworkChangeForTests(
+      NetworkChangeNotifier::CONNECTION_NONE);
+  NetworkChangeNotifier::NotifyObserversOfNetworkChangeForTests(
+      NetworkChangeNotifier::CONNECTION_WIFI);
+
+  base::RunLoop run_loop;
+  observer.set_quit_closure(run_loop.QuitClosure());
+  run_loop.Run();
+  observer.set_quit_closure(base::Closure());
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(1, observer.num_notifications());
+  EXPECT_EQ(NetworkChangeNotifier::CONNECTION_WIFI, observer.last_type());
+  NetworkChangeNotifier::RemoveNetworkChangeObserver(&observer);
+}
+
 }  // namespace net
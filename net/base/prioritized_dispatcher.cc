@@ -4,7 +4,10 @@
 
 #include "net/base/prioritized_dispatcher.h"
 
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/single_thread_task_runner.h"
 
 namespace net {
 
@@ -17,11 +20,25 @@ PrioritizedDispatcher::Limits::~Limits() {}
 PrioritizedDispatcher::PrioritizedDispatcher(const Limits& limits)
     : queue_(limits.reserved_slots.size()),
       max_running_jobs_(limits.reserved_slots.size()),
-      num_running_jobs_(0) {
+      num_running_jobs_(0),
+      queued_counts_(limits.reserved_slots.size()),
+      starvation_counts_(limits.reserved_slots.size()),
+      posted_jobs_head_(0),
+      weak_factory_(this) {
   SetLimits(limits);
 }
 
-PrioritizedDispatcher::~PrioritizedDispatcher() {}
+PrioritizedDispatcher::~PrioritizedDispatcher() {
+  // Free submissions that were never drained. The jobs themselves are not
+  // owned by the dispatcher and are never started.
+  PostedJob* posted = reinterpret_cast<PostedJob*>(
+      base::subtle::NoBarrier_AtomicExchange(&posted_jobs_head_, 0));
+  while (posted) {
+    PostedJob* next = posted->next;
+    delete posted;
+    posted = next;
+  }
+}
 
 PrioritizedDispatcher::Handle PrioritizedDispatcher::Add(
     Job* job, Priority priority) {
@@ -29,9 +46,11 @@ PrioritizedDispatcher::Handle PrioritizedDispatcher::Add(
   DCHECK_LT(priority, num_priorities());
   if (num_running_jobs_ < max_running_jobs_[priority]) {
     ++num_running_jobs_;
+    RecordStarvation(priority);
     job->Start();
     return Handle();
   }
+  ++queued_counts_[priority];
   return queue_.Insert(job, priority);
 }
 
@@ -41,13 +60,51 @@ PrioritizedDispatcher::Handle PrioritizedDispatcher::AddAtHead(
   DCHECK_LT(priority, num_priorities());
   if (num_running_jobs_ < max_running_jobs_[priority]) {
     ++num_running_jobs_;
+    RecordStarvation(priority);
     job->Start();
     return Handle();
   }
+  ++queued_counts_[priority];
   return queue_.InsertAtFront(job, priority);
 }
 
+void PrioritizedDispatcher::EnableCrossThreadSubmission(
+    const scoped_refptr<base::SingleThreadTaskRunner>& task_runner) {
+  DCHECK(task_runner.get());
+  DCHECK(!origin_task_runner_.get());
+  origin_task_runner_ = task_runner;
+  weak_this_ = weak_factory_.GetWeakPtr();
+}
+
+void PrioritizedDispatcher::PostJob(Job* job, Priority priority) {
+  DCHECK(job);
+  DCHECK_LT(priority, num_priorities());
+  DCHECK(origin_task_runner_.get());
+
+  // Push onto the lock-free list. The release barrier on success makes the
+  // node visible to the draining thread.
+  PostedJob* posted = new PostedJob(job, priority);
+  base::subtle::AtomicWord old_head;
+  do {
+    old_head = base::subtle::NoBarrier_Load(&posted_jobs_head_);
+    posted->next = reinterpret_cast<PostedJob*>(old_head);
+  } while (base::subtle::Release_CompareAndSwap(
+               &posted_jobs_head_, old_head,
+               reinterpret_cast<base::subtle::AtomicWord>(posted)) !=
+           old_head);
+
+  // The submitter that found the list empty schedules the drain; later
+  // submitters piggyback on it.
+  if (!old_head) {
+    origin_task_runner_->PostTask(
+        FROM_HERE,
+        base::Bind(&PrioritizedDispatcher::DrainPostedJobs, weak_this_));
+  }
+}
+
 void PrioritizedDispatcher::Cancel(const Handle& handle) {
+  DCHECK_GT(queued_counts_[handle.priority()], 0u);
+  --queued_counts_[handle.priority()];
   queue_.Erase(handle);
 }
 
@@ -73,7 +130,10 @@ PrioritizedDispatcher::Handle PrioritizedDispatcher::ChangePriority(
   if (MaybeDispatchJob(handle, priority))
     return Handle();
   Job* job = handle.value();
+  DCHECK_GT(queued_counts_[handle.priority()], 0u);
+  --queued_counts_[handle.priority()];
   queue_.Erase(handle);
+  ++queued_counts_[priority];
   return queue_.Insert(job, priority);
 }
 
@@ -111,10 +171,7 @@ void PrioritizedDispatcher::SetLimits(const Limits& limits) {
   }
 
   // Start pending jobs, if limits permit.
-  while (true) {
-    if (!MaybeDispatchNextJob())
-      break;
-  }
+  DispatchRunnableJobs();
 }
 
 void PrioritizedDispatcher::SetLimitsToZero() {
@@ -127,8 +184,11 @@ bool PrioritizedDispatcher::MaybeDispatchJob(const Handle& handle,
   if (num_running_jobs_ >= max_running_jobs_[job_priority])
     return false;
   Job* job = handle.value();
+  DCHECK_GT(queued_counts_[handle.priority()], 0u);
+  --queued_counts_[handle.priority()];
   queue_.Erase(handle);
   ++num_running_jobs_;
+  RecordStarvation(job_priority);
   job->Start();
   return true;
 }
@@ -142,4 +202,47 @@ bool PrioritizedDispatcher::MaybeDispatchNextJob() {
   return MaybeDispatchJob(handle, handle.priority());
 }
 
+size_t PrioritizedDispatcher::DispatchRunnableJobs() {
+  size_t num_started = 0;
+  while (MaybeDispatchNextJob())
+    ++num_started;
+  return num_started;
+}
+
+void PrioritizedDispatcher::DrainPostedJobs() {
+  // Detach the whole list in one shot. The acquire barrier pairs with the
+  // release in PostJob(), making the nodes' contents visible here.
+  base::subtle::AtomicWord head;
+  do {
+    head = base::subtle::Acquire_Load(&posted_jobs_head_);
+    if (!head)
+      return;
+  } while (base::subtle::Acquire_CompareAndSwap(&posted_jobs_head_, head, 0) !=
+           head);
+
+  // The list is in LIFO order; reverse it to add jobs in submission order.
+  PostedJob* posted = reinterpret_cast<PostedJob*>(head);
+  PostedJob* reversed = NULL;
+  while (posted) {
+    PostedJob* next = posted->next;
+    posted->next = reversed;
+    reversed = posted;
+    posted = next;
+  }
+
+  while (reversed) {
+    PostedJob* next = reversed->next;
+    Add(reversed->job, reversed->priority);
+    delete reversed;
+    reversed = next;
+  }
+
+  DispatchRunnableJobs();
+}
+
+void PrioritizedDispatcher::RecordStarvation(Priority priority) {
+  for (Priority p = 0; p < priority; ++p)
+    starvation_counts_[p] += queued_counts_[p];
+}
+
 }  // namespace net
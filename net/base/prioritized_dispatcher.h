@@ -7,9 +7,16 @@
 
 #include <vector>
 
+#include "base/atomicops.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "net/base/net_export.h"
 #include "net/base/priority_queue.h"
 
+namespace base {
+class SingleThreadTaskRunner;
+}  // namespace base
+
 namespace net {
 
 // A priority-based dispatcher of jobs. Dispatch order is by priority (highest
@@ -18,9 +25,10 @@ namespace net {
 // once it finishes in order to dispatch further jobs.
 //
 // This class is NOT thread-safe which is enforced by the underlying
-// non-thread-safe PriorityQueue. All operations are O(p) time for p priority
-// levels. It is safe to execute any method, including destructor, from within
-// Job::Start.
+// non-thread-safe PriorityQueue, with one exception: PostJob() may be called
+// from any thread once cross-thread submission has been enabled. All
+// operations are O(p) time for p priority levels. It is safe to execute any
+// method, including destructor, from within Job::Start.
 //
 class NET_EXPORT_PRIVATE PrioritizedDispatcher {
  public:
@@ -82,6 +90,28 @@ class NET_EXPORT_PRIVATE PrioritizedDispatcher {
   // priorities of |priority|.
   Handle AddAtHead(Job* job, Priority priority);
 
+  // Enables PostJob(). Cross-thread submissions are drained and dispatched in
+  // one batch on |task_runner|, which must run its tasks on the thread that
+  // owns this dispatcher. Must be called on that thread, before the first
+  // call to PostJob().
+  void EnableCrossThreadSubmission(
+      const scoped_refptr<base::SingleThreadTaskRunner>& task_runner);
+
+  // Adds |job| with |priority| to the dispatcher from any thread. The job is
+  // pushed onto a lock-free list and added to the queue on the dispatcher's
+  // own thread, so Job::Start is always invoked there. There is no handle to
+  // a posted job, so it cannot be canceled or reprioritized before it starts.
+  // As with Add, |job| must live at least until it is started or the
+  // dispatcher is destroyed. Requires EnableCrossThreadSubmission().
+  void PostJob(Job* job, Priority priority);
+
+  // Number of times a queued job at |priority| has been passed over by the
+  // start of a higher-priority job. A rapidly growing count indicates that
+  // the priority level is being starved.
+  size_t starvation_count(Priority priority) const {
+    return starvation_counts_[priority];
+  }
+
   // Removes the job with |handle| from the queue. Invalidates |handle|.
   // Note: a Handle is valid iff the job is in the queue, i.e. has not Started.
   void Cancel(const Handle& handle);
@@ -112,6 +142,16 @@ class NET_EXPORT_PRIVATE PrioritizedDispatcher {
   void SetLimitsToZero();
 
  private:
+  // A job submitted through PostJob(), linked into a lock-free LIFO list.
+  struct PostedJob {
+    PostedJob(Job* job, Priority priority)
+        : job(job), priority(priority), next(NULL) {}
+
+    Job* job;
+    Priority priority;
+    PostedJob* next;
+  };
+
   // Attempts to dispatch the job with |handle| at priority |priority| (might be
   // different than |handle.priority()|. Returns true if successful. If so
   // the |handle| becomes invalid.
@@ -121,6 +161,18 @@ class NET_EXPORT_PRIVATE PrioritizedDispatcher {
   // true if successful, and all handles to that job become invalid.
   bool MaybeDispatchNextJob();
 
+  // Starts queued jobs in priority order until the limits no longer permit
+  // any, in one pass. Returns the number of jobs started.
+  size_t DispatchRunnableJobs();
+
+  // Moves all jobs submitted through PostJob() into |queue_| in submission
+  // order, then dispatches every runnable job.
+  void DrainPostedJobs();
+
+  // Credits queued jobs of priority lower than |priority| with being passed
+  // over by the start of a job at |priority|.
+  void RecordStarvation(Priority priority);
+
   // Queue for jobs that need to wait for a spare slot.
   PriorityQueue<Job*> queue_;
   // Maximum total number of running jobs allowed after a job at a particular
@@ -129,6 +181,21 @@ class NET_EXPORT_PRIVATE PrioritizedDispatcher {
   std::vector<size_t> max_running_jobs_;
   // Total number of running jobs.
   size_t num_running_jobs_;
+  // Number of queued jobs at each priority. Kept in sync with |queue_|.
+  std::vector<size_t> queued_counts_;
+  // See starvation_count().
+  std::vector<size_t> starvation_counts_;
+  // Head of the lock-free LIFO list of jobs submitted through PostJob().
+  // Stores a PostedJob*.
+  base::subtle::AtomicWord posted_jobs_head_;
+  // Runs DrainPostedJobs() on the thread owning this dispatcher. NULL until
+  // EnableCrossThreadSubmission().
+  scoped_refptr<base::SingleThreadTaskRunner> origin_task_runner_;
+  // Created on the origin thread by EnableCrossThreadSubmission() so that
+  // PostJob() can bind drain tasks from other threads.
+  base::WeakPtr<PrioritizedDispatcher> weak_this_;
+
+  base::WeakPtrFactory<PrioritizedDispatcher> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(PrioritizedDispatcher);
 };
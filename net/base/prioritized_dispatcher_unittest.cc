@@ -5,10 +5,15 @@
 #include <ctype.h>
 #include <string>
 
+#include "base/bind.h"
 #include "base/compiler_specific.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/run_loop.h"
+#include "base/thread_task_runner_handle.h"
+#include "base/threading/thread.h"
 #include "net/base/prioritized_dispatcher.h"
 #include "net/base/request_priority.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -526,6 +531,72 @@ TEST_F(PrioritizedDispatcherTest, ZeroLimitsThenIncreasePriority) {
   Expect("a.");
 }
 
+TEST_F(PrioritizedDispatcherTest, StarvationCount) {
+  PrioritizedDispatcher::Limits limits(NUM_PRIORITIES, 1);
+  Prepare(limits);
+
+  TestJob* job_a = AddJob('a', IDLE);     // Runs.
+  TestJob* job_b = AddJob('b', IDLE);     // Queued.
+  TestJob* job_c = AddJob('c', HIGHEST);  // Queued.
+  EXPECT_EQ(0u, dispatcher_->starvation_count(IDLE));
+
+  job_a->Finish();  // Starts |job_c|, passing over |job_b|.
+  EXPECT_EQ(1u, dispatcher_->starvation_count(IDLE));
+  EXPECT_EQ(0u, dispatcher_->starvation_count(HIGHEST));
+
+  TestJob* job_d = AddJob('d', HIGHEST);  // Queued.
+  job_c->Finish();  // Starts |job_d|, passing over |job_b| again.
+  EXPECT_EQ(2u, dispatcher_->starvation_count(IDLE));
+
+  job_d->Finish();  // Starts |job_b|.
+  EXPECT_EQ(2u, dispatcher_->starvation_count(IDLE));
+  job_b->Finish();
+
+  Expect("a.c.d.b.");
+}
+
+TEST_F(PrioritizedDispatcherTest, PostJobFromAnotherThread) {
+  PrioritizedDispatcher::Limits limits(NUM_PRIORITIES, 1);
+  Prepare(limits);
+  dispatcher_->EnableCrossThreadSubmission(base::ThreadTaskRunnerHandle::Get());
+
+  TestJob* job_a = AddJob('a', IDLE);
+  ASSERT_TRUE(job_a->running());
+
+  TestJob* job_b = new TestJob(dispatcher_.get(), 'b', IDLE, &log_);
+  TestJob* job_c = new TestJob(dispatcher_.get(), 'c', HIGHEST, &log_);
+  jobs_.push_back(job_b);
+  jobs_.push_back(job_c);
+
+  // Submit both jobs from a worker thread.
+  base::Thread worker("dispatcher_worker");
+  ASSERT_TRUE(worker.Start());
+  worker.task_runner()->PostTask(
+      FROM_HERE,
+      base::Bind(&PrioritizedDispatcher::PostJob,
+                 base::Unretained(dispatcher_.get()), job_b,
+                 static_cast<Priority>(IDLE)));
+  worker.task_runner()->PostTask(
+      FROM_HERE,
+      base::Bind(&PrioritizedDispatcher::PostJob,
+                 base::Unretained(dispatcher_.get()), job_c,
+                 static_cast<Priority>(HIGHEST)));
+  // Joins the worker thread, so both submissions have been pushed.
+  worker.Stop();
+
+  // Run the drain task. All slots are taken, so the posted jobs queue up.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(2u, dispatcher_->num_queued_jobs());
+
+  job_a->Finish();
+  ASSERT_TRUE(job_c->running());
+  job_c->Finish();
+  ASSERT_TRUE(job_b->running());
+  job_b->Finish();
+
+  Expect("a.c.b.");
+}
+
 #if GTEST_HAS_DEATH_TEST && !defined(NDEBUG)
 TEST_F(PrioritizedDispatcherTest, CancelNull) {
   PrioritizedDispatcher::Limits limits(NUM_PRIORITIES, 1);
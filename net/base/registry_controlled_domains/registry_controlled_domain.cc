@@ -45,8 +45,13 @@
 
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 
+#include <utility>
+
+#include "base/containers/mru_cache.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/strings/string_util.h"
+#include "base/threading/thread_local.h"
 #include "base/strings/utf_string_conversions.h"
 #include "net/base/lookup_string_in_fixed_set.h"
 #include "net/base/net_module.h"
@@ -148,7 +153,73 @@ size_t GetRegistryLengthImpl(
       (host.length() - curr_start) : 0;
 }
 
-std::string GetDomainAndRegistryImpl(
+// Number of distinct (host, filter) results remembered per thread. Traffic
+// tends to concentrate on a few hundred hosts, so this captures nearly all
+// repeated lookups while staying small.
+const size_t kDomainAndRegistryCacheSize = 512;
+
+class DomainAndRegistryCache;
+
+base::LazyInstance<base::ThreadLocalPointer<DomainAndRegistryCache> >::Leaky
+    g_domain_and_registry_cache_tls = LAZY_INSTANCE_INITIALIZER;
+
+// A per-thread LRU cache of GetDomainAndRegistry() results. Callers like
+// CookieMonster's key computation and TransportSecurityState look up the
+// same hosts for every request, so caching avoids walking the DAFSA on the
+// hot path. Entries are tied to the domain graph they were computed from,
+// so tests that swap the graph via SetFindDomainGraph() don't see stale
+// results.
+class DomainAndRegistryCache {
+ public:
+  DomainAndRegistryCache()
+      : cache_(kDomainAndRegistryCacheSize),
+        graph_(g_graph),
+        graph_length_(g_graph_length) {}
+
+  static DomainAndRegistryCache* GetForCurrentThread() {
+    DomainAndRegistryCache* cache = g_domain_and_registry_cache_tls.Get().Get();
+    if (!cache) {
+      // Intentionally leaked at thread exit; holds at most a few hundred
+      // short strings.
+      cache = new DomainAndRegistryCache();
+      g_domain_and_registry_cache_tls.Get().Set(cache);
+    }
+    return cache;
+  }
+
+  // Returns the cached result for |host| under |filter|, or NULL if it has
+  // not been computed since the last graph change.
+  const std::string* Lookup(const std::string& host,
+                            PrivateRegistryFilter filter) {
+    if (graph_ != g_graph || graph_length_ != g_graph_length) {
+      cache_.Clear();
+      graph_ = g_graph;
+      graph_length_ = g_graph_length;
+    }
+    HostCache::iterator it = cache_.Get(std::make_pair(host, filter));
+    return it == cache_.end() ? NULL : &it->second;
+  }
+
+  void Put(const std::string& host,
+           PrivateRegistryFilter filter,
+           const std::string& result) {
+    cache_.Put(std::make_pair(host, filter), result);
+  }
+
+ private:
+  typedef base::MRUCache<std::pair<std::string, PrivateRegistryFilter>,
+                         std::string> HostCache;
+
+  HostCache cache_;
+
+  // The domain graph the cached entries were computed from.
+  const unsigned char* graph_;
+  size_t graph_length_;
+
+  DISALLOW_COPY_AND_ASSIGN(DomainAndRegistryCache);
+};
+
+std::string ComputeDomainAndRegistry(
     const std::string& host, PrivateRegistryFilter private_filter) {
   DCHECK(!host.empty());
 
@@ -175,6 +246,18 @@ std::string GetDomainAndRegistryImpl(
   return host.substr(dot + 1);
 }
 
+std::string GetDomainAndRegistryImpl(
+    const std::string& host, PrivateRegistryFilter private_filter) {
+  DomainAndRegistryCache* cache = DomainAndRegistryCache::GetForCurrentThread();
+  const std::string* cached = cache->Lookup(host, private_filter);
+  if (cached)
+    return *cached;
+
+  std::string result = ComputeDomainAndRegistry(host, private_filter);
+  cache->Put(host, private_filter, result);
+  return result;
+}
+
 }  // namespace
 
 std::string GetDomainAndRegistry(
@@ -144,6 +144,21 @@ TEST_F(RegistryControlledDomainTest, TestGetDomainAndRegistry) {
   EXPECT_EQ("", GetDomainFromHost(".localhost."));
 }
 
+TEST_F(RegistryControlledDomainTest, TestGetDomainAndRegistryCached) {
+  UseDomainData(test1::kDafsa);
+
+  // Repeated lookups of the same host are answered from the per-thread
+  // cache; make sure the cached answer matches a fresh one.
+  EXPECT_EQ("", GetDomainFromHost("baz.bar.jp"));
+  EXPECT_EQ("", GetDomainFromHost("baz.bar.jp"));
+
+  // Swapping the domain graph must invalidate the cached results.
+  UseDomainData(test2::kDafsa);
+  EXPECT_EQ("baz.bar.jp", GetDomainFromHost("baz.bar.jp"));
+  SetFindDomainGraph();
+  EXPECT_EQ("bar.jp", GetDomainFromHost("baz.bar.jp"));
+}
+
 TEST_F(RegistryControlledDomainTest, TestGetRegistryLength) {
   UseDomainData(test1::kDafsa);
 
@@ -5,10 +5,12 @@
 #include "net/base/sdch_manager.h"
 
 #include "base/base64url.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
 #include "base/time/default_clock.h"
 #include "base/values.h"
 #include "crypto/sha2.h"
@@ -38,6 +40,67 @@ void StripTrailingDot(GURL* gurl) {
 
 namespace net {
 
+namespace {
+
+// All SdchManagers in the process share one copy of each dictionary through
+// this pool. The server hash covers the entire dictionary payload, so two
+// dictionaries with the same hash are byte-identical and every manager can
+// use the copy loaded first. A pool entry is dropped when the last manager
+// removes the dictionary; outstanding DictionarySet handles keep the
+// underlying RefCountedData alive on their own.
+class DictionaryInternPool {
+ public:
+  DictionaryInternPool() {}
+
+  // Returns the process-wide shared dictionary for |server_hash|, interning
+  // |dictionary| if no other manager currently holds it. On a pool hit the
+  // returned dictionary carries the metadata (notably the expiration time)
+  // of the copy loaded first. Each call must be balanced by a call to
+  // Release().
+  scoped_refptr<base::RefCountedData<SdchDictionary>> Intern(
+      const std::string& server_hash,
+      const SdchDictionary& dictionary) {
+    base::AutoLock lock(lock_);
+    EntryMap::iterator it = entries_.find(server_hash);
+    if (it == entries_.end()) {
+      it = entries_.insert(std::make_pair(server_hash, Entry())).first;
+      it->second.dictionary = new base::RefCountedData<SdchDictionary>(
+          dictionary);
+    }
+    it->second.manager_count++;
+    return it->second.dictionary;
+  }
+
+  // Balances one Intern() call for |server_hash|.
+  void Release(const std::string& server_hash) {
+    base::AutoLock lock(lock_);
+    EntryMap::iterator it = entries_.find(server_hash);
+    DCHECK(it != entries_.end());
+    if (--it->second.manager_count == 0)
+      entries_.erase(it);
+  }
+
+ private:
+  struct Entry {
+    Entry() : manager_count(0) {}
+
+    scoped_refptr<base::RefCountedData<SdchDictionary>> dictionary;
+    // The number of managers holding the dictionary in their map.
+    size_t manager_count;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  base::Lock lock_;
+  EntryMap entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryInternPool);
+};
+
+base::LazyInstance<DictionaryInternPool>::Leaky g_dictionary_intern_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 SdchManager::DictionarySet::DictionarySet() {}
 
 SdchManager::DictionarySet::~DictionarySet() {}
@@ -83,6 +146,7 @@ SdchManager::~SdchManager() {
   DCHECK(thread_checker_.CalledOnValidThread());
   while (!dictionaries_.empty()) {
     auto it = dictionaries_.begin();
+    g_dictionary_intern_pool.Get().Release(it->first);
     dictionaries_.erase(it->first);
   }
 }
@@ -90,6 +154,8 @@ SdchManager::~SdchManager() {
 void SdchManager::ClearData() {
   blacklisted_domains_.clear();
   allow_latency_experiment_.clear();
+  for (const auto& entry : dictionaries_)
+    g_dictionary_intern_pool.Get().Release(entry.first);
   dictionaries_.clear();
   FOR_EACH_OBSERVER(SdchObserver, observers_, OnClearDictionaries());
 }
@@ -406,7 +472,7 @@ SdchProblemCode SdchManager::AddSdchDictionary(
                             server_hash, dictionary_url_normalized, domain,
                             path, expiration, ports);
   dictionaries_[server_hash] =
-      new base::RefCountedData<SdchDictionary>(dictionary);
+      g_dictionary_intern_pool.Get().Intern(server_hash, dictionary);
   if (server_hash_p)
     *server_hash_p = server_hash;
 
@@ -421,6 +487,7 @@ SdchProblemCode SdchManager::RemoveSdchDictionary(
   if (dictionaries_.find(server_hash) == dictionaries_.end())
     return SDCH_DICTIONARY_HASH_NOT_FOUND;
 
+  g_dictionary_intern_pool.Get().Release(server_hash);
   dictionaries_.erase(server_hash);
 
   FOR_EACH_OBSERVER(SdchObserver, observers_, OnDictionaryRemoved(server_hash));
@@ -42,7 +42,9 @@ class SdchObserver;
 // The SdchManager maintains a collection of memory resident dictionaries. It
 // can find a dictionary (based on a server specification of a hash), store a
 // dictionary, and make judgements about what URLs can use, set, etc. a
-// dictionary.
+// dictionary. Dictionary contents are shared process-wide: when several
+// managers (one per URLRequestContext) load the dictionary with the same
+// server hash, they all reference a single copy of its text.
 
 // These dictionaries are acquired over the net, and include a header
 // (containing metadata) as well as a VCDIFF dictionary (for use by a VCDIFF
@@ -224,6 +224,39 @@ TEST_F(SdchManagerTest, CanSetExactMatchDictionary) {
                                 GURL("http://" + dictionary_domain)));
 }
 
+TEST_F(SdchManagerTest, SameDictionarySharedBetweenManagers) {
+  std::string dictionary_domain("x.y.z.google.com");
+  std::string dictionary_text(NewSdchDictionary(dictionary_domain));
+  GURL dictionary_url("http://" + dictionary_domain);
+  GURL target_url("http://" + dictionary_domain + "/test");
+
+  std::string server_hash;
+  EXPECT_EQ(SDCH_OK, sdch_manager()->AddSdchDictionary(
+                         dictionary_text, dictionary_url, &server_hash));
+
+  SdchManager second_manager;
+  std::string second_server_hash;
+  EXPECT_EQ(SDCH_OK,
+            second_manager.AddSdchDictionary(dictionary_text, dictionary_url,
+                                             &second_server_hash));
+  EXPECT_EQ(server_hash, second_server_hash);
+
+  // Both managers hand out the same process-wide copy of the text.
+  SdchProblemCode problem_code;
+  scoped_ptr<SdchManager::DictionarySet> first_set(
+      sdch_manager()->GetDictionarySetByHash(target_url, server_hash,
+                                             &problem_code));
+  ASSERT_TRUE(first_set.get());
+  EXPECT_EQ(SDCH_OK, problem_code);
+  scoped_ptr<SdchManager::DictionarySet> second_set(
+      second_manager.GetDictionarySetByHash(target_url, server_hash,
+                                            &problem_code));
+  ASSERT_TRUE(second_set.get());
+  EXPECT_EQ(SDCH_OK, problem_code);
+  EXPECT_EQ(first_set->GetDictionaryText(server_hash),
+            second_set->GetDictionaryText(server_hash));
+}
+
 TEST_F(SdchManagerTest, CanAdvertiseDictionaryOverHTTP) {
   std::string dictionary_domain("x.y.z.google.com");
   std::string dictionary_text(NewSdchDictionary(dictionary_domain));
@@ -148,6 +148,51 @@ static bool SeekToSPKI(base::StringPiece* cert) {
   return true;
 }
 
+// SeekToExtensions parses the certificate in |cert| and sets
+// |*extensions_out| to the contents of the Extensions SEQUENCE (that is, a
+// concatenation of DER Extension values). If the certificate has no
+// extensions, |*extensions_out| is set to the empty string.
+static bool SeekToExtensions(base::StringPiece cert,
+                             base::StringPiece* extensions_out) {
+  if (!SeekToSPKI(&cert))
+    return false;
+
+  // From RFC 5280, section 4.1
+  // TBSCertificate  ::=  SEQUENCE  {
+  //      ...
+  //      subjectPublicKeyInfo SubjectPublicKeyInfo,
+  //      issuerUniqueID  [1]  IMPLICIT UniqueIdentifier OPTIONAL,
+  //      subjectUniqueID [2]  IMPLICIT UniqueIdentifier OPTIONAL,
+  //      extensions      [3]  EXPLICIT Extensions OPTIONAL
+
+  // subjectPublicKeyInfo
+  if (!GetElement(&cert, kSEQUENCE, NULL))
+    return false;
+  // issuerUniqueID
+  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 1, NULL))
+    return false;
+  // subjectUniqueID
+  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 2, NULL))
+    return false;
+
+  base::StringPiece extensions_seq;
+  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 3,
+                  &extensions_seq)) {
+    return false;
+  }
+
+  if (extensions_seq.empty()) {
+    *extensions_out = base::StringPiece();
+    return true;
+  }
+
+  // Extensions  ::=  SEQUENCE SIZE (1..MAX) OF Extension
+
+  // |extensions_seq| was EXPLICITly tagged, so we still need to remove the
+  // ASN.1 SEQUENCE header.
+  return GetElement(&extensions_seq, kSEQUENCE, extensions_out);
+}
+
 bool ExtractSPKIFromDERCert(base::StringPiece cert,
                             base::StringPiece* spki_out) {
   if (!SeekToSPKI(&cert))
@@ -190,48 +235,15 @@ bool ExtractCRLURLsFromDERCert(base::StringPiece cert,
   urls_out->clear();
   std::vector<base::StringPiece> tmp_urls_out;
 
-  if (!SeekToSPKI(&cert))
-    return false;
-
-  // From RFC 5280, section 4.1
-  // TBSCertificate  ::=  SEQUENCE  {
-  //      ...
-  //      subjectPublicKeyInfo SubjectPublicKeyInfo,
-  //      issuerUniqueID  [1]  IMPLICIT UniqueIdentifier OPTIONAL,
-  //      subjectUniqueID [2]  IMPLICIT UniqueIdentifier OPTIONAL,
-  //      extensions      [3]  EXPLICIT Extensions OPTIONAL
-
-  // subjectPublicKeyInfo
-  if (!GetElement(&cert, kSEQUENCE, NULL))
-    return false;
-  // issuerUniqueID
-  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 1, NULL))
-    return false;
-  // subjectUniqueID
-  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 2, NULL))
-    return false;
-
-  base::StringPiece extensions_seq;
-  if (!GetElement(&cert, kOptional | kConstructed | kContextSpecific | 3,
-                  &extensions_seq)) {
+  base::StringPiece extensions;
+  if (!SeekToExtensions(cert, &extensions))
     return false;
-  }
-
-  if (extensions_seq.empty())
-    return true;
 
-  // Extensions  ::=  SEQUENCE SIZE (1..MAX) OF Extension
   // Extension   ::=  SEQUENCE  {
   //      extnID      OBJECT IDENTIFIER,
   //      critical    BOOLEAN DEFAULT FALSE,
   //      extnValue   OCTET STRING
 
-  // |extensions_seq| was EXPLICITly tagged, so we still need to remove the
-  // ASN.1 SEQUENCE header.
-  base::StringPiece extensions;
-  if (!GetElement(&extensions_seq, kSEQUENCE, &extensions))
-    return false;
-
   while (extensions.size() > 0) {
     base::StringPiece extension;
     if (!GetElement(&extensions, kSEQUENCE, &extension))
@@ -326,6 +338,93 @@ bool ExtractCRLURLsFromDERCert(base::StringPiece cert,
   return true;
 }
 
+bool ExtractCaIssuersURLsFromDERCert(base::StringPiece cert,
+                                     std::vector<base::StringPiece>* urls_out) {
+  urls_out->clear();
+  std::vector<base::StringPiece> tmp_urls_out;
+
+  base::StringPiece extensions;
+  if (!SeekToExtensions(cert, &extensions))
+    return false;
+
+  // Extension   ::=  SEQUENCE  {
+  //      extnID      OBJECT IDENTIFIER,
+  //      critical    BOOLEAN DEFAULT FALSE,
+  //      extnValue   OCTET STRING
+
+  while (extensions.size() > 0) {
+    base::StringPiece extension;
+    if (!GetElement(&extensions, kSEQUENCE, &extension))
+      return false;
+
+    base::StringPiece oid;
+    if (!GetElement(&extension, kOID, &oid))
+      return false;
+
+    // kAuthorityInfoAccessOID is the DER encoding of the OID for the X.509
+    // Authority Information Access extension (1.3.6.1.5.5.7.1.1).
+    static const uint8_t kAuthorityInfoAccessOID[] = {0x2b, 0x06, 0x01, 0x05,
+                                                      0x05, 0x07, 0x01, 0x01};
+
+    if (oid.size() != sizeof(kAuthorityInfoAccessOID) ||
+        memcmp(oid.data(), kAuthorityInfoAccessOID, oid.size()) != 0) {
+      continue;
+    }
+
+    // critical
+    GetElement(&extension, kBOOLEAN, NULL);
+
+    // extnValue
+    base::StringPiece extension_value;
+    if (!GetElement(&extension, kOCTETSTRING, &extension_value))
+      return false;
+
+    // RFC 5280, section 4.2.2.1.
+    //
+    // AuthorityInfoAccessSyntax  ::=
+    //         SEQUENCE SIZE (1..MAX) OF AccessDescription
+    //
+    // AccessDescription  ::=  SEQUENCE {
+    //         accessMethod          OBJECT IDENTIFIER,
+    //         accessLocation        GeneralName  }
+
+    base::StringPiece access_descriptions;
+    if (!GetElement(&extension_value, kSEQUENCE, &access_descriptions))
+      return false;
+
+    while (access_descriptions.size() > 0) {
+      base::StringPiece access_description;
+      if (!GetElement(&access_descriptions, kSEQUENCE, &access_description))
+        return false;
+
+      base::StringPiece access_method;
+      if (!GetElement(&access_description, kOID, &access_method))
+        return false;
+
+      // kCaIssuersOID is the DER encoding of the id-ad-caIssuers access
+      // method (1.3.6.1.5.5.7.48.2).
+      static const uint8_t kCaIssuersOID[] = {0x2b, 0x06, 0x01, 0x05,
+                                              0x05, 0x07, 0x30, 0x02};
+
+      if (access_method.size() != sizeof(kCaIssuersOID) ||
+          memcmp(access_method.data(), kCaIssuersOID, access_method.size()) !=
+              0) {
+        continue;
+      }
+
+      // accessLocation. Only uniformResourceIdentifier names are of use to a
+      // fetcher; other GeneralName choices (most commonly LDAP directory
+      // names) are skipped.
+      base::StringPiece url;
+      if (GetElement(&access_description, kContextSpecific | 6, &url))
+        tmp_urls_out.push_back(url);
+    }
+  }
+
+  urls_out->swap(tmp_urls_out);
+  return true;
+}
+
 } // namespace asn1
 
 } // namespace net
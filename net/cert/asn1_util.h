@@ -87,6 +87,17 @@ NET_EXPORT_PRIVATE bool ExtractCRLURLsFromDERCert(
     base::StringPiece cert,
     std::vector<base::StringPiece>* urls_out);
 
+// ExtractCaIssuersURLsFromDERCert parses the DER encoded certificate in
+// |cert| and extracts the caIssuers URLs from its Authority Information
+// Access extension. On successful return, the elements of |urls_out| point
+// into |cert|.
+//
+// Access descriptions using a method other than id-ad-caIssuers, or a
+// location that is not a uniformResourceIdentifier, are omitted.
+NET_EXPORT_PRIVATE bool ExtractCaIssuersURLsFromDERCert(
+    base::StringPiece cert,
+    std::vector<base::StringPiece>* urls_out);
+
 } // namespace asn1
 
 } // namespace net
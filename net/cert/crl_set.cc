@@ -29,20 +29,26 @@ CRLSet::Result CRLSet::CheckSPKI(const base::StringPiece& spki_hash) const {
   return GOOD;
 }
 
+// static
+bool CRLSet::CanonicalizeSerial(base::StringPiece* serial) {
+  if (!serial->empty() && ((*serial)[0] & 0x80) != 0) {
+    // This serial number is negative.
+    return false;
+  }
+
+  // Remove any leading zero bytes.
+  while (serial->size() > 1 && (*serial)[0] == 0x00)
+    serial->remove_prefix(1);
+
+  return true;
+}
+
 CRLSet::Result CRLSet::CheckSerial(
     const base::StringPiece& serial_number,
     const base::StringPiece& issuer_spki_hash) const {
   base::StringPiece serial(serial_number);
-
-  if (!serial.empty() && (serial[0] & 0x80) != 0) {
-    // This serial number is negative but the process which generates CRL sets
-    // will reject any certificates with negative serial numbers as invalid.
+  if (!CanonicalizeSerial(&serial))
     return UNKNOWN;
-  }
-
-  // Remove any leading zero bytes.
-  while (serial.size() > 1 && serial[0] == 0x00)
-    serial.remove_prefix(1);
 
   base::hash_map<std::string, size_t>::const_iterator crl_index =
       crls_index_by_issuer_.find(issuer_spki_hash.as_string());
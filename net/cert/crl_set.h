@@ -31,14 +31,17 @@ class NET_EXPORT CRLSet : public base::RefCountedThreadSafe<CRLSet> {
 
   // CheckSPKI checks whether the given SPKI has been listed as blocked.
   //   spki_hash: the SHA256 of the SubjectPublicKeyInfo of the certificate.
-  Result CheckSPKI(const base::StringPiece& spki_hash) const;
+  //
+  // Virtual so that CRLSetStorage can provide an implementation that
+  // searches an indexed, memory-mapped representation in place.
+  virtual Result CheckSPKI(const base::StringPiece& spki_hash) const;
 
   // CheckSerial returns the information contained in the set for a given
   // certificate:
   //   serial_number: the serial number of the certificate
   //   issuer_spki_hash: the SHA256 of the SubjectPublicKeyInfo of the CRL
   //       signer
-  Result CheckSerial(
+  virtual Result CheckSerial(
       const base::StringPiece& serial_number,
       const base::StringPiece& issuer_spki_hash) const;
 
@@ -75,10 +78,18 @@ class NET_EXPORT CRLSet : public base::RefCountedThreadSafe<CRLSet> {
                             const SHA256HashValue* issuer_spki,
                             const std::string& serial_number);
 
- private:
+ protected:
   CRLSet();
-  ~CRLSet();
+  virtual ~CRLSet();
+
+  // CanonicalizeSerial strips any leading zero bytes from |*serial|, which
+  // is the form serial numbers are stored in. It returns false if the serial
+  // number is negative, in which case lookups should return UNKNOWN: the
+  // process which generates CRL sets rejects certificates with negative
+  // serial numbers as invalid.
+  static bool CanonicalizeSerial(base::StringPiece* serial);
 
+ private:
   friend class base::RefCountedThreadSafe<CRLSet>;
   friend class CRLSetStorage;
 
@@ -4,8 +4,13 @@
 
 #include "net/cert/crl_set_storage.h"
 
+#include <algorithm>
+
 #include "base/base64.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/format_macros.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/json/json_reader.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
@@ -549,4 +554,351 @@ std::string CRLSetStorage::Serialize(const CRLSet* crl_set) {
   return ret;
 }
 
+// Indexed CRLSet format:
+//
+// All integers are little-endian, matching the regular CRLSet format above.
+//
+// byte[8] magic = "CRLSetIx"
+// uint32le version (currently 1)
+// uint32le sequence
+// uint64le not_after
+// uint32le num_blocked_spkis
+// uint32le num_issuers
+// byte[32][num_blocked_spkis] blocked_spki_sha256s (sorted by memcmp)
+// [num_issuers] {                 (sorted by memcmp of parent_spki_sha256)
+//   byte[32] parent_spki_sha256
+//   uint32le serials_offset       (byte offset from the start of the data)
+//   uint32le num_serials
+//   uint32le serial_cell_size
+// }
+// ... serial cell arrays ...
+//
+// The serial numbers of each issuer are stored at |serials_offset| as
+// |num_serials| fixed-width cells of |serial_cell_size| bytes each: a length
+// byte followed by the serial, zero padded on the right. Cells are sorted by
+// memcmp, which (because the length byte leads) is also the order used by
+// the binary search in CheckSerial. The fixed widths are what allow both
+// tables to be binary-searched directly in a read-only file mapping.
+
+static const char kIndexedMagic[] = "CRLSetIx";
+static const size_t kIndexedMagicLen = 8;
+static const uint32_t kIndexedVersion = 1;
+static const size_t kIndexedHeaderLen = 32;
+static const size_t kIndexedIssuerRecordLen = crypto::kSHA256Length + 12;
+
+namespace {
+
+// CRLSetIndexed is a CRLSet whose lookups binary-search indexed-format bytes
+// in place, rather than heap structures built at parse time. The backing
+// bytes are either owned directly or held through a file mapping.
+class CRLSetIndexed : public CRLSet {
+ public:
+  CRLSetIndexed(scoped_ptr<base::MemoryMappedFile> mapping,
+                const std::string& owned_data)
+      : mapping_(mapping.Pass()), owned_data_(owned_data) {
+    if (mapping_) {
+      data_ = base::StringPiece(reinterpret_cast<const char*>(mapping_->data()),
+                                mapping_->length());
+    } else {
+      data_ = base::StringPiece(owned_data_);
+    }
+    memcpy(&num_blocked_spkis_, data_.data() + 24, sizeof(uint32_t));
+    memcpy(&num_issuers_, data_.data() + 28, sizeof(uint32_t));
+  }
+
+  Result CheckSPKI(const base::StringPiece& spki_hash) const override {
+    if (spki_hash.size() != crypto::kSHA256Length)
+      return GOOD;
+
+    const char* table = data_.data() + kIndexedHeaderLen;
+    size_t lo = 0, hi = num_blocked_spkis_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const int r = memcmp(spki_hash.data(),
+                           table + mid * crypto::kSHA256Length,
+                           crypto::kSHA256Length);
+      if (r == 0)
+        return REVOKED;
+      if (r < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return GOOD;
+  }
+
+  Result CheckSerial(const base::StringPiece& serial_number,
+                     const base::StringPiece& issuer_spki_hash) const override {
+    base::StringPiece serial(serial_number);
+    if (!CanonicalizeSerial(&serial))
+      return UNKNOWN;
+
+    if (issuer_spki_hash.size() != crypto::kSHA256Length)
+      return UNKNOWN;
+
+    const char* table = data_.data() + kIndexedHeaderLen +
+                        num_blocked_spkis_ * crypto::kSHA256Length;
+    const char* record = NULL;
+    size_t lo = 0, hi = num_issuers_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const char* mid_record = table + mid * kIndexedIssuerRecordLen;
+      const int r = memcmp(issuer_spki_hash.data(), mid_record,
+                           crypto::kSHA256Length);
+      if (r == 0) {
+        record = mid_record;
+        break;
+      }
+      if (r < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    if (record == NULL)
+      return UNKNOWN;
+
+    uint32_t serials_offset, num_serials, cell_size;
+    memcpy(&serials_offset, record + crypto::kSHA256Length, sizeof(uint32_t));
+    memcpy(&num_serials, record + crypto::kSHA256Length + 4, sizeof(uint32_t));
+    memcpy(&cell_size, record + crypto::kSHA256Length + 8, sizeof(uint32_t));
+
+    // A serial longer than the widest one stored cannot be present.
+    if (serial.size() + 1 > cell_size)
+      return GOOD;
+
+    std::string needle(cell_size, '\0');
+    needle[0] = static_cast<char>(serial.size());
+    memcpy(&needle[1], serial.data(), serial.size());
+
+    const char* cells = data_.data() + serials_offset;
+    lo = 0;
+    hi = num_serials;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const int r = memcmp(needle.data(), cells + mid * cell_size, cell_size);
+      if (r == 0)
+        return REVOKED;
+      if (r < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return GOOD;
+  }
+
+ private:
+  ~CRLSetIndexed() override {}
+
+  const scoped_ptr<base::MemoryMappedFile> mapping_;
+  const std::string owned_data_;
+  base::StringPiece data_;
+  uint32_t num_blocked_spkis_;
+  uint32_t num_issuers_;
+};
+
+}  // namespace
+
+// ValidateIndexed checks that |data| is well-formed indexed-format bytes: it
+// verifies the magic, version and that every table and serial array lies
+// within |data|, so that the binary searches in CRLSetIndexed never read out
+// of bounds. On success the header fields are returned in the out
+// parameters. This is O(num_issuers), not O(size of the set).
+static bool ValidateIndexed(base::StringPiece data,
+                            uint32_t* out_sequence,
+                            uint64_t* out_not_after) {
+  if (data.size() < kIndexedHeaderLen)
+    return false;
+  if (memcmp(data.data(), kIndexedMagic, kIndexedMagicLen) != 0)
+    return false;
+
+  uint32_t version, num_blocked_spkis, num_issuers;
+  uint64_t not_after;
+  // Assumes little endian.
+  memcpy(&version, data.data() + 8, sizeof(version));
+  memcpy(out_sequence, data.data() + 12, sizeof(*out_sequence));
+  memcpy(&not_after, data.data() + 16, sizeof(not_after));
+  memcpy(&num_blocked_spkis, data.data() + 24, sizeof(num_blocked_spkis));
+  memcpy(&num_issuers, data.data() + 28, sizeof(num_issuers));
+
+  if (version != kIndexedVersion)
+    return false;
+  *out_not_after = not_after;
+
+  const uint64_t tables_len =
+      static_cast<uint64_t>(num_blocked_spkis) * crypto::kSHA256Length +
+      static_cast<uint64_t>(num_issuers) * kIndexedIssuerRecordLen;
+  if (tables_len > data.size() - kIndexedHeaderLen)
+    return false;
+
+  const char* record = data.data() + kIndexedHeaderLen +
+                       num_blocked_spkis * crypto::kSHA256Length;
+  for (uint32_t i = 0; i < num_issuers;
+       i++, record += kIndexedIssuerRecordLen) {
+    uint32_t serials_offset, num_serials, cell_size;
+    memcpy(&serials_offset, record + crypto::kSHA256Length, sizeof(uint32_t));
+    memcpy(&num_serials, record + crypto::kSHA256Length + 4, sizeof(uint32_t));
+    memcpy(&cell_size, record + crypto::kSHA256Length + 8, sizeof(uint32_t));
+
+    if (cell_size == 0)
+      return false;
+    if (serials_offset > data.size())
+      return false;
+    if (static_cast<uint64_t>(num_serials) * cell_size >
+        data.size() - serials_offset) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool IssuerHashLessThan(
+    const std::pair<std::string, std::vector<std::string> >* a,
+    const std::pair<std::string, std::vector<std::string> >* b) {
+  return a->first < b->first;
+}
+
+// static
+std::string CRLSetStorage::SerializeIndexed(const CRLSet* crl_set) {
+  // Gather and sort the blocked SPKIs.
+  std::vector<std::string> blocked_spkis = crl_set->blocked_spkis_;
+  for (size_t i = 0; i < blocked_spkis.size(); i++) {
+    if (blocked_spkis[i].size() != crypto::kSHA256Length)
+      return std::string();
+  }
+  std::sort(blocked_spkis.begin(), blocked_spkis.end());
+
+  // Gather the issuers through |crls_index_by_issuer_| so that, should the
+  // list ever contain a duplicate issuer, the indexed set resolves it to the
+  // same CRL that CRLSet::CheckSerial would.
+  std::vector<const std::pair<std::string, std::vector<std::string> >*>
+      issuers;
+  issuers.reserve(crl_set->crls_index_by_issuer_.size());
+  for (base::hash_map<std::string, size_t>::const_iterator i =
+           crl_set->crls_index_by_issuer_.begin();
+       i != crl_set->crls_index_by_issuer_.end(); ++i) {
+    issuers.push_back(&crl_set->crls_[i->second]);
+  }
+  std::sort(issuers.begin(), issuers.end(), IssuerHashLessThan);
+
+  // Build each issuer's sorted, fixed-width cell array.
+  std::vector<uint32_t> cell_sizes;
+  std::vector<std::string> cell_arrays;
+  cell_sizes.reserve(issuers.size());
+  cell_arrays.reserve(issuers.size());
+  for (size_t i = 0; i < issuers.size(); i++) {
+    if (issuers[i]->first.size() != crypto::kSHA256Length)
+      return std::string();
+    const std::vector<std::string>& serials = issuers[i]->second;
+
+    size_t max_serial_len = 0;
+    for (size_t j = 0; j < serials.size(); j++)
+      max_serial_len = std::max(max_serial_len, serials[j].size());
+    if (max_serial_len > 0xff)
+      return std::string();
+    const uint32_t cell_size = static_cast<uint32_t>(1 + max_serial_len);
+
+    std::vector<std::string> cells;
+    cells.reserve(serials.size());
+    for (size_t j = 0; j < serials.size(); j++) {
+      std::string cell(cell_size, '\0');
+      cell[0] = static_cast<char>(serials[j].size());
+      memcpy(&cell[1], serials[j].data(), serials[j].size());
+      cells.push_back(cell);
+    }
+    std::sort(cells.begin(), cells.end());
+
+    cell_sizes.push_back(cell_size);
+    cell_arrays.push_back(std::string());
+    std::string* cell_array = &cell_arrays.back();
+    cell_array->reserve(serials.size() * cell_size);
+    for (size_t j = 0; j < cells.size(); j++)
+      cell_array->append(cells[j]);
+  }
+
+  const size_t tables_len = kIndexedHeaderLen +
+                            blocked_spkis.size() * crypto::kSHA256Length +
+                            issuers.size() * kIndexedIssuerRecordLen;
+
+  std::string ret;
+  ret.reserve(tables_len);
+  ret.append(kIndexedMagic, kIndexedMagicLen);
+
+  // Assumes little endian (as does Serialize(), above).
+  const uint32_t version = kIndexedVersion;
+  const uint32_t sequence = crl_set->sequence_;
+  const uint64_t not_after = crl_set->not_after_;
+  const uint32_t num_blocked_spkis =
+      static_cast<uint32_t>(blocked_spkis.size());
+  const uint32_t num_issuers = static_cast<uint32_t>(issuers.size());
+  ret.append(reinterpret_cast<const char*>(&version), sizeof(version));
+  ret.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+  ret.append(reinterpret_cast<const char*>(&not_after), sizeof(not_after));
+  ret.append(reinterpret_cast<const char*>(&num_blocked_spkis),
+             sizeof(num_blocked_spkis));
+  ret.append(reinterpret_cast<const char*>(&num_issuers), sizeof(num_issuers));
+
+  for (size_t i = 0; i < blocked_spkis.size(); i++)
+    ret.append(blocked_spkis[i]);
+
+  uint64_t serials_offset = tables_len;
+  for (size_t i = 0; i < issuers.size(); i++) {
+    if (!base::IsValueInRangeForNumericType<uint32_t>(serials_offset))
+      return std::string();
+    const uint32_t offset = static_cast<uint32_t>(serials_offset);
+    const uint32_t num_serials =
+        static_cast<uint32_t>(issuers[i]->second.size());
+    ret.append(issuers[i]->first);
+    ret.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    ret.append(reinterpret_cast<const char*>(&num_serials),
+               sizeof(num_serials));
+    ret.append(reinterpret_cast<const char*>(&cell_sizes[i]),
+               sizeof(cell_sizes[i]));
+    serials_offset += cell_arrays[i].size();
+  }
+
+  for (size_t i = 0; i < cell_arrays.size(); i++)
+    ret.append(cell_arrays[i]);
+
+  return ret;
+}
+
+// static
+bool CRLSetStorage::ParseIndexed(base::StringPiece data,
+                                 scoped_refptr<CRLSet>* out_crl_set) {
+  uint32_t sequence;
+  uint64_t not_after;
+  if (!ValidateIndexed(data, &sequence, &not_after))
+    return false;
+
+  scoped_refptr<CRLSet> crl_set(new CRLSetIndexed(
+      scoped_ptr<base::MemoryMappedFile>(), data.as_string()));
+  crl_set->sequence_ = sequence;
+  crl_set->not_after_ = not_after;
+  *out_crl_set = crl_set;
+  return true;
+}
+
+// static
+bool CRLSetStorage::LoadIndexed(const base::FilePath& path,
+                                scoped_refptr<CRLSet>* out_crl_set) {
+  scoped_ptr<base::MemoryMappedFile> mapping(new base::MemoryMappedFile);
+  if (!mapping->Initialize(path))
+    return false;
+
+  uint32_t sequence;
+  uint64_t not_after;
+  const base::StringPiece data(
+      reinterpret_cast<const char*>(mapping->data()), mapping->length());
+  if (!ValidateIndexed(data, &sequence, &not_after))
+    return false;
+
+  scoped_refptr<CRLSet> crl_set(
+      new CRLSetIndexed(mapping.Pass(), std::string()));
+  crl_set->sequence_ = sequence;
+  crl_set->not_after_ = not_after;
+  *out_crl_set = crl_set;
+  return true;
+}
+
 }  // namespace net
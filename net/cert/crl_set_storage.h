@@ -15,6 +15,7 @@
 
 namespace base {
 class DictionaryValue;
+class FilePath;
 }
 
 namespace net {
@@ -43,6 +44,29 @@ class NET_EXPORT CRLSetStorage {
   // will be equal.
   static std::string Serialize(const CRLSet* crl_set);
 
+  // SerializeIndexed returns |crl_set| in the indexed, flat format described
+  // in crl_set_storage.cc: a sorted fixed-width SPKI hash table with sorted
+  // fixed-width serial arrays, which LoadIndexed() and ParseIndexed() can
+  // binary-search in place without inflating anything onto the heap. Returns
+  // the empty string on failure.
+  static std::string SerializeIndexed(const CRLSet* crl_set);
+
+  // ParseIndexed validates the indexed-format bytes in |data| and, on
+  // success, puts in |out_crl_set| a CRLSet whose CheckSPKI() and
+  // CheckSerial() binary-search those bytes directly. |data| is copied.
+  //
+  // Indexed CRLSets are read-only lookup structures: crls() is empty for
+  // them and they cannot be used with ApplyDelta() or Serialize(). Apply
+  // deltas to a regular parsed CRLSet and re-run SerializeIndexed() instead.
+  static bool ParseIndexed(base::StringPiece data,
+                           scoped_refptr<CRLSet>* out_crl_set);
+
+  // LoadIndexed is like ParseIndexed, but memory-maps the indexed-format
+  // file at |path| instead of copying it. Loading is therefore O(1) in the
+  // size of the set, and lookups only fault in the pages they touch.
+  static bool LoadIndexed(const base::FilePath& path,
+                          scoped_refptr<CRLSet>* out_crl_set);
+
  private:
   // CopyBlockedSPKIsFromHeader sets |blocked_spkis_| to the list of values
   // from "BlockedSPKIs" in |header_dict|.
@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "crypto/sha2.h"
 #include "net/cert/crl_set.h"
 #include "net/cert/crl_set_storage.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -318,6 +321,126 @@ TEST(CRLSetTest, BlockedSPKIs) {
             set->CheckSPKI(reinterpret_cast<const char*>(spki_hash)));
 }
 
+TEST(CRLSetTest, IndexedRoundTrip) {
+  base::StringPiece s(reinterpret_cast<const char*>(kGIACRLSet),
+                      sizeof(kGIACRLSet));
+  scoped_refptr<CRLSet> set;
+  EXPECT_TRUE(CRLSetStorage::Parse(s, &set));
+  ASSERT_TRUE(set.get() != NULL);
+
+  const std::string indexed = CRLSetStorage::SerializeIndexed(set.get());
+  ASSERT_FALSE(indexed.empty());
+
+  scoped_refptr<CRLSet> indexed_set;
+  ASSERT_TRUE(CRLSetStorage::ParseIndexed(indexed, &indexed_set));
+  ASSERT_TRUE(indexed_set.get() != NULL);
+
+  EXPECT_EQ(set->sequence(), indexed_set->sequence());
+  EXPECT_FALSE(indexed_set->IsExpired());
+
+  const std::string gia_spki_hash(
+      reinterpret_cast<const char*>(kGIASPKISHA256),
+      sizeof(kGIASPKISHA256));
+
+  // Every serial in the set must look up the same as in the heap-based set.
+  const CRLSet::CRLList& crls = set->crls();
+  ASSERT_EQ(1u, crls.size());
+  const std::vector<std::string>& serials = crls[0].second;
+  for (size_t i = 0; i < serials.size(); i++) {
+    EXPECT_EQ(CRLSet::REVOKED,
+              indexed_set->CheckSerial(serials[i], gia_spki_hash));
+  }
+
+  EXPECT_EQ(CRLSet::GOOD,
+            indexed_set->CheckSerial(
+                std::string("\x47\x54\x3E\x79\x00\x03\x00\x00\x14\xF5", 10),
+                gia_spki_hash));
+  const std::string other_spki_hash(crypto::kSHA256Length, 'x');
+  EXPECT_EQ(CRLSet::UNKNOWN,
+            indexed_set->CheckSerial(
+                std::string("\x16\x7D\x75\x9D\x00\x03\x00\x00\x14\x55", 10),
+                other_spki_hash));
+}
+
+TEST(CRLSetTest, IndexedBlockedSPKIs) {
+  base::StringPiece s(reinterpret_cast<const char*>(kBlockedSPKICRLSet),
+                      sizeof(kBlockedSPKICRLSet));
+  scoped_refptr<CRLSet> set;
+  EXPECT_TRUE(CRLSetStorage::Parse(s, &set));
+  ASSERT_TRUE(set.get() != NULL);
+
+  const std::string indexed = CRLSetStorage::SerializeIndexed(set.get());
+  ASSERT_FALSE(indexed.empty());
+
+  scoped_refptr<CRLSet> indexed_set;
+  ASSERT_TRUE(CRLSetStorage::ParseIndexed(indexed, &indexed_set));
+  ASSERT_TRUE(indexed_set.get() != NULL);
+
+  const uint8_t spki_hash[] = {
+    227, 176, 196, 66, 152, 252, 28, 20, 154, 251, 244, 200, 153, 111, 185, 36,
+    39, 174, 65, 228, 100, 155, 147, 76, 164, 149, 153, 27, 120, 82, 184, 85,
+    0,
+  };
+
+  EXPECT_EQ(CRLSet::GOOD, indexed_set->CheckSPKI(""));
+  EXPECT_EQ(CRLSet::REVOKED,
+            indexed_set->CheckSPKI(reinterpret_cast<const char*>(spki_hash)));
+}
+
+TEST(CRLSetTest, LoadIndexed) {
+  base::StringPiece s(reinterpret_cast<const char*>(kGIACRLSet),
+                      sizeof(kGIACRLSet));
+  scoped_refptr<CRLSet> set;
+  EXPECT_TRUE(CRLSetStorage::Parse(s, &set));
+  ASSERT_TRUE(set.get() != NULL);
+
+  const std::string indexed = CRLSetStorage::SerializeIndexed(set.get());
+  ASSERT_FALSE(indexed.empty());
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("crl-set.indexed");
+  ASSERT_EQ(static_cast<int>(indexed.size()),
+            base::WriteFile(path, indexed.data(), indexed.size()));
+
+  scoped_refptr<CRLSet> indexed_set;
+  ASSERT_TRUE(CRLSetStorage::LoadIndexed(path, &indexed_set));
+  ASSERT_TRUE(indexed_set.get() != NULL);
+
+  const std::string gia_spki_hash(
+      reinterpret_cast<const char*>(kGIASPKISHA256),
+      sizeof(kGIASPKISHA256));
+  EXPECT_EQ(CRLSet::REVOKED,
+            indexed_set->CheckSerial(
+                std::string("\x16\x7D\x75\x9D\x00\x03\x00\x00\x14\x55", 10),
+                gia_spki_hash));
+  EXPECT_EQ(CRLSet::GOOD,
+            indexed_set->CheckSerial(
+                std::string("\x47\x54\x3E\x79\x00\x03\x00\x00\x14\xF5", 10),
+                gia_spki_hash));
+}
+
+TEST(CRLSetTest, IndexedRejectsMalformed) {
+  base::StringPiece s(reinterpret_cast<const char*>(kGIACRLSet),
+                      sizeof(kGIACRLSet));
+  scoped_refptr<CRLSet> set;
+  EXPECT_TRUE(CRLSetStorage::Parse(s, &set));
+  ASSERT_TRUE(set.get() != NULL);
+
+  const std::string indexed = CRLSetStorage::SerializeIndexed(set.get());
+  ASSERT_FALSE(indexed.empty());
+
+  scoped_refptr<CRLSet> indexed_set;
+  // Data that isn't in the indexed format at all.
+  EXPECT_FALSE(CRLSetStorage::ParseIndexed(s, &indexed_set));
+  // A truncated header.
+  EXPECT_FALSE(
+      CRLSetStorage::ParseIndexed(indexed.substr(0, 16), &indexed_set));
+  // A set whose serial arrays have been cut off.
+  EXPECT_FALSE(CRLSetStorage::ParseIndexed(
+      indexed.substr(0, indexed.size() - 1), &indexed_set));
+}
+
 TEST(CRLSetTest, Expired) {
   // This CRLSet has an expiry value set to one second past midnight, 1st Jan,
   // 1970.
@@ -5,11 +5,22 @@
 #include "net/cert/ct_log_verifier.h"
 
 #include "base/logging.h"
+#include "crypto/sha2.h"
 #include "net/cert/ct_serialization.h"
 #include "net/cert/signed_tree_head.h"
 
 namespace net {
 
+namespace {
+
+// The number of distinct SCT signatures whose successful verification is
+// remembered. Handshakes carry only a few SCTs each and popular servers
+// present the same ones on every connection, so a small cache suffices to
+// absorb most of the repeat verifications.
+const size_t kMaxCachedVerifications = 256;
+
+}  // namespace
+
 // static
 scoped_refptr<const CTLogVerifier> CTLogVerifier::Create(
     const base::StringPiece& public_key,
@@ -30,7 +41,9 @@ CTLogVerifier::CTLogVerifier(const base::StringPiece& description,
       url_(url),
       hash_algorithm_(ct::DigitallySigned::HASH_ALGO_NONE),
       signature_algorithm_(ct::DigitallySigned::SIG_ALGO_ANONYMOUS),
-      public_key_(NULL) {
+      public_key_(NULL),
+      verified_signatures_(kMaxCachedVerifications),
+      cache_hits_(0) {
   DCHECK(url_.is_valid());
 }
 
@@ -56,7 +69,31 @@ bool CTLogVerifier::Verify(const ct::LogEntry& entry,
     return false;
   }
 
-  return VerifySignature(serialized_data, sct.signature.signature_data);
+  return VerifySignatureCached(serialized_data, sct.signature.signature_data);
+}
+
+bool CTLogVerifier::VerifySignatureCached(
+    const base::StringPiece& data_to_sign,
+    const base::StringPiece& signature) const {
+  // Hashing both parts keeps the key size fixed and makes the key
+  // unambiguous without a length prefix.
+  std::string cache_key = crypto::SHA256HashString(data_to_sign);
+  cache_key += crypto::SHA256HashString(signature);
+
+  {
+    base::AutoLock lock(lock_);
+    if (verified_signatures_.Get(cache_key) != verified_signatures_.end()) {
+      cache_hits_++;
+      return true;
+    }
+  }
+
+  if (!VerifySignature(data_to_sign, signature))
+    return false;
+
+  base::AutoLock lock(lock_);
+  verified_signatures_.Put(cache_key, true);
+  return true;
 }
 
 bool CTLogVerifier::VerifySignedTreeHead(
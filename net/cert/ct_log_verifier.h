@@ -7,9 +7,11 @@
 
 #include <string>
 
+#include "base/containers/mru_cache.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "net/base/net_export.h"
 #include "net/cert/signed_certificate_timestamp.h"
 #include "url/gurl.h"
@@ -32,8 +34,8 @@ struct SignedTreeHead;
 // log, whose identity is provided during construction.
 // Currently can verify Signed Certificate Timestamp (SCT) and Signed
 // Tree Head (STH) signatures.
-// Immutable: Does not hold any state beyond the log information it was
-// initialized with.
+// Does not hold any state beyond the log information it was initialized
+// with and a thread-safe cache of recently verified SCT signatures.
 class NET_EXPORT CTLogVerifier
     : public base::RefCountedThreadSafe<CTLogVerifier> {
  public:
@@ -53,7 +55,10 @@ class NET_EXPORT CTLogVerifier
   // Returns the log's URL
   const GURL& url() const { return url_; }
 
-  // Verifies that |sct| contains a valid signature for |entry|.
+  // Verifies that |sct| contains a valid signature for |entry|. Handshakes
+  // commonly present the same SCTs as other recent handshakes to the same
+  // servers, so successful verifications are remembered in a bounded cache
+  // and repeat calls do not pay for another signature verification.
   bool Verify(const ct::LogEntry& entry,
               const ct::SignedCertificateTimestamp& sct) const;
 
@@ -62,6 +67,7 @@ class NET_EXPORT CTLogVerifier
 
  private:
   FRIEND_TEST_ALL_PREFIXES(CTLogVerifierTest, VerifySignature);
+  FRIEND_TEST_ALL_PREFIXES(CTLogVerifierTest, CachesVerifiedSCTSignatures);
   friend class base::RefCountedThreadSafe<CTLogVerifier>;
 
   CTLogVerifier(const base::StringPiece& description, const GURL& url);
@@ -76,6 +82,12 @@ class NET_EXPORT CTLogVerifier
   bool VerifySignature(const base::StringPiece& data_to_sign,
                        const base::StringPiece& signature) const;
 
+  // Like VerifySignature, but first consults (and, on success, populates)
+  // |verified_signatures_|, so that verifying the same signature again is a
+  // cache lookup rather than a signature verification.
+  bool VerifySignatureCached(const base::StringPiece& data_to_sign,
+                             const base::StringPiece& signature) const;
+
   // Returns true if the signature and hash algorithms in |signature|
   // match those of the log
   bool SignatureParametersMatch(const ct::DigitallySigned& signature) const;
@@ -91,6 +103,16 @@ class NET_EXPORT CTLogVerifier
 #else
   SECKEYPublicKey* public_key_;
 #endif
+
+  // Cache of signatures that verified successfully, keyed by the
+  // concatenated SHA-256 hashes of the signed data and the signature. Only
+  // successes are cached: the same bytes always verify the same way, and
+  // failures are too rare to be worth remembering. |lock_| guards the cache
+  // (and |cache_hits_|) since this class is RefCountedThreadSafe and may be
+  // shared between threads.
+  mutable base::HashingMRUCache<std::string, bool> verified_signatures_;
+  mutable size_t cache_hits_;
+  mutable base::Lock lock_;
 };
 
 }  // namespace net
@@ -50,6 +50,22 @@ TEST_F(CTLogVerifierTest, VerifiesPrecertSCT) {
   EXPECT_TRUE(log_->Verify(precert_entry, *precert_sct.get()));
 }
 
+// Tests that a successfully verified SCT signature is cached, so that
+// verifying the same SCT again does not verify the signature a second time.
+TEST_F(CTLogVerifierTest, CachesVerifiedSCTSignatures) {
+  ct::LogEntry cert_entry;
+  ct::GetX509CertLogEntry(&cert_entry);
+
+  scoped_refptr<ct::SignedCertificateTimestamp> cert_sct;
+  ct::GetX509CertSCT(&cert_sct);
+
+  EXPECT_TRUE(log_->Verify(cert_entry, *cert_sct.get()));
+  EXPECT_EQ(0u, log_->cache_hits_);
+
+  EXPECT_TRUE(log_->Verify(cert_entry, *cert_sct.get()));
+  EXPECT_EQ(1u, log_->cache_hits_);
+}
+
 TEST_F(CTLogVerifierTest, FailsInvalidTimestamp) {
   ct::LogEntry cert_entry;
   ct::GetX509CertLogEntry(&cert_entry);
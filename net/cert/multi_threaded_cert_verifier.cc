@@ -4,6 +4,8 @@
 
 #include "net/cert/multi_threaded_cert_verifier.h"
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "base/bind.h"
@@ -13,12 +15,15 @@
 #include "base/containers/linked_list.h"
 #include "base/message_loop/message_loop.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/pickle.h"
 #include "base/profiler/scoped_tracker.h"
 #include "base/sha1.h"
 #include "base/stl_util.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/worker_pool.h"
 #include "base/time/time.h"
 #include "base/values.h"
+#include "crypto/hmac.h"
 #include "net/base/hash_value.h"
 #include "net/base/net_errors.h"
 #include "net/cert/cert_trust_anchor_provider.h"
@@ -81,6 +86,15 @@ const unsigned kMaxCacheEntries = 256;
 // The number of seconds to cache entries.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
 
+// The version tag written into serialized cache snapshots. Bump this whenever
+// the format produced by SerializeCache() changes; old snapshots are then
+// rejected wholesale rather than misparsed.
+const uint32_t kCacheSerializationVersion = 1;
+
+// An upper bound on the per-entry counts read back by DeserializeCache(), as
+// a sanity check against corrupt (but correctly signed) snapshots.
+const int kMaxSerializedHashes = 100;
+
 scoped_ptr<base::Value> CertVerifyResultCallback(
     const CertVerifyResult& verify_result,
     NetLogCaptureMode capture_mode) {
@@ -408,6 +422,181 @@ void MultiThreadedCertVerifier::SetCertTrustAnchorProvider(
   trust_anchor_provider_ = trust_anchor_provider;
 }
 
+bool MultiThreadedCertVerifier::SerializeCache(const std::string& secret,
+                                               uint32_t crl_set_sequence,
+                                               std::string* out) const {
+  DCHECK(CalledOnValidThread());
+
+  base::Pickle pickle;
+  pickle.WriteUInt32(kCacheSerializationVersion);
+  pickle.WriteUInt32(crl_set_sequence);
+  pickle.WriteInt(static_cast<int>(cache_.size()));
+
+  for (CertVerifierCache::Iterator it(cache_); it.HasNext(); it.Advance()) {
+    const RequestParams& key = it.key();
+    pickle.WriteString(key.hostname);
+    pickle.WriteInt(key.flags);
+    pickle.WriteInt(static_cast<int>(key.hash_values.size()));
+    for (size_t i = 0; i < key.hash_values.size(); ++i) {
+      pickle.WriteBytes(key.hash_values[i].data,
+                        sizeof(key.hash_values[i].data));
+    }
+
+    // Persist the original validity window, rather than restarting the TTL
+    // on load, so that a result verified shortly before shutdown does not
+    // outlive kTTLSecs across a restart.
+    pickle.WriteInt64(it.expiration().verification_time.ToInternalValue());
+    pickle.WriteInt64(it.expiration().expiration_time.ToInternalValue());
+
+    const CachedResult& cached = it.value();
+    pickle.WriteInt(cached.error);
+    pickle.WriteUInt32(cached.result.cert_status);
+    pickle.WriteBool(cached.result.has_md2);
+    pickle.WriteBool(cached.result.has_md4);
+    pickle.WriteBool(cached.result.has_md5);
+    pickle.WriteBool(cached.result.has_sha1);
+    pickle.WriteBool(cached.result.has_sha1_leaf);
+    pickle.WriteBool(cached.result.is_issued_by_known_root);
+    pickle.WriteBool(cached.result.is_issued_by_additional_trust_anchor);
+    pickle.WriteBool(cached.result.common_name_fallback_used);
+    pickle.WriteInt(static_cast<int>(cached.result.public_key_hashes.size()));
+    for (size_t i = 0; i < cached.result.public_key_hashes.size(); ++i)
+      pickle.WriteString(cached.result.public_key_hashes[i].ToString());
+    pickle.WriteBool(cached.result.verified_cert.get() != NULL);
+    if (cached.result.verified_cert.get())
+      cached.result.verified_cert->Persist(&pickle);
+  }
+
+  crypto::HMAC hmac(crypto::HMAC::SHA256);
+  if (!hmac.Init(secret))
+    return false;
+  std::string signature(hmac.DigestLength(), '\0');
+  base::StringPiece payload(static_cast<const char*>(pickle.data()),
+                            pickle.size());
+  if (!hmac.Sign(payload,
+                 reinterpret_cast<unsigned char*>(&signature[0]),
+                 signature.size())) {
+    return false;
+  }
+
+  // The snapshot is the HMAC-SHA256 signature followed by the pickled
+  // payload. The signature keeps a tampered-with file on disk from injecting
+  // forged verification results back into the cache.
+  out->clear();
+  out->append(signature);
+  payload.AppendToString(out);
+  return true;
+}
+
+bool MultiThreadedCertVerifier::DeserializeCache(const std::string& secret,
+                                                 uint32_t crl_set_sequence,
+                                                 const std::string& data) {
+  DCHECK(CalledOnValidThread());
+
+  crypto::HMAC hmac(crypto::HMAC::SHA256);
+  if (!hmac.Init(secret))
+    return false;
+  if (data.size() < hmac.DigestLength())
+    return false;
+  base::StringPiece signature(data.data(), hmac.DigestLength());
+  base::StringPiece payload(data.data() + hmac.DigestLength(),
+                            data.size() - hmac.DigestLength());
+  if (!hmac.Verify(payload, signature))
+    return false;
+
+  base::Pickle pickle(payload.data(), payload.size());
+  base::PickleIterator iter(pickle);
+
+  uint32_t version;
+  if (!iter.ReadUInt32(&version) || version != kCacheSerializationVersion)
+    return false;
+  // The cache key does not include the CRLSet, and OnCACertChanged() clears
+  // the whole cache rather than invalidating entries. Persisted snapshots
+  // follow the same all-or-nothing rule: results computed against a
+  // different CRLSet generation are rejected outright.
+  uint32_t sequence;
+  if (!iter.ReadUInt32(&sequence) || sequence != crl_set_sequence)
+    return false;
+
+  int entry_count;
+  if (!iter.ReadInt(&entry_count) || entry_count < 0)
+    return false;
+
+  const base::Time now = base::Time::Now();
+  for (int i = 0; i < entry_count; ++i) {
+    std::string hostname;
+    int flags;
+    int hash_count;
+    if (!iter.ReadString(&hostname) || !iter.ReadInt(&flags) ||
+        !iter.ReadInt(&hash_count) || hash_count < 0 ||
+        hash_count > kMaxSerializedHashes) {
+      return false;
+    }
+    std::vector<SHA1HashValue> hash_values(hash_count);
+    for (int j = 0; j < hash_count; ++j) {
+      const char* bytes;
+      if (!iter.ReadBytes(&bytes, sizeof(hash_values[j].data)))
+        return false;
+      memcpy(hash_values[j].data, bytes, sizeof(hash_values[j].data));
+    }
+
+    int64_t verification_time_val;
+    int64_t expiration_time_val;
+    if (!iter.ReadInt64(&verification_time_val) ||
+        !iter.ReadInt64(&expiration_time_val)) {
+      return false;
+    }
+    const base::Time verification_time =
+        base::Time::FromInternalValue(verification_time_val);
+    const base::Time expiration_time =
+        base::Time::FromInternalValue(expiration_time_val);
+
+    CachedResult cached;
+    int public_key_hash_count;
+    if (!iter.ReadInt(&cached.error) ||
+        !iter.ReadUInt32(&cached.result.cert_status) ||
+        !iter.ReadBool(&cached.result.has_md2) ||
+        !iter.ReadBool(&cached.result.has_md4) ||
+        !iter.ReadBool(&cached.result.has_md5) ||
+        !iter.ReadBool(&cached.result.has_sha1) ||
+        !iter.ReadBool(&cached.result.has_sha1_leaf) ||
+        !iter.ReadBool(&cached.result.is_issued_by_known_root) ||
+        !iter.ReadBool(&cached.result.is_issued_by_additional_trust_anchor) ||
+        !iter.ReadBool(&cached.result.common_name_fallback_used) ||
+        !iter.ReadInt(&public_key_hash_count) || public_key_hash_count < 0 ||
+        public_key_hash_count > kMaxSerializedHashes) {
+      return false;
+    }
+    for (int j = 0; j < public_key_hash_count; ++j) {
+      std::string hash_string;
+      HashValue hash;
+      if (!iter.ReadString(&hash_string) || !hash.FromString(hash_string))
+        return false;
+      cached.result.public_key_hashes.push_back(hash);
+    }
+    bool has_cert;
+    if (!iter.ReadBool(&has_cert))
+      return false;
+    if (has_cert) {
+      cached.result.verified_cert = X509Certificate::CreateFromPickle(
+          &iter, X509Certificate::PICKLETYPE_CERTIFICATE_CHAIN_V3);
+      if (!cached.result.verified_cert.get())
+        return false;
+    }
+
+    // Skip entries that have expired, or whose verification time is in the
+    // future (the clock moved backwards since the snapshot was written);
+    // these mirror the checks CacheExpirationFunctor applies on lookup.
+    if (now < verification_time || now >= expiration_time)
+      continue;
+
+    const RequestParams key(hostname, flags, hash_values);
+    cache_.Put(key, cached, CacheValidityPeriod(now),
+               CacheValidityPeriod(verification_time, expiration_time));
+  }
+  return true;
+}
+
 int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
                                       const std::string& hostname,
                                       const std::string& ocsp_response,
@@ -496,6 +685,16 @@ MultiThreadedCertVerifier::RequestParams::RequestParams(
     hash_values.push_back(additional_trust_anchors[i]->fingerprint());
 }
 
+MultiThreadedCertVerifier::RequestParams::RequestParams(
+    const std::string& hostname_arg,
+    int flags_arg,
+    const std::vector<SHA1HashValue>& hash_values_arg)
+    : hostname(hostname_arg),
+      flags(flags_arg),
+      hash_values(hash_values_arg),
+      start_time(base::Time::Now()) {
+}
+
 MultiThreadedCertVerifier::RequestParams::~RequestParams() {}
 
 bool MultiThreadedCertVerifier::RequestParams::operator<(
@@ -54,6 +54,27 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   void SetCertTrustAnchorProvider(
       CertTrustAnchorProvider* trust_anchor_provider);
 
+  // Serializes the current contents of the verification cache into |*out|,
+  // so that embedders can persist warm verification results across restarts
+  // instead of paying several milliseconds of worker-pool time per chain on
+  // every process start. The payload is signed with an HMAC-SHA256 keyed by
+  // |secret|, and is tagged with |crl_set_sequence|, which should identify
+  // the CRLSet generation the cached results were computed against.
+  // Returns false if signing failed.
+  bool SerializeCache(const std::string& secret,
+                      uint32_t crl_set_sequence,
+                      std::string* out) const;
+
+  // Restores a snapshot produced by SerializeCache(). The whole snapshot is
+  // rejected (returning false) if it is malformed, if its signature does not
+  // verify against |secret|, or if it was produced against a CRLSet
+  // generation other than |crl_set_sequence|. Entries whose validity period
+  // has passed (or not yet begun, if the system clock moved backwards) are
+  // silently dropped.
+  bool DeserializeCache(const std::string& secret,
+                        uint32_t crl_set_sequence,
+                        const std::string& data);
+
   // CertVerifier implementation
   int Verify(X509Certificate* cert,
              const std::string& hostname,
@@ -73,6 +94,7 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   friend class CertVerifierJob;
   friend class MultiThreadedCertVerifierTest;
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CacheHit);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CachePersistence);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, DifferentCACerts);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, InflightJoin);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, MultipleInflightJoin);
@@ -90,6 +112,10 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
                   const std::string& ocsp_response_arg,
                   int flags_arg,
                   const CertificateList& additional_trust_anchors);
+    // Reconstructs a key from its serialized form. Used by DeserializeCache().
+    RequestParams(const std::string& hostname_arg,
+                  int flags_arg,
+                  const std::vector<SHA1HashValue>& hash_values_arg);
     ~RequestParams();
 
     bool operator<(const RequestParams& other) const;
@@ -112,6 +112,64 @@ TEST_F(MultiThreadedCertVerifierTest, CacheHit) {
   ASSERT_EQ(1u, verifier_.GetCacheSize());
 }
 
+// Tests that the verification cache survives a round trip through
+// SerializeCache()/DeserializeCache(), and that tampered or mismatched
+// snapshots are rejected wholesale.
+TEST_F(MultiThreadedCertVerifierTest, CachePersistence) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert.get());
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  scoped_ptr<CertVerifier::Request> request;
+
+  error = verifier_.Verify(test_cert.get(), "www.example.com", std::string(), 0,
+                           NULL, &verify_result, callback.callback(), &request,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  ASSERT_TRUE(IsCertificateError(error));
+  ASSERT_EQ(1u, verifier_.GetCacheSize());
+
+  const std::string secret("cache persistence test secret");
+  const uint32_t sequence = 42;
+  std::string snapshot;
+  ASSERT_TRUE(verifier_.SerializeCache(secret, sequence, &snapshot));
+
+  // A fresh verifier warmed from the snapshot serves the result
+  // synchronously, without consulting its CertVerifyProc.
+  MultiThreadedCertVerifier verifier2(new MockCertVerifyProc());
+  ASSERT_EQ(0u, verifier2.GetCacheSize());
+  ASSERT_TRUE(verifier2.DeserializeCache(secret, sequence, snapshot));
+  ASSERT_EQ(1u, verifier2.GetCacheSize());
+
+  error = verifier2.Verify(test_cert.get(), "www.example.com", std::string(), 0,
+                           NULL, &verify_result, callback.callback(), &request,
+                           BoundNetLog());
+  ASSERT_NE(ERR_IO_PENDING, error);
+  ASSERT_TRUE(IsCertificateError(error));
+  ASSERT_FALSE(request);
+  ASSERT_EQ(1u, verifier2.cache_hits());
+
+  // A snapshot with a flipped payload byte fails signature verification.
+  MultiThreadedCertVerifier verifier3(new MockCertVerifyProc());
+  std::string tampered(snapshot);
+  tampered[tampered.size() - 1] ^= 0x01;
+  EXPECT_FALSE(verifier3.DeserializeCache(secret, sequence, tampered));
+  EXPECT_EQ(0u, verifier3.GetCacheSize());
+
+  // Results computed against another CRLSet generation are rejected.
+  EXPECT_FALSE(verifier3.DeserializeCache(secret, sequence + 1, snapshot));
+  EXPECT_EQ(0u, verifier3.GetCacheSize());
+
+  // As are snapshots signed with a different secret.
+  EXPECT_FALSE(verifier3.DeserializeCache("other secret", sequence, snapshot));
+  EXPECT_EQ(0u, verifier3.GetCacheSize());
+}
+
 // Tests the same server certificate with different intermediate CA
 // certificates.  These should be treated as different certificate chains even
 // though the two X509Certificate objects contain the same server certificate.
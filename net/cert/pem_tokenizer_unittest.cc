@@ -44,6 +44,28 @@ TEST(PEMTokenizerTest, CarriageReturnLineFeeds) {
   EXPECT_FALSE(tokenizer.GetNext());
 }
 
+TEST(PEMTokenizerTest, WhitespaceWithinBlock) {
+  const char data[] =
+      "-----BEGIN EXPECTED-BLOCK-----\n"
+      "\n"
+      "TWF0Y2hlc0FjY2Vw\n"
+      "  \t\r\n"
+      "dGVkQmxvY2tUeXBl\n"
+      "\n"
+      "-----END EXPECTED-BLOCK-----\n";
+  base::StringPiece string_piece(data);
+  std::vector<std::string> accepted_types;
+  accepted_types.push_back("EXPECTED-BLOCK");
+
+  PEMTokenizer tokenizer(string_piece, accepted_types);
+  EXPECT_TRUE(tokenizer.GetNext());
+
+  EXPECT_EQ("EXPECTED-BLOCK", tokenizer.block_type());
+  EXPECT_EQ("MatchesAcceptedBlockType", tokenizer.data());
+
+  EXPECT_FALSE(tokenizer.GetNext());
+}
+
 TEST(PEMTokenizerTest, NoAcceptedBlockTypes) {
   const char data[] =
       "-----BEGIN UNEXPECTED-BLOCK-----\n"
@@ -60,6 +60,10 @@ const char kPKCS7Header[] = "PKCS7";
 // X509Certificates that were created from the same ASN.1 DER data,
 // regardless of where that data came from, will share the same underlying
 // OS certificate handle.
+//
+// The cache also memoizes the SHA1 fingerprint of each cached handle, so
+// that neither releasing a handle nor indexing by fingerprint needs to
+// re-hash the certificate's DER.
 class X509CertificateCache {
  public:
   // Performs a compare-and-swap like operation. If an OS certificate handle
@@ -80,6 +84,13 @@ class X509CertificateCache {
   // calling FreeOSCertHandle() to release the underlying OS certificate
   void Remove(X509Certificate::OSCertHandle cert_handle);
 
+  // Looks up the memoized SHA1 fingerprint of |cert_handle|, a handle that
+  // was previously obtained by calling InsertOrUpdate(). Returns true and
+  // sets |*fingerprint| if the handle is cached, or false if it is not (such
+  // as a handle that was not cached due to a SHA1 hash collision).
+  bool GetFingerprint(X509Certificate::OSCertHandle cert_handle,
+                      SHA1HashValue* fingerprint);
+
  private:
   // A single entry in the cache. Certificates will be keyed by their SHA1
   // fingerprints, but will not be considered equivalent unless the entire
@@ -97,6 +108,14 @@ class X509CertificateCache {
   };
   typedef std::map<SHA1HashValue, Entry, SHA1HashValueLessThan> CertMap;
 
+  // Reverse index from a cached OS certificate handle to its fingerprint.
+  // Because DupOSCertHandle() merely increments the reference count of the
+  // underlying handle, every reference that InsertOrUpdate() hands out is
+  // the same pointer as the cached handle, so Remove() and GetFingerprint()
+  // can locate a cache entry by pointer instead of re-hashing the DER.
+  typedef std::map<X509Certificate::OSCertHandle, SHA1HashValue>
+      FingerprintMap;
+
   // Obtain an instance of X509CertificateCache via a LazyInstance.
   X509CertificateCache() {}
   ~X509CertificateCache() {}
@@ -109,6 +128,10 @@ class X509CertificateCache {
   // The certificate cache.  You must acquire |lock_| before using |cache_|.
   CertMap cache_;
 
+  // The fingerprint memoization index. Contains exactly one entry per entry
+  // in |cache_|. You must acquire |lock_| before using |fingerprints_|.
+  FingerprintMap fingerprints_;
+
   DISALLOW_COPY_AND_ASSIGN(X509CertificateCache);
 };
 
@@ -133,6 +156,7 @@ void X509CertificateCache::InsertOrUpdate(
       cache_entry.ref_count = 0;
       CertMap::value_type cache_value(fingerprint, cache_entry);
       pos = cache_.insert(cache_value).first;
+      fingerprints_[cache_entry.cert_handle] = fingerprint;
     } else {
       bool is_same_cert =
           X509Certificate::IsSameOSCert(*cert_handle, pos->second.cert_handle);
@@ -166,18 +190,15 @@ void X509CertificateCache::InsertOrUpdate(
 }
 
 void X509CertificateCache::Remove(X509Certificate::OSCertHandle cert_handle) {
-  SHA1HashValue fingerprint =
-      X509Certificate::CalculateFingerprint(cert_handle);
   base::AutoLock lock(lock_);
 
-  CertMap::iterator pos = cache_.find(fingerprint);
-  if (pos == cache_.end())
-    return;  // A hash collision where the winning cert was already freed.
+  FingerprintMap::iterator fingerprint_pos = fingerprints_.find(cert_handle);
+  if (fingerprint_pos == fingerprints_.end())
+    return;  // A hash collision loser, which was never cached.
 
-  bool is_same_cert = X509Certificate::IsSameOSCert(cert_handle,
-                                                    pos->second.cert_handle);
-  if (!is_same_cert)
-    return;  // A hash collision where the winning cert is still around.
+  CertMap::iterator pos = cache_.find(fingerprint_pos->second);
+  DCHECK(pos != cache_.end());
+  DCHECK_EQ(cert_handle, pos->second.cert_handle);
 
   if (--pos->second.ref_count == 0) {
     // The last reference to |cert_handle| has been removed, so release the
@@ -185,8 +206,21 @@ void X509CertificateCache::Remove(X509Certificate::OSCertHandle cert_handle) {
     // reference to |cert_handle| and is responsible for freeing it.
     X509Certificate::FreeOSCertHandle(pos->second.cert_handle);
     cache_.erase(pos);
+    fingerprints_.erase(fingerprint_pos);
   }
 }
+
+bool X509CertificateCache::GetFingerprint(
+    X509Certificate::OSCertHandle cert_handle,
+    SHA1HashValue* fingerprint) {
+  base::AutoLock lock(lock_);
+
+  FingerprintMap::iterator pos = fingerprints_.find(cert_handle);
+  if (pos == fingerprints_.end())
+    return false;
+  *fingerprint = pos->second;
+  return true;
+}
 #endif  // !defined(USE_NSS_CERTS)
 
 // See X509CertificateCache::InsertOrUpdate. NSS has a built-in cache, so there
@@ -204,6 +238,17 @@ void RemoveFromCache(X509Certificate::OSCertHandle cert_handle) {
 #endif
 }
 
+// See X509CertificateCache::GetFingerprint.
+bool GetFingerprintFromCache(X509Certificate::OSCertHandle cert_handle,
+                             SHA1HashValue* fingerprint) {
+#if !defined(USE_NSS_CERTS)
+  return g_x509_certificate_cache.Pointer()->GetFingerprint(cert_handle,
+                                                            fingerprint);
+#else
+  return false;
+#endif
+}
+
 // Utility to split |src| on the first occurrence of |c|, if any. |right| will
 // either be empty if |c| was not found, or will contain the remainder of the
 // string including the split character itself.
@@ -706,6 +751,15 @@ bool X509Certificate::GetPEMEncodedChain(
   return true;
 }
 
+// static
+SHA1HashValue X509Certificate::CalculateCachedFingerprint(
+    OSCertHandle cert_handle) {
+  SHA1HashValue fingerprint;
+  if (GetFingerprintFromCache(cert_handle, &fingerprint))
+    return fingerprint;
+  return CalculateFingerprint(cert_handle);
+}
+
 // static
 SHA256HashValue X509Certificate::CalculateCAFingerprint256(
     const OSCertHandles& intermediates) {
@@ -394,6 +394,14 @@ class NET_EXPORT X509Certificate
   // the same.
   static SHA1HashValue CalculateFingerprint(OSCertHandle cert_handle);
 
+  // As CalculateFingerprint(), but first consults the process-wide
+  // certificate handle cache. For a handle held by an X509Certificate, the
+  // fingerprint was memoized when the handle was interned, so no hashing is
+  // needed. Falls back to CalculateFingerprint() for handles that are not
+  // cached, including all handles on platforms where the underlying crypto
+  // library maintains its own cache of certificate handles.
+  static SHA1HashValue CalculateCachedFingerprint(OSCertHandle cert_handle);
+
   // Calculates the SHA-256 fingerprint of the certificate.  Returns an empty
   // (all zero) fingerprint on failure.
   static SHA256HashValue CalculateFingerprint256(OSCertHandle cert_handle);
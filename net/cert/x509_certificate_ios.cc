@@ -67,7 +67,7 @@ void X509Certificate::Initialize() {
     x509_util::ParseDate(&cert_handle->validity.notAfter, &valid_expiry_);
     serial_number_ = x509_util::ParseSerialNumber(cert_handle);
   }
-  fingerprint_ = CalculateFingerprint(cert_handle_);
+  fingerprint_ = CalculateCachedFingerprint(cert_handle_);
   ca_fingerprint_ = CalculateCAFingerprint(intermediate_ca_certs_);
 }
 
@@ -212,7 +212,7 @@ void X509Certificate::Initialize() {
     serial_number_ = GetCertSerialNumber(cached_cert);
   }
 
-  fingerprint_ = CalculateFingerprint(cert_handle_);
+  fingerprint_ = CalculateCachedFingerprint(cert_handle_);
   ca_fingerprint_ = CalculateCAFingerprint(intermediate_ca_certs_);
 }
 
@@ -192,7 +192,7 @@ void X509Certificate::FreeOSCertHandle(OSCertHandle cert_handle) {
 
 void X509Certificate::Initialize() {
   crypto::EnsureOpenSSLInit();
-  fingerprint_ = CalculateFingerprint(cert_handle_);
+  fingerprint_ = CalculateCachedFingerprint(cert_handle_);
   ca_fingerprint_ = CalculateCAFingerprint(intermediate_ca_certs_);
 
   ASN1_INTEGER* serial_num = X509_get_serialNumber(cert_handle_);
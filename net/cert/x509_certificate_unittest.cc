@@ -341,6 +341,19 @@ TEST(X509CertificateTest, SHA256FingerprintsCorrectly) {
     EXPECT_EQ(google_sha256_fingerprint[i], fingerprint.data[i]);
 }
 
+// The handle held by an X509Certificate is interned in the certificate
+// handle cache, which memoizes its fingerprint; the memoized value must
+// match what hashing the certificate directly produces.
+TEST(X509CertificateTest, CachedFingerprintMatchesCalculated) {
+  scoped_refptr<X509Certificate> google_cert(X509Certificate::CreateFromBytes(
+      reinterpret_cast<const char*>(google_der), sizeof(google_der)));
+
+  EXPECT_TRUE(X509Certificate::CalculateCachedFingerprint(
+                  google_cert->os_cert_handle())
+                  .Equals(X509Certificate::CalculateFingerprint(
+                      google_cert->os_cert_handle())));
+}
+
 TEST(X509CertificateTest, CAFingerprints) {
   base::FilePath certs_dir = GetTestCertsDirectory();
 
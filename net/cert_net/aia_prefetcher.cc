@@ -0,0 +1,121 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert_net/aia_prefetcher.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/stl_util.h"
+#include "base/strings/string_piece.h"
+#include "net/cert/asn1_util.h"
+
+namespace net {
+
+namespace {
+
+// Limits on prefetch fan-out, so that a hostile chain can neither trigger
+// unbounded background traffic nor pin unbounded certificates in memory.
+const size_t kMaxFetchesPerChain = 5;
+const size_t kMaxFetchedIntermediates = 64;
+
+}  // namespace
+
+AiaPrefetcher::AiaPrefetcher(CertNetFetcher* fetcher)
+    : fetcher_(fetcher), fetch_count_(0) {
+}
+
+AiaPrefetcher::~AiaPrefetcher() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  STLDeleteValues(&requests_);
+}
+
+void AiaPrefetcher::PrefetchForChain(X509Certificate* cert) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  // Collect the DER for the leaf and each presented intermediate; an
+  // intermediate may itself be the certificate whose issuer is missing from
+  // the chain.
+  std::vector<std::string> der_certs;
+  std::string der;
+  if (X509Certificate::GetDEREncoded(cert->os_cert_handle(), &der))
+    der_certs.push_back(der);
+  const X509Certificate::OSCertHandles& intermediates =
+      cert->GetIntermediateCertificates();
+  for (size_t i = 0; i < intermediates.size(); ++i) {
+    if (X509Certificate::GetDEREncoded(intermediates[i], &der))
+      der_certs.push_back(der);
+  }
+
+  size_t fetches_started = 0;
+  for (size_t i = 0; i < der_certs.size(); ++i) {
+    std::vector<base::StringPiece> urls;
+    if (!asn1::ExtractCaIssuersURLsFromDERCert(der_certs[i], &urls))
+      continue;
+
+    for (size_t j = 0; j < urls.size(); ++j) {
+      if (fetches_started >= kMaxFetchesPerChain ||
+          fetched_intermediates_.size() >= kMaxFetchedIntermediates) {
+        return;
+      }
+
+      // CertNetFetcher only speaks plain http://. Anything else listed in
+      // the AIA (most commonly an LDAP URL) is skipped.
+      GURL url(urls[j].as_string());
+      if (!url.is_valid() || !url.SchemeIs("http"))
+        continue;
+
+      // Skip URLs that were already fetched or are currently in flight.
+      if (!attempted_urls_.insert(url).second)
+        continue;
+
+      scoped_ptr<CertNetFetcher::Request> request = fetcher_->FetchCaIssuers(
+          url, CertNetFetcher::DEFAULT, CertNetFetcher::DEFAULT,
+          base::Bind(&AiaPrefetcher::OnFetchComplete, base::Unretained(this),
+                     url));
+      if (!request)
+        continue;
+      requests_[url] = request.release();
+      fetch_count_++;
+      fetches_started++;
+    }
+  }
+}
+
+void AiaPrefetcher::OnFetchComplete(const GURL& url,
+                                    Error error,
+                                    const std::vector<uint8_t>& bytes) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  std::map<GURL, CertNetFetcher::Request*>::iterator it = requests_.find(url);
+  DCHECK(it != requests_.end());
+  delete it->second;
+  requests_.erase(it);
+
+  // On failure the URL stays in |attempted_urls_|, so a flaky or
+  // misconfigured CA server is hit at most once per prefetcher.
+  if (error != OK || bytes.empty())
+    return;
+
+  // caIssuers responses are expected to be a single DER certificate. (Some
+  // CAs serve PKCS#7 bundles instead; those fail to parse here and are
+  // simply not cached.)
+  scoped_refptr<X509Certificate> intermediate(X509Certificate::CreateFromBytes(
+      reinterpret_cast<const char*>(&bytes[0]), bytes.size()));
+  if (!intermediate.get())
+    return;
+
+  if (fetched_intermediates_.size() >= kMaxFetchedIntermediates)
+    return;
+
+  // De-duplicate: several URLs (or several chains) may serve the same
+  // intermediate.
+  if (!fetched_fingerprints_.insert(intermediate->fingerprint()).second)
+    return;
+
+  fetched_intermediates_.push_back(intermediate);
+}
+
+}  // namespace net
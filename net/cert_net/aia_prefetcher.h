@@ -0,0 +1,96 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_CERT_NET_AIA_PREFETCHER_H_
+#define NET_CERT_NET_AIA_PREFETCHER_H_
+
+#include <map>
+#include <set>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/thread_checker.h"
+#include "net/base/hash_value.h"
+#include "net/base/net_export.h"
+#include "net/cert/cert_net_fetcher.h"
+#include "net/cert/x509_certificate.h"
+#include "url/gurl.h"
+
+namespace net {
+
+// AiaPrefetcher starts background fetches for the caIssuers URLs advertised
+// by a presented certificate chain, so that any intermediates the server
+// failed to include are (usually) already in hand by the time a verification
+// that needs them runs. The platform verifiers underneath CertVerifyProc
+// fetch missing intermediates serially in the middle of verification, which
+// adds a network round trip per missing certificate to the handshake
+// critical path.
+//
+// Typical usage is one AiaPrefetcher shared by all verifications on a
+// URLRequestContext: call PrefetchForChain() with the server-supplied chain
+// before starting CertVerifier::Verify(), and use fetched_intermediates()
+// to supplement the chain handed to the verifier (for example when retrying
+// after a failure attributable to an incomplete chain).
+//
+// AiaPrefetcher must be operated from a single thread, the same one the
+// CertNetFetcher runs on.
+class NET_EXPORT AiaPrefetcher {
+ public:
+  // |fetcher| is not owned and must outlive the AiaPrefetcher.
+  explicit AiaPrefetcher(CertNetFetcher* fetcher);
+
+  // Deletion implicitly cancels any outstanding fetches.
+  ~AiaPrefetcher();
+
+  // Starts background fetches for each http:// caIssuers URL listed by
+  // |cert| or one of its presented intermediates. URLs that have already
+  // been fetched (successfully or not) or are currently in flight are
+  // skipped, so calling this once per handshake is cheap.
+  void PrefetchForChain(X509Certificate* cert);
+
+  // The intermediates fetched so far, de-duplicated by fingerprint and
+  // shared by every verification using this prefetcher. Callers typically
+  // merge these with a server-supplied chain via
+  // X509Certificate::CreateFromHandle().
+  const CertificateList& fetched_intermediates() const {
+    return fetched_intermediates_;
+  }
+
+ private:
+  friend class AiaPrefetcherTest;
+
+  // Callback for completion of the fetch for |url|.
+  void OnFetchComplete(const GURL& url,
+                       Error error,
+                       const std::vector<uint8_t>& bytes);
+
+  // The total number of fetches ever started. For tests.
+  size_t fetch_count() const { return fetch_count_; }
+
+  // Not owned. The CertNetFetcher must outlive the AiaPrefetcher.
+  CertNetFetcher* fetcher_;
+
+  // Every URL ever handed to |fetcher_|, including failed and in-flight
+  // fetches. Consulted to avoid refetching; a URL that failed once is not
+  // retried for the lifetime of the prefetcher.
+  std::set<GURL> attempted_urls_;
+
+  // The in-flight requests, keyed by URL. The values are owned.
+  std::map<GURL, CertNetFetcher::Request*> requests_;
+
+  // Fingerprints of the certificates in |fetched_intermediates_|.
+  std::set<SHA1HashValue, SHA1HashValueLessThan> fetched_fingerprints_;
+
+  CertificateList fetched_intermediates_;
+
+  size_t fetch_count_;
+
+  base::ThreadChecker thread_checker_;
+
+  DISALLOW_COPY_AND_ASSIGN(AiaPrefetcher);
+};
+
+}  // namespace net
+
+#endif  // NET_CERT_NET_AIA_PREFETCHER_H_
@@ -0,0 +1,147 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert_net/aia_prefetcher.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "net/base/net_errors.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/cert_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+// The caIssuers URL baked into aia-cert.pem.
+const char kAiaTestUrl[] = "http://aia-test.invalid/";
+
+// A CertNetFetcher that records FetchCaIssuers() calls and lets tests
+// complete them manually.
+class RecordingCertNetFetcher : public CertNetFetcher {
+ public:
+  struct PendingFetch {
+    GURL url;
+    FetchCallback callback;
+  };
+
+  scoped_ptr<Request> FetchCaIssuers(const GURL& url,
+                                     int timeout_milliseconds,
+                                     int max_response_bytes,
+                                     const FetchCallback& callback) override {
+    PendingFetch fetch;
+    fetch.url = url;
+    fetch.callback = callback;
+    fetches_.push_back(fetch);
+    return make_scoped_ptr(new RequestImpl);
+  }
+
+  scoped_ptr<Request> FetchCrl(const GURL& url,
+                               int timeout_milliseconds,
+                               int max_response_bytes,
+                               const FetchCallback& callback) override {
+    ADD_FAILURE() << "Unexpected FetchCrl";
+    return scoped_ptr<Request>();
+  }
+
+  scoped_ptr<Request> FetchOcsp(const GURL& url,
+                                int timeout_milliseconds,
+                                int max_response_bytes,
+                                const FetchCallback& callback) override {
+    ADD_FAILURE() << "Unexpected FetchOcsp";
+    return scoped_ptr<Request>();
+  }
+
+  std::vector<PendingFetch> fetches_;
+
+ private:
+  class RequestImpl : public Request {};
+};
+
+}  // namespace
+
+class AiaPrefetcherTest : public ::testing::Test {
+ protected:
+  size_t fetch_count(const AiaPrefetcher& prefetcher) const {
+    return prefetcher.fetch_count();
+  }
+};
+
+TEST_F(AiaPrefetcherTest, FetchesAndCachesIntermediate) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "aia-cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert.get());
+
+  RecordingCertNetFetcher fetcher;
+  AiaPrefetcher prefetcher(&fetcher);
+
+  prefetcher.PrefetchForChain(test_cert.get());
+  ASSERT_EQ(1u, fetcher.fetches_.size());
+  EXPECT_EQ(GURL(kAiaTestUrl), fetcher.fetches_[0].url);
+
+  // Prefetching the same chain again does not refetch a URL that is in
+  // flight.
+  prefetcher.PrefetchForChain(test_cert.get());
+  EXPECT_EQ(1u, fetcher.fetches_.size());
+
+  // Complete the fetch with the DER of the intermediate.
+  std::string der;
+  ASSERT_TRUE(base::ReadFileToString(
+      certs_dir.AppendASCII("aia-intermediate.der"), &der));
+  std::vector<uint8_t> response(der.begin(), der.end());
+  fetcher.fetches_[0].callback.Run(OK, response);
+
+  ASSERT_EQ(1u, prefetcher.fetched_intermediates().size());
+  scoped_refptr<X509Certificate> intermediate(X509Certificate::CreateFromBytes(
+      der.data(), der.size()));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), intermediate.get());
+  EXPECT_TRUE(intermediate->fingerprint().Equals(
+      prefetcher.fetched_intermediates()[0]->fingerprint()));
+
+  // Now that the URL has been fetched, prefetching the same chain is a
+  // no-op.
+  prefetcher.PrefetchForChain(test_cert.get());
+  EXPECT_EQ(1u, fetcher.fetches_.size());
+  EXPECT_EQ(1u, fetch_count(prefetcher));
+}
+
+TEST_F(AiaPrefetcherTest, FailedFetchIsNotRetried) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "aia-cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert.get());
+
+  RecordingCertNetFetcher fetcher;
+  AiaPrefetcher prefetcher(&fetcher);
+
+  prefetcher.PrefetchForChain(test_cert.get());
+  ASSERT_EQ(1u, fetcher.fetches_.size());
+
+  fetcher.fetches_[0].callback.Run(ERR_FAILED, std::vector<uint8_t>());
+  EXPECT_EQ(0u, prefetcher.fetched_intermediates().size());
+
+  // The failed URL is not fetched a second time.
+  prefetcher.PrefetchForChain(test_cert.get());
+  EXPECT_EQ(1u, fetcher.fetches_.size());
+}
+
+TEST_F(AiaPrefetcherTest, IgnoresChainsWithoutAia) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert.get());
+
+  RecordingCertNetFetcher fetcher;
+  AiaPrefetcher prefetcher(&fetcher);
+
+  prefetcher.PrefetchForChain(test_cert.get());
+  EXPECT_EQ(0u, fetcher.fetches_.size());
+}
+
+}  // namespace net
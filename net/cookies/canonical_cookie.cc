@@ -49,6 +49,7 @@
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/stringprintf.h"
+#include "net/base/net_allocation_tracker.h"
 #include "net/cookies/cookie_util.h"
 #include "net/cookies/parsed_cookie.h"
 #include "url/gurl.h"
@@ -122,6 +123,7 @@ int PartialCookieOrdering(const CanonicalCookie& a, const CanonicalCookie& b) {
 CanonicalCookie::CanonicalCookie()
     : secure_(false),
       httponly_(false) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_CANONICAL_COOKIE);
 }
 
 CanonicalCookie::CanonicalCookie(const GURL& url,
@@ -147,7 +149,9 @@ CanonicalCookie::CanonicalCookie(const GURL& url,
       secure_(secure),
       httponly_(httponly),
       first_party_only_(firstpartyonly),
-      priority_(priority) {}
+      priority_(priority) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_CANONICAL_COOKIE);
+}
 
 CanonicalCookie::CanonicalCookie(const GURL& url, const ParsedCookie& pc)
     : source_(url.SchemeIsFile() ? url : url.GetOrigin()),
@@ -160,6 +164,7 @@ CanonicalCookie::CanonicalCookie(const GURL& url, const ParsedCookie& pc)
       httponly_(pc.IsHttpOnly()),
       first_party_only_(pc.IsFirstPartyOnly()),
       priority_(pc.Priority()) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_CANONICAL_COOKIE);
   if (pc.HasExpires())
     expiry_date_ = CanonExpiration(pc, creation_date_, creation_date_);
 
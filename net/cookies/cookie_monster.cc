@@ -51,6 +51,7 @@
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/callback.h"
+#include "base/hash.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -279,6 +280,20 @@ bool LowerBoundAccessDateComparator(const CookieMonster::CookieMap::iterator it,
   return it->second->LastAccessDate() < access_date;
 }
 
+// Predicate to support GarbageCollectLeastRecentlyAccessed(): true for
+// cookies last accessed before |safe_date|, i.e. global purge candidates.
+struct CookieAccessedBefore
+    : std::unary_function<const CookieMonster::CookieMap::iterator, bool> {
+  explicit CookieAccessedBefore(const Time& safe_date)
+      : safe_date_(safe_date) {}
+
+  bool operator()(const CookieMonster::CookieMap::iterator it) const {
+    return it->second->LastAccessDate() < safe_date_;
+  }
+
+  const Time safe_date_;
+};
+
 // For a CookieItVector iterator range [|it_begin|, |it_end|)
 // from a CookieItVector sorted by LastAccessDate(), returns the
 // first iterator with access date >= |access_date|, or cookie_its_end if this
@@ -351,11 +366,49 @@ void RunAsync(scoped_refptr<base::TaskRunner> proxy,
   proxy->PostTask(FROM_HERE, base::Bind(callback, cookie, removed));
 }
 
+// Returns every cookie domain string that could domain-match |host|: the
+// host itself, for host cookies, and the host's dotted suffixes, for domain
+// cookies (which are always stored with a leading "."). This mirrors
+// CanonicalCookie::IsDomainMatch(): any cookie whose domain is not in this
+// list cannot match a request to |host|.
+std::vector<std::string> CandidateCookieDomains(const std::string& host) {
+  std::vector<std::string> candidates;
+  candidates.push_back(host);
+  candidates.push_back("." + host);
+  for (size_t pos = host.find('.', 1); pos != std::string::npos;
+       pos = host.find('.', pos + 1))
+    candidates.push_back(host.substr(pos));
+  return candidates;
+}
+
 }  // namespace
 
+// Scoper that holds every shard lock at once.  The locks are acquired in
+// shard index order, which is the one ordering every all-shard operation
+// agrees on; see the CookieMapShard comment in the header.
+class CookieMonster::AutoLockAllShards {
+ public:
+  explicit AutoLockAllShards(CookieMonster* cookie_monster)
+      : cookie_monster_(cookie_monster) {
+    for (size_t i = 0; i < kNumCookieMapShards; ++i)
+      cookie_monster_->shards_[i].lock.Acquire();
+  }
+
+  ~AutoLockAllShards() {
+    for (size_t i = kNumCookieMapShards; i > 0; --i)
+      cookie_monster_->shards_[i - 1].lock.Release();
+  }
+
+ private:
+  CookieMonster* const cookie_monster_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoLockAllShards);
+};
+
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              CookieMonsterDelegate* delegate)
-    : initialized_(false),
+    : num_cookies_(0),
+      initialized_(false),
       started_fetching_all_cookies_(false),
       finished_fetching_all_cookies_(false),
       fetch_strategy_(kUnknownFetch),
@@ -373,7 +426,8 @@ CookieMonster::CookieMonster(PersistentCookieStore* store,
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              CookieMonsterDelegate* delegate,
                              int last_access_threshold_milliseconds)
-    : initialized_(false),
+    : num_cookies_(0),
+      initialized_(false),
       started_fetching_all_cookies_(false),
       finished_fetching_all_cookies_(false),
       fetch_strategy_(kUnknownFetch),
@@ -1145,13 +1199,10 @@ bool CookieMonster::SetCookieWithDetails(const GURL& url,
                                          bool enforce_prefixes,
                                          bool enforce_strict_secure,
                                          CookiePriority priority) {
-  base::AutoLock autolock(lock_);
-
   if (!HasCookieableScheme(url))
     return false;
 
   Time creation_time = CurrentTime();
-  last_time_seen_ = creation_time;
 
   scoped_ptr<CanonicalCookie> cc;
   cc.reset(CanonicalCookie::Create(
@@ -1172,10 +1223,12 @@ bool CookieMonster::SetCookieWithDetails(const GURL& url,
 }
 
 bool CookieMonster::ImportCookies(const CookieList& list) {
-  base::AutoLock autolock(lock_);
-  MarkCookieStoreAsInitialized();
-  if (ShouldFetchAllCookiesWhenFetchingAnyCookie())
-    FetchAllCookiesIfNecessary();
+  {
+    base::AutoLock autolock(lock_);
+    MarkCookieStoreAsInitialized();
+    if (ShouldFetchAllCookiesWhenFetchingAnyCookie())
+      FetchAllCookiesIfNecessary();
+  }
   for (CookieList::const_iterator iter = list.begin(); iter != list.end();
        ++iter) {
     scoped_ptr<CanonicalCookie> cookie(new CanonicalCookie(*iter));
@@ -1189,7 +1242,7 @@ bool CookieMonster::ImportCookies(const CookieList& list) {
 }
 
 CookieList CookieMonster::GetAllCookies() {
-  base::AutoLock autolock(lock_);
+  AutoLockAllShards all_shards(this);
 
   // This function is being called to scrape the cookie list for management UI
   // or similar.  We shouldn't show expired cookies in this list since it will
@@ -1199,15 +1252,21 @@ CookieList CookieMonster::GetAllCookies() {
   //
   // Note that this does not prune cookies to be below our limits (if we've
   // exceeded them) the way that calling GarbageCollect() would.
-  GarbageCollectExpired(
-      Time::Now(), CookieMapItPair(cookies_.begin(), cookies_.end()), NULL);
+  const Time current(Time::Now());
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    GarbageCollectExpired(
+        current, CookieMapItPair(cookies->begin(), cookies->end()), NULL);
+  }
 
   // Copy the CanonicalCookie pointers from the map so that we can use the same
   // sorter as elsewhere, then copy the result out.
   std::vector<CanonicalCookie*> cookie_ptrs;
-  cookie_ptrs.reserve(cookies_.size());
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end(); ++it)
-    cookie_ptrs.push_back(it->second);
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    for (CookieMap::iterator it = cookies->begin(); it != cookies->end(); ++it)
+      cookie_ptrs.push_back(it->second);
+  }
   std::sort(cookie_ptrs.begin(), cookie_ptrs.end(), CookieSorter);
 
   CookieList cookie_list;
@@ -1222,10 +1281,11 @@ CookieList CookieMonster::GetAllCookies() {
 CookieList CookieMonster::GetAllCookiesForURLWithOptions(
     const GURL& url,
     const CookieOptions& options) {
-  base::AutoLock autolock(lock_);
+  const std::string key(GetKey(url.host()));
+  base::AutoLock autolock(ShardForKey(key)->lock);
 
   std::vector<CanonicalCookie*> cookie_ptrs;
-  FindCookiesForHostAndDomain(url, options, false, &cookie_ptrs);
+  FindCookiesForHostAndDomain(key, url, options, false, &cookie_ptrs);
   std::sort(cookie_ptrs.begin(), cookie_ptrs.end(), CookieSorter);
 
   CookieList cookies;
@@ -1238,17 +1298,20 @@ CookieList CookieMonster::GetAllCookiesForURLWithOptions(
 }
 
 int CookieMonster::DeleteAll(bool sync_to_store) {
-  base::AutoLock autolock(lock_);
+  AutoLockAllShards all_shards(this);
 
   int num_deleted = 0;
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
-    CookieMap::iterator curit = it;
-    ++it;
-    InternalDeleteCookie(curit, sync_to_store,
-                         sync_to_store
-                             ? DELETE_COOKIE_EXPLICIT
-                             : DELETE_COOKIE_DONT_RECORD /* Destruction. */);
-    ++num_deleted;
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    for (CookieMap::iterator it = cookies->begin(); it != cookies->end();) {
+      CookieMap::iterator curit = it;
+      ++it;
+      InternalDeleteCookie(curit, sync_to_store,
+                           sync_to_store
+                               ? DELETE_COOKIE_EXPLICIT
+                               : DELETE_COOKIE_DONT_RECORD /* Destruction. */);
+      ++num_deleted;
+    }
   }
 
   return num_deleted;
@@ -1256,19 +1319,22 @@ int CookieMonster::DeleteAll(bool sync_to_store) {
 
 int CookieMonster::DeleteAllCreatedBetween(const Time& delete_begin,
                                            const Time& delete_end) {
-  base::AutoLock autolock(lock_);
+  AutoLockAllShards all_shards(this);
 
   int num_deleted = 0;
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
-    CookieMap::iterator curit = it;
-    CanonicalCookie* cc = curit->second;
-    ++it;
-
-    if (cc->CreationDate() >= delete_begin &&
-        (delete_end.is_null() || cc->CreationDate() < delete_end)) {
-      InternalDeleteCookie(curit, true, /*sync_to_store*/
-                           DELETE_COOKIE_EXPLICIT);
-      ++num_deleted;
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    for (CookieMap::iterator it = cookies->begin(); it != cookies->end();) {
+      CookieMap::iterator curit = it;
+      CanonicalCookie* cc = curit->second;
+      ++it;
+
+      if (cc->CreationDate() >= delete_begin &&
+          (delete_end.is_null() || cc->CreationDate() < delete_end)) {
+        InternalDeleteCookie(curit, true, /*sync_to_store*/
+                             DELETE_COOKIE_EXPLICIT);
+        ++num_deleted;
+      }
     }
   }
 
@@ -1278,18 +1344,19 @@ int CookieMonster::DeleteAllCreatedBetween(const Time& delete_begin,
 int CookieMonster::DeleteAllCreatedBetweenForHost(const Time delete_begin,
                                                   const Time delete_end,
                                                   const GURL& url) {
-  base::AutoLock autolock(lock_);
-
   if (!HasCookieableScheme(url))
     return 0;
 
   const std::string host(url.host());
+  const std::string key(GetKey(host));
+  CookieMapShard* shard = ShardForKey(key);
+  base::AutoLock autolock(shard->lock);
 
   // We store host cookies in the store by their canonical host name;
   // domain cookies are stored with a leading ".".  So this is a pretty
   // simple lookup and per-cookie delete.
   int num_deleted = 0;
-  for (CookieMapItPair its = cookies_.equal_range(GetKey(host));
+  for (CookieMapItPair its = shard->cookies.equal_range(key);
        its.first != its.second;) {
     CookieMap::iterator curit = its.first;
     ++its.first;
@@ -1315,9 +1382,11 @@ int CookieMonster::DeleteAllForHost(const GURL& url) {
 }
 
 bool CookieMonster::DeleteCanonicalCookie(const CanonicalCookie& cookie) {
-  base::AutoLock autolock(lock_);
+  const std::string key(GetKey(cookie.Domain()));
+  CookieMapShard* shard = ShardForKey(key);
+  base::AutoLock autolock(shard->lock);
 
-  for (CookieMapItPair its = cookies_.equal_range(GetKey(cookie.Domain()));
+  for (CookieMapItPair its = shard->cookies.equal_range(key);
        its.first != its.second; ++its.first) {
     // The creation date acts as our unique index...
     if (its.first->second->CreationDate() == cookie.CreationDate()) {
@@ -1358,8 +1427,6 @@ void CookieMonster::FlushStore(const base::Closure& callback) {
 bool CookieMonster::SetCookieWithOptions(const GURL& url,
                                          const std::string& cookie_line,
                                          const CookieOptions& options) {
-  base::AutoLock autolock(lock_);
-
   if (!HasCookieableScheme(url)) {
     return false;
   }
@@ -1369,16 +1436,20 @@ bool CookieMonster::SetCookieWithOptions(const GURL& url,
 
 std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
                                                  const CookieOptions& options) {
-  base::AutoLock autolock(lock_);
-
   if (!HasCookieableScheme(url))
     return std::string();
 
-  std::vector<CanonicalCookie*> cookies;
-  FindCookiesForHostAndDomain(url, options, true, &cookies);
-  std::sort(cookies.begin(), cookies.end(), CookieSorter);
+  const std::string key(GetKey(url.host()));
+  std::string cookie_line;
+  {
+    base::AutoLock autolock(ShardForKey(key)->lock);
 
-  std::string cookie_line = BuildCookieLine(cookies);
+    std::vector<CanonicalCookie*> cookies;
+    FindCookiesForHostAndDomain(key, url, options, true, &cookies);
+    std::sort(cookies.begin(), cookies.end(), CookieSorter);
+
+    cookie_line = BuildCookieLine(cookies);
+  }
 
   VLOG(kVlogGetCookies) << "GetCookies() result: " << cookie_line;
 
@@ -1387,17 +1458,19 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
 
 void CookieMonster::DeleteCookie(const GURL& url,
                                  const std::string& cookie_name) {
-  base::AutoLock autolock(lock_);
-
   if (!HasCookieableScheme(url))
     return;
 
+  const std::string key(GetKey(url.host()));
+  CookieMapShard* shard = ShardForKey(key);
+  base::AutoLock autolock(shard->lock);
+
   CookieOptions options;
   options.set_include_httponly();
   options.set_include_first_party_only();
   // Get the cookies for this host and its domain(s).
   std::vector<CanonicalCookie*> cookies;
-  FindCookiesForHostAndDomain(url, options, true, &cookies);
+  FindCookiesForHostAndDomain(key, url, options, true, &cookies);
   std::set<CanonicalCookie*> matching_cookies;
 
   for (std::vector<CanonicalCookie*>::const_iterator it = cookies.begin();
@@ -1409,9 +1482,12 @@ void CookieMonster::DeleteCookie(const GURL& url,
     matching_cookies.insert(*it);
   }
 
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
-    CookieMap::iterator curit = it;
-    ++it;
+  // All the matches share the URL's key, so only that key's range needs to
+  // be walked for deletion.
+  for (CookieMapItPair its = shard->cookies.equal_range(key);
+       its.first != its.second;) {
+    CookieMap::iterator curit = its.first;
+    ++its.first;
     if (matching_cookies.find(curit->second) != matching_cookies.end()) {
       InternalDeleteCookie(curit, true, DELETE_COOKIE_EXPLICIT);
     }
@@ -1419,18 +1495,21 @@ void CookieMonster::DeleteCookie(const GURL& url,
 }
 
 int CookieMonster::DeleteSessionCookies() {
-  base::AutoLock autolock(lock_);
+  AutoLockAllShards all_shards(this);
 
   int num_deleted = 0;
-  for (CookieMap::iterator it = cookies_.begin(); it != cookies_.end();) {
-    CookieMap::iterator curit = it;
-    CanonicalCookie* cc = curit->second;
-    ++it;
-
-    if (!cc->IsPersistent()) {
-      InternalDeleteCookie(curit, true, /*sync_to_store*/
-                           DELETE_COOKIE_EXPIRED);
-      ++num_deleted;
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    for (CookieMap::iterator it = cookies->begin(); it != cookies->end();) {
+      CookieMap::iterator curit = it;
+      CanonicalCookie* cc = curit->second;
+      ++it;
+
+      if (!cc->IsPersistent()) {
+        InternalDeleteCookie(curit, true, /*sync_to_store*/
+                             DELETE_COOKIE_EXPIRED);
+        ++num_deleted;
+      }
     }
   }
 
@@ -1461,15 +1540,17 @@ bool CookieMonster::SetCookieWithCreationTime(const GURL& url,
                                               const std::string& cookie_line,
                                               const base::Time& creation_time) {
   DCHECK(!store_.get()) << "This method is only to be used by unit-tests.";
-  base::AutoLock autolock(lock_);
 
   if (!HasCookieableScheme(url)) {
     return false;
   }
 
-  MarkCookieStoreAsInitialized();
-  if (ShouldFetchAllCookiesWhenFetchingAnyCookie())
-    FetchAllCookiesIfNecessary();
+  {
+    base::AutoLock autolock(lock_);
+    MarkCookieStoreAsInitialized();
+    if (ShouldFetchAllCookiesWhenFetchingAnyCookie())
+      FetchAllCookiesIfNecessary();
+  }
 
   return SetCookieWithCreationTimeAndOptions(url, cookie_line, creation_time,
                                              CookieOptions());
@@ -1568,8 +1649,10 @@ void CookieMonster::StoreLoadedCookies(
 
   // Initialize the store and sync in any saved persistent cookies.  We don't
   // care if it's expired, insert it so it can be garbage collected, removed,
-  // and sync'd.
-  base::AutoLock autolock(lock_);
+  // and sync'd.  Loading is rare, so holding every shard for the duration is
+  // fine, and keeps the whole import atomic the way it was with a single
+  // store lock.
+  AutoLockAllShards all_shards(this);
 
   CookieItVector cookies_with_control_chars;
 
@@ -1577,13 +1660,21 @@ void CookieMonster::StoreLoadedCookies(
        it != cookies.end(); ++it) {
     int64 cookie_creation_time = (*it)->CreationDate().ToInternalValue();
 
-    if (creation_times_.insert(cookie_creation_time).second) {
+    bool seen_before;
+    {
+      base::AutoLock autolock(lock_);
+      seen_before = !creation_times_.insert(cookie_creation_time).second;
+    }
+    if (!seen_before) {
       CookieMap::iterator inserted =
           InternalInsertCookie(GetKey((*it)->Domain()), *it, false);
       const Time cookie_access_time((*it)->LastAccessDate());
-      if (earliest_access_time_.is_null() ||
-          cookie_access_time < earliest_access_time_)
-        earliest_access_time_ = cookie_access_time;
+      {
+        base::AutoLock autolock(lock_);
+        if (earliest_access_time_.is_null() ||
+            cookie_access_time < earliest_access_time_)
+          earliest_access_time_ = cookie_access_time;
+      }
 
       if (ContainsControlCharacter((*it)->Name()) ||
           ContainsControlCharacter((*it)->Value())) {
@@ -1641,25 +1732,29 @@ void CookieMonster::InvokeQueue() {
 }
 
 void CookieMonster::EnsureCookiesMapIsValid() {
-  lock_.AssertAcquired();
+  for (size_t i = 0; i < kNumCookieMapShards; ++i)
+    shards_[i].lock.AssertAcquired();
 
   // Iterate through all the of the cookies, grouped by host.
-  CookieMap::iterator prev_range_end = cookies_.begin();
-  while (prev_range_end != cookies_.end()) {
-    CookieMap::iterator cur_range_begin = prev_range_end;
-    const std::string key = cur_range_begin->first;  // Keep a copy.
-    CookieMap::iterator cur_range_end = cookies_.upper_bound(key);
-    prev_range_end = cur_range_end;
-
-    // Ensure no equivalent cookies for this host.
-    TrimDuplicateCookiesForKey(key, cur_range_begin, cur_range_end);
+  for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+    CookieMap* cookies = &shards_[i].cookies;
+    CookieMap::iterator prev_range_end = cookies->begin();
+    while (prev_range_end != cookies->end()) {
+      CookieMap::iterator cur_range_begin = prev_range_end;
+      const std::string key = cur_range_begin->first;  // Keep a copy.
+      CookieMap::iterator cur_range_end = cookies->upper_bound(key);
+      prev_range_end = cur_range_end;
+
+      // Ensure no equivalent cookies for this host.
+      TrimDuplicateCookiesForKey(key, cur_range_begin, cur_range_end);
+    }
   }
 }
 
 void CookieMonster::TrimDuplicateCookiesForKey(const std::string& key,
                                                CookieMap::iterator begin,
                                                CookieMap::iterator end) {
-  lock_.AssertAcquired();
+  ShardForKey(key)->lock.AssertAcquired();
 
   // Set of cookies ordered by creation time.
   typedef std::set<CookieMap::iterator, OrderByCreationTimeDesc> CookieSet;
@@ -1684,7 +1779,7 @@ void CookieMonster::TrimDuplicateCookiesForKey(const std::string& key,
     if (!set.empty())
       num_duplicates++;
 
-    // We save the iterator into |cookies_| rather than the actual cookie
+    // We save the iterator into the cookie map rather than the actual cookie
     // pointer, since we may need to delete it later.
     bool insert_success = set.insert(it).second;
     DCHECK(insert_success)
@@ -1720,8 +1815,8 @@ void CookieMonster::TrimDuplicateCookiesForKey(const std::string& key,
         signature.domain.c_str(), signature.path.c_str());
 
     // Remove all the cookies identified by |dupes|. It is valid to delete our
-    // list of iterators one at a time, since |cookies_| is a multimap (they
-    // don't invalidate existing iterators following deletion).
+    // list of iterators one at a time, since the cookie map is a multimap
+    // (they don't invalidate existing iterators following deletion).
     for (CookieSet::iterator dupes_it = dupes.begin(); dupes_it != dupes.end();
          ++dupes_it) {
       InternalDeleteCookie(*dupes_it, true,
@@ -1747,11 +1842,13 @@ void CookieMonster::SetDefaultCookieableSchemes() {
 }
 
 void CookieMonster::FindCookiesForHostAndDomain(
+    const std::string& key,
     const GURL& url,
     const CookieOptions& options,
     bool update_access_time,
     std::vector<CanonicalCookie*>* cookies) {
-  lock_.AssertAcquired();
+  DCHECK_EQ(GetKey(url.host()), key);
+  ShardForKey(key)->lock.AssertAcquired();
 
   const Time current_time(CurrentTime());
 
@@ -1761,7 +1858,6 @@ void CookieMonster::FindCookiesForHostAndDomain(
   RecordPeriodicStats(current_time);
 
   // Can just dispatch to FindCookiesForKey
-  const std::string key(GetKey(url.host()));
   FindCookiesForKey(key, url, options, current_time, update_access_time,
                     cookies);
 }
@@ -1772,13 +1868,34 @@ void CookieMonster::FindCookiesForKey(const std::string& key,
                                       const Time& current,
                                       bool update_access_time,
                                       std::vector<CanonicalCookie*>* cookies) {
-  lock_.AssertAcquired();
+  CookieMapShard* shard = ShardForKey(key);
+  shard->lock.AssertAcquired();
+
+  // Consult the domain index so that only cookies whose domain can possibly
+  // match |url| are inspected, instead of every cookie under |key|.  The
+  // candidate iterators are copied out first because deleting an expired
+  // cookie below rewrites the index buckets.
+  CookieItVector candidates;
+  const std::vector<std::string> domains(CandidateCookieDomains(url.host()));
+  for (size_t i = 0; i < domains.size(); ++i) {
+    DomainIndex::const_iterator bucket = shard->domain_index.find(domains[i]);
+    if (bucket == shard->domain_index.end())
+      continue;
+    // A candidate domain may belong to a different map key that landed in
+    // the same shard (e.g. a ".com" cookie, which is keyed under "com");
+    // the full-range scan this replaces never returned those, so skip such
+    // buckets.  Every cookie in a bucket shares the same domain and hence
+    // the same key, so checking the first entry suffices.
+    if (bucket->second.front()->first != key)
+      continue;
+    candidates.insert(candidates.end(), bucket->second.begin(),
+                      bucket->second.end());
+  }
 
-  for (CookieMapItPair its = cookies_.equal_range(key);
-       its.first != its.second;) {
-    CookieMap::iterator curit = its.first;
+  for (CookieItVector::iterator it = candidates.begin();
+       it != candidates.end(); ++it) {
+    CookieMap::iterator curit = *it;
     CanonicalCookie* cc = curit->second;
-    ++its.first;
 
     // If the cookie is expired, delete it.
     if (cc->IsExpired(current) && !keep_expired_cookies_) {
@@ -1806,12 +1923,13 @@ bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
                                               bool skip_httponly,
                                               bool already_expired,
                                               bool enforce_strict_secure) {
-  lock_.AssertAcquired();
+  CookieMapShard* shard = ShardForKey(key);
+  shard->lock.AssertAcquired();
 
   bool found_equivalent_cookie = false;
   bool skipped_httponly = false;
   bool skipped_secure_cookie = false;
-  for (CookieMapItPair its = cookies_.equal_range(key);
+  for (CookieMapItPair its = shard->cookies.equal_range(key);
        its.first != its.second;) {
     CookieMap::iterator curit = its.first;
     CanonicalCookie* cc = curit->second;
@@ -1859,13 +1977,19 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
   tracked_objects::ScopedTracker tracking_profile(
       FROM_HERE_WITH_EXPLICIT_FUNCTION(
           "456373 CookieMonster::InternalInsertCookie"));
-  lock_.AssertAcquired();
+  CookieMapShard* shard = ShardForKey(key);
+  shard->lock.AssertAcquired();
 
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get() &&
       sync_to_store)
     store_->AddCookie(*cc);
   CookieMap::iterator inserted =
-      cookies_.insert(CookieMap::value_type(key, cc));
+      shard->cookies.insert(CookieMap::value_type(key, cc));
+  shard->domain_index[cc->Domain()].push_back(inserted);
+  {
+    base::AutoLock autolock(lock_);
+    ++num_cookies_;
+  }
   if (delegate_.get()) {
     delegate_->OnCookieChanged(*cc, false,
                                CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT);
@@ -1908,15 +2032,11 @@ bool CookieMonster::SetCookieWithCreationTimeAndOptions(
     const std::string& cookie_line,
     const Time& creation_time_or_null,
     const CookieOptions& options) {
-  lock_.AssertAcquired();
-
   VLOG(kVlogSetCookies) << "SetCookie() line: " << cookie_line;
 
   Time creation_time = creation_time_or_null;
-  if (creation_time.is_null()) {
+  if (creation_time.is_null())
     creation_time = CurrentTime();
-    last_time_seen_ = creation_time;
-  }
 
   scoped_ptr<CanonicalCookie> cc(
       CanonicalCookie::Create(url, cookie_line, creation_time, options));
@@ -1934,55 +2054,63 @@ bool CookieMonster::SetCanonicalCookie(scoped_ptr<CanonicalCookie>* cc,
   const std::string key(GetKey((*cc)->Domain()));
   bool already_expired = (*cc)->IsExpired(creation_time);
 
-  if (DeleteAnyEquivalentCookie(key, **cc, options.exclude_httponly(),
-                                already_expired,
-                                options.enforce_strict_secure())) {
-    std::string error;
-    if (options.enforce_strict_secure()) {
-      error =
-          "SetCookie() not clobbering httponly cookie or secure cookie for "
-          "insecure scheme";
-    } else {
-      error = "SetCookie() not clobbering httponly cookie";
+  {
+    base::AutoLock autolock(ShardForKey(key)->lock);
+
+    if (DeleteAnyEquivalentCookie(key, **cc, options.exclude_httponly(),
+                                  already_expired,
+                                  options.enforce_strict_secure())) {
+      std::string error;
+      if (options.enforce_strict_secure()) {
+        error =
+            "SetCookie() not clobbering httponly cookie or secure cookie for "
+            "insecure scheme";
+      } else {
+        error = "SetCookie() not clobbering httponly cookie";
+      }
+
+      VLOG(kVlogSetCookies) << error;
+      return false;
     }
 
-    VLOG(kVlogSetCookies) << error;
-    return false;
-  }
+    VLOG(kVlogSetCookies) << "SetCookie() key: " << key
+                          << " cc: " << (*cc)->DebugString();
 
-  VLOG(kVlogSetCookies) << "SetCookie() key: " << key
-                        << " cc: " << (*cc)->DebugString();
+    // Realize that we might be setting an expired cookie, and the only point
+    // was to delete the cookie which we've already done.
+    if (!already_expired || keep_expired_cookies_) {
+      // See InitializeHistograms() for details.
+      if ((*cc)->IsPersistent()) {
+        histogram_expiration_duration_minutes_->Add(
+            ((*cc)->ExpiryDate() - creation_time).InMinutes());
+      }
 
-  // Realize that we might be setting an expired cookie, and the only point
-  // was to delete the cookie which we've already done.
-  if (!already_expired || keep_expired_cookies_) {
-    // See InitializeHistograms() for details.
-    if ((*cc)->IsPersistent()) {
-      histogram_expiration_duration_minutes_->Add(
-          ((*cc)->ExpiryDate() - creation_time).InMinutes());
+      {
+        CanonicalCookie cookie = *(cc->get());
+        InternalInsertCookie(key, cc->release(), true);
+      }
+    } else {
+      VLOG(kVlogSetCookies)
+          << "SetCookie() not storing already expired cookie.";
     }
 
-    {
-      CanonicalCookie cookie = *(cc->get());
-      InternalInsertCookie(key, cc->release(), true);
-    }
-  } else {
-    VLOG(kVlogSetCookies) << "SetCookie() not storing already expired cookie.";
+    // We assume that hopefully setting a cookie will be less common than
+    // querying a cookie.  Since setting a cookie can put us over our limits,
+    // make sure that we garbage collect...  We can also make the assumption
+    // that if a cookie was set, in the common case it will be used soon after,
+    // and we will purge the expired cookies in GetCookies().
+    GarbageCollectForKey(creation_time, key, options.enforce_strict_secure());
   }
 
-  // We assume that hopefully setting a cookie will be less common than
-  // querying a cookie.  Since setting a cookie can put us over our limits,
-  // make sure that we garbage collect...  We can also make the assumption that
-  // if a cookie was set, in the common case it will be used soon after,
-  // and we will purge the expired cookies in GetCookies().
-  GarbageCollect(creation_time, key, options.enforce_strict_secure());
+  // The global cookie limit spans every shard, so it is enforced outside the
+  // per-key critical section; GarbageCollectGlobal() takes all the shard
+  // locks itself when the limit has actually been reached.
+  GarbageCollectGlobal(creation_time, options.enforce_strict_secure());
 
   return true;
 }
 
 bool CookieMonster::SetCanonicalCookies(const CookieList& list) {
-  base::AutoLock autolock(lock_);
-
   CookieOptions options;
   options.set_include_httponly();
 
@@ -1995,10 +2123,9 @@ bool CookieMonster::SetCanonicalCookies(const CookieList& list) {
   return true;
 }
 
+// The caller must hold the lock of the shard that owns |cc|.
 void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
                                                    const Time& current) {
-  lock_.AssertAcquired();
-
   // Based off the Mozilla code.  When a cookie has been accessed recently,
   // don't bother updating its access time again.  This reduces the number of
   // updates we do during pageload, which in turn reduces the chance our storage
@@ -2016,7 +2143,8 @@ void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
 void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
                                          bool sync_to_store,
                                          DeletionCause deletion_cause) {
-  lock_.AssertAcquired();
+  CookieMapShard* shard = ShardForKey(it->first);
+  shard->lock.AssertAcquired();
 
   // Ideally, this would be asserted up where we define ChangeCauseMapping,
   // but DeletionCause's visibility (or lack thereof) forces us to make
@@ -2043,7 +2171,22 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
   RunCallbacks(*cc, true);
-  cookies_.erase(it);
+
+  // Unlink the cookie from the domain index before erasing its map entry.
+  DomainIndex::iterator bucket = shard->domain_index.find(cc->Domain());
+  DCHECK(bucket != shard->domain_index.end());
+  CookieItVector::iterator indexed_it =
+      std::find(bucket->second.begin(), bucket->second.end(), it);
+  DCHECK(indexed_it != bucket->second.end());
+  bucket->second.erase(indexed_it);
+  if (bucket->second.empty())
+    shard->domain_index.erase(bucket);
+
+  shard->cookies.erase(it);
+  {
+    base::AutoLock autolock(lock_);
+    --num_cookies_;
+  }
   delete cc;
 }
 
@@ -2052,43 +2195,72 @@ size_t CookieMonster::GarbageCollectLeastRecentlyAccessed(
     const base::Time& safe_date,
     size_t purge_goal,
     CookieItVector cookie_its) {
-  // Sorts up to *and including* |cookie_its[purge_goal]|, so
-  // |earliest_access_time| will be properly assigned even if
-  // |global_purge_it| == |cookie_its.begin() + purge_goal|.
-  SortLeastRecentlyAccessed(cookie_its.begin(), cookie_its.end(), purge_goal);
-  // Find boundary to cookies older than safe_date.
-  CookieItVector::iterator global_purge_it = LowerBoundAccessDate(
-      cookie_its.begin(), cookie_its.begin() + purge_goal, safe_date);
-  // Only delete the old cookies, and if strict secure is enabled, delete
-  // non-secure ones first.
+  DCHECK_LT(purge_goal, cookie_its.size());
+
+  // Only cookies last accessed before |safe_date| may be purged, so move
+  // those to the front in a single linear pass instead of ordering the
+  // whole candidate set up front.
+  CookieItVector::iterator stale_end =
+      std::partition(cookie_its.begin(), cookie_its.end(),
+                     CookieAccessedBefore(safe_date));
+  size_t num_stale = stale_end - cookie_its.begin();
+
+  CookieItVector::iterator global_purge_it;
+  if (num_stale <= purge_goal) {
+    // Every stale cookie fits within the purge goal, so the eviction set is
+    // the whole stale range and no ordering among them is needed.
+    global_purge_it = stale_end;
+  } else {
+    // Heap-select the oldest |purge_goal| cookies from the stale range only.
+    // Orders up to *and including* |cookie_its[purge_goal]|, so
+    // |earliest_access_time_| below is properly assigned.
+    std::partial_sort(cookie_its.begin(), cookie_its.begin() + purge_goal + 1,
+                      stale_end, LRACookieSorter);
+    global_purge_it = cookie_its.begin() + purge_goal;
+  }
   size_t num_deleted =
       GarbageCollectDeleteRange(current, DELETE_COOKIE_EVICTED_GLOBAL,
                                 cookie_its.begin(), global_purge_it);
-  // Set access day to the oldest cookie that wasn't deleted.
-  earliest_access_time_ = (*global_purge_it)->second->LastAccessDate();
+  // Set access day to the oldest cookie that wasn't deleted.  When the purge
+  // stopped short of the goal every survivor is on or past |safe_date|, so
+  // scan for the minimum; otherwise the heap-select already placed it at
+  // |global_purge_it|.
+  Time earliest_remaining;
+  if (num_stale <= purge_goal) {
+    earliest_remaining = (*std::min_element(global_purge_it, cookie_its.end(),
+                                            LRACookieSorter))
+                             ->second->LastAccessDate();
+  } else {
+    earliest_remaining = (*global_purge_it)->second->LastAccessDate();
+  }
+  {
+    base::AutoLock autolock(lock_);
+    earliest_access_time_ = earliest_remaining;
+  }
   return num_deleted;
 }
 
 // Domain expiry behavior is unchanged by key/expiry scheme (the
 // meaning of the key is different, but that's not visible to this routine).
-size_t CookieMonster::GarbageCollect(const Time& current,
-                                     const std::string& key,
-                                     bool enforce_strict_secure) {
-  lock_.AssertAcquired();
+size_t CookieMonster::GarbageCollectForKey(const Time& current,
+                                           const std::string& key,
+                                           bool enforce_strict_secure) {
+  CookieMapShard* shard = ShardForKey(key);
+  shard->lock.AssertAcquired();
 
   size_t num_deleted = 0;
   Time safe_date(Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
 
   // Collect garbage for this key, minding cookie priorities.
-  if (cookies_.count(key) > kDomainMaxCookies) {
+  if (shard->cookies.count(key) > kDomainMaxCookies) {
     VLOG(kVlogGarbageCollection) << "GarbageCollect() key: " << key;
 
     CookieItVector* cookie_its;
 
     CookieItVector non_expired_cookie_its;
     cookie_its = &non_expired_cookie_its;
-    num_deleted +=
-        GarbageCollectExpired(current, cookies_.equal_range(key), cookie_its);
+    num_deleted += GarbageCollectExpired(
+        current, shard->cookies.equal_range(key), cookie_its);
 
     CookieItVector secure_cookie_its;
     if (enforce_strict_secure && cookie_its->size() > kDomainMaxCookies) {
@@ -2158,15 +2330,38 @@ size_t CookieMonster::GarbageCollect(const Time& current,
     }
   }
 
+  return num_deleted;
+}
+
+size_t CookieMonster::GarbageCollectGlobal(const Time& current,
+                                           bool enforce_strict_secure) {
+  Time safe_date(Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
+
+  // Check the global trigger before taking every shard lock, so that the
+  // common case stays on the owning shard's lock alone.  The counters are
+  // re-derived below once the locks are held; like |earliest_access_time_|,
+  // they only need to be approximate for triggering purposes.
+  {
+    base::AutoLock autolock(lock_);
+    if (num_cookies_ <= kMaxCookies || earliest_access_time_ >= safe_date)
+      return 0;
+  }
+
+  AutoLockAllShards all_shards(this);
+
   // Collect garbage for everything. With firefox style we want to preserve
   // cookies accessed in kSafeFromGlobalPurgeDays, otherwise evict.
-  if (cookies_.size() > kMaxCookies && earliest_access_time_ < safe_date) {
+  size_t num_deleted = 0;
+  {
     VLOG(kVlogGarbageCollection) << "GarbageCollect() everything";
     CookieItVector cookie_its;
 
-    num_deleted += GarbageCollectExpired(
-        current, CookieMapItPair(cookies_.begin(), cookies_.end()),
-        &cookie_its);
+    for (size_t i = 0; i < kNumCookieMapShards; ++i) {
+      CookieMap* cookies = &shards_[i].cookies;
+      num_deleted += GarbageCollectExpired(
+          current, CookieMapItPair(cookies->begin(), cookies->end()),
+          &cookie_its);
+    }
 
     if (cookie_its.size() > kMaxCookies) {
       VLOG(kVlogGarbageCollection) << "Deep Garbage Collect everything.";
@@ -2201,14 +2396,13 @@ size_t CookieMonster::GarbageCollect(const Time& current,
   return num_deleted;
 }
 
+// The caller must hold the locks of every shard that |itpair| spans.
 size_t CookieMonster::GarbageCollectExpired(const Time& current,
                                             const CookieMapItPair& itpair,
                                             CookieItVector* cookie_its) {
   if (keep_expired_cookies_)
     return 0;
 
-  lock_.AssertAcquired();
-
   int num_deleted = 0;
   for (CookieMap::iterator it = itpair.first, end = itpair.second; it != end;) {
     CookieMap::iterator curit = it;
@@ -2225,11 +2419,10 @@ size_t CookieMonster::GarbageCollectExpired(const Time& current,
   return num_deleted;
 }
 
+// The caller must hold the locks of every shard that |valid_cookies| spans.
 size_t CookieMonster::GarbageCollectNonSecure(
     const CookieItVector& valid_cookies,
     CookieItVector* cookie_its) {
-  lock_.AssertAcquired();
-
   size_t num_deleted = 0;
   for (const auto& curr_cookie_it : valid_cookies) {
     if (!curr_cookie_it->second->IsSecure()) {
@@ -2291,6 +2484,11 @@ std::string CookieMonster::GetKey(const std::string& domain) const {
   return effective_domain;
 }
 
+CookieMonster::CookieMapShard* CookieMonster::ShardForKey(
+    const std::string& key) {
+  return &shards_[base::Hash(key) % kNumCookieMapShards];
+}
+
 bool CookieMonster::IsCookieableScheme(const std::string& scheme) {
   base::AutoLock autolock(lock_);
 
@@ -2299,7 +2497,7 @@ bool CookieMonster::IsCookieableScheme(const std::string& scheme) {
 }
 
 bool CookieMonster::HasCookieableScheme(const GURL& url) {
-  lock_.AssertAcquired();
+  base::AutoLock autolock(lock_);
 
   // Make sure the request is on a cookie-able url scheme.
   for (size_t i = 0; i < cookieable_schemes_.size(); ++i) {
@@ -2328,6 +2526,8 @@ void CookieMonster::RecordPeriodicStats(const base::Time& current_time) {
   const base::TimeDelta kRecordStatisticsIntervalTime(
       base::TimeDelta::FromSeconds(kRecordStatisticsIntervalSeconds));
 
+  base::AutoLock autolock(lock_);
+
   // If we've taken statistics recently, return.
   if (current_time - last_statistic_record_time_ <=
       kRecordStatisticsIntervalTime) {
@@ -2335,7 +2535,7 @@ void CookieMonster::RecordPeriodicStats(const base::Time& current_time) {
   }
 
   // See InitializeHistograms() for details.
-  histogram_count_->Add(cookies_.size());
+  histogram_count_->Add(num_cookies_);
 
   // More detailed statistics on cookie counts at different granularities.
   last_statistic_record_time_ = current_time;
@@ -2396,9 +2596,14 @@ void CookieMonster::InitializeHistograms() {
 // The system resolution is not high enough, so we can have multiple
 // set cookies that result in the same system time.  When this happens, we
 // increment by one Time unit.  Let's hope computers don't get too fast.
+// The returned value is recorded in |last_time_seen_| so that no two calls
+// ever return the same time, which keeps cookie creation times unique.
 Time CookieMonster::CurrentTime() {
-  return std::max(Time::Now(), Time::FromInternalValue(
-                                   last_time_seen_.ToInternalValue() + 1));
+  base::AutoLock autolock(lock_);
+  last_time_seen_ = std::max(
+      Time::Now(),
+      Time::FromInternalValue(last_time_seen_.ToInternalValue() + 1));
+  return last_time_seen_;
 }
 
 void CookieMonster::ComputeCookieDiff(CookieList* old_cookies,
@@ -2464,7 +2669,7 @@ void CookieMonster::SetEnableFileScheme(bool accept) {
 #endif
 
 void CookieMonster::RunCallbacks(const CanonicalCookie& cookie, bool removed) {
-  lock_.AssertAcquired();
+  base::AutoLock autolock(lock_);
   CookieOptions opts;
   opts.set_include_httponly();
   opts.set_include_first_party_only();
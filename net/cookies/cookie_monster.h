@@ -317,6 +317,12 @@ class NET_EXPORT CookieMonster : public CookieStore {
 #endif
 
  private:
+  struct CookieMapShard;
+
+  // Scoper that acquires every shard lock, in shard index order, for
+  // operations that span the whole cookie store.
+  class AutoLockAllShards;
+
   // For queueing the cookie monster calls.
   class CookieMonsterTask;
   template <typename Result>
@@ -457,6 +463,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // to global garbage collection.
   static const int kSafeFromGlobalPurgeDays;
 
+  // The number of shards the in-memory cookie map is split into.  Each
+  // CookieMap key (eTLD+1) is owned by exactly one shard; see the
+  // CookieMapShard comment below.
+  static const size_t kNumCookieMapShards = 16;
+
   // Record statistics every kRecordStatisticsIntervalSeconds of uptime.
   static const int kRecordStatisticsIntervalSeconds = 10 * 60;
 
@@ -547,8 +558,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Invokes deferred calls.
   void InvokeQueue();
 
-  // Checks that |cookies_| matches our invariants, and tries to repair any
-  // inconsistencies. (In other words, it does not have duplicate cookies).
+  // Checks that the cookie map matches our invariants, and tries to repair
+  // any inconsistencies. (In other words, it does not have duplicate
+  // cookies).  The caller must hold every shard lock.
   void EnsureCookiesMapIsValid();
 
   // Checks for any duplicate cookies for CookieMap key |key| which lie between
@@ -559,11 +571,15 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   void SetDefaultCookieableSchemes();
 
-  void FindCookiesForHostAndDomain(const GURL& url,
+  // |key| must be GetKey(url.host()); the caller must hold the lock of the
+  // shard that owns |key|.
+  void FindCookiesForHostAndDomain(const std::string& key,
+                                   const GURL& url,
                                    const CookieOptions& options,
                                    bool update_access_time,
                                    std::vector<CanonicalCookie*>* cookies);
 
+  // The caller must hold the lock of the shard that owns |key|.
   void FindCookiesForKey(const std::string& key,
                          const GURL& url,
                          const CookieOptions& options,
@@ -576,8 +592,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // return value will be true if |skip_httponly| skipped an httponly cookie or
   // |enforce_strict_secure| is true and the cookie to
   // delete was Secure and the scheme of |ecc| is insecure.  |key| is the key to
-  // find the cookie in cookies_; see the comment before the CookieMap typedef
-  // for details.
+  // find the cookie in the cookie map; see the comment before the CookieMap
+  // typedef for details.  The caller must hold the lock of the shard that
+  // owns |key|.
   // NOTE: There should never be more than a single matching equivalent cookie.
   bool DeleteAnyEquivalentCookie(const std::string& key,
                                  const CanonicalCookie& ecc,
@@ -586,7 +603,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                  bool enforce_strict_secure);
 
   // Takes ownership of *cc. Returns an iterator that points to the inserted
-  // cookie in cookies_. Guarantee: all iterators to cookies_ remain valid.
+  // cookie in the owning shard's map. Guarantee: all iterators to the map
+  // remain valid.  The caller must hold the lock of the shard that owns
+  // |key|.
   CookieMap::iterator InternalInsertCookie(const std::string& key,
                                            CanonicalCookie* cc,
                                            bool sync_to_store);
@@ -613,21 +632,30 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   // |deletion_cause| argument is used for collecting statistics and choosing
   // the correct CookieMonsterDelegate::ChangeCause for OnCookieChanged
-  // notifications.  Guarantee: All iterators to cookies_ except to the
-  // deleted entry remain vaild.
+  // notifications.  Guarantee: All iterators to the cookie map except to the
+  // deleted entry remain vaild.  The caller must hold the lock of the shard
+  // that owns |it|.
   void InternalDeleteCookie(CookieMap::iterator it,
                             bool sync_to_store,
                             DeletionCause deletion_cause);
 
-  // If the number of cookies for CookieMap key |key|, or globally, are
-  // over the preset maximums above, garbage collect, first for the host and
-  // then globally.  See comments above garbage collection threshold
-  // constants for details.
+  // If the number of cookies for CookieMap key |key| is over the preset
+  // maximum above, garbage collect for that key.  The caller must hold the
+  // lock of the shard that owns |key|.  See comments above garbage
+  // collection threshold constants for details.
   //
   // Returns the number of cookies deleted (useful for debugging).
-  size_t GarbageCollect(const base::Time& current,
-                        const std::string& key,
-                        bool enforce_strict_secure);
+  size_t GarbageCollectForKey(const base::Time& current,
+                              const std::string& key,
+                              bool enforce_strict_secure);
+
+  // If the total number of cookies across all shards is over kMaxCookies,
+  // garbage collect globally.  Acquires every shard lock itself; the caller
+  // must not hold any of them.
+  //
+  // Returns the number of cookies deleted.
+  size_t GarbageCollectGlobal(const base::Time& current,
+                              bool enforce_strict_secure);
 
   // Helper for GarbageCollect(); can be called directly as well.  Deletes all
   // expired cookies in |itpair|.  If |cookie_its| is non-NULL, all the
@@ -655,16 +683,21 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   // Helper for GarbageCollect(). Deletes cookies in |cookie_its| from least to
   // most recently used, but only before |safe_date|. Also will stop deleting
-  // when the number of remaining cookies hits |purge_goal|.
+  // when the number of remaining cookies hits |purge_goal|. The eviction set
+  // is heap-selected from the cookies older than |safe_date| rather than by
+  // sorting all of |cookie_its|.
   size_t GarbageCollectLeastRecentlyAccessed(const base::Time& current,
                                              const base::Time& safe_date,
                                              size_t purge_goal,
                                              CookieItVector cookie_its);
 
-  // Find the key (for lookup in cookies_) based on the given domain.
+  // Find the key (for lookup in the cookie map) based on the given domain.
   // See comment on keys before the CookieMap typedef.
   std::string GetKey(const std::string& domain) const;
 
+  // Returns the shard that owns CookieMap key |key|.
+  CookieMapShard* ShardForKey(const std::string& key);
+
   bool HasCookieableScheme(const GURL& url);
 
   // Statistics support
@@ -714,7 +747,37 @@ class NET_EXPORT CookieMonster : public CookieStore {
   base::HistogramBase* histogram_cookie_source_scheme_;
   base::HistogramBase* histogram_time_blocked_on_load_;
 
-  CookieMap cookies_;
+  // The in-memory cookie store is split into kNumCookieMapShards shards,
+  // each owning the CookieMap keys (eTLD+1) that hash to it along with a
+  // lock that guards them.  Requests that touch a single key -- the hot
+  // GetCookiesWithOptions()/SetCookieWithOptions() paths -- only take the
+  // owning shard's lock, so cookie access from multiple threads scales
+  // instead of serializing on one store-wide lock.  Operations that span
+  // every key (GetAllCookies(), the DeleteAll*() family, global garbage
+  // collection) hold all shard locks at once via AutoLockAllShards.
+  //
+  // Lock ordering: shard locks are always acquired in index order, and
+  // |lock_| may only be acquired while holding shard locks, never the
+  // reverse.
+  // Secondary index from exact cookie domain string to iterators for the
+  // cookies with that domain.  Only cookies whose domain is the request
+  // host itself or a dotted suffix of it can ever domain-match, so
+  // FindCookiesForKey() walks just those buckets instead of every cookie
+  // under the key.  Maintained by InternalInsertCookie() and
+  // InternalDeleteCookie().
+  typedef std::map<std::string, CookieItVector> DomainIndex;
+
+  struct CookieMapShard {
+    base::Lock lock;
+    CookieMap cookies;
+    DomainIndex domain_index;
+  };
+  CookieMapShard shards_[kNumCookieMapShards];
+
+  // Total number of cookies across all shards, maintained so that the
+  // global garbage collection trigger does not need every shard lock.
+  // Guarded by |lock_|.
+  size_t num_cookies_;
 
   // Indicates whether the cookie store has been initialized.
   bool initialized_;
@@ -748,7 +811,7 @@ class NET_EXPORT CookieMonster : public CookieStore {
   const base::TimeDelta last_access_threshold_;
 
   // Approximate date of access time of least recently accessed cookie
-  // in |cookies_|.  Note that this is not guaranteed to be accurate, only a)
+  // in the store.  Note that this is not guaranteed to be accurate, only a)
   // to be before or equal to the actual time, and b) to be accurate
   // immediately after a garbage collection that scans through all the cookies.
   // This value is used to determine whether global garbage collection might
@@ -768,7 +831,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   scoped_refptr<CookieMonsterDelegate> delegate_;
 
-  // Lock for thread-safety
+  // Guards the store-wide bookkeeping that is not owned by a single shard:
+  // initialization and fetch state, the pending task queues, |hook_map_|,
+  // |last_time_seen_|, |earliest_access_time_|, |num_cookies_| and the
+  // statistics fields.  See the CookieMapShard comment for the lock
+  // ordering.
   base::Lock lock_;
 
   base::Time last_statistic_record_time_;
@@ -8,11 +8,11 @@
 #include "base/message_loop/message_loop.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
-#include "base/test/perf_time_logger.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_monster.h"
 #include "net/cookies/cookie_monster_store_test.h"
 #include "net/cookies/parsed_cookie.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
 
@@ -99,7 +99,7 @@ class GetCookiesCallback : public BaseCallback {
 
 TEST(ParsedCookieTest, TestParseCookies) {
   std::string cookie(kCookieLine);
-  base::PerfTimeLogger timer("Parsed_cookie_parse_cookies");
+  net::test::BenchmarkReporter timer("Parsed_cookie_parse_cookies");
   for (int i = 0; i < kNumCookies; ++i) {
     ParsedCookie pc(cookie);
     EXPECT_TRUE(pc.IsValid());
@@ -110,7 +110,7 @@ TEST(ParsedCookieTest, TestParseCookies) {
 TEST(ParsedCookieTest, TestParseBigCookies) {
   std::string cookie(3800, 'z');
   cookie += kCookieLine;
-  base::PerfTimeLogger timer("Parsed_cookie_parse_big_cookies");
+  net::test::BenchmarkReporter timer("Parsed_cookie_parse_big_cookies");
   for (int i = 0; i < kNumCookies; ++i) {
     ParsedCookie pc(cookie);
     EXPECT_TRUE(pc.IsValid());
@@ -128,7 +128,7 @@ TEST_F(CookieMonsterTest, TestAddCookiesOnSingleHost) {
   SetCookieCallback setCookieCallback;
 
   // Add a bunch of cookies on a single host
-  base::PerfTimeLogger timer("Cookie_monster_add_single_host");
+  net::test::BenchmarkReporter timer("Cookie_monster_add_single_host");
 
   for (std::vector<std::string>::const_iterator it = cookies.begin();
        it != cookies.end(); ++it) {
@@ -138,14 +138,14 @@ TEST_F(CookieMonsterTest, TestAddCookiesOnSingleHost) {
 
   GetCookiesCallback getCookiesCallback;
 
-  base::PerfTimeLogger timer2("Cookie_monster_query_single_host");
+  net::test::BenchmarkReporter timer2("Cookie_monster_query_single_host");
   for (std::vector<std::string>::const_iterator it = cookies.begin();
        it != cookies.end(); ++it) {
     getCookiesCallback.GetCookies(cm.get(), GURL(kGoogleURL));
   }
   timer2.Done();
 
-  base::PerfTimeLogger timer3("Cookie_monster_deleteall_single_host");
+  net::test::BenchmarkReporter timer3("Cookie_monster_deleteall_single_host");
   cm->DeleteAllAsync(CookieMonster::DeleteCallback());
   base::MessageLoop::current()->RunUntilIdle();
   timer3.Done();
@@ -162,7 +162,7 @@ TEST_F(CookieMonsterTest, TestAddCookieOnManyHosts) {
   SetCookieCallback setCookieCallback;
 
   // Add a cookie on a bunch of host
-  base::PerfTimeLogger timer("Cookie_monster_add_many_hosts");
+  net::test::BenchmarkReporter timer("Cookie_monster_add_many_hosts");
   for (std::vector<GURL>::const_iterator it = gurls.begin(); it != gurls.end();
        ++it) {
     setCookieCallback.SetCookie(cm.get(), *it, cookie);
@@ -171,14 +171,14 @@ TEST_F(CookieMonsterTest, TestAddCookieOnManyHosts) {
 
   GetCookiesCallback getCookiesCallback;
 
-  base::PerfTimeLogger timer2("Cookie_monster_query_many_hosts");
+  net::test::BenchmarkReporter timer2("Cookie_monster_query_many_hosts");
   for (std::vector<GURL>::const_iterator it = gurls.begin(); it != gurls.end();
        ++it) {
     getCookiesCallback.GetCookies(cm.get(), *it);
   }
   timer2.Done();
 
-  base::PerfTimeLogger timer3("Cookie_monster_deleteall_many_hosts");
+  net::test::BenchmarkReporter timer3("Cookie_monster_deleteall_many_hosts");
   cm->DeleteAllAsync(CookieMonster::DeleteCallback());
   base::MessageLoop::current()->RunUntilIdle();
   timer3.Done();
@@ -230,7 +230,7 @@ TEST_F(CookieMonsterTest, TestDomainTree) {
   std::string cookie_line = getCookiesCallback.GetCookies(cm.get(), probe_gurl);
   EXPECT_EQ(5, CountInString(cookie_line, '='))
       << "Cookie line: " << cookie_line;
-  base::PerfTimeLogger timer("Cookie_monster_query_domain_tree");
+  net::test::BenchmarkReporter timer("Cookie_monster_query_domain_tree");
   for (int i = 0; i < kNumCookies; i++) {
     getCookiesCallback.GetCookies(cm.get(), probe_gurl);
   }
@@ -270,7 +270,7 @@ TEST_F(CookieMonsterTest, TestDomainLine) {
 
   cookie_line = getCookiesCallback.GetCookies(cm.get(), probe_gurl);
   EXPECT_EQ(32, CountInString(cookie_line, '='));
-  base::PerfTimeLogger timer2("Cookie_monster_query_domain_line");
+  net::test::BenchmarkReporter timer2("Cookie_monster_query_domain_line");
   for (int i = 0; i < kNumCookies; i++) {
     getCookiesCallback.GetCookies(cm.get(), probe_gurl);
   }
@@ -305,7 +305,7 @@ TEST_F(CookieMonsterTest, TestImport) {
   // Import will happen on first access.
   GURL gurl("www.google.com");
   CookieOptions options;
-  base::PerfTimeLogger timer("Cookie_monster_import_from_store");
+  net::test::BenchmarkReporter timer("Cookie_monster_import_from_store");
   getCookiesCallback.GetCookies(cm.get(), gurl);
   timer.Done();
 
@@ -315,7 +315,7 @@ TEST_F(CookieMonsterTest, TestImport) {
 
 TEST_F(CookieMonsterTest, TestGetKey) {
   scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
-  base::PerfTimeLogger timer("Cookie_monster_get_key");
+  net::test::BenchmarkReporter timer("Cookie_monster_get_key");
   for (int i = 0; i < kNumCookies; i++)
     cm->GetKey("www.google.com");
   timer.Done();
@@ -379,7 +379,7 @@ TEST_F(CookieMonsterTest, TestGCTimes) {
     // Trigger the Garbage collection we're allowed.
     setCookieCallback.SetCookie(cm.get(), gurl, cookie_line);
 
-    base::PerfTimeLogger timer((std::string("GC_") + test_case.name).c_str());
+    net::test::BenchmarkReporter timer(std::string("GC_") + test_case.name);
     for (int i = 0; i < kNumCookies; i++)
       setCookieCallback.SetCookie(cm.get(), gurl, cookie_line);
     timer.Done();
@@ -45,6 +45,7 @@
 #include "net/cookies/parsed_cookie.h"
 
 #include "base/logging.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 
 namespace {
@@ -97,17 +98,17 @@ inline bool SeekBackPast(std::string::const_iterator* it,
 
 // Validate whether |value| is a valid token according to [RFC7230],
 // Section 3.2.6.
-bool IsValidToken(const std::string& value) {
+bool IsValidToken(const base::StringPiece& value) {
   if (value.empty())
     return false;
 
   // Check that |value| has no separators.
-  std::string separators = "()<>@,;:\\\"/[]?={} \t";
-  if (value.find_first_of(separators) != std::string::npos)
+  if (value.find_first_of("()<>@,;:\\\"/[]?={} \t") != base::StringPiece::npos)
     return false;
 
   // Check that |value| has no CTLs.
-  for (std::string::const_iterator i = value.begin(); i != value.end(); ++i) {
+  for (base::StringPiece::const_iterator i = value.begin(); i != value.end();
+       ++i) {
     if ((*i >= 0 && *i <= 31) || *i >= 127)
       return false;
   }
@@ -121,12 +122,12 @@ bool IsValidToken(const std::string& value) {
 //                      ; US-ASCII characters excluding CTLs,
 //                      ; whitespace DQUOTE, comma, semicolon,
 //                      ; and backslash
-bool IsValidCookieValue(const std::string& value) {
+bool IsValidCookieValue(const base::StringPiece& value) {
   // Number of characters to skip in validation at beginning and end of string.
   size_t skip = 0;
   if (value.size() >= 2 && *value.begin() == '"' && *(value.end() - 1) == '"')
     skip = 1;
-  for (std::string::const_iterator i = value.begin() + skip;
+  for (base::StringPiece::const_iterator i = value.begin() + skip;
        i != value.end() - skip; ++i) {
     bool valid_octet =
         (*i == 0x21 || (*i >= 0x23 && *i <= 0x2B) ||
@@ -142,10 +143,11 @@ bool IsControlCharacter(unsigned char c) {
   return c <= 31;
 }
 
-bool IsValidCookieAttributeValue(const std::string& value) {
+bool IsValidCookieAttributeValue(const base::StringPiece& value) {
   // The greatest common denominator of cookie attribute values is
   // <any CHAR except CTLs or ";"> according to RFC 6265.
-  for (std::string::const_iterator i = value.begin(); i != value.end(); ++i) {
+  for (base::StringPiece::const_iterator i = value.begin(); i != value.end();
+       ++i) {
     if (IsControlCharacter(*i) || *i == ';')
       return false;
   }
@@ -171,8 +173,6 @@ ParsedCookie::ParsedCookie(const std::string& cookie_line)
   }
 
   ParseTokenValuePairs(cookie_line);
-  if (!pairs_.empty())
-    SetupAttributes();
 }
 
 ParsedCookie::~ParsedCookie() {
@@ -346,10 +346,17 @@ std::string ParsedCookie::ParseValueString(const std::string& value) {
   return std::string(value_start, value_end);
 }
 
-// Parse all token/value pairs and populate pairs_.
+// Parse all token/value pairs, populate pairs_ and set the attribute
+// indexes. The line is scanned and validated as StringPieces over
+// |cookie_line| in a single pass; nothing is allocated until the whole line
+// has been accepted, so rejected lines cost no allocations and accepted
+// ones cost exactly one |pairs_| reservation plus the stored strings.
 void ParsedCookie::ParseTokenValuePairs(const std::string& cookie_line) {
   pairs_.clear();
 
+  std::pair<base::StringPiece, base::StringPiece> pieces[kMaxPairs];
+  size_t num_pieces = 0;
+
   // Ok, here we go.  We should be expecting to be starting somewhere
   // before the cookie line, not including any header name...
   std::string::const_iterator start = cookie_line.begin();
@@ -360,7 +367,7 @@ void ParsedCookie::ParseTokenValuePairs(const std::string& cookie_line) {
   std::string::const_iterator end = FindFirstTerminator(cookie_line);
 
   for (int pair_num = 0; pair_num < kMaxPairs && it != end; ++pair_num) {
-    TokenValuePair pair;
+    base::StringPiece token;
 
     std::string::const_iterator token_start, token_end;
     if (!ParseToken(&it, end, &token_start, &token_end))
@@ -373,7 +380,7 @@ void ParsedCookie::ParseTokenValuePairs(const std::string& cookie_line) {
         // as a value with an empty name. (Mozilla bug 169091).
         // IE seems to also have this behavior, ex "AAA", and "AAA=10" will
         // set 2 different cookies, and setting "BBB" will then replace "AAA".
-        pair.first = "";
+        //
         // Rewind to the beginning of what we thought was the token name,
         // and let it get parsed as a value.
         it = token_start;
@@ -381,11 +388,11 @@ void ParsedCookie::ParseTokenValuePairs(const std::string& cookie_line) {
         // Any not-first attribute we want to treat a value as a
         // name with an empty value...  This is so something like
         // "secure;" will get parsed as a Token name, and not a value.
-        pair.first = std::string(token_start, token_end);
+        token = base::StringPiece(token_start, token_end);
       }
     } else {
       // We have a TOKEN=VALUE.
-      pair.first = std::string(token_start, token_end);
+      token = base::StringPiece(token_start, token_end);
       ++it;  // Skip past the '='.
     }
 
@@ -393,60 +400,105 @@ void ParsedCookie::ParseTokenValuePairs(const std::string& cookie_line) {
     std::string::const_iterator value_start, value_end;
     ParseValue(&it, end, &value_start, &value_end);
 
-    // OK, we're finished with a Token/Value.
-    pair.second = std::string(value_start, value_end);
-
-    // From RFC2109: "Attributes (names) (attr) are case-insensitive."
-    if (pair_num != 0)
-      pair.first = base::ToLowerASCII(pair.first);
     // Ignore Set-Cookie directives contaning control characters. See
     // http://crbug.com/238041.
-    if (!IsValidCookieAttributeValue(pair.first) ||
-        !IsValidCookieAttributeValue(pair.second)) {
-      pairs_.clear();
-      break;
+    base::StringPiece value(value_start, value_end);
+    if (!IsValidCookieAttributeValue(token) ||
+        !IsValidCookieAttributeValue(value)) {
+      return;
     }
 
-    pairs_.push_back(pair);
+    pieces[num_pieces++] = std::make_pair(token, value);
 
     // We've processed a token/value pair, we're either at the end of
     // the string or a ValueSeparator like ';', which we want to skip.
     if (it != end)
       ++it;
   }
-}
 
-void ParsedCookie::SetupAttributes() {
+  if (num_pieces == 0)
+    return;
+
   // Ignore Set-Cookie directive where name and value are both empty.
-  if (pairs_[0].first.empty() && pairs_[0].second.empty()) {
-    pairs_.clear();
+  if (pieces[0].first.empty() && pieces[0].second.empty())
     return;
-  }
+
+  pairs_.reserve(num_pieces);
+  pairs_.push_back(TokenValuePair(pieces[0].first.as_string(),
+                                  pieces[0].second.as_string()));
 
   // We skip over the first token/value, the user supplied one.
-  for (size_t i = 1; i < pairs_.size(); ++i) {
-    if (pairs_[i].first == kPathTokenName) {
-      path_index_ = i;
-    } else if (pairs_[i].first == kDomainTokenName) {
-      domain_index_ = i;
-    } else if (pairs_[i].first == kExpiresTokenName) {
-      expires_index_ = i;
-    } else if (pairs_[i].first == kMaxAgeTokenName) {
-      maxage_index_ = i;
-    } else if (pairs_[i].first == kSecureTokenName) {
-      secure_index_ = i;
-    } else if (pairs_[i].first == kHttpOnlyTokenName) {
-      httponly_index_ = i;
-    } else if (pairs_[i].first == kFirstPartyOnlyTokenName) {
-      firstpartyonly_index_ = i;
-    } else if (pairs_[i].first == kPriorityTokenName) {
-      priority_index_ = i;
+  //
+  // From RFC2109: "Attributes (names) (attr) are case-insensitive."
+  // Recognized attribute names are materialized from their static lowercase
+  // spelling; only names outside the fixed set still need lowercasing.
+  for (size_t i = 1; i < num_pieces; ++i) {
+    const char* canonical_name = NULL;
+    size_t* index = RecognizeAttribute(pieces[i].first, &canonical_name);
+    if (index) {
+      *index = i;
+      pairs_.push_back(
+          TokenValuePair(canonical_name, pieces[i].second.as_string()));
     } else {
       /* some attribute we don't know or don't care about. */
+      pairs_.push_back(TokenValuePair(pieces[i].first.as_string(),
+                                      pieces[i].second.as_string()));
+      std::string& name = pairs_.back().first;
+      for (size_t c = 0; c < name.size(); ++c)
+        name[c] = base::ToLowerASCII(name[c]);
     }
   }
 }
 
+size_t* ParsedCookie::RecognizeAttribute(const base::StringPiece& name,
+                                         const char** canonical_name) {
+  switch (name.length()) {
+    case 4:
+      if (base::LowerCaseEqualsASCII(name, kPathTokenName)) {
+        *canonical_name = kPathTokenName;
+        return &path_index_;
+      }
+      break;
+    case 6:
+      if (base::LowerCaseEqualsASCII(name, kDomainTokenName)) {
+        *canonical_name = kDomainTokenName;
+        return &domain_index_;
+      }
+      if (base::LowerCaseEqualsASCII(name, kSecureTokenName)) {
+        *canonical_name = kSecureTokenName;
+        return &secure_index_;
+      }
+      break;
+    case 7:
+      if (base::LowerCaseEqualsASCII(name, kExpiresTokenName)) {
+        *canonical_name = kExpiresTokenName;
+        return &expires_index_;
+      }
+      if (base::LowerCaseEqualsASCII(name, kMaxAgeTokenName)) {
+        *canonical_name = kMaxAgeTokenName;
+        return &maxage_index_;
+      }
+      break;
+    case 8:
+      if (base::LowerCaseEqualsASCII(name, kHttpOnlyTokenName)) {
+        *canonical_name = kHttpOnlyTokenName;
+        return &httponly_index_;
+      }
+      if (base::LowerCaseEqualsASCII(name, kPriorityTokenName)) {
+        *canonical_name = kPriorityTokenName;
+        return &priority_index_;
+      }
+      break;
+    case 16:
+      if (base::LowerCaseEqualsASCII(name, kFirstPartyOnlyTokenName)) {
+        *canonical_name = kFirstPartyOnlyTokenName;
+        return &firstpartyonly_index_;
+      }
+      break;
+  }
+  return NULL;
+}
+
 bool ParsedCookie::SetString(size_t* index,
                              const std::string& key,
                              const std::string& value) {
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/cookies/cookie_constants.h"
 
@@ -104,7 +105,14 @@ class NET_EXPORT ParsedCookie {
 
  private:
   void ParseTokenValuePairs(const std::string& cookie_line);
-  void SetupAttributes();
+
+  // Recognizes a cookie attribute |name| with a single case-insensitive
+  // comparison keyed on the name's length, and returns the |*_index_| member
+  // that tracks the attribute's position in |pairs_|, or NULL if |name| is
+  // not one of the fixed attribute names. On a match, |canonical_name| is
+  // pointed at the attribute's static lowercase spelling.
+  size_t* RecognizeAttribute(const base::StringPiece& name,
+                             const char** canonical_name);
 
   // Sets a key/value pair for a cookie. |index| has to point to one of the
   // |*_index_| fields in ParsedCookie and is updated to the position where
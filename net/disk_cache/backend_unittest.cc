@@ -25,10 +25,12 @@
 #include "net/disk_cache/blockfile/experiments.h"
 #include "net/disk_cache/blockfile/histogram_macros.h"
 #include "net/disk_cache/blockfile/mapped_file.h"
+#include "net/disk_cache/blockfile/sharded_backend.h"
 #include "net/disk_cache/cache_util.h"
 #include "net/disk_cache/disk_cache_test_base.h"
 #include "net/disk_cache/disk_cache_test_util.h"
 #include "net/disk_cache/memory/mem_backend_impl.h"
+#include "net/disk_cache/memory/mem_sharded_backend.h"
 #include "net/disk_cache/simple/simple_backend_impl.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_test_util.h"
@@ -95,6 +97,7 @@ class DiskCacheBackendTest : public DiskCacheTestWithCache {
 
   // Actual tests:
   void BackendBasics();
+  void BackendOpenEntries();
   void BackendKeying();
   void BackendShutdownWithPendingFileIO(bool fast);
   void BackendShutdownWithPendingIO(bool fast);
@@ -344,6 +347,39 @@ void DiskCacheBackendTest::BackendBasics() {
   entry2->Close();
 }
 
+void DiskCacheBackendTest::BackendOpenEntries() {
+  InitCache();
+  disk_cache::Entry* entry = NULL;
+  ASSERT_EQ(net::OK, CreateEntry("first", &entry));
+  entry->Close();
+  ASSERT_EQ(net::OK, CreateEntry("second", &entry));
+  entry->Close();
+
+  std::vector<std::string> keys;
+  keys.push_back("first");
+  keys.push_back("missing");
+  keys.push_back("second");
+
+  std::vector<disk_cache::Entry*> entries;
+  net::TestCompletionCallback cb;
+  int rv = cache_->OpenEntries(keys, &entries, cb.callback());
+  EXPECT_EQ(2, cb.GetResult(rv));
+  ASSERT_EQ(keys.size(), entries.size());
+  ASSERT_TRUE(entries[0] != NULL);
+  EXPECT_EQ("first", entries[0]->GetKey());
+  EXPECT_TRUE(entries[1] == NULL);
+  ASSERT_TRUE(entries[2] != NULL);
+  EXPECT_EQ("second", entries[2]->GetKey());
+  entries[0]->Close();
+  entries[2]->Close();
+
+  // An empty batch completes synchronously.
+  keys.clear();
+  net::TestCompletionCallback cb2;
+  EXPECT_EQ(0, cache_->OpenEntries(keys, &entries, cb2.callback()));
+  EXPECT_TRUE(entries.empty());
+}
+
 TEST_F(DiskCacheBackendTest, Basics) {
   BackendBasics();
 }
@@ -358,6 +394,15 @@ TEST_F(DiskCacheBackendTest, MemoryOnlyBasics) {
   BackendBasics();
 }
 
+TEST_F(DiskCacheBackendTest, OpenEntries) {
+  BackendOpenEntries();
+}
+
+TEST_F(DiskCacheBackendTest, MemoryOnlyOpenEntries) {
+  SetMemoryOnlyMode();
+  BackendOpenEntries();
+}
+
 TEST_F(DiskCacheBackendTest, AppCacheBasics) {
   SetCacheType(net::APP_CACHE);
   BackendBasics();
@@ -926,6 +971,35 @@ TEST_F(DiskCacheBackendTest, NewEvictionTrim) {
   entry->Close();
 }
 
+TEST_F(DiskCacheBackendTest, ClockEvictionTrim) {
+  SetClockEviction();
+  InitCache();
+
+  disk_cache::Entry* entry;
+  for (int i = 0; i < 100; i++) {
+    std::string name(base::StringPrintf("Key %d", i));
+    ASSERT_EQ(net::OK, CreateEntry(name, &entry));
+    entry->Close();
+  }
+
+  // Opening the entry at the tail sets its reference bit but does not move it
+  // on the list.
+  ASSERT_EQ(net::OK, OpenEntry("Key 0", &entry));
+  entry->Close();
+
+  // The first pass of the hand must give "Key 0" a second chance, so the
+  // first eviction is "Key 1".
+  TrimForTest(false);
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Key 1", &entry));
+  ASSERT_EQ(net::OK, OpenEntry("Key 0", &entry));
+  entry->Close();
+
+  // An entry that was never reused does not get rescued.
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Key 2", &entry));
+}
+
 // Before looking for invalid entries, let's check a valid entry.
 void DiskCacheBackendTest::BackendValidEntry() {
   InitCache();
@@ -3072,6 +3146,114 @@ TEST_F(DiskCacheTest, MultipleInstances) {
   }
 }
 
+// Tests that a sharded backend routes every key to a stable shard and that
+// the cross-shard operations (entry count, enumeration, doom) see all of
+// them.
+TEST_F(DiskCacheTest, ShardedBackendBasics) {
+  ASSERT_TRUE(CleanupCacheDir());
+  net::TestCompletionCallback cb;
+
+  const int kNumShards = 4;
+  scoped_ptr<disk_cache::ShardedBackend> cache(new disk_cache::ShardedBackend(
+      cache_path_, kNumShards, net::DISK_CACHE, NULL));
+  cache->SetFlags(disk_cache::kNoRandom);
+  int rv = cache->Init(cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+
+  const int kNumEntries = 20;
+  disk_cache::Entry* entry;
+  for (int i = 0; i < kNumEntries; i++) {
+    std::string key = base::StringPrintf("key %d", i);
+    rv = cache->CreateEntry(key, &entry, cb.callback());
+    ASSERT_EQ(net::OK, cb.GetResult(rv));
+    entry->Close();
+  }
+  EXPECT_EQ(kNumEntries, cache->GetEntryCount());
+
+  // Every key must be found again, whatever shard it landed on.
+  for (int i = 0; i < kNumEntries; i++) {
+    std::string key = base::StringPrintf("key %d", i);
+    rv = cache->OpenEntry(key, &entry, cb.callback());
+    ASSERT_EQ(net::OK, cb.GetResult(rv));
+    entry->Close();
+  }
+
+  // An enumeration spans all the shards.
+  scoped_ptr<disk_cache::Backend::Iterator> iter = cache->CreateIterator();
+  int count = 0;
+  while (true) {
+    rv = cb.GetResult(iter->OpenNextEntry(&entry, cb.callback()));
+    if (rv != net::OK)
+      break;
+    entry->Close();
+    count++;
+  }
+  EXPECT_EQ(net::ERR_FAILED, rv);
+  EXPECT_EQ(kNumEntries, count);
+  iter.reset();
+
+  rv = cache->DoomAllEntries(cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+  EXPECT_EQ(0, cache->GetEntryCount());
+  cache.reset();
+}
+
+// Tests the sharded in-memory backend: key routing, cross-shard operations
+// and the precise byte accounting of the shards.
+TEST_F(DiskCacheTest, ShardedMemBackendBasics) {
+  net::TestCompletionCallback cb;
+
+  const int kNumShards = 4;
+  scoped_ptr<disk_cache::Backend> cache(
+      disk_cache::ShardedMemBackendImpl::CreateBackend(0, kNumShards, NULL));
+  ASSERT_TRUE(cache.get());
+
+  const int kNumEntries = 20;
+  disk_cache::Entry* entry;
+  int rv;
+  for (int i = 0; i < kNumEntries; i++) {
+    std::string key = base::StringPrintf("key %d", i);
+    rv = cache->CreateEntry(key, &entry, cb.callback());
+    ASSERT_EQ(net::OK, cb.GetResult(rv));
+    entry->Close();
+  }
+  EXPECT_EQ(kNumEntries, cache->GetEntryCount());
+
+  // Every key must be found again, whatever shard it landed on.
+  int keys_size = 0;
+  for (int i = 0; i < kNumEntries; i++) {
+    std::string key = base::StringPrintf("key %d", i);
+    rv = cache->OpenEntry(key, &entry, cb.callback());
+    ASSERT_EQ(net::OK, cb.GetResult(rv));
+    entry->Close();
+    keys_size += key.size();
+  }
+
+  // With precise accounting each entry is charged more than just its key and
+  // data, so the reported size exceeds the plain sum of key sizes.
+  rv = cb.GetResult(cache->CalculateSizeOfAllEntries(cb.callback()));
+  EXPECT_GT(rv, keys_size);
+
+  // An enumeration spans all the shards.
+  scoped_ptr<disk_cache::Backend::Iterator> iter = cache->CreateIterator();
+  int count = 0;
+  while (true) {
+    rv = cb.GetResult(iter->OpenNextEntry(&entry, cb.callback()));
+    if (rv != net::OK)
+      break;
+    entry->Close();
+    count++;
+  }
+  EXPECT_EQ(net::ERR_FAILED, rv);
+  EXPECT_EQ(kNumEntries, count);
+  iter.reset();
+
+  rv = cache->DoomAllEntries(cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+  EXPECT_EQ(0, cache->GetEntryCount());
+  cache.reset();
+}
+
 // Test the six regions of the curve that determines the max cache size.
 TEST_F(DiskCacheTest, AutomaticMaxSize) {
   using disk_cache::kDefaultCacheSize;
@@ -3295,6 +3477,11 @@ TEST_F(DiskCacheBackendTest, SimpleCacheBasics) {
   BackendBasics();
 }
 
+TEST_F(DiskCacheBackendTest, SimpleCacheOpenEntries) {
+  SetSimpleCacheMode();
+  BackendOpenEntries();
+}
+
 TEST_F(DiskCacheBackendTest, SimpleCacheAppCacheBasics) {
   SetCacheType(net::APP_CACHE);
   SetSimpleCacheMode();
@@ -132,6 +132,7 @@ BackendImpl::BackendImpl(
       read_only_(false),
       disabled_(false),
       new_eviction_(false),
+      clock_eviction_(false),
       first_timer_(true),
       user_load_(false),
       net_log_(net_log),
@@ -159,6 +160,7 @@ BackendImpl::BackendImpl(
       read_only_(false),
       disabled_(false),
       new_eviction_(false),
+      clock_eviction_(false),
       first_timer_(true),
       user_load_(false),
       net_log_(net_log),
@@ -229,7 +231,7 @@ int BackendImpl::SyncInit() {
 
   if (!(user_flags_ & kNoRandom)) {
     // The unit test controls directly what to test.
-    new_eviction_ = (cache_type_ == net::DISK_CACHE);
+    new_eviction_ = (cache_type_ == net::DISK_CACHE) && !clock_eviction_;
   }
 
   if (!CheckIndex()) {
@@ -1105,6 +1107,11 @@ void BackendImpl::OnStatsTimer() {
   byte_count_ = 0;
   up_ticks_++;
 
+  // Return the unused tail of the block files to the system while the cache
+  // is idle; at most one file is trimmed per tick.
+  if (!read_only_ && !user_load_ && !num_pending_io_)
+    block_files_.TrimOneBlockFile();
+
   if (!data_)
     first_timer_ = false;
   if (first_timer_) {
@@ -1141,6 +1148,12 @@ void BackendImpl::SetNewEviction() {
   new_eviction_ = true;
 }
 
+void BackendImpl::SetClockEviction() {
+  DCHECK(!new_eviction_);
+  user_flags_ |= kClockEviction;
+  clock_eviction_ = true;
+}
+
 void BackendImpl::SetFlags(uint32_t flags) {
   user_flags_ |= flags;
 }
@@ -1224,6 +1237,19 @@ int32_t BackendImpl::GetEntryCount() const {
   return not_deleted;
 }
 
+size_t BackendImpl::EstimateMemoryUsage() const {
+  size_t estimate = 0;
+  // The mapped index becomes private dirty memory as its pages are written.
+  if (index_.get())
+    estimate += index_->GetLength();
+  // Each open entry keeps an EntryImpl plus mapped copies of its store and
+  // rankings control blocks.
+  estimate += open_entries_.size() *
+              (sizeof(EntriesMap::value_type) + sizeof(EntryImpl) +
+               sizeof(EntryStore) + sizeof(RankingsNode));
+  return estimate;
+}
+
 int BackendImpl::OpenEntry(const std::string& key, Entry** entry,
                            const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
@@ -1231,6 +1257,20 @@ int BackendImpl::OpenEntry(const std::string& key, Entry** entry,
   return net::ERR_IO_PENDING;
 }
 
+int BackendImpl::OpenEntryAndReadData(const std::string& key,
+                                      int index,
+                                      Entry** entry,
+                                      scoped_refptr<net::IOBuffer>* buf,
+                                      int* data_len,
+                                      const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  *buf = NULL;
+  *data_len = -1;
+  background_queue_.OpenEntryAndReadData(key, index, entry, buf, data_len,
+                                         callback);
+  return net::ERR_IO_PENDING;
+}
+
 int BackendImpl::CreateEntry(const std::string& key, Entry** entry,
                              const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
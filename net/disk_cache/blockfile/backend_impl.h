@@ -43,7 +43,8 @@ enum BackendFlags {
   kNewEviction = 1 << 4,        // Use of new eviction was specified.
   kNoRandom = 1 << 5,           // Don't add randomness to the behavior.
   kNoLoadProtection = 1 << 6,   // Don't act conservatively under load.
-  kNoBuffering = 1 << 7         // Disable extended IO buffering.
+  kNoBuffering = 1 << 7,        // Disable extended IO buffering.
+  kClockEviction = 1 << 8       // Use of clock eviction was specified.
 };
 
 // This class implements the Backend interface. An object of this
@@ -176,6 +177,12 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   // Returns true if this instance seems to be under heavy load.
   bool IsLoaded() const;
 
+  // Estimates the memory held by this backend: the mapped index table plus
+  // the open entries and their control blocks, in bytes. The estimate is
+  // meant for profiling tools; it reads sizes that the cache thread may be
+  // updating concurrently.
+  size_t EstimateMemoryUsage() const;
+
   // Returns the full histogram name, for the given base |name| and experiment,
   // and the current cache type. The name will be "DiskCache.t.name_e" where n
   // is the cache type and e the provided |experiment|.
@@ -229,6 +236,10 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   // Sets the eviction algorithm to version 2.
   void SetNewEviction();
 
+  // Sets the CLOCK-style eviction algorithm (see eviction.cc). Incompatible
+  // with SetNewEviction().
+  void SetClockEviction();
+
   // Sets an explicit set of BackendFlags.
   void SetFlags(uint32_t flags);
 
@@ -267,6 +278,12 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   int OpenEntry(const std::string& key,
                 Entry** entry,
                 const CompletionCallback& callback) override;
+  int OpenEntryAndReadData(const std::string& key,
+                           int index,
+                           Entry** entry,
+                           scoped_refptr<net::IOBuffer>* buf,
+                           int* data_len,
+                           const CompletionCallback& callback) override;
   int CreateEntry(const std::string& key,
                   Entry** entry,
                   const CompletionCallback& callback) override;
@@ -396,6 +413,7 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   bool read_only_;  // Prevents updates of the rankings data (used by tools).
   bool disabled_;
   bool new_eviction_;  // What eviction algorithm should be used.
+  bool clock_eviction_;  // True if the CLOCK eviction algorithm is in use.
   bool first_timer_;  // True if the timer has not been called.
   bool user_load_;  // True if we see a high load coming from the caller.
 
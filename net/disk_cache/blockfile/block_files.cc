@@ -225,6 +225,19 @@ int BlockHeader::EmptyBlocks() const {
   return empty_blocks;
 }
 
+int BlockHeader::HighestUsedBlock() const {
+  for (int i = header_->max_entries / 32 - 1; i >= 0; i--) {
+    uint32_t map_block = header_->allocation_map[i];
+    if (!map_block)
+      continue;
+    int bit = 31;
+    while (!(map_block & (1U << bit)))
+      bit--;
+    return i * 32 + bit + 1;
+  }
+  return 0;
+}
+
 int BlockHeader::MinimumAllocations() const {
   return header_->empty[kMaxNumBlocks - 1];
 }
@@ -264,7 +277,7 @@ BlockFileHeader* BlockHeader::Header() {
 // ------------------------------------------------------------------------
 
 BlockFiles::BlockFiles(const base::FilePath& path)
-    : init_(false), zero_buffer_(NULL), path_(path) {
+    : init_(false), zero_buffer_(NULL), path_(path), next_trim_file_(0) {
 }
 
 BlockFiles::~BlockFiles() {
@@ -397,6 +410,24 @@ void BlockFiles::CloseFiles() {
   block_files_.clear();
 }
 
+bool BlockFiles::TrimOneBlockFile() {
+  DCHECK(thread_checker_->CalledOnValidThread());
+  if (!init_)
+    return false;
+
+  for (size_t i = 0; i < block_files_.size(); i++) {
+    size_t index = (next_trim_file_ + i) % block_files_.size();
+    if (!block_files_[index])
+      continue;
+    if (TrimBlockFile(block_files_[index])) {
+      next_trim_file_ = (index + 1) % block_files_.size();
+      return true;
+    }
+  }
+  next_trim_file_ = 0;
+  return false;
+}
+
 void BlockFiles::ReportStats() {
   DCHECK(thread_checker_->CalledOnValidThread());
   int used_blocks[kFirstAdditionalBlockFile];
@@ -549,6 +580,41 @@ bool BlockFiles::GrowBlockFile(MappedFile* file, BlockFileHeader* header) {
   return true;
 }
 
+bool BlockFiles::TrimBlockFile(MappedFile* file) {
+  BlockHeader file_header(file);
+  BlockFileHeader* header = file_header.Header();
+  if (header->updating)
+    return false;
+
+  // Don't shrink a file that is part of a longer chain: allocation assumes
+  // that a file with a successor is at full capacity.
+  if (header->next_file)
+    return false;
+
+  // Keep the granularity used when growing the file, so a trim releases at
+  // least 1024 blocks.
+  int new_size = (file_header.HighestUsedBlock() + 1023) & ~1023;
+  if (new_size >= header->max_entries)
+    return false;
+
+  Trace("TrimBlockFile %d: %d -> %d blocks", file_header.FileId(),
+        header->max_entries, new_size);
+  {
+    FileLock lock(header);
+    header->max_entries = new_size;
+    // The discarded tail was free so its section of the allocation map is
+    // zero; recompute the counters and hints for the smaller map.
+    file_header.FixAllocationCounters();
+  }
+  file->Flush();
+
+  // If the truncation fails the file is merely longer than the header says,
+  // which is tolerated when the file is opened again.
+  int new_size_bytes = new_size * header->entry_size + file_header.Size();
+  file->SetLength(new_size_bytes);
+  return true;
+}
+
 MappedFile* BlockFiles::FileForNewBlock(FileType block_type, int block_count) {
   static_assert(RANKINGS == 1, "invalid file type");
   MappedFile* file = block_files_[block_type - 1];
@@ -670,14 +736,19 @@ bool BlockFiles::FixBlockFileHeader(MappedFile* file) {
   int expected = header->entry_size * header->max_entries + file_header.Size();
   if (file_size != expected) {
     int max_expected = header->entry_size * kMaxBlocks + file_header.Size();
-    if (file_size < expected || header->empty[3] || file_size > max_expected) {
+    if (file_size < expected || file_size > max_expected) {
       NOTREACHED();
       LOG(ERROR) << "Unexpected file size";
       return false;
     }
-    // We were in the middle of growing the file.
-    int num_entries = (file_size - file_header.Size()) / header->entry_size;
-    header->max_entries = num_entries;
+    if (!header->empty[3]) {
+      // We were in the middle of growing the file.
+      int num_entries = (file_size - file_header.Size()) / header->entry_size;
+      header->max_entries = num_entries;
+    }
+    // Otherwise we crashed while trimming the unused tail of the file; the
+    // header already describes the smaller map and the extra file length is
+    // harmless.
   }
 
   file_header.FixAllocationCounters();
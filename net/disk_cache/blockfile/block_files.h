@@ -63,6 +63,10 @@ class NET_EXPORT_PRIVATE BlockHeader {
   // Returns the number of empty blocks for this file.
   int EmptyBlocks() const;
 
+  // Returns one past the index of the highest block currently in use, in
+  // other words the number of blocks needed to cover every used block.
+  int HighestUsedBlock() const;
+
   // Returns the minumum number of allocations that can be satisfied.
   int MinimumAllocations() const;
 
@@ -116,6 +120,14 @@ class NET_EXPORT_PRIVATE BlockFiles {
   // cache is being purged.
   void CloseFiles();
 
+  // Releases the unused tail of one block file, if any file has one. Live
+  // blocks are never moved (nothing maps a block back to the records that
+  // point at it), so this only reclaims space that churn has already freed
+  // at the end of a file; empty chained files are removed as usual. Intended
+  // to be called periodically while the cache is idle. Returns true if a
+  // file was trimmed.
+  bool TrimOneBlockFile();
+
   // Sends UMA stats.
   void ReportStats();
 
@@ -131,6 +143,10 @@ class NET_EXPORT_PRIVATE BlockFiles {
   // Attemp to grow this file. Fails if the file cannot be extended anymore.
   bool GrowBlockFile(MappedFile* file, BlockFileHeader* header);
 
+  // Truncates the unused tail of this file, if large enough to be worth
+  // releasing. Returns true if the file was trimmed.
+  bool TrimBlockFile(MappedFile* file);
+
   // Returns the appropriate file to use for a new block.
   MappedFile* FileForNewBlock(FileType block_type, int block_count);
 
@@ -156,8 +172,10 @@ class NET_EXPORT_PRIVATE BlockFiles {
   char* zero_buffer_;  // Buffer to speed-up cleaning deleted entries.
   base::FilePath path_;  // Path to the backing folder.
   std::vector<MappedFile*> block_files_;  // The actual files.
+  size_t next_trim_file_;  // File to be considered first by TrimOneBlockFile.
   scoped_ptr<base::ThreadChecker> thread_checker_;
 
+  FRIEND_TEST_ALL_PREFIXES(DiskCacheTest, BlockFiles_TrimTail);
   FRIEND_TEST_ALL_PREFIXES(DiskCacheTest, BlockFiles_ZeroSizeFile);
   FRIEND_TEST_ALL_PREFIXES(DiskCacheTest, BlockFiles_TruncatedFile);
   FRIEND_TEST_ALL_PREFIXES(DiskCacheTest, BlockFiles_InvalidFile);
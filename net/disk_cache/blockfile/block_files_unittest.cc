@@ -77,6 +77,56 @@ TEST_F(DiskCacheTest, BlockFiles_Shrink) {
   EXPECT_EQ(4, NumberOfFiles(cache_path_));
 }
 
+// We should be able to truncate the unused tail of a block file.
+TEST_F(DiskCacheTest, BlockFiles_TrimTail) {
+  ASSERT_TRUE(CleanupCacheDir());
+  ASSERT_TRUE(base::CreateDirectory(cache_path_));
+
+  BlockFiles files(cache_path_);
+  ASSERT_TRUE(files.Init(true));
+
+  const int kMaxSize = 6000;
+  Addr address[kMaxSize];
+
+  // Fill a few thousand blocks of the 36-byte block file.
+  for (int i = 0; i < kMaxSize; i++) {
+    EXPECT_TRUE(files.CreateBlock(RANKINGS, 4, &address[i]));
+  }
+
+  MappedFile* file = files.GetFile(address[0]);
+  ASSERT_TRUE(NULL != file);
+  BlockFileHeader* header = reinterpret_cast<BlockFileHeader*>(file->buffer());
+  int full_size = header->max_entries;
+  int64 full_length;
+  ASSERT_TRUE(base::GetFileSize(files.Name(0), &full_length));
+
+  // Nothing to trim while the tail is in use.
+  EXPECT_FALSE(files.TrimOneBlockFile());
+
+  // Free everything but the first blocks and trim the tail.
+  for (int i = 20; i < kMaxSize; i++) {
+    files.DeleteBlock(address[i], false);
+  }
+  EXPECT_TRUE(files.TrimOneBlockFile());
+  EXPECT_GT(full_size, header->max_entries);
+  EXPECT_EQ(0, header->max_entries % 1024);
+
+  int64 trimmed_length;
+  ASSERT_TRUE(base::GetFileSize(files.Name(0), &trimmed_length));
+  EXPECT_GT(full_length, trimmed_length);
+
+  // The remaining blocks are still usable, and the file can grow again.
+  for (int i = 0; i < 20; i++) {
+    EXPECT_TRUE(files.IsValid(address[i]));
+  }
+  for (int i = 20; i < kMaxSize; i++) {
+    EXPECT_TRUE(files.CreateBlock(RANKINGS, 4, &address[i]));
+  }
+
+  // Nothing left to trim.
+  EXPECT_FALSE(files.TrimOneBlockFile());
+}
+
 // Handling of block files not properly closed.
 TEST_F(DiskCacheTest, BlockFiles_Recover) {
   ASSERT_TRUE(CleanupCacheDir());
@@ -2,16 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/hash.h"
 #include "base/strings/string_util.h"
-#include "base/test/perf_time_logger.h"
 #include "base/test/test_file_util.h"
 #include "base/threading/thread.h"
+#include "base/time/time.h"
 #include "net/base/cache_type.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
@@ -21,6 +23,7 @@
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/disk_cache_test_base.h"
 #include "net/disk_cache/disk_cache_test_util.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -52,7 +55,7 @@ bool TimeWrite(int num_entries, disk_cache::Backend* cache,
   MessageLoopHelper helper;
   CallbackTest callback(&helper, true);
 
-  base::PerfTimeLogger timer("Write disk cache entries");
+  net::test::BenchmarkReporter timer("Write disk cache entries");
 
   for (int i = 0; i < num_entries; i++) {
     TestEntry entry;
@@ -106,7 +109,7 @@ bool TimeRead(int num_entries, disk_cache::Backend* cache,
 
   const char* message = cold ? "Read disk cache entries (cold)" :
                         "Read disk cache entries (warm)";
-  base::PerfTimeLogger timer(message);
+  net::test::BenchmarkReporter timer(message);
 
   for (int i = 0; i < num_entries; i++) {
     disk_cache::Entry* cache_entry;
@@ -143,13 +146,147 @@ int BlockSize() {
   return (rand() & 0x3) + 1;
 }
 
+// ---------------------------------------------------------------------------
+// A small benchmark harness that runs the same mixed read/write workload
+// against any backend and reports per-operation latency percentiles, so that
+// changes to one backend can be compared against the others (and against its
+// own previous numbers).
+
+// Describes one workload: how many entries to touch, the entry-size range
+// (sizes are drawn uniformly from it) and the fraction of operations that are
+// writes.
+struct BenchmarkParams {
+  int num_entries;
+  int min_data_size;
+  int max_data_size;
+  int write_percent;  // 0 to 100.
+};
+
+// Collects individual operation timings and reports their percentiles
+// through the common benchmark harness.
+class LatencyStats {
+ public:
+  LatencyStats() {}
+
+  void Add(base::TimeDelta sample) { samples_.push_back(sample); }
+
+  void Report(const std::string& name) {
+    if (samples_.empty())
+      return;
+    net::test::BenchmarkReporter reporter(name);
+    for (size_t i = 0; i < samples_.size(); ++i)
+      reporter.AddLatencySampleUs(samples_[i].InMicroseconds());
+  }
+
+ private:
+  std::vector<base::TimeDelta> samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyStats);
+};
+
+// Writes |len| bytes to stream 1 of |entry| and records the end-to-end
+// latency. Returns false on failure.
+bool TimedWrite(disk_cache::Entry* entry, net::IOBuffer* buffer, int len,
+                LatencyStats* stats) {
+  net::TestCompletionCallback cb;
+  base::TimeTicks start = base::TimeTicks::Now();
+  int rv = cb.GetResult(entry->WriteData(1, 0, buffer, len, cb.callback(),
+                                         true));
+  stats->Add(base::TimeTicks::Now() - start);
+  return rv == len;
+}
+
+// Reads |len| bytes from stream 1 of |entry| and records the end-to-end
+// latency. Returns false on failure.
+bool TimedRead(disk_cache::Entry* entry, net::IOBuffer* buffer, int len,
+               LatencyStats* stats) {
+  net::TestCompletionCallback cb;
+  base::TimeTicks start = base::TimeTicks::Now();
+  int rv = cb.GetResult(entry->ReadData(1, 0, buffer, len, cb.callback()));
+  stats->Add(base::TimeTicks::Now() - start);
+  return rv == len;
+}
+
+// Populates |cache| with the workload's entries and then performs
+// |params.num_entries| operations against random entries, mixing reads and
+// writes according to |params.write_percent|. Latency percentiles for each
+// operation type are logged with |name| as the prefix.
+bool RunMixedWorkload(disk_cache::Backend* cache,
+                      const BenchmarkParams& params,
+                      const std::string& name) {
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(params.max_data_size));
+  CacheTestFillBuffer(buffer->data(), params.max_data_size, false);
+
+  int size_range = params.max_data_size - params.min_data_size + 1;
+
+  TestEntries entries;
+  LatencyStats create_stats;
+  for (int i = 0; i < params.num_entries; i++) {
+    TestEntry entry;
+    entry.key = GenerateKey(true);
+    entry.data_len = params.min_data_size + rand() % size_range;
+    entries.push_back(entry);
+
+    disk_cache::Entry* cache_entry;
+    net::TestCompletionCallback cb;
+    base::TimeTicks start = base::TimeTicks::Now();
+    int rv = cache->CreateEntry(entry.key, &cache_entry, cb.callback());
+    if (net::OK != cb.GetResult(rv))
+      return false;
+    create_stats.Add(base::TimeTicks::Now() - start);
+    if (!TimedWrite(cache_entry, buffer.get(), entry.data_len, &create_stats))
+      return false;
+    cache_entry->Close();
+  }
+
+  LatencyStats open_stats;
+  LatencyStats read_stats;
+  LatencyStats write_stats;
+  for (int i = 0; i < params.num_entries; i++) {
+    const TestEntry& entry = entries[rand() % entries.size()];
+    disk_cache::Entry* cache_entry;
+    net::TestCompletionCallback cb;
+    base::TimeTicks start = base::TimeTicks::Now();
+    int rv = cache->OpenEntry(entry.key, &cache_entry, cb.callback());
+    if (net::OK != cb.GetResult(rv))
+      return false;
+    open_stats.Add(base::TimeTicks::Now() - start);
+
+    bool ok;
+    if (rand() % 100 < params.write_percent)
+      ok = TimedWrite(cache_entry, buffer.get(), entry.data_len, &write_stats);
+    else
+      ok = TimedRead(cache_entry, buffer.get(), entry.data_len, &read_stats);
+    cache_entry->Close();
+    if (!ok)
+      return false;
+  }
+
+  create_stats.Report(name + "_create");
+  open_stats.Report(name + "_open");
+  read_stats.Report(name + "_read");
+  write_stats.Report(name + "_write");
+  return true;
+}
+
+// The workload shared by the backend comparison benchmarks below: mostly
+// small entries, with reads dominating as they do in a browser cache.
+BenchmarkParams DefaultBenchmarkParams() {
+  BenchmarkParams params;
+  params.num_entries = 1000;
+  params.min_data_size = 64;
+  params.max_data_size = kMaxSize;
+  params.write_percent = 20;
+  return params;
+}
+
 }  // namespace
 
 TEST_F(DiskCacheTest, Hash) {
   int seed = static_cast<int>(Time::Now().ToInternalValue());
   srand(seed);
 
-  base::PerfTimeLogger timer("Hash disk cache keys");
+  net::test::BenchmarkReporter timer("Hash disk cache keys");
   for (int i = 0; i < 300000; i++) {
     std::string key = GenerateKey(true);
     base::Hash(key);
@@ -217,6 +354,78 @@ TEST_F(DiskCacheTest, CacheBackendPerformance) {
   base::MessageLoop::current()->RunUntilIdle();
 }
 
+// Runs the mixed workload against the blockfile backend.
+TEST_F(DiskCacheTest, BlockfileBackendLatency) {
+  base::Thread cache_thread("CacheThread");
+  ASSERT_TRUE(cache_thread.StartWithOptions(
+                  base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+
+  ASSERT_TRUE(CleanupCacheDir());
+  net::TestCompletionCallback cb;
+  scoped_ptr<disk_cache::Backend> cache;
+  int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE,
+                                          net::CACHE_BACKEND_BLOCKFILE,
+                                          cache_path_,
+                                          0,
+                                          false,
+                                          cache_thread.task_runner(),
+                                          NULL,
+                                          &cache,
+                                          cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+
+  srand(static_cast<int>(Time::Now().ToInternalValue()));
+  EXPECT_TRUE(RunMixedWorkload(cache.get(), DefaultBenchmarkParams(),
+                               "Blockfile"));
+  base::MessageLoop::current()->RunUntilIdle();
+}
+
+// Runs the mixed workload against the simple backend.
+TEST_F(DiskCacheTest, SimpleBackendLatency) {
+  base::Thread cache_thread("CacheThread");
+  ASSERT_TRUE(cache_thread.StartWithOptions(
+                  base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+
+  ASSERT_TRUE(CleanupCacheDir());
+  net::TestCompletionCallback cb;
+  scoped_ptr<disk_cache::Backend> cache;
+  int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE,
+                                          net::CACHE_BACKEND_SIMPLE,
+                                          cache_path_,
+                                          0,
+                                          false,
+                                          cache_thread.task_runner(),
+                                          NULL,
+                                          &cache,
+                                          cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+
+  srand(static_cast<int>(Time::Now().ToInternalValue()));
+  EXPECT_TRUE(RunMixedWorkload(cache.get(), DefaultBenchmarkParams(),
+                               "Simple"));
+  base::MessageLoop::current()->RunUntilIdle();
+}
+
+// Runs the mixed workload against the in-memory backend.
+TEST_F(DiskCacheTest, MemoryBackendLatency) {
+  net::TestCompletionCallback cb;
+  scoped_ptr<disk_cache::Backend> cache;
+  int rv = disk_cache::CreateCacheBackend(net::MEMORY_CACHE,
+                                          net::CACHE_BACKEND_DEFAULT,
+                                          base::FilePath(),
+                                          0,
+                                          false,
+                                          NULL,
+                                          NULL,
+                                          &cache,
+                                          cb.callback());
+  ASSERT_EQ(net::OK, cb.GetResult(rv));
+
+  srand(static_cast<int>(Time::Now().ToInternalValue()));
+  EXPECT_TRUE(RunMixedWorkload(cache.get(), DefaultBenchmarkParams(),
+                               "Memory"));
+}
+
 // Creating and deleting "entries" on a block-file is something quite frequent
 // (after all, almost everything is stored on block files). The operation is
 // almost free when the file is empty, but can be expensive if the file gets
@@ -234,7 +443,7 @@ TEST_F(DiskCacheTest, BlockFilesPerformance) {
   const int kNumEntries = 60000;
   disk_cache::Addr* address = new disk_cache::Addr[kNumEntries];
 
-  base::PerfTimeLogger timer1("Fill three block-files");
+  net::test::BenchmarkReporter timer1("Fill three block-files");
 
   // Fill up the 32-byte block file (use three files).
   for (int i = 0; i < kNumEntries; i++) {
@@ -243,7 +452,7 @@ TEST_F(DiskCacheTest, BlockFilesPerformance) {
   }
 
   timer1.Done();
-  base::PerfTimeLogger timer2("Create and delete blocks");
+  net::test::BenchmarkReporter timer2("Create and delete blocks");
 
   for (int i = 0; i < 200000; i++) {
     int entry = rand() * (kNumEntries / RAND_MAX + 1);
@@ -26,6 +26,18 @@
 // size so that we have a chance to see an element again and move it to another
 // list.
 
+// The clock eviction policy (opt-in, see BackendImpl::SetClockEviction) keeps
+// a single list like the original policy, but accessing an entry does not move
+// it on the list: the hit is recorded lazily by bumping the entry's
+// reuse_count, which acts as the reference bit of a CLOCK algorithm. At trim
+// time the tail of the list is the clock hand: an entry that was referenced
+// since the hand last passed over it has its reuse_count decayed and moves to
+// the front of the list; an entry that was never referenced is evicted. This
+// replaces the per-hit list surgery with a single in-place write and makes
+// the policy scan-resistant, since entries touched only once (e.g. a large
+// sequential video read) never earn a second chance and are evicted before
+// the frequently used set.
+
 #include "net/disk_cache/blockfile/eviction.h"
 
 #include <stdint.h>
@@ -96,6 +108,8 @@ void Eviction::Init(BackendImpl* backend) {
   max_size_ = LowWaterAdjust(backend_->max_size_);
   index_size_ = backend->mask_ + 1;
   new_eviction_ = backend->new_eviction_;
+  clock_eviction_ = backend->clock_eviction_;
+  DCHECK(!(new_eviction_ && clock_eviction_));
   first_trim_ = true;
   trimming_ = false;
   delay_trim_ = false;
@@ -127,6 +141,9 @@ void Eviction::TrimCache(bool empty) {
   if (new_eviction_)
     return TrimCacheV2(empty);
 
+  if (clock_eviction_)
+    return TrimCacheClock(empty);
+
   Trace("*** Trim Cache ***");
   trimming_ = true;
   TimeTicks start = TimeTicks::Now();
@@ -176,12 +193,18 @@ void Eviction::UpdateRank(EntryImpl* entry, bool modified) {
   if (new_eviction_)
     return UpdateRankV2(entry, modified);
 
+  if (clock_eviction_)
+    return UpdateRankClock(entry, modified);
+
   rankings_->UpdateRank(entry->rankings(), modified, GetListForEntry(entry));
 }
 
 void Eviction::OnOpenEntry(EntryImpl* entry) {
   if (new_eviction_)
     return OnOpenEntryV2(entry);
+
+  if (clock_eviction_)
+    return OnOpenEntryClock(entry);
 }
 
 void Eviction::OnCreateEntry(EntryImpl* entry) {
@@ -545,6 +568,100 @@ bool Eviction::RemoveDeletedNode(CacheRankingsBlock* node) {
   return !doomed;
 }
 
+// -----------------------------------------------------------------------
+
+void Eviction::TrimCacheClock(bool empty) {
+  Trace("*** Trim Cache clock ***");
+  trimming_ = true;
+  TimeTicks start = TimeTicks::Now();
+  Rankings::ScopedRankingsBlock node(rankings_);
+  Rankings::ScopedRankingsBlock next(
+      rankings_, rankings_->GetPrev(node.get(), Rankings::NO_USE));
+  int deleted_entries = 0;
+  int rescued_entries = 0;
+  int target_size = empty ? 0 : max_size_;
+  while ((header_->num_bytes > target_size || test_mode_) && next.get()) {
+    // The iterator could be invalidated within EvictEntry().
+    if (!next->HasData())
+      break;
+    node.reset(next.release());
+    next.reset(rankings_->GetPrev(node.get(), Rankings::NO_USE));
+    if (node->Data()->dirty != backend_->GetCurrentEntryId() || empty) {
+      if (!empty && GiveSecondChance(node.get())) {
+        rescued_entries++;
+      } else {
+        // This entry is not being used by anybody.
+        // Do NOT use node as an iterator after this point.
+        rankings_->TrackRankingsBlock(node.get(), false);
+        if (EvictEntry(node.get(), empty, Rankings::NO_USE) && !test_mode_)
+          deleted_entries++;
+      }
+
+      if (!empty && test_mode_)
+        break;
+    }
+    if (!empty && (deleted_entries + rescued_entries > 20 ||
+                   (TimeTicks::Now() - start).InMilliseconds() > 20)) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::Bind(&Eviction::TrimCache, ptr_factory_.GetWeakPtr(), false));
+      break;
+    }
+  }
+
+  if (empty) {
+    CACHE_UMA(AGE_MS, "TotalClearTimeClock", 0, start);
+  } else {
+    CACHE_UMA(AGE_MS, "TotalTrimTimeClock", 0, start);
+  }
+  CACHE_UMA(COUNTS, "TrimItemsClock", 0, deleted_entries);
+  CACHE_UMA(COUNTS, "TrimRescuedItemsClock", 0, rescued_entries);
+
+  trimming_ = false;
+  Trace("*** Trim Cache clock end ***");
+  return;
+}
+
+void Eviction::UpdateRankClock(EntryImpl* entry, bool modified) {
+  // The position on the list only changes when the clock hand passes over the
+  // entry, so a hit is just a timestamp update on the node itself.
+  rankings_->UpdateTimesOnly(entry->rankings(), modified);
+}
+
+void Eviction::OnOpenEntryClock(EntryImpl* entry) {
+  // This is the reference bit of the clock: it marks the entry as reused
+  // without touching the rankings list. The write is lazy; the block is
+  // already mapped so this doesn't generate IO of its own.
+  EntryStore* info = entry->entry()->Data();
+  DCHECK_EQ(ENTRY_NORMAL, info->state);
+
+  if (info->reuse_count < std::numeric_limits<int32_t>::max()) {
+    info->reuse_count++;
+    entry->entry()->set_modified();
+  }
+}
+
+// Implements the hand of the clock. Returns true if the entry was referenced
+// since the last time the hand passed over it, in which case its reference
+// count is decayed and the entry moves back to the front of the list instead
+// of being evicted. Decaying (rather than clearing) the count gives entries
+// that are reused often more than one extra trip around the clock.
+bool Eviction::GiveSecondChance(CacheRankingsBlock* node) {
+  EntryImpl* entry = backend_->GetEnumeratedEntry(node, Rankings::NO_USE);
+  if (!entry)
+    return false;  // Let EvictEntry() deal with the invalid entry.
+
+  EntryStore* info = entry->entry()->Data();
+  bool referenced = info->reuse_count > 0;
+  if (referenced) {
+    info->reuse_count /= 2;
+    entry->entry()->set_modified();
+    rankings_->UpdateRank(entry->rankings(), false, Rankings::NO_USE);
+  }
+  entry->Release();
+  return referenced;
+}
+
 bool Eviction::NodeIsOldEnough(CacheRankingsBlock* node, int list) {
   if (!node)
     return false;
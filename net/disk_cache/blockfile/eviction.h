@@ -65,6 +65,14 @@ class Eviction {
   void TrimDeleted(bool empty);
   bool RemoveDeletedNode(CacheRankingsBlock* node);
 
+  // A third set of methods implementing a CLOCK-style policy (see the
+  // comment at the top of eviction.cc), enabled with
+  // BackendImpl::SetClockEviction().
+  void TrimCacheClock(bool empty);
+  void UpdateRankClock(EntryImpl* entry, bool modified);
+  void OnOpenEntryClock(EntryImpl* entry);
+  bool GiveSecondChance(CacheRankingsBlock* node);
+
   bool NodeIsOldEnough(CacheRankingsBlock* node, int list);
   int SelectListByLength(Rankings::ScopedRankingsBlock* next);
   void ReportListStats();
@@ -76,6 +84,7 @@ class Eviction {
   int trim_delays_;
   int index_size_;
   bool new_eviction_;
+  bool clock_eviction_;
   bool first_trim_;
   bool trimming_;
   bool delay_trim_;
@@ -9,6 +9,7 @@
 #include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/single_thread_task_runner.h"
+#include "base/thread_task_runner_handle.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/blockfile/backend_impl.h"
 #include "net/disk_cache/blockfile/entry_impl.h"
@@ -33,7 +34,9 @@ BackendIO::BackendIO(InFlightIO* controller, BackendImpl* backend,
       buf_len_(0),
       truncate_(false),
       offset64_(0),
-      start_(NULL) {
+      start_(NULL),
+      out_buf_(NULL),
+      out_data_len_(NULL) {
   start_time_ = base::TimeTicks::Now();
 }
 
@@ -78,6 +81,33 @@ void BackendIO::ReferenceEntry() {
   entry_->AddRef();
 }
 
+bool BackendIO::IsOpenForKey(const std::string& key) const {
+  return operation_ == OP_OPEN && key_ == key;
+}
+
+bool BackendIO::BlocksOpenMerge(const std::string& key) const {
+  switch (operation_) {
+    case OP_INIT:
+    case OP_DOOM_ALL:
+    case OP_DOOM_BETWEEN:
+    case OP_DOOM_SINCE:
+    case OP_DOOM_ENTRY:  // May doom the entry with this key.
+    case OP_RUN_TASK:
+      return true;
+    case OP_CREATE:
+    case OP_DOOM:
+      return key_ == key;
+    default:
+      return false;
+  }
+}
+
+void BackendIO::MergeOpenWith(BackendIO* source) {
+  DCHECK_EQ(OP_OPEN, operation_);
+  DCHECK(source->IsOpenForKey(key_));
+  merge_source_ = source;
+}
+
 void BackendIO::Init() {
   operation_ = OP_INIT;
 }
@@ -88,6 +118,19 @@ void BackendIO::OpenEntry(const std::string& key, Entry** entry) {
   entry_ptr_ = entry;
 }
 
+void BackendIO::OpenEntryAndReadData(const std::string& key,
+                                     int index,
+                                     Entry** entry,
+                                     scoped_refptr<net::IOBuffer>* out_buf,
+                                     int* out_data_len) {
+  operation_ = OP_OPEN_AND_READ;
+  key_ = key;
+  index_ = index;
+  entry_ptr_ = entry;
+  out_buf_ = out_buf;
+  out_data_len_ = out_data_len;
+}
+
 void BackendIO::CreateEntry(const std::string& key, Entry** entry) {
   operation_ = OP_CREATE;
   key_ = key;
@@ -216,14 +259,30 @@ void BackendIO::ReadyForSparseIO(EntryImpl* entry) {
 BackendIO::~BackendIO() {}
 
 bool BackendIO::ReturnsEntry() {
-  return operation_ == OP_OPEN || operation_ == OP_CREATE ||
-      operation_ == OP_OPEN_NEXT;
+  return operation_ == OP_OPEN || operation_ == OP_OPEN_AND_READ ||
+      operation_ == OP_CREATE || operation_ == OP_OPEN_NEXT;
 }
 
 base::TimeDelta BackendIO::ElapsedTime() const {
   return base::TimeTicks::Now() - start_time_;
 }
 
+// Runs on the background thread.
+void BackendIO::OnCompoundReadComplete(int result) {
+  DCHECK_EQ(OP_OPEN_AND_READ, operation_);
+  FinishCompoundRead(result);
+  result_ = net::OK;
+  NotifyController();
+}
+
+void BackendIO::FinishCompoundRead(int result) {
+  if (result >= 0) {
+    *out_buf_ = compound_buf_;
+    *out_data_len_ = result;
+  }
+  compound_buf_ = NULL;
+}
+
 // Runs on the background thread.
 void BackendIO::ExecuteBackendOperation() {
   switch (operation_) {
@@ -231,8 +290,43 @@ void BackendIO::ExecuteBackendOperation() {
       result_ = backend_->SyncInit();
       break;
     case OP_OPEN:
+      if (merge_source_.get()) {
+        // An identical open executed earlier in this batch; hand out the same
+        // entry with an extra reference instead of opening it again.
+        result_ = merge_source_->result_;
+        if (result_ == net::OK) {
+          EntryImpl* merged_entry =
+              static_cast<EntryImpl*>(*merge_source_->entry_ptr_);
+          merged_entry->AddRef();
+          *entry_ptr_ = merged_entry;
+        }
+        merge_source_ = NULL;
+      } else {
+        result_ = backend_->SyncOpenEntry(key_, entry_ptr_);
+      }
+      break;
+    case OP_OPEN_AND_READ: {
       result_ = backend_->SyncOpenEntry(key_, entry_ptr_);
+      if (result_ != net::OK)
+        break;
+      EntryImpl* opened_entry = static_cast<EntryImpl*>(*entry_ptr_);
+      int size = opened_entry->GetDataSize(index_);
+      if (size <= 0) {
+        if (size == 0)
+          *out_data_len_ = 0;
+        break;  // The open succeeded; result_ is already net::OK.
+      }
+      compound_buf_ = new net::IOBuffer(size);
+      int rv = opened_entry->ReadDataImpl(
+          index_, 0, compound_buf_.get(), size,
+          base::Bind(&BackendIO::OnCompoundReadComplete, this));
+      if (rv == net::ERR_IO_PENDING) {
+        result_ = net::ERR_IO_PENDING;
+        break;
+      }
+      FinishCompoundRead(rv);
       break;
+    }
     case OP_CREATE:
       result_ = backend_->SyncCreateEntry(key_, entry_ptr_);
       break;
@@ -350,6 +444,30 @@ void InFlightBackendIO::OpenEntry(const std::string& key, Entry** entry,
                                   const net::CompletionCallback& callback) {
   scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
   operation->OpenEntry(key, entry);
+
+  // Merge with an open for the same key already queued in this batch, unless
+  // an operation queued after it could change the outcome of the open.
+  for (OperationBatch::reverse_iterator it = pending_batch_.rbegin();
+       it != pending_batch_.rend(); ++it) {
+    if ((*it)->IsOpenForKey(key)) {
+      operation->MergeOpenWith(it->get());
+      break;
+    }
+    if ((*it)->BlocksOpenMerge(key))
+      break;
+  }
+  PostOperation(operation.get());
+}
+
+void InFlightBackendIO::OpenEntryAndReadData(
+    const std::string& key,
+    int index,
+    Entry** entry,
+    scoped_refptr<net::IOBuffer>* buf,
+    int* data_len,
+    const net::CompletionCallback& callback) {
+  scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
+  operation->OpenEntryAndReadData(key, index, entry, buf, data_len);
   PostOperation(operation.get());
 }
 
@@ -502,9 +620,18 @@ void InFlightBackendIO::ReadyForSparseIO(
 }
 
 void InFlightBackendIO::WaitForPendingIO() {
+  PostPendingBatch();
   InFlightIO::WaitForPendingIO();
 }
 
+void InFlightBackendIO::DropPendingIO() {
+  // Hand queued operations to the background thread so that state-changing
+  // work (closes, dooms) still executes before the backend shuts down; only
+  // the user callbacks are dropped.
+  PostPendingBatch();
+  InFlightIO::DropPendingIO();
+}
+
 void InFlightBackendIO::OnOperationComplete(BackgroundIO* operation,
                                             bool cancel) {
   BackendIO* op = static_cast<BackendIO*>(operation);
@@ -514,12 +641,38 @@ void InFlightBackendIO::OnOperationComplete(BackgroundIO* operation,
     op->callback().Run(op->result());
 }
 
+// Runs on the primary thread.
 void InFlightBackendIO::PostOperation(BackendIO* operation) {
-  background_thread_->PostTask(
-      FROM_HERE, base::Bind(&BackendIO::ExecuteOperation, operation));
+  if (pending_batch_.empty()) {
+    // Post the flush at the end of the current task, so that every operation
+    // requested before then rides along in a single cross-thread hop.
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::Bind(&InFlightBackendIO::PostPendingBatch,
+                              ptr_factory_.GetWeakPtr()));
+  }
+  pending_batch_.push_back(make_scoped_refptr(operation));
   OnOperationPosted(operation);
 }
 
+// Runs on the primary thread.
+void InFlightBackendIO::PostPendingBatch() {
+  if (pending_batch_.empty())
+    return;
+  OperationBatch batch;
+  batch.swap(pending_batch_);
+  background_thread_->PostTask(
+      FROM_HERE, base::Bind(&InFlightBackendIO::ExecuteBatch, batch));
+}
+
+// Runs on the background thread.
+// static
+void InFlightBackendIO::ExecuteBatch(const OperationBatch& batch) {
+  for (OperationBatch::const_iterator it = batch.begin(); it != batch.end();
+       ++it) {
+    (*it)->ExecuteOperation();
+  }
+}
+
 base::WeakPtr<InFlightBackendIO> InFlightBackendIO::GetWeakPtr() {
   return ptr_factory_.GetWeakPtr();
 }
@@ -7,6 +7,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "base/memory/ref_counted.h"
 #include "base/single_thread_task_runner.h"
@@ -47,9 +48,27 @@ class BackendIO : public BackgroundIO {
   // Grabs an extra reference of entry_.
   void ReferenceEntry();
 
+  // Returns true if this is an OpenEntry operation for |key|.
+  bool IsOpenForKey(const std::string& key) const;
+
+  // Returns true if executing this operation may change the outcome of
+  // opening the entry keyed by |key|, so a later OpenEntry queued in the same
+  // batch cannot be merged across it.
+  bool BlocksOpenMerge(const std::string& key) const;
+
+  // Makes this operation (which must be an OpenEntry for the same key) share
+  // the result of |source|, an OpenEntry queued earlier in the same batch,
+  // instead of performing the open again.
+  void MergeOpenWith(BackendIO* source);
+
   // The operations we proxy:
   void Init();
   void OpenEntry(const std::string& key, Entry** entry);
+  void OpenEntryAndReadData(const std::string& key,
+                            int index,
+                            Entry** entry,
+                            scoped_refptr<net::IOBuffer>* out_buf,
+                            int* out_data_len);
   void CreateEntry(const std::string& key, Entry** entry);
   void DoomEntry(const std::string& key);
   void DoomAllEntries();
@@ -86,6 +105,7 @@ class BackendIO : public BackgroundIO {
     OP_NONE = 0,
     OP_INIT,
     OP_OPEN,
+    OP_OPEN_AND_READ,
     OP_CREATE,
     OP_DOOM,
     OP_DOOM_ALL,
@@ -120,6 +140,15 @@ class BackendIO : public BackgroundIO {
   void ExecuteBackendOperation();
   void ExecuteEntryOperation();
 
+  // Completion of the read half of OP_OPEN_AND_READ; runs on the background
+  // thread.
+  void OnCompoundReadComplete(int result);
+
+  // Publishes the read result of OP_OPEN_AND_READ to the caller. A failed
+  // read is not fatal once the entry is open, so it leaves |*out_buf_| NULL
+  // instead of failing the operation.
+  void FinishCompoundRead(int result);
+
   BackendImpl* backend_;
   net::CompletionCallback callback_;
   Operation operation_;
@@ -141,11 +170,23 @@ class BackendIO : public BackgroundIO {
   int64* start_;
   base::TimeTicks start_time_;
   base::Closure task_;
+  scoped_refptr<net::IOBuffer>* out_buf_;
+  int* out_data_len_;
+  scoped_refptr<net::IOBuffer> compound_buf_;
+
+  // When set, this OpenEntry operation returns the entry opened by
+  // |merge_source_| (executed earlier in the same batch) with an extra
+  // reference, instead of performing the open again.
+  scoped_refptr<BackendIO> merge_source_;
 
   DISALLOW_COPY_AND_ASSIGN(BackendIO);
 };
 
-// The specialized controller that keeps track of current operations.
+// The specialized controller that keeps track of current operations. To
+// reduce cross-thread PostTask overhead, operations requested within the same
+// IO-thread task are queued and handed to the background thread as a single
+// batch that executes them back-to-back; duplicate OpenEntry calls for the
+// same key within a batch are merged so the open is performed only once.
 class InFlightBackendIO : public InFlightIO {
  public:
   InFlightBackendIO(
@@ -157,6 +198,12 @@ class InFlightBackendIO : public InFlightIO {
   void Init(const net::CompletionCallback& callback);
   void OpenEntry(const std::string& key, Entry** entry,
                  const net::CompletionCallback& callback);
+  void OpenEntryAndReadData(const std::string& key,
+                            int index,
+                            Entry** entry,
+                            scoped_refptr<net::IOBuffer>* buf,
+                            int* data_len,
+                            const net::CompletionCallback& callback);
   void CreateEntry(const std::string& key, Entry** entry,
                    const net::CompletionCallback& callback);
   void DoomEntry(const std::string& key,
@@ -195,6 +242,10 @@ class InFlightBackendIO : public InFlightIO {
   // Blocks until all operations are cancelled or completed.
   void WaitForPendingIO();
 
+  // Drops current pending operations without waiting for them to complete,
+  // posting any not yet handed to the background thread first.
+  void DropPendingIO();
+
   scoped_refptr<base::SingleThreadTaskRunner> background_thread() {
     return background_thread_;
   }
@@ -210,10 +261,24 @@ class InFlightBackendIO : public InFlightIO {
   void OnOperationComplete(BackgroundIO* operation, bool cancel) override;
 
  private:
+  typedef std::vector<scoped_refptr<BackendIO> > OperationBatch;
+
+  // Queues |operation| into the current batch, scheduling the batch to be
+  // posted at the end of the current IO-thread task.
   void PostOperation(BackendIO* operation);
 
+  // Hands the queued batch, if any, to the background thread as one task.
+  void PostPendingBatch();
+
+  // Runs every operation of |batch| on the background thread, back-to-back.
+  static void ExecuteBatch(const OperationBatch& batch);
+
   BackendImpl* backend_;
   scoped_refptr<base::SingleThreadTaskRunner> background_thread_;
+
+  // Operations waiting to be posted to the background thread as one batch.
+  OperationBatch pending_batch_;
+
   base::WeakPtrFactory<InFlightBackendIO> ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(InFlightBackendIO);
@@ -419,6 +419,11 @@ void Rankings::UpdateRank(CacheRankingsBlock* node, bool modified, List list) {
   CACHE_UMA(AGE_MS, "UpdateRank", 0, start);
 }
 
+void Rankings::UpdateTimesOnly(CacheRankingsBlock* node, bool modified) {
+  UpdateTimes(node, modified);
+  node->set_modified();
+}
+
 CacheRankingsBlock* Rankings::GetNext(CacheRankingsBlock* node, List list) {
   ScopedRankingsBlock next(this);
   if (!node) {
@@ -123,6 +123,10 @@ class Rankings {
   // Moves a given entry to the head.
   void UpdateRank(CacheRankingsBlock* node, bool modified, List list);
 
+  // Updates the timestamps of a node without moving it on its list. Used by
+  // eviction policies that don't perform list surgery on every access.
+  void UpdateTimesOnly(CacheRankingsBlock* node, bool modified);
+
   // Iterates through the list.
   CacheRankingsBlock* GetNext(CacheRankingsBlock* node, List list);
   CacheRankingsBlock* GetPrev(CacheRankingsBlock* node, List list);
@@ -0,0 +1,299 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/blockfile/sharded_backend.h"
+
+#include "base/bind.h"
+#include "base/hash.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/single_thread_task_runner.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/thread.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/blockfile/backend_impl.h"
+
+namespace {
+
+// Collects the completion of an operation that was fanned out to every
+// shard, and runs |callback| with the combined result once the last shard
+// reports back. For |sum_results| operations (size calculations) the shard
+// results are added together; otherwise the combined result is net::OK
+// unless some shard failed, in which case it is the first error seen.
+class ShardResultAggregator : public base::RefCounted<ShardResultAggregator> {
+ public:
+  ShardResultAggregator(int shard_count,
+                        bool sum_results,
+                        const net::CompletionCallback& callback)
+      : pending_(shard_count),
+        result_(net::OK),
+        sum_results_(sum_results),
+        callback_(callback) {}
+
+  net::CompletionCallback CallbackForShard() {
+    return base::Bind(&ShardResultAggregator::OnShardComplete, this);
+  }
+
+ private:
+  friend class base::RefCounted<ShardResultAggregator>;
+  ~ShardResultAggregator() {}
+
+  void OnShardComplete(int result) {
+    DCHECK_GT(pending_, 0);
+    if (sum_results_) {
+      if (result < 0)
+        result_ = result_ < 0 ? result_ : result;
+      else if (result_ >= 0)
+        result_ += result;
+    } else if (result != net::OK && result_ == net::OK) {
+      result_ = result;
+    }
+    if (!--pending_)
+      callback_.Run(result_);
+  }
+
+  int pending_;
+  int result_;
+  const bool sum_results_;
+  net::CompletionCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardResultAggregator);
+};
+
+}  // namespace
+
+namespace disk_cache {
+
+// Enumerates the shards one after another, using each shard's own iterator.
+class ShardedBackend::ShardedIterator : public Backend::Iterator {
+ public:
+  explicit ShardedIterator(const ScopedVector<BackendImpl>& shards)
+      : current_shard_(0), next_entry_(NULL), weak_factory_(this) {
+    for (size_t i = 0; i < shards.size(); i++)
+      shard_iterators_.push_back(shards[i]->CreateIterator().release());
+  }
+
+  ~ShardedIterator() override {}
+
+  int OpenNextEntry(Entry** next_entry,
+                    const net::CompletionCallback& callback) override {
+    next_entry_ = next_entry;
+    callback_ = callback;
+    return OpenNextEntryFromCurrentShard();
+  }
+
+ private:
+  // Asks the current shard for its next entry, skipping to the following
+  // shard every time one reaches the end of its enumeration.
+  int OpenNextEntryFromCurrentShard() {
+    while (current_shard_ < shard_iterators_.size()) {
+      int rv = shard_iterators_[current_shard_]->OpenNextEntry(
+          next_entry_, base::Bind(&ShardedIterator::OnOpenNextEntryComplete,
+                                  weak_factory_.GetWeakPtr()));
+      if (rv != net::ERR_FAILED)
+        return rv;
+      current_shard_++;
+    }
+    return net::ERR_FAILED;
+  }
+
+  void OnOpenNextEntryComplete(int result) {
+    if (result == net::ERR_FAILED &&
+        current_shard_ + 1 < shard_iterators_.size()) {
+      current_shard_++;
+      result = OpenNextEntryFromCurrentShard();
+      if (result == net::ERR_IO_PENDING)
+        return;
+    }
+    callback_.Run(result);
+  }
+
+  ScopedVector<Backend::Iterator> shard_iterators_;
+  size_t current_shard_;
+  Entry** next_entry_;
+  net::CompletionCallback callback_;
+  base::WeakPtrFactory<ShardedIterator> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedIterator);
+};
+
+ShardedBackend::ShardedBackend(const base::FilePath& path,
+                               int num_shards,
+                               net::CacheType cache_type,
+                               net::NetLog* net_log)
+    : path_(path),
+      num_shards_(num_shards),
+      cache_type_(cache_type),
+      net_log_(net_log),
+      max_size_(0),
+      flags_(kNone),
+      pending_shard_inits_(0),
+      init_result_(net::OK) {
+  DCHECK_GE(num_shards, 1);
+  DCHECK_LE(num_shards, kMaxShards);
+}
+
+ShardedBackend::~ShardedBackend() {
+  // The shards must go away before their cache threads; rely on the member
+  // declaration order for that, and just stop the threads here so that any
+  // task posted by a shard destructor has completed before the thread is
+  // deleted.
+  shards_.clear();
+  for (size_t i = 0; i < cache_threads_.size(); i++)
+    cache_threads_[i]->Stop();
+}
+
+bool ShardedBackend::SetMaxSize(int max_bytes) {
+  DCHECK(shards_.empty());
+  if (max_bytes < 0)
+    return false;
+  max_size_ = max_bytes;
+  return true;
+}
+
+void ShardedBackend::SetFlags(uint32_t flags) {
+  DCHECK(shards_.empty());
+  flags_ = flags;
+}
+
+int ShardedBackend::Init(const CompletionCallback& callback) {
+  DCHECK(shards_.empty());
+  DCHECK(!callback.is_null());
+
+  for (int i = 0; i < num_shards_; i++) {
+    scoped_ptr<base::Thread> cache_thread(
+        new base::Thread(base::StringPrintf("CacheThread_Shard%d", i)));
+    if (!cache_thread->StartWithOptions(
+            base::Thread::Options(base::MessageLoop::TYPE_IO, 0))) {
+      return net::ERR_FAILED;
+    }
+    scoped_ptr<BackendImpl> shard(
+        new BackendImpl(path_.AppendASCII(base::StringPrintf("shard_%d", i)),
+                        cache_thread->task_runner(), net_log_));
+    shard->SetType(cache_type_);
+    shard->SetFlags(flags_);
+    if (max_size_)
+      shard->SetMaxSize(max_size_ / num_shards_);
+    cache_threads_.push_back(cache_thread.release());
+    shards_.push_back(shard.release());
+  }
+
+  init_callback_ = callback;
+  init_result_ = net::OK;
+  pending_shard_inits_ = num_shards_;
+  for (int i = 0; i < num_shards_; i++) {
+    int rv = shards_[i]->Init(base::Bind(&ShardedBackend::OnShardInitComplete,
+                                         base::Unretained(this)));
+    DCHECK_EQ(net::ERR_IO_PENDING, rv);
+  }
+  return net::ERR_IO_PENDING;
+}
+
+net::CacheType ShardedBackend::GetCacheType() const {
+  return cache_type_;
+}
+
+int32_t ShardedBackend::GetEntryCount() const {
+  int32_t count = 0;
+  for (size_t i = 0; i < shards_.size(); i++)
+    count += shards_[i]->GetEntryCount();
+  return count;
+}
+
+int ShardedBackend::OpenEntry(const std::string& key,
+                              Entry** entry,
+                              const CompletionCallback& callback) {
+  return GetShard(key)->OpenEntry(key, entry, callback);
+}
+
+int ShardedBackend::CreateEntry(const std::string& key,
+                                Entry** entry,
+                                const CompletionCallback& callback) {
+  return GetShard(key)->CreateEntry(key, entry, callback);
+}
+
+int ShardedBackend::DoomEntry(const std::string& key,
+                              const CompletionCallback& callback) {
+  return GetShard(key)->DoomEntry(key, callback);
+}
+
+int ShardedBackend::DoomAllEntries(const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  scoped_refptr<ShardResultAggregator> aggregator(
+      new ShardResultAggregator(num_shards_, false, callback));
+  for (size_t i = 0; i < shards_.size(); i++)
+    shards_[i]->DoomAllEntries(aggregator->CallbackForShard());
+  return net::ERR_IO_PENDING;
+}
+
+int ShardedBackend::DoomEntriesBetween(base::Time initial_time,
+                                       base::Time end_time,
+                                       const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  scoped_refptr<ShardResultAggregator> aggregator(
+      new ShardResultAggregator(num_shards_, false, callback));
+  for (size_t i = 0; i < shards_.size(); i++) {
+    shards_[i]->DoomEntriesBetween(initial_time, end_time,
+                                   aggregator->CallbackForShard());
+  }
+  return net::ERR_IO_PENDING;
+}
+
+int ShardedBackend::DoomEntriesSince(base::Time initial_time,
+                                     const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  scoped_refptr<ShardResultAggregator> aggregator(
+      new ShardResultAggregator(num_shards_, false, callback));
+  for (size_t i = 0; i < shards_.size(); i++)
+    shards_[i]->DoomEntriesSince(initial_time, aggregator->CallbackForShard());
+  return net::ERR_IO_PENDING;
+}
+
+int ShardedBackend::CalculateSizeOfAllEntries(
+    const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  scoped_refptr<ShardResultAggregator> aggregator(
+      new ShardResultAggregator(num_shards_, true, callback));
+  for (size_t i = 0; i < shards_.size(); i++)
+    shards_[i]->CalculateSizeOfAllEntries(aggregator->CallbackForShard());
+  return net::ERR_IO_PENDING;
+}
+
+scoped_ptr<Backend::Iterator> ShardedBackend::CreateIterator() {
+  return scoped_ptr<Backend::Iterator>(new ShardedIterator(shards_));
+}
+
+void ShardedBackend::GetStats(StatsItems* stats) {
+  for (size_t i = 0; i < shards_.size(); i++) {
+    stats->push_back(
+        std::make_pair("Shard", base::IntToString(static_cast<int>(i))));
+    shards_[i]->GetStats(stats);
+  }
+}
+
+void ShardedBackend::OnExternalCacheHit(const std::string& key) {
+  GetShard(key)->OnExternalCacheHit(key);
+}
+
+BackendImpl* ShardedBackend::GetShard(const std::string& key) const {
+  // Each shard indexes its hash table with the low bits of this same hash,
+  // so the shard is derived from the high bits (multiply-shift range
+  // reduction) to keep every shard's table evenly loaded.
+  uint32_t hash = base::Hash(key);
+  size_t shard = (static_cast<uint64_t>(hash) * num_shards_) >> 32;
+  return shards_[shard];
+}
+
+void ShardedBackend::OnShardInitComplete(int result) {
+  DCHECK_GT(pending_shard_inits_, 0);
+  if (result != net::OK && init_result_ == net::OK)
+    init_result_ = result;
+  if (!--pending_shard_inits_)
+    init_callback_.Run(init_result_);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,119 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_BLOCKFILE_SHARDED_BACKEND_H_
+#define NET_DISK_CACHE_BLOCKFILE_SHARDED_BACKEND_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/cache_type.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace base {
+class Thread;
+}  // namespace base
+
+namespace net {
+class NetLog;
+}  // namespace net
+
+namespace disk_cache {
+
+class BackendImpl;
+
+// A cache backend that partitions the key space across several independent
+// blockfile backends (shards). Each shard owns its own hash table and block
+// files, stored under a "shard_n" subdirectory of |path|, and runs its own
+// cache thread, so operations on different shards execute in parallel
+// instead of being serialized behind a single cache thread. A key is always
+// routed to the same shard, derived from the high bits of its hash.
+class NET_EXPORT_PRIVATE ShardedBackend : public Backend {
+ public:
+  // |num_shards| must be between 1 and kMaxShards. The sharded cache on disk
+  // is not compatible with a plain blockfile cache at the same |path|, nor
+  // with a sharded cache using a different |num_shards|.
+  ShardedBackend(const base::FilePath& path,
+                 int num_shards,
+                 net::CacheType cache_type,
+                 net::NetLog* net_log);
+  ~ShardedBackend() override;
+
+  static const int kMaxShards = 64;
+
+  // Sets the maximum size for the total amount of data stored by all shards
+  // combined. Only valid before Init().
+  bool SetMaxSize(int max_bytes);
+
+  // Sets an explicit set of BackendFlags for every shard. Only valid before
+  // Init().
+  void SetFlags(uint32_t flags);
+
+  // Creates and initializes every shard. The return value is a net error
+  // code. If this method returns ERR_IO_PENDING, the |callback| will be
+  // invoked when initialization completes on all shards.
+  int Init(const CompletionCallback& callback);
+
+  // Backend interface.
+  net::CacheType GetCacheType() const override;
+  int32_t GetEntryCount() const override;
+  int OpenEntry(const std::string& key,
+                Entry** entry,
+                const CompletionCallback& callback) override;
+  int CreateEntry(const std::string& key,
+                  Entry** entry,
+                  const CompletionCallback& callback) override;
+  int DoomEntry(const std::string& key,
+                const CompletionCallback& callback) override;
+  int DoomAllEntries(const CompletionCallback& callback) override;
+  int DoomEntriesBetween(base::Time initial_time,
+                         base::Time end_time,
+                         const CompletionCallback& callback) override;
+  int DoomEntriesSince(base::Time initial_time,
+                       const CompletionCallback& callback) override;
+  int CalculateSizeOfAllEntries(const CompletionCallback& callback) override;
+  // The returned iterator enumerates the shards one after another, so the
+  // caveats about modifying the cache during enumeration (see
+  // backend_impl.h) apply to each shard individually.
+  scoped_ptr<Iterator> CreateIterator() override;
+  void GetStats(StatsItems* stats) override;
+  void OnExternalCacheHit(const std::string& key) override;
+
+ private:
+  class ShardedIterator;
+
+  // Returns the shard that owns |key|.
+  BackendImpl* GetShard(const std::string& key) const;
+
+  // Invoked as each shard finishes initialization.
+  void OnShardInitComplete(int result);
+
+  const base::FilePath path_;
+  const int num_shards_;
+  const net::CacheType cache_type_;
+  net::NetLog* net_log_;
+  int max_size_;
+  uint32_t flags_;
+
+  // The threads must outlive the shards running on them; they are declared
+  // first so that the shards are destroyed before their threads.
+  ScopedVector<base::Thread> cache_threads_;
+  ScopedVector<BackendImpl> shards_;
+
+  // Initialization bookkeeping.
+  int pending_shard_inits_;
+  int init_result_;
+  CompletionCallback init_callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedBackend);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_BLOCKFILE_SHARDED_BACKEND_H_
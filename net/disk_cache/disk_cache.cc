@@ -0,0 +1,196 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/disk_cache.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+
+namespace disk_cache {
+
+namespace {
+
+// Drives the default, two-step implementation of
+// Backend::OpenEntryAndReadData. Deletes itself when the compound operation
+// completes. If the backend is destroyed with the operation in flight the
+// pending callback is dropped, so this object is leaked at shutdown just
+// like any other abandoned operation.
+class OpenAndReadHelper {
+ public:
+  OpenAndReadHelper(Backend* backend,
+                    int index,
+                    Entry** entry,
+                    scoped_refptr<net::IOBuffer>* buf,
+                    int* data_len,
+                    const net::CompletionCallback& callback)
+      : backend_(backend),
+        index_(index),
+        entry_(entry),
+        buf_(buf),
+        data_len_(data_len),
+        callback_(callback),
+        opened_(false) {}
+
+  int Start(const std::string& key) {
+    int rv = backend_->OpenEntry(
+        key, entry_,
+        base::Bind(&OpenAndReadHelper::OnOpenComplete,
+                   base::Unretained(this)));
+    if (rv == net::ERR_IO_PENDING)
+      return rv;
+    rv = DoRead(rv);
+    if (rv == net::ERR_IO_PENDING)
+      return rv;
+    int result = OnReadComplete(rv);
+    delete this;
+    return result;
+  }
+
+ private:
+  void OnOpenComplete(int result) {
+    result = DoRead(result);
+    if (result == net::ERR_IO_PENDING)
+      return;
+    FinishAsync(result);
+  }
+
+  // Returns the open result on failure, the read result otherwise.
+  int DoRead(int open_result) {
+    if (open_result != net::OK)
+      return open_result;
+    opened_ = true;
+    int size = (*entry_)->GetDataSize(index_);
+    if (size <= 0)
+      return size;
+    read_buf_ = new net::IOBuffer(size);
+    return (*entry_)->ReadData(
+        index_, 0, read_buf_.get(), size,
+        base::Bind(&OpenAndReadHelper::OnEntryReadComplete,
+                   base::Unretained(this)));
+  }
+
+  void OnEntryReadComplete(int result) {
+    FinishAsync(OnReadComplete(result));
+  }
+
+  // Folds the read result into the compound result: a failed read is not
+  // fatal once the entry is open.
+  int OnReadComplete(int result) {
+    if (!opened_)
+      return result;
+    if (result >= 0) {
+      *buf_ = read_buf_;
+      *data_len_ = result;
+    }
+    return net::OK;
+  }
+
+  void FinishAsync(int result) {
+    net::CompletionCallback callback = callback_;
+    delete this;
+    callback.Run(result);
+  }
+
+  Backend* backend_;
+  const int index_;
+  Entry** entry_;
+  scoped_refptr<net::IOBuffer>* buf_;
+  int* data_len_;
+  net::CompletionCallback callback_;
+  scoped_refptr<net::IOBuffer> read_buf_;
+  bool opened_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenAndReadHelper);
+};
+
+// Tracks an OpenEntries batch: counts down outstanding opens and reports
+// how many succeeded. Deletes itself when the batch completes.
+class BatchOpenHelper {
+ public:
+  BatchOpenHelper(std::vector<Entry*>* entries,
+                  const net::CompletionCallback& callback)
+      : entries_(entries),
+        callback_(callback),
+        remaining_(entries->size()),
+        opened_(0),
+        starting_(true) {}
+
+  net::CompletionCallback MakeEntryCallback(size_t index) {
+    return base::Bind(&BatchOpenHelper::OnEntryOpened,
+                      base::Unretained(this), index);
+  }
+
+  void OnEntryOpened(size_t index, int result) {
+    if (result == net::OK)
+      ++opened_;
+    else
+      (*entries_)[index] = NULL;
+    DCHECK_GT(remaining_, 0u);
+    if (--remaining_ > 0)
+      return;
+    if (starting_)
+      return;  // Finish() reports the synchronous result.
+    net::CompletionCallback callback = callback_;
+    int opened = opened_;
+    delete this;
+    callback.Run(opened);
+  }
+
+  // Called once every open has been issued. Returns the final count if the
+  // whole batch completed synchronously, ERR_IO_PENDING otherwise.
+  int Finish() {
+    starting_ = false;
+    if (remaining_ > 0)
+      return net::ERR_IO_PENDING;
+    int opened = opened_;
+    delete this;
+    return opened;
+  }
+
+ private:
+  std::vector<Entry*>* entries_;
+  net::CompletionCallback callback_;
+  size_t remaining_;
+  int opened_;
+  bool starting_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchOpenHelper);
+};
+
+}  // namespace
+
+int Backend::OpenEntryAndReadData(const std::string& key,
+                                  int index,
+                                  Entry** entry,
+                                  scoped_refptr<net::IOBuffer>* buf,
+                                  int* data_len,
+                                  const CompletionCallback& callback) {
+  *buf = NULL;
+  *data_len = -1;
+  // Owns itself; deleted on completion.
+  OpenAndReadHelper* helper =
+      new OpenAndReadHelper(this, index, entry, buf, data_len, callback);
+  return helper->Start(key);
+}
+
+int Backend::OpenEntries(const std::vector<std::string>& keys,
+                         std::vector<Entry*>* entries,
+                         const CompletionCallback& callback) {
+  entries->assign(keys.size(), static_cast<Entry*>(NULL));
+  if (keys.empty())
+    return 0;
+  // Owns itself; deleted when the batch completes.
+  BatchOpenHelper* helper = new BatchOpenHelper(entries, callback);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    int rv = OpenEntry(keys[i], &(*entries)[i],
+                       helper->MakeEntryCallback(i));
+    if (rv != net::ERR_IO_PENDING)
+      helper->OnEntryOpened(i, rv);
+  }
+  return helper->Finish();
+}
+
+}  // namespace disk_cache
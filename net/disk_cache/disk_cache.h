@@ -109,6 +109,35 @@ class NET_EXPORT Backend {
   virtual int OpenEntry(const std::string& key, Entry** entry,
                         const CompletionCallback& callback) = 0;
 
+  // Opens an existing entry and reads the whole of data stream |index| as a
+  // single compound operation, saving callers a backend round trip on the
+  // common open-then-read sequence. On success (net::OK) |entry| is set as
+  // with OpenEntry, and |*buf| / |*data_len| receive the stream contents.
+  // If the entry opens but the read fails, the call still succeeds with
+  // |*buf| left NULL and |*data_len| set to -1; the caller falls back to a
+  // regular ReadData and observes the error there. The default
+  // implementation issues the two operations back to back; backends that
+  // dispatch to another thread can override it to do both in one hop.
+  virtual int OpenEntryAndReadData(const std::string& key,
+                                   int index,
+                                   Entry** entry,
+                                   scoped_refptr<net::IOBuffer>* buf,
+                                   int* data_len,
+                                   const CompletionCallback& callback);
+
+  // Opens a batch of existing entries the caller knows it will need soon,
+  // such as a page's subresources. |entries| is resized to match |keys| and
+  // slot i receives the entry for keys[i] as its open completes, or stays
+  // NULL if that key cannot be opened; each opened entry must eventually be
+  // Closed. The return value, or the value passed to |callback| if this
+  // returns ERR_IO_PENDING, is the number of entries opened. |entries| must
+  // outlive the operation. The default implementation fans the opens out
+  // concurrently; backends with an in-memory index can fail misses up front
+  // without touching the disk.
+  virtual int OpenEntries(const std::vector<std::string>& keys,
+                          std::vector<Entry*>* entries,
+                          const CompletionCallback& callback);
+
   // Creates a new entry. Upon success, the out param holds a pointer to an
   // Entry object representing the newly created disk cache entry. When the
   // entry pointer is no longer needed, its Close method should be called. The
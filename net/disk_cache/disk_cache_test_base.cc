@@ -78,6 +78,7 @@ DiskCacheTestWithCache::DiskCacheTestWithCache()
       simple_cache_wait_for_index_(true),
       force_creation_(false),
       new_eviction_(false),
+      clock_eviction_(false),
       first_cleanup_(true),
       integrity_(true),
       use_current_thread_(false),
@@ -334,6 +335,8 @@ void DiskCacheTestWithCache::CreateBackend(uint32 flags, base::Thread* thread) {
     EXPECT_TRUE(cache_impl_->SetMaxSize(size_));
   if (new_eviction_)
     cache_impl_->SetNewEviction();
+  if (clock_eviction_)
+    cache_impl_->SetClockEviction();
   cache_impl_->SetType(type_);
   cache_impl_->SetFlags(flags);
   net::TestCompletionCallback cb;
@@ -101,6 +101,10 @@ class DiskCacheTestWithCache : public DiskCacheTest {
     new_eviction_ = true;
   }
 
+  void SetClockEviction() {
+    clock_eviction_ = true;
+  }
+
   void DisableSimpleCacheWaitForIndex() {
     simple_cache_wait_for_index_ = false;
   }
@@ -172,6 +176,7 @@ class DiskCacheTestWithCache : public DiskCacheTest {
   bool simple_cache_wait_for_index_;
   bool force_creation_;
   bool new_eviction_;
+  bool clock_eviction_;
   bool first_cleanup_;
   bool integrity_;
   bool use_current_thread_;
@@ -29,7 +29,11 @@ int LowWaterAdjust(int high_water) {
 namespace disk_cache {
 
 MemBackendImpl::MemBackendImpl(net::NetLog* net_log)
-    : max_size_(0), current_size_(0), net_log_(net_log), weak_factory_(this) {
+    : max_size_(0),
+      current_size_(0),
+      entry_overhead_(0),
+      net_log_(net_log),
+      weak_factory_(this) {
 }
 
 MemBackendImpl::~MemBackendImpl() {
@@ -89,6 +93,13 @@ bool MemBackendImpl::SetMaxSize(int max_bytes) {
   return true;
 }
 
+void MemBackendImpl::SetPreciseAccounting() {
+  DCHECK(entries_.empty());
+  // This does not capture the allocator and hash map overhead exactly, but it
+  // is close enough to keep a large cache within its configured budget.
+  entry_overhead_ = static_cast<int32>(sizeof(MemEntryImpl));
+}
+
 void MemBackendImpl::InternalDoomEntry(MemEntryImpl* entry) {
   // Only parent entries can be passed into this method.
   DCHECK(entry->type() == MemEntryImpl::kParentEntry);
@@ -134,6 +145,21 @@ int32 MemBackendImpl::GetEntryCount() const {
   return static_cast<int32>(entries_.size());
 }
 
+size_t MemBackendImpl::EstimateMemoryUsage() const {
+  // Estimated allocator cost of one hash table node beyond the stored value:
+  // a next pointer and a cached hash.
+  const size_t kHashNodeOverhead = 2 * sizeof(void*);
+  size_t estimate = static_cast<size_t>(current_size_);
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    // The key is stored both in the map and in the entry.
+    estimate += sizeof(EntryMap::value_type) + kHashNodeOverhead +
+                sizeof(MemEntryImpl) + 2 * it->first.size();
+  }
+  estimate += entries_.bucket_count() * sizeof(void*);
+  return estimate;
+}
+
 int MemBackendImpl::OpenEntry(const std::string& key, Entry** entry,
                               const CompletionCallback& callback) {
   if (OpenEntry(key, entry))
@@ -42,6 +42,16 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   // Sets the maximum size for the total amount of data stored by this instance.
   bool SetMaxSize(int max_bytes);
 
+  // Charges every entry a fixed overhead for the entry object and index
+  // bookkeeping, in addition to its key and data, so that the configured
+  // maximum reflects actual memory use more closely. Must be called before
+  // any entry is created.
+  void SetPreciseAccounting();
+
+  // The fixed per-entry charge; zero unless SetPreciseAccounting() was
+  // called.
+  int32 entry_overhead() const { return entry_overhead_; }
+
   // Permanently deletes an entry.
   void InternalDoomEntry(MemEntryImpl* entry);
 
@@ -54,6 +64,10 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   // Returns the maximum size for a file to reside on the cache.
   int MaxFileSize() const;
 
+  // Estimates the heap memory used by the cache: stored data plus entry
+  // objects and index bookkeeping, in bytes.
+  size_t EstimateMemoryUsage() const;
+
   // Insert an MemEntryImpl into the ranking list. This method is only called
   // from MemEntryImpl to insert child entries. The reference can be removed
   // by calling RemoveFromRankingList(|entry|).
@@ -113,6 +127,7 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   MemRankings rankings_;  // Rankings to be able to trim the cache.
   int32 max_size_;        // Maximum data size for this instance.
   int32 current_size_;
+  int32 entry_overhead_;  // Per-entry charge for precise accounting.
 
   net::NetLog* net_log_;
 
@@ -88,7 +88,8 @@ bool MemEntryImpl::CreateEntry(const std::string& key, net::NetLog* net_log) {
       CreateNetLogEntryCreationCallback(this, true));
 
   Open();
-  backend_->ModifyStorageSize(0, static_cast<int32>(key.size()));
+  backend_->ModifyStorageSize(
+      0, static_cast<int32>(key.size()) + backend_->entry_overhead());
   return true;
 }
 
@@ -275,7 +276,8 @@ int MemEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
 MemEntryImpl::~MemEntryImpl() {
   for (int i = 0; i < NUM_STREAMS; i++)
     backend_->ModifyStorageSize(data_size_[i], 0);
-  backend_->ModifyStorageSize(static_cast<int32>(key_.size()), 0);
+  backend_->ModifyStorageSize(
+      static_cast<int32>(key_.size()) + backend_->entry_overhead(), 0);
   net_log_.EndEvent(net::NetLog::TYPE_DISK_CACHE_MEM_ENTRY_IMPL);
 }
 
@@ -458,6 +460,10 @@ int MemEntryImpl::InternalWriteSparseData(int64 offset, IOBuffer* buf,
     if (data_size != child_offset)
       child->child_first_pos_ = child_offset;
 
+    // The write may have discarded bytes the child stored before, so rebuild
+    // the child's contribution to the extent index from scratch.
+    UpdateExtentsForChild(child);
+
     // Adjust the offset in the IO buffer.
     io_buf->DidConsume(ret);
   }
@@ -477,38 +483,26 @@ int MemEntryImpl::GetAvailableRange(int64 offset, int len, int64* start) {
   if (offset < 0 || len < 0 || !start)
     return net::ERR_INVALID_ARGUMENT;
 
-  MemEntryImpl* current_child = NULL;
-
-  // Find the first child and record the number of empty bytes.
-  int empty = FindNextChild(offset, len, &current_child);
-  if (current_child && empty < len) {
-    *start = offset + empty;
-    len -= empty;
-
-    // Counts the number of continuous bytes.
-    int continuous = 0;
-
-    // This loop scan for continuous bytes.
-    while (len && current_child) {
-      // Number of bytes available in this child.
-      int data_size = current_child->GetDataSize(kSparseData) -
-                      ToChildOffset(*start + continuous);
-      if (data_size > len)
-        data_size = len;
-
-      // We have found more continuous bytes so increment the count. Also
-      // decrement the length we should scan.
-      continuous += data_size;
-      len -= data_size;
-
-      // If the next child is discontinuous, break the loop.
-      if (FindNextChild(*start + continuous, len, &current_child))
-        break;
-    }
-    return continuous;
-  }
   *start = offset;
-  return 0;
+  if (!len)
+    return 0;
+
+  // The runs in the extent index are disjoint and coalesced, so the only
+  // candidate is the first run that ends after |offset|.
+  ExtentMap::const_iterator it = extents_->upper_bound(offset);
+  if (it != extents_->begin()) {
+    ExtentMap::const_iterator prev = it;
+    --prev;
+    if (prev->first + prev->second > offset)
+      it = prev;
+  }
+  if (it == extents_->end() || it->first >= offset + len)
+    return 0;
+
+  int64 range_start = std::max(it->first, offset);
+  int64 range_end = std::min(it->first + it->second, offset + len);
+  *start = range_start;
+  return static_cast<int>(range_end - range_start);
 }
 
 void MemEntryImpl::PrepareTarget(int index, int offset, int buf_len) {
@@ -548,6 +542,7 @@ bool MemEntryImpl::InitSparseInfo() {
     if (GetDataSize(kSparseData))
       return false;
     children_.reset(new EntryMap());
+    extents_.reset(new ExtentMap());
 
     // The parent entry stores data for the first block, so save this object to
     // index 0.
@@ -592,40 +587,91 @@ MemEntryImpl* MemEntryImpl::OpenChild(int64 offset, bool create) {
   return NULL;
 }
 
-int MemEntryImpl::FindNextChild(int64 offset, int len, MemEntryImpl** child) {
-  DCHECK(child);
-  *child = NULL;
-  int scanned_len = 0;
+void MemEntryImpl::UpdateExtentsForChild(MemEntryImpl* child) {
+  int64 child_start = static_cast<int64>(child->child_id_)
+                      << kMaxSparseEntryBits;
 
-  // This loop tries to find the first existing child.
-  while (scanned_len < len) {
-    // This points to the current offset in the child.
-    int current_child_offset = ToChildOffset(offset + scanned_len);
-    MemEntryImpl* current_child = OpenChild(offset + scanned_len, false);
-    if (current_child) {
-      int child_first_pos = current_child->child_first_pos_;
+  // A child stores a single contiguous run, so anything previously indexed
+  // for its range is stale after a write.
+  RemoveSparseExtent(child_start, kMaxSparseEntrySize);
 
-      // This points to the first byte that we should be reading from, we need
-      // to take care of the filled region and the current offset in the child.
-      int first_pos =  std::max(current_child_offset, child_first_pos);
+  int filled = child->GetDataSize(kSparseData) - child->child_first_pos_;
+  if (filled > 0)
+    AddSparseExtent(child_start + child->child_first_pos_, filled);
+}
 
-      // If the first byte position we should read from doesn't exceed the
-      // filled region, we have found the first child.
-      if (first_pos < current_child->GetDataSize(kSparseData)) {
-         *child = current_child;
+void MemEntryImpl::AddSparseExtent(int64 offset, int64 len) {
+  DCHECK(extents_.get());
+  if (len <= 0)
+    return;
+  int64 end = offset + len;
+
+  // Merge with a run that starts before |offset| and reaches it.
+  ExtentMap::iterator it = extents_->upper_bound(offset);
+  if (it != extents_->begin()) {
+    ExtentMap::iterator prev = it;
+    --prev;
+    if (prev->first + prev->second >= offset) {
+      offset = prev->first;
+      if (prev->first + prev->second > end)
+        end = prev->first + prev->second;
+      extents_->erase(prev);
+    }
+  }
 
-         // We need to advance the scanned length.
-         scanned_len += first_pos - current_child_offset;
-         break;
-      }
+  // Absorb the runs that the merged range overlaps or touches.
+  it = extents_->lower_bound(offset);
+  while (it != extents_->end() && it->first <= end) {
+    if (it->first + it->second > end)
+      end = it->first + it->second;
+    extents_->erase(it++);
+  }
+
+  (*extents_)[offset] = end - offset;
+}
+
+void MemEntryImpl::RemoveSparseExtent(int64 offset, int64 len) {
+  DCHECK(extents_.get());
+  if (len <= 0)
+    return;
+  int64 end = offset + len;
+
+  // Trim a run that starts before |offset| and extends into the removed
+  // range, keeping whatever part of it survives on either side.
+  ExtentMap::iterator it = extents_->upper_bound(offset);
+  if (it != extents_->begin()) {
+    ExtentMap::iterator prev = it;
+    --prev;
+    int64 prev_end = prev->first + prev->second;
+    if (prev_end > offset) {
+      prev->second = offset - prev->first;
+      if (!prev->second)
+        extents_->erase(prev);
+      if (prev_end > end)
+        (*extents_)[end] = prev_end - end;
+    }
+  }
+
+  // Drop the runs that start inside the removed range, keeping any tail that
+  // extends past its end.
+  it = extents_->lower_bound(offset);
+  while (it != extents_->end() && it->first < end) {
+    int64 it_end = it->first + it->second;
+    extents_->erase(it++);
+    if (it_end > end) {
+      (*extents_)[end] = it_end - end;
+      break;
     }
-    scanned_len += kMaxSparseEntrySize - current_child_offset;
   }
-  return scanned_len;
 }
 
 void MemEntryImpl::DetachChild(int child_id) {
   children_->erase(child_id);
+
+  // The child's data is gone (e.g. it was evicted), so its range must not be
+  // reported as available anymore.
+  RemoveSparseExtent(static_cast<int64>(child_id) << kMaxSparseEntryBits,
+                     kMaxSparseEntrySize);
 }
 
 }  // namespace disk_cache
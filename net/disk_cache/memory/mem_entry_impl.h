@@ -5,6 +5,8 @@
 #ifndef NET_DISK_CACHE_MEMORY_MEM_ENTRY_IMPL_H_
 #define NET_DISK_CACHE_MEMORY_MEM_ENTRY_IMPL_H_
 
+#include <map>
+
 #include "base/containers/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/disk_cache/disk_cache.h"
@@ -41,6 +43,12 @@ class MemBackendImpl;
 // region, and the unfilled region (if there is one) is always before the filled
 // region. The book keeping for filled region in a sparse entry is done by using
 // the variable |child_first_pos_| (inclusive).
+//
+// In addition to the child entries, the parent keeps an extent index: an
+// ordered map of the filled (offset, length) runs across all children.
+// GetAvailableRange is answered directly from this index in logarithmic time
+// instead of probing the children one block at a time, which matters for
+// large sparse entries (e.g. media) with few long runs.
 
 class MemEntryImpl : public Entry {
  public:
@@ -122,6 +130,10 @@ class MemEntryImpl : public Entry {
  private:
   typedef base::hash_map<int, MemEntryImpl*> EntryMap;
 
+  // Offset of a filled run to its length. The runs are disjoint and
+  // non-adjacent (touching runs are coalesced on insertion).
+  typedef std::map<int64, int64> ExtentMap;
+
   enum {
     NUM_STREAMS = 3
   };
@@ -160,10 +172,18 @@ class MemEntryImpl : public Entry {
   // created.
   MemEntryImpl* OpenChild(int64 offset, bool create);
 
-  // Finds the first child located within the range [|offset|, |offset + len|).
-  // Returns the number of bytes ahead of |offset| to reach the first available
-  // bytes in the entry. The first child found is output to |child|.
-  int FindNextChild(int64 offset, int len, MemEntryImpl** child);
+  // Re-derives the extent covered by |child| from its filled region and
+  // updates the extent index accordingly. Called after every write to the
+  // child, since a write can discard previously stored bytes.
+  void UpdateExtentsForChild(MemEntryImpl* child);
+
+  // Records [|offset|, |offset| + |len|) as filled, merging with any runs it
+  // touches.
+  void AddSparseExtent(int64 offset, int64 len);
+
+  // Removes [|offset|, |offset| + |len|) from the filled runs, splitting a
+  // run if the removed range falls in its middle.
+  void RemoveSparseExtent(int64 offset, int64 len);
 
   // Removes child indexed by |child_id| from the children map.
   void DetachChild(int child_id);
@@ -180,6 +200,7 @@ class MemEntryImpl : public Entry {
   MemEntryImpl* prev_;
   MemEntryImpl* parent_;      // Pointer to the parent entry.
   scoped_ptr<EntryMap> children_;
+  scoped_ptr<ExtentMap> extents_;  // Index of the filled runs.
 
   base::Time last_modified_;  // LRU information.
   base::Time last_used_;
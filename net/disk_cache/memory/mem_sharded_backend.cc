@@ -0,0 +1,184 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/memory/mem_sharded_backend.h"
+
+#include "base/hash.h"
+#include "base/logging.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/memory/mem_backend_impl.h"
+
+namespace disk_cache {
+
+namespace {
+
+const int kMaxMemShards = 64;
+
+}  // namespace
+
+// Enumerates the shards one after another, exhausting each shard's iterator
+// before moving on to the next. Everything is synchronous, so there is no
+// continuation machinery; a shard returning ERR_FAILED simply advances the
+// chain.
+class ShardedMemBackendImpl::ShardedMemIterator : public Backend::Iterator {
+ public:
+  explicit ShardedMemIterator(ShardedMemBackendImpl* backend)
+      : current_shard_(0) {
+    for (size_t i = 0; i < backend->shards_.size(); i++)
+      shard_iterators_.push_back(
+          backend->shards_[i]->CreateIterator().release());
+  }
+
+  int OpenNextEntry(Entry** next_entry,
+                    const CompletionCallback& callback) override {
+    while (current_shard_ < shard_iterators_.size()) {
+      int rv = shard_iterators_[current_shard_]->OpenNextEntry(next_entry,
+                                                               callback);
+      if (rv != net::ERR_FAILED)
+        return rv;
+      current_shard_++;
+    }
+    return net::ERR_FAILED;
+  }
+
+ private:
+  ScopedVector<Backend::Iterator> shard_iterators_;
+  size_t current_shard_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedMemIterator);
+};
+
+ShardedMemBackendImpl::ShardedMemBackendImpl(int num_shards,
+                                             net::NetLog* net_log)
+    : num_shards_(num_shards), net_log_(net_log), max_size_(0) {
+  DCHECK_GT(num_shards_, 0);
+  DCHECK_LE(num_shards_, kMaxMemShards);
+}
+
+ShardedMemBackendImpl::~ShardedMemBackendImpl() {
+}
+
+// Static.
+scoped_ptr<Backend> ShardedMemBackendImpl::CreateBackend(int max_bytes,
+                                                         int num_shards,
+                                                         net::NetLog* net_log) {
+  scoped_ptr<ShardedMemBackendImpl> cache(
+      new ShardedMemBackendImpl(num_shards, net_log));
+  cache->SetMaxSize(max_bytes);
+  if (cache->Init())
+    return cache.Pass();
+
+  LOG(ERROR) << "Unable to create sharded memory cache";
+  return nullptr;
+}
+
+bool ShardedMemBackendImpl::SetMaxSize(int max_bytes) {
+  DCHECK(shards_.empty());
+  if (max_bytes < 0)
+    return false;
+
+  max_size_ = max_bytes;
+  return true;
+}
+
+bool ShardedMemBackendImpl::Init() {
+  DCHECK(shards_.empty());
+  for (int i = 0; i < num_shards_; i++) {
+    scoped_ptr<MemBackendImpl> shard(new MemBackendImpl(net_log_));
+    shard->SetPreciseAccounting();
+    if (max_size_)
+      shard->SetMaxSize(max_size_ / num_shards_);
+    if (!shard->Init())
+      return false;
+    shards_.push_back(shard.release());
+  }
+  return true;
+}
+
+net::CacheType ShardedMemBackendImpl::GetCacheType() const {
+  return net::MEMORY_CACHE;
+}
+
+int32 ShardedMemBackendImpl::GetEntryCount() const {
+  int32 count = 0;
+  for (size_t i = 0; i < shards_.size(); i++)
+    count += shards_[i]->GetEntryCount();
+  return count;
+}
+
+int ShardedMemBackendImpl::OpenEntry(const std::string& key,
+                                     Entry** entry,
+                                     const CompletionCallback& callback) {
+  return GetShard(key)->OpenEntry(key, entry, callback);
+}
+
+int ShardedMemBackendImpl::CreateEntry(const std::string& key,
+                                       Entry** entry,
+                                       const CompletionCallback& callback) {
+  return GetShard(key)->CreateEntry(key, entry, callback);
+}
+
+int ShardedMemBackendImpl::DoomEntry(const std::string& key,
+                                     const CompletionCallback& callback) {
+  return GetShard(key)->DoomEntry(key, callback);
+}
+
+int ShardedMemBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  for (size_t i = 0; i < shards_.size(); i++) {
+    int rv = shards_[i]->DoomAllEntries(callback);
+    if (rv != net::OK)
+      return rv;
+  }
+  return net::OK;
+}
+
+int ShardedMemBackendImpl::DoomEntriesBetween(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const CompletionCallback& callback) {
+  for (size_t i = 0; i < shards_.size(); i++) {
+    int rv = shards_[i]->DoomEntriesBetween(initial_time, end_time, callback);
+    if (rv != net::OK)
+      return rv;
+  }
+  return net::OK;
+}
+
+int ShardedMemBackendImpl::DoomEntriesSince(
+    const base::Time initial_time,
+    const CompletionCallback& callback) {
+  for (size_t i = 0; i < shards_.size(); i++) {
+    int rv = shards_[i]->DoomEntriesSince(initial_time, callback);
+    if (rv != net::OK)
+      return rv;
+  }
+  return net::OK;
+}
+
+int ShardedMemBackendImpl::CalculateSizeOfAllEntries(
+    const CompletionCallback& callback) {
+  int total = 0;
+  for (size_t i = 0; i < shards_.size(); i++)
+    total += shards_[i]->CalculateSizeOfAllEntries(callback);
+  return total;
+}
+
+scoped_ptr<Backend::Iterator> ShardedMemBackendImpl::CreateIterator() {
+  return scoped_ptr<Backend::Iterator>(new ShardedMemIterator(this));
+}
+
+void ShardedMemBackendImpl::OnExternalCacheHit(const std::string& key) {
+  GetShard(key)->OnExternalCacheHit(key);
+}
+
+MemBackendImpl* ShardedMemBackendImpl::GetShard(const std::string& key) {
+  // Pick the shard from the top bits of the hash; taking the hash modulo the
+  // shard count would correlate with the hash table bucket inside each shard.
+  uint32_t hash = base::Hash(key);
+  size_t shard = (static_cast<uint64_t>(hash) *
+                  static_cast<uint64_t>(num_shards_)) >> 32;
+  return shards_[shard];
+}
+
+}  // namespace disk_cache
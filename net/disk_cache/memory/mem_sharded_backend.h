@@ -0,0 +1,86 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// See net/disk_cache/disk_cache.h for the public interface of the cache.
+
+#ifndef NET_DISK_CACHE_MEMORY_MEM_SHARDED_BACKEND_H_
+#define NET_DISK_CACHE_MEMORY_MEM_SHARDED_BACKEND_H_
+
+#include "base/memory/scoped_vector.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace net {
+class NetLog;
+}  // namespace net
+
+namespace disk_cache {
+
+class MemBackendImpl;
+
+// An in-memory backend that splits its key space over a number of independent
+// MemBackendImpl shards, each with its own entry map, ranking list and byte
+// budget. Shards use precise byte accounting (see
+// MemBackendImpl::SetPreciseAccounting()), so large configured sizes match
+// actual memory use more closely than the plain in-memory backend. All
+// operations complete synchronously, like MemBackendImpl.
+class NET_EXPORT_PRIVATE ShardedMemBackendImpl : public Backend {
+ public:
+  ShardedMemBackendImpl(int num_shards, net::NetLog* net_log);
+  ~ShardedMemBackendImpl() override;
+
+  // Returns a fully initialized sharded in-memory backend, or NULL on failure.
+  // |max_bytes| is the total budget, split evenly between shards; zero means
+  // use the default size. The returned object should be deleted when not
+  // needed anymore.
+  static scoped_ptr<Backend> CreateBackend(int max_bytes,
+                                           int num_shards,
+                                           net::NetLog* net_log);
+
+  // Sets the total maximum size; each shard gets an even split. Must be
+  // called before Init().
+  bool SetMaxSize(int max_bytes);
+
+  // Creates and initializes the shards.
+  bool Init();
+
+  // Backend interface.
+  net::CacheType GetCacheType() const override;
+  int32 GetEntryCount() const override;
+  int OpenEntry(const std::string& key,
+                Entry** entry,
+                const CompletionCallback& callback) override;
+  int CreateEntry(const std::string& key,
+                  Entry** entry,
+                  const CompletionCallback& callback) override;
+  int DoomEntry(const std::string& key,
+                const CompletionCallback& callback) override;
+  int DoomAllEntries(const CompletionCallback& callback) override;
+  int DoomEntriesBetween(base::Time initial_time,
+                         base::Time end_time,
+                         const CompletionCallback& callback) override;
+  int DoomEntriesSince(base::Time initial_time,
+                       const CompletionCallback& callback) override;
+  int CalculateSizeOfAllEntries(const CompletionCallback& callback) override;
+  scoped_ptr<Iterator> CreateIterator() override;
+  void GetStats(base::StringPairs* stats) override {}
+  void OnExternalCacheHit(const std::string& key) override;
+
+ private:
+  class ShardedMemIterator;
+
+  // Returns the shard that owns |key|.
+  MemBackendImpl* GetShard(const std::string& key);
+
+  const int num_shards_;
+  net::NetLog* net_log_;
+  int max_size_;  // Total budget for all shards.
+
+  ScopedVector<MemBackendImpl> shards_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedMemBackendImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_MEMORY_MEM_SHARDED_BACKEND_H_
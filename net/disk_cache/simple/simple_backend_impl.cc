@@ -387,6 +387,17 @@ int SimpleBackendImpl::OpenEntry(const std::string& key,
                                     operation, callback));
     return net::ERR_IO_PENDING;
   }
+  // Once the index is loaded it is authoritative, so a miss can be failed
+  // straight from memory without constructing an entry or posting to the
+  // worker pool. This is what makes batch opens through OpenEntries()
+  // cheap: misses complete inline and only keys that exist fan out to
+  // parallel file opens.
+  if (index_->initialized() &&
+      active_entries_.find(entry_hash) == active_entries_.end() &&
+      !index_->Has(entry_hash)) {
+    return net::ERR_FAILED;
+  }
+
   scoped_refptr<SimpleEntryImpl> simple_entry =
       CreateOrFindActiveEntry(entry_hash, key);
   CompletionCallback backend_callback =
@@ -0,0 +1,83 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_bloom_filter.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace {
+
+// Number of bit probes per hash. Together with ~10 bits per entry this gives
+// a false positive rate of about 1%.
+const uint32 kNumProbes = 7;
+
+const size_t kBitsPerEntry = 10;
+
+// Smallest filter produced, in bits (512 bytes). There is no point in a
+// smaller allocation, and tiny caches get an excellent false positive rate.
+const size_t kMinBitCount = 1 << 12;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+bool IsPowerOfTwo(size_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+SimpleBloomFilter::SimpleBloomFilter(size_t expected_entries) {
+  size_t bit_count = RoundUpToPowerOfTwo(
+      std::max(expected_entries * kBitsPerEntry, kMinBitCount));
+  bits_.resize(bit_count / 8);
+}
+
+SimpleBloomFilter::SimpleBloomFilter(const std::vector<uint8>& bits)
+    : bits_(bits) {
+}
+
+SimpleBloomFilter::~SimpleBloomFilter() {
+}
+
+// static
+scoped_ptr<SimpleBloomFilter> SimpleBloomFilter::FromBitData(
+    const std::vector<uint8>& data) {
+  if (!IsPowerOfTwo(data.size()))
+    return nullptr;
+  return scoped_ptr<SimpleBloomFilter>(new SimpleBloomFilter(data));
+}
+
+void SimpleBloomFilter::Add(uint64 entry_hash) {
+  // Double hashing: the entry hashes are already uniformly distributed, so
+  // the two 32-bit halves make independent enough probe generators.
+  const uint32 h1 = static_cast<uint32>(entry_hash);
+  const uint32 h2 = static_cast<uint32>(entry_hash >> 32) | 1;
+  const uint32 mask = static_cast<uint32>(bits_.size() * 8 - 1);
+  for (uint32 i = 0; i < kNumProbes; ++i) {
+    const uint32 bit = (h1 + i * h2) & mask;
+    bits_[bit / 8] |= 1 << (bit % 8);
+  }
+}
+
+bool SimpleBloomFilter::MightContain(uint64 entry_hash) const {
+  const uint32 h1 = static_cast<uint32>(entry_hash);
+  const uint32 h2 = static_cast<uint32>(entry_hash >> 32) | 1;
+  const uint32 mask = static_cast<uint32>(bits_.size() * 8 - 1);
+  for (uint32 i = 0; i < kNumProbes; ++i) {
+    const uint32 bit = (h1 + i * h2) & mask;
+    if (!(bits_[bit / 8] & (1 << (bit % 8))))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,52 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// A Bloom filter over the entry hashes of a Simple Cache instance. It is used
+// to reject lookups of absent entries without touching the disk while the
+// full index is still loading. The filter has no false negatives with respect
+// to the hashes added to it; a false positive merely falls through to the
+// disk open that every lookup pays today.
+class NET_EXPORT_PRIVATE SimpleBloomFilter {
+ public:
+  // Creates an empty filter sized for |expected_entries| entries at roughly
+  // ten bits per entry, which keeps the false positive rate around 1%.
+  explicit SimpleBloomFilter(size_t expected_entries);
+  ~SimpleBloomFilter();
+
+  // Recreates a filter from bits previously obtained through bit_data().
+  // Returns NULL if |data| does not have a valid (power-of-two) size.
+  static scoped_ptr<SimpleBloomFilter> FromBitData(
+      const std::vector<uint8>& data);
+
+  void Add(uint64 entry_hash);
+
+  // Returns false only if |entry_hash| was never added.
+  bool MightContain(uint64 entry_hash) const;
+
+  const std::vector<uint8>& bit_data() const { return bits_; }
+
+ private:
+  explicit SimpleBloomFilter(const std::vector<uint8>& bits);
+
+  // The bit array; its size in bits is always a power of two, so that the
+  // hash probes reduce to a mask.
+  std::vector<uint8> bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleBloomFilter);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
@@ -0,0 +1,61 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_bloom_filter.h"
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+
+class SimpleBloomFilterTest : public testing::Test {};
+
+TEST_F(SimpleBloomFilterTest, NoFalseNegatives) {
+  SimpleBloomFilter filter(1000);
+  for (uint64 i = 0; i < 1000; ++i) {
+    const uint64 hash = i * UINT64_C(0x9e3779b97f4a7c15) + 1;
+    filter.Add(hash);
+    EXPECT_TRUE(filter.MightContain(hash));
+  }
+  for (uint64 i = 0; i < 1000; ++i)
+    EXPECT_TRUE(filter.MightContain(i * UINT64_C(0x9e3779b97f4a7c15) + 1));
+}
+
+TEST_F(SimpleBloomFilterTest, MostlyRejectsAbsentHashes) {
+  SimpleBloomFilter filter(1000);
+  for (uint64 i = 0; i < 1000; ++i)
+    filter.Add(i * UINT64_C(0x9e3779b97f4a7c15) + 1);
+
+  // With ~10 bits per entry and 7 probes the false positive rate should be
+  // around 1%; allow a generous margin so the test is not flaky.
+  int false_positives = 0;
+  for (uint64 i = 0; i < 1000; ++i) {
+    if (filter.MightContain(i * UINT64_C(0xc6a4a7935bd1e995) + 7))
+      ++false_positives;
+  }
+  EXPECT_LT(false_positives, 100);
+}
+
+TEST_F(SimpleBloomFilterTest, RoundTripsThroughBitData) {
+  SimpleBloomFilter filter(100);
+  for (uint64 i = 0; i < 100; ++i)
+    filter.Add(i * UINT64_C(0x9e3779b97f4a7c15) + 1);
+
+  scoped_ptr<SimpleBloomFilter> copy =
+      SimpleBloomFilter::FromBitData(filter.bit_data());
+  ASSERT_TRUE(copy);
+  for (uint64 i = 0; i < 100; ++i)
+    EXPECT_TRUE(copy->MightContain(i * UINT64_C(0x9e3779b97f4a7c15) + 1));
+}
+
+TEST_F(SimpleBloomFilterTest, RejectsCorruptBitData) {
+  // The bit count must be a power of two for the probe mask to be valid.
+  EXPECT_FALSE(SimpleBloomFilter::FromBitData(std::vector<uint8>()));
+  EXPECT_FALSE(SimpleBloomFilter::FromBitData(std::vector<uint8>(100)));
+}
+
+}  // namespace disk_cache
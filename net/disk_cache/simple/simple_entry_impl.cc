@@ -224,6 +224,10 @@ int SimpleEntryImpl::OpenEntry(Entry** out_entry,
       open_entry_index_enum = INDEX_HIT;
     else
       open_entry_index_enum = INDEX_MISS;
+  } else if (!backend_->index()->Has(entry_hash_)) {
+    // The index is still loading, but its Bloom filter already rules this
+    // hash out, so the disk probe that a miss would cost can be skipped.
+    open_entry_index_enum = INDEX_MISS;
   }
   SIMPLE_CACHE_UMA(ENUMERATION,
                    "OpenEntryIndexState", cache_type_,
@@ -550,6 +554,7 @@ void SimpleEntryImpl::PostClientCallback(const CompletionCallback& callback,
 
 void SimpleEntryImpl::MakeUninitialized() {
   state_ = STATE_UNINITIALIZED;
+  stream_1_prefetch_data_ = NULL;
   std::memset(crc32s_end_offset_, 0, sizeof(crc32s_end_offset_));
   std::memset(crc32s_, 0, sizeof(crc32s_));
   std::memset(have_written_, 0, sizeof(have_written_));
@@ -855,6 +860,29 @@ void SimpleEntryImpl::ReadDataInternal(int stream_index,
     return;
   }
 
+  // Stream 1 data may have been prefetched and verified when the entry was
+  // opened; while it is still valid (no writes since), reads are served from
+  // memory too.
+  if (stream_index == 1 && stream_1_prefetch_data_.get()) {
+    if (!doomed_ && backend_.get())
+      backend_->index()->UseIfExists(entry_hash_);
+    memcpy(buf->data(), stream_1_prefetch_data_->data() + offset, buf_len);
+    UpdateDataFromEntryStat(
+        SimpleEntryStat(base::Time::Now(), last_modified_, data_size_,
+                        sparse_data_size_));
+    RecordReadResult(cache_type_, READ_RESULT_SUCCESS);
+    if (!callback.is_null()) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE, base::Bind(callback, buf_len));
+    }
+    if (net_log_.IsCapturing()) {
+      net_log_.AddEvent(
+          net::NetLog::TYPE_SIMPLE_CACHE_ENTRY_READ_END,
+          CreateNetLogReadWriteCompleteCallback(buf_len));
+    }
+    return;
+  }
+
   state_ = STATE_IO_PENDING;
   if (!doomed_ && backend_.get())
     backend_->index()->UseIfExists(entry_hash_);
@@ -942,6 +970,10 @@ void SimpleEntryImpl::WriteDataInternal(int stream_index,
   if (!doomed_ && backend_.get())
     backend_->index()->UseIfExists(entry_hash_);
 
+  // Any write to stream 1 invalidates its prefetched copy.
+  if (stream_index == 1)
+    stream_1_prefetch_data_ = NULL;
+
   AdvanceCrc(buf, offset, buf_len, stream_index);
 
   // |entry_stat| needs to be initialized before modifying |data_size_|.
@@ -1123,6 +1155,14 @@ void SimpleEntryImpl::CreationOperationComplete(
     crc32s_[0] = in_results->stream_0_crc32;
     crc32s_end_offset_[0] = in_results->entry_stat.data_size(0);
   }
+  if (in_results->stream_1_data.get()) {
+    stream_1_prefetch_data_ = in_results->stream_1_data;
+    // The whole stream was read and verified in SimpleSynchronousEntry, so no
+    // further incremental checksumming is needed.
+    crc_check_state_[1] = CRC_CHECK_DONE;
+    crc32s_[1] = in_results->stream_1_crc32;
+    crc32s_end_offset_[1] = in_results->entry_stat.data_size(1);
+  }
   if (key_.empty()) {
     SetKey(synchronous_entry_->key());
   } else {
@@ -378,6 +378,13 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
   // used to write HTTP headers, the memory consumption of keeping it in memory
   // is acceptable.
   scoped_refptr<net::GrowableIOBuffer> stream_0_data_;
+
+  // When a small stream 1 is opened, its data is prefetched and verified in
+  // the same worker-pool task that opened the entry, and reads are then
+  // served from this buffer without further thread hops. The buffer is
+  // dropped on the first write to stream 1, after which reads go back to the
+  // worker pool.
+  scoped_refptr<net::GrowableIOBuffer> stream_1_prefetch_data_;
 };
 
 }  // namespace disk_cache
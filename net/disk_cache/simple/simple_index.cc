@@ -24,6 +24,7 @@
 #include "base/threading/worker_pool.h"
 #include "base/time/time.h"
 #include "net/base/net_errors.h"
+#include "net/disk_cache/simple/simple_bloom_filter.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index_delegate.h"
@@ -151,6 +152,8 @@ SimpleIndex::SimpleIndex(
       low_watermark_(0),
       eviction_in_progress_(false),
       initialized_(false),
+      full_index_write_required_(true),
+      journal_records_since_compaction_(0),
       index_file_(index_file.Pass()),
       io_thread_(io_thread),
       // Creating the callback once so it is reused every time
@@ -179,6 +182,16 @@ void SimpleIndex::Initialize(base::Time cache_mtime) {
   }
 #endif
 
+  // The Bloom filter is a few kilobytes, so it becomes available long before
+  // the index itself and covers the lookups made in the meantime.
+  SimpleBloomFilterLoadResult* bloom_result = new SimpleBloomFilterLoadResult();
+  scoped_ptr<SimpleBloomFilterLoadResult> bloom_result_scoped(bloom_result);
+  base::Closure bloom_reply = base::Bind(
+      &SimpleIndex::OnBloomFilterLoaded,
+      AsWeakPtr(),
+      base::Passed(&bloom_result_scoped));
+  index_file_->LoadBloomFilter(cache_mtime, bloom_reply, bloom_result);
+
   SimpleIndexLoadResult* load_result = new SimpleIndexLoadResult();
   scoped_ptr<SimpleIndexLoadResult> load_result_scoped(load_result);
   base::Closure reply = base::Bind(
@@ -244,6 +257,21 @@ uint64 SimpleIndex::GetCacheSize() const {
   return cache_size_;
 }
 
+size_t SimpleIndex::EstimateMemoryUsage() const {
+  // Estimated allocator cost of one hash table node beyond the stored value:
+  // a next pointer and a cached hash.
+  const size_t kHashNodeOverhead = 2 * sizeof(void*);
+  size_t estimate =
+      entries_set_.size() *
+          (sizeof(EntrySet::value_type) + kHashNodeOverhead) +
+      entries_set_.bucket_count() * sizeof(void*);
+  estimate += (removed_entries_.size() + dirty_entries_.size()) *
+              (sizeof(uint64) + kHashNodeOverhead);
+  if (bloom_filter_)
+    estimate += bloom_filter_->bit_data().size();
+  return estimate;
+}
+
 void SimpleIndex::Insert(uint64 entry_hash) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   // Upon insert we don't know yet the size of the entry.
@@ -251,8 +279,12 @@ void SimpleIndex::Insert(uint64 entry_hash) {
   // creating the new entry, and then UpdateEntrySize will be called.
   InsertInEntrySet(
       entry_hash, EntryMetadata(base::Time::Now(), 0), &entries_set_);
-  if (!initialized_)
+  if (!initialized_) {
     removed_entries_.erase(entry_hash);
+    if (bloom_filter_)
+      bloom_filter_->Add(entry_hash);
+  }
+  dirty_entries_.insert(entry_hash);
   PostponeWritingToDisk();
 }
 
@@ -266,13 +298,21 @@ void SimpleIndex::Remove(uint64 entry_hash) {
 
   if (!initialized_)
     removed_entries_.insert(entry_hash);
+  dirty_entries_.insert(entry_hash);
   PostponeWritingToDisk();
 }
 
 bool SimpleIndex::Has(uint64 hash) const {
   DCHECK(io_thread_checker_.CalledOnValidThread());
-  // If not initialized, always return true, forcing it to go to the disk.
-  return !initialized_ || entries_set_.count(hash) > 0;
+  if (!initialized_) {
+    // While the index is loading, the Bloom filter persisted at the last
+    // index write can still reject most absent entries without a disk probe.
+    // With no filter (not yet loaded, missing or stale) claim the entry
+    // exists, forcing it to go to the disk.
+    return !bloom_filter_ || bloom_filter_->MightContain(hash) ||
+           entries_set_.count(hash) > 0;
+  }
+  return entries_set_.count(hash) > 0;
 }
 
 bool SimpleIndex::UseIfExists(uint64 entry_hash) {
@@ -284,6 +324,7 @@ bool SimpleIndex::UseIfExists(uint64 entry_hash) {
     // If not initialized, always return true, forcing it to go to the disk.
     return !initialized_;
   it->second.SetLastUsedTime(base::Time::Now());
+  dirty_entries_.insert(entry_hash);
   PostponeWritingToDisk();
   return true;
 }
@@ -344,6 +385,7 @@ bool SimpleIndex::UpdateEntrySize(uint64 entry_hash, int64 entry_size) {
     return false;
 
   UpdateEntryIteratorSize(&it, entry_size);
+  dirty_entries_.insert(entry_hash);
   PostponeWritingToDisk();
   StartEvictionIfNeeded();
   return true;
@@ -424,6 +466,9 @@ void SimpleIndex::MergeInitializingSet(
   entries_set_.swap(*index_file_entries);
   cache_size_ = merged_cache_size;
   initialized_ = true;
+  // From here on |entries_set_| is authoritative, so the filter is no longer
+  // consulted.
+  bloom_filter_.reset();
 
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
   // merge down much.
@@ -441,6 +486,19 @@ void SimpleIndex::MergeInitializingSet(
   to_run_when_initialized_.clear();
 }
 
+void SimpleIndex::OnBloomFilterLoaded(
+    scoped_ptr<SimpleBloomFilterLoadResult> result) {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  if (initialized_ || !result->filter)
+    return;
+  bloom_filter_ = result->filter.Pass();
+  // Entries created while the filter was loading are only in |entries_set_|.
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    bloom_filter_->Add(it->first);
+  }
+}
+
 #if defined(OS_ANDROID)
 void SimpleIndex::OnApplicationStateChange(
     base::android::ApplicationState state) {
@@ -478,8 +536,35 @@ void SimpleIndex::WriteToDisk() {
   }
   last_write_to_disk_ = start;
 
+  // Prefer appending just the dirty entries to the index journal; rewrite the
+  // whole index only when required or once the journal would grow past a
+  // fraction of the index size (a rewrite discards the journal).
+  const size_t journal_size_cap = entries_set_.size() / 2 + 1;
+  if (!full_index_write_required_ &&
+      journal_records_since_compaction_ + dirty_entries_.size() <=
+          journal_size_cap) {
+    if (dirty_entries_.empty())
+      return;
+    scoped_ptr<std::vector<SimpleIndexFile::JournalRecord>> records(
+        new std::vector<SimpleIndexFile::JournalRecord>());
+    records->reserve(dirty_entries_.size());
+    for (base::hash_set<uint64>::const_iterator it = dirty_entries_.begin();
+         it != dirty_entries_.end(); ++it) {
+      EntrySet::const_iterator found = entries_set_.find(*it);
+      records->push_back(SimpleIndexFile::MakeJournalRecord(
+          *it, found == entries_set_.end() ? NULL : &found->second));
+    }
+    journal_records_since_compaction_ += records->size();
+    dirty_entries_.clear();
+    index_file_->AppendToJournal(records.Pass());
+    return;
+  }
+
   index_file_->WriteToDisk(entries_set_, cache_size_,
                            start, app_on_background_, base::Closure());
+  full_index_write_required_ = false;
+  dirty_entries_.clear();
+  journal_records_since_compaction_ = 0;
 }
 
 }  // namespace disk_cache
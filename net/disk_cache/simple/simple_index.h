@@ -35,8 +35,10 @@ class PickleIterator;
 
 namespace disk_cache {
 
+class SimpleBloomFilter;
 class SimpleIndexDelegate;
 class SimpleIndexFile;
+struct SimpleBloomFilterLoadResult;
 struct SimpleIndexLoadResult;
 
 class NET_EXPORT_PRIVATE EntryMetadata {
@@ -94,7 +96,10 @@ class NET_EXPORT_PRIVATE SimpleIndex
   void Insert(uint64 entry_hash);
   void Remove(uint64 entry_hash);
 
-  // Check whether the index has the entry given the hash of its key.
+  // Check whether the index has the entry given the hash of its key. Until
+  // the index finishes initializing this errs on the side of claiming the
+  // entry exists, unless the Bloom filter persisted with the index has been
+  // loaded and rules the hash out.
   bool Has(uint64 entry_hash) const;
 
   // Update the last used time of the entry with the given key and return true
@@ -134,6 +139,10 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // index has been initialized.
   uint64 GetCacheSize() const;
 
+  // Estimates the heap memory held by the in-memory index: the entry set,
+  // the bookkeeping hash sets and the Bloom filter, in bytes.
+  size_t EstimateMemoryUsage() const;
+
   // Returns whether the index has been initialized yet.
   bool initialized() const { return initialized_; }
 
@@ -143,6 +152,7 @@ class NET_EXPORT_PRIVATE SimpleIndex
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteQueued);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteExecuted);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWritePostponed);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteUsesJournal);
 
   void StartEvictionIfNeeded();
   void EvictionDone(int result);
@@ -154,6 +164,10 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // Must run on IO Thread.
   void MergeInitializingSet(scoped_ptr<SimpleIndexLoadResult> load_result);
 
+  // Must run on IO Thread. Installs the Bloom filter loaded from disk,
+  // unless the full index finished loading first.
+  void OnBloomFilterLoaded(scoped_ptr<SimpleBloomFilterLoadResult> result);
+
 #if defined(OS_ANDROID)
   void OnApplicationStateChange(base::android::ApplicationState state);
 
@@ -178,6 +192,25 @@ class NET_EXPORT_PRIVATE SimpleIndex
   base::hash_set<uint64> removed_entries_;
   bool initialized_;
 
+  // Rejects lookups of absent entries while the index is initializing; NULL
+  // before the filter is loaded and after initialization, when |entries_set_|
+  // is authoritative.
+  scoped_ptr<SimpleBloomFilter> bloom_filter_;
+
+  // The entry_hash of entries mutated since the last flush. When few entries
+  // are dirty, WriteToDisk() appends just these to the index journal instead
+  // of rewriting the whole index.
+  base::hash_set<uint64> dirty_entries_;
+
+  // Forces the next WriteToDisk() to rewrite the whole index file; set
+  // initially and whenever the journal has grown large enough that a rewrite
+  // (which discards it) is cheaper than letting it grow.
+  bool full_index_write_required_;
+
+  // Number of records appended to the journal since the index file was last
+  // rewritten.
+  int journal_records_since_compaction_;
+
   scoped_ptr<SimpleIndexFile> index_file_;
 
   scoped_refptr<base::SingleThreadTaskRunner> io_thread_;
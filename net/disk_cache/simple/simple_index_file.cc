@@ -4,6 +4,8 @@
 
 #include "net/disk_cache/simple/simple_index_file.h"
 
+#include <stddef.h>
+
 #include <vector>
 
 #include "base/files/file.h"
@@ -17,6 +19,7 @@
 #include "base/task_runner_util.h"
 #include "base/threading/thread_restrictions.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
+#include "net/disk_cache/simple/simple_bloom_filter.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
@@ -40,6 +43,12 @@ uint32 CalculatePickleCRC(const base::Pickle& pickle) {
                pickle.payload_size());
 }
 
+uint32 CalculateJournalRecordCRC(const SimpleIndexFile::JournalRecord& record) {
+  return crc32(crc32(0, Z_NULL, 0),
+               reinterpret_cast<const Bytef*>(&record),
+               offsetof(SimpleIndexFile::JournalRecord, crc));
+}
+
 // Used in histograms. Please only add new values at the end.
 enum IndexFileState {
   INDEX_STATE_CORRUPT = 0,
@@ -141,6 +150,12 @@ SimpleIndexLoadResult::SimpleIndexLoadResult() : did_load(false),
 SimpleIndexLoadResult::~SimpleIndexLoadResult() {
 }
 
+SimpleBloomFilterLoadResult::SimpleBloomFilterLoadResult() {
+}
+
+SimpleBloomFilterLoadResult::~SimpleBloomFilterLoadResult() {
+}
+
 void SimpleIndexLoadResult::Reset() {
   did_load = false;
   flush_required = false;
@@ -153,6 +168,10 @@ const char SimpleIndexFile::kIndexFileName[] = "the-real-index";
 const char SimpleIndexFile::kIndexDirectory[] = "index-dir";
 // static
 const char SimpleIndexFile::kTempIndexFileName[] = "temp-index";
+// static
+const char SimpleIndexFile::kIndexJournalFileName[] = "index-journal";
+// static
+const char SimpleIndexFile::kBloomFilterFileName[] = "index-bloom";
 
 SimpleIndexFile::IndexMetadata::IndexMetadata()
     : magic_number_(kSimpleIndexMagicNumber),
@@ -193,13 +212,17 @@ bool SimpleIndexFile::IndexMetadata::Deserialize(base::PickleIterator* it) {
       it->ReadUInt64(&cache_size_);
 }
 
-void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
-                                      const base::FilePath& cache_directory,
-                                      const base::FilePath& index_filename,
-                                      const base::FilePath& temp_index_filename,
-                                      scoped_ptr<base::Pickle> pickle,
-                                      const base::TimeTicks& start_time,
-                                      bool app_on_background) {
+void SimpleIndexFile::SyncWriteToDisk(
+    net::CacheType cache_type,
+    const base::FilePath& cache_directory,
+    const base::FilePath& index_filename,
+    const base::FilePath& temp_index_filename,
+    const base::FilePath& journal_filename,
+    const base::FilePath& bloom_filter_filename,
+    scoped_ptr<base::Pickle> pickle,
+    scoped_ptr<base::Pickle> bloom_filter_pickle,
+    const base::TimeTicks& start_time,
+    bool app_on_background) {
   DCHECK_EQ(index_filename.DirName().value(),
             temp_index_filename.DirName().value());
   base::FilePath index_file_directory = temp_index_filename.DirName();
@@ -232,6 +255,15 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
   if (!base::ReplaceFile(temp_index_filename, index_filename, NULL))
     return;
 
+  // The new index supersedes anything the journal recorded.
+  simple_util::SimpleCacheDeleteFile(journal_filename);
+
+  // The Bloom filter is advisory, so it is not written atomically; a corrupt
+  // filter fails its CRC on load and is simply not used.
+  SerializeFinalData(cache_dir_mtime, bloom_filter_pickle.get());
+  if (!WritePickleFile(bloom_filter_pickle.get(), bloom_filter_filename))
+    simple_util::SimpleCacheDeleteFile(bloom_filter_filename);
+
   if (app_on_background) {
     SIMPLE_CACHE_UMA(TIMES,
                      "IndexWriteToDiskTime.Background", cache_type,
@@ -261,7 +293,11 @@ SimpleIndexFile::SimpleIndexFile(
       index_file_(cache_directory_.AppendASCII(kIndexDirectory)
                       .AppendASCII(kIndexFileName)),
       temp_index_file_(cache_directory_.AppendASCII(kIndexDirectory)
-                           .AppendASCII(kTempIndexFileName)) {
+                           .AppendASCII(kTempIndexFileName)),
+      journal_file_(cache_directory_.AppendASCII(kIndexDirectory)
+                        .AppendASCII(kIndexJournalFileName)),
+      bloom_filter_file_(cache_directory_.AppendASCII(kIndexDirectory)
+                             .AppendASCII(kBloomFilterFileName)) {
 }
 
 SimpleIndexFile::~SimpleIndexFile() {}
@@ -276,6 +312,15 @@ void SimpleIndexFile::LoadIndexEntries(base::Time cache_last_modified,
   worker_pool_->PostTaskAndReply(FROM_HERE, task, callback);
 }
 
+void SimpleIndexFile::LoadBloomFilter(base::Time cache_last_modified,
+                                      const base::Closure& callback,
+                                      SimpleBloomFilterLoadResult* out_result) {
+  base::Closure task = base::Bind(&SimpleIndexFile::SyncLoadBloomFilter,
+                                  cache_last_modified, bloom_filter_file_,
+                                  journal_file_, out_result);
+  worker_pool_->PostTaskAndReply(FROM_HERE, task, callback);
+}
+
 void SimpleIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                                   uint64 cache_size,
                                   const base::TimeTicks& start,
@@ -283,16 +328,49 @@ void SimpleIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                                   const base::Closure& callback) {
   IndexMetadata index_metadata(entry_set.size(), cache_size);
   scoped_ptr<base::Pickle> pickle = Serialize(index_metadata, entry_set);
+  scoped_ptr<base::Pickle> bloom_filter_pickle = SerializeBloomFilter(
+      entry_set);
   base::Closure task =
       base::Bind(&SimpleIndexFile::SyncWriteToDisk,
                  cache_type_, cache_directory_, index_file_, temp_index_file_,
-                 base::Passed(&pickle), start, app_on_background);
+                 journal_file_, bloom_filter_file_, base::Passed(&pickle),
+                 base::Passed(&bloom_filter_pickle), start,
+                 app_on_background);
   if (callback.is_null())
     cache_thread_->PostTask(FROM_HERE, task);
   else
     cache_thread_->PostTaskAndReply(FROM_HERE, task, callback);
 }
 
+void SimpleIndexFile::AppendToJournal(
+    scoped_ptr<std::vector<JournalRecord>> records) {
+  DCHECK(records);
+  DCHECK(!records->empty());
+  // Appends must be ordered with respect to full index writes, so they run on
+  // the cache thread like SyncWriteToDisk, not on the worker pool.
+  cache_thread_->PostTask(FROM_HERE,
+                          base::Bind(&SimpleIndexFile::SyncAppendToJournal,
+                                     cache_directory_, journal_file_,
+                                     base::Passed(&records)));
+}
+
+// static
+SimpleIndexFile::JournalRecord SimpleIndexFile::MakeJournalRecord(
+    uint64 entry_hash,
+    const EntryMetadata* entry_metadata) {
+  JournalRecord record = {};
+  record.entry_hash = entry_hash;
+  if (entry_metadata) {
+    record.last_used_time =
+        entry_metadata->GetLastUsedTime().ToInternalValue();
+    record.entry_size = entry_metadata->GetEntrySize();
+    record.op = JOURNAL_OP_UPDATE;
+  } else {
+    record.op = JOURNAL_OP_REMOVE;
+  }
+  return record;
+}
+
 // static
 void SimpleIndexFile::SyncLoadIndexEntries(
     net::CacheType cache_type,
@@ -365,8 +443,200 @@ void SimpleIndexFile::SyncLoadFromDisk(const base::FilePath& index_filename,
       out_last_cache_seen_by_index,
       out_result);
 
-  if (!out_result->did_load)
+  const base::FilePath journal_filename =
+      index_filename.DirName().AppendASCII(kIndexJournalFileName);
+  if (!out_result->did_load) {
     simple_util::SimpleCacheDeleteFile(index_filename);
+    // A journal without the index it applies to is useless.
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+
+  SyncReplayJournal(journal_filename, out_last_cache_seen_by_index, out_result);
+}
+
+// static
+void SimpleIndexFile::SyncLoadBloomFilter(
+    base::Time cache_last_modified,
+    const base::FilePath& bloom_filter_filename,
+    const base::FilePath& journal_filename,
+    SimpleBloomFilterLoadResult* out_result) {
+  File file(bloom_filter_filename,
+            File::FLAG_OPEN | File::FLAG_READ | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid())
+    return;
+
+  base::MemoryMappedFile file_map;
+  if (!file_map.Initialize(file.Pass())) {
+    simple_util::SimpleCacheDeleteFile(bloom_filter_filename);
+    return;
+  }
+
+  base::Pickle pickle(reinterpret_cast<const char*>(file_map.data()),
+                      file_map.length());
+  if (!pickle.data())
+    return;
+  PickleHeader* header_p = pickle.headerT<PickleHeader>();
+  if (header_p->crc != CalculatePickleCRC(pickle))
+    return;
+
+  base::PickleIterator pickle_it(pickle);
+  uint64 magic_number;
+  uint32 version;
+  const char* bit_data;
+  int bit_data_len;
+  int64 last_cache_seen_value;
+  if (!pickle_it.ReadUInt64(&magic_number) ||
+      !pickle_it.ReadUInt32(&version) ||
+      magic_number != kSimpleBloomMagicNumber || version != kSimpleVersion ||
+      !pickle_it.ReadData(&bit_data, &bit_data_len) || bit_data_len <= 0 ||
+      !pickle_it.ReadInt64(&last_cache_seen_value)) {
+    return;
+  }
+  base::Time last_cache_seen =
+      base::Time::FromInternalValue(last_cache_seen_value);
+
+  const uint8* bit_data_begin = reinterpret_cast<const uint8*>(bit_data);
+  scoped_ptr<SimpleBloomFilter> filter = SimpleBloomFilter::FromBitData(
+      std::vector<uint8>(bit_data_begin, bit_data_begin + bit_data_len));
+  if (!filter)
+    return;
+
+  // Entries journaled after the filter was written are not in it yet. Add
+  // them, so the filter cannot turn an existing entry into a miss; removals
+  // are skipped since a leftover bit is merely conservative. Journal mtime
+  // records advance the freshness watermark, as in SyncReplayJournal().
+  File journal(journal_filename,
+               File::FLAG_OPEN | File::FLAG_READ | File::FLAG_SHARE_DELETE);
+  if (journal.IsValid()) {
+    base::MemoryMappedFile journal_map;
+    if (!journal_map.Initialize(journal.Pass()))
+      return;
+    const size_t num_records = journal_map.length() / sizeof(JournalRecord);
+    const JournalRecord* records =
+        reinterpret_cast<const JournalRecord*>(journal_map.data());
+    for (size_t i = 0; i < num_records; ++i) {
+      const JournalRecord& record = records[i];
+      if (record.crc != CalculateJournalRecordCRC(record))
+        break;
+      if (record.op == JOURNAL_OP_UPDATE) {
+        filter->Add(record.entry_hash);
+      } else if (record.op == JOURNAL_OP_CACHE_MTIME) {
+        const base::Time mtime =
+            base::Time::FromInternalValue(record.last_used_time);
+        if (last_cache_seen < mtime)
+          last_cache_seen = mtime;
+      }
+    }
+  }
+
+  // A filter older than the cache directory may be missing entries created
+  // since it was written, so it is not safe to reject lookups with it.
+  if (cache_last_modified > last_cache_seen)
+    return;
+
+  out_result->filter = filter.Pass();
+}
+
+// static
+void SimpleIndexFile::SyncAppendToJournal(
+    const base::FilePath& cache_directory,
+    const base::FilePath& journal_filename,
+    scoped_ptr<std::vector<JournalRecord>> records) {
+  DCHECK(records);
+
+  // Record the cache directory age alongside the batch, exactly as
+  // SyncWriteToDisk does for the full index, so that a journaled index can
+  // still pass the freshness check on the next startup.
+  base::Time cache_dir_mtime;
+  if (!simple_util::GetMTime(cache_directory, &cache_dir_mtime)) {
+    LOG(ERROR) << "Could obtain information about cache age";
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+  JournalRecord mtime_record = {};
+  mtime_record.op = JOURNAL_OP_CACHE_MTIME;
+  mtime_record.last_used_time = cache_dir_mtime.ToInternalValue();
+  records->push_back(mtime_record);
+
+  File file(journal_filename, File::FLAG_OPEN_ALWAYS | File::FLAG_APPEND |
+                                  File::FLAG_WRITE | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid()) {
+    // Without the journal the on-disk index will look stale and the next
+    // startup falls back to a directory scan.
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    return;
+  }
+
+  for (size_t i = 0; i < records->size(); ++i) {
+    JournalRecord& record = (*records)[i];
+    record.crc = CalculateJournalRecordCRC(record);
+    int bytes_written = file.WriteAtCurrentPos(
+        reinterpret_cast<const char*>(&record), sizeof(record));
+    if (bytes_written != static_cast<int>(sizeof(record))) {
+      file.Close();
+      simple_util::SimpleCacheDeleteFile(journal_filename);
+      return;
+    }
+  }
+}
+
+// static
+void SimpleIndexFile::SyncReplayJournal(
+    const base::FilePath& journal_filename,
+    base::Time* in_out_last_cache_seen_by_index,
+    SimpleIndexLoadResult* out_result) {
+  File file(journal_filename,
+            File::FLAG_OPEN | File::FLAG_READ | File::FLAG_SHARE_DELETE);
+  if (!file.IsValid())
+    return;  // No journal: the index alone is authoritative.
+
+  base::MemoryMappedFile journal_map;
+  if (!journal_map.Initialize(file.Pass())) {
+    simple_util::SimpleCacheDeleteFile(journal_filename);
+    out_result->flush_required = true;
+    return;
+  }
+
+  const size_t num_records = journal_map.length() / sizeof(JournalRecord);
+  bool corrupt = journal_map.length() % sizeof(JournalRecord) != 0;
+  const JournalRecord* records =
+      reinterpret_cast<const JournalRecord*>(journal_map.data());
+  for (size_t i = 0; i < num_records; ++i) {
+    const JournalRecord& record = records[i];
+    if (record.crc != CalculateJournalRecordCRC(record)) {
+      corrupt = true;
+      break;
+    }
+    switch (record.op) {
+      case JOURNAL_OP_UPDATE:
+        out_result->entries[record.entry_hash] =
+            EntryMetadata(base::Time::FromInternalValue(record.last_used_time),
+                          record.entry_size);
+        break;
+      case JOURNAL_OP_REMOVE:
+        out_result->entries.erase(record.entry_hash);
+        break;
+      case JOURNAL_OP_CACHE_MTIME: {
+        const base::Time mtime =
+            base::Time::FromInternalValue(record.last_used_time);
+        if (*in_out_last_cache_seen_by_index < mtime)
+          *in_out_last_cache_seen_by_index = mtime;
+        break;
+      }
+      default:
+        corrupt = true;
+        break;
+    }
+    if (corrupt)
+      break;
+  }
+  if (corrupt)
+    LOG(WARNING) << "Corrupt Simple Index journal; replayed a valid prefix.";
+
+  // A full index write compacts the journal away; request one so the journal
+  // does not grow without bound (and immediately if it was corrupt).
+  out_result->flush_required = true;
 }
 
 // static
@@ -385,6 +655,25 @@ scoped_ptr<base::Pickle> SimpleIndexFile::Serialize(
   return pickle.Pass();
 }
 
+// static
+scoped_ptr<base::Pickle> SimpleIndexFile::SerializeBloomFilter(
+    const SimpleIndex::EntrySet& entries) {
+  SimpleBloomFilter filter(entries.size());
+  for (SimpleIndex::EntrySet::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    filter.Add(it->first);
+  }
+
+  scoped_ptr<base::Pickle> pickle(
+      new base::Pickle(sizeof(SimpleIndexFile::PickleHeader)));
+  pickle->WriteUInt64(kSimpleBloomMagicNumber);
+  pickle->WriteUInt32(kSimpleVersion);
+  const std::vector<uint8>& bits = filter.bit_data();
+  pickle->WriteData(reinterpret_cast<const char*>(&bits[0]),
+                    static_cast<int>(bits.size()));
+  return pickle.Pass();
+}
+
 // static
 void SimpleIndexFile::Deserialize(const char* data, int data_len,
                                   base::Time* out_cache_last_modified,
@@ -456,6 +745,10 @@ void SimpleIndexFile::SyncRestoreFromDisk(
     SimpleIndexLoadResult* out_result) {
   VLOG(1) << "Simple Cache Index is being restored from disk.";
   simple_util::SimpleCacheDeleteFile(index_file_path);
+  simple_util::SimpleCacheDeleteFile(
+      index_file_path.DirName().AppendASCII(kIndexJournalFileName));
+  simple_util::SimpleCacheDeleteFile(
+      index_file_path.DirName().AppendASCII(kBloomFilterFileName));
   out_result->Reset();
   SimpleIndex::EntrySet* entries = &out_result->entries;
 
@@ -27,7 +27,10 @@ class TaskRunner;
 
 namespace disk_cache {
 
+class SimpleBloomFilter;
+
 const uint64 kSimpleIndexMagicNumber = UINT64_C(0x656e74657220796f);
+const uint64 kSimpleBloomMagicNumber = UINT64_C(0x736620626c6f6f6d);
 
 struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
   SimpleIndexLoadResult();
@@ -39,6 +42,14 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
   bool flush_required;
 };
 
+struct NET_EXPORT_PRIVATE SimpleBloomFilterLoadResult {
+  SimpleBloomFilterLoadResult();
+  ~SimpleBloomFilterLoadResult();
+
+  // NULL when the filter file is missing, corrupt or stale.
+  scoped_ptr<SimpleBloomFilter> filter;
+};
+
 // Simple Index File format is a pickle serialized data of IndexMetadata and
 // EntryMetadata objects. The file format is as follows: one instance of
 // serialized |IndexMetadata| followed serialized |EntryMetadata| entries
@@ -46,6 +57,16 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
 // see SimpleIndexFile::Serialize() and SeeSimpleIndexFile::LoadFromDisk()
 // methods.
 //
+// In addition to the index file, changes made since the index was last
+// rewritten may be recorded in an append-only journal of fixed-layout
+// JournalRecord structs sitting next to it. On load the journal is memory
+// mapped and replayed over the deserialized index; a full index rewrite
+// discards the journal (compaction). See AppendToJournal().
+//
+// Every full index write also stores a Bloom filter over the entry hashes in
+// a file of its own, so that it can be loaded cheaply ahead of the index
+// proper. See LoadBloomFilter().
+//
 // The non-static methods must run on the IO thread. All the real
 // work is done in the static methods, which are run on the cache thread
 // or in worker threads. Synchronization between methods is the
@@ -74,6 +95,27 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
     uint64 cache_size_;  // Total cache storage size in bytes.
   };
 
+  // Operation recorded in a JournalRecord.
+  enum JournalOp {
+    JOURNAL_OP_UPDATE = 0,      // Insert or update an entry.
+    JOURNAL_OP_REMOVE = 1,      // Remove an entry.
+    JOURNAL_OP_CACHE_MTIME = 2  // Record the cache directory mtime seen when
+                                // the batch was appended; |last_used_time|
+                                // holds the mtime, other fields are unused.
+  };
+
+  // A fixed-layout record of one index mutation. These are appended verbatim
+  // to the journal file and read back directly from a memory mapping, so the
+  // layout may not change without also changing kSimpleVersion.
+  struct JournalRecord {
+    uint64 entry_hash;
+    int64 last_used_time;  // base::Time::ToInternalValue().
+    uint64 entry_size;
+    uint32 op;             // A JournalOp.
+    uint32 crc;            // crc32 over the preceding fields.
+  };
+  static_assert(sizeof(JournalRecord) == 32, "incorrect journal record size");
+
   SimpleIndexFile(
       const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
       const scoped_refptr<base::TaskRunner>& worker_pool,
@@ -86,6 +128,15 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                                 const base::Closure& callback,
                                 SimpleIndexLoadResult* out_result);
 
+  // Loads the Bloom filter written next to the index. This reads a few
+  // kilobytes at most, so it completes long before LoadIndexEntries() and
+  // lets the index reject misses during the load window. A filter that does
+  // not cover every change the journal recorded is brought up to date from
+  // the journal; one older than the cache directory is discarded as stale.
+  virtual void LoadBloomFilter(base::Time cache_last_modified,
+                               const base::Closure& callback,
+                               SimpleBloomFilterLoadResult* out_result);
+
   // Write the specified set of entries to disk.
   virtual void WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                            uint64 cache_size,
@@ -93,6 +144,16 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                            bool app_on_background,
                            const base::Closure& callback);
 
+  // Appends |records| to the index journal instead of rewriting the whole
+  // index; much cheaper than WriteToDisk() when only a few entries changed.
+  // The records' |crc| fields are filled in here.
+  virtual void AppendToJournal(scoped_ptr<std::vector<JournalRecord>> records);
+
+  // Builds the journal record for |entry_hash|. A NULL |entry_metadata|
+  // produces a removal record.
+  static JournalRecord MakeJournalRecord(uint64 entry_hash,
+                                         const EntryMetadata* entry_metadata);
+
  private:
   friend class WrappedSimpleIndexFile;
 
@@ -110,11 +171,35 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                                    const base::FilePath& index_file_path,
                                    SimpleIndexLoadResult* out_result);
 
-  // Load the index file from disk returning an EntrySet.
+  // Load the index file from disk returning an EntrySet.  If a journal is
+  // present next to the index file, it is replayed over the loaded entries.
   static void SyncLoadFromDisk(const base::FilePath& index_filename,
                                base::Time* out_last_cache_seen_by_index,
                                SimpleIndexLoadResult* out_result);
 
+  // Synchronous (IO performing) implementation of LoadBloomFilter.
+  static void SyncLoadBloomFilter(base::Time cache_last_modified,
+                                  const base::FilePath& bloom_filter_filename,
+                                  const base::FilePath& journal_filename,
+                                  SimpleBloomFilterLoadResult* out_result);
+
+  // Synchronous implementation of AppendToJournal.  On failure the journal
+  // is deleted, which makes the on-disk index stale and forces a directory
+  // scan on the next startup.
+  static void SyncAppendToJournal(
+      const base::FilePath& cache_directory,
+      const base::FilePath& journal_filename,
+      scoped_ptr<std::vector<JournalRecord>> records);
+
+  // Memory maps the journal at |journal_filename| and applies its records to
+  // |out_result->entries|.  Records after a corrupt one are ignored and
+  // |out_result->flush_required| is set so that the next write compacts the
+  // index.  JOURNAL_OP_CACHE_MTIME records advance
+  // |*in_out_last_cache_seen_by_index|.
+  static void SyncReplayJournal(const base::FilePath& journal_filename,
+                                base::Time* in_out_last_cache_seen_by_index,
+                                SimpleIndexLoadResult* out_result);
+
   // Returns a scoped_ptr for a newly allocated base::Pickle containing the
   // serialized
   // data to be written to a file. Note: the pickle is not in a consistent state
@@ -146,12 +231,22 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
       const base::FilePath& cache_path,
       const EntryFileCallback& entry_file_callback);
 
-  // Writes the index file to disk atomically.
+  // Serializes the Bloom filter covering |entries| for writing next to the
+  // index.
+  static scoped_ptr<base::Pickle> SerializeBloomFilter(
+      const SimpleIndex::EntrySet& entries);
+
+  // Writes the index file to disk atomically, along with the Bloom filter in
+  // |bloom_filter_pickle|.  A successful write makes the journal at
+  // |journal_filename| obsolete, so it is deleted.
   static void SyncWriteToDisk(net::CacheType cache_type,
                               const base::FilePath& cache_directory,
                               const base::FilePath& index_filename,
                               const base::FilePath& temp_index_filename,
+                              const base::FilePath& journal_filename,
+                              const base::FilePath& bloom_filter_filename,
                               scoped_ptr<base::Pickle> pickle,
+                              scoped_ptr<base::Pickle> bloom_filter_pickle,
                               const base::TimeTicks& start_time,
                               bool app_on_background);
 
@@ -178,10 +273,14 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
   const base::FilePath cache_directory_;
   const base::FilePath index_file_;
   const base::FilePath temp_index_file_;
+  const base::FilePath journal_file_;
+  const base::FilePath bloom_filter_file_;
 
   static const char kIndexDirectory[];
   static const char kIndexFileName[];
   static const char kTempIndexFileName[];
+  static const char kIndexJournalFileName[];
+  static const char kBloomFilterFileName[];
 
   DISALLOW_COPY_AND_ASSIGN(SimpleIndexFile);
 };
@@ -75,6 +75,7 @@ class WrappedSimpleIndexFile : public SimpleIndexFile {
   using SimpleIndexFile::LegacyIsIndexFileStale;
   using SimpleIndexFile::Serialize;
   using SimpleIndexFile::SerializeFinalData;
+  using SimpleIndexFile::SyncAppendToJournal;
 
   explicit WrappedSimpleIndexFile(const base::FilePath& index_file_directory)
       : SimpleIndexFile(base::ThreadTaskRunnerHandle::Get(),
@@ -91,6 +92,10 @@ class WrappedSimpleIndexFile : public SimpleIndexFile {
     return temp_index_file_;
   }
 
+  const base::FilePath& GetJournalFilePath() const {
+    return journal_file_;
+  }
+
   bool CreateIndexFileDirectory() const {
     return base::CreateDirectory(index_file_.DirName());
   }
@@ -217,6 +222,94 @@ TEST_F(SimpleIndexFileTest, WriteThenLoadIndex) {
     EXPECT_EQ(1U, load_index_result.entries.count(kHashes[i]));
 }
 
+TEST_F(SimpleIndexFileTest, WriteAppendJournalThenLoad) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+  const base::FilePath cache_path = cache_dir.path();
+
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time(), 11), &entries);
+  SimpleIndex::InsertInEntrySet(22, EntryMetadata(Time(), 22), &entries);
+
+  net::TestClosure closure;
+  WrappedSimpleIndexFile simple_index_file(cache_path);
+  simple_index_file.WriteToDisk(entries, 33U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+
+  // Journal an update of a new entry and the removal of an existing one.
+  scoped_ptr<std::vector<SimpleIndexFile::JournalRecord>> records(
+      new std::vector<SimpleIndexFile::JournalRecord>());
+  EntryMetadata new_metadata(base::Time::Now(), 33);
+  records->push_back(SimpleIndexFile::MakeJournalRecord(33, &new_metadata));
+  records->push_back(SimpleIndexFile::MakeJournalRecord(22, NULL));
+  WrappedSimpleIndexFile::SyncAppendToJournal(
+      cache_path, simple_index_file.GetJournalFilePath(), records.Pass());
+  ASSERT_TRUE(base::PathExists(simple_index_file.GetJournalFilePath()));
+
+  base::Time fake_cache_mtime;
+  ASSERT_TRUE(simple_util::GetMTime(cache_path, &fake_cache_mtime));
+  SimpleIndexLoadResult load_index_result;
+  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
+                                     &load_index_result);
+  closure.WaitForResult();
+
+  EXPECT_TRUE(load_index_result.did_load);
+  // A non-empty journal always requests a compacting rewrite.
+  EXPECT_TRUE(load_index_result.flush_required);
+  EXPECT_EQ(2U, load_index_result.entries.size());
+  EXPECT_EQ(1U, load_index_result.entries.count(11));
+  EXPECT_EQ(0U, load_index_result.entries.count(22));
+  ASSERT_EQ(1U, load_index_result.entries.count(33));
+  EXPECT_EQ(33U, load_index_result.entries[33].GetEntrySize());
+
+  // A full index write compacts the journal away.
+  simple_index_file.WriteToDisk(load_index_result.entries, 44U,
+                                base::TimeTicks(), false, closure.closure());
+  closure.WaitForResult();
+  EXPECT_FALSE(base::PathExists(simple_index_file.GetJournalFilePath()));
+}
+
+TEST_F(SimpleIndexFileTest, LoadTruncatedJournal) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+  const base::FilePath cache_path = cache_dir.path();
+
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time(), 11), &entries);
+
+  net::TestClosure closure;
+  WrappedSimpleIndexFile simple_index_file(cache_path);
+  simple_index_file.WriteToDisk(entries, 11U, base::TimeTicks(), false,
+                                closure.closure());
+  closure.WaitForResult();
+
+  scoped_ptr<std::vector<SimpleIndexFile::JournalRecord>> records(
+      new std::vector<SimpleIndexFile::JournalRecord>());
+  EntryMetadata new_metadata(base::Time::Now(), 33);
+  records->push_back(SimpleIndexFile::MakeJournalRecord(33, &new_metadata));
+  WrappedSimpleIndexFile::SyncAppendToJournal(
+      cache_path, simple_index_file.GetJournalFilePath(), records.Pass());
+
+  // Simulate a write that was cut short; the valid prefix must still replay.
+  const std::string kGarbage = "split";
+  ASSERT_TRUE(base::AppendToFile(simple_index_file.GetJournalFilePath(),
+                                 kGarbage.data(), kGarbage.size()));
+
+  base::Time fake_cache_mtime;
+  ASSERT_TRUE(simple_util::GetMTime(cache_path, &fake_cache_mtime));
+  SimpleIndexLoadResult load_index_result;
+  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
+                                     &load_index_result);
+  closure.WaitForResult();
+
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_TRUE(load_index_result.flush_required);
+  EXPECT_EQ(2U, load_index_result.entries.size());
+  EXPECT_EQ(1U, load_index_result.entries.count(11));
+  EXPECT_EQ(1U, load_index_result.entries.count(33));
+}
+
 TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
   base::ScopedTempDir cache_dir;
   ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
@@ -55,7 +55,8 @@ class MockSimpleIndexFile : public SimpleIndexFile,
       : SimpleIndexFile(NULL, NULL, net::DISK_CACHE, base::FilePath()),
         load_result_(NULL),
         load_index_entries_calls_(0),
-        disk_writes_(0) {}
+        disk_writes_(0),
+        journal_appends_(0) {}
 
   void LoadIndexEntries(base::Time cache_last_modified,
                         const base::Closure& callback,
@@ -74,6 +75,12 @@ class MockSimpleIndexFile : public SimpleIndexFile,
     disk_write_entry_set_ = entry_set;
   }
 
+  void AppendToJournal(
+      scoped_ptr<std::vector<JournalRecord>> records) override {
+    journal_appends_++;
+    journal_records_ = *records;
+  }
+
   void GetAndResetDiskWriteEntrySet(SimpleIndex::EntrySet* entry_set) {
     entry_set->swap(disk_write_entry_set_);
   }
@@ -82,13 +89,19 @@ class MockSimpleIndexFile : public SimpleIndexFile,
   SimpleIndexLoadResult* load_result() const { return load_result_; }
   int load_index_entries_calls() const { return load_index_entries_calls_; }
   int disk_writes() const { return disk_writes_; }
+  int journal_appends() const { return journal_appends_; }
+  const std::vector<JournalRecord>& journal_records() const {
+    return journal_records_;
+  }
 
  private:
   base::Closure load_callback_;
   SimpleIndexLoadResult* load_result_;
   int load_index_entries_calls_;
   int disk_writes_;
+  int journal_appends_;
   SimpleIndex::EntrySet disk_write_entry_set_;
+  std::vector<JournalRecord> journal_records_;
 };
 
 class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
@@ -603,6 +616,52 @@ TEST_F(SimpleIndexTest, DiskWriteExecuted) {
   EXPECT_EQ(20U, entry1.GetEntrySize());
 }
 
+// After the initial full index write, a flush with only a few dirty entries
+// should append to the journal instead of rewriting the whole index.
+TEST_F(SimpleIndexTest, DiskWriteUsesJournal) {
+  index()->SetMaxSize(1000);
+  ReturnIndexFile();
+
+  // The first write after initialization is always a full one.
+  const uint64 kHash1 = hashes_.at<1>();
+  index()->Insert(kHash1);
+  index()->UpdateEntrySize(kHash1, 20);
+  index()->write_to_disk_timer_.Stop();
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(0, index_file_->journal_appends());
+
+  // A subsequent flush with one dirty entry goes to the journal.
+  const uint64 kHash2 = hashes_.at<2>();
+  index()->Insert(kHash2);
+  index()->UpdateEntrySize(kHash2, 40);
+  index()->write_to_disk_timer_.Stop();
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(1, index_file_->journal_appends());
+  ASSERT_EQ(1u, index_file_->journal_records().size());
+  EXPECT_EQ(kHash2, index_file_->journal_records()[0].entry_hash);
+  EXPECT_EQ(static_cast<uint32>(SimpleIndexFile::JOURNAL_OP_UPDATE),
+            index_file_->journal_records()[0].op);
+  EXPECT_EQ(40U, index_file_->journal_records()[0].entry_size);
+
+  // Removals are journaled too.
+  index()->Remove(kHash2);
+  index()->write_to_disk_timer_.Stop();
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(2, index_file_->journal_appends());
+  ASSERT_EQ(1u, index_file_->journal_records().size());
+  EXPECT_EQ(kHash2, index_file_->journal_records()[0].entry_hash);
+  EXPECT_EQ(static_cast<uint32>(SimpleIndexFile::JOURNAL_OP_REMOVE),
+            index_file_->journal_records()[0].op);
+
+  // With nothing dirty, a flush is a no-op.
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(2, index_file_->journal_appends());
+}
+
 TEST_F(SimpleIndexTest, DiskWritePostponed) {
   index()->SetMaxSize(1000);
   ReturnIndexFile();
@@ -78,8 +78,14 @@ struct SimpleEntryCreationResults {
 
   SimpleSynchronousEntry* sync_entry;
   scoped_refptr<net::GrowableIOBuffer> stream_0_data;
+  // Set only when stream 1 was small enough to be prefetched in full during
+  // OpenEntry(), with its checksum already verified. Lets the entry serve
+  // stream 1 reads from memory instead of posting further tasks to the
+  // worker pool.
+  scoped_refptr<net::GrowableIOBuffer> stream_1_data;
   SimpleEntryStat entry_stat;
   uint32_t stream_0_crc32;
+  uint32_t stream_1_crc32;
   int result;
 };
 
@@ -233,7 +239,9 @@ class SimpleSynchronousEntry {
   int InitializeForOpen(bool had_index,
                         SimpleEntryStat* out_entry_stat,
                         scoped_refptr<net::GrowableIOBuffer>* stream_0_data,
-                        uint32_t* out_stream_0_crc32);
+                        uint32_t* out_stream_0_crc32,
+                        scoped_refptr<net::GrowableIOBuffer>* stream_1_data,
+                        uint32_t* out_stream_1_crc32);
 
   // Writes the header and key to a newly-created stream file. |index| is the
   // index of the stream. Returns true on success; returns false and sets
@@ -254,6 +262,16 @@ class SimpleSynchronousEntry {
       scoped_refptr<net::GrowableIOBuffer>* stream_0_data,
       uint32_t* out_stream_0_crc32) const;
 
+  // Prefetches all of stream 1 into |*stream_1_data| and checks it against
+  // its EOF record, but only when the stream is small enough for the extra
+  // read during open to be worthwhile. When the stream is not prefetched --
+  // including when it fails validation -- |*stream_1_data| is left NULL and
+  // reads go through ReadData() as before.
+  void ReadAndValidateStream1(
+      const SimpleEntryStat& entry_stat,
+      scoped_refptr<net::GrowableIOBuffer>* stream_1_data,
+      uint32_t* out_stream_1_crc32) const;
+
   int GetEOFRecordData(int index,
                        const SimpleEntryStat& entry_stat,
                        bool* out_has_crc32,
@@ -176,11 +176,18 @@ AddressSorterPosix::PolicyEntry kDefaultIPv4ScopeTable[] = {
   { { }, 0, AddressSorterPosix::SCOPE_GLOBAL },
 };
 
+// Maximum number of entries in the destination to source address cache. The
+// cache is dropped entirely once full, and on IP address change.
+const size_t kMaxDestinationCacheSize = 10000;
+
 struct DestinationInfo {
   IPAddressNumber address;
   AddressSorterPosix::AddressScope scope;
   unsigned precedence;
   unsigned label;
+  // Source address for this destination; empty if the destination is
+  // unusable.
+  IPAddressNumber src_address;
   const AddressSorterPosix::SourceAddressInfo* src;
   unsigned common_prefix_length;
 };
@@ -259,6 +266,10 @@ void AddressSorterPosix::Sort(const AddressList& list,
                               const CallbackType& callback) const {
   DCHECK(CalledOnValidThread());
   std::vector<scoped_ptr<DestinationInfo>> sort_list;
+  // Destinations with no cached source address, and their probe sockets,
+  // which are all opened and connected before any is harvested.
+  std::vector<DestinationInfo*> probe_infos;
+  std::vector<scoped_ptr<DatagramClientSocket>> probe_sockets;
 
   for (size_t i = 0; i < list.size(); ++i) {
     scoped_ptr<DestinationInfo> info(new DestinationInfo());
@@ -267,6 +278,14 @@ void AddressSorterPosix::Sort(const AddressList& list,
     info->precedence = GetPolicyValue(precedence_table_, info->address);
     info->label = GetPolicyValue(label_table_, info->address);
 
+    DestinationSourceCache::const_iterator cached =
+        dest_source_cache_.find(info->address);
+    if (cached != dest_source_cache_.end()) {
+      info->src_address = cached->second;
+      sort_list.push_back(info.Pass());
+      continue;
+    }
+
     // Each socket can only be bound once.
     scoped_ptr<DatagramClientSocket> socket(
         socket_factory_->CreateDatagramClientSocket(
@@ -283,36 +302,57 @@ void AddressSorterPosix::Sort(const AddressList& list,
               << " reason " << rv;
       continue;
     }
-    // Filter out unusable destinations.
+    probe_infos.push_back(info.get());
+    probe_sockets.push_back(socket.Pass());
+    sort_list.push_back(info.Pass());
+  }
+
+  // Harvest the source address of every connected probe socket.
+  for (size_t i = 0; i < probe_sockets.size(); ++i) {
     IPEndPoint src;
-    rv = socket->GetLocalAddress(&src);
+    int rv = probe_sockets[i]->GetLocalAddress(&src);
     if (rv != OK) {
+      IPEndPoint dest(probe_infos[i]->address, 80 /* port */);
       LOG(WARNING) << "Could not get local address for "
                    << dest.ToStringWithoutPort() << " reason " << rv;
       continue;
     }
+    probe_infos[i]->src_address = src.address();
+    if (dest_source_cache_.size() >= kMaxDestinationCacheSize)
+      dest_source_cache_.clear();
+    dest_source_cache_[probe_infos[i]->address] = src.address();
+  }
 
-    SourceAddressInfo& src_info = source_map_[src.address()];
+  // Annotate the usable destinations with their source info, and filter out
+  // the rest.
+  std::vector<scoped_ptr<DestinationInfo>> usable_list;
+  for (size_t i = 0; i < sort_list.size(); ++i) {
+    DestinationInfo* info = sort_list[i].get();
+    if (info->src_address.empty())
+      continue;
+
+    SourceAddressInfo& src_info = source_map_[info->src_address];
     if (src_info.scope == SCOPE_UNDEFINED) {
       // If |source_info_| is out of date, |src| might be missing, but we still
       // want to sort, even though the HostCache will be cleared soon.
-      FillPolicy(src.address(), &src_info);
+      FillPolicy(info->src_address, &src_info);
     }
     info->src = &src_info;
 
-    if (info->address.size() == src.address().size()) {
+    if (info->address.size() == info->src_address.size()) {
       info->common_prefix_length = std::min(
-          CommonPrefixLength(info->address, src.address()),
+          CommonPrefixLength(info->address, info->src_address),
           info->src->prefix_length);
     }
-    sort_list.push_back(info.Pass());
+    usable_list.push_back(sort_list[i].Pass());
   }
 
-  std::stable_sort(sort_list.begin(), sort_list.end(), CompareDestinations);
+  std::stable_sort(usable_list.begin(), usable_list.end(),
+                   CompareDestinations);
 
   AddressList result;
-  for (size_t i = 0; i < sort_list.size(); ++i)
-    result.push_back(IPEndPoint(sort_list[i]->address, 0 /* port */));
+  for (size_t i = 0; i < usable_list.size(); ++i)
+    result.push_back(IPEndPoint(usable_list[i]->address, 0 /* port */));
 
   callback.Run(true, result);
 }
@@ -320,6 +360,7 @@ void AddressSorterPosix::Sort(const AddressList& list,
 void AddressSorterPosix::OnIPAddressChanged() {
   DCHECK(CalledOnValidThread());
   source_map_.clear();
+  dest_source_cache_.clear();
 #if defined(OS_LINUX)
   const internal::AddressTrackerLinux* tracker =
       NetworkChangeNotifier::GetAddressTracker();
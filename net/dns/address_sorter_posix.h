@@ -59,6 +59,10 @@ class NET_EXPORT_PRIVATE AddressSorterPosix
 
   typedef std::map<IPAddressNumber, SourceAddressInfo> SourceAddressMap;
 
+  // Maps a destination address to the source address the kernel picked when
+  // a UDP socket was connected toward that destination.
+  typedef std::map<IPAddressNumber, IPAddressNumber> DestinationSourceCache;
+
   explicit AddressSorterPosix(ClientSocketFactory* socket_factory);
   ~AddressSorterPosix() override;
 
@@ -80,6 +84,11 @@ class NET_EXPORT_PRIVATE AddressSorterPosix
   // found in most recent OnIPAddressChanged.
   mutable SourceAddressMap source_map_;
 
+  // Cache of probe results, so repeated sorts of recently seen destinations
+  // skip the probe syscalls entirely. Cleared on IP address change, since the
+  // routes that produced the cached source addresses may be gone.
+  mutable DestinationSourceCache dest_source_cache_;
+
   ClientSocketFactory* socket_factory_;
   PolicyTable precedence_table_;
   PolicyTable label_table_;
@@ -94,7 +94,7 @@ class TestUDPClientSocket : public DatagramClientSocket {
 // Creates TestUDPClientSockets and maintains an AddressMapping.
 class TestSocketFactory : public ClientSocketFactory {
  public:
-  TestSocketFactory() {}
+  TestSocketFactory() : created_socket_count_(0) {}
   ~TestSocketFactory() override {}
 
   scoped_ptr<DatagramClientSocket> CreateDatagramClientSocket(
@@ -102,6 +102,7 @@ class TestSocketFactory : public ClientSocketFactory {
       const RandIntCallback&,
       NetLog*,
       const NetLog::Source&) override {
+    ++created_socket_count_;
     return scoped_ptr<DatagramClientSocket>(new TestUDPClientSocket(&mapping_));
   }
   scoped_ptr<StreamSocket> CreateTransportClientSocket(
@@ -125,8 +126,11 @@ class TestSocketFactory : public ClientSocketFactory {
     mapping_[dst] = src;
   }
 
+  size_t created_socket_count() const { return created_socket_count_; }
+
  private:
   AddressMapping mapping_;
+  size_t created_socket_count_;
 
   DISALLOW_COPY_AND_ASSIGN(TestSocketFactory);
 };
@@ -314,6 +318,25 @@ TEST_F(AddressSorterPosixTest, Rule10) {
   Verify(addresses, order);
 }
 
+// Repeated sorts of recently seen destinations must reuse cached probe
+// results instead of creating new sockets.
+TEST_F(AddressSorterPosixTest, CachedProbeResults) {
+  AddMapping("3002::1", "4000::10");
+  AddMapping("10.0.0.231", "10.0.0.1");
+  const char* const addresses[] = { "3002::1", "10.0.0.231", NULL };
+  const int order[] = { 0, 1, -1 };
+  Verify(addresses, order);
+  size_t probe_count = socket_factory_.created_socket_count();
+  EXPECT_EQ(2u, probe_count);
+  // Sorting again must not create any new sockets...
+  Verify(addresses, order);
+  EXPECT_EQ(probe_count, socket_factory_.created_socket_count());
+  // ...until an IP address change invalidates the cache.
+  sorter_.OnIPAddressChanged();
+  Verify(addresses, order);
+  EXPECT_EQ(2 * probe_count, socket_factory_.created_socket_count());
+}
+
 TEST_F(AddressSorterPosixTest, MultipleRules) {
   AddMapping("::1", "::1");           // loopback
   AddMapping("ff32::1", "fe81::10");  // link-local multicast
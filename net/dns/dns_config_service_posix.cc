@@ -329,6 +329,7 @@ class DnsConfigServicePosix::HostsReader : public SerialWorker {
   explicit HostsReader(DnsConfigServicePosix* service)
       : service_(service),
         file_path_hosts_(service->file_path_hosts_),
+        hosts_file_reader_(file_path_hosts_),
         success_(false) {}
 
  private:
@@ -336,7 +337,9 @@ class DnsConfigServicePosix::HostsReader : public SerialWorker {
 
   void DoWork() override {
     base::TimeTicks start_time = base::TimeTicks::Now();
-    success_ = ParseHostsFile(file_path_hosts_, &hosts_);
+    // Watchers can fire spuriously, so skip re-parsing large HOSTS files
+    // whose size and mtime are unchanged.
+    success_ = hosts_file_reader_.ReadAndParse(&hosts_);
     UMA_HISTOGRAM_BOOLEAN("AsyncDNS.HostParseResult", success_);
     UMA_HISTOGRAM_TIMES("AsyncDNS.HostsParseDuration",
                         base::TimeTicks::Now() - start_time);
@@ -356,6 +359,8 @@ class DnsConfigServicePosix::HostsReader : public SerialWorker {
   DnsConfigServicePosix* const service_;
   // Hosts file path to parse.
   const base::FilePath file_path_hosts_;
+  // Only used in DoWork, which SerialWorker never runs concurrently.
+  DnsHostsFileReader hosts_file_reader_;
   // Written in DoWork, read in OnWorkFinished, no locking necessary.
   DnsHosts hosts_;
   bool success_;
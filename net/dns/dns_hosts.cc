@@ -4,6 +4,7 @@
 
 #include "net/dns/dns_hosts.h"
 
+#include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
@@ -135,6 +136,9 @@ void ParseHostsWithCommaMode(const std::string& contents,
   StringPiece ip_text;
   IPAddressNumber ip;
   AddressFamily family = ADDRESS_FAMILY_IPV4;
+  // Reused across hostname tokens so that ad-blocking hosts files with
+  // hundreds of thousands of entries don't pay an extra allocation per line.
+  DnsHostsKey key(std::string(), family);
   HostsParser parser(contents, comma_mode);
   while (parser.Advance()) {
     if (parser.token_is_ip()) {
@@ -153,12 +157,12 @@ void ParseHostsWithCommaMode(const std::string& contents,
         }
       }
     } else {
-      DnsHostsKey key(parser.token().as_string(), family);
-      key.first = base::ToLowerASCII(key.first);
-      IPAddressNumber* mapped_ip = &(*dns_hosts)[key];
-      if (mapped_ip->empty())
-        *mapped_ip = ip;
-      // else ignore this entry (first hit counts)
+      key.first = base::ToLowerASCII(parser.token());
+      key.second = family;
+      // The first hit counts, so don't bother copying the key and value into
+      // the map for names that are already mapped.
+      if (dns_hosts->find(key) == dns_hosts->end())
+        dns_hosts->insert(std::make_pair(key, ip));
     }
   }
 }
@@ -210,5 +214,35 @@ bool ParseHostsFile(const base::FilePath& path, DnsHosts* dns_hosts) {
   return true;
 }
 
+DnsHostsFileReader::DnsHostsFileReader(const base::FilePath& path)
+    : path_(path), last_size_(-1) {
+}
+
+DnsHostsFileReader::~DnsHostsFileReader() {
+}
+
+bool DnsHostsFileReader::ReadAndParse(DnsHosts* dns_hosts) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path_, &info)) {
+    // Missing file indicates empty HOSTS.
+    last_size_ = -1;
+    dns_hosts->clear();
+    return true;
+  }
+
+  if (info.size == last_size_ && info.last_modified == last_modified_)
+    return true;
+
+  // The stamp is taken before reading, so a write racing the read makes the
+  // next notification parse again rather than being missed.
+  if (!ParseHostsFile(path_, dns_hosts)) {
+    last_size_ = -1;
+    return false;
+  }
+  last_modified_ = info.last_modified;
+  last_size_ = info.size;
+  return true;
+}
+
 }  // namespace net
 
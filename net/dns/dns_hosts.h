@@ -13,6 +13,7 @@
 #include "base/basictypes.h"
 #include "base/containers/hash_tables.h"
 #include "base/files/file_path.h"
+#include "base/time/time.h"
 #include "net/base/address_family.h"
 #include "net/base/ip_address_number.h"
 #include "net/base/net_export.h"
@@ -82,7 +83,30 @@ void NET_EXPORT_PRIVATE ParseHosts(const std::string& contents,
 bool NET_EXPORT_PRIVATE ParseHostsFile(const base::FilePath& path,
                                        DnsHosts* dns_hosts);
 
-
+// Reads and parses the HOSTS file at |path| on demand, skipping the parse
+// when the file has not changed. Meant to be owned by the SerialWorker that
+// re-reads HOSTS on change notifications, and to be called with the same
+// |dns_hosts| instance every time, which is left holding the previous parse
+// when the file is unchanged. Not thread-safe.
+class NET_EXPORT_PRIVATE DnsHostsFileReader {
+ public:
+  explicit DnsHostsFileReader(const base::FilePath& path);
+  ~DnsHostsFileReader();
+
+  // As ParseHostsFile(), but re-reads and re-parses the file only if its size
+  // or last-modified time differs from the last successful call. A rewrite
+  // which preserves both is missed until the next change to the file.
+  bool ReadAndParse(DnsHosts* dns_hosts);
+
+ private:
+  const base::FilePath path_;
+  // Stamp of the file as of the last successful parse; |last_size_| is -1
+  // when there is no previous parse to reuse.
+  base::Time last_modified_;
+  int64 last_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(DnsHostsFileReader);
+};
 
 }  // namespace net
 
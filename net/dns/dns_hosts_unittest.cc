@@ -4,6 +4,8 @@
 
 #include "net/dns/dns_hosts.h"
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -175,6 +177,48 @@ TEST(DnsHostsTest, HostsParser_EndsWithNewlineAndToken) {
   EXPECT_EQ(1u, hosts.size());
 }
 
+TEST(DnsHostsTest, FileReader_SkipsUnchangedFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII("hosts");
+
+  DnsHostsFileReader reader(path);
+  DnsHosts hosts;
+
+  // Missing file indicates empty HOSTS.
+  ASSERT_TRUE(reader.ReadAndParse(&hosts));
+  EXPECT_EQ(0u, hosts.size());
+
+  std::string contents = "127.0.0.1 name\n";
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(), contents.size()));
+  ASSERT_TRUE(reader.ReadAndParse(&hosts));
+  EXPECT_EQ(1u, hosts.size());
+
+  // An unchanged file is not re-parsed, so a cleared map stays empty.
+  hosts.clear();
+  ASSERT_TRUE(reader.ReadAndParse(&hosts));
+  EXPECT_EQ(0u, hosts.size());
+
+  // A change in size forces a parse.
+  contents = "127.0.0.1 name\n127.0.0.1 name2\n";
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(), contents.size()));
+  ASSERT_TRUE(reader.ReadAndParse(&hosts));
+  EXPECT_EQ(2u, hosts.size());
+
+  // A same-size rewrite is caught via the modification time.
+  contents = "127.0.0.2 name\n127.0.0.2 name2\n";
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(), contents.size()));
+  base::Time yesterday = base::Time::Now() - base::TimeDelta::FromDays(1);
+  ASSERT_TRUE(base::TouchFile(path, yesterday, yesterday));
+  ASSERT_TRUE(reader.ReadAndParse(&hosts));
+  IPAddressNumber expected_ip;
+  ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.2", &expected_ip));
+  EXPECT_EQ(expected_ip, hosts[DnsHostsKey("name", ADDRESS_FAMILY_IPV4)]);
+}
+
 }  // namespace
 
 }  // namespace net
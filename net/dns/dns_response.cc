@@ -4,7 +4,10 @@
 
 #include "net/dns/dns_response.h"
 
+#include <algorithm>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "base/big_endian.h"
 #include "base/strings/string_util.h"
@@ -49,6 +52,10 @@ unsigned DnsRecordParser::ReadName(const void* const vpos,
   unsigned seen = 0;
   // Remember how many bytes were consumed before first jump.
   unsigned consumed = 0;
+  // Pointer targets jumped to while reading this name, paired with the
+  // position in |out| where each target's expansion starts, so the expansion
+  // can be memoized in |name_cache_| once the name is fully read.
+  std::vector<std::pair<uint16_t, size_t>> jumps;
 
   if (pos >= end)
     return 0;
@@ -77,6 +84,21 @@ unsigned DnsRecordParser::ReadName(const void* const vpos,
         uint16_t offset;
         base::ReadBigEndian<uint16_t>(p, &offset);
         offset &= dns_protocol::kOffsetMask;
+        std::map<uint16_t, std::string>::const_iterator cached =
+            name_cache_.find(offset);
+        if (cached != name_cache_.end()) {
+          // The rest of the name was already decompressed by an earlier read.
+          if (!cached->second.empty()) {
+            if (!out->empty())
+              out->append(".");
+            out->append(cached->second);
+          }
+          CacheNameSuffixes(jumps, *out);
+          return consumed;
+        }
+        // The expansion of |offset| will start after the separator, if any.
+        jumps.push_back(
+            std::make_pair(offset, out->size() + (out->empty() ? 0 : 1)));
         p = packet_ + offset;
         if (p >= end)
           return 0;
@@ -90,6 +112,8 @@ unsigned DnsRecordParser::ReadName(const void* const vpos,
           if (consumed == 0) {
             consumed = p - pos;
           }  // else we set |consumed| before first jump
+          if (out)
+            CacheNameSuffixes(jumps, *out);
           return consumed;
         }
         if (p + label_len >= end)
@@ -110,6 +134,17 @@ unsigned DnsRecordParser::ReadName(const void* const vpos,
   }
 }
 
+void DnsRecordParser::CacheNameSuffixes(
+    const std::vector<std::pair<uint16_t, size_t>>& jumps,
+    const std::string& name) const {
+  for (size_t i = 0; i < jumps.size(); ++i) {
+    // A jump to the root label expands to nothing, in which case the recorded
+    // start position is one past the end of |name|.
+    size_t start = std::min(jumps[i].second, name.size());
+    name_cache_[jumps[i].first] = name.substr(start);
+  }
+}
+
 bool DnsRecordParser::ReadRecord(DnsResourceRecord* out) {
   DCHECK(packet_);
   size_t consumed = ReadName(cur_, &out->name);
@@ -147,6 +182,10 @@ DnsResponse::DnsResponse()
     : io_buffer_(new IOBufferWithSize(dns_protocol::kMaxUDPSize + 1)) {
 }
 
+DnsResponse::DnsResponse(scoped_refptr<IOBufferWithSize> buffer)
+    : io_buffer_(buffer) {
+}
+
 DnsResponse::DnsResponse(size_t length)
     : io_buffer_(new IOBufferWithSize(length)) {
 }
@@ -7,7 +7,10 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -72,10 +75,21 @@ class NET_EXPORT_PRIVATE DnsRecordParser {
   bool SkipQuestion();
 
  private:
+  // Stores in |name_cache_| the expansion of every compression pointer target
+  // in |jumps| followed while reading |name|. Each entry of |jumps| pairs a
+  // packet offset with the position in |name| where its expansion starts.
+  void CacheNameSuffixes(const std::vector<std::pair<uint16_t, size_t>>& jumps,
+                         const std::string& name) const;
+
   const char* packet_;
   size_t length_;
   // Current offset within the packet.
   const char* cur_;
+  // Memo of compression pointer target offset to its expanded name, filled in
+  // as names are read, so that a suffix shared by many records in a large
+  // response is decompressed only once. Mutable because it is only a cache:
+  // ReadName() is logically const.
+  mutable std::map<uint16_t, std::string> name_cache_;
 };
 
 // Buffer-holder for the DNS response allowing easy access to the header fields
@@ -103,6 +117,10 @@ class NET_EXPORT_PRIVATE DnsResponse {
   // largest possible response, to detect malformed responses.
   DnsResponse();
 
+  // Constructs a response which reads into |buffer|, avoiding an allocation
+  // when the buffer is reused (see DnsSession::AllocateUdpResponseBuffer).
+  explicit DnsResponse(scoped_refptr<IOBufferWithSize> buffer);
+
   // Constructs a response buffer of given length. Used for TCP transactions.
   explicit DnsResponse(size_t length);
 
@@ -74,6 +74,47 @@ TEST(DnsRecordParserTest, ReadName) {
   EXPECT_EQ(0x6u, parser.ReadName(data + 0x11, NULL));
 }
 
+TEST(DnsRecordParserTest, ReadNameSharedSuffixes) {
+  const uint8 data[] = {
+      // all labels "www.example.com"
+      0x03, 'w', 'w', 'w',
+      0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e',
+      0x03, 'c', 'o', 'm',
+      // byte 0x10
+      0x00,
+      // byte 0x11
+      // part label, part pointer, "ftp.example.com"
+      0x03, 'f', 't', 'p',
+      0xc0, 0x04,
+      // byte 0x17
+      // part label, part pointer to a name which is itself partially
+      // compressed, "mail.ftp.example.com"
+      0x04, 'm', 'a', 'i', 'l',
+      0xc0, 0x11,
+      // byte 0x1e
+      // all pointer to "mail.ftp.example.com"
+      0xc0, 0x17,
+      // byte 0x20
+  };
+
+  std::string out;
+  DnsRecordParser parser(data, sizeof(data), 0);
+  ASSERT_TRUE(parser.IsValid());
+
+  // Repeated reads exercise the per-parse suffix memo; every read must see
+  // the same expansions regardless of what was read before it.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(0x11u, parser.ReadName(data + 0x00, &out));
+    EXPECT_EQ("www.example.com", out);
+    EXPECT_EQ(0x6u, parser.ReadName(data + 0x11, &out));
+    EXPECT_EQ("ftp.example.com", out);
+    EXPECT_EQ(0x7u, parser.ReadName(data + 0x17, &out));
+    EXPECT_EQ("mail.ftp.example.com", out);
+    EXPECT_EQ(0x2u, parser.ReadName(data + 0x1e, &out));
+    EXPECT_EQ("mail.ftp.example.com", out);
+  }
+}
+
 TEST(DnsRecordParserTest, ReadNameFail) {
   const uint8 data[] = {
       // label length beyond packet
@@ -15,9 +15,11 @@
 #include "base/rand_util.h"
 #include "base/stl_util.h"
 #include "base/time/time.h"
+#include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
 #include "net/dns/dns_config_service.h"
+#include "net/dns/dns_protocol.h"
 #include "net/dns/dns_socket_pool.h"
 #include "net/socket/stream_socket.h"
 #include "net/udp/datagram_client_socket.h"
@@ -34,6 +36,12 @@ const unsigned kMinTimeoutMs = 10;
 const size_t kRTTBucketCount = 100;
 // Target percentile in the RTT histogram used for retransmission timeout.
 const unsigned kRTOPercentile = 99;
+// Number of samples the RTT histogram of each server is seeded with. Until a
+// server has more samples than this, it has no measured RTT.
+const int kRTTSeedCount = 2;
+
+// Maximum number of freed UDP response buffers kept for reuse.
+const size_t kUdpResponseBufferPoolMax = 32;
 }  // namespace
 
 // Runtime statistics of DNS server.
@@ -41,10 +49,10 @@ struct DnsSession::ServerStats {
   ServerStats(base::TimeDelta rtt_estimate_param, RttBuckets* buckets)
     : last_failure_count(0), rtt_estimate(rtt_estimate_param) {
     rtt_histogram.reset(new base::SampleVector(buckets));
-    // Seed histogram with 2 samples at |rtt_estimate| timeout.
+    // Seed histogram with |kRTTSeedCount| samples at |rtt_estimate| timeout.
     rtt_histogram->Accumulate(
         static_cast<base::HistogramBase::Sample>(rtt_estimate.InMilliseconds()),
-        2);
+        kRTTSeedCount);
   }
 
   // Count of consecutive failures after last success.
@@ -112,10 +120,28 @@ uint16_t DnsSession::NextQueryId() const {
 }
 
 unsigned DnsSession::NextFirstServerIndex() {
-  unsigned index = NextGoodServerIndex(server_index_);
-  if (config_.rotate)
+  if (config_.rotate) {
+    unsigned index = NextGoodServerIndex(server_index_);
     server_index_ = (server_index_ + 1) % config_.nameservers.size();
-  return index;
+    return index;
+  }
+  // Prefer the fastest known server, rather than eating the full timeout on
+  // a slow first server while a faster one is configured after it.
+  return NextGoodServerIndex(FastestServerIndex());
+}
+
+unsigned DnsSession::FastestServerIndex() const {
+  unsigned fastest_index = server_index_;
+  base::TimeDelta fastest_rtt = base::TimeDelta::Max();
+  for (size_t i = 0; i < server_stats_.size(); ++i) {
+    if (server_stats_[i]->last_failure_count >= config_.attempts)
+      continue;
+    if (server_stats_[i]->rtt_estimate < fastest_rtt) {
+      fastest_rtt = server_stats_[i]->rtt_estimate;
+      fastest_index = i;
+    }
+  }
+  return fastest_index;
 }
 
 unsigned DnsSession::NextGoodServerIndex(unsigned server_index) {
@@ -130,7 +156,7 @@ unsigned DnsSession::NextGoodServerIndex(unsigned server_index) {
     base::Time cur_server_failure = server_stats_[index]->last_failure;
     // If number of failures on this server doesn't exceed number of allowed
     // attempts, return its index.
-    if (server_stats_[server_index]->last_failure_count < config_.attempts) {
+    if (server_stats_[index]->last_failure_count < config_.attempts) {
       return index;
     }
     // Track oldest failed server.
@@ -220,9 +246,14 @@ void DnsSession::RecordServerStats() {
 
 
 base::TimeDelta DnsSession::NextTimeout(unsigned server_index, int attempt) {
-  // Respect config timeout if it exceeds |kMaxTimeoutMs|.
-  if (config_.timeout.InMilliseconds() >= kMaxTimeoutMs)
+  // Respect config timeout if it exceeds |kMaxTimeoutMs|, but only until the
+  // server has measured RTTs; the histogram starts out seeded with the config
+  // timeout, so without samples the adaptive timeout says nothing more.
+  if (config_.timeout.InMilliseconds() >= kMaxTimeoutMs &&
+      server_stats_[server_index]->rtt_histogram->TotalCount() <=
+          kRTTSeedCount) {
     return config_.timeout;
+  }
   return NextTimeoutFromHistogram(server_index, attempt);
 }
 
@@ -247,6 +278,25 @@ scoped_ptr<StreamSocket> DnsSession::CreateTCPSocket(
   return socket_pool_->CreateTCPSocket(server_index, source);
 }
 
+scoped_refptr<IOBufferWithSize> DnsSession::AllocateUdpResponseBuffer() {
+  if (udp_response_buffer_pool_.empty()) {
+    // One byte more than the largest possible response, so that reads can
+    // detect malformed oversized responses (see DnsResponse()).
+    return make_scoped_refptr(
+        new IOBufferWithSize(dns_protocol::kMaxUDPSize + 1));
+  }
+  scoped_refptr<IOBufferWithSize> buffer = udp_response_buffer_pool_.back();
+  udp_response_buffer_pool_.pop_back();
+  return buffer;
+}
+
+void DnsSession::FreeUdpResponseBuffer(
+    scoped_refptr<IOBufferWithSize> buffer) {
+  DCHECK_EQ(dns_protocol::kMaxUDPSize + 1, buffer->size());
+  if (udp_response_buffer_pool_.size() < kUdpResponseBufferPoolMax)
+    udp_response_buffer_pool_.push_back(buffer);
+}
+
 // Release a socket.
 void DnsSession::FreeSocket(unsigned server_index,
                             scoped_ptr<DatagramClientSocket> socket) {
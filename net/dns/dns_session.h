@@ -26,6 +26,7 @@ namespace net {
 
 class ClientSocketFactory;
 class DatagramClientSocket;
+class IOBufferWithSize;
 class NetLog;
 class StreamSocket;
 
@@ -68,6 +69,8 @@ class NET_EXPORT_PRIVATE DnsSession
   uint16_t NextQueryId() const;
 
   // Return the index of the first configured server to use on first attempt.
+  // Unless the config requests rotation, prefers the server with the lowest
+  // estimated RTT among servers without recent failures.
   unsigned NextFirstServerIndex();
 
   // Start with |server_index| and find the index of the next known good server
@@ -105,6 +108,14 @@ class NET_EXPORT_PRIVATE DnsSession
   scoped_ptr<StreamSocket> CreateTCPSocket(unsigned server_index,
                                            const NetLog::Source& source);
 
+  // Allocates a buffer for a UDP response, reusing a freed buffer when one
+  // is available. All buffers have the fixed maximum UDP response size.
+  scoped_refptr<IOBufferWithSize> AllocateUdpResponseBuffer();
+
+  // Returns a buffer obtained from AllocateUdpResponseBuffer() for reuse.
+  // The caller must not keep other references to the buffer.
+  void FreeUdpResponseBuffer(scoped_refptr<IOBufferWithSize> buffer);
+
  private:
   friend class base::RefCounted<DnsSession>;
   ~DnsSession();
@@ -113,6 +124,11 @@ class NET_EXPORT_PRIVATE DnsSession
   void FreeSocket(unsigned server_index,
                   scoped_ptr<DatagramClientSocket> socket);
 
+  // Return the index of the server with the lowest estimated RTT among
+  // servers without recent failures, or |server_index_| if all servers have
+  // recently failed.
+  unsigned FastestServerIndex() const;
+
   // Return the timeout using the TCP timeout method.
   base::TimeDelta NextTimeoutFromJacobson(unsigned server_index, int attempt);
 
@@ -132,6 +148,9 @@ class NET_EXPORT_PRIVATE DnsSession
   // Track runtime statistics of each DNS server.
   std::vector<scoped_ptr<ServerStats>> server_stats_;
 
+  // Freed UDP response buffers kept for reuse by later attempts.
+  std::vector<scoped_refptr<IOBufferWithSize>> udp_response_buffer_pool_;
+
   // Buckets shared for all |ServerStats::rtt_histogram|.
   struct RttBuckets : public base::BucketRanges {
     RttBuckets();
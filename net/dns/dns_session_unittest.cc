@@ -10,6 +10,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/rand_util.h"
 #include "base/stl_util.h"
+#include "net/base/io_buffer.h"
 #include "net/dns/dns_protocol.h"
 #include "net/dns/dns_socket_pool.h"
 #include "net/log/net_log.h"
@@ -220,6 +221,26 @@ TEST_F(DnsSessionTest, AllocateFree) {
   EXPECT_TRUE(NoMoreEvents());
 }
 
+// A freed UDP response buffer must be handed out again before any new
+// buffer is allocated.
+TEST_F(DnsSessionTest, UdpResponseBufferPool) {
+  Initialize(2);
+
+  scoped_refptr<IOBufferWithSize> buffer = session_->AllocateUdpResponseBuffer();
+  EXPECT_EQ(dns_protocol::kMaxUDPSize + 1, buffer->size());
+  IOBufferWithSize* first = buffer.get();
+
+  session_->FreeUdpResponseBuffer(buffer);
+  buffer = NULL;
+
+  buffer = session_->AllocateUdpResponseBuffer();
+  EXPECT_EQ(first, buffer.get());
+
+  // With the pool drained, a second allocation gets a fresh buffer.
+  scoped_refptr<IOBufferWithSize> other = session_->AllocateUdpResponseBuffer();
+  EXPECT_NE(buffer.get(), other.get());
+}
+
 // Expect default calculated timeout to be within 10ms of in DnsConfig.
 TEST_F(DnsSessionTest, HistogramTimeoutNormal) {
   Initialize(2);
@@ -243,6 +264,47 @@ TEST_F(DnsSessionTest, HistogramTimeoutLong) {
   EXPECT_EQ(config_.timeout.InMilliseconds(), timeout.InMilliseconds());
 }
 
+// Expect a long config timeout to be cut once the server has measured RTTs.
+TEST_F(DnsSessionTest, AdaptiveTimeoutCutsLongConfigTimeout) {
+  config_.timeout = base::TimeDelta::FromSeconds(15);
+  Initialize(2);
+  for (int i = 0; i < 100; ++i)
+    session_->RecordRTT(0, base::TimeDelta::FromMilliseconds(20));
+  EXPECT_LT(session_->NextTimeout(0, 0), config_.timeout);
+  // The other server has no samples yet, so it keeps the config timeout.
+  EXPECT_EQ(config_.timeout, session_->NextTimeout(1, 0));
+}
+
+// Expect the first server used to be the one with the lowest estimated RTT.
+TEST_F(DnsSessionTest, PreferFastestServer) {
+  Initialize(3);
+  EXPECT_EQ(0u, session_->NextFirstServerIndex());
+
+  session_->RecordRTT(1, base::TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(1u, session_->NextFirstServerIndex());
+
+  // Once the fastest server accumulates failures, fall back to the next
+  // fastest one.
+  for (int i = 0; i < config_.attempts; ++i)
+    session_->RecordServerFailure(1);
+  session_->RecordRTT(2, base::TimeDelta::FromMilliseconds(100));
+  EXPECT_EQ(2u, session_->NextFirstServerIndex());
+
+  // A success clears the failures.
+  session_->RecordServerSuccess(1);
+  EXPECT_EQ(1u, session_->NextFirstServerIndex());
+}
+
+// Expect NextGoodServerIndex to skip over servers with too many failures,
+// even when other servers failed longer ago.
+TEST_F(DnsSessionTest, NextGoodServerIndexSkipsFailedServer) {
+  Initialize(2);
+  for (int i = 0; i < config_.attempts; ++i)
+    session_->RecordServerFailure(0);
+  session_->RecordServerFailure(1);
+  EXPECT_EQ(1u, session_->NextGoodServerIndex(0));
+}
+
 }  // namespace
 
 } // namespace net
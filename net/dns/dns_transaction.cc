@@ -135,15 +135,28 @@ class DnsAttempt {
 
 class DnsUDPAttempt : public DnsAttempt {
  public:
-  DnsUDPAttempt(unsigned server_index,
+  DnsUDPAttempt(scoped_refptr<DnsSession> session,
+                unsigned server_index,
                 scoped_ptr<DnsSession::SocketLease> socket_lease,
                 scoped_ptr<DnsQuery> query)
       : DnsAttempt(server_index),
         next_state_(STATE_NONE),
         received_malformed_response_(false),
+        session_(session),
         socket_lease_(socket_lease.Pass()),
         query_(query.Pass()) {}
 
+  ~DnsUDPAttempt() override {
+    // Destroy the socket first: a read still pending on it targets the
+    // response buffer, which is returned to the session for reuse below.
+    socket_lease_.reset();
+    if (response_) {
+      scoped_refptr<IOBufferWithSize> buffer(response_->io_buffer());
+      response_.reset();
+      session_->FreeUdpResponseBuffer(buffer);
+    }
+  }
+
   // DnsAttempt:
   int Start(const CompletionCallback& callback) override {
     DCHECK_EQ(STATE_NONE, next_state_);
@@ -241,7 +254,10 @@ class DnsUDPAttempt : public DnsAttempt {
 
   int DoReadResponse() {
     next_state_ = STATE_READ_RESPONSE_COMPLETE;
-    response_.reset(new DnsResponse());
+    // Reuse the buffer when rereading after a malformed response; InitParse
+    // repositions the parser on every read.
+    if (!response_)
+      response_.reset(new DnsResponse(session_->AllocateUdpResponseBuffer()));
     return socket()->Read(response_->io_buffer(),
                           response_->io_buffer()->size(),
                           base::Bind(&DnsUDPAttempt::OnIOComplete,
@@ -285,6 +301,7 @@ class DnsUDPAttempt : public DnsAttempt {
   bool received_malformed_response_;
   base::TimeTicks start_time_;
 
+  scoped_refptr<DnsSession> session_;
   scoped_ptr<DnsSession::SocketLease> socket_lease_;
   scoped_ptr<DnsQuery> query_;
 
@@ -723,7 +740,7 @@ class DnsTransactionImpl : public DnsTransaction,
     bool got_socket = !!lease.get();
 
     DnsUDPAttempt* attempt =
-        new DnsUDPAttempt(server_index, lease.Pass(), query.Pass());
+        new DnsUDPAttempt(session_, server_index, lease.Pass(), query.Pass());
 
     attempts_.push_back(make_scoped_ptr(attempt));
     ++attempts_count_;
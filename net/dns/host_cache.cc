@@ -4,14 +4,25 @@
 
 #include "net/dns/host_cache.h"
 
+#include <vector>
+
 #include "base/logging.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/pickle.h"
 #include "base/strings/string_number_conversions.h"
 #include "net/base/net_errors.h"
 
 namespace net {
 
+namespace {
+
+// Bumped whenever the snapshot layout changes; snapshots from other versions
+// are rejected rather than migrated.
+const int kSerializationFormatVersion = 1;
+
+}  // namespace
+
 //-----------------------------------------------------------------------------
 
 HostCache::Entry::Entry(int error, const AddressList& addrlist,
@@ -34,7 +45,9 @@ HostCache::Entry::~Entry() {
 //-----------------------------------------------------------------------------
 
 HostCache::HostCache(size_t max_entries)
-    : entries_(max_entries) {
+    : max_entries_(max_entries),
+      max_bytes_(0),
+      estimated_bytes_(0) {
 }
 
 HostCache::~HostCache() {
@@ -46,7 +59,33 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   if (caching_is_disabled())
     return NULL;
 
-  return entries_.Get(key, now);
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return NULL;
+
+  // Immediately remove expired entries.
+  if (it->second.second <= now) {
+    Evict(it, now, true);
+    return NULL;
+  }
+
+  return &it->second.first;
+}
+
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               base::TimeDelta* stale_out) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return NULL;
+
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return NULL;
+
+  if (stale_out)
+    *stale_out = now - it->second.second;
+  return &it->second.first;
 }
 
 void HostCache::Set(const Key& key,
@@ -57,12 +96,32 @@ void HostCache::Set(const Key& key,
   if (caching_is_disabled())
     return;
 
-  entries_.Put(key, entry, now, now + ttl);
+  base::TimeTicks expiration = now + ttl;
+  size_t entry_bytes = EstimateEntryBytes(key, entry);
+
+  EntryMap::iterator it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Update an existing cache entry.
+    estimated_bytes_ -= EstimateEntryBytes(it->first, it->second.first);
+    it->second.first = entry;
+    it->second.second = expiration;
+    estimated_bytes_ += entry_bytes;
+    return;
+  }
+
+  // Compact the cache if the new entry would take it over a limit.
+  if (entries_.size() == max_entries_ ||
+      (max_bytes_ > 0 && estimated_bytes_ + entry_bytes > max_bytes_))
+    Compact(now, entry_bytes);
+
+  entries_.insert(std::make_pair(key, std::make_pair(entry, expiration)));
+  estimated_bytes_ += entry_bytes;
 }
 
 void HostCache::clear() {
   DCHECK(CalledOnValidThread());
-  entries_.Clear();
+  entries_.clear();
+  estimated_bytes_ = 0;
 }
 
 size_t HostCache::size() const {
@@ -72,7 +131,7 @@ size_t HostCache::size() const {
 
 size_t HostCache::max_entries() const {
   DCHECK(CalledOnValidThread());
-  return entries_.max_entries();
+  return max_entries_;
 }
 
 // Note that this map may contain expired entries.
@@ -81,6 +140,125 @@ const HostCache::EntryMap& HostCache::entries() const {
   return entries_;
 }
 
+size_t HostCache::estimated_bytes() const {
+  DCHECK(CalledOnValidThread());
+  return estimated_bytes_;
+}
+
+void HostCache::Serialize(base::Pickle* pickle, base::TimeTicks now) const {
+  DCHECK(CalledOnValidThread());
+  pickle->WriteInt(kSerializationFormatVersion);
+  pickle->WriteInt64(base::Time::Now().ToInternalValue());
+
+  int count = 0;
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    if (it->second.second > now)
+      ++count;
+  }
+  pickle->WriteInt(count);
+
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    if (it->second.second <= now)
+      continue;
+    const Key& key = it->first;
+    const Entry& entry = it->second.first;
+    pickle->WriteString(key.hostname);
+    pickle->WriteInt(static_cast<int>(key.address_family));
+    pickle->WriteInt(key.host_resolver_flags);
+    pickle->WriteInt(entry.error);
+    pickle->WriteInt64(entry.ttl.ToInternalValue());
+    pickle->WriteInt64((it->second.second - now).ToInternalValue());
+    pickle->WriteString(entry.addrlist.canonical_name());
+    pickle->WriteInt(static_cast<int>(entry.addrlist.size()));
+    for (size_t i = 0; i < entry.addrlist.size(); ++i) {
+      const IPAddressNumber& address = entry.addrlist[i].address();
+      pickle->WriteData(reinterpret_cast<const char*>(&address[0]),
+                        address.size());
+      pickle->WriteUInt16(entry.addrlist[i].port());
+    }
+  }
+}
+
+bool HostCache::Restore(base::PickleIterator* iter, base::TimeTicks now) {
+  DCHECK(CalledOnValidThread());
+
+  int version;
+  if (!iter->ReadInt(&version) || version != kSerializationFormatVersion)
+    return false;
+  int64 snapshot_time_val;
+  if (!iter->ReadInt64(&snapshot_time_val))
+    return false;
+  base::TimeDelta elapsed =
+      base::Time::Now() - base::Time::FromInternalValue(snapshot_time_val);
+  if (elapsed < base::TimeDelta())
+    elapsed = base::TimeDelta();  // The wall clock moved backwards.
+
+  int count;
+  if (!iter->ReadInt(&count) || count < 0)
+    return false;
+
+  // Parse the whole snapshot before touching the cache, so a truncated or
+  // corrupt tail cannot leave it partially restored.
+  std::vector<std::pair<Key, std::pair<Entry, base::TimeDelta>>> restored;
+  for (int i = 0; i < count; ++i) {
+    std::string hostname;
+    int address_family;
+    int host_resolver_flags;
+    int error;
+    int64 ttl_val;
+    int64 remaining_val;
+    std::string canonical_name;
+    int num_addresses;
+    if (!iter->ReadString(&hostname) || !iter->ReadInt(&address_family) ||
+        !iter->ReadInt(&host_resolver_flags) || !iter->ReadInt(&error) ||
+        !iter->ReadInt64(&ttl_val) || !iter->ReadInt64(&remaining_val) ||
+        !iter->ReadString(&canonical_name) || !iter->ReadInt(&num_addresses) ||
+        address_family < 0 || address_family > ADDRESS_FAMILY_LAST ||
+        num_addresses < 0) {
+      return false;
+    }
+
+    AddressList addrlist;
+    for (int j = 0; j < num_addresses; ++j) {
+      const char* data;
+      int length;
+      uint16 port;
+      if (!iter->ReadData(&data, &length) || !iter->ReadUInt16(&port))
+        return false;
+      if (length != static_cast<int>(kIPv4AddressSize) &&
+          length != static_cast<int>(kIPv6AddressSize)) {
+        return false;
+      }
+      IPAddressNumber address(
+          reinterpret_cast<const unsigned char*>(data),
+          reinterpret_cast<const unsigned char*>(data) + length);
+      addrlist.push_back(IPEndPoint(address, port));
+    }
+    addrlist.set_canonical_name(canonical_name);
+
+    Key key(hostname, static_cast<AddressFamily>(address_family),
+            host_resolver_flags);
+    Entry entry(error, addrlist);
+    entry.ttl = base::TimeDelta::FromInternalValue(ttl_val);
+    base::TimeDelta remaining =
+        base::TimeDelta::FromInternalValue(remaining_val) - elapsed;
+    restored.push_back(std::make_pair(key, std::make_pair(entry, remaining)));
+  }
+
+  for (size_t i = 0; i < restored.size(); ++i) {
+    if (restored[i].second.second <= base::TimeDelta())
+      continue;
+    // Entries resolved in this process are fresher than the snapshot.
+    if (entries_.find(restored[i].first) != entries_.end())
+      continue;
+    Set(restored[i].first, restored[i].second.first, now,
+        restored[i].second.second);
+  }
+  return true;
+}
+
 // static
 scoped_ptr<HostCache> HostCache::CreateDefaultCache() {
   // Cache capacity is determined by the field trial.
@@ -98,6 +276,42 @@ scoped_ptr<HostCache> HostCache::CreateDefaultCache() {
   return make_scoped_ptr(new HostCache(max_entries));
 }
 
+// static
+size_t HostCache::EstimateEntryBytes(const Key& key, const Entry& entry) {
+  return sizeof(EntryMap::value_type) + key.hostname.size() +
+         entry.addrlist.size() * sizeof(IPEndPoint) +
+         entry.addrlist.canonical_name().size();
+}
+
+void HostCache::Evict(EntryMap::iterator it,
+                      base::TimeTicks now,
+                      bool on_get) {
+  EvictionHandler().Handle(it->first, it->second.first, it->second.second,
+                           now, on_get);
+  estimated_bytes_ -= EstimateEntryBytes(it->first, it->second.first);
+  entries_.erase(it);
+}
+
+void HostCache::Compact(base::TimeTicks now, size_t additional_bytes) {
+  // Clear out expired entries.
+  for (EntryMap::iterator it = entries_.begin(); it != entries_.end(); ) {
+    if (it->second.second <= now) {
+      Evict(it++, now, false);
+    } else {
+      ++it;
+    }
+  }
+
+  // If the cache is still too full, start deleting items 'randomly'.
+  for (EntryMap::iterator it = entries_.begin();
+       it != entries_.end() &&
+       (entries_.size() >= max_entries_ ||
+        (max_bytes_ > 0 && estimated_bytes_ + additional_bytes > max_bytes_));
+       ) {
+    Evict(it++, now, false);
+  }
+}
+
 void HostCache::EvictionHandler::Handle(
     const Key& key,
     const Entry& entry,
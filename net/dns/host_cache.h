@@ -5,19 +5,25 @@
 #ifndef NET_DNS_HOST_CACHE_H_
 #define NET_DNS_HOST_CACHE_H_
 
-#include <functional>
 #include <string>
 #include <tuple>
+#include <utility>
 
+#include "base/containers/hash_tables.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time/time.h"
 #include "net/base/address_family.h"
 #include "net/base/address_list.h"
-#include "net/base/expiring_cache.h"
 #include "net/base/net_export.h"
 
+namespace base {
+class Pickle;
+class PickleIterator;
+}
+
 namespace net {
 
 // Cache used by HostResolver to map hostnames to their resolved result.
@@ -56,11 +62,29 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
                       other.hostname);
     }
 
+    bool operator==(const Key& other) const {
+      return address_family == other.address_family &&
+             host_resolver_flags == other.host_resolver_flags &&
+             hostname == other.hostname;
+    }
+
     std::string hostname;
     AddressFamily address_family;
     HostResolverFlags host_resolver_flags;
   };
 
+  // Folds the fixed-width fields into the hostname hash, so that a Lookup()
+  // is a hash probe plus a single equality check rather than a walk over
+  // tree nodes comparing hostnames.
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const {
+      BASE_HASH_NAMESPACE::hash<base::StringPiece> string_piece_hash;
+      return string_piece_hash(key.hostname) +
+             (static_cast<std::size_t>(key.address_family) << 16) +
+             static_cast<std::size_t>(key.host_resolver_flags);
+    }
+  };
+
   struct EvictionHandler {
     void Handle(const Key& key,
                 const Entry& entry,
@@ -69,9 +93,9 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
                 bool onGet) const;
   };
 
-  typedef ExpiringCache<Key, Entry, base::TimeTicks,
-                        std::less<base::TimeTicks>,
-                        EvictionHandler> EntryMap;
+  // Map from key to (entry, expiration time).
+  typedef base::hash_map<Key, std::pair<Entry, base::TimeTicks>, KeyHash>
+      EntryMap;
 
   // Constructs a HostCache that stores up to |max_entries|.
   explicit HostCache(size_t max_entries);
@@ -82,6 +106,15 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Returns a pointer to the entry for |key|, even if it has expired at
+  // time |now|, or NULL if there is no entry at all. Unlike Lookup(),
+  // expired entries are left in the cache. If |stale_out| is non-NULL, it
+  // receives how far past its expiration the entry is at |now| (zero or
+  // negative if the entry is still valid).
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           base::TimeDelta* stale_out);
+
   // Overwrites or creates an entry for |key|.
   // |entry| is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -101,6 +134,28 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
 
   const EntryMap& entries() const;
 
+  // Estimated number of heap bytes used by the stored entries. Maintained
+  // incrementally, so this is cheap to call.
+  size_t estimated_bytes() const;
+
+  // Caps the estimated heap usage of the stored entries at |max_bytes|;
+  // entries are evicted to stay under the cap. Zero (the default) means no
+  // byte limit, leaving only the entry-count limit in effect.
+  void set_max_bytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
+  // Appends a compact binary snapshot of all entries unexpired at |now| to
+  // |pickle|. The snapshot records the wall-clock time it was taken at, so
+  // that remaining TTLs survive a process restart.
+  void Serialize(base::Pickle* pickle, base::TimeTicks now) const;
+
+  // Restores entries from a snapshot written by Serialize(), resuming at
+  // |iter|. The TTL remaining on each entry is discounted by the wall-clock
+  // time elapsed since the snapshot was taken; entries expired by then, and
+  // entries whose key is already in the cache, are dropped. Returns false
+  // without modifying the cache if the snapshot is malformed or from an
+  // incompatible version.
+  bool Restore(base::PickleIterator* iter, base::TimeTicks now);
+
   // Creates a default cache.
   static scoped_ptr<HostCache> CreateDefaultCache();
 
@@ -108,14 +163,30 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   FRIEND_TEST_ALL_PREFIXES(HostCacheTest, NoCache);
 
   // Returns true if this HostCache can contain no entries.
-  bool caching_is_disabled() const {
-    return entries_.max_entries() == 0;
-  }
+  bool caching_is_disabled() const { return max_entries_ == 0; }
+
+  // Returns the rough number of heap bytes taken by the given entry,
+  // counting the variable-length parts it points at.
+  static size_t EstimateEntryBytes(const Key& key, const Entry& entry);
+
+  // Removes the entry at |it| from the cache, recording histograms via
+  // EvictionHandler. |on_get| is true if the entry was found expired by a
+  // Lookup() rather than pushed out while making room.
+  void Evict(EntryMap::iterator it, base::TimeTicks now, bool on_get);
+
+  // Makes room for a new entry of |additional_bytes|: first drops expired
+  // entries, then evicts in (arbitrary) hash order until the cache is below
+  // both the entry-count and byte limits.
+  void Compact(base::TimeTicks now, size_t additional_bytes);
 
   // Map from hostname (presumably in lowercase canonicalized format) to
   // a resolved result entry.
   EntryMap entries_;
 
+  size_t max_entries_;
+  size_t max_bytes_;
+  size_t estimated_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(HostCache);
 };
 
@@ -5,6 +5,7 @@
 #include "net/dns/host_cache.h"
 
 #include "base/format_macros.h"
+#include "base/pickle.h"
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
@@ -85,6 +86,43 @@ TEST(HostCacheTest, Basic) {
   EXPECT_FALSE(cache.Lookup(key2, now));
 }
 
+// LookupStale() should return expired entries without evicting them, and
+// report how far past their expiration they are.
+TEST(HostCacheTest, LookupStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Key key = Key("foobar.com");
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+
+  EXPECT_FALSE(cache.LookupStale(key, now, NULL));
+  cache.Set(key, entry, now, kTTL);
+
+  // At t=5 the entry is fresh; staleness is negative.
+  now += base::TimeDelta::FromSeconds(5);
+  base::TimeDelta staleness;
+  EXPECT_TRUE(cache.LookupStale(key, now, &staleness));
+  EXPECT_EQ(base::TimeDelta::FromSeconds(-5), staleness);
+
+  // At t=15 the entry has been expired for 5 seconds. LookupStale() still
+  // returns it, and leaves it in the cache.
+  now += base::TimeDelta::FromSeconds(10);
+  EXPECT_TRUE(cache.LookupStale(key, now, &staleness));
+  EXPECT_EQ(base::TimeDelta::FromSeconds(5), staleness);
+  EXPECT_TRUE(cache.LookupStale(key, now, &staleness));
+  EXPECT_EQ(1U, cache.size());
+
+  // A regular Lookup() misses and evicts the expired entry, after which
+  // LookupStale() misses as well.
+  EXPECT_FALSE(cache.Lookup(key, now));
+  EXPECT_FALSE(cache.LookupStale(key, now, &staleness));
+  EXPECT_EQ(0U, cache.size());
+}
+
 // Try caching entries for a failed resolve attempt -- since we set the TTL of
 // such entries to 0 it won't store, but it will kick out the previous result.
 TEST(HostCacheTest, NoCacheZeroTTL) {
@@ -115,6 +153,73 @@ TEST(HostCacheTest, NoCacheZeroTTL) {
   EXPECT_FALSE(cache.Lookup(key1, now));
 }
 
+// When the cache is at its entry limit, adding an entry first drops expired
+// entries, then evicts valid ones.
+TEST(HostCacheTest, EvictsWhenFullOfEntries) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(3);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+
+  cache.Set(Key("host1.com"), entry, now, kTTL);
+  cache.Set(Key("host2.com"), entry, now, kTTL);
+  cache.Set(Key("host3.com"), entry, now, kTTL);
+  EXPECT_EQ(3U, cache.size());
+
+  // At t=5 nothing has expired, so an insert evicts a valid entry.
+  now += base::TimeDelta::FromSeconds(5);
+  cache.Set(Key("host4.com"), entry, now, kTTL);
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_TRUE(cache.Lookup(Key("host4.com"), now));
+
+  // At t=12 the first three entries (t=0 + 10s TTL) have expired, and
+  // inserting drops all of them.
+  now += base::TimeDelta::FromSeconds(7);
+  cache.Set(Key("host5.com"), entry, now, kTTL);
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_TRUE(cache.Lookup(Key("host4.com"), now));
+  EXPECT_TRUE(cache.Lookup(Key("host5.com"), now));
+}
+
+// A byte cap set with set_max_bytes() bounds the estimated heap usage of
+// the stored entries, independent of the entry-count limit.
+TEST(HostCacheTest, EvictsWhenOverByteBudget) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+
+  cache.Set(Key("host1.com"), entry, now, kTTL);
+  EXPECT_GT(cache.estimated_bytes(), 0U);
+
+  // Budget for roughly two entries.
+  const size_t kMaxBytes = 2 * cache.estimated_bytes() + 1;
+  cache.set_max_bytes(kMaxBytes);
+
+  cache.Set(Key("host2.com"), entry, now, kTTL);
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_LE(cache.estimated_bytes(), kMaxBytes);
+
+  // A third entry goes over budget and evicts one of the others, even
+  // though the entry-count limit is far away.
+  cache.Set(Key("host3.com"), entry, now, kTTL);
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_LE(cache.estimated_bytes(), kMaxBytes);
+  EXPECT_TRUE(cache.Lookup(Key("host3.com"), now));
+
+  // Clearing the cache resets the accounting.
+  cache.clear();
+  EXPECT_EQ(0U, cache.estimated_bytes());
+}
+
 // Try caching entries for a failed resolves for 10 seconds.
 TEST(HostCacheTest, CacheNegativeEntry) {
   const base::TimeDelta kFailureEntryTTL = base::TimeDelta::FromSeconds(10);
@@ -296,6 +401,105 @@ TEST(HostCacheTest, Clear) {
   EXPECT_EQ(0u, cache.size());
 }
 
+TEST(HostCacheTest, SerializeAndRestore) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  IPAddressNumber address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("1.2.3.4", &address));
+  AddressList addrlist;
+  addrlist.push_back(IPEndPoint(address, 80));
+  addrlist.set_canonical_name("canonical.com");
+
+  // One entry with addresses and a known TTL, one empty entry, and one
+  // entry that will be expired by the time of the snapshot.
+  cache.Set(Key("foobar.com"), HostCache::Entry(OK, addrlist, kTTL), now,
+            kTTL);
+  cache.Set(Key("foobar2.com"), HostCache::Entry(OK, AddressList()), now,
+            kTTL);
+  cache.Set(Key("expired.com"), HostCache::Entry(OK, AddressList()), now,
+            base::TimeDelta::FromSeconds(5));
+
+  // Advance to t=5; "expired.com" is now expired.
+  now += base::TimeDelta::FromSeconds(5);
+
+  base::Pickle pickle;
+  cache.Serialize(&pickle, now);
+
+  HostCache restored_cache(kMaxCacheEntries);
+
+  // An entry resolved in this process must survive the restore.
+  IPAddressNumber other_address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("5.6.7.8", &other_address));
+  AddressList other_addrlist;
+  other_addrlist.push_back(IPEndPoint(other_address, 80));
+  restored_cache.Set(Key("foobar.com"),
+                     HostCache::Entry(OK, other_addrlist), now, kTTL);
+
+  base::PickleIterator iter(pickle);
+  EXPECT_TRUE(restored_cache.Restore(&iter, now));
+  EXPECT_EQ(2u, restored_cache.size());
+
+  // The local entry was not overwritten by the snapshot.
+  const HostCache::Entry* entry = restored_cache.Lookup(Key("foobar.com"),
+                                                        now);
+  ASSERT_TRUE(entry);
+  ASSERT_EQ(1u, entry->addrlist.size());
+  EXPECT_EQ(other_address, entry->addrlist[0].address());
+
+  // The empty entry was restored; the expired one was not.
+  EXPECT_TRUE(restored_cache.Lookup(Key("foobar2.com"), now));
+  EXPECT_FALSE(restored_cache.Lookup(Key("expired.com"), now));
+
+  // Restoring into an empty cache keeps the addresses, canonical name, and
+  // remaining TTL: at t=5 the entry had 5 seconds left, so it must expire
+  // by t=10.
+  HostCache cache2(kMaxCacheEntries);
+  base::PickleIterator iter2(pickle);
+  EXPECT_TRUE(cache2.Restore(&iter2, now));
+  entry = cache2.Lookup(Key("foobar.com"), now);
+  ASSERT_TRUE(entry);
+  ASSERT_EQ(1u, entry->addrlist.size());
+  EXPECT_EQ(address, entry->addrlist[0].address());
+  EXPECT_EQ(80, entry->addrlist[0].port());
+  EXPECT_EQ("canonical.com", entry->addrlist.canonical_name());
+  EXPECT_EQ(kTTL, entry->ttl);
+  now += base::TimeDelta::FromSeconds(5);
+  EXPECT_FALSE(cache2.Lookup(Key("foobar.com"), now));
+}
+
+TEST(HostCacheTest, RestoreRejectsMalformedSnapshot) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+  base::TimeTicks now;
+  cache.Set(Key("foobar.com"), HostCache::Entry(OK, AddressList()), now,
+            kTTL);
+
+  base::Pickle pickle;
+  cache.Serialize(&pickle, now);
+
+  // A snapshot truncated mid-entry must be rejected without restoring
+  // anything.
+  base::Pickle truncated(static_cast<const char*>(pickle.data()),
+                         static_cast<int>(pickle.size()) - 1);
+  HostCache restored_cache(kMaxCacheEntries);
+  base::PickleIterator iter(truncated);
+  EXPECT_FALSE(restored_cache.Restore(&iter, now));
+  EXPECT_EQ(0u, restored_cache.size());
+
+  // So must a snapshot from an unknown format version.
+  base::Pickle bad_version;
+  bad_version.WriteInt(0xbadf00d);
+  base::PickleIterator iter2(bad_version);
+  EXPECT_FALSE(restored_cache.Restore(&iter2, now));
+  EXPECT_EQ(0u, restored_cache.size());
+}
+
 // Tests the less than and equal operators for HostCache::Key work.
 TEST(HostCacheTest, KeyComparators) {
   struct {
@@ -24,6 +24,7 @@
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/sparse_histogram.h"
+#include "base/pickle.h"
 #include "base/profiler/scoped_tracker.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
@@ -78,6 +79,16 @@ const unsigned kMinimumTTLSeconds = kCacheEntryTTLSeconds;
 // cached.
 const int kIPv6ProbePeriodMs = 1000;
 
+// Parameters for adaptive dispatcher sizing. While the moving average of
+// ProcTask blocking time stays below the fast threshold and jobs are queued,
+// the dispatcher may grow beyond its configured capacity, one slot per
+// completed lookup, up to the configured capacity times the given factor.
+// Once the average crosses the slow threshold the extra slots are given back,
+// again one per completed lookup.
+const unsigned kAdaptiveDispatcherFastThresholdMs = 250;
+const unsigned kAdaptiveDispatcherSlowThresholdMs = 1000;
+const size_t kAdaptiveDispatcherMaxFactor = 4;
+
 // Google DNS address used for IPv6 probes.
 const uint8_t kIPv6ProbeAddress[] =
     { 0x20, 0x01, 0x48, 0x60, 0x48, 0x60, 0x00, 0x00,
@@ -440,6 +451,27 @@ void LogCancelRequest(const BoundNetLog& source_net_log,
 
 //-----------------------------------------------------------------------------
 
+// Identifies the current DnsConfig so that a persisted cache snapshot can be
+// validated against the configuration of a later process. Results obtained
+// under a different configuration may be wrong, just as when the
+// configuration changes within a process (see UpdateDNSConfig()).
+std::string GetDnsConfigFingerprint() {
+  DnsConfig dns_config;
+  NetworkChangeNotifier::GetDnsConfig(&dns_config);
+  std::string fingerprint;
+  for (size_t i = 0; i < dns_config.nameservers.size(); ++i) {
+    fingerprint += dns_config.nameservers[i].ToString();
+    fingerprint += '\n';
+  }
+  for (size_t i = 0; i < dns_config.search.size(); ++i) {
+    fingerprint += dns_config.search[i];
+    fingerprint += '\n';
+  }
+  return fingerprint;
+}
+
+//-----------------------------------------------------------------------------
+
 // Keeps track of the highest priority.
 class PriorityTracker {
  public:
@@ -675,8 +707,9 @@ class HostResolverImpl::ProcTask
       return;
     }
 
-    net_log_.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_ATTEMPT_STARTED,
-                      NetLog::IntCallback("attempt_number", attempt_number_));
+    net_log_.AddEventWithIntParams(
+        NetLog::TYPE_HOST_RESOLVER_IMPL_ATTEMPT_STARTED, "attempt_number",
+        attempt_number_);
 
     // If we don't get the results within a given time, RetryIfNotComplete
     // will start a new attempt on a different worker thread if none of our
@@ -1244,10 +1277,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   Job(const base::WeakPtr<HostResolverImpl>& resolver,
       const Key& key,
       RequestPriority priority,
+      bool is_cache_refresh,
       const BoundNetLog& source_net_log)
       : resolver_(resolver),
         key_(key),
         priority_tracker_(priority),
+        is_cache_refresh_(is_cache_refresh),
         had_non_speculative_request_(false),
         had_dns_config_(false),
         num_occupied_job_slots_(0),
@@ -1399,11 +1434,14 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    DCHECK(num_active_requests() > 0u || is_cache_refresh_);
     AddressList addr_list;
-    if (resolver_->ServeFromHosts(key(),
-                                  requests_.front()->info(),
-                                  &addr_list)) {
+    // Cache refresh jobs have no attached requests; the port is irrelevant
+    // since it is fixed up when the cached result is served.
+    RequestInfo info = requests_.empty()
+                           ? RequestInfo(HostPortPair(key_.hostname, 0))
+                           : requests_.front()->info();
+    if (resolver_->ServeFromHosts(key(), info, &addr_list)) {
       // This will destroy the Job.
       CompleteRequests(
           HostCache::Entry(OK, MakeAddressListForRequest(addr_list)),
@@ -1532,6 +1570,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                           const AddressList& addr_list) {
     DCHECK(is_proc_running());
 
+    resolver_->RecordProcTaskBlockingTime(base::TimeTicks::Now() - start_time);
+
     if (!resolver_->resolved_known_ipv6_hostname_ &&
         net_error == OK &&
         key_.address_family == ADDRESS_FAMILY_UNSPECIFIED) {
@@ -1703,7 +1743,14 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       handle_.Reset();
     }
 
+    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
+                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
+
     if (num_active_requests() == 0) {
+      // Cache refresh jobs have no attached requests, but their results
+      // must still replace the stale cache entry they were spawned for.
+      if (is_cache_refresh_ && did_complete)
+        resolver_->CacheResult(key_, entry, ttl);
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1722,8 +1769,6 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                             resolver_->received_dns_config_);
     }
 
-    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
-                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
     if (did_complete)
       resolver_->CacheResult(key_, entry, ttl);
 
@@ -1779,6 +1824,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Tracks the highest priority across |requests_|.
   PriorityTracker priority_tracker_;
 
+  // True if this job was spawned only to refresh a stale cache entry, and
+  // so may complete without any attached requests.
+  const bool is_cache_refresh_;
+
   bool had_non_speculative_request_;
 
   // Distinguishes measurements taken while DnsClient was fully configured.
@@ -1844,6 +1893,7 @@ HostResolverImpl::HostResolverImpl(const Options& options, NetLog* net_log)
   PrioritizedDispatcher::Limits job_limits = options.GetDispatcherLimits();
   dispatcher_.reset(new PrioritizedDispatcher(job_limits));
   max_queued_jobs_ = job_limits.total_jobs * 100u;
+  base_dispatcher_total_jobs_ = job_limits.total_jobs;
 
   DCHECK_GE(dispatcher_->num_priorities(), static_cast<size_t>(NUM_PRIORITIES));
 
@@ -1914,8 +1964,14 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
   // outstanding jobs map.
   Key key = GetEffectiveKeyForRequest(info, ip_number_ptr, source_net_log);
 
-  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, source_net_log);
+  bool served_stale = false;
+  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, true,
+                         &served_stale, source_net_log);
   if (rv != ERR_DNS_CACHE_MISS) {
+    // A stale cache entry was served; refresh it in the background unless a
+    // job for this key is already in flight.
+    if (served_stale && jobs_.find(key) == jobs_.end())
+      CreateJob(key, priority, true /* is_cache_refresh */, source_net_log);
     LogFinishRequest(source_net_log, info, rv);
     RecordTotalTime(HaveDnsConfig(), info.is_speculative(), base::TimeDelta());
     return rv;
@@ -1927,22 +1983,13 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
   JobMap::iterator jobit = jobs_.find(key);
   Job* job;
   if (jobit == jobs_.end()) {
-    job =
-        new Job(weak_ptr_factory_.GetWeakPtr(), key, priority, source_net_log);
-    job->Schedule(false);
-
-    // Check for queue overflow.
-    if (dispatcher_->num_queued_jobs() > max_queued_jobs_) {
-      Job* evicted = static_cast<Job*>(dispatcher_->EvictOldestLowest());
-      DCHECK(evicted);
-      evicted->OnEvicted();  // Deletes |evicted|.
-      if (evicted == job) {
-        rv = ERR_HOST_RESOLVER_QUEUE_TOO_LARGE;
-        LogFinishRequest(source_net_log, info, rv);
-        return rv;
-      }
+    job = CreateJob(key, priority, false /* is_cache_refresh */,
+                    source_net_log);
+    if (!job) {
+      rv = ERR_HOST_RESOLVER_QUEUE_TOO_LARGE;
+      LogFinishRequest(source_net_log, info, rv);
+      return rv;
     }
-    jobs_.insert(jobit, std::make_pair(key, job));
   } else {
     job = jobit->second;
   }
@@ -1962,6 +2009,8 @@ int HostResolverImpl::ResolveHelper(const Key& key,
                                     const RequestInfo& info,
                                     const IPAddressNumber* ip_number,
                                     AddressList* addresses,
+                                    bool allow_stale,
+                                    bool* served_stale,
                                     const BoundNetLog& source_net_log) {
   // The result of |getaddrinfo| for empty hosts is inconsistent across systems.
   // On Windows it gives the default interface's address, whereas on Linux it
@@ -1972,7 +2021,8 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, ip_number, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
+  if (ServeFromCache(key, info, &net_error, addresses, allow_stale,
+                     served_stale)) {
     source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
     return net_error;
   }
@@ -2005,7 +2055,8 @@ int HostResolverImpl::ResolveFromCache(const RequestInfo& info,
 
   Key key = GetEffectiveKeyForRequest(info, ip_number_ptr, source_net_log);
 
-  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, source_net_log);
+  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, false, NULL,
+                         source_net_log);
   LogFinishRequest(source_net_log, info, rv);
   return rv;
 }
@@ -2048,6 +2099,27 @@ base::Value* HostResolverImpl::GetDnsConfigAsValue() const {
   return dns_config->ToValue();
 }
 
+void HostResolverImpl::PersistHostCache(base::Pickle* pickle) const {
+  DCHECK(CalledOnValidThread());
+  if (!cache_.get())
+    return;
+  pickle->WriteString(GetDnsConfigFingerprint());
+  cache_->Serialize(pickle, base::TimeTicks::Now());
+}
+
+bool HostResolverImpl::RestoreHostCache(const base::Pickle& pickle) {
+  DCHECK(CalledOnValidThread());
+  if (!cache_.get())
+    return false;
+  base::PickleIterator iter(pickle);
+  std::string fingerprint;
+  if (!iter.ReadString(&fingerprint))
+    return false;
+  if (fingerprint != GetDnsConfigFingerprint())
+    return false;
+  return cache_->Restore(&iter, base::TimeTicks::Now());
+}
+
 bool HostResolverImpl::ResolveAsIP(const Key& key,
                                    const RequestInfo& info,
                                    const IPAddressNumber* ip_number,
@@ -2080,14 +2152,38 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      bool allow_stale,
+                                      bool* served_stale) {
   DCHECK(addresses);
   DCHECK(net_error);
+  DCHECK(!allow_stale || served_stale);
+  if (served_stale)
+    *served_stale = false;
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  base::TimeTicks now = base::TimeTicks::Now();
+  const HostCache::Entry* cache_entry;
+  if (allow_stale && serve_stale_max_age_ > base::TimeDelta()) {
+    base::TimeDelta staleness;
+    cache_entry = cache_->LookupStale(key, now, &staleness);
+    if (cache_entry && staleness > base::TimeDelta()) {
+      // Never serve expired error results, entries expired for longer than
+      // the staleness bound, or expired entries to speculative requests,
+      // which are made to refresh the cache in the first place.
+      if (cache_entry->error != OK || staleness > serve_stale_max_age_ ||
+          info.is_speculative()) {
+        // Evict the entry, as a regular lookup would have.
+        cache_entry = cache_->Lookup(key, now);
+        DCHECK(!cache_entry);
+      } else {
+        *served_stale = true;
+      }
+    }
+  } else {
+    cache_entry = cache_->Lookup(key, now);
+  }
   if (!cache_entry)
     return false;
 
@@ -2177,6 +2273,60 @@ bool HostResolverImpl::ServeLocalhost(const Key& key,
   return true;
 }
 
+HostResolverImpl::Job* HostResolverImpl::CreateJob(
+    const Key& key,
+    RequestPriority priority,
+    bool is_cache_refresh,
+    const BoundNetLog& source_net_log) {
+  DCHECK(jobs_.find(key) == jobs_.end());
+  Job* job = new Job(weak_ptr_factory_.GetWeakPtr(), key, priority,
+                     is_cache_refresh, source_net_log);
+  job->Schedule(false);
+
+  // Check for queue overflow.
+  if (dispatcher_->num_queued_jobs() > max_queued_jobs_) {
+    Job* evicted = static_cast<Job*>(dispatcher_->EvictOldestLowest());
+    DCHECK(evicted);
+    evicted->OnEvicted();  // Deletes |evicted|.
+    if (evicted == job)
+      return NULL;
+  }
+  jobs_.insert(std::make_pair(key, job));
+  return job;
+}
+
+void HostResolverImpl::RecordProcTaskBlockingTime(
+    base::TimeDelta blocking_time) {
+  // Moving average with the same smoothing DnsSession applies to RTTs.
+  if (proc_task_blocking_time_ == base::TimeDelta()) {
+    proc_task_blocking_time_ = blocking_time;
+  } else {
+    proc_task_blocking_time_ += (blocking_time - proc_task_blocking_time_) / 8;
+  }
+
+  PrioritizedDispatcher::Limits limits = dispatcher_->GetLimits();
+  if (proc_task_blocking_time_ <=
+          base::TimeDelta::FromMilliseconds(
+              kAdaptiveDispatcherFastThresholdMs) &&
+      dispatcher_->num_queued_jobs() > 0 &&
+      limits.total_jobs <
+          base_dispatcher_total_jobs_ * kAdaptiveDispatcherMaxFactor) {
+    // Lookups are fast but jobs are piling up; add a slot.
+    ++limits.total_jobs;
+  } else if (proc_task_blocking_time_ >=
+                 base::TimeDelta::FromMilliseconds(
+                     kAdaptiveDispatcherSlowThresholdMs) &&
+             limits.total_jobs > base_dispatcher_total_jobs_) {
+    // Lookups are blocking workers for a long time; fall back toward the
+    // configured capacity. Running jobs are not stopped, so the reduction
+    // takes effect as they finish.
+    --limits.total_jobs;
+  } else {
+    return;
+  }
+  dispatcher_->SetLimits(limits);
+}
+
 void HostResolverImpl::CacheResult(const Key& key,
                                    const HostCache::Entry& entry,
                                    base::TimeDelta ttl) {
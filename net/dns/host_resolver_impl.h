@@ -19,6 +19,11 @@
 #include "net/dns/host_resolver.h"
 #include "net/dns/host_resolver_proc.h"
 
+namespace base {
+class Pickle;
+class PickleIterator;
+}
+
 namespace net {
 
 class BoundNetLog;
@@ -137,10 +142,32 @@ class NET_EXPORT HostResolverImpl
   HostCache* GetHostCache() override;
   base::Value* GetDnsConfigAsValue() const override;
 
+  // Appends a snapshot of the host cache to |pickle|, tagged with a
+  // fingerprint of the current DnsConfig. The caller saves the pickle,
+  // typically to disk at shutdown, and hands it to RestoreHostCache() in a
+  // later process to start with a warm cache. No-op without a cache.
+  void PersistHostCache(base::Pickle* pickle) const;
+
+  // Merges a snapshot produced by PersistHostCache() into the cache. The
+  // TTL remaining on each entry is discounted by the time since the
+  // snapshot was taken, and entries resolved in this process are not
+  // overwritten. Returns false without modifying the cache if the snapshot
+  // is malformed or was taken under a different DnsConfig.
+  bool RestoreHostCache(const base::Pickle& pickle);
+
   void set_proc_params_for_test(const ProcTaskParams& proc_params) {
     proc_params_ = proc_params;
   }
 
+  // Enables serving expired cache entries: a cached address list that has
+  // been expired for no longer than |max_age| is returned immediately while
+  // a background job refreshes the cache entry. A zero |max_age| (the
+  // default) disables the feature. Expired entries are never served for
+  // speculative requests or error results.
+  void set_serve_stale_max_age(base::TimeDelta max_age) {
+    serve_stale_max_age_ = max_age;
+  }
+
  private:
   friend class HostResolverImplTest;
   class Job;
@@ -159,11 +186,15 @@ class NET_EXPORT HostResolverImpl
   // literal, cache and HOSTS lookup (if enabled), returns OK if successful,
   // ERR_NAME_NOT_RESOLVED if either hostname is invalid or IP literal is
   // incompatible, ERR_DNS_CACHE_MISS if entry was not found in cache and
-  // HOSTS and is not localhost.
+  // HOSTS and is not localhost. If |allow_stale| is true, an expired cache
+  // entry may be served (see ServeFromCache()), in which case |served_stale|
+  // is set to true; |served_stale| may be NULL iff |allow_stale| is false.
   int ResolveHelper(const Key& key,
                     const RequestInfo& info,
                     const IPAddressNumber* ip_address,
                     AddressList* addresses,
+                    bool allow_stale,
+                    bool* served_stale,
                     const BoundNetLog& request_net_log);
 
   // Tries to resolve |key| as an IP, returns true and sets |net_error| if
@@ -176,11 +207,17 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. If |allow_stale| is true and serving stale
+  // entries is enabled via set_serve_stale_max_age(), a successful entry
+  // that expired no longer than the maximum age ago may also be served,
+  // in which case |served_stale| is set to true and the expired entry is
+  // left in the cache for the refresh job to overwrite.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      bool allow_stale,
+                      bool* served_stale);
 
   // If we have a DnsClient with a valid DnsConfig, and |key| is found in the
   // HOSTS file, returns true and fills |addresses|. Otherwise returns false.
@@ -209,6 +246,22 @@ class NET_EXPORT HostResolverImpl
   // from the first probe for some time before probing again.
   virtual bool IsIPv6Reachable(const BoundNetLog& net_log);
 
+  // Creates a new Job for |key|, adds it to |jobs_| and schedules it on the
+  // dispatcher. If |is_cache_refresh| is true, the job only refreshes the
+  // cache entry for |key| and completes without any attached requests.
+  // Returns NULL if the new job was immediately evicted from an overflowing
+  // dispatcher queue.
+  Job* CreateJob(const Key& key,
+                 RequestPriority priority,
+                 bool is_cache_refresh,
+                 const BoundNetLog& source_net_log);
+
+  // Records how long a ProcTask spent blocked in the system resolver, and
+  // adapts the |dispatcher_| size: when lookups are fast and jobs are piling
+  // up in the queue, extra slots are added beyond the configured limit, and
+  // they are removed again when lookups slow down.
+  void RecordProcTaskBlockingTime(base::TimeDelta blocking_time);
+
   // Records the result in cache if cache is present.
   void CacheResult(const Key& key,
                    const HostCache::Entry& entry,
@@ -265,6 +318,14 @@ class NET_EXPORT HostResolverImpl
   // Limit on the maximum number of jobs queued in |dispatcher_|.
   size_t max_queued_jobs_;
 
+  // Configured |dispatcher_| capacity. Adaptive sizing never shrinks the
+  // dispatcher below this, nor grows it beyond a fixed multiple of it.
+  size_t base_dispatcher_total_jobs_;
+
+  // Moving average of the time ProcTasks spend blocked in the system
+  // resolver. Drives the adaptive sizing of |dispatcher_|.
+  base::TimeDelta proc_task_blocking_time_;
+
   // Parameters for ProcTask.
   ProcTaskParams proc_params_;
 
@@ -297,6 +358,11 @@ class NET_EXPORT HostResolverImpl
   // Allow fallback to ProcTask if DnsTask fails.
   bool fallback_to_proctask_;
 
+  // Maximum time past its expiration for which a successful cache entry is
+  // still served while a refresh job runs. Zero disables serving stale
+  // entries.
+  base::TimeDelta serve_stale_max_age_;
+
   base::WeakPtrFactory<HostResolverImpl> weak_ptr_factory_;
 
   base::WeakPtrFactory<HostResolverImpl> probe_weak_ptr_factory_;
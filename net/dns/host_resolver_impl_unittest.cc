@@ -996,6 +996,79 @@ TEST_F(HostResolverImplTest, FlushCacheOnIPAddressChange) {
   EXPECT_EQ(OK, req->WaitForResult());
 }
 
+// Test that when serving stale entries is enabled, an expired cache entry is
+// served synchronously while a background job refreshes it.
+TEST_F(HostResolverImplTest, ServeStaleWhileRefreshing) {
+  proc_->AddRuleForAllFamilies("host1", "192.168.1.101");
+  proc_->SignalMultiple(2u);  // One initial resolution, one refresh.
+
+  resolver_->set_serve_stale_max_age(base::TimeDelta::FromMinutes(1));
+
+  Request* req = CreateRequest("host1", 80);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  EXPECT_EQ(OK, req->WaitForResult());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.101", 80));
+
+  // Rewrite the cached entry as having expired five seconds ago, and change
+  // what the proc returns, so stale and fresh results are distinguishable.
+  HostCache* cache = resolver_->GetHostCache();
+  ASSERT_EQ(1u, cache->size());
+  const HostCache::Key key = cache->entries().begin()->first;
+  const HostCache::Entry entry = cache->entries().begin()->second.first;
+  cache->Set(key, entry,
+             base::TimeTicks::Now() - base::TimeDelta::FromSeconds(10),
+             base::TimeDelta::FromSeconds(5));
+  proc_->AddRuleForAllFamilies("host1", "192.168.1.102");
+
+  // The stale address is served synchronously while a refresh job starts.
+  req = CreateRequest("host1", 80);
+  EXPECT_EQ(OK, req->Resolve());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.101", 80));
+
+  // Speculative requests are never served stale; this one attaches to the
+  // refresh job, which lets the test wait for the refresh to finish.
+  HostResolver::RequestInfo info(HostPortPair("host1", 80));
+  info.set_is_speculative(true);
+  Request* refresh_req = CreateRequest(info, MEDIUM);
+  EXPECT_EQ(ERR_IO_PENDING, refresh_req->Resolve());
+  EXPECT_EQ(OK, refresh_req->WaitForResult());
+
+  // The refreshed result is served from then on.
+  req = CreateRequest("host1", 80);
+  EXPECT_EQ(OK, req->Resolve());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.102", 80));
+  EXPECT_EQ(2u, proc_->GetCaptureList().size());
+}
+
+// Test that entries expired for longer than the staleness bound are treated
+// as misses and evicted.
+TEST_F(HostResolverImplTest, DontServeStaleBeyondMaxAge) {
+  proc_->AddRuleForAllFamilies("host1", "192.168.1.101");
+  proc_->SignalMultiple(2u);
+
+  resolver_->set_serve_stale_max_age(base::TimeDelta::FromSeconds(60));
+
+  Request* req = CreateRequest("host1", 80);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  EXPECT_EQ(OK, req->WaitForResult());
+
+  // Rewrite the cached entry as having expired well past the bound.
+  HostCache* cache = resolver_->GetHostCache();
+  ASSERT_EQ(1u, cache->size());
+  const HostCache::Key key = cache->entries().begin()->first;
+  const HostCache::Entry entry = cache->entries().begin()->second.first;
+  cache->Set(key, entry,
+             base::TimeTicks::Now() - base::TimeDelta::FromSeconds(120),
+             base::TimeDelta::FromSeconds(5));
+
+  // Too stale to serve: the entry is evicted and the request goes to the
+  // proc, like a regular cache miss.
+  req = CreateRequest("host1", 80);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  EXPECT_EQ(0u, cache->size());
+  EXPECT_EQ(OK, req->WaitForResult());
+}
+
 // Test that IP address changes send ERR_NETWORK_CHANGED to pending requests.
 TEST_F(HostResolverImplTest, AbortOnIPAddressChanged) {
   Request* req = CreateRequest("host1", 70);
@@ -1050,6 +1123,28 @@ TEST_F(HostResolverImplTest, ObeyPoolConstraintsAfterIPAddressChange) {
   EXPECT_EQ(OK, requests_[1]->result());
 }
 
+// The dispatcher grows beyond its configured size when lookups complete
+// quickly while other jobs are queued behind them.
+TEST_F(HostResolverImplTest, AdaptiveDispatcherGrowsWhenLookupsAreFast) {
+  // Runs at most one job at a time, before adaptation.
+  CreateSerialResolver();
+  proc_->SignalMultiple(1u);  // Only let the first lookup return.
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("a")->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("b")->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("c")->Resolve());
+
+  // "a" completes quickly with "b" and "c" queued, so the dispatcher gains a
+  // slot and both remaining jobs end up running concurrently.
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_TRUE(proc_->WaitFor(2u));
+  EXPECT_EQ(2u, num_running_dispatcher_jobs());
+
+  proc_->SignalAll();
+  EXPECT_EQ(OK, requests_[1]->WaitForResult());
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+}
+
 // Tests that a new Request made from the callback of a previously aborted one
 // will not be aborted.
 TEST_F(HostResolverImplTest, AbortOnlyExistingRequestsOnIPAddressChange) {
@@ -4,10 +4,10 @@
 
 #include "net/dns/mdns_cache.h"
 
-#include <algorithm>
 #include <tuple>
 #include <utility>
 
+#include "base/logging.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "net/dns/dns_protocol.h"
@@ -70,7 +70,7 @@ MDnsCache::~MDnsCache() {
 }
 
 void MDnsCache::Clear() {
-  next_expiration_ = base::Time();
+  expiration_index_.clear();
   STLDeleteValues(&mdns_cache_);
 }
 
@@ -91,8 +91,6 @@ MDnsCache::UpdateType MDnsCache::UpdateDnsRecord(
     return NoChange;
 
   base::Time new_expiration = GetEffectiveExpiration(record.get());
-  if (next_expiration_ != base::Time())
-    new_expiration = std::min(new_expiration, next_expiration_);
 
   std::pair<RecordMap::iterator, bool> insert_result =
       mdns_cache_.insert(std::make_pair(cache_key, (const RecordParsed*)NULL));
@@ -105,40 +103,29 @@ MDnsCache::UpdateType MDnsCache::UpdateDnsRecord(
     if (record->ttl() != 0 && !record->IsEqual(other_record, true)) {
       type = RecordChanged;
     }
+    RemoveFromExpirationIndex(other_record);
     delete other_record;
   }
 
-  insert_result.first->second = record.release();
-  next_expiration_ = new_expiration;
+  insert_result.first->second = record.get();
+  expiration_index_.insert(std::make_pair(new_expiration, record.release()));
   return type;
 }
 
 void MDnsCache::CleanupRecords(
     base::Time now,
     const RecordRemovedCallback& record_removed_callback) {
-  base::Time next_expiration;
-
-  // We are guaranteed that |next_expiration_| will be at or before the next
-  // expiration. This allows clients to eagrely call CleanupRecords with
+  // |expiration_index_| is ordered by expiration time, so only the records
+  // that are actually due are visited. Clients may call this eagerly with
   // impunity.
-  if (now < next_expiration_) return;
-
-  for (RecordMap::iterator i = mdns_cache_.begin();
-       i != mdns_cache_.end(); ) {
-    base::Time expiration = GetEffectiveExpiration(i->second);
-    if (now >= expiration) {
-      record_removed_callback.Run(i->second);
-      delete i->second;
-      mdns_cache_.erase(i++);
-    } else {
-      if (next_expiration == base::Time() ||  expiration < next_expiration) {
-        next_expiration = expiration;
-      }
-      ++i;
-    }
+  while (!expiration_index_.empty() &&
+         now >= expiration_index_.begin()->first) {
+    const RecordParsed* record = expiration_index_.begin()->second;
+    expiration_index_.erase(expiration_index_.begin());
+    mdns_cache_.erase(Key::CreateFor(record));
+    record_removed_callback.Run(record);
+    delete record;
   }
-
-  next_expiration_ = next_expiration;
 }
 
 void MDnsCache::FindDnsRecords(unsigned type,
@@ -171,12 +158,25 @@ scoped_ptr<const RecordParsed> MDnsCache::RemoveRecord(
 
   if (found != mdns_cache_.end() && found->second == record) {
     mdns_cache_.erase(key);
+    RemoveFromExpirationIndex(record);
     return scoped_ptr<const RecordParsed>(record);
   }
 
   return scoped_ptr<const RecordParsed>();
 }
 
+void MDnsCache::RemoveFromExpirationIndex(const RecordParsed* record) {
+  std::pair<ExpirationIndex::iterator, ExpirationIndex::iterator> range =
+      expiration_index_.equal_range(GetEffectiveExpiration(record));
+  for (ExpirationIndex::iterator i = range.first; i != range.second; ++i) {
+    if (i->second == record) {
+      expiration_index_.erase(i);
+      return;
+    }
+  }
+  NOTREACHED();
+}
+
 // static
 std::string MDnsCache::GetOptionalFieldForRecord(
     const RecordParsed* record) {
@@ -79,14 +79,17 @@ class NET_EXPORT_PRIVATE MDnsCache {
                       base::Time now) const;
 
   // Remove expired records, call |record_removed_callback| for every removed
-  // record.
+  // record. Only touches the records that are due at |now|, not the whole
+  // cache.
   void CleanupRecords(base::Time now,
                       const RecordRemovedCallback& record_removed_callback);
 
-  // Returns a time less than or equal to the next time a record will expire.
-  // Is updated when CleanupRecords or UpdateDnsRecord are called. Returns
-  // base::Time when the cache is empty.
-  base::Time next_expiration() const { return next_expiration_; }
+  // Returns the next time a record will expire, or base::Time() when the
+  // cache is empty.
+  base::Time next_expiration() const {
+    return expiration_index_.empty() ? base::Time()
+                                     : expiration_index_.begin()->first;
+  }
 
   // Remove a record from the cache.  Returns a scoped version of the pointer
   // passed in if it was removed, scoped null otherwise.
@@ -97,6 +100,10 @@ class NET_EXPORT_PRIVATE MDnsCache {
  private:
   typedef std::map<Key, const RecordParsed*> RecordMap;
 
+  // Index of the records in |mdns_cache_| ordered by effective expiration
+  // time, so expiring records are found without scanning the whole cache.
+  typedef std::multimap<base::Time, const RecordParsed*> ExpirationIndex;
+
   // Get the effective expiration of a cache entry, based on its creation time
   // and TTL. Does adjustments so entries with a TTL of zero will have a
   // nonzero TTL, as explained in RFC 6762 Section 10.1.
@@ -108,9 +115,12 @@ class NET_EXPORT_PRIVATE MDnsCache {
   static std::string GetOptionalFieldForRecord(
       const RecordParsed* record);
 
+  // Remove |record| from |expiration_index_|. The record must be indexed.
+  void RemoveFromExpirationIndex(const RecordParsed* record);
+
   RecordMap mdns_cache_;
 
-  base::Time next_expiration_;
+  ExpirationIndex expiration_index_;
 
   DISALLOW_COPY_AND_ASSIGN(MDnsCache);
 };
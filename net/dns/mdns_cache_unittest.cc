@@ -370,6 +370,7 @@ TEST_F(MDnsCacheTest, RemoveRecord) {
                         &results, default_time_);
 
   EXPECT_EQ(0u, results.size());
+  EXPECT_EQ(base::Time(), cache_.next_expiration());
 }
 
 }  // namespace net
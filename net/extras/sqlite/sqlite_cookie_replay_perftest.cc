@@ -0,0 +1,337 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays a production-shaped mix of cookie operations through a CookieMonster
+// backed by a SQLitePersistentCookieStore, and reports replay throughput plus
+// flush-latency percentiles. The existing cookie perf tests each cover one
+// layer with synthetic loops; this one exercises the full stack (parsing,
+// the in-memory store and the SQLite backend together) under a skewed
+// domain distribution, which is where sharding and indexing changes show up.
+//
+// By default a deterministic synthetic trace is replayed. An anonymized trace
+// captured elsewhere can be supplied with --cookie-replay-trace=<path>; the
+// format is one operation per line,
+//
+//   S <domain-id> <value-bytes>   set a cookie for the given domain
+//   G <domain-id>                 read the cookies for the given domain
+//
+// with '#' introducing comment lines. Domain ids are opaque small integers;
+// they carry no origin information.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/thread_task_runner_handle.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/time/time.h"
+#include "net/cookies/cookie_monster.h"
+#include "net/cookies/cookie_options.h"
+#include "net/extras/sqlite/sqlite_persistent_cookie_store.h"
+#include "net/test/benchmark_reporter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+const base::FilePath::CharType kCookieFilename[] = FILE_PATH_LITERAL("Cookies");
+
+// Switch holding the path of an anonymized trace to replay instead of the
+// built-in synthetic one.
+const char kReplayTraceSwitch[] = "cookie-replay-trace";
+
+// Shape of the default synthetic trace.
+const int kNumDomains = 300;
+const int kNumOps = 30000;
+const int kGetPercent = 80;
+
+// Distinct cookie names used per domain, so that repeated sets exercise the
+// overwrite path as well as insertion.
+const int kCookiesPerDomain = 5;
+
+// A store flush is timed once per this many replayed operations.
+const int kOpsPerFlush = 1000;
+
+// One replayed operation: either set a cookie of |value_size| bytes for
+// |domain|, or read the cookies for |domain|.
+struct ReplayOp {
+  bool is_set;
+  int domain;
+  int value_size;
+};
+
+// Deterministic generator (numerical recipes LCG) so that consecutive runs
+// replay the identical operation sequence and their numbers are comparable.
+class TraceRng {
+ public:
+  explicit TraceRng(uint32 seed) : state_(seed) {}
+
+  // Returns a value in [0, |range|).
+  uint32 Next(uint32 range) {
+    state_ = state_ * 1664525 + 1013904223;
+    return (state_ >> 16) % range;
+  }
+
+ private:
+  uint32 state_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceRng);
+};
+
+// Builds the default trace: domain popularity is heavily skewed (squaring a
+// uniform draw), most operations are reads, and cookie values cluster at
+// small sizes with a long tail, approximating production load.
+void GenerateDefaultTrace(std::vector<ReplayOp>* ops) {
+  static const int kValueSizes[] = {16, 64, 256, 1024};
+  TraceRng rng(0x5eed);
+  ops->reserve(kNumOps);
+  for (int i = 0; i < kNumOps; ++i) {
+    ReplayOp op;
+    uint32 popularity = rng.Next(kNumDomains);
+    op.domain = static_cast<int>(popularity * popularity / kNumDomains);
+    op.is_set = rng.Next(100) >= static_cast<uint32>(kGetPercent);
+    if (op.is_set) {
+      uint32 r = rng.Next(10);
+      op.value_size = kValueSizes[r < 4 ? 0 : r < 7 ? 1 : r < 9 ? 2 : 3];
+    } else {
+      op.value_size = 0;
+    }
+    ops->push_back(op);
+  }
+}
+
+// Parses the trace format described at the top of the file. Returns false if
+// any line is malformed or the trace holds no operations.
+bool ParseReplayTrace(const std::string& text, std::vector<ReplayOp>* ops) {
+  for (const std::string& line : base::SplitString(
+           text, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (line[0] == '#')
+      continue;
+    std::vector<std::string> fields = base::SplitString(
+        line, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    ReplayOp op;
+    op.value_size = 0;
+    if (fields[0] == "S" && fields.size() == 3u) {
+      op.is_set = true;
+      if (!base::StringToInt(fields[1], &op.domain) ||
+          !base::StringToInt(fields[2], &op.value_size))
+        return false;
+    } else if (fields[0] == "G" && fields.size() == 2u) {
+      op.is_set = false;
+      if (!base::StringToInt(fields[1], &op.domain))
+        return false;
+    } else {
+      return false;
+    }
+    if (op.domain < 0 || op.value_size < 0)
+      return false;
+    ops->push_back(op);
+  }
+  return !ops->empty();
+}
+
+GURL ReplayURL(int domain) {
+  return GURL(base::StringPrintf("https://www.domain-%d.com/", domain));
+}
+
+// Unlike cookie_monster_perftest.cc, the replay runs against a real
+// background store, so callbacks are not guaranteed to complete
+// synchronously; each wait pumps the main loop until the callback has posted
+// its quit task.
+class ReplayCallback {
+ public:
+  ReplayCallback() : has_run_(false) {}
+
+  void WaitForCallback() {
+    base::MessageLoop::current()->Run();
+    EXPECT_TRUE(has_run_);
+    has_run_ = false;
+  }
+
+ protected:
+  void Run() {
+    has_run_ = true;
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE, base::MessageLoop::QuitWhenIdleClosure());
+  }
+
+ private:
+  bool has_run_;
+};
+
+class SetCookieCallback : public ReplayCallback {
+ public:
+  void SetCookie(CookieMonster* cm,
+                 const GURL& gurl,
+                 const std::string& cookie) {
+    cm->SetCookieWithOptionsAsync(
+        gurl, cookie, options_,
+        base::Bind(&SetCookieCallback::Run, base::Unretained(this)));
+    WaitForCallback();
+  }
+
+ private:
+  void Run(bool success) {
+    EXPECT_TRUE(success);
+    ReplayCallback::Run();
+  }
+
+  CookieOptions options_;
+};
+
+class GetCookiesCallback : public ReplayCallback {
+ public:
+  void GetCookies(CookieMonster* cm, const GURL& gurl) {
+    cm->GetCookiesWithOptionsAsync(
+        gurl, options_,
+        base::Bind(&GetCookiesCallback::Run, base::Unretained(this)));
+    WaitForCallback();
+  }
+
+ private:
+  void Run(const std::string& cookies) { ReplayCallback::Run(); }
+
+  CookieOptions options_;
+};
+
+class FlushCallback : public ReplayCallback {
+ public:
+  // Flushes |cm|'s backing store and returns the end-to-end latency.
+  base::TimeDelta TimedFlush(CookieMonster* cm) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    cm->FlushStore(base::Bind(&FlushCallback::Run, base::Unretained(this)));
+    WaitForCallback();
+    return base::TimeTicks::Now() - start;
+  }
+
+ private:
+  void Run() { ReplayCallback::Run(); }
+};
+
+// Collects flush timings and reports their percentiles through the common
+// benchmark harness, mirroring the disk cache benchmark.
+class LatencyStats {
+ public:
+  LatencyStats() {}
+
+  void Add(base::TimeDelta sample) { samples_.push_back(sample); }
+
+  void Report(const std::string& name) {
+    if (samples_.empty())
+      return;
+    net::test::BenchmarkReporter reporter(name);
+    for (size_t i = 0; i < samples_.size(); ++i)
+      reporter.AddLatencySampleUs(samples_[i].InMicroseconds());
+  }
+
+ private:
+  std::vector<base::TimeDelta> samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyStats);
+};
+
+}  // namespace
+
+class SQLiteCookieReplayPerfTest : public testing::Test {
+ public:
+  SQLiteCookieReplayPerfTest()
+      : pool_owner_(new base::SequencedWorkerPoolOwner(1, "Background Pool")) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    // The client runner is the main loop so that completions are pumped by
+    // ReplayCallback::WaitForCallback().
+    store_ = new SQLitePersistentCookieStore(
+        temp_dir_.path().Append(kCookieFilename),
+        base::ThreadTaskRunnerHandle::Get(),
+        pool_owner_->pool()->GetSequencedTaskRunner(
+            pool_owner_->pool()->GetNamedSequenceToken("background")),
+        false, NULL);
+    cookie_monster_ = new CookieMonster(store_.get(), NULL);
+  }
+
+  void TearDown() override {
+    cookie_monster_ = NULL;
+    store_ = NULL;
+    pool_owner_->pool()->Shutdown();
+  }
+
+ protected:
+  // Loads the trace named on the command line, or falls back to the built-in
+  // synthetic one.
+  void BuildTrace(std::vector<ReplayOp>* ops) {
+    const base::CommandLine& command_line =
+        *base::CommandLine::ForCurrentProcess();
+    if (command_line.HasSwitch(kReplayTraceSwitch)) {
+      std::string text;
+      ASSERT_TRUE(base::ReadFileToString(
+          command_line.GetSwitchValuePath(kReplayTraceSwitch), &text));
+      ASSERT_TRUE(ParseReplayTrace(text, ops));
+    } else {
+      GenerateDefaultTrace(ops);
+    }
+  }
+
+  base::MessageLoopForIO main_loop_;
+  scoped_ptr<base::SequencedWorkerPoolOwner> pool_owner_;
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<SQLitePersistentCookieStore> store_;
+  scoped_refptr<CookieMonster> cookie_monster_;
+};
+
+TEST_F(SQLiteCookieReplayPerfTest, TestReplayThroughput) {
+  std::vector<ReplayOp> ops;
+  BuildTrace(&ops);
+
+  SetCookieCallback set_callback;
+  GetCookiesCallback get_callback;
+  FlushCallback flush_callback;
+
+  // Seed one cookie per domain, untimed, so the replay measures a warm store
+  // rather than a cascade of first-touch key loads.
+  int max_domain = 0;
+  for (const ReplayOp& op : ops)
+    max_domain = std::max(max_domain, op.domain);
+  for (int domain = 0; domain <= max_domain; ++domain)
+    set_callback.SetCookie(cookie_monster_.get(), ReplayURL(domain), "c0=s");
+
+  LatencyStats flush_latency;
+  int set_serial = 0;
+
+  net::test::BenchmarkReporter timer("Cookie_replay");
+  base::TimeTicks replay_start = base::TimeTicks::Now();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const ReplayOp& op = ops[i];
+    if (op.is_set) {
+      std::string cookie_line =
+          base::StringPrintf("c%d=", set_serial++ % kCookiesPerDomain) +
+          std::string(op.value_size, 'v');
+      set_callback.SetCookie(cookie_monster_.get(), ReplayURL(op.domain),
+                             cookie_line);
+    } else {
+      get_callback.GetCookies(cookie_monster_.get(), ReplayURL(op.domain));
+    }
+    if ((i + 1) % kOpsPerFlush == 0)
+      flush_latency.Add(flush_callback.TimedFlush(cookie_monster_.get()));
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - replay_start;
+  timer.SetThroughput("ops", ops.size() / elapsed.InSecondsF());
+  timer.Done();
+
+  flush_latency.Report("Cookie_replay_flush");
+}
+
+}  // namespace net
@@ -10,15 +10,19 @@
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/callback.h"
+#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/pickle.h"
 #include "base/profiler/scoped_tracker.h"
 #include "base/sequenced_task_runner.h"
+#include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
@@ -53,11 +57,14 @@ namespace net {
 //
 // SQLitePersistentCookieStore::Load is called to load all cookies.  It
 // delegates to Backend::Load, which posts a Backend::LoadAndNotifyOnDBThread
-// task to the background runner.  This task calls Backend::ChainLoadCookies(),
-// which repeatedly posts itself to the BG runner to load each eTLD+1's cookies
-// in separate tasks.  When this is complete, Backend::CompleteLoadOnIOThread is
-// posted to the client runner, which notifies the caller of
-// SQLitePersistentCookieStore::Load that the load is complete.
+// task to the background runner.  This task first tries to restore the whole
+// store in one step from the binary snapshot written during the previous
+// clean shutdown (see LoadFromSnapshot()).  If no usable snapshot exists it
+// calls Backend::ChainLoadCookies(), which repeatedly posts itself to the BG
+// runner to load each eTLD+1's cookies in separate tasks.  When this is
+// complete, Backend::CompleteLoadOnIOThread is posted to the client runner,
+// which notifies the caller of SQLitePersistentCookieStore::Load that the
+// load is complete.
 //
 // If a priority load request is invoked via SQLitePersistentCookieStore::
 // LoadCookiesForKey, it is delegated to Backend::LoadCookiesForKey, which posts
@@ -196,6 +203,27 @@ class SQLitePersistentCookieStore::Backend
   // Initialize the data base.
   bool InitializeDatabase();
 
+  // Returns the path of the binary cookie snapshot written next to the
+  // database at clean shutdown.
+  base::FilePath SnapshotPath() const;
+
+  // Attempts to load every cookie from the snapshot file written during the
+  // previous clean shutdown, bypassing the row-by-row SQLite load. The
+  // snapshot file is deleted as soon as it has been read, whether or not it
+  // was usable: it describes the database as of the last clean shutdown, so
+  // a session that ends in a crash must not leave it behind for the session
+  // after that. It is rewritten on every clean Close(). Returns true if all
+  // cookies were loaded; on false the caller falls back to
+  // ChainLoadCookies(). Only the full load uses the snapshot; priority key
+  // loads keep the per-key SQL path. A key that a priority load has already
+  // fetched is delivered a second time with the snapshot, which the
+  // CookieMonster discards as a duplicate.
+  bool LoadFromSnapshot();
+
+  // Serializes the entire cookies table to the snapshot file. Called on the
+  // background runner during Close(), after the final Commit().
+  void WriteSnapshot();
+
   // Loads cookies for the next domain key from the DB, then either reschedules
   // itself or schedules the provided callback to run on the client runner (if
   // all domains are loaded).
@@ -326,6 +354,12 @@ namespace {
 const int kCurrentVersionNumber = 9;
 const int kCompatibleVersionNumber = 5;
 
+// Magic number and format version of the binary cookie snapshot written at
+// clean shutdown. The snapshot also records the database schema version, so
+// a snapshot written before a schema migration is never trusted.
+const uint64 kSnapshotMagicNumber = 0x636f6f6b736e6170;  // "cooksnap"
+const uint32 kSnapshotFormatVersion = 1;
+
 // Possible values for the 'priority' column.
 enum DBCookiePriority {
   kCookiePriorityLow = 0,
@@ -464,6 +498,8 @@ void SQLitePersistentCookieStore::Backend::LoadAndNotifyInBackground(
   if (!InitializeDatabase()) {
     PostClientTask(FROM_HERE, base::Bind(&Backend::CompleteLoadInForeground,
                                          this, loaded_callback, false));
+  } else if (LoadFromSnapshot()) {
+    FinishedLoadingCookies(loaded_callback, true);
   } else {
     ChainLoadCookies(loaded_callback);
   }
@@ -676,6 +712,180 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
   return true;
 }
 
+base::FilePath SQLitePersistentCookieStore::Backend::SnapshotPath() const {
+  return path_.InsertBeforeExtensionASCII("-snapshot");
+}
+
+bool SQLitePersistentCookieStore::Backend::LoadFromSnapshot() {
+  DCHECK(background_task_runner_->RunsTasksOnCurrentThread());
+
+  const base::FilePath snapshot_path = SnapshotPath();
+  std::string contents;
+  bool read_ok = base::ReadFileToString(snapshot_path, &contents);
+  // The snapshot is only trusted once. Deleting it here guarantees that a
+  // session that ends in a crash cannot leave a snapshot behind that no
+  // longer matches the database; WriteSnapshot() recreates it on the next
+  // clean shutdown.
+  base::DeleteFile(snapshot_path, false);
+  if (!read_ok)
+    return false;
+
+  const base::Time start = base::Time::Now();
+
+  base::Pickle pickle(contents.data(), static_cast<int>(contents.size()));
+  base::PickleIterator it(pickle);
+  uint64 magic_number;
+  uint32 format_version;
+  int db_version;
+  int64 db_size;
+  int64 db_mtime;
+  int count;
+  if (!it.ReadUInt64(&magic_number) || !it.ReadUInt32(&format_version) ||
+      !it.ReadInt(&db_version) || !it.ReadInt64(&db_size) ||
+      !it.ReadInt64(&db_mtime) || !it.ReadInt(&count) ||
+      magic_number != kSnapshotMagicNumber ||
+      format_version != kSnapshotFormatVersion ||
+      db_version != kCurrentVersionNumber || count < 0) {
+    UMA_HISTOGRAM_BOOLEAN("Cookie.SnapshotLoadSuccess", false);
+    return false;
+  }
+
+  // The snapshot is stale if the database has been touched since it was
+  // written, whether by another program, by a schema migration, or by
+  // DeleteSessionCookiesOnStartup() during InitializeDatabase(). In all of
+  // those cases the database is the authority, so fall back to the SQL load.
+  base::File::Info db_info;
+  if (!base::GetFileInfo(path_, &db_info) || db_info.size != db_size ||
+      db_info.last_modified.ToInternalValue() != db_mtime) {
+    UMA_HISTOGRAM_BOOLEAN("Cookie.SnapshotLoadSuccess", false);
+    return false;
+  }
+
+  std::vector<CanonicalCookie*> cookies;
+  for (int i = 0; i < count; ++i) {
+    int64 creation_utc;
+    int64 expires_utc;
+    int64 last_access_utc;
+    std::string host_key, name, value, encrypted_value, path;
+    bool secure, httponly, firstpartyonly, persistent;
+    int priority;
+    if (!it.ReadInt64(&creation_utc) || !it.ReadString(&host_key) ||
+        !it.ReadString(&name) || !it.ReadString(&value) ||
+        !it.ReadString(&encrypted_value) || !it.ReadString(&path) ||
+        !it.ReadInt64(&expires_utc) || !it.ReadBool(&secure) ||
+        !it.ReadBool(&httponly) || !it.ReadBool(&firstpartyonly) ||
+        !it.ReadInt64(&last_access_utc) || !it.ReadBool(&persistent) ||
+        !it.ReadInt(&priority)) {
+      STLDeleteElements(&cookies);
+      UMA_HISTOGRAM_BOOLEAN("Cookie.SnapshotLoadSuccess", false);
+      return false;
+    }
+    // Match the SQL load: session cookies are skipped unless the store was
+    // asked to restore them. (They have also already been removed from the
+    // database itself by DeleteSessionCookiesOnStartup().)
+    if (!persistent && !restore_old_session_cookies_)
+      continue;
+    if (!encrypted_value.empty() && crypto_) {
+      if (!crypto_->DecryptString(encrypted_value, &value))
+        continue;
+    }
+    cookies.push_back(new CanonicalCookie(
+        // The "source" URL is not used with persisted cookies.
+        GURL(), name, value, host_key, path,
+        Time::FromInternalValue(creation_utc),
+        Time::FromInternalValue(expires_utc),
+        Time::FromInternalValue(last_access_utc), secure, httponly,
+        firstpartyonly, DBCookiePriorityToCookiePriority(
+                            static_cast<DBCookiePriority>(priority))));
+    ++num_cookies_read_;
+  }
+
+  {
+    base::AutoLock locked(lock_);
+    cookies_.insert(cookies_.end(), cookies.begin(), cookies.end());
+  }
+  // Every cookie is now in memory, so there is nothing left for regular or
+  // priority loads to fetch from the database.
+  keys_to_load_.clear();
+
+  UMA_HISTOGRAM_BOOLEAN("Cookie.SnapshotLoadSuccess", true);
+  UMA_HISTOGRAM_CUSTOM_TIMES("Cookie.TimeLoadSnapshot",
+                             base::Time::Now() - start,
+                             base::TimeDelta::FromMilliseconds(1),
+                             base::TimeDelta::FromMinutes(1), 50);
+  return true;
+}
+
+void SQLitePersistentCookieStore::Backend::WriteSnapshot() {
+  DCHECK(background_task_runner_->RunsTasksOnCurrentThread());
+  DCHECK(db_.get());
+
+  const base::Time start = base::Time::Now();
+
+  // The final Commit() has already run, so the database file on disk is the
+  // state the next session will see. Record its size and mtime so that
+  // LoadFromSnapshot() can tell whether anything else touched it in between.
+  base::File::Info db_info;
+  if (!base::GetFileInfo(path_, &db_info))
+    return;
+
+  sql::Statement count_smt(
+      db_->GetUniqueStatement("SELECT COUNT(*) FROM cookies"));
+  if (!count_smt.is_valid() || !count_smt.Step())
+    return;
+  const int count = count_smt.ColumnInt(0);
+
+  sql::Statement smt(db_->GetUniqueStatement(
+      "SELECT creation_utc, host_key, name, value, encrypted_value, path, "
+      "expires_utc, secure, httponly, firstpartyonly, last_access_utc, "
+      "persistent, priority FROM cookies"));
+  if (!smt.is_valid())
+    return;
+
+  base::Pickle pickle;
+  pickle.WriteUInt64(kSnapshotMagicNumber);
+  pickle.WriteUInt32(kSnapshotFormatVersion);
+  pickle.WriteInt(kCurrentVersionNumber);
+  pickle.WriteInt64(db_info.size);
+  pickle.WriteInt64(db_info.last_modified.ToInternalValue());
+  pickle.WriteInt(count);
+
+  // Serialize the raw column values, including |encrypted_value|, so that
+  // LoadFromSnapshot() applies exactly the same crypto handling as
+  // MakeCookiesFromSQLStatement().
+  int rows_written = 0;
+  while (smt.Step()) {
+    pickle.WriteInt64(smt.ColumnInt64(0));      // creation_utc
+    pickle.WriteString(smt.ColumnString(1));    // host_key
+    pickle.WriteString(smt.ColumnString(2));    // name
+    pickle.WriteString(smt.ColumnString(3));    // value
+    pickle.WriteString(smt.ColumnString(4));    // encrypted_value
+    pickle.WriteString(smt.ColumnString(5));    // path
+    pickle.WriteInt64(smt.ColumnInt64(6));      // expires_utc
+    pickle.WriteBool(smt.ColumnInt(7) != 0);    // secure
+    pickle.WriteBool(smt.ColumnInt(8) != 0);    // httponly
+    pickle.WriteBool(smt.ColumnInt(9) != 0);    // firstpartyonly
+    pickle.WriteInt64(smt.ColumnInt64(10));     // last_access_utc
+    pickle.WriteBool(smt.ColumnInt(11) != 0);   // persistent
+    pickle.WriteInt(smt.ColumnInt(12));         // priority
+    ++rows_written;
+  }
+  DCHECK_EQ(count, rows_written);
+
+  if (!base::ImportantFileWriter::WriteFileAtomically(
+          SnapshotPath(),
+          std::string(static_cast<const char*>(pickle.data()),
+                      pickle.size()))) {
+    LOG(WARNING) << "Failed to write cookie snapshot.";
+    return;
+  }
+
+  UMA_HISTOGRAM_CUSTOM_TIMES("Cookie.TimeWriteSnapshot",
+                             base::Time::Now() - start,
+                             base::TimeDelta::FromMilliseconds(1),
+                             base::TimeDelta::FromMinutes(1), 50);
+}
+
 void SQLitePersistentCookieStore::Backend::ChainLoadCookies(
     const LoadedCallback& loaded_callback) {
   DCHECK(background_task_runner_->RunsTasksOnCurrentThread());
@@ -1181,6 +1391,11 @@ void SQLitePersistentCookieStore::Backend::InternalBackgroundClose(
   // Commit any pending operations
   Commit();
 
+  // With the final mutations on disk, snapshot the cookies table so the next
+  // session can skip the row-by-row load.
+  if (db_ && initialized_ && !corruption_detected_)
+    WriteSnapshot();
+
   meta_table_.Reset();
   db_.reset();
 
@@ -13,12 +13,12 @@
 #include "base/sequenced_task_runner.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
-#include "base/test/perf_time_logger.h"
 #include "base/test/sequenced_worker_pool_owner.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_constants.h"
 #include "net/extras/sqlite/cookie_crypto_delegate.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
 
@@ -115,7 +115,7 @@ class SQLitePersistentCookieStorePerfTest : public testing::Test {
 TEST_F(SQLitePersistentCookieStorePerfTest, TestLoadForKeyPerformance) {
   for (int domain_num = 0; domain_num < 3; ++domain_num) {
     std::string domain_name(base::StringPrintf("domain_%d.com", domain_num));
-    base::PerfTimeLogger timer(
+    net::test::BenchmarkReporter timer(
         ("Load cookies for the eTLD+1 " + domain_name).c_str());
     store_->LoadCookiesForKey(
         domain_name,
@@ -130,7 +130,7 @@ TEST_F(SQLitePersistentCookieStorePerfTest, TestLoadForKeyPerformance) {
 
 // Test the performance of load
 TEST_F(SQLitePersistentCookieStorePerfTest, TestLoadPerformance) {
-  base::PerfTimeLogger timer("Load all cookies");
+  net::test::BenchmarkReporter timer("Load all cookies");
   Load();
   timer.Done();
 
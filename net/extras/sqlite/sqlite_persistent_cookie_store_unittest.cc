@@ -16,6 +16,7 @@
 #include "base/sequenced_task_runner.h"
 #include "base/stl_util.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/test/histogram_tester.h"
 #include "base/test/sequenced_worker_pool_owner.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "base/time/time.h"
@@ -275,6 +276,62 @@ TEST_F(SQLitePersistentCookieStoreTest, TestPersistance) {
   ASSERT_EQ(0U, cookies.size());
 }
 
+// Test that a clean shutdown writes a snapshot next to the database, and that
+// the next load restores the same cookies from it in one step.
+TEST_F(SQLitePersistentCookieStoreTest, TestSnapshotRoundTrip) {
+  const base::FilePath snapshot_path =
+      temp_dir_.path().Append(kCookieFilename).InsertBeforeExtensionASCII(
+          "-snapshot");
+
+  InitializeStore(false, false);
+  AddCookie("A", "B", "foo.bar", "/", base::Time::Now());
+  DestroyStore();
+  EXPECT_TRUE(base::PathExists(snapshot_path));
+
+  base::HistogramTester histograms;
+  CanonicalCookieVector cookies;
+  CreateAndLoad(false, false, &cookies);
+  ASSERT_EQ(1U, cookies.size());
+  ASSERT_STREQ("foo.bar", cookies[0]->Domain().c_str());
+  ASSERT_STREQ("A", cookies[0]->Name().c_str());
+  ASSERT_STREQ("B", cookies[0]->Value().c_str());
+  histograms.ExpectUniqueSample("Cookie.SnapshotLoadSuccess", true, 1);
+
+  // The snapshot is consumed by the load, so a crash later in this session
+  // cannot leave a stale snapshot behind for the session after that.
+  EXPECT_FALSE(base::PathExists(snapshot_path));
+  STLDeleteElements(&cookies);
+}
+
+// Test that a snapshot is ignored if the database has been modified behind
+// the store's back since the snapshot was written.
+TEST_F(SQLitePersistentCookieStoreTest, TestStaleSnapshotIgnored) {
+  const base::FilePath snapshot_path =
+      temp_dir_.path().Append(kCookieFilename).InsertBeforeExtensionASCII(
+          "-snapshot");
+
+  InitializeStore(false, false);
+  AddCookie("A", "B", "foo.bar", "/", base::Time::Now());
+  DestroyStore();
+  ASSERT_TRUE(base::PathExists(snapshot_path));
+
+  // Delete the cookie directly from the database; the snapshot no longer
+  // matches it.
+  {
+    sql::Connection db;
+    ASSERT_TRUE(db.Open(temp_dir_.path().Append(kCookieFilename)));
+    ASSERT_TRUE(db.Execute("DELETE FROM cookies"));
+    db.Close();
+  }
+
+  base::HistogramTester histograms;
+  CanonicalCookieVector cookies;
+  CreateAndLoad(false, false, &cookies);
+  EXPECT_EQ(0U, cookies.size());
+  histograms.ExpectUniqueSample("Cookie.SnapshotLoadSuccess", false, 1);
+  STLDeleteElements(&cookies);
+}
+
 TEST_F(SQLitePersistentCookieStoreTest, TestSessionCookiesDeletedOnStartup) {
   // Initialize the cookie store with 3 persistent cookies, 5 transient
   // cookies.
@@ -360,6 +417,14 @@ TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
   AddCookie("A", "B", "www.bbb.com", "/", t);
   DestroyStore();
 
+  // Remove the shutdown snapshot so that the load below takes the row-by-row
+  // path; this test exercises how chain loading interleaves with priority
+  // loads, which only happens on that path.
+  ASSERT_TRUE(base::DeleteFile(
+      temp_dir_.path().Append(kCookieFilename).InsertBeforeExtensionASCII(
+          "-snapshot"),
+      false));
+
   store_ = new SQLitePersistentCookieStore(
       temp_dir_.path().Append(kCookieFilename), client_task_runner(),
       background_task_runner(), false, nullptr);
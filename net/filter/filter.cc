@@ -52,6 +52,14 @@ const char kTextHtml[]             = "text/html";
 // Buffer size allocated when de-compressing data.
 const int kFilterBufSize = 32 * 1024;
 
+// Buffer size used instead of kFilterBufSize when the response headers
+// promise a body large enough that the extra memory is paid back in fewer
+// trips through the filter chain.
+const int kBigFilterBufSize = 256 * 1024;
+
+// Minimum reported content length before kBigFilterBufSize is used.
+const int64 kBigFilterMinContentLength = 1024 * 1024;
+
 void LogSdchProblem(const FilterContext& filter_context,
                     SdchProblemCode problem) {
   SdchManager::SdchErrorRecovery(problem);
@@ -78,6 +86,16 @@ std::string FilterTypeAsString(Filter::FilterType type_id) {
   return "";
 }
 
+// Selects the stream buffer size for |filter_context|'s filter chain.  Most
+// responses use the small buffer; bodies known from the Content-Length header
+// to be large get a bigger one, so each pass through the chain moves more
+// data.
+int BufferSizeForContext(const FilterContext& filter_context) {
+  if (filter_context.GetContentLength() >= kBigFilterMinContentLength)
+    return kBigFilterBufSize;
+  return kFilterBufSize;
+}
+
 }  // namespace
 
 FilterContext::~FilterContext() {
@@ -92,9 +110,10 @@ Filter* Filter::Factory(const std::vector<FilterType>& filter_types,
     return NULL;
 
   Filter* filter_list = NULL;  // Linked list of filters.
+  const int buffer_size = BufferSizeForContext(filter_context);
   for (size_t i = 0; i < filter_types.size(); i++) {
     filter_list = PrependNewFilter(filter_types[i], filter_context,
-                                   kFilterBufSize, filter_list);
+                                   buffer_size, filter_list);
     if (!filter_list)
       return NULL;
   }
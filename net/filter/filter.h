@@ -111,6 +111,11 @@ class NET_EXPORT_PRIVATE FilterContext {
   // Was this data flagged as a response to a request with an SDCH dictionary?
   virtual SdchManager::DictionarySet* SdchDictionariesAdvertised() const = 0;
 
+  // How large is the response body, as promised by the response headers?
+  // This is the encoded (e.g., still compressed) length.  Returns -1 if the
+  // length is not known.
+  virtual int64 GetContentLength() const = 0;
+
   // How many bytes were read from the net or cache so far (and potentially
   // pushed into a filter for processing)?
   virtual int64 GetByteReadCount() const = 0;
@@ -142,6 +142,25 @@ TEST(FilterTest, Gzip) {
   EXPECT_EQ(Filter::FILTER_TYPE_GZIP, encoding_types.front());
 }
 
+TEST(FilterTest, ContentLengthSizesBuffer) {
+  MockFilterContext filter_context;
+  std::vector<Filter::FilterType> encoding_types;
+  encoding_types.push_back(Filter::FILTER_TYPE_GZIP);
+
+  // With an unknown content length, the default buffer is used.
+  scoped_ptr<Filter> small_filter(
+      Filter::Factory(encoding_types, filter_context));
+  ASSERT_TRUE(small_filter.get());
+
+  // A body known to be large gets a bigger buffer.
+  filter_context.SetContentLength(10 * 1024 * 1024);
+  scoped_ptr<Filter> big_filter(
+      Filter::Factory(encoding_types, filter_context));
+  ASSERT_TRUE(big_filter.get());
+  EXPECT_GT(big_filter->stream_buffer_size(),
+            small_filter->stream_buffer_size());
+}
+
 // Make sure a series of three pass-through filters copies the data cleanly.
 // Regression test for http://crbug.com/418975.
 TEST(FilterTest, ThreeFilterChain) {
@@ -4,12 +4,88 @@
 
 #include "net/filter/gzip_filter.h"
 
+#include <vector>
+
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/threading/thread_local.h"
 #include "net/filter/gzip_header.h"
 #include "third_party/zlib/zlib.h"
 
 namespace net {
 
+namespace {
+
+// Maximum number of idle inflate contexts kept per thread.
+const size_t kMaxPooledStreams = 4;
+
+class ZlibStreamPool;
+
+base::LazyInstance<base::ThreadLocalPointer<ZlibStreamPool> >::Leaky
+    g_zlib_stream_pool_tls = LAZY_INSTANCE_INITIALIZER;
+
+// A per-thread pool of initialized inflate contexts.  inflateInit2 allocates
+// the inflate state and, lazily, a 32KB sliding window for every stream;
+// recycling contexts through inflateReset2 keeps those allocations alive
+// across responses.  Filters are created and destroyed on the IO thread, so
+// no locking is needed.
+class ZlibStreamPool {
+ public:
+  // Returns the pool for the calling thread, creating it on first use.  The
+  // pool is intentionally never freed; filters live on long-running IO
+  // threads.
+  static ZlibStreamPool* GetForCurrentThread() {
+    ZlibStreamPool* pool = g_zlib_stream_pool_tls.Get().Get();
+    if (!pool) {
+      pool = new ZlibStreamPool();
+      g_zlib_stream_pool_tls.Get().Set(pool);
+    }
+    return pool;
+  }
+
+  // Returns a z_stream ready to inflate with |window_bits|, recycled from the
+  // pool when possible.  Returns NULL on failure.
+  z_stream* Acquire(int window_bits) {
+    while (!streams_.empty()) {
+      z_stream* stream = streams_.back();
+      streams_.pop_back();
+      if (inflateReset2(stream, window_bits) == Z_OK)
+        return stream;
+      // The recycled context was unusable (e.g. corrupted by a stream
+      // error); dispose of it and try the next one.
+      inflateEnd(stream);
+      delete stream;
+    }
+    scoped_ptr<z_stream> stream(new z_stream);
+    memset(stream.get(), 0, sizeof(z_stream));
+    if (inflateInit2(stream.get(), window_bits) != Z_OK)
+      return NULL;
+    return stream.release();
+  }
+
+  // Takes ownership of the initialized |stream|, keeping it for reuse or
+  // freeing it if the pool is full.
+  void Release(z_stream* stream) {
+    DCHECK(stream);
+    if (streams_.size() < kMaxPooledStreams) {
+      streams_.push_back(stream);
+      return;
+    }
+    inflateEnd(stream);
+    delete stream;
+  }
+
+ private:
+  ZlibStreamPool() {}
+  ~ZlibStreamPool() {}
+
+  std::vector<z_stream*> streams_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZlibStreamPool);
+};
+
+}  // namespace
+
 GZipFilter::GZipFilter(FilterType type)
     : Filter(type),
       decoding_status_(DECODING_UNINITIALIZED),
@@ -22,7 +98,9 @@ GZipFilter::GZipFilter(FilterType type)
 
 GZipFilter::~GZipFilter() {
   if (decoding_status_ != DECODING_UNINITIALIZED) {
-    inflateEnd(zlib_stream_.get());
+    // Hand the initialized context back for reuse rather than tearing it
+    // down with inflateEnd.
+    ZlibStreamPool::GetForCurrentThread()->Release(zlib_stream_.release());
   }
 }
 
@@ -30,17 +108,13 @@ bool GZipFilter::InitDecoding(Filter::FilterType filter_type) {
   if (decoding_status_ != DECODING_UNINITIALIZED)
     return false;
 
-  // Initialize zlib control block
-  zlib_stream_.reset(new z_stream);
-  if (!zlib_stream_.get())
-    return false;
-  memset(zlib_stream_.get(), 0, sizeof(z_stream));
-
-  // Set decoding mode
+  // Set decoding mode.  Deflate responses carry a zlib-wrapped stream, gzip
+  // responses a raw DEFLATE stream behind the gzip header that this filter
+  // parses itself.
+  int window_bits = 0;
   switch (filter_type) {
     case Filter::FILTER_TYPE_DEFLATE: {
-      if (inflateInit(zlib_stream_.get()) != Z_OK)
-        return false;
+      window_bits = MAX_WBITS;
       decoding_mode_ = DECODE_MODE_DEFLATE;
       break;
     }
@@ -51,8 +125,7 @@ bool GZipFilter::InitDecoding(Filter::FilterType filter_type) {
       gzip_header_.reset(new GZipHeader());
       if (!gzip_header_.get())
         return false;
-      if (inflateInit2(zlib_stream_.get(), -MAX_WBITS) != Z_OK)
-        return false;
+      window_bits = -MAX_WBITS;
       decoding_mode_ = DECODE_MODE_GZIP;
       break;
     }
@@ -61,6 +134,12 @@ bool GZipFilter::InitDecoding(Filter::FilterType filter_type) {
     }
   }
 
+  // Get an initialized zlib control block, recycled if one is available.
+  zlib_stream_.reset(
+      ZlibStreamPool::GetForCurrentThread()->Acquire(window_bits));
+  if (!zlib_stream_.get())
+    return false;
+
   decoding_status_ = DECODING_IN_PROGRESS;
   return true;
 }
@@ -12,6 +12,7 @@ MockFilterContext::MockFilterContext()
     : is_cached_content_(false),
       ok_to_call_get_url_(true),
       response_code_(-1),
+      content_length_(-1),
       context_(new URLRequestContext()) {
 }
 
@@ -48,6 +49,8 @@ MockFilterContext::SdchDictionariesAdvertised() const {
   return dictionaries_handle_.get();
 }
 
+int64 MockFilterContext::GetContentLength() const { return content_length_; }
+
 int64 MockFilterContext::GetByteReadCount() const { return 0; }
 
 int MockFilterContext::GetResponseCode() const { return response_code_; }
@@ -27,6 +27,9 @@ class MockFilterContext : public FilterContext {
   void SetRequestTime(const base::Time time) { request_time_ = time; }
   void SetCached(bool is_cached) { is_cached_content_ = is_cached; }
   void SetResponseCode(int response_code) { response_code_ = response_code; }
+  void SetContentLength(int64 content_length) {
+    content_length_ = content_length;
+  }
   void SetSdchResponse(scoped_ptr<SdchManager::DictionarySet> handle) {
     dictionaries_handle_ = handle.Pass();
   }
@@ -54,6 +57,9 @@ class MockFilterContext : public FilterContext {
   // Handle to dictionaries advertised.
   SdchManager::DictionarySet* SdchDictionariesAdvertised() const override;
 
+  // How large is the response body, per the response headers?
+  int64 GetContentLength() const override;
+
   // How many bytes were fed to filter(s) so far?
   int64 GetByteReadCount() const override;
 
@@ -74,6 +80,7 @@ class MockFilterContext : public FilterContext {
   scoped_ptr<SdchManager::DictionarySet> dictionaries_handle_;
   bool ok_to_call_get_url_;
   int response_code_;
+  int64 content_length_;
   scoped_ptr<URLRequestContext> context_;
   BoundNetLog net_log_;
 
@@ -0,0 +1,230 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/ftp/ftp_directory_listing_incremental_parser.h"
+
+#include "base/i18n/icu_encoding_detection.h"
+#include "base/i18n/icu_string_conversions.h"
+#include "base/logging.h"
+#include "net/base/net_errors.h"
+#include "net/ftp/ftp_directory_listing_parser_ls.h"
+#include "net/ftp/ftp_directory_listing_parser_windows.h"
+#include "net/ftp/ftp_server_type_histograms.h"
+
+namespace net {
+
+namespace {
+
+// Number of complete lines to collect before attempting format detection.
+// Enough to skip over a "total n" header and any message lines some servers
+// put at the beginning of the listing.
+const size_t kFormatDetectionLines = 5;
+
+}  // namespace
+
+FtpDirectoryListingIncrementalParser::FtpDirectoryListingIncrementalParser(
+    const base::Time& current_time)
+    : current_time_(current_time),
+      format_(FORMAT_UNDETECTED),
+      received_total_line_(false),
+      entries_taken_(false) {
+}
+
+FtpDirectoryListingIncrementalParser::~FtpDirectoryListingIncrementalParser() {
+}
+
+int FtpDirectoryListingIncrementalParser::OnDataReceived(const char* data,
+                                                         size_t length) {
+  full_text_.append(data, length);
+  if (format_ == FORMAT_BUFFERED)
+    return OK;
+  buffer_.append(data, length);
+  return ProcessBuffer(false);
+}
+
+int FtpDirectoryListingIncrementalParser::OnDataEnd() {
+  int rv = OK;
+  if (format_ != FORMAT_BUFFERED)
+    rv = ProcessBuffer(true);
+  if (rv != OK)
+    return rv;
+
+  if (format_ == FORMAT_BUFFERED) {
+    // FallBackToBuffered() guarantees no entries have been taken yet, so the
+    // one-shot parser sees the listing from the beginning.
+    entries_.clear();
+    return ParseFtpDirectoryListing(full_text_, current_time_, &entries_);
+  }
+
+  if (format_ == FORMAT_LS)
+    UpdateFtpServerTypeHistograms(SERVER_LS);
+  else if (format_ == FORMAT_WINDOWS)
+    UpdateFtpServerTypeHistograms(SERVER_WINDOWS);
+  return OK;
+}
+
+void FtpDirectoryListingIncrementalParser::TakeAvailableEntries(
+    std::vector<FtpDirectoryListingEntry>* entries) {
+  if (!entries_.empty())
+    entries_taken_ = true;
+  entries->insert(entries->end(), entries_.begin(), entries_.end());
+  entries_.clear();
+}
+
+int FtpDirectoryListingIncrementalParser::ProcessBuffer(bool end_of_data) {
+  // Split complete lines in place, consuming the buffer in one pass.
+  int rv = OK;
+  size_t consumed = 0;
+  while (rv == OK) {
+    size_t newline = buffer_.find('\n', consumed);
+    if (newline == std::string::npos)
+      break;
+    size_t line_end = newline;
+    if (line_end > consumed && buffer_[line_end - 1] == '\r')
+      line_end--;
+    rv = ProcessLine(
+        base::StringPiece(buffer_.data() + consumed, line_end - consumed));
+    consumed = newline + 1;
+  }
+  buffer_.erase(0, consumed);
+  if (format_ == FORMAT_BUFFERED) {
+    // |full_text_| has everything; the line buffer is no longer needed.
+    buffer_.clear();
+    return rv;
+  }
+  if (rv != OK || !end_of_data)
+    return rv;
+
+  // Process the trailing line without a newline terminator, if any.
+  if (!buffer_.empty()) {
+    std::string line;
+    line.swap(buffer_);
+    if (line[line.size() - 1] == '\r')
+      line.resize(line.size() - 1);
+    rv = ProcessLine(line);
+    if (rv != OK)
+      return rv;
+  }
+  if (format_ == FORMAT_UNDETECTED)
+    rv = DetectFormat();
+  return rv;
+}
+
+int FtpDirectoryListingIncrementalParser::ProcessLine(
+    const base::StringPiece& line) {
+  switch (format_) {
+    case FORMAT_BUFFERED:
+      // |full_text_| already has the data.
+      return OK;
+    case FORMAT_UNDETECTED:
+      pending_raw_lines_.push_back(line.as_string());
+      if (pending_raw_lines_.size() >= kFormatDetectionLines)
+        return DetectFormat();
+      return OK;
+    case FORMAT_LS:
+    case FORMAT_WINDOWS:
+      return ParseLine(line);
+  }
+  NOTREACHED();
+  return ERR_UNEXPECTED;
+}
+
+int FtpDirectoryListingIncrementalParser::DetectFormat() {
+  if (pending_raw_lines_.empty())
+    return FallBackToBuffered();
+
+  std::vector<std::string> encodings;
+  if (!base::DetectAllEncodings(full_text_, &encodings))
+    return FallBackToBuffered();
+
+  // Use the first encoding that can decode the lines seen so far, mirroring
+  // DecodeAndParse() in ftp_directory_listing_parser.cc.
+  for (size_t i = 0; i < encodings.size(); i++) {
+    std::vector<base::string16> lines;
+    bool converted = true;
+    for (size_t j = 0; j < pending_raw_lines_.size(); j++) {
+      base::string16 line;
+      if (!base::CodepageToUTF16(pending_raw_lines_[j], encodings[i].c_str(),
+                                 base::OnStringConversionError::FAIL, &line)) {
+        converted = false;
+        break;
+      }
+      lines.push_back(line);
+    }
+    if (!converted)
+      continue;
+
+    std::vector<FtpDirectoryListingEntry> entries;
+    bool received_total_line = false;
+    if (ParseFtpDirectoryListingLs(lines, current_time_, &received_total_line,
+                                   &entries)) {
+      format_ = FORMAT_LS;
+      received_total_line_ = received_total_line;
+    } else {
+      entries.clear();
+      if (!ParseFtpDirectoryListingWindows(lines, &entries))
+        continue;
+      format_ = FORMAT_WINDOWS;
+    }
+
+    encoding_ = encodings[i];
+    pending_raw_lines_.clear();
+    return AppendEntries(entries);
+  }
+
+  // Not a line-oriented format we recognize (e.g. VMS); parse the buffered
+  // listing in one shot at the end of the data.
+  return FallBackToBuffered();
+}
+
+int FtpDirectoryListingIncrementalParser::ParseLine(
+    const base::StringPiece& line) {
+  base::string16 converted;
+  if (!base::CodepageToUTF16(line.as_string(), encoding_.c_str(),
+                             base::OnStringConversionError::FAIL, &converted)) {
+    return FallBackToBuffered();
+  }
+
+  std::vector<base::string16> lines(1, converted);
+  std::vector<FtpDirectoryListingEntry> entries;
+  bool parsed;
+  if (format_ == FORMAT_LS) {
+    parsed = ParseFtpDirectoryListingLs(lines, current_time_,
+                                        &received_total_line_, &entries);
+  } else {
+    parsed = ParseFtpDirectoryListingWindows(lines, &entries);
+  }
+  if (!parsed)
+    return FallBackToBuffered();
+  return AppendEntries(entries);
+}
+
+int FtpDirectoryListingIncrementalParser::AppendEntries(
+    const std::vector<FtpDirectoryListingEntry>& entries) {
+  for (size_t i = 0; i < entries.size(); i++) {
+    FtpDirectoryListingEntry entry = entries[i];
+    if (!base::UTF16ToCodepage(entry.name, encoding_.c_str(),
+                               base::OnStringConversionError::FAIL,
+                               &entry.raw_name)) {
+      return FallBackToBuffered();
+    }
+    entries_.push_back(entry);
+  }
+  return OK;
+}
+
+int FtpDirectoryListingIncrementalParser::FallBackToBuffered() {
+  // Entries already handed to the caller cannot be revoked, so a one-shot
+  // re-parse of the full listing is no longer an option.
+  if (entries_taken_)
+    return ERR_UNRECOGNIZED_FTP_DIRECTORY_LISTING_FORMAT;
+  format_ = FORMAT_BUFFERED;
+  encoding_.clear();
+  pending_raw_lines_.clear();
+  received_total_line_ = false;
+  entries_.clear();
+  return OK;
+}
+
+}  // namespace net
@@ -0,0 +1,109 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_FTP_FTP_DIRECTORY_LISTING_INCREMENTAL_PARSER_H_
+#define NET_FTP_FTP_DIRECTORY_LISTING_INCREMENTAL_PARSER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+#include "net/ftp/ftp_directory_listing_parser.h"
+
+namespace net {
+
+// Incremental counterpart of ParseFtpDirectoryListing. Feed it raw listing
+// data as it arrives from the server; for line-oriented listing formats
+// ("ls -l" and Windows) it detects the format and character encoding from
+// the first few complete lines and then emits entries as data comes in, so
+// a large listing does not have to be fully received before the first
+// entries are available. Line splitting is done in place on the receive
+// buffer.
+//
+// Formats that cannot be parsed line by line (e.g. VMS, which is only
+// recognizable by its footer), and streams that stop parsing mid-way, are
+// transparently buffered and re-parsed in one shot when the data ends,
+// producing the same results as the one-shot parser -- provided no entries
+// have been taken yet (see TakeAvailableEntries()).
+class NET_EXPORT_PRIVATE FtpDirectoryListingIncrementalParser {
+ public:
+  explicit FtpDirectoryListingIncrementalParser(const base::Time& current_time);
+  ~FtpDirectoryListingIncrementalParser();
+
+  // Feeds the next |length| bytes of raw listing data. Returns a network
+  // error code. On success, newly parsed entries become available via
+  // TakeAvailableEntries().
+  int OnDataReceived(const char* data, size_t length);
+
+  // Signals the end of the listing data. Returns a network error code. On
+  // success, all remaining entries become available.
+  int OnDataEnd();
+
+  // Appends the entries parsed so far to |entries| and removes them from
+  // the parser. Once any entries have been taken, the buffered re-parse
+  // fallback is no longer possible, and a later parse failure is reported
+  // as an error instead.
+  void TakeAvailableEntries(std::vector<FtpDirectoryListingEntry>* entries);
+
+ private:
+  enum Format {
+    FORMAT_UNDETECTED,  // Still collecting lines for format detection.
+    FORMAT_LS,
+    FORMAT_WINDOWS,
+    FORMAT_BUFFERED,  // Not parseable line by line; parse at end of data.
+  };
+
+  // Splits complete lines out of |buffer_| and processes them. If
+  // |end_of_data| is true, also processes the trailing partial line.
+  int ProcessBuffer(bool end_of_data);
+
+  // Processes a single raw (not yet converted to UTF-16) line.
+  int ProcessLine(const base::StringPiece& line);
+
+  // Detects the character encoding and listing format from
+  // |pending_raw_lines_|, emitting the entries they contain on success.
+  int DetectFormat();
+
+  // Converts |line| to UTF-16 and parses it with the detected format
+  // parser.
+  int ParseLine(const base::StringPiece& line);
+
+  // Fills in raw names and appends |entries| to |entries_|.
+  int AppendEntries(const std::vector<FtpDirectoryListingEntry>& entries);
+
+  // Switches to the buffered fallback, discarding incrementally parsed
+  // state. Fails if entries have already been handed to the caller.
+  int FallBackToBuffered();
+
+  const base::Time current_time_;
+
+  Format format_;
+
+  // Character encoding of the listing; empty until detected.
+  std::string encoding_;
+
+  // Raw bytes not yet split into complete lines.
+  std::string buffer_;
+
+  // All raw bytes received, kept for the buffered fallback.
+  std::string full_text_;
+
+  // Complete raw lines collected before format detection.
+  std::vector<std::string> pending_raw_lines_;
+
+  // See ParseFtpDirectoryListingLs().
+  bool received_total_line_;
+
+  std::vector<FtpDirectoryListingEntry> entries_;
+  bool entries_taken_;
+
+  DISALLOW_COPY_AND_ASSIGN(FtpDirectoryListingIncrementalParser);
+};
+
+}  // namespace net
+
+#endif  // NET_FTP_FTP_DIRECTORY_LISTING_INCREMENTAL_PARSER_H_
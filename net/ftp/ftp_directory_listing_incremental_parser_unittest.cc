@@ -0,0 +1,133 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/ftp/ftp_directory_listing_incremental_parser.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/format_macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+base::Time GetMockCurrentTime() {
+  base::Time::Exploded mock_current_time_exploded = { 0 };
+  mock_current_time_exploded.year = 1994;
+  mock_current_time_exploded.month = 11;
+  mock_current_time_exploded.day_of_month = 15;
+  mock_current_time_exploded.hour = 12;
+  mock_current_time_exploded.minute = 45;
+  return base::Time::FromLocalExploded(mock_current_time_exploded);
+}
+
+// Feeds |listing| to |parser| in chunks of |chunk_size| bytes, collecting
+// entries into |entries| after every chunk. Returns the first error, or OK.
+int FeedInChunks(const std::string& listing,
+                 size_t chunk_size,
+                 FtpDirectoryListingIncrementalParser* parser,
+                 std::vector<FtpDirectoryListingEntry>* entries) {
+  for (size_t i = 0; i < listing.size(); i += chunk_size) {
+    size_t length = std::min(chunk_size, listing.size() - i);
+    int rv = parser->OnDataReceived(listing.data() + i, length);
+    if (rv != OK)
+      return rv;
+    parser->TakeAvailableEntries(entries);
+  }
+  return OK;
+}
+
+TEST(FtpDirectoryListingIncrementalParserTest, LsEmitsEntriesIncrementally) {
+  std::string listing("total 8\n");
+  for (int i = 0; i < 8; i++) {
+    listing += base::StringPrintf(
+        "-rw-r--r-- 1 ftp ftp 528 Nov 01 2007 file%d\n", i);
+  }
+
+  FtpDirectoryListingIncrementalParser parser(GetMockCurrentTime());
+  std::vector<FtpDirectoryListingEntry> entries;
+  ASSERT_EQ(OK, FeedInChunks(listing, 7, &parser, &entries));
+
+  // Entries must become available before the end of the data.
+  EXPECT_FALSE(entries.empty());
+
+  ASSERT_EQ(OK, parser.OnDataEnd());
+  parser.TakeAvailableEntries(&entries);
+  ASSERT_EQ(8U, entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(FtpDirectoryListingEntry::FILE, entries[i].type);
+    EXPECT_EQ(base::ASCIIToUTF16(base::StringPrintf("file%" PRIuS, i)),
+              entries[i].name);
+    EXPECT_EQ(528, entries[i].size);
+  }
+}
+
+TEST(FtpDirectoryListingIncrementalParserTest, Windows) {
+  std::string listing;
+  for (int i = 0; i < 6; i++) {
+    listing += base::StringPrintf(
+        "12-07-2010  12:05AM           1024 file%d\r\n", i);
+  }
+  listing += "12-07-2010  12:05AM       <DIR>          dir\r\n";
+
+  FtpDirectoryListingIncrementalParser parser(GetMockCurrentTime());
+  std::vector<FtpDirectoryListingEntry> entries;
+  ASSERT_EQ(OK, FeedInChunks(listing, 16, &parser, &entries));
+  EXPECT_FALSE(entries.empty());
+
+  ASSERT_EQ(OK, parser.OnDataEnd());
+  parser.TakeAvailableEntries(&entries);
+  ASSERT_EQ(7U, entries.size());
+  EXPECT_EQ(FtpDirectoryListingEntry::FILE, entries[0].type);
+  EXPECT_EQ(base::ASCIIToUTF16("file0"), entries[0].name);
+  EXPECT_EQ(1024, entries[0].size);
+  EXPECT_EQ(FtpDirectoryListingEntry::DIRECTORY, entries[6].type);
+  EXPECT_EQ(base::ASCIIToUTF16("dir"), entries[6].name);
+}
+
+TEST(FtpDirectoryListingIncrementalParserTest, VmsFallsBackToBuffered) {
+  const char kListing[] =
+      "Directory SYS$SYSDEVICE:[ANONYMOUS]\n"
+      "\n"
+      "README.TXT;4 2 1-AUG-1994 12:45\n"
+      "\n"
+      "Total of 1 file, 2 blocks.\n";
+
+  FtpDirectoryListingIncrementalParser parser(GetMockCurrentTime());
+  std::vector<FtpDirectoryListingEntry> entries;
+  ASSERT_EQ(OK, FeedInChunks(kListing, 11, &parser, &entries));
+
+  // VMS listings are not parseable line by line; nothing should be emitted
+  // until the end of the data.
+  EXPECT_TRUE(entries.empty());
+
+  ASSERT_EQ(OK, parser.OnDataEnd());
+  parser.TakeAvailableEntries(&entries);
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(FtpDirectoryListingEntry::FILE, entries[0].type);
+  EXPECT_EQ(base::ASCIIToUTF16("readme.txt"), entries[0].name);
+  EXPECT_EQ(1024, entries[0].size);
+}
+
+TEST(FtpDirectoryListingIncrementalParserTest, UnrecognizedFormat) {
+  const char kListing[] = "qwerty\nasdfgh\nzxcvbn\n";
+
+  FtpDirectoryListingIncrementalParser parser(GetMockCurrentTime());
+  std::vector<FtpDirectoryListingEntry> entries;
+  ASSERT_EQ(OK, FeedInChunks(kListing, 4, &parser, &entries));
+  EXPECT_TRUE(entries.empty());
+
+  EXPECT_EQ(ERR_UNRECOGNIZED_FTP_DIRECTORY_LISTING_FORMAT,
+            parser.OnDataEnd());
+}
+
+}  // namespace
+
+}  // namespace net
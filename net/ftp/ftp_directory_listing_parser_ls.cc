@@ -125,7 +125,15 @@ bool ParseFtpDirectoryListingLs(
   // True after we have received a "total n" listing header, where n is an
   // integer. Only one such header is allowed per listing.
   bool received_total_line = false;
+  return ParseFtpDirectoryListingLs(lines, current_time, &received_total_line,
+                                    entries);
+}
 
+bool ParseFtpDirectoryListingLs(
+    const std::vector<base::string16>& lines,
+    const base::Time& current_time,
+    bool* received_total_line,
+    std::vector<FtpDirectoryListingEntry>* entries) {
   for (size_t i = 0; i < lines.size(); i++) {
     if (lines[i].empty())
       continue;
@@ -139,8 +147,8 @@ bool ParseFtpDirectoryListingLs(
     // the first non-empty line. Do not match the word exactly, because it may
     // be in different languages (at least English and German have been seen
     // in the field).
-    if (columns.size() == 2 && !received_total_line) {
-      received_total_line = true;
+    if (columns.size() == 2 && !*received_total_line) {
+      *received_total_line = true;
 
       // Some FTP servers incorrectly return a negative integer for "n". Since
       // this value is ignored anyway, just check any valid integer was
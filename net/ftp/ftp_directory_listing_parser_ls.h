@@ -24,6 +24,16 @@ NET_EXPORT_PRIVATE bool ParseFtpDirectoryListingLs(
     const base::Time& current_time,
     std::vector<FtpDirectoryListingEntry>* entries);
 
+// Same as above, but threads the "total n" header state through
+// |received_total_line| so that a listing can be parsed in multiple
+// chunks of lines. |*received_total_line| must be false for the first
+// chunk and must be carried over unchanged between chunks.
+NET_EXPORT_PRIVATE bool ParseFtpDirectoryListingLs(
+    const std::vector<base::string16>& lines,
+    const base::Time& current_time,
+    bool* received_total_line,
+    std::vector<FtpDirectoryListingEntry>* entries);
+
 }  // namespace net
 
 #endif  // NET_FTP_FTP_DIRECTORY_LISTING_PARSER_LS_H_
@@ -4,6 +4,10 @@
 
 #include "net/ftp/ftp_network_transaction.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/compiler_specific.h"
@@ -16,6 +20,8 @@
 #include "net/base/address_list.h"
 #include "net/base/connection_type_histograms.h"
 #include "net/base/escape.h"
+#include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
 #include "net/base/port_util.h"
@@ -34,6 +40,14 @@ const char kCRLF[] = "\r\n";
 
 const int kCtrlBufLen = 1024;
 
+// Size of each pooled buffer used to read ahead of the consumer on the data
+// connection, and the default cap on how much read-ahead data may be queued.
+// Keeping reads outstanding on the data socket keeps the TCP receive window
+// open on high bandwidth-delay-product links instead of stalling the
+// connection between consumer reads.
+const int kReadaheadChunkSize = 64 * 1024;
+const int kDefaultDataReadaheadLimit = 256 * 1024;
+
 // Returns true if |input| can be safely used as a part of FTP command.
 bool IsValidFTPCommandString(const std::string& input) {
   // RFC 959 only allows ASCII strings, but at least Firefox can send non-ASCII
@@ -221,7 +235,16 @@ FtpNetworkTransaction::FtpNetworkTransaction(
       data_connection_port_(0),
       socket_factory_(socket_factory),
       next_state_(STATE_NONE),
-      state_after_data_connect_complete_(STATE_NONE) {
+      state_after_data_connect_complete_(STATE_NONE),
+      readahead_callback_(
+          base::Bind(&FtpNetworkTransaction::OnReadaheadReadComplete,
+                     base::Unretained(this))),
+      readahead_queued_bytes_(0),
+      data_readahead_limit_(kDefaultDataReadaheadLimit),
+      readahead_read_pending_(false),
+      readahead_done_(false),
+      readahead_result_(OK),
+      consumer_read_pending_(false) {
 }
 
 FtpNetworkTransaction::~FtpNetworkTransaction() {
@@ -336,9 +359,17 @@ void FtpNetworkTransaction::ResetStateForRestart() {
   last_error_ = OK;
   data_connection_port_ = 0;
   ctrl_socket_.reset();
+  // Destroying the data socket cancels any in-flight read-ahead read.
   data_socket_.reset();
   next_state_ = STATE_NONE;
   state_after_data_connect_complete_ = STATE_NONE;
+  readahead_queue_.clear();
+  readahead_queued_bytes_ = 0;
+  readahead_buf_ = NULL;
+  readahead_read_pending_ = false;
+  readahead_done_ = false;
+  readahead_result_ = OK;
+  consumer_read_pending_ = false;
 }
 
 void FtpNetworkTransaction::EstablishDataConnection(State state_after_connect) {
@@ -1264,6 +1295,29 @@ int FtpNetworkTransaction::DoDataRead() {
   DCHECK(read_data_buf_.get());
   DCHECK_GT(read_data_buf_len_, 0);
 
+  // Serve data already read ahead of the consumer first.
+  if (!readahead_queue_.empty()) {
+    next_state_ = STATE_DATA_READ_COMPLETE;
+    return FillReadBufferFromQueue();
+  }
+
+  if (readahead_read_pending_) {
+    // A read-ahead is in flight; complete the consumer's read when it
+    // finishes. Don't fall through to the disconnected-socket case below:
+    // the socket may be half-closed with the final data still in flight.
+    next_state_ = STATE_DATA_READ_COMPLETE;
+    consumer_read_pending_ = true;
+    return ERR_IO_PENDING;
+  }
+
+  if (readahead_done_) {
+    // Deliver the terminal result (EOF or error) recorded by the read-ahead
+    // loop. The next read takes the disconnected-socket path below.
+    next_state_ = STATE_DATA_READ_COMPLETE;
+    readahead_done_ = false;
+    return readahead_result_;
+  }
+
   if (data_socket_ == NULL || !data_socket_->IsConnected()) {
     // If we don't destroy the data socket completely, some servers will wait
     // for us (http://crbug.com/21127). The half-closed TCP connection needs
@@ -1282,14 +1336,96 @@ int FtpNetworkTransaction::DoDataRead() {
 
   next_state_ = STATE_DATA_READ_COMPLETE;
   read_data_buf_->data()[0] = 0;
-  return data_socket_->Read(
-      read_data_buf_.get(), read_data_buf_len_, io_callback_);
+  StartReadahead();
+  if (!readahead_queue_.empty())
+    return FillReadBufferFromQueue();
+  if (readahead_done_) {
+    readahead_done_ = false;
+    return readahead_result_;
+  }
+  DCHECK(readahead_read_pending_);
+  consumer_read_pending_ = true;
+  return ERR_IO_PENDING;
 }
 
 int FtpNetworkTransaction::DoDataReadComplete(int result) {
   return result;
 }
 
+void FtpNetworkTransaction::StartReadahead() {
+  while (!readahead_read_pending_ && !readahead_done_ &&
+         data_socket_.get() && data_socket_->IsConnected() &&
+         readahead_queued_bytes_ < data_readahead_limit_) {
+    if (!readahead_buf_.get())
+      readahead_buf_ = IOBufferPool::Default()->Allocate(kReadaheadChunkSize);
+    readahead_read_pending_ = true;
+    int rv = data_socket_->Read(readahead_buf_.get(), readahead_buf_->size(),
+                                readahead_callback_);
+    if (rv == ERR_IO_PENDING)
+      return;
+    readahead_read_pending_ = false;
+    ProcessReadaheadResult(rv);
+  }
+}
+
+void FtpNetworkTransaction::ProcessReadaheadResult(int result) {
+  if (result > 0) {
+    ReadaheadChunk chunk;
+    chunk.buffer = readahead_buf_;
+    chunk.length = result;
+    readahead_queue_.push_back(chunk);
+    readahead_queued_bytes_ += result;
+  } else {
+    readahead_done_ = true;
+    readahead_result_ = result;
+  }
+  readahead_buf_ = NULL;
+}
+
+void FtpNetworkTransaction::OnReadaheadReadComplete(int result) {
+  DCHECK(readahead_read_pending_);
+  readahead_read_pending_ = false;
+  ProcessReadaheadResult(result);
+  StartReadahead();
+
+  if (!consumer_read_pending_)
+    return;
+
+  int rv;
+  if (!readahead_queue_.empty()) {
+    rv = FillReadBufferFromQueue();
+  } else {
+    DCHECK(readahead_done_);
+    readahead_done_ = false;
+    rv = readahead_result_;
+  }
+  consumer_read_pending_ = false;
+  OnIOComplete(rv);
+}
+
+int FtpNetworkTransaction::FillReadBufferFromQueue() {
+  DCHECK(!readahead_queue_.empty());
+
+  int bytes_copied = 0;
+  while (bytes_copied < read_data_buf_len_ && !readahead_queue_.empty()) {
+    ReadaheadChunk& chunk = readahead_queue_.front();
+    int to_copy = std::min(read_data_buf_len_ - bytes_copied,
+                           chunk.length - chunk.offset);
+    memcpy(read_data_buf_->data() + bytes_copied,
+           chunk.buffer->data() + chunk.offset,
+           to_copy);
+    bytes_copied += to_copy;
+    chunk.offset += to_copy;
+    readahead_queued_bytes_ -= to_copy;
+    if (chunk.offset == chunk.length)
+      readahead_queue_.pop_front();
+  }
+
+  // Consuming data may have made room for more read-ahead.
+  StartReadahead();
+  return bytes_copied;
+}
+
 // We're using a histogram as a group of counters, with one bucket for each
 // enumeration value.  We're only interested in the values of the counters.
 // Ignore the shape, average, and standard deviation of the histograms because
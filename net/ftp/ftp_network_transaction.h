@@ -5,6 +5,7 @@
 #ifndef NET_FTP_FTP_NETWORK_TRANSACTION_H_
 #define NET_FTP_FTP_NETWORK_TRANSACTION_H_
 
+#include <deque>
 #include <string>
 #include <utility>
 
@@ -48,6 +49,10 @@ class NET_EXPORT_PRIVATE FtpNetworkTransaction : public FtpTransaction {
   LoadState GetLoadState() const override;
   uint64 GetUploadProgress() const override;
 
+  // Sets the cap on how much data connection data may be buffered ahead of
+  // consumer reads. Must be called before Start().
+  void set_data_readahead_limit(int limit) { data_readahead_limit_ = limit; }
+
  private:
   FRIEND_TEST_ALL_PREFIXES(FtpNetworkTransactionTest,
                            DownloadTransactionEvilPasvUnsafeHost);
@@ -194,6 +199,25 @@ class NET_EXPORT_PRIVATE FtpNetworkTransaction : public FtpTransaction {
   int DoDataRead();
   int DoDataReadComplete(int result);
 
+  // Issues reads on the data socket until |data_readahead_limit_| bytes are
+  // queued, a read returns EOF or an error, or a read is left in flight.
+  // Reads that complete synchronously are queued in place; the consumer
+  // callback is never invoked from here.
+  void StartReadahead();
+
+  // Queues the |result| bytes read into |readahead_buf_|, or records a
+  // terminal read result (EOF or error) for delivery after the queued data
+  // has been consumed.
+  void ProcessReadaheadResult(int result);
+
+  // Completion callback for read-ahead reads. Resumes a consumer read
+  // waiting in STATE_DATA_READ_COMPLETE, if any.
+  void OnReadaheadReadComplete(int result);
+
+  // Copies queued read-ahead data into |read_data_buf_| and returns the
+  // number of bytes copied.
+  int FillReadBufferFromQueue();
+
   void RecordDataConnectionError(int result);
 
   Command command_sent_;
@@ -255,6 +279,38 @@ class NET_EXPORT_PRIVATE FtpNetworkTransaction : public FtpTransaction {
 
   // State to switch to after data connection is complete.
   State state_after_data_connect_complete_;
+
+  // A chunk of data read from the data socket ahead of the consumer.
+  // |offset| is the index of the first byte not yet handed to the consumer.
+  struct ReadaheadChunk {
+    ReadaheadChunk() : offset(0), length(0) {}
+
+    scoped_refptr<IOBufferWithSize> buffer;
+    int offset;
+    int length;
+  };
+
+  CompletionCallback readahead_callback_;
+
+  // Data read ahead of the consumer, oldest chunk first, and the number of
+  // unconsumed bytes it holds.
+  std::deque<ReadaheadChunk> readahead_queue_;
+  int readahead_queued_bytes_;
+
+  // Cap on |readahead_queued_bytes_|.
+  int data_readahead_limit_;
+
+  // Pooled buffer the in-flight read-ahead read is filling.
+  scoped_refptr<IOBufferWithSize> readahead_buf_;
+  bool readahead_read_pending_;
+
+  // Once the data socket returns EOF or an error, the result is held here
+  // until the queued data has been consumed, then handed to the consumer.
+  bool readahead_done_;
+  int readahead_result_;
+
+  // True while a consumer Read() is waiting for a read-ahead to complete.
+  bool consumer_read_pending_;
 };
 
 }  // namespace net
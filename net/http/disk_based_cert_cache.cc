@@ -20,15 +20,20 @@ namespace net {
 
 namespace {
 
-// TODO(brandonsalmon): change this number to improve performance.
-const size_t kMemoryCacheMaxSize = 30;
+// The number of certificate handles kept in the in-memory cache. Because
+// certificates are stored individually rather than per chain, this tier
+// only needs to cover the distinct leaves and intermediates seen recently;
+// intermediates in particular are shared by many sites, so a few hundred
+// entries (each a ref to an OS handle already interned process-wide) is
+// enough to serve most lookups and repeat stores without disk I/O.
+const size_t kMemoryCacheMaxSize = 256;
 
 // Used to obtain a unique cache key for a certificate in the form of
 // "cert:<hash>".
 std::string GetCacheKeyForCert(
     const X509Certificate::OSCertHandle cert_handle) {
   SHA1HashValue fingerprint =
-      X509Certificate::CalculateFingerprint(cert_handle);
+      X509Certificate::CalculateCachedFingerprint(cert_handle);
 
   return "cert:" +
          base::HexEncode(fingerprint.data, arraysize(fingerprint.data));
@@ -560,6 +565,19 @@ void DiskBasedCertCache::SetCertificate(
   DCHECK(cert_handle);
   std::string key = GetCacheKeyForCert(cert_handle);
 
+  // If the certificate is in the MRU cache, it was already read from or
+  // written to the disk cache, so the disk entry exists and the write can
+  // be answered immediately. This keeps repeat stores of the same chain
+  // (the common case, since intermediates recur across sites) off the
+  // cache thread entirely.
+  MRUCertCache::iterator mru_it = mru_cert_cache_.Get(key);
+  if (mru_it != mru_cert_cache_.end()) {
+    ++mem_cache_hits_;
+    cb.Run(key);
+    return;
+  }
+  ++mem_cache_misses_;
+
   WriteWorkerMap::iterator it = write_worker_map_.find(key);
 
   if (it == write_worker_map_.end()) {
@@ -23,6 +23,8 @@ namespace net {
 // DiskBasedCertCache is used to store and retrieve X.509 certificates from the
 // cache. Each individual certificate is stored separately from its certificate
 // chain. No more than one copy (per certificate) will be stored on disk.
+// Recently used certificates are additionally kept in a bounded in-memory
+// cache, which serves both retrievals and repeat stores without any disk I/O.
 class NET_EXPORT_PRIVATE DiskBasedCertCache {
  public:
   typedef base::Callback<void(const X509Certificate::OSCertHandle cert_handle)>
@@ -44,6 +46,10 @@ class NET_EXPORT_PRIVATE DiskBasedCertCache {
   // Stores |cert_handle| in the cache. If |cert_handle| is successfully stored,
   // |cb| will be called with the key. If |cb| is called with an empty
   // string, then |cert_handle| was not stored.
+  // If |cert_handle| is already present in the in-memory cache, |cb| is
+  // invoked synchronously and no disk write is issued; certificates only
+  // enter the in-memory cache after a successful disk read or write, so
+  // the corresponding disk entry already exists.
   void SetCertificate(const X509Certificate::OSCertHandle cert_handle,
                       const SetCallback& cb);
 
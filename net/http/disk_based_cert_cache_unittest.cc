@@ -318,14 +318,14 @@ TEST(DiskBasedCertCache, SetMultiple) {
   ASSERT_NO_FATAL_FAILURE(CheckCertCached(&backend, kCert1));
 }
 
-// Issues two requests to store a certificate in the cache
-// because the first transaction finishes before the second
-// one is issued, the first cache write is overwritten.
-TEST(DiskBasedCertCache, SetOverwrite) {
+// Issues two requests to store a certificate in the cache. Because the
+// first store completes (and populates the in-memory cache) before the
+// second one is issued, the second store is answered from memory without
+// another disk write.
+TEST(DiskBasedCertCache, SetFromMemory) {
   ScopedMockTransaction trans1(
       CreateMockTransaction(kCert1.cache_key, TEST_MODE_NORMAL));
   MockDiskCache backend;
-  backend.set_double_create_check(false);
   DiskBasedCertCache cache(&backend);
   scoped_refptr<X509Certificate> cert(
       ImportCertFromFile(GetTestCertsDirectory(), kCert1.file_name));
@@ -334,8 +334,10 @@ TEST(DiskBasedCertCache, SetOverwrite) {
 
   cache.SetCertificate(cert->os_cert_handle(), set_callback1.callback());
   set_callback1.WaitForResult();
+  EXPECT_EQ(0U, cache.mem_cache_hits_for_testing());
   cache.SetCertificate(cert->os_cert_handle(), set_callback2.callback());
   set_callback2.WaitForResult();
+  EXPECT_EQ(1U, cache.mem_cache_hits_for_testing());
 
   EXPECT_EQ(set_callback1.key(), set_callback2.key());
   ASSERT_NO_FATAL_FAILURE(CheckCertCached(&backend, kCert1));
@@ -4,6 +4,8 @@
 
 #include "net/http/http_auth_cache.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_util.h"
@@ -77,30 +79,37 @@ HttpAuthCache::HttpAuthCache() {
 HttpAuthCache::~HttpAuthCache() {
 }
 
-// Performance: O(n), where n is the number of realm entries.
+// Performance: O(k), where k is the number of realm entries for |origin|;
+// entries for other origins are not examined.
 HttpAuthCache::Entry* HttpAuthCache::Lookup(const GURL& origin,
                                             const std::string& realm,
                                             HttpAuth::Scheme scheme) {
   CheckOriginIsValid(origin);
 
+  EntryIterators* bucket = LookupOrigin(origin);
+  if (!bucket) {
+    RecordLookupPosition(0);
+    return NULL;
+  }
+
   int entries_examined = 0;
-  // Linear scan through the realm entries.
-  for (EntryList::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+  // Linear scan through this origin's realm entries.
+  for (EntryIterators::iterator it = bucket->begin(); it != bucket->end();
+       ++it) {
     ++entries_examined;
-    if (it->origin() == origin && it->realm() == realm &&
-        it->scheme() == scheme) {
-      it->last_use_time_ = base::TimeTicks::Now();
+    if ((*it)->realm() == realm && (*it)->scheme() == scheme) {
+      (*it)->last_use_time_ = base::TimeTicks::Now();
       RecordLookupPosition(entries_examined);
-      return &(*it);
+      return &(**it);
     }
   }
   RecordLookupPosition(0);
   return NULL;  // No realm entry found.
 }
 
-// Performance: O(n*m), where n is the number of realm entries, m is the number
-// of path entries per realm. Both n amd m are expected to be small; m is
-// kept small because AddPath() only keeps the shallowest entry.
+// Performance: O(k*m), where k is the number of realm entries for |origin|
+// and m is the number of path entries per realm.  m is kept small because
+// AddPath() only keeps the shallowest entry.
 HttpAuthCache::Entry* HttpAuthCache::LookupByPath(const GURL& origin,
                                                   const std::string& path) {
   HttpAuthCache::Entry* best_match = NULL;
@@ -115,14 +124,21 @@ HttpAuthCache::Entry* HttpAuthCache::LookupByPath(const GURL& origin,
   // within the protection space ...
   std::string parent_dir = GetParentDirectory(path);
 
+  EntryIterators* bucket = LookupOrigin(origin);
+  if (!bucket) {
+    RecordLookupByPathPosition(0);
+    return NULL;
+  }
+
   int entries_examined = 0;
-  // Linear scan through the realm entries.
-  for (EntryList::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+  // Linear scan through this origin's realm entries.
+  for (EntryIterators::iterator it = bucket->begin(); it != bucket->end();
+       ++it) {
     ++entries_examined;
     size_t len = 0;
-    if (it->origin() == origin && it->HasEnclosingPath(parent_dir, &len) &&
+    if ((*it)->HasEnclosingPath(parent_dir, &len) &&
         (!best_match || len > best_match_length)) {
-      best_match = &(*it);
+      best_match = &(**it);
       best_match_length = len;
       best_match_position = entries_examined;
     }
@@ -133,6 +149,28 @@ HttpAuthCache::Entry* HttpAuthCache::LookupByPath(const GURL& origin,
   return best_match;
 }
 
+void HttpAuthCache::IndexEntry(EntryList::iterator it) {
+  entries_by_origin_[it->origin().spec()].push_back(it);
+}
+
+void HttpAuthCache::UnindexEntry(EntryList::iterator it) {
+  EntriesByOrigin::iterator bucket =
+      entries_by_origin_.find(it->origin().spec());
+  DCHECK(bucket != entries_by_origin_.end());
+  EntryIterators::iterator pos =
+      std::find(bucket->second.begin(), bucket->second.end(), it);
+  DCHECK(pos != bucket->second.end());
+  bucket->second.erase(pos);
+  if (bucket->second.empty())
+    entries_by_origin_.erase(bucket);
+}
+
+HttpAuthCache::EntryIterators* HttpAuthCache::LookupOrigin(
+    const GURL& origin) {
+  EntriesByOrigin::iterator bucket = entries_by_origin_.find(origin.spec());
+  return bucket == entries_by_origin_.end() ? NULL : &bucket->second;
+}
+
 HttpAuthCache::Entry* HttpAuthCache::Add(const GURL& origin,
                                          const std::string& realm,
                                          HttpAuth::Scheme scheme,
@@ -155,6 +193,7 @@ HttpAuthCache::Entry* HttpAuthCache::Add(const GURL& origin,
           now - entries_.back().creation_time_);
       UMA_HISTOGRAM_LONG_TIMES("Net.HttpAuthCacheAddEvictedLastUse",
           now - entries_.back().last_use_time_);
+      UnindexEntry(--entries_.end());
       entries_.pop_back();
       evicted = true;
     }
@@ -166,6 +205,7 @@ HttpAuthCache::Entry* HttpAuthCache::Add(const GURL& origin,
     entry->realm_ = realm;
     entry->scheme_ = scheme;
     entry->creation_time_ = now;
+    IndexEntry(entries_.begin());
   }
   DCHECK_EQ(origin, entry->origin_);
   DCHECK_EQ(realm, entry->realm_);
@@ -241,6 +281,7 @@ bool HttpAuthCache::Remove(const GURL& origin,
     if (it->origin() == origin && it->realm() == realm &&
         it->scheme() == scheme) {
       if (credentials.Equals(it->credentials())) {
+        UnindexEntry(it);
         entries_.erase(it);
         return true;
       }
@@ -252,6 +293,7 @@ bool HttpAuthCache::Remove(const GURL& origin,
 
 void HttpAuthCache::Clear() {
   entries_.clear();
+  entries_by_origin_.clear();
 }
 
 bool HttpAuthCache::UpdateStaleChallenge(const GURL& origin,
@@ -7,7 +7,9 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
+#include "base/containers/hash_tables.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/time/time.h"
@@ -177,7 +179,22 @@ class NET_EXPORT_PRIVATE HttpAuthCache {
 
  private:
   typedef std::list<Entry> EntryList;
+  // Entries for one origin, in the same relative order as in |entries_|.
+  typedef std::vector<EntryList::iterator> EntryIterators;
+  // Maps an origin's spec to its entries so lookups only examine entries for
+  // the requested origin instead of scanning the whole cache.
+  typedef base::hash_map<std::string, EntryIterators> EntriesByOrigin;
+
+  // Index maintenance helpers; must be called whenever an entry is added to
+  // or about to be removed from |entries_|.
+  void IndexEntry(EntryList::iterator it);
+  void UnindexEntry(EntryList::iterator it);
+
+  // Returns the index bucket for |origin|, or NULL if there is none.
+  EntryIterators* LookupOrigin(const GURL& origin);
+
   EntryList entries_;
+  EntriesByOrigin entries_by_origin_;
 };
 
 // An authentication realm entry.
@@ -17,10 +17,18 @@
 namespace net {
 
 HttpBasicState::HttpBasicState(ClientSocketHandle* connection, bool using_proxy)
-    : read_buf_(new GrowableIOBuffer()),
-      connection_(connection),
+    : connection_(connection),
       using_proxy_(using_proxy),
-      request_info_(NULL) {}
+      request_info_(NULL) {
+  // Adopt the read buffer deposited by the previous stream on this
+  // connection, if there is one, so that a keep-alive chain of requests
+  // reuses a single allocation and consumes any bytes already read past the
+  // end of the previous response.
+  if (connection_.get())
+    read_buf_ = connection_->release_http_read_buf();
+  if (!read_buf_.get())
+    read_buf_ = new GrowableIOBuffer();
+}
 
 HttpBasicState::~HttpBasicState() {}
 
@@ -36,6 +44,10 @@ int HttpBasicState::Initialize(const HttpRequestInfo* request_info,
 }
 
 scoped_ptr<ClientSocketHandle> HttpBasicState::ReleaseConnection() {
+  // Deposit the read buffer with the connection so that the next stream
+  // created on this handle can adopt it. HttpStreamParser leaves any bytes
+  // it read past the end of the response at the start of the buffer.
+  connection_->set_http_read_buf(read_buf_);
   return connection_.Pass();
 }
 
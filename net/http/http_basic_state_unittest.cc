@@ -5,6 +5,7 @@
 #include "net/http/http_basic_state.h"
 
 #include "net/base/completion_callback.h"
+#include "net/base/io_buffer.h"
 #include "net/base/request_priority.h"
 #include "net/http/http_request_info.h"
 #include "net/socket/client_socket_handle.h"
@@ -35,6 +36,29 @@ TEST(HttpBasicStateTest, ReleaseConnectionWorks) {
   EXPECT_EQ(handle, released_connection.get());
 }
 
+TEST(HttpBasicStateTest, ReadBufIsCarriedOnTheConnection) {
+  ClientSocketHandle* const handle = new ClientSocketHandle;
+  HttpBasicState first_state(handle, false);
+  GrowableIOBuffer* const read_buf = first_state.read_buf().get();
+  scoped_ptr<ClientSocketHandle> released_connection(
+      first_state.ReleaseConnection());
+  const HttpBasicState second_state(released_connection.release(), false);
+  EXPECT_EQ(read_buf, second_state.read_buf().get());
+}
+
+TEST(HttpBasicStateTest, ResetDropsCarriedReadBuf) {
+  ClientSocketHandle* const handle = new ClientSocketHandle;
+  HttpBasicState first_state(handle, false);
+  GrowableIOBuffer* const read_buf = first_state.read_buf().get();
+  scoped_ptr<ClientSocketHandle> released_connection(
+      first_state.ReleaseConnection());
+  // Resetting the handle releases the socket, so the buffer no longer
+  // corresponds to a live connection and must not be reused.
+  released_connection->Reset();
+  const HttpBasicState second_state(released_connection.release(), false);
+  EXPECT_NE(read_buf, second_state.read_buf().get());
+}
+
 TEST(HttpBasicStateTest, InitializeWorks) {
   HttpBasicState state(new ClientSocketHandle(), false);
   const HttpRequestInfo request_info;
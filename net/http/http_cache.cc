@@ -41,6 +41,7 @@
 #include "net/http/http_response_headers.h"
 #include "net/http/http_response_info.h"
 #include "net/http/http_util.h"
+#include "net/quic/crypto/memory_caching_quic_server_info.h"
 #include "net/quic/crypto/quic_server_info.h"
 
 #if defined(OS_POSIX)
@@ -100,6 +101,7 @@ int HttpCache::DefaultBackend::CreateBackend(
 
 HttpCache::ActiveEntry::ActiveEntry(disk_cache::Entry* entry)
     : disk_entry(entry),
+      preread_info_len(-1),
       writer(NULL),
       will_process_pending_queue(false),
       doomed(false) {
@@ -117,10 +119,13 @@ HttpCache::ActiveEntry::~ActiveEntry() {
 // This structure keeps track of work items that are attempting to create or
 // open cache entries or the backend itself.
 struct HttpCache::PendingOp {
-  PendingOp() : disk_entry(NULL), writer(NULL) {}
+  PendingOp() : disk_entry(NULL), info_buf_len(-1), writer(NULL) {}
   ~PendingOp() {}
 
   disk_cache::Entry* disk_entry;
+  // Response info preread by OpenEntryAndReadData along with the open.
+  scoped_refptr<IOBuffer> info_buf;
+  int info_buf_len;
   scoped_ptr<disk_cache::Backend> backend;
   WorkItem* writer;
   CompletionCallback callback;  // BackendCallback.
@@ -281,6 +286,76 @@ void HttpCache::MetadataWriter::OnIOComplete(int result) {
 
 //-----------------------------------------------------------------------------
 
+// This class encapsulates a transaction whose only purpose is to revalidate a
+// stale entry in the background, while the stale response is being served to
+// the caller.  Reading the response through a cache transaction writes the
+// fresh copy to the entry; the body itself is drained and discarded.  The
+// object deletes itself when the revalidation completes.
+class HttpCache::BackgroundRevalidation {
+ public:
+  explicit BackgroundRevalidation(const HttpRequestInfo& request)
+      : request_(request), buf_(new IOBuffer(kBufSize)) {
+    // The background transaction must perform a real validation, and must not
+    // itself be served stale or spawn another revalidation.
+    request_.load_flags &= ~LOAD_SUPPORT_ASYNC_REVALIDATION;
+    request_.load_flags |= LOAD_VALIDATE_CACHE;
+  }
+
+  // Starts the revalidation.  On failure the object destroys itself.
+  void Start(HttpCache* cache, RequestPriority priority) {
+    int rv = cache->CreateTransaction(priority, &transaction_);
+    if (rv != OK)
+      return SelfDestroy();
+
+    rv = transaction_->Start(
+        &request_,
+        base::Bind(&BackgroundRevalidation::OnStartComplete,
+                   base::Unretained(this)),
+        BoundNetLog());
+    if (rv != ERR_IO_PENDING)
+      OnStartComplete(rv);
+  }
+
+ private:
+  static const int kBufSize = 32 * 1024;
+
+  void OnStartComplete(int result) {
+    if (result != OK)
+      return SelfDestroy();
+    ReadLoop();
+  }
+
+  void ReadLoop() {
+    int rv;
+    do {
+      rv = transaction_->Read(
+          buf_.get(), kBufSize,
+          base::Bind(&BackgroundRevalidation::OnReadComplete,
+                     base::Unretained(this)));
+    } while (rv > 0);
+    if (rv != ERR_IO_PENDING)
+      SelfDestroy();
+  }
+
+  void OnReadComplete(int result) {
+    if (result > 0)
+      return ReadLoop();
+    SelfDestroy();
+  }
+
+  void SelfDestroy() {
+    delete this;
+  }
+
+  scoped_ptr<HttpTransaction> transaction_;
+  HttpRequestInfo request_;
+  scoped_refptr<IOBuffer> buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundRevalidation);
+};
+
+//-----------------------------------------------------------------------------
+
 class HttpCache::QuicServerInfoFactoryAdaptor : public QuicServerInfoFactory {
  public:
   explicit QuicServerInfoFactoryAdaptor(HttpCache* http_cache)
@@ -311,6 +386,7 @@ HttpCache::HttpCache(scoped_ptr<HttpTransactionFactory> network_layer,
       building_backend_(false),
       bypass_lock_for_test_(false),
       fail_conditionalization_for_test_(false),
+      async_revalidation_enabled_(false),
       mode_(NORMAL),
       network_layer_(network_layer.Pass()),
       clock_(new base::DefaultClock()),
@@ -323,9 +399,13 @@ HttpCache::HttpCache(scoped_ptr<HttpTransactionFactory> network_layer,
     net_log_ = session->net_log();
     if (set_up_quic_server_info &&
         !session->quic_stream_factory()->has_quic_server_info_factory()) {
-      // QuicStreamFactory takes ownership of QuicServerInfoFactoryAdaptor.
+      // QuicStreamFactory takes ownership of the factory chain. The memory
+      // tier keeps hot server configs resident so 0-RTT handshake assembly
+      // does not wait on a disk cache read for repeat origins.
       session->quic_stream_factory()->set_quic_server_info_factory(
-          new QuicServerInfoFactoryAdaptor(this));
+          new MemoryCachingQuicServerInfoFactory(
+              make_scoped_ptr<QuicServerInfoFactory>(
+                  new QuicServerInfoFactoryAdaptor(this))));
     }
   }
 }
@@ -403,6 +483,16 @@ bool HttpCache::ParseResponseInfo(const char* data, int len,
   return response_info->InitFromPickle(pickle, response_truncated);
 }
 
+void HttpCache::StartBackgroundRevalidation(const HttpRequestInfo& request,
+                                            RequestPriority priority) {
+  DCHECK(async_revalidation_enabled_);
+  DCHECK_EQ(request.method, "GET");
+
+  // BackgroundRevalidation deletes itself when the revalidation completes.
+  BackgroundRevalidation* revalidation = new BackgroundRevalidation(request);
+  revalidation->Start(this, priority);
+}
+
 void HttpCache::WriteMetadata(const GURL& url,
                               RequestPriority priority,
                               base::Time expected_response_time,
@@ -744,8 +834,12 @@ int HttpCache::OpenEntry(const std::string& key, ActiveEntry** entry,
   pending_op->callback = base::Bind(&HttpCache::OnPendingOpComplete,
                                     GetWeakPtr(), pending_op);
 
-  int rv = disk_cache_->OpenEntry(key, &(pending_op->disk_entry),
-                                  pending_op->callback);
+  // Read the response info along with the open; a typical cache hit then
+  // needs a single backend round trip before the body read.
+  int rv = disk_cache_->OpenEntryAndReadData(
+      key, kResponseInfoIndex, &(pending_op->disk_entry),
+      &(pending_op->info_buf), &(pending_op->info_buf_len),
+      pending_op->callback);
   if (rv != ERR_IO_PENDING) {
     item->ClearTransaction();
     pending_op->callback.Run(rv);
@@ -1043,6 +1137,10 @@ void HttpCache::OnIOComplete(int result, PendingOp* pending_op) {
     } else if (item->IsValid()) {
       key = pending_op->disk_entry->GetKey();
       entry = ActivateEntry(pending_op->disk_entry);
+      if (op == WI_OPEN_ENTRY && pending_op->info_buf.get()) {
+        entry->preread_info_buf = pending_op->info_buf;
+        entry->preread_info_len = pending_op->info_buf_len;
+      }
     } else {
       // The writer transaction is gone.
       if (op == WI_CREATE_ENTRY)
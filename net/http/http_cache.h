@@ -21,6 +21,7 @@
 #include "base/basictypes.h"
 #include "base/containers/hash_tables.h"
 #include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/threading/non_thread_safe.h"
@@ -212,6 +213,18 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     fail_conditionalization_for_test_ = true;
   }
 
+  // When enabled, a transaction that serves a stale response under the
+  // stale-while-revalidate directive also starts a background transaction
+  // that revalidates the entry in place, so subsequent requests see a fresh
+  // copy. When disabled (the default), the embedder is expected to act on
+  // HttpResponseInfo::async_revalidation_required itself.
+  void set_async_revalidation_enabled(bool enabled) {
+    async_revalidation_enabled_ = enabled;
+  }
+  bool async_revalidation_enabled() const {
+    return async_revalidation_enabled_;
+  }
+
   // HttpTransactionFactory implementation:
   int CreateTransaction(RequestPriority priority,
                         scoped_ptr<HttpTransaction>* trans) override;
@@ -241,6 +254,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     kNumCacheEntryDataIndices
   };
 
+  class BackgroundRevalidation;
   class MetadataWriter;
   class QuicServerInfoFactoryAdaptor;
   class Transaction;
@@ -257,6 +271,11 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     ~ActiveEntry();
 
     disk_cache::Entry* disk_entry;
+    // Response info (stream kResponseInfoIndex) preread by the compound
+    // open-and-read backend call; lets transactions skip the separate
+    // backend read. Invalidated whenever the info stream is rewritten.
+    scoped_refptr<IOBuffer> preread_info_buf;
+    int                preread_info_len;
     Transaction*       writer;
     TransactionList    readers;
     TransactionList    pending_queue;
@@ -381,6 +400,12 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // Resumes processing the pending list of |entry|.
   void ProcessPendingQueue(ActiveEntry* entry);
 
+  // Starts a detached transaction that revalidates the entry for |request|
+  // and updates it in place.  Called by a transaction that served a stale
+  // response under stale-while-revalidate.
+  void StartBackgroundRevalidation(const HttpRequestInfo& request,
+                                   RequestPriority priority);
+
   // Events (called via PostTask) ---------------------------------------------
 
   void OnProcessPendingQueue(ActiveEntry* entry);
@@ -412,6 +437,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   bool building_backend_;
   bool bypass_lock_for_test_;
   bool fail_conditionalization_for_test_;
+  bool async_revalidation_enabled_;
 
   Mode mode_;
 
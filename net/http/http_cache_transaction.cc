@@ -80,7 +80,7 @@ class SharedChainData : public base::RefCounted<SharedChainData> {
 // from the disk.
 std::string GetCacheKeyForCert(X509Certificate::OSCertHandle cert_handle) {
   SHA1HashValue fingerprint =
-      X509Certificate::CalculateFingerprint(cert_handle);
+      X509Certificate::CalculateCachedFingerprint(cert_handle);
 
   return "cert:" +
          base::HexEncode(fingerprint.data, arraysize(fingerprint.data));
@@ -1260,9 +1260,18 @@ int HttpCache::Transaction::DoCacheReadResponse() {
   next_state_ = STATE_CACHE_READ_RESPONSE_COMPLETE;
 
   io_buf_len_ = entry_->disk_entry->GetDataSize(kResponseInfoIndex);
-  read_buf_ = new IOBuffer(io_buf_len_);
 
   net_log_.BeginEvent(NetLog::TYPE_HTTP_CACHE_READ_INFO);
+
+  // Use the response info preread along with the open, as long as nothing
+  // rewrote the info stream since then.
+  if (entry_->preread_info_buf.get() &&
+      entry_->preread_info_len == io_buf_len_) {
+    read_buf_ = entry_->preread_info_buf;
+    return io_buf_len_;
+  }
+
+  read_buf_ = new IOBuffer(io_buf_len_);
   return entry_->disk_entry->ReadData(kResponseInfoIndex, 0, read_buf_.get(),
                                       io_buf_len_, io_callback_);
 }
@@ -2132,7 +2141,13 @@ int HttpCache::Transaction::BeginCacheValidation() {
       required_validation == VALIDATION_ASYNCHRONOUS) {
     DCHECK_EQ(request_->method, "GET");
     skip_validation = true;
-    response_.async_revalidation_required = true;
+    if (cache_->async_revalidation_enabled()) {
+      // The cache revalidates the entry itself, in parallel with serving the
+      // stale response, so the embedder does not need to be told.
+      cache_->StartBackgroundRevalidation(*request_, priority_);
+    } else {
+      response_.async_revalidation_required = true;
+    }
   }
 
   if (request_->method == "HEAD" &&
@@ -2676,6 +2691,11 @@ int HttpCache::Transaction::WriteResponseInfoToEntry(bool truncated) {
   data->Done();
 
   io_buf_len_ = data->pickle()->size();
+
+  // The preread copy of the info is about to go stale.
+  entry_->preread_info_buf = NULL;
+  entry_->preread_info_len = -1;
+
   return entry_->disk_entry->WriteData(kResponseInfoIndex, 0, data.get(),
                                        io_buf_len_, io_callback_, true);
 }
@@ -2867,8 +2887,40 @@ void HttpCache::Transaction::UpdateTransactionPattern(
   transaction_pattern_ = new_transaction_pattern;
 }
 
+void HttpCache::Transaction::RecordPatternInSessionCounters() {
+  if (!cache_.get())
+    return;
+  HttpNetworkSession* session = cache_->GetSession();
+  if (!session)
+    return;
+
+  HttpSessionCounters::CounterId counter;
+  switch (transaction_pattern_) {
+    case PATTERN_ENTRY_USED:
+      counter = HttpSessionCounters::CACHE_ENTRY_USED;
+      break;
+    case PATTERN_ENTRY_VALIDATED:
+      counter = HttpSessionCounters::CACHE_ENTRY_VALIDATED;
+      break;
+    case PATTERN_ENTRY_UPDATED:
+      counter = HttpSessionCounters::CACHE_ENTRY_UPDATED;
+      break;
+    case PATTERN_ENTRY_NOT_CACHED:
+      counter = HttpSessionCounters::CACHE_ENTRY_NOT_CACHED;
+      break;
+    case PATTERN_ENTRY_CANT_CONDITIONALIZE:
+      counter = HttpSessionCounters::CACHE_ENTRY_CANT_CONDITIONALIZE;
+      break;
+    default:
+      counter = HttpSessionCounters::CACHE_NOT_COVERED;
+      break;
+  }
+  session->counters()->Increment(counter);
+}
+
 void HttpCache::Transaction::RecordHistograms() {
   DCHECK_NE(PATTERN_UNDEFINED, transaction_pattern_);
+  RecordPatternInSessionCounters();
   if (!cache_.get() || !cache_->GetCurrentBackend() ||
       cache_->GetCurrentBackend()->GetCacheType() != DISK_CACHE ||
       cache_->mode() != NORMAL || request_->method != "GET") {
@@ -428,6 +428,10 @@ class HttpCache::Transaction : public HttpTransaction {
   void UpdateTransactionPattern(TransactionPattern new_transaction_pattern);
   void RecordHistograms();
 
+  // Bumps the cache outcome counter matching |transaction_pattern_| in the
+  // network session's hot path counters, if a session is reachable.
+  void RecordPatternInSessionCounters();
+
   // Called to signal completion of asynchronous IO.
   void OnIOComplete(int result);
 
@@ -7528,6 +7528,39 @@ TEST(HttpCache, StaleContentUsedWhenLoadFlagSetAndUsable) {
   EXPECT_TRUE(response_info.async_revalidation_required);
 }
 
+TEST(HttpCache, StaleContentUsedAndRevalidatedInBackground) {
+  MockHttpCache cache;
+  cache.http_cache()->set_async_revalidation_enabled(true);
+
+  ScopedMockTransaction stale_while_revalidate_transaction(
+      kSimpleGET_Transaction);
+  stale_while_revalidate_transaction.load_flags |=
+      LOAD_SUPPORT_ASYNC_REVALIDATION;
+  stale_while_revalidate_transaction.response_headers =
+      "Last-Modified: Sat, 18 Apr 2007 01:10:43 GMT\n"
+      "Age: 10801\n"
+      "Cache-Control: max-age=0,stale-while-revalidate=86400\n";
+
+  // Write to the cache.
+  RunTransactionTest(cache.http_cache(), stale_while_revalidate_transaction);
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+
+  // Send the request again.  The stale response is served directly from the
+  // cache, and since the cache executes the revalidation itself, the
+  // embedder-facing flag is not set.
+  HttpResponseInfo response_info;
+  RunTransactionTestWithResponseInfo(
+      cache.http_cache(), stale_while_revalidate_transaction, &response_info);
+
+  EXPECT_TRUE(response_info.was_cached);
+  EXPECT_FALSE(response_info.async_revalidation_required);
+
+  // Let the background revalidation hit the network.
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+}
+
 TEST(HttpCache, StaleContentNotUsedWhenUnusable) {
   MockHttpCache cache;
 
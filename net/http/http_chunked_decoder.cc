@@ -44,6 +44,8 @@
 
 #include "net/http/http_chunked_decoder.h"
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "base/logging.h"
@@ -67,12 +69,45 @@ HttpChunkedDecoder::HttpChunkedDecoder()
 }
 
 int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
+  chunk_spans_.clear();
+  int result = FilterBuf(buf, buf_len, &chunk_spans_);
+  if (result < 0)
+    return result;
+
+  // Compact the payload spans to the front of |buf|.  Each byte is moved at
+  // most once, unlike the old code which shifted the whole remaining tail
+  // for every chunk marker encountered.
+  char* out = buf;
+  for (size_t i = 0; i < chunk_spans_.size(); ++i) {
+    const base::StringPiece& span = chunk_spans_[i];
+    if (span.data() != out)
+      memmove(out, span.data(), span.size());
+    out += span.size();
+  }
+  DCHECK_EQ(result, static_cast<int>(out - buf));
+
+  return result;
+}
+
+int HttpChunkedDecoder::FilterBuf(char* buf,
+                                  int buf_len,
+                                  std::vector<base::StringPiece>* chunk_spans) {
   int result = 0;
 
   while (buf_len) {
     if (chunk_remaining_) {
       int num = std::min(chunk_remaining_, buf_len);
 
+      // Merge with the previous span when the payload is adjacent to it.
+      if (!chunk_spans->empty() &&
+          chunk_spans->back().data() + chunk_spans->back().size() == buf) {
+        chunk_spans->back() =
+            base::StringPiece(chunk_spans->back().data(),
+                              chunk_spans->back().size() + num);
+      } else {
+        chunk_spans->push_back(base::StringPiece(buf, num));
+      }
+
       buf_len -= num;
       chunk_remaining_ -= num;
 
@@ -92,9 +127,8 @@ int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
     if (bytes_consumed < 0)
       return bytes_consumed; // Error
 
+    buf += bytes_consumed;
     buf_len -= bytes_consumed;
-    if (buf_len)
-      memmove(buf, buf + bytes_consumed, buf_len);
   }
 
   return result;
@@ -106,8 +140,10 @@ int HttpChunkedDecoder::ScanForChunkRemaining(const char* buf, int buf_len) {
 
   int bytes_consumed = 0;
 
-  size_t index_of_lf = base::StringPiece(buf, buf_len).find('\n');
-  if (index_of_lf != base::StringPiece::npos) {
+  // memchr is vectorized in common libc implementations.
+  const void* lf = memchr(buf, '\n', buf_len);
+  if (lf) {
+    size_t index_of_lf = static_cast<const char*>(lf) - buf;
     buf_len = static_cast<int>(index_of_lf);
     if (buf_len && buf[buf_len - 1] == '\r')  // Eliminate a preceding CR.
       buf_len--;
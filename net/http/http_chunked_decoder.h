@@ -46,7 +46,9 @@
 #define NET_HTTP_HTTP_CHUNKED_DECODER_H_
 
 #include <string>
+#include <vector>
 
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 
 namespace net {
@@ -96,6 +98,15 @@ class NET_EXPORT_PRIVATE HttpChunkedDecoder {
   // was encountered.
   int FilterBuf(char* buf, int buf_len);
 
+  // Zero-copy variant of the above: instead of compacting |buf| in place,
+  // appends views of the chunk payloads within |buf| to |*chunk_spans|
+  // (adjacent payloads are merged).  |buf| is not modified; the spans are
+  // only valid while |buf| is.  The return value is the total number of
+  // payload bytes, i.e. the sum of the span lengths.
+  int FilterBuf(char* buf,
+                int buf_len,
+                std::vector<base::StringPiece>* chunk_spans);
+
  private:
   // Scans |buf| for the next chunk delimiter.  This method returns the number
   // of bytes consumed from |buf|.  If found, |chunk_remaining_| holds the
@@ -124,6 +135,10 @@ class NET_EXPORT_PRIVATE HttpChunkedDecoder {
 
   // The number of extraneous unfiltered bytes after the final CRLF.
   int bytes_after_eof_;
+
+  // Scratch space for the in-place FilterBuf(), reused across calls to avoid
+  // reallocating.
+  std::vector<base::StringPiece> chunk_spans_;
 };
 
 }  // namespace net
@@ -64,6 +64,42 @@ TEST(HttpChunkedDecoderTest, Basic) {
   RunTest(inputs, arraysize(inputs), "hello hello", true, 0);
 }
 
+TEST(HttpChunkedDecoderTest, FilterBufSpans) {
+  HttpChunkedDecoder decoder;
+  std::string input("5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n");
+  const std::string original = input;
+
+  std::vector<base::StringPiece> spans;
+  int n = decoder.FilterBuf(&input[0], static_cast<int>(input.size()), &spans);
+  EXPECT_EQ(11, n);
+  ASSERT_EQ(2u, spans.size());
+  EXPECT_EQ("hello", spans[0]);
+  EXPECT_EQ(" world", spans[1]);
+  EXPECT_TRUE(decoder.reached_eof());
+
+  // The zero-copy mode must not modify the input buffer.
+  EXPECT_EQ(original, input);
+}
+
+TEST(HttpChunkedDecoderTest, FilterBufSpansIncremental) {
+  HttpChunkedDecoder decoder;
+  std::vector<base::StringPiece> spans;
+
+  std::string input1("5\r\nhel");
+  EXPECT_EQ(3, decoder.FilterBuf(&input1[0], static_cast<int>(input1.size()),
+                                 &spans));
+  ASSERT_EQ(1u, spans.size());
+  EXPECT_EQ("hel", spans[0]);
+
+  std::string input2("lo\r\n0\r\n\r\n");
+  spans.clear();
+  EXPECT_EQ(2, decoder.FilterBuf(&input2[0], static_cast<int>(input2.size()),
+                                 &spans));
+  ASSERT_EQ(1u, spans.size());
+  EXPECT_EQ("lo", spans[0]);
+  EXPECT_TRUE(decoder.reached_eof());
+}
+
 TEST(HttpChunkedDecoderTest, OneChunk) {
   const char* const inputs[] = {
     "5\r\nhello\r\n"
@@ -15,6 +15,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/values.h"
+#include "net/base/net_allocation_tracker.h"
 #include "net/http/http_auth_handler_factory.h"
 #include "net/http/http_response_body_drainer.h"
 #include "net/http/http_stream_factory_impl.h"
@@ -125,6 +126,7 @@ HttpNetworkSession::Params::Params()
       quic_close_sessions_on_ip_change(false),
       quic_idle_connection_timeout_seconds(kIdleConnectionTimeoutSeconds),
       quic_disable_preconnect_if_0rtt(false),
+      enable_speculative_preconnect(false),
       proxy_delegate(NULL) {
   quic_supported_versions.push_back(QUIC_VERSION_25);
 }
@@ -196,6 +198,8 @@ HttpNetworkSession::HttpNetworkSession(const Params& params)
   DCHECK(ssl_config_service_.get());
   CHECK(http_server_properties_);
 
+  spdy_session_pool_.set_session_counters(&counters_);
+
   const std::string ssl_session_cache_shard =
       "http_network_session/" + base::IntToString(g_next_shard_id.GetNext());
   normal_socket_pool_manager_.reset(CreateSocketPoolManager(
@@ -315,6 +319,14 @@ scoped_ptr<base::Value> HttpNetworkSession::QuicInfoToValue() const {
   return dict.Pass();
 }
 
+scoped_ptr<base::Value> HttpNetworkSession::CountersToValue() const {
+  scoped_ptr<base::Value> counters(counters_.ToValue());
+  base::DictionaryValue* dict;
+  if (counters->GetAsDictionary(&dict))
+    dict->Set("allocations", NetAllocationTracker::ToValue());
+  return counters.Pass();
+}
+
 void HttpNetworkSession::CloseAllConnections() {
   normal_socket_pool_manager_->FlushSocketPoolsWithError(ERR_ABORTED);
   websocket_socket_pool_manager_->FlushSocketPoolsWithError(ERR_ABORTED);
@@ -17,7 +17,9 @@
 #include "net/base/net_export.h"
 #include "net/dns/host_resolver.h"
 #include "net/http/http_auth_cache.h"
+#include "net/http/http_session_counters.h"
 #include "net/http/http_stream_factory.h"
+#include "net/http/http_stream_preconnect_predictor.h"
 #include "net/quic/quic_stream_factory.h"
 #include "net/socket/next_proto.h"
 #include "net/spdy/spdy_session_pool.h"
@@ -176,6 +178,9 @@ class NET_EXPORT HttpNetworkSession
     int quic_idle_connection_timeout_seconds;
     // If true, disable preconnections if QUIC can do 0RTT.
     bool quic_disable_preconnect_if_0rtt;
+    // If true, learn per-origin connect latency and request arrival patterns
+    // and speculatively warm sockets for origins predicted to be used.
+    bool enable_speculative_preconnect;
     ProxyDelegate* proxy_delegate;
   };
 
@@ -229,9 +234,14 @@ class NET_EXPORT HttpNetworkSession
   HttpStreamFactory* http_stream_factory_for_websocket() {
     return http_stream_factory_for_websocket_.get();
   }
+  HttpStreamPreconnectPredictor* preconnect_predictor() {
+    return &preconnect_predictor_;
+  }
   NetLog* net_log() {
     return net_log_;
   }
+  HttpSessionCounters* counters() { return &counters_; }
+  const HttpSessionCounters* counters() const { return &counters_; }
 
   // Creates a Value summary of the state of the socket pools.
   scoped_ptr<base::Value> SocketPoolInfoToValue() const;
@@ -243,6 +253,9 @@ class NET_EXPORT HttpNetworkSession
   // configuration.
   scoped_ptr<base::Value> QuicInfoToValue() const;
 
+  // Creates a Value dictionary of the always-on hot path counters.
+  scoped_ptr<base::Value> CountersToValue() const;
+
   void CloseAllConnections();
   void CloseIdleConnections();
 
@@ -276,6 +289,9 @@ class NET_EXPORT HttpNetworkSession
   ProxyService* proxy_service_;
   const scoped_refptr<SSLConfigService> ssl_config_service_;
 
+  // Must outlive the pools and factories below, which keep pointers to it.
+  HttpSessionCounters counters_;
+
   HttpAuthCache http_auth_cache_;
   SSLClientAuthCache ssl_client_auth_cache_;
   scoped_ptr<ClientSocketPoolManager> normal_socket_pool_manager_;
@@ -284,6 +300,7 @@ class NET_EXPORT HttpNetworkSession
   SpdySessionPool spdy_session_pool_;
   scoped_ptr<HttpStreamFactory> http_stream_factory_;
   scoped_ptr<HttpStreamFactory> http_stream_factory_for_websocket_;
+  HttpStreamPreconnectPredictor preconnect_predictor_;
   std::set<HttpResponseBodyDrainer*> response_drainers_;
 
   NextProtoVector next_protos_;
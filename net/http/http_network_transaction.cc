@@ -151,6 +151,7 @@ HttpNetworkTransaction::HttpNetworkTransaction(RequestPriority priority,
       read_buf_len_(0),
       total_received_bytes_(0),
       total_sent_bytes_(0),
+      protocol_negotiated_(kProtoUnknown),
       next_state_(STATE_NONE),
       establishing_tunnel_(false),
       websocket_handshake_stream_base_create_helper_(NULL),
@@ -162,6 +163,7 @@ HttpNetworkTransaction::HttpNetworkTransaction(RequestPriority priority,
 }
 
 HttpNetworkTransaction::~HttpNetworkTransaction() {
+  RecordBytesInSessionCounters();
   if (stream_.get()) {
     // TODO(mbelshe): The stream_ should be able to compute whether or not the
     //                stream should be kept alive.  No reason to compute here
@@ -296,7 +298,8 @@ void HttpNetworkTransaction::PrepareForAuthRestart(HttpAuth::Target target) {
     // it first.
     if (!stream_->IsResponseBodyComplete()) {
       next_state_ = STATE_DRAIN_BODY_FOR_AUTH_RESTART;
-      read_buf_ = new IOBuffer(kDrainBodyBufferSize);  // A bit bucket.
+      // A bit bucket, carved from the arena since it dies with us.
+      read_buf_ = new WrappedIOBuffer(arena_.Alloc(kDrainBodyBufferSize));
       read_buf_len_ = kDrainBodyBufferSize;
       return;
     }
@@ -514,6 +517,10 @@ void HttpNetworkTransaction::OnStreamReady(const SSLConfig& used_ssl_config,
   stream_.reset(stream);
   server_ssl_config_ = used_ssl_config;
   proxy_info_ = used_proxy_info;
+  protocol_negotiated_ = stream_request_->protocol_negotiated();
+  session_->counters()->Increment(stream_->IsConnectionReused()
+                                      ? HttpSessionCounters::SOCKET_REUSED
+                                      : HttpSessionCounters::SOCKET_CREATED);
   response_.was_npn_negotiated = stream_request_->was_npn_negotiated();
   response_.npn_negotiated_protocol = SSLClientSocket::NextProtoToString(
       stream_request_->protocol_negotiated());
@@ -1486,6 +1493,28 @@ void HttpNetworkTransaction::CacheNetErrorDetailsAndResetStream() {
   stream_.reset();
 }
 
+void HttpNetworkTransaction::RecordBytesInSessionCounters() {
+  int64_t sent = GetTotalSentBytes();
+  int64_t received = GetTotalReceivedBytes();
+  if (sent == 0 && received == 0)
+    return;
+
+  HttpSessionCounters::CounterId sent_counter;
+  HttpSessionCounters::CounterId received_counter;
+  if (protocol_negotiated_ == kProtoQUIC1SPDY3) {
+    sent_counter = HttpSessionCounters::BYTES_SENT_QUIC;
+    received_counter = HttpSessionCounters::BYTES_RECEIVED_QUIC;
+  } else if (NextProtoIsSPDY(protocol_negotiated_)) {
+    sent_counter = HttpSessionCounters::BYTES_SENT_SPDY;
+    received_counter = HttpSessionCounters::BYTES_RECEIVED_SPDY;
+  } else {
+    sent_counter = HttpSessionCounters::BYTES_SENT_HTTP;
+    received_counter = HttpSessionCounters::BYTES_RECEIVED_HTTP;
+  }
+  session_->counters()->Add(sent_counter, sent);
+  session_->counters()->Add(received_counter, received);
+}
+
 void HttpNetworkTransaction::RecordSSLFallbackMetrics(int result) {
   if (result != OK && result != ERR_SSL_INAPPROPRIATE_FALLBACK)
     return;
@@ -21,6 +21,7 @@
 #include "net/http/http_response_info.h"
 #include "net/http/http_stream_factory.h"
 #include "net/http/http_transaction.h"
+#include "net/http/http_transaction_arena.h"
 #include "net/log/net_log.h"
 #include "net/proxy/proxy_service.h"
 #include "net/socket/connection_attempts.h"
@@ -256,6 +257,10 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
   // Records metrics relating to SSL fallbacks.
   void RecordSSLFallbackMetrics(int result);
 
+  // Attributes this transaction's wire bytes to a protocol in the session's
+  // hot path counters.  Called once, from the destructor.
+  void RecordBytesInSessionCounters();
+
   // Returns true if we should try to add a Proxy-Authorization header
   bool ShouldApplyProxyAuth() const;
 
@@ -325,6 +330,11 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
 
   HttpRequestHeaders request_headers_;
 
+  // Backs scratch allocations that live exactly as long as this
+  // transaction, such as the body-drain bit bucket.  Declared before
+  // |read_buf_| and |stream_| so it outlives anything pointing into it.
+  HttpTransactionArena arena_;
+
   // The size in bytes of the buffer we use to drain the response body that
   // we want to throw away.  The response body is typically a small error
   // page just a few hundred bytes long.
@@ -342,6 +352,10 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
   // transaction.
   int64_t total_sent_bytes_;
 
+  // The protocol negotiated for the most recent stream, used to attribute
+  // this transaction's bytes to a protocol in the session counters.
+  NextProto protocol_negotiated_;
+
   // When the transaction started / finished sending the request, including
   // the body, if present.
   base::TimeTicks send_start_time_;
@@ -244,6 +244,12 @@ void HttpProxyClientSocketPool::CancelRequest(
   base_.CancelRequest(group_name, handle);
 }
 
+void HttpProxyClientSocketPool::SetPriority(const std::string& group_name,
+                                            ClientSocketHandle* handle,
+                                            RequestPriority priority) {
+  base_.SetPriority(group_name, handle, priority);
+}
+
 void HttpProxyClientSocketPool::ReleaseSocket(const std::string& group_name,
                                               scoped_ptr<StreamSocket> socket,
                                               int id) {
@@ -22,6 +22,7 @@
 #include "base/time/time.h"
 #include "base/values.h"
 #include "net/base/escape.h"
+#include "net/base/net_allocation_tracker.h"
 #include "net/http/http_byte_range.h"
 #include "net/http/http_log_util.h"
 #include "net/http/http_util.h"
@@ -134,6 +135,7 @@ struct HttpResponseHeaders::ParsedHeader {
 
 HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
     : response_code_(-1) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_RESPONSE_HEADERS);
   Parse(raw_input);
 
   // The most important thing to do with this histogram is find out
@@ -157,6 +159,7 @@ HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
 
 HttpResponseHeaders::HttpResponseHeaders(base::PickleIterator* iter)
     : response_code_(-1) {
+  NET_TRACK_ALLOCATION(ALLOC_SITE_RESPONSE_HEADERS);
   std::string raw_input;
   if (iter->ReadString(&raw_input))
     Parse(raw_input);
@@ -407,6 +410,7 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
 
     DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
     DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 1]);
+    BuildNameIndex();
     return;
   }
 
@@ -438,6 +442,19 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
 
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 1]);
+
+  BuildNameIndex();
+}
+
+void HttpResponseHeaders::BuildNameIndex() {
+  name_index_.clear();
+  for (size_t i = 0; i < parsed_.size(); ++i) {
+    if (parsed_[i].is_continuation())
+      continue;
+    std::string name = base::ToLowerASCII(
+        base::StringPiece(parsed_[i].name_begin, parsed_[i].name_end));
+    name_index_.insert(std::make_pair(name, i));  // Keeps the first index.
+  }
 }
 
 // Append all of our headers to the final output string.
@@ -597,12 +614,38 @@ bool HttpResponseHeaders::EnumerateHeader(void** iter,
   return true;
 }
 
+bool HttpResponseHeaders::EnumerateHeader(void** iter,
+                                          const base::StringPiece& name,
+                                          base::StringPiece* value) const {
+  size_t i;
+  if (!iter || !*iter) {
+    i = FindHeader(0, name);
+  } else {
+    i = reinterpret_cast<size_t>(*iter);
+    if (i >= parsed_.size()) {
+      i = std::string::npos;
+    } else if (!parsed_[i].is_continuation()) {
+      i = FindHeader(i, name);
+    }
+  }
+
+  if (i == std::string::npos) {
+    *value = base::StringPiece();
+    return false;
+  }
+
+  if (iter)
+    *iter = reinterpret_cast<void*>(i + 1);
+  *value = base::StringPiece(parsed_[i].value_begin, parsed_[i].value_end);
+  return true;
+}
+
 bool HttpResponseHeaders::HasHeaderValue(const base::StringPiece& name,
                                          const base::StringPiece& value) const {
   // The value has to be an exact match.  This is important since
   // 'cache-control: no-cache' != 'cache-control: no-cache="foo"'
   void* iter = NULL;
-  std::string temp;
+  base::StringPiece temp;
   while (EnumerateHeader(&iter, name, &temp)) {
     if (base::EqualsCaseInsensitiveASCII(value, temp))
       return true;
@@ -739,6 +782,14 @@ void HttpResponseHeaders::ParseStatusLine(
 
 size_t HttpResponseHeaders::FindHeader(size_t from,
                                        const base::StringPiece& search) const {
+  // Searches from the beginning can be answered from the name index without
+  // scanning parsed_.
+  if (from == 0) {
+    base::hash_map<std::string, size_t>::const_iterator it =
+        name_index_.find(base::ToLowerASCII(search));
+    return it == name_index_.end() ? std::string::npos : it->second;
+  }
+
   for (size_t i = from; i < parsed_.size(); ++i) {
     if (parsed_[i].is_continuation())
       continue;
@@ -177,6 +177,14 @@ class NET_EXPORT HttpResponseHeaders
                        const base::StringPiece& name,
                        std::string* value) const;
 
+  // Zero-copy variant of the above.  The returned StringPiece points into
+  // raw_headers_ and is valid only as long as this object is alive and
+  // unmodified.  Prefer this overload on hot paths (e.g. the cache and
+  // network transactions) where the caller does not need to own the value.
+  bool EnumerateHeader(void** iter,
+                       const base::StringPiece& name,
+                       base::StringPiece* value) const;
+
   // Returns true if the response contains the specified header-value pair.
   // Both name and value are compared case insensitively.
   bool HasHeaderValue(const base::StringPiece& name,
@@ -334,6 +342,9 @@ class NET_EXPORT HttpResponseHeaders
   // index |from|.  Returns string::npos if not found.
   size_t FindHeader(size_t from, const base::StringPiece& name) const;
 
+  // Rebuilds name_index_ from parsed_.  Called at the end of Parse().
+  void BuildNameIndex();
+
   // Search the Cache-Control header for a directive matching |directive|. If
   // present, treat its value as a time offset in seconds, write it to |result|,
   // and return true.
@@ -385,6 +396,11 @@ class NET_EXPORT HttpResponseHeaders
   // header-value pairs within raw_headers_.
   HeaderList parsed_;
 
+  // Maps a lower-cased header name to the index in parsed_ of its first
+  // occurrence, so that lookups do not have to scan parsed_ from the start.
+  // Rebuilt whenever the headers are re-parsed.
+  base::hash_map<std::string, size_t> name_index_;
+
   // The raw_headers_ consists of the normalized status line (terminated with a
   // null byte) and then followed by the raw null-terminated headers from the
   // input that was passed to our constructor.  We preserve the input [*] to
@@ -468,6 +468,29 @@ TEST(HttpResponseHeadersTest, EnumerateHeader_Coalesced) {
   EXPECT_FALSE(parsed->EnumerateHeader(&iter, "cache-control", &value));
 }
 
+TEST(HttpResponseHeadersTest, EnumerateHeader_StringPiece) {
+  // The StringPiece overload must return views into the raw headers without
+  // copying, and enumerate values the same way as the std::string overload.
+  std::string headers =
+      "HTTP/1.1 200 OK\n"
+      "Cache-control: private\n"
+      "cache-Control: no-store\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(headers));
+
+  void* iter = NULL;
+  base::StringPiece value;
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "cache-control", &value));
+  EXPECT_EQ("private", value);
+  // The view must point into raw_headers_.
+  EXPECT_GE(value.data(), parsed->raw_headers().data());
+  EXPECT_LE(value.data() + value.size(),
+            parsed->raw_headers().data() + parsed->raw_headers().size());
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "cache-control", &value));
+  EXPECT_EQ("no-store", value);
+  EXPECT_FALSE(parsed->EnumerateHeader(&iter, "cache-control", &value));
+}
+
 TEST(HttpResponseHeadersTest, EnumerateHeader_Challenge) {
   // Even though WWW-Authenticate has commas, it should not be treated as
   // coalesced values.
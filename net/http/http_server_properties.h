@@ -206,12 +206,26 @@ struct NET_EXPORT ServerNetworkStats {
   QuicBandwidth bandwidth_estimate;
 };
 
+// QUIC connection history for one network, identified by the local IP
+// address. Used to stagger the QUIC vs. TCP job race adaptively: on
+// networks where QUIC keeps losing (e.g. UDP is blocked by a middlebox)
+// the TCP job should start immediately.
+struct NET_EXPORT QuicNetworkStats {
+  QuicNetworkStats() : num_successes(0), consecutive_failures(0) {}
+
+  int num_successes;
+  int consecutive_failures;
+  // Smoothed connect time of successful QUIC connections on this network.
+  base::TimeDelta smoothed_connect_time;
+};
+
 typedef std::vector<AlternativeService> AlternativeServiceVector;
 typedef std::vector<AlternativeServiceInfo> AlternativeServiceInfoVector;
 typedef base::MRUCache<HostPortPair, AlternativeServiceInfoVector>
     AlternativeServiceMap;
 typedef base::MRUCache<HostPortPair, SettingsMap> SpdySettingsMap;
 typedef base::MRUCache<HostPortPair, ServerNetworkStats> ServerNetworkStatsMap;
+typedef base::MRUCache<IPAddressNumber, QuicNetworkStats> QuicNetworkStatsMap;
 typedef base::MRUCache<QuicServerId, std::string> QuicServerInfoMap;
 
 // Persist 5 QUIC Servers. This is mainly used by cronet.
@@ -358,6 +372,18 @@ class NET_EXPORT HttpServerProperties {
   virtual void SetSupportsQuic(bool used_quic,
                                const IPAddressNumber& last_address) = 0;
 
+  // Records the result of a QUIC connection attempt on the network
+  // identified by |local_address|. |connect_time| is ignored unless
+  // |success| is true. Not persisted to disk.
+  virtual void RecordQuicNetworkResult(const IPAddressNumber& local_address,
+                                       bool success,
+                                       base::TimeDelta connect_time) = 0;
+
+  // Returns the QUIC history for the network identified by |local_address|,
+  // or nullptr if no results have been recorded on it.
+  virtual const QuicNetworkStats* GetQuicNetworkStats(
+      const IPAddressNumber& local_address) = 0;
+
   // Sets |stats| for |host_port_pair|.
   virtual void SetServerNetworkStats(const HostPortPair& host_port_pair,
                                      ServerNetworkStats stats) = 0;
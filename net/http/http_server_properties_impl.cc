@@ -23,6 +23,9 @@ namespace {
 
 const uint64 kBrokenAlternativeProtocolDelaySecs = 300;
 
+// Remember QUIC history for this many networks (local IP addresses).
+const int kMaxQuicNetworksToTrack = 10;
+
 }  // namespace
 
 HttpServerPropertiesImpl::HttpServerPropertiesImpl()
@@ -30,6 +33,7 @@ HttpServerPropertiesImpl::HttpServerPropertiesImpl()
       alternative_service_map_(AlternativeServiceMap::NO_AUTO_EVICT),
       spdy_settings_map_(SpdySettingsMap::NO_AUTO_EVICT),
       server_network_stats_map_(ServerNetworkStatsMap::NO_AUTO_EVICT),
+      quic_network_stats_map_(kMaxQuicNetworksToTrack),
       alternative_service_probability_threshold_(1.0),
       quic_server_info_map_(kMaxQuicServersToPersist),
       weak_ptr_factory_(this) {
@@ -153,6 +157,7 @@ void HttpServerPropertiesImpl::Clear() {
   spdy_settings_map_.Clear();
   last_quic_address_.clear();
   server_network_stats_map_.Clear();
+  quic_network_stats_map_.Clear();
   quic_server_info_map_.Clear();
 }
 
@@ -554,6 +559,39 @@ void HttpServerPropertiesImpl::SetSupportsQuic(bool used_quic,
   }
 }
 
+void HttpServerPropertiesImpl::RecordQuicNetworkResult(
+    const IPAddressNumber& local_address,
+    bool success,
+    base::TimeDelta connect_time) {
+  if (local_address.empty())
+    return;
+  QuicNetworkStatsMap::iterator it = quic_network_stats_map_.Get(local_address);
+  if (it == quic_network_stats_map_.end())
+    it = quic_network_stats_map_.Put(local_address, QuicNetworkStats());
+  QuicNetworkStats* stats = &it->second;
+  if (!success) {
+    ++stats->consecutive_failures;
+    return;
+  }
+  ++stats->num_successes;
+  stats->consecutive_failures = 0;
+  if (stats->smoothed_connect_time == base::TimeDelta()) {
+    stats->smoothed_connect_time = connect_time;
+  } else {
+    // Standard EWMA with a gain of 1/8, as used for RTT estimates.
+    stats->smoothed_connect_time +=
+        (connect_time - stats->smoothed_connect_time) / 8;
+  }
+}
+
+const QuicNetworkStats* HttpServerPropertiesImpl::GetQuicNetworkStats(
+    const IPAddressNumber& local_address) {
+  QuicNetworkStatsMap::iterator it = quic_network_stats_map_.Get(local_address);
+  if (it == quic_network_stats_map_.end())
+    return nullptr;
+  return &it->second;
+}
+
 void HttpServerPropertiesImpl::SetServerNetworkStats(
     const HostPortPair& host_port_pair,
     ServerNetworkStats stats) {
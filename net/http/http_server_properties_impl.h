@@ -122,6 +122,11 @@ class NET_EXPORT HttpServerPropertiesImpl
   const SpdySettingsMap& spdy_settings_map() const override;
   bool GetSupportsQuic(IPAddressNumber* last_address) const override;
   void SetSupportsQuic(bool used_quic, const IPAddressNumber& address) override;
+  void RecordQuicNetworkResult(const IPAddressNumber& local_address,
+                               bool success,
+                               base::TimeDelta connect_time) override;
+  const QuicNetworkStats* GetQuicNetworkStats(
+      const IPAddressNumber& local_address) override;
   void SetServerNetworkStats(const HostPortPair& host_port_pair,
                              ServerNetworkStats stats) override;
   const ServerNetworkStats* GetServerNetworkStats(
@@ -173,6 +178,9 @@ class NET_EXPORT HttpServerPropertiesImpl
   IPAddressNumber last_quic_address_;
   SpdySettingsMap spdy_settings_map_;
   ServerNetworkStatsMap server_network_stats_map_;
+  // Keyed by the local IP address that identifies the network. A handful of
+  // entries covers every network a device typically moves between.
+  QuicNetworkStatsMap quic_network_stats_map_;
   // Contains a map of servers which could share the same alternate protocol.
   // Map from a Canonical host/port (host is some postfix of host names) to an
   // actual origin, which has a plausible alternate protocol mapping.
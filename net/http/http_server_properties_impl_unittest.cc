@@ -1159,6 +1159,49 @@ TEST_F(SupportsQuicServerPropertiesTest, SetSupportsQuic) {
   EXPECT_FALSE(impl_.GetSupportsQuic(&address));
 }
 
+typedef HttpServerPropertiesImplTest QuicNetworkStatsServerPropertiesTest;
+
+TEST_F(QuicNetworkStatsServerPropertiesTest, RecordQuicNetworkResult) {
+  IPAddressNumber local_address;
+  CHECK(ParseIPLiteralToNumber("10.0.0.1", &local_address));
+  EXPECT_EQ(NULL, impl_.GetQuicNetworkStats(local_address));
+
+  // Failures accumulate until a success resets them.
+  impl_.RecordQuicNetworkResult(local_address, false, base::TimeDelta());
+  impl_.RecordQuicNetworkResult(local_address, false, base::TimeDelta());
+  const QuicNetworkStats* stats = impl_.GetQuicNetworkStats(local_address);
+  ASSERT_TRUE(stats != NULL);
+  EXPECT_EQ(0, stats->num_successes);
+  EXPECT_EQ(2, stats->consecutive_failures);
+  EXPECT_EQ(base::TimeDelta(), stats->smoothed_connect_time);
+
+  impl_.RecordQuicNetworkResult(local_address, true,
+                                base::TimeDelta::FromMilliseconds(80));
+  stats = impl_.GetQuicNetworkStats(local_address);
+  ASSERT_TRUE(stats != NULL);
+  EXPECT_EQ(1, stats->num_successes);
+  EXPECT_EQ(0, stats->consecutive_failures);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(80),
+            stats->smoothed_connect_time);
+
+  // The connect time estimate is smoothed, not replaced.
+  impl_.RecordQuicNetworkResult(local_address, true,
+                                base::TimeDelta::FromMilliseconds(160));
+  stats = impl_.GetQuicNetworkStats(local_address);
+  ASSERT_TRUE(stats != NULL);
+  EXPECT_EQ(2, stats->num_successes);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(90),
+            stats->smoothed_connect_time);
+
+  // History is tracked per network.
+  IPAddressNumber other_address;
+  CHECK(ParseIPLiteralToNumber("192.168.0.5", &other_address));
+  EXPECT_EQ(NULL, impl_.GetQuicNetworkStats(other_address));
+
+  impl_.Clear();
+  EXPECT_EQ(NULL, impl_.GetQuicNetworkStats(local_address));
+}
+
 typedef HttpServerPropertiesImplTest ServerNetworkStatsServerPropertiesTest;
 
 TEST_F(ServerNetworkStatsServerPropertiesTest, Initialize) {
@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/prefs/pref_service.h"
+#include "base/prefs/scoped_user_pref_update.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
@@ -82,7 +83,8 @@ HttpServerPropertiesManager::HttpServerPropertiesManager(
       pref_service_(pref_service),
       setting_prefs_(false),
       path_(pref_path),
-      network_task_runner_(network_task_runner) {
+      network_task_runner_(network_task_runner),
+      full_prefs_update_required_(true) {
   DCHECK(pref_service);
   pref_weak_ptr_factory_.reset(
       new base::WeakPtrFactory<HttpServerPropertiesManager>(this));
@@ -147,6 +149,7 @@ void HttpServerPropertiesManager::Clear(const base::Closure& completion) {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
 
   http_server_properties_impl_->Clear();
+  MarkAllPrefsDirty();
   UpdatePrefsFromCacheOnNetworkThread(completion);
 }
 
@@ -168,8 +171,10 @@ void HttpServerPropertiesManager::SetSupportsSpdy(const HostPortPair& server,
   bool old_support_spdy = http_server_properties_impl_->GetSupportsSpdy(server);
   http_server_properties_impl_->SetSupportsSpdy(server, support_spdy);
   bool new_support_spdy = http_server_properties_impl_->GetSupportsSpdy(server);
-  if (old_support_spdy != new_support_spdy)
+  if (old_support_spdy != new_support_spdy) {
+    MarkServerDirty(server);
     ScheduleUpdatePrefsOnNetworkThread(SUPPORTS_SPDY);
+  }
 }
 
 bool HttpServerPropertiesManager::RequiresHTTP11(const HostPortPair& server) {
@@ -182,6 +187,7 @@ void HttpServerPropertiesManager::SetHTTP11Required(
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
 
   http_server_properties_impl_->SetHTTP11Required(server);
+  MarkServerDirty(server);
   ScheduleUpdatePrefsOnNetworkThread(HTTP_11_REQUIRED);
 }
 
@@ -206,6 +212,7 @@ bool HttpServerPropertiesManager::SetAlternativeService(
   const bool changed = http_server_properties_impl_->SetAlternativeService(
       origin, alternative_service, alternative_probability, expiration);
   if (changed) {
+    MarkServerDirty(origin);
     ScheduleUpdatePrefsOnNetworkThread(SET_ALTERNATIVE_SERVICES);
   }
   return changed;
@@ -218,6 +225,7 @@ bool HttpServerPropertiesManager::SetAlternativeServices(
   const bool changed = http_server_properties_impl_->SetAlternativeServices(
       origin, alternative_service_info_vector);
   if (changed) {
+    MarkServerDirty(origin);
     ScheduleUpdatePrefsOnNetworkThread(SET_ALTERNATIVE_SERVICES);
   }
   return changed;
@@ -228,6 +236,9 @@ void HttpServerPropertiesManager::MarkAlternativeServiceBroken(
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
   http_server_properties_impl_->MarkAlternativeServiceBroken(
       alternative_service);
+  // A broken alternative service affects the persisted form of every origin
+  // mapped to it, so a full rewrite is required.
+  MarkAllPrefsDirty();
   ScheduleUpdatePrefsOnNetworkThread(MARK_ALTERNATIVE_SERVICE_BROKEN);
 }
 
@@ -263,8 +274,10 @@ void HttpServerPropertiesManager::ConfirmAlternativeService(
       alternative_service);
   // For persisting, we only care about the value returned by
   // IsAlternativeServiceBroken. If that value changes, then call persist.
-  if (old_value != new_value)
+  if (old_value != new_value) {
+    MarkAllPrefsDirty();
     ScheduleUpdatePrefsOnNetworkThread(CONFIRM_ALTERNATIVE_SERVICE);
+  }
 }
 
 void HttpServerPropertiesManager::ClearAlternativeServices(
@@ -276,8 +289,10 @@ void HttpServerPropertiesManager::ClearAlternativeServices(
   http_server_properties_impl_->ClearAlternativeServices(origin);
   size_t new_size = map.size();
   // Persist only if we have deleted an entry.
-  if (old_size != new_size)
+  if (old_size != new_size) {
+    MarkServerDirty(origin);
     ScheduleUpdatePrefsOnNetworkThread(CLEAR_ALTERNATIVE_SERVICE);
+  }
 }
 
 const AlternativeServiceMap&
@@ -314,8 +329,10 @@ bool HttpServerPropertiesManager::SetSpdySetting(
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
   bool persist = http_server_properties_impl_->SetSpdySetting(
       host_port_pair, id, flags, value);
-  if (persist)
+  if (persist) {
+    MarkServerDirty(host_port_pair);
     ScheduleUpdatePrefsOnNetworkThread(SET_SPDY_SETTING);
+  }
   return persist;
 }
 
@@ -323,12 +340,14 @@ void HttpServerPropertiesManager::ClearSpdySettings(
     const HostPortPair& host_port_pair) {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
   http_server_properties_impl_->ClearSpdySettings(host_port_pair);
+  MarkServerDirty(host_port_pair);
   ScheduleUpdatePrefsOnNetworkThread(CLEAR_SPDY_SETTINGS);
 }
 
 void HttpServerPropertiesManager::ClearAllSpdySettings() {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
   http_server_properties_impl_->ClearAllSpdySettings();
+  MarkAllPrefsDirty();
   ScheduleUpdatePrefsOnNetworkThread(CLEAR_ALL_SPDY_SETTINGS);
 }
 
@@ -353,8 +372,26 @@ void HttpServerPropertiesManager::SetSupportsQuic(
   http_server_properties_impl_->SetSupportsQuic(used_quic, address);
   IPAddressNumber new_last_quic_addr;
   http_server_properties_impl_->GetSupportsQuic(&new_last_quic_addr);
-  if (old_last_quic_addr != new_last_quic_addr)
+  if (old_last_quic_addr != new_last_quic_addr) {
+    MarkAllPrefsDirty();
     ScheduleUpdatePrefsOnNetworkThread(SET_SUPPORTS_QUIC);
+  }
+}
+
+void HttpServerPropertiesManager::RecordQuicNetworkResult(
+    const IPAddressNumber& local_address,
+    bool success,
+    base::TimeDelta connect_time) {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+  // Per-network QUIC history is not persisted to prefs.
+  http_server_properties_impl_->RecordQuicNetworkResult(local_address, success,
+                                                        connect_time);
+}
+
+const QuicNetworkStats* HttpServerPropertiesManager::GetQuicNetworkStats(
+    const IPAddressNumber& local_address) {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+  return http_server_properties_impl_->GetQuicNetworkStats(local_address);
 }
 
 void HttpServerPropertiesManager::SetServerNetworkStats(
@@ -369,8 +406,10 @@ void HttpServerPropertiesManager::SetServerNetworkStats(
   http_server_properties_impl_->SetServerNetworkStats(host_port_pair, stats);
   ServerNetworkStats new_stats =
       *(http_server_properties_impl_->GetServerNetworkStats(host_port_pair));
-  if (old_stats != new_stats)
+  if (old_stats != new_stats) {
+    MarkServerDirty(host_port_pair);
     ScheduleUpdatePrefsOnNetworkThread(SET_SERVER_NETWORK_STATS);
+  }
 }
 
 const ServerNetworkStats* HttpServerPropertiesManager::GetServerNetworkStats(
@@ -391,8 +430,10 @@ bool HttpServerPropertiesManager::SetQuicServerInfo(
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
   bool changed =
       http_server_properties_impl_->SetQuicServerInfo(server_id, server_info);
-  if (changed)
+  if (changed) {
+    MarkAllPrefsDirty();
     ScheduleUpdatePrefsOnNetworkThread(SET_QUIC_SERVER_INFO);
+  }
   return changed;
 }
 
@@ -802,6 +843,7 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnNetworkThread(
 
   // Update the prefs with what we have read (delete all corrupted prefs).
   if (detected_corrupted_prefs)
+    MarkAllPrefsDirty();
     ScheduleUpdatePrefsOnNetworkThread(DETECTED_CORRUPTED_PREFS);
 }
 
@@ -811,15 +853,29 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnNetworkThread(
 void HttpServerPropertiesManager::ScheduleUpdatePrefsOnNetworkThread(
     Location location) {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
-  // Cancel pending updates, if any.
-  network_prefs_update_timer_->Stop();
-  StartPrefsUpdateTimerOnNetworkThread(
-      base::TimeDelta::FromMilliseconds(kUpdatePrefsDelayMs));
+  // Coalesce: if an update is already scheduled, let it fire on time so a
+  // steady stream of updates cannot postpone persistence indefinitely.
+  if (!network_prefs_update_timer_->IsRunning()) {
+    StartPrefsUpdateTimerOnNetworkThread(
+        base::TimeDelta::FromMilliseconds(kUpdatePrefsDelayMs));
+  }
   // TODO(rtenneti): Delete the following histogram after collecting some data.
   UMA_HISTOGRAM_ENUMERATION("Net.HttpServerProperties.UpdatePrefs", location,
                             HttpServerPropertiesManager::NUM_LOCATIONS);
 }
 
+void HttpServerPropertiesManager::MarkServerDirty(const HostPortPair& server) {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+  if (!full_prefs_update_required_)
+    dirty_servers_.insert(server);
+}
+
+void HttpServerPropertiesManager::MarkAllPrefsDirty() {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+  full_prefs_update_required_ = true;
+  dirty_servers_.clear();
+}
+
 void HttpServerPropertiesManager::StartPrefsUpdateTimerOnNetworkThread(
     base::TimeDelta delay) {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
@@ -840,6 +896,15 @@ void HttpServerPropertiesManager::UpdatePrefsFromCacheOnNetworkThread(
     const base::Closure& completion) {
   DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
 
+  if (!full_prefs_update_required_) {
+    UpdateDirtyPrefsFromCacheOnNetworkThread(completion);
+    return;
+  }
+  // The write below establishes a consistent baseline; changes made after
+  // this point are tracked per server again.
+  full_prefs_update_required_ = false;
+  dirty_servers_.clear();
+
   base::ListValue* spdy_server_list = new base::ListValue;
   http_server_properties_impl_->GetSpdyServerList(
       spdy_server_list, kMaxSupportsSpdyServerHostsToPersist);
@@ -938,6 +1003,145 @@ void HttpServerPropertiesManager::UpdatePrefsFromCacheOnNetworkThread(
           base::Owned(quic_server_info_map), completion));
 }
 
+void HttpServerPropertiesManager::UpdateDirtyPrefsFromCacheOnNetworkThread(
+    const base::Closure& completion) {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+  DCHECK(!full_prefs_update_required_);
+
+  std::set<HostPortPair> dirty_servers;
+  dirty_servers.swap(dirty_servers_);
+  if (dirty_servers.empty()) {
+    if (!completion.is_null())
+      pref_task_runner_->PostTask(FROM_HERE, completion);
+    return;
+  }
+
+  // One pass over the alternative service map gathers the persistable
+  // vectors for all dirty servers.  This mirrors the filtering done by the
+  // full update, except that the canonical-suffix deduplication and the
+  // persistence caps only apply to full rewrites.
+  std::map<HostPortPair, AlternativeServiceInfoVector>
+      dirty_alternative_services;
+  const AlternativeServiceMap& map =
+      http_server_properties_impl_->alternative_service_map();
+  for (AlternativeServiceMap::const_iterator it = map.begin();
+       it != map.end(); ++it) {
+    const HostPortPair& server = it->first;
+    if (dirty_servers.find(server) == dirty_servers.end())
+      continue;
+    AlternativeServiceInfoVector notbroken_alternative_service_info_vector;
+    for (const AlternativeServiceInfo& alternative_service_info : it->second) {
+      // Do not persist expired entries.
+      if (alternative_service_info.expiration < base::Time::Now())
+        continue;
+      AlternativeService alternative_service(
+          alternative_service_info.alternative_service);
+      if (!IsAlternateProtocolValid(alternative_service.protocol))
+        continue;
+      if (alternative_service.host.empty())
+        alternative_service.host = server.host();
+      if (IsAlternativeServiceBroken(alternative_service))
+        continue;
+      notbroken_alternative_service_info_vector.push_back(
+          alternative_service_info);
+    }
+    if (!notbroken_alternative_service_info_vector.empty()) {
+      dirty_alternative_services[server] =
+          notbroken_alternative_service_info_vector;
+    }
+  }
+
+  // A dictionary value replaces the server's persisted entry; a null value
+  // removes it.
+  scoped_ptr<base::DictionaryValue> dirty_server_prefs(
+      new base::DictionaryValue);
+  for (const HostPortPair& server : dirty_servers) {
+    std::map<HostPortPair, AlternativeServiceInfoVector>::const_iterator
+        alternative_it = dirty_alternative_services.find(server);
+    scoped_ptr<base::DictionaryValue> server_pref_dict =
+        BuildServerPrefDictOnNetworkThread(
+            server, alternative_it == dirty_alternative_services.end()
+                        ? NULL
+                        : &alternative_it->second);
+    if (server_pref_dict) {
+      dirty_server_prefs->SetWithoutPathExpansion(server.ToString(),
+                                                  server_pref_dict.release());
+    } else {
+      dirty_server_prefs->SetWithoutPathExpansion(
+          server.ToString(), base::Value::CreateNullValue());
+    }
+  }
+
+  pref_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&HttpServerPropertiesManager::UpdateServerPrefsOnPrefThread,
+                 pref_weak_ptr_, base::Owned(dirty_server_prefs.release()),
+                 completion));
+}
+
+scoped_ptr<base::DictionaryValue>
+HttpServerPropertiesManager::BuildServerPrefDictOnNetworkThread(
+    const HostPortPair& server,
+    const AlternativeServiceInfoVector* alternative_service_info_vector) {
+  DCHECK(network_task_runner_->RunsTasksOnCurrentThread());
+
+  scoped_ptr<base::DictionaryValue> server_pref_dict(
+      new base::DictionaryValue);
+
+  if (http_server_properties_impl_->GetSupportsSpdy(server))
+    server_pref_dict->SetBoolean(kSupportsSpdyKey, true);
+
+  const SettingsMap& settings_map =
+      http_server_properties_impl_->GetSpdySettings(server);
+  if (!settings_map.empty())
+    SaveSpdySettingsToServerPrefs(&settings_map, server_pref_dict.get());
+
+  SaveAlternativeServiceToServerPrefs(alternative_service_info_vector,
+                                      server_pref_dict.get());
+
+  SaveNetworkStatsToServerPrefs(
+      http_server_properties_impl_->GetServerNetworkStats(server),
+      server_pref_dict.get());
+
+  if (server_pref_dict->empty())
+    return scoped_ptr<base::DictionaryValue>();
+  return server_pref_dict.Pass();
+}
+
+void HttpServerPropertiesManager::UpdateServerPrefsOnPrefThread(
+    base::DictionaryValue* dirty_server_prefs,
+    const base::Closure& completion) {
+  DCHECK(pref_task_runner_->RunsTasksOnCurrentThread());
+
+  {
+    DictionaryPrefUpdate update(pref_service_, path_);
+    base::DictionaryValue* http_server_properties_dict = update.Get();
+    base::DictionaryValue* servers_dict = NULL;
+    if (!http_server_properties_dict->GetDictionaryWithoutPathExpansion(
+            kServersKey, &servers_dict)) {
+      servers_dict = new base::DictionaryValue;
+      http_server_properties_dict->SetWithoutPathExpansion(kServersKey,
+                                                           servers_dict);
+      SetVersion(http_server_properties_dict, kVersionNumber);
+    }
+
+    setting_prefs_ = true;
+    for (base::DictionaryValue::Iterator it(*dirty_server_prefs);
+         !it.IsAtEnd(); it.Advance()) {
+      if (it.value().IsType(base::Value::TYPE_NULL)) {
+        servers_dict->RemoveWithoutPathExpansion(it.key(), NULL);
+      } else {
+        servers_dict->SetWithoutPathExpansion(it.key(),
+                                              it.value().DeepCopy());
+      }
+    }
+    setting_prefs_ = false;
+  }
+
+  if (!completion.is_null())
+    completion.Run();
+}
+
 // A local or temporary data structure to hold |supports_spdy|, SpdySettings,
 // AlternativeServiceInfoVector, and SupportsQuic preferences for a server. This
 // is used only in UpdatePrefsOnPrefThread.
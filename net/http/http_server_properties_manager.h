@@ -5,6 +5,7 @@
 #ifndef NET_HTTP_HTTP_SERVER_PROPERTIES_MANAGER_H_
 #define NET_HTTP_HTTP_SERVER_PROPERTIES_MANAGER_H_
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -123,6 +124,11 @@ class NET_EXPORT HttpServerPropertiesManager : public HttpServerProperties {
   bool GetSupportsQuic(IPAddressNumber* last_address) const override;
   void SetSupportsQuic(bool used_quic,
                        const IPAddressNumber& last_address) override;
+  void RecordQuicNetworkResult(const IPAddressNumber& local_address,
+                               bool success,
+                               base::TimeDelta connect_time) override;
+  const QuicNetworkStats* GetQuicNetworkStats(
+      const IPAddressNumber& local_address) override;
   void SetServerNetworkStats(const HostPortPair& host_port_pair,
                              ServerNetworkStats stats) override;
   const ServerNetworkStats* GetServerNetworkStats(
@@ -214,6 +220,35 @@ class NET_EXPORT HttpServerPropertiesManager : public HttpServerProperties {
                                const base::Closure& completion);
 
  private:
+  // Tracks which servers changed since the last prefs write, so the write can
+  // update just those entries instead of reserializing every server.
+  // MarkServerDirty() is called by updates scoped to a single server;
+  // MarkAllPrefsDirty() by updates whose effect on the persisted form is not
+  // limited to one server (broken alternative services, QUIC state, clears).
+  void MarkServerDirty(const HostPortPair& server);
+  void MarkAllPrefsDirty();
+
+  // Incremental flavor of UpdatePrefsFromCacheOnNetworkThread: serializes
+  // only the servers in |dirty_servers_| and posts the result to the pref
+  // thread.
+  void UpdateDirtyPrefsFromCacheOnNetworkThread(const base::Closure& completion);
+
+  // Builds the persisted dictionary for a single |server| from
+  // |http_server_properties_impl_|, or returns NULL if the server has nothing
+  // worth persisting.  |alternative_service_info_vector| holds the server's
+  // persistable alternative services, and may be NULL.  Runs on the network
+  // thread.
+  scoped_ptr<base::DictionaryValue> BuildServerPrefDictOnNetworkThread(
+      const HostPortPair& server,
+      const AlternativeServiceInfoVector* alternative_service_info_vector);
+
+  // Applies an incremental update to the servers dictionary in prefs.  Each
+  // key of |dirty_server_prefs| is a server string; a dictionary value
+  // replaces that server's entry and a null value removes it.  Runs on the
+  // pref thread.
+  void UpdateServerPrefsOnPrefThread(base::DictionaryValue* dirty_server_prefs,
+                                     const base::Closure& completion);
+
   FRIEND_TEST_ALL_PREFIXES(HttpServerPropertiesManagerTest,
                            AddToAlternativeServiceMap);
   void OnHttpServerPropertiesChanged();
@@ -278,6 +313,13 @@ class NET_EXPORT HttpServerPropertiesManager : public HttpServerProperties {
   // Used to post |prefs::kHttpServerProperties| pref update tasks.
   scoped_ptr<base::OneShotTimer> network_prefs_update_timer_;
 
+  // Servers whose persisted entries are out of date.  When
+  // |full_prefs_update_required_| is set the next write reserializes
+  // everything and the set is ignored.  Starts out requiring a full write so
+  // the first update establishes a consistent baseline.
+  std::set<HostPortPair> dirty_servers_;
+  bool full_prefs_update_required_;
+
   scoped_ptr<HttpServerPropertiesImpl> http_server_properties_impl_;
 
   // Used to get |weak_ptr_| to self on the pref thread.
@@ -0,0 +1,79 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_session_counters.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/values.h"
+
+namespace net {
+
+HttpSessionCounters::HttpSessionCounters() {
+  memset(counters_, 0, sizeof(counters_));
+}
+
+HttpSessionCounters::~HttpSessionCounters() {}
+
+void HttpSessionCounters::Snapshot(int64* snapshot) const {
+  for (int i = 0; i < NUM_COUNTERS; ++i)
+    snapshot[i] = GetCount(static_cast<CounterId>(i));
+}
+
+// static
+const char* HttpSessionCounters::CounterName(CounterId counter) {
+  switch (counter) {
+    case SOCKET_REUSED:
+      return "socket_reused";
+    case SOCKET_CREATED:
+      return "socket_created";
+    case SPDY_FRAMES_RECEIVED:
+      return "spdy_frames_received";
+    case SPDY_FRAMES_SENT:
+      return "spdy_frames_sent";
+    case CACHE_ENTRY_USED:
+      return "cache_entry_used";
+    case CACHE_ENTRY_VALIDATED:
+      return "cache_entry_validated";
+    case CACHE_ENTRY_UPDATED:
+      return "cache_entry_updated";
+    case CACHE_ENTRY_NOT_CACHED:
+      return "cache_entry_not_cached";
+    case CACHE_ENTRY_CANT_CONDITIONALIZE:
+      return "cache_entry_cant_conditionalize";
+    case CACHE_NOT_COVERED:
+      return "cache_not_covered";
+    case BYTES_SENT_HTTP:
+      return "bytes_sent_http";
+    case BYTES_RECEIVED_HTTP:
+      return "bytes_received_http";
+    case BYTES_SENT_SPDY:
+      return "bytes_sent_spdy";
+    case BYTES_RECEIVED_SPDY:
+      return "bytes_received_spdy";
+    case BYTES_SENT_QUIC:
+      return "bytes_sent_quic";
+    case BYTES_RECEIVED_QUIC:
+      return "bytes_received_quic";
+    case NUM_COUNTERS:
+      break;
+  }
+  NOTREACHED();
+  return "";
+}
+
+scoped_ptr<base::Value> HttpSessionCounters::ToValue() const {
+  scoped_ptr<base::DictionaryValue> dict(new base::DictionaryValue());
+  for (int i = 0; i < NUM_COUNTERS; ++i) {
+    CounterId counter = static_cast<CounterId>(i);
+    // base::Value has no 64 bit integer type; doubles keep exact values up
+    // to 2^53, which is plenty for these counters.
+    dict->SetDouble(CounterName(counter),
+                    static_cast<double>(GetCount(counter)));
+  }
+  return dict.Pass();
+}
+
+}  // namespace net
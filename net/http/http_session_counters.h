@@ -0,0 +1,89 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_HTTP_SESSION_COUNTERS_H_
+#define NET_HTTP_HTTP_SESSION_COUNTERS_H_
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class Value;
+}
+
+namespace net {
+
+// Always-on counters for the hottest paths of the HTTP stack.  Unlike UMA
+// histograms or NetLog, updating one of these is a single atomic add, cheap
+// enough to leave enabled in production and scrape at high frequency.
+// Updates may happen from any thread; reads are lock-free and individual
+// counters may be observed mid-update relative to each other, which is
+// acceptable for monitoring purposes.  Counters are AtomicWord sized, so
+// they are 64 bits wide on 64-bit builds.
+class NET_EXPORT HttpSessionCounters {
+ public:
+  enum CounterId {
+    // An idle socket was handed to a new transaction.
+    SOCKET_REUSED = 0,
+    // A transaction required a fresh connection.
+    SOCKET_CREATED,
+    // SPDY and HTTP/2 frames parsed from, and queued to, the wire.
+    SPDY_FRAMES_RECEIVED,
+    SPDY_FRAMES_SENT,
+    // Cache transaction outcomes, mirroring HttpCache::Transaction's
+    // transaction patterns.
+    CACHE_ENTRY_USED,
+    CACHE_ENTRY_VALIDATED,
+    CACHE_ENTRY_UPDATED,
+    CACHE_ENTRY_NOT_CACHED,
+    CACHE_ENTRY_CANT_CONDITIONALIZE,
+    CACHE_NOT_COVERED,
+    // Bytes on the wire for completed transactions, by protocol.
+    BYTES_SENT_HTTP,
+    BYTES_RECEIVED_HTTP,
+    BYTES_SENT_SPDY,
+    BYTES_RECEIVED_SPDY,
+    BYTES_SENT_QUIC,
+    BYTES_RECEIVED_QUIC,
+    NUM_COUNTERS
+  };
+
+  HttpSessionCounters();
+  ~HttpSessionCounters();
+
+  void Increment(CounterId counter) { Add(counter, 1); }
+
+  void Add(CounterId counter, int64 delta) {
+    base::subtle::NoBarrier_AtomicIncrement(
+        &counters_[counter], static_cast<base::subtle::AtomicWord>(delta));
+  }
+
+  int64 GetCount(CounterId counter) const {
+    return base::subtle::NoBarrier_Load(&counters_[counter]);
+  }
+
+  // Copies all counters into |snapshot|, which must hold NUM_COUNTERS
+  // entries.  This is the 1Hz scrape path: NUM_COUNTERS relaxed loads and
+  // nothing else.
+  void Snapshot(int64* snapshot) const;
+
+  // Returns the stable name of |counter|, used as the dictionary key in
+  // ToValue() and by external exporters.
+  static const char* CounterName(CounterId counter);
+
+  // Creates a Value dictionary mapping counter names to current values,
+  // in the style of the other *InfoToValue() debugging surfaces.
+  scoped_ptr<base::Value> ToValue() const;
+
+ private:
+  base::subtle::AtomicWord counters_[NUM_COUNTERS];
+
+  DISALLOW_COPY_AND_ASSIGN(HttpSessionCounters);
+};
+
+}  // namespace net
+
+#endif  // NET_HTTP_HTTP_SESSION_COUNTERS_H_
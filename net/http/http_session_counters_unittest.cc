@@ -0,0 +1,63 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_session_counters.h"
+
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(HttpSessionCountersTest, StartsAtZero) {
+  HttpSessionCounters counters;
+  for (int i = 0; i < HttpSessionCounters::NUM_COUNTERS; ++i) {
+    EXPECT_EQ(0, counters.GetCount(
+                     static_cast<HttpSessionCounters::CounterId>(i)));
+  }
+}
+
+TEST(HttpSessionCountersTest, IncrementAndAdd) {
+  HttpSessionCounters counters;
+  counters.Increment(HttpSessionCounters::SOCKET_REUSED);
+  counters.Increment(HttpSessionCounters::SOCKET_REUSED);
+  counters.Add(HttpSessionCounters::BYTES_RECEIVED_HTTP, 1234);
+
+  EXPECT_EQ(2, counters.GetCount(HttpSessionCounters::SOCKET_REUSED));
+  EXPECT_EQ(0, counters.GetCount(HttpSessionCounters::SOCKET_CREATED));
+  EXPECT_EQ(1234,
+            counters.GetCount(HttpSessionCounters::BYTES_RECEIVED_HTTP));
+}
+
+TEST(HttpSessionCountersTest, Snapshot) {
+  HttpSessionCounters counters;
+  counters.Add(HttpSessionCounters::SPDY_FRAMES_SENT, 7);
+
+  int64 snapshot[HttpSessionCounters::NUM_COUNTERS];
+  counters.Snapshot(snapshot);
+  EXPECT_EQ(7, snapshot[HttpSessionCounters::SPDY_FRAMES_SENT]);
+  EXPECT_EQ(0, snapshot[HttpSessionCounters::SPDY_FRAMES_RECEIVED]);
+}
+
+TEST(HttpSessionCountersTest, ToValueContainsAllCounters) {
+  HttpSessionCounters counters;
+  counters.Increment(HttpSessionCounters::CACHE_ENTRY_USED);
+
+  scoped_ptr<base::Value> value(counters.ToValue());
+  const base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(value->GetAsDictionary(&dict));
+  EXPECT_EQ(static_cast<size_t>(HttpSessionCounters::NUM_COUNTERS),
+            dict->size());
+
+  double used = 0;
+  ASSERT_TRUE(dict->GetDouble(
+      HttpSessionCounters::CounterName(HttpSessionCounters::CACHE_ENTRY_USED),
+      &used));
+  EXPECT_EQ(1, used);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -8,6 +8,7 @@
 
 #include "base/logging.h"
 #include "base/stl_util.h"
+#include "base/time/time.h"
 #include "net/base/net_util.h"
 #include "net/http/http_network_session.h"
 #include "net/http/http_server_properties.h"
@@ -85,6 +86,17 @@ HttpStreamRequest* HttpStreamFactoryImpl::RequestStreamInternal(
     WebSocketHandshakeStreamBase::CreateHelper*
         websocket_handshake_stream_create_helper,
     const BoundNetLog& net_log) {
+  if (!for_websockets_ && session_->params().enable_speculative_preconnect &&
+      request_info.url.SchemeIsHTTPOrHTTPS()) {
+    int num_streams = session_->preconnect_predictor()->OnRequest(
+        HostPortPair::FromURL(request_info.url), base::TimeTicks::Now());
+    // Warm a spare socket for the next request to this origin, beyond the
+    // connection this request is about to claim.
+    if (num_streams > 0)
+      PreconnectStreams(num_streams, request_info, server_ssl_config,
+                        proxy_ssl_config);
+  }
+
   Request* request = new Request(request_info.url,
                                  this,
                                  delegate,
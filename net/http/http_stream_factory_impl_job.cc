@@ -261,8 +261,11 @@ void HttpStreamFactoryImpl::Job::Orphan(const Request* request) {
 
 void HttpStreamFactoryImpl::Job::SetPriority(RequestPriority priority) {
   priority_ = priority;
-  // TODO(akalin): Propagate this to |connection_| and maybe the
-  // preconnect state.
+  // If the job is still waiting in a socket pool's queue, move it to its
+  // new place in the queue.  In-flight connects and established
+  // connections keep their original priority.
+  if (connection_ && !connection_->is_initialized())
+    connection_->SetPriority(priority);
 }
 
 bool HttpStreamFactoryImpl::Job::was_npn_negotiated() const {
@@ -1108,6 +1111,19 @@ int HttpStreamFactoryImpl::Job::DoInitConnectionComplete(int result) {
     if (!connection_->is_reused()) {
       ConnectionType type = using_spdy_ ? CONNECTION_SPDY : CONNECTION_HTTP;
       UpdateConnectionTypeHistograms(type);
+
+      // Feed the observed connection setup latency to the preconnect
+      // predictor, so it can tell which origins are worth warming.
+      if (session_->params().enable_speculative_preconnect) {
+        const LoadTimingInfo::ConnectTiming& connect_timing =
+            connection_->connect_timing();
+        if (!connect_timing.connect_start.is_null() &&
+            !connect_timing.connect_end.is_null()) {
+          session_->preconnect_predictor()->OnConnectLatency(
+              server_,
+              connect_timing.connect_end - connect_timing.connect_start);
+        }
+      }
     }
   }
 
@@ -4,6 +4,9 @@
 
 #include "net/http/http_stream_parser.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/logging.h"
@@ -12,6 +15,7 @@
 #include "base/strings/string_util.h"
 #include "base/values.h"
 #include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/upload_data_stream.h"
 #include "net/http/http_chunked_decoder.h"
@@ -47,6 +51,12 @@ void RecordHeaderParserEvent(HttpHeaderParserEvent header_event) {
 const uint64 kMaxMergedHeaderAndBodySize = 1400;
 const size_t kRequestBodyBufferSize = 1 << 14;  // 16KB
 
+// Large non-chunked uploads use a bigger body buffer so that each
+// read/write cycle moves more data, cutting the number of file reads and
+// socket writes for the same body.
+const size_t kLargeRequestBodyBufferSize = 1 << 16;  // 64KB
+const uint64 kLargeRequestBodyThreshold = 1 << 20;  // 1MB
+
 std::string GetResponseHeaderLines(const HttpResponseHeaders& headers) {
   std::string raw_headers = headers.raw_headers();
   const char* null_separated_headers = raw_headers.c_str();
@@ -257,14 +267,19 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
   request_headers_length_ = request.size();
 
   if (request_->upload_data_stream != NULL) {
-    request_body_send_buf_ = new SeekableIOBuffer(kRequestBodyBufferSize);
     if (request_->upload_data_stream->is_chunked()) {
+      request_body_send_buf_ = new SeekableIOBuffer(kRequestBodyBufferSize);
       // Read buffer is adjusted to guarantee that |request_body_send_buf_| is
       // large enough to hold the encoded chunk.
       request_body_read_buf_ =
           new SeekableIOBuffer(kRequestBodyBufferSize - kChunkHeaderFooterSize);
     } else {
-      // No need to encode request body, just send the raw data.
+      // No need to encode request body, just send the raw data.  Large
+      // bodies get a bigger buffer so they complete in fewer cycles.
+      size_t body_buffer_size = kRequestBodyBufferSize;
+      if (request_->upload_data_stream->size() >= kLargeRequestBodyThreshold)
+        body_buffer_size = kLargeRequestBodyBufferSize;
+      request_body_send_buf_ = new SeekableIOBuffer(body_buffer_size);
       request_body_read_buf_ = request_body_send_buf_;
     }
   }
@@ -273,32 +288,52 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
 
   // If we have a small request body, then we'll merge with the headers into a
   // single write.
-  bool did_merge = false;
+  // |request_headers_| normally contains just the HTTP headers; the merged
+  // copy path below may repurpose it to hold headers and body.
+  scoped_refptr<StringIOBuffer> headers_io_buf(new StringIOBuffer(request));
+  request_headers_ =
+      new DrainableIOBuffer(headers_io_buf.get(), headers_io_buf->size());
+
   if (ShouldMergeRequestHeadersAndBody(request, request_->upload_data_stream)) {
-    int merged_size = static_cast<int>(
-        request_headers_length_ + request_->upload_data_stream->size());
-    scoped_refptr<IOBuffer> merged_request_headers_and_body(
-        new IOBuffer(merged_size));
-    // We'll repurpose |request_headers_| to store the merged headers and
-    // body.
-    request_headers_ = new DrainableIOBuffer(
-        merged_request_headers_and_body.get(), merged_size);
-
-    memcpy(request_headers_->data(), request.data(), request_headers_length_);
-    request_headers_->DidConsume(request_headers_length_);
+    scoped_refptr<DrainableIOBuffer> body_target;
+    if (connection_->socket()->SupportsGatherWrites()) {
+      // Stage the whole body in its own buffer, and let DoSendHeaders()
+      // submit headers and body as a single gather write.  This avoids
+      // copying the headers into a merged buffer, and avoids a second
+      // syscall on transports with scatter/gather support.
+      int body_size = static_cast<int>(request_->upload_data_stream->size());
+      scoped_refptr<IOBufferWithSize> body_buf(
+          IOBufferPool::Default()->Allocate(body_size));
+      request_merged_body_ = new DrainableIOBuffer(body_buf.get(), body_size);
+      body_target = request_merged_body_;
+    } else {
+      // Transports that lack native gather writes (notably SSL sockets and
+      // the proxy tunnel wrappers) would otherwise send headers and body as
+      // two sequential writes -- two records on TLS.  Keep the merged copy
+      // for them, repurposing |request_headers_| to hold headers and body.
+      int merged_size = static_cast<int>(
+          request_headers_length_ + request_->upload_data_stream->size());
+      scoped_refptr<IOBufferWithSize> merged_buf(
+          IOBufferPool::Default()->Allocate(merged_size));
+      request_headers_ = new DrainableIOBuffer(merged_buf.get(), merged_size);
+
+      memcpy(request_headers_->data(), request.data(),
+             request_headers_length_);
+      request_headers_->DidConsume(request_headers_length_);
+      body_target = request_headers_;
+    }
 
     uint64 todo = request_->upload_data_stream->size();
     while (todo) {
       int consumed = request_->upload_data_stream->Read(
-          request_headers_.get(), static_cast<int>(todo), CompletionCallback());
+          body_target.get(), static_cast<int>(todo), CompletionCallback());
       DCHECK_GT(consumed, 0);  // Read() won't fail if not chunked.
-      request_headers_->DidConsume(consumed);
+      body_target->DidConsume(consumed);
       todo -= consumed;
     }
     DCHECK(request_->upload_data_stream->IsEOF());
     // Reset the offset, so the buffer can be read from the beginning.
-    request_headers_->SetOffset(0);
-    did_merge = true;
+    body_target->SetOffset(0);
 
     net_log_.AddEvent(
         NetLog::TYPE_HTTP_TRANSACTION_SEND_REQUEST_BODY,
@@ -308,14 +343,6 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
                    true /* merged */));
   }
 
-  if (!did_merge) {
-    // If we didn't merge the body with the headers, then |request_headers_|
-    // contains just the HTTP headers.
-    scoped_refptr<StringIOBuffer> headers_io_buf(new StringIOBuffer(request));
-    request_headers_ =
-        new DrainableIOBuffer(headers_io_buf.get(), headers_io_buf->size());
-  }
-
   result = DoLoop(OK);
   if (result == ERR_IO_PENDING)
     callback_ = callback;
@@ -450,7 +477,9 @@ int HttpStreamParser::DoSendHeaders() {
           "424359 HttpStreamParser::DoSendHeaders"));
 
   int bytes_remaining = request_headers_->BytesRemaining();
-  DCHECK_GT(bytes_remaining, 0);
+  DCHECK(bytes_remaining > 0 ||
+         (request_merged_body_.get() &&
+          request_merged_body_->BytesRemaining() > 0));
 
   // Record our best estimate of the 'request time' as the time when we send
   // out the first bytes of the request headers.
@@ -458,8 +487,19 @@ int HttpStreamParser::DoSendHeaders() {
     response_->request_time = base::Time::Now();
 
   io_state_ = STATE_SEND_HEADERS_COMPLETE;
-  return connection_->socket()
-      ->Write(request_headers_.get(), bytes_remaining, io_callback_);
+
+  // Gather the unconsumed headers and merged body, if any, into one write.
+  std::vector<scoped_refptr<DrainableIOBuffer>> buffers;
+  if (bytes_remaining > 0)
+    buffers.push_back(request_headers_);
+  if (request_merged_body_.get() && request_merged_body_->BytesRemaining() > 0)
+    buffers.push_back(request_merged_body_);
+  if (buffers.size() == 1u) {
+    DrainableIOBuffer* buf = buffers.front().get();
+    return connection_->socket()
+        ->Write(buf, buf->BytesRemaining(), io_callback_);
+  }
+  return connection_->socket()->WriteV(buffers, io_callback_);
 }
 
 int HttpStreamParser::DoSendHeadersComplete(int result) {
@@ -477,8 +517,16 @@ int HttpStreamParser::DoSendHeadersComplete(int result) {
   }
 
   sent_bytes_ += result;
-  request_headers_->DidConsume(result);
-  if (request_headers_->BytesRemaining() > 0) {
+  // A gather write consumes from the front of the sequence, so drain the
+  // headers first and credit whatever is left to the merged body.
+  int headers_consumed =
+      std::min(result, request_headers_->BytesRemaining());
+  request_headers_->DidConsume(headers_consumed);
+  if (request_merged_body_.get())
+    request_merged_body_->DidConsume(result - headers_consumed);
+  if (request_headers_->BytesRemaining() > 0 ||
+      (request_merged_body_.get() &&
+       request_merged_body_->BytesRemaining() > 0)) {
     io_state_ = STATE_SEND_HEADERS;
     return OK;
   }
@@ -888,6 +936,10 @@ int HttpStreamParser::HandleReadHeaderResult(int result) {
 
     // Note where the headers stop.
     read_buf_unused_offset_ = end_of_header_offset;
+    // The headers buffer is kept around while the body streams, which can be
+    // a long time for slow responses; return the capacity grown for header
+    // parsing but no longer needed.
+    read_buf_->ShrinkToFit();
     // Now waiting for the body to be read.
   }
   return result;
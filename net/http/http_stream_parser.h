@@ -191,11 +191,15 @@ class NET_EXPORT_PRIVATE HttpStreamParser {
   // The request to send.
   const HttpRequestInfo* request_;
 
-  // The request header data.  May include a merged request body.
+  // The request header data.
   scoped_refptr<DrainableIOBuffer> request_headers_;
 
-  // Size of just the request headers.  May be less than the length of
-  // |request_headers_| if the body was merged with the headers.
+  // When a small in-memory request body is merged with the headers, the whole
+  // body is staged here and submitted together with |request_headers_| as a
+  // single gather write.  NULL if the body is not merged.
+  scoped_refptr<DrainableIOBuffer> request_merged_body_;
+
+  // Size of just the request headers.
   int request_headers_length_;
 
   // Temporary buffer for reading.
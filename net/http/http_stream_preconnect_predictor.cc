@@ -0,0 +1,100 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_stream_preconnect_predictor.h"
+
+namespace net {
+
+namespace {
+
+// Origins whose connection setup completes faster than this are not worth
+// warming; the preconnect machinery itself is not free.
+const int kMinConnectLatencyMs = 20;
+
+// A warmed socket must be predicted to be used within this long.  Beyond
+// that, the socket pools are likely to close it as an unused idle socket
+// before the next request arrives.
+const int kMaxPredictedIdleTimeSeconds = 10;
+
+// Smooth with a gain of 1/8, as used for TCP RTT estimation.  The first
+// sample initializes the average.
+base::TimeDelta Smooth(base::TimeDelta smoothed, base::TimeDelta sample) {
+  if (smoothed == base::TimeDelta())
+    return sample;
+  return smoothed + (sample - smoothed) / 8;
+}
+
+}  // namespace
+
+// static
+const size_t HttpStreamPreconnectPredictor::kMaxTrackedOrigins;
+const int HttpStreamPreconnectPredictor::kMaxPreconnectsPerMinute;
+const int HttpStreamPreconnectPredictor::kMinRequestsBeforePrediction;
+
+HttpStreamPreconnectPredictor::OriginStats::OriginStats()
+    : request_count(0) {
+}
+
+HttpStreamPreconnectPredictor::HttpStreamPreconnectPredictor()
+    : origins_(kMaxTrackedOrigins),
+      preconnects_in_window_(0) {
+}
+
+HttpStreamPreconnectPredictor::~HttpStreamPreconnectPredictor() {
+}
+
+int HttpStreamPreconnectPredictor::OnRequest(const HostPortPair& origin,
+                                             base::TimeTicks now) {
+  OriginStatsMap::iterator it = origins_.Get(origin);
+  if (it == origins_.end())
+    it = origins_.Put(origin, OriginStats());
+  OriginStats& stats = it->second;
+
+  ++stats.request_count;
+  if (!stats.last_request_time.is_null()) {
+    stats.smoothed_interarrival =
+        Smooth(stats.smoothed_interarrival, now - stats.last_request_time);
+  }
+  stats.last_request_time = now;
+
+  if (stats.request_count < kMinRequestsBeforePrediction)
+    return 0;
+  if (stats.smoothed_connect_latency <
+      base::TimeDelta::FromMilliseconds(kMinConnectLatencyMs)) {
+    return 0;
+  }
+  if (stats.smoothed_interarrival >
+      base::TimeDelta::FromSeconds(kMaxPredictedIdleTimeSeconds)) {
+    return 0;
+  }
+  if (!TakeBudget(now))
+    return 0;
+
+  // One spare socket beyond the connection the current request will use.
+  return 2;
+}
+
+void HttpStreamPreconnectPredictor::OnConnectLatency(
+    const HostPortPair& origin,
+    base::TimeDelta latency) {
+  OriginStatsMap::iterator it = origins_.Get(origin);
+  if (it == origins_.end())
+    it = origins_.Put(origin, OriginStats());
+  it->second.smoothed_connect_latency =
+      Smooth(it->second.smoothed_connect_latency, latency);
+}
+
+bool HttpStreamPreconnectPredictor::TakeBudget(base::TimeTicks now) {
+  if (budget_window_start_.is_null() ||
+      now - budget_window_start_ >= base::TimeDelta::FromMinutes(1)) {
+    budget_window_start_ = now;
+    preconnects_in_window_ = 0;
+  }
+  if (preconnects_in_window_ >= kMaxPreconnectsPerMinute)
+    return false;
+  ++preconnects_in_window_;
+  return true;
+}
+
+}  // namespace net
@@ -0,0 +1,72 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_HTTP_STREAM_PRECONNECT_PREDICTOR_H_
+#define NET_HTTP_HTTP_STREAM_PRECONNECT_PREDICTOR_H_
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/time/time.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// HttpStreamPreconnectPredictor decides when it is worthwhile to warm a
+// spare connection for an origin before the next request to it arrives.  It
+// keeps exponentially smoothed per-origin estimates of request inter-arrival
+// time and connection setup (DNS+TCP+TLS) latency, and recommends a
+// speculative preconnect when requests to an origin arrive often enough that
+// a warmed socket is likely to be used before the socket pools would close it
+// as unused, and connection setup to that origin is slow enough to be worth
+// hiding.  A global per-minute budget bounds how many speculative connections
+// may be initiated, no matter how many origins qualify.
+class NET_EXPORT_PRIVATE HttpStreamPreconnectPredictor {
+ public:
+  // Budget caps.  These are deliberately conservative: a wrong prediction
+  // costs a wasted connection on the server and local sockets.
+  static const size_t kMaxTrackedOrigins = 200;
+  static const int kMaxPreconnectsPerMinute = 6;
+  // Number of requests observed for an origin before predictions are made
+  // for it.
+  static const int kMinRequestsBeforePrediction = 3;
+
+  HttpStreamPreconnectPredictor();
+  ~HttpStreamPreconnectPredictor();
+
+  // Records a request to |origin| at time |now|.  Returns the total number
+  // of streams worth having warm for the origin's socket group (including
+  // the one the current request is about to use), or zero when no
+  // speculative connection should be made.
+  int OnRequest(const HostPortPair& origin, base::TimeTicks now);
+
+  // Records an observed connection setup latency for |origin|.
+  void OnConnectLatency(const HostPortPair& origin, base::TimeDelta latency);
+
+ private:
+  struct OriginStats {
+    OriginStats();
+
+    int request_count;
+    base::TimeTicks last_request_time;
+    // Exponentially weighted moving averages; zero until the first sample.
+    base::TimeDelta smoothed_interarrival;
+    base::TimeDelta smoothed_connect_latency;
+  };
+  typedef base::MRUCache<HostPortPair, OriginStats> OriginStatsMap;
+
+  // Returns true if the per-minute budget admits another preconnect, and
+  // charges the budget if so.
+  bool TakeBudget(base::TimeTicks now);
+
+  OriginStatsMap origins_;
+  base::TimeTicks budget_window_start_;
+  int preconnects_in_window_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpStreamPreconnectPredictor);
+};
+
+}  // namespace net
+
+#endif  // NET_HTTP_HTTP_STREAM_PRECONNECT_PREDICTOR_H_
@@ -0,0 +1,80 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_stream_preconnect_predictor.h"
+
+#include "base/time/time.h"
+#include "net/base/host_port_pair.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class HttpStreamPreconnectPredictorTest : public testing::Test {
+ protected:
+  HttpStreamPreconnectPredictorTest()
+      : origin_("www.example.com", 443),
+        now_(base::TimeTicks() + base::TimeDelta::FromMinutes(1)) {}
+
+  // Advances the test clock and records a request to |origin_|.
+  int RequestAfter(base::TimeDelta delta) {
+    now_ += delta;
+    return predictor_.OnRequest(origin_, now_);
+  }
+
+  HttpStreamPreconnectPredictor predictor_;
+  HostPortPair origin_;
+  base::TimeTicks now_;
+};
+
+TEST_F(HttpStreamPreconnectPredictorTest, NoPredictionWithoutHistory) {
+  // Without an observed connect latency, no prediction is ever made.
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(0, RequestAfter(base::TimeDelta::FromSeconds(1)));
+}
+
+TEST_F(HttpStreamPreconnectPredictorTest, PredictsBusySlowOrigin) {
+  predictor_.OnConnectLatency(origin_,
+                              base::TimeDelta::FromMilliseconds(100));
+  EXPECT_EQ(0, RequestAfter(base::TimeDelta::FromSeconds(1)));
+  EXPECT_EQ(0, RequestAfter(base::TimeDelta::FromSeconds(1)));
+  // Once kMinRequestsBeforePrediction requests have been seen, an origin
+  // with slow connects and short inter-arrival qualifies.
+  EXPECT_EQ(2, RequestAfter(base::TimeDelta::FromSeconds(1)));
+}
+
+TEST_F(HttpStreamPreconnectPredictorTest, FastConnectNotWorthWarming) {
+  predictor_.OnConnectLatency(origin_, base::TimeDelta::FromMilliseconds(1));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(0, RequestAfter(base::TimeDelta::FromSeconds(1)));
+}
+
+TEST_F(HttpStreamPreconnectPredictorTest, SparseRequestsNotPredicted) {
+  predictor_.OnConnectLatency(origin_,
+                              base::TimeDelta::FromMilliseconds(100));
+  // A warmed socket would be closed as idle long before the next request.
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(0, RequestAfter(base::TimeDelta::FromMinutes(5)));
+}
+
+TEST_F(HttpStreamPreconnectPredictorTest, BudgetCapsPreconnects) {
+  predictor_.OnConnectLatency(origin_,
+                              base::TimeDelta::FromMilliseconds(100));
+  int predicted = 0;
+  // All requests land within one budget window.
+  for (int i = 0; i < 60; ++i) {
+    if (RequestAfter(base::TimeDelta::FromMilliseconds(500)) > 0)
+      ++predicted;
+  }
+  EXPECT_EQ(HttpStreamPreconnectPredictor::kMaxPreconnectsPerMinute,
+            predicted);
+
+  // The next window starts with a fresh budget.
+  EXPECT_EQ(2, RequestAfter(base::TimeDelta::FromMinutes(1)));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,78 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_transaction_arena.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+
+namespace {
+
+// Sized so a typical transaction (request line, serialized headers, drain
+// buffer) fits in the first chunk.
+const size_t kChunkSize = 4096;
+
+const size_t kAlignment = 8;
+
+size_t AlignUp(size_t size) {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // namespace
+
+HttpTransactionArena::HttpTransactionArena()
+    : current_offset_(0), bytes_allocated_(0), bytes_reserved_(0) {
+}
+
+HttpTransactionArena::~HttpTransactionArena() {
+  for (size_t i = 0; i < chunks_.size(); ++i)
+    delete[] chunks_[i];
+}
+
+char* HttpTransactionArena::Alloc(size_t size) {
+  size = AlignUp(std::max(size, static_cast<size_t>(1)));
+  if (chunks_.empty() || current_offset_ + size > chunk_sizes_.back())
+    AddChunk(size);
+  char* result = chunks_.back() + current_offset_;
+  current_offset_ += size;
+  bytes_allocated_ += size;
+  return result;
+}
+
+base::StringPiece HttpTransactionArena::DupString(
+    const base::StringPiece& str) {
+  if (str.empty())
+    return base::StringPiece();
+  char* copy = Alloc(str.size());
+  memcpy(copy, str.data(), str.size());
+  return base::StringPiece(copy, str.size());
+}
+
+void HttpTransactionArena::Clear() {
+  for (size_t i = 1; i < chunks_.size(); ++i) {
+    delete[] chunks_[i];
+    bytes_reserved_ -= chunk_sizes_[i];
+  }
+  if (chunks_.size() > 1) {
+    chunks_.resize(1);
+    chunk_sizes_.resize(1);
+  }
+  current_offset_ = 0;
+  bytes_allocated_ = 0;
+}
+
+void HttpTransactionArena::AddChunk(size_t min_size) {
+  size_t size = std::max(min_size, kChunkSize);
+  chunks_.push_back(new char[size]);
+  chunk_sizes_.push_back(size);
+  current_offset_ = 0;
+  bytes_reserved_ += size;
+}
+
+}  // namespace net
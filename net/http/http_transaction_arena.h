@@ -0,0 +1,67 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_HTTP_TRANSACTION_ARENA_H_
+#define NET_HTTP_HTTP_TRANSACTION_ARENA_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// A bump-pointer arena for scratch allocations whose lifetime matches the
+// owning HttpNetworkTransaction.  Memory is carved out of chunks in strict
+// sequence and only ever freed wholesale, either by Clear() or by the
+// destructor, so per-allocation bookkeeping and heap round trips disappear
+// from the request setup/teardown path.
+//
+// Only use this for data that genuinely dies with the transaction.
+// Refcounted objects that escape the transaction (HttpResponseHeaders,
+// HttpAuthController, SSLCertRequestInfo) must stay on the heap.
+class NET_EXPORT_PRIVATE HttpTransactionArena {
+ public:
+  HttpTransactionArena();
+  ~HttpTransactionArena();
+
+  // Returns |size| bytes, 8-byte aligned, valid until Clear() or
+  // destruction.  Never returns NULL; allocations larger than the chunk
+  // size get a dedicated chunk.
+  char* Alloc(size_t size);
+
+  // Copies |str| into the arena and returns a piece pointing at the copy.
+  base::StringPiece DupString(const base::StringPiece& str);
+
+  // Releases every chunk except the first, which is retained and reused,
+  // since a transaction restarted for auth goes through setup again.
+  // Invalidates all outstanding allocations.
+  void Clear();
+
+  // Total bytes handed out since the last Clear().
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+  // Total bytes of chunk capacity currently held.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  // Allocates a chunk of at least |min_size| bytes and makes it current.
+  void AddChunk(size_t min_size);
+
+  std::vector<char*> chunks_;
+  std::vector<size_t> chunk_sizes_;
+  // Next free offset in the last chunk.
+  size_t current_offset_;
+  size_t bytes_allocated_;
+  size_t bytes_reserved_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpTransactionArena);
+};
+
+}  // namespace net
+
+#endif  // NET_HTTP_HTTP_TRANSACTION_ARENA_H_
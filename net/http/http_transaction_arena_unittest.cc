@@ -0,0 +1,65 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_transaction_arena.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(HttpTransactionArenaTest, AllocationsAreAlignedAndDistinct) {
+  HttpTransactionArena arena;
+  char* a = arena.Alloc(3);
+  char* b = arena.Alloc(10);
+  ASSERT_TRUE(a);
+  ASSERT_TRUE(b);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % 8);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 8);
+  // Writes to one allocation must not overlap the other.
+  memset(a, 'a', 3);
+  memset(b, 'b', 10);
+  EXPECT_EQ('a', a[2]);
+  EXPECT_EQ('b', b[0]);
+}
+
+TEST(HttpTransactionArenaTest, LargeAllocationGetsDedicatedChunk) {
+  HttpTransactionArena arena;
+  char* big = arena.Alloc(64 * 1024);
+  ASSERT_TRUE(big);
+  memset(big, 0, 64 * 1024);
+  EXPECT_GE(arena.bytes_reserved(), static_cast<size_t>(64 * 1024));
+}
+
+TEST(HttpTransactionArenaTest, DupString) {
+  HttpTransactionArena arena;
+  std::string original("GET /index.html HTTP/1.1");
+  base::StringPiece copy = arena.DupString(original);
+  EXPECT_NE(original.data(), copy.data());
+  EXPECT_EQ(original, copy);
+  EXPECT_EQ(base::StringPiece(), arena.DupString(base::StringPiece()));
+}
+
+TEST(HttpTransactionArenaTest, ClearRetainsFirstChunk) {
+  HttpTransactionArena arena;
+  arena.Alloc(100);
+  arena.Alloc(8 * 1024);  // Forces a second chunk.
+  size_t reserved_before = arena.bytes_reserved();
+  arena.Clear();
+  EXPECT_EQ(0u, arena.bytes_allocated());
+  EXPECT_LT(arena.bytes_reserved(), reserved_before);
+  EXPECT_GT(arena.bytes_reserved(), 0u);
+  // The arena is usable again after Clear().
+  char* p = arena.Alloc(16);
+  ASSERT_TRUE(p);
+  memset(p, 0, 16);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -17,6 +17,16 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
+
+// As with websocket_frame.cc, only use vector instructions where we know the
+// compiler generates them natively; emulated vector ops are unlikely to beat
+// the scalar loop.
+#if defined(COMPILER_GCC) && defined(ARCH_CPU_X86_FAMILY) && \
+    !defined(OS_NACL) && defined(__SSE2__)
+#define HTTP_UTIL_USE_SSE2_SCAN 1
+#include <emmintrin.h>
+#endif
 
 
 namespace net {
@@ -559,7 +569,7 @@ static bool IsLineSegmentContinuable(const char* begin, const char* end) {
   if (begin == end)
     return false;
 
-  const char* colon = std::find(begin, end, ':');
+  const char* colon = HttpUtil::FindColon(begin, end);
   if (colon == end)
     return false;
 
@@ -577,14 +587,41 @@ static bool IsLineSegmentContinuable(const char* begin, const char* end) {
   return true;
 }
 
-// Helper used by AssembleRawHeaders, to find the end of the status line.
-static const char* FindStatusLineEnd(const char* begin, const char* end) {
+// static
+const char* HttpUtil::FindLineEnd(const char* begin, const char* end) {
+#if defined(HTTP_UTIL_USE_SSE2_SCAN)
+  const __m128i crs = _mm_set1_epi8('\r');
+  const __m128i lfs = _mm_set1_epi8('\n');
+  while (begin + 16 <= end) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, crs),
+                                              _mm_cmpeq_epi8(block, lfs)));
+    if (mask)
+      return begin + __builtin_ctz(mask);
+    begin += 16;
+  }
+#endif
   size_t i = base::StringPiece(begin, end - begin).find_first_of("\r\n");
   if (i == base::StringPiece::npos)
     return end;
   return begin + i;
 }
 
+// static
+const char* HttpUtil::FindColon(const char* begin, const char* end) {
+#if defined(HTTP_UTIL_USE_SSE2_SCAN)
+  const __m128i colons = _mm_set1_epi8(':');
+  while (begin + 16 <= end) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, colons));
+    if (mask)
+      return begin + __builtin_ctz(mask);
+    begin += 16;
+  }
+#endif
+  return std::find(begin, end, ':');
+}
+
 // Helper used by AssembleRawHeaders, to skip past leading LWS.
 static const char* FindFirstNonLWS(const char* begin, const char* end) {
   for (const char* cur = begin; cur != end; ++cur) {
@@ -608,22 +645,27 @@ std::string HttpUtil::AssembleRawHeaders(const char* input_begin,
     input_begin += status_begin_offset;
 
   // Copy the status line.
-  const char* status_line_end = FindStatusLineEnd(input_begin, input_end);
+  const char* status_line_end = FindLineEnd(input_begin, input_end);
   raw_headers.append(input_begin, status_line_end);
 
   // After the status line, every subsequent line is a header line segment.
   // Should a segment start with LWS, it is a continuation of the previous
   // line's field-value.
 
-  // TODO(ericroman): is this too permissive? (delimits on [\r\n]+)
-  base::CStringTokenizer lines(status_line_end, input_end, "\r\n");
-
   // This variable is true when the previous line was continuable.
   bool prev_line_continuable = false;
 
-  while (lines.GetNext()) {
-    const char* line_begin = lines.token_begin();
-    const char* line_end = lines.token_end();
+  // TODO(ericroman): is this too permissive? (delimits on [\r\n]+)
+  const char* line_begin = status_line_end;
+  while (line_begin != input_end) {
+    // Skip past the line delimiters to the start of the next segment.
+    while (line_begin != input_end &&
+           (*line_begin == '\r' || *line_begin == '\n')) {
+      ++line_begin;
+    }
+    if (line_begin == input_end)
+      break;
+    const char* line_end = FindLineEnd(line_begin, input_end);
 
     if (prev_line_continuable && IsLWS(*line_begin)) {
       // Join continuation; reduce the leading LWS to a single SP.
@@ -639,6 +681,8 @@ std::string HttpUtil::AssembleRawHeaders(const char* input_begin,
       // Check if the current line can be continued.
       prev_line_continuable = IsLineSegmentContinuable(line_begin, line_end);
     }
+
+    line_begin = line_end;
   }
 
   raw_headers.append("\n\n", 2);
@@ -794,7 +838,10 @@ bool HttpUtil::HeadersIterator::GetNext() {
     name_begin_ = lines_.token_begin();
     values_end_ = lines_.token_end();
 
-    std::string::const_iterator colon(std::find(name_begin_, values_end_, ':'));
+    const char* line_begin = &*name_begin_;
+    const char* line_end = line_begin + (values_end_ - name_begin_);
+    std::string::const_iterator colon(
+        name_begin_ + (FindColon(line_begin, line_end) - line_begin));
     if (colon == values_end_)
       continue;  // skip malformed header
 
@@ -15,19 +15,77 @@
 
 namespace net {
 
-HttpVaryData::HttpVaryData() : is_valid_(false) {
+HttpVaryData::HttpVaryData()
+    : is_valid_(false),
+      last_match_valid_(false),
+      last_match_result_(false) {
 }
 
 bool HttpVaryData::Init(const HttpRequestInfo& request_info,
                         const HttpResponseHeaders& response_headers) {
-  base::MD5Context ctx;
-  base::MD5Init(&ctx);
+  is_valid_ = false;
+  last_match_valid_ = false;
+
+  std::string key;
+  if (!BuildVaryKey(request_info, response_headers, &key))
+    return false;
+
+  base::MD5Sum(key.data(), key.size(), &request_digest_);
+  return is_valid_ = true;
+}
 
+bool HttpVaryData::InitFromPickle(base::PickleIterator* iter) {
   is_valid_ = false;
+  last_match_valid_ = false;
+  const char* data;
+  if (iter->ReadBytes(&data, sizeof(request_digest_))) {
+    memcpy(&request_digest_, data, sizeof(request_digest_));
+    return is_valid_ = true;
+  }
+  return false;
+}
+
+void HttpVaryData::Persist(base::Pickle* pickle) const {
+  DCHECK(is_valid());
+  pickle->WriteBytes(&request_digest_, sizeof(request_digest_));
+}
+
+bool HttpVaryData::MatchesRequest(
+    const HttpRequestInfo& request_info,
+    const HttpResponseHeaders& cached_response_headers) const {
+  std::string key;
+  if (!BuildVaryKey(request_info, cached_response_headers, &key)) {
+    // This shouldn't happen provided the same response headers passed here
+    // were also used when initializing |this|.
+    NOTREACHED();
+    return false;
+  }
+
+  // Repeated lookups against the same entry usually carry the same request
+  // values, so remember the vary key of the last comparison and skip the MD5
+  // for exact repeats.  The key is already materialized, so comparing it in
+  // full costs nothing and cannot conflate distinct keys.
+  if (last_match_valid_ && key == last_match_key_)
+    return last_match_result_;
+
+  base::MD5Digest new_digest;
+  base::MD5Sum(key.data(), key.size(), &new_digest);
+
+  last_match_key_ = key;
+  last_match_result_ =
+      memcmp(&new_digest, &request_digest_, sizeof(request_digest_)) == 0;
+  last_match_valid_ = true;
+  return last_match_result_;
+}
+
+// static
+bool HttpVaryData::BuildVaryKey(const HttpRequestInfo& request_info,
+                                const HttpResponseHeaders& response_headers,
+                                std::string* key) {
   bool processed_header = false;
 
-  // Feed the MD5 context in the order of the Vary header enumeration.  If the
-  // Vary header repeats a header name, then that's OK.
+  // Append fields in the order of the Vary header enumeration.  If the Vary
+  // header repeats a header name, then that's OK.
   //
   // If the Vary header contains '*' then we should not construct any vary data
   // since it is all usurped by a '*'.  See section 13.6 of RFC 2616.
@@ -37,7 +95,7 @@ bool HttpVaryData::Init(const HttpRequestInfo& request_info,
   while (response_headers.EnumerateHeader(&iter, name, &request_header)) {
     if (request_header == "*")
       return false;
-    AddField(request_info, request_header, &ctx);
+    AddField(request_info, request_header, key);
     processed_header = true;
   }
 
@@ -53,44 +111,11 @@ bool HttpVaryData::Init(const HttpRequestInfo& request_info,
   //
   std::string location;
   if (response_headers.IsRedirect(&location)) {
-    AddField(request_info, "cookie", &ctx);
+    AddField(request_info, "cookie", key);
     processed_header = true;
   }
 
-  if (!processed_header)
-    return false;
-
-  base::MD5Final(&request_digest_, &ctx);
-  return is_valid_ = true;
-}
-
-bool HttpVaryData::InitFromPickle(base::PickleIterator* iter) {
-  is_valid_ = false;
-  const char* data;
-  if (iter->ReadBytes(&data, sizeof(request_digest_))) {
-    memcpy(&request_digest_, data, sizeof(request_digest_));
-    return is_valid_ = true;
-  }
-  return false;
-}
-
-void HttpVaryData::Persist(base::Pickle* pickle) const {
-  DCHECK(is_valid());
-  pickle->WriteBytes(&request_digest_, sizeof(request_digest_));
-}
-
-bool HttpVaryData::MatchesRequest(
-    const HttpRequestInfo& request_info,
-    const HttpResponseHeaders& cached_response_headers) const {
-  HttpVaryData new_vary_data;
-  if (!new_vary_data.Init(request_info, cached_response_headers)) {
-    // This shouldn't happen provided the same response headers passed here
-    // were also used when initializing |this|.
-    NOTREACHED();
-    return false;
-  }
-  return memcmp(&new_vary_data.request_digest_, &request_digest_,
-                sizeof(request_digest_)) == 0;
+  return processed_header;
 }
 
 // static
@@ -111,16 +136,14 @@ std::string HttpVaryData::GetRequestValue(
 // static
 void HttpVaryData::AddField(const HttpRequestInfo& request_info,
                             const std::string& request_header,
-                            base::MD5Context* ctx) {
-  std::string request_value = GetRequestValue(request_info, request_header);
+                            std::string* key) {
+  key->append(GetRequestValue(request_info, request_header));
 
   // Append a character that cannot appear in the request header line so that we
   // protect against case where the concatenation of two request headers could
   // look the same for a variety of values for the individual request headers.
   // For example, "foo: 12\nbar: 3" looks like "foo: 1\nbar: 23" otherwise.
-  request_value.append(1, '\n');
-
-  base::MD5Update(ctx, request_value);
+  key->append(1, '\n');
 }
 
 }  // namespace net
@@ -5,6 +5,9 @@
 #ifndef NET_HTTP_HTTP_VARY_DATA_H_
 #define NET_HTTP_HTTP_VARY_DATA_H_
 
+#include <string>
+
+#include "base/basictypes.h"
 #include "base/md5.h"
 #include "net/base/net_export.h"
 
@@ -71,16 +74,35 @@ class NET_EXPORT_PRIVATE HttpVaryData {
   static std::string GetRequestValue(const HttpRequestInfo& request_info,
                                      const std::string& request_header);
 
-  // Append to the MD5 context for the given request header.
+  // Appends the given request header's value to the vary key.
   static void AddField(const HttpRequestInfo& request_info,
                        const std::string& request_header,
-                       base::MD5Context* context);
-
-  // A digested version of the request headers corresponding to the Vary header.
+                       std::string* key);
+
+  // Builds the concatenation of the request header values named by the
+  // response's Vary header -- the input that request_digest_ is computed
+  // over.  Returns false if no vary data applies (no Vary header, or a '*'
+  // value), in which case |*key| is meaningless.
+  static bool BuildVaryKey(const HttpRequestInfo& request_info,
+                           const HttpResponseHeaders& response_headers,
+                           std::string* key);
+
+  // A digested version of the request headers corresponding to the Vary
+  // header.  MD5 remains the persisted format so that vary data written by
+  // older versions keeps matching.
   base::MD5Digest request_digest_;
 
   // True when request_digest_ contains meaningful data.
   bool is_valid_;
+
+  // Memo of the last MatchesRequest() comparison, keyed by the full vary key
+  // so that distinct keys can never be conflated.  Repeated cache hits
+  // against the same entry usually present identical request values, so this
+  // skips the MD5 recomputation.  The key lives only in memory and is never
+  // persisted.  Mutable because MatchesRequest() is logically const.
+  mutable std::string last_match_key_;
+  mutable bool last_match_valid_;
+  mutable bool last_match_result_;
 };
 
 }  // namespace net
@@ -94,6 +94,25 @@ TEST(HttpVaryDataTest, DoesVary2) {
   EXPECT_FALSE(v.MatchesRequest(b.request, *b.response.get()));
 }
 
+TEST(HttpVaryDataTest, RepeatedMatchesRequest) {
+  TestTransaction a;
+  a.Init("Foo: 1", "HTTP/1.1 200 OK\nVary: foo\n\n");
+
+  TestTransaction b;
+  b.Init("Foo: 2", "HTTP/1.1 200 OK\nVary: foo\n\n");
+
+  HttpVaryData v;
+  EXPECT_TRUE(v.Init(a.request, *a.response.get()));
+
+  // Exercise the memoized comparison: repeats of the same request values and
+  // alternation between matching and non-matching values.
+  EXPECT_TRUE(v.MatchesRequest(a.request, *a.response.get()));
+  EXPECT_TRUE(v.MatchesRequest(a.request, *a.response.get()));
+  EXPECT_FALSE(v.MatchesRequest(b.request, *b.response.get()));
+  EXPECT_FALSE(v.MatchesRequest(b.request, *b.response.get()));
+  EXPECT_TRUE(v.MatchesRequest(a.request, *a.response.get()));
+}
+
 TEST(HttpVaryDataTest, DoesntVary) {
   TestTransaction a;
   a.Init("Foo: 1", "HTTP/1.1 200 OK\nVary: foo\n\n");
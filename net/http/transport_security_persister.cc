@@ -8,6 +8,7 @@
 #include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/location.h"
@@ -78,6 +79,12 @@ const char kCreated[] = "created";
 const char kStsObserved[] = "sts_observed";
 const char kPkpObserved[] = "pkp_observed";
 const char kReportUri[] = "report-uri";
+const char kNumLabels[] = "num_labels";
+
+// The time that writes are delayed after the state becomes dirty, so that
+// bursts of changes (e.g. while loading a page full of HSTS hosts) are
+// batched into a single write.
+const int kCommitIntervalMSecs = 10000;
 
 std::string LoadState(const base::FilePath& path) {
   std::string result;
@@ -87,6 +94,16 @@ std::string LoadState(const base::FilePath& path) {
   return result;
 }
 
+// Runs on the background runner: serializes |state| as JSON and safely
+// writes it to |path|.
+void WriteState(const base::FilePath& path,
+                scoped_ptr<base::DictionaryValue> state) {
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      *state, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  base::ImportantFileWriter::WriteFileAtomically(path, json);
+}
+
 }  // namespace
 
 TransportSecurityPersister::TransportSecurityPersister(
@@ -95,7 +112,7 @@ TransportSecurityPersister::TransportSecurityPersister(
     const scoped_refptr<base::SequencedTaskRunner>& background_runner,
     bool readonly)
     : transport_security_state_(state),
-      writer_(profile_path.AppendASCII("TransportSecurity"), background_runner),
+      path_(profile_path.AppendASCII("TransportSecurity")),
       foreground_runner_(base::ThreadTaskRunnerHandle::Get()),
       background_runner_(background_runner),
       readonly_(readonly),
@@ -103,8 +120,7 @@ TransportSecurityPersister::TransportSecurityPersister(
   transport_security_state_->SetDelegate(this);
 
   base::PostTaskAndReplyWithResult(
-      background_runner_.get(), FROM_HERE,
-      base::Bind(&LoadState, writer_.path()),
+      background_runner_.get(), FROM_HERE, base::Bind(&LoadState, path_),
       base::Bind(&TransportSecurityPersister::CompleteLoad,
                  weak_ptr_factory_.GetWeakPtr()));
 }
@@ -112,8 +128,10 @@ TransportSecurityPersister::TransportSecurityPersister(
 TransportSecurityPersister::~TransportSecurityPersister() {
   DCHECK(foreground_runner_->RunsTasksOnCurrentThread());
 
-  if (writer_.HasPendingWrite())
-    writer_.DoScheduledWrite();
+  if (commit_timer_.IsRunning()) {
+    commit_timer_.Stop();
+    CommitState();
+  }
 
   transport_security_state_->SetDelegate(NULL);
 }
@@ -123,14 +141,30 @@ void TransportSecurityPersister::StateIsDirty(
   DCHECK(foreground_runner_->RunsTasksOnCurrentThread());
   DCHECK_EQ(transport_security_state_, state);
 
-  if (!readonly_)
-    writer_.ScheduleWrite(this);
+  if (readonly_ || commit_timer_.IsRunning())
+    return;
+
+  commit_timer_.Start(
+      FROM_HERE, base::TimeDelta::FromMilliseconds(kCommitIntervalMSecs),
+      base::Bind(&TransportSecurityPersister::CommitState,
+                 weak_ptr_factory_.GetWeakPtr()));
 }
 
 bool TransportSecurityPersister::SerializeData(std::string* output) {
   DCHECK(foreground_runner_->RunsTasksOnCurrentThread());
 
-  base::DictionaryValue toplevel;
+  scoped_ptr<base::DictionaryValue> toplevel = SerializeToDictionary();
+  base::JSONWriter::WriteWithOptions(
+      *toplevel, base::JSONWriter::OPTIONS_PRETTY_PRINT, output);
+  return true;
+}
+
+scoped_ptr<base::DictionaryValue>
+TransportSecurityPersister::SerializeToDictionary() {
+  DCHECK(foreground_runner_->RunsTasksOnCurrentThread());
+
+  scoped_ptr<base::DictionaryValue> output(new base::DictionaryValue);
+  base::DictionaryValue& toplevel = *output;
   base::Time now = base::Time::Now();
 
   // TODO(davidben): Fix the serialization format by splitting the on-disk
@@ -149,6 +183,10 @@ bool TransportSecurityPersister::SerializeData(std::string* output) {
     serialized->SetBoolean(kStsIncludeSubdomains, sts_state.include_subdomains);
     serialized->SetDouble(kStsObserved, sts_state.last_observed.ToDoubleT());
     serialized->SetDouble(kExpiry, sts_state.expiry.ToDoubleT());
+    if (sts_state.num_labels != 0) {
+      serialized->SetInteger(kNumLabels,
+                             static_cast<int>(sts_state.num_labels));
+    }
 
     switch (sts_state.upgrade_mode) {
       case TransportSecurityState::STSState::MODE_FORCE_HTTPS:
@@ -200,11 +238,21 @@ bool TransportSecurityPersister::SerializeData(std::string* output) {
     }
 
     serialized->SetString(kReportUri, pkp_state.report_uri.spec());
+    if (pkp_state.num_labels != 0) {
+      serialized->SetInteger(kNumLabels,
+                             static_cast<int>(pkp_state.num_labels));
+    }
   }
 
-  base::JSONWriter::WriteWithOptions(
-      toplevel, base::JSONWriter::OPTIONS_PRETTY_PRINT, output);
-  return true;
+  return output.Pass();
+}
+
+void TransportSecurityPersister::CommitState() {
+  DCHECK(foreground_runner_->RunsTasksOnCurrentThread());
+
+  scoped_ptr<base::DictionaryValue> state = SerializeToDictionary();
+  background_runner_->PostTask(
+      FROM_HERE, base::Bind(&WriteState, path_, base::Passed(&state)));
 }
 
 bool TransportSecurityPersister::LoadEntries(const std::string& serialized,
@@ -270,6 +318,15 @@ bool TransportSecurityPersister::Deserialize(const std::string& serialized,
     parsed->GetDouble(kDynamicSPKIHashesExpiry,
                       &dynamic_spki_hashes_expiry);
 
+    // Don't fail if this key is not present; state written by older versions
+    // carries no label count, and 0 means "unknown".
+    int num_labels = 0;
+    parsed->GetInteger(kNumLabels, &num_labels);
+    if (num_labels > 0) {
+      sts_state.num_labels = num_labels;
+      pkp_state.num_labels = num_labels;
+    }
+
     const base::ListValue* pins_list = NULL;
     if (parsed->GetList(kDynamicSPKIHashes, &pins_list)) {
       SPKIHashesFromListValue(*pins_list, &pkp_state.spki_hashes);
@@ -362,6 +419,8 @@ void TransportSecurityPersister::PopulateEntryWithDefaults(
   host->SetBoolean(kPkpIncludeSubdomains, false);
   host->SetDouble(kPkpObserved, 0.0);
   host->SetDouble(kDynamicSPKIHashesExpiry, 0.0);
+
+  host->SetInteger(kNumLabels, 0);
 }
 
 void TransportSecurityPersister::CompleteLoad(const std::string& state) {
@@ -21,14 +21,14 @@
 //
 // TransportSecurityState calls...
 // TransportSecurityPersister::StateIsDirty
-//   since the callback isn't allowed to block or reenter, we schedule a Task
-//   on the file task runner after some small amount of time
+//   since the callback isn't allowed to block or reenter, we start a timer
+//   (if one isn't already running) so that changes are batched together
 //
 // ...
 //
-// TransportSecurityPersister::SerializeState
-//   copies the current state of the TransportSecurityState, serializes
-//   and writes to disk.
+// TransportSecurityPersister::CommitState
+//   copies the current state of the TransportSecurityState and hands it to
+//   the background runner, which serializes it and writes it to disk.
 
 #ifndef NET_HTTP_TRANSPORT_SECURITY_PERSISTER_H_
 #define NET_HTTP_TRANSPORT_SECURITY_PERSISTER_H_
@@ -36,9 +36,10 @@
 #include <string>
 
 #include "base/files/file_path.h"
-#include "base/files/important_file_writer.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
 #include "net/base/net_export.h"
 #include "net/http/transport_security_state.h"
 
@@ -55,8 +56,7 @@ namespace net {
 // background_runner is the task runner this class should use internally to
 // perform file IO, and can optionally be associated with a different thread.
 class NET_EXPORT TransportSecurityPersister
-    : public TransportSecurityState::Delegate,
-      public base::ImportantFileWriter::DataSerializer {
+    : public TransportSecurityState::Delegate {
  public:
   TransportSecurityPersister(
       TransportSecurityState* state,
@@ -65,11 +65,12 @@ class NET_EXPORT TransportSecurityPersister
       bool readonly);
   ~TransportSecurityPersister() override;
 
-  // Called by the TransportSecurityState when it changes its state.
+  // Called by the TransportSecurityState when it changes its state. Writes
+  // are batched: the first change starts a timer and all changes made
+  // before it fires are committed to disk together, by the background
+  // runner, rather than re-serializing the full state on every change.
   void StateIsDirty(TransportSecurityState*) override;
 
-  // ImportantFileWriter::DataSerializer:
-  //
   // Serializes |transport_security_state_| into |*output|. Returns true if
   // all STS and PKP states were serialized correctly.
   //
@@ -93,13 +94,16 @@ class NET_EXPORT TransportSecurityPersister
   //     "bad_static_spki_hashes": list of strings
   //         legacy key synonym "bad_preloaded_spki_hashes"
   //     "dynamic_spki_hashes": list of strings
+  //     "num_labels": integer; the number of DNS labels in the (hashed)
+  //         domain, or 0 if unknown. Absent in state written by older
+  //         versions.
   //
   // The JSON dictionary keys are strings containing
   // Base64(SHA256(TransportSecurityState::CanonicalizeHost(domain))).
   // The reason for hashing them is so that the stored state does not
   // trivially reveal a user's browsing history to an attacker reading the
   // serialized state on disk.
-  bool SerializeData(std::string* data) override;
+  bool SerializeData(std::string* data);
 
   // Clears any existing non-static entries, and then re-populates
   // |transport_security_state_|.
@@ -109,6 +113,16 @@ class NET_EXPORT TransportSecurityPersister
   bool LoadEntries(const std::string& serialized, bool* dirty);
 
  private:
+  // Copies the current state of |transport_security_state_| into a
+  // DictionaryValue suitable for JSON serialization.
+  scoped_ptr<base::DictionaryValue> SerializeToDictionary();
+
+  // Snapshots |transport_security_state_| and posts a task to
+  // |background_runner_| to serialize the snapshot and write it to disk.
+  // Called when |commit_timer_| fires and on destruction if a commit is
+  // still pending.
+  void CommitState();
+
   // Populates |state| from the JSON string |serialized|. Returns true if
   // all entries were parsed and deserialized correctly.
   //
@@ -130,8 +144,12 @@ class NET_EXPORT TransportSecurityPersister
 
   TransportSecurityState* transport_security_state_;
 
-  // Helper for safely writing the data.
-  base::ImportantFileWriter writer_;
+  // The path of the file the state is written to.
+  const base::FilePath path_;
+
+  // Batches calls to StateIsDirty(): while the timer is running further
+  // changes do not schedule additional writes.
+  base::OneShotTimer commit_timer_;
 
   scoped_refptr<base::SequencedTaskRunner> foreground_runner_;
   scoped_refptr<base::SequencedTaskRunner> background_runner_;
@@ -134,9 +134,9 @@ TEST_F(TransportSecurityPersisterTest, SerializeData3) {
   EXPECT_TRUE(persister_->SerializeData(&serialized));
 
   // Persist the data to the file. For the test to be fast and not flaky, we
-  // just do it directly rather than call persister_->StateIsDirty. (That uses
-  // ImportantFileWriter, which has an asynchronous commit interval rather
-  // than block.) Use a different basename just for cleanliness.
+  // just do it directly rather than call persister_->StateIsDirty. (That
+  // batches writes behind an asynchronous commit interval rather than
+  // block.) Use a different basename just for cleanliness.
   base::FilePath path =
       temp_dir_.path().AppendASCII("TransportSecurityPersisterTest");
   EXPECT_TRUE(base::WriteFile(path, serialized.c_str(), serialized.size()));
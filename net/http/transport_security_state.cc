@@ -172,6 +172,36 @@ std::string HashHost(const std::string& canonicalized_host) {
   return std::string(hashed, sizeof(hashed));
 }
 
+// CountLabels returns the number of DNS labels in |canonicalized_host|,
+// which must be in the length-prefixed form produced by CanonicalizeHost.
+size_t CountLabels(const std::string& canonicalized_host) {
+  size_t labels = 0;
+  for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1)
+    labels++;
+  return labels;
+}
+
+void AddLabelCount(size_t num_labels, std::map<size_t, size_t>* counts) {
+  ++(*counts)[num_labels];
+}
+
+void RemoveLabelCount(size_t num_labels, std::map<size_t, size_t>* counts) {
+  std::map<size_t, size_t>::iterator it = counts->find(num_labels);
+  DCHECK(it != counts->end());
+  if (it == counts->end())
+    return;
+  if (--it->second == 0)
+    counts->erase(it);
+}
+
+// LabelCountMatchPossible returns true if an entry indexed in |counts| might
+// cover a hostname suffix with |num_labels| labels. Entries with an unknown
+// label count (the 0 bucket) might cover any suffix.
+bool LabelCountMatchPossible(const std::map<size_t, size_t>& counts,
+                             size_t num_labels) {
+  return counts.count(0) != 0 || counts.count(num_labels) != 0;
+}
+
 // Returns true if the intersection of |a| and |b| is not empty. If either
 // |a| or |b| is empty, returns false.
 bool HashesIntersect(const HashValueVector& a,
@@ -717,6 +747,13 @@ void TransportSecurityState::EnableSTSHost(const std::string& host,
   if (canonicalized_host.empty())
     return;
 
+  const std::string hashed_host = HashHost(canonicalized_host);
+  STSStateMap::iterator it = enabled_sts_hosts_.find(hashed_host);
+  if (it != enabled_sts_hosts_.end()) {
+    RemoveLabelCount(it->second.num_labels, &sts_label_counts_);
+    enabled_sts_hosts_.erase(it);
+  }
+
   // Only store new state when HSTS is explicitly enabled. If it is
   // disabled, remove the state from the enabled hosts.
   if (state.ShouldUpgradeToSSL()) {
@@ -724,11 +761,10 @@ void TransportSecurityState::EnableSTSHost(const std::string& host,
     // No need to store this value since it is redundant. (|canonicalized_host|
     // is the map key.)
     sts_state.domain.clear();
+    sts_state.num_labels = CountLabels(canonicalized_host);
 
-    enabled_sts_hosts_[HashHost(canonicalized_host)] = sts_state;
-  } else {
-    const std::string hashed_host = HashHost(canonicalized_host);
-    enabled_sts_hosts_.erase(hashed_host);
+    AddLabelCount(sts_state.num_labels, &sts_label_counts_);
+    enabled_sts_hosts_[hashed_host] = sts_state;
   }
 
   DirtyNotify();
@@ -742,6 +778,13 @@ void TransportSecurityState::EnablePKPHost(const std::string& host,
   if (canonicalized_host.empty())
     return;
 
+  const std::string hashed_host = HashHost(canonicalized_host);
+  PKPStateMap::iterator it = enabled_pkp_hosts_.find(hashed_host);
+  if (it != enabled_pkp_hosts_.end()) {
+    RemoveLabelCount(it->second.num_labels, &pkp_label_counts_);
+    enabled_pkp_hosts_.erase(it);
+  }
+
   // Only store new state when HPKP is explicitly enabled. If it is
   // disabled, remove the state from the enabled hosts.
   if (state.HasPublicKeyPins()) {
@@ -749,11 +792,10 @@ void TransportSecurityState::EnablePKPHost(const std::string& host,
     // No need to store this value since it is redundant. (|canonicalized_host|
     // is the map key.)
     pkp_state.domain.clear();
+    pkp_state.num_labels = CountLabels(canonicalized_host);
 
-    enabled_pkp_hosts_[HashHost(canonicalized_host)] = pkp_state;
-  } else {
-    const std::string hashed_host = HashHost(canonicalized_host);
-    enabled_pkp_hosts_.erase(hashed_host);
+    AddLabelCount(pkp_state.num_labels, &pkp_label_counts_);
+    enabled_pkp_hosts_[hashed_host] = pkp_state;
   }
 
   DirtyNotify();
@@ -817,12 +859,14 @@ bool TransportSecurityState::DeleteDynamicDataForHost(const std::string& host) {
   bool deleted = false;
   STSStateMap::iterator sts_interator = enabled_sts_hosts_.find(hashed_host);
   if (sts_interator != enabled_sts_hosts_.end()) {
+    RemoveLabelCount(sts_interator->second.num_labels, &sts_label_counts_);
     enabled_sts_hosts_.erase(sts_interator);
     deleted = true;
   }
 
   PKPStateMap::iterator pkp_iterator = enabled_pkp_hosts_.find(hashed_host);
   if (pkp_iterator != enabled_pkp_hosts_.end()) {
+    RemoveLabelCount(pkp_iterator->second.num_labels, &pkp_label_counts_);
     enabled_pkp_hosts_.erase(pkp_iterator);
     deleted = true;
   }
@@ -836,6 +880,8 @@ void TransportSecurityState::ClearDynamicData() {
   DCHECK(CalledOnValidThread());
   enabled_sts_hosts_.clear();
   enabled_pkp_hosts_.clear();
+  sts_label_counts_.clear();
+  pkp_label_counts_.clear();
 }
 
 void TransportSecurityState::DeleteAllDynamicDataSince(const base::Time& time) {
@@ -846,6 +892,7 @@ void TransportSecurityState::DeleteAllDynamicDataSince(const base::Time& time) {
   while (sts_iterator != enabled_sts_hosts_.end()) {
     if (sts_iterator->second.last_observed >= time) {
       dirtied = true;
+      RemoveLabelCount(sts_iterator->second.num_labels, &sts_label_counts_);
       enabled_sts_hosts_.erase(sts_iterator++);
       continue;
     }
@@ -857,6 +904,7 @@ void TransportSecurityState::DeleteAllDynamicDataSince(const base::Time& time) {
   while (pkp_iterator != enabled_pkp_hosts_.end()) {
     if (pkp_iterator->second.last_observed >= time) {
       dirtied = true;
+      RemoveLabelCount(pkp_iterator->second.num_labels, &pkp_label_counts_);
       enabled_pkp_hosts_.erase(pkp_iterator++);
       continue;
     }
@@ -1094,9 +1142,19 @@ bool TransportSecurityState::GetDynamicSTSState(const std::string& host,
   if (canonicalized_host.empty())
     return false;
 
+  if (sts_label_counts_.empty())
+    return false;
+
   base::Time current_time(base::Time::Now());
+  size_t num_labels = CountLabels(canonicalized_host);
+
+  for (size_t i = 0; canonicalized_host[i];
+       i += canonicalized_host[i] + 1, num_labels--) {
+    // Hashing each dot-suffix of |host| is the expensive part of a dynamic
+    // lookup, so skip suffixes whose label count matches no stored entry.
+    if (!LabelCountMatchPossible(sts_label_counts_, num_labels))
+      continue;
 
-  for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     std::string host_sub_chunk(&canonicalized_host[i],
                                canonicalized_host.size() - i);
     STSStateMap::iterator j = enabled_sts_hosts_.find(HashHost(host_sub_chunk));
@@ -1105,6 +1163,7 @@ bool TransportSecurityState::GetDynamicSTSState(const std::string& host,
 
     // If the entry is invalid, drop it.
     if (current_time > j->second.expiry) {
+      RemoveLabelCount(j->second.num_labels, &sts_label_counts_);
       enabled_sts_hosts_.erase(j);
       DirtyNotify();
       continue;
@@ -1135,9 +1194,19 @@ bool TransportSecurityState::GetDynamicPKPState(const std::string& host,
   if (canonicalized_host.empty())
     return false;
 
+  if (pkp_label_counts_.empty())
+    return false;
+
   base::Time current_time(base::Time::Now());
+  size_t num_labels = CountLabels(canonicalized_host);
+
+  for (size_t i = 0; canonicalized_host[i];
+       i += canonicalized_host[i] + 1, num_labels--) {
+    // Hashing each dot-suffix of |host| is the expensive part of a dynamic
+    // lookup, so skip suffixes whose label count matches no stored entry.
+    if (!LabelCountMatchPossible(pkp_label_counts_, num_labels))
+      continue;
 
-  for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     std::string host_sub_chunk(&canonicalized_host[i],
                                canonicalized_host.size() - i);
     PKPStateMap::iterator j = enabled_pkp_hosts_.find(HashHost(host_sub_chunk));
@@ -1146,6 +1215,7 @@ bool TransportSecurityState::GetDynamicPKPState(const std::string& host,
 
     // If the entry is invalid, drop it.
     if (current_time > j->second.expiry) {
+      RemoveLabelCount(j->second.num_labels, &pkp_label_counts_);
       enabled_pkp_hosts_.erase(j);
       DirtyNotify();
       continue;
@@ -1173,6 +1243,10 @@ void TransportSecurityState::AddOrUpdateEnabledSTSHosts(
     const STSState& state) {
   DCHECK(CalledOnValidThread());
   DCHECK(state.ShouldUpgradeToSSL());
+  STSStateMap::iterator it = enabled_sts_hosts_.find(hashed_host);
+  if (it != enabled_sts_hosts_.end())
+    RemoveLabelCount(it->second.num_labels, &sts_label_counts_);
+  AddLabelCount(state.num_labels, &sts_label_counts_);
   enabled_sts_hosts_[hashed_host] = state;
 }
 
@@ -1181,11 +1255,15 @@ void TransportSecurityState::AddOrUpdateEnabledPKPHosts(
     const PKPState& state) {
   DCHECK(CalledOnValidThread());
   DCHECK(state.HasPublicKeyPins());
+  PKPStateMap::iterator it = enabled_pkp_hosts_.find(hashed_host);
+  if (it != enabled_pkp_hosts_.end())
+    RemoveLabelCount(it->second.num_labels, &pkp_label_counts_);
+  AddLabelCount(state.num_labels, &pkp_label_counts_);
   enabled_pkp_hosts_[hashed_host] = state;
 }
 
 TransportSecurityState::STSState::STSState()
-    : upgrade_mode(MODE_DEFAULT), include_subdomains(false) {
+    : upgrade_mode(MODE_DEFAULT), include_subdomains(false), num_labels(0) {
 }
 
 TransportSecurityState::STSState::~STSState() {
@@ -1208,7 +1286,8 @@ TransportSecurityState::STSStateIterator::STSStateIterator(
 TransportSecurityState::STSStateIterator::~STSStateIterator() {
 }
 
-TransportSecurityState::PKPState::PKPState() : include_subdomains(false) {
+TransportSecurityState::PKPState::PKPState()
+    : include_subdomains(false), num_labels(0) {
 }
 
 TransportSecurityState::PKPState::~PKPState() {
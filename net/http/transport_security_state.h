@@ -81,6 +81,13 @@ class NET_EXPORT TransportSecurityState
     // Updated by |GetDynamicSTSState| and |GetStaticDomainState|.
     std::string domain;
 
+    // The number of DNS labels in the domain this state was set for, or 0
+    // if unknown (entries deserialized from old on-disk state). Dynamic
+    // entries are keyed by a hash of the domain, so this is the only
+    // information about the domain's shape that survives hashing; it lets
+    // lookups skip dot-suffixes that cannot possibly have an entry.
+    size_t num_labels;
+
     // ShouldUpgradeToSSL returns true iff HTTP requests should be internally
     // redirected to HTTPS (also if WS should be upgraded to WSS).
     bool ShouldUpgradeToSSL() const;
@@ -133,6 +140,11 @@ class NET_EXPORT TransportSecurityState
     // Updated by |GetDynamicPKPState| and |GetStaticDomainState|.
     std::string domain;
 
+    // The number of DNS labels in the domain this state was set for, or 0
+    // if unknown (entries deserialized from old on-disk state). See the
+    // comment on STSState::num_labels.
+    size_t num_labels;
+
     // An optional URI indicating where reports should be sent when this
     // pin is violated, or empty when omitted.
     GURL report_uri;
@@ -395,6 +407,17 @@ class NET_EXPORT TransportSecurityState
   STSStateMap enabled_sts_hosts_;
   PKPStateMap enabled_pkp_hosts_;
 
+  // Histograms of STSState::num_labels (PKPState::num_labels) over the
+  // entries of |enabled_sts_hosts_| (|enabled_pkp_hosts_|), mapping a label
+  // count to the number of entries with that count. The dynamic maps are
+  // keyed by SHA-256 hashes of hostnames and a lookup must hash every
+  // dot-suffix of the input, so GetDynamicSTSState() and
+  // GetDynamicPKPState() consult these to skip suffixes whose label count
+  // matches no entry. The 0 bucket counts entries whose label count is
+  // unknown; while it is non-empty every suffix must be hashed.
+  std::map<size_t, size_t> sts_label_counts_;
+  std::map<size_t, size_t> pkp_label_counts_;
+
   Delegate* delegate_;
 
   ReportSender* report_sender_;
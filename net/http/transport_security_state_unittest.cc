@@ -26,6 +26,7 @@
 #include "net/cert/test_root_certs.h"
 #include "net/cert/x509_cert_types.h"
 #include "net/cert/x509_certificate.h"
+#include "net/dns/dns_util.h"
 #include "net/http/http_util.h"
 #include "net/log/net_log.h"
 #include "net/ssl/ssl_info.h"
@@ -346,6 +347,32 @@ TEST_F(TransportSecurityStateTest, SubdomainMatches) {
   EXPECT_FALSE(state.ShouldUpgradeToSSL("notexample.test"));
 }
 
+// Tests that dynamic entries whose label count is unknown (as deserialized
+// from state written by older versions, which did not record it) are still
+// matched against every dot-suffix of a hostname.
+TEST_F(TransportSecurityStateTest, SubdomainMatchesWithUnknownLabelCount) {
+  TransportSecurityState state;
+  const base::Time current_time(base::Time::Now());
+  const base::Time expiry = current_time + base::TimeDelta::FromSeconds(1000);
+
+  std::string canonicalized_host;
+  ASSERT_TRUE(DNSDomainFromDot("example.test", &canonicalized_host));
+  const std::string hashed_host = crypto::SHA256HashString(canonicalized_host);
+
+  TransportSecurityState::STSState sts_state;
+  sts_state.last_observed = current_time;
+  sts_state.expiry = expiry;
+  sts_state.upgrade_mode = TransportSecurityState::STSState::MODE_FORCE_HTTPS;
+  sts_state.include_subdomains = true;
+  ASSERT_EQ(0u, sts_state.num_labels);
+  state.AddOrUpdateEnabledSTSHosts(hashed_host, sts_state);
+
+  EXPECT_TRUE(state.ShouldUpgradeToSSL("example.test"));
+  EXPECT_TRUE(state.ShouldUpgradeToSSL("foo.example.test"));
+  EXPECT_TRUE(state.ShouldUpgradeToSSL("foo.bar.example.test"));
+  EXPECT_FALSE(state.ShouldUpgradeToSSL("notexample.test"));
+}
+
 // Tests that a more-specific HSTS or HPKP rule overrides a less-specific rule
 // with it, regardless of the includeSubDomains bit. This is a regression test
 // for https://crbug.com/469957.
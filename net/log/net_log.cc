@@ -78,6 +78,15 @@ scoped_ptr<base::Value> NetLogStringCallback(
   return event_params.Pass();
 }
 
+scoped_ptr<base::Value> NetLogCharStringCallback(
+    const char* name,
+    const char* value,
+    NetLogCaptureMode /* capture_mode */) {
+  scoped_ptr<base::DictionaryValue> event_params(new base::DictionaryValue());
+  event_params->SetString(name, value);
+  return event_params.Pass();
+}
+
 scoped_ptr<base::Value> NetLogString16Callback(
     const char* name,
     const base::string16* value,
@@ -381,6 +390,15 @@ void NetLog::AddEntry(EventType type,
                        parameters_callback);
 
   // Notify all of the log observers.
+  //
+  // Note that delivery must stay synchronous and under |lock_|:
+  // |parameters_callback| usually points at a caller stack frame, so entries
+  // cannot be queued for asynchronous draining, and holding the lock across
+  // the callbacks is what guarantees both that deliveries are serialized
+  // (observers such as the file writers depend on this) and that no events
+  // arrive after DeprecatedRemoveObserver() returns.  The lock-free
+  // |is_capturing_| check above keeps the common no-observer configuration
+  // free of any synchronization.
   base::AutoLock lock(lock_);
   FOR_EACH_OBSERVER(ThreadSafeObserver, observers_, OnAddEntryData(entry_data));
 }
@@ -459,9 +477,35 @@ void BoundNetLog::EndEventWithNetErrorCode(NetLog::EventType event_type,
   }
 }
 
+void BoundNetLog::AddEventWithIntParams(NetLog::EventType type,
+                                        const char* name,
+                                        int value) const {
+  if (!IsCapturing())
+    return;
+  AddEvent(type, NetLog::IntCallback(name, value));
+}
+
+void BoundNetLog::EndEventWithIntParams(NetLog::EventType type,
+                                        const char* name,
+                                        int value) const {
+  if (!IsCapturing())
+    return;
+  EndEvent(type, NetLog::IntCallback(name, value));
+}
+
+void BoundNetLog::AddEventWithStringLiteral(NetLog::EventType type,
+                                            const char* name,
+                                            const char* value) const {
+  if (!IsCapturing())
+    return;
+  AddEvent(type, base::Bind(NetLogCharStringCallback, name, value));
+}
+
 void BoundNetLog::AddByteTransferEvent(NetLog::EventType event_type,
                                        int byte_count,
                                        const char* bytes) const {
+  if (!IsCapturing())
+    return;
   AddEvent(event_type, base::Bind(BytesTransferredCallback, byte_count, bytes));
 }
 
@@ -357,6 +357,21 @@ class NET_EXPORT BoundNetLog {
   void EndEventWithNetErrorCode(NetLog::EventType event_type,
                                 int net_error) const;
 
+  // Typed fast paths for hot event sites with a single simple parameter.
+  // These check IsCapturing() before binding a parameters callback, so when
+  // nothing is observing the NetLog they cost one atomic load and perform
+  // no allocation.  |name| and |value| only need to remain valid for the
+  // duration of the call.
+  void AddEventWithIntParams(NetLog::EventType type,
+                             const char* name,
+                             int value) const;
+  void EndEventWithIntParams(NetLog::EventType type,
+                             const char* name,
+                             int value) const;
+  void AddEventWithStringLiteral(NetLog::EventType type,
+                                 const char* name,
+                                 const char* value) const;
+
   // Logs a byte transfer event to the NetLog.  Determines whether to log the
   // received bytes or not based on the current logging level.
   void AddByteTransferEvent(NetLog::EventType event_type,
@@ -64,6 +64,34 @@ TEST(NetLogTest, Basic) {
   EXPECT_FALSE(entries[0].params);
 }
 
+TEST(NetLogTest, TypedFastPathEntryPoints) {
+  TestNetLog net_log;
+  BoundNetLog bound_net_log =
+      BoundNetLog::Make(&net_log, NetLog::SOURCE_SOCKET);
+
+  bound_net_log.AddEventWithIntParams(NetLog::TYPE_CANCELLED, "an_int", 5);
+  bound_net_log.EndEventWithIntParams(NetLog::TYPE_REQUEST_ALIVE, "an_int", 6);
+  bound_net_log.AddEventWithStringLiteral(NetLog::TYPE_CANCELLED, "a_string",
+                                          "hello");
+
+  TestNetLogEntry::List entries;
+  net_log.GetEntries(&entries);
+  ASSERT_EQ(3u, entries.size());
+
+  int int_value;
+  ASSERT_TRUE(entries[0].GetIntegerValue("an_int", &int_value));
+  EXPECT_EQ(5, int_value);
+  EXPECT_EQ(NetLog::PHASE_NONE, entries[0].phase);
+
+  ASSERT_TRUE(entries[1].GetIntegerValue("an_int", &int_value));
+  EXPECT_EQ(6, int_value);
+  EXPECT_EQ(NetLog::PHASE_END, entries[1].phase);
+
+  std::string string_value;
+  ASSERT_TRUE(entries[2].GetStringValue("a_string", &string_value));
+  EXPECT_EQ("hello", string_value);
+}
+
 // Check that the correct CaptureMode is sent to NetLog Value callbacks.
 TEST(NetLogTest, CaptureModes) {
   NetLogCaptureMode kModes[] = {
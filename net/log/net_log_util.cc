@@ -5,7 +5,9 @@
 #include "net/log/net_log_util.h"
 
 #include <algorithm>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
@@ -365,10 +367,10 @@ NET_EXPORT scoped_ptr<base::DictionaryValue> GetNetInfo(
 
       base::ListValue* entry_list = new base::ListValue();
 
-      HostCache::EntryMap::Iterator it(cache->entries());
-      for (; it.HasNext(); it.Advance()) {
-        const HostCache::Key& key = it.key();
-        const HostCache::Entry& entry = it.value();
+      for (HostCache::EntryMap::const_iterator it = cache->entries().begin();
+           it != cache->entries().end(); ++it) {
+        const HostCache::Key& key = it->first;
+        const HostCache::Entry& entry = it->second.first;
 
         base::DictionaryValue* entry_dict = new base::DictionaryValue();
 
@@ -376,7 +378,7 @@ NET_EXPORT scoped_ptr<base::DictionaryValue> GetNetInfo(
         entry_dict->SetInteger("address_family",
                                static_cast<int>(key.address_family));
         entry_dict->SetString("expiration",
-                              NetLog::TickCountToString(it.expiration()));
+                              NetLog::TickCountToString(it->second.second));
 
         if (entry.error != OK) {
           entry_dict->SetInteger("error", entry.error);
@@ -528,4 +530,112 @@ NET_EXPORT void CreateNetLogEntriesForActiveObjects(
   }
 }
 
+namespace {
+
+// Appends one collapsed-stack line to |out|, omitting empty phases.
+void AppendCollapsedLine(const std::string& stack,
+                         int64 millis,
+                         std::string* out) {
+  if (millis <= 0)
+    return;
+  out->append(stack);
+  out->append(" ");
+  out->append(base::Int64ToString(millis));
+  out->append("\n");
+}
+
+}  // namespace
+
+std::string GetLatencyProfileCollapsed(const base::ListValue& events) {
+  // Total time of matched BEGIN/END pairs, by event type, plus open BEGIN
+  // times keyed by (source id, event type) so concurrent requests don't
+  // steal each other's intervals.
+  std::map<int, int64> total_ms;
+  std::map<std::pair<int, int>, int64> open_begin_ms;
+
+  for (size_t i = 0; i < events.GetSize(); ++i) {
+    const base::DictionaryValue* event = NULL;
+    const base::DictionaryValue* source = NULL;
+    std::string time_string;
+    int type, phase, source_id;
+    int64 time_ms;
+    if (!events.GetDictionary(i, &event) ||
+        !event->GetString("time", &time_string) ||
+        !base::StringToInt64(time_string, &time_ms) ||
+        !event->GetDictionary("source", &source) ||
+        !source->GetInteger("id", &source_id) ||
+        !event->GetInteger("type", &type) ||
+        !event->GetInteger("phase", &phase)) {
+      continue;
+    }
+
+    switch (type) {
+      case NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST:
+      case NetLog::TYPE_TCP_CONNECT:
+      case NetLog::TYPE_SSL_CONNECT:
+      case NetLog::TYPE_HTTP_STREAM_REQUEST:
+      case NetLog::TYPE_HTTP_TRANSACTION_SEND_REQUEST:
+      case NetLog::TYPE_HTTP_TRANSACTION_READ_HEADERS:
+      case NetLog::TYPE_HTTP_TRANSACTION_READ_BODY:
+      case NetLog::TYPE_HTTP_CACHE_GET_BACKEND:
+      case NetLog::TYPE_HTTP_CACHE_OPEN_ENTRY:
+      case NetLog::TYPE_HTTP_CACHE_CREATE_ENTRY:
+      case NetLog::TYPE_HTTP_CACHE_ADD_TO_ENTRY:
+      case NetLog::TYPE_HTTP_CACHE_READ_INFO:
+      case NetLog::TYPE_HTTP_CACHE_WRITE_INFO:
+      case NetLog::TYPE_HTTP_CACHE_READ_DATA:
+      case NetLog::TYPE_HTTP_CACHE_WRITE_DATA:
+        break;
+      default:
+        continue;
+    }
+
+    std::pair<int, int> key(source_id, type);
+    if (phase == NetLog::PHASE_BEGIN) {
+      open_begin_ms[key] = time_ms;
+    } else if (phase == NetLog::PHASE_END) {
+      std::map<std::pair<int, int>, int64>::iterator it =
+          open_begin_ms.find(key);
+      if (it == open_begin_ms.end())
+        continue;
+      if (time_ms >= it->second)
+        total_ms[type] += time_ms - it->second;
+      open_begin_ms.erase(it);
+    }
+  }
+
+  const int64 dns = total_ms[NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST];
+  const int64 connect = total_ms[NetLog::TYPE_TCP_CONNECT];
+  const int64 tls = total_ms[NetLog::TYPE_SSL_CONNECT];
+  const int64 send = total_ms[NetLog::TYPE_HTTP_TRANSACTION_SEND_REQUEST];
+  const int64 ttfb = total_ms[NetLog::TYPE_HTTP_TRANSACTION_READ_HEADERS];
+  const int64 body = total_ms[NetLog::TYPE_HTTP_TRANSACTION_READ_BODY];
+  const int64 cache = total_ms[NetLog::TYPE_HTTP_CACHE_GET_BACKEND] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_OPEN_ENTRY] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_CREATE_ENTRY] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_ADD_TO_ENTRY] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_READ_INFO] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_WRITE_INFO] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_READ_DATA] +
+                      total_ms[NetLog::TYPE_HTTP_CACHE_WRITE_DATA];
+  // DNS, connect and TLS all happen while the transaction waits for a
+  // stream; whatever stream acquisition time they don't explain was spent
+  // queued behind socket pool limits.
+  int64 queue = total_ms[NetLog::TYPE_HTTP_STREAM_REQUEST] -
+                (dns + connect + tls);
+  if (queue < 0)
+    queue = 0;
+
+  std::string out;
+  AppendCollapsedLine("net;queue", queue, &out);
+  AppendCollapsedLine("net;queue;dns", dns, &out);
+  AppendCollapsedLine("net;queue;connect", connect, &out);
+  AppendCollapsedLine("net;queue;tls", tls, &out);
+  AppendCollapsedLine("net;cache", cache, &out);
+  AppendCollapsedLine("net;send", send, &out);
+  AppendCollapsedLine("net;ttfb", ttfb, &out);
+  AppendCollapsedLine("net;body", body, &out);
+  return out;
+}
+
 }  // namespace net
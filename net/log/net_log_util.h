@@ -6,6 +6,7 @@
 #define NET_LOG_NET_LOG_UTIL_H_
 
 #include <set>
+#include <string>
 
 #include "base/memory/scoped_ptr.h"
 #include "net/base/net_export.h"
@@ -13,6 +14,7 @@
 
 namespace base {
 class DictionaryValue;
+class ListValue;
 class Value;
 }
 
@@ -64,6 +66,19 @@ NET_EXPORT void CreateNetLogEntriesForActiveObjects(
     const std::set<URLRequestContext*>& contexts,
     NetLog::ThreadSafeObserver* observer);
 
+// Aggregates a captured NetLog event stream into a latency-by-phase profile
+// in collapsed flamegraph format: one "net;<phase>[;<subphase>] <millis>"
+// line per phase, suitable for feeding directly to flamegraph.pl.  |events|
+// is a list of serialized events, as written by WriteToFileNetLogObserver.
+//
+// Matched BEGIN/END pairs of the phase-defining events (DNS resolution, TCP
+// connect, TLS handshake, cache I/O, request send, header read, body read
+// and stream acquisition) are summed across all requests in the capture.
+// Stream acquisition time not covered by DNS, connect or TLS is reported as
+// queue time.  Phases with no recorded time are omitted.
+NET_EXPORT std::string GetLatencyProfileCollapsed(
+    const base::ListValue& events);
+
 }  // namespace net
 
 #endif  // NET_LOG_NET_LOG_UTIL_H_
@@ -9,6 +9,7 @@
 
 #include "base/files/file_path.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/values.h"
 #include "net/base/net_errors.h"
 #include "net/base/test_completion_callback.h"
@@ -113,6 +114,94 @@ TEST(NetLogUtil, CreateNetLogEntriesForActiveObjectsMultipleContexts) {
   }
 }
 
+// Appends a serialized event to |events| in the same shape that
+// NetLog::Entry::ToValue() produces.
+void AddSerializedEvent(base::ListValue* events,
+                        int source_id,
+                        NetLog::EventType type,
+                        NetLog::EventPhase phase,
+                        int64 time_ms) {
+  scoped_ptr<base::DictionaryValue> event(new base::DictionaryValue());
+  event->SetString("time", base::Int64ToString(time_ms));
+  scoped_ptr<base::DictionaryValue> source(new base::DictionaryValue());
+  source->SetInteger("id", source_id);
+  source->SetInteger("type", static_cast<int>(NetLog::SOURCE_URL_REQUEST));
+  event->Set("source", source.Pass());
+  event->SetInteger("type", static_cast<int>(type));
+  event->SetInteger("phase", static_cast<int>(phase));
+  events->Append(event.Pass());
+}
+
+TEST(NetLogUtil, GetLatencyProfileCollapsedEmpty) {
+  base::ListValue events;
+  EXPECT_EQ("", GetLatencyProfileCollapsed(events));
+}
+
+TEST(NetLogUtil, GetLatencyProfileCollapsed) {
+  base::ListValue events;
+  // One request: 100ms acquiring a stream, of which 30ms DNS and 20ms
+  // connect, then 10ms sending, 40ms to headers, 50ms reading the body.
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_STREAM_REQUEST,
+                     NetLog::PHASE_BEGIN, 1000);
+  AddSerializedEvent(&events, 2, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_BEGIN, 1000);
+  AddSerializedEvent(&events, 2, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_END, 1030);
+  AddSerializedEvent(&events, 3, NetLog::TYPE_TCP_CONNECT,
+                     NetLog::PHASE_BEGIN, 1030);
+  AddSerializedEvent(&events, 3, NetLog::TYPE_TCP_CONNECT, NetLog::PHASE_END,
+                     1050);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_STREAM_REQUEST,
+                     NetLog::PHASE_END, 1100);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_SEND_REQUEST,
+                     NetLog::PHASE_BEGIN, 1100);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_SEND_REQUEST,
+                     NetLog::PHASE_END, 1110);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_READ_HEADERS,
+                     NetLog::PHASE_BEGIN, 1110);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_READ_HEADERS,
+                     NetLog::PHASE_END, 1150);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_READ_BODY,
+                     NetLog::PHASE_BEGIN, 1150);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HTTP_TRANSACTION_READ_BODY,
+                     NetLog::PHASE_END, 1200);
+
+  EXPECT_EQ(
+      "net;queue 50\n"
+      "net;queue;dns 30\n"
+      "net;queue;connect 20\n"
+      "net;send 10\n"
+      "net;ttfb 40\n"
+      "net;body 50\n",
+      GetLatencyProfileCollapsed(events));
+}
+
+TEST(NetLogUtil, GetLatencyProfileCollapsedAggregatesAcrossRequests) {
+  base::ListValue events;
+  // Two concurrent resolutions on different sources; their intervals must
+  // not be confused with one another.
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_BEGIN, 1000);
+  AddSerializedEvent(&events, 2, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_BEGIN, 1010);
+  AddSerializedEvent(&events, 1, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_END, 1020);
+  AddSerializedEvent(&events, 2, NetLog::TYPE_HOST_RESOLVER_IMPL_REQUEST,
+                     NetLog::PHASE_END, 1040);
+
+  EXPECT_EQ("net;queue;dns 50\n", GetLatencyProfileCollapsed(events));
+}
+
+// Unmatched END events and events missing fields are ignored.
+TEST(NetLogUtil, GetLatencyProfileCollapsedIgnoresMalformedEvents) {
+  base::ListValue events;
+  AddSerializedEvent(&events, 1, NetLog::TYPE_TCP_CONNECT, NetLog::PHASE_END,
+                     1000);
+  events.Append(new base::DictionaryValue());
+
+  EXPECT_EQ("", GetLatencyProfileCollapsed(events));
+}
+
 }  // namespace
 
 }  // namespace net
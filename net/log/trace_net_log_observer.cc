@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <string>
 
 #include "base/json/json_writer.h"
@@ -46,6 +47,7 @@ class TracedValue : public base::trace_event::ConvertableToTraceFormat {
 }  // namespace
 
 TraceNetLogObserver::TraceNetLogObserver() : net_log_to_watch_(NULL) {
+  std::fill(sample_rates_, sample_rates_ + NetLog::SOURCE_COUNT, 1u);
 }
 
 TraceNetLogObserver::~TraceNetLogObserver() {
@@ -53,7 +55,34 @@ TraceNetLogObserver::~TraceNetLogObserver() {
   DCHECK(!net_log());
 }
 
+void TraceNetLogObserver::SetSourceTypeSampleRate(
+    NetLog::SourceType source_type,
+    uint32 sample_rate) {
+  DCHECK(!net_log_to_watch_);
+  DCHECK_GE(source_type, 0);
+  DCHECK_LT(source_type, NetLog::SOURCE_COUNT);
+  sample_rates_[source_type] = sample_rate;
+}
+
 void TraceNetLogObserver::OnAddEntry(const NetLog::Entry& entry) {
+  // Converting the parameters to a Value is the dominant capture-time cost,
+  // so don't do it for events that the trace log is going to drop anyway:
+  // the observer stays registered while a tracing session that excludes the
+  // "netlog" category is running.
+  bool category_enabled = false;
+  TRACE_EVENT_CATEGORY_GROUP_ENABLED(kNetLogTracingCategory,
+                                     &category_enabled);
+  if (!category_enabled)
+    return;
+
+  // Sample by source id rather than per event, so that BEGIN/END pairs from
+  // a sampled source stay matched up in the trace.
+  const uint32 sample_rate = sample_rates_[entry.source().type];
+  if (sample_rate != 1 &&
+      (sample_rate == 0 || entry.source().id % sample_rate != 0)) {
+    return;
+  }
+
   scoped_ptr<base::Value> params(entry.ParametersToValue());
   switch (entry.phase()) {
     case NetLog::PHASE_BEGIN:
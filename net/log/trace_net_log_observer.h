@@ -5,6 +5,7 @@
 #ifndef NET_LOG_TRACE_NET_LOG_OBSERVER_H_
 #define NET_LOG_TRACE_NET_LOG_OBSERVER_H_
 
+#include "base/basictypes.h"
 #include "base/macros.h"
 #include "base/trace_event/trace_log.h"
 #include "net/base/net_export.h"
@@ -21,6 +22,14 @@ class NET_EXPORT TraceNetLogObserver
   TraceNetLogObserver();
   ~TraceNetLogObserver() override;
 
+  // Forwards only one out of every |sample_rate| sources of type
+  // |source_type| to the trace log.  The decision is made per source id, so
+  // BEGIN/END pairs belonging to a sampled source are kept together.  A rate
+  // of 1 (the default) keeps every event; a rate of 0 drops the source type
+  // entirely.  Must be called before WatchForTraceStart().
+  void SetSourceTypeSampleRate(NetLog::SourceType source_type,
+                               uint32 sample_rate);
+
   // net::NetLog::ThreadSafeObserver implementation:
   void OnAddEntry(const NetLog::Entry& entry) override;
 
@@ -41,6 +50,9 @@ class NET_EXPORT TraceNetLogObserver
  private:
   NetLog* net_log_to_watch_;
 
+  // Per-source-type sampling rates; see SetSourceTypeSampleRate().
+  uint32 sample_rates_[NetLog::SOURCE_COUNT];
+
   DISALLOW_COPY_AND_ASSIGN(TraceNetLogObserver);
 };
 
@@ -318,6 +318,32 @@ TEST_F(TraceNetLogObserverTest, CreateObserverAfterTracingStarts) {
   EXPECT_EQ(0u, trace_events()->GetSize());
 }
 
+TEST_F(TraceNetLogObserverTest, SampleRateZeroDropsSourceType) {
+  trace_net_log_observer()->SetSourceTypeSampleRate(NetLog::SOURCE_URL_REQUEST,
+                                                    0);
+  trace_net_log_observer()->WatchForTraceStart(net_log());
+  EnableTraceLog();
+  BoundNetLog bound_net_log =
+      BoundNetLog::Make(net_log(), net::NetLog::SOURCE_URL_REQUEST);
+  bound_net_log.BeginEvent(NetLog::TYPE_URL_REQUEST_START_JOB);
+  bound_net_log.EndEvent(NetLog::TYPE_URL_REQUEST_START_JOB);
+  net_log()->AddGlobalEntry(NetLog::TYPE_CANCELLED);
+
+  EndTraceAndFlush();
+  trace_net_log_observer()->StopWatchForTraceStart();
+
+  TestNetLogEntry::List entries;
+  net_log()->GetEntries(&entries);
+  EXPECT_EQ(3u, entries.size());
+  ASSERT_EQ(1u, trace_events()->GetSize());
+
+  const base::DictionaryValue* item1 = NULL;
+  ASSERT_TRUE(trace_events()->GetDictionary(0, &item1));
+  TraceEntryInfo actual_item1 = GetTraceEntryInfoFromValue(*item1);
+  EXPECT_EQ(NetLog::EventTypeToString(NetLog::TYPE_CANCELLED),
+            actual_item1.name);
+}
+
 TEST_F(TraceNetLogObserverTest, EventsWithAndWithoutParameters) {
   trace_net_log_observer()->WatchForTraceStart(net_log());
   EnableTraceLog();
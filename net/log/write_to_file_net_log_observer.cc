@@ -17,11 +17,50 @@
 
 namespace net {
 
+namespace {
+
+// Once the in-memory write buffer reaches this size, further events are
+// dropped until the flusher thread catches up.  Dropping keeps a slow disk
+// from applying backpressure to the network thread.
+const size_t kMaxWriteBufferSize = 4 * 1024 * 1024;
+
+}  // namespace
+
+WriteToFileNetLogObserver::FlushThread::FlushThread(
+    WriteToFileNetLogObserver* observer)
+    : base::SimpleThread("NetLogFlush"), observer_(observer) {
+}
+
+WriteToFileNetLogObserver::FlushThread::~FlushThread() {
+}
+
+void WriteToFileNetLogObserver::FlushThread::Run() {
+  for (;;) {
+    {
+      base::AutoLock lock(observer_->lock_);
+      while (observer_->write_buffer_.empty() && !observer_->stop_flushing_)
+        observer_->buffer_ready_.Wait();
+      if (observer_->write_buffer_.empty())
+        return;
+      // |flush_buffer_| was drained after the previous swap, so this only
+      // exchanges pointers.
+      observer_->flush_buffer_.swap(observer_->write_buffer_);
+    }
+    observer_->WriteBuffer(observer_->flush_buffer_);
+    observer_->flush_buffer_.clear();
+  }
+}
+
 WriteToFileNetLogObserver::WriteToFileNetLogObserver()
-    : capture_mode_(NetLogCaptureMode::Default()), added_events_(false) {
+    : capture_mode_(NetLogCaptureMode::Default()),
+      buffer_ready_(&lock_),
+      added_events_(false),
+      stop_flushing_(false),
+      dropped_events_(0) {
 }
 
 WriteToFileNetLogObserver::~WriteToFileNetLogObserver() {
+  DCHECK(!flush_thread_);
 }
 
 void WriteToFileNetLogObserver::set_capture_mode(
@@ -38,6 +77,10 @@ void WriteToFileNetLogObserver::StartObserving(
   DCHECK(file.get());
   file_ = file.Pass();
   added_events_ = false;
+  stop_flushing_ = false;
+  dropped_events_ = 0;
+  write_buffer_.clear();
+  flush_buffer_.clear();
 
   // Write constants to the output file.  This allows loading files that have
   // different source and event types, as they may be added and removed
@@ -53,6 +96,11 @@ void WriteToFileNetLogObserver::StartObserving(
   // Start events array.  It's closed in StopObserving().
   fprintf(file_.get(), "\"events\": [\n");
 
+  // Start the flusher before any events can be appended so the buffer is
+  // drained from the very beginning of the capture.
+  flush_thread_.reset(new FlushThread(this));
+  flush_thread_->Start();
+
   // Add events for in progress requests if a context is given.
   if (url_request_context) {
     DCHECK(url_request_context->CalledOnValidThread());
@@ -69,6 +117,21 @@ void WriteToFileNetLogObserver::StopObserving(
     URLRequestContext* url_request_context) {
   net_log()->DeprecatedRemoveObserver(this);
 
+  // No new events can arrive now; drain whatever is buffered and stop the
+  // flusher before touching the file from this thread.
+  {
+    base::AutoLock lock(lock_);
+    stop_flushing_ = true;
+    buffer_ready_.Signal();
+  }
+  flush_thread_->Join();
+  flush_thread_.reset();
+
+  if (dropped_events_ > 0) {
+    LOG(WARNING) << "Dropped " << dropped_events_ << " NetLog events because"
+                 << " the write buffer was full.";
+  }
+
   // End events array.
   fprintf(file_.get(), "]");
 
@@ -87,14 +150,28 @@ void WriteToFileNetLogObserver::StopObserving(
 }
 
 void WriteToFileNetLogObserver::OnAddEntry(const NetLog::Entry& entry) {
-  // Add a comma and newline for every event but the first.  Newlines are needed
-  // so can load partial log files by just ignoring the last line.  For this to
-  // work, lines cannot be pretty printed.
+  // Serialize outside the lock; only the append contends with the flusher.
   scoped_ptr<base::Value> value(entry.ToValue());
   std::string json;
   base::JSONWriter::Write(*value, &json);
-  fprintf(file_.get(), "%s%s", (added_events_ ? ",\n" : ""), json.c_str());
+
+  base::AutoLock lock(lock_);
+  if (write_buffer_.size() >= kMaxWriteBufferSize) {
+    ++dropped_events_;
+    return;
+  }
+  // Add a comma and newline for every event but the first.  Newlines are needed
+  // so can load partial log files by just ignoring the last line.  For this to
+  // work, lines cannot be pretty printed.
+  if (added_events_)
+    write_buffer_.append(",\n");
+  write_buffer_.append(json);
   added_events_ = true;
+  buffer_ready_.Signal();
+}
+
+void WriteToFileNetLogObserver::WriteBuffer(const std::string& buffer) {
+  fwrite(buffer.data(), 1, buffer.size(), file_.get());
 }
 
 }  // namespace net
@@ -7,9 +7,15 @@
 
 #include <stdio.h>
 
+#include <string>
+
 #include "base/files/scoped_file.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
 #include "net/log/net_log.h"
 
 namespace base {
@@ -26,6 +32,12 @@ class URLRequestContext;
 // entries to a file specified on creation.
 //
 // The text file will contain a single JSON object.
+//
+// Events are serialized to an in-memory buffer on the thread that emits
+// them and written out in large blocks by a background flusher thread, so
+// OnAddEntry() never blocks on disk.  If the flusher falls behind and the
+// buffer fills up, further events are dropped (and counted) rather than
+// stalling the network thread.
 class NET_EXPORT WriteToFileNetLogObserver : public NetLog::ThreadSafeObserver {
  public:
   WriteToFileNetLogObserver();
@@ -62,15 +74,55 @@ class NET_EXPORT WriteToFileNetLogObserver : public NetLog::ThreadSafeObserver {
   // net::NetLog::ThreadSafeObserver implementation:
   void OnAddEntry(const NetLog::Entry& entry) override;
 
+  // Number of events dropped because the write buffer was full.  Only
+  // meaningful after StopObserving() has returned.
+  uint64 dropped_events() const { return dropped_events_; }
+
  private:
+  // Background thread which swaps the full buffer for the empty one and
+  // fwrite()s its contents to |file_|.
+  class FlushThread : public base::SimpleThread {
+   public:
+    explicit FlushThread(WriteToFileNetLogObserver* observer);
+    ~FlushThread() override;
+
+    void Run() override;
+
+   private:
+    WriteToFileNetLogObserver* const observer_;
+
+    DISALLOW_COPY_AND_ASSIGN(FlushThread);
+  };
+
+  // Writes |buffer| to |file_|.  Called on the flusher thread while |lock_|
+  // is not held, and on the observer's thread after the flusher has joined.
+  void WriteBuffer(const std::string& buffer);
+
   base::ScopedFILE file_;
 
   // The capture mode to log at.
   NetLogCaptureMode capture_mode_;
 
-  // True if OnAddEntry() has been called at least once.
+  // Guards the members below.  OnAddEntry() only appends to the current
+  // write buffer under this lock; disk IO happens with the lock released.
+  base::Lock lock_;
+  base::ConditionVariable buffer_ready_;
+
+  // Double buffer: OnAddEntry() appends to |write_buffer_|, the flusher
+  // swaps it with the (drained) |flush_buffer_| before writing.
+  std::string write_buffer_;
+  std::string flush_buffer_;
+
+  // True if an event has been appended at least once.
   bool added_events_;
 
+  // True once StopObserving() asks the flusher thread to exit.
+  bool stop_flushing_;
+
+  uint64 dropped_events_;
+
+  scoped_ptr<FlushThread> flush_thread_;
+
   DISALLOW_COPY_AND_ASSIGN(WriteToFileNetLogObserver);
 };
 
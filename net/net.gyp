@@ -430,7 +430,7 @@
       ],
     },
     {
-      'target_name': 'net_perftests',
+      'target_name': 'net_benchmarks',
       'type': 'executable',
       'dependencies': [
         '../base/base.gyp:base',
@@ -446,8 +446,14 @@
         'base/mime_sniffer_perftest.cc',
         'cookies/cookie_monster_perftest.cc',
         'disk_cache/blockfile/disk_cache_perftest.cc',
+        'extras/sqlite/sqlite_cookie_replay_perftest.cc',
         'extras/sqlite/sqlite_persistent_cookie_store_perftest.cc',
         'proxy/proxy_resolver_perftest.cc',
+        'quic/quic_utils_perftest.cc',
+        'spdy/spdy_framer_perftest.cc',
+        'test/benchmark_reporter.cc',
+        'test/benchmark_reporter.h',
+        'test/run_all_benchmarks.cc',
         'udp/udp_socket_perftest.cc',
         'websockets/websocket_frame_perftest.cc',
       ],
@@ -796,6 +802,8 @@
         'net_test_support',
       ],
       'sources': [
+        'tools/dump_cache/cache_migrator.cc',
+        'tools/dump_cache/cache_migrator.h',
         'tools/dump_cache/dump_cache.cc',
         'tools/dump_cache/dump_files.cc',
         'tools/dump_cache/dump_files.h',
@@ -1149,6 +1157,23 @@
             'tools/quic/quic_simple_server_bin.cc',
           ],
         },
+        {
+          'target_name': 'quic_send_algorithm_sweep',
+          'type': 'executable',
+          'dependencies': [
+            '../base/base.gyp:base',
+            'net',
+          ],
+          'sources': [
+            'quic/congestion_control/send_algorithm_simulator.cc',
+            'quic/congestion_control/send_algorithm_simulator.h',
+            'quic/congestion_control/send_algorithm_sweep.cc',
+            'quic/test_tools/mock_clock.cc',
+            'quic/test_tools/mock_clock.h',
+            'quic/test_tools/simple_random.cc',
+            'quic/test_tools/simple_random.h',
+          ],
+        },
         {
           'target_name': 'stress_cache',
           'type': 'executable',
@@ -1289,6 +1314,10 @@
             'net_quic_proto',
           ],
           'sources': [
+            'tools/quic/benchmark/quic_load_generator.cc',
+            'tools/quic/benchmark/quic_load_generator.h',
+            'tools/quic/quic_batch_packet_writer.cc',
+            'tools/quic/quic_batch_packet_writer.h',
             'tools/quic/quic_client.cc',
             'tools/quic/quic_client.h',
             'tools/quic/quic_default_packet_writer.cc',
@@ -1303,6 +1332,8 @@
             'tools/quic/quic_packet_writer_wrapper.h',
             'tools/quic/quic_server.cc',
             'tools/quic/quic_server.h',
+            'tools/quic/quic_sharded_server.cc',
+            'tools/quic/quic_sharded_server.h',
             'tools/quic/quic_socket_utils.cc',
             'tools/quic/quic_socket_utils.h',
           ],
@@ -1334,6 +1365,18 @@
             'tools/quic/quic_server_bin.cc',
           ],
         },
+        {
+          'target_name': 'quic_load_generator',
+          'type': 'executable',
+          'dependencies': [
+            '../base/base.gyp:base',
+            'net',
+            'epoll_quic_tools',
+          ],
+          'sources': [
+            'tools/quic/benchmark/quic_load_generator_bin.cc',
+          ],
+        },
       ]
     }],
     ['OS=="android"', {
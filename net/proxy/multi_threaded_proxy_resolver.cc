@@ -4,6 +4,7 @@
 
 #include "net/proxy/multi_threaded_proxy_resolver.h"
 
+#include <algorithm>
 #include <deque>
 #include <utility>
 #include <vector>
@@ -19,6 +20,8 @@
 #include "base/threading/non_thread_safe.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "net/base/net_errors.h"
 #include "net/log/net_log.h"
 #include "net/proxy/proxy_info.h"
@@ -28,6 +31,27 @@ namespace net {
 namespace {
 class Job;
 
+// Maximum number of queued jobs handed to an executor in one shot. Jobs are
+// only submitted in batches when the queue is deep and the PAC script is
+// measured to run quickly; see MultiThreadedProxyResolver::OnExecutorReady.
+const size_t kMaxJobsPerBatch = 4;
+
+// Only scripts whose executions recently averaged below this are
+// batch-submitted. For slower scripts the origin-thread round trip between
+// jobs is noise, and batching would just delay cancellations.
+const int kMaxBatchableRunDurationMs = 2;
+
+// Weight of the newest sample when updating the moving average of script
+// execution times: avg += (sample - avg) / kRunDurationEwmaWeight.
+const int kRunDurationEwmaWeight = 8;
+
+// How often idle worker threads are considered for reclamation.
+const int kIdleExecutorPruneIntervalSeconds = 60;
+
+// Queueing delay deemed acceptable when computing how many worker threads
+// recent load justifies keeping alive.
+const int kAcceptableQueueingDelayMs = 25;
+
 // An "executor" is a job-runner for PAC requests. It encapsulates a worker
 // thread and a synchronous ProxyResolver (which will be operated on said
 // thread.)
@@ -35,8 +59,15 @@ class Executor : public base::RefCountedThreadSafe<Executor> {
  public:
   class Coordinator {
    public:
+    // Called when |executor| has finished its last outstanding job and is
+    // ready to receive more work.
     virtual void OnExecutorReady(Executor* executor) = 0;
 
+    // Called each time a GetProxyForURL job finishes, with the time it spent
+    // executing on the worker thread. Gives the coordinator feedback about
+    // how expensive the PAC script is.
+    virtual void OnJobExecuted(base::TimeDelta run_duration) {}
+
    protected:
     virtual ~Coordinator() = default;
   };
@@ -47,7 +78,9 @@ class Executor : public base::RefCountedThreadSafe<Executor> {
   // |thread_number| is an identifier used when naming the worker thread.
   Executor(Coordinator* coordinator, int thread_number);
 
-  // Submit a job to this executor.
+  // Submit a job to this executor. May be called while earlier jobs are
+  // still outstanding, in which case the jobs run back to back on the worker
+  // thread in submission order.
   void StartJob(Job* job);
 
   // Callback for when a job has completed running on the executor's thread.
@@ -57,8 +90,8 @@ class Executor : public base::RefCountedThreadSafe<Executor> {
   // and resolver.
   void Destroy();
 
-  // Returns the outstanding job, or NULL.
-  Job* outstanding_job() const { return outstanding_job_.get(); }
+  // Returns true if no jobs are outstanding.
+  bool is_idle() const { return outstanding_jobs_.empty(); }
 
   ProxyResolver* resolver() { return resolver_.get(); }
 
@@ -81,9 +114,10 @@ class Executor : public base::RefCountedThreadSafe<Executor> {
   Coordinator* coordinator_;
   const int thread_number_;
 
-  // The currently active job for this executor (either a CreateProxyResolver or
-  // GetProxyForURL task).
-  scoped_refptr<Job> outstanding_job_;
+  // The currently active jobs for this executor (CreateProxyResolver or
+  // GetProxyForURL tasks), in the order they were posted to the worker
+  // thread. Normally at most one entry; batch submission can queue a few.
+  std::vector<scoped_refptr<Job>> outstanding_jobs_;
 
   // The synchronous resolver implementation.
   scoped_ptr<ProxyResolver> resolver_;
@@ -136,14 +170,34 @@ class MultiThreadedProxyResolver : public ProxyResolver,
   // Creates a new worker thread, and appends it to |executors_|.
   void AddNewExecutor();
 
-  // Starts the next job from |pending_jobs_| if possible.
+  // Executor::Coordinator implementation. OnExecutorReady() starts the next
+  // jobs from |pending_jobs_| if possible; OnJobExecuted() folds the
+  // measured script execution time into |avg_run_duration_|.
   void OnExecutorReady(Executor* executor) override;
+  void OnJobExecuted(base::TimeDelta run_duration) override;
+
+  // Returns the number of queued jobs to hand a ready executor in one shot.
+  size_t ChooseBatchSize() const;
+
+  // Timer callback that destroys idle worker threads (and their synchronous
+  // resolvers) beyond what recent load justifies.
+  void PruneIdleExecutors();
 
   const scoped_ptr<ProxyResolverFactory> resolver_factory_;
   const size_t max_num_threads_;
   PendingJobsQueue pending_jobs_;
   ExecutorList executors_;
   scoped_refptr<ProxyResolverScriptData> script_data_;
+
+  // Moving average of recent GetProxyForURL() execution times on the worker
+  // threads. Zero until the first job completes.
+  base::TimeDelta avg_run_duration_;
+
+  // The deepest |pending_jobs_| has been since the last prune.
+  size_t peak_pending_jobs_;
+
+  // Runs PruneIdleExecutors() while more than one executor exists.
+  base::RepeatingTimer prune_timer_;
 };
 
 // Job ---------------------------------------------
@@ -184,6 +238,11 @@ class Job : public base::RefCountedThreadSafe<Job> {
 
   Type type() const { return type_; }
 
+  // The time the job spent executing on the worker thread. Set by Run()
+  // before completion is posted back to the origin thread, so it may be read
+  // there once the job has completed.
+  base::TimeDelta run_duration() const { return run_duration_; }
+
   // Returns true if this job still has a user callback. Some jobs
   // do not have a user callback, because they were helper jobs
   // scheduled internally (for example TYPE_CREATE_RESOLVER).
@@ -206,6 +265,10 @@ class Job : public base::RefCountedThreadSafe<Job> {
       scoped_refptr<base::SingleThreadTaskRunner> origin_runner) = 0;
 
  protected:
+  void set_run_duration(base::TimeDelta run_duration) {
+    run_duration_ = run_duration;
+  }
+
   void OnJobCompleted() {
     // |executor_| will be NULL if the executor has already been deleted.
     if (executor_)
@@ -229,6 +292,7 @@ class Job : public base::RefCountedThreadSafe<Job> {
   CompletionCallback callback_;
   Executor* executor_;
   bool was_cancelled_;
+  base::TimeDelta run_duration_;
 };
 
 // CreateResolverJob -----------------------------------------------------------
@@ -313,9 +377,11 @@ class MultiThreadedProxyResolver::GetProxyForURLJob : public Job {
   void Run(scoped_refptr<base::SingleThreadTaskRunner> origin_runner) override {
     ProxyResolver* resolver = executor()->resolver();
     DCHECK(resolver);
+    base::TimeTicks start_time = base::TimeTicks::Now();
     int rv = resolver->GetProxyForURL(
         url_, &results_buf_, CompletionCallback(), NULL, net_log_);
     DCHECK_NE(rv, ERR_IO_PENDING);
+    set_run_duration(base::TimeTicks::Now() - start_time);
 
     origin_runner->PostTask(
         FROM_HERE, base::Bind(&GetProxyForURLJob::QueryComplete, this, rv));
@@ -362,8 +428,7 @@ Executor::Executor(Executor::Coordinator* coordinator, int thread_number)
 }
 
 void Executor::StartJob(Job* job) {
-  DCHECK(!outstanding_job_.get());
-  outstanding_job_ = job;
+  outstanding_jobs_.push_back(make_scoped_refptr(job));
 
   // Run the job. Once it has completed (regardless of whether it was
   // cancelled), it will invoke OnJobCompleted() on this thread.
@@ -375,9 +440,18 @@ void Executor::StartJob(Job* job) {
 }
 
 void Executor::OnJobCompleted(Job* job) {
-  DCHECK_EQ(job, outstanding_job_.get());
-  outstanding_job_ = NULL;
-  coordinator_->OnExecutorReady(this);
+  std::vector<scoped_refptr<Job>>::iterator it =
+      std::find(outstanding_jobs_.begin(), outstanding_jobs_.end(), job);
+  DCHECK(it != outstanding_jobs_.end());
+  outstanding_jobs_.erase(it);
+
+  if (job->type() == Job::TYPE_GET_PROXY_FOR_URL)
+    coordinator_->OnJobExecuted(job->run_duration());
+
+  // Signal readiness only once the whole batch has drained, so the
+  // coordinator never assigns work to an executor that is still busy.
+  if (outstanding_jobs_.empty())
+    coordinator_->OnExecutorReady(this);
 }
 
 void Executor::Destroy() {
@@ -391,11 +465,11 @@ void Executor::Destroy() {
     thread_.reset();
   }
 
-  // Cancel any outstanding job.
-  if (outstanding_job_.get()) {
-    outstanding_job_->Cancel();
+  // Cancel any outstanding jobs.
+  for (auto& job : outstanding_jobs_) {
+    job->Cancel();
     // Orphan the job (since this executor may be deleted soon).
-    outstanding_job_->set_executor(NULL);
+    job->set_executor(NULL);
   }
 
   // It is now safe to free the ProxyResolver, since all the tasks that
@@ -404,7 +478,7 @@ void Executor::Destroy() {
 
   // Null some stuff as a precaution.
   coordinator_ = NULL;
-  outstanding_job_ = NULL;
+  outstanding_jobs_.clear();
 }
 
 Executor::~Executor() {
@@ -413,7 +487,7 @@ Executor::~Executor() {
   DCHECK(!coordinator_) << "Destroy() was not called";
   DCHECK(!thread_.get());
   DCHECK(!resolver_.get());
-  DCHECK(!outstanding_job_.get());
+  DCHECK(outstanding_jobs_.empty());
 }
 
 // MultiThreadedProxyResolver --------------------------------------------------
@@ -425,7 +499,8 @@ MultiThreadedProxyResolver::MultiThreadedProxyResolver(
     scoped_refptr<Executor> executor)
     : resolver_factory_(resolver_factory.Pass()),
       max_num_threads_(max_num_threads),
-      script_data_(script_data) {
+      script_data_(script_data),
+      peak_pending_jobs_(0) {
   DCHECK(script_data_);
   executor->set_coordinator(this);
   executors_.push_back(executor);
@@ -467,6 +542,7 @@ int MultiThreadedProxyResolver::GetProxyForURL(
   // becomes available).
   job->WaitingForThread();
   pending_jobs_.push_back(job);
+  peak_pending_jobs_ = std::max(peak_pending_jobs_, pending_jobs_.size());
 
   // If we haven't already reached the thread limit, provision a new thread to
   // drain the requests more quickly.
@@ -507,7 +583,7 @@ Executor* MultiThreadedProxyResolver::FindIdleExecutor() {
   for (ExecutorList::iterator it = executors_.begin();
        it != executors_.end(); ++it) {
     Executor* executor = it->get();
-    if (!executor->outstanding_job())
+    if (executor->is_idle())
       return executor;
   }
   return NULL;
@@ -522,6 +598,15 @@ void MultiThreadedProxyResolver::AddNewExecutor() {
   executor->StartJob(
       new CreateResolverJob(script_data_, resolver_factory_.get()));
   executors_.push_back(make_scoped_refptr(executor));
+
+  // Once the pool has grown, periodically check whether load still justifies
+  // its size.
+  if (!prune_timer_.IsRunning()) {
+    prune_timer_.Start(
+        FROM_HERE,
+        base::TimeDelta::FromSeconds(kIdleExecutorPruneIntervalSeconds), this,
+        &MultiThreadedProxyResolver::PruneIdleExecutors);
+  }
 }
 
 void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
@@ -529,11 +614,71 @@ void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
   if (pending_jobs_.empty())
     return;
 
-  // Get the next job to process (FIFO). Transfer it from the pending queue
-  // to the executor.
-  scoped_refptr<Job> job = pending_jobs_.front();
-  pending_jobs_.pop_front();
-  executor->StartJob(job.get());
+  // Get the next jobs to process (FIFO). Transfer them from the pending
+  // queue to the executor. When the queue is deep and the script is known to
+  // run quickly, a small batch is handed over at once, so the worker thread
+  // does not sit through an origin-thread round trip between jobs of
+  // comparable cost to that round trip.
+  size_t batch_size = ChooseBatchSize();
+  while (batch_size-- && !pending_jobs_.empty()) {
+    scoped_refptr<Job> job = pending_jobs_.front();
+    pending_jobs_.pop_front();
+    executor->StartJob(job.get());
+  }
+}
+
+void MultiThreadedProxyResolver::OnJobExecuted(base::TimeDelta run_duration) {
+  DCHECK(CalledOnValidThread());
+  if (avg_run_duration_ == base::TimeDelta())
+    avg_run_duration_ = run_duration;
+  else
+    avg_run_duration_ += (run_duration - avg_run_duration_) /
+                         kRunDurationEwmaWeight;
+}
+
+size_t MultiThreadedProxyResolver::ChooseBatchSize() const {
+  DCHECK(!executors_.empty());
+  if (avg_run_duration_ == base::TimeDelta() ||
+      avg_run_duration_ >
+          base::TimeDelta::FromMilliseconds(kMaxBatchableRunDurationMs)) {
+    return 1;
+  }
+  // Leave enough queued jobs behind for the other executors to claim as they
+  // finish.
+  size_t fair_share = pending_jobs_.size() / executors_.size();
+  return std::min(std::max<size_t>(fair_share, 1), kMaxJobsPerBatch);
+}
+
+void MultiThreadedProxyResolver::PruneIdleExecutors() {
+  DCHECK(CalledOnValidThread());
+
+  // Keep enough executors that a queue as deep as the recent peak would
+  // drain within an acceptable delay given the measured script execution
+  // time. Anything beyond that which is sitting idle is reclaimed, together
+  // with its synchronous resolver.
+  size_t justified = 1;
+  if (avg_run_duration_ > base::TimeDelta()) {
+    int64 backlog_us = peak_pending_jobs_ * avg_run_duration_.InMicroseconds();
+    justified += static_cast<size_t>(
+        backlog_us / (kAcceptableQueueingDelayMs * 1000));
+  } else if (peak_pending_jobs_ > 0) {
+    // Jobs have queued but none have been measured yet; leave the pool alone.
+    justified = executors_.size();
+  }
+  peak_pending_jobs_ = pending_jobs_.size();
+
+  ExecutorList::iterator it = executors_.end();
+  while (executors_.size() > justified && it != executors_.begin()) {
+    --it;
+    if ((*it)->is_idle()) {
+      (*it)->Destroy();
+      it = executors_.erase(it);
+    }
+  }
+
+  // AddNewExecutor() restarts the timer if the pool grows again.
+  if (executors_.size() <= 1)
+    prune_timer_.Stop();
 }
 
 }  // namespace
@@ -24,6 +24,11 @@ class ProxyResolver;
 // of having a pool of threads, is faster performance. In particular, being
 // able to keep servicing PAC requests even if one blocks its execution.
 //
+// The pool also adapts downwards: worker threads (and their synchronous
+// resolvers) that recent load no longer justifies -- judged from the
+// observed script execution time and how deep the request queue has been --
+// are periodically reclaimed while idle.
+//
 // During initialization (CreateProxyResolver), a single thread is spun up to
 // test the script. If this succeeds, we cache the input script, and will re-use
 // this to lazily provision any new threads as needed.
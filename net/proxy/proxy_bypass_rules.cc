@@ -4,6 +4,10 @@
 
 #include "net/proxy/proxy_bypass_rules.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
 #include "base/stl_util.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_number_conversions.h"
@@ -17,6 +21,187 @@
 
 namespace net {
 
+// BypassRuleMatcher ----------------------------------------------------------
+
+// A compiled single-pass index over a list of bypass rules, so that large
+// (enterprise-sized) rule lists don't pay a virtual call plus a string
+// pattern walk per rule per request. Rules that need neither a scheme nor a
+// port check, and whose hostname pattern is exact or a plain suffix (a
+// single "*" at the front), are folded into a trie over reversed hostnames;
+// scheme-less CIDR rules are folded into a sorted list of disjoint IP
+// intervals. Anything else stays on a residual list and is evaluated with
+// Rule::Matches() as before.
+class BypassRuleMatcher {
+ public:
+  BypassRuleMatcher() {}
+
+  ~BypassRuleMatcher() {}
+
+  // Adds the (already lower-cased) hostname pattern of a scheme-less,
+  // port-less rule to the index. Returns false if the pattern uses wildcards
+  // the index cannot represent, in which case nothing was added.
+  bool AddHostnamePattern(const std::string& pattern) {
+    if (pattern.find('?') != std::string::npos)
+      return false;
+    bool is_suffix =
+        base::StartsWith(pattern, "*", base::CompareCase::SENSITIVE);
+    std::string hostname = is_suffix ? pattern.substr(1) : pattern;
+    if (hostname.find('*') != std::string::npos)
+      return false;  // Wildcards other than one leading "*".
+
+    TrieNode* node = &trie_root_;
+    for (std::string::const_reverse_iterator it = hostname.rbegin();
+         it != hostname.rend(); ++it) {
+      TrieNode*& child = node->children[*it];
+      if (!child)
+        child = new TrieNode;
+      node = child;
+    }
+    if (is_suffix)
+      node->matches_suffix = true;
+    else
+      node->matches_whole_host = true;
+    return true;
+  }
+
+  // Adds the CIDR block |ip_prefix|/|prefix_length_in_bits| of a scheme-less
+  // rule to the index.
+  void AddIPBlock(const IPAddressNumber& ip_prefix,
+                  size_t prefix_length_in_bits) {
+    // Normalize IPv4 blocks to the IPv4-mapped IPv6 space, mirroring what
+    // IPNumberMatchesPrefix() does on a family mismatch, so that a single
+    // interval list covers both families.
+    IPAddressNumber prefix = ip_prefix;
+    if (prefix.size() == kIPv4AddressSize) {
+      prefix = ConvertIPv4NumberToIPv6Number(prefix);
+      prefix_length_in_bits += 96;
+    }
+
+    // Expand the prefix to the lowest and highest addresses it contains,
+    // ignoring any stray bits beyond the prefix length (which
+    // IPNumberMatchesPrefix() also ignores).
+    IPAddressNumber low = prefix;
+    IPAddressNumber high = prefix;
+    for (size_t i = 0; i < low.size(); ++i) {
+      size_t bit = i * 8;
+      if (bit >= prefix_length_in_bits) {
+        low[i] = 0;
+        high[i] = 0xFF;
+      } else if (bit + 8 > prefix_length_in_bits) {
+        unsigned char mask = 0xFF << (8 - (prefix_length_in_bits - bit));
+        low[i] &= mask;
+        high[i] |= static_cast<unsigned char>(~mask);
+      }
+    }
+    ip_intervals_.push_back(IPInterval(low, high));
+  }
+
+  // Adds a rule which could not be indexed; Matches() will fall back to
+  // Rule::Matches() for it. |rule| must outlive this matcher.
+  void AddGeneralRule(const ProxyBypassRules::Rule* rule) {
+    general_rules_.push_back(rule);
+  }
+
+  // Called once after all rules have been added.
+  void Finalize() {
+    // Sort the IP intervals and merge any that overlap, so that a single
+    // predecessor check suffices at lookup time.
+    std::sort(ip_intervals_.begin(), ip_intervals_.end());
+    std::vector<IPInterval> merged;
+    for (std::vector<IPInterval>::const_iterator it = ip_intervals_.begin();
+         it != ip_intervals_.end(); ++it) {
+      if (!merged.empty() && it->first <= merged.back().second) {
+        if (merged.back().second < it->second)
+          merged.back().second = it->second;
+      } else {
+        merged.push_back(*it);
+      }
+    }
+    merged.swap(ip_intervals_);
+  }
+
+  // Returns true if any of the indexed or residual rules matches |url|.
+  bool Matches(const GURL& url) const {
+    if (MatchesHostname(url.host()))
+      return true;
+
+    if (!ip_intervals_.empty() && url.HostIsIPAddress()) {
+      IPAddressNumber ip_number;
+      if (ParseIPLiteralToNumber(url.HostNoBrackets(), &ip_number)) {
+        if (ip_number.size() == kIPv4AddressSize)
+          ip_number = ConvertIPv4NumberToIPv6Number(ip_number);
+        if (MatchesIP(ip_number))
+          return true;
+      }
+    }
+
+    for (std::vector<const ProxyBypassRules::Rule*>::const_iterator it =
+             general_rules_.begin();
+         it != general_rules_.end(); ++it) {
+      if ((*it)->Matches(url))
+        return true;
+    }
+    return false;
+  }
+
+ private:
+  // Node in the trie over reversed hostnames. A terminal node either
+  // requires the whole host to have been consumed (exact rule, "foo.com"),
+  // or matches any host ending here (suffix rule, "*.foo.com").
+  struct TrieNode {
+    TrieNode() : matches_whole_host(false), matches_suffix(false) {}
+    ~TrieNode() { STLDeleteValues(&children); }
+
+    bool matches_whole_host;
+    bool matches_suffix;
+    std::map<char, TrieNode*> children;
+  };
+
+  // An inclusive [low, high] range of IPv4-mapped IPv6 addresses.
+  typedef std::pair<IPAddressNumber, IPAddressNumber> IPInterval;
+
+  static bool IntervalStartsBefore(const IPInterval& lhs,
+                                   const IPInterval& rhs) {
+    return lhs.first < rhs.first;
+  }
+
+  bool MatchesHostname(const std::string& host) const {
+    const TrieNode* node = &trie_root_;
+    if (node->matches_suffix)
+      return true;  // A lone "*" rule matches everything.
+    for (std::string::const_reverse_iterator it = host.rbegin();
+         it != host.rend(); ++it) {
+      std::map<char, TrieNode*>::const_iterator child =
+          node->children.find(*it);
+      if (child == node->children.end())
+        return false;
+      node = child->second;
+      if (node->matches_suffix)
+        return true;
+    }
+    return node->matches_whole_host;
+  }
+
+  bool MatchesIP(const IPAddressNumber& ip_number) const {
+    // Find the first interval starting after |ip_number|. Only its
+    // predecessor can contain the address, since Finalize() left the
+    // intervals disjoint.
+    std::vector<IPInterval>::const_iterator it = std::upper_bound(
+        ip_intervals_.begin(), ip_intervals_.end(),
+        IPInterval(ip_number, IPAddressNumber()), &IntervalStartsBefore);
+    if (it == ip_intervals_.begin())
+      return false;
+    --it;
+    return ip_number <= it->second;
+  }
+
+  TrieNode trie_root_;
+  std::vector<IPInterval> ip_intervals_;
+  std::vector<const ProxyBypassRules::Rule*> general_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(BypassRuleMatcher);
+};
+
 namespace {
 
 class HostnamePatternRule : public ProxyBypassRules::Rule {
@@ -56,6 +241,12 @@ class HostnamePatternRule : public ProxyBypassRules::Rule {
                                    optional_port_);
   }
 
+  bool AddToMatcher(BypassRuleMatcher* matcher) const override {
+    if (!optional_scheme_.empty() || optional_port_ != -1)
+      return false;
+    return matcher->AddHostnamePattern(hostname_pattern_);
+  }
+
  private:
   const std::string optional_scheme_;
   const std::string hostname_pattern_;
@@ -118,6 +309,13 @@ class BypassIPBlockRule : public ProxyBypassRules::Rule {
                                  prefix_length_in_bits_);
   }
 
+  bool AddToMatcher(BypassRuleMatcher* matcher) const override {
+    if (!optional_scheme_.empty())
+      return false;
+    matcher->AddIPBlock(ip_prefix_, prefix_length_in_bits_);
+    return true;
+  }
+
  private:
   const std::string description_;
   const std::string optional_scheme_;
@@ -149,6 +347,10 @@ bool ProxyBypassRules::Rule::Equals(const Rule& rule) const {
   return ToString() == rule.ToString();
 }
 
+bool ProxyBypassRules::Rule::AddToMatcher(BypassRuleMatcher* matcher) const {
+  return false;
+}
+
 ProxyBypassRules::ProxyBypassRules() {
 }
 
@@ -166,11 +368,19 @@ ProxyBypassRules& ProxyBypassRules::operator=(const ProxyBypassRules& rhs) {
 }
 
 bool ProxyBypassRules::Matches(const GURL& url) const {
-  for (RuleList::const_iterator it = rules_.begin(); it != rules_.end(); ++it) {
-    if ((*it)->Matches(url))
-      return true;
+  if (!matcher_) {
+    // (Re)compile the rules into a single-pass matcher. The matcher is
+    // dropped whenever the rules change, which in practice only happens
+    // when a new configuration is applied.
+    matcher_.reset(new BypassRuleMatcher);
+    for (RuleList::const_iterator it = rules_.begin(); it != rules_.end();
+         ++it) {
+      if (!(*it)->AddToMatcher(matcher_.get()))
+        matcher_->AddGeneralRule(*it);
+    }
+    matcher_->Finalize();
   }
-  return false;
+  return matcher_->Matches(url);
 }
 
 bool ProxyBypassRules::Equals(const ProxyBypassRules& other) const {
@@ -202,11 +412,13 @@ bool ProxyBypassRules::AddRuleForHostname(const std::string& optional_scheme,
   rules_.push_back(new HostnamePatternRule(optional_scheme,
                                            hostname_pattern,
                                            optional_port));
+  matcher_.reset();
   return true;
 }
 
 void ProxyBypassRules::AddRuleToBypassLocal() {
   rules_.push_back(new BypassLocalRule);
+  matcher_.reset();
 }
 
 bool ProxyBypassRules::AddRuleFromString(const std::string& raw) {
@@ -231,6 +443,7 @@ std::string ProxyBypassRules::ToString() const {
 
 void ProxyBypassRules::Clear() {
   STLDeleteElements(&rules_);
+  matcher_.reset();
 }
 
 void ProxyBypassRules::AssignFrom(const ProxyBypassRules& other) {
@@ -292,6 +505,7 @@ bool ProxyBypassRules::AddRuleFromStringInternal(
 
     rules_.push_back(
         new BypassIPBlockRule(raw, scheme, ip_prefix, prefix_length_in_bits));
+    matcher_.reset();
 
     return true;
   }
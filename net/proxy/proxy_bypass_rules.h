@@ -8,11 +8,14 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "net/base/net_export.h"
 #include "url/gurl.h"
 
 namespace net {
 
+class BypassRuleMatcher;
+
 // ProxyBypassRules describes the set of URLs that should bypass the proxy
 // settings, as a list of rules. A URL is said to match the bypass rules
 // if it matches any one of these rules.
@@ -34,6 +37,12 @@ class NET_EXPORT ProxyBypassRules {
     // Creates a copy of this rule. (Caller is responsible for deleting it)
     virtual Rule* Clone() const = 0;
 
+    // Folds this rule into |matcher|'s compiled index, if it can be
+    // represented there. Returns false if the rule must instead be
+    // evaluated through Matches(); this is what the default implementation
+    // does.
+    virtual bool AddToMatcher(BypassRuleMatcher* matcher) const;
+
     bool Equals(const Rule& rule) const;
 
    private:
@@ -172,6 +181,11 @@ class NET_EXPORT ProxyBypassRules {
                                             bool use_hostname_suffix_matching);
 
   RuleList rules_;
+
+  // Compiled single-pass index over |rules_|, built lazily by Matches() and
+  // dropped whenever the rules change. See BypassRuleMatcher in the .cc
+  // file.
+  mutable scoped_ptr<BypassRuleMatcher> matcher_;
 };
 
 }  // namespace net
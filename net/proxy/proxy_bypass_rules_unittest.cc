@@ -310,6 +310,56 @@ TEST(ProxyBypassRulesTest, ParseAndMatchCIDR_IPv6) {
   EXPECT_FALSE(rules.Matches(GURL("http://192.169.1.1")));
 }
 
+// Exercises a mixed rule list: exact hostnames, suffixes and CIDR blocks are
+// folded into the compiled matcher, while scheme/port-restricted and
+// mid-string wildcard rules take the residual path.
+TEST(ProxyBypassRulesTest, MixedRules) {
+  ProxyBypassRules rules;
+  rules.ParseFromString(
+      "www.example.com; *.google.com; *foobar.com; 192.168.1.1/16; "
+      "https://secure.com; bar.com:443; a.*.b.com; <local>");
+
+  // Exact host: only the host itself.
+  EXPECT_TRUE(rules.Matches(GURL("http://www.example.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://sub.www.example.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://example.com")));
+
+  // Dotted suffix: subdomains but not the bare domain.
+  EXPECT_TRUE(rules.Matches(GURL("http://mail.google.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://google.com")));
+
+  // Undotted suffix: any host ending in "foobar.com".
+  EXPECT_TRUE(rules.Matches(GURL("http://foobar.com")));
+  EXPECT_TRUE(rules.Matches(GURL("http://xfoobar.com")));
+
+  // CIDR block, including the IPv4-mapped IPv6 form.
+  EXPECT_TRUE(rules.Matches(GURL("http://192.168.4.4")));
+  EXPECT_TRUE(rules.Matches(GURL("http://[::ffff:192.168.11.11]")));
+  EXPECT_FALSE(rules.Matches(GURL("http://192.169.1.1")));
+
+  // Scheme and port restrictions still apply.
+  EXPECT_TRUE(rules.Matches(GURL("https://secure.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://secure.com")));
+  EXPECT_TRUE(rules.Matches(GURL("https://bar.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://bar.com:80")));
+
+  // Mid-string wildcard.
+  EXPECT_TRUE(rules.Matches(GURL("http://a.x.b.com")));
+  EXPECT_FALSE(rules.Matches(GURL("http://a.b.com")));
+
+  // <local>.
+  EXPECT_TRUE(rules.Matches(GURL("http://localhost")));
+
+  // Adding a rule after matching must be reflected in later matches.
+  EXPECT_FALSE(rules.Matches(GURL("http://late.com")));
+  rules.AddRuleFromString("late.com");
+  EXPECT_TRUE(rules.Matches(GURL("http://late.com")));
+
+  // So must clearing.
+  rules.Clear();
+  EXPECT_FALSE(rules.Matches(GURL("http://www.example.com")));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -8,7 +8,6 @@
 #include "base/message_loop/message_loop.h"
 #include "base/path_service.h"
 #include "base/strings/string_util.h"
-#include "base/test/perf_time_logger.h"
 #include "net/base/net_errors.h"
 #include "net/dns/mock_host_resolver.h"
 #include "net/proxy/proxy_info.h"
@@ -16,6 +15,7 @@
 #include "net/proxy/proxy_resolver_factory.h"
 #include "net/proxy/proxy_resolver_v8.h"
 #include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 #if defined(OS_WIN)
@@ -134,7 +134,7 @@ class PacPerfSuiteRunner {
 
     // Start the perf timer.
     std::string perf_test_name = resolver_name_ + "_" + script_name;
-    base::PerfTimeLogger timer(perf_test_name.c_str());
+    net::test::BenchmarkReporter timer(perf_test_name.c_str());
 
     for (int i = 0; i < kNumIterations; ++i) {
       // Round-robin between URLs to resolve.
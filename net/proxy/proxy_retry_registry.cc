@@ -0,0 +1,82 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/proxy/proxy_retry_registry.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/location.h"
+
+namespace net {
+
+namespace {
+
+base::LazyInstance<ProxyRetryRegistry>::Leaky g_proxy_retry_registry =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+ProxyRetryRegistry::ProxyRetryRegistry()
+    : observers_(new base::ObserverListThreadSafe<Observer>(
+          base::ObserverListBase<Observer>::NOTIFY_EXISTING_ONLY)) {
+}
+
+ProxyRetryRegistry::~ProxyRetryRegistry() {
+}
+
+// static
+ProxyRetryRegistry* ProxyRetryRegistry::GetInstance() {
+  return g_proxy_retry_registry.Pointer();
+}
+
+void ProxyRetryRegistry::AddObserver(Observer* observer) {
+  observers_->AddObserver(observer);
+}
+
+void ProxyRetryRegistry::RemoveObserver(Observer* observer) {
+  observers_->RemoveObserver(observer);
+}
+
+void ProxyRetryRegistry::Publish(const ProxyRetryInfoMap& retry_info) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  std::vector<std::pair<std::string, ProxyRetryInfo>> updates;
+  {
+    base::AutoLock auto_lock(lock_);
+
+    // Drop entries whose retry window has passed, so a long-running process
+    // doesn't accumulate every proxy that was ever bad.
+    for (ProxyRetryInfoMap::iterator it = retry_info_.begin();
+         it != retry_info_.end();) {
+      if (it->second.bad_until <= now)
+        retry_info_.erase(it++);
+      else
+        ++it;
+    }
+
+    for (ProxyRetryInfoMap::const_iterator it = retry_info.begin();
+         it != retry_info.end(); ++it) {
+      if (it->second.bad_until <= now)
+        continue;
+      ProxyRetryInfoMap::iterator existing = retry_info_.find(it->first);
+      if (existing == retry_info_.end()) {
+        retry_info_[it->first] = it->second;
+      } else if (existing->second.bad_until < it->second.bad_until) {
+        existing->second = it->second;
+      } else {
+        continue;  // Nothing new; don't notify.
+      }
+      updates.push_back(*it);
+    }
+  }
+
+  for (std::vector<std::pair<std::string, ProxyRetryInfo>>::const_iterator
+           it = updates.begin();
+       it != updates.end(); ++it) {
+    observers_->Notify(FROM_HERE, &Observer::OnProxyMarkedBad, it->first,
+                       it->second);
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,81 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_PROXY_PROXY_RETRY_REGISTRY_H_
+#define NET_PROXY_PROXY_RETRY_REGISTRY_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
+#include "base/observer_list_threadsafe.h"
+#include "base/synchronization/lock.h"
+#include "net/base/net_export.h"
+#include "net/proxy/proxy_retry_info.h"
+
+namespace net {
+
+// Process-wide clearinghouse for bad-proxy retry information.
+//
+// Each ProxyService keeps its own ProxyRetryInfoMap describing the proxies
+// it has recently seen fail. In a process with several URLRequestContexts
+// (and hence several ProxyServices), each context would otherwise rediscover
+// a dead proxy on its own, paying a full connect timeout on live traffic
+// every time. ProxyServices publish new retry information to the registry as
+// they learn it, and observe it to fold other services' discoveries into
+// their own maps immediately.
+//
+// The registry may be used from any thread. Observers are notified on the
+// message loop they subscribed from.
+class NET_EXPORT ProxyRetryRegistry {
+ public:
+  class NET_EXPORT Observer {
+   public:
+    // Called when some ProxyService in the process has marked |proxy_key| (a
+    // ProxyServer URI) as bad until |retry_info.bad_until|. This includes
+    // the observing service's own publications; receivers are expected to
+    // merge, keeping whichever entry marks the proxy bad for longer.
+    virtual void OnProxyMarkedBad(const std::string& proxy_key,
+                                  const ProxyRetryInfo& retry_info) = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  static ProxyRetryRegistry* GetInstance();
+
+  // An observer may be added from any thread with a message loop, and is
+  // notified on that loop. It must be removed (from the same thread) before
+  // destruction.
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
+  // Publishes the entries of |retry_info| which are new to the registry, or
+  // which extend how long an already-known proxy is considered bad. Each
+  // such entry is forwarded to all observers. Entries the registry already
+  // knows about are dropped, so repeated rediscovery of the same dead proxy
+  // by several contexts does not cause notification storms.
+  void Publish(const ProxyRetryInfoMap& retry_info);
+
+ private:
+  friend struct base::DefaultLazyInstanceTraits<ProxyRetryRegistry>;
+
+  ProxyRetryRegistry();
+  ~ProxyRetryRegistry();
+
+  base::Lock lock_;
+
+  // The union of everything published, minus expired entries. Protected by
+  // |lock_|.
+  ProxyRetryInfoMap retry_info_;
+
+  const scoped_refptr<base::ObserverListThreadSafe<Observer>> observers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProxyRetryRegistry);
+};
+
+}  // namespace net
+
+#endif  // NET_PROXY_PROXY_RETRY_REGISTRY_H_
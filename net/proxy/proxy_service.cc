@@ -76,6 +76,13 @@ namespace {
 // sorts of problems.
 const int64 kDelayAfterNetworkChangesMs = 2000;
 
+// Bounds for the cache of proxy resolver decisions keyed by the request
+// URL's (scheme, host, port). The TTL limits how long a decision can outlive
+// an in-place PAC script change that the script poller has not picked up
+// yet; config and network changes clear the cache outright.
+const size_t kPacResultCacheMaxEntries = 1024;
+const int kPacResultCacheTtlMinutes = 5;
+
 // This is the default policy for polling the PAC script.
 //
 // In response to a failure, the poll intervals are:
@@ -851,6 +858,12 @@ class ProxyService::PacRequest
     // DidFinishResolvingProxy() runs.
     resolve_job_ = nullptr;
 
+    // A successful script run is the authoritative decision for this
+    // destination; remember it before DidFinishResolvingProxy() reorders the
+    // list around this particular request's bad proxies.
+    if (script_executed && result_code == OK)
+      service_->AddToPacResultCache(url_, results_->proxy_list());
+
     // Note that DidFinishResolvingProxy might modify |results_|.
     int rv = service_->DidFinishResolvingProxy(
         url_, load_flags_, network_delegate_, results_, result_code, net_log_,
@@ -924,6 +937,7 @@ ProxyService::ProxyService(scoped_ptr<ProxyConfigService> config_service,
                            NetLog* net_log)
     : resolver_factory_(resolver_factory.Pass()),
       next_config_id_(1),
+      pac_result_cache_(kPacResultCacheMaxEntries),
       current_state_(STATE_NONE),
       net_log_(net_log),
       stall_proxy_auto_config_delay_(
@@ -931,6 +945,7 @@ ProxyService::ProxyService(scoped_ptr<ProxyConfigService> config_service,
       quick_check_enabled_(true) {
   NetworkChangeNotifier::AddIPAddressObserver(this);
   NetworkChangeNotifier::AddDNSObserver(this);
+  ProxyRetryRegistry::GetInstance()->AddObserver(this);
   ResetConfigService(config_service.Pass());
 }
 
@@ -1056,6 +1071,15 @@ int ProxyService::ResolveProxyHelper(const GURL& raw_url,
     return rv;
   }
 
+  // Check for a fresh decision from an earlier script run for the same
+  // (scheme, host, port) before dispatching to the proxy resolver.
+  if (current_state_ == STATE_READY && LookupInPacResultCache(url, result)) {
+    rv = DidFinishResolvingProxy(
+        url, load_flags, network_delegate, result, OK, net_log,
+        callback.is_null() ? TimeTicks() : TimeTicks::Now(), false);
+    return rv;
+  }
+
   if (callback.is_null())
     return ERR_IO_PENDING;
 
@@ -1126,7 +1150,37 @@ int ProxyService::TryToCompleteSynchronously(const GURL& url,
   return OK;
 }
 
+bool ProxyService::LookupInPacResultCache(const GURL& url,
+                                          ProxyInfo* results) {
+  // Only decisions made by the proxy resolver are cached; manual settings
+  // are already applied synchronously.
+  if (!config_.HasAutomaticSettings())
+    return false;
+
+  const ProxyList* cached =
+      pac_result_cache_.Get(url.GetOrigin().spec(), TimeTicks::Now());
+  UMA_HISTOGRAM_BOOLEAN("Net.ProxyService.PacResultCacheHit", cached != NULL);
+  if (!cached)
+    return false;
+
+  results->UseProxyList(*cached);
+  // Annotate the result the same way PacRequest does after a script run.
+  results->config_id_ = config_.id();
+  results->config_source_ = config_.source();
+  results->did_use_pac_script_ = true;
+  return true;
+}
+
+void ProxyService::AddToPacResultCache(const GURL& url,
+                                       const ProxyList& proxy_list) {
+  TimeTicks now = TimeTicks::Now();
+  pac_result_cache_.Put(
+      url.GetOrigin().spec(), proxy_list, now,
+      now + TimeDelta::FromMinutes(kPacResultCacheTtlMinutes));
+}
+
 ProxyService::~ProxyService() {
+  ProxyRetryRegistry::GetInstance()->RemoveObserver(this);
   NetworkChangeNotifier::RemoveIPAddressObserver(this);
   NetworkChangeNotifier::RemoveDNSObserver(this);
   config_service_->RemoveObserver(this);
@@ -1298,6 +1352,9 @@ bool ProxyService::MarkProxiesAsBadUntil(
   result.proxy_list_.UpdateRetryInfoOnFallback(&proxy_retry_info_, retry_delay,
                                                false, additional_bad_proxies,
                                                OK, net_log);
+  // Share the new knowledge with the other ProxyServices in this process.
+  // The registry drops the entries it has already seen.
+  ProxyRetryRegistry::GetInstance()->Publish(proxy_retry_info_);
   return result.proxy_list_.size() > (additional_bad_proxies.size() + 1);
 }
 
@@ -1325,6 +1382,11 @@ void ProxyService::ReportSuccess(const ProxyInfo& result,
     else if (existing->second.bad_until < iter->second.bad_until)
       existing->second.bad_until = iter->second.bad_until;
   }
+
+  // Share the new knowledge with the other ProxyServices in this process.
+  // The registry drops the entries it has already seen.
+  ProxyRetryRegistry::GetInstance()->Publish(new_retry_info);
+
   if (net_log_) {
     net_log_->AddGlobalEntry(
         NetLog::TYPE_BAD_PROXY_LIST_REPORTED,
@@ -1332,6 +1394,18 @@ void ProxyService::ReportSuccess(const ProxyInfo& result,
   }
 }
 
+void ProxyService::OnProxyMarkedBad(const std::string& proxy_key,
+                                    const ProxyRetryInfo& retry_info) {
+  DCHECK(CalledOnValidThread());
+  // Merge, keeping whichever entry marks the proxy bad for longer. Entries
+  // this service itself published come back around as no-ops.
+  ProxyRetryInfoMap::iterator existing = proxy_retry_info_.find(proxy_key);
+  if (existing == proxy_retry_info_.end())
+    proxy_retry_info_[proxy_key] = retry_info;
+  else if (existing->second.bad_until < retry_info.bad_until)
+    existing->second.bad_until = retry_info.bad_until;
+}
+
 void ProxyService::CancelPacRequest(PacRequest* req) {
   DCHECK(CalledOnValidThread());
   DCHECK(req);
@@ -1461,6 +1535,7 @@ ProxyService::State ProxyService::ResetProxyConfig(bool reset_fetched_config) {
 
   permanent_error_ = OK;
   proxy_retry_info_.clear();
+  pac_result_cache_.Clear();
   script_poller_.reset();
   init_proxy_resolver_.reset();
   SuspendAllPendingRequests();
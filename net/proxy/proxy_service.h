@@ -15,12 +15,14 @@
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/non_thread_safe.h"
 #include "net/base/completion_callback.h"
+#include "net/base/expiring_cache.h"
 #include "net/base/load_states.h"
 #include "net/base/net_export.h"
 #include "net/base/network_change_notifier.h"
 #include "net/log/net_log.h"
 #include "net/proxy/proxy_config_service.h"
 #include "net/proxy/proxy_info.h"
+#include "net/proxy/proxy_retry_registry.h"
 #include "net/proxy/proxy_server.h"
 
 class GURL;
@@ -47,6 +49,7 @@ class ProxyScriptFetcher;
 class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
                                 public NetworkChangeNotifier::DNSObserver,
                                 public ProxyConfigService::Observer,
+                                public ProxyRetryRegistry::Observer,
                                 NON_EXPORTED_BASE(public base::NonThreadSafe) {
  public:
   static const size_t kDefaultNumPacThreads = 4;
@@ -226,6 +229,14 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
     proxy_retry_info_.clear();
   }
 
+  // Empties the cache of proxy resolver decisions. This happens automatically
+  // whenever the configuration or network changes; it only needs to be called
+  // manually if the PAC script's output changed in place without either of
+  // those (e.g. a script that consults external state).
+  void ClearPacResultCache() {
+    pac_result_cache_.Clear();
+  }
+
   // Forces refetching the proxy configuration, and applying it.
   // This re-does everything from fetching the system configuration,
   // to downloading and testing the PAC files.
@@ -326,6 +337,15 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
                                  NetworkDelegate* network_delegate,
                                  ProxyInfo* result);
 
+  // Returns true and fills |results| from a previously cached proxy resolver
+  // decision for |url|'s (scheme, host, port), if a fresh one exists. |url|
+  // must already have been passed through SimplifyUrlForRequest().
+  bool LookupInPacResultCache(const GURL& url, ProxyInfo* results);
+
+  // Remembers the proxy resolver's decision |proxy_list| for |url|'s
+  // (scheme, host, port).
+  void AddToPacResultCache(const GURL& url, const ProxyList& proxy_list);
+
   // Identical to ResolveProxy, except that |callback| is permitted to be null.
   // if |callback.is_null()|, this function becomes a thin wrapper around
   // |TryToCompleteSynchronously|.
@@ -385,6 +405,13 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
       const ProxyConfig& config,
       ProxyConfigService::ConfigAvailability availability) override;
 
+  // ProxyRetryRegistry::Observer
+  // Folds retry information published by another ProxyService in this
+  // process into |proxy_retry_info_|, so this context skips proxies the
+  // other context has already found to be dead.
+  void OnProxyMarkedBad(const std::string& proxy_key,
+                        const ProxyRetryInfo& retry_info) override;
+
   scoped_ptr<ProxyConfigService> config_service_;
   scoped_ptr<ProxyResolverFactory> resolver_factory_;
   scoped_ptr<ProxyResolver> resolver_;
@@ -406,6 +433,16 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // Map of the known bad proxies and the information about the retry time.
   ProxyRetryInfoMap proxy_retry_info_;
 
+  // Recent proxy resolver decisions, keyed by the request URL's
+  // (scheme, host, port). PAC scripts overwhelmingly branch only on the
+  // host, so repeated resolves of the same destination can skip the resolver
+  // until the entry expires or the configuration or network changes (which
+  // clear the cache via ResetProxyConfig()).
+  ExpiringCache<std::string,
+                ProxyList,
+                base::TimeTicks,
+                std::less<base::TimeTicks>> pac_result_cache_;
+
   // Set of pending/inprogress requests.
   PendingRequests pending_requests_;
 
@@ -500,6 +500,86 @@ TEST_F(ProxyServiceTest, PAC) {
       entries, 4, NetLog::TYPE_PROXY_SERVICE));
 }
 
+// Test that a successful PAC decision is memoized per (scheme, host, port),
+// and that the memoized decision is dropped when the configuration changes.
+TEST_F(ProxyServiceTest, PAC_ResultIsMemoized) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+
+  MockAsyncProxyResolver resolver;
+  MockAsyncProxyResolverFactory* factory =
+      new MockAsyncProxyResolverFactory(false);
+
+  ProxyService service(make_scoped_ptr(config_service),
+                       make_scoped_ptr(factory), NULL);
+
+  ProxyInfo info1;
+  TestCompletionCallback callback1;
+  int rv = service.ResolveProxy(GURL("http://www.google.com/path1"),
+                                LOAD_NORMAL, &info1, callback1.callback(), NULL,
+                                NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  factory->pending_requests()[0]->CompleteNowWithForwarder(OK, &resolver);
+
+  ASSERT_EQ(1u, resolver.pending_requests().size());
+  resolver.pending_requests()[0]->results()->UseNamedProxy("foopy:8080");
+  resolver.pending_requests()[0]->CompleteNow(OK);
+
+  EXPECT_EQ(OK, callback1.WaitForResult());
+  EXPECT_EQ("foopy:8080", info1.proxy_server().ToURI());
+
+  // A second request for the same (scheme, host, port) -- the path differs --
+  // completes synchronously from the memoized decision, without reaching the
+  // resolver.
+  ProxyInfo info2;
+  TestCompletionCallback callback2;
+  rv = service.ResolveProxy(GURL("http://www.google.com/path2"), LOAD_NORMAL,
+                            &info2, callback2.callback(), NULL, NULL,
+                            BoundNetLog());
+  EXPECT_EQ(OK, rv);
+  EXPECT_TRUE(resolver.pending_requests().empty());
+  EXPECT_EQ("foopy:8080", info2.proxy_server().ToURI());
+  EXPECT_TRUE(info2.did_use_pac_script());
+
+  // A different scheme for the same host is a different key, and must reach
+  // the resolver.
+  ProxyInfo info3;
+  TestCompletionCallback callback3;
+  rv = service.ResolveProxy(GURL("https://www.google.com/"), LOAD_NORMAL,
+                            &info3, callback3.callback(), NULL, NULL,
+                            BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  ASSERT_EQ(1u, resolver.pending_requests().size());
+  resolver.pending_requests()[0]->results()->UseNamedProxy("foopy2:8080");
+  resolver.pending_requests()[0]->CompleteNow(OK);
+
+  EXPECT_EQ(OK, callback3.WaitForResult());
+  EXPECT_EQ("foopy2:8080", info3.proxy_server().ToURI());
+
+  // Reloading the configuration drops all memoized decisions, so the next
+  // request reaches the resolver again (after the PAC script is set up once
+  // more).
+  service.ForceReloadProxyConfig();
+
+  ProxyInfo info4;
+  TestCompletionCallback callback4;
+  rv = service.ResolveProxy(GURL("http://www.google.com/path1"), LOAD_NORMAL,
+                            &info4, callback4.callback(), NULL, NULL,
+                            BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  factory->pending_requests()[0]->CompleteNowWithForwarder(OK, &resolver);
+
+  ASSERT_EQ(1u, resolver.pending_requests().size());
+  resolver.pending_requests()[0]->results()->UseNamedProxy("foopy3:8080");
+  resolver.pending_requests()[0]->CompleteNow(OK);
+
+  EXPECT_EQ(OK, callback4.WaitForResult());
+  EXPECT_EQ("foopy3:8080", info4.proxy_server().ToURI());
+}
+
 // Test that the proxy resolver does not see the URL's username/password
 // or its reference section.
 TEST_F(ProxyServiceTest, PAC_NoIdentityOrHash) {
@@ -1180,6 +1260,10 @@ TEST_F(ProxyServiceTest, ProxyFallback) {
   EXPECT_EQ(ERR_PROXY_CONNECTION_FAILED,
             test_delegate.proxy_fallback_net_error());
 
+  // The PAC script is about to return a different list for the same URL;
+  // drop the memoized decision so the resolver runs again.
+  service.ClearPacResultCache();
+
   TestCompletionCallback callback3;
   rv = service.ResolveProxy(url, LOAD_NORMAL, &info, callback3.callback(), NULL,
                             NULL, BoundNetLog());
@@ -1238,7 +1322,9 @@ TEST_F(ProxyServiceTest, ProxyFallback) {
   EXPECT_EQ(proxy_resolve_start_time, info.proxy_resolve_start_time());
   EXPECT_EQ(proxy_resolve_end_time, info.proxy_resolve_end_time());
 
-  // Look up proxies again
+  // Look up proxies again. The PAC script will return yet another list, so
+  // drop the memoized decision again.
+  service.ClearPacResultCache();
   TestCompletionCallback callback7;
   rv = service.ResolveProxy(url, LOAD_NORMAL, &info, callback7.callback(), NULL,
                             NULL, BoundNetLog());
@@ -1488,7 +1574,9 @@ TEST_F(ProxyServiceTest, ProxyFallback_BadConfig) {
   EXPECT_FALSE(info.is_direct());
   EXPECT_EQ("foopy2:9090", info.proxy_server().ToURI());
 
-  // Fake a PAC failure.
+  // Fake a PAC failure. First drop the memoized decision from the earlier
+  // successful run, so the next resolve reaches the resolver.
+  service.ClearPacResultCache();
   ProxyInfo info2;
   TestCompletionCallback callback3;
   rv = service.ResolveProxy(url, LOAD_NORMAL, &info2, callback3.callback(),
@@ -1586,7 +1674,9 @@ TEST_F(ProxyServiceTest, ProxyFallback_BadConfigMandatory) {
   EXPECT_FALSE(info.is_direct());
   EXPECT_EQ("foopy2:9090", info.proxy_server().ToURI());
 
-  // Fake a PAC failure.
+  // Fake a PAC failure. First drop the memoized decision from the earlier
+  // successful run, so the next resolve reaches the resolver.
+  service.ClearPacResultCache();
   ProxyInfo info2;
   TestCompletionCallback callback3;
   rv = service.ResolveProxy(url, LOAD_NORMAL, &info2, callback3.callback(),
@@ -1695,6 +1785,41 @@ TEST_F(ProxyServiceTest, MarkProxiesAsBadTests) {
   }
 }
 
+TEST_F(ProxyServiceTest, RetryInfoSharedAcrossServices) {
+  // Bad-proxy knowledge published by one ProxyService should show up in the
+  // retry map of the other services in the process.
+  ProxyConfig config;
+  config.proxy_rules().ParseFromString(
+      "http=sharedbad1:8080;http=sharedbad2:8080");
+  config.set_auto_detect(false);
+
+  ProxyService service1(make_scoped_ptr(new MockProxyConfigService(config)),
+                        nullptr, NULL);
+  ProxyService service2(make_scoped_ptr(new MockProxyConfigService(config)),
+                        nullptr, NULL);
+
+  ProxyList proxy_list;
+  for (const ProxyServer& proxy_server :
+       config.proxy_rules().proxies_for_http.GetAll()) {
+    proxy_list.AddProxyServer(proxy_server);
+  }
+  ProxyInfo proxy_info;
+  proxy_info.UseProxyList(proxy_list);
+
+  service1.MarkProxiesAsBadUntil(proxy_info, base::TimeDelta::FromMinutes(1),
+                                 std::vector<ProxyServer>(), BoundNetLog());
+  EXPECT_EQ(1u, service1.proxy_retry_info().size());
+  EXPECT_TRUE(service2.proxy_retry_info().empty());
+
+  // The registry notification is delivered through the message loop.
+  base::MessageLoop::current()->RunUntilIdle();
+  ASSERT_EQ(1u, service2.proxy_retry_info().size());
+  EXPECT_EQ(service1.proxy_retry_info().begin()->first,
+            service2.proxy_retry_info().begin()->first);
+  EXPECT_EQ(service1.proxy_retry_info().begin()->second.bad_until,
+            service2.proxy_retry_info().begin()->second.bad_until);
+}
+
 TEST_F(ProxyServiceTest, PerProtocolProxyTests) {
   ProxyConfig config;
   config.proxy_rules().ParseFromString("http=foopy1:8080;https=foopy2:8080");
@@ -2465,7 +2590,9 @@ TEST_F(ProxyServiceTest, BypassDoesntApplyToPac) {
   EXPECT_EQ(OK, callback1.WaitForResult());
   EXPECT_EQ("request1:80", info1.proxy_server().ToURI());
 
-  // Start another request, it should pickup the bypass item.
+  // Start another request, it should pickup the bypass item. Drop the
+  // memoized decision first so the request reaches the resolver again.
+  service.ClearPacResultCache();
   ProxyInfo info2;
   TestCompletionCallback callback2;
   rv = service.ResolveProxy(GURL("http://www.google.com"), LOAD_NORMAL, &info2,
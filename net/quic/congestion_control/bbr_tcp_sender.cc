@@ -0,0 +1,330 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_tcp_sender.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "net/quic/congestion_control/rtt_stats.h"
+#include "net/quic/proto/cached_network_parameters.pb.h"
+
+using std::max;
+using std::min;
+
+namespace net {
+
+namespace {
+
+// The minimum congestion window, which keeps enough packets in flight to
+// sustain bandwidth and RTT measurement.
+const QuicByteCount kMinimumCongestionWindow = 4 * kDefaultTCPMSS;
+
+// 2/ln(2), the gain needed to double the sending rate every round trip, used
+// for pacing and the congestion window in STARTUP.
+const float kHighGain = 2.885f;
+
+// The gain cycle used in PROBE_BW: one phase probing above the estimated
+// bandwidth, one draining the queue the probe may have created, and six
+// cruising at the estimate.
+const float kGainCycle[] = {1.25f, 0.75f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+const int kGainCycleLength = arraysize(kGainCycle);
+
+// Number of round trips bandwidth samples stay in the windowed max filter,
+// covering a full PROBE_BW gain cycle.
+const uint64 kBandwidthWindowRounds = 10;
+
+// STARTUP exits when the bandwidth estimate has grown by less than 25% per
+// round for this many rounds.
+const float kStartupGrowthTarget = 1.25f;
+const uint64 kStartupRoundsWithoutGrowth = 3;
+
+// The cwnd gain outside STARTUP; allows two bandwidth-delay products in
+// flight to tolerate ack aggregation and delayed acks.
+const float kCwndGain = 2.0f;
+
+}  // namespace
+
+BbrTcpSender::BbrTcpSender(const QuicClock* clock,
+                           const RttStats* rtt_stats,
+                           QuicPacketCount initial_congestion_window,
+                           QuicPacketCount max_congestion_window,
+                           QuicConnectionStats* stats)
+    : clock_(clock),
+      rtt_stats_(rtt_stats),
+      stats_(stats),
+      mode_(STARTUP),
+      pacing_gain_(kHighGain),
+      largest_sent_packet_number_(0),
+      largest_acked_packet_number_(0),
+      round_trip_count_(0),
+      current_round_trip_end_(0),
+      round_trip_start_(QuicTime::Zero()),
+      bytes_acked_since_round_start_(0),
+      bandwidth_at_last_round_(QuicBandwidth::Zero()),
+      rounds_without_bandwidth_gain_(0),
+      gain_cycle_index_(0),
+      gain_cycle_start_(QuicTime::Zero()),
+      congestion_window_(initial_congestion_window * kDefaultTCPMSS),
+      max_congestion_window_(max_congestion_window * kDefaultTCPMSS),
+      initial_congestion_window_(initial_congestion_window * kDefaultTCPMSS) {}
+
+BbrTcpSender::~BbrTcpSender() {}
+
+void BbrTcpSender::SetFromConfig(const QuicConfig& config,
+                                 Perspective perspective) {}
+
+void BbrTcpSender::ResumeConnectionState(
+    const CachedNetworkParameters& cached_network_params,
+    bool max_bandwidth_resumption) {
+  QuicBandwidth bandwidth = QuicBandwidth::FromBytesPerSecond(
+      max_bandwidth_resumption
+          ? cached_network_params.max_bandwidth_estimate_bytes_per_second()
+          : cached_network_params.bandwidth_estimate_bytes_per_second());
+  if (bandwidth.IsZero()) {
+    return;
+  }
+  // Seed the filter so the first rounds pace near the previous estimate; the
+  // sample ages out of the window if the path no longer supports it.
+  max_bandwidth_.clear();
+  max_bandwidth_.push_back(BandwidthSample(round_trip_count_, bandwidth));
+  congestion_window_ =
+      max(kMinimumCongestionWindow,
+          min(max_congestion_window_, GetTargetCongestionWindow(kCwndGain)));
+}
+
+void BbrTcpSender::SetNumEmulatedConnections(int num_connections) {}
+
+void BbrTcpSender::SetMaxCongestionWindow(
+    QuicByteCount max_congestion_window) {
+  max_congestion_window_ = max_congestion_window;
+}
+
+void BbrTcpSender::OnCongestionEvent(bool rtt_updated,
+                                     QuicByteCount bytes_in_flight,
+                                     const CongestionVector& acked_packets,
+                                     const CongestionVector& lost_packets) {
+  const QuicTime now = clock_->ApproximateNow();
+  QuicByteCount bytes_acked = 0;
+  for (CongestionVector::const_iterator it = acked_packets.begin();
+       it != acked_packets.end(); ++it) {
+    largest_acked_packet_number_ =
+        max(it->first, largest_acked_packet_number_);
+    bytes_acked += it->second;
+  }
+  // Losses do not feed the model: the bandwidth filter only grows from
+  // delivered data, so sustained loss caps the estimate on its own.
+  for (CongestionVector::const_iterator it = lost_packets.begin();
+       it != lost_packets.end(); ++it) {
+    ++stats_->tcp_loss_events;
+  }
+  bytes_acked_since_round_start_ += bytes_acked;
+
+  if (largest_acked_packet_number_ > current_round_trip_end_) {
+    // The packet marking the end of the round has been acked.
+    UpdateBandwidth(now, bytes_acked_since_round_start_);
+    ++round_trip_count_;
+    current_round_trip_end_ = largest_sent_packet_number_;
+    round_trip_start_ = now;
+    bytes_acked_since_round_start_ = 0;
+    MaybeUpdateMode(now, bytes_in_flight);
+  } else if (mode_ == DRAIN || mode_ == PROBE_BW) {
+    MaybeUpdateMode(now, bytes_in_flight);
+  }
+
+  congestion_window_ =
+      max(kMinimumCongestionWindow,
+          min(max_congestion_window_,
+              GetTargetCongestionWindow(mode_ == STARTUP ? kHighGain
+                                                         : kCwndGain)));
+}
+
+bool BbrTcpSender::OnPacketSent(QuicTime sent_time,
+                                QuicByteCount bytes_in_flight,
+                                QuicPacketNumber packet_number,
+                                QuicByteCount bytes,
+                                HasRetransmittableData is_retransmittable) {
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return false;
+  }
+  if (largest_sent_packet_number_ == 0) {
+    // First packet of the connection starts the first round trip.
+    round_trip_start_ = sent_time;
+  }
+  DCHECK_LT(largest_sent_packet_number_, packet_number);
+  largest_sent_packet_number_ = packet_number;
+  return true;
+}
+
+void BbrTcpSender::OnRetransmissionTimeout(bool packets_retransmitted) {
+  if (!packets_retransmitted) {
+    return;
+  }
+  // An RTO means the model is stale; collapse the window and rebuild the
+  // bandwidth estimate from new samples.
+  max_bandwidth_.clear();
+  congestion_window_ = kMinimumCongestionWindow;
+}
+
+void BbrTcpSender::OnConnectionMigration() {
+  mode_ = STARTUP;
+  pacing_gain_ = kHighGain;
+  largest_sent_packet_number_ = 0;
+  largest_acked_packet_number_ = 0;
+  round_trip_count_ = 0;
+  current_round_trip_end_ = 0;
+  round_trip_start_ = QuicTime::Zero();
+  bytes_acked_since_round_start_ = 0;
+  max_bandwidth_.clear();
+  bandwidth_at_last_round_ = QuicBandwidth::Zero();
+  rounds_without_bandwidth_gain_ = 0;
+  gain_cycle_index_ = 0;
+  gain_cycle_start_ = QuicTime::Zero();
+  congestion_window_ = initial_congestion_window_;
+}
+
+QuicTime::Delta BbrTcpSender::TimeUntilSend(
+    QuicTime now,
+    QuicByteCount bytes_in_flight,
+    HasRetransmittableData has_retransmittable_data) const {
+  if (has_retransmittable_data == NO_RETRANSMITTABLE_DATA) {
+    // ACKs can always be sent immediately.
+    return QuicTime::Delta::Zero();
+  }
+  if (bytes_in_flight < GetCongestionWindow()) {
+    return QuicTime::Delta::Zero();
+  }
+  return QuicTime::Delta::Infinite();
+}
+
+QuicBandwidth BbrTcpSender::PacingRate() const {
+  QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero()) {
+    // No samples yet; pace the initial window over the initial RTT.
+    bandwidth = QuicBandwidth::FromBytesAndTimeDelta(
+        initial_congestion_window_, GetMinRtt());
+  }
+  return bandwidth.Scale(pacing_gain_);
+}
+
+QuicBandwidth BbrTcpSender::BandwidthEstimate() const {
+  if (max_bandwidth_.empty()) {
+    return QuicBandwidth::Zero();
+  }
+  return max_bandwidth_.front().second;
+}
+
+QuicTime::Delta BbrTcpSender::RetransmissionDelay() const {
+  if (rtt_stats_->smoothed_rtt().IsZero()) {
+    return QuicTime::Delta::Zero();
+  }
+  return rtt_stats_->smoothed_rtt().Add(
+      rtt_stats_->mean_deviation().Multiply(4));
+}
+
+QuicByteCount BbrTcpSender::GetCongestionWindow() const {
+  return congestion_window_;
+}
+
+bool BbrTcpSender::InSlowStart() const {
+  return mode_ == STARTUP;
+}
+
+bool BbrTcpSender::InRecovery() const {
+  return false;
+}
+
+QuicByteCount BbrTcpSender::GetSlowStartThreshold() const {
+  // There is no slow start threshold in a bandwidth-based algorithm.
+  return 0;
+}
+
+CongestionControlType BbrTcpSender::GetCongestionControlType() const {
+  return kBBR;
+}
+
+QuicTime::Delta BbrTcpSender::GetMinRtt() const {
+  if (!rtt_stats_->recent_min_rtt().IsZero()) {
+    return rtt_stats_->recent_min_rtt();
+  }
+  return QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
+}
+
+QuicByteCount BbrTcpSender::GetTargetCongestionWindow(float gain) const {
+  QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero()) {
+    return initial_congestion_window_;
+  }
+  const QuicByteCount bdp = bandwidth.ToBytesPerPeriod(GetMinRtt());
+  return static_cast<QuicByteCount>(gain * bdp);
+}
+
+void BbrTcpSender::UpdateBandwidth(QuicTime now,
+                                   QuicByteCount bytes_acked_in_round) {
+  const QuicTime::Delta round_duration = now.Subtract(round_trip_start_);
+  if (round_duration.IsZero()) {
+    return;
+  }
+  const QuicBandwidth sample =
+      QuicBandwidth::FromBytesAndTimeDelta(bytes_acked_in_round,
+                                           round_duration);
+  // Age samples outside the window out of the front, then keep the deque
+  // sorted in decreasing order by dropping samples dominated by the new one.
+  while (!max_bandwidth_.empty() &&
+         max_bandwidth_.front().first + kBandwidthWindowRounds <=
+             round_trip_count_) {
+    max_bandwidth_.pop_front();
+  }
+  while (!max_bandwidth_.empty() && max_bandwidth_.back().second <= sample) {
+    max_bandwidth_.pop_back();
+  }
+  max_bandwidth_.push_back(BandwidthSample(round_trip_count_, sample));
+}
+
+void BbrTcpSender::MaybeUpdateMode(QuicTime now,
+                                   QuicByteCount bytes_in_flight) {
+  switch (mode_) {
+    case STARTUP: {
+      const QuicBandwidth bandwidth = BandwidthEstimate();
+      if (bandwidth.IsZero()) {
+        return;
+      }
+      if (bandwidth >= bandwidth_at_last_round_.Scale(kStartupGrowthTarget)) {
+        bandwidth_at_last_round_ = bandwidth;
+        rounds_without_bandwidth_gain_ = 0;
+        return;
+      }
+      if (++rounds_without_bandwidth_gain_ >= kStartupRoundsWithoutGrowth) {
+        // The estimate has plateaued: the link is full and further STARTUP
+        // rounds only build a queue at the bottleneck.
+        mode_ = DRAIN;
+        pacing_gain_ = 1.0f / kHighGain;
+      }
+      break;
+    }
+    case DRAIN:
+      if (bytes_in_flight <= GetTargetCongestionWindow(1.0f)) {
+        // The queue built during STARTUP has drained.
+        mode_ = PROBE_BW;
+        pacing_gain_ = kGainCycle[0];
+        gain_cycle_index_ = 0;
+        gain_cycle_start_ = now;
+      }
+      break;
+    case PROBE_BW:
+      MaybeAdvanceGainCycle(now);
+      break;
+  }
+}
+
+void BbrTcpSender::MaybeAdvanceGainCycle(QuicTime now) {
+  if (now.Subtract(gain_cycle_start_) < GetMinRtt()) {
+    return;
+  }
+  gain_cycle_index_ = (gain_cycle_index_ + 1) % kGainCycleLength;
+  pacing_gain_ = kGainCycle[gain_cycle_index_];
+  gain_cycle_start_ = now;
+}
+
+}  // namespace net
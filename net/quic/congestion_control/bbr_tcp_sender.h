@@ -0,0 +1,166 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Bandwidth-based send side congestion algorithm.  Instead of backing a
+// congestion window out of loss events, the sender builds a model of the
+// path from a windowed maximum of per-round-trip bandwidth samples and the
+// windowed minimum RTT kept by RttStats, and paces at a gain applied to the
+// estimated bottleneck bandwidth.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
+#define NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
+
+#include <deque>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_clock.h"
+#include "net/quic/quic_connection_stats.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class RttStats;
+
+namespace test {
+class BbrTcpSenderPeer;
+}  // namespace test
+
+class NET_EXPORT_PRIVATE BbrTcpSender : public SendAlgorithmInterface {
+ public:
+  // The phases of the algorithm:
+  //   STARTUP ramps the sending rate up exponentially, like slow start, until
+  //   the bandwidth estimate stops growing, which indicates the bottleneck
+  //   link is saturated.
+  //   DRAIN empties the queue which STARTUP built at the bottleneck by
+  //   pacing below the estimated bandwidth.
+  //   PROBE_BW cycles the pacing gain around 1.0, periodically probing for
+  //   more bandwidth and then draining any queue the probe created.
+  enum Mode {
+    STARTUP,
+    DRAIN,
+    PROBE_BW,
+  };
+
+  BbrTcpSender(const QuicClock* clock,
+               const RttStats* rtt_stats,
+               QuicPacketCount initial_congestion_window,
+               QuicPacketCount max_congestion_window,
+               QuicConnectionStats* stats);
+  ~BbrTcpSender() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  void SetFromConfig(const QuicConfig& config,
+                     Perspective perspective) override;
+  void ResumeConnectionState(
+      const CachedNetworkParameters& cached_network_params,
+      bool max_bandwidth_resumption) override;
+  void SetNumEmulatedConnections(int num_connections) override;
+  void SetMaxCongestionWindow(QuicByteCount max_congestion_window) override;
+  void OnCongestionEvent(bool rtt_updated,
+                         QuicByteCount bytes_in_flight,
+                         const CongestionVector& acked_packets,
+                         const CongestionVector& lost_packets) override;
+  bool OnPacketSent(QuicTime sent_time,
+                    QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number,
+                    QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnRetransmissionTimeout(bool packets_retransmitted) override;
+  void OnConnectionMigration() override;
+  QuicTime::Delta TimeUntilSend(
+      QuicTime now,
+      QuicByteCount bytes_in_flight,
+      HasRetransmittableData has_retransmittable_data) const override;
+  QuicBandwidth PacingRate() const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  QuicTime::Delta RetransmissionDelay() const override;
+  QuicByteCount GetCongestionWindow() const override;
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  // End implementation of SendAlgorithmInterface.
+
+ private:
+  friend class test::BbrTcpSenderPeer;
+
+  // A bandwidth sample and the round trip in which it was taken.
+  typedef std::pair<uint64, QuicBandwidth> BandwidthSample;
+
+  // Returns the windowed minimum RTT, falling back to the initial RTT before
+  // any sample has been taken.
+  QuicTime::Delta GetMinRtt() const;
+
+  // Returns the estimated bandwidth-delay product of the path, or the
+  // initial congestion window before a bandwidth estimate exists.
+  QuicByteCount GetTargetCongestionWindow(float gain) const;
+
+  // Records a bandwidth sample for the round trip which just completed, aging
+  // samples outside the bandwidth window out of |max_bandwidth_|.
+  void UpdateBandwidth(QuicTime now, QuicByteCount bytes_acked_in_round);
+
+  // Detects the bandwidth plateau which ends STARTUP, and moves through
+  // DRAIN to PROBE_BW once the queue built during STARTUP has drained.
+  void MaybeUpdateMode(QuicTime now, QuicByteCount bytes_in_flight);
+
+  // Advances the pacing gain cycle in PROBE_BW once per minimum RTT.
+  void MaybeAdvanceGainCycle(QuicTime now);
+
+  const QuicClock* clock_;
+  const RttStats* rtt_stats_;
+  QuicConnectionStats* stats_;
+
+  Mode mode_;
+
+  // Pacing gain applied to the bandwidth estimate; set by the mode and, in
+  // PROBE_BW, by the gain cycle.
+  float pacing_gain_;
+
+  // Track the largest packet that has been sent.
+  QuicPacketNumber largest_sent_packet_number_;
+
+  // Track the largest packet that has been acked.
+  QuicPacketNumber largest_acked_packet_number_;
+
+  // Round trips are counted by marking the largest packet sent when an ack
+  // arrives; the round ends when that packet is acked.
+  uint64 round_trip_count_;
+  QuicPacketNumber current_round_trip_end_;
+  QuicTime round_trip_start_;
+  QuicByteCount bytes_acked_since_round_start_;
+
+  // Windowed maximum filter of per-round bandwidth samples, kept in
+  // decreasing order so the front is the maximum in the window.
+  std::deque<BandwidthSample> max_bandwidth_;
+
+  // STARTUP exit detection: the estimate when growth was last seen, and the
+  // number of rounds it has failed to grow since.
+  QuicBandwidth bandwidth_at_last_round_;
+  uint64 rounds_without_bandwidth_gain_;
+
+  // Start of the current PROBE_BW gain cycle phase.
+  int gain_cycle_index_;
+  QuicTime gain_cycle_start_;
+
+  // Congestion window in bytes.
+  QuicByteCount congestion_window_;
+
+  // Maximum congestion window in bytes.
+  QuicByteCount max_congestion_window_;
+
+  // Initial congestion window in bytes, used before a bandwidth estimate
+  // exists and when the window is reset.
+  const QuicByteCount initial_congestion_window_;
+
+  DISALLOW_COPY_AND_ASSIGN(BbrTcpSender);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
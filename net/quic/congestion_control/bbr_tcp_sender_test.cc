@@ -0,0 +1,156 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_tcp_sender.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/quic/congestion_control/rtt_stats.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+const uint32 kInitialCongestionWindowPackets = 10;
+
+class BbrTcpSenderPeer : public BbrTcpSender {
+ public:
+  explicit BbrTcpSenderPeer(const QuicClock* clock)
+      : BbrTcpSender(clock,
+                     &rtt_stats_,
+                     kInitialCongestionWindowPackets,
+                     kMaxCongestionWindow,
+                     &stats_) {}
+
+  Mode mode() const { return mode_; }
+  float pacing_gain() const { return pacing_gain_; }
+
+  RttStats rtt_stats_;
+  QuicConnectionStats stats_;
+};
+
+class BbrTcpSenderTest : public ::testing::Test {
+ protected:
+  BbrTcpSenderTest()
+      : rtt_(QuicTime::Delta::FromMilliseconds(100)),
+        sender_(new BbrTcpSenderPeer(&clock_)),
+        packet_number_(1),
+        acked_packet_number_(0),
+        bytes_in_flight_(0) {}
+
+  void SendPackets(int n) {
+    for (int i = 0; i < n; ++i) {
+      sender_->OnPacketSent(clock_.Now(), bytes_in_flight_, packet_number_++,
+                            kDefaultTCPMSS, HAS_RETRANSMITTABLE_DATA);
+      bytes_in_flight_ += kDefaultTCPMSS;
+    }
+  }
+
+  // Advances the clock by an RTT and acks every outstanding packet,
+  // completing a round trip.
+  void AckAllOutstanding() {
+    clock_.AdvanceTime(rtt_);
+    sender_->rtt_stats_.UpdateRtt(rtt_, QuicTime::Delta::Zero(), clock_.Now());
+    SendAlgorithmInterface::CongestionVector acked;
+    for (QuicPacketNumber i = acked_packet_number_ + 1; i < packet_number_;
+         ++i) {
+      acked.push_back(std::make_pair(i, kDefaultTCPMSS));
+    }
+    acked_packet_number_ = packet_number_ - 1;
+    sender_->OnCongestionEvent(
+        true, bytes_in_flight_, acked,
+        SendAlgorithmInterface::CongestionVector());
+    bytes_in_flight_ = 0;
+  }
+
+  // Runs round trips which all deliver the same bandwidth.
+  void RunConstantBandwidthRounds(int num_rounds) {
+    for (int i = 0; i < num_rounds; ++i) {
+      SendPackets(kInitialCongestionWindowPackets);
+      AckAllOutstanding();
+    }
+  }
+
+  const QuicTime::Delta rtt_;
+  MockClock clock_;
+  scoped_ptr<BbrTcpSenderPeer> sender_;
+  QuicPacketNumber packet_number_;
+  QuicPacketNumber acked_packet_number_;
+  QuicByteCount bytes_in_flight_;
+};
+
+TEST_F(BbrTcpSenderTest, BandwidthEstimateFromAckedData) {
+  EXPECT_EQ(QuicBandwidth::Zero(), sender_->BandwidthEstimate());
+
+  SendPackets(kInitialCongestionWindowPackets);
+  AckAllOutstanding();
+
+  // Ten packets delivered in one RTT.
+  EXPECT_EQ(QuicBandwidth::FromBytesAndTimeDelta(
+                kInitialCongestionWindowPackets * kDefaultTCPMSS, rtt_),
+            sender_->BandwidthEstimate());
+}
+
+TEST_F(BbrTcpSenderTest, CongestionWindowTracksBandwidthDelayProduct) {
+  RunConstantBandwidthRounds(1);
+
+  // During STARTUP the window is the high gain applied to the
+  // bandwidth-delay product.
+  const QuicByteCount bdp =
+      sender_->BandwidthEstimate().ToBytesPerPeriod(rtt_);
+  EXPECT_EQ(static_cast<QuicByteCount>(2.885f * bdp),
+            sender_->GetCongestionWindow());
+}
+
+TEST_F(BbrTcpSenderTest, StartupExitsWhenBandwidthPlateaus) {
+  EXPECT_EQ(BbrTcpSender::STARTUP, sender_->mode());
+  EXPECT_TRUE(sender_->InSlowStart());
+
+  // The first round records the estimate; three further rounds without 25%
+  // growth end STARTUP.
+  RunConstantBandwidthRounds(3);
+  EXPECT_EQ(BbrTcpSender::STARTUP, sender_->mode());
+  RunConstantBandwidthRounds(1);
+  EXPECT_EQ(BbrTcpSender::DRAIN, sender_->mode());
+  EXPECT_FALSE(sender_->InSlowStart());
+  EXPECT_LT(sender_->pacing_gain(), 1.0f);
+}
+
+TEST_F(BbrTcpSenderTest, DrainMovesToProbeBandwidthAndCyclesGain) {
+  RunConstantBandwidthRounds(4);
+  ASSERT_EQ(BbrTcpSender::DRAIN, sender_->mode());
+
+  // Once the bytes in flight are below the bandwidth-delay product, the
+  // queue built during STARTUP has drained.
+  RunConstantBandwidthRounds(1);
+  ASSERT_EQ(BbrTcpSender::PROBE_BW, sender_->mode());
+  EXPECT_FLOAT_EQ(1.25f, sender_->pacing_gain());
+
+  // The gain cycle advances to the drain phase after a minimum RTT.
+  RunConstantBandwidthRounds(1);
+  EXPECT_FLOAT_EQ(0.75f, sender_->pacing_gain());
+}
+
+TEST_F(BbrTcpSenderTest, PacingRateAppliesGainToBandwidth) {
+  RunConstantBandwidthRounds(1);
+
+  EXPECT_EQ(sender_->BandwidthEstimate().Scale(sender_->pacing_gain()),
+            sender_->PacingRate());
+}
+
+TEST_F(BbrTcpSenderTest, RetransmissionTimeoutCollapsesWindow) {
+  RunConstantBandwidthRounds(1);
+  EXPECT_GT(sender_->GetCongestionWindow(), 4 * kDefaultTCPMSS);
+
+  sender_->OnRetransmissionTimeout(true);
+  EXPECT_EQ(4 * kDefaultTCPMSS, sender_->GetCongestionWindow());
+  EXPECT_EQ(QuicBandwidth::Zero(), sender_->BandwidthEstimate());
+}
+
+}  // namespace test
+}  // namespace net
@@ -60,8 +60,12 @@ void GeneralLossAlgorithm::DetectLosses(
       QuicTime::Delta::Max(rtt_stats.smoothed_rtt(), rtt_stats.latest_rtt())
           .Multiply(kLossDelayMultiplier));
 
-  QuicPacketNumber packet_number = unacked_packets.GetLeastUnacked();
-  for (QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
+  // Packets before the first one in flight can never be declared lost, so
+  // start the scan there instead of at the least unacked packet.
+  QuicPacketNumber packet_number = unacked_packets.GetLeastInFlight();
+  for (QuicUnackedPacketMap::const_iterator it =
+           unacked_packets.begin() +
+           (packet_number - unacked_packets.GetLeastUnacked());
        it != unacked_packets.end() && packet_number <= largest_observed;
        ++it, ++packet_number) {
     if (!it->in_flight) {
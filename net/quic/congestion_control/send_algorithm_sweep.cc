@@ -0,0 +1,205 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A parameter-sweep benchmark for QUIC send algorithms.  Simulates transfers
+// over a grid of (RTT, forward loss rate, buffer depth, competing flows)
+// scenarios for every SendAlgorithmInterface implementation, running the
+// independent scenarios on parallel worker threads, and prints a
+// throughput/latency table suitable for offline congestion tuning.
+//
+// Usage: quic_send_algorithm_sweep [--workers=N]
+
+#include <stdio.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/command_line.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
+#include "net/quic/congestion_control/rtt_stats.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/congestion_control/send_algorithm_simulator.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_connection_stats.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+#include "net/quic/test_tools/mock_clock.h"
+
+namespace net {
+namespace {
+
+// The link bandwidth shared by all flows in a scenario.
+const int kBandwidthKbps = 10000;
+
+// Swept dimensions.  The buffer depths bracket the bandwidth-delay product
+// of the 100ms point (125KB).
+const int kRttsMs[] = {20, 100, 300};
+const float kLossRates[] = {0.0f, 0.01f, 0.05f};
+const int kBufferKBytes[] = {40, 200, 1000};
+const int kNumFlows[] = {1, 2, 4};
+
+const struct {
+  CongestionControlType type;
+  const char* name;
+} kAlgorithms[] = {
+    {kCubic, "cubic"},
+    {kCubicBytes, "cubic_bytes"},
+    {kReno, "reno"},
+    {kRenoBytes, "reno_bytes"},
+    {kBBR, "bbr"},
+};
+
+// Bytes each flow transfers, and the simulated-time budget for a scenario.
+const QuicByteCount kTransferBytes = 3 * 1024 * 1024;
+const int kMaxTransferSeconds = 300;
+
+const QuicPacketCount kInitialCongestionWindowPackets = 10;
+
+// One point of the sweep grid, along with the results of simulating it.
+struct Scenario {
+  Scenario()
+      : congestion_control_type(kCubic),
+        algorithm_name(nullptr),
+        rtt_ms(0),
+        loss_rate(0),
+        buffer_kbytes(0),
+        num_flows(0),
+        goodput(QuicBandwidth::Zero()),
+        smoothed_rtt(QuicTime::Delta::Zero()),
+        completion_time(QuicTime::Delta::Zero()),
+        observed_loss_rate(0) {}
+
+  CongestionControlType congestion_control_type;
+  const char* algorithm_name;
+  int rtt_ms;
+  float loss_rate;
+  int buffer_kbytes;
+  int num_flows;
+
+  // Results for the first flow, valid once the scenario has run.  A zero
+  // goodput means the transfer did not complete within the time budget.
+  QuicBandwidth goodput;
+  QuicTime::Delta smoothed_rtt;
+  QuicTime::Delta completion_time;
+  float observed_loss_rate;
+};
+
+void RunScenario(Scenario* scenario) {
+  MockClock clock;
+  SendAlgorithmSimulator simulator(
+      &clock, QuicBandwidth::FromKBitsPerSecond(kBandwidthKbps),
+      QuicTime::Delta::FromMilliseconds(scenario->rtt_ms));
+  simulator.set_forward_loss_rate(scenario->loss_rate);
+  simulator.set_buffer_size(scenario->buffer_kbytes * 1024);
+
+  ScopedVector<RttStats> rtt_stats;
+  ScopedVector<QuicConnectionStats> stats;
+  ScopedVector<SendAlgorithmInterface> algorithms;
+  ScopedVector<SendAlgorithmSimulator::Sender> senders;
+  for (int i = 0; i < scenario->num_flows; ++i) {
+    rtt_stats.push_back(new RttStats());
+    stats.push_back(new QuicConnectionStats());
+    algorithms.push_back(SendAlgorithmInterface::Create(
+        &clock, rtt_stats.back(), scenario->congestion_control_type,
+        stats.back(), kInitialCongestionWindowPackets));
+    senders.push_back(new SendAlgorithmSimulator::Sender(algorithms.back(),
+                                                         rtt_stats.back()));
+    simulator.AddTransfer(senders.back(), kTransferBytes);
+  }
+  simulator.TransferBytes(std::numeric_limits<QuicByteCount>::max(),
+                          QuicTime::Delta::FromSeconds(kMaxTransferSeconds));
+
+  scenario->goodput = senders[0]->last_transfer_bandwidth;
+  scenario->observed_loss_rate = senders[0]->last_transfer_loss_rate;
+  scenario->smoothed_rtt = rtt_stats[0]->smoothed_rtt();
+  if (!scenario->goodput.IsZero()) {
+    scenario->completion_time = scenario->goodput.TransferTime(kTransferBytes);
+  }
+}
+
+// Runs a single scenario on a worker thread.
+class ScenarioRunner : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit ScenarioRunner(Scenario* scenario) : scenario_(scenario) {}
+
+  void Run() override { RunScenario(scenario_); }
+
+ private:
+  Scenario* scenario_;
+};
+
+int Main(int argc, char* argv[]) {
+  base::AtExitManager exit_manager;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  int num_workers = base::SysInfo::NumberOfProcessors();
+  if (line->HasSwitch("workers") &&
+      (!base::StringToInt(line->GetSwitchValueASCII("workers"),
+                          &num_workers) ||
+       num_workers < 1)) {
+    fprintf(stderr, "--workers must be a positive integer\n");
+    return 1;
+  }
+
+  std::vector<Scenario> scenarios;
+  for (size_t a = 0; a < arraysize(kAlgorithms); ++a) {
+    for (size_t r = 0; r < arraysize(kRttsMs); ++r) {
+      for (size_t l = 0; l < arraysize(kLossRates); ++l) {
+        for (size_t b = 0; b < arraysize(kBufferKBytes); ++b) {
+          for (size_t f = 0; f < arraysize(kNumFlows); ++f) {
+            Scenario scenario;
+            scenario.congestion_control_type = kAlgorithms[a].type;
+            scenario.algorithm_name = kAlgorithms[a].name;
+            scenario.rtt_ms = kRttsMs[r];
+            scenario.loss_rate = kLossRates[l];
+            scenario.buffer_kbytes = kBufferKBytes[b];
+            scenario.num_flows = kNumFlows[f];
+            scenarios.push_back(scenario);
+          }
+        }
+      }
+    }
+  }
+
+  // Scenarios are independent, so farm them out to the pool in one batch.
+  std::vector<ScenarioRunner> runners;
+  runners.reserve(scenarios.size());
+  base::DelegateSimpleThreadPool pool("sweep_worker", num_workers);
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    runners.push_back(ScenarioRunner(&scenarios[i]));
+    pool.AddWork(&runners.back());
+  }
+  pool.Start();
+  pool.JoinAll();
+
+  printf("%-12s %7s %6s %10s %6s %13s %8s %13s %10s\n", "algorithm", "rtt_ms",
+         "loss", "buffer_kb", "flows", "goodput_kbps", "srtt_ms",
+         "completion_s", "loss_seen");
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    const Scenario& s = scenarios[i];
+    printf("%-12s %7d %6.3f %10d %6d %13" PRId64 " %8" PRId64 " %13.1f %10.3f\n",
+           s.algorithm_name, s.rtt_ms, s.loss_rate, s.buffer_kbytes,
+           s.num_flows, s.goodput.ToKBitsPerSecond(),
+           s.smoothed_rtt.ToMilliseconds(),
+           static_cast<double>(s.completion_time.ToMicroseconds()) / 1000000,
+           s.observed_loss_rate);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace net
+
+int main(int argc, char* argv[]) {
+  return net::Main(argc, argv);
+}
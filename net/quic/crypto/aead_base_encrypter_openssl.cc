@@ -108,11 +108,15 @@ bool AeadBaseEncrypter::EncryptPacket(QuicPacketNumber packet_number,
   }
   // TODO(ianswett): Introduce a check to ensure that we don't encrypt with the
   // same packet number twice.
+  // The nonce is built in a local buffer, not in |output|, so that |output|
+  // may alias |plaintext| for in-place encryption.
   const size_t nonce_size = nonce_prefix_size_ + sizeof(packet_number);
-  memcpy(output, nonce_prefix_, nonce_prefix_size_);
-  memcpy(output + nonce_prefix_size_, &packet_number, sizeof(packet_number));
-  if (!Encrypt(StringPiece(output, nonce_size), associated_data, plaintext,
-               reinterpret_cast<unsigned char*>(output))) {
+  char nonce_buffer[kMaxNoncePrefixSize + sizeof(packet_number)];
+  memcpy(nonce_buffer, nonce_prefix_, nonce_prefix_size_);
+  memcpy(nonce_buffer + nonce_prefix_size_, &packet_number,
+         sizeof(packet_number));
+  if (!Encrypt(StringPiece(nonce_buffer, nonce_size), associated_data,
+               plaintext, reinterpret_cast<unsigned char*>(output))) {
     return false;
   }
   *output_length = ciphertext_size;
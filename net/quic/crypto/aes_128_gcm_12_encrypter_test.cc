@@ -279,6 +279,38 @@ TEST(Aes128Gcm12EncrypterTest, Encrypt) {
   }
 }
 
+TEST(Aes128Gcm12EncrypterTest, EncryptPacketInPlace) {
+  // Encrypting with the output buffer aliasing the plaintext must produce
+  // the same ciphertext as encrypting out of place.
+  const QuicPacketNumber kPacketNumber = UINT64_C(0x123456789ABC);
+  string key;
+  ASSERT_TRUE(DecodeHexString("11754cd72aec309bf52f7687212e8957", &key));
+  string nonce_prefix("abcd", 4);
+  string associated_data = "associated data";
+  string plaintext = "this is the payload";
+
+  Aes128Gcm12Encrypter encrypter;
+  ASSERT_TRUE(encrypter.SetKey(key));
+  ASSERT_TRUE(encrypter.SetNoncePrefix(nonce_prefix));
+
+  char expected[kMaxPacketSize];
+  size_t expected_len = 0;
+  ASSERT_TRUE(encrypter.EncryptPacket(kPacketNumber, associated_data,
+                                      plaintext, expected, &expected_len,
+                                      arraysize(expected)));
+
+  char buffer[kMaxPacketSize];
+  memcpy(buffer, plaintext.data(), plaintext.size());
+  size_t in_place_len = 0;
+  ASSERT_TRUE(encrypter.EncryptPacket(
+      kPacketNumber, associated_data, StringPiece(buffer, plaintext.size()),
+      buffer, &in_place_len, arraysize(buffer)));
+
+  ASSERT_EQ(expected_len, in_place_len);
+  test::CompareCharArraysWithHexError("in-place ciphertext", buffer,
+                                      in_place_len, expected, expected_len);
+}
+
 TEST(Aes128Gcm12EncrypterTest, GetMaxPlaintextSize) {
   Aes128Gcm12Encrypter encrypter;
   EXPECT_EQ(1000u, encrypter.GetMaxPlaintextSize(1012));
@@ -4,6 +4,8 @@
 
 #include "net/quic/crypto/local_strike_register_client.h"
 
+#include <algorithm>
+
 #include "net/quic/crypto/crypto_protocol.h"
 
 using base::StringPiece;
@@ -11,22 +13,42 @@ using std::string;
 
 namespace net {
 
+namespace {
+
+// The byte of a nonce used to pick a shard. Nonces are 4 bytes of timestamp
+// followed by 8 bytes of orbit and 20 bytes of random data; the timestamp
+// and orbit are shared by bursts of nonces, so the shard is chosen from the
+// random data to spread concurrent handshakes evenly.
+const size_t kShardSelectorOffset = sizeof(uint32) + kOrbitSize;
+
+}  // namespace
+
+const size_t LocalStrikeRegisterClient::kNumShards;
+
 LocalStrikeRegisterClient::LocalStrikeRegisterClient(
     unsigned max_entries,
     uint32 current_time_external,
     uint32 window_secs,
     const uint8 orbit[8],
-    StrikeRegister::StartupType startup)
-    : strike_register_(max_entries, current_time_external,  window_secs,
-                       orbit, startup) {
+    StrikeRegister::StartupType startup) {
+  // Each shard needs at least two entries to satisfy
+  // StrikeRegister::ValidateStrikeRegisterConfig.
+  unsigned max_entries_per_shard =
+      std::max(2u, static_cast<unsigned>(max_entries / kNumShards));
+  for (size_t i = 0; i < kNumShards; i++) {
+    shards_[i].reset(new Shard(max_entries_per_shard, current_time_external,
+                               window_secs, orbit, startup));
+  }
 }
 
 bool LocalStrikeRegisterClient::IsKnownOrbit(StringPiece orbit) const {
-  base::AutoLock lock(m_);
+  // All shards share the same orbit; ask the first one.
+  Shard* shard = shards_[0].get();
+  base::AutoLock lock(shard->lock);
   if (orbit.length() != kOrbitSize) {
     return false;
   }
-  return memcmp(orbit.data(), strike_register_.orbit(), kOrbitSize) == 0;
+  return memcmp(orbit.data(), shard->strike_register.orbit(), kOrbitSize) == 0;
 }
 
 void LocalStrikeRegisterClient::VerifyNonceIsValidAndUnique(
@@ -37,13 +59,16 @@ void LocalStrikeRegisterClient::VerifyNonceIsValidAndUnique(
   if (nonce.length() != kNonceSize) {
     nonce_error = NONCE_INVALID_FAILURE;
   } else {
-    base::AutoLock lock(m_);
-    nonce_error = strike_register_.Insert(
+    Shard* shard =
+        shards_[static_cast<uint8>(nonce[kShardSelectorOffset]) % kNumShards]
+            .get();
+    base::AutoLock lock(shard->lock);
+    nonce_error = shard->strike_register.Insert(
         reinterpret_cast<const uint8*>(nonce.data()),
         static_cast<uint32>(now.ToUNIXSeconds()));
   }
 
-  // m_ must not be held when the ResultCallback runs.
+  // No shard lock may be held when the ResultCallback runs.
   cb->Run((nonce_error == NONCE_OK), nonce_error);
 }
 
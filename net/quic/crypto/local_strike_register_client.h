@@ -6,6 +6,7 @@
 #define NET_QUIC_CRYPTO_LOCAL_STRIKE_REGISTER_CLIENT_H_
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/strings/string_piece.h"
 #include "base/synchronization/lock.h"
 #include "net/base/net_export.h"
@@ -15,8 +16,11 @@
 
 namespace net {
 
-// StrikeRegisterClient implementation that wraps a local in-memory
-// strike register.
+// StrikeRegisterClient implementation that wraps local in-memory
+// strike registers. The nonce space is split across several independent
+// strike registers, each with its own lock, so concurrent 0-RTT handshakes
+// only serialize when their nonces map to the same shard instead of on a
+// single process-wide register.
 class NET_EXPORT_PRIVATE LocalStrikeRegisterClient
     : public StrikeRegisterClient {
  public:
@@ -32,8 +36,31 @@ class NET_EXPORT_PRIVATE LocalStrikeRegisterClient
                                    ResultCallback* cb) override;
 
  private:
-  mutable base::Lock m_;
-  StrikeRegister strike_register_;
+  // A shard is an independent strike register guarded by its own lock.
+  struct Shard {
+    Shard(unsigned max_entries,
+          uint32 current_time_external,
+          uint32 window_secs,
+          const uint8 orbit[8],
+          StrikeRegister::StartupType startup)
+        : strike_register(max_entries,
+                          current_time_external,
+                          window_secs,
+                          orbit,
+                          startup) {}
+
+    mutable base::Lock lock;
+    StrikeRegister strike_register;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  // Number of shards the nonce space is split across. |max_entries| is
+  // divided evenly between them.
+  static const size_t kNumShards = 8;
+
+  scoped_ptr<Shard> shards_[kNumShards];
 
   DISALLOW_COPY_AND_ASSIGN(LocalStrikeRegisterClient);
 };
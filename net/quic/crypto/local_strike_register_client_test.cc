@@ -133,6 +133,59 @@ TEST_F(LocalStrikeRegisterClientTest, IncorrectNonceLength) {
   }
 }
 
+TEST_F(LocalStrikeRegisterClientTest, DuplicateNonce) {
+  string nonce;
+  uint32 norder = htonl(kCurrentTimeExternalSecs);
+  nonce.assign(reinterpret_cast<const char*>(&norder), sizeof(norder));
+  nonce.append(string(reinterpret_cast<const char*>(kOrbit), kOrbitSize));
+  nonce.append(string(20, '\x17'));  // 20 'random' bytes.
+
+  {
+    // The nonce is accepted the first time it is seen.
+    bool called = false;
+    bool is_valid = false;
+    InsertStatus nonce_error = NONCE_UNKNOWN_FAILURE;
+    strike_register_->VerifyNonceIsValidAndUnique(
+        nonce,
+        QuicWallTime::FromUNIXSeconds(kCurrentTimeExternalSecs),
+        new RecordResultCallback(&called, &is_valid, &nonce_error));
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(is_valid);
+    EXPECT_EQ(NONCE_OK, nonce_error);
+  }
+
+  {
+    // The same nonce is rejected when replayed.
+    bool called = false;
+    bool is_valid = false;
+    InsertStatus nonce_error = NONCE_UNKNOWN_FAILURE;
+    strike_register_->VerifyNonceIsValidAndUnique(
+        nonce,
+        QuicWallTime::FromUNIXSeconds(kCurrentTimeExternalSecs),
+        new RecordResultCallback(&called, &is_valid, &nonce_error));
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(is_valid);
+    EXPECT_EQ(NONCE_NOT_UNIQUE_FAILURE, nonce_error);
+  }
+
+  {
+    // A nonce whose random data differs only in the byte that selects the
+    // internal shard is still accepted.
+    bool called = false;
+    bool is_valid = false;
+    InsertStatus nonce_error = NONCE_UNKNOWN_FAILURE;
+    string other_nonce(nonce);
+    other_nonce[sizeof(norder) + kOrbitSize] = '\x18';
+    strike_register_->VerifyNonceIsValidAndUnique(
+        other_nonce,
+        QuicWallTime::FromUNIXSeconds(kCurrentTimeExternalSecs),
+        new RecordResultCallback(&called, &is_valid, &nonce_error));
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(is_valid);
+    EXPECT_EQ(NONCE_OK, nonce_error);
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
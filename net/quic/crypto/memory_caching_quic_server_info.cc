@@ -0,0 +1,157 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/memory_caching_quic_server_info.h"
+
+#include "base/bind.h"
+#include "base/stl_util.h"
+#include "net/base/net_errors.h"
+
+namespace net {
+
+namespace {
+
+void CopyState(const QuicServerInfo::State& from,
+               QuicServerInfo::State* to) {
+  to->server_config = from.server_config;
+  to->source_address_token = from.source_address_token;
+  to->certs = from.certs;
+  to->server_config_sig = from.server_config_sig;
+}
+
+}  // namespace
+
+MemoryCachingQuicServerInfo::MemoryCachingQuicServerInfo(
+    const QuicServerId& server_id,
+    scoped_ptr<QuicServerInfo> wrapped,
+    const base::WeakPtr<MemoryCachingQuicServerInfoFactory>& factory)
+    : QuicServerInfo(server_id),
+      wrapped_(wrapped.Pass()),
+      factory_(factory),
+      ready_(false),
+      weak_factory_(this) {
+  DCHECK(wrapped_.get());
+}
+
+MemoryCachingQuicServerInfo::~MemoryCachingQuicServerInfo() {
+}
+
+void MemoryCachingQuicServerInfo::Start() {
+  if (factory_ && factory_->Lookup(server_id_, mutable_state()))
+    ready_ = true;
+  // Start the wrapped tier regardless: on a memory hit it only warms the
+  // slower store so a later Persist() can write back without waiting for
+  // the load then.
+  wrapped_->Start();
+}
+
+int MemoryCachingQuicServerInfo::WaitForDataReady(
+    const CompletionCallback& callback) {
+  wait_for_data_start_time_ = base::TimeTicks::Now();
+  if (ready_) {
+    wait_for_data_end_time_ = wait_for_data_start_time_;
+    return OK;
+  }
+
+  int rv = wrapped_->WaitForDataReady(
+      base::Bind(&MemoryCachingQuicServerInfo::OnWrappedDataReady,
+                 weak_factory_.GetWeakPtr()));
+  if (rv == ERR_IO_PENDING) {
+    wait_callback_ = callback;
+    return rv;
+  }
+  OnWrappedDataReady(rv);
+  return rv;
+}
+
+void MemoryCachingQuicServerInfo::ResetWaitForDataReadyCallback() {
+  wait_callback_.Reset();
+  wrapped_->ResetWaitForDataReadyCallback();
+}
+
+void MemoryCachingQuicServerInfo::CancelWaitForDataReadyCallback() {
+  wait_callback_.Reset();
+  if (!ready_)
+    wrapped_->CancelWaitForDataReadyCallback();
+}
+
+bool MemoryCachingQuicServerInfo::IsDataReady() {
+  return ready_;
+}
+
+bool MemoryCachingQuicServerInfo::IsReadyToPersist() {
+  // The memory tier can always absorb a persist once the data is ready;
+  // flushing to the wrapped store happens asynchronously.
+  return ready_;
+}
+
+void MemoryCachingQuicServerInfo::Persist() {
+  DCHECK(ready_);
+  if (factory_)
+    factory_->Save(server_id_, state());
+
+  // Asynchronous writeback. The wrapped store buffers the data itself if
+  // its own load or a previous write is still in flight.
+  CopyState(state(), wrapped_->mutable_state());
+  wrapped_->Persist();
+}
+
+void MemoryCachingQuicServerInfo::OnExternalCacheHit() {
+  wrapped_->OnExternalCacheHit();
+}
+
+void MemoryCachingQuicServerInfo::OnWrappedDataReady(int result) {
+  wait_for_data_end_time_ = base::TimeTicks::Now();
+  if (result == OK && !ready_) {
+    CopyState(wrapped_->state(), mutable_state());
+    ready_ = true;
+    if (factory_)
+      factory_->Save(server_id_, state());
+  }
+  if (!wait_callback_.is_null()) {
+    CompletionCallback callback = wait_callback_;
+    wait_callback_.Reset();
+    callback.Run(result);
+  }
+}
+
+MemoryCachingQuicServerInfoFactory::MemoryCachingQuicServerInfoFactory(
+    scoped_ptr<QuicServerInfoFactory> wrapped)
+    : wrapped_(wrapped.Pass()), weak_factory_(this) {
+}
+
+MemoryCachingQuicServerInfoFactory::~MemoryCachingQuicServerInfoFactory() {
+  STLDeleteValues(&states_);
+}
+
+QuicServerInfo* MemoryCachingQuicServerInfoFactory::GetForServer(
+    const QuicServerId& server_id) {
+  scoped_ptr<QuicServerInfo> wrapped_info(
+      wrapped_->GetForServer(server_id));
+  if (!wrapped_info.get())
+    return NULL;
+  return new MemoryCachingQuicServerInfo(server_id, wrapped_info.Pass(),
+                                         weak_factory_.GetWeakPtr());
+}
+
+bool MemoryCachingQuicServerInfoFactory::Lookup(
+    const QuicServerId& server_id,
+    QuicServerInfo::State* state) {
+  StateMap::const_iterator it = states_.find(server_id);
+  if (it == states_.end())
+    return false;
+  CopyState(*it->second, state);
+  return true;
+}
+
+void MemoryCachingQuicServerInfoFactory::Save(
+    const QuicServerId& server_id,
+    const QuicServerInfo::State& state) {
+  QuicServerInfo::State*& entry = states_[server_id];
+  if (!entry)
+    entry = new QuicServerInfo::State();
+  CopyState(state, entry);
+}
+
+}  // namespace net
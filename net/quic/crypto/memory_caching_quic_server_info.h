@@ -0,0 +1,95 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CRYPTO_MEMORY_CACHING_QUIC_SERVER_INFO_H_
+#define NET_QUIC_CRYPTO_MEMORY_CACHING_QUIC_SERVER_INFO_H_
+
+#include <map>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/completion_callback.h"
+#include "net/base/net_export.h"
+#include "net/quic/crypto/quic_server_info.h"
+
+namespace net {
+
+class MemoryCachingQuicServerInfoFactory;
+
+// QuicServerInfo decorator that adds an always-resident memory tier in
+// front of a slower store such as DiskCacheBasedQuicServerInfo. For
+// origins already in the memory map, WaitForDataReady() answers
+// synchronously and 0-RTT handshake assembly never blocks on a
+// cache-thread read; Persist() updates the memory map immediately and
+// writes back to the wrapped store asynchronously. Misses fall through to
+// the wrapped info and populate the map on completion, so the map warms
+// with every origin this process talks to.
+class NET_EXPORT_PRIVATE MemoryCachingQuicServerInfo : public QuicServerInfo {
+ public:
+  // |wrapped| is the slower tier for the same server; may not be NULL.
+  MemoryCachingQuicServerInfo(
+      const QuicServerId& server_id,
+      scoped_ptr<QuicServerInfo> wrapped,
+      const base::WeakPtr<MemoryCachingQuicServerInfoFactory>& factory);
+  ~MemoryCachingQuicServerInfo() override;
+
+  // QuicServerInfo implementation.
+  void Start() override;
+  int WaitForDataReady(const CompletionCallback& callback) override;
+  void ResetWaitForDataReadyCallback() override;
+  void CancelWaitForDataReadyCallback() override;
+  bool IsDataReady() override;
+  bool IsReadyToPersist() override;
+  void Persist() override;
+  void OnExternalCacheHit() override;
+
+ private:
+  // Completion of the wrapped WaitForDataReady on a memory miss.
+  void OnWrappedDataReady(int result);
+
+  const scoped_ptr<QuicServerInfo> wrapped_;
+  const base::WeakPtr<MemoryCachingQuicServerInfoFactory> factory_;
+  bool ready_;
+  CompletionCallback wait_callback_;
+
+  base::WeakPtrFactory<MemoryCachingQuicServerInfo> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryCachingQuicServerInfo);
+};
+
+// Wraps another QuicServerInfoFactory and owns the shared memory map keyed
+// by server id. The map holds only server config data that the wrapped
+// store would persist anyway; nothing sensitive lives here.
+class NET_EXPORT_PRIVATE MemoryCachingQuicServerInfoFactory
+    : public QuicServerInfoFactory {
+ public:
+  explicit MemoryCachingQuicServerInfoFactory(
+      scoped_ptr<QuicServerInfoFactory> wrapped);
+  ~MemoryCachingQuicServerInfoFactory() override;
+
+  // QuicServerInfoFactory implementation.
+  QuicServerInfo* GetForServer(const QuicServerId& server_id) override;
+
+  // Copies the cached state for |server_id| into |state| and returns true,
+  // or returns false if the server is not in the memory map.
+  bool Lookup(const QuicServerId& server_id, QuicServerInfo::State* state);
+
+  // Saves a copy of |state| as the resident data for |server_id|.
+  void Save(const QuicServerId& server_id,
+            const QuicServerInfo::State& state);
+
+ private:
+  typedef std::map<QuicServerId, QuicServerInfo::State*> StateMap;
+
+  const scoped_ptr<QuicServerInfoFactory> wrapped_;
+  StateMap states_;
+
+  base::WeakPtrFactory<MemoryCachingQuicServerInfoFactory> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryCachingQuicServerInfoFactory);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CRYPTO_MEMORY_CACHING_QUIC_SERVER_INFO_H_
@@ -0,0 +1,182 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/memory_caching_quic_server_info.h"
+
+#include <string>
+
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/quic/crypto/quic_server_info.h"
+#include "net/quic/quic_server_id.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+namespace {
+
+const char kServerConfig[] = "server_config";
+const char kSourceAddressToken[] = "source_address_token";
+const char kServerConfigSig[] = "server_config_sig";
+const char kCert[] = "cert";
+
+// A wrapped tier that completes its load only when told to, standing in for
+// the disk cache read that the memory tier is meant to hide.
+class FakeSlowQuicServerInfo : public QuicServerInfo {
+ public:
+  explicit FakeSlowQuicServerInfo(const QuicServerId& server_id)
+      : QuicServerInfo(server_id), ready_(false), persist_count_(0) {}
+  ~FakeSlowQuicServerInfo() override {}
+
+  void Start() override {}
+
+  int WaitForDataReady(const CompletionCallback& callback) override {
+    if (ready_)
+      return OK;
+    callback_ = callback;
+    return ERR_IO_PENDING;
+  }
+
+  void ResetWaitForDataReadyCallback() override { callback_.Reset(); }
+  void CancelWaitForDataReadyCallback() override { callback_.Reset(); }
+  bool IsDataReady() override { return ready_; }
+  bool IsReadyToPersist() override { return ready_; }
+  void Persist() override { ++persist_count_; }
+  void OnExternalCacheHit() override {}
+
+  // Completes the pending load with |result|.
+  void CompleteLoad(int result) {
+    ready_ = (result == OK);
+    if (callback_.is_null())
+      return;
+    CompletionCallback callback = callback_;
+    callback_.Reset();
+    callback.Run(result);
+  }
+
+  int persist_count() const { return persist_count_; }
+
+ private:
+  bool ready_;
+  int persist_count_;
+  CompletionCallback callback_;
+};
+
+// Hands out FakeSlowQuicServerInfos and remembers the last one created.
+class FakeSlowQuicServerInfoFactory : public QuicServerInfoFactory {
+ public:
+  FakeSlowQuicServerInfoFactory() : last_info_(nullptr) {}
+
+  QuicServerInfo* GetForServer(const QuicServerId& server_id) override {
+    last_info_ = new FakeSlowQuicServerInfo(server_id);
+    return last_info_;
+  }
+
+  FakeSlowQuicServerInfo* last_info() const { return last_info_; }
+
+ private:
+  FakeSlowQuicServerInfo* last_info_;
+};
+
+class MemoryCachingQuicServerInfoTest : public ::testing::Test {
+ protected:
+  MemoryCachingQuicServerInfoTest()
+      : server_id_("www.google.com", 443, PRIVACY_MODE_DISABLED),
+        fake_factory_(new FakeSlowQuicServerInfoFactory),
+        factory_(make_scoped_ptr<QuicServerInfoFactory>(fake_factory_)) {}
+
+  void FillState(QuicServerInfo::State* state) {
+    state->server_config = kServerConfig;
+    state->source_address_token = kSourceAddressToken;
+    state->server_config_sig = kServerConfigSig;
+    state->certs.push_back(kCert);
+  }
+
+  void VerifyState(const QuicServerInfo::State& state) {
+    EXPECT_EQ(kServerConfig, state.server_config);
+    EXPECT_EQ(kSourceAddressToken, state.source_address_token);
+    EXPECT_EQ(kServerConfigSig, state.server_config_sig);
+    ASSERT_EQ(1u, state.certs.size());
+    EXPECT_EQ(kCert, state.certs[0]);
+  }
+
+  QuicServerId server_id_;
+  FakeSlowQuicServerInfoFactory* fake_factory_;  // Owned by |factory_|.
+  MemoryCachingQuicServerInfoFactory factory_;
+};
+
+// A miss falls through to the wrapped tier and populates the memory map, so
+// the next lookup for the same server is answered synchronously.
+TEST_F(MemoryCachingQuicServerInfoTest, MissThenMemoryHit) {
+  scoped_ptr<QuicServerInfo> info(factory_.GetForServer(server_id_));
+  FakeSlowQuicServerInfo* wrapped = fake_factory_->last_info();
+
+  info->Start();
+  EXPECT_FALSE(info->IsDataReady());
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_IO_PENDING, info->WaitForDataReady(callback.callback()));
+
+  FillState(wrapped->mutable_state());
+  wrapped->CompleteLoad(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_TRUE(info->IsDataReady());
+  VerifyState(info->state());
+
+  // A second info for the same server answers from memory, without waiting
+  // for its wrapped tier.
+  scoped_ptr<QuicServerInfo> info2(factory_.GetForServer(server_id_));
+  info2->Start();
+  EXPECT_TRUE(info2->IsDataReady());
+  EXPECT_EQ(OK, info2->WaitForDataReady(CompletionCallback()));
+  VerifyState(info2->state());
+}
+
+// Persist updates the memory map synchronously and writes back to the
+// wrapped tier.
+TEST_F(MemoryCachingQuicServerInfoTest, PersistUpdatesMemoryAndWritesBack) {
+  scoped_ptr<QuicServerInfo> info(factory_.GetForServer(server_id_));
+  FakeSlowQuicServerInfo* wrapped = fake_factory_->last_info();
+
+  info->Start();
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_IO_PENDING, info->WaitForDataReady(callback.callback()));
+  wrapped->CompleteLoad(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  FillState(info->mutable_state());
+  EXPECT_TRUE(info->IsReadyToPersist());
+  info->Persist();
+  EXPECT_EQ(1, wrapped->persist_count());
+  VerifyState(wrapped->state());
+
+  // The updated data is immediately visible to new lookups.
+  scoped_ptr<QuicServerInfo> info2(factory_.GetForServer(server_id_));
+  info2->Start();
+  EXPECT_TRUE(info2->IsDataReady());
+  VerifyState(info2->state());
+}
+
+// A failed load from the wrapped tier is reported to the caller and leaves
+// the memory map untouched.
+TEST_F(MemoryCachingQuicServerInfoTest, FailedLoadDoesNotPopulateMemory) {
+  scoped_ptr<QuicServerInfo> info(factory_.GetForServer(server_id_));
+  FakeSlowQuicServerInfo* wrapped = fake_factory_->last_info();
+
+  info->Start();
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_IO_PENDING, info->WaitForDataReady(callback.callback()));
+  wrapped->CompleteLoad(ERR_FAILED);
+  EXPECT_EQ(ERR_FAILED, callback.WaitForResult());
+  EXPECT_FALSE(info->IsDataReady());
+
+  scoped_ptr<QuicServerInfo> info2(factory_.GetForServer(server_id_));
+  info2->Start();
+  EXPECT_FALSE(info2->IsDataReady());
+}
+
+}  // namespace
+
+}  // namespace test
+}  // namespace net
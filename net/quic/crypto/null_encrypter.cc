@@ -34,9 +34,11 @@ bool NullEncrypter::EncryptPacket(QuicPacketNumber /*packet_number*/,
   uint128 hash = QuicUtils::FNV1a_128_Hash_Two(
       associated_data.data(), associated_data.size(), plaintext.data(),
       plaintext.size());
+  // The hash goes in front of the plaintext, so move the plaintext before
+  // writing the hash in case |output| aliases |plaintext|.
+  memmove(output + GetHashLength(), plaintext.data(), plaintext.length());
   QuicUtils::SerializeUint128Short(hash,
                                    reinterpret_cast<unsigned char*>(output));
-  memcpy(output + GetHashLength(), plaintext.data(), plaintext.length());
   *output_length = len;
   return true;
 }
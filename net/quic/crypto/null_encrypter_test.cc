@@ -33,6 +33,28 @@ TEST_F(NullEncrypterTest, Encrypt) {
       reinterpret_cast<const char*>(expected), arraysize(expected));
 }
 
+TEST_F(NullEncrypterTest, EncryptInPlace) {
+  unsigned char expected[] = {
+    // fnv hash
+    0xa0, 0x6f, 0x44, 0x8a,
+    0x44, 0xf8, 0x18, 0x3b,
+    0x47, 0x91, 0xb2, 0x13,
+    // payload
+    'g',  'o',  'o',  'd',
+    'b',  'y',  'e',  '!',
+  };
+  NullEncrypter encrypter;
+  char buffer[256];
+  memcpy(buffer, "goodbye!", 8);
+  size_t encrypted_len = 0;
+  ASSERT_TRUE(encrypter.EncryptPacket(0, "hello world!",
+                                      StringPiece(buffer, 8), buffer,
+                                      &encrypted_len, 256));
+  test::CompareCharArraysWithHexError(
+      "encrypted data", buffer, encrypted_len,
+      reinterpret_cast<const char*>(expected), arraysize(expected));
+}
+
 TEST_F(NullEncrypterTest, GetMaxPlaintextSize) {
   NullEncrypter encrypter;
   EXPECT_EQ(1000u, encrypter.GetMaxPlaintextSize(1012));
@@ -12,6 +12,7 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
+#include "crypto/sha2.h"
 #include "crypto/signature_verifier.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/net_errors.h"
@@ -20,6 +21,7 @@
 #include "net/cert/cert_status_flags.h"
 #include "net/cert/cert_verifier.h"
 #include "net/cert/cert_verify_result.h"
+#include "net/cert/crl_set.h"
 #include "net/cert/ct_verifier.h"
 #include "net/cert/x509_certificate.h"
 #include "net/cert/x509_util.h"
@@ -35,6 +37,46 @@ using std::vector;
 
 namespace net {
 
+namespace {
+
+// The maximum number of memoized proof verifications.
+const unsigned kMaxCacheEntries = 100;
+
+// How long a memoized verification stays valid. Kept short: a cached entry
+// skips re-checking revocation and pinning state, so it should only bridge
+// reconnect storms, not act as a long-lived verdict.
+const unsigned kCacheTTLSecs = 300;  // 5 minutes.
+
+// Appends |in| to |out| prefixed with its length, so that adjacent fields
+// cannot be confused for one another when the result is hashed.
+void AppendLengthPrefixed(const string& in, string* out) {
+  uint32 length = in.size();
+  out->append(reinterpret_cast<const char*>(&length), sizeof(length));
+  out->append(in);
+}
+
+// Returns the key under which a successful verification of the given proof
+// is memoized: the hostname together with a digest over every input that
+// contributed to the verification result.
+string GetProofCacheKey(const string& hostname,
+                        const string& server_config,
+                        const vector<string>& certs,
+                        const string& cert_sct,
+                        const string& signature,
+                        int cert_verify_flags) {
+  string to_hash;
+  AppendLengthPrefixed(server_config, &to_hash);
+  AppendLengthPrefixed(signature, &to_hash);
+  AppendLengthPrefixed(cert_sct, &to_hash);
+  for (size_t i = 0; i < certs.size(); i++) {
+    AppendLengthPrefixed(certs[i], &to_hash);
+  }
+  return hostname + StringPrintf("/%d/", cert_verify_flags) +
+         crypto::SHA256HashString(to_hash);
+}
+
+}  // namespace
+
 ProofVerifyDetails* ProofVerifyDetailsChromium::Clone() const {
   ProofVerifyDetailsChromium* other = new ProofVerifyDetailsChromium;
   other->cert_verify_result = cert_verify_result;
@@ -380,12 +422,53 @@ bool ProofVerifierChromium::Job::VerifySignature(const string& signed_data,
   return true;
 }
 
+// A CachingCallback wraps the caller's callback so that a successful
+// asynchronous verification is memoized before it is reported. It assumes
+// ownership of the wrapped callback only once the job goes asynchronous,
+// mirroring the ownership contract of VerifyProof.
+class ProofVerifierChromium::CachingCallback : public ProofVerifierCallback {
+ public:
+  CachingCallback(ProofVerifierChromium* proof_verifier,
+                  const std::string& cache_key,
+                  ProofVerifierCallback* inner)
+      : proof_verifier_(proof_verifier),
+        cache_key_(cache_key),
+        inner_(inner) {}
+
+  void Run(bool ok,
+           const std::string& error_details,
+           scoped_ptr<ProofVerifyDetails>* details) override {
+    if (ok) {
+      proof_verifier_->CacheProof(
+          cache_key_,
+          *static_cast<const ProofVerifyDetailsChromium*>(details->get()));
+    }
+    inner_->Run(ok, error_details, details);
+  }
+
+  // Relinquishes the wrapped callback on the synchronous completion paths,
+  // where the caller retains ownership of it.
+  ProofVerifierCallback* release_inner() { return inner_.release(); }
+
+ private:
+  ProofVerifierChromium* const proof_verifier_;
+  const std::string cache_key_;
+  scoped_ptr<ProofVerifierCallback> inner_;
+
+  DISALLOW_COPY_AND_ASSIGN(CachingCallback);
+};
+
+ProofVerifierChromium::CachedProof::CachedProof() {}
+
+ProofVerifierChromium::CachedProof::~CachedProof() {}
+
 ProofVerifierChromium::ProofVerifierChromium(
     CertVerifier* cert_verifier,
     CertPolicyEnforcer* cert_policy_enforcer,
     TransportSecurityState* transport_security_state,
     CTVerifier* cert_transparency_verifier)
-    : cert_verifier_(cert_verifier),
+    : proof_cache_(kMaxCacheEntries),
+      cert_verifier_(cert_verifier),
       cert_policy_enforcer_(cert_policy_enforcer),
       transport_security_state_(transport_security_state),
       cert_transparency_verifier_(cert_transparency_verifier) {}
@@ -410,19 +493,55 @@ QuicAsyncStatus ProofVerifierChromium::VerifyProof(
   }
   const ProofVerifyContextChromium* chromium_context =
       reinterpret_cast<const ProofVerifyContextChromium*>(verify_context);
+
+  const std::string cache_key =
+      GetProofCacheKey(hostname, server_config, certs, cert_sct, signature,
+                       chromium_context->cert_verify_flags);
+  const CachedProof* cached =
+      proof_cache_.Get(cache_key, base::TimeTicks::Now());
+  if (cached &&
+      cached->crl_set.get() == SSLConfigService::GetCRLSet().get()) {
+    // The identical proof recently verified successfully against the current
+    // CRLSet; reuse that result instead of spawning another job.
+    verify_details->reset(cached->details.Clone());
+    return QUIC_SUCCESS;
+  }
+
   scoped_ptr<Job> job(
       new Job(this, cert_verifier_, cert_policy_enforcer_,
               transport_security_state_, cert_transparency_verifier_,
               chromium_context->cert_verify_flags, chromium_context->net_log));
+  scoped_ptr<CachingCallback> caching_callback(
+      new CachingCallback(this, cache_key, callback));
   QuicAsyncStatus status =
       job->VerifyProof(hostname, server_config, certs, cert_sct, signature,
-                       error_details, verify_details, callback);
+                       error_details, verify_details, caching_callback.get());
   if (status == QUIC_PENDING) {
+    ignore_result(caching_callback.release());  // Owned by the job now.
     active_jobs_.insert(job.release());
+    return status;
+  }
+  // On synchronous completion the caller keeps ownership of |callback|, so
+  // hand it back before the wrapper is destroyed.
+  ignore_result(caching_callback->release_inner());
+  if (status == QUIC_SUCCESS) {
+    CacheProof(cache_key, *static_cast<const ProofVerifyDetailsChromium*>(
+                              verify_details->get()));
   }
   return status;
 }
 
+void ProofVerifierChromium::CacheProof(
+    const std::string& cache_key,
+    const ProofVerifyDetailsChromium& verify_details) {
+  CachedProof cached;
+  cached.details = verify_details;
+  cached.crl_set = SSLConfigService::GetCRLSet();
+  const base::TimeTicks now = base::TimeTicks::Now();
+  proof_cache_.Put(cache_key, cached, now,
+                   now + base::TimeDelta::FromSeconds(kCacheTTLSecs));
+}
+
 void ProofVerifierChromium::OnJobComplete(Job* job) {
   active_jobs_.erase(job);
   delete job;
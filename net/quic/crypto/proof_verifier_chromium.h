@@ -11,7 +11,10 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "net/base/expiring_cache.h"
 #include "net/base/net_export.h"
 #include "net/cert/cert_verify_result.h"
 #include "net/cert/ct_verify_result.h"
@@ -23,6 +26,7 @@ namespace net {
 
 class CertPolicyEnforcer;
 class CertVerifier;
+class CRLSet;
 class CTVerifier;
 class TransportSecurityState;
 
@@ -77,14 +81,41 @@ class NET_EXPORT_PRIVATE ProofVerifierChromium : public ProofVerifier {
                               ProofVerifierCallback* callback) override;
 
  private:
+  class CachingCallback;
   class Job;
   typedef std::set<Job*> JobSet;
 
+  // A memoized successful verification. The CRLSet that was current when the
+  // proof was verified is recorded so that the entry can be ignored once a
+  // new CRLSet is loaded.
+  struct CachedProof {
+    CachedProof();
+    ~CachedProof();
+
+    ProofVerifyDetailsChromium details;
+    scoped_refptr<CRLSet> crl_set;
+  };
+
+  typedef ExpiringCache<std::string,
+                        CachedProof,
+                        base::TimeTicks,
+                        std::less<base::TimeTicks>> ProofCache;
+
   void OnJobComplete(Job* job);
 
+  // Memoizes the successful verification of the proof identified by
+  // |cache_key|, so that an identical proof presented within the cache TTL
+  // does not spawn another verification job.
+  void CacheProof(const std::string& cache_key,
+                  const ProofVerifyDetailsChromium& verify_details);
+
   // Set owning pointers to active jobs.
   JobSet active_jobs_;
 
+  // Results of recent successful verifications, keyed by hostname and a
+  // digest of the proof inputs.
+  ProofCache proof_cache_;
+
   // Underlying verifier used to verify certificates.
   CertVerifier* const cert_verifier_;
   CertPolicyEnforcer* const cert_policy_enforcer_;
@@ -50,6 +50,36 @@ class FailsTestCertVerifier : public CertVerifier {
   }
 };
 
+// CertVerifier that delegates to another verifier while counting the calls,
+// used to observe whether a verification was served from the proof cache.
+class CountingCertVerifier : public CertVerifier {
+ public:
+  explicit CountingCertVerifier(CertVerifier* wrapped)
+      : wrapped_(wrapped), num_verifications_(0) {}
+  ~CountingCertVerifier() override {}
+
+  // CertVerifier implementation
+  int Verify(X509Certificate* cert,
+             const std::string& hostname,
+             const std::string& ocsp_response,
+             int flags,
+             CRLSet* crl_set,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             scoped_ptr<CertVerifier::Request>* out_req,
+             const BoundNetLog& net_log) override {
+    ++num_verifications_;
+    return wrapped_->Verify(cert, hostname, ocsp_response, flags, crl_set,
+                            verify_result, callback, out_req, net_log);
+  }
+
+  int num_verifications() const { return num_verifications_; }
+
+ private:
+  CertVerifier* wrapped_;
+  int num_verifications_;
+};
+
 // CertPolicyEnforcer that will fail the test if it is ever called.
 class FailsTestCertPolicyEnforcer : public CertPolicyEnforcer {
  public:
@@ -426,5 +456,75 @@ TEST_F(ProofVerifierChromiumTest, IgnoresPolicyEnforcerIfNotEV) {
   EXPECT_EQ(0u, verify_details->cert_verify_result.cert_status);
 }
 
+// Tests that a successful verification is reused for an identical proof
+// presented again within the cache TTL, without consulting the CertVerifier
+// a second time, and that a different hostname misses the cache.
+TEST_F(ProofVerifierChromiumTest, MemoizesSuccessfulVerification) {
+  scoped_refptr<X509Certificate> test_cert = GetTestServerCertificate();
+  ASSERT_TRUE(test_cert);
+
+  CertVerifyResult dummy_result;
+  dummy_result.verified_cert = test_cert;
+  dummy_result.cert_status = 0;
+
+  MockCertVerifier dummy_verifier;
+  dummy_verifier.AddResultForCert(test_cert.get(), dummy_result, OK);
+  CountingCertVerifier counting_verifier(&dummy_verifier);
+
+  ProofVerifierChromium proof_verifier(&counting_verifier, nullptr, nullptr,
+                                       ct_verifier_.get());
+
+  scoped_ptr<DummyProofVerifierCallback> callback(
+      new DummyProofVerifierCallback);
+  QuicAsyncStatus status = proof_verifier.VerifyProof(
+      kTestHostname, kTestConfig, certs_, "", GetTestSignature(),
+      verify_context_.get(), &error_details_, &details_, callback.get());
+  ASSERT_EQ(QUIC_SUCCESS, status);
+  EXPECT_EQ(1, counting_verifier.num_verifications());
+
+  // The identical proof is served from the cache.
+  callback.reset(new DummyProofVerifierCallback);
+  status = proof_verifier.VerifyProof(
+      kTestHostname, kTestConfig, certs_, "", GetTestSignature(),
+      verify_context_.get(), &error_details_, &details_, callback.get());
+  ASSERT_EQ(QUIC_SUCCESS, status);
+  EXPECT_EQ(1, counting_verifier.num_verifications());
+
+  ASSERT_TRUE(details_.get());
+  ProofVerifyDetailsChromium* verify_details =
+      static_cast<ProofVerifyDetailsChromium*>(details_.get());
+  EXPECT_EQ(dummy_result.cert_status,
+            verify_details->cert_verify_result.cert_status);
+
+  // The same proof for a different hostname misses the cache.
+  callback.reset(new DummyProofVerifierCallback);
+  status = proof_verifier.VerifyProof(
+      "other.example.com", kTestConfig, certs_, "", GetTestSignature(),
+      verify_context_.get(), &error_details_, &details_, callback.get());
+  ASSERT_EQ(QUIC_SUCCESS, status);
+  EXPECT_EQ(2, counting_verifier.num_verifications());
+}
+
+// Tests that failed verifications are not memoized: each attempt reaches the
+// CertVerifier again.
+TEST_F(ProofVerifierChromiumTest, DoesNotMemoizeFailedVerification) {
+  // A MockCertVerifier with no configured results fails every verification.
+  MockCertVerifier dummy_verifier;
+  CountingCertVerifier counting_verifier(&dummy_verifier);
+
+  ProofVerifierChromium proof_verifier(&counting_verifier, nullptr, nullptr,
+                                       ct_verifier_.get());
+
+  for (int i = 0; i < 2; ++i) {
+    scoped_ptr<DummyProofVerifierCallback> callback(
+        new DummyProofVerifierCallback);
+    QuicAsyncStatus status = proof_verifier.VerifyProof(
+        kTestHostname, kTestConfig, certs_, "", GetTestSignature(),
+        verify_context_.get(), &error_details_, &details_, callback.get());
+    ASSERT_EQ(QUIC_FAILURE, status);
+  }
+  EXPECT_EQ(2, counting_verifier.num_verifications());
+}
+
 }  // namespace test
 }  // namespace net
@@ -0,0 +1,80 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/quic_compressed_certs_cache.h"
+
+using std::string;
+using std::vector;
+
+namespace net {
+
+namespace {
+
+// AppendSized appends |data|'s length and then its bytes to |key|, so that
+// concatenated components can't be confused with one another.
+void AppendSized(const string& data, string* key) {
+  uint32 length = data.size();
+  key->append(reinterpret_cast<const char*>(&length), sizeof(length));
+  key->append(data);
+}
+
+}  // namespace
+
+QuicCompressedCertsCache::QuicCompressedCertsCache(size_t max_entries)
+    : certs_cache_(max_entries) {}
+
+QuicCompressedCertsCache::~QuicCompressedCertsCache() {}
+
+const string* QuicCompressedCertsCache::GetCompressedCert(
+    const vector<string>& certs,
+    const string& client_common_set_hashes,
+    const string& client_cached_cert_hashes,
+    const void* common_sets_identity) {
+  base::MRUCache<string, string>::iterator it =
+      certs_cache_.Get(MakeKey(certs, client_common_set_hashes,
+                               client_cached_cert_hashes,
+                               common_sets_identity));
+  if (it == certs_cache_.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void QuicCompressedCertsCache::Insert(
+    const vector<string>& certs,
+    const string& client_common_set_hashes,
+    const string& client_cached_cert_hashes,
+    const void* common_sets_identity,
+    const string& compressed_cert) {
+  certs_cache_.Put(MakeKey(certs, client_common_set_hashes,
+                           client_cached_cert_hashes, common_sets_identity),
+                   compressed_cert);
+}
+
+size_t QuicCompressedCertsCache::Size() const {
+  return certs_cache_.size();
+}
+
+size_t QuicCompressedCertsCache::MaxSize() const {
+  return certs_cache_.max_size();
+}
+
+// static
+string QuicCompressedCertsCache::MakeKey(
+    const vector<string>& certs,
+    const string& client_common_set_hashes,
+    const string& client_cached_cert_hashes,
+    const void* common_sets_identity) {
+  string key;
+  for (size_t i = 0; i < certs.size(); i++) {
+    AppendSized(certs[i], &key);
+  }
+  AppendSized(client_common_set_hashes, &key);
+  AppendSized(client_cached_cert_hashes, &key);
+  key.append(reinterpret_cast<const char*>(&common_sets_identity),
+             sizeof(common_sets_identity));
+  return key;
+}
+
+}  // namespace net
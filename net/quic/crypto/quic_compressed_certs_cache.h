@@ -0,0 +1,66 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CRYPTO_QUIC_COMPRESSED_CERTS_CACHE_H_
+#define NET_QUIC_CRYPTO_QUIC_COMPRESSED_CERTS_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// QuicCompressedCertsCache remembers the output of
+// CertCompressor::CompressChain so that the zlib deflate of a certificate
+// chain is paid once per unique (chain, client hints) combination rather
+// than once per handshake. The cache is not thread safe; callers are
+// expected to synchronize access.
+class NET_EXPORT_PRIVATE QuicCompressedCertsCache {
+ public:
+  explicit QuicCompressedCertsCache(size_t max_entries);
+  ~QuicCompressedCertsCache();
+
+  // Returns the cached compressed representation of |certs| for a client
+  // that presented |client_common_set_hashes| and
+  // |client_cached_cert_hashes|, or nullptr if none is cached.
+  // |common_sets_identity| distinguishes entries built against different
+  // common certificate sets. The returned pointer is only valid until the
+  // next call to Insert.
+  const std::string* GetCompressedCert(
+      const std::vector<std::string>& certs,
+      const std::string& client_common_set_hashes,
+      const std::string& client_cached_cert_hashes,
+      const void* common_sets_identity);
+
+  // Caches |compressed_cert| as the compressed representation of |certs|
+  // for the given client hints, evicting the least recently used entry if
+  // the cache is full.
+  void Insert(const std::vector<std::string>& certs,
+              const std::string& client_common_set_hashes,
+              const std::string& client_cached_cert_hashes,
+              const void* common_sets_identity,
+              const std::string& compressed_cert);
+
+  size_t Size() const;
+  size_t MaxSize() const;
+
+ private:
+  // Builds the lookup key from the inputs. Every component is length
+  // prefixed, so distinct inputs cannot produce the same key.
+  static std::string MakeKey(const std::vector<std::string>& certs,
+                             const std::string& client_common_set_hashes,
+                             const std::string& client_cached_cert_hashes,
+                             const void* common_sets_identity);
+
+  base::MRUCache<std::string, std::string> certs_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicCompressedCertsCache);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CRYPTO_QUIC_COMPRESSED_CERTS_CACHE_H_
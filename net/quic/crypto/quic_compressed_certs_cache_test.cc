@@ -0,0 +1,98 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/quic_compressed_certs_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::string;
+using std::vector;
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicCompressedCertsCacheTest : public ::testing::Test {
+ protected:
+  QuicCompressedCertsCacheTest() : cache_(2) {}
+
+  QuicCompressedCertsCache cache_;
+};
+
+TEST_F(QuicCompressedCertsCacheTest, CacheHit) {
+  vector<string> certs;
+  certs.push_back("leaf cert");
+  certs.push_back("intermediate cert");
+  const string common_set_hashes = "common set hashes";
+  const string cached_cert_hashes = "cached cert hashes";
+  const string compressed = "compressed cert";
+
+  cache_.Insert(certs, common_set_hashes, cached_cert_hashes, nullptr,
+                compressed);
+
+  const string* cached = cache_.GetCompressedCert(
+      certs, common_set_hashes, cached_cert_hashes, nullptr);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(compressed, *cached);
+}
+
+TEST_F(QuicCompressedCertsCacheTest, CacheMiss) {
+  vector<string> certs;
+  certs.push_back("leaf cert");
+  certs.push_back("intermediate cert");
+  const string common_set_hashes = "common set hashes";
+  const string cached_cert_hashes = "cached cert hashes";
+
+  cache_.Insert(certs, common_set_hashes, cached_cert_hashes, nullptr,
+                "compressed cert");
+
+  EXPECT_EQ(nullptr,
+            cache_.GetCompressedCert(certs, "wrong common set hashes",
+                                     cached_cert_hashes, nullptr));
+  EXPECT_EQ(nullptr,
+            cache_.GetCompressedCert(certs, common_set_hashes,
+                                     "wrong cached cert hashes", nullptr));
+
+  vector<string> other_certs;
+  other_certs.push_back("leaf cert");
+  EXPECT_EQ(nullptr, cache_.GetCompressedCert(other_certs, common_set_hashes,
+                                              cached_cert_hashes, nullptr));
+
+  // The same inputs compressed against a different common cert set are a
+  // different entry.
+  int set_a, set_b;
+  cache_.Insert(certs, common_set_hashes, cached_cert_hashes, &set_a,
+                "compressed against set a");
+  EXPECT_EQ(nullptr, cache_.GetCompressedCert(certs, common_set_hashes,
+                                              cached_cert_hashes, &set_b));
+}
+
+TEST_F(QuicCompressedCertsCacheTest, CacheMissDueToEviction) {
+  vector<string> certs;
+  certs.push_back("leaf cert");
+  const string common_set_hashes = "common set hashes";
+  const string cached_cert_hashes = "cached cert hashes";
+
+  cache_.Insert(certs, common_set_hashes, cached_cert_hashes, nullptr,
+                "compressed cert");
+
+  // Inserting more entries than the cache can hold evicts the oldest.
+  for (unsigned i = 0; i < cache_.MaxSize(); i++) {
+    vector<string> other_certs;
+    other_certs.push_back("leaf cert " + string(1, 'a' + i));
+    cache_.Insert(other_certs, common_set_hashes, cached_cert_hashes, nullptr,
+                  "compressed cert");
+  }
+  EXPECT_EQ(cache_.MaxSize(), cache_.Size());
+
+  EXPECT_EQ(nullptr, cache_.GetCompressedCert(certs, common_set_hashes,
+                                              cached_cert_hashes, nullptr));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -58,6 +58,10 @@ const size_t kMultiplier = 3;
 
 const int kMaxTokenAddresses = 4;
 
+// kCompressedCertsCacheSize is the bound on the number of compressed
+// certificate chain representations kept by compressed_certs_cache_.
+const size_t kCompressedCertsCacheSize = 225;
+
 string DeriveSourceAddressTokenKey(StringPiece source_address_token_secret) {
   crypto::HKDF hkdf(source_address_token_secret,
                     StringPiece() /* no salt */,
@@ -221,8 +225,9 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
     : replay_protection_(true),
       chlo_multiplier_(kMultiplier),
       configs_lock_(),
-      primary_config_(nullptr),
-      next_config_promotion_time_(QuicWallTime::Zero()),
+      snapshot_(new ConfigSnapshot),
+      compressed_certs_cache_lock_(),
+      compressed_certs_cache_(kCompressedCertsCacheSize),
       server_nonce_strike_register_lock_(),
       proof_source_(proof_source),
       strike_register_no_startup_period_(false),
@@ -249,7 +254,7 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
 }
 
 QuicCryptoServerConfig::~QuicCryptoServerConfig() {
-  primary_config_ = nullptr;
+  snapshot_ = nullptr;
 }
 
 // static
@@ -384,17 +389,23 @@ CryptoHandshakeMessage* QuicCryptoServerConfig::AddConfig(
 
   {
     base::AutoLock locked(configs_lock_);
-    if (configs_.find(config->id) != configs_.end()) {
+    if (snapshot_->configs.find(config->id) != snapshot_->configs.end()) {
       LOG(WARNING) << "Failed to add config because another with the same "
                       "server config id already exists: "
                    << base::HexEncode(config->id.data(), config->id.size());
       return nullptr;
     }
 
-    configs_[config->id] = config;
-    SelectNewPrimaryConfig(now);
-    DCHECK(primary_config_.get());
-    DCHECK_EQ(configs_.find(primary_config_->id)->second, primary_config_);
+    scoped_refptr<ConfigSnapshot> new_snapshot(new ConfigSnapshot);
+    new_snapshot->configs = snapshot_->configs;
+    new_snapshot->primary_config = snapshot_->primary_config;
+    new_snapshot->configs[config->id] = config;
+    SelectNewPrimaryConfig(new_snapshot.get(), now);
+    DCHECK(new_snapshot->primary_config.get());
+    DCHECK_EQ(new_snapshot->configs.find(new_snapshot->primary_config->id)
+                  ->second,
+              new_snapshot->primary_config);
+    snapshot_ = new_snapshot;
   }
 
   return msg.release();
@@ -437,15 +448,17 @@ bool QuicCryptoServerConfig::SetConfigs(
     VLOG(1) << "Updating configs:";
 
     base::AutoLock locked(configs_lock_);
-    ConfigMap new_configs;
+    scoped_refptr<ConfigSnapshot> new_snapshot(new ConfigSnapshot);
+    new_snapshot->primary_config = snapshot_->primary_config;
+    ConfigMap& new_configs = new_snapshot->configs;
 
     for (vector<scoped_refptr<Config> >::const_iterator i =
              parsed_configs.begin();
          i != parsed_configs.end(); ++i) {
       scoped_refptr<Config> config = *i;
 
-      ConfigMap::iterator it = configs_.find(config->id);
-      if (it != configs_.end()) {
+      ConfigMap::iterator it = snapshot_->configs.find(config->id);
+      if (it != snapshot_->configs.end()) {
         VLOG(1)
             << "Keeping scid: " << base::HexEncode(
                 config->id.data(), config->id.size())
@@ -470,19 +483,25 @@ bool QuicCryptoServerConfig::SetConfigs(
       }
     }
 
-    configs_.swap(new_configs);
-    SelectNewPrimaryConfig(now);
-    DCHECK(primary_config_.get());
-    DCHECK_EQ(configs_.find(primary_config_->id)->second, primary_config_);
+    SelectNewPrimaryConfig(new_snapshot.get(), now);
+    DCHECK(new_snapshot->primary_config.get());
+    DCHECK_EQ(new_snapshot->configs.find(new_snapshot->primary_config->id)
+                  ->second,
+              new_snapshot->primary_config);
+    snapshot_ = new_snapshot;
   }
 
   return ok;
 }
 
 void QuicCryptoServerConfig::GetConfigIds(vector<string>* scids) const {
-  base::AutoLock locked(configs_lock_);
-  for (ConfigMap::const_iterator it = configs_.begin();
-       it != configs_.end(); ++it) {
+  scoped_refptr<ConfigSnapshot> snapshot;
+  {
+    base::AutoLock locked(configs_lock_);
+    snapshot = snapshot_;
+  }
+  for (ConfigMap::const_iterator it = snapshot->configs.begin();
+       it != snapshot->configs.end(); ++it) {
     scids->push_back(it->first);
   }
 }
@@ -505,30 +524,21 @@ void QuicCryptoServerConfig::ValidateClientHello(
   client_hello.GetStringPiece(kSCID, &requested_scid);
 
   uint8 primary_orbit[kOrbitSize];
-  scoped_refptr<Config> requested_config;
-  scoped_refptr<Config> primary_config;
-  {
-    base::AutoLock locked(configs_lock_);
+  scoped_refptr<ConfigSnapshot> snapshot = GetSnapshot(now);
 
-    if (!primary_config_.get()) {
-      result->error_code = QUIC_CRYPTO_INTERNAL_ERROR;
-      result->error_details = "No configurations loaded";
-    } else {
-      if (!next_config_promotion_time_.IsZero() &&
-          next_config_promotion_time_.IsAfter(now)) {
-        SelectNewPrimaryConfig(now);
-        DCHECK(primary_config_.get());
-        DCHECK_EQ(configs_.find(primary_config_->id)->second, primary_config_);
-      }
-
-      memcpy(primary_orbit, primary_config_->orbit, sizeof(primary_orbit));
-    }
-
-    requested_config = GetConfigWithScid(requested_scid);
-    primary_config = primary_config_;
-    crypto_proof->primary_scid = primary_config->id;
+  if (!snapshot->primary_config.get()) {
+    result->error_code = QUIC_CRYPTO_INTERNAL_ERROR;
+    result->error_details = "No configurations loaded";
+  } else {
+    memcpy(primary_orbit, snapshot->primary_config->orbit,
+           sizeof(primary_orbit));
   }
 
+  scoped_refptr<Config> requested_config =
+      GetConfigWithScid(*snapshot, requested_scid);
+  scoped_refptr<Config> primary_config = snapshot->primary_config;
+  crypto_proof->primary_scid = primary_config->id;
+
   if (result->error_code == QUIC_NO_ERROR) {
     EvaluateClientHello(server_ip, version, primary_orbit, requested_config,
                         primary_config, crypto_proof, result, done_cb);
@@ -567,40 +577,31 @@ QuicErrorCode QuicCryptoServerConfig::ProcessClientHello(
   client_hello.GetStringPiece(kSCID, &requested_scid);
   const QuicWallTime now(clock->WallNow());
 
-  scoped_refptr<Config> requested_config;
-  scoped_refptr<Config> primary_config;
-  {
-    base::AutoLock locked(configs_lock_);
+  scoped_refptr<ConfigSnapshot> snapshot = GetSnapshot(now);
 
-    if (!primary_config_.get()) {
-      *error_details = "No configurations loaded";
-      return QUIC_CRYPTO_INTERNAL_ERROR;
-    }
-
-    if (!next_config_promotion_time_.IsZero() &&
-        next_config_promotion_time_.IsAfter(now)) {
-      SelectNewPrimaryConfig(now);
-      DCHECK(primary_config_.get());
-      DCHECK_EQ(configs_.find(primary_config_->id)->second, primary_config_);
-    }
+  if (!snapshot->primary_config.get()) {
+    *error_details = "No configurations loaded";
+    return QUIC_CRYPTO_INTERNAL_ERROR;
+  }
 
-    // We'll use the config that the client requested in order to do
-    // key-agreement. Otherwise we'll give it a copy of |primary_config_|
-    // to use.
-    if (FLAGS_quic_use_primary_config_for_proof) {
-      primary_config = GetConfigWithScid(crypto_proof->primary_scid);
-      if (!primary_config) {
-        *error_details = "Configuration not found";
-        LOG(DFATAL) << "Primary config not found";
-        return QUIC_CRYPTO_INTERNAL_ERROR;
-      }
-    } else {
-      primary_config = primary_config_;
+  // We'll use the config that the client requested in order to do
+  // key-agreement. Otherwise we'll give it a copy of the primary config
+  // to use.
+  scoped_refptr<Config> primary_config;
+  if (FLAGS_quic_use_primary_config_for_proof) {
+    primary_config = GetConfigWithScid(*snapshot, crypto_proof->primary_scid);
+    if (!primary_config) {
+      *error_details = "Configuration not found";
+      LOG(DFATAL) << "Primary config not found";
+      return QUIC_CRYPTO_INTERNAL_ERROR;
     }
-
-    requested_config = GetConfigWithScid(requested_scid);
+  } else {
+    primary_config = snapshot->primary_config;
   }
 
+  scoped_refptr<Config> requested_config =
+      GetConfigWithScid(*snapshot, requested_scid);
+
   if (validate_chlo_result.error_code != QUIC_NO_ERROR) {
     *error_details = validate_chlo_result.error_details;
     return validate_chlo_result.error_code;
@@ -851,15 +852,54 @@ QuicErrorCode QuicCryptoServerConfig::ProcessClientHello(
   return QUIC_NO_ERROR;
 }
 
-scoped_refptr<QuicCryptoServerConfig::Config>
-QuicCryptoServerConfig::GetConfigWithScid(StringPiece requested_scid) const {
-  // In Chromium, we will dead lock if the lock is held by the current thread.
-  // Chromium doesn't have AssertReaderHeld API call.
-  // configs_lock_.AssertReaderHeld();
+scoped_refptr<QuicCryptoServerConfig::ConfigSnapshot>
+QuicCryptoServerConfig::GetSnapshot(QuicWallTime now) const {
+  scoped_refptr<ConfigSnapshot> snapshot;
+  {
+    base::AutoLock locked(configs_lock_);
+    snapshot = snapshot_;
+  }
+
+  if (snapshot->primary_config.get() &&
+      !snapshot->next_config_promotion_time.IsZero() &&
+      snapshot->next_config_promotion_time.IsAfter(now)) {
+    return PromotePrimaryConfig(now);
+  }
 
+  return snapshot;
+}
+
+scoped_refptr<QuicCryptoServerConfig::ConfigSnapshot>
+QuicCryptoServerConfig::PromotePrimaryConfig(QuicWallTime now) const {
+  base::AutoLock locked(configs_lock_);
+
+  // Re-check now that the lock is held: another thread may have published a
+  // rotated snapshot already.
+  if (snapshot_->primary_config.get() &&
+      !snapshot_->next_config_promotion_time.IsZero() &&
+      snapshot_->next_config_promotion_time.IsAfter(now)) {
+    scoped_refptr<ConfigSnapshot> new_snapshot(new ConfigSnapshot);
+    new_snapshot->configs = snapshot_->configs;
+    new_snapshot->primary_config = snapshot_->primary_config;
+    SelectNewPrimaryConfig(new_snapshot.get(), now);
+    DCHECK(new_snapshot->primary_config.get());
+    DCHECK_EQ(new_snapshot->configs.find(new_snapshot->primary_config->id)
+                  ->second,
+              new_snapshot->primary_config);
+    snapshot_ = new_snapshot;
+  }
+
+  return snapshot_;
+}
+
+// static
+scoped_refptr<QuicCryptoServerConfig::Config>
+QuicCryptoServerConfig::GetConfigWithScid(const ConfigSnapshot& snapshot,
+                                          StringPiece requested_scid) {
   if (!requested_scid.empty()) {
-    ConfigMap::const_iterator it = configs_.find(requested_scid.as_string());
-    if (it != configs_.end()) {
+    ConfigMap::const_iterator it =
+        snapshot.configs.find(requested_scid.as_string());
+    if (it != snapshot.configs.end()) {
       // We'll use the config that the client requested in order to do
       // key-agreement.
       return scoped_refptr<Config>(it->second);
@@ -889,18 +929,19 @@ bool QuicCryptoServerConfig::ConfigPrimaryTimeLessThan(
 }
 
 void QuicCryptoServerConfig::SelectNewPrimaryConfig(
+    ConfigSnapshot* snapshot,
     const QuicWallTime now) const {
   vector<scoped_refptr<Config> > configs;
-  configs.reserve(configs_.size());
+  configs.reserve(snapshot->configs.size());
 
-  for (ConfigMap::const_iterator it = configs_.begin();
-       it != configs_.end(); ++it) {
+  for (ConfigMap::const_iterator it = snapshot->configs.begin();
+       it != snapshot->configs.end(); ++it) {
     // TODO(avd) Exclude expired configs?
     configs.push_back(it->second);
   }
 
   if (configs.empty()) {
-    if (primary_config_.get()) {
+    if (snapshot->primary_config.get()) {
       LOG(DFATAL) << "No valid QUIC server config. Keeping the current config.";
     } else {
       LOG(DFATAL) << "No valid QUIC server config.";
@@ -923,30 +964,30 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
 
     // This is the first config with a primary_time in the future. Thus the
     // previous Config should be the primary and this one should determine the
-    // next_config_promotion_time_.
+    // next_config_promotion_time.
     scoped_refptr<Config> new_primary(best_candidate);
     if (i == 0) {
       // We need the primary_time of the next config.
       if (configs.size() > 1) {
-        next_config_promotion_time_ = configs[1]->primary_time;
+        snapshot->next_config_promotion_time = configs[1]->primary_time;
       } else {
-        next_config_promotion_time_ = QuicWallTime::Zero();
+        snapshot->next_config_promotion_time = QuicWallTime::Zero();
       }
     } else {
-      next_config_promotion_time_ = config->primary_time;
+      snapshot->next_config_promotion_time = config->primary_time;
     }
 
-    if (primary_config_.get()) {
-      primary_config_->is_primary = false;
+    if (snapshot->primary_config.get()) {
+      snapshot->primary_config->is_primary = false;
     }
-    primary_config_ = new_primary;
+    snapshot->primary_config = new_primary;
     new_primary->is_primary = true;
     DVLOG(1) << "New primary config.  orbit: "
              << base::HexEncode(
-                 reinterpret_cast<const char*>(primary_config_->orbit),
+                 reinterpret_cast<const char*>(new_primary->orbit),
                  kOrbitSize);
     if (primary_config_changed_cb_.get() != nullptr) {
-      primary_config_changed_cb_->Run(primary_config_->id);
+      primary_config_changed_cb_->Run(new_primary->id);
     }
 
     return;
@@ -955,20 +996,20 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
   // All config's primary times are in the past. We should make the most recent
   // and highest priority candidate primary.
   scoped_refptr<Config> new_primary(best_candidate);
-  if (primary_config_.get()) {
-    primary_config_->is_primary = false;
+  if (snapshot->primary_config.get()) {
+    snapshot->primary_config->is_primary = false;
   }
-  primary_config_ = new_primary;
+  snapshot->primary_config = new_primary;
   new_primary->is_primary = true;
   DVLOG(1) << "New primary config.  orbit: "
            << base::HexEncode(
-               reinterpret_cast<const char*>(primary_config_->orbit),
+               reinterpret_cast<const char*>(new_primary->orbit),
                kOrbitSize)
-           << " scid: " << base::HexEncode(primary_config_->id.data(),
-                                           primary_config_->id.size());
-  next_config_promotion_time_ = QuicWallTime::Zero();
+           << " scid: " << base::HexEncode(new_primary->id.data(),
+                                           new_primary->id.size());
+  snapshot->next_config_promotion_time = QuicWallTime::Zero();
   if (primary_config_changed_cb_.get() != nullptr) {
-    primary_config_changed_cb_->Run(primary_config_->id);
+    primary_config_changed_cb_->Run(new_primary->id);
   }
 }
 
@@ -1183,12 +1224,17 @@ bool QuicCryptoServerConfig::BuildServerConfigUpdateMessage(
     const QuicCryptoNegotiatedParameters& params,
     const CachedNetworkParameters* cached_network_params,
     CryptoHandshakeMessage* out) const {
-  base::AutoLock locked(configs_lock_);
+  scoped_refptr<ConfigSnapshot> snapshot;
+  {
+    base::AutoLock locked(configs_lock_);
+    snapshot = snapshot_;
+  }
+  const scoped_refptr<Config>& primary_config = snapshot->primary_config;
   out->set_tag(kSCUP);
-  out->SetStringPiece(kSCFG, primary_config_->serialized);
+  out->SetStringPiece(kSCFG, primary_config->serialized);
   out->SetStringPiece(
       kSourceAddressTokenTag,
-      NewSourceAddressToken(*primary_config_.get(),
+      NewSourceAddressToken(*primary_config.get(),
                             previous_source_address_tokens, client_ip, rand,
                             clock->WallNow(), cached_network_params));
 
@@ -1196,15 +1242,16 @@ bool QuicCryptoServerConfig::BuildServerConfigUpdateMessage(
   string signature;
   string cert_sct;
   if (!proof_source_->GetProof(
-          server_ip, params.sni, primary_config_->serialized,
+          server_ip, params.sni, primary_config->serialized,
           params.x509_ecdsa_supported, &certs, &signature, &cert_sct)) {
     DVLOG(1) << "Server: failed to get proof.";
     return false;
   }
 
-  const string compressed = CertCompressor::CompressChain(
-      *certs, params.client_common_set_hashes, params.client_cached_cert_hashes,
-      primary_config_->common_cert_sets);
+  const string compressed =
+      CompressCerts(*certs, params.client_common_set_hashes,
+                    params.client_cached_cert_hashes,
+                    primary_config->common_cert_sets);
 
   out->SetStringPiece(kCertificateTag, compressed);
   out->SetStringPiece(kPROF, signature);
@@ -1271,9 +1318,9 @@ void QuicCryptoServerConfig::BuildRejection(
     params->client_cached_cert_hashes = client_cached_cert_hashes.as_string();
   }
 
-  const string compressed = CertCompressor::CompressChain(
-      *crypto_proof.certs, params->client_common_set_hashes,
-      params->client_cached_cert_hashes, config.common_cert_sets);
+  const string compressed =
+      CompressCerts(*crypto_proof.certs, params->client_common_set_hashes,
+                    params->client_cached_cert_hashes, config.common_cert_sets);
 
   // kREJOverheadBytes is a very rough estimate of how much of a REJ
   // message is taken up by things other than the certificates.
@@ -1594,7 +1641,7 @@ string QuicCryptoServerConfig::NewSourceAddressToken(
 
 int QuicCryptoServerConfig::NumberOfConfigs() const {
   base::AutoLock locked(configs_lock_);
-  return configs_.size();
+  return snapshot_->configs.size();
 }
 
 HandshakeFailureReason QuicCryptoServerConfig::ParseSourceAddressToken(
@@ -1799,6 +1846,35 @@ void QuicCryptoServerConfig::ParseProofDemand(
   }
 }
 
+string QuicCryptoServerConfig::CompressCerts(
+    const vector<string>& certs,
+    const string& client_common_set_hashes,
+    const string& client_cached_cert_hashes,
+    const CommonCertSets* common_sets) const {
+  {
+    base::AutoLock locked(compressed_certs_cache_lock_);
+    const string* cached = compressed_certs_cache_.GetCompressedCert(
+        certs, client_common_set_hashes, client_cached_cert_hashes,
+        common_sets);
+    if (cached != nullptr) {
+      return *cached;
+    }
+  }
+
+  // The compression itself runs without the lock held: it can take on the
+  // order of a millisecond and concurrent handshakes shouldn't serialize
+  // behind it.
+  string compressed =
+      CertCompressor::CompressChain(certs, client_common_set_hashes,
+                                    client_cached_cert_hashes, common_sets);
+
+  base::AutoLock locked(compressed_certs_cache_lock_);
+  compressed_certs_cache_.Insert(certs, client_common_set_hashes,
+                                 client_cached_cert_hashes, common_sets,
+                                 compressed);
+  return compressed;
+}
+
 QuicCryptoServerConfig::Config::Config()
     : channel_id_enabled(false),
       is_primary(false),
@@ -1808,4 +1884,9 @@ QuicCryptoServerConfig::Config::Config()
 
 QuicCryptoServerConfig::Config::~Config() { STLDeleteElements(&key_exchanges); }
 
+QuicCryptoServerConfig::ConfigSnapshot::ConfigSnapshot()
+    : next_config_promotion_time(QuicWallTime::Zero()) {}
+
+QuicCryptoServerConfig::ConfigSnapshot::~ConfigSnapshot() {}
+
 }  // namespace net
@@ -20,6 +20,7 @@
 #include "net/quic/crypto/crypto_handshake_message.h"
 #include "net/quic/crypto/crypto_protocol.h"
 #include "net/quic/crypto/crypto_secret_boxer.h"
+#include "net/quic/crypto/quic_compressed_certs_cache.h"
 #include "net/quic/proto/cached_network_parameters.pb.h"
 #include "net/quic/proto/source_address_token.pb.h"
 #include "net/quic/quic_time.h"
@@ -425,18 +426,57 @@ class NET_EXPORT_PRIVATE QuicCryptoServerConfig {
 
   typedef std::map<ServerConfigID, scoped_refptr<Config> > ConfigMap;
 
-  // Get a ref to the config with a given server config id.
-  scoped_refptr<Config> GetConfigWithScid(
-      base::StringPiece requested_scid) const;
+  // ConfigSnapshot is an immutable view of the set of active configs and the
+  // primary config. Handshake threads copy a reference to the current
+  // snapshot and then work against it without further synchronization;
+  // config additions and primary rotations build a new snapshot and publish
+  // it, so a snapshot never changes once another thread can see it.
+  struct ConfigSnapshot : public base::RefCountedThreadSafe<ConfigSnapshot> {
+    ConfigSnapshot();
+
+    // All active server configs. It's expected that there are about
+    // half-a-dozen configs active at any one time.
+    ConfigMap configs;
+    // The config in |configs| that we'll give out to new clients, or nullptr
+    // if |configs| is empty.
+    scoped_refptr<Config> primary_config;
+    // The nearest, future time when an active config will be promoted to
+    // primary.
+    QuicWallTime next_config_promotion_time;
+
+   private:
+    friend class base::RefCountedThreadSafe<ConfigSnapshot>;
+
+    ~ConfigSnapshot();
+
+    DISALLOW_COPY_AND_ASSIGN(ConfigSnapshot);
+  };
+
+  // Returns the current snapshot, first rotating the primary config if a
+  // promotion has come due. Only the snapshot pointer copy happens under
+  // configs_lock_.
+  scoped_refptr<ConfigSnapshot> GetSnapshot(QuicWallTime now) const;
+
+  // Rebuilds and publishes the snapshot with a newly selected primary
+  // config, if a promotion is still due once configs_lock_ is held. Returns
+  // the published snapshot.
+  scoped_refptr<ConfigSnapshot> PromotePrimaryConfig(QuicWallTime now) const;
+
+  // Get a ref to the config in |snapshot| with a given server config id.
+  static scoped_refptr<Config> GetConfigWithScid(
+      const ConfigSnapshot& snapshot,
+      base::StringPiece requested_scid);
 
   // ConfigPrimaryTimeLessThan returns true if a->primary_time <
   // b->primary_time.
   static bool ConfigPrimaryTimeLessThan(const scoped_refptr<Config>& a,
                                         const scoped_refptr<Config>& b);
 
-  // SelectNewPrimaryConfig reevaluates the primary config based on the
-  // "primary_time" deadlines contained in each.
-  void SelectNewPrimaryConfig(QuicWallTime now) const;
+  // SelectNewPrimaryConfig reevaluates the primary config of |snapshot|
+  // based on the "primary_time" deadlines contained in each config. Called
+  // while building a new snapshot, before it is published.
+  void SelectNewPrimaryConfig(ConfigSnapshot* snapshot,
+                              QuicWallTime now) const;
 
   // EvaluateClientHello checks |client_hello| for gross errors and determines
   // whether it can be shown to be fresh (i.e. not a replay). The results are
@@ -543,6 +583,15 @@ class NET_EXPORT_PRIVATE QuicCryptoServerConfig {
                         bool* x509_supported,
                         bool* x509_ecdsa_supported) const;
 
+  // CompressCerts returns the compressed representation of |certs| for a
+  // client that presented |client_common_set_hashes| and
+  // |client_cached_cert_hashes|, serving it from compressed_certs_cache_
+  // when the same combination has been compressed before.
+  std::string CompressCerts(const std::vector<std::string>& certs,
+                            const std::string& client_common_set_hashes,
+                            const std::string& client_cached_cert_hashes,
+                            const CommonCertSets* common_sets) const;
+
   // replay_protection_ controls whether the server enforces that handshakes
   // aren't replays.
   bool replay_protection_;
@@ -552,23 +601,25 @@ class NET_EXPORT_PRIVATE QuicCryptoServerConfig {
   // used to protect QUIC from amplification attacks.
   size_t chlo_multiplier_;
 
-  // configs_ satisfies the following invariants:
-  //   1) configs_.empty() <-> primary_config_ == nullptr
-  //   2) primary_config_ != nullptr -> primary_config_->is_primary
-  //   3) ∀ c∈configs_, c->is_primary <-> c == primary_config_
+  // configs_lock_ serializes writers of |snapshot_|; readers only hold it
+  // long enough to copy the snapshot pointer, so handshakes never contend on
+  // it for the duration of a config lookup.
   mutable base::Lock configs_lock_;
-  // configs_ contains all active server configs. It's expected that there are
-  // about half-a-dozen configs active at any one time.
-  ConfigMap configs_;
-  // primary_config_ points to a Config (which is also in |configs_|) which is
-  // the primary config - i.e. the one that we'll give out to new clients.
-  mutable scoped_refptr<Config> primary_config_;
-  // next_config_promotion_time_ contains the nearest, future time when an
-  // active config will be promoted to primary.
-  mutable QuicWallTime next_config_promotion_time_;
+  // snapshot_ is never nullptr and satisfies the following invariants:
+  //   1) snapshot_->configs.empty() <-> snapshot_->primary_config == nullptr
+  //   2) primary_config != nullptr -> primary_config->is_primary
+  //   3) ∀ c∈configs, c->is_primary <-> c == primary_config
+  mutable scoped_refptr<ConfigSnapshot> snapshot_;
   // Callback to invoke when the primary config changes.
   scoped_ptr<PrimaryConfigChangedCallback> primary_config_changed_cb_;
 
+  // compressed_certs_cache_ caches the compressed representations of
+  // certificate chains so that each unique (chain, client hints)
+  // combination only pays for the zlib deflate once. Guarded by
+  // compressed_certs_cache_lock_.
+  mutable base::Lock compressed_certs_cache_lock_;
+  mutable QuicCompressedCertsCache compressed_certs_cache_;
+
   // Protects access to the pointer held by strike_register_client_.
   mutable base::Lock strike_register_client_lock_;
   // strike_register_ contains a data structure that keeps track of previously
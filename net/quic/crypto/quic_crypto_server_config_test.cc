@@ -39,9 +39,10 @@ class QuicCryptoServerConfigPeer {
     base::AutoLock locked(server_config_->configs_lock_);
     if (config_id == "<primary>") {
       return scoped_refptr<QuicCryptoServerConfig::Config>(
-          server_config_->primary_config_);
+          server_config_->snapshot_->primary_config);
     } else {
-      return server_config_->GetConfigWithScid(config_id);
+      return QuicCryptoServerConfig::GetConfigWithScid(
+          *server_config_->snapshot_, config_id);
     }
   }
 
@@ -129,12 +130,12 @@ class QuicCryptoServerConfigPeer {
 
     base::AutoLock locked(server_config_->configs_lock_);
 
-    ASSERT_EQ(expected.size(), server_config_->configs_.size())
+    ASSERT_EQ(expected.size(), server_config_->snapshot_->configs.size())
         << ConfigsDebug();
 
     for (const pair<const ServerConfigID,
                     scoped_refptr<QuicCryptoServerConfig::Config>>& i :
-         server_config_->configs_) {
+         server_config_->snapshot_->configs) {
       bool found = false;
       for (pair<ServerConfigID, bool>& j : expected) {
         if (i.first == j.first && i.second->is_primary == j.second) {
@@ -154,13 +155,13 @@ class QuicCryptoServerConfigPeer {
   // ConfigsDebug() should be called after acquiring
   // server_config_->configs_lock_.
   string ConfigsDebug() {
-    if (server_config_->configs_.empty()) {
+    if (server_config_->snapshot_->configs.empty()) {
       return "No Configs in QuicCryptoServerConfig";
     }
 
     string s;
 
-    for (const auto& i : server_config_->configs_) {
+    for (const auto& i : server_config_->snapshot_->configs) {
       const scoped_refptr<QuicCryptoServerConfig::Config> config = i.second;
       if (config->is_primary) {
         s += "(primary) ";
@@ -176,8 +177,13 @@ class QuicCryptoServerConfigPeer {
 
   void SelectNewPrimaryConfig(int seconds) {
     base::AutoLock locked(server_config_->configs_lock_);
+    scoped_refptr<QuicCryptoServerConfig::ConfigSnapshot> new_snapshot(
+        new QuicCryptoServerConfig::ConfigSnapshot);
+    new_snapshot->configs = server_config_->snapshot_->configs;
+    new_snapshot->primary_config = server_config_->snapshot_->primary_config;
     server_config_->SelectNewPrimaryConfig(
-        QuicWallTime::FromUNIXSeconds(seconds));
+        new_snapshot.get(), QuicWallTime::FromUNIXSeconds(seconds));
+    server_config_->snapshot_ = new_snapshot;
   }
 
  private:
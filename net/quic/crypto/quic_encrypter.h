@@ -43,6 +43,8 @@ class NET_EXPORT_PRIVATE QuicEncrypter {
   // |plaintext| as well as a MAC over both |plaintext| and |associated_data|,
   // or nullptr if there is an error. |packet_number| is appended to the
   // |nonce_prefix| value provided in SetNoncePrefix() to form the nonce.
+  // |output| may point to the same memory as |plaintext|, in which case the
+  // packet is encrypted in place; any other overlap is not supported.
   virtual bool EncryptPacket(QuicPacketNumber packet_number,
                              base::StringPiece associated_data,
                              base::StringPiece plaintext,
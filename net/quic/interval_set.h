@@ -18,6 +18,12 @@
 // otherwise modified in order to maintain this invariant. The intervals are
 // maintained in sorted order, by ascending min() value.
 //
+// The intervals are stored in a flat sorted vector with inline storage for
+// the first few entries, so the common case of a small set (e.g. the ack
+// ranges of a connection with little reordering) performs no heap
+// allocation at all, and mutations do not churn per-node allocations the
+// way a tree-based set would.
+//
 // The reader is cautioned to beware of the terminology used here: this library
 // uses the terms "min" and "max" rather than "begin" and "end" as is
 // conventional for the STL. The terminology [min, max) refers to the half-open
@@ -29,7 +35,8 @@
 // comparison operators (<, <=, ==, !=, >=, >). These requirements are inherited
 // from Interval<T>.
 //
-// IntervalSet has constant-time move operations.
+// Swapping two IntervalSets is constant time once both have spilled to the
+// heap, and linear in the (small) inline capacity otherwise.
 //
 // This class is thread-compatible if T is thread-compatible. (See
 // go/thread-compatible).
@@ -54,7 +61,7 @@
 
 #include <stddef.h>
 #include <algorithm>
-#include <set>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -64,13 +71,133 @@
 
 namespace net {
 
+// A vector of Interval<T> with inline storage for the first
+// kInlineCapacity entries. Provides only the operations IntervalSet
+// needs. Iterators are raw pointers, so the standard algorithms apply
+// directly, and iteration touches contiguous memory.
+template <typename T>
+class IntervalVector {
+ public:
+  typedef Interval<T> value_type;
+  typedef Interval<T>* iterator;
+  typedef const Interval<T>* const_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  // Eight ranges cover ack frames in all but heavily reordered
+  // connections.
+  static const size_t kInlineCapacity = 8;
+
+  IntervalVector() : data_(inline_), size_(0), capacity_(kInlineCapacity) {}
+
+  IntervalVector(const IntervalVector& other)
+      : data_(inline_), size_(0), capacity_(kInlineCapacity) {
+    *this = other;
+  }
+
+  ~IntervalVector() {
+    if (!IsInline()) {
+      delete[] data_;
+    }
+  }
+
+  IntervalVector& operator=(const IntervalVector& other) {
+    if (this == &other) {
+      return *this;
+    }
+    size_ = 0;
+    reserve(other.size_);
+    std::copy(other.data_, other.data_ + other.size_, data_);
+    size_ = other.size_;
+    return *this;
+  }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  Interval<T>& back() { return data_[size_ - 1]; }
+  const Interval<T>& back() const { return data_[size_ - 1]; }
+
+  void clear() { size_ = 0; }
+
+  // Grows the backing store so that at least |capacity| entries fit.
+  void reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+      return;
+    }
+    size_t new_capacity = std::max(capacity, 2 * capacity_);
+    Interval<T>* new_data = new Interval<T>[new_capacity];
+    std::copy(data_, data_ + size_, new_data);
+    if (!IsInline()) {
+      delete[] data_;
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  void push_back(const Interval<T>& interval) {
+    reserve(size_ + 1);
+    data_[size_++] = interval;
+  }
+
+  // Inserts |interval| before |position| and returns an iterator to the
+  // inserted entry.
+  iterator insert(iterator position, const Interval<T>& interval) {
+    const size_t index = position - data_;
+    reserve(size_ + 1);
+    std::copy_backward(data_ + index, data_ + size_, data_ + size_ + 1);
+    data_[index] = interval;
+    ++size_;
+    return data_ + index;
+  }
+
+  // Erases the entries in [first, last).
+  iterator erase(iterator first, iterator last) {
+    std::copy(last, data_ + size_, first);
+    size_ -= last - first;
+    return first;
+  }
+
+  void swap(IntervalVector* other) {
+    if (!IsInline() && !other->IsInline()) {
+      std::swap(data_, other->data_);
+      std::swap(size_, other->size_);
+      std::swap(capacity_, other->capacity_);
+      return;
+    }
+    // At least one side still lives in its inline storage; swap through a
+    // copy so that neither ends up pointing into the other's inline array.
+    IntervalVector tmp(*this);
+    *this = *other;
+    *other = tmp;
+  }
+
+ private:
+  bool IsInline() const { return data_ == inline_; }
+
+  Interval<T> inline_[kInlineCapacity];
+  // Points at inline_ until the vector grows past kInlineCapacity.
+  Interval<T>* data_;
+  size_t size_;
+  size_t capacity_;
+};
+
 template <typename T>
 class IntervalSet {
  private:
   struct IntervalComparator {
     bool operator()(const Interval<T>& a, const Interval<T>& b) const;
   };
-  typedef std::set<Interval<T>, IntervalComparator> Set;
+  typedef IntervalVector<T> Set;
 
  public:
   typedef typename Set::value_type value_type;
@@ -272,58 +399,24 @@ class IntervalSet {
   }
 #endif
 
-  // Swap this IntervalSet with *other. This is a constant-time operation.
-  void Swap(IntervalSet<T>* other) { intervals_.swap(other->intervals_); }
+  // Swap this IntervalSet with *other. Constant time once both sets have
+  // spilled to the heap; linear in the inline capacity otherwise.
+  void Swap(IntervalSet<T>* other) { intervals_.swap(&other->intervals_); }
 
  private:
-  // Removes overlapping ranges and coalesces adjacent intervals as needed.
-  void Compact(const typename Set::iterator& begin,
-               const typename Set::iterator& end);
-
   // Returns true if this set is valid (i.e. all intervals in it are non-empty,
   // non-adjacent, and mutually disjoint). Currently this is used as an
   // integrity check by the Intersection() and Difference() methods, but is only
   // invoked for debug builds (via DCHECK).
   bool Valid() const;
 
-  // Finds the first interval that potentially intersects 'other'.
-  const_iterator FindIntersectionCandidate(const IntervalSet& other) const;
-
-  // Finds the first interval that potentially intersects 'interval'.
-  const_iterator FindIntersectionCandidate(const Interval<T>& interval) const;
-
-  // Helper for Intersection() and Difference(): Finds the next pair of
-  // intervals from 'x' and 'y' that intersect. 'mine' is an iterator
-  // over x->intervals_. 'theirs' is an iterator over y.intervals_. 'mine'
-  // and 'theirs' are advanced until an intersecting pair is found.
-  // Non-intersecting intervals (aka "holes") from x->intervals_ can be
-  // optionally erased by "on_hole".
-  template <typename X, typename Func>
-  static bool FindNextIntersectingPairImpl(X* x,
-                                           const IntervalSet& y,
-                                           const_iterator* mine,
-                                           const_iterator* theirs,
-                                           Func on_hole);
-
-  // The variant of the above method that doesn't mutate this IntervalSet.
-  bool FindNextIntersectingPair(const IntervalSet& other,
-                                const_iterator* mine,
-                                const_iterator* theirs) const {
-    return FindNextIntersectingPairImpl(
-        this, other, mine, theirs,
-        [](const IntervalSet*, const_iterator, const_iterator) {});
-  }
-
-  // The variant of the above method that mutates this IntervalSet by erasing
-  // holes.
-  bool FindNextIntersectingPairAndEraseHoles(const IntervalSet& other,
-                                             const_iterator* mine,
-                                             const_iterator* theirs) {
-    return FindNextIntersectingPairImpl(
-        this, other, mine, theirs,
-        [](IntervalSet* x, const_iterator from, const_iterator to) {
-          x->intervals_.erase(from, to);
-        });
+  // Returns an iterator to the first interval whose min() is greater than
+  // the probe, under the ascending-min()/descending-max() ordering
+  // described at IntervalComparator. Analogous to std::set::upper_bound on
+  // the former tree-based representation.
+  const_iterator UpperBound(const Interval<T>& probe) const {
+    return std::upper_bound(intervals_.begin(), intervals_.end(), probe,
+                            IntervalComparator());
   }
 
   // The representation for the intervals. The intervals in this set are
@@ -355,23 +448,42 @@ template <typename T>
 void IntervalSet<T>::Add(const Interval<T>& interval) {
   if (interval.Empty())
     return;
-  std::pair<typename Set::iterator, bool> ins = intervals_.insert(interval);
-  if (!ins.second) {
-    // This interval already exists.
+  // Fast path: ack ranges usually grow upward, so the new interval most
+  // often lands at or beyond the back of the vector.
+  if (intervals_.empty() || interval.min() > intervals_.back().max()) {
+    intervals_.push_back(interval);
+    return;
+  }
+  if (interval.min() >= intervals_.back().min()) {
+    // Extends (or lands inside) the last interval.
+    if (interval.max() > intervals_.back().max()) {
+      intervals_.back().SetMax(interval.max());
+    }
+    return;
+  }
+  // General case: find the first interval that the new one can touch
+  // (overlap or be adjacent to), i.e. the first with max() >= min().
+  typename Set::iterator it =
+      std::lower_bound(intervals_.begin(), intervals_.end(), interval.min(),
+                       [](const Interval<T>& i, const T& min) {
+                         return i.max() < min;
+                       });
+  if (it == intervals_.end() || interval.max() < it->min()) {
+    // Disjoint from (and not adjacent to) every existing interval.
+    intervals_.insert(it, interval);
     return;
   }
-  // Determine the minimal range that will have to be compacted.  We know that
-  // the IntervalSet was valid before the addition of the interval, so only
-  // need to start with the interval itself (although Compact takes an open
-  // range so begin needs to be the interval to the left).  We don't know how
-  // many ranges this interval may cover, so we need to find the appropriate
-  // interval to end with on the right.
-  typename Set::iterator begin = ins.first;
-  if (begin != intervals_.begin())
-    --begin;
-  const Interval<T> target_end(interval.max(), interval.max());
-  const typename Set::iterator end = intervals_.upper_bound(target_end);
-  Compact(begin, end);
+  // Merge with the run of intervals [it, last) that the new interval
+  // touches, then collapse the run into a single entry.
+  T new_min = std::min(it->min(), interval.min());
+  T new_max = interval.max();
+  typename Set::iterator last = it;
+  while (last != intervals_.end() && last->min() <= interval.max()) {
+    new_max = std::max(new_max, last->max());
+    ++last;
+  }
+  it->Set(new_min, new_max);
+  intervals_.erase(it + 1, last);
 }
 
 template <typename T>
@@ -385,8 +497,7 @@ template <typename T>
 bool IntervalSet<T>::Equals(const IntervalSet& other) const {
   if (intervals_.size() != other.intervals_.size())
     return false;
-  for (typename Set::iterator i = intervals_.begin(),
-                              j = other.intervals_.begin();
+  for (const_iterator i = intervals_.begin(), j = other.intervals_.begin();
        i != intervals_.end(); ++i, ++j) {
     // Simple member-wise equality, since all intervals are non-empty.
     if (i->min() != j->min() || i->max() != j->max())
@@ -399,7 +510,7 @@ template <typename T>
 bool IntervalSet<T>::Contains(const T& value) const {
   Interval<T> tmp(value, value);
   // Find the first interval with min() > value, then move back one step
-  const_iterator it = intervals_.upper_bound(tmp);
+  const_iterator it = UpperBound(tmp);
   if (it == intervals_.begin())
     return false;
   --it;
@@ -409,7 +520,7 @@ bool IntervalSet<T>::Contains(const T& value) const {
 template <typename T>
 bool IntervalSet<T>::Contains(const Interval<T>& interval) const {
   // Find the first interval with min() > value, then move back one step.
-  const_iterator it = intervals_.upper_bound(interval);
+  const_iterator it = UpperBound(interval);
   if (it == intervals_.begin())
     return false;
   --it;
@@ -438,13 +549,13 @@ bool IntervalSet<T>::Contains(const IntervalSet<T>& other) const {
 // min() having min() <= value.
 //
 // Determining the candidate interval takes a couple of steps. First, since the
-// underlying std::set stores intervals, not values, we need to create a "probe
-// interval" suitable for use as a search key. The probe interval used is
+// vector stores intervals, not values, we need to create a "probe interval"
+// suitable for use as a search key. The probe interval used is
 // [value, value). Now we can restate the problem as finding the largest
 // interval in the IntervalSet that is <= the probe interval.
 //
-// This restatement only works if the set's comparator behaves in a certain way.
-// In particular it needs to order first by ascending min(), and then by
+// This restatement only works if the ordering behaves in a certain way. In
+// particular it needs to order first by ascending min(), and then by
 // descending max(). The comparator used by this library is defined in exactly
 // this way. To see why descending max() is required, consider the following
 // example. Assume an IntervalSet containing these intervals:
@@ -471,20 +582,19 @@ bool IntervalSet<T>::Contains(const IntervalSet<T>& other) const {
 // is larger than any non-empty interval with the same min(). The comparator
 // used by this library is careful to induce this ordering.
 //
-// Another detail involves the choice of which std::set method to use to try to
-// find the candidate interval. The most appropriate entry point is
-// set::upper_bound(), which finds the smallest interval which is > the probe
-// interval. The semantics of upper_bound() are slightly different from what we
-// want (namely, to find the largest interval which is <= the probe interval)
-// but they are close enough; the interval found by upper_bound() will always be
-// one step past the interval we are looking for (if it exists) or at begin()
-// (if it does not). Getting to the proper interval is a simple matter of
-// decrementing the iterator.
+// Another detail involves the choice of search primitive. The most appropriate
+// entry point is UpperBound(), which finds the smallest interval which is >
+// the probe interval. The semantics of UpperBound() are slightly different
+// from what we want (namely, to find the largest interval which is <= the
+// probe interval) but they are close enough; the interval found by
+// UpperBound() will always be one step past the interval we are looking for
+// (if it exists) or at begin() (if it does not). Getting to the proper
+// interval is a simple matter of decrementing the iterator.
 template <typename T>
 typename IntervalSet<T>::const_iterator IntervalSet<T>::Find(
     const T& value) const {
   Interval<T> tmp(value, value);
-  const_iterator it = intervals_.upper_bound(tmp);
+  const_iterator it = UpperBound(tmp);
   if (it == intervals_.begin())
     return intervals_.end();
   --it;
@@ -498,50 +608,13 @@ typename IntervalSet<T>::const_iterator IntervalSet<T>::Find(
 // an interval exists in the IntervalSet. The way this is done is to locate the
 // "candidate interval", the only interval that could *possibly* contain
 // "probe", and test it using Contains(). The candidate interval is the largest
-// interval that is <= the probe interval.
-//
-// The search for the candidate interval only works if the comparator used
-// behaves in a certain way. In particular it needs to order first by ascending
-// min(), and then by descending max(). The comparator used by this library is
-// defined in exactly this way. To see why descending max() is required,
-// consider the following example. Assume an IntervalSet containing these
-// intervals:
-//
-//   [0, 5)  [10, 20)  [50, 60)
-//
-// Consider searching for the probe [15, 17). [10, 20) is the largest interval
-// in the set which is <= the probe interval. This is the correct interval
-// needed for the Contains() test, which will then return true, because [10, 20)
-// contains [15, 17).
-//
-// Now consider searching for the probe [30, 32). Again [10, 20] is the largest
-// interval <= the probe interval. This is again the correct interval needed for
-// the Contains() test, which in this case returns false, because [10, 20) does
-// not contain [30, 32).
-//
-// Finally, consider searching for the probe [10, 12). Here the ordering
-// relationship between [10, 12) and [10, 20) becomes vitally important. If
-// [10, 12) were to come before [10, 20), then [0, 5) would be the largest
-// interval <= the probe, leading to the wrong choice of interval for the
-// Contains() test. Therefore [10, 12) needs to come after [10, 20). The
-// simplest way to make this work in the general case is to order by ascending
-// min() but descending max(). In this ordering, given two intervals with the
-// same min(), the wider one goes before the narrower one. The comparator used
-// by this library is careful to induce this ordering.
-//
-// Another detail involves the choice of which std::set method to use to try to
-// find the candidate interval. The most appropriate entry point is
-// set::upper_bound(), which finds the smallest interval which is > the probe
-// interval. The semantics of upper_bound() are slightly different from what we
-// want (namely, to find the largest interval which is <= the probe interval)
-// but they are close enough; the interval found by upper_bound() will always be
-// one step past the interval we are looking for (if it exists) or at begin()
-// (if it does not). Getting to the proper interval is a simple matter of
-// decrementing the iterator.
+// interval that is <= the probe interval, under the ascending-min(),
+// descending-max() ordering described in the comment on Find(value) above,
+// which is found by taking one step back from UpperBound().
 template <typename T>
 typename IntervalSet<T>::const_iterator IntervalSet<T>::Find(
     const Interval<T>& probe) const {
-  const_iterator it = intervals_.upper_bound(probe);
+  const_iterator it = UpperBound(probe);
   if (it == intervals_.begin())
     return intervals_.end();
   --it;
@@ -555,7 +628,7 @@ template <typename T>
 bool IntervalSet<T>::IsDisjoint(const Interval<T>& interval) const {
   Interval<T> tmp(interval.min(), interval.min());
   // Find the first interval with min() > interval.min()
-  const_iterator it = intervals_.upper_bound(tmp);
+  const_iterator it = UpperBound(tmp);
   if (it != intervals_.end() && interval.max() > it->min())
     return false;
   if (it == intervals_.begin())
@@ -566,67 +639,32 @@ bool IntervalSet<T>::IsDisjoint(const Interval<T>& interval) const {
 
 template <typename T>
 void IntervalSet<T>::Union(const IntervalSet& other) {
-  intervals_.insert(other.begin(), other.end());
-  Compact(intervals_.begin(), intervals_.end());
-}
-
-template <typename T>
-typename IntervalSet<T>::const_iterator
-IntervalSet<T>::FindIntersectionCandidate(const IntervalSet& other) const {
-  return FindIntersectionCandidate(*other.intervals_.begin());
-}
-
-template <typename T>
-typename IntervalSet<T>::const_iterator
-IntervalSet<T>::FindIntersectionCandidate(const Interval<T>& interval) const {
-  // Use upper_bound to efficiently find the first interval in intervals_
-  // where min() is greater than interval.min().  If the result
-  // isn't the beginning of intervals_ then move backwards one interval since
-  // the interval before it is the first candidate where max() may be
-  // greater than interval.min().
-  // In other words, no interval before that can possibly intersect with any
-  // of other.intervals_.
-  const_iterator mine = intervals_.upper_bound(interval);
-  if (mine != intervals_.begin()) {
-    --mine;
-  }
-  return mine;
-}
-
-template <typename T>
-template <typename X, typename Func>
-bool IntervalSet<T>::FindNextIntersectingPairImpl(X* x,
-                                                  const IntervalSet& y,
-                                                  const_iterator* mine,
-                                                  const_iterator* theirs,
-                                                  Func on_hole) {
-  CHECK(x != nullptr);
-  if ((*mine == x->intervals_.end()) || (*theirs == y.intervals_.end())) {
-    return false;
+  if (other.Empty()) {
+    return;
   }
-  while (!(**mine).Intersects(**theirs)) {
-    const_iterator erase_first = *mine;
-    // Skip over intervals in 'mine' that don't reach 'theirs'.
-    while (*mine != x->intervals_.end() && (**mine).max() <= (**theirs).min()) {
-      ++(*mine);
-    }
-    on_hole(x, erase_first, *mine);
-    // We're done if the end of intervals_ is reached.
-    if (*mine == x->intervals_.end()) {
-      return false;
-    }
-    // Skip over intervals 'theirs' that don't reach 'mine'.
-    while (*theirs != y.intervals_.end() &&
-           (**theirs).max() <= (**mine).min()) {
-      ++(*theirs);
-    }
-    // If the end of other.intervals_ is reached, we're done.
-    if (*theirs == y.intervals_.end()) {
-      on_hole(x, *mine, x->intervals_.end());
-      return false;
+  if (Empty()) {
+    intervals_ = other.intervals_;
+    return;
+  }
+  // Merge the two sorted vectors into a fresh compacted vector.
+  Set merged;
+  merged.reserve(intervals_.size() + other.intervals_.size());
+  const_iterator mine = begin();
+  const_iterator theirs = other.begin();
+  while (mine != end() || theirs != other.end()) {
+    const Interval<T>& next =
+        (theirs == other.end() ||
+         (mine != end() && mine->min() <= theirs->min()))
+            ? *mine++
+            : *theirs++;
+    if (merged.empty() || next.min() > merged.back().max()) {
+      merged.push_back(next);
+    } else if (next.max() > merged.back().max()) {
+      merged.back().SetMax(next.max());
     }
   }
-  return true;
+  intervals_.swap(&merged);
+  DCHECK(Valid());
 }
 
 template <typename T>
@@ -635,35 +673,25 @@ void IntervalSet<T>::Intersection(const IntervalSet& other) {
     intervals_.clear();
     return;
   }
-
-  const_iterator mine = FindIntersectionCandidate(other);
-  // Remove any intervals that cannot possibly intersect with other.intervals_.
-  intervals_.erase(intervals_.begin(), mine);
-  const_iterator theirs = other.FindIntersectionCandidate(*this);
-
-  while (FindNextIntersectingPairAndEraseHoles(other, &mine, &theirs)) {
-    // OK, *mine and *theirs intersect.  Now, we find the largest
-    // span of intervals in other (starting at theirs) - say [a..b]
-    // - that intersect *mine, and we replace *mine with (*mine
-    // intersect x) for all x in [a..b] Note that subsequent
-    // intervals in this can't intersect any intervals in [a..b) --
-    // they may only intersect b or subsequent intervals in other.
-    Interval<T> i(*mine);
-    intervals_.erase(mine);
-    mine = intervals_.end();
+  // Walk both sorted vectors in lockstep, keeping every pairwise
+  // intersection.
+  Set result;
+  const_iterator mine = begin();
+  const_iterator theirs = other.begin();
+  while (mine != end() && theirs != other.end()) {
     Interval<T> intersection;
-    while (theirs != other.intervals_.end() &&
-           i.Intersects(*theirs, &intersection)) {
-      std::pair<typename Set::iterator, bool> ins =
-          intervals_.insert(intersection);
-      DCHECK(ins.second);
-      mine = ins.first;
+    if (mine->Intersects(*theirs, &intersection)) {
+      result.push_back(intersection);
+    }
+    // Advance whichever interval ends first; the other may still intersect
+    // the next interval on the opposite side.
+    if (mine->max() < theirs->max()) {
+      ++mine;
+    } else {
       ++theirs;
     }
-    DCHECK(mine != intervals_.end());
-    --theirs;
-    ++mine;
   }
+  intervals_.swap(&result);
   DCHECK(Valid());
 }
 
@@ -672,14 +700,19 @@ bool IntervalSet<T>::Intersects(const IntervalSet& other) const {
   if (!SpanningInterval().Intersects(other.SpanningInterval())) {
     return false;
   }
-
-  const_iterator mine = FindIntersectionCandidate(other);
-  if (mine == intervals_.end()) {
-    return false;
+  const_iterator mine = begin();
+  const_iterator theirs = other.begin();
+  while (mine != end() && theirs != other.end()) {
+    if (mine->Intersects(*theirs)) {
+      return true;
+    }
+    if (mine->max() < theirs->max()) {
+      ++mine;
+    } else {
+      ++theirs;
+    }
   }
-  const_iterator theirs = other.FindIntersectionCandidate(*mine);
-
-  return FindNextIntersectingPair(other, &mine, &theirs);
+  return false;
 }
 
 template <typename T>
@@ -700,37 +733,39 @@ void IntervalSet<T>::Difference(const IntervalSet& other) {
   if (!SpanningInterval().Intersects(other.SpanningInterval())) {
     return;
   }
-
-  const_iterator mine = FindIntersectionCandidate(other);
-  // If no interval in mine reaches the first interval of theirs then we're
-  // done.
-  if (mine == intervals_.end()) {
-    return;
-  }
-  const_iterator theirs = other.FindIntersectionCandidate(*this);
-
-  while (FindNextIntersectingPair(other, &mine, &theirs)) {
-    // At this point *mine and *theirs overlap.  Remove mine from
-    // intervals_ and replace it with the possibly two intervals that are
-    // the difference between mine and theirs.
-    Interval<T> i(*mine);
-    intervals_.erase(mine++);
-    Interval<T> lo;
-    Interval<T> hi;
-    i.Difference(*theirs, &lo, &hi);
-
-    if (!lo.Empty()) {
-      // We have a low end.  This can't intersect anything else.
-      std::pair<typename Set::iterator, bool> ins = intervals_.insert(lo);
-      DCHECK(ins.second);
+  Set result;
+  result.reserve(intervals_.size() + other.intervals_.size());
+  const_iterator theirs = other.begin();
+  for (const_iterator mine = begin(); mine != end(); ++mine) {
+    Interval<T> remaining = *mine;
+    // Discard intervals of "other" that end at or before this one; they
+    // cannot touch this or any later interval.
+    while (theirs != other.end() && theirs->max() <= remaining.min()) {
+      ++theirs;
     }
-
-    if (!hi.Empty()) {
-      std::pair<typename Set::iterator, bool> ins = intervals_.insert(hi);
-      DCHECK(ins.second);
-      mine = ins.first;
+    // Carve out every overlapping interval of "other". An interval of
+    // "other" may span several of ours, so |theirs| itself is not advanced
+    // here.
+    const_iterator cut = theirs;
+    while (cut != other.end() && cut->min() < remaining.max()) {
+      Interval<T> lo;
+      Interval<T> hi;
+      remaining.Difference(*cut, &lo, &hi);
+      if (!lo.Empty()) {
+        result.push_back(lo);
+      }
+      if (hi.Empty()) {
+        remaining = Interval<T>();
+        break;
+      }
+      remaining = hi;
+      ++cut;
+    }
+    if (!remaining.Empty()) {
+      result.push_back(remaining);
     }
   }
+  intervals_.swap(&result);
   DCHECK(Valid());
 }
 
@@ -738,7 +773,7 @@ template <typename T>
 void IntervalSet<T>::Complement(const T& min, const T& max) {
   IntervalSet<T> span(min, max);
   span.Difference(*this);
-  intervals_.swap(span.intervals_);
+  intervals_.swap(&span.intervals_);
 }
 
 template <typename T>
@@ -748,49 +783,6 @@ std::string IntervalSet<T>::ToString() const {
   return os.str();
 }
 
-// This method compacts the IntervalSet, merging pairs of overlapping intervals
-// into a single interval. In the steady state, the IntervalSet does not contain
-// any such pairs. However, the way the Union() and Add() methods work is to
-// temporarily put the IntervalSet into such a state and then to call Compact()
-// to "fix it up" so that it is no longer in that state.
-//
-// Compact() needs the interval set to allow two intervals [a,b) and [a,c)
-// (having the same min() but different max()) to briefly coexist in the set at
-// the same time, and be adjacent to each other, so that they can be efficiently
-// located and merged into a single interval. This state would be impossible
-// with a comparator which only looked at min(), as such a comparator would
-// consider such pairs equal. Fortunately, the comparator used by IntervalSet
-// does exactly what is needed, ordering first by ascending min(), then by
-// descending max().
-template <typename T>
-void IntervalSet<T>::Compact(const typename Set::iterator& begin,
-                             const typename Set::iterator& end) {
-  if (begin == end)
-    return;
-  typename Set::iterator next = begin;
-  typename Set::iterator prev = begin;
-  typename Set::iterator it = begin;
-  ++it;
-  ++next;
-  while (it != end) {
-    ++next;
-    if (prev->max() >= it->min()) {
-      // Overlapping / coalesced range; merge the two intervals.
-      T min = prev->min();
-      T max = std::max(prev->max(), it->max());
-      Interval<T> i(min, max);
-      intervals_.erase(prev);
-      intervals_.erase(it);
-      std::pair<typename Set::iterator, bool> ins = intervals_.insert(i);
-      DCHECK(ins.second);
-      prev = ins.first;
-    } else {
-      prev = it;
-    }
-    it = next;
-  }
-}
-
 template <typename T>
 bool IntervalSet<T>::Valid() const {
   const_iterator prev = end();
@@ -827,7 +819,7 @@ void swap(IntervalSet<T>& x, IntervalSet<T>& y) {
 // maintainers of this library.
 //
 // The reason for this ordering is that this comparator has to serve two
-// masters. First, it has to maintain the intervals in its internal set in the
+// masters. First, it has to maintain the intervals in the vector in the
 // order that clients expect to see them. Clients see these intervals via the
 // iterators provided by begin()/end() or as a result of invoking Get(). For
 // this reason, the comparator orders intervals by ascending min().
@@ -843,7 +835,7 @@ void swap(IntervalSet<T>& x, IntervalSet<T>& y) {
 // peculiar internal implementation. These needs require the comparator to order
 // first by ascending min() and then by descending max(). The best way to
 // understand why this is so is to check out the comments associated with the
-// Find() and Compact() methods.
+// Find() methods.
 template <typename T>
 inline bool IntervalSet<T>::IntervalComparator::operator()(
     const Interval<T>& a,
@@ -878,6 +878,34 @@ TEST_F(IntervalSetTest, Swap) {
   EXPECT_TRUE(Check(b, 2, 100, 200, 500, 600));
 }
 
+TEST_F(IntervalSetTest, GrowsPastInlineStorage) {
+  // Cross the inline-storage boundary of the backing vector and make sure
+  // ordering, coalescing and lookup still hold.
+  IntervalSet<int> set;
+  const int kRanges = 3 * IntervalVector<int>::kInlineCapacity;
+  for (int i = kRanges - 1; i >= 0; --i) {
+    set.Add(10 * i, 10 * i + 5);
+  }
+  EXPECT_EQ(static_cast<size_t>(kRanges), set.Size());
+  for (int i = 0; i < kRanges; ++i) {
+    EXPECT_TRUE(set.Contains(10 * i));
+    EXPECT_FALSE(set.Contains(10 * i + 5));
+  }
+
+  // Swapping an inline set with a spilled one preserves both.
+  IntervalSet<int> small;
+  small.Add(1000, 1005);
+  small.Swap(&set);
+  EXPECT_TRUE(Check(set, 1, 1000, 1005));
+  EXPECT_EQ(static_cast<size_t>(kRanges), small.Size());
+  EXPECT_TRUE(small.Contains(0));
+  EXPECT_TRUE(small.Contains(10 * (kRanges - 1)));
+
+  // Coalesce everything into a single interval.
+  small.Add(0, 10 * kRanges);
+  EXPECT_TRUE(Check(small, 1, 0, 10 * kRanges));
+}
+
 // TODO(rtenneti): Enabled these tests.
 #if 0
 static void BM_Difference(int iters) {
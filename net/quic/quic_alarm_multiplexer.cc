@@ -0,0 +1,123 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_alarm_multiplexer.h"
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/task_runner.h"
+#include "base/time/time.h"
+#include "net/quic/quic_clock.h"
+
+namespace net {
+
+// An alarm whose scheduling is delegated to the shared multiplexer.
+// Setting and cancelling just move the alarm in the multiplexer's deadline
+// map; the multiplexer decides when a delayed task actually gets posted.
+class QuicAlarmMultiplexer::MultiplexedAlarm : public QuicAlarm {
+ public:
+  MultiplexedAlarm(QuicAlarmMultiplexer* multiplexer,
+                   QuicAlarm::Delegate* delegate)
+      : QuicAlarm(delegate), multiplexer_(multiplexer), scheduled_(false) {}
+
+  ~MultiplexedAlarm() override {
+    if (scheduled_) {
+      multiplexer_->Unschedule(this);
+    }
+  }
+
+ protected:
+  void SetImpl() override {
+    DCHECK(deadline().IsInitialized());
+    multiplexer_->Schedule(this);
+  }
+
+  void CancelImpl() override {
+    DCHECK(!deadline().IsInitialized());
+    if (scheduled_) {
+      multiplexer_->Unschedule(this);
+    }
+  }
+
+ private:
+  friend class QuicAlarmMultiplexer;
+
+  // Fire() is protected in QuicAlarm; let the multiplexer invoke it.
+  void FireAlarm() { Fire(); }
+
+  QuicAlarmMultiplexer* multiplexer_;
+  // True while this alarm has an entry, at |token_|, in the multiplexer's
+  // deadline map.
+  bool scheduled_;
+  AlarmMap::iterator token_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiplexedAlarm);
+};
+
+QuicAlarmMultiplexer::QuicAlarmMultiplexer(const QuicClock* clock,
+                                           base::TaskRunner* task_runner)
+    : clock_(clock), task_runner_(task_runner), weak_factory_(this) {}
+
+QuicAlarmMultiplexer::~QuicAlarmMultiplexer() {
+  // Detach any alarms which outlive the multiplexer so their destructors do
+  // not touch the deadline map.
+  for (AlarmMap::iterator it = alarms_.begin(); it != alarms_.end(); ++it) {
+    it->second->scheduled_ = false;
+  }
+}
+
+QuicAlarm* QuicAlarmMultiplexer::CreateAlarm(QuicAlarm::Delegate* delegate) {
+  return new MultiplexedAlarm(this, delegate);
+}
+
+void QuicAlarmMultiplexer::Schedule(MultiplexedAlarm* alarm) {
+  DCHECK(!alarm->scheduled_);
+  alarm->token_ =
+      alarms_.insert(std::make_pair(alarm->deadline(), alarm));
+  alarm->scheduled_ = true;
+  MaybePostWakeup();
+}
+
+void QuicAlarmMultiplexer::Unschedule(MultiplexedAlarm* alarm) {
+  DCHECK(alarm->scheduled_);
+  alarms_.erase(alarm->token_);
+  alarm->scheduled_ = false;
+}
+
+void QuicAlarmMultiplexer::MaybePostWakeup() {
+  DCHECK(!alarms_.empty());
+  const QuicTime earliest = alarms_.begin()->first;
+  if (!posted_wakeups_.empty() && *posted_wakeups_.begin() <= earliest) {
+    // A posted wakeup runs early enough; it will either fire the alarm or
+    // post a follow-up wakeup for it.
+    return;
+  }
+  int64 delay_us = earliest.Subtract(clock_->Now()).ToMicroseconds();
+  if (delay_us < 0) {
+    delay_us = 0;
+  }
+  posted_wakeups_.insert(earliest);
+  task_runner_->PostDelayedTask(
+      FROM_HERE, base::Bind(&QuicAlarmMultiplexer::OnWakeup,
+                            weak_factory_.GetWeakPtr(), earliest),
+      base::TimeDelta::FromMicroseconds(delay_us));
+}
+
+void QuicAlarmMultiplexer::OnWakeup(QuicTime scheduled) {
+  posted_wakeups_.erase(posted_wakeups_.find(scheduled));
+  const QuicTime now = clock_->Now();
+  while (!alarms_.empty() && alarms_.begin()->first <= now) {
+    MultiplexedAlarm* alarm = alarms_.begin()->second;
+    Unschedule(alarm);
+    // Fire() may re-set this alarm or reschedule others; the map is
+    // re-examined from the front on every iteration.
+    alarm->FireAlarm();
+  }
+  if (!alarms_.empty()) {
+    MaybePostWakeup();
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,76 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_QUIC_ALARM_MULTIPLEXER_H_
+#define NET_QUIC_QUIC_ALARM_MULTIPLEXER_H_
+
+#include <map>
+#include <set>
+
+#include "base/basictypes.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/net_export.h"
+#include "net/quic/quic_alarm.h"
+#include "net/quic/quic_time.h"
+
+namespace base {
+class TaskRunner;
+}  // namespace base
+
+namespace net {
+
+class QuicClock;
+
+// Schedules the alarms of every connection sharing a helper through one
+// time-ordered map, so the helper keeps at most one delayed task in flight
+// per distinct wakeup instead of one per alarm. A wakeup fires every alarm
+// whose deadline has passed by the time it runs, so deadlines landing close
+// together are handled by a single wakeup, and cancelled alarms are removed
+// from the map immediately instead of leaving dead tasks in the message
+// loop.
+class NET_EXPORT_PRIVATE QuicAlarmMultiplexer {
+ public:
+  QuicAlarmMultiplexer(const QuicClock* clock, base::TaskRunner* task_runner);
+  ~QuicAlarmMultiplexer();
+
+  // Creates a new alarm scheduled through this multiplexer. The multiplexer
+  // must outlive the returned alarm.
+  QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate);
+
+ private:
+  class MultiplexedAlarm;
+  typedef std::multimap<QuicTime, MultiplexedAlarm*> AlarmMap;
+
+  // Adds |alarm| under its deadline, posting a wakeup task unless an already
+  // posted one runs early enough to handle it.
+  void Schedule(MultiplexedAlarm* alarm);
+  void Unschedule(MultiplexedAlarm* alarm);
+
+  // Posts a delayed wakeup for the earliest deadline unless a posted wakeup
+  // covers it.
+  void MaybePostWakeup();
+
+  // Fires every alarm whose deadline has passed and schedules the next
+  // wakeup. |scheduled| is the deadline this task was posted for.
+  void OnWakeup(QuicTime scheduled);
+
+  const QuicClock* clock_;
+  base::TaskRunner* task_runner_;
+
+  // Pending alarms, ordered by deadline.
+  AlarmMap alarms_;
+
+  // Deadlines of the wakeup tasks currently posted. Tasks cannot be
+  // un-posted, so several may be outstanding after alarms move around; stale
+  // ones find nothing due and do no work.
+  std::multiset<QuicTime> posted_wakeups_;
+
+  base::WeakPtrFactory<QuicAlarmMultiplexer> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicAlarmMultiplexer);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_QUIC_ALARM_MULTIPLEXER_H_
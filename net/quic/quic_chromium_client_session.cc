@@ -191,10 +191,12 @@ QuicChromiumClientSession::QuicChromiumClientSession(
                      yield_after_duration,
                      net_log_),
       dns_resolution_end_time_(dns_resolution_end_time),
-      logger_(new QuicConnectionLogger(this,
-                                       connection_description,
-                                       socket_performance_watcher.Pass(),
-                                       net_log_)),
+      logger_(new QuicConnectionLogger(
+          this,
+          connection_description,
+          QuicConnectionLogger::ShouldLogConnectionFully(),
+          socket_performance_watcher.Pass(),
+          net_log_)),
       going_away_(false),
       disabled_reason_(QUIC_DISABLED_NOT),
       weak_factory_(this) {
@@ -1747,9 +1747,29 @@ void QuicConnection::OnResetFecGroup() {
 void QuicConnection::OnCongestionWindowChange() {
   packet_generator_.OnCongestionWindowChange(
       sent_packet_manager_.EstimateMaxPacketsInFlight(max_packet_length()));
+  MaybeUpdateFecPolicy();
   visitor_->OnCongestionWindowChange(clock_->ApproximateNow());
 }
 
+void QuicConnection::MaybeUpdateFecPolicy() {
+  if (!FLAGS_enable_quic_fec) {
+    return;
+  }
+  fec_policy_.OnCongestionEvent(stats_.packets_sent, stats_.packets_lost,
+                                sent_packet_manager_.GetRttStats()->
+                                    smoothed_rtt());
+  if (fec_policy_.ShouldFecProtect()) {
+    // Override the congestion-window based group size with one matched to
+    // the observed loss pattern.
+    packet_generator_.set_max_packets_per_fec_group(
+        fec_policy_.GetMaxPacketsPerFecGroup());
+  }
+}
+
+bool QuicConnection::ShouldFecProtectNewData() const {
+  return FLAGS_enable_quic_fec && fec_policy_.ShouldFecProtect();
+}
+
 void QuicConnection::OnRttChange() {
   // Uses the connection's smoothed RTT. If zero, uses initial_rtt.
   QuicTime::Delta rtt = sent_packet_manager_.GetRttStats()->smoothed_rtt();
@@ -33,6 +33,7 @@
 #include "net/quic/quic_alarm.h"
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_fec_group.h"
+#include "net/quic/quic_fec_policy.h"
 #include "net/quic/quic_framer.h"
 #include "net/quic/quic_packet_creator.h"
 #include "net/quic/quic_packet_generator.h"
@@ -446,6 +447,16 @@ class NET_EXPORT_PRIVATE QuicConnection
   // the SHLO.
   void OnHandshakeComplete();
 
+  // Returns true if the adaptive FEC policy recommends protecting new
+  // stream data on this connection. Always false when FEC is disabled by
+  // flag.
+  bool ShouldFecProtectNewData() const;
+
+  // Feeds current loss and RTT state into the adaptive FEC policy and
+  // applies its group size recommendation. No-op when FEC is disabled by
+  // flag.
+  void MaybeUpdateFecPolicy();
+
   // Accessors
   void set_visitor(QuicConnectionVisitorInterface* visitor) {
     visitor_ = visitor;
@@ -903,6 +914,10 @@ class NET_EXPORT_PRIVATE QuicConnection
   // An alarm that fires when an FEC packet should be sent.
   scoped_ptr<QuicAlarm> fec_alarm_;
 
+  // Decides, from observed loss and RTT, whether new data on this
+  // connection should be FEC protected and how large FEC groups should be.
+  QuicFecPolicy fec_policy_;
+
   // Network idle time before we kill of this connection.
   QuicTime::Delta idle_network_timeout_;
   // Overall connection timeout.
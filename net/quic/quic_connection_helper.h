@@ -15,6 +15,7 @@
 #include "base/basictypes.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/ip_endpoint.h"
+#include "net/quic/quic_alarm_multiplexer.h"
 #include "net/quic/quic_protocol.h"
 #include "net/quic/quic_time.h"
 #include "net/udp/datagram_client_socket.h"
@@ -45,6 +46,9 @@ class NET_EXPORT_PRIVATE QuicConnectionHelper
   base::TaskRunner* task_runner_;
   const QuicClock* clock_;
   QuicRandom* random_generator_;
+  // Shared scheduler for the alarms of every connection using this helper,
+  // so alarms with nearby deadlines share a single posted task.
+  QuicAlarmMultiplexer alarm_multiplexer_;
   base::WeakPtrFactory<QuicConnectionHelper> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicConnectionHelper);
@@ -134,13 +134,31 @@ TEST_F(QuicConnectionHelperTest, CreateAlarmAndResetEarlier) {
   // The latter task is still posted.
   ASSERT_EQ(1u, runner_->GetPostedTasks().size());
 
-  // When the latter task is executed, the weak ptr will be invalid and
-  // the alarm will not fire.
+  // When the latter task is executed, no alarm is due and nothing fires.
   runner_->RunNextTask();
   EXPECT_EQ(QuicTime::Zero().Add(delta), clock_.Now());
   EXPECT_FALSE(delegate->fired());
 }
 
+TEST_F(QuicConnectionHelperTest, CreateAlarmsWithSameDeadline) {
+  TestDelegate* delegate1 = new TestDelegate();
+  TestDelegate* delegate2 = new TestDelegate();
+  scoped_ptr<QuicAlarm> alarm1(helper_.CreateAlarm(delegate1));
+  scoped_ptr<QuicAlarm> alarm2(helper_.CreateAlarm(delegate2));
+
+  QuicTime deadline = clock_.Now().Add(QuicTime::Delta::FromMicroseconds(2));
+  alarm1->Set(deadline);
+  alarm2->Set(deadline);
+
+  // Both alarms share a single posted task.
+  ASSERT_EQ(1u, runner_->GetPostedTasks().size());
+
+  runner_->RunNextTask();
+  EXPECT_TRUE(delegate1->fired());
+  EXPECT_TRUE(delegate2->fired());
+  EXPECT_EQ(0u, runner_->GetPostedTasks().size());
+}
+
 TEST_F(QuicConnectionHelperTest, CreateAlarmAndUpdate) {
   TestDelegate* delegate = new TestDelegate();
   scoped_ptr<QuicAlarm> alarm(helper_.CreateAlarm(delegate));
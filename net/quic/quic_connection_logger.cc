@@ -20,6 +20,7 @@
 #include "net/quic/crypto/crypto_handshake_message.h"
 #include "net/quic/crypto/crypto_protocol.h"
 #include "net/quic/quic_address_mismatch.h"
+#include "net/quic/quic_flags.h"
 #include "net/quic/quic_socket_address_coder.h"
 #include "net/quic/quic_time.h"
 
@@ -274,13 +275,25 @@ AddressFamily GetRealAddressFamily(const IPAddressNumber& address) {
 
 }  // namespace
 
+// static
+bool QuicConnectionLogger::ShouldLogConnectionFully() {
+  if (FLAGS_quic_connection_logger_sampling_period <= 1)
+    return true;
+  static uint32 connection_count = 0;
+  return connection_count++ %
+             FLAGS_quic_connection_logger_sampling_period ==
+         0;
+}
+
 QuicConnectionLogger::QuicConnectionLogger(
     QuicSpdySession* session,
     const char* const connection_description,
+    bool full_logging,
     scoped_ptr<SocketPerformanceWatcher> socket_performance_watcher,
     const BoundNetLog& net_log)
     : net_log_(net_log),
       session_(session),
+      full_logging_(full_logging),
       last_received_packet_number_(0),
       last_received_packet_size_(0),
       previous_received_packet_size_(0),
@@ -347,14 +360,18 @@ void QuicConnectionLogger::OnFrameAddedToPacket(const QuicFrame& frame) {
     case PADDING_FRAME:
       break;
     case STREAM_FRAME:
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_STREAM_FRAME_SENT,
-          base::Bind(&NetLogQuicStreamFrameCallback, frame.stream_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_STREAM_FRAME_SENT,
+            base::Bind(&NetLogQuicStreamFrameCallback, frame.stream_frame));
+      }
       break;
     case ACK_FRAME: {
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_ACK_FRAME_SENT,
-          base::Bind(&NetLogQuicAckFrameCallback, frame.ack_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_ACK_FRAME_SENT,
+            base::Bind(&NetLogQuicAckFrameCallback, frame.ack_frame));
+      }
       const PacketNumberQueue& missing_packets =
           frame.ack_frame->missing_packets;
       const uint8 max_ranges = std::numeric_limits<uint8>::max();
@@ -379,40 +396,52 @@ void QuicConnectionLogger::OnFrameAddedToPacket(const QuicFrame& frame) {
     case RST_STREAM_FRAME:
       UMA_HISTOGRAM_SPARSE_SLOWLY("Net.QuicSession.RstStreamErrorCodeClient",
                                   frame.rst_stream_frame->error_code);
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_RST_STREAM_FRAME_SENT,
-          base::Bind(&NetLogQuicRstStreamFrameCallback,
-                     frame.rst_stream_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_RST_STREAM_FRAME_SENT,
+            base::Bind(&NetLogQuicRstStreamFrameCallback,
+                       frame.rst_stream_frame));
+      }
       break;
     case CONNECTION_CLOSE_FRAME:
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_CONNECTION_CLOSE_FRAME_SENT,
-          base::Bind(&NetLogQuicConnectionCloseFrameCallback,
-                     frame.connection_close_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_CONNECTION_CLOSE_FRAME_SENT,
+            base::Bind(&NetLogQuicConnectionCloseFrameCallback,
+                       frame.connection_close_frame));
+      }
       break;
     case GOAWAY_FRAME:
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_GOAWAY_FRAME_SENT,
-          base::Bind(&NetLogQuicGoAwayFrameCallback,
-                     frame.goaway_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_GOAWAY_FRAME_SENT,
+            base::Bind(&NetLogQuicGoAwayFrameCallback,
+                       frame.goaway_frame));
+      }
       break;
     case WINDOW_UPDATE_FRAME:
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_WINDOW_UPDATE_FRAME_SENT,
-          base::Bind(&NetLogQuicWindowUpdateFrameCallback,
-                     frame.window_update_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_WINDOW_UPDATE_FRAME_SENT,
+            base::Bind(&NetLogQuicWindowUpdateFrameCallback,
+                       frame.window_update_frame));
+      }
       break;
     case BLOCKED_FRAME:
       ++num_blocked_frames_sent_;
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_BLOCKED_FRAME_SENT,
-          base::Bind(&NetLogQuicBlockedFrameCallback, frame.blocked_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_BLOCKED_FRAME_SENT,
+            base::Bind(&NetLogQuicBlockedFrameCallback, frame.blocked_frame));
+      }
       break;
     case STOP_WAITING_FRAME:
-      net_log_.AddEvent(
-          NetLog::TYPE_QUIC_SESSION_STOP_WAITING_FRAME_SENT,
-          base::Bind(&NetLogQuicStopWaitingFrameCallback,
-                     frame.stop_waiting_frame));
+      if (full_logging_) {
+        net_log_.AddEvent(
+            NetLog::TYPE_QUIC_SESSION_STOP_WAITING_FRAME_SENT,
+            base::Bind(&NetLogQuicStopWaitingFrameCallback,
+                       frame.stop_waiting_frame));
+      }
       break;
     case PING_FRAME:
       UMA_HISTOGRAM_BOOLEAN("Net.QuicSession.ConnectionFlowControlBlocked",
@@ -420,11 +449,13 @@ void QuicConnectionLogger::OnFrameAddedToPacket(const QuicFrame& frame) {
       UMA_HISTOGRAM_BOOLEAN("Net.QuicSession.StreamFlowControlBlocked",
                             session_->IsStreamFlowControlBlocked());
       // PingFrame has no contents to log, so just record that it was sent.
-      net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PING_FRAME_SENT);
+      if (full_logging_)
+        net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PING_FRAME_SENT);
       break;
     case MTU_DISCOVERY_FRAME:
       // MtuDiscoveryFrame is PingFrame on wire, it does not have any payload.
-      net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_MTU_DISCOVERY_FRAME_SENT);
+      if (full_logging_)
+        net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_MTU_DISCOVERY_FRAME_SENT);
       break;
     default:
       DCHECK(false) << "Illegal frame type: " << frame.type;
@@ -437,25 +468,27 @@ void QuicConnectionLogger::OnPacketSent(
     TransmissionType transmission_type,
     size_t encrypted_length,
     QuicTime sent_time) {
-  if (original_packet_number == 0) {
-    net_log_.AddEvent(
-        NetLog::TYPE_QUIC_SESSION_PACKET_SENT,
-        base::Bind(&NetLogQuicPacketSentCallback, serialized_packet,
-                   transmission_type, encrypted_length, sent_time));
-  }  else {
-    net_log_.AddEvent(
-        NetLog::TYPE_QUIC_SESSION_PACKET_RETRANSMITTED,
-        base::Bind(&NetLogQuicPacketRetransmittedCallback,
-                   original_packet_number, serialized_packet.packet_number));
-  }
-  // Record time duration from last packet sent to the new packet sent.
-  if (last_packet_sent_time_.IsInitialized()) {
-    UMA_HISTOGRAM_CUSTOM_TIMES(
-        "Net.QuicTimeBetweenTwoPacketSent",
-        base::TimeDelta::FromMilliseconds(
-            sent_time.Subtract(last_packet_sent_time_).ToMilliseconds()),
-        base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(10),
-        100);
+  if (full_logging_) {
+    if (original_packet_number == 0) {
+      net_log_.AddEvent(
+          NetLog::TYPE_QUIC_SESSION_PACKET_SENT,
+          base::Bind(&NetLogQuicPacketSentCallback, serialized_packet,
+                     transmission_type, encrypted_length, sent_time));
+    } else {
+      net_log_.AddEvent(
+          NetLog::TYPE_QUIC_SESSION_PACKET_RETRANSMITTED,
+          base::Bind(&NetLogQuicPacketRetransmittedCallback,
+                     original_packet_number, serialized_packet.packet_number));
+    }
+    // Record time duration from last packet sent to the new packet sent.
+    if (last_packet_sent_time_.IsInitialized()) {
+      UMA_HISTOGRAM_CUSTOM_TIMES(
+          "Net.QuicTimeBetweenTwoPacketSent",
+          base::TimeDelta::FromMilliseconds(
+              sent_time.Subtract(last_packet_sent_time_).ToMilliseconds()),
+          base::TimeDelta::FromMilliseconds(1),
+          base::TimeDelta::FromMinutes(10), 100);
+    }
   }
   last_packet_sent_time_ = sent_time;
 }
@@ -472,6 +505,8 @@ void QuicConnectionLogger::OnPacketReceived(const IPEndPoint& self_address,
 
   previous_received_packet_size_ = last_received_packet_size_;
   last_received_packet_size_ = packet.length();
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_PACKET_RECEIVED,
       base::Bind(&NetLogQuicPacketCallback, &self_address, &peer_address,
@@ -480,6 +515,8 @@ void QuicConnectionLogger::OnPacketReceived(const IPEndPoint& self_address,
 
 void QuicConnectionLogger::OnUnauthenticatedHeader(
     const QuicPacketHeader& header) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_UNAUTHENTICATED_PACKET_HEADER_RECEIVED,
       base::Bind(&NetLogQuicPacketHeaderCallback, &header));
@@ -495,9 +532,11 @@ void QuicConnectionLogger::OnUndecryptablePacket() {
 }
 
 void QuicConnectionLogger::OnDuplicatePacket(QuicPacketNumber packet_number) {
-  net_log_.AddEvent(
-      NetLog::TYPE_QUIC_SESSION_DUPLICATE_PACKET_RECEIVED,
-      base::Bind(&NetLogQuicDuplicatePacketCallback, packet_number));
+  if (full_logging_) {
+    net_log_.AddEvent(
+        NetLog::TYPE_QUIC_SESSION_DUPLICATE_PACKET_RECEIVED,
+        base::Bind(&NetLogQuicDuplicatePacketCallback, packet_number));
+  }
   ++num_duplicate_packets_;
 }
 
@@ -507,12 +546,13 @@ void QuicConnectionLogger::OnProtocolVersionMismatch(
 }
 
 void QuicConnectionLogger::OnPacketHeader(const QuicPacketHeader& header) {
-  net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PACKET_AUTHENTICATED);
+  if (full_logging_)
+    net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PACKET_AUTHENTICATED);
   ++num_packets_received_;
   if (largest_received_packet_number_ < header.packet_number) {
     QuicPacketNumber delta =
         header.packet_number - largest_received_packet_number_;
-    if (delta > 1) {
+    if (delta > 1 && full_logging_) {
       // There is a gap between the largest packet previously received and
       // the current packet.  This indicates either loss, or out-of-order
       // delivery.
@@ -528,24 +568,30 @@ void QuicConnectionLogger::OnPacketHeader(const QuicPacketHeader& header) {
     ++num_out_of_order_received_packets_;
     if (previous_received_packet_size_ < last_received_packet_size_)
       ++num_out_of_order_large_received_packets_;
-    UMA_HISTOGRAM_COUNTS(
-        "Net.QuicSession.OutOfOrderGapReceived",
-        static_cast<base::HistogramBase::Sample>(last_received_packet_number_ -
-                                                 header.packet_number));
+    if (full_logging_) {
+      UMA_HISTOGRAM_COUNTS(
+          "Net.QuicSession.OutOfOrderGapReceived",
+          static_cast<base::HistogramBase::Sample>(
+              last_received_packet_number_ - header.packet_number));
+    }
   }
   last_received_packet_number_ = header.packet_number;
 }
 
 void QuicConnectionLogger::OnStreamFrame(const QuicStreamFrame& frame) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_STREAM_FRAME_RECEIVED,
       base::Bind(&NetLogQuicStreamFrameCallback, &frame));
 }
 
 void QuicConnectionLogger::OnAckFrame(const QuicAckFrame& frame) {
-  net_log_.AddEvent(
-      NetLog::TYPE_QUIC_SESSION_ACK_FRAME_RECEIVED,
-      base::Bind(&NetLogQuicAckFrameCallback, &frame));
+  if (full_logging_) {
+    net_log_.AddEvent(
+        NetLog::TYPE_QUIC_SESSION_ACK_FRAME_RECEIVED,
+        base::Bind(&NetLogQuicAckFrameCallback, &frame));
+  }
 
   const size_t kApproximateLargestSoloAckBytes = 100;
   if (last_received_packet_number_ < received_acks_.size() &&
@@ -556,7 +602,7 @@ void QuicConnectionLogger::OnAckFrame(const QuicAckFrame& frame) {
   if (frame.is_truncated)
     ++num_truncated_acks_received_;
 
-  if (frame.missing_packets.Empty())
+  if (!full_logging_ || frame.missing_packets.Empty())
     return;
 
   const PacketNumberQueue& missing_packets = frame.missing_packets;
@@ -593,6 +639,8 @@ void QuicConnectionLogger::OnAckFrame(const QuicAckFrame& frame) {
 
 void QuicConnectionLogger::OnStopWaitingFrame(
     const QuicStopWaitingFrame& frame) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_STOP_WAITING_FRAME_RECEIVED,
       base::Bind(&NetLogQuicStopWaitingFrameCallback, &frame));
@@ -601,6 +649,8 @@ void QuicConnectionLogger::OnStopWaitingFrame(
 void QuicConnectionLogger::OnRstStreamFrame(const QuicRstStreamFrame& frame) {
   UMA_HISTOGRAM_SPARSE_SLOWLY("Net.QuicSession.RstStreamErrorCodeServer",
                               frame.error_code);
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_RST_STREAM_FRAME_RECEIVED,
       base::Bind(&NetLogQuicRstStreamFrameCallback, &frame));
@@ -608,6 +658,8 @@ void QuicConnectionLogger::OnRstStreamFrame(const QuicRstStreamFrame& frame) {
 
 void QuicConnectionLogger::OnConnectionCloseFrame(
     const QuicConnectionCloseFrame& frame) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_CONNECTION_CLOSE_FRAME_RECEIVED,
       base::Bind(&NetLogQuicConnectionCloseFrameCallback, &frame));
@@ -615,6 +667,8 @@ void QuicConnectionLogger::OnConnectionCloseFrame(
 
 void QuicConnectionLogger::OnWindowUpdateFrame(
     const QuicWindowUpdateFrame& frame) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_WINDOW_UPDATE_FRAME_RECEIVED,
       base::Bind(&NetLogQuicWindowUpdateFrameCallback, &frame));
@@ -622,12 +676,16 @@ void QuicConnectionLogger::OnWindowUpdateFrame(
 
 void QuicConnectionLogger::OnBlockedFrame(const QuicBlockedFrame& frame) {
   ++num_blocked_frames_received_;
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_BLOCKED_FRAME_RECEIVED,
       base::Bind(&NetLogQuicBlockedFrameCallback, &frame));
 }
 
 void QuicConnectionLogger::OnGoAwayFrame(const QuicGoAwayFrame& frame) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_GOAWAY_FRAME_RECEIVED,
       base::Bind(&NetLogQuicGoAwayFrameCallback, &frame));
@@ -635,18 +693,22 @@ void QuicConnectionLogger::OnGoAwayFrame(const QuicGoAwayFrame& frame) {
 
 void QuicConnectionLogger::OnPingFrame(const QuicPingFrame& frame) {
   // PingFrame has no contents to log, so just record that it was received.
-  net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PING_FRAME_RECEIVED);
+  if (full_logging_)
+    net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PING_FRAME_RECEIVED);
 }
 
 void QuicConnectionLogger::OnPublicResetPacket(
     const QuicPublicResetPacket& packet) {
-  net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PUBLIC_RESET_PACKET_RECEIVED);
+  if (full_logging_)
+    net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_PUBLIC_RESET_PACKET_RECEIVED);
   UpdatePublicResetAddressMismatchHistogram(local_address_from_shlo_,
                                             packet.client_address);
 }
 
 void QuicConnectionLogger::OnVersionNegotiationPacket(
     const QuicVersionNegotiationPacket& packet) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_VERSION_NEGOTIATION_PACKET_RECEIVED,
       base::Bind(&NetLogQuicVersionNegotiationPacketCallback, &packet));
@@ -655,6 +717,8 @@ void QuicConnectionLogger::OnVersionNegotiationPacket(
 void QuicConnectionLogger::OnRevivedPacket(
     const QuicPacketHeader& revived_header,
     base::StringPiece payload) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_PACKET_HEADER_REVIVED,
       base::Bind(&NetLogQuicPacketHeaderCallback, &revived_header));
@@ -662,9 +726,11 @@ void QuicConnectionLogger::OnRevivedPacket(
 
 void QuicConnectionLogger::OnCryptoHandshakeMessageReceived(
     const CryptoHandshakeMessage& message) {
-  net_log_.AddEvent(
-      NetLog::TYPE_QUIC_SESSION_CRYPTO_HANDSHAKE_MESSAGE_RECEIVED,
-      base::Bind(&NetLogQuicCryptoHandshakeMessageCallback, &message));
+  if (full_logging_) {
+    net_log_.AddEvent(
+        NetLog::TYPE_QUIC_SESSION_CRYPTO_HANDSHAKE_MESSAGE_RECEIVED,
+        base::Bind(&NetLogQuicCryptoHandshakeMessageCallback, &message));
+  }
 
   if (message.tag() == kSHLO) {
     StringPiece address;
@@ -682,6 +748,8 @@ void QuicConnectionLogger::OnCryptoHandshakeMessageReceived(
 
 void QuicConnectionLogger::OnCryptoHandshakeMessageSent(
     const CryptoHandshakeMessage& message) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_CRYPTO_HANDSHAKE_MESSAGE_SENT,
       base::Bind(&NetLogQuicCryptoHandshakeMessageCallback, &message));
@@ -689,6 +757,8 @@ void QuicConnectionLogger::OnCryptoHandshakeMessageSent(
 
 void QuicConnectionLogger::OnConnectionClosed(QuicErrorCode error,
                                               bool from_peer) {
+  if (!full_logging_)
+    return;
   net_log_.AddEvent(
       NetLog::TYPE_QUIC_SESSION_CLOSED,
       base::Bind(&NetLogQuicOnConnectionClosedCallback, error, from_peer));
@@ -696,6 +766,8 @@ void QuicConnectionLogger::OnConnectionClosed(QuicErrorCode error,
 
 void QuicConnectionLogger::OnSuccessfulVersionNegotiation(
     const QuicVersion& version) {
+  if (!full_logging_)
+    return;
   string quic_version = QuicVersionToString(version);
   net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_VERSION_NEGOTIATED,
                     NetLog::StringCallback("version", &quic_version));
@@ -713,6 +785,8 @@ void QuicConnectionLogger::UpdateReceivedFrameCounts(
 
 void QuicConnectionLogger::OnCertificateVerified(
     const CertVerifyResult& result) {
+  if (!full_logging_)
+    return;
   if (result.cert_status == CERT_STATUS_INVALID) {
     net_log_.AddEvent(NetLog::TYPE_QUIC_SESSION_CERTIFICATE_VERIFY_FAILED);
     return;
@@ -28,14 +28,24 @@ class CertVerifyResult;
 class NET_EXPORT_PRIVATE QuicConnectionLogger
     : public QuicConnectionDebugVisitor {
  public:
+  // If |full_logging| is false, the connection was sampled out of full
+  // logging: NetLog events and per-packet histograms are skipped, and only
+  // cheap counters and the per-connection histograms they feed at
+  // destruction are maintained.
   QuicConnectionLogger(
       QuicSpdySession* session,
       const char* const connection_description,
+      bool full_logging,
       scoped_ptr<SocketPerformanceWatcher> socket_performance_watcher,
       const BoundNetLog& net_log);
 
   ~QuicConnectionLogger() override;
 
+  // Returns true if the next connection should be logged fully, sampling
+  // 1-in-FLAGS_quic_connection_logger_sampling_period connections. Values
+  // of the flag less than or equal to 1 log every connection fully.
+  static bool ShouldLogConnectionFully();
+
   // QuicPacketGenerator::DebugDelegateInterface
   void OnFrameAddedToPacket(const QuicFrame& frame) override;
 
@@ -123,6 +133,8 @@ class NET_EXPORT_PRIVATE QuicConnectionLogger
 
   BoundNetLog net_log_;
   QuicSpdySession* session_;  // Unowned.
+  // False if this connection was sampled out of full logging.
+  const bool full_logging_;
   // The last packet number received.
   QuicPacketNumber last_received_packet_number_;
   // The size of the most recently received packet.
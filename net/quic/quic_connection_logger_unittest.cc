@@ -5,6 +5,7 @@
 #include "net/quic/quic_connection_logger.h"
 
 #include "net/base/socket_performance_watcher.h"
+#include "net/quic/quic_flags.h"
 #include "net/quic/quic_protocol.h"
 #include "net/quic/test_tools/quic_test_utils.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -35,6 +36,7 @@ class QuicConnectionLoggerTest : public ::testing::Test {
       : session_(new MockConnection(&helper_, Perspective::IS_CLIENT)),
         logger_(&session_,
                 "CONNECTION_UNKNOWN",
+                /*full_logging=*/true,
                 /*socket_performance_watcher=*/nullptr,
                 net_log_) {}
 
@@ -71,5 +73,34 @@ TEST_F(QuicConnectionLoggerTest, ReceivedPacketLossRate) {
   EXPECT_EQ(0.5f, logger_.ReceivedPacketLossRate());
 }
 
+TEST_F(QuicConnectionLoggerTest, TruncatedAcksSentWithoutFullLogging) {
+  // Counters feeding per-connection histograms are maintained even for
+  // connections sampled out of full logging.
+  QuicConnectionLogger logger(&session_, "CONNECTION_UNKNOWN",
+                              /*full_logging=*/false,
+                              /*socket_performance_watcher=*/nullptr, net_log_);
+  QuicAckFrame frame;
+  for (QuicPacketNumber i = 0; i < 512; i += 2) {
+    frame.missing_packets.Add(i);
+  }
+  logger.OnFrameAddedToPacket(QuicFrame(&frame));
+  EXPECT_EQ(1u, QuicConnectionLoggerPeer::num_truncated_acks_sent(logger));
+}
+
+TEST_F(QuicConnectionLoggerTest, ShouldLogConnectionFully) {
+  ValueRestore<int32> old_flag(&FLAGS_quic_connection_logger_sampling_period,
+                               1);
+  EXPECT_TRUE(QuicConnectionLogger::ShouldLogConnectionFully());
+  EXPECT_TRUE(QuicConnectionLogger::ShouldLogConnectionFully());
+
+  FLAGS_quic_connection_logger_sampling_period = 3;
+  int num_fully_logged = 0;
+  for (int i = 0; i < 9; ++i) {
+    if (QuicConnectionLogger::ShouldLogConnectionFully())
+      ++num_fully_logged;
+  }
+  EXPECT_EQ(3, num_fully_logged);
+}
+
 }  // namespace test
 }  // namespace net
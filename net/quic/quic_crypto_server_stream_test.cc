@@ -44,8 +44,9 @@ class QuicCryptoServerConfigPeer {
  public:
   static string GetPrimaryOrbit(const QuicCryptoServerConfig& config) {
     base::AutoLock lock(config.configs_lock_);
-    CHECK(config.primary_config_.get() != nullptr);
-    return string(reinterpret_cast<const char*>(config.primary_config_->orbit),
+    CHECK(config.snapshot_->primary_config.get() != nullptr);
+    return string(reinterpret_cast<const char*>(
+                      config.snapshot_->primary_config->orbit),
                   kOrbitSize);
   }
 };
@@ -4,6 +4,8 @@
 
 #include "net/quic/quic_default_packet_writer.h"
 
+#include <string.h>
+
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
@@ -26,8 +28,8 @@ WriteResult QuicDefaultPacketWriter::WritePacket(
     size_t buf_len,
     const IPAddressNumber& self_address,
     const IPEndPoint& peer_address) {
-  scoped_refptr<StringIOBuffer> buf(
-      new StringIOBuffer(std::string(buffer, buf_len)));
+  scoped_refptr<IOBuffer> buf = buffer_pool_.Acquire(buf_len);
+  memcpy(buf->data(), buffer, buf_len);
   DCHECK(!IsWriteBlocked());
   base::TimeTicks now = base::TimeTicks::Now();
   int rv = socket_->Write(buf.get(),
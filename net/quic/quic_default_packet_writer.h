@@ -9,6 +9,7 @@
 #include "base/memory/weak_ptr.h"
 #include "net/base/ip_endpoint.h"
 #include "net/quic/quic_connection.h"
+#include "net/quic/quic_packet_buffer_pool.h"
 #include "net/quic/quic_packet_writer.h"
 #include "net/quic/quic_protocol.h"
 #include "net/udp/datagram_client_socket.h"
@@ -51,6 +52,10 @@ class NET_EXPORT_PRIVATE QuicDefaultPacketWriter : public QuicPacketWriter {
   // Whether a write is currently in flight.
   bool write_blocked_;
 
+  // Reusable buffers the serialized packets are copied into before being
+  // handed to the socket.
+  QuicPacketBufferPool buffer_pool_;
+
   base::WeakPtrFactory<QuicDefaultPacketWriter> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicDefaultPacketWriter);
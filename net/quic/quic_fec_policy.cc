@@ -0,0 +1,101 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_fec_policy.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+
+namespace {
+
+// Loss rates at which FEC protection turns on and off. The gap provides
+// hysteresis.
+const float kFecEnableLossRate = 0.02f;
+const float kFecDisableLossRate = 0.01f;
+
+// FEC only pays off when a retransmission is expensive; below this RTT the
+// lost packet is recovered quickly enough without it.
+const int64 kMinRttForFecMs = 60;
+
+// Bounds for the FEC group size. The lower bound matches the packet
+// creator's kLowestMaxPacketsPerFecGroup, the upper bound its default
+// group size.
+const size_t kMinFecGroupSize = 2;
+const size_t kMaxFecGroupSize = 10;
+
+// Gain of the loss rate and burst size EWMAs.
+const float kSmoothingAlpha = 0.125f;
+
+}  // namespace
+
+QuicFecPolicy::QuicFecPolicy()
+    : last_packets_sent_(0),
+      last_packets_lost_(0),
+      smoothed_loss_rate_(0.0f),
+      smoothed_burst_size_(0.0f),
+      smoothed_rtt_(QuicTime::Delta::Zero()),
+      fec_enabled_(false) {}
+
+QuicFecPolicy::~QuicFecPolicy() {}
+
+void QuicFecPolicy::OnCongestionEvent(QuicPacketCount packets_sent,
+                                      QuicPacketCount packets_lost,
+                                      QuicTime::Delta smoothed_rtt) {
+  smoothed_rtt_ = smoothed_rtt;
+  DCHECK_GE(packets_sent, last_packets_sent_);
+  DCHECK_GE(packets_lost, last_packets_lost_);
+  QuicPacketCount interval_sent = packets_sent - last_packets_sent_;
+  QuicPacketCount interval_lost = packets_lost - last_packets_lost_;
+  last_packets_sent_ = packets_sent;
+  last_packets_lost_ = packets_lost;
+
+  if (interval_sent > 0) {
+    float interval_loss_rate =
+        static_cast<float>(interval_lost) / interval_sent;
+    smoothed_loss_rate_ +=
+        kSmoothingAlpha * (interval_loss_rate - smoothed_loss_rate_);
+  }
+  if (interval_lost > 0) {
+    // Losses reported in the same congestion event tend to belong to one
+    // burst, so the per-interval loss count approximates burst length.
+    if (smoothed_burst_size_ == 0.0f) {
+      smoothed_burst_size_ = interval_lost;
+    } else {
+      smoothed_burst_size_ +=
+          kSmoothingAlpha * (interval_lost - smoothed_burst_size_);
+    }
+  }
+
+  bool rtt_high_enough =
+      smoothed_rtt_ >= QuicTime::Delta::FromMilliseconds(kMinRttForFecMs);
+  if (fec_enabled_) {
+    if (smoothed_loss_rate_ < kFecDisableLossRate || !rtt_high_enough) {
+      fec_enabled_ = false;
+    }
+  } else {
+    if (smoothed_loss_rate_ >= kFecEnableLossRate && rtt_high_enough) {
+      fec_enabled_ = true;
+    }
+  }
+}
+
+size_t QuicFecPolicy::GetMaxPacketsPerFecGroup() const {
+  if (smoothed_loss_rate_ <= 0.0f) {
+    return kMaxFecGroupSize;
+  }
+  // Cover about half the expected gap between loss events, so a group
+  // rarely sees more than the single loss it can revive, and shrink the
+  // group further when losses come in bursts.
+  float burst = std::max(1.0f, smoothed_burst_size_);
+  float group_size = 1.0f / (2.0f * smoothed_loss_rate_ * burst);
+  if (group_size <= kMinFecGroupSize) {
+    return kMinFecGroupSize;
+  }
+  return std::min(kMaxFecGroupSize, static_cast<size_t>(group_size));
+}
+
+}  // namespace net
@@ -0,0 +1,69 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Adaptive FEC policy for a connection. Watches the loss rate and smoothed
+// RTT reported by the sent packet manager and recommends FEC protection
+// only where it pays off: paths losing enough packets that retransmissions
+// hurt, with an RTT high enough that waiting a round trip for the
+// retransmission is worse than the FEC overhead. Also sizes FEC groups to
+// the observed loss pattern, since a group can revive only a single lost
+// packet and large groups are defeated by loss bursts.
+
+#ifndef NET_QUIC_QUIC_FEC_POLICY_H_
+#define NET_QUIC_QUIC_FEC_POLICY_H_
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class NET_EXPORT_PRIVATE QuicFecPolicy {
+ public:
+  QuicFecPolicy();
+  ~QuicFecPolicy();
+
+  // Feeds the connection's cumulative packet counters and current smoothed
+  // RTT into the policy. Called whenever the congestion state changes.
+  void OnCongestionEvent(QuicPacketCount packets_sent,
+                         QuicPacketCount packets_lost,
+                         QuicTime::Delta smoothed_rtt);
+
+  // Returns true if new stream data on this connection should be FEC
+  // protected.
+  bool ShouldFecProtect() const { return fec_enabled_; }
+
+  // Returns the number of packets an FEC group should cover, given the
+  // observed loss rate and burstiness.
+  size_t GetMaxPacketsPerFecGroup() const;
+
+  float smoothed_loss_rate() const { return smoothed_loss_rate_; }
+
+ private:
+  // Cumulative counters as of the previous OnCongestionEvent call, used to
+  // compute per-interval deltas.
+  QuicPacketCount last_packets_sent_;
+  QuicPacketCount last_packets_lost_;
+
+  // EWMA of the per-interval loss rate.
+  float smoothed_loss_rate_;
+
+  // EWMA of the number of packets lost per lossy interval, a proxy for loss
+  // burst length.
+  float smoothed_burst_size_;
+
+  QuicTime::Delta smoothed_rtt_;
+
+  // Whether FEC protection is currently recommended. Toggled with
+  // hysteresis so a loss rate hovering at the threshold does not flap
+  // protection on and off.
+  bool fec_enabled_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicFecPolicy);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_QUIC_FEC_POLICY_H_
@@ -0,0 +1,96 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_fec_policy.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const int64 kHighRttMs = 100;
+const int64 kLowRttMs = 20;
+
+class QuicFecPolicyTest : public ::testing::Test {
+ protected:
+  QuicFecPolicyTest() : packets_sent_(0), packets_lost_(0) {}
+
+  // Feeds |count| congestion events to the policy, each reporting
+  // |sent_per_event| more packets sent and |lost_per_event| more lost.
+  void FeedEvents(size_t count,
+                  QuicPacketCount sent_per_event,
+                  QuicPacketCount lost_per_event,
+                  int64 rtt_ms) {
+    for (size_t i = 0; i < count; ++i) {
+      packets_sent_ += sent_per_event;
+      packets_lost_ += lost_per_event;
+      policy_.OnCongestionEvent(packets_sent_, packets_lost_,
+                                QuicTime::Delta::FromMilliseconds(rtt_ms));
+    }
+  }
+
+  QuicFecPolicy policy_;
+  QuicPacketCount packets_sent_;
+  QuicPacketCount packets_lost_;
+};
+
+TEST_F(QuicFecPolicyTest, StaysOffOnCleanPath) {
+  FeedEvents(100, 100, 0, kHighRttMs);
+  EXPECT_FALSE(policy_.ShouldFecProtect());
+  EXPECT_EQ(10u, policy_.GetMaxPacketsPerFecGroup());
+}
+
+TEST_F(QuicFecPolicyTest, EnablesOnLossyHighRttPath) {
+  FeedEvents(100, 100, 5, kHighRttMs);
+  EXPECT_TRUE(policy_.ShouldFecProtect());
+}
+
+TEST_F(QuicFecPolicyTest, StaysOffWhenRttIsLow) {
+  // Retransmissions are cheap on a low RTT path, so losses alone do not
+  // justify the FEC overhead.
+  FeedEvents(100, 100, 5, kLowRttMs);
+  EXPECT_FALSE(policy_.ShouldFecProtect());
+}
+
+TEST_F(QuicFecPolicyTest, DisablesWithHysteresis) {
+  FeedEvents(100, 100, 5, kHighRttMs);
+  EXPECT_TRUE(policy_.ShouldFecProtect());
+
+  // One clean event decays the smoothed loss rate but leaves it above the
+  // disable threshold; protection must not flap off.
+  FeedEvents(1, 100, 0, kHighRttMs);
+  EXPECT_TRUE(policy_.ShouldFecProtect());
+
+  // A sustained clean path eventually turns protection off.
+  FeedEvents(50, 100, 0, kHighRttMs);
+  EXPECT_FALSE(policy_.ShouldFecProtect());
+}
+
+TEST_F(QuicFecPolicyTest, DisablesWhenRttDrops) {
+  FeedEvents(100, 100, 5, kHighRttMs);
+  EXPECT_TRUE(policy_.ShouldFecProtect());
+
+  // Same loss rate, but the path RTT drops below the threshold (e.g. after
+  // a network change).
+  FeedEvents(1, 100, 5, kLowRttMs);
+  EXPECT_FALSE(policy_.ShouldFecProtect());
+}
+
+TEST_F(QuicFecPolicyTest, GroupSizeShrinksWithLossRate) {
+  // 10% isolated losses: cover half the expected gap between losses.
+  FeedEvents(200, 10, 1, kHighRttMs);
+  EXPECT_EQ(5u, policy_.GetMaxPacketsPerFecGroup());
+}
+
+TEST_F(QuicFecPolicyTest, GroupSizeShrinksWithBurstiness) {
+  // The same 10% loss rate arriving in bursts of five defeats large groups,
+  // since a group can revive only one loss.
+  FeedEvents(200, 50, 5, kHighRttMs);
+  EXPECT_EQ(2u, policy_.GetMaxPacketsPerFecGroup());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
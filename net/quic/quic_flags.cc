@@ -21,7 +21,7 @@ bool FLAGS_quic_use_bbr_congestion_control = false;
 
 // If true, QUIC BBR congestion control may be enabled via Finch and/or via QUIC
 // connection options.
-bool FLAGS_quic_allow_bbr = false;
+bool FLAGS_quic_allow_bbr = true;
 
 // Time period for which a given connection_id should live in the time-wait
 // state.
@@ -130,3 +130,13 @@ bool FLAGS_quic_validate_stk_without_scid = true;
 
 // If true, use the new write blocked list for QUIC.
 bool FLAGS_quic_new_blocked_list = true;
+
+// If true, stream frames created from application iovecs reference the
+// caller's memory directly and are only copied once, into the packet's
+// plaintext buffer, when the packet is serialized.
+bool FLAGS_quic_zero_copy_stream_frames = false;
+
+// Log 1 in this many QUIC connections fully (NetLog events and per-packet
+// histograms); the others only maintain cheap counters. Values less than or
+// equal to 1 log every connection fully.
+int32 FLAGS_quic_connection_logger_sampling_period = 1;
@@ -40,4 +40,6 @@ NET_EXPORT_PRIVATE extern bool FLAGS_quic_use_primary_config_for_proof;
 NET_EXPORT_PRIVATE extern bool FLAGS_quic_distinguish_incoming_outgoing_streams;
 NET_EXPORT_PRIVATE extern bool FLAGS_quic_validate_stk_without_scid;
 NET_EXPORT_PRIVATE extern bool FLAGS_quic_new_blocked_list;
+NET_EXPORT_PRIVATE extern bool FLAGS_quic_zero_copy_stream_frames;
+NET_EXPORT_PRIVATE extern int32 FLAGS_quic_connection_logger_sampling_period;
 #endif  // NET_QUIC_QUIC_FLAGS_H_
@@ -13,6 +13,20 @@ QuicFrameList::FrameData::FrameData(QuicStreamOffset offset,
                                     const QuicTime timestamp)
     : offset(offset), segment(segment), timestamp(timestamp) {}
 
+QuicFrameList::FrameData::FrameData(
+    QuicStreamOffset offset,
+    StringPiece view,
+    const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+    const QuicTime timestamp)
+    : offset(offset),
+      view(view),
+      packet_buffer(packet_buffer),
+      timestamp(timestamp) {}
+
+StringPiece QuicFrameList::FrameData::data() const {
+  return packet_buffer.get() ? view : StringPiece(segment);
+}
+
 QuicFrameList::QuicFrameList() {}
 
 QuicFrameList::~QuicFrameList() {
@@ -53,6 +67,33 @@ QuicErrorCode QuicFrameList::OnStreamData(QuicStreamOffset offset,
   return QUIC_NO_ERROR;
 }
 
+QuicErrorCode QuicFrameList::OnPinnedStreamData(
+    QuicStreamOffset offset,
+    StringPiece data,
+    const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+    QuicTime timestamp,
+    size_t* const bytes_buffered) {
+  *bytes_buffered = 0;
+  const size_t data_len = data.size();
+  auto insertion_point = FindInsertionPoint(offset, data_len);
+  if (IsDuplicate(offset, data_len, insertion_point)) {
+    return QUIC_NO_ERROR;
+  }
+
+  if (FrameOverlapsBufferedData(offset, data_len, insertion_point)) {
+    return QUIC_INVALID_STREAM_DATA;
+  }
+
+  DVLOG(1) << "Buffering pinned stream data at offset " << offset;
+  // Keep a view of the data and a reference to the packet buffer that owns
+  // it instead of copying the payload.
+  frame_list_.insert(insertion_point,
+                     FrameData(offset, data, packet_buffer, timestamp));
+  *bytes_buffered = data_len;
+  num_bytes_buffered_ += data_len;
+  return QUIC_NO_ERROR;
+}
+
 // Finds the place the frame should be inserted.  If an identical frame is
 // present, stops on the identical frame.
 list<QuicFrameList::FrameData>::iterator QuicFrameList::FindInsertionPoint(
@@ -63,7 +104,7 @@ list<QuicFrameList::FrameData>::iterator QuicFrameList::FindInsertionPoint(
   }
   // If it's after all buffered_frames, return the end.
   if (offset >=
-      (frame_list_.rbegin()->offset + frame_list_.rbegin()->segment.length())) {
+      (frame_list_.rbegin()->offset + frame_list_.rbegin()->data().length())) {
     return frame_list_.end();
   }
   auto iter = frame_list_.begin();
@@ -71,7 +112,7 @@ list<QuicFrameList::FrameData>::iterator QuicFrameList::FindInsertionPoint(
   // frame.  If the new frame overlaps with an existing frame, the iterator will
   // still point to the frame it overlaps with.
   while (iter != frame_list_.end() &&
-         offset >= iter->offset + iter->segment.length()) {
+         offset >= iter->offset + iter->data().length()) {
     ++iter;
   }
   return iter;
@@ -97,10 +138,10 @@ bool QuicFrameList::FrameOverlapsBufferedData(
   // If there is a buffered frame with a lower starting offset, then check to
   // see if the buffered frame runs into the new frame.
   if (offset >= insertion_point->offset &&
-      offset < insertion_point->offset + insertion_point->segment.length()) {
+      offset < insertion_point->offset + insertion_point->data().length()) {
     DVLOG(1) << "Preceeding frame overlaps new frame: "
              << insertion_point->offset << " + "
-             << insertion_point->segment.length() << " > " << offset;
+             << insertion_point->data().length() << " > " << offset;
     return true;
   }
 
@@ -128,9 +169,9 @@ int QuicFrameList::GetReadableRegions(struct iovec* iov, int iov_len) const {
     }
 
     iov[index].iov_base =
-        static_cast<void*>(const_cast<char*>(it->segment.data()));
-    iov[index].iov_len = it->segment.size();
-    offset += it->segment.size();
+        static_cast<void*>(const_cast<char*>(it->data().data()));
+    iov[index].iov_len = it->data().size();
+    offset += it->data().size();
 
     ++index;
     ++it;
@@ -143,8 +184,8 @@ bool QuicFrameList::GetReadableRegion(iovec* iov, QuicTime* timestamp) const {
   if (it == frame_list_.end() || it->offset != total_bytes_read_) {
     return false;
   }
-  iov->iov_base = static_cast<void*>(const_cast<char*>(it->segment.data()));
-  iov->iov_len = it->segment.size();
+  iov->iov_base = static_cast<void*>(const_cast<char*>(it->data().data()));
+  iov->iov_len = it->data().size();
   *timestamp = it->timestamp;
   return true;
 }
@@ -157,9 +198,9 @@ bool QuicFrameList::MarkConsumed(size_t bytes_used) {
       return false;
     }
 
-    if (it->offset + it->segment.length() <= end_offset) {
-      total_bytes_read_ += it->segment.length();
-      num_bytes_buffered_ -= it->segment.length();
+    if (it->offset + it->data().length() <= end_offset) {
+      total_bytes_read_ += it->data().length();
+      num_bytes_buffered_ -= it->data().length();
       // This chunk is entirely consumed.
       frame_list_.erase(it);
       continue;
@@ -169,10 +210,17 @@ bool QuicFrameList::MarkConsumed(size_t bytes_used) {
     size_t delta = end_offset - it->offset;
     total_bytes_read_ += delta;
     num_bytes_buffered_ -= delta;
-    string new_data = it->segment.substr(delta);
     const QuicTime timestamp = it->timestamp;
-    frame_list_.erase(it);
-    frame_list_.push_front(FrameData(total_bytes_read_, new_data, timestamp));
+    if (it->packet_buffer.get()) {
+      FrameData remainder(total_bytes_read_, it->view.substr(delta),
+                          it->packet_buffer, timestamp);
+      frame_list_.erase(it);
+      frame_list_.push_front(remainder);
+    } else {
+      string new_data = it->segment.substr(delta);
+      frame_list_.erase(it);
+      frame_list_.push_front(FrameData(total_bytes_read_, new_data, timestamp));
+    }
     break;
   }
   return true;
@@ -188,10 +236,10 @@ size_t QuicFrameList::Readv(const struct iovec* iov, size_t iov_len) {
   while (iov_index < iov_len && it != frame_list_.end() &&
          it->offset == total_bytes_read_) {
     int bytes_to_read = std::min(iov[iov_index].iov_len - iov_offset,
-                                 it->segment.size() - frame_offset);
+                                 it->data().size() - frame_offset);
 
     char* iov_ptr = static_cast<char*>(iov[iov_index].iov_base) + iov_offset;
-    memcpy(iov_ptr, it->segment.data() + frame_offset, bytes_to_read);
+    memcpy(iov_ptr, it->data().data() + frame_offset, bytes_to_read);
     frame_offset += bytes_to_read;
     iov_offset += bytes_to_read;
 
@@ -200,10 +248,10 @@ size_t QuicFrameList::Readv(const struct iovec* iov, size_t iov_len) {
       iov_offset = 0;
       ++iov_index;
     }
-    if (it->segment.size() == frame_offset) {
+    if (it->data().size() == frame_offset) {
       // We've copied this whole frame
-      total_bytes_read_ += it->segment.size();
-      num_bytes_buffered_ -= it->segment.size();
+      total_bytes_read_ += it->data().size();
+      num_bytes_buffered_ -= it->data().size();
       frame_list_.erase(it);
       it = frame_list_.begin();
       frame_offset = 0;
@@ -211,9 +259,15 @@ size_t QuicFrameList::Readv(const struct iovec* iov, size_t iov_len) {
   }
   // Done copying.  If there is a partial frame, update it.
   if (frame_offset != 0) {
-    frame_list_.push_front(FrameData(it->offset + frame_offset,
-                                     it->segment.substr(frame_offset),
-                                     it->timestamp));
+    if (it->packet_buffer.get()) {
+      frame_list_.push_front(FrameData(it->offset + frame_offset,
+                                       it->view.substr(frame_offset),
+                                       it->packet_buffer, it->timestamp));
+    } else {
+      frame_list_.push_front(FrameData(it->offset + frame_offset,
+                                       it->segment.substr(frame_offset),
+                                       it->timestamp));
+    }
     frame_list_.erase(it);
     total_bytes_read_ += frame_offset;
     num_bytes_buffered_ -= frame_offset;
@@ -227,7 +281,7 @@ size_t QuicFrameList::FlushBufferedFrames() {
     // Consume all of the bytes up to the last byte yet seen, including the
     // ones that haven't arrived yet.
     auto it = frame_list_.back();
-    total_bytes_read_ = it.offset + it.segment.length();
+    total_bytes_read_ = it.offset + it.data().length();
     frame_list_.clear();
   }
   return total_bytes_read_ - initial_bytes_consumed;
@@ -21,14 +21,26 @@ class QuicStreamSequencerPeer;
 class NET_EXPORT_PRIVATE QuicFrameList
     : public QuicStreamSequencerBufferInterface {
  public:
-  // A contiguous segment received by a QUIC stream.
+  // A contiguous segment received by a QUIC stream. The payload is either
+  // copied into |segment|, or, for pinned frames, left in the decrypted
+  // packet buffer which |packet_buffer| keeps alive while |view| points
+  // into it.
   struct FrameData {
     FrameData(QuicStreamOffset offset,
               string segment,
               const QuicTime timestamp);
+    FrameData(QuicStreamOffset offset,
+              StringPiece view,
+              const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+              const QuicTime timestamp);
+
+    // The payload of this segment, wherever it lives.
+    StringPiece data() const;
 
     const QuicStreamOffset offset;
     string segment;
+    StringPiece view;
+    scoped_refptr<QuicPacketBuffer> packet_buffer;
     const QuicTime timestamp;
   };
 
@@ -43,6 +55,12 @@ class NET_EXPORT_PRIVATE QuicFrameList
                              StringPiece data,
                              QuicTime timestamp,
                              size_t* bytes_buffered) override;
+  QuicErrorCode OnPinnedStreamData(
+      QuicStreamOffset offset,
+      StringPiece data,
+      const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+      QuicTime timestamp,
+      size_t* bytes_buffered) override;
   size_t Readv(const struct iovec* iov, size_t iov_len) override;
   int GetReadableRegions(struct iovec* iov, int iov_len) const override;
   bool GetReadableRegion(iovec* iov, QuicTime* timestamp) const override;
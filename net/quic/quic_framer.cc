@@ -145,6 +145,7 @@ QuicFramer::QuicFramer(const QuicVersionVector& supported_versions,
       alternative_decrypter_latch_(false),
       perspective_(perspective),
       validate_flags_(true),
+      zero_copy_parsing_(false),
       creation_time_(creation_time),
       last_timestamp_(QuicTime::Delta::Zero()) {
   DCHECK(!supported_versions.empty());
@@ -320,6 +321,14 @@ size_t QuicFramer::BuildDataPacket(const QuicPacketHeader& header,
                                    const QuicFrames& frames,
                                    char* buffer,
                                    size_t packet_length) {
+  return BuildDataPacket(header, frames, buffer, packet_length, nullptr);
+}
+
+size_t QuicFramer::BuildDataPacket(const QuicPacketHeader& header,
+                                   const QuicFrames& frames,
+                                   char* buffer,
+                                   size_t packet_length,
+                                   QuicPacketBuffer* packet_buffer) {
   QuicDataWriter writer(packet_length, buffer);
   if (!AppendPacketHeader(header, &writer)) {
     LOG(DFATAL) << "AppendPacketHeader failed";
@@ -341,13 +350,26 @@ size_t QuicFramer::BuildDataPacket(const QuicPacketHeader& header,
       case PADDING_FRAME:
         writer.WritePadding();
         break;
-      case STREAM_FRAME:
-        if (!AppendStreamFrame(*frame.stream_frame, no_stream_frame_length,
+      case STREAM_FRAME: {
+        QuicStreamFrame* stream_frame = frame.stream_frame;
+        if (!AppendStreamFrame(*stream_frame, no_stream_frame_length,
                                &writer)) {
           LOG(DFATAL) << "AppendStreamFrame failed";
           return 0;
         }
+        // A frame that owns no copy of its data was serialized straight from
+        // the sender's iovec; anchor it to the plaintext buffer so that it
+        // remains valid for retransmission after the iovec is reclaimed.
+        if (packet_buffer != nullptr && stream_frame->buffer == nullptr &&
+            stream_frame->packet_buffer == nullptr &&
+            stream_frame->frame_length > 0) {
+          DCHECK_EQ(buffer, packet_buffer->data());
+          stream_frame->frame_buffer =
+              buffer + writer.length() - stream_frame->frame_length;
+          stream_frame->packet_buffer = packet_buffer;
+        }
         break;
+      }
       case ACK_FRAME:
         if (!AppendAckFrameAndTypeByte(header, *frame.ack_frame, &writer)) {
           LOG(DFATAL) << "AppendAckFrameAndTypeByte failed";
@@ -533,6 +555,16 @@ bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
     rv = ProcessVersionNegotiationPacket(&reader, &public_header);
   } else if (public_header.reset_flag) {
     rv = ProcessPublicResetPacket(&reader, public_header);
+  } else if (zero_copy_parsing_) {
+    // Decrypt into a reference counted buffer and pin the stream frames
+    // parsed from it, so their payload outlives this call without a copy.
+    current_packet_buffer_ = new QuicPacketBuffer(packet.length());
+    rv = ProcessDataPacket(&reader, public_header, packet,
+                           current_packet_buffer_->data(), packet.length());
+    current_packet_buffer_ = nullptr;
+    LOG_IF(DFATAL, rv && packet.length() > kMaxPacketSize)
+        << "QUIC should never successfully process packets "
+        << "larger than kMaxPacketSize. packet size:" << packet.length();
   } else if (packet.length() <= kMaxPacketSize) {
     // The optimized decryption algorithm implementations run faster when
     // operating on aligned memory.
@@ -1306,6 +1338,9 @@ bool QuicFramer::ProcessStreamFrame(QuicDataReader* reader,
   }
   frame->frame_buffer = data.data();
   frame->frame_length = static_cast<uint16>(data.length());
+  // In zero-copy mode the payload lives in the decrypted packet buffer; hand
+  // the visitor a reference so it can retain the data without copying it.
+  frame->packet_buffer = current_packet_buffer_;
 
   return true;
 }
@@ -1659,6 +1694,28 @@ size_t QuicFramer::EncryptPayload(EncryptionLevel level,
   return ad_len + output_length;
 }
 
+size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
+                                  QuicPacketNumber packet_number,
+                                  size_t ad_len,
+                                  size_t total_len,
+                                  size_t buffer_len,
+                                  char* buffer) {
+  DCHECK(encrypter_[level].get() != nullptr);
+
+  size_t output_length = 0;
+  if (!encrypter_[level]->EncryptPacket(
+          packet_number,
+          StringPiece(buffer, ad_len),                       // Associated data
+          StringPiece(buffer + ad_len, total_len - ad_len),  // Plaintext
+          buffer + ad_len,  // Destination for the ciphertext
+          &output_length, buffer_len - ad_len)) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+
+  return ad_len + output_length;
+}
+
 size_t QuicFramer::GetMaxPlaintextSize(size_t ciphertext_size) {
   // In order to keep the code simple, we don't have the current encryption
   // level to hand. Both the NullEncrypter and AES-GCM have a tag length of 12.
@@ -285,6 +285,17 @@ class NET_EXPORT_PRIVATE QuicFramer {
                          char* buffer,
                          size_t packet_length);
 
+  // As above, except that |buffer| must be |packet_buffer|->data(). Any
+  // stream frame in |frames| that owns no copy of its data (it references
+  // the sender's iovec directly) is re-pointed at its serialized payload
+  // inside |packet_buffer| and takes a reference on it, so that the frame
+  // outlives the iovec for retransmission.
+  size_t BuildDataPacket(const QuicPacketHeader& header,
+                         const QuicFrames& frames,
+                         char* buffer,
+                         size_t packet_length,
+                         QuicPacketBuffer* packet_buffer);
+
   // Returns a QuicPacket* that is owned by the caller, and is populated with
   // the fields in |header| and |fec|.  Returns nullptr if the packet could
   // not be created.
@@ -332,6 +343,19 @@ class NET_EXPORT_PRIVATE QuicFramer {
                         char* buffer,
                         size_t buffer_len);
 
+  // Encrypts a serialized packet of length |total_len| already present in
+  // |buffer|, writing the ciphertext over the plaintext so that no separate
+  // plaintext buffer or copy of the header is needed. The first |ad_len|
+  // bytes of |buffer| are the associated data (the unencrypted header) and
+  // are left untouched. Returns the length of the encrypted packet if
+  // |buffer_len| is long enough, and otherwise 0.
+  size_t EncryptInPlace(EncryptionLevel level,
+                        QuicPacketNumber packet_number,
+                        size_t ad_len,
+                        size_t total_len,
+                        size_t buffer_len,
+                        char* buffer);
+
   // Returns the maximum length of plaintext that can be encrypted
   // to ciphertext no larger than |ciphertext_size|.
   size_t GetMaxPlaintextSize(size_t ciphertext_size);
@@ -349,6 +373,14 @@ class NET_EXPORT_PRIVATE QuicFramer {
 
   void set_validate_flags(bool value) { validate_flags_ = value; }
 
+  // When true, each data packet is decrypted into a reference counted buffer
+  // and the stream frames handed to the visitor are pinned to it, so their
+  // payload stays valid after ProcessPacket() returns without being copied.
+  // When false (the default), frame payloads are only valid for the duration
+  // of the visitor callback.
+  void set_zero_copy_parsing(bool value) { zero_copy_parsing_ = value; }
+  bool zero_copy_parsing() const { return zero_copy_parsing_; }
+
   Perspective perspective() const { return perspective_; }
 
   static QuicPacketEntropyHash GetPacketEntropyHash(
@@ -526,6 +558,12 @@ class NET_EXPORT_PRIVATE QuicFramer {
   Perspective perspective_;
   // If false, skip validation that the public flags are set to legal values.
   bool validate_flags_;
+  // If true, decrypt into reference counted buffers and pin parsed stream
+  // frames to them instead of decrypting into a stack buffer.
+  bool zero_copy_parsing_;
+  // The buffer holding the packet currently being processed in zero-copy
+  // mode; only set for the duration of ProcessDataPacket().
+  scoped_refptr<QuicPacketBuffer> current_packet_buffer_;
   // The time this framer was created.  Time written to the wire will be
   // written as a delta from this value.
   QuicTime creation_time_;
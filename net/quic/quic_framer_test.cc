@@ -4235,6 +4235,46 @@ TEST_P(QuicFramerTest, EncryptPacket) {
   EXPECT_TRUE(CheckEncryption(packet_number, raw.get()));
 }
 
+TEST_P(QuicFramerTest, EncryptInPlace) {
+  QuicPacketNumber packet_number = kPacketNumber;
+  // clang-format off
+  unsigned char packet[] = {
+    // public flags (8 byte connection_id)
+    0x3C,
+    // connection_id
+    0x10, 0x32, 0x54, 0x76,
+    0x98, 0xBA, 0xDC, 0xFE,
+    // packet number
+    0xBC, 0x9A, 0x78, 0x56,
+    0x34, 0x12,
+    // private flags (fec group & fec packet)
+    0x06,
+    // first fec protected packet offset
+    0x01,
+
+    // redundancy
+    'a',  'b',  'c',  'd',
+    'e',  'f',  'g',  'h',
+    'i',  'j',  'k',  'l',
+    'm',  'n',  'o',  'p',
+  };
+  // clang-format on
+
+  scoped_ptr<QuicPacket> raw(new QuicPacket(
+      AsChars(packet), arraysize(packet), false, PACKET_8BYTE_CONNECTION_ID,
+      !kIncludeVersion, PACKET_6BYTE_PACKET_NUMBER));
+  char buffer[kMaxPacketSize];
+  memcpy(buffer, packet, arraysize(packet));
+  size_t encrypted_length = framer_.EncryptInPlace(
+      ENCRYPTION_NONE, packet_number,
+      GetStartOfEncryptedData(PACKET_8BYTE_CONNECTION_ID, !kIncludeVersion,
+                              PACKET_6BYTE_PACKET_NUMBER),
+      arraysize(packet), kMaxPacketSize, buffer);
+
+  ASSERT_NE(0u, encrypted_length);
+  EXPECT_TRUE(CheckEncryption(packet_number, raw.get()));
+}
+
 TEST_P(QuicFramerTest, EncryptPacketWithVersionFlag) {
   QuicPacketNumber packet_number = kPacketNumber;
   // clang-format off
@@ -75,7 +75,8 @@ class QuicHeadersStream::SpdyFramerVisitor
 
   SpdyHeadersHandlerInterface* OnHeaderFrameStart(
       SpdyStreamId stream_id) override {
-    LOG(FATAL);
+    // Return no handler so that the framer delivers header blocks through
+    // OnControlFrameHeaderData() instead.
     return nullptr;
   }
 
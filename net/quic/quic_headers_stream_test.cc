@@ -23,6 +23,7 @@ using std::vector;
 using testing::ElementsAre;
 using testing::InSequence;
 using testing::Invoke;
+using testing::Return;
 using testing::StrictMock;
 using testing::WithArgs;
 using testing::_;
@@ -188,6 +189,8 @@ class QuicHeadersStreamTest : public ::testing::TestWithParam<TestParams> {
                             /*parent_stream_id=*/0,
                             /*exclusive=*/false, fin, kFrameComplete));
     }
+    EXPECT_CALL(visitor_, OnHeaderFrameStart(stream_id))
+        .WillRepeatedly(Return(nullptr));
     EXPECT_CALL(visitor_, OnControlFrameHeaderData(stream_id, _, _))
         .WillRepeatedly(WithArgs<1, 2>(
             Invoke(this, &QuicHeadersStreamTest::SaveHeaderData)));
@@ -286,6 +289,8 @@ TEST_P(QuicHeadersStreamTest, WritePushPromises) {
       // Parse the outgoing data and check that it matches was was written.
       EXPECT_CALL(visitor_,
                   OnPushPromise(stream_id, promised_stream_id, kFrameComplete));
+      EXPECT_CALL(visitor_, OnHeaderFrameStart(stream_id))
+          .WillRepeatedly(Return(nullptr));
       EXPECT_CALL(visitor_, OnControlFrameHeaderData(stream_id, _, _))
           .WillRepeatedly(WithArgs<1, 2>(
               Invoke(this, &QuicHeadersStreamTest::SaveHeaderData)));
@@ -0,0 +1,58 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_packet_buffer_pool.h"
+
+#include "net/base/io_buffer.h"
+#include "net/quic/quic_protocol.h"
+
+namespace net {
+
+namespace {
+
+// Maximum number of packet buffers kept for reuse. Writes on a Chrome socket
+// are serialized (the writer is blocked while one is in flight), so only a
+// handful of buffers are ever referenced by the socket at once.
+const size_t kPacketBufferPoolSize = 8;
+
+}  // namespace
+
+// An MTU-sized, cache-aligned packet buffer which can be handed to the
+// socket repeatedly without reallocating its storage.
+class QuicPacketBufferPool::PooledPacketBuffer : public IOBuffer {
+ public:
+  PooledPacketBuffer() { data_ = storage_; }
+
+ private:
+  ~PooledPacketBuffer() override { data_ = nullptr; }
+
+  ALIGNAS(64) char storage_[kMaxPacketSize];
+
+  DISALLOW_COPY_AND_ASSIGN(PooledPacketBuffer);
+};
+
+QuicPacketBufferPool::QuicPacketBufferPool() : next_index_(0) {}
+
+QuicPacketBufferPool::~QuicPacketBufferPool() {}
+
+scoped_refptr<IOBuffer> QuicPacketBufferPool::Acquire(size_t buf_len) {
+  if (buf_len > kMaxPacketSize)
+    return new IOBuffer(buf_len);
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    size_t index = (next_index_ + i) % buffers_.size();
+    if (buffers_[index]->HasOneRef()) {
+      next_index_ = (index + 1) % buffers_.size();
+      return buffers_[index];
+    }
+  }
+  if (buffers_.size() < kPacketBufferPoolSize) {
+    buffers_.push_back(make_scoped_refptr(new PooledPacketBuffer()));
+    return buffers_.back();
+  }
+  // Every pooled buffer is still referenced by an in-flight write; fall back
+  // to a one-off allocation.
+  return new IOBuffer(buf_len);
+}
+
+}  // namespace net
@@ -0,0 +1,46 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
+#define NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class IOBuffer;
+
+// A small ring of reusable MTU-sized, cache-aligned packet buffers for the
+// QUIC send path. Packet writers copy each serialized packet into an IOBuffer
+// before handing it to the socket; acquiring that buffer from a pool avoids a
+// malloc/free pair per packet. A pooled buffer is in use for as long as the
+// socket holds a reference to it, so a buffer whose only remaining reference
+// is the pool's may be handed out again.
+class NET_EXPORT_PRIVATE QuicPacketBufferPool {
+ public:
+  QuicPacketBufferPool();
+  ~QuicPacketBufferPool();
+
+  // Returns a buffer of at least |buf_len| bytes. Reuses a pooled buffer
+  // when one is free, and falls back to a one-off allocation when |buf_len|
+  // exceeds kMaxPacketSize or every pooled buffer is referenced by an
+  // in-flight write.
+  scoped_refptr<IOBuffer> Acquire(size_t buf_len);
+
+ private:
+  class PooledPacketBuffer;
+
+  std::vector<scoped_refptr<PooledPacketBuffer>> buffers_;
+  size_t next_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketBufferPool);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
@@ -105,6 +105,7 @@ QuicPacketCreator::QuicPacketCreator(QuicConnectionId connection_id,
       packet_number_length_(next_packet_number_length_),
       packet_size_(0),
       needs_padding_(false),
+      has_borrowed_stream_data_(false),
       fec_send_policy_(FEC_ANY_TRIGGER),
       fec_timeout_(QuicTime::Delta::Zero()),
       rtt_multiplier_for_fec_timeout_(kRttMultiplierForFecTimeout) {
@@ -269,6 +270,13 @@ bool QuicPacketCreator::ConsumeData(QuicStreamId id,
   bool success = AddFrame(*frame,
                           /*save_retransmittable_frames=*/true, needs_padding);
   DCHECK(success);
+  if (frame->stream_frame->buffer == nullptr &&
+      frame->stream_frame->frame_length > 0) {
+    // The frame references |iov|'s memory directly; it must be anchored to
+    // the packet's plaintext buffer when the packet is serialized, before the
+    // caller reclaims the iovec.
+    has_borrowed_stream_data_ = true;
+  }
   return true;
 }
 
@@ -328,6 +336,17 @@ size_t QuicPacketCreator::CreateStreamFrame(QuicStreamId id,
   size_t bytes_consumed = min<size_t>(BytesFree() - min_frame_size, data_size);
 
   bool set_fin = fin && bytes_consumed == data_size;  // Last frame.
+  if (FLAGS_quic_zero_copy_stream_frames) {
+    // Reference the caller's data directly instead of copying it into a
+    // stream buffer. The single copy happens when the frame is serialized
+    // into the packet's plaintext buffer, which the frame then adopts.
+    const char* data = GetContiguousBuffer(iov, iov_offset, bytes_consumed);
+    if (data != nullptr) {
+      *frame = QuicFrame(new QuicStreamFrame(
+          id, set_fin, offset, StringPiece(data, bytes_consumed)));
+      return bytes_consumed;
+    }
+  }
   UniqueStreamBuffer buffer = NewStreamBuffer(bytes_consumed);
   CopyToBuffer(iov, iov_offset, bytes_consumed, buffer.get());
   *frame = QuicFrame(new QuicStreamFrame(id, set_fin, offset, bytes_consumed,
@@ -399,6 +418,22 @@ void QuicPacketCreator::CopyToBuffer(QuicIOVector iov,
   LOG_IF(DFATAL, length > 0) << "Failed to copy entire length to buffer.";
 }
 
+// static
+const char* QuicPacketCreator::GetContiguousBuffer(QuicIOVector iov,
+                                                   size_t iov_offset,
+                                                   size_t length) {
+  int iovnum = 0;
+  while (iovnum < iov.iov_count && iov_offset >= iov.iov[iovnum].iov_len) {
+    iov_offset -= iov.iov[iovnum].iov_len;
+    ++iovnum;
+  }
+  if (iovnum >= iov.iov_count ||
+      iov_offset + length > iov.iov[iovnum].iov_len) {
+    return nullptr;
+  }
+  return static_cast<const char*>(iov.iov[iovnum].iov_base) + iov_offset;
+}
+
 SerializedPacket QuicPacketCreator::ReserializeAllFrames(
     const RetransmittableFrames& frames,
     EncryptionLevel original_encryption_level,
@@ -542,15 +577,32 @@ SerializedPacket QuicPacketCreator::SerializePacket(
   bool possibly_truncated_by_length = packet_size_ == max_plaintext_size_ &&
                                       queued_frames_.size() == 1 &&
                                       queued_frames_.back().type == ACK_FRAME;
-  // The optimized encryption algorithm implementations run faster when
-  // operating on aligned memory.
-  // TODO(rtenneti): Change the default 64 alignas value (used the default
-  // value from CACHELINE_SIZE).
-  ALIGNAS(64) char buffer[kMaxPacketSize];
+  if (encrypted_buffer_len < packet_size_) {
+    LOG(DFATAL) << "Buffer of length " << encrypted_buffer_len
+                << " is too small to serialize a packet of size "
+                << packet_size_;
+    return NoPacket();
+  }
   // Use the packet_size_ instead of the buffer size to ensure smaller
   // packet sizes are properly used.
-  size_t length =
-      framer_->BuildDataPacket(header, queued_frames_, buffer, packet_size_);
+  size_t length;
+  scoped_refptr<QuicPacketBuffer> plaintext_buffer;
+  if (has_borrowed_stream_data_) {
+    // One or more queued stream frames reference caller-owned iovec memory.
+    // Serialize into a reference counted plaintext buffer which those frames
+    // adopt for retransmission, and encrypt out of place below.
+    plaintext_buffer = new QuicPacketBuffer(packet_size_);
+    length =
+        framer_->BuildDataPacket(header, queued_frames_,
+                                 plaintext_buffer->data(), packet_size_,
+                                 plaintext_buffer.get());
+  } else {
+    // Serialize the packet directly into the buffer the encrypted packet is
+    // returned in, so that the packet can be encrypted in place instead of
+    // being copied out of a separate plaintext buffer.
+    length = framer_->BuildDataPacket(header, queued_frames_, encrypted_buffer,
+                                      packet_size_);
+  }
   if (length == 0) {
     LOG(DFATAL) << "Failed to serialize " << queued_frames_.size()
                 << " frames.";
@@ -559,7 +611,9 @@ SerializedPacket QuicPacketCreator::SerializePacket(
 
   // TODO(ianswett) Consider replacing QuicPacket with something else,
   // since it's only used to provide convenience methods to FEC and encryption.
-  QuicPacket packet(buffer, length,
+  QuicPacket packet(has_borrowed_stream_data_ ? plaintext_buffer->data()
+                                              : encrypted_buffer,
+                    length,
                     /* owns_buffer */ false,
                     header.public_header.connection_id_length,
                     header.public_header.version_flag,
@@ -572,10 +626,23 @@ SerializedPacket QuicPacketCreator::SerializePacket(
     DCHECK_EQ(packet_size_, length);
   }
   // Immediately encrypt the packet, to ensure we don't encrypt the same packet
-  // packet number multiple times.
-  size_t encrypted_length =
-      framer_->EncryptPayload(encryption_level_, packet_number_, packet,
-                              encrypted_buffer, encrypted_buffer_len);
+  // packet number multiple times.  In the common case the header is the
+  // associated data and is left in place with the ciphertext overwriting the
+  // plaintext after it; when the plaintext buffer is retained for borrowed
+  // stream frames it must stay intact, so encrypt out of place instead.
+  size_t encrypted_length;
+  if (has_borrowed_stream_data_) {
+    encrypted_length =
+        framer_->EncryptPayload(encryption_level_, packet_number_, packet,
+                                encrypted_buffer, encrypted_buffer_len);
+  } else {
+    encrypted_length = framer_->EncryptInPlace(
+        encryption_level_, packet_number_,
+        GetStartOfEncryptedData(header.public_header.connection_id_length,
+                                header.public_header.version_flag,
+                                header.public_header.packet_number_length),
+        length, encrypted_buffer_len, encrypted_buffer);
+  }
   if (encrypted_length == 0) {
     LOG(DFATAL) << "Failed to encrypt packet number " << packet_number_;
     return NoPacket();
@@ -596,6 +663,7 @@ SerializedPacket QuicPacketCreator::SerializePacket(
   packet_size_ = 0;
   queued_frames_.clear();
   needs_padding_ = false;
+  has_borrowed_stream_data_ = false;
   return SerializedPacket(
       header.packet_number, header.public_header.packet_number_length,
       encrypted_buffer, encrypted_length, /* owns_buffer*/ false,
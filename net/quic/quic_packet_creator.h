@@ -150,6 +150,10 @@ class NET_EXPORT_PRIVATE QuicPacketCreator {
   // Returns true if there are retransmittable frames pending to be serialized.
   bool HasPendingRetransmittableFrames() const;
 
+  // Returns true if a queued stream frame still references caller-owned iovec
+  // memory. Such a packet must be serialized before the iovec is reclaimed.
+  bool HasBorrowedStreamData() const { return has_borrowed_stream_data_; }
+
   // Returns the number of bytes which are available to be used by additional
   // frames in the packet.  Since stream frames are slightly smaller when they
   // are the last frame in a packet, this method will return a different
@@ -282,7 +286,9 @@ class NET_EXPORT_PRIVATE QuicPacketCreator {
   // Returns the number of bytes consumed from data.
   // If data is empty and fin is true, the expected behavior is to consume the
   // fin but return 0.  If any data is consumed, it will be copied into a
-  // new buffer that |frame| will point to and own.
+  // new buffer that |frame| will point to and own, unless zero-copy mode is
+  // on and the data is contiguous in |iov|, in which case |frame| references
+  // the iovec memory directly until the packet is serialized.
   size_t CreateStreamFrame(QuicStreamId id,
                            QuicIOVector iov,
                            size_t iov_offset,
@@ -298,6 +304,12 @@ class NET_EXPORT_PRIVATE QuicPacketCreator {
                            size_t length,
                            char* buffer);
 
+  // Returns a pointer to the |length| bytes at offset |iov_offset| into |iov|
+  // if they are contiguous in a single iovec entry, and nullptr otherwise.
+  static const char* GetContiguousBuffer(QuicIOVector iov,
+                                         size_t iov_offset,
+                                         size_t length);
+
   // Updates lengths and also starts an FEC group if FEC protection is on and
   // there is not already an FEC group open.
   InFecGroup MaybeUpdateLengthsAndStartFec();
@@ -412,6 +424,9 @@ class NET_EXPORT_PRIVATE QuicPacketCreator {
   scoped_ptr<RetransmittableFrames> queued_retransmittable_frames_;
   // If true, the packet will be padded up to |max_packet_length_|.
   bool needs_padding_;
+  // True if a frame in queued_frames_ references iovec memory owned by the
+  // caller rather than a private copy of its data.
+  bool has_borrowed_stream_data_;
   // FEC policy that specifies when to send FEC packet.
   FecSendPolicy fec_send_policy_;
   // Timeout used for FEC alarm. Can be set to zero initially or if the SRTT has
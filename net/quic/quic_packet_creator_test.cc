@@ -781,6 +781,47 @@ TEST_P(QuicPacketCreatorTest, ConsumeDataFinOnly) {
   EXPECT_TRUE(creator_.HasPendingFrames());
 }
 
+TEST_P(QuicPacketCreatorTest, ConsumeDataZeroCopy) {
+  ValueRestore<bool> old_flag(&FLAGS_quic_zero_copy_stream_frames, true);
+  QuicFrame frame;
+  char data[] = "test";
+  struct iovec iov = {data, 4u};
+  QuicIOVector io_vector(&iov, 1, 4u);
+  ASSERT_TRUE(creator_.ConsumeData(1u, io_vector, 0u, 0u, false, false, &frame,
+                                   MAY_FEC_PROTECT));
+  ASSERT_TRUE(frame.stream_frame);
+  // The frame references the caller's memory directly instead of owning a
+  // copy of the data.
+  EXPECT_EQ(data, frame.stream_frame->frame_buffer);
+  EXPECT_TRUE(frame.stream_frame->buffer == nullptr);
+  EXPECT_TRUE(creator_.HasBorrowedStreamData());
+
+  // Serialization copies the data once, into the packet's plaintext buffer,
+  // and re-anchors the frame to that buffer so that it remains valid for
+  // retransmission after the iovec is reclaimed.
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketCreatorTest::SaveSerializedPacket));
+  creator_.Flush();
+  EXPECT_FALSE(creator_.HasBorrowedStreamData());
+  EXPECT_NE(data, frame.stream_frame->frame_buffer);
+  EXPECT_TRUE(frame.stream_frame->packet_buffer != nullptr);
+  memset(data, 'x', 4u);
+  CheckStreamFrame(frame, 1u, "test", 0u, false);
+
+  {
+    InSequence s;
+    EXPECT_CALL(framer_visitor_, OnPacket());
+    EXPECT_CALL(framer_visitor_, OnUnauthenticatedPublicHeader(_));
+    EXPECT_CALL(framer_visitor_, OnUnauthenticatedHeader(_));
+    EXPECT_CALL(framer_visitor_, OnDecryptedPacket(_));
+    EXPECT_CALL(framer_visitor_, OnPacketHeader(_));
+    EXPECT_CALL(framer_visitor_, OnStreamFrame(_));
+    EXPECT_CALL(framer_visitor_, OnPacketComplete());
+  }
+  ProcessPacket(serialized_packet_.packet);
+  ClearSerializedPacket(&serialized_packet_);
+}
+
 TEST_P(QuicPacketCreatorTest, ConsumeDataWithFecProtect) {
   creator_.set_max_packets_per_fec_group(6);
   QuicFrame frame;
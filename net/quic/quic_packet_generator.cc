@@ -162,6 +162,12 @@ QuicConsumedData QuicPacketGenerator::ConsumeData(
     }
   }
 
+  // In zero-copy mode, any open packet still references |iov|'s memory;
+  // serialize it before the caller reclaims the iovec.
+  if (packet_creator_.HasBorrowedStreamData()) {
+    packet_creator_.Flush();
+  }
+
   // Don't allow the handshake to be bundled with other retransmittable frames.
   if (has_handshake) {
     SendQueuedFrames(/*flush=*/true, /*is_fec_timeout=*/false);
@@ -214,6 +214,10 @@ class NET_EXPORT_PRIVATE QuicPacketGenerator
   FecSendPolicy fec_send_policy();
   void set_fec_send_policy(FecSendPolicy fec_send_policy);
 
+  void set_max_packets_per_fec_group(size_t max_packets_per_fec_group) {
+    packet_creator_.set_max_packets_per_fec_group(max_packets_per_fec_group);
+  }
+
  private:
   friend class test::QuicPacketGeneratorPeer;
 
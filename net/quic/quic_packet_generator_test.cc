@@ -457,6 +457,27 @@ TEST_P(QuicPacketGeneratorTest, ConsumeData_BatchOperations) {
   CheckPacketContains(contents, 0);
 }
 
+TEST_P(QuicPacketGeneratorTest, ConsumeData_ZeroCopyFlushesBeforeReturning) {
+  ValueRestore<bool> old_flag(&FLAGS_quic_zero_copy_stream_frames, true);
+  delegate_.SetCanWriteAnything();
+  generator_.StartBatchOperations();
+
+  // Even in batch mode, a packet whose stream frame references the caller's
+  // iovec must be serialized before ConsumeData() returns, since the iovec
+  // may be reclaimed afterwards.
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketGeneratorTest::SavePacket));
+  QuicConsumedData consumed = generator_.ConsumeData(
+      kHeadersStreamId, MakeIOVector("foo"), 2, true, MAY_FEC_PROTECT, nullptr);
+  EXPECT_EQ(3u, consumed.bytes_consumed);
+  EXPECT_TRUE(consumed.fin_consumed);
+  EXPECT_FALSE(generator_.HasQueuedFrames());
+
+  PacketContents contents;
+  contents.num_stream_frames = 1;
+  CheckPacketContains(contents, 0);
+}
+
 TEST_P(QuicPacketGeneratorTest, ConsumeDataFecOnMaxGroupSize) {
   delegate_.SetCanWriteAnything();
 
@@ -28,9 +28,13 @@ QuicPacketReader::QuicPacketReader(DatagramClientSocket* socket,
       yield_after_packets_(yield_after_packets),
       yield_after_duration_(yield_after_duration),
       yield_after_(QuicTime::Infinite()),
-      read_buffer_(new IOBufferWithSize(static_cast<size_t>(kMaxPacketSize))),
       net_log_(net_log),
-      weak_factory_(this) {}
+      weak_factory_(this) {
+  for (size_t i = 0; i < kQuicPacketsPerBatchRead; ++i) {
+    read_buffers_.push_back(
+        new IOBufferWithSize(static_cast<size_t>(kMaxPacketSize)));
+  }
+}
 
 QuicPacketReader::~QuicPacketReader() {
 }
@@ -44,7 +48,9 @@ void QuicPacketReader::StartReading() {
 
   DCHECK(socket_);
   read_pending_ = true;
-  int rv = socket_->Read(read_buffer_.get(), read_buffer_->size(),
+  int rv =
+      socket_->ReadBatch(read_buffers_, static_cast<int>(kMaxPacketSize),
+                         &read_results_,
                          base::Bind(&QuicPacketReader::OnReadComplete,
                                     weak_factory_.GetWeakPtr()));
   UMA_HISTOGRAM_BOOLEAN("Net.QuicSession.AsyncRead", rv == ERR_IO_PENDING);
@@ -53,7 +59,8 @@ void QuicPacketReader::StartReading() {
     return;
   }
 
-  if (++num_packets_read_ > yield_after_packets_ ||
+  num_packets_read_ += rv > 0 ? rv : 1;
+  if (num_packets_read_ > yield_after_packets_ ||
       clock_->Now() > yield_after_) {
     num_packets_read_ = 0;
     // Data was read, process it.
@@ -77,13 +84,23 @@ void QuicPacketReader::OnReadComplete(int result) {
     return;
   }
 
-  QuicEncryptedPacket packet(read_buffer_->data(), result);
+  // |result| is a datagram count; the size of each one is in |read_results_|.
+  DCHECK_LE(static_cast<size_t>(result), read_buffers_.size());
   IPEndPoint local_address;
   IPEndPoint peer_address;
   socket_->GetLocalAddress(&local_address);
   socket_->GetPeerAddress(&peer_address);
-  if (!visitor_->OnPacket(packet, local_address, peer_address))
-    return;
+  for (int i = 0; i < result; ++i) {
+    if (read_results_[i] == 0) {
+      // A zero-length datagram means the connection was closed, as with
+      // Read().
+      visitor_->OnReadError(ERR_CONNECTION_CLOSED);
+      return;
+    }
+    QuicEncryptedPacket packet(read_buffers_[i]->data(), read_results_[i]);
+    if (!visitor_->OnPacket(packet, local_address, peer_address))
+      return;
+  }
 
   StartReading();
 }
@@ -6,6 +6,8 @@
 #ifndef NET_QUIC_QUIC_PACKET_READER_H_
 #define NET_QUIC_QUIC_PACKET_READER_H_
 
+#include <vector>
+
 #include "base/memory/weak_ptr.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_export.h"
@@ -24,6 +26,11 @@ class QuicTime;
 const int kQuicYieldAfterPacketsRead = 32;
 const int kQuicYieldAfterDurationMilliseconds = 20;
 
+// Number of datagrams requested from the socket per batch read. Each needs a
+// kMaxPacketSize buffer for the lifetime of the reader, so this is kept well
+// below the yield limit.
+const size_t kQuicPacketsPerBatchRead = 16;
+
 class NET_EXPORT_PRIVATE QuicPacketReader {
  public:
   class NET_EXPORT_PRIVATE Visitor {
@@ -59,7 +66,8 @@ class NET_EXPORT_PRIVATE QuicPacketReader {
   int yield_after_packets_;
   QuicTime::Delta yield_after_duration_;
   QuicTime yield_after_;
-  scoped_refptr<IOBufferWithSize> read_buffer_;
+  std::vector<scoped_refptr<IOBuffer>> read_buffers_;
+  std::vector<int> read_results_;
   BoundNetLog net_log_;
 
   base::WeakPtrFactory<QuicPacketReader> weak_factory_;
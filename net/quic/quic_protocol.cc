@@ -101,6 +101,11 @@ QuicPublicResetPacket::QuicPublicResetPacket(
     const QuicPacketPublicHeader& header)
     : public_header(header), nonce_proof(0), rejected_packet_number(0) {}
 
+QuicPacketBuffer::QuicPacketBuffer(size_t capacity)
+    : data_(new char[capacity]), capacity_(capacity) {}
+
+QuicPacketBuffer::~QuicPacketBuffer() {}
+
 void StreamBufferDeleter::operator()(char* buf) const {
   delete[] buf;
 }
@@ -509,6 +514,16 @@ PacketNumberQueue::const_iterator PacketNumberQueue::lower_bound(
   return const_iterator(it, first, last);
 }
 
+IntervalSet<QuicPacketNumber>::const_iterator PacketNumberQueue::
+    begin_intervals() const {
+  return packet_number_intervals_.begin();
+}
+
+IntervalSet<QuicPacketNumber>::const_iterator PacketNumberQueue::
+    end_intervals() const {
+  return packet_number_intervals_.end();
+}
+
 ostream& operator<<(ostream& os, const PacketNumberQueue& q) {
   for (QuicPacketNumber packet_number : q) {
     os << packet_number << " ";
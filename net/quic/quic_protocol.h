@@ -716,6 +716,28 @@ struct NET_EXPORT_PRIVATE QuicPingFrame {};
 // frame.
 struct NET_EXPORT_PRIVATE QuicMtuDiscoveryFrame {};
 
+// A reference counted buffer holding a decrypted packet. When the framer
+// parses in zero-copy mode, stream frames point directly into one of these
+// and keep it alive until the last view of its payload has been released.
+class NET_EXPORT_PRIVATE QuicPacketBuffer
+    : public base::RefCounted<QuicPacketBuffer> {
+ public:
+  explicit QuicPacketBuffer(size_t capacity);
+
+  char* data() { return data_.get(); }
+  const char* data() const { return data_.get(); }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  friend class base::RefCounted<QuicPacketBuffer>;
+  ~QuicPacketBuffer();
+
+  std::unique_ptr<char[]> data_;
+  const size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketBuffer);
+};
+
 // Deleter for stream buffers.
 class NET_EXPORT_PRIVATE StreamBufferDeleter {
  public:
@@ -748,8 +770,13 @@ struct NET_EXPORT_PRIVATE QuicStreamFrame {
   QuicPacketLength frame_length;
   const char* frame_buffer;
   QuicStreamOffset offset;  // Location of this data in the stream.
-  // nullptr when the QuicStreamFrame is received, and non-null when sent.
+  // Non-null iff the frame owns a private copy of its data. Frames received
+  // from the wire and frames created in zero-copy mode do not.
   UniqueStreamBuffer buffer;
+  // Set in zero-copy mode; owns the packet memory (the decrypted packet on
+  // the receive side, the serialized plaintext packet on the send side) that
+  // |frame_buffer| points into.
+  scoped_refptr<QuicPacketBuffer> packet_buffer;
 
  private:
   QuicStreamFrame(QuicStreamId stream_id,
@@ -870,6 +897,11 @@ class NET_EXPORT_PRIVATE PacketNumberQueue {
   const_iterator end() const;
   const_iterator lower_bound(QuicPacketNumber packet_number) const;
 
+  // Returns iterators over the half open packet number intervals, for callers
+  // which can process whole ranges at once.
+  IntervalSet<QuicPacketNumber>::const_iterator begin_intervals() const;
+  IntervalSet<QuicPacketNumber>::const_iterator end_intervals() const;
+
   NET_EXPORT_PRIVATE friend std::ostream& operator<<(
       std::ostream& os,
       const PacketNumberQueue& q);
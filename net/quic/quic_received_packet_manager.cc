@@ -131,6 +131,143 @@ AdvanceFirstGapAndGarbageCollectEntropyMap() {
   }
 }
 
+QuicReceivedPacketManager::ReceivedPacketBitmap::ReceivedPacketBitmap()
+    : base_(1),
+      largest_observed_(0) {
+}
+
+QuicReceivedPacketManager::ReceivedPacketBitmap::~ReceivedPacketBitmap() {}
+
+bool QuicReceivedPacketManager::ReceivedPacketBitmap::GetBit(
+    QuicPacketNumber packet_number) const {
+  DCHECK_GE(packet_number, base_);
+  const QuicPacketNumber offset = packet_number - base_;
+  DCHECK_LT(offset / kBitsPerWord, words_.size());
+  return (words_[offset / kBitsPerWord] >> (offset % kBitsPerWord)) & 1;
+}
+
+void QuicReceivedPacketManager::ReceivedPacketBitmap::RecordReceived(
+    QuicPacketNumber packet_number) {
+  if (packet_number < base_) {
+    // The packet was already passed over by RemoveUpTo.
+    return;
+  }
+  const QuicPacketNumber offset = packet_number - base_;
+  while (offset / kBitsPerWord >= words_.size()) {
+    words_.push_back(0);
+  }
+  words_[offset / kBitsPerWord] |= UINT64_C(1) << (offset % kBitsPerWord);
+  largest_observed_ = max(largest_observed_, packet_number);
+}
+
+bool QuicReceivedPacketManager::ReceivedPacketBitmap::IsMissing(
+    QuicPacketNumber packet_number) const {
+  if (packet_number < base_ || packet_number >= largest_observed_) {
+    return false;
+  }
+  return !GetBit(packet_number);
+}
+
+bool QuicReceivedPacketManager::ReceivedPacketBitmap::RemoveUpTo(
+    QuicPacketNumber least_unacked) {
+  if (least_unacked <= base_) {
+    return false;
+  }
+  // Only packets up to the largest received can have been reported missing.
+  bool had_missing = false;
+  const QuicPacketNumber limit = min(least_unacked, largest_observed_ + 1);
+  for (QuicPacketNumber packet_number = base_; packet_number < limit;
+       ++packet_number) {
+    if (!GetBit(packet_number)) {
+      had_missing = true;
+      break;
+    }
+  }
+  // Drop whole words that fall entirely below |least_unacked|.
+  while (!words_.empty() && base_ + kBitsPerWord <= least_unacked) {
+    words_.pop_front();
+    base_ += kBitsPerWord;
+  }
+  if (words_.empty()) {
+    base_ = least_unacked;
+    return had_missing;
+  }
+  // Force on the remaining bits below |least_unacked| so those packets are
+  // never reported missing.
+  words_.front() |= (UINT64_C(1) << (least_unacked - base_)) - 1;
+  return had_missing;
+}
+
+QuicPacketNumber
+QuicReceivedPacketManager::ReceivedPacketBitmap::LargestMissing() const {
+  if (largest_observed_ <= base_) {
+    return 0;
+  }
+  // Scan downwards from the largest received packet, skipping words with no
+  // holes.
+  size_t word_index =
+      static_cast<size_t>((largest_observed_ - base_) / kBitsPerWord);
+  for (;;) {
+    uint64 missing = ~words_[word_index];
+    if (word_index == (largest_observed_ - base_) / kBitsPerWord) {
+      // Ignore bits at and above the largest received packet.
+      missing &= (UINT64_C(1) << ((largest_observed_ - base_) %
+                                  kBitsPerWord)) - 1;
+    }
+    if (missing != 0) {
+      size_t bit = kBitsPerWord - 1;
+      while ((missing >> bit) == 0) {
+        --bit;
+      }
+      return base_ + word_index * kBitsPerWord + bit;
+    }
+    if (word_index == 0) {
+      return 0;
+    }
+    --word_index;
+  }
+}
+
+void QuicReceivedPacketManager::ReceivedPacketBitmap::AppendMissingPackets(
+    PacketNumberQueue* missing_packets) const {
+  if (largest_observed_ <= base_) {
+    return;
+  }
+  const size_t last_word =
+      static_cast<size_t>((largest_observed_ - base_) / kBitsPerWord);
+  bool in_run = false;
+  QuicPacketNumber run_start = 0;
+  for (size_t word_index = 0; word_index <= last_word; ++word_index) {
+    const uint64 word = words_[word_index];
+    // Fast paths: a fully received word cannot start or end a run, and a
+    // fully missing word cannot end one.
+    if (!in_run && word == ~UINT64_C(0)) {
+      continue;
+    }
+    if (in_run && word == 0) {
+      continue;
+    }
+    const QuicPacketNumber word_base = base_ + word_index * kBitsPerWord;
+    for (size_t bit = 0; bit < kBitsPerWord; ++bit) {
+      const QuicPacketNumber packet_number = word_base + bit;
+      if (packet_number > largest_observed_) {
+        break;
+      }
+      if ((word >> bit) & 1) {
+        if (in_run) {
+          missing_packets->Add(run_start, packet_number);
+          in_run = false;
+        }
+      } else if (!in_run) {
+        run_start = packet_number;
+        in_run = true;
+      }
+    }
+  }
+  // The largest received packet closes any open run.
+  DCHECK(!in_run);
+}
+
 QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
     : peer_least_packet_awaiting_ack_(0),
       ack_frame_updated_(false),
@@ -150,17 +287,11 @@ void QuicReceivedPacketManager::RecordPacketReceived(
   DCHECK(IsAwaitingPacket(packet_number));
   ack_frame_updated_ = true;
 
-  // Adds the range of packet numbers from max(largest observed + 1, least
-  // awaiting ack) up to packet_number not including packet_number.
-  ack_frame_.missing_packets.Add(
-      max(ack_frame_.largest_observed + 1, peer_least_packet_awaiting_ack_),
-      packet_number);
+  received_bitmap_.RecordReceived(packet_number);
 
   if (ack_frame_.largest_observed > packet_number) {
-    // We've gotten one of the out of order packets - remove it from our
-    // "missing packets" list.
-    DVLOG(1) << "Removing " << packet_number << " from missing list";
-    ack_frame_.missing_packets.Remove(packet_number);
+    // We've gotten one of the out of order packets.
+    DVLOG(1) << "Packet " << packet_number << " no longer missing";
 
     // Record how out of order stats.
     ++stats_->packets_reordered;
@@ -194,12 +325,13 @@ void QuicReceivedPacketManager::RecordPacketRevived(
 }
 
 bool QuicReceivedPacketManager::IsMissing(QuicPacketNumber packet_number) {
-  return ack_frame_.missing_packets.Contains(packet_number);
+  return received_bitmap_.IsMissing(packet_number);
 }
 
 bool QuicReceivedPacketManager::IsAwaitingPacket(
     QuicPacketNumber packet_number) {
-  return ::net::IsAwaitingPacket(ack_frame_, packet_number);
+  return packet_number > ack_frame_.largest_observed ||
+         received_bitmap_.IsMissing(packet_number);
 }
 
 namespace {
@@ -218,6 +350,9 @@ struct isTooLarge {
 void QuicReceivedPacketManager::UpdateReceivedPacketInfo(
     QuicAckFrame* ack_frame, QuicTime approximate_now) {
   ack_frame_updated_ = false;
+  // Generate the missing packet ranges from the received bitmap.
+  ack_frame_.missing_packets = PacketNumberQueue();
+  received_bitmap_.AppendMissingPackets(&ack_frame_.missing_packets);
   *ack_frame = ack_frame_;
   ack_frame->entropy_hash = EntropyHash(ack_frame_.largest_observed);
 
@@ -262,7 +397,7 @@ bool QuicReceivedPacketManager::DontWaitForPacketsBefore(
   if (ack_frame_.latest_revived_packet < least_unacked) {
     ack_frame_.latest_revived_packet = 0;
   }
-  return ack_frame_.missing_packets.RemoveUpTo(least_unacked);
+  return received_bitmap_.RemoveUpTo(least_unacked);
 }
 
 void QuicReceivedPacketManager::UpdatePacketInformationSentByPeer(
@@ -283,13 +418,14 @@ void QuicReceivedPacketManager::UpdatePacketInformationSentByPeer(
     }
     peer_least_packet_awaiting_ack_ = stop_waiting.least_unacked;
   }
-  DCHECK(ack_frame_.missing_packets.Empty() ||
-         ack_frame_.missing_packets.Min() >= peer_least_packet_awaiting_ack_);
+  DCHECK(peer_least_packet_awaiting_ack_ == 0 ||
+         !received_bitmap_.IsMissing(peer_least_packet_awaiting_ack_ - 1));
 }
 
 bool QuicReceivedPacketManager::HasNewMissingPackets() const {
-  return !ack_frame_.missing_packets.Empty() &&
-         (ack_frame_.largest_observed - ack_frame_.missing_packets.Max()) <=
+  const QuicPacketNumber largest_missing = received_bitmap_.LargestMissing();
+  return largest_missing != 0 &&
+         (ack_frame_.largest_observed - largest_missing) <=
              kMaxPacketsAfterNewMissing;
 }
 
@@ -95,6 +95,57 @@ class NET_EXPORT_PRIVATE QuicReceivedPacketManager :
     DISALLOW_COPY_AND_ASSIGN(EntropyTracker);
   };
 
+  // A sliding window of bits keyed by packet number, recording which packets
+  // have been received.  Missing packet ranges for outgoing ack frames are
+  // generated from the bitmap with word-at-a-time scans instead of mutating
+  // an interval set once per received packet.
+  class NET_EXPORT_PRIVATE ReceivedPacketBitmap {
+   public:
+    ReceivedPacketBitmap();
+    ~ReceivedPacketBitmap();
+
+    // Marks |packet_number| as received, extending the window if necessary.
+    void RecordReceived(QuicPacketNumber packet_number);
+
+    // Returns true if |packet_number| is missing: at or above the floor, below
+    // the largest received packet, and not itself received.
+    bool IsMissing(QuicPacketNumber packet_number) const;
+
+    // Stops tracking packets below |least_unacked|; they will never be
+    // reported missing again.  Returns true if any of the forgotten packets
+    // was missing.
+    bool RemoveUpTo(QuicPacketNumber least_unacked);
+
+    // Returns the largest missing packet number, or 0 if none is missing.
+    QuicPacketNumber LargestMissing() const;
+
+    // Appends all missing packet ranges to |missing_packets|, scanning the
+    // bitmap a word at a time.
+    void AppendMissingPackets(PacketNumberQueue* missing_packets) const;
+
+   private:
+    typedef std::deque<uint64> BitmapWords;
+
+    static const size_t kBitsPerWord = 64;
+
+    // Returns true if |packet_number|'s bit is set.  |packet_number| must be
+    // within [base_, base_ + kBitsPerWord * words_.size()).
+    bool GetBit(QuicPacketNumber packet_number) const;
+
+    // Bit i of words_[w] records receipt of packet base_ + w * kBitsPerWord
+    // + i.  Bits below the floor set by RemoveUpTo are forced on, so the
+    // packets they describe are never considered missing.
+    BitmapWords words_;
+
+    // Packet number corresponding to bit 0 of words_.front().
+    QuicPacketNumber base_;
+
+    // The largest packet number recorded as received.
+    QuicPacketNumber largest_observed_;
+
+    DISALLOW_COPY_AND_ASSIGN(ReceivedPacketBitmap);
+  };
+
   explicit QuicReceivedPacketManager(QuicConnectionStats* stats);
   ~QuicReceivedPacketManager() override;
 
@@ -154,6 +205,10 @@ class NET_EXPORT_PRIVATE QuicReceivedPacketManager :
   // Tracks entropy hashes of received packets.
   EntropyTracker entropy_tracker_;
 
+  // Tracks which packets have been received.  |ack_frame_|'s missing packet
+  // set is regenerated from this bitmap by UpdateReceivedPacketInfo.
+  ReceivedPacketBitmap received_bitmap_;
+
   // Least packet number of the the packet sent by the peer for which it
   // hasn't received an ack.
   QuicPacketNumber peer_least_packet_awaiting_ack_;
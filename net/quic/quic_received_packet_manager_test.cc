@@ -185,6 +185,57 @@ TEST(EntropyTrackerTest, SetCumulativeEntropyUpTo) {
   EXPECT_EQ(42 ^ 21, tracker.EntropyHash(9));
 }
 
+TEST(ReceivedPacketBitmapTest, MissingRanges) {
+  QuicReceivedPacketManager::ReceivedPacketBitmap bitmap;
+  bitmap.RecordReceived(2);
+  bitmap.RecordReceived(5);
+  bitmap.RecordReceived(200);
+
+  EXPECT_TRUE(bitmap.IsMissing(1));
+  EXPECT_TRUE(bitmap.IsMissing(3));
+  EXPECT_FALSE(bitmap.IsMissing(5));
+  EXPECT_TRUE(bitmap.IsMissing(199));
+  EXPECT_FALSE(bitmap.IsMissing(200));
+  EXPECT_FALSE(bitmap.IsMissing(201));
+  EXPECT_EQ(199u, bitmap.LargestMissing());
+
+  PacketNumberQueue missing;
+  bitmap.AppendMissingPackets(&missing);
+  EXPECT_EQ(1u, missing.Min());
+  EXPECT_EQ(199u, missing.Max());
+  EXPECT_EQ(197u, missing.NumPacketsSlow());
+  EXPECT_FALSE(missing.Contains(2));
+  EXPECT_FALSE(missing.Contains(5));
+  EXPECT_TRUE(missing.Contains(100));
+}
+
+TEST(ReceivedPacketBitmapTest, RemoveUpTo) {
+  QuicReceivedPacketManager::ReceivedPacketBitmap bitmap;
+  bitmap.RecordReceived(2);
+  bitmap.RecordReceived(130);
+
+  // Packets 1 and 3..129 are missing.
+  EXPECT_TRUE(bitmap.RemoveUpTo(100));
+  EXPECT_FALSE(bitmap.IsMissing(99));
+  EXPECT_TRUE(bitmap.IsMissing(100));
+
+  // No missing packets below 100 remain.
+  EXPECT_FALSE(bitmap.RemoveUpTo(100));
+  EXPECT_TRUE(bitmap.RemoveUpTo(131));
+  EXPECT_EQ(0u, bitmap.LargestMissing());
+
+  PacketNumberQueue missing;
+  bitmap.AppendMissingPackets(&missing);
+  EXPECT_TRUE(missing.Empty());
+
+  // Packets below the floor are never reported missing again, but packets at
+  // or above it are.
+  bitmap.RecordReceived(133);
+  EXPECT_FALSE(bitmap.IsMissing(130));
+  EXPECT_TRUE(bitmap.IsMissing(131));
+  EXPECT_TRUE(bitmap.IsMissing(132));
+}
+
 class QuicReceivedPacketManagerTest : public ::testing::Test {
  protected:
   QuicReceivedPacketManagerTest() : received_manager_(&stats_) {}
@@ -286,21 +286,30 @@ void QuicSentPacketManager::MaybeInvokeCongestionEvent(
 
 void QuicSentPacketManager::HandleAckForSentPackets(
     const QuicAckFrame& ack_frame) {
-  // Go through the packets we have not received an ack for and see if this
-  // incoming_ack shows they've been seen by the peer.
+  // Derive the acked packets directly from the ack frame: the ranges between
+  // the missing intervals, up to the largest observed, have been seen by the
+  // peer.  This touches only the acked and missing packets instead of walking
+  // every unacked packet.
   QuicTime::Delta delta_largest_observed =
       ack_frame.delta_time_largest_observed;
+  const QuicPacketNumber largest_observed = ack_frame.largest_observed;
   QuicPacketNumber packet_number = unacked_packets_.GetLeastUnacked();
-  for (QuicUnackedPacketMap::iterator it = unacked_packets_.begin();
-       it != unacked_packets_.end(); ++it, ++packet_number) {
-    if (packet_number > ack_frame.largest_observed) {
-      // These packets are still in flight.
-      break;
+  for (IntervalSet<QuicPacketNumber>::const_iterator interval =
+           ack_frame.missing_packets.begin_intervals();
+       interval != ack_frame.missing_packets.end_intervals() &&
+       packet_number <= largest_observed;
+       ++interval) {
+    if (interval->max() <= packet_number) {
+      // The interval is entirely below the least unacked packet.
+      continue;
     }
-
-    if (ack_frame.missing_packets.Contains(packet_number)) {
+    // The range between the previous missing interval and this one was acked.
+    HandleAckedRange(packet_number, min(interval->min(), largest_observed + 1),
+                     delta_largest_observed);
+    for (QuicPacketNumber nacked = max(packet_number, interval->min());
+         nacked < interval->max() && nacked <= largest_observed; ++nacked) {
       // Don't continue to increase the nack count for packets not in flight.
-      if (!it->in_flight) {
+      if (!unacked_packets_.GetTransmissionInfo(nacked).in_flight) {
         continue;
       }
       // Consider it multiple nacks when there is a gap between the missing
@@ -308,22 +317,19 @@ void QuicSentPacketManager::HandleAckForSentPackets(
       // threshold is to tolerate re-ordering.  This handles both StretchAcks
       // and Forward Acks.
       // The nack count only increases when the largest observed increases.
-      QuicPacketCount min_nacks = ack_frame.largest_observed - packet_number;
+      QuicPacketCount min_nacks = largest_observed - nacked;
       // Truncated acks can nack the largest observed, so use a min of 1.
       if (min_nacks == 0) {
         min_nacks = 1;
       }
-      unacked_packets_.NackPacket(packet_number, min_nacks);
-      continue;
-    }
-    // Packet was acked, so remove it from our unacked packet list.
-    DVLOG(1) << ENDPOINT << "Got an ack for packet " << packet_number;
-    // If data is associated with the most recent transmission of this
-    // packet, then inform the caller.
-    if (it->in_flight) {
-      packets_acked_.push_back(std::make_pair(packet_number, it->bytes_sent));
+      unacked_packets_.NackPacket(nacked, min_nacks);
     }
-    MarkPacketHandled(packet_number, &(*it), delta_largest_observed);
+    packet_number = interval->max();
+  }
+  // Everything above the last missing interval was acked.
+  if (packet_number <= largest_observed) {
+    HandleAckedRange(packet_number, largest_observed + 1,
+                     delta_largest_observed);
   }
 
   // Discard any retransmittable frames associated with revived packets.
@@ -332,6 +338,25 @@ void QuicSentPacketManager::HandleAckForSentPackets(
   }
 }
 
+void QuicSentPacketManager::HandleAckedRange(
+    QuicPacketNumber lower,
+    QuicPacketNumber higher,
+    QuicTime::Delta delta_largest_observed) {
+  for (QuicPacketNumber packet_number = lower; packet_number < higher;
+       ++packet_number) {
+    // Packet was acked, so remove it from our unacked packet list.
+    DVLOG(1) << ENDPOINT << "Got an ack for packet " << packet_number;
+    TransmissionInfo* info =
+        unacked_packets_.GetMutableTransmissionInfo(packet_number);
+    // If data is associated with the most recent transmission of this
+    // packet, then inform the caller.
+    if (info->in_flight) {
+      packets_acked_.push_back(std::make_pair(packet_number, info->bytes_sent));
+    }
+    MarkPacketHandled(packet_number, info, delta_largest_observed);
+  }
+}
+
 bool QuicSentPacketManager::HasRetransmittableFrames(
     QuicPacketNumber packet_number) const {
   return unacked_packets_.HasRetransmittableFrames(packet_number);
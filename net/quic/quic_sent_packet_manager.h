@@ -280,6 +280,11 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
   // Process the incoming ack looking for newly ack'd data packets.
   void HandleAckForSentPackets(const QuicAckFrame& ack_frame);
 
+  // Marks the packets in [lower, higher) as acked.
+  void HandleAckedRange(QuicPacketNumber lower,
+                        QuicPacketNumber higher,
+                        QuicTime::Delta delta_largest_observed);
+
   // Returns the current retransmission mode.
   RetransmissionTimeoutMode GetRetransmissionMode() const;
 
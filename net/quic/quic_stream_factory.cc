@@ -77,6 +77,10 @@ const int32 kQuicStreamMaxRecvWindowSize = 6 * 1024 * 1024;    // 6 MB
 // Set the maximum number of undecryptable packets the connection will store.
 const int32 kMaxUndecryptablePackets = 100;
 
+// After this many consecutive QUIC connection failures on a network, the
+// waiting TCP job is no longer delayed at all on that network.
+const int kMaxQuicFailuresBeforeNoDelay = 3;
+
 void HistogramCreateSessionFailure(enum CreateSessionFailure error) {
   UMA_HISTOGRAM_ENUMERATION("Net.QuicSession.CreationError", error,
                             CREATION_ERROR_MAX);
@@ -169,6 +173,10 @@ class QuicStreamFactory::Job {
 
   const QuicServerId server_id() const { return server_id_; }
 
+  // Time this job was created, used to measure how long QUIC takes to
+  // connect on the current network.
+  base::TimeTicks start_time() const { return start_time_; }
+
   base::WeakPtr<Job> GetWeakPtr() { return weak_factory_.GetWeakPtr(); }
 
  private:
@@ -200,6 +208,7 @@ class QuicStreamFactory::Job {
   AddressList address_list_;
   base::TimeTicks dns_resolution_start_time_;
   base::TimeTicks dns_resolution_end_time_;
+  const base::TimeTicks start_time_;
   base::WeakPtrFactory<Job> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(Job);
 };
@@ -227,6 +236,7 @@ QuicStreamFactory::Job::Job(QuicStreamFactory* factory,
       started_another_job_(false),
       net_log_(net_log),
       session_(nullptr),
+      start_time_(base::TimeTicks::Now()),
       weak_factory_(this) {}
 
 QuicStreamFactory::Job::Job(QuicStreamFactory* factory,
@@ -244,6 +254,7 @@ QuicStreamFactory::Job::Job(QuicStreamFactory* factory,
       started_another_job_(false),                      // unused
       net_log_(session->net_log()),                     // unused
       session_(session),
+      start_time_(base::TimeTicks::Now()),
       weak_factory_(this) {}
 
 QuicStreamFactory::Job::~Job() {
@@ -693,7 +704,26 @@ base::TimeDelta QuicStreamFactory::GetTimeDelayForWaitingJob(
     const QuicServerId& server_id) {
   if (!delay_tcp_race_ || require_confirmation_)
     return base::TimeDelta();
+
+  // If QUIC has recently failed every attempt on this network (e.g. UDP is
+  // blocked by a middlebox), don't hold the TCP job back at all.
+  const QuicNetworkStats* network_stats = nullptr;
+  if (http_server_properties_ && !(local_address_ == IPEndPoint())) {
+    network_stats =
+        http_server_properties_->GetQuicNetworkStats(local_address_.address());
+  }
+  if (network_stats &&
+      network_stats->consecutive_failures >= kMaxQuicFailuresBeforeNoDelay) {
+    return base::TimeDelta();
+  }
+
   int64 srtt = 1.5 * GetServerNetworkStatsSmoothedRttInMicroseconds(server_id);
+  if (!srtt && network_stats &&
+      network_stats->smoothed_connect_time > base::TimeDelta()) {
+    // No history for this server: fall back to how long QUIC typically
+    // takes to connect on this network.
+    srtt = network_stats->smoothed_connect_time.InMicroseconds();
+  }
   // Picked 300ms based on mean time from
   // Net.QuicSession.HostResolution.HandshakeConfirmedTime histogram.
   const int kDefaultRTT = 300 * kNumMicrosPerMilli;
@@ -823,6 +853,12 @@ bool QuicStreamFactory::OnResolution(
 
 void QuicStreamFactory::OnJobComplete(Job* job, int rv) {
   QuicServerId server_id = job->server_id();
+  // Update the per-network QUIC history used to stagger the TCP race.
+  if (http_server_properties_ && !(local_address_ == IPEndPoint())) {
+    http_server_properties_->RecordQuicNetworkResult(
+        local_address_.address(), rv == OK,
+        base::TimeTicks::Now() - job->start_time());
+  }
   if (rv != OK) {
     JobSet* jobs = &(active_jobs_[server_id]);
     if (jobs->size() > 1) {
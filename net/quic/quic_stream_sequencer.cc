@@ -60,9 +60,18 @@ void QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
     }
   }
   size_t bytes_written;
-  QuicErrorCode result = buffered_frames_->OnStreamData(
-      byte_offset, StringPiece(frame.frame_buffer, frame.frame_length),
-      clock_->ApproximateNow(), &bytes_written);
+  QuicErrorCode result;
+  if (frame.packet_buffer.get()) {
+    // The frame is pinned to the decrypted packet buffer, so the data can be
+    // retained without copying it.
+    result = buffered_frames_->OnPinnedStreamData(
+        byte_offset, StringPiece(frame.frame_buffer, frame.frame_length),
+        frame.packet_buffer, clock_->ApproximateNow(), &bytes_written);
+  } else {
+    result = buffered_frames_->OnStreamData(
+        byte_offset, StringPiece(frame.frame_buffer, frame.frame_length),
+        clock_->ApproximateNow(), &bytes_written);
+  }
 
   if (result == QUIC_INVALID_STREAM_DATA) {
     stream_->CloseConnectionWithDetails(
@@ -32,6 +32,16 @@ class NET_EXPORT_PRIVATE QuicStreamSequencerBufferInterface {
                                      QuicTime timestamp,
                                      size_t* bytes_buffered) = 0;
 
+  // Zero-copy variant of OnStreamData(). |packet_buffer| owns the memory
+  // |data| points into, and the implementation may keep a reference to it
+  // instead of copying the payload.
+  virtual QuicErrorCode OnPinnedStreamData(
+      QuicStreamOffset offset,
+      StringPiece data,
+      const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+      QuicTime timestamp,
+      size_t* bytes_buffered) = 0;
+
   // Reads from this buffer into given iovec array, up to number of iov_len
   // iovec objects and returns the number of bytes read.
   virtual size_t Readv(const struct iovec* iov, size_t iov_len) = 0;
@@ -639,6 +639,36 @@ TEST(QuicFrameListTest, FrameOverlapsBufferedData) {
       QuicStreamFrame(1, false, kBufferedOffset + kBufferedDataLength, data)));
 }
 
+TEST(QuicFrameListTest, PinnedFrameKeepsPacketBufferAlive) {
+  QuicFrameList buffer;
+
+  // Stage the payload in a ref counted packet buffer, as the framer does in
+  // zero-copy mode.
+  const char kPayload[] = "abcdef";
+  scoped_refptr<QuicPacketBuffer> packet_buffer(
+      new QuicPacketBuffer(arraysize(kPayload)));
+  memcpy(packet_buffer->data(), kPayload, arraysize(kPayload));
+
+  size_t bytes_written;
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer.OnPinnedStreamData(0, StringPiece(packet_buffer->data(), 6),
+                                      packet_buffer, QuicTime::Zero(),
+                                      &bytes_written));
+  EXPECT_EQ(6u, bytes_written);
+  // Drop the local reference; the buffered frame must keep the packet buffer
+  // alive.
+  packet_buffer = nullptr;
+
+  char dest[3];
+  iovec iov{dest, 3};
+  EXPECT_EQ(3u, buffer.Readv(&iov, 1));
+  EXPECT_EQ("abc", StringPiece(dest, 3));
+  EXPECT_EQ(3u, buffer.BytesBuffered());
+  EXPECT_EQ(3u, buffer.Readv(&iov, 1));
+  EXPECT_EQ("def", StringPiece(dest, 3));
+  EXPECT_EQ(0u, buffer.BytesBuffered());
+}
+
 TEST_P(QuicStreamSequencerTest, DontAcceptOverlappingFrames) {
   // The peer should never send us non-identical stream frames which contain
   // overlapping byte ranges - if they do, we close the connection.
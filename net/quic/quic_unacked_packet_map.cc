@@ -18,6 +18,7 @@ QuicUnackedPacketMap::QuicUnackedPacketMap()
     : largest_sent_packet_(0),
       largest_observed_(0),
       least_unacked_(1),
+      least_in_flight_(1),
       bytes_in_flight_(0),
       pending_crypto_packet_count_(0),
       track_single_retransmission_(FLAGS_quic_track_single_retransmission) {}
@@ -349,6 +350,23 @@ const TransmissionInfo& QuicUnackedPacketMap::GetTransmissionInfo(
   return unacked_packets_[packet_number - least_unacked_];
 }
 
+TransmissionInfo* QuicUnackedPacketMap::GetMutableTransmissionInfo(
+    QuicPacketNumber packet_number) {
+  return &unacked_packets_[packet_number - least_unacked_];
+}
+
+QuicPacketNumber QuicUnackedPacketMap::GetLeastInFlight() const {
+  if (least_in_flight_ < least_unacked_) {
+    // Packets below least_unacked_ have been removed from the map.
+    least_in_flight_ = least_unacked_;
+  }
+  while (least_in_flight_ - least_unacked_ < unacked_packets_.size() &&
+         !unacked_packets_[least_in_flight_ - least_unacked_].in_flight) {
+    ++least_in_flight_;
+  }
+  return least_in_flight_;
+}
+
 QuicTime QuicUnackedPacketMap::GetLastPacketSentTime() const {
   UnackedPacketMap::const_reverse_iterator it = unacked_packets_.rbegin();
   while (it != unacked_packets_.rend()) {
@@ -113,6 +113,15 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
   const TransmissionInfo& GetTransmissionInfo(
       QuicPacketNumber packet_number) const;
 
+  // Returns a mutable pointer to the TransmissionInfo associated with
+  // |packet_number|, which must be unacked.
+  TransmissionInfo* GetMutableTransmissionInfo(QuicPacketNumber packet_number);
+
+  // Returns the smallest packet number of a packet in flight, or the packet
+  // number following the map if no packets are in flight.  Amortized O(1):
+  // packets are never returned to flight, so the cursor only moves forward.
+  QuicPacketNumber GetLeastInFlight() const;
+
   // Returns the time that the last unacked packet was sent.
   QuicTime GetLastPacketSentTime() const;
 
@@ -186,6 +195,9 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
   UnackedPacketMap unacked_packets_;
   // The packet at the 0th index of unacked_packets_.
   QuicPacketNumber least_unacked_;
+  // Lower bound on the smallest packet number in flight, advanced lazily by
+  // GetLeastInFlight().
+  mutable QuicPacketNumber least_in_flight_;
 
   QuicByteCount bytes_in_flight_;
   // Number of retransmittable crypto handshake packets.
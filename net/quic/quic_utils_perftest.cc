@@ -0,0 +1,52 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_utils.h"
+
+#include <string>
+
+#include "base/logging.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/test/benchmark_reporter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+// Roughly a full-sized QUIC packet; the hash runs over every packet's
+// associated data on the framing paths.
+const size_t kPacketSize = 1350;
+const size_t kWarmupIterations = 1 << 10;
+const size_t kMeasuredIterations = 1 << 16;
+
+uint128 RunHash(const std::string& data, size_t iterations) {
+  // Accumulate the results so the hash cannot be optimized away.
+  uint128 sum = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    sum = sum + QuicUtils::FNV1a_128_Hash(data.data(), data.size());
+  }
+  return sum;
+}
+
+TEST(QuicUtilsTest, FNV1a128HashPerfTest) {
+  std::string data;
+  data.reserve(kPacketSize);
+  for (size_t i = 0; i < kPacketSize; ++i) {
+    data.push_back(static_cast<char>(i));
+  }
+  CHECK(RunHash(data, kWarmupIterations) != 0);
+  base::ElapsedTimer elapsed_timer;
+  uint128 sum = RunHash(data, kMeasuredIterations);
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+  CHECK(sum != 0);
+  test::BenchmarkReporter reporter("QUIC_fnv1a_128_hash");
+  reporter.set_wall_time(elapsed);
+  reporter.set_iterations(kMeasuredIterations);
+  reporter.SetThroughput("KB",
+                         kPacketSize * kMeasuredIterations / 1024.0 /
+                             elapsed.InSecondsF());
+}
+
+}  // namespace
+}  // namespace net
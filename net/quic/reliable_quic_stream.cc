@@ -343,7 +343,15 @@ QuicConsumedData ReliableQuicStream::WritevData(
 }
 
 FecProtection ReliableQuicStream::GetFecProtection() {
-  return fec_policy_ == FEC_PROTECT_ALWAYS ? MUST_FEC_PROTECT : MAY_FEC_PROTECT;
+  if (fec_policy_ == FEC_PROTECT_ALWAYS) {
+    return MUST_FEC_PROTECT;
+  }
+  // For FEC_PROTECT_OPTIONAL streams, defer to the connection's adaptive
+  // policy, which protects only lossy high-RTT paths.
+  if (session_->connection()->ShouldFecProtectNewData()) {
+    return MUST_FEC_PROTECT;
+  }
+  return MAY_FEC_PROTECT;
 }
 
 void ReliableQuicStream::CloseReadSide() {
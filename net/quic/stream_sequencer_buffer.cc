@@ -44,8 +44,8 @@ void StreamSequencerBuffer::Clear() {
   // Reset gaps_ so that buffer is in a state as if all data before
   // total_bytes_read_ has been consumed, and those after total_bytes_read_
   // has never arrived.
-  gaps_ = std::list<Gap>(
-      1, Gap(total_bytes_read_, std::numeric_limits<QuicStreamOffset>::max())),
+  gaps_.clear();
+  gaps_[total_bytes_read_] = std::numeric_limits<QuicStreamOffset>::max();
   frame_arrival_time_map_.clear();
 }
 
@@ -70,10 +70,17 @@ QuicErrorCode StreamSequencerBuffer::OnStreamData(
   }
 
   // Find the first gap not ending before |offset|. This gap maybe the gap to
-  // fill if the arriving frame doesn't overlaps with previous ones.
-  std::list<Gap>::iterator current_gap = gaps_.begin();
-  while (current_gap != gaps_.end() && current_gap->end_offset <= offset) {
-    ++current_gap;
+  // fill if the arriving frame doesn't overlaps with previous ones. The gaps
+  // are ordered by begin offset, so this is the gap before the first gap
+  // beginning after |offset| when that gap extends past |offset|, and the
+  // latter gap otherwise.
+  GapMap::iterator current_gap = gaps_.upper_bound(offset);
+  if (current_gap != gaps_.begin()) {
+    GapMap::iterator previous_gap = current_gap;
+    --previous_gap;
+    if (previous_gap->second > offset) {
+      current_gap = previous_gap;
+    }
   }
 
   DCHECK(current_gap != gaps_.end());
@@ -82,17 +89,15 @@ QuicErrorCode StreamSequencerBuffer::OnStreamData(
   // overlap across different base::StringPiece objects already written.
   // In both cases, don't write the data,
   // and allow the caller of this method to handle the result.
-  if (offset < current_gap->begin_offset &&
-      offset + size <= current_gap->begin_offset) {
+  if (offset < current_gap->first && offset + size <= current_gap->first) {
     DVLOG(1) << "Duplicated data at offset: " << offset << " length: " << size;
     return QUIC_NO_ERROR;
   }
-  if (offset < current_gap->begin_offset &&
-      offset + size > current_gap->begin_offset) {
+  if (offset < current_gap->first && offset + size > current_gap->first) {
     // Beginning of new data overlaps data before current gap.
     return QUIC_INVALID_STREAM_DATA;
   }
-  if (offset + size > current_gap->end_offset) {
+  if (offset + size > current_gap->second) {
     // End of new data overlaps with data after current gap.
     return QUIC_INVALID_STREAM_DATA;
   }
@@ -148,31 +153,39 @@ QuicErrorCode StreamSequencerBuffer::OnStreamData(
   return QUIC_NO_ERROR;
 }
 
+QuicErrorCode StreamSequencerBuffer::OnPinnedStreamData(
+    QuicStreamOffset offset,
+    base::StringPiece data,
+    const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+    QuicTime timestamp,
+    size_t* const bytes_buffered) {
+  // The ring buffer copies into its own blocks by design, so there is
+  // nothing to pin here.
+  return OnStreamData(offset, data, timestamp, bytes_buffered);
+}
+
 inline void StreamSequencerBuffer::UpdateGapList(
-    std::list<Gap>::iterator gap_with_new_data_written,
+    GapMap::iterator gap_with_new_data_written,
     QuicStreamOffset start_offset,
     size_t bytes_written) {
-  if (gap_with_new_data_written->begin_offset == start_offset &&
-      gap_with_new_data_written->end_offset > start_offset + bytes_written) {
-    // New data has been written into the left part of the buffer.
-    gap_with_new_data_written->begin_offset = start_offset + bytes_written;
-  } else if (gap_with_new_data_written->begin_offset < start_offset &&
-             gap_with_new_data_written->end_offset ==
-                 start_offset + bytes_written) {
+  const QuicStreamOffset gap_begin = gap_with_new_data_written->first;
+  const QuicStreamOffset gap_end = gap_with_new_data_written->second;
+  if (gap_begin == start_offset && gap_end > start_offset + bytes_written) {
+    // New data has been written into the left part of the buffer. The begin
+    // offset is the map key, so the gap is re-inserted under its new one.
+    gaps_.erase(gap_with_new_data_written);
+    gaps_[start_offset + bytes_written] = gap_end;
+  } else if (gap_begin < start_offset &&
+             gap_end == start_offset + bytes_written) {
     // New data has been written into the right part of the buffer.
-    gap_with_new_data_written->end_offset = start_offset;
-  } else if (gap_with_new_data_written->begin_offset < start_offset &&
-             gap_with_new_data_written->end_offset >
-                 start_offset + bytes_written) {
+    gap_with_new_data_written->second = start_offset;
+  } else if (gap_begin < start_offset &&
+             gap_end > start_offset + bytes_written) {
     // New data has been written into the middle of the buffer.
-    auto current = gap_with_new_data_written++;
-    size_t current_end = current->end_offset;
-    current->end_offset = start_offset;
-    gaps_.insert(gap_with_new_data_written,
-                 Gap(start_offset + bytes_written, current_end));
-  } else if (gap_with_new_data_written->begin_offset == start_offset &&
-             gap_with_new_data_written->end_offset ==
-                 start_offset + bytes_written) {
+    gap_with_new_data_written->second = start_offset;
+    gaps_[start_offset + bytes_written] = gap_end;
+  } else if (gap_begin == start_offset &&
+             gap_end == start_offset + bytes_written) {
     // This gap has been filled with new data. So it's no longer a gap.
     gaps_.erase(gap_with_new_data_written);
   }
@@ -227,7 +240,7 @@ int StreamSequencerBuffer::GetReadableRegions(struct iovec* iov,
   }
 
   size_t start_block_idx = NextBlockToRead();
-  QuicStreamOffset readable_offset_end = gaps_.front().begin_offset - 1;
+  QuicStreamOffset readable_offset_end = gaps_.begin()->first - 1;
   DCHECK_GE(readable_offset_end + 1, total_bytes_read_);
   size_t end_block_offset = GetInBlockOffset(readable_offset_end);
   size_t end_block_idx = GetBlockIndex(readable_offset_end);
@@ -340,13 +353,13 @@ bool StreamSequencerBuffer::MarkConsumed(size_t bytes_used) {
 
 size_t StreamSequencerBuffer::FlushBufferedFrames() {
   size_t prev_total_bytes_read = total_bytes_read_;
-  total_bytes_read_ = gaps_.back().begin_offset;
+  total_bytes_read_ = gaps_.rbegin()->first;
   Clear();
   return total_bytes_read_ - prev_total_bytes_read;
 }
 
 size_t StreamSequencerBuffer::ReadableBytes() const {
-  return gaps_.front().begin_offset - total_bytes_read_;
+  return gaps_.begin()->first - total_bytes_read_;
 }
 
 bool StreamSequencerBuffer::HasBytesToRead() const {
@@ -390,20 +403,20 @@ void StreamSequencerBuffer::RetireBlockIfEmpty(size_t block_index) {
 
   // Check where the logical end of this buffer is.
   // Not empty if the end of circular buffer has been wrapped to this block.
-  if (GetBlockIndex(gaps_.back().begin_offset - 1) == block_index) {
+  if (GetBlockIndex(gaps_.rbegin()->first - 1) == block_index) {
     return;
   }
 
   // Read index remains in this block, which means a gap has been reached.
   if (NextBlockToRead() == block_index) {
-    Gap first_gap = gaps_.front();
-    DCHECK(first_gap.begin_offset == total_bytes_read_);
+    GapMap::const_iterator first_gap = gaps_.begin();
+    DCHECK(first_gap->first == total_bytes_read_);
     // Check where the next piece data is.
     // Not empty if next piece of data is still in this chunk.
     bool gap_extends_to_infinity =
-        (first_gap.end_offset != std::numeric_limits<QuicStreamOffset>::max());
+        (first_gap->second != std::numeric_limits<QuicStreamOffset>::max());
     bool gap_ends_in_this_block =
-        (GetBlockIndex(first_gap.end_offset) == block_index);
+        (GetBlockIndex(first_gap->second) == block_index);
     if (gap_extends_to_infinity || gap_ends_in_this_block) {
       return;
     }
@@ -412,7 +425,7 @@ void StreamSequencerBuffer::RetireBlockIfEmpty(size_t block_index) {
 }
 
 bool StreamSequencerBuffer::Empty() const {
-  return gaps_.size() == 1 && gaps_.front().begin_offset == total_bytes_read_;
+  return gaps_.size() == 1 && gaps_.begin()->first == total_bytes_read_;
 }
 
 size_t StreamSequencerBuffer::GetBlockCapacity(size_t block_index) const {
@@ -62,6 +62,7 @@
 
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 
 #include "base/macros.h"
@@ -85,6 +86,11 @@ class NET_EXPORT_PRIVATE StreamSequencerBuffer
     QuicStreamOffset end_offset;
   };
 
+  // The set of gaps, stored as an ordered map from a gap's begin offset to
+  // its end offset so that the gap covering an offset can be found in
+  // O(log gaps) instead of a linear scan.
+  typedef std::map<QuicStreamOffset, QuicStreamOffset> GapMap;
+
   // A FrameInfo stores the length of a frame and the time it arrived.
   struct NET_EXPORT_PRIVATE FrameInfo {
     FrameInfo();
@@ -115,6 +121,12 @@ class NET_EXPORT_PRIVATE StreamSequencerBuffer
                              base::StringPiece data,
                              QuicTime timestamp,
                              size_t* bytes_buffered) override;
+  QuicErrorCode OnPinnedStreamData(
+      QuicStreamOffset offset,
+      base::StringPiece data,
+      const scoped_refptr<QuicPacketBuffer>& packet_buffer,
+      QuicTime timestamp,
+      size_t* bytes_buffered) override;
   size_t Readv(const struct iovec* dest_iov, size_t dest_count) override;
   int GetReadableRegions(struct iovec* iov, int iov_len) const override;
   bool GetReadableRegion(iovec* iov, QuicTime* timestamp) const override;
@@ -140,7 +152,7 @@ class NET_EXPORT_PRIVATE StreamSequencerBuffer
 
   // Called within OnStreamData() to update the gap OnStreamData() writes into
   // (remove, split or change begin/end offset).
-  void UpdateGapList(std::list<Gap>::iterator gap_with_new_data_written,
+  void UpdateGapList(GapMap::iterator gap_with_new_data_written,
                      QuicStreamOffset start_offset,
                      size_t bytes_written);
 
@@ -181,7 +193,7 @@ class NET_EXPORT_PRIVATE StreamSequencerBuffer
   QuicStreamOffset total_bytes_read_;
 
   // Contains Gaps which represents currently missing data.
-  std::list<Gap> gaps_;
+  GapMap gaps_;
 
   // An ordered, variable-length list of blocks, with the length limited
   // such that the number of blocks never exceeds blocks_count_.
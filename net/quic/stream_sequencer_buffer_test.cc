@@ -84,16 +84,16 @@ class StreamSequencerBufferPeer {
 
   bool CheckBufferInvariants() {
     QuicStreamOffset data_span =
-        buffer_->gaps_.back().begin_offset - buffer_->total_bytes_read_;
+        buffer_->gaps_.rbegin()->first - buffer_->total_bytes_read_;
     bool capacity_sane = data_span <= buffer_->max_buffer_capacity_bytes_ &&
                          data_span >= buffer_->num_bytes_buffered_;
     if (!capacity_sane) {
       LOG(ERROR) << "data span is larger than capacity.";
       LOG(ERROR) << "total read: " << buffer_->total_bytes_read_
-                 << " last byte: " << buffer_->gaps_.back().begin_offset;
+                 << " last byte: " << buffer_->gaps_.rbegin()->first;
     }
     bool total_read_sane =
-        buffer_->gaps_.front().begin_offset >= buffer_->total_bytes_read_;
+        buffer_->gaps_.begin()->first >= buffer_->total_bytes_read_;
     if (!total_read_sane) {
       LOG(ERROR) << "read across 1st gap.";
     }
@@ -125,7 +125,13 @@ class StreamSequencerBufferPeer {
 
   int GapSize() { return buffer_->gaps_.size(); }
 
-  std::list<Gap> GetGaps() { return buffer_->gaps_; }
+  std::list<Gap> GetGaps() {
+    std::list<Gap> gaps;
+    for (const auto& gap : buffer_->gaps_) {
+      gaps.push_back(Gap(gap.first, gap.second));
+    }
+    return gaps;
+  }
 
   size_t max_buffer_capacity() { return buffer_->max_buffer_capacity_bytes_; }
 
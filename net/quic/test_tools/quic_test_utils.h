@@ -22,6 +22,7 @@
 #include "net/quic/quic_session.h"
 #include "net/quic/test_tools/mock_clock.h"
 #include "net/quic/test_tools/mock_random.h"
+#include "net/quic/test_tools/simple_random.h"
 #include "net/spdy/spdy_framer.h"
 #include "net/tools/quic/quic_dispatcher.h"
 #include "net/tools/quic/quic_per_connection_packet_writer.h"
@@ -179,25 +180,6 @@ class ValueRestore {
   DISALLOW_COPY_AND_ASSIGN(ValueRestore);
 };
 
-// Simple random number generator used to compute random numbers suitable
-// for pseudo-randomly dropping packets in tests.  It works by computing
-// the sha1 hash of the current seed, and using the first 64 bits as
-// the next random number, and the next seed.
-class SimpleRandom {
- public:
-  SimpleRandom() : seed_(0) {}
-
-  // Returns a random number in the range [0, kuint64max].
-  uint64 RandUint64();
-
-  void set_seed(uint64 seed) { seed_ = seed; }
-
- private:
-  uint64 seed_;
-
-  DISALLOW_COPY_AND_ASSIGN(SimpleRandom);
-};
-
 class MockFramerVisitor : public QuicFramerVisitorInterface {
  public:
   MockFramerVisitor();
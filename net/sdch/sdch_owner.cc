@@ -335,6 +335,12 @@ void SdchOwner::OnDictionaryFetched(base::Time last_used,
     DictionaryItem(const DictionaryItem& rhs) = default;
     DictionaryItem& operator=(const DictionaryItem& rhs) = default;
     bool operator<(const DictionaryItem& rhs) const {
+      // Least-earning dictionaries sort (and so are evicted) first:
+      // fewest recorded uses, with age breaking ties.  Use count is a
+      // proxy for the bytes the dictionary has saved, as each use
+      // represents a response it compressed.
+      if (use_count != rhs.use_count)
+        return use_count < rhs.use_count;
       return last_used < rhs.last_used;
     }
   };
@@ -681,33 +687,85 @@ bool SdchOwner::SchedulePersistedDictionaryLoads(
   if (!persisted_info.GetDictionary(kDictionariesKey, &dictionary_set))
     return false;
 
+  struct PersistedDictionary {
+    GURL url;
+    base::Time last_used;
+    int use_count;
+    int size;
+
+    PersistedDictionary() : use_count(0), size(0) {}
+    bool operator<(const PersistedDictionary& rhs) const {
+      // Dictionaries that have earned their keep sort (and so are
+      // reloaded) first: most recorded uses, with recency breaking ties.
+      if (use_count != rhs.use_count)
+        return use_count > rhs.use_count;
+      return last_used > rhs.last_used;
+    }
+  };
+
+  // Dictionaries that were never used and are from before
+  // |never_used_stale_boundary| would be immediately evictable; don't
+  // spend memory reloading them.
+  base::Time never_used_stale_boundary(
+      clock_->Now() -
+      base::TimeDelta::FromHours(kNeverUsedFreshnessLifetimeHours));
+
   // Any formatting error will result in skipping that particular
   // dictionary.
+  std::vector<PersistedDictionary> candidates;
   for (base::DictionaryValue::Iterator dict_it(*dictionary_set);
        !dict_it.IsAtEnd(); dict_it.Advance()) {
     const base::DictionaryValue* dict_info = nullptr;
     if (!dict_it.value().GetAsDictionary(&dict_info))
       continue;
 
+    PersistedDictionary candidate;
+
     std::string url_string;
     if (!dict_info->GetString(kDictionaryUrlKey, &url_string))
       continue;
-    GURL dict_url(url_string);
+    candidate.url = GURL(url_string);
 
     double last_used;
     if (!dict_info->GetDouble(kDictionaryLastUsedKey, &last_used))
       continue;
+    candidate.last_used = base::Time::FromDoubleT(last_used);
 
-    int use_count;
-    if (!dict_info->GetInteger(kDictionaryUseCountKey, &use_count))
+    if (!dict_info->GetInteger(kDictionaryUseCountKey, &candidate.use_count))
       continue;
 
+    if (!dict_info->GetInteger(kDictionarySizeKey, &candidate.size))
+      continue;
+
+    if (candidate.use_count == 0 &&
+        candidate.last_used < never_used_stale_boundary) {
+      RecordDictionaryFate(DICTIONARY_FATE_RELOAD_SKIPPED);
+      continue;
+    }
+
+    candidates.push_back(candidate);
+  }
+
+  // Reload the best-earning dictionaries first, and stop scheduling once
+  // reloading more would exceed the memory budget.  Skipped dictionaries
+  // will be refetched through Get-Dictionary if a server advertises them
+  // again.
+  std::sort(candidates.begin(), candidates.end());
+  size_t scheduled_bytes = 0;
+  for (const auto& candidate : candidates) {
+    if (scheduled_bytes + static_cast<size_t>(candidate.size) >
+        max_total_dictionary_size_) {
+      RecordDictionaryFate(DICTIONARY_FATE_RELOAD_SKIPPED);
+      continue;
+    }
+    scheduled_bytes += candidate.size;
+
     fetcher_->ScheduleReload(
-        dict_url, base::Bind(&SdchOwner::OnDictionaryFetched,
-                             // SdchOwner will outlive its member variables.
-                             base::Unretained(this),
-                             base::Time::FromDoubleT(last_used),
-                             use_count));
+        candidate.url, base::Bind(&SdchOwner::OnDictionaryFetched,
+                                  // SdchOwner will outlive its member
+                                  // variables.
+                                  base::Unretained(this), candidate.last_used,
+                                  candidate.use_count));
   }
 
   return true;
@@ -30,7 +30,9 @@ class URLRequestContext;
 // This class owns the SDCH objects not owned as part of URLRequestContext, and
 // exposes interface for setting SDCH policy.  It should be instantiated by
 // the net/ embedder.
-// TODO(rdsmith): Implement dictionary prioritization.
+// Dictionaries are prioritized by recorded use: eviction removes the
+// least-used dictionaries first, and persisted dictionaries are reloaded
+// most-used first until the memory budget is filled.
 class NET_EXPORT SdchOwner : public SdchObserver, public PrefStore::Observer {
  public:
   static const size_t kMaxTotalDictionarySize;
@@ -106,10 +108,14 @@ class NET_EXPORT SdchOwner : public SdchObserver, public PrefStore::Observer {
   void OnMemoryPressure(
       base::MemoryPressureListener::MemoryPressureLevel level);
 
-  // Schedule loading of all dictionaries described in |persisted_info|.
-  // Returns false and does not schedule a load if |persisted_info| has an
-  // unsupported version or no dictionaries key. Skips any dictionaries that are
-  // malformed in |persisted_info|.
+  // Schedule loading of the dictionaries described in |persisted_info|,
+  // best-earning (most used, most recently used) dictionaries first, up to
+  // the memory budget. Returns false and does not schedule a load if
+  // |persisted_info| has an unsupported version or no dictionaries key.
+  // Skips any dictionaries that are malformed in |persisted_info|, that
+  // went stale without ever being used, or that do not fit in the budget;
+  // skipped dictionaries are refetched through Get-Dictionary if a server
+  // advertises them again.
   bool SchedulePersistedDictionaryLoads(
       const base::DictionaryValue& persisted_info);
 
@@ -149,7 +155,12 @@ class NET_EXPORT SdchOwner : public SdchObserver, public PrefStore::Observer {
     // A dictionary was unloaded on destruction, but is still present on disk.
     DICTIONARY_FATE_UNLOAD_FOR_DESTRUCTION = 10,
 
-    DICTIONARY_FATE_MAX = 11
+    // A persisted dictionary was not reloaded, either because it had
+    // never earned a use before going stale or because reloading it
+    // would have exceeded the memory budget.
+    DICTIONARY_FATE_RELOAD_SKIPPED = 11,
+
+    DICTIONARY_FATE_MAX = 12
   };
 
   void RecordDictionaryFate(DictionaryFate fate);
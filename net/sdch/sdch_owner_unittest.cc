@@ -577,6 +577,41 @@ TEST_F(SdchOwnerTest, UseChangesEviction) {
   EXPECT_TRUE(DictionaryPresentInManager(server_hash_d4));
 }
 
+// Confirm eviction prefers dictionaries that have never been used over
+// older dictionaries that have earned a use.
+TEST_F(SdchOwnerTest, UseWeightsEviction) {
+  std::string server_hash_d1;
+  std::string server_hash_d2;
+
+  base::SimpleTestClock* test_clock = new base::SimpleTestClock();
+  sdch_owner().SetClockForTesting(make_scoped_ptr(test_clock));
+  test_clock->SetNow(base::Time::Now());
+
+  // Add a dictionary and use it, then age it until it is stale.
+  EXPECT_TRUE(CreateAndAddDictionary(kMaxSizeForTesting / 2, &server_hash_d1,
+                                     base::Time::Now()));
+  sdch_owner().OnDictionaryUsed(server_hash_d1);
+  test_clock->Advance(base::TimeDelta::FromHours(47));
+
+  // Add a never-used dictionary that went stale more recently than
+  // |server_hash_d1| was last used.
+  EXPECT_TRUE(CreateAndAddDictionary(
+      kMaxSizeForTesting / 4, &server_hash_d2,
+      test_clock->Now() - base::TimeDelta::FromHours(2)));
+
+  EXPECT_TRUE(DictionaryPresentInManager(server_hash_d1));
+  EXPECT_TRUE(DictionaryPresentInManager(server_hash_d2));
+
+  // The addition of a new dictionary should evict the never-used
+  // dictionary, even though the used one is older.
+  std::string server_hash_d3;
+  EXPECT_TRUE(CreateAndAddDictionary(kMaxSizeForTesting / 2, &server_hash_d3,
+                                     test_clock->Now()));
+  EXPECT_TRUE(DictionaryPresentInManager(server_hash_d1));
+  EXPECT_FALSE(DictionaryPresentInManager(server_hash_d2));
+  EXPECT_TRUE(DictionaryPresentInManager(server_hash_d3));
+}
+
 // Confirm using a dictionary can prevent the addition of a new dictionary.
 TEST_F(SdchOwnerTest, UsePreventsAddition) {
   std::string server_hash_d1;
@@ -902,6 +937,59 @@ TEST_F(SdchOwnerPersistenceTest, LoadingDictionaryMerges) {
   EXPECT_EQ(2, owner_->GetDictionaryCountForTesting());
 }
 
+// Confirm that a persisted dictionary that went stale without ever being
+// used is not reloaded.
+TEST_F(SdchOwnerPersistenceTest, ReloadSkipsUnusedStaleDictionary) {
+  const GURL url0("http://www.example.com/dict0");
+  const GURL url1("http://www.example.com/dict1");
+  ResetOwner(false);
+  InsertDictionaryForURL(url0, "0");
+  InsertDictionaryForURL(url1, "1");
+
+  // Mark the second dictionary as never used and long stale.
+  ClearOwner();
+  base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(GetDictionaryForURL(pref_store_.get(), url1, nullptr, &dict));
+  dict->SetInteger("use_count", 0);
+  dict->SetDouble("last_used",
+                  (base::Time::Now() - base::TimeDelta::FromHours(48))
+                      .ToDoubleT());
+
+  ResetOwner(false);
+  EXPECT_TRUE(CompleteLoadFromURL(url0, "0", true));
+  EXPECT_FALSE(CompleteLoadFromURL(url1, "1", true));
+  EXPECT_EQ(1, owner_->GetDictionaryCountForTesting());
+  EXPECT_TRUE(owner_->HasDictionaryFromURLForTesting(url0));
+  EXPECT_FALSE(owner_->HasDictionaryFromURLForTesting(url1));
+}
+
+// Confirm that reloads stop once the memory budget is filled, and that the
+// budget goes to the most-used dictionary.
+TEST_F(SdchOwnerPersistenceTest, ReloadRespectsBudget) {
+  const GURL url0("http://www.example.com/dict0");
+  const GURL url1("http://www.example.com/dict1");
+  ResetOwner(false);
+  InsertDictionaryForURL(url0, "0");
+  InsertDictionaryForURL(url1, "1");
+
+  // Make the first dictionary the better earner.
+  ClearOwner();
+  base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(GetDictionaryForURL(pref_store_.get(), url0, nullptr, &dict));
+  dict->SetInteger("use_count", 2);
+
+  // Leave room for only one dictionary.
+  ResetOwner(true);
+  owner_->SetMaxTotalDictionarySize(CreateDictionary(url0, "0").size());
+  owner_->EnablePersistentStorage(pref_store_.get());
+
+  EXPECT_TRUE(CompleteLoadFromURL(url0, "0", true));
+  EXPECT_FALSE(CompleteLoadFromURL(url1, "1", true));
+  EXPECT_EQ(1, owner_->GetDictionaryCountForTesting());
+  EXPECT_TRUE(owner_->HasDictionaryFromURLForTesting(url0));
+  EXPECT_FALSE(owner_->HasDictionaryFromURLForTesting(url1));
+}
+
 TEST_F(SdchOwnerPersistenceTest, PersistenceMetrics) {
   const GURL url0("http://www.example.com/dict0");
   const GURL url1("http://www.example.com/dict1");
@@ -106,19 +106,32 @@ bool HttpConnection::QueuedWriteIOBuffer::Append(const std::string& data) {
   if (data.empty())
     return true;
 
-  if (total_size_ + static_cast<int>(data.size()) > max_buffer_size_) {
+  scoped_ptr<std::string> owned_data(new std::string(data));
+  int size = owned_data->size();
+  return Append(make_scoped_refptr(new StringIOBuffer(owned_data.Pass())),
+                size);
+}
+
+bool HttpConnection::QueuedWriteIOBuffer::Append(
+    const scoped_refptr<IOBuffer>& buffer,
+    int size) {
+  DCHECK_GE(size, 0);
+  if (size == 0)
+    return true;
+
+  if (total_size_ + size > max_buffer_size_) {
     LOG(ERROR) << "Too large write data is pending: size="
-               << total_size_ + data.size()
+               << total_size_ + size
                << ", max_buffer_size=" << max_buffer_size_;
     return false;
   }
 
-  pending_data_.push(data);
-  total_size_ += data.size();
+  pending_data_.push_back(new DrainableIOBuffer(buffer.get(), size));
+  total_size_ += size;
 
   // If new data is the first pending data, updates data_.
   if (pending_data_.size() == 1)
-    data_ = const_cast<char*>(pending_data_.front().data());
+    data_ = pending_data_.front()->data();
   return true;
 }
 
@@ -128,12 +141,11 @@ void HttpConnection::QueuedWriteIOBuffer::DidConsume(int size) {
   if (size == 0)
     return;
 
-  if (size < GetSizeToWrite()) {
-    data_ += size;
-  } else {  // size == GetSizeToWrite(). Updates data_ to next pending data.
-    pending_data_.pop();
-    data_ = IsEmpty() ? NULL : const_cast<char*>(pending_data_.front().data());
-  }
+  DrainableIOBuffer* front = pending_data_.front().get();
+  front->DidConsume(size);
+  if (front->BytesRemaining() == 0)
+    pending_data_.pop_front();
+  data_ = IsEmpty() ? NULL : pending_data_.front()->data();
   total_size_ -= size;
 }
 
@@ -142,10 +154,7 @@ int HttpConnection::QueuedWriteIOBuffer::GetSizeToWrite() const {
     DCHECK_EQ(0, total_size_);
     return 0;
   }
-  DCHECK_GE(data_, pending_data_.front().data());
-  int consumed = static_cast<int>(data_ - pending_data_.front().data());
-  DCHECK_GT(static_cast<int>(pending_data_.front().size()), consumed);
-  return pending_data_.front().size() - consumed;
+  return pending_data_.front()->BytesRemaining();
 }
 
 HttpConnection::HttpConnection(int id, scoped_ptr<StreamSocket> socket)
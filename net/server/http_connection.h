@@ -5,7 +5,7 @@
 #ifndef NET_SERVER_HTTP_CONNECTION_H_
 #define NET_SERVER_HTTP_CONNECTION_H_
 
-#include <queue>
+#include <deque>
 #include <string>
 
 #include "base/basictypes.h"
@@ -67,9 +67,10 @@ class HttpConnection {
     DISALLOW_COPY_AND_ASSIGN(ReadIOBuffer);
   };
 
-  // IOBuffer of pending data to write which has a queue of pending data. Each
-  // pending data is stored in std::string.  data() is the data of first
-  // std::string stored.
+  // IOBuffer of pending data to write which has a deque of pending data
+  // segments.  Each segment is a refcounted IOBuffer slice, so appending an
+  // IOBuffer does not copy the payload.  data() is the unconsumed part of the
+  // first segment.
   class QueuedWriteIOBuffer : public IOBuffer {
    public:
     static const int kDefaultMaxBufferSize = 1 * 1024 * 1024;  // 1 Mbytes.
@@ -81,9 +82,15 @@ class HttpConnection {
 
     // Appends new pending data and returns true if total size doesn't exceed
     // the limit, |total_size_limit_|.  It would change data() if new data is
-    // the first pending data.
+    // the first pending data.  This copies |data| once, into an internal
+    // segment.
     bool Append(const std::string& data);
 
+    // Same as above, but takes a reference to the first |size| bytes of
+    // |buffer| without copying them.  The caller must not mutate the buffer
+    // contents until they have been consumed.
+    bool Append(const scoped_refptr<IOBuffer>& buffer, int size);
+
     // Consumes data and changes data() accordingly.  It cannot be more than
     // GetSizeToWrite().
     void DidConsume(int size);
@@ -103,7 +110,7 @@ class HttpConnection {
    private:
     ~QueuedWriteIOBuffer() override;
 
-    std::queue<std::string> pending_data_;
+    std::deque<scoped_refptr<DrainableIOBuffer> > pending_data_;
     int total_size_;
     int max_buffer_size_;
 
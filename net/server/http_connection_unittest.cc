@@ -287,6 +287,32 @@ TEST(HttpConnectionTest, QueuedWriteIOBuffer_Append_DidConsume) {
   EXPECT_EQ(0, buffer->total_size());
 }
 
+TEST(HttpConnectionTest, QueuedWriteIOBuffer_Append_IOBuffer) {
+  scoped_refptr<HttpConnection::QueuedWriteIOBuffer> buffer(
+      new HttpConnection::QueuedWriteIOBuffer());
+
+  // Appending an IOBuffer takes a reference to it instead of copying it, so
+  // the first data to write aliases the appended buffer.
+  const std::string kData("data to write");
+  scoped_refptr<StringIOBuffer> io_buffer(new StringIOBuffer(kData));
+  EXPECT_TRUE(buffer->Append(io_buffer, io_buffer->size()));
+  EXPECT_FALSE(buffer->IsEmpty());
+  EXPECT_EQ(io_buffer->size(), buffer->GetSizeToWrite());
+  EXPECT_EQ(io_buffer->size(), buffer->total_size());
+  EXPECT_EQ(io_buffer->data(), buffer->data());
+
+  // Partial consumption advances within the same buffer.
+  const int kConsumedLength = 5;
+  buffer->DidConsume(kConsumedLength);
+  EXPECT_EQ(io_buffer->data() + kConsumedLength, buffer->data());
+  EXPECT_EQ(io_buffer->size() - kConsumedLength, buffer->GetSizeToWrite());
+
+  // Consume the rest.
+  buffer->DidConsume(io_buffer->size() - kConsumedLength);
+  EXPECT_TRUE(buffer->IsEmpty());
+  EXPECT_EQ(0, buffer->total_size());
+}
+
 TEST(HttpConnectionTest, QueuedWriteIOBuffer_TotalSizeLimit) {
   scoped_refptr<HttpConnection::QueuedWriteIOBuffer> buffer(
       new HttpConnection::QueuedWriteIOBuffer());
@@ -4,6 +4,7 @@
 
 #include "net/server/http_server.h"
 
+#include "base/atomic_sequence_num.h"
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/location.h"
@@ -27,11 +28,19 @@
 
 namespace net {
 
+namespace {
+
+// Source of connection ids.  A lock-free process-wide counter rather than a
+// per-server one, so that ids stay unique across a group of servers sharing
+// one port from several threads.
+base::StaticAtomicSequenceNumber g_next_connection_id;
+
+}  // namespace
+
 HttpServer::HttpServer(scoped_ptr<ServerSocket> server_socket,
                        HttpServer::Delegate* delegate)
     : server_socket_(server_socket.Pass()),
       delegate_(delegate),
-      last_id_(0),
       weak_ptr_factory_(this) {
   DCHECK(server_socket_);
   // Start accepting connections in next run loop in case when delegate is not
@@ -159,7 +168,8 @@ int HttpServer::HandleAcceptResult(int rv) {
   }
 
   HttpConnection* connection =
-      new HttpConnection(++last_id_, accepted_socket_.Pass());
+      new HttpConnection(g_next_connection_id.GetNext() + 1,
+                         accepted_socket_.Pass());
   id_to_connection_[connection->id()] = connection;
   delegate_->OnConnect(connection->id());
   if (!HasClosedConnection(connection))
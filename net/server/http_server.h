@@ -5,10 +5,10 @@
 #ifndef NET_SERVER_HTTP_SERVER_H_
 #define NET_SERVER_HTTP_SERVER_H_
 
-#include <map>
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/macros.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
@@ -46,6 +46,15 @@ class HttpServer {
   // listening, but not accepting.  This constructor schedules accepting
   // connections asynchronously in case when |delegate| is not ready to get
   // callbacks yet.
+  //
+  // Each HttpServer is single-threaded.  To scale to many concurrent
+  // connections, create one HttpServer per worker thread, each with its own
+  // TCPServerSocket on which AllowPortSharing() was called before Listen();
+  // the kernel then balances incoming connections across the listeners.
+  // Every server keeps its own connection table, and connection ids are
+  // allocated from a process-wide atomic counter, so they are unique across
+  // the whole group and a shared Delegate can use them as keys (its methods
+  // are still invoked on the thread owning the accepting server).
   HttpServer(scoped_ptr<ServerSocket> server_socket,
              HttpServer::Delegate* delegate);
   ~HttpServer();
@@ -80,7 +89,7 @@ class HttpServer {
  private:
   friend class HttpServerTest;
 
-  typedef std::map<int, HttpConnection*> IdToConnectionMap;
+  typedef base::hash_map<int, HttpConnection*> IdToConnectionMap;
 
   void DoAcceptLoop();
   void OnAcceptCompleted(int rv);
@@ -111,7 +120,6 @@ class HttpServer {
   scoped_ptr<StreamSocket> accepted_socket_;
   HttpServer::Delegate* const delegate_;
 
-  int last_id_;
   IdToConnectionMap id_to_connection_;
 
   base::WeakPtrFactory<HttpServer> weak_ptr_factory_;
@@ -8,6 +8,7 @@
 #include "base/bind_helpers.h"
 #include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/socket/client_socket_pool.h"
 
@@ -57,6 +58,7 @@ void ClientSocketHandle::ResetInternal(bool cancel) {
   }
   is_initialized_ = false;
   socket_.reset();
+  http_read_buf_ = NULL;
   group_name_.clear();
   reuse_type_ = ClientSocketHandle::UNUSED;
   user_callback_.Reset();
@@ -77,6 +79,17 @@ void ClientSocketHandle::ResetErrorState() {
   pending_http_proxy_connection_.reset();
 }
 
+void ClientSocketHandle::SetPriority(RequestPriority priority) {
+  if (socket_) {
+    // The priority of the handle is no longer relevant to the socket pool;
+    // just return.
+    return;
+  }
+
+  if (pool_)
+    pool_->SetPriority(group_name_, this, priority);
+}
+
 LoadState ClientSocketHandle::GetLoadState() const {
   CHECK(!is_initialized());
   CHECK(!group_name_.empty());
@@ -137,6 +150,17 @@ void ClientSocketHandle::SetSocket(scoped_ptr<StreamSocket> s) {
   socket_ = s.Pass();
 }
 
+void ClientSocketHandle::set_http_read_buf(
+    const scoped_refptr<GrowableIOBuffer>& read_buf) {
+  http_read_buf_ = read_buf;
+}
+
+scoped_refptr<GrowableIOBuffer> ClientSocketHandle::release_http_read_buf() {
+  scoped_refptr<GrowableIOBuffer> read_buf = http_read_buf_;
+  http_read_buf_ = NULL;
+  return read_buf;
+}
+
 void ClientSocketHandle::OnIOComplete(int result) {
   CompletionCallback callback = user_callback_;
   user_callback_.Reset();
@@ -27,6 +27,8 @@
 
 namespace net {
 
+class GrowableIOBuffer;
+
 // A container for a StreamSocket.
 //
 // The handle's |group_name| uniquely identifies the origin and type of the
@@ -91,6 +93,11 @@ class NET_EXPORT ClientSocketHandle {
   // StreamSocket.
   void Reset();
 
+  // Changes the priority of the pool request associated with this handle.
+  // Only meaningful while the handle is waiting in the pool's queue; does
+  // nothing once a socket has been assigned.
+  void SetPriority(RequestPriority priority);
+
   // Used after Init() is called, but before the ClientSocketPool has
   // initialized the ClientSocketHandle.
   LoadState GetLoadState() const;
@@ -145,6 +152,11 @@ class NET_EXPORT ClientSocketHandle {
   void set_connection_attempts(const ConnectionAttempts& attempts) {
     connection_attempts_ = attempts;
   }
+  // Deposits a read buffer for reuse by the next HTTP/1.x stream created on
+  // this handle, e.g. when renewing a stream for authentication. See
+  // HttpBasicState. The buffer is dropped when the handle is reset, since it
+  // is only meaningful for the current socket.
+  void set_http_read_buf(const scoped_refptr<GrowableIOBuffer>& read_buf);
 
   // Only valid if there is no |socket_|.
   bool is_ssl_error() const {
@@ -161,6 +173,11 @@ class NET_EXPORT ClientSocketHandle {
   ClientSocketHandle* release_pending_http_proxy_connection() {
     return pending_http_proxy_connection_.release();
   }
+  // Relinquishes the read buffer deposited by the previous stream on this
+  // connection, or NULL if there is none. Any data in the buffer was read
+  // from the socket past the end of the previous response and belongs to the
+  // new owner.
+  scoped_refptr<GrowableIOBuffer> release_http_read_buf();
   // If the connection failed, returns the connection attempts made. (If it
   // succeeded, they will be returned through the socket instead; see
   // |StreamSocket::GetConnectionAttempts|.)
@@ -217,6 +234,7 @@ class NET_EXPORT ClientSocketHandle {
   HttpResponseInfo ssl_error_response_info_;
   SSLFailureState ssl_failure_state_;
   scoped_ptr<ClientSocketHandle> pending_http_proxy_connection_;
+  scoped_refptr<GrowableIOBuffer> http_read_buf_;
   std::vector<ConnectionAttempt> connection_attempts_;
   base::TimeTicks init_time_;
   base::TimeDelta setup_time_;
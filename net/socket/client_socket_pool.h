@@ -126,6 +126,15 @@ class NET_EXPORT ClientSocketPool : public LowerLayeredPool {
   virtual void CancelRequest(const std::string& group_name,
                              ClientSocketHandle* handle) = 0;
 
+  // Called to change the priority of a RequestSocket call that returned
+  // ERR_IO_PENDING and has not been granted a socket yet.  The same handle
+  // parameter must be passed to this method as was passed to the
+  // RequestSocket call being modified.  This function is a no-op if |handle|
+  // is not currently queued in the pool.
+  virtual void SetPriority(const std::string& group_name,
+                           ClientSocketHandle* handle,
+                           RequestPriority priority) = 0;
+
   // Called to release a socket once the socket is no longer needed.  If the
   // socket still has an established connection, then it will be added to the
   // set of idle sockets to be used to satisfy future RequestSocket calls.
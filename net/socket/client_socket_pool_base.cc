@@ -10,6 +10,7 @@
 #include "base/format_macros.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
@@ -136,6 +137,22 @@ void ConnectJob::OnTimeout() {
 
 namespace internal {
 
+namespace {
+
+// Records how long |request| spent queued in the pool before being granted
+// a socket (or failing), split by whether it was interactive-priority.
+void RecordQueueTime(const ClientSocketPoolBaseHelper::Request& request) {
+  base::TimeDelta queue_time = base::TimeTicks::Now() - request.submit_time();
+  UMA_HISTOGRAM_TIMES("Net.SocketPool.QueueTime", queue_time);
+  if (request.priority() >= MEDIUM) {
+    UMA_HISTOGRAM_TIMES("Net.SocketPool.QueueTime.HighPriority", queue_time);
+  } else {
+    UMA_HISTOGRAM_TIMES("Net.SocketPool.QueueTime.LowPriority", queue_time);
+  }
+}
+
+}  // namespace
+
 ClientSocketPoolBaseHelper::Request::Request(
     ClientSocketHandle* handle,
     const CompletionCallback& callback,
@@ -148,7 +165,8 @@ ClientSocketPoolBaseHelper::Request::Request(
       priority_(priority),
       ignore_limits_(ignore_limits),
       flags_(flags),
-      net_log_(net_log) {
+      net_log_(net_log),
+      submit_time_(base::TimeTicks::Now()) {
   if (ignore_limits_)
     DCHECK_EQ(priority_, MAXIMUM_PRIORITY);
 }
@@ -454,36 +472,30 @@ int ClientSocketPoolBaseHelper::RequestSocketInternal(
 bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
     const Request& request, Group* group) {
   std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
-  std::list<IdleSocket>::iterator idle_socket_it = idle_sockets->end();
-
-  // Iterate through the idle sockets forwards (oldest to newest)
-  //   * Delete any disconnected ones.
-  //   * If we find a used idle socket, assign to |idle_socket|.  At the end,
-  //   the |idle_socket_it| will be set to the newest used idle socket.
-  for (std::list<IdleSocket>::iterator it = idle_sockets->begin();
-       it != idle_sockets->end();) {
-    if (!it->IsUsable()) {
-      DecrementIdleCount();
-      delete it->socket;
-      it = idle_sockets->erase(it);
-      continue;
-    }
 
-    if (it->socket->WasEverUsed()) {
-      // We found one we can reuse!
-      idle_socket_it = it;
+  // Pick a candidate without probing the whole list: prefer the newest used
+  // idle socket (most recently released, most likely still alive), falling
+  // back to the oldest unused one (FIFO). Only the candidate is checked with
+  // IsUsable(); a stale candidate is closed and the next one tried. Sockets
+  // that went stale while idle are swept in batch by the cleanup timer, so
+  // the request path usually probes exactly once.
+  while (!idle_sockets->empty()) {
+    std::list<IdleSocket>::iterator idle_socket_it = idle_sockets->end();
+    for (std::list<IdleSocket>::iterator it = idle_sockets->begin();
+         it != idle_sockets->end(); ++it) {
+      if (it->socket->WasEverUsed())
+        idle_socket_it = it;
     }
+    if (idle_socket_it == idle_sockets->end())
+      idle_socket_it = idle_sockets->begin();
 
-    ++it;
-  }
-
-  // If we haven't found an idle socket, that means there are no used idle
-  // sockets.  Pick the oldest (first) idle socket (FIFO).
-
-  if (idle_socket_it == idle_sockets->end() && !idle_sockets->empty())
-    idle_socket_it = idle_sockets->begin();
+    if (!idle_socket_it->IsUsable()) {
+      DecrementIdleCount();
+      delete idle_socket_it->socket;
+      idle_sockets->erase(idle_socket_it);
+      continue;
+    }
 
-  if (idle_socket_it != idle_sockets->end()) {
     DecrementIdleCount();
     base::TimeDelta idle_time =
         base::TimeTicks::Now() - idle_socket_it->start_time;
@@ -559,6 +571,18 @@ void ClientSocketPoolBaseHelper::CancelRequest(
   }
 }
 
+void ClientSocketPoolBaseHelper::SetPriority(const std::string& group_name,
+                                             ClientSocketHandle* handle,
+                                             RequestPriority priority) {
+  GroupMap::iterator group_it = group_map_.find(group_name);
+  if (group_it == group_map_.end()) {
+    // The request was already granted a socket and the group has gone away;
+    // in-flight and established connections keep their original priority.
+    return;
+  }
+  group_it->second->SetPendingRequestPriority(handle, priority);
+}
+
 bool ClientSocketPoolBaseHelper::HasGroup(const std::string& group_name) const {
   return ContainsKey(group_map_, group_name);
 }
@@ -905,6 +929,7 @@ void ClientSocketPoolBaseHelper::OnConnectJobComplete(
           socket.Pass(), ClientSocketHandle::UNUSED, connect_timing,
           request->handle(), base::TimeDelta(), group, request->net_log());
       request->net_log().EndEvent(NetLog::TYPE_SOCKET_POOL);
+      RecordQueueTime(*request);
       InvokeUserCallbackLater(request->handle(), request->callback(), result);
     } else {
       AddIdleSocket(socket.Pass(), group);
@@ -928,6 +953,7 @@ void ClientSocketPoolBaseHelper::OnConnectJobComplete(
       }
       request->net_log().EndEventWithNetErrorCode(
           NetLog::TYPE_SOCKET_POOL, result);
+      RecordQueueTime(*request);
       InvokeUserCallbackLater(request->handle(), request->callback(), result);
     } else {
       RemoveConnectJob(job, group);
@@ -990,6 +1016,7 @@ void ClientSocketPoolBaseHelper::ProcessPendingRequest(
       RemoveGroup(group_name);
 
     request->net_log().EndEventWithNetErrorCode(NetLog::TYPE_SOCKET_POOL, rv);
+    RecordQueueTime(*request);
     InvokeUserCallbackLater(request->handle(), request->callback(), rv);
   }
 }
@@ -1010,10 +1037,9 @@ void ClientSocketPoolBaseHelper::HandOutSocket(
   handle->set_connect_timing(connect_timing);
 
   if (handle->is_reused()) {
-    net_log.AddEvent(
-        NetLog::TYPE_SOCKET_POOL_REUSED_AN_EXISTING_SOCKET,
-        NetLog::IntCallback("idle_ms",
-                            static_cast<int>(idle_time.InMilliseconds())));
+    net_log.AddEventWithIntParams(
+        NetLog::TYPE_SOCKET_POOL_REUSED_AN_EXISTING_SOCKET, "idle_ms",
+        static_cast<int>(idle_time.InMilliseconds()));
   }
 
   net_log.AddEvent(
@@ -1299,17 +1325,22 @@ bool ClientSocketPoolBaseHelper::Group::HasConnectJobForHandle(
 
 void ClientSocketPoolBaseHelper::Group::InsertPendingRequest(
     scoped_ptr<const Request> request) {
-  // This value must be cached before we release |request|.
+  // These values must be cached before we release |request|.
   RequestPriority priority = request->priority();
+  const ClientSocketHandle* handle = request->handle();
+  // A handle can have at most one request pending per group.
+  DCHECK(!ContainsKey(pending_request_pointers_, handle));
+  RequestQueue::Pointer pointer;
   if (request->ignore_limits()) {
     // Put requests with ignore_limits == true (which should have
     // priority == MAXIMUM_PRIORITY) ahead of other requests with
     // MAXIMUM_PRIORITY.
     DCHECK_EQ(priority, MAXIMUM_PRIORITY);
-    pending_requests_.InsertAtFront(request.release(), priority);
+    pointer = pending_requests_.InsertAtFront(request.release(), priority);
   } else {
-    pending_requests_.Insert(request.release(), priority);
+    pointer = pending_requests_.Insert(request.release(), priority);
   }
+  pending_request_pointers_[handle] = pointer;
 }
 
 scoped_ptr<const ClientSocketPoolBaseHelper::Request>
@@ -1322,15 +1353,33 @@ ClientSocketPoolBaseHelper::Group::PopNextPendingRequest() {
 scoped_ptr<const ClientSocketPoolBaseHelper::Request>
 ClientSocketPoolBaseHelper::Group::FindAndRemovePendingRequest(
     ClientSocketHandle* handle) {
-  for (RequestQueue::Pointer pointer = pending_requests_.FirstMax();
-       !pointer.is_null();
-       pointer = pending_requests_.GetNextTowardsLastMin(pointer)) {
-    if (pointer.value()->handle() == handle) {
-      scoped_ptr<const Request> request = RemovePendingRequest(pointer);
-      return request.Pass();
-    }
+  PendingRequestPointerMap::const_iterator it =
+      pending_request_pointers_.find(handle);
+  if (it == pending_request_pointers_.end())
+    return scoped_ptr<const ClientSocketPoolBaseHelper::Request>();
+  // Copied because RemovePendingRequest() erases the map entry.
+  RequestQueue::Pointer pointer = it->second;
+  return RemovePendingRequest(pointer);
+}
+
+void ClientSocketPoolBaseHelper::Group::SetPendingRequestPriority(
+    ClientSocketHandle* handle,
+    RequestPriority priority) {
+  PendingRequestPointerMap::iterator it =
+      pending_request_pointers_.find(handle);
+  if (it == pending_request_pointers_.end())
+    return;
+  RequestQueue::Pointer pointer = it->second;
+  // Requests with ignore_limits were inserted at the front of the queue and
+  // must stay there; see InsertPendingRequest().
+  if (pointer.value()->priority() == priority ||
+      pointer.value()->ignore_limits()) {
+    return;
   }
-  return scoped_ptr<const ClientSocketPoolBaseHelper::Request>();
+  scoped_ptr<Request> request(const_cast<Request*>(pointer.value()));
+  pending_requests_.Erase(pointer);
+  request->set_priority(priority);
+  it->second = pending_requests_.Insert(request.release(), priority);
 }
 
 scoped_ptr<const ClientSocketPoolBaseHelper::Request>
@@ -1340,6 +1389,7 @@ ClientSocketPoolBaseHelper::Group::RemovePendingRequest(
   CHECK(!pointer.is_null());
   scoped_ptr<const Request> request(pointer.value());
   pending_requests_.Erase(pointer);
+  pending_request_pointers_.erase(request->handle());
   // If there are no more requests, kill the backup timer.
   if (pending_requests_.empty())
     backup_job_timer_.Stop();
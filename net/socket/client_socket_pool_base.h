@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
@@ -179,9 +180,13 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     ClientSocketHandle* handle() const { return handle_; }
     const CompletionCallback& callback() const { return callback_; }
     RequestPriority priority() const { return priority_; }
+    // May only be called while the request is still queued; the queue
+    // position is maintained by Group::SetPendingRequestPriority().
+    void set_priority(RequestPriority priority) { priority_ = priority; }
     bool ignore_limits() const { return ignore_limits_; }
     Flags flags() const { return flags_; }
     const BoundNetLog& net_log() const { return net_log_; }
+    base::TimeTicks submit_time() const { return submit_time_; }
 
     // TODO(eroman): Temporary until crbug.com/467797 is solved.
     void CrashIfInvalid() const;
@@ -195,11 +200,13 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
     ClientSocketHandle* const handle_;
     const CompletionCallback callback_;
-    // TODO(akalin): Support reprioritization.
-    const RequestPriority priority_;
+    RequestPriority priority_;
     const bool ignore_limits_;
     const Flags flags_;
     const BoundNetLog net_log_;
+    // When the request was submitted to the pool; used for queue-time
+    // metrics.
+    const base::TimeTicks submit_time_;
 
     // TODO(eroman): Temporary until crbug.com/467797 is solved.
     Liveness liveness_ = ALIVE;
@@ -258,6 +265,11 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   void CancelRequest(const std::string& group_name,
                      ClientSocketHandle* handle);
 
+  // See ClientSocketPool::SetPriority for documentation on this function.
+  void SetPriority(const std::string& group_name,
+                   ClientSocketHandle* handle,
+                   RequestPriority priority);
+
   // See ClientSocketPool::ReleaseSocket for documentation on this function.
   void ReleaseSocket(const std::string& group_name,
                      scoped_ptr<StreamSocket> socket,
@@ -457,6 +469,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     scoped_ptr<const Request> FindAndRemovePendingRequest(
         ClientSocketHandle* handle);
 
+    // Changes the priority of the pending request for |handle|, if any,
+    // and moves it to its new position in the queue.  Requests with
+    // ignore_limits set keep their place at the front of the queue.
+    void SetPendingRequestPriority(ClientSocketHandle* handle,
+                                   RequestPriority priority);
+
     void IncrementActiveSocketCount() { active_socket_count_++; }
     void DecrementActiveSocketCount() { active_socket_count_--; }
 
@@ -467,6 +485,11 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     std::list<IdleSocket>* mutable_idle_sockets() { return &idle_sockets_; }
 
    private:
+    // Index of pending requests by handle, so that cancellation does not
+    // scan the queue. A Pointer stays valid until its request is erased.
+    typedef base::hash_map<const ClientSocketHandle*, RequestQueue::Pointer>
+        PendingRequestPointerMap;
+
     // Returns the iterator's pending request after removing it from
     // the queue.
     scoped_ptr<const Request> RemovePendingRequest(
@@ -492,12 +515,15 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     std::list<IdleSocket> idle_sockets_;
     std::list<ConnectJob*> jobs_;
     RequestQueue pending_requests_;
+    PendingRequestPointerMap pending_request_pointers_;
     int active_socket_count_;  // number of active sockets used by clients
     // A timer for when to start the backup job.
     base::OneShotTimer backup_job_timer_;
   };
 
-  typedef std::map<std::string, Group*> GroupMap;
+  // Hashed so that the group lookup on every stream start stays O(1) as the
+  // number of groups grows.
+  typedef base::hash_map<std::string, Group*> GroupMap;
 
   typedef std::set<ConnectJob*> ConnectJobSet;
 
@@ -775,6 +801,12 @@ class ClientSocketPoolBase {
     return helper_.CancelRequest(group_name, handle);
   }
 
+  void SetPriority(const std::string& group_name,
+                   ClientSocketHandle* handle,
+                   RequestPriority priority) {
+    helper_.SetPriority(group_name, handle, priority);
+  }
+
   void ReleaseSocket(const std::string& group_name,
                      scoped_ptr<StreamSocket> socket,
                      int id) {
@@ -0,0 +1,26 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/socket.h"
+
+#include "base/logging.h"
+#include "net/base/io_buffer.h"
+
+namespace net {
+
+int Socket::WriteV(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(!buffers.empty());
+  // Transports without scatter/gather support write the first buffer only.
+  // The caller resubmits the rest, exactly as it would after a short write.
+  DrainableIOBuffer* front = buffers.front().get();
+  return Write(front, front->BytesRemaining(), callback);
+}
+
+bool Socket::SupportsGatherWrites() const {
+  return false;
+}
+
+}  // namespace net
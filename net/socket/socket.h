@@ -5,11 +5,15 @@
 #ifndef NET_SOCKET_SOCKET_H_
 #define NET_SOCKET_SOCKET_H_
 
+#include <vector>
+
+#include "base/memory/ref_counted.h"
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 
 namespace net {
 
+class DrainableIOBuffer;
 class IOBuffer;
 
 // Represents a read/write socket.
@@ -46,6 +50,24 @@ class NET_EXPORT Socket {
   virtual int Write(IOBuffer* buf, int buf_len,
                     const CompletionCallback& callback) = 0;
 
+  // Writes the unconsumed portions of |buffers|, in order, to the socket as a
+  // single gather operation when the transport supports it (writev).  The
+  // return value is the total number of bytes written, counted from the front
+  // of the sequence, and the data may be written partially just as with
+  // Write().  Callers should DidConsume() across the sequence and resubmit
+  // whatever remains.  The default implementation writes only the first
+  // buffer, which gives the same semantics without scatter/gather support.
+  virtual int WriteV(const std::vector<scoped_refptr<DrainableIOBuffer>>&
+                         buffers,
+                     const CompletionCallback& callback);
+
+  // Returns true if WriteV() is a native gather write on this socket, rather
+  // than the default first-buffer-only implementation.  Callers that would
+  // otherwise copy several buffers into one before writing should keep doing
+  // so when this returns false, so the data still leaves in a single Write()
+  // (and, for SSL sockets, a single record).
+  virtual bool SupportsGatherWrites() const;
+
   // Set the receive buffer size (in bytes) for the socket.
   // Note: changing this value can affect the TCP window size on some platforms.
   // Returns a net error code.
@@ -7,6 +7,9 @@
 #include <errno.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
 
 #include "base/callback_helpers.h"
 #include "base/logging.h"
@@ -20,6 +23,11 @@ namespace net {
 
 namespace {
 
+// Cap on the number of chunks passed to sendmsg() in one gather write, well
+// below any IOV_MAX. Writing fewer than all buffers is fine: WriteV()
+// callers handle short writes.
+const size_t kMaxWriteVChunks = 64;
+
 int MapAcceptError(int os_error) {
   switch (os_error) {
     // If the client aborts the connection before the server calls accept,
@@ -55,7 +63,9 @@ int MapConnectError(int os_error) {
 
 SocketPosix::SocketPosix()
     : socket_fd_(kInvalidSocket),
+      read_watcher_armed_(false),
       read_buf_len_(0),
+      write_watcher_armed_(false),
       write_buf_len_(0),
       waiting_connect_(false) {}
 
@@ -176,11 +186,14 @@ int SocketPosix::Connect(const SockaddrStorage& address,
   if (rv != ERR_IO_PENDING)
     return rv;
 
-  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_fd_, true, base::MessageLoopForIO::WATCH_WRITE,
-          &write_socket_watcher_, this)) {
-    PLOG(ERROR) << "WatchFileDescriptor failed on connect, errno " << errno;
-    return MapSystemError(errno);
+  if (!write_watcher_armed_) {
+    if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+            socket_fd_, true, base::MessageLoopForIO::WATCH_WRITE,
+            &write_socket_watcher_, this)) {
+      PLOG(ERROR) << "WatchFileDescriptor failed on connect, errno " << errno;
+      return MapSystemError(errno);
+    }
+    write_watcher_armed_ = true;
   }
 
   write_callback_ = callback;
@@ -238,11 +251,14 @@ int SocketPosix::Read(IOBuffer* buf,
   if (rv != ERR_IO_PENDING)
     return rv;
 
-  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_fd_, true, base::MessageLoopForIO::WATCH_READ,
-          &read_socket_watcher_, this)) {
-    PLOG(ERROR) << "WatchFileDescriptor failed on read, errno " << errno;
-    return MapSystemError(errno);
+  if (!read_watcher_armed_) {
+    if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+            socket_fd_, true, base::MessageLoopForIO::WATCH_READ,
+            &read_socket_watcher_, this)) {
+      PLOG(ERROR) << "WatchFileDescriptor failed on read, errno " << errno;
+      return MapSystemError(errno);
+    }
+    read_watcher_armed_ = true;
   }
 
   read_buf_ = buf;
@@ -268,6 +284,39 @@ int SocketPosix::Write(IOBuffer* buf,
   return rv;
 }
 
+int SocketPosix::WriteV(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_fd_);
+  DCHECK(!waiting_connect_);
+  CHECK(write_callback_.is_null());
+  // Synchronous operation not supported
+  DCHECK(!callback.is_null());
+  DCHECK(!buffers.empty());
+
+  write_buf_list_ = buffers;
+  int rv = DoWriteV();
+  if (rv != ERR_IO_PENDING) {
+    write_buf_list_.clear();
+    return rv;
+  }
+
+  if (!write_watcher_armed_) {
+    if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+            socket_fd_, true, base::MessageLoopForIO::WATCH_WRITE,
+            &write_socket_watcher_, this)) {
+      PLOG(ERROR) << "WatchFileDescriptor failed on write, errno " << errno;
+      write_buf_list_.clear();
+      return MapSystemError(errno);
+    }
+    write_watcher_armed_ = true;
+  }
+
+  write_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int SocketPosix::WaitForWrite(IOBuffer* buf,
                               int buf_len,
                               const CompletionCallback& callback) {
@@ -278,11 +327,14 @@ int SocketPosix::WaitForWrite(IOBuffer* buf,
   DCHECK(!callback.is_null());
   DCHECK_LT(0, buf_len);
 
-  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_fd_, true, base::MessageLoopForIO::WATCH_WRITE,
-          &write_socket_watcher_, this)) {
-    PLOG(ERROR) << "WatchFileDescriptor failed on write, errno " << errno;
-    return MapSystemError(errno);
+  if (!write_watcher_armed_) {
+    if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+            socket_fd_, true, base::MessageLoopForIO::WATCH_WRITE,
+            &write_socket_watcher_, this)) {
+      PLOG(ERROR) << "WatchFileDescriptor failed on write, errno " << errno;
+      return MapSystemError(errno);
+    }
+    write_watcher_armed_ = true;
   }
 
   write_buf_ = buf;
@@ -342,24 +394,48 @@ void SocketPosix::Close() {
 }
 
 void SocketPosix::DetachFromThread() {
+  // Watchers may stay registered after an operation completes; they must not
+  // survive a move to another thread's message loop.
+  if (read_watcher_armed_) {
+    bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
+    DCHECK(ok);
+    read_watcher_armed_ = false;
+  }
+  if (write_watcher_armed_) {
+    bool ok = write_socket_watcher_.StopWatchingFileDescriptor();
+    DCHECK(ok);
+    write_watcher_armed_ = false;
+  }
   thread_checker_.DetachFromThread();
 }
 
 void SocketPosix::OnFileCanReadWithoutBlocking(int fd) {
-  DCHECK(!accept_callback_.is_null() || !read_callback_.is_null());
   if (!accept_callback_.is_null()) {
     AcceptCompleted();
-  } else {  // !read_callback_.is_null()
+  } else if (!read_callback_.is_null()) {
     ReadCompleted();
+  } else {
+    // The watcher stays registered across reads to avoid epoll_ctl churn. A
+    // wakeup with no read pending means the caller is not reading right now;
+    // deregister so a readable socket does not spin the message loop.
+    bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
+    DCHECK(ok);
+    read_watcher_armed_ = false;
   }
 }
 
 void SocketPosix::OnFileCanWriteWithoutBlocking(int fd) {
-  DCHECK(!write_callback_.is_null());
   if (waiting_connect_) {
     ConnectCompleted();
-  } else {
+  } else if (!write_callback_.is_null()) {
     WriteCompleted();
+  } else {
+    // See OnFileCanReadWithoutBlocking(). A connected socket is almost always
+    // writable, so deregistering here is what stops the loop from spinning
+    // between writes.
+    bool ok = write_socket_watcher_.StopWatchingFileDescriptor();
+    DCHECK(ok);
+    write_watcher_armed_ = false;
   }
 }
 
@@ -413,8 +489,8 @@ void SocketPosix::ConnectCompleted() {
   if (rv == ERR_IO_PENDING)
     return;
 
-  bool ok = write_socket_watcher_.StopWatchingFileDescriptor();
-  DCHECK(ok);
+  // |write_socket_watcher_| stays registered; the first Write() then needs no
+  // epoll_ctl, and a wakeup with no write pending deregisters it.
   waiting_connect_ = false;
   base::ResetAndReturn(&write_callback_).Run(rv);
 }
@@ -429,8 +505,8 @@ void SocketPosix::ReadCompleted() {
   if (rv == ERR_IO_PENDING)
     return;
 
-  bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
-  DCHECK(ok);
+  // |read_socket_watcher_| stays registered so the next Read() needs no
+  // epoll_ctl when issued before another wakeup arrives.
   read_buf_ = NULL;
   read_buf_len_ = 0;
   base::ResetAndReturn(&read_callback_).Run(rv);
@@ -441,15 +517,30 @@ int SocketPosix::DoWrite(IOBuffer* buf, int buf_len) {
   return rv >= 0 ? rv : MapSystemError(errno);
 }
 
+int SocketPosix::DoWriteV() {
+  struct iovec iov[kMaxWriteVChunks];
+  size_t count = std::min(write_buf_list_.size(), kMaxWriteVChunks);
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = write_buf_list_[i]->data();
+    iov[i].iov_len = write_buf_list_[i]->BytesRemaining();
+  }
+  struct msghdr msg = {};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+  int rv = HANDLE_EINTR(sendmsg(socket_fd_, &msg, 0));
+  return rv >= 0 ? rv : MapSystemError(errno);
+}
+
 void SocketPosix::WriteCompleted() {
-  int rv = DoWrite(write_buf_.get(), write_buf_len_);
+  int rv = write_buf_list_.empty() ? DoWrite(write_buf_.get(), write_buf_len_)
+                                   : DoWriteV();
   if (rv == ERR_IO_PENDING)
     return;
 
-  bool ok = write_socket_watcher_.StopWatchingFileDescriptor();
-  DCHECK(ok);
+  // See ReadCompleted(): the watcher stays registered for the next Write().
   write_buf_ = NULL;
   write_buf_len_ = 0;
+  write_buf_list_.clear();
   base::ResetAndReturn(&write_callback_).Run(rv);
 }
 
@@ -458,8 +549,10 @@ void SocketPosix::StopWatchingAndCleanUp() {
   DCHECK(ok);
   ok = read_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
+  read_watcher_armed_ = false;
   ok = write_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
+  write_watcher_armed_ = false;
 
   if (!accept_callback_.is_null()) {
     accept_socket_ = NULL;
@@ -475,6 +568,7 @@ void SocketPosix::StopWatchingAndCleanUp() {
   if (!write_callback_.is_null()) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
+    write_buf_list_.clear();
     write_callback_.Reset();
   }
 
@@ -5,6 +5,8 @@
 #ifndef NET_SOCKET_SOCKET_POSIX_H_
 #define NET_SOCKET_SOCKET_POSIX_H_
 
+#include <vector>
+
 #include "base/compiler_specific.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -16,6 +18,7 @@
 
 namespace net {
 
+class DrainableIOBuffer;
 class IOBuffer;
 class IPEndPoint;
 struct SockaddrStorage;
@@ -60,6 +63,13 @@ class NET_EXPORT_PRIVATE SocketPosix : public base::MessageLoopForIO::Watcher {
   int Read(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
   int Write(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
 
+  // Writes the unconsumed portions of |buffers|, in order, with a single
+  // gather write (sendmsg). Returns the total number of bytes written,
+  // which may cover only a prefix of the sequence; otherwise semantics
+  // match Write().
+  int WriteV(const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+             const CompletionCallback& callback);
+
   // Waits for next write event. This is called by TCPSocketPosix for TCP
   // fastopen after sending first data. Returns ERR_IO_PENDING if it starts
   // waiting for write event successfully. Otherwise, returns a net error code.
@@ -97,6 +107,7 @@ class NET_EXPORT_PRIVATE SocketPosix : public base::MessageLoopForIO::Watcher {
   void ReadCompleted();
 
   int DoWrite(IOBuffer* buf, int buf_len);
+  int DoWriteV();
   void WriteCompleted();
 
   void StopWatchingAndCleanUp();
@@ -108,14 +119,23 @@ class NET_EXPORT_PRIVATE SocketPosix : public base::MessageLoopForIO::Watcher {
   CompletionCallback accept_callback_;
 
   base::MessageLoopForIO::FileDescriptorWatcher read_socket_watcher_;
+  // Whether |read_socket_watcher_| is registered with the message loop. The
+  // watcher stays registered after a read completes so that back-to-back
+  // reads do not re-register (epoll_ctl) per operation; a wakeup that finds
+  // no read pending deregisters it.
+  bool read_watcher_armed_;
   scoped_refptr<IOBuffer> read_buf_;
   int read_buf_len_;
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
   base::MessageLoopForIO::FileDescriptorWatcher write_socket_watcher_;
+  // Same as |read_watcher_armed_|, for |write_socket_watcher_|.
+  bool write_watcher_armed_;
   scoped_refptr<IOBuffer> write_buf_;
   int write_buf_len_;
+  // Non-empty while a WriteV() is pending; |write_buf_| is unused then.
+  std::vector<scoped_refptr<DrainableIOBuffer>> write_buf_list_;
   // External callback; called when write or connect is complete.
   CompletionCallback write_callback_;
 
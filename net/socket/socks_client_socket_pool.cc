@@ -238,6 +238,12 @@ void SOCKSClientSocketPool::CancelRequest(const std::string& group_name,
   base_.CancelRequest(group_name, handle);
 }
 
+void SOCKSClientSocketPool::SetPriority(const std::string& group_name,
+                                        ClientSocketHandle* handle,
+                                        RequestPriority priority) {
+  base_.SetPriority(group_name, handle, priority);
+}
+
 void SOCKSClientSocketPool::ReleaseSocket(const std::string& group_name,
                                           scoped_ptr<StreamSocket> socket,
                                           int id) {
@@ -132,6 +132,9 @@ class NET_EXPORT_PRIVATE SOCKSClientSocketPool
 
   void CancelRequest(const std::string& group_name,
                      ClientSocketHandle* handle) override;
+  void SetPriority(const std::string& group_name,
+                   ClientSocketHandle* handle,
+                   RequestPriority priority) override;
 
   void ReleaseSocket(const std::string& group_name,
                      scoped_ptr<StreamSocket> socket,
@@ -18,6 +18,7 @@
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/hash.h"
 #include "base/lazy_instance.h"
 #include "base/memory/singleton.h"
 #include "base/metrics/histogram_macros.h"
@@ -191,7 +192,21 @@ class SSLClientSocketOpenSSL::SSLContext {
     return base::Singleton<SSLContext>::get();
   }
   SSL_CTX* ssl_ctx() { return ssl_ctx_.get(); }
-  SSLClientSessionCacheOpenSSL* session_cache() { return &session_cache_; }
+
+  // Returns the session cache shard for |cache_key|. The session cache is
+  // shared by every SSLClientSocketOpenSSL in the process, so it is split
+  // into independently locked shards to keep concurrent handshakes on
+  // different threads from serializing on a single lock.
+  SSLClientSessionCacheOpenSSL* session_cache(const std::string& cache_key) {
+    return session_caches_[base::Hash(cache_key) % kNumSessionCacheShards]
+        .get();
+  }
+
+  // Removes all entries from every session cache shard.
+  void FlushSessionCache() {
+    for (size_t i = 0; i < kNumSessionCacheShards; i++)
+      session_caches_[i]->Flush();
+  }
 
   SSLClientSocketOpenSSL* GetClientSocketFromSSL(const SSL* ssl) {
     DCHECK(ssl);
@@ -220,7 +235,13 @@ class SSLClientSocketOpenSSL::SSLContext {
  private:
   friend struct base::DefaultSingletonTraits<SSLContext>;
 
-  SSLContext() : session_cache_(SSLClientSessionCacheOpenSSL::Config()) {
+  SSLContext() {
+    SSLClientSessionCacheOpenSSL::Config session_cache_config;
+    session_cache_config.max_entries /= kNumSessionCacheShards;
+    for (size_t i = 0; i < kNumSessionCacheShards; i++) {
+      session_caches_[i].reset(
+          new SSLClientSessionCacheOpenSSL(session_cache_config));
+    }
     crypto::EnsureOpenSSLInit();
     ssl_socket_data_index_ = SSL_get_ex_new_index(0, 0, 0, 0, 0);
     DCHECK_NE(ssl_socket_data_index_, -1);
@@ -360,12 +381,18 @@ class SSLClientSocketOpenSSL::SSLContext {
   scoped_ptr<SSLKeyLogger> ssl_key_logger_;
 #endif
 
+  // The number of session cache shards. Shards are selected by a hash of
+  // the session cache key, so the sharding is invisible to lookups; it only
+  // bounds lock contention between concurrent handshakes.
+  static const size_t kNumSessionCacheShards = 8;
+
   // TODO(davidben): Use a separate cache per URLRequestContext.
   // https://crbug.com/458365
   //
   // TODO(davidben): Sessions should be invalidated on fatal
   // alerts. https://crbug.com/466352
-  SSLClientSessionCacheOpenSSL session_cache_;
+  scoped_ptr<SSLClientSessionCacheOpenSSL>
+      session_caches_[kNumSessionCacheShards];
 };
 
 const SSL_PRIVATE_KEY_METHOD
@@ -461,7 +488,7 @@ SSLClientSocketOpenSSL::PeerCertificateChain::AsOSChain() const {
 void SSLClientSocket::ClearSessionCache() {
   SSLClientSocketOpenSSL::SSLContext* context =
       SSLClientSocketOpenSSL::SSLContext::GetInstance();
-  context->session_cache()->Flush();
+  context->FlushSessionCache();
 }
 
 SSLClientSocketOpenSSL::SSLClientSocketOpenSSL(
@@ -871,8 +898,9 @@ int SSLClientSocketOpenSSL::Init() {
     return ERR_UNEXPECTED;
   }
 
+  std::string cache_key = GetSessionCacheKey();
   ScopedSSL_SESSION session =
-      context->session_cache()->Lookup(GetSessionCacheKey());
+      context->session_cache(cache_key)->Lookup(cache_key);
   if (session)
     SSL_set_session(ssl_, session.get());
 
@@ -883,6 +911,15 @@ int SSLClientSocketOpenSSL::Init() {
 
   BIO* ssl_bio = NULL;
 
+  // The BIO pair uses |send_buffer_| and |recv_buffer_| as its internal ring
+  // buffers, and BufferSend()/BufferRecv() issue transport I/O directly on
+  // those rings (see BIO_zero_copy_get_read_buf() and
+  // BIO_zero_copy_get_write_buf()). TLS records are therefore staged exactly
+  // once between SSL_read()/SSL_write() and the socket, with no extra copy in
+  // either direction. A BIO that called the StreamSocket directly could not
+  // do better: BIO callbacks are synchronous while the transport is
+  // asynchronous, so a staging buffer of some form is always needed.
+  //
   // SSLClientSocketOpenSSL retains ownership of the BIO buffers.
   if (!BIO_new_bio_pair_external_buf(
           &ssl_bio, send_buffer_->capacity(),
@@ -1890,15 +1927,15 @@ int SSLClientSocketOpenSSL::ClientCertRequestCallback(SSL* ssl) {
     SSL_set_private_key_digest_prefs(ssl_, digests.data(), digests.size());
 
     int cert_count = 1 + sk_X509_num(chain.get());
-    net_log_.AddEvent(NetLog::TYPE_SSL_CLIENT_CERT_PROVIDED,
-                      NetLog::IntCallback("cert_count", cert_count));
+    net_log_.AddEventWithIntParams(NetLog::TYPE_SSL_CLIENT_CERT_PROVIDED,
+                                   "cert_count", cert_count);
     return 1;
   }
 #endif  // defined(OS_IOS)
 
   // Send no client certificate.
-  net_log_.AddEvent(NetLog::TYPE_SSL_CLIENT_CERT_PROVIDED,
-                    NetLog::IntCallback("cert_count", 0));
+  net_log_.AddEventWithIntParams(NetLog::TYPE_SSL_CLIENT_CERT_PROVIDED,
+                                 "cert_count", 0);
   return 1;
 }
 
@@ -2031,8 +2068,9 @@ void SSLClientSocketOpenSSL::MaybeCacheSession() {
   if (!session_pending_ || !certificate_verified_)
     return;
 
-  SSLContext::GetInstance()->session_cache()->Insert(GetSessionCacheKey(),
-                                                     SSL_get_session(ssl_));
+  std::string cache_key = GetSessionCacheKey();
+  SSLContext::GetInstance()->session_cache(cache_key)->Insert(
+      cache_key, SSL_get_session(ssl_));
   session_pending_ = false;
 }
 
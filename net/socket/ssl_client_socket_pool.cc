@@ -605,6 +605,12 @@ void SSLClientSocketPool::CancelRequest(const std::string& group_name,
   base_.CancelRequest(group_name, handle);
 }
 
+void SSLClientSocketPool::SetPriority(const std::string& group_name,
+                                      ClientSocketHandle* handle,
+                                      RequestPriority priority) {
+  base_.SetPriority(group_name, handle, priority);
+}
+
 void SSLClientSocketPool::ReleaseSocket(const std::string& group_name,
                                         scoped_ptr<StreamSocket> socket,
                                         int id) {
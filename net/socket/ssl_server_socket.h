@@ -6,6 +6,7 @@
 #define NET_SOCKET_SSL_SERVER_SOCKET_H_
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
@@ -19,6 +20,7 @@ class RSAPrivateKey;
 namespace net {
 
 struct SSLServerConfig;
+class SSLPrivateKey;
 class X509Certificate;
 
 class SSLServerSocket : public SSLSocket {
@@ -59,6 +61,15 @@ NET_EXPORT scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
     crypto::RSAPrivateKey* key,
     const SSLServerConfig& ssl_config);
 
+// As above, but handshake signatures are computed asynchronously through
+// |key|, so a key backed by a worker pool, smartcard or HSM does not block
+// the network thread while a handshake is in progress.
+NET_EXPORT scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
+    scoped_ptr<StreamSocket> socket,
+    X509Certificate* certificate,
+    scoped_refptr<SSLPrivateKey> key,
+    const SSLServerConfig& ssl_config);
+
 }  // namespace net
 
 #endif  // NET_SOCKET_SSL_SERVER_SOCKET_H_
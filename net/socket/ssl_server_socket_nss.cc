@@ -39,6 +39,7 @@
 #include "net/base/net_errors.h"
 #include "net/log/net_log.h"
 #include "net/socket/nss_ssl_util.h"
+#include "net/ssl/ssl_private_key.h"
 
 // SSL plaintext fragments are shorter than 16KB. Although the record layer
 // overhead is allowed to be 2K + 5 bytes, in practice the overhead is much
@@ -91,6 +92,17 @@ scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
       new SSLServerSocketNSS(socket.Pass(), cert, key, ssl_config));
 }
 
+scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
+    scoped_ptr<StreamSocket> socket,
+    X509Certificate* cert,
+    scoped_refptr<SSLPrivateKey> key,
+    const SSLServerConfig& ssl_config) {
+  // Asynchronous signing requires the external private key hooks of the
+  // OpenSSL implementation.
+  NOTIMPLEMENTED();
+  return nullptr;
+}
+
 SSLServerSocketNSS::SSLServerSocketNSS(
     scoped_ptr<StreamSocket> transport_socket,
     scoped_refptr<X509Certificate> cert,
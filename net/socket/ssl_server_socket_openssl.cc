@@ -5,9 +5,12 @@
 #include "net/socket/ssl_server_socket_openssl.h"
 
 #include <openssl/err.h>
+#include <openssl/evp.h>
 #include <openssl/ssl.h>
 
+#include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "crypto/openssl_util.h"
@@ -16,11 +19,67 @@
 #include "net/base/net_errors.h"
 #include "net/ssl/openssl_ssl_util.h"
 #include "net/ssl/scoped_openssl_types.h"
+#include "net/ssl/ssl_private_key.h"
 
 #define GotoState(s) next_handshake_state_ = s
 
 namespace net {
 
+namespace {
+
+// This constant can be any non-negative/non-zero value (eg: it does not
+// overlap with any value of the net::Error range, including net::OK).
+const int kNoPendingResult = 1;
+
+// Creates the once-per-process index used to stash the owning
+// SSLServerSocketOpenSSL on each SSL object, so that the
+// SSL_PRIVATE_KEY_METHOD callbacks can find it again.
+class SocketDataIndex {
+ public:
+  static SocketDataIndex* GetInstance();
+
+  SocketDataIndex() {
+    ssl_socket_data_index_ = SSL_get_ex_new_index(0, 0, 0, 0, 0);
+    DCHECK_NE(-1, ssl_socket_data_index_);
+  }
+
+  // This is the index used with SSL_get_ex_data to retrieve the owner
+  // SSLServerSocketOpenSSL object from an SSL instance.
+  int ssl_socket_data_index_;
+};
+
+base::LazyInstance<SocketDataIndex>::Leaky g_ssl_socket_data_index =
+    LAZY_INSTANCE_INITIALIZER;
+
+// static
+SocketDataIndex* SocketDataIndex::GetInstance() {
+  return g_ssl_socket_data_index.Pointer();
+}
+
+bool EVP_MDToPrivateKeyHash(const EVP_MD* md, SSLPrivateKey::Hash* hash) {
+  switch (EVP_MD_type(md)) {
+    case NID_md5_sha1:
+      *hash = SSLPrivateKey::Hash::MD5_SHA1;
+      return true;
+    case NID_sha1:
+      *hash = SSLPrivateKey::Hash::SHA1;
+      return true;
+    case NID_sha256:
+      *hash = SSLPrivateKey::Hash::SHA256;
+      return true;
+    case NID_sha384:
+      *hash = SSLPrivateKey::Hash::SHA384;
+      return true;
+    case NID_sha512:
+      *hash = SSLPrivateKey::Hash::SHA512;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
 void EnableSSLServerSockets() {
   // No-op because CreateSSLServerSocket() calls crypto::EnsureOpenSSLInit().
 }
@@ -35,6 +94,16 @@ scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
       new SSLServerSocketOpenSSL(socket.Pass(), certificate, key, ssl_config));
 }
 
+scoped_ptr<SSLServerSocket> CreateSSLServerSocket(
+    scoped_ptr<StreamSocket> socket,
+    X509Certificate* certificate,
+    scoped_refptr<SSLPrivateKey> key,
+    const SSLServerConfig& ssl_config) {
+  crypto::EnsureOpenSSLInit();
+  return scoped_ptr<SSLServerSocket>(
+      new SSLServerSocketOpenSSL(socket.Pass(), certificate, key, ssl_config));
+}
+
 SSLServerSocketOpenSSL::SSLServerSocketOpenSSL(
     scoped_ptr<StreamSocket> transport_socket,
     scoped_refptr<X509Certificate> certificate,
@@ -51,8 +120,10 @@ SSLServerSocketOpenSSL::SSLServerSocketOpenSSL(
       transport_socket_(transport_socket.Pass()),
       ssl_config_(ssl_config),
       cert_(certificate),
+      signature_result_(kNoPendingResult),
       next_handshake_state_(STATE_NONE),
-      completed_handshake_(false) {
+      completed_handshake_(false),
+      weak_factory_(this) {
   // TODO(byungchul): Need a better way to clone a key.
   std::vector<uint8> key_bytes;
   CHECK(key->ExportPrivateKey(&key_bytes));
@@ -60,6 +131,30 @@ SSLServerSocketOpenSSL::SSLServerSocketOpenSSL(
   CHECK(key_.get());
 }
 
+SSLServerSocketOpenSSL::SSLServerSocketOpenSSL(
+    scoped_ptr<StreamSocket> transport_socket,
+    scoped_refptr<X509Certificate> certificate,
+    scoped_refptr<SSLPrivateKey> key,
+    const SSLServerConfig& ssl_config)
+    : transport_send_busy_(false),
+      transport_recv_busy_(false),
+      transport_recv_eof_(false),
+      user_read_buf_len_(0),
+      user_write_buf_len_(0),
+      transport_write_error_(OK),
+      ssl_(NULL),
+      transport_bio_(NULL),
+      transport_socket_(transport_socket.Pass()),
+      ssl_config_(ssl_config),
+      cert_(certificate),
+      private_key_(key),
+      signature_result_(kNoPendingResult),
+      next_handshake_state_(STATE_NONE),
+      completed_handshake_(false),
+      weak_factory_(this) {
+  CHECK(private_key_.get());
+}
+
 SSLServerSocketOpenSSL::~SSLServerSocketOpenSSL() {
   if (ssl_) {
     // Calling SSL_shutdown prevents the session from being marked as
@@ -570,6 +665,14 @@ int SSLServerSocketOpenSSL::DoHandshake() {
     completed_handshake_ = true;
   } else {
     int ssl_error = SSL_get_error(ssl_, rv);
+
+    if (ssl_error == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION) {
+      DCHECK(private_key_.get());
+      DCHECK_NE(kNoPendingResult, signature_result_);
+      GotoState(STATE_HANDSHAKE);
+      return ERR_IO_PENDING;
+    }
+
     OpenSSLErrorInfo error_info;
     net_error = MapOpenSSLErrorWithDetails(ssl_error, err_tracer, &error_info);
 
@@ -593,6 +696,145 @@ void SSLServerSocketOpenSSL::DoHandshakeCallback(int rv) {
   ResetAndReturn(&user_handshake_callback_).Run(rv > OK ? OK : rv);
 }
 
+const SSL_PRIVATE_KEY_METHOD SSLServerSocketOpenSSL::kPrivateKeyMethod = {
+    &SSLServerSocketOpenSSL::PrivateKeyTypeCallback,
+    &SSLServerSocketOpenSSL::PrivateKeyMaxSignatureLenCallback,
+    &SSLServerSocketOpenSSL::PrivateKeySignCallback,
+    &SSLServerSocketOpenSSL::PrivateKeySignCompleteCallback,
+};
+
+// static
+int SSLServerSocketOpenSSL::PrivateKeyTypeCallback(SSL* ssl) {
+  SSLServerSocketOpenSSL* socket = static_cast<SSLServerSocketOpenSSL*>(
+      SSL_get_ex_data(ssl, SocketDataIndex::GetInstance()->
+                               ssl_socket_data_index_));
+  DCHECK(socket);
+  return socket->PrivateKeyTypeCallback();
+}
+
+// static
+size_t SSLServerSocketOpenSSL::PrivateKeyMaxSignatureLenCallback(SSL* ssl) {
+  SSLServerSocketOpenSSL* socket = static_cast<SSLServerSocketOpenSSL*>(
+      SSL_get_ex_data(ssl, SocketDataIndex::GetInstance()->
+                               ssl_socket_data_index_));
+  DCHECK(socket);
+  return socket->PrivateKeyMaxSignatureLenCallback();
+}
+
+// static
+ssl_private_key_result_t SSLServerSocketOpenSSL::PrivateKeySignCallback(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    const EVP_MD* md,
+    const uint8_t* in,
+    size_t in_len) {
+  SSLServerSocketOpenSSL* socket = static_cast<SSLServerSocketOpenSSL*>(
+      SSL_get_ex_data(ssl, SocketDataIndex::GetInstance()->
+                               ssl_socket_data_index_));
+  DCHECK(socket);
+  return socket->PrivateKeySignCallback(out, out_len, max_out, md, in, in_len);
+}
+
+// static
+ssl_private_key_result_t
+SSLServerSocketOpenSSL::PrivateKeySignCompleteCallback(SSL* ssl,
+                                                       uint8_t* out,
+                                                       size_t* out_len,
+                                                       size_t max_out) {
+  SSLServerSocketOpenSSL* socket = static_cast<SSLServerSocketOpenSSL*>(
+      SSL_get_ex_data(ssl, SocketDataIndex::GetInstance()->
+                               ssl_socket_data_index_));
+  DCHECK(socket);
+  return socket->PrivateKeySignCompleteCallback(out, out_len, max_out);
+}
+
+int SSLServerSocketOpenSSL::PrivateKeyTypeCallback() {
+  switch (private_key_->GetType()) {
+    case SSLPrivateKey::Type::RSA:
+      return EVP_PKEY_RSA;
+    case SSLPrivateKey::Type::ECDSA:
+      return EVP_PKEY_EC;
+  }
+  NOTREACHED();
+  return EVP_PKEY_NONE;
+}
+
+size_t SSLServerSocketOpenSSL::PrivateKeyMaxSignatureLenCallback() {
+  return private_key_->GetMaxSignatureLengthInBytes();
+}
+
+ssl_private_key_result_t SSLServerSocketOpenSSL::PrivateKeySignCallback(
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    const EVP_MD* md,
+    const uint8_t* in,
+    size_t in_len) {
+  DCHECK_EQ(kNoPendingResult, signature_result_);
+  DCHECK(signature_.empty());
+  DCHECK(private_key_.get());
+
+  net_log_.BeginEvent(NetLog::TYPE_SSL_PRIVATE_KEY_OPERATION);
+
+  SSLPrivateKey::Hash hash;
+  if (!EVP_MDToPrivateKeyHash(md, &hash)) {
+    OpenSSLPutNetError(FROM_HERE, ERR_SSL_CLIENT_AUTH_SIGNATURE_FAILED);
+    return ssl_private_key_failure;
+  }
+
+  signature_result_ = ERR_IO_PENDING;
+  private_key_->SignDigest(
+      hash, base::StringPiece(reinterpret_cast<const char*>(in), in_len),
+      base::Bind(&SSLServerSocketOpenSSL::OnPrivateKeySignComplete,
+                 weak_factory_.GetWeakPtr()));
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t SSLServerSocketOpenSSL::PrivateKeySignCompleteCallback(
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out) {
+  DCHECK_NE(kNoPendingResult, signature_result_);
+  DCHECK(private_key_.get());
+
+  if (signature_result_ == ERR_IO_PENDING)
+    return ssl_private_key_retry;
+  if (signature_result_ != OK) {
+    OpenSSLPutNetError(FROM_HERE, signature_result_);
+    return ssl_private_key_failure;
+  }
+  if (signature_.size() > max_out) {
+    OpenSSLPutNetError(FROM_HERE, ERR_SSL_CLIENT_AUTH_SIGNATURE_FAILED);
+    return ssl_private_key_failure;
+  }
+  memcpy(out, signature_.data(), signature_.size());
+  *out_len = signature_.size();
+  signature_.clear();
+  signature_result_ = kNoPendingResult;
+  return ssl_private_key_success;
+}
+
+void SSLServerSocketOpenSSL::OnPrivateKeySignComplete(
+    Error error,
+    const std::vector<uint8_t>& signature) {
+  DCHECK_EQ(ERR_IO_PENDING, signature_result_);
+  DCHECK(signature_.empty());
+  DCHECK(private_key_.get());
+
+  net_log_.EndEventWithNetErrorCode(NetLog::TYPE_SSL_PRIVATE_KEY_OPERATION,
+                                    error);
+
+  signature_result_ = error;
+  if (signature_result_ == OK)
+    signature_ = signature;
+
+  // Signing only happens during the handshake; the server socket does not
+  // support renegotiation.
+  OnHandshakeIOComplete(signature_result_);
+}
+
 void SSLServerSocketOpenSSL::DoReadCallback(int rv) {
   DCHECK(rv != ERR_IO_PENDING);
   DCHECK(!user_read_callback_.is_null());
@@ -625,6 +867,10 @@ int SSLServerSocketOpenSSL::Init() {
   ssl_ = SSL_new(ssl_ctx.get());
   if (!ssl_)
     return ERR_UNEXPECTED;
+  if (SSL_set_ex_data(ssl_, SocketDataIndex::GetInstance()->
+                                ssl_socket_data_index_, this) != 1) {
+    return ERR_UNEXPECTED;
+  }
 
   BIO* ssl_bio = NULL;
   // 0 => use default buffer sizes.
@@ -662,10 +908,14 @@ int SSLServerSocketOpenSSL::Init() {
   }
 #endif  // USE_OPENSSL_CERTS
 
-  DCHECK(key_->key());
-  if (SSL_use_PrivateKey(ssl_, key_->key()) != 1) {
-    LOG(ERROR) << "Cannot set private key.";
-    return ERR_UNEXPECTED;
+  if (private_key_.get()) {
+    SSL_set_private_key_method(ssl_, &kPrivateKeyMethod);
+  } else {
+    DCHECK(key_->key());
+    if (SSL_use_PrivateKey(ssl_, key_->key()) != 1) {
+      LOG(ERROR) << "Cannot set private key.";
+      return ERR_UNEXPECTED;
+    }
   }
 
   DCHECK_LT(SSL3_VERSION, ssl_config_.version_min);
@@ -5,24 +5,26 @@
 #ifndef NET_SOCKET_SSL_SERVER_SOCKET_OPENSSL_H_
 #define NET_SOCKET_SSL_SERVER_SOCKET_OPENSSL_H_
 
+#include <openssl/base.h>
+#include <openssl/ssl.h>
 #include <stdint.h>
 
+#include <vector>
+
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "net/base/completion_callback.h"
 #include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
 #include "net/log/net_log.h"
 #include "net/socket/ssl_server_socket.h"
 #include "net/ssl/ssl_server_config.h"
 
-// Avoid including misc OpenSSL headers, i.e.:
-// <openssl/bio.h>
-typedef struct bio_st BIO;
-// <openssl/ssl.h>
-typedef struct ssl_st SSL;
-
 namespace net {
 
 class SSLInfo;
+class SSLPrivateKey;
 
 class SSLServerSocketOpenSSL : public SSLServerSocket {
  public:
@@ -32,6 +34,13 @@ class SSLServerSocketOpenSSL : public SSLServerSocket {
                          scoped_refptr<X509Certificate> certificate,
                          crypto::RSAPrivateKey* key,
                          const SSLServerConfig& ssl_config);
+
+  // As above, but signs handshake messages asynchronously with |key|. See
+  // the corresponding CreateSSLServerSocket overload.
+  SSLServerSocketOpenSSL(scoped_ptr<StreamSocket> socket,
+                         scoped_refptr<X509Certificate> certificate,
+                         scoped_refptr<SSLPrivateKey> key,
+                         const SSLServerConfig& ssl_config);
   ~SSLServerSocketOpenSSL() override;
 
   // SSLServerSocket interface.
@@ -105,6 +114,38 @@ class SSLServerSocketOpenSSL : public SSLServerSocket {
 
   int Init();
 
+  // SSL_PRIVATE_KEY_METHOD trampolines and implementation, used when the
+  // socket was created with an SSLPrivateKey.
+  static int PrivateKeyTypeCallback(SSL* ssl);
+  static size_t PrivateKeyMaxSignatureLenCallback(SSL* ssl);
+  static ssl_private_key_result_t PrivateKeySignCallback(SSL* ssl,
+                                                         uint8_t* out,
+                                                         size_t* out_len,
+                                                         size_t max_out,
+                                                         const EVP_MD* md,
+                                                         const uint8_t* in,
+                                                         size_t in_len);
+  static ssl_private_key_result_t PrivateKeySignCompleteCallback(
+      SSL* ssl,
+      uint8_t* out,
+      size_t* out_len,
+      size_t max_out);
+  static const SSL_PRIVATE_KEY_METHOD kPrivateKeyMethod;
+
+  int PrivateKeyTypeCallback();
+  size_t PrivateKeyMaxSignatureLenCallback();
+  ssl_private_key_result_t PrivateKeySignCallback(uint8_t* out,
+                                                  size_t* out_len,
+                                                  size_t max_out,
+                                                  const EVP_MD* md,
+                                                  const uint8_t* in,
+                                                  size_t in_len);
+  ssl_private_key_result_t PrivateKeySignCompleteCallback(uint8_t* out,
+                                                          size_t* out_len,
+                                                          size_t max_out);
+  void OnPrivateKeySignComplete(Error error,
+                                const std::vector<uint8_t>& signature);
+
   // Members used to send and receive buffer.
   bool transport_send_busy_;
   bool transport_recv_busy_;
@@ -144,12 +185,22 @@ class SSLServerSocketOpenSSL : public SSLServerSocket {
   // Certificate for the server.
   scoped_refptr<X509Certificate> cert_;
 
-  // Private key used by the server.
+  // Private key used by the server. Exactly one of |key_| and |private_key_|
+  // is non-NULL; when |private_key_| is set, handshake signatures are
+  // produced asynchronously through the SSL_PRIVATE_KEY_METHOD callbacks.
   scoped_ptr<crypto::RSAPrivateKey> key_;
+  scoped_refptr<SSLPrivateKey> private_key_;
+
+  // The result and signature of a pending |private_key_| operation.
+  // |signature_result_| is kNoPendingResult when no operation is in flight.
+  int signature_result_;
+  std::vector<uint8_t> signature_;
 
   State next_handshake_state_;
   bool completed_handshake_;
 
+  base::WeakPtrFactory<SSLServerSocketOpenSSL> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(SSLServerSocketOpenSSL);
 };
 
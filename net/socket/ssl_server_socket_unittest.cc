@@ -15,12 +15,19 @@
 
 #include "net/socket/ssl_server_socket.h"
 
+#if defined(USE_OPENSSL)
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#endif
 #include <stdint.h>
 #include <stdlib.h>
 
 #include <queue>
+#include <vector>
 
+#include "base/bind.h"
 #include "base/compiler_specific.h"
+#include "base/macros.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/location.h"
@@ -30,6 +37,9 @@
 #include "base/thread_task_runner_handle.h"
 #include "crypto/nss_util.h"
 #include "crypto/rsa_private_key.h"
+#if defined(USE_OPENSSL)
+#include "crypto/scoped_openssl_types.h"
+#endif
 #include "net/base/address_list.h"
 #include "net/base/completion_callback.h"
 #include "net/base/host_port_pair.h"
@@ -49,6 +59,7 @@
 #include "net/ssl/ssl_cipher_suite_names.h"
 #include "net/ssl/ssl_connection_status_flags.h"
 #include "net/ssl/ssl_info.h"
+#include "net/ssl/ssl_private_key.h"
 #include "net/ssl/ssl_server_config.h"
 #include "net/test/cert_test_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -254,6 +265,84 @@ class FakeSocket : public StreamSocket {
   DISALLOW_COPY_AND_ASSIGN(FakeSocket);
 };
 
+#if defined(USE_OPENSSL)
+// An SSLPrivateKey that signs with an in-memory RSA key but completes
+// asynchronously through the message loop, the way a smartcard- or
+// HSM-backed key would.
+class FakeAsyncRSAPrivateKey : public SSLPrivateKey {
+ public:
+  explicit FakeAsyncRSAPrivateKey(scoped_ptr<crypto::RSAPrivateKey> key)
+      : key_(key.Pass()) {}
+
+  Type GetType() override { return Type::RSA; }
+
+  std::vector<SSLPrivateKey::Hash> GetDigestPreferences() override {
+    static const SSLPrivateKey::Hash kHashes[] = {
+        SSLPrivateKey::Hash::SHA512, SSLPrivateKey::Hash::SHA384,
+        SSLPrivateKey::Hash::SHA256, SSLPrivateKey::Hash::SHA1};
+    return std::vector<SSLPrivateKey::Hash>(kHashes,
+                                            kHashes + arraysize(kHashes));
+  }
+
+  size_t GetMaxSignatureLengthInBytes() override {
+    return EVP_PKEY_size(key_->key());
+  }
+
+  void SignDigest(Hash hash,
+                  const base::StringPiece& input,
+                  const SignCallback& callback) override {
+    std::vector<uint8_t> signature;
+    Error error = DoSign(hash, input, &signature);
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::Bind(callback, error, signature));
+  }
+
+ private:
+  ~FakeAsyncRSAPrivateKey() override {}
+
+  Error DoSign(Hash hash,
+               const base::StringPiece& input,
+               std::vector<uint8_t>* signature) {
+    int hash_nid = NID_undef;
+    switch (hash) {
+      case SSLPrivateKey::Hash::MD5_SHA1:
+        hash_nid = NID_md5_sha1;
+        break;
+      case SSLPrivateKey::Hash::SHA1:
+        hash_nid = NID_sha1;
+        break;
+      case SSLPrivateKey::Hash::SHA256:
+        hash_nid = NID_sha256;
+        break;
+      case SSLPrivateKey::Hash::SHA384:
+        hash_nid = NID_sha384;
+        break;
+      case SSLPrivateKey::Hash::SHA512:
+        hash_nid = NID_sha512;
+        break;
+    }
+    if (hash_nid == NID_undef)
+      return ERR_SSL_CLIENT_AUTH_SIGNATURE_FAILED;
+
+    crypto::ScopedRSA rsa(EVP_PKEY_get1_RSA(key_->key()));
+    if (!rsa)
+      return ERR_SSL_CLIENT_AUTH_SIGNATURE_FAILED;
+    signature->resize(RSA_size(rsa.get()));
+    unsigned int len = 0;
+    if (!RSA_sign(hash_nid, reinterpret_cast<const uint8_t*>(input.data()),
+                  input.size(), signature->data(), &len, rsa.get())) {
+      return ERR_SSL_CLIENT_AUTH_SIGNATURE_FAILED;
+    }
+    signature->resize(len);
+    return OK;
+  }
+
+  scoped_ptr<crypto::RSAPrivateKey> key_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeAsyncRSAPrivateKey);
+};
+#endif  // defined(USE_OPENSSL)
+
 }  // namespace
 
 // Verify the correctness of the test helper classes first.
@@ -306,7 +395,7 @@ class SSLServerSocketTest : public PlatformTest {
   }
 
  protected:
-  void Initialize() {
+  void Initialize(bool use_async_private_key = false) {
     scoped_ptr<ClientSocketHandle> client_connection(new ClientSocketHandle);
     client_connection->SetSocket(
         scoped_ptr<StreamSocket>(new FakeSocket(&channel_1_, &channel_2_)));
@@ -348,6 +437,17 @@ class SSLServerSocketTest : public PlatformTest {
     context.transport_security_state = transport_security_state_.get();
     client_socket_ = socket_factory_->CreateSSLClientSocket(
         client_connection.Pass(), host_and_pair, client_ssl_config_, context);
+#if defined(USE_OPENSSL)
+    if (use_async_private_key) {
+      server_socket_ = CreateSSLServerSocket(
+          server_socket.Pass(), cert.get(),
+          make_scoped_refptr(new FakeAsyncRSAPrivateKey(private_key.Pass())),
+          server_ssl_config_);
+      return;
+    }
+#else
+    DCHECK(!use_async_private_key);
+#endif
     server_socket_ =
         CreateSSLServerSocket(server_socket.Pass(), cert.get(),
                               private_key.get(), server_ssl_config_);
@@ -371,6 +471,33 @@ TEST_F(SSLServerSocketTest, Initialize) {
   Initialize();
 }
 
+#if defined(USE_OPENSSL)
+// Tests that the handshake completes when signing with the server's private
+// key is performed asynchronously, off the SSL stack's control flow.
+TEST_F(SSLServerSocketTest, HandshakeWithAsyncPrivateKey) {
+  Initialize(true /* use_async_private_key */);
+
+  TestCompletionCallback connect_callback;
+  TestCompletionCallback handshake_callback;
+
+  int server_ret = server_socket_->Handshake(handshake_callback.callback());
+  EXPECT_TRUE(server_ret == OK || server_ret == ERR_IO_PENDING);
+
+  int client_ret = client_socket_->Connect(connect_callback.callback());
+  EXPECT_TRUE(client_ret == OK || client_ret == ERR_IO_PENDING);
+
+  if (client_ret == ERR_IO_PENDING)
+    EXPECT_EQ(OK, connect_callback.WaitForResult());
+  if (server_ret == ERR_IO_PENDING)
+    EXPECT_EQ(OK, handshake_callback.WaitForResult());
+
+  // Make sure the cert status is expected.
+  SSLInfo ssl_info;
+  ASSERT_TRUE(client_socket_->GetSSLInfo(&ssl_info));
+  EXPECT_EQ(CERT_STATUS_AUTHORITY_INVALID, ssl_info.cert_status);
+}
+#endif  // defined(USE_OPENSSL)
+
 // This test executes Connect() on SSLClientSocket and Handshake() on
 // SSLServerSocket to make sure handshaking between the two sockets is
 // completed successfully.
@@ -292,6 +292,26 @@ int TCPClientSocket::Write(IOBuffer* buf,
   return result;
 }
 
+int TCPClientSocket::WriteV(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+
+  // |socket_| is owned by this class and the callback won't be run once
+  // |socket_| is gone. Therefore, it is safe to use base::Unretained() here.
+  CompletionCallback write_callback = base::Bind(
+      &TCPClientSocket::DidCompleteWrite, base::Unretained(this), callback);
+  int result = socket_->WriteV(buffers, write_callback);
+  if (result > 0)
+    use_history_.set_was_used_to_convey_data();
+
+  return result;
+}
+
+bool TCPClientSocket::SupportsGatherWrites() const {
+  return true;
+}
+
 int TCPClientSocket::SetReceiveBufferSize(int32 size) {
   return socket_->SetReceiveBufferSize(size);
 }
@@ -66,6 +66,9 @@ class NET_EXPORT TCPClientSocket : public StreamSocket {
   int Write(IOBuffer* buf,
             int buf_len,
             const CompletionCallback& callback) override;
+  int WriteV(const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+             const CompletionCallback& callback) override;
+  bool SupportsGatherWrites() const override;
   int SetReceiveBufferSize(int32 size) override;
   int SetSendBufferSize(int32 size) override;
 
@@ -14,12 +14,17 @@ namespace net {
 
 TCPServerSocket::TCPServerSocket(NetLog* net_log, const NetLog::Source& source)
     : socket_(net_log, source),
-      pending_accept_(false) {
+      pending_accept_(false),
+      allow_port_sharing_(false) {
 }
 
 TCPServerSocket::~TCPServerSocket() {
 }
 
+void TCPServerSocket::AllowPortSharing() {
+  allow_port_sharing_ = true;
+}
+
 int TCPServerSocket::Listen(const IPEndPoint& address, int backlog) {
   int result = socket_.Open(address.GetFamily());
   if (result != OK)
@@ -31,6 +36,14 @@ int TCPServerSocket::Listen(const IPEndPoint& address, int backlog) {
     return result;
   }
 
+  if (allow_port_sharing_) {
+    result = socket_.SetPortReuse(true);
+    if (result != OK) {
+      socket_.Close();
+      return result;
+    }
+  }
+
   result = socket_.Bind(address);
   if (result != OK) {
     socket_.Close();
@@ -21,6 +21,16 @@ class NET_EXPORT_PRIVATE TCPServerSocket : public ServerSocket {
   TCPServerSocket(NetLog* net_log, const NetLog::Source& source);
   ~TCPServerSocket() override;
 
+  // Allows this socket to share its local address with other listening
+  // sockets (a "reuseport group"). Several TCPServerSockets can then call
+  // Listen() on the same end point, and the kernel balances incoming
+  // connections across their accept backlogs. Combined with
+  // DetachFromThread(), this shards accept load across threads: bind one
+  // socket per thread, each running its own accept loop. Must be called
+  // before Listen() on every socket of the group; Listen() fails with
+  // ERR_NOT_IMPLEMENTED on platforms without SO_REUSEPORT.
+  void AllowPortSharing();
+
   // net::ServerSocket implementation.
   int Listen(const IPEndPoint& address, int backlog) override;
   int GetLocalAddress(IPEndPoint* address) const override;
@@ -49,6 +59,7 @@ class NET_EXPORT_PRIVATE TCPServerSocket : public ServerSocket {
   scoped_ptr<TCPSocket> accepted_socket_;
   IPEndPoint accepted_address_;
   bool pending_accept_;
+  bool allow_port_sharing_;
 
   DISALLOW_COPY_AND_ASSIGN(TCPServerSocket);
 };
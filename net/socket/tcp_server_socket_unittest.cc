@@ -9,6 +9,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
+#include "build/build_config.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/base/address_list.h"
 #include "net/base/io_buffer.h"
@@ -164,6 +165,35 @@ TEST_F(TCPServerSocketTest, Accept2Connections) {
             local_address_.address());
 }
 
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+// Tests that sockets which opted into port sharing can listen on the same
+// end point as a group, and that the option is required on every member.
+TEST_F(TCPServerSocketTest, AllowPortSharing) {
+  IPEndPoint address;
+  ParseAddress("127.0.0.1", 0, &address);
+  socket_.AllowPortSharing();
+  ASSERT_EQ(OK, socket_.Listen(address, kListenBacklog));
+  ASSERT_EQ(OK, socket_.GetLocalAddress(&local_address_));
+
+  // A second listener on the same end point succeeds when it also opts in...
+  TCPServerSocket second_socket(NULL, NetLog::Source());
+  second_socket.AllowPortSharing();
+  EXPECT_EQ(OK, second_socket.Listen(local_address_, kListenBacklog));
+
+  // ...and fails when it does not.
+  TCPServerSocket third_socket(NULL, NetLog::Source());
+  EXPECT_EQ(ERR_ADDRESS_IN_USE,
+            third_socket.Listen(local_address_, kListenBacklog));
+
+  // Connections still complete against the listener group.
+  TestCompletionCallback connect_callback;
+  TCPClientSocket connecting_socket(local_address_list(),
+                                    NULL, NetLog::Source());
+  connecting_socket.Connect(connect_callback.callback());
+  EXPECT_EQ(OK, connect_callback.WaitForResult());
+}
+#endif  // defined(OS_LINUX) || defined(OS_MACOSX)
+
 TEST_F(TCPServerSocketTest, AcceptIPv6) {
   bool initialized = false;
   ASSERT_NO_FATAL_FAILURE(SetUpIPv6(&initialized));
@@ -8,6 +8,8 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
@@ -315,6 +317,31 @@ int TCPSocketPosix::Write(IOBuffer* buf,
   return rv;
 }
 
+int TCPSocketPosix::WriteV(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(socket_);
+  DCHECK(!callback.is_null());
+  DCHECK(!buffers.empty());
+
+  if (use_tcp_fastopen_ && !tcp_fastopen_write_attempted_) {
+    // TCP FastOpen sends the data with connect(), which takes one buffer;
+    // fall back to a short write of the front buffer.
+    DrainableIOBuffer* front = buffers.front().get();
+    return Write(front, front->BytesRemaining(), callback);
+  }
+
+  // Binding |buffers| keeps references to them until the write completes,
+  // just as Write() grabs a reference to its buffer.
+  CompletionCallback write_callback =
+      base::Bind(&TCPSocketPosix::WriteVCompleted,
+                 base::Unretained(this), buffers, callback);
+  int rv = socket_->WriteV(buffers, write_callback);
+  if (rv != ERR_IO_PENDING)
+    rv = HandleWriteVCompleted(buffers, rv);
+  return rv;
+}
+
 int TCPSocketPosix::GetLocalAddress(IPEndPoint* address) const {
   DCHECK(address);
 
@@ -404,6 +431,30 @@ int TCPSocketPosix::SetAddressReuse(bool allow) {
   return OK;
 }
 
+int TCPSocketPosix::SetPortReuse(bool allow) {
+  DCHECK(socket_);
+
+  // SO_REUSEPORT allows several sockets to bind to the same end point. On
+  // Linux 3.9+ the kernel also balances incoming connections across all
+  // listening sockets that set it, which is the building block for sharding
+  // accept load over several threads: each thread owns its own listening
+  // socket with its own accept backlog, so a burst of connections no longer
+  // funnels through a single backlog.
+  //
+  // SO_REUSEPORT is also provided on MacOS X and iOS, but without the
+  // load-balancing behavior.
+#if defined(SO_REUSEPORT)
+  int boolean_value = allow ? 1 : 0;
+  int rv = setsockopt(socket_->socket_fd(), SOL_SOCKET, SO_REUSEPORT,
+                      &boolean_value, sizeof(boolean_value));
+  if (rv < 0)
+    return MapSystemError(errno);
+  return OK;
+#else
+  return ERR_NOT_IMPLEMENTED;
+#endif
+}
+
 int TCPSocketPosix::SetReceiveBufferSize(int32 size) {
   DCHECK(socket_);
   int rv = setsockopt(socket_->socket_fd(), SOL_SOCKET, SO_RCVBUF,
@@ -538,8 +589,8 @@ void TCPSocketPosix::ConnectCompleted(const CompletionCallback& callback,
 int TCPSocketPosix::HandleConnectCompleted(int rv) const {
   // Log the end of this attempt (and any OS error it threw).
   if (rv != OK) {
-    net_log_.EndEvent(NetLog::TYPE_TCP_CONNECT_ATTEMPT,
-                      NetLog::IntCallback("os_error", errno));
+    net_log_.EndEventWithIntParams(NetLog::TYPE_TCP_CONNECT_ATTEMPT, "os_error",
+                                   errno);
   } else {
     net_log_.EndEvent(NetLog::TYPE_TCP_CONNECT_ATTEMPT);
   }
@@ -648,6 +699,36 @@ int TCPSocketPosix::HandleWriteCompleted(IOBuffer* buf, int rv) {
   return rv;
 }
 
+void TCPSocketPosix::WriteVCompleted(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback,
+    int rv) {
+  DCHECK_NE(ERR_IO_PENDING, rv);
+  callback.Run(HandleWriteVCompleted(buffers, rv));
+}
+
+int TCPSocketPosix::HandleWriteVCompleted(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    int rv) {
+  if (rv < 0) {
+    // WriteV() is never used for the TCP FastOpen connect-with-write, so
+    // there is no FastOpen state to update here.
+    net_log_.AddEvent(NetLog::TYPE_SOCKET_WRITE_ERROR,
+                      CreateNetLogSocketErrorCallback(rv, errno));
+    return rv;
+  }
+  // Attribute the written bytes to the buffers they came from.
+  int remaining = rv;
+  for (size_t i = 0; i < buffers.size() && remaining > 0; ++i) {
+    int chunk = std::min(remaining, buffers[i]->BytesRemaining());
+    net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, chunk,
+                                  buffers[i]->data());
+    remaining -= chunk;
+  }
+  NetworkActivityMonitor::GetInstance()->IncrementBytesSent(rv);
+  return rv;
+}
+
 int TCPSocketPosix::TcpFastOpenWrite(IOBuffer* buf,
                                      int buf_len,
                                      const CompletionCallback& callback) {
@@ -5,6 +5,8 @@
 #ifndef NET_SOCKET_TCP_SOCKET_POSIX_H_
 #define NET_SOCKET_TCP_SOCKET_POSIX_H_
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
@@ -18,6 +20,7 @@
 namespace net {
 
 class AddressList;
+class DrainableIOBuffer;
 class IOBuffer;
 class IPEndPoint;
 class SocketPosix;
@@ -47,6 +50,11 @@ class NET_EXPORT TCPSocketPosix {
   int Read(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
   int Write(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
 
+  // Writes the unconsumed portions of |buffers| with a single gather write
+  // when possible; see Socket::WriteV() for semantics.
+  int WriteV(const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+             const CompletionCallback& callback);
+
   int GetLocalAddress(IPEndPoint* address) const;
   int GetPeerAddress(IPEndPoint* address) const;
 
@@ -59,6 +67,7 @@ class NET_EXPORT TCPSocketPosix {
   // - SetKeepAlive(true, 45).
   void SetDefaultOptionsForClient();
   int SetAddressReuse(bool allow);
+  int SetPortReuse(bool allow);
   int SetReceiveBufferSize(int32 size);
   int SetSendBufferSize(int32 size);
   bool SetKeepAlive(bool enable, int delay);
@@ -191,6 +200,13 @@ class NET_EXPORT TCPSocketPosix {
                       const CompletionCallback& callback,
                       int rv);
   int HandleWriteCompleted(IOBuffer* buf, int rv);
+  void WriteVCompleted(
+      const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+      const CompletionCallback& callback,
+      int rv);
+  int HandleWriteVCompleted(
+      const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+      int rv);
   int TcpFastOpenWrite(IOBuffer* buf,
                        int buf_len,
                        const CompletionCallback& callback);
@@ -6,6 +6,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -286,5 +287,73 @@ TEST_F(TCPSocketTest, ReadWrite) {
   ASSERT_EQ(message, received_message);
 }
 
+// Writes two buffers with a single WriteV() call and verifies that the peer
+// reads them back in order. WriteV() may cover only a prefix of the buffer
+// sequence, so unwritten bytes are resubmitted just as a caller would.
+TEST_F(TCPSocketTest, WriteV) {
+  ASSERT_NO_FATAL_FAILURE(SetUpListenIPv4());
+
+  TestCompletionCallback connect_callback;
+  TCPSocket connecting_socket(NULL, NetLog::Source());
+  int result = connecting_socket.Open(ADDRESS_FAMILY_IPV4);
+  ASSERT_EQ(OK, result);
+  connecting_socket.Connect(local_address_, connect_callback.callback());
+
+  TestCompletionCallback accept_callback;
+  scoped_ptr<TCPSocket> accepted_socket;
+  IPEndPoint accepted_address;
+  result = socket_.Accept(&accepted_socket, &accepted_address,
+                          accept_callback.callback());
+  ASSERT_EQ(OK, accept_callback.GetResult(result));
+
+  ASSERT_TRUE(accepted_socket.get());
+  EXPECT_EQ(OK, connect_callback.WaitForResult());
+
+  const std::string first_chunk("first chunk ");
+  const std::string second_chunk("second chunk");
+  const std::string message = first_chunk + second_chunk;
+
+  std::vector<scoped_refptr<DrainableIOBuffer>> buffers;
+  scoped_refptr<StringIOBuffer> first_buffer(new StringIOBuffer(first_chunk));
+  buffers.push_back(
+      new DrainableIOBuffer(first_buffer.get(), first_buffer->size()));
+  scoped_refptr<StringIOBuffer> second_buffer(new StringIOBuffer(second_chunk));
+  buffers.push_back(
+      new DrainableIOBuffer(second_buffer.get(), second_buffer->size()));
+
+  while (!buffers.empty()) {
+    TestCompletionCallback write_callback;
+    int write_result =
+        accepted_socket->WriteV(buffers, write_callback.callback());
+    write_result = write_callback.GetResult(write_result);
+    ASSERT_GT(write_result, 0);
+    while (write_result > 0) {
+      int consumed = std::min(write_result, buffers.front()->BytesRemaining());
+      buffers.front()->DidConsume(consumed);
+      write_result -= consumed;
+      if (buffers.front()->BytesRemaining() == 0)
+        buffers.erase(buffers.begin());
+    }
+  }
+
+  std::vector<char> buffer(message.size());
+  size_t bytes_read = 0;
+  while (bytes_read < message.size()) {
+    scoped_refptr<IOBufferWithSize> read_buffer(
+        new IOBufferWithSize(message.size() - bytes_read));
+    TestCompletionCallback read_callback;
+    int read_result = connecting_socket.Read(
+        read_buffer.get(), read_buffer->size(), read_callback.callback());
+    read_result = read_callback.GetResult(read_result);
+    ASSERT_TRUE(read_result >= 0);
+    ASSERT_TRUE(bytes_read + read_result <= message.size());
+    memmove(&buffer[bytes_read], read_buffer->data(), read_result);
+    bytes_read += read_result;
+  }
+
+  std::string received_message(buffer.begin(), buffer.end());
+  ASSERT_EQ(message, received_message);
+}
+
 }  // namespace
 }  // namespace net
@@ -500,6 +500,14 @@ int TCPSocketWin::Read(IOBuffer* buf,
   return DoRead(buf, buf_len, callback);
 }
 
+int TCPSocketWin::WriteV(
+    const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(!buffers.empty());
+  DrainableIOBuffer* front = buffers.front().get();
+  return Write(front, front->BytesRemaining(), callback);
+}
+
 int TCPSocketWin::Write(IOBuffer* buf,
                         int buf_len,
                         const CompletionCallback& callback) {
@@ -624,6 +632,13 @@ int TCPSocketWin::SetExclusiveAddrUse() {
   return OK;
 }
 
+int TCPSocketWin::SetPortReuse(bool allow) {
+  // Windows has no counterpart of SO_REUSEPORT that balances incoming
+  // connections across several listening sockets, and SO_REUSEADDR would let
+  // the end point be hijacked (see SetExclusiveAddrUse() above).
+  return ERR_NOT_IMPLEMENTED;
+}
+
 int TCPSocketWin::SetReceiveBufferSize(int32 size) {
   DCHECK(CalledOnValidThread());
   return SetSocketReceiveBufferSize(socket_, size);
@@ -845,8 +860,8 @@ void TCPSocketWin::DoConnectComplete(int result) {
   int os_error = connect_os_error_;
   connect_os_error_ = 0;
   if (result != OK) {
-    net_log_.EndEvent(NetLog::TYPE_TCP_CONNECT_ATTEMPT,
-                      NetLog::IntCallback("os_error", os_error));
+    net_log_.EndEventWithIntParams(NetLog::TYPE_TCP_CONNECT_ATTEMPT, "os_error",
+                                   os_error);
   } else {
     net_log_.EndEvent(NetLog::TYPE_TCP_CONNECT_ATTEMPT);
   }
@@ -7,6 +7,8 @@
 
 #include <winsock2.h>
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
@@ -21,6 +23,7 @@
 namespace net {
 
 class AddressList;
+class DrainableIOBuffer;
 class IOBuffer;
 class IPEndPoint;
 
@@ -55,6 +58,11 @@ class NET_EXPORT TCPSocketWin : NON_EXPORTED_BASE(public base::NonThreadSafe),
   int Read(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
   int Write(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
 
+  // No gather path on Windows yet: writes the front buffer only, which is a
+  // valid short write under Socket::WriteV() semantics.
+  int WriteV(const std::vector<scoped_refptr<DrainableIOBuffer>>& buffers,
+             const CompletionCallback& callback);
+
   int GetLocalAddress(IPEndPoint* address) const;
   int GetPeerAddress(IPEndPoint* address) const;
 
@@ -68,6 +76,7 @@ class NET_EXPORT TCPSocketWin : NON_EXPORTED_BASE(public base::NonThreadSafe),
   // - SetKeepAlive(true, 45).
   void SetDefaultOptionsForClient();
   int SetExclusiveAddrUse();
+  int SetPortReuse(bool allow);
   int SetReceiveBufferSize(int32 size);
   int SetSendBufferSize(int32 size);
   bool SetKeepAlive(bool enable, int delay);
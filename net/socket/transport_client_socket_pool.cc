@@ -18,6 +18,7 @@
 #include "base/values.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
+#include "net/base/network_change_notifier.h"
 #include "net/log/net_log.h"
 #include "net/socket/client_socket_factory.h"
 #include "net/socket/client_socket_handle.h"
@@ -34,6 +35,11 @@ namespace net {
 // don't synchronize.
 const int TransportConnectJobHelper::kIPv6FallbackTimerInMs = 300;
 
+// Floor for the adaptive IPv6 fallback delay. Even on a network where IPv6
+// looks broken, IPv6 keeps a small head start so a recovered network can win
+// races again and restore the learned delay.
+const int TransportConnectJobHelper::kMinIPv6FallbackTimerInMs = 50;
+
 namespace {
 
 // Returns true iff all addresses in |list| are in the IPv6 family.
@@ -47,6 +53,44 @@ bool AddressListOnlyContainsIPv6(const AddressList& list) {
   return true;
 }
 
+// The delay before the IPv4 fallback connect starts, learned from observed
+// IPv6/IPv4 race outcomes. The value describes the current network, so it is
+// reset to the default when the machine's IP addresses change. All connect
+// jobs in the process share it, like |g_last_connect_time| below.
+class IPv6FallbackDelay : public NetworkChangeNotifier::IPAddressObserver {
+ public:
+  IPv6FallbackDelay()
+      : delay_ms_(TransportConnectJobHelper::kIPv6FallbackTimerInMs) {
+    NetworkChangeNotifier::AddIPAddressObserver(this);
+  }
+  ~IPv6FallbackDelay() override {
+    NetworkChangeNotifier::RemoveIPAddressObserver(this);
+  }
+
+  int get() {
+    base::AutoLock lock(lock_);
+    return delay_ms_;
+  }
+
+  void set(int delay_ms) {
+    base::AutoLock lock(lock_);
+    delay_ms_ = delay_ms;
+  }
+
+  // NetworkChangeNotifier::IPAddressObserver implementation.
+  void OnIPAddressChanged() override {
+    set(TransportConnectJobHelper::kIPv6FallbackTimerInMs);
+  }
+
+ private:
+  // Protects |delay_ms_|; connect jobs may run on multiple threads.
+  base::Lock lock_;
+  int delay_ms_;
+};
+
+base::LazyInstance<IPv6FallbackDelay>::Leaky g_ipv6_fallback_delay =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 // This lock protects |g_last_connect_time|.
@@ -189,9 +233,50 @@ base::TimeDelta TransportConnectJobHelper::HistogramDuration(
       break;
   }
 
+  AdaptIPv6FallbackDelay(race_result, connect_duration);
+
   return connect_duration;
 }
 
+// static
+base::TimeDelta TransportConnectJobHelper::GetIPv6FallbackDelay() {
+  return base::TimeDelta::FromMilliseconds(g_ipv6_fallback_delay.Get().get());
+}
+
+// static
+void TransportConnectJobHelper::ResetIPv6FallbackDelayForTesting() {
+  g_ipv6_fallback_delay.Get().set(kIPv6FallbackTimerInMs);
+}
+
+// static
+void TransportConnectJobHelper::AdaptIPv6FallbackDelay(
+    ConnectionLatencyHistogram race_result,
+    base::TimeDelta connect_duration) {
+  IPv6FallbackDelay* delay = g_ipv6_fallback_delay.Pointer();
+  switch (race_result) {
+    case CONNECTION_LATENCY_IPV4_WINS_RACE:
+      // IPv6 had its head start and lost. Back the delay off so a network
+      // with broken IPv6 does not pay the full delay on every fresh
+      // connection.
+      delay->set(std::max(kMinIPv6FallbackTimerInMs, delay->get() / 2));
+      break;
+
+    case CONNECTION_LATENCY_IPV6_RACEABLE:
+      // IPv6 won against a dual-stack destination. Track twice the observed
+      // IPv6 connect time so a slower but working IPv6 network is not raced
+      // needlessly, capped at the default.
+      delay->set(std::min(
+          kIPv6FallbackTimerInMs,
+          std::max(kMinIPv6FallbackTimerInMs,
+                   2 * static_cast<int>(connect_duration.InMilliseconds()))));
+      break;
+
+    default:
+      // IPv4-only or IPv6-only destinations say nothing about the race.
+      break;
+  }
+}
+
 TransportConnectJob::TransportConnectJob(
     const std::string& group_name,
     RequestPriority priority,
@@ -317,8 +402,7 @@ int TransportConnectJob::DoTransportConnect() {
   if (rv == ERR_IO_PENDING && try_ipv6_connect_with_ipv4_fallback) {
     fallback_timer_.Start(
         FROM_HERE,
-        base::TimeDelta::FromMilliseconds(
-            TransportConnectJobHelper::kIPv6FallbackTimerInMs),
+        TransportConnectJobHelper::GetIPv6FallbackDelay(),
         this,
         &TransportConnectJob::DoIPv6FallbackTransportConnect);
   }
@@ -503,6 +587,25 @@ base::TimeDelta
   return base::TimeDelta::FromSeconds(kTransportConnectJobTimeoutInSeconds);
 }
 
+// The burst size matches the default limit of sockets per group, so a single
+// group's preconnect is never staggered. The interval is short: the point is
+// to spread resolver and timer work over a few ticks, not to delay warmup.
+const int TransportClientSocketPool::kPreconnectBurstSize = 6;
+const int TransportClientSocketPool::kPreconnectTokenIntervalMs = 10;
+
+TransportClientSocketPool::PreconnectRequest::PreconnectRequest(
+    const std::string& group_name,
+    const scoped_refptr<TransportSocketParams>& params,
+    int num_sockets)
+    : group_name(group_name), params(params), num_sockets(num_sockets) {}
+
+TransportClientSocketPool::PreconnectRequest::~PreconnectRequest() {}
+
+TransportClientSocketPool::PendingPreconnect::PendingPreconnect()
+    : num_sockets(0), num_issued(0) {}
+
+TransportClientSocketPool::PendingPreconnect::~PendingPreconnect() {}
+
 TransportClientSocketPool::TransportClientSocketPool(
     int max_sockets,
     int max_sockets_per_group,
@@ -516,7 +619,8 @@ TransportClientSocketPool::TransportClientSocketPool(
             ClientSocketPool::used_idle_socket_timeout(),
             new TransportConnectJobFactory(client_socket_factory,
                                            host_resolver,
-                                           net_log)) {
+                                           net_log)),
+      preconnect_tokens_(kPreconnectBurstSize) {
   base_.EnableConnectBackupJobs();
 }
 
@@ -569,12 +673,93 @@ void TransportClientSocketPool::RequestSockets(
   base_.RequestSockets(group_name, *casted_params, num_sockets, net_log);
 }
 
+void TransportClientSocketPool::RequestSocketsBatch(
+    const std::vector<PreconnectRequest>& requests,
+    const BoundNetLog& net_log) {
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const PreconnectRequest& request = requests[i];
+    DCHECK_GT(request.num_sockets, 0);
+
+    // Merge duplicate groups, keeping the largest socket count. The merged
+    // entry keeps its queue position.
+    bool merged = false;
+    for (std::deque<PendingPreconnect>::iterator it =
+             pending_preconnects_.begin();
+         it != pending_preconnects_.end(); ++it) {
+      if (it->group_name == request.group_name) {
+        it->num_sockets = std::max(it->num_sockets, request.num_sockets);
+        merged = true;
+        break;
+      }
+    }
+    if (merged)
+      continue;
+
+    PendingPreconnect pending;
+    pending.group_name = request.group_name;
+    pending.params = request.params;
+    pending.num_sockets = request.num_sockets;
+    pending.net_log = net_log;
+    pending_preconnects_.push_back(pending);
+  }
+
+  DrainPreconnectQueue();
+}
+
+void TransportClientSocketPool::DrainPreconnectQueue() {
+  // Refill the token bucket from the time elapsed since the last refill.
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (last_preconnect_token_time_.is_null()) {
+    last_preconnect_token_time_ = now;
+  } else {
+    int64 refill = (now - last_preconnect_token_time_).InMilliseconds() /
+                   kPreconnectTokenIntervalMs;
+    if (refill > 0) {
+      preconnect_tokens_ = static_cast<int>(
+          std::min(static_cast<int64>(kPreconnectBurstSize),
+                   preconnect_tokens_ + refill));
+      last_preconnect_token_time_ += base::TimeDelta::FromMilliseconds(
+          refill * kPreconnectTokenIntervalMs);
+    }
+  }
+
+  while (!pending_preconnects_.empty() && preconnect_tokens_ > 0) {
+    PendingPreconnect& front = pending_preconnects_.front();
+    int grant = std::min(front.num_sockets - front.num_issued,
+                         preconnect_tokens_);
+    front.num_issued += grant;
+    preconnect_tokens_ -= grant;
+    // RequestSockets() ensures a total for the group, so issuing a growing
+    // target tops the group up as tokens arrive.
+    RequestSockets(front.group_name, &front.params, front.num_issued,
+                   front.net_log);
+    if (front.num_issued == front.num_sockets)
+      pending_preconnects_.pop_front();
+  }
+
+  if (pending_preconnects_.empty()) {
+    preconnect_timer_.Stop();
+  } else if (!preconnect_timer_.IsRunning()) {
+    preconnect_timer_.Start(
+        FROM_HERE,
+        base::TimeDelta::FromMilliseconds(kPreconnectTokenIntervalMs),
+        this,
+        &TransportClientSocketPool::DrainPreconnectQueue);
+  }
+}
+
 void TransportClientSocketPool::CancelRequest(
     const std::string& group_name,
     ClientSocketHandle* handle) {
   base_.CancelRequest(group_name, handle);
 }
 
+void TransportClientSocketPool::SetPriority(const std::string& group_name,
+                                            ClientSocketHandle* handle,
+                                            RequestPriority priority) {
+  base_.SetPriority(group_name, handle, priority);
+}
+
 void TransportClientSocketPool::ReleaseSocket(
     const std::string& group_name,
     scoped_ptr<StreamSocket> socket,
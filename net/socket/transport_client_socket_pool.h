@@ -5,7 +5,9 @@
 #ifndef NET_SOCKET_TRANSPORT_CLIENT_SOCKET_POOL_H_
 #define NET_SOCKET_TRANSPORT_CLIENT_SOCKET_POOL_H_
 
+#include <deque>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
@@ -126,15 +128,36 @@ class NET_EXPORT_PRIVATE TransportConnectJobHelper {
   void OnIOComplete(T* job, int result);
 
   // Record the histograms Net.DNS_Resolution_And_TCP_Connection_Latency2 and
-  // Net.TCP_Connection_Latency and return the connect duration.
+  // Net.TCP_Connection_Latency and return the connect duration. Also feeds
+  // the race outcome into the adaptive IPv6 fallback delay.
   base::TimeDelta HistogramDuration(ConnectionLatencyHistogram race_result);
 
+  // Returns the delay before the IPv4 fallback connect is started when racing
+  // it against IPv6 ("Happy Eyeballs"). Starts at kIPv6FallbackTimerInMs and
+  // adapts to race outcomes observed on the current network: it backs off
+  // toward kMinIPv6FallbackTimerInMs while IPv4 keeps winning races and
+  // follows the observed IPv6 connect time while IPv6 wins. The learned value
+  // is shared by TransportConnectJob and WebSocketTransportConnectJob and is
+  // reset when the machine's IP addresses change.
+  static base::TimeDelta GetIPv6FallbackDelay();
+
+  // Restores the learned fallback delay to the default. The learned value is
+  // shared process-wide, so tests that depend on fallback timing call this to
+  // isolate themselves from races observed by earlier tests.
+  static void ResetIPv6FallbackDelayForTesting();
+
   static const int kIPv6FallbackTimerInMs;
+  static const int kMinIPv6FallbackTimerInMs;
 
  private:
   template <class T>
   int DoLoop(T* job, int result);
 
+  // Updates the learned IPv6 fallback delay with the outcome of one
+  // dual-stack connect; see GetIPv6FallbackDelay().
+  static void AdaptIPv6FallbackDelay(ConnectionLatencyHistogram race_result,
+                                     base::TimeDelta connect_duration);
+
   scoped_refptr<TransportSocketParams> params_;
   ClientSocketFactory* const client_socket_factory_;
   SingleRequestHostResolver resolver_;
@@ -228,6 +251,18 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
  public:
   typedef TransportSocketParams SocketParams;
 
+  // One entry of a batched preconnect; see RequestSocketsBatch().
+  struct NET_EXPORT_PRIVATE PreconnectRequest {
+    PreconnectRequest(const std::string& group_name,
+                      const scoped_refptr<TransportSocketParams>& params,
+                      int num_sockets);
+    ~PreconnectRequest();
+
+    std::string group_name;
+    scoped_refptr<TransportSocketParams> params;
+    int num_sockets;
+  };
+
   TransportClientSocketPool(
       int max_sockets,
       int max_sockets_per_group,
@@ -248,8 +283,23 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
                       const void* params,
                       int num_sockets,
                       const BoundNetLog& net_log) override;
+
+  // Batched form of RequestSockets() for page-load warmup. Entries with the
+  // same group name are merged, with the largest socket count winning, so a
+  // warmup list cannot double-preconnect a host. Connect jobs are started
+  // through a token bucket: the first kPreconnectBurstSize start immediately
+  // and further jobs one per kPreconnectTokenIntervalMs, so a list of 30+
+  // preconnects does not start that many resolver jobs and backup timers in
+  // a single tick. Concurrent jobs for one group already share a resolution
+  // in HostResolverImpl.
+  void RequestSocketsBatch(const std::vector<PreconnectRequest>& requests,
+                           const BoundNetLog& net_log);
+
   void CancelRequest(const std::string& group_name,
                      ClientSocketHandle* handle) override;
+  void SetPriority(const std::string& group_name,
+                   ClientSocketHandle* handle,
+                   RequestPriority priority) override;
   void ReleaseSocket(const std::string& group_name,
                      scoped_ptr<StreamSocket> socket,
                      int id) override;
@@ -270,6 +320,10 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
   void AddHigherLayeredPool(HigherLayeredPool* higher_pool) override;
   void RemoveHigherLayeredPool(HigherLayeredPool* higher_pool) override;
 
+  // Token bucket parameters for RequestSocketsBatch().
+  static const int kPreconnectBurstSize;
+  static const int kPreconnectTokenIntervalMs;
+
  protected:
   // Methods shared with WebSocketTransportClientSocketPool
   void NetLogTcpClientSocketPoolRequestedSocket(
@@ -308,8 +362,33 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
     DISALLOW_COPY_AND_ASSIGN(TransportConnectJobFactory);
   };
 
+  // A batched preconnect entry not yet fully issued to the pool.
+  struct PendingPreconnect {
+    PendingPreconnect();
+    ~PendingPreconnect();
+
+    std::string group_name;
+    scoped_refptr<TransportSocketParams> params;
+    // Target number of sockets for the group.
+    int num_sockets;
+    // Sockets already requested from the pool.
+    int num_issued;
+    BoundNetLog net_log;
+  };
+
+  // Issues queued batch preconnects as token bucket capacity allows, and
+  // keeps |preconnect_timer_| running while entries remain queued.
+  void DrainPreconnectQueue();
+
   PoolBase base_;
 
+  // State for RequestSocketsBatch(). Entries in |pending_preconnects_| always
+  // have |num_issued| < |num_sockets|.
+  std::deque<PendingPreconnect> pending_preconnects_;
+  int preconnect_tokens_;
+  base::TimeTicks last_preconnect_token_time_;
+  base::RepeatingTimer preconnect_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(TransportClientSocketPool);
 };
 
@@ -8,6 +8,7 @@
 #include "base/bind_helpers.h"
 #include "base/callback.h"
 #include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
 #include "base/threading/platform_thread.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/load_timing_info.h"
@@ -52,6 +53,7 @@ class TransportClientSocketPoolTest : public testing::Test {
               host_resolver_.get(),
               &client_socket_factory_,
               NULL) {
+    TransportConnectJobHelper::ResetIPv6FallbackDelayForTesting();
   }
 
   ~TransportClientSocketPoolTest() override {
@@ -1132,6 +1134,45 @@ TEST_F(TransportClientSocketPoolTest,
   EXPECT_FALSE(handle.socket()->UsingTCPFastOpen());
 }
 
+TEST_F(TransportClientSocketPoolTest, RequestSocketsBatch) {
+  host_resolver_->set_synchronous_mode(true);
+
+  scoped_refptr<TransportSocketParams> params_b(new TransportSocketParams(
+      HostPortPair("www.batch.com", 80), false, false,
+      OnHostResolutionCallback(),
+      TransportSocketParams::COMBINE_CONNECT_AND_WRITE_DEFAULT));
+
+  std::vector<TransportClientSocketPool::PreconnectRequest> requests;
+  requests.push_back(
+      TransportClientSocketPool::PreconnectRequest("a", params_, 1));
+  // Duplicate groups are merged; the largest count wins.
+  requests.push_back(
+      TransportClientSocketPool::PreconnectRequest("a", params_, 2));
+  requests.push_back(TransportClientSocketPool::PreconnectRequest(
+      "b", params_b, TransportClientSocketPool::kPreconnectBurstSize));
+  pool_.RequestSocketsBatch(requests, BoundNetLog());
+
+  // The initial burst covers the first kPreconnectBurstSize connects; the
+  // rest start only as the token bucket refills.
+  EXPECT_EQ(2, pool_.IdleSocketCountInGroup("a"));
+  EXPECT_EQ(TransportClientSocketPool::kPreconnectBurstSize - 2,
+            pool_.IdleSocketCountInGroup("b"));
+  EXPECT_EQ(TransportClientSocketPool::kPreconnectBurstSize,
+            client_socket_factory_.allocation_count());
+
+  while (pool_.IdleSocketCountInGroup("b") <
+         TransportClientSocketPool::kPreconnectBurstSize) {
+    base::RunLoop run_loop;
+    base::MessageLoop::current()->PostDelayedTask(
+        FROM_HERE, run_loop.QuitClosure(),
+        base::TimeDelta::FromMilliseconds(
+            TransportClientSocketPool::kPreconnectTokenIntervalMs));
+    run_loop.Run();
+  }
+  EXPECT_EQ(TransportClientSocketPool::kPreconnectBurstSize + 2,
+            client_socket_factory_.allocation_count());
+}
+
 }  // namespace
 
 }  // namespace net
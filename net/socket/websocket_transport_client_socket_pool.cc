@@ -135,8 +135,7 @@ int WebSocketTransportConnectJob::DoTransportConnect() {
           // owned by this object.
           fallback_timer_.Start(
               FROM_HERE,
-              TimeDelta::FromMilliseconds(
-                  TransportConnectJobHelper::kIPv6FallbackTimerInMs),
+              TransportConnectJobHelper::GetIPv6FallbackDelay(),
               base::Bind(&WebSocketTransportConnectJob::StartIPv4JobAsync,
                          base::Unretained(this)));
         }
@@ -375,6 +374,15 @@ void WebSocketTransportClientSocketPool::CancelRequest(
     ActivateStalledRequest();
 }
 
+void WebSocketTransportClientSocketPool::SetPriority(
+    const std::string& group_name,
+    ClientSocketHandle* handle,
+    RequestPriority priority) {
+  // WebSocket connections are all issued at the same priority, and the
+  // stalled request queue is deliberately FIFO, so there is nothing to
+  // reprioritize.
+}
+
 void WebSocketTransportClientSocketPool::ReleaseSocket(
     const std::string& group_name,
     scoped_ptr<StreamSocket> socket,
@@ -64,7 +64,9 @@ class WebSocketTransportClientSocketPoolTest : public ::testing::Test {
               kMaxSocketsPerGroup,
               host_resolver_.get(),
               &client_socket_factory_,
-              NULL) {}
+              NULL) {
+    TransportConnectJobHelper::ResetIPv6FallbackDelayForTesting();
+  }
 
   ~WebSocketTransportClientSocketPoolTest() override {
     RunUntilIdle();
@@ -13,8 +13,52 @@ namespace {
 // GOAWAY frame debug data is only buffered up to this many bytes.
 size_t kGoAwayDebugDataMaxSize = 1024;
 
+const char kCookieKey[] = "cookie";
+
 }  // namespace
 
+BufferedSpdyFramer::HeaderCoalescer::HeaderCoalescer()
+    : header_bytes_received_(0),
+      error_seen_(false) {
+}
+
+void BufferedSpdyFramer::HeaderCoalescer::OnHeaderBlockStart() {
+  Clear();
+}
+
+void BufferedSpdyFramer::HeaderCoalescer::OnHeader(base::StringPiece key,
+                                                   base::StringPiece value) {
+  if (error_seen_)
+    return;
+  header_bytes_received_ += key.size() + value.size();
+  if (header_bytes_received_ > kHeaderBufferSize) {
+    error_seen_ = true;
+    headers_.clear();
+    return;
+  }
+  auto it = headers_.find(key);
+  if (it == headers_.end()) {
+    headers_[key] = value;
+  } else {
+    // This key has repeated values; join them as the HPACK decoder's
+    // buffered path does.
+    std::string new_value = it->second.as_string();
+    new_value.append((key == kCookieKey) ? "; " : std::string(1, '\0'));
+    value.AppendToString(&new_value);
+    headers_.ReplaceOrAppendHeader(key, new_value);
+  }
+}
+
+void BufferedSpdyFramer::HeaderCoalescer::OnHeaderBlockEnd(
+    size_t header_bytes_parsed) {
+}
+
+void BufferedSpdyFramer::HeaderCoalescer::Clear() {
+  headers_.clear();
+  header_bytes_received_ = 0;
+  error_seen_ = false;
+}
+
 SpdyMajorVersion NextProtoToSpdyMajorVersion(NextProto next_proto) {
   switch (next_proto) {
     case kProtoDeprecatedSPDY2:
@@ -133,41 +177,7 @@ bool BufferedSpdyFramer::OnControlFrameHeaderData(SpdyStreamId stream_id,
           stream_id, "Could not parse Spdy Control Frame Header.");
       return false;
     }
-    DCHECK(control_frame_fields_.get());
-    switch (control_frame_fields_->type) {
-      case SYN_STREAM:
-        visitor_->OnSynStream(control_frame_fields_->stream_id,
-                              control_frame_fields_->associated_stream_id,
-                              control_frame_fields_->priority,
-                              control_frame_fields_->fin,
-                              control_frame_fields_->unidirectional,
-                              headers);
-        break;
-      case SYN_REPLY:
-        visitor_->OnSynReply(control_frame_fields_->stream_id,
-                             control_frame_fields_->fin,
-                             headers);
-        break;
-      case HEADERS:
-        visitor_->OnHeaders(control_frame_fields_->stream_id,
-                            control_frame_fields_->has_priority,
-                            control_frame_fields_->priority,
-                            control_frame_fields_->parent_stream_id,
-                            control_frame_fields_->exclusive,
-                            control_frame_fields_->fin, headers);
-        break;
-      case PUSH_PROMISE:
-        DCHECK_LT(SPDY3, protocol_version());
-        visitor_->OnPushPromise(control_frame_fields_->stream_id,
-                                control_frame_fields_->promised_stream_id,
-                                headers);
-        break;
-      default:
-        DCHECK(false) << "Unexpect control frame type: "
-                      << control_frame_fields_->type;
-        break;
-    }
-    control_frame_fields_.reset(NULL);
+    DeliverHeaderBlock(headers);
     return true;
   }
 
@@ -204,12 +214,21 @@ void BufferedSpdyFramer::OnStreamPadding(SpdyStreamId stream_id, size_t len) {
 
 SpdyHeadersHandlerInterface* BufferedSpdyFramer::OnHeaderFrameStart(
     SpdyStreamId stream_id) {
-  return visitor_->OnHeaderFrameStart(stream_id);
+  return &header_coalescer_;
 }
 
 void BufferedSpdyFramer::OnHeaderFrameEnd(SpdyStreamId stream_id,
                                           bool end_headers) {
-  visitor_->OnHeaderFrameEnd(stream_id, end_headers);
+  if (!end_headers)
+    return;
+  if (header_coalescer_.error_seen()) {
+    visitor_->OnStreamError(
+        stream_id, "Received more data than the allocated size.");
+    control_frame_fields_.reset(NULL);
+  } else {
+    DeliverHeaderBlock(header_coalescer_.headers());
+  }
+  header_coalescer_.Clear();
 }
 
 void BufferedSpdyFramer::OnSettings(bool clear_persisted) {
@@ -442,11 +461,53 @@ SpdyPriority BufferedSpdyFramer::GetHighestPriority() const {
 }
 
 void BufferedSpdyFramer::InitHeaderStreaming(SpdyStreamId stream_id) {
-  memset(header_buffer_, 0, kHeaderBufferSize);
-  header_buffer_used_ = 0;
-  header_buffer_valid_ = true;
+  if (protocol_version() <= SPDY3) {
+    // HTTP/2 header blocks bypass |header_buffer_|; they are delivered
+    // directly to |header_coalescer_| as they are decoded.
+    memset(header_buffer_, 0, kHeaderBufferSize);
+    header_buffer_used_ = 0;
+    header_buffer_valid_ = true;
+  }
   header_stream_id_ = stream_id;
   DCHECK_NE(header_stream_id_, SpdyFramer::kInvalidStream);
 }
 
+void BufferedSpdyFramer::DeliverHeaderBlock(const SpdyHeaderBlock& headers) {
+  DCHECK(control_frame_fields_.get());
+  switch (control_frame_fields_->type) {
+    case SYN_STREAM:
+      visitor_->OnSynStream(control_frame_fields_->stream_id,
+                            control_frame_fields_->associated_stream_id,
+                            control_frame_fields_->priority,
+                            control_frame_fields_->fin,
+                            control_frame_fields_->unidirectional,
+                            headers);
+      break;
+    case SYN_REPLY:
+      visitor_->OnSynReply(control_frame_fields_->stream_id,
+                           control_frame_fields_->fin,
+                           headers);
+      break;
+    case HEADERS:
+      visitor_->OnHeaders(control_frame_fields_->stream_id,
+                          control_frame_fields_->has_priority,
+                          control_frame_fields_->priority,
+                          control_frame_fields_->parent_stream_id,
+                          control_frame_fields_->exclusive,
+                          control_frame_fields_->fin, headers);
+      break;
+    case PUSH_PROMISE:
+      DCHECK_LT(SPDY3, protocol_version());
+      visitor_->OnPushPromise(control_frame_fields_->stream_id,
+                              control_frame_fields_->promised_stream_id,
+                              headers);
+      break;
+    default:
+      DCHECK(false) << "Unexpect control frame type: "
+                    << control_frame_fields_->type;
+      break;
+  }
+  control_frame_fields_.reset(NULL);
+}
+
 }  // namespace net
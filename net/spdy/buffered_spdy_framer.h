@@ -13,6 +13,7 @@
 #include "net/socket/next_proto.h"
 #include "net/spdy/spdy_framer.h"
 #include "net/spdy/spdy_header_block.h"
+#include "net/spdy/spdy_headers_handler_interface.h"
 #include "net/spdy/spdy_protocol.h"
 
 namespace net {
@@ -77,20 +78,6 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramerVisitorInterface {
   // |len| The number of padding octets.
   virtual void OnStreamPadding(SpdyStreamId stream_id, size_t len) = 0;
 
-  // Called just before processing the payload of a frame containing header
-  // data. Should return an implementation of SpdyHeadersHandlerInterface that
-  // will receive headers for stream |stream_id|. The caller will not take
-  // ownership of the headers handler. The same instance should be returned
-  // for all header frames comprising a logical header block (i.e. until
-  // OnHeaderFrameEnd() is called with end_headers == true).
-  virtual SpdyHeadersHandlerInterface* OnHeaderFrameStart(
-      SpdyStreamId stream_id) = 0;
-
-  // Called after processing the payload of a frame containing header data.
-  // |end_headers| is true if there will not be any subsequent CONTINUATION
-  // frames.
-  virtual void OnHeaderFrameEnd(SpdyStreamId stream_id, bool end_headers) = 0;
-
   // Called when a SETTINGS frame is received.
   // |clear_persisted| True if the respective flag is set on the SETTINGS frame.
   virtual void OnSettings(bool clear_persisted) = 0;
@@ -277,12 +264,43 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramer
   // The size of the header_buffer_.
   enum { kHeaderBufferSize = 32 * 1024 };
 
+  // Collects headers emitted by the framer's HPACK decoder into a
+  // SpdyHeaderBlock, joining repeated keys as the decoder's buffered path
+  // would: Cookie crumbs are rejoined with "; ", other repeats with '\0'.
+  class HeaderCoalescer : public SpdyHeadersHandlerInterface {
+   public:
+    HeaderCoalescer();
+
+    // SpdyHeadersHandlerInterface
+    void OnHeaderBlockStart() override;
+    void OnHeader(base::StringPiece key, base::StringPiece value) override;
+    void OnHeaderBlockEnd(size_t header_bytes_parsed) override;
+
+    const SpdyHeaderBlock& headers() const { return headers_; }
+    // Whether the block so far has exceeded kHeaderBufferSize.
+    bool error_seen() const { return error_seen_; }
+    void Clear();
+
+   private:
+    SpdyHeaderBlock headers_;
+    size_t header_bytes_received_;
+    bool error_seen_;
+  };
+
   void InitHeaderStreaming(SpdyStreamId stream_id);
 
+  // Dispatches a complete header block to |visitor_| according to the
+  // buffered |control_frame_fields_|.
+  void DeliverHeaderBlock(const SpdyHeaderBlock& headers);
+
   SpdyFramer spdy_framer_;
   BufferedSpdyFramerVisitorInterface* visitor_;
 
-  // Header block streaming state:
+  // Receives HPACK-decoded headers directly from the framer, making
+  // |header_buffer_| unnecessary for HTTP/2 sessions.
+  HeaderCoalescer header_coalescer_;
+
+  // Header block streaming state, used only for SPDY (zlib) header blocks:
   char header_buffer_[kHeaderBufferSize];
   size_t header_buffer_used_;
   bool header_buffer_valid_;
@@ -88,16 +88,6 @@ class TestBufferedSpdyVisitor : public BufferedSpdyFramerVisitorInterface {
     LOG(FATAL) << "Unexpected OnStreamPadding call.";
   }
 
-  SpdyHeadersHandlerInterface* OnHeaderFrameStart(
-      SpdyStreamId stream_id) override {
-    LOG(FATAL) << "Unexpected OnHeaderFrameStart call.";
-    return nullptr;
-  }
-
-  void OnHeaderFrameEnd(SpdyStreamId stream_id, bool end_headers) override {
-    LOG(FATAL) << "Unexpected OnHeaderFrameEnd call.";
-  }
-
   void OnSettings(bool clear_persisted) override {}
 
   void OnSetting(SpdySettingsIds id, uint8 flags, uint32 value) override {
@@ -303,6 +293,31 @@ TEST_P(BufferedSpdyFramerTest, ReadHeadersHeaderBlock) {
   EXPECT_EQ(headers, visitor.headers_);
 }
 
+TEST_P(BufferedSpdyFramerTest, ReadHeadersHeaderBlockWithCookies) {
+  if (spdy_version() < HTTP2)
+    return;
+  // HPACK crumbles the Cookie header into individual crumbs on the wire;
+  // the receiving side must reassemble them into a single value.
+  SpdyHeaderBlock headers;
+  headers["alpha"] = "beta";
+  headers["cookie"] = "key1=value1; key2=value2";
+  BufferedSpdyFramer framer(spdy_version(), true);
+  scoped_ptr<SpdyFrame> control_frame(
+      framer.CreateHeaders(1,                        // stream_id
+                           CONTROL_FLAG_NONE,
+                           0,                        // priority
+                           &headers));
+  EXPECT_TRUE(control_frame.get() != NULL);
+
+  TestBufferedSpdyVisitor visitor(spdy_version());
+  visitor.SimulateInFramer(
+      reinterpret_cast<unsigned char*>(control_frame.get()->data()),
+      control_frame.get()->size());
+  EXPECT_EQ(0, visitor.error_count_);
+  EXPECT_EQ(1, visitor.headers_frame_count_);
+  EXPECT_EQ(headers, visitor.headers_);
+}
+
 TEST_P(BufferedSpdyFramerTest, ReadPushPromiseHeaderBlock) {
   if (spdy_version() < HTTP2)
     return;
@@ -23,12 +23,26 @@ HpackEncoder::HpackEncoder(const HpackHuffmanTable& table)
       huffman_table_(table),
       min_table_size_setting_received_(std::numeric_limits<size_t>::max()),
       allow_huffman_compression_(true),
-      should_emit_table_size_(false) {}
+      should_emit_table_size_(false),
+      last_encode_reusable_(false) {}
 
 HpackEncoder::~HpackEncoder() {}
 
 bool HpackEncoder::EncodeHeaderSet(const SpdyHeaderBlock& header_set,
                                    string* output) {
+  // Connections commonly carry long runs of near-identical requests. Once a
+  // set has encoded entirely as index representations, the header table is
+  // left untouched; encoding an identical set again would reproduce the same
+  // bytes with no side effects, so serve it from the memo instead.
+  if (last_encode_reusable_ && !should_emit_table_size_ &&
+      header_set == last_header_set_) {
+    *output = last_encoded_output_;
+    return true;
+  }
+  // Tentatively reusable. Emitting a table size update or an incrementally
+  // indexed literal below clears this.
+  last_encode_reusable_ = !should_emit_table_size_;
+
   MaybeEmitTableSize();
   // Separate header set into pseudo-headers and regular headers.
   Representations pseudo_headers;
@@ -84,6 +98,11 @@ bool HpackEncoder::EncodeHeaderSet(const SpdyHeaderBlock& header_set,
   }
 
   output_stream_.TakeString(output);
+
+  if (last_encode_reusable_) {
+    last_header_set_ = header_set;
+    last_encoded_output_ = *output;
+  }
   return true;
 }
 
@@ -111,6 +130,8 @@ void HpackEncoder::ApplyHeaderTableSizeSetting(size_t size_setting) {
   }
   header_table_.SetSettingsHeaderTableSize(size_setting);
   should_emit_table_size_ = true;
+  // Shrinking the table may evict entries, shifting dynamic indices.
+  last_encode_reusable_ = false;
 }
 
 void HpackEncoder::EmitIndex(const HpackEntry* entry) {
@@ -122,6 +143,9 @@ void HpackEncoder::EmitIndexedLiteral(const Representation& representation) {
   output_stream_.AppendPrefix(kLiteralIncrementalIndexOpcode);
   EmitLiteral(representation);
   header_table_.TryAddEntry(representation.first, representation.second);
+  // The attempted insertion mutates the dynamic table (even a failed add may
+  // evict), so prior encodings cannot be replayed.
+  last_encode_reusable_ = false;
 }
 
 void HpackEncoder::EmitNonIndexedLiteral(const Representation& representation) {
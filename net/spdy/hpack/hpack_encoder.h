@@ -92,6 +92,14 @@ class NET_EXPORT_PRIVATE HpackEncoder {
   bool allow_huffman_compression_;
   bool should_emit_table_size_;
 
+  // Memo of the most recent header set encoded entirely as index
+  // representations. Such an encoding leaves the header table untouched, so
+  // an identical set may be re-encoded by replaying the cached bytes.
+  // |last_encode_reusable_| is cleared whenever the dynamic table mutates.
+  SpdyHeaderBlock last_header_set_;
+  std::string last_encoded_output_;
+  bool last_encode_reusable_;
+
   DISALLOW_COPY_AND_ASSIGN(HpackEncoder);
 };
 
@@ -44,6 +44,7 @@ class HpackEncoderPeer {
   }
   void EmitString(StringPiece str) { encoder_->EmitString(str); }
   void TakeString(string* out) { encoder_->output_stream_.TakeString(out); }
+  bool last_encode_reusable() const { return encoder_->last_encode_reusable_; }
   static void CookieToCrumbs(StringPiece cookie,
                              std::vector<StringPiece>* out) {
     Representations tmp;
@@ -341,6 +342,89 @@ TEST_F(HpackEncoderTest, MultipleEncodingPasses) {
   }
 }
 
+TEST_F(HpackEncoderTest, IdenticalHeaderSetsAreMemoized) {
+  SpdyHeaderBlock headers;
+  headers[key_1_->name().as_string()] = key_1_->value().as_string();
+  headers[key_2_->name().as_string()] = key_2_->value().as_string();
+
+  // The set encodes entirely as indices, leaving the header table untouched,
+  // and is memoized for replay.
+  ExpectIndex(IndexOf(key_1_));
+  ExpectIndex(IndexOf(key_2_));
+  CompareWithExpectedEncoding(headers);
+  EXPECT_TRUE(peer_.last_encode_reusable());
+
+  // Encoding the identical set replays the memoized bytes.
+  ExpectIndex(IndexOf(key_1_));
+  ExpectIndex(IndexOf(key_2_));
+  CompareWithExpectedEncoding(headers);
+  EXPECT_TRUE(peer_.last_encode_reusable());
+
+  // A different set takes the full encoding path.
+  SpdyHeaderBlock other_headers;
+  other_headers[key_2_->name().as_string()] = key_2_->value().as_string();
+  ExpectIndex(IndexOf(key_2_));
+  CompareWithExpectedEncoding(other_headers);
+}
+
+TEST_F(HpackEncoderTest, MemoNotReusedForPrefixOfMemoizedSet) {
+  SpdyHeaderBlock headers;
+  headers[key_1_->name().as_string()] = key_1_->value().as_string();
+  headers[key_2_->name().as_string()] = key_2_->value().as_string();
+
+  ExpectIndex(IndexOf(key_1_));
+  ExpectIndex(IndexOf(key_2_));
+  CompareWithExpectedEncoding(headers);
+  EXPECT_TRUE(peer_.last_encode_reusable());
+
+  // A strict prefix of the memoized set must not replay the memo, which
+  // would write the previous set's extra header onto the wire.
+  SpdyHeaderBlock prefix;
+  prefix[key_1_->name().as_string()] = key_1_->value().as_string();
+  ExpectIndex(IndexOf(key_1_));
+  CompareWithExpectedEncoding(prefix);
+
+  // A set extending the now-memoized prefix must re-encode as well.
+  ExpectIndex(IndexOf(key_1_));
+  ExpectIndex(IndexOf(key_2_));
+  CompareWithExpectedEncoding(headers);
+}
+
+TEST_F(HpackEncoderTest, MemoNotReusedAfterInsertion) {
+  // The insertion of "key3" mutates the dynamic table, so this encoding
+  // cannot be replayed.
+  ExpectIndexedLiteral("key3", "value3");
+
+  SpdyHeaderBlock headers;
+  headers["key3"] = "value3";
+  CompareWithExpectedEncoding(headers);
+  EXPECT_FALSE(peer_.last_encode_reusable());
+
+  // A second encoding finds "key3" in the table, emits only its index, and
+  // is memoized.
+  ExpectIndex(62);
+  CompareWithExpectedEncoding(headers);
+  EXPECT_TRUE(peer_.last_encode_reusable());
+}
+
+TEST_F(HpackEncoderTest, MemoInvalidatedByTableSizeUpdate) {
+  SpdyHeaderBlock headers;
+  headers[key_1_->name().as_string()] = key_1_->value().as_string();
+
+  ExpectIndex(IndexOf(key_1_));
+  CompareWithExpectedEncoding(headers);
+  EXPECT_TRUE(peer_.last_encode_reusable());
+
+  // A table size change invalidates the memo; the next encoding of the same
+  // set emits the size update rather than replaying.
+  encoder_.ApplyHeaderTableSizeSetting(1024);
+  EXPECT_FALSE(peer_.last_encode_reusable());
+
+  ExpectHeaderTableSizeUpdate(1024);
+  ExpectIndex(IndexOf(key_1_));
+  CompareWithExpectedEncoding(headers);
+}
+
 TEST_F(HpackEncoderTest, PseudoHeadersFirst) {
   SpdyHeaderBlock headers;
   // A pseudo-header that should not be indexed.
@@ -5,7 +5,6 @@
 #include "net/spdy/hpack/hpack_huffman_table.h"
 
 #include <algorithm>
-#include <cmath>
 
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
@@ -266,56 +265,58 @@ size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
 bool HpackHuffmanTable::DecodeString(HpackInputStream* in,
                                      size_t out_capacity,
                                      string* out) const {
-  // Number of decode iterations required for a 32-bit code.
-  const int kDecodeIterations = static_cast<int>(
-      std::ceil((32.f - kDecodeTableRootBits) / kDecodeTableBranchBits));
-
   out->clear();
 
   // Current input, stored in the high |bits_available| bits of |bits|.
   uint32 bits = 0;
   size_t bits_available = 0;
-  bool peeked_success = in->PeekBits(&bits_available, &bits);
 
   while (true) {
+    // Refill the high bits of |bits| from input. PeekBits() adds one byte at
+    // a time, and returns false once |bits| is full or input is exhausted.
+    while (bits_available < 32 && in->PeekBits(&bits_available, &bits)) {
+    }
+
+    // Walk the decode table hierarchy until reaching a terminal entry.
+    // Branch entries hold the length of the longest code routed through
+    // them, which always exceeds the bits the table chain has indexed;
+    // codes short enough to resolve within the root table (the common case)
+    // therefore require just this one table load.
     const DecodeTable* table = &decode_tables_[0];
     uint32 index = bits >> (32 - kDecodeTableRootBits);
+    const DecodeEntry* entry = &Entry(*table, index);
 
-    for (int i = 0; i != kDecodeIterations; i++) {
-      DCHECK_LT(index, table->size());
-      DCHECK_LT(Entry(*table, index).next_table_index, decode_tables_.size());
-
-      table = &decode_tables_[Entry(*table, index).next_table_index];
+    while (entry->length >
+           size_t(table->prefix_length) + table->indexed_length) {
+      DCHECK_LT(entry->next_table_index, decode_tables_.size());
+      table = &decode_tables_[entry->next_table_index];
       // Mask and shift the portion of the code being indexed into low bits.
       index = (bits << table->prefix_length) >> (32 - table->indexed_length);
+      entry = &Entry(*table, index);
     }
-    const DecodeEntry& entry = Entry(*table, index);
-
-    if (entry.length > bits_available) {
-      if (!peeked_success) {
-        // Unable to read enough input for a match. If only a portion of
-        // the last byte remains, this is a successful EOF condition.
-        in->ConsumeByteRemainder();
-        return !in->HasMoreData();
-      }
-    } else if (entry.length == 0) {
+
+    if (entry->length > bits_available) {
+      // Unable to read enough input for a match. If only a portion of
+      // the last byte remains, this is a successful EOF condition.
+      in->ConsumeByteRemainder();
+      return !in->HasMoreData();
+    }
+    if (entry->length == 0) {
       // The input is an invalid prefix, larger than any prefix in the table.
       return false;
-    } else {
-      if (out->size() == out_capacity) {
-        // This code would cause us to overflow |out_capacity|.
-        return false;
-      }
-      if (entry.symbol_id < 256) {
-        // Assume symbols >= 256 are used for padding.
-        out->push_back(static_cast<char>(entry.symbol_id));
-      }
-
-      in->ConsumeBits(entry.length);
-      bits = bits << entry.length;
-      bits_available -= entry.length;
     }
-    peeked_success = in->PeekBits(&bits_available, &bits);
+    if (out->size() == out_capacity) {
+      // This code would cause us to overflow |out_capacity|.
+      return false;
+    }
+    if (entry->symbol_id < 256) {
+      // Assume symbols >= 256 are used for padding.
+      out->push_back(static_cast<char>(entry->symbol_id));
+    }
+
+    in->ConsumeBits(entry->length);
+    bits = bits << entry->length;
+    bits_available -= entry->length;
   }
   NOTREACHED();
   return false;
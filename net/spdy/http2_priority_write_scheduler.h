@@ -0,0 +1,295 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_HTTP2_PRIORITY_WRITE_SCHEDULER_H_
+#define NET_SPDY_HTTP2_PRIORITY_WRITE_SCHEDULER_H_
+
+#include <vector>
+
+#include "base/logging.h"
+#include "net/spdy/spdy_priority_tree.h"
+#include "net/spdy/spdy_protocol.h"
+
+namespace net {
+
+// Maps a SPDY/3 priority value to an HTTP/2 stream weight such that
+// the relative ordering of priorities is preserved: the highest SPDY/3
+// priority (0) maps to the maximum weight, and the lowest (7) maps to
+// the minimum weight.
+inline int Spdy3PriorityToHttp2Weight(SpdyPriority priority) {
+  return ((kV3LowestPriority - priority) * (kMaxWeight - kMinWeight)) /
+             kV3LowestPriority +
+         kMinWeight;
+}
+
+// Inverse of Spdy3PriorityToHttp2Weight: maps an HTTP/2 stream weight
+// to the SPDY/3 priority value whose weight range contains it.
+inline SpdyPriority Http2WeightToSpdy3Priority(int weight) {
+  const float kPerPrioritySteps =
+      (kMaxWeight - kMinWeight) / static_cast<float>(kV3LowestPriority);
+  float priority =
+      kV3LowestPriority - (weight - kMinWeight) / kPerPrioritySteps;
+  if (priority < kV3HighestPriority) {
+    priority = kV3HighestPriority;
+  }
+  return static_cast<SpdyPriority>(priority);
+}
+
+// Class that manages the order in which streams are written using the HTTP/2
+// stream dependencies and weights described in section 5.3 of RFC 7540:
+// https://tools.ietf.org/html/rfc7540#section-5.3
+//
+// Implements the same stream registration and ready-state interface as
+// PriorityWriteScheduler, so the two can be used interchangeably by code
+// that schedules with flat SPDY/3 priorities. SPDY/3 priorities are mapped
+// onto weights of streams that depend directly on the root of the tree, so
+// streams of different priorities share bandwidth proportionally instead of
+// the lower-priority stream being starved outright. In addition, the
+// dependencies and weights of registered streams can be manipulated
+// directly for sessions that negotiate HTTP/2 priorities on the wire.
+//
+// Unlike PriorityWriteScheduler, the order in which ready streams are
+// returned is fully determined by the dependency tree: MarkStreamReady()'s
+// |add_to_front| argument has no effect, and ties between streams of equal
+// computed priority are broken arbitrarily.
+template <typename StreamIdType>
+class Http2PriorityWriteScheduler {
+ public:
+  // Creates scheduler with no streams.
+  Http2PriorityWriteScheduler() = default;
+
+  // Returns true if the given stream is currently registered.
+  bool StreamRegistered(StreamIdType stream_id) const {
+    return tree_.NodeExists(stream_id);
+  }
+
+  // Registers the given stream as a direct dependent of the root, with a
+  // weight derived from |priority|. If the stream was already registered,
+  // logs DFATAL and does nothing.
+  void RegisterStream(StreamIdType stream_id, SpdyPriority priority) {
+    RegisterStream(stream_id, kRootNodeId,
+                   Spdy3PriorityToHttp2Weight(ClampPriority(priority)), false);
+  }
+
+  // Registers the given stream as a dependent of |parent_id| with the given
+  // weight. If |parent_id| is not registered, logs DFATAL and registers the
+  // stream under the root instead. If the stream was already registered,
+  // logs DFATAL and does nothing.
+  void RegisterStream(StreamIdType stream_id,
+                      StreamIdType parent_id,
+                      int weight,
+                      bool exclusive) {
+    if (parent_id != kRootNodeId && !StreamRegistered(parent_id)) {
+      LOG(DFATAL) << "Parent stream " << parent_id << " not registered";
+      parent_id = kRootNodeId;
+    }
+    if (!tree_.AddNode(stream_id, parent_id, ClampWeight(weight), exclusive)) {
+      LOG(DFATAL) << "Stream " << stream_id << " already registered";
+    }
+  }
+
+  // Unregisters the given stream from the scheduler. Per section 5.3.1 of
+  // RFC 7540, its children are moved up to its parent, with their weights
+  // scaled proportionally to the removed stream's weight. If the stream was
+  // not previously registered, logs DFATAL and does nothing.
+  void UnregisterStream(StreamIdType stream_id) {
+    if (!tree_.RemoveNode(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+    }
+  }
+
+  // Returns the SPDY/3 priority value whose weight range contains the
+  // stream's weight. If the stream is not registered, logs DFATAL and
+  // returns the lowest priority.
+  SpdyPriority GetStreamPriority(StreamIdType stream_id) const {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return kV3LowestPriority;
+    }
+    return Http2WeightToSpdy3Priority(tree_.GetWeight(stream_id));
+  }
+
+  // Updates the weight of the given stream to match |priority|, leaving its
+  // position in the dependency tree unchanged. If the stream is not
+  // registered, logs DFATAL and does nothing.
+  void UpdateStreamPriority(StreamIdType stream_id, SpdyPriority priority) {
+    SetStreamWeight(stream_id,
+                    Spdy3PriorityToHttp2Weight(ClampPriority(priority)));
+  }
+
+  // Returns the weight of the given stream. If the stream is not registered,
+  // logs DFATAL and returns the minimum weight.
+  int GetStreamWeight(StreamIdType stream_id) const {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return kMinWeight;
+    }
+    return tree_.GetWeight(stream_id);
+  }
+
+  // Updates the weight of the given stream. If the stream is not registered,
+  // logs DFATAL and does nothing.
+  void SetStreamWeight(StreamIdType stream_id, int weight) {
+    if (!tree_.SetWeight(stream_id, ClampWeight(weight))) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+    }
+  }
+
+  // Returns the ID of the parent of the given stream, or the root node ID if
+  // the stream depends directly on the root. If the stream is not
+  // registered, logs DFATAL and returns the root node ID.
+  StreamIdType GetStreamParent(StreamIdType stream_id) const {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return kRootNodeId;
+    }
+    return tree_.GetParent(stream_id);
+  }
+
+  // Returns the IDs of the children of the given stream, or an empty vector
+  // if it has none. If the stream is not registered, logs DFATAL and returns
+  // an empty vector.
+  std::vector<StreamIdType> GetStreamChildren(StreamIdType stream_id) const {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return std::vector<StreamIdType>();
+    }
+    return tree_.GetChildren(stream_id);
+  }
+
+  // Makes the given stream a dependent of |parent_id|, rearranging the tree
+  // as described in section 5.3.3 of RFC 7540 if |parent_id| is currently a
+  // descendant of the stream. If either stream is not registered, logs
+  // DFATAL and does nothing.
+  void SetStreamParent(StreamIdType stream_id,
+                       StreamIdType parent_id,
+                       bool exclusive) {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return;
+    }
+    if (parent_id != kRootNodeId && !StreamRegistered(parent_id)) {
+      LOG(DFATAL) << "Parent stream " << parent_id << " not registered";
+      return;
+    }
+    tree_.SetParent(stream_id, parent_id, exclusive);
+  }
+
+  // Pops the ready stream with the highest computed priority (its share of
+  // the tree's bandwidth) and returns its ID, transitioning the stream from
+  // ready to not ready. If the scheduler doesn't have any ready streams,
+  // logs DFATAL and returns 0.
+  StreamIdType PopNextReadyStream() {
+    StreamIdType stream_id = 0;
+    PriorityList priority_list = tree_.GetPriorityList();
+    if (priority_list.empty()) {
+      LOG(DFATAL) << "No ready streams available";
+      return stream_id;
+    }
+    stream_id = priority_list.front().first;
+    tree_.SetReady(stream_id, false);
+    return stream_id;
+  }
+
+  // Returns true if the scheduler has any ready streams whose weight maps to
+  // a higher SPDY/3 priority value than that of the specified stream. If the
+  // stream is not registered, logs DFATAL and returns false.
+  bool HasHigherPriorityReadyStream(StreamIdType stream_id) {
+    if (!StreamRegistered(stream_id)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+      return false;
+    }
+    const SpdyPriority priority = GetStreamPriority(stream_id);
+    PriorityList priority_list = tree_.GetPriorityList();
+    for (typename PriorityList::const_iterator it = priority_list.begin();
+         it != priority_list.end(); ++it) {
+      if (it->first != stream_id && GetStreamPriority(it->first) < priority) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Marks the given stream as ready to write. If the stream was already
+  // ready, does nothing. If the stream is not registered, logs DFATAL and
+  // does nothing. |add_to_front| is accepted for interface compatibility
+  // with PriorityWriteScheduler, but has no effect: ordering is determined
+  // by the dependency tree.
+  void MarkStreamReady(StreamIdType stream_id, bool add_to_front) {
+    if (!tree_.SetReady(stream_id, true)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+    }
+  }
+
+  // Marks the given stream as not ready to write. If the stream was already
+  // not ready, does nothing. If the stream is not registered, logs DFATAL
+  // and does nothing.
+  void MarkStreamNotReady(StreamIdType stream_id) {
+    if (!tree_.SetReady(stream_id, false)) {
+      LOG(DFATAL) << "Stream " << stream_id << " not registered";
+    }
+  }
+
+  // Returns true iff the number of ready streams is non-zero.
+  bool HasReadyStreams() {
+    return !tree_.GetPriorityList().empty();
+  }
+
+  // Returns the number of ready streams that are currently eligible for
+  // writing. Ready streams that depend on another ready stream are not
+  // counted, since the tree schedules their ancestor ahead of them.
+  size_t NumReadyStreams() {
+    return tree_.GetPriorityList().size();
+  }
+
+  // Returns the number of eligible ready streams whose weight maps to the
+  // given SPDY/3 priority value.
+  size_t NumReadyStreams(SpdyPriority priority) {
+    priority = ClampPriority(priority);
+    size_t n = 0;
+    PriorityList priority_list = tree_.GetPriorityList();
+    for (typename PriorityList::const_iterator it = priority_list.begin();
+         it != priority_list.end(); ++it) {
+      if (GetStreamPriority(it->first) == priority) {
+        ++n;
+      }
+    }
+    return n;
+  }
+
+ private:
+  typedef typename SpdyPriorityTree<StreamIdType>::PriorityList PriorityList;
+
+  static SpdyPriority ClampPriority(SpdyPriority priority) {
+    if (priority < kV3HighestPriority) {
+      LOG(DFATAL) << "Invalid priority: " << static_cast<int>(priority);
+      return kV3HighestPriority;
+    }
+    if (priority > kV3LowestPriority) {
+      LOG(DFATAL) << "Invalid priority: " << static_cast<int>(priority);
+      return kV3LowestPriority;
+    }
+    return priority;
+  }
+
+  static int ClampWeight(int weight) {
+    if (weight < kMinWeight) {
+      LOG(DFATAL) << "Invalid weight: " << weight;
+      return kMinWeight;
+    }
+    if (weight > kMaxWeight) {
+      LOG(DFATAL) << "Invalid weight: " << weight;
+      return kMaxWeight;
+    }
+    return weight;
+  }
+
+  // The RFC 7540 dependency tree; streams registered with a SPDY/3 priority
+  // are children of the root with a weight derived from that priority.
+  SpdyPriorityTree<StreamIdType> tree_;
+};
+
+}  // namespace net
+
+#endif  // NET_SPDY_HTTP2_PRIORITY_WRITE_SCHEDULER_H_
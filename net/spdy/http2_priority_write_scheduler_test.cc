@@ -0,0 +1,274 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/http2_priority_write_scheduler.h"
+
+#include "net/test/gtest_util.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class Http2PriorityWriteSchedulerTest : public ::testing::Test {
+ public:
+  Http2PriorityWriteScheduler<int> scheduler_;
+};
+
+TEST_F(Http2PriorityWriteSchedulerTest, Spdy3PriorityToHttp2Weight) {
+  EXPECT_EQ(kMaxWeight, Spdy3PriorityToHttp2Weight(kV3HighestPriority));
+  EXPECT_EQ(kMinWeight, Spdy3PriorityToHttp2Weight(kV3LowestPriority));
+
+  // Round trip across the whole priority range, and verify that lower
+  // priority values (more important) map to larger weights.
+  int last_weight = kMaxWeight + 1;
+  for (SpdyPriority p = kV3HighestPriority; p <= kV3LowestPriority; ++p) {
+    int weight = Spdy3PriorityToHttp2Weight(p);
+    EXPECT_GE(weight, kMinWeight);
+    EXPECT_LE(weight, kMaxWeight);
+    EXPECT_LT(weight, last_weight);
+    EXPECT_EQ(p, Http2WeightToSpdy3Priority(weight));
+    last_weight = weight;
+  }
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, RegisterUnregisterStreams) {
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+  EXPECT_FALSE(scheduler_.StreamRegistered(1));
+  scheduler_.RegisterStream(1, 1);
+  EXPECT_TRUE(scheduler_.StreamRegistered(1));
+
+  // Try redundant registrations.
+  EXPECT_DFATAL(scheduler_.RegisterStream(1, 1), "Stream 1 already registered");
+  EXPECT_DFATAL(scheduler_.RegisterStream(1, 2), "Stream 1 already registered");
+
+  scheduler_.RegisterStream(2, 3);
+
+  // Registering a stream under an unregistered parent should log DFATAL and
+  // attach the stream to the root instead.
+  EXPECT_DFATAL(scheduler_.RegisterStream(3, 7, kDefaultWeight, false),
+                "Parent stream 7 not registered");
+  EXPECT_EQ(kRootNodeId, scheduler_.GetStreamParent(3));
+
+  // Verify registration != ready.
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+
+  scheduler_.UnregisterStream(1);
+  scheduler_.UnregisterStream(2);
+  scheduler_.UnregisterStream(3);
+
+  // Try redundant unregistration.
+  EXPECT_DFATAL(scheduler_.UnregisterStream(1), "Stream 1 not registered");
+  EXPECT_DFATAL(scheduler_.UnregisterStream(2), "Stream 2 not registered");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, GetStreamWeight) {
+  EXPECT_DFATAL(EXPECT_EQ(kMinWeight, scheduler_.GetStreamWeight(1)),
+                "Stream 1 not registered");
+
+  scheduler_.RegisterStream(1, kRootNodeId, 100, false);
+  EXPECT_EQ(100, scheduler_.GetStreamWeight(1));
+
+  scheduler_.SetStreamWeight(1, 50);
+  EXPECT_EQ(50, scheduler_.GetStreamWeight(1));
+
+  // Out-of-range weights should be clamped.
+  EXPECT_DFATAL(scheduler_.SetStreamWeight(1, 0), "Invalid weight: 0");
+  EXPECT_EQ(kMinWeight, scheduler_.GetStreamWeight(1));
+  EXPECT_DFATAL(scheduler_.SetStreamWeight(1, 500), "Invalid weight: 500");
+  EXPECT_EQ(kMaxWeight, scheduler_.GetStreamWeight(1));
+
+  EXPECT_DFATAL(scheduler_.SetStreamWeight(2, 100), "Stream 2 not registered");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, GetStreamPriority) {
+  EXPECT_DFATAL(EXPECT_EQ(kV3LowestPriority, scheduler_.GetStreamPriority(1)),
+                "Stream 1 not registered");
+
+  scheduler_.RegisterStream(1, 3);
+  EXPECT_EQ(3, scheduler_.GetStreamPriority(1));
+  EXPECT_EQ(Spdy3PriorityToHttp2Weight(3), scheduler_.GetStreamWeight(1));
+
+  // Redundant registration shouldn't change stream priority.
+  EXPECT_DFATAL(scheduler_.RegisterStream(1, 4), "Stream 1 already registered");
+  EXPECT_EQ(3, scheduler_.GetStreamPriority(1));
+
+  scheduler_.UpdateStreamPriority(1, 5);
+  EXPECT_EQ(5, scheduler_.GetStreamPriority(1));
+
+  // Toggling ready state shouldn't change stream priority.
+  scheduler_.MarkStreamReady(1, true);
+  EXPECT_EQ(5, scheduler_.GetStreamPriority(1));
+
+  // Test changing priority of ready stream.
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams(5));
+  scheduler_.UpdateStreamPriority(1, 6);
+  EXPECT_EQ(6, scheduler_.GetStreamPriority(1));
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams(5));
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams(6));
+
+  EXPECT_EQ(1, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(6, scheduler_.GetStreamPriority(1));
+
+  scheduler_.UnregisterStream(1);
+  EXPECT_DFATAL(EXPECT_EQ(kV3LowestPriority, scheduler_.GetStreamPriority(1)),
+                "Stream 1 not registered");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, UpdateStreamPriority) {
+  // Updating priority of unregistered stream should have no effect.
+  EXPECT_DFATAL(scheduler_.UpdateStreamPriority(3, 1),
+                "Stream 3 not registered");
+
+  scheduler_.RegisterStream(3, 1);
+  EXPECT_EQ(1, scheduler_.GetStreamPriority(3));
+  scheduler_.UpdateStreamPriority(3, 2);
+  EXPECT_EQ(2, scheduler_.GetStreamPriority(3));
+
+  // Even though stream 4 is marked ready after stream 5, it should be
+  // returned first by PopNextReadyStream() since it has higher priority.
+  scheduler_.RegisterStream(4, 1);
+  scheduler_.MarkStreamReady(3, false);  // priority 2
+  scheduler_.MarkStreamReady(4, false);  // priority 1
+  EXPECT_EQ(4, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(3, scheduler_.PopNextReadyStream());
+
+  // Verify that lowering priority of stream 4 causes it to be returned later
+  // by PopNextReadyStream().
+  scheduler_.MarkStreamReady(3, false);  // priority 2
+  scheduler_.MarkStreamReady(4, false);  // priority 1
+  scheduler_.UpdateStreamPriority(4, 3);
+  EXPECT_EQ(3, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(4, scheduler_.PopNextReadyStream());
+
+  scheduler_.UnregisterStream(3);
+  EXPECT_DFATAL(scheduler_.UpdateStreamPriority(3, 1),
+                "Stream 3 not registered");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, PopOrderByWeight) {
+  // Ready streams should pop in descending order of weight, not strictly
+  // starve the lighter streams.
+  scheduler_.RegisterStream(1, kRootNodeId, 50, false);
+  scheduler_.RegisterStream(3, kRootNodeId, 200, false);
+  scheduler_.RegisterStream(5, kRootNodeId, 100, false);
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+  scheduler_.MarkStreamReady(5, false);
+
+  EXPECT_EQ(3u, scheduler_.NumReadyStreams());
+  EXPECT_EQ(3, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(5, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1, scheduler_.PopNextReadyStream());
+  EXPECT_DFATAL(EXPECT_EQ(0, scheduler_.PopNextReadyStream()),
+                "No ready streams available");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, DependentStreamsPopAfterParent) {
+  // A ready stream should be scheduled ahead of its own ready dependents.
+  scheduler_.RegisterStream(1, kRootNodeId, kDefaultWeight, false);
+  scheduler_.RegisterStream(3, 1, kDefaultWeight, false);
+  EXPECT_EQ(1, scheduler_.GetStreamParent(3));
+  ASSERT_EQ(1u, scheduler_.GetStreamChildren(1).size());
+  EXPECT_EQ(3, scheduler_.GetStreamChildren(1)[0]);
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+
+  // Only the parent is eligible while it is ready.
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+  EXPECT_EQ(1, scheduler_.PopNextReadyStream());
+
+  // Once the parent is no longer ready, the child becomes eligible.
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+  EXPECT_EQ(3, scheduler_.PopNextReadyStream());
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, SetStreamParent) {
+  scheduler_.RegisterStream(1, kRootNodeId, kDefaultWeight, false);
+  scheduler_.RegisterStream(3, kRootNodeId, kDefaultWeight, false);
+
+  EXPECT_DFATAL(scheduler_.SetStreamParent(5, 1, false),
+                "Stream 5 not registered");
+  EXPECT_DFATAL(scheduler_.SetStreamParent(3, 5, false),
+                "Parent stream 5 not registered");
+
+  scheduler_.SetStreamParent(3, 1, false);
+  EXPECT_EQ(1, scheduler_.GetStreamParent(3));
+
+  // Exclusive insertion: stream 5 becomes the sole child of stream 1, and
+  // stream 3 is moved below stream 5.
+  scheduler_.RegisterStream(5, 1, kDefaultWeight, true);
+  EXPECT_EQ(1, scheduler_.GetStreamParent(5));
+  EXPECT_EQ(5, scheduler_.GetStreamParent(3));
+
+  // Unregistering stream 5 should move stream 3 back up to stream 1.
+  scheduler_.UnregisterStream(5);
+  EXPECT_EQ(1, scheduler_.GetStreamParent(3));
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, HasHigherPriorityReadyStream) {
+  EXPECT_DFATAL(EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1)),
+                "Stream 1 not registered");
+
+  // Add ready streams of lower and equal priority.
+  scheduler_.RegisterStream(1, 4);
+  EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1));
+  scheduler_.RegisterStream(2, 5);
+  scheduler_.MarkStreamReady(2, false);
+  EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1));
+  scheduler_.RegisterStream(3, 4);
+  scheduler_.MarkStreamReady(3, false);
+  EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1));
+
+  // Verify that registration of a stream with higher priority isn't
+  // sufficient--it needs to be marked ready.
+  scheduler_.RegisterStream(4, 3);
+  EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1));
+  scheduler_.MarkStreamReady(4, false);
+  EXPECT_TRUE(scheduler_.HasHigherPriorityReadyStream(1));
+
+  // Verify method is responsive to changes in priority.
+  scheduler_.UpdateStreamPriority(1, 2);
+  EXPECT_FALSE(scheduler_.HasHigherPriorityReadyStream(1));
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, MarkStreamNotReady) {
+  // Verify ready state reflected in NumReadyStreams().
+  scheduler_.RegisterStream(1, 1);
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams());
+  scheduler_.MarkStreamReady(1, false);
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+  scheduler_.MarkStreamNotReady(1);
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams());
+
+  // Empty pop should fail.
+  EXPECT_DFATAL(EXPECT_EQ(0, scheduler_.PopNextReadyStream()),
+                "No ready streams available");
+
+  // Tolerate redundant marking of a stream as not ready.
+  scheduler_.MarkStreamNotReady(1);
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams());
+
+  // Should only be able to mark registered streams.
+  EXPECT_DFATAL(scheduler_.MarkStreamNotReady(3), "Stream 3 not registered");
+  EXPECT_DFATAL(scheduler_.MarkStreamReady(3, false),
+                "Stream 3 not registered");
+}
+
+TEST_F(Http2PriorityWriteSchedulerTest, UnregisterRemovesStream) {
+  scheduler_.RegisterStream(3, 4);
+  scheduler_.MarkStreamReady(3, false);
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+
+  // Unregistering a stream should remove it from set of ready streams.
+  scheduler_.UnregisterStream(3);
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams());
+  EXPECT_DFATAL(EXPECT_EQ(0, scheduler_.PopNextReadyStream()),
+                "No ready streams available");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
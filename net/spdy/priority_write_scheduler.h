@@ -5,11 +5,14 @@
 #ifndef NET_SPDY_PRIORITY_WRITE_SCHEDULER_H_
 #define NET_SPDY_PRIORITY_WRITE_SCHEDULER_H_
 
+#include <stdint.h>
+
 #include <algorithm>
 #include <deque>
 #include <unordered_map>
 #include <utility>
 
+#include "base/bits.h"
 #include "base/logging.h"
 #include "net/spdy/spdy_protocol.h"
 
@@ -35,7 +38,10 @@ namespace net {
 //
 // Internally, PriorityWriteScheduler consists of 8 per-priority sublists, one
 // for each priority value.  The elements (if any) of each sublist are streams
-// that are ready to write and have that priority.
+// that are ready to write and have that priority.  A bitmap records which
+// sublists are non-empty, so the highest ready priority is found with a
+// find-first-set rather than a scan, keeping dispatch constant time
+// regardless of how many streams are ready.
 template <typename StreamIdType>
 class PriorityWriteScheduler {
  public:
@@ -66,7 +72,7 @@ class PriorityWriteScheduler {
     }
     StreamInfo& stream_info = it->second;
     if (stream_info.ready) {
-      bool erased = Erase(&ready_lists_[stream_info.priority], stream_id);
+      bool erased = Erase(stream_info.priority, stream_id);
       DCHECK(erased);
     }
     stream_infos_.erase(it);
@@ -96,9 +102,11 @@ class PriorityWriteScheduler {
       return;
     }
     if (stream_info.ready) {
-      bool erased = Erase(&ready_lists_[stream_info.priority], stream_id);
+      bool erased = Erase(stream_info.priority, stream_id);
       DCHECK(erased);
       ready_lists_[priority].push_back(stream_id);
+      nonempty_priorities_ |= 1u << priority;
+      ++num_ready_streams_;
     }
     stream_info.priority = priority;
   }
@@ -109,22 +117,25 @@ class PriorityWriteScheduler {
   // streams, logs DFATAL and returns 0.
   StreamIdType PopNextReadyStream() {
     StreamIdType stream_id = 0;
-    for (SpdyPriority p = kV3HighestPriority; p <= kV3LowestPriority; ++p) {
-      StreamIdList& ready_list = ready_lists_[p];
-      if (!ready_list.empty()) {
-        stream_id = ready_list.front();
-        ready_list.pop_front();
+    if (nonempty_priorities_ == 0) {
+      LOG(DFATAL) << "No ready streams available";
+      return stream_id;
+    }
+    SpdyPriority priority = HighestReadyPriority();
+    StreamIdList& ready_list = ready_lists_[priority];
+    stream_id = ready_list.front();
+    ready_list.pop_front();
+    if (ready_list.empty()) {
+      nonempty_priorities_ &= ~(1u << priority);
+    }
+    --num_ready_streams_;
 
-        auto it = stream_infos_.find(stream_id);
-        if (it == stream_infos_.end()) {
-          LOG(DFATAL) << "Missing StreamInfo for stream " << stream_id;
-        } else {
-          it->second.ready = false;
-        }
-        return stream_id;
-      }
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      LOG(DFATAL) << "Missing StreamInfo for stream " << stream_id;
+    } else {
+      it->second.ready = false;
     }
-    LOG(DFATAL) << "No ready streams available";
     return stream_id;
   }
 
@@ -138,12 +149,8 @@ class PriorityWriteScheduler {
       return false;
     }
     StreamInfo& stream_info = it->second;
-    for (SpdyPriority p = kV3HighestPriority; p < stream_info.priority; ++p) {
-      if (!ready_lists_[p].empty()) {
-        return true;
-      }
-    }
-    return false;
+    // Bits below the stream's own priority correspond to higher priorities.
+    return (nonempty_priorities_ & ((1u << stream_info.priority) - 1)) != 0;
   }
 
   // Marks the given stream as ready to write. If stream was already ready,
@@ -166,6 +173,8 @@ class PriorityWriteScheduler {
     } else {
       ready_list.push_back(stream_id);
     }
+    nonempty_priorities_ |= 1u << stream_info.priority;
+    ++num_ready_streams_;
     stream_info.ready = true;
   }
 
@@ -182,29 +191,16 @@ class PriorityWriteScheduler {
     if (!stream_info.ready) {
       return;
     }
-    bool erased = Erase(&ready_lists_[stream_info.priority], stream_id);
+    bool erased = Erase(stream_info.priority, stream_id);
     DCHECK(erased);
     stream_info.ready = false;
   }
 
   // Returns true iff the number of ready streams is non-zero.
-  bool HasReadyStreams() const {
-    for (SpdyPriority i = kV3HighestPriority; i <= kV3LowestPriority; ++i) {
-      if (!ready_lists_[i].empty()) {
-        return true;
-      }
-    }
-    return false;
-  }
+  bool HasReadyStreams() const { return nonempty_priorities_ != 0; }
 
   // Returns the number of ready streams.
-  size_t NumReadyStreams() const {
-    size_t n = 0;
-    for (SpdyPriority i = kV3HighestPriority; i <= kV3LowestPriority; ++i) {
-      n += ready_lists_[i].size();
-    }
-    return n;
-  }
+  size_t NumReadyStreams() const { return num_ready_streams_; }
 
   // Returns the number of ready streams with the given priority.
   size_t NumReadyStreams(SpdyPriority priority) const {
@@ -237,19 +233,40 @@ class PriorityWriteScheduler {
     return priority;
   }
 
+  // Returns the highest priority with a non-empty ready list. Must only be
+  // called when at least one stream is ready.
+  SpdyPriority HighestReadyPriority() const {
+    DCHECK_NE(0u, nonempty_priorities_);
+    // The lowest set bit corresponds to the highest ready priority; isolate
+    // it and take its base-2 log to recover the priority value.
+    return static_cast<SpdyPriority>(base::bits::Log2Floor(
+        nonempty_priorities_ & ~(nonempty_priorities_ - 1)));
+  }
+
   // Erases first occurrence (which should be the only one) of |stream_id| in
-  // |ready_list|, returning true if found (and erased), or false otherwise.
-  bool Erase(StreamIdList* ready_list, StreamIdType stream_id) {
-    auto it = std::find(ready_list->begin(), ready_list->end(), stream_id);
-    if (it == ready_list->end()) {
+  // the ready list for |priority|, returning true if found (and erased), or
+  // false otherwise. Keeps the non-empty priority bitmap and ready stream
+  // count in sync with the lists.
+  bool Erase(SpdyPriority priority, StreamIdType stream_id) {
+    StreamIdList& ready_list = ready_lists_[priority];
+    auto it = std::find(ready_list.begin(), ready_list.end(), stream_id);
+    if (it == ready_list.end()) {
       return false;
     }
-    ready_list->erase(it);
+    ready_list.erase(it);
+    if (ready_list.empty()) {
+      nonempty_priorities_ &= ~(1u << priority);
+    }
+    --num_ready_streams_;
     return true;
   }
 
   // IDs of streams that are ready to write, grouped by priority.
   StreamIdList ready_lists_[kV3LowestPriority + 1];
+  // Bit i is set iff ready_lists_[i] is non-empty.
+  uint32_t nonempty_priorities_ = 0;
+  // Number of streams in the ready lists, kept in sync by the methods above.
+  size_t num_ready_streams_ = 0;
   // StreamInfos for all registered streams.
   StreamInfoMap stream_infos_;
 };
@@ -245,6 +245,36 @@ TEST_F(PriorityWriteSchedulerTest, MarkStreamNotReady) {
   EXPECT_DFATAL(scheduler_.MarkStreamNotReady(3), "Stream 3 not registered");
 }
 
+TEST_F(PriorityWriteSchedulerTest, ReadyStreamCountStaysInSync) {
+  // Exercise every operation that moves streams between ready lists and
+  // verify the ready stream accounting after each one.
+  scheduler_.RegisterStream(1, 2);
+  scheduler_.RegisterStream(2, 4);
+  scheduler_.RegisterStream(3, 4);
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(2, false);
+  scheduler_.MarkStreamReady(3, false);
+  EXPECT_TRUE(scheduler_.HasReadyStreams());
+  EXPECT_EQ(3u, scheduler_.NumReadyStreams());
+
+  // Moving a ready stream between priorities should not change the count.
+  scheduler_.UpdateStreamPriority(2, 6);
+  EXPECT_EQ(3u, scheduler_.NumReadyStreams());
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams(6));
+
+  EXPECT_EQ(1, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(2u, scheduler_.NumReadyStreams());
+
+  scheduler_.UnregisterStream(3);
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+
+  EXPECT_EQ(2, scheduler_.PopNextReadyStream());
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+  EXPECT_EQ(0u, scheduler_.NumReadyStreams());
+}
+
 TEST_F(PriorityWriteSchedulerTest, UnregisterRemovesStream) {
   scheduler_.RegisterStream(3, 4);
   scheduler_.MarkStreamReady(3, false);
@@ -8,6 +8,7 @@
 
 #include "base/callback.h"
 #include "base/logging.h"
+#include "net/base/net_allocation_tracker.h"
 #include "net/base/io_buffer.h"
 #include "net/spdy/spdy_protocol.h"
 
@@ -33,6 +34,10 @@ scoped_ptr<SpdyFrame> MakeSpdyFrame(const char* data, size_t size) {
 
 }  // namespace
 
+SpdyBuffer::SharedFrame::SharedFrame() {}
+
+SpdyBuffer::SharedFrame::~SharedFrame() {}
+
 // This class is an IOBuffer implementation that simply holds a
 // reference to a SharedFrame object and a fixed offset. Used by
 // SpdyBuffer::GetIOBufferForRemainingData().
@@ -58,6 +63,7 @@ SpdyBuffer::SpdyBuffer(scoped_ptr<SpdyFrame> frame)
     : shared_frame_(new SharedFrame()),
       offset_(0) {
   shared_frame_->data = frame.Pass();
+  NET_TRACK_ALLOCATION(ALLOC_SITE_SPDY_BUFFER);
 }
 
 // The given data may not be strictly a SPDY frame; we (ab)use
@@ -68,6 +74,21 @@ SpdyBuffer::SpdyBuffer(const char* data, size_t size) :
   CHECK_GT(size, 0u);
   CHECK_LE(size, kMaxSpdyFrameSize);
   shared_frame_->data = MakeSpdyFrame(data, size);
+  NET_TRACK_ALLOCATION(ALLOC_SITE_SPDY_BUFFER);
+}
+
+SpdyBuffer::SpdyBuffer(const scoped_refptr<IOBuffer>& buffer,
+                       size_t offset,
+                       size_t size)
+    : shared_frame_(new SharedFrame()),
+      offset_(0) {
+  CHECK(buffer.get());
+  CHECK_GT(size, 0u);
+  CHECK_LE(size, kMaxSpdyFrameSize);
+  shared_frame_->data.reset(
+      new SpdyFrame(buffer->data() + offset, size, false /* owns_buffer */));
+  shared_frame_->backing_buffer = buffer;
+  NET_TRACK_ALLOCATION(ALLOC_SITE_SPDY_BUFFER);
 }
 
 SpdyBuffer::~SpdyBuffer() {
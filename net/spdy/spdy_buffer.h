@@ -53,6 +53,15 @@ class NET_EXPORT_PRIVATE SpdyBuffer {
   // non-NULL and |size| must be non-zero.
   SpdyBuffer(const char* data, size_t size);
 
+  // Construct to wrap |size| bytes of |buffer| starting at |offset|,
+  // without copying. A reference to |buffer| is held for the lifetime
+  // of this object (and of any IOBuffer returned by
+  // GetIOBufferForRemainingData()), so the caller must not overwrite
+  // |buffer|'s data while it remains referenced elsewhere.
+  SpdyBuffer(const scoped_refptr<IOBuffer>& buffer,
+             size_t offset,
+             size_t size);
+
   // If there are bytes remaining in the buffer, triggers a call to
   // any consume callbacks with a DISCARD source.
   ~SpdyBuffer();
@@ -86,9 +95,19 @@ class NET_EXPORT_PRIVATE SpdyBuffer {
  private:
   void ConsumeHelper(size_t consume_size, ConsumeSource consume_source);
 
-  // Ref-count the passed-in SpdyFrame to support the semantics of
-  // |GetIOBufferForRemainingData()|.
-  typedef base::RefCountedData<scoped_ptr<SpdyFrame> > SharedFrame;
+  // Ref-counts the passed-in SpdyFrame to support the semantics of
+  // |GetIOBufferForRemainingData()|, and optionally keeps alive an
+  // underlying IOBuffer which the frame points into.
+  struct SharedFrame : public base::RefCounted<SharedFrame> {
+    SharedFrame();
+
+    scoped_ptr<SpdyFrame> data;
+    scoped_refptr<IOBuffer> backing_buffer;
+
+   private:
+    friend class base::RefCounted<SharedFrame>;
+    ~SharedFrame();
+  };
 
   class SharedFrameIOBuffer;
 
@@ -55,6 +55,37 @@ TEST_F(SpdyBufferTest, DataConstructor) {
   EXPECT_EQ(std::string(kData, kDataSize), BufferToString(buffer));
 }
 
+// Construct a SpdyBuffer wrapping a slice of an IOBuffer and make sure
+// it points directly into the IOBuffer's data without copying.
+TEST_F(SpdyBufferTest, IOBufferSliceConstructor) {
+  scoped_refptr<IOBuffer> io_buffer(new IOBuffer(kDataSize));
+  std::memcpy(io_buffer->data(), kData, kDataSize);
+
+  SpdyBuffer buffer(io_buffer, 2, kDataSize - 2);
+
+  EXPECT_EQ(io_buffer->data() + 2, buffer.GetRemainingData());
+  EXPECT_EQ(kDataSize - 2, buffer.GetRemainingSize());
+  EXPECT_EQ(std::string(kData + 2, kDataSize - 2), BufferToString(buffer));
+}
+
+// Make sure a SpdyBuffer wrapping a slice of an IOBuffer keeps the
+// IOBuffer alive.
+TEST_F(SpdyBufferTest, IOBufferSliceKeepsIOBufferAlive) {
+  scoped_refptr<IOBuffer> io_buffer(new IOBuffer(kDataSize));
+  std::memcpy(io_buffer->data(), kData, kDataSize);
+
+  scoped_ptr<SpdyBuffer> buffer(new SpdyBuffer(io_buffer, 0, kDataSize));
+  io_buffer = NULL;
+
+  // This will cause a use-after-free error if |buffer| doesn't keep a
+  // reference to the underlying IOBuffer.
+  EXPECT_EQ(std::string(kData, kDataSize), BufferToString(*buffer));
+
+  scoped_refptr<IOBuffer> remaining = buffer->GetIOBufferForRemainingData();
+  buffer.reset();
+  std::memcpy(remaining->data(), kData, kDataSize);
+}
+
 void IncrementBy(size_t* x,
                  SpdyBuffer::ConsumeSource expected_consume_source,
                  size_t delta,
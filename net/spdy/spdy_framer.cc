@@ -223,6 +223,7 @@ void SpdyFramer::Reset() {
   settings_scratch_.Reset();
   altsvc_scratch_.reset();
   remaining_padding_payload_length_ = 0;
+  header_handler_ = NULL;
 }
 
 size_t SpdyFramer::GetDataFrameMinimumSize() const {
@@ -1551,6 +1552,14 @@ size_t SpdyFramer::ProcessControlFrameBeforeHeaderBlock(const char* data,
                 (current_frame_flags_ & CONTROL_FLAG_FIN) != 0,
                 expect_continuation_ == 0);
           }
+          if (protocol_version() > SPDY3) {
+            // If the visitor provides a headers handler, decoded headers
+            // will be delivered to it directly, skipping the SPDY3
+            // re-serialization round trip.
+            header_handler_ =
+                visitor_->OnHeaderFrameStart(current_frame_stream_id_);
+            GetHpackDecoder()->HandleControlFrameHeadersStart(header_handler_);
+          }
         }
         CHANGE_STATE(SPDY_CONTROL_FRAME_HEADER_BLOCK);
         break;
@@ -1593,6 +1602,9 @@ size_t SpdyFramer::ProcessControlFrameBeforeHeaderBlock(const char* data,
                                   promised_stream_id,
                                   (current_frame_flags_ &
                                    PUSH_PROMISE_FLAG_END_PUSH_PROMISE) != 0);
+          header_handler_ =
+              visitor_->OnHeaderFrameStart(current_frame_stream_id_);
+          GetHpackDecoder()->HandleControlFrameHeadersStart(header_handler_);
         }
         CHANGE_STATE(SPDY_CONTROL_FRAME_HEADER_BLOCK);
         break;
@@ -1674,15 +1686,22 @@ size_t SpdyFramer::ProcessControlFrameHeaderBlock(const char* data,
         size_t compressed_len = 0;
         if (GetHpackDecoder()->HandleControlFrameHeadersComplete(
                 &compressed_len)) {
-          // TODO(jgraettinger): To be removed with migration to
-          // SpdyHeadersHandlerInterface. Serializes the HPACK block as a SPDY3
-          // block, delivered via reentrant call to
-          // ProcessControlFrameHeaderBlock().
-          DeliverHpackBlockAsSpdy3Block(compressed_len);
-          return process_bytes;
+          if (header_handler_ == NULL) {
+            // TODO(jgraettinger): To be removed with migration to
+            // SpdyHeadersHandlerInterface. Serializes the HPACK block as a
+            // SPDY3 block, delivered via reentrant call to
+            // ProcessControlFrameHeaderBlock().
+            DeliverHpackBlockAsSpdy3Block(compressed_len);
+            return process_bytes;
+          }
+          // Decoded headers were delivered to |header_handler_| as they
+          // were parsed; all that remains is to signal the end of the block.
+          visitor_->OnHeaderFrameEnd(current_frame_stream_id_, true);
+          header_handler_ = NULL;
+        } else {
+          set_error(SPDY_DECOMPRESS_FAILURE);
+          processed_successfully = false;
         }
-        set_error(SPDY_DECOMPRESS_FAILURE);
-        processed_successfully = false;
       } else {
         // The complete header block has been delivered. We send a zero-length
         // OnControlFrameHeaderData() to indicate this.
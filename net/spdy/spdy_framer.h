@@ -757,6 +757,12 @@ class NET_EXPORT_PRIVATE SpdyFramer {
   scoped_ptr<HpackEncoder> hpack_encoder_;
   scoped_ptr<HpackDecoder> hpack_decoder_;
 
+  // The handler returned by the visitor's OnHeaderFrameStart() for the
+  // HPACK header block currently being processed, or NULL if the visitor
+  // elected to receive the block via the SPDY3 re-serialization path.
+  // Unused for SPDY3 and below.
+  SpdyHeadersHandlerInterface* header_handler_;
+
   SpdyFramerVisitorInterface* visitor_;
   SpdyFramerDebugVisitorInterface* debug_visitor_;
 
@@ -0,0 +1,362 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_framer.h"
+
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/spdy/buffered_spdy_framer.h"
+#include "net/spdy/fuzzing/hpack_fuzz_util.h"
+#include "net/spdy/hpack/hpack_constants.h"
+#include "net/spdy/hpack/hpack_decoder.h"
+#include "net/spdy/hpack/hpack_encoder.h"
+#include "net/spdy/spdy_protocol.h"
+#include "net/test/benchmark_reporter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+// Replays a corpus of header blocks through each stage of the framing
+// pipeline (HpackEncoder, HpackDecoder, SpdyFramer serialization and
+// parsing, and BufferedSpdyFramer parsing) and reports the time spent
+// per kilobyte of input.
+//
+// By default the corpus is synthesized with HpackFuzzUtil's header
+// generator. To replay captured headers instead, pass
+// --header-corpus=<file>, where the file contains length-prefixed
+// header blocks in the format written by hpack_example_generator (the
+// same format consumed by hpack_fuzz_wrapper --file-to-parse).
+const char kHeaderCorpusSwitch[] = "header-corpus";
+
+// Number of header sets to synthesize when no corpus file is given.
+const size_t kGeneratedHeaderSets = 500;
+
+// Iterations to run before starting the timer, to warm the CPU cache.
+const size_t kWarmupRuns = 4;
+
+const size_t kMeasuredRuns = 64;
+
+// Returns the size in bytes of the names and values in |headers|.
+size_t HeaderBlockSize(const SpdyHeaderBlock& headers) {
+  size_t size = 0;
+  for (SpdyHeaderBlock::const_iterator it = headers.begin();
+       it != headers.end(); ++it) {
+    size += it->first.size() + it->second.size();
+  }
+  return size;
+}
+
+// A SpdyFramerVisitorInterface that discards everything it is given.
+// OnHeaderFrameStart() returns NULL so that header blocks are delivered
+// through OnControlFrameHeaderData(), exercising the framer's own HPACK
+// decoding path.
+class DiscardingSpdyFramerVisitor : public SpdyFramerVisitorInterface {
+ public:
+  DiscardingSpdyFramerVisitor() : error_count_(0) {}
+  ~DiscardingSpdyFramerVisitor() override {}
+
+  void OnError(SpdyFramer* framer) override { ++error_count_; }
+  void OnDataFrameHeader(SpdyStreamId stream_id,
+                         size_t length,
+                         bool fin) override {}
+  void OnStreamFrameData(SpdyStreamId stream_id,
+                         const char* data,
+                         size_t len,
+                         bool fin) override {}
+  void OnStreamPadding(SpdyStreamId stream_id, size_t len) override {}
+  SpdyHeadersHandlerInterface* OnHeaderFrameStart(
+      SpdyStreamId stream_id) override {
+    return NULL;
+  }
+  void OnHeaderFrameEnd(SpdyStreamId stream_id, bool end_headers) override {}
+  bool OnControlFrameHeaderData(SpdyStreamId stream_id,
+                                const char* header_data,
+                                size_t len) override {
+    return true;
+  }
+  void OnSynStream(SpdyStreamId stream_id,
+                   SpdyStreamId associated_stream_id,
+                   SpdyPriority priority,
+                   bool fin,
+                   bool unidirectional) override {}
+  void OnSynReply(SpdyStreamId stream_id, bool fin) override {}
+  void OnRstStream(SpdyStreamId stream_id,
+                   SpdyRstStreamStatus status) override {}
+  void OnSetting(SpdySettingsIds id, uint8 flags, uint32 value) override {}
+  void OnSettingsEnd() override {}
+  void OnPing(SpdyPingId unique_id, bool is_ack) override {}
+  void OnGoAway(SpdyStreamId last_accepted_stream_id,
+                SpdyGoAwayStatus status) override {}
+  void OnHeaders(SpdyStreamId stream_id,
+                 bool has_priority,
+                 SpdyPriority priority,
+                 SpdyStreamId parent_stream_id,
+                 bool exclusive,
+                 bool fin,
+                 bool end) override {}
+  void OnWindowUpdate(SpdyStreamId stream_id, int delta_window_size) override {
+  }
+  void OnPushPromise(SpdyStreamId stream_id,
+                     SpdyStreamId promised_stream_id,
+                     bool end) override {}
+  void OnContinuation(SpdyStreamId stream_id, bool end) override {}
+  bool OnUnknownFrame(SpdyStreamId stream_id, int frame_type) override {
+    return false;
+  }
+
+  int error_count() const { return error_count_; }
+
+ private:
+  int error_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiscardingSpdyFramerVisitor);
+};
+
+// The BufferedSpdyFramer analogue of DiscardingSpdyFramerVisitor. The
+// assembled SpdyHeaderBlocks delivered to OnHeaders() are discarded.
+class DiscardingBufferedSpdyFramerVisitor
+    : public BufferedSpdyFramerVisitorInterface {
+ public:
+  DiscardingBufferedSpdyFramerVisitor() : error_count_(0) {}
+  ~DiscardingBufferedSpdyFramerVisitor() override {}
+
+  void OnError(SpdyFramer::SpdyError error_code) override { ++error_count_; }
+  void OnStreamError(SpdyStreamId stream_id,
+                     const std::string& description) override {
+    ++error_count_;
+  }
+  void OnSynStream(SpdyStreamId stream_id,
+                   SpdyStreamId associated_stream_id,
+                   SpdyPriority priority,
+                   bool fin,
+                   bool unidirectional,
+                   const SpdyHeaderBlock& headers) override {}
+  void OnSynReply(SpdyStreamId stream_id,
+                  bool fin,
+                  const SpdyHeaderBlock& headers) override {}
+  void OnHeaders(SpdyStreamId stream_id,
+                 bool has_priority,
+                 SpdyPriority priority,
+                 SpdyStreamId parent_stream_id,
+                 bool exclusive,
+                 bool fin,
+                 const SpdyHeaderBlock& headers) override {}
+  void OnDataFrameHeader(SpdyStreamId stream_id,
+                         size_t length,
+                         bool fin) override {}
+  void OnStreamFrameData(SpdyStreamId stream_id,
+                         const char* data,
+                         size_t len,
+                         bool fin) override {}
+  void OnStreamPadding(SpdyStreamId stream_id, size_t len) override {}
+  void OnSettings(bool clear_persisted) override {}
+  void OnSetting(SpdySettingsIds id, uint8 flags, uint32 value) override {}
+  void OnPing(SpdyPingId unique_id, bool is_ack) override {}
+  void OnRstStream(SpdyStreamId stream_id,
+                   SpdyRstStreamStatus status) override {}
+  void OnGoAway(SpdyStreamId last_accepted_stream_id,
+                SpdyGoAwayStatus status,
+                base::StringPiece debug_data) override {}
+  void OnWindowUpdate(SpdyStreamId stream_id, int delta_window_size) override {
+  }
+  void OnPushPromise(SpdyStreamId stream_id,
+                     SpdyStreamId promised_stream_id,
+                     const SpdyHeaderBlock& headers) override {}
+  bool OnUnknownFrame(SpdyStreamId stream_id, int frame_type) override {
+    return false;
+  }
+
+  int error_count() const { return error_count_; }
+
+ private:
+  int error_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiscardingBufferedSpdyFramerVisitor);
+};
+
+class SpdyFramerPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    const base::CommandLine& command_line =
+        *base::CommandLine::ForCurrentProcess();
+    if (command_line.HasSwitch(kHeaderCorpusSwitch)) {
+      LoadCorpusFromFile(
+          command_line.GetSwitchValuePath(kHeaderCorpusSwitch));
+    } else {
+      GenerateCorpus();
+    }
+    ASSERT_FALSE(corpus_.empty());
+    corpus_bytes_ = 0;
+    for (size_t i = 0; i != corpus_.size(); ++i) {
+      corpus_bytes_ += HeaderBlockSize(corpus_[i]);
+    }
+  }
+
+  // Reports |elapsed| spent processing |total_bytes| of input.
+  void LogResult(const std::string& name,
+                 base::TimeDelta elapsed,
+                 size_t total_bytes) {
+    test::BenchmarkReporter reporter(name);
+    reporter.set_wall_time(elapsed);
+    reporter.set_iterations(corpus_.size() * kMeasuredRuns);
+    reporter.SetThroughput("KB", total_bytes / 1024.0 / elapsed.InSecondsF());
+  }
+
+  // Encodes every header set in the corpus with a fresh encoder, so each
+  // run sees the same dynamic table transitions. Returns the total number
+  // of compressed bytes produced.
+  size_t EncodeCorpus(std::vector<std::string>* encoded) {
+    HpackEncoder encoder(ObtainHpackHuffmanTable());
+    size_t total = 0;
+    for (size_t i = 0; i != corpus_.size(); ++i) {
+      std::string buffer;
+      EXPECT_TRUE(encoder.EncodeHeaderSet(corpus_[i], &buffer));
+      total += buffer.size();
+      if (encoded)
+        encoded->push_back(buffer);
+    }
+    return total;
+  }
+
+  // Serializes every header set in the corpus as an HTTP/2 HEADERS frame
+  // on successive streams, appending the frames to |frames|. Returns the
+  // total number of serialized bytes.
+  size_t SerializeCorpus(SpdyFramer* framer, std::string* frames) {
+    size_t total = 0;
+    SpdyStreamId stream_id = 1;
+    for (size_t i = 0; i != corpus_.size(); ++i, stream_id += 2) {
+      SpdyHeadersIR headers(stream_id);
+      headers.set_header_block(corpus_[i]);
+      scoped_ptr<SpdySerializedFrame> frame(framer->SerializeFrame(headers));
+      total += frame->size();
+      if (frames)
+        frames->append(frame->data(), frame->size());
+    }
+    return total;
+  }
+
+  std::vector<SpdyHeaderBlock> corpus_;
+  size_t corpus_bytes_;
+
+  // Started once the warmup runs are done.
+  scoped_ptr<base::ElapsedTimer> timer_;
+
+ private:
+  void GenerateCorpus() {
+    HpackFuzzUtil::GeneratorContext context;
+    HpackFuzzUtil::InitializeGeneratorContext(&context);
+    for (size_t i = 0; i != kGeneratedHeaderSets; ++i) {
+      corpus_.push_back(HpackFuzzUtil::NextGeneratedHeaderSet(&context));
+    }
+  }
+
+  void LoadCorpusFromFile(const base::FilePath& path) {
+    HpackFuzzUtil::Input input;
+    ASSERT_TRUE(base::ReadFileToString(path, &input.input));
+
+    // Captured blocks are HPACK-encoded; decode them back into header
+    // sets so that every benchmark starts from the same representation.
+    HpackDecoder decoder(ObtainHpackHuffmanTable());
+    base::StringPiece block;
+    while (HpackFuzzUtil::NextHeaderBlock(&input, &block)) {
+      decoder.HandleControlFrameHeadersStart(NULL);
+      ASSERT_TRUE(
+          decoder.HandleControlFrameHeadersData(block.data(), block.size()));
+      ASSERT_TRUE(decoder.HandleControlFrameHeadersComplete(NULL));
+      corpus_.push_back(decoder.decoded_block());
+    }
+  }
+};
+
+TEST_F(SpdyFramerPerfTest, HpackEncoderEncode) {
+  size_t encoded_bytes = 0;
+  for (size_t run = 0; run != kWarmupRuns + kMeasuredRuns; ++run) {
+    if (run == kWarmupRuns)
+      timer_.reset(new base::ElapsedTimer());
+    encoded_bytes = EncodeCorpus(NULL);
+  }
+  LogResult("HpackEncoder", timer_->Elapsed(), corpus_bytes_ * kMeasuredRuns);
+  LOG(INFO) << "HpackEncoder: compressed " << corpus_bytes_ << " bytes to "
+            << encoded_bytes << " bytes";
+}
+
+TEST_F(SpdyFramerPerfTest, HpackDecoderDecode) {
+  std::vector<std::string> encoded;
+  size_t encoded_bytes = EncodeCorpus(&encoded);
+  for (size_t run = 0; run != kWarmupRuns + kMeasuredRuns; ++run) {
+    if (run == kWarmupRuns)
+      timer_.reset(new base::ElapsedTimer());
+    HpackDecoder decoder(ObtainHpackHuffmanTable());
+    for (size_t i = 0; i != encoded.size(); ++i) {
+      decoder.HandleControlFrameHeadersStart(NULL);
+      ASSERT_TRUE(decoder.HandleControlFrameHeadersData(encoded[i].data(),
+                                                        encoded[i].size()));
+      ASSERT_TRUE(decoder.HandleControlFrameHeadersComplete(NULL));
+    }
+  }
+  LogResult("HpackDecoder", timer_->Elapsed(), encoded_bytes * kMeasuredRuns);
+}
+
+TEST_F(SpdyFramerPerfTest, SpdyFramerSerializeHeaders) {
+  size_t serialized_bytes = 0;
+  for (size_t run = 0; run != kWarmupRuns + kMeasuredRuns; ++run) {
+    if (run == kWarmupRuns)
+      timer_.reset(new base::ElapsedTimer());
+    SpdyFramer framer(HTTP2);
+    serialized_bytes = SerializeCorpus(&framer, NULL);
+  }
+  LogResult("SpdyFramer serialize", timer_->Elapsed(),
+            corpus_bytes_ * kMeasuredRuns);
+  LOG(INFO) << "SpdyFramer serialize: " << corpus_bytes_ << " header bytes"
+            << " to " << serialized_bytes << " frame bytes";
+}
+
+TEST_F(SpdyFramerPerfTest, SpdyFramerProcessInput) {
+  SpdyFramer serializer(HTTP2);
+  std::string frames;
+  SerializeCorpus(&serializer, &frames);
+
+  DiscardingSpdyFramerVisitor visitor;
+  for (size_t run = 0; run != kWarmupRuns + kMeasuredRuns; ++run) {
+    if (run == kWarmupRuns)
+      timer_.reset(new base::ElapsedTimer());
+    SpdyFramer framer(HTTP2);
+    framer.set_visitor(&visitor);
+    size_t processed = framer.ProcessInput(frames.data(), frames.size());
+    ASSERT_EQ(frames.size(), processed);
+  }
+  ASSERT_EQ(0, visitor.error_count());
+  LogResult("SpdyFramer parse", timer_->Elapsed(),
+            frames.size() * kMeasuredRuns);
+}
+
+TEST_F(SpdyFramerPerfTest, BufferedSpdyFramerProcessInput) {
+  SpdyFramer serializer(HTTP2);
+  std::string frames;
+  SerializeCorpus(&serializer, &frames);
+
+  DiscardingBufferedSpdyFramerVisitor visitor;
+  for (size_t run = 0; run != kWarmupRuns + kMeasuredRuns; ++run) {
+    if (run == kWarmupRuns)
+      timer_.reset(new base::ElapsedTimer());
+    BufferedSpdyFramer framer(HTTP2, true);
+    framer.set_visitor(&visitor);
+    size_t processed = framer.ProcessInput(frames.data(), frames.size());
+    ASSERT_EQ(frames.size(), processed);
+  }
+  ASSERT_EQ(0, visitor.error_count());
+  LogResult("BufferedSpdyFramer parse", timer_->Elapsed(),
+            frames.size() * kMeasuredRuns);
+}
+
+}  // namespace
+}  // namespace net
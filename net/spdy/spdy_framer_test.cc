@@ -102,7 +102,7 @@ class SpdyFramerTestUtil {
 
     SpdyHeadersHandlerInterface* OnHeaderFrameStart(
         SpdyStreamId stream_id) override {
-      LOG(FATAL);
+      // Receive header blocks through OnControlFrameHeaderData() instead.
       return nullptr;
     }
 
@@ -332,7 +332,7 @@ class TestSpdyVisitor : public SpdyFramerVisitorInterface,
 
   SpdyHeadersHandlerInterface* OnHeaderFrameStart(
       SpdyStreamId stream_id) override {
-    LOG(FATAL);
+    // Receive header blocks through OnControlFrameHeaderData() instead.
     return nullptr;
   }
 
@@ -5282,6 +5282,10 @@ TEST_P(SpdyFramerTest, HeadersFrameFlags) {
       }
       EXPECT_CALL(visitor, OnHeaders(stream_id, has_priority, priority,
                                      parent_stream_id, exclusive, fin, end));
+      if (IsHttp2()) {
+        EXPECT_CALL(visitor, OnHeaderFrameStart(57))
+            .WillRepeatedly(testing::Return(nullptr));
+      }
       EXPECT_CALL(visitor, OnControlFrameHeaderData(57, _, _))
           .WillRepeatedly(testing::Return(true));
       if (flags & DATA_FLAG_FIN &&
@@ -5420,6 +5424,8 @@ TEST_P(SpdyFramerTest, PushPromiseFrameFlags) {
       EXPECT_CALL(debug_visitor, OnReceiveCompressedFrame(42, PUSH_PROMISE, _));
       EXPECT_CALL(visitor, OnPushPromise(42, 57,
           flags & PUSH_PROMISE_FLAG_END_PUSH_PROMISE));
+      EXPECT_CALL(visitor, OnHeaderFrameStart(42))
+          .WillRepeatedly(testing::Return(nullptr));
       EXPECT_CALL(visitor, OnControlFrameHeaderData(42, _, _))
           .WillRepeatedly(testing::Return(true));
     }
@@ -5456,6 +5462,8 @@ TEST_P(SpdyFramerTest, ContinuationFrameFlags) {
     EXPECT_CALL(debug_visitor, OnSendCompressedFrame(42, HEADERS, _, _));
     EXPECT_CALL(debug_visitor, OnReceiveCompressedFrame(42, HEADERS, _));
     EXPECT_CALL(visitor, OnHeaders(42, false, 0, 0, false, false, false));
+    EXPECT_CALL(visitor, OnHeaderFrameStart(42))
+        .WillRepeatedly(testing::Return(nullptr));
     EXPECT_CALL(visitor, OnControlFrameHeaderData(42, _, _))
           .WillRepeatedly(testing::Return(true));
 
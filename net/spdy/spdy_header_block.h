@@ -8,10 +8,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string_piece.h"
-#include "net/base/linked_hash_map.h"
 #include "net/base/net_export.h"
 #include "net/log/net_log.h"
 
@@ -33,7 +34,63 @@ using ::operator<<;
 // It's expected that keys are rarely deleted from a SpdyHeaderBlock.
 class NET_EXPORT SpdyHeaderBlock {
  private:
-  using MapType = linked_hash_map<base::StringPiece, base::StringPiece>;
+  // A flat, insertion-ordered key-value index. Keys and values point into
+  // the arena (Storage, below); the entries themselves occupy one contiguous
+  // vector, so header insertion performs no per-entry node allocations.
+  // Lookups are linear scans, which is cheaper than hashing or ordering for
+  // the header counts seen in practice.
+  class MapType {
+   public:
+    using value_type = std::pair<base::StringPiece, base::StringPiece>;
+    using EntryVector = std::vector<value_type>;
+    using iterator = EntryVector::iterator;
+    using const_iterator = EntryVector::const_iterator;
+    using reverse_iterator = EntryVector::reverse_iterator;
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    reverse_iterator rbegin() { return entries_.rbegin(); }
+    bool empty() const { return entries_.empty(); }
+    size_t size() const { return entries_.size(); }
+
+    iterator find(base::StringPiece key) {
+      iterator it = entries_.begin();
+      for (; it != entries_.end() && it->first != key; ++it) {
+      }
+      return it;
+    }
+    const_iterator find(base::StringPiece key) const {
+      const_iterator it = entries_.begin();
+      for (; it != entries_.end() && it->first != key; ++it) {
+      }
+      return it;
+    }
+
+    // Appends |value| if no entry with its key is present, preserving
+    // insertion order; existing entries are left unmodified.
+    std::pair<iterator, bool> insert(const value_type& value) {
+      iterator it = find(value.first);
+      if (it != entries_.end()) {
+        return std::make_pair(it, false);
+      }
+      entries_.push_back(value);
+      return std::make_pair(entries_.end() - 1, true);
+    }
+
+    void erase(base::StringPiece key) {
+      iterator it = find(key);
+      if (it != entries_.end()) {
+        entries_.erase(it);
+      }
+    }
+
+    void clear() { entries_.clear(); }
+
+   private:
+    EntryVector entries_;
+  };
   class Storage;
 
  public:
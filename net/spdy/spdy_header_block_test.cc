@@ -55,6 +55,23 @@ TEST(SpdyHeaderBlockTest, AddHeaders) {
   EXPECT_EQ(block1.end(), block1.find("key"));
 }
 
+// This test verifies that iteration and copies preserve insertion order.
+TEST(SpdyHeaderBlockTest, PreservesInsertionOrder) {
+  SpdyHeaderBlock block;
+  block["foo"] = "1";
+  block["bar"] = "2";
+  block.insert(make_pair("baz", "3"));
+  block.erase("bar");
+  block["qux"] = "4";
+
+  EXPECT_THAT(block, ElementsAre(Pair("foo", "1"), Pair("baz", "3"),
+                                 Pair("qux", "4")));
+
+  SpdyHeaderBlock copy(block);
+  EXPECT_THAT(copy, ElementsAre(Pair("foo", "1"), Pair("baz", "3"),
+                                Pair("qux", "4")));
+}
+
 // This test verifies that SpdyHeaderBlock can be copied.
 TEST(SpdyHeaderBlockTest, CopyBlocks) {
   SpdyHeaderBlock block1;
@@ -97,6 +114,12 @@ TEST(SpdyHeaderBlockTest, Equality) {
 
   EXPECT_EQ(block1, block2);
   EXPECT_NE(block1, block3);
+
+  // A block that is a strict prefix of another is not equal to it, in either
+  // direction.
+  block2["baz"] = "qux";
+  EXPECT_NE(block1, block2);
+  EXPECT_NE(block2, block1);
 }
 
 }  // namespace net
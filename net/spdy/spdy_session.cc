@@ -4,6 +4,8 @@
 
 #include "net/spdy/spdy_session.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <limits>
 #include <map>
@@ -57,9 +59,19 @@ const int kReadBufferSize = 8 * 1024;
 const int kDefaultConnectionAtRiskOfLossSeconds = 10;
 const int kHungIntervalSeconds = 10;
 
+// Maximum number of bytes to coalesce into a single socket write.
+// DoWrite() dequeues frames (in priority order) until this many bytes
+// are pending, so that a burst of small frames (e.g. WINDOW_UPDATEs)
+// does not cost one socket write each. A frame is never split by this
+// limit, so a single large frame may exceed it.
+const size_t kMaxCoalescedWriteSize = 8 * 1024;
+
 // Minimum seconds that unclaimed pushed streams will be kept in memory.
 const int kMinPushedStreamLifetimeSeconds = 300;
 
+// Largest session receive window that auto-tuning will grow to.
+const int32_t kSessionMaxRecvWindowSizeCap = 15 * 1024 * 1024;  // 15 MB
+
 // Field trial constants
 const char kSpdyDependenciesFieldTrial[] = "SpdyEnableDependencies";
 const char kSpdyDepencenciesFieldTrialEnable[] = "Enable";
@@ -627,6 +639,21 @@ bool SpdySession::CanPool(TransportSecurityState* transport_security_state,
   return true;
 }
 
+SpdySession::InFlightWrite::InFlightWrite()
+    : buffer(NULL), frame_type(DATA), frame_size(0) {}
+
+SpdySession::InFlightWrite::InFlightWrite(
+    SpdyBuffer* buffer,
+    SpdyFrameType frame_type,
+    size_t frame_size,
+    const base::WeakPtr<SpdyStream>& stream)
+    : buffer(buffer),
+      frame_type(frame_type),
+      frame_size(frame_size),
+      stream(stream) {}
+
+SpdySession::InFlightWrite::~InFlightWrite() {}
+
 SpdySession::SpdySession(
     const SpdySessionKey& spdy_session_key,
     const base::WeakPtr<HttpServerProperties>& http_server_properties,
@@ -652,8 +679,6 @@ SpdySession::SpdySession(
       last_accepted_push_stream_id_(0),
       num_pushed_streams_(0u),
       num_active_pushed_streams_(0u),
-      in_flight_write_frame_type_(DATA),
-      in_flight_write_frame_size_(0),
       is_secure_(false),
       certificate_error_code_(OK),
       availability_state_(STATE_AVAILABLE),
@@ -719,6 +744,8 @@ SpdySession::~SpdySession() {
   CHECK(!in_io_loop_);
   DcheckDraining();
 
+  ClearInFlightWrites();
+
   // TODO(akalin): Check connection->is_initialized() instead. This
   // requires re-working CreateFakeSpdySession(), though.
   DCHECK(connection_->socket());
@@ -1222,9 +1249,9 @@ scoped_ptr<SpdyBuffer> SpdySession::CreateDataBuffer(SpdyStreamId stream_id,
       // Even though we're currently stalled only by the stream, we
       // might end up being stalled by the session also.
       QueueSendStalledStream(*stream);
-      net_log().AddEvent(
+      net_log().AddEventWithIntParams(
           NetLog::TYPE_HTTP2_SESSION_STREAM_STALLED_BY_STREAM_SEND_WINDOW,
-          NetLog::IntCallback("stream_id", stream_id));
+          "stream_id", stream_id);
       return scoped_ptr<SpdyBuffer>();
     }
 
@@ -1237,9 +1264,9 @@ scoped_ptr<SpdyBuffer> SpdySession::CreateDataBuffer(SpdyStreamId stream_id,
     if (send_stalled_by_session) {
       stream->set_send_stalled_by_flow_control(true);
       QueueSendStalledStream(*stream);
-      net_log().AddEvent(
+      net_log().AddEventWithIntParams(
           NetLog::TYPE_HTTP2_SESSION_STREAM_STALLED_BY_SESSION_SEND_WINDOW,
-          NetLog::IntCallback("stream_id", stream_id));
+          "stream_id", stream_id);
       return scoped_ptr<SpdyBuffer>();
     }
 
@@ -1476,6 +1503,11 @@ int SpdySession::DoRead() {
 
   CHECK(connection_);
   CHECK(connection_->socket());
+  if (!read_buffer_->HasOneRef()) {
+    // DATA payload from the previous read is still referenced by SpdyBuffers
+    // handed to streams; read into a fresh buffer rather than overwriting it.
+    read_buffer_ = new IOBuffer(kReadBufferSize);
+  }
   read_state_ = READ_STATE_DO_READ_COMPLETE;
   return connection_->socket()->Read(
       read_buffer_.get(),
@@ -1533,7 +1565,7 @@ void SpdySession::PumpWriteLoop(WriteState expected_write_state, int result) {
 
   DoWriteLoop(expected_write_state, result);
 
-  if (availability_state_ == STATE_DRAINING && !in_flight_write_ &&
+  if (availability_state_ == STATE_DRAINING && in_flight_writes_.empty() &&
       write_queue_.IsEmpty()) {
     pool_->RemoveUnavailableSession(GetWeakPtr());  // Destroys |this|.
     return;
@@ -1582,53 +1614,62 @@ int SpdySession::DoWrite() {
   CHECK(in_io_loop_);
 
   DCHECK(buffered_spdy_framer_);
-  if (in_flight_write_) {
-    DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
+  if (!in_flight_writes_.empty()) {
+    DCHECK_GT(in_flight_writes_.front().buffer->GetRemainingSize(), 0u);
   } else {
-    // Grab the next frame to send.
-    SpdyFrameType frame_type = DATA;
-    scoped_ptr<SpdyBufferProducer> producer;
-    base::WeakPtr<SpdyStream> stream;
-    if (!write_queue_.Dequeue(&frame_type, &producer, &stream)) {
-      write_state_ = WRITE_STATE_IDLE;
-      return ERR_IO_PENDING;
-    }
-
-    if (stream.get())
-      CHECK(!stream->IsClosed());
-
-    // Activate the stream only when sending the SYN_STREAM frame to
-    // guarantee monotonically-increasing stream IDs.
-    if (frame_type == SYN_STREAM) {
-      CHECK(stream.get());
-      CHECK_EQ(stream->stream_id(), 0u);
-      scoped_ptr<SpdyStream> owned_stream =
-          ActivateCreatedStream(stream.get());
-      InsertActivatedStream(owned_stream.Pass());
-
-      if (stream_hi_water_mark_ > kLastStreamId) {
-        CHECK_EQ(stream->stream_id(), kLastStreamId);
-        // We've exhausted the stream ID space, and no new streams may be
-        // created after this one.
-        MakeUnavailable();
-        StartGoingAway(kLastStreamId, ERR_ABORTED);
-      }
-    }
-
     // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is
     // fixed.
     tracked_objects::ScopedTracker tracking_profile1(
         FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite1"));
-    in_flight_write_ = producer->ProduceBuffer();
-    if (!in_flight_write_) {
-      NOTREACHED();
-      return ERR_UNEXPECTED;
+    // Grab the next frames to send, coalescing them up to
+    // |kMaxCoalescedWriteSize|. Since Dequeue() returns frames in
+    // priority order, the cap bounds how much data can get ahead of a
+    // high-priority frame enqueued while the write is in flight.
+    size_t total_size = 0;
+    while (total_size < kMaxCoalescedWriteSize) {
+      SpdyFrameType frame_type = DATA;
+      scoped_ptr<SpdyBufferProducer> producer;
+      base::WeakPtr<SpdyStream> stream;
+      if (!write_queue_.Dequeue(&frame_type, &producer, &stream))
+        break;
+
+      if (stream.get())
+        CHECK(!stream->IsClosed());
+
+      // Activate the stream only when sending the SYN_STREAM frame to
+      // guarantee monotonically-increasing stream IDs.
+      if (frame_type == SYN_STREAM) {
+        CHECK(stream.get());
+        CHECK_EQ(stream->stream_id(), 0u);
+        scoped_ptr<SpdyStream> owned_stream =
+            ActivateCreatedStream(stream.get());
+        InsertActivatedStream(owned_stream.Pass());
+
+        if (stream_hi_water_mark_ > kLastStreamId) {
+          CHECK_EQ(stream->stream_id(), kLastStreamId);
+          // We've exhausted the stream ID space, and no new streams may be
+          // created after this one.
+          MakeUnavailable();
+          StartGoingAway(kLastStreamId, ERR_ABORTED);
+        }
+      }
+
+      scoped_ptr<SpdyBuffer> buffer = producer->ProduceBuffer();
+      if (!buffer) {
+        NOTREACHED();
+        return ERR_UNEXPECTED;
+      }
+      size_t frame_size = buffer->GetRemainingSize();
+      DCHECK_GE(frame_size, buffered_spdy_framer_->GetFrameMinimumSize());
+      total_size += frame_size;
+      in_flight_writes_.push_back(
+          InFlightWrite(buffer.release(), frame_type, frame_size, stream));
+    }
+
+    if (in_flight_writes_.empty()) {
+      write_state_ = WRITE_STATE_IDLE;
+      return ERR_IO_PENDING;
     }
-    in_flight_write_frame_type_ = frame_type;
-    in_flight_write_frame_size_ = in_flight_write_->GetRemainingSize();
-    DCHECK_GE(in_flight_write_frame_size_,
-              buffered_spdy_framer_->GetFrameMinimumSize());
-    in_flight_write_stream_ = stream;
   }
 
   write_state_ = WRITE_STATE_DO_WRITE_COMPLETE;
@@ -1639,11 +1680,34 @@ int SpdySession::DoWrite() {
   // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is fixed.
   tracked_objects::ScopedTracker tracking_profile2(
       FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite2"));
-  scoped_refptr<IOBuffer> write_io_buffer =
-      in_flight_write_->GetIOBufferForRemainingData();
+  scoped_refptr<IOBuffer> write_io_buffer;
+  size_t write_size = 0;
+  if (in_flight_writes_.size() == 1) {
+    // A single frame is written directly from its buffer, with no copy.
+    SpdyBuffer* buffer = in_flight_writes_.front().buffer;
+    write_io_buffer = buffer->GetIOBufferForRemainingData();
+    write_size = buffer->GetRemainingSize();
+  } else {
+    // Coalesce the remaining bytes of all pending frames into a single
+    // buffer so that they are sent with one socket write.
+    for (std::deque<InFlightWrite>::const_iterator it =
+             in_flight_writes_.begin();
+         it != in_flight_writes_.end(); ++it) {
+      write_size += it->buffer->GetRemainingSize();
+    }
+    write_io_buffer = new IOBuffer(write_size);
+    char* data = write_io_buffer->data();
+    for (std::deque<InFlightWrite>::const_iterator it =
+             in_flight_writes_.begin();
+         it != in_flight_writes_.end(); ++it) {
+      memcpy(data, it->buffer->GetRemainingData(),
+             it->buffer->GetRemainingSize());
+      data += it->buffer->GetRemainingSize();
+    }
+  }
   return connection_->socket()->Write(
       write_io_buffer.get(),
-      in_flight_write_->GetRemainingSize(),
+      write_size,
       base::Bind(&SpdySession::PumpWriteLoop,
                  weak_factory_.GetWeakPtr(), WRITE_STATE_DO_WRITE_COMPLETE));
 }
@@ -1651,47 +1715,51 @@ int SpdySession::DoWrite() {
 int SpdySession::DoWriteComplete(int result) {
   CHECK(in_io_loop_);
   DCHECK_NE(result, ERR_IO_PENDING);
-  DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
+  DCHECK(!in_flight_writes_.empty());
+  DCHECK_GT(in_flight_writes_.front().buffer->GetRemainingSize(), 0u);
 
   last_activity_time_ = time_func_();
 
   if (result < 0) {
     DCHECK_NE(result, ERR_IO_PENDING);
-    in_flight_write_.reset();
-    in_flight_write_frame_type_ = DATA;
-    in_flight_write_frame_size_ = 0;
-    in_flight_write_stream_.reset();
+    ClearInFlightWrites();
     write_state_ = WRITE_STATE_DO_WRITE;
     DoDrainSession(static_cast<Error>(result), "Write error");
     return OK;
   }
 
-  // It should not be possible to have written more bytes than our
-  // in_flight_write_.
-  DCHECK_LE(static_cast<size_t>(result),
-            in_flight_write_->GetRemainingSize());
-
-  if (result > 0) {
-    in_flight_write_->Consume(static_cast<size_t>(result));
-    if (in_flight_write_stream_.get())
-      in_flight_write_stream_->AddRawSentBytes(static_cast<size_t>(result));
+  // Consume the written bytes from the in-flight writes in order,
+  // notifying each stream as its frame completes.
+  while (result > 0) {
+    // It should not be possible to have written more bytes than our
+    // in-flight writes.
+    CHECK(!in_flight_writes_.empty());
+    InFlightWrite& front = in_flight_writes_.front();
+
+    size_t consumed_size =
+        std::min(static_cast<size_t>(result), front.buffer->GetRemainingSize());
+    front.buffer->Consume(consumed_size);
+    if (front.stream.get())
+      front.stream->AddRawSentBytes(consumed_size);
+    result -= consumed_size;
 
     // We only notify the stream when we've fully written the pending frame.
-    if (in_flight_write_->GetRemainingSize() == 0) {
-      // It is possible that the stream was cancelled while we were
-      // writing to the socket.
-      if (in_flight_write_stream_.get()) {
-        DCHECK_GT(in_flight_write_frame_size_, 0u);
-        in_flight_write_stream_->OnFrameWriteComplete(
-            in_flight_write_frame_type_,
-            in_flight_write_frame_size_);
-      }
+    if (front.buffer->GetRemainingSize() > 0)
+      break;
+
+    // It is possible that the stream was cancelled while we were
+    // writing to the socket.
+    base::WeakPtr<SpdyStream> stream = front.stream;
+    SpdyFrameType frame_type = front.frame_type;
+    size_t frame_size = front.frame_size;
 
-      // Cleanup the write which just completed.
-      in_flight_write_.reset();
-      in_flight_write_frame_type_ = DATA;
-      in_flight_write_frame_size_ = 0;
-      in_flight_write_stream_.reset();
+    // Cleanup the write which just completed.
+    delete front.buffer;
+    in_flight_writes_.pop_front();
+
+    if (stream.get()) {
+      DCHECK_GT(frame_size, 0u);
+      stream->OnFrameWriteComplete(frame_type, frame_size);
     }
   }
 
@@ -1699,6 +1767,13 @@ int SpdySession::DoWriteComplete(int result) {
   return OK;
 }
 
+void SpdySession::ClearInFlightWrites() {
+  while (!in_flight_writes_.empty()) {
+    delete in_flight_writes_.front().buffer;  // Invokes consume callbacks.
+    in_flight_writes_.pop_front();
+  }
+}
+
 void SpdySession::DcheckGoingAway() const {
 #if DCHECK_IS_ON()
   DCHECK_GE(availability_state_, STATE_GOING_AWAY);
@@ -1968,13 +2043,14 @@ void SpdySession::EnqueueWrite(RequestPriority priority,
   if (availability_state_ == STATE_DRAINING)
     return;
 
+  RecordFrameSent();
   write_queue_.Enqueue(priority, frame_type, producer.Pass(), stream);
   MaybePostWriteLoop();
 }
 
 void SpdySession::MaybePostWriteLoop() {
   if (write_state_ == WRITE_STATE_IDLE) {
-    CHECK(!in_flight_write_);
+    CHECK(in_flight_writes_.empty());
     write_state_ = WRITE_STATE_DO_WRITE;
     base::ThreadTaskRunnerHandle::Get()->PostTask(
         FROM_HERE,
@@ -2011,12 +2087,14 @@ void SpdySession::InsertActivatedStream(scoped_ptr<SpdyStream> stream) {
 }
 
 void SpdySession::DeleteStream(scoped_ptr<SpdyStream> stream, int status) {
-  if (in_flight_write_stream_.get() == stream.get()) {
-    // If we're deleting the stream for the in-flight write, we still
-    // need to let the write complete, so we clear
-    // |in_flight_write_stream_| and let the write finish on its own
-    // without notifying |in_flight_write_stream_|.
-    in_flight_write_stream_.reset();
+  for (std::deque<InFlightWrite>::iterator it = in_flight_writes_.begin();
+       it != in_flight_writes_.end(); ++it) {
+    if (it->stream.get() == stream.get()) {
+      // If we're deleting the stream for an in-flight write, we still
+      // need to let the write complete, so we clear the write's stream
+      // and let it finish on its own without notifying the stream.
+      it->stream.reset();
+    }
   }
 
   write_queue_.RemovePendingWritesForStream(stream->GetWeakPtr());
@@ -2086,6 +2164,7 @@ void SpdySession::OnDataFrameHeader(SpdyStreamId stream_id,
                                     size_t length,
                                     bool fin) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   ActiveStreamMap::iterator it = active_streams_.find(stream_id);
 
@@ -2122,7 +2201,17 @@ void SpdySession::OnStreamFrameData(SpdyStreamId stream_id,
   if (data) {
     DCHECK_GT(len, 0u);
     CHECK_LE(len, static_cast<size_t>(kReadBufferSize));
-    buffer.reset(new SpdyBuffer(data, len));
+    if (data >= read_buffer_->data() &&
+        data + len <= read_buffer_->data() + kReadBufferSize) {
+      // The framer delivers DATA payload as a view directly into
+      // |read_buffer_|; wrap the slice rather than copying it. DoRead()
+      // replaces |read_buffer_| instead of overwriting it while such
+      // slices remain referenced.
+      buffer.reset(
+          new SpdyBuffer(read_buffer_, data - read_buffer_->data(), len));
+    } else {
+      buffer.reset(new SpdyBuffer(data, len));
+    }
 
     if (flow_control_state_ == FLOW_CONTROL_STREAM_AND_SESSION) {
       DecreaseRecvWindowSize(static_cast<int32_t>(len));
@@ -2174,18 +2263,9 @@ void SpdySession::OnStreamPadding(SpdyStreamId stream_id, size_t len) {
   it->second.stream->OnPaddingConsumed(len);
 }
 
-SpdyHeadersHandlerInterface* SpdySession::OnHeaderFrameStart(
-    SpdyStreamId stream_id) {
-  LOG(FATAL);
-  return nullptr;
-}
-
-void SpdySession::OnHeaderFrameEnd(SpdyStreamId stream_id, bool end_headers) {
-  LOG(FATAL);
-}
-
 void SpdySession::OnSettings(bool clear_persisted) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   if (clear_persisted)
     http_server_properties_->ClearSpdySettings(host_port_pair());
@@ -2295,6 +2375,7 @@ void SpdySession::OnSynStream(SpdyStreamId stream_id,
                               bool unidirectional,
                               const SpdyHeaderBlock& headers) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   DCHECK_LE(GetProtocolVersion(), SPDY3);
 
@@ -2369,6 +2450,7 @@ void SpdySession::OnSynReply(SpdyStreamId stream_id,
                              bool fin,
                              const SpdyHeaderBlock& headers) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   base::Time response_time = base::Time::Now();
   base::TimeTicks recv_first_byte_time = time_func_();
@@ -2418,6 +2500,7 @@ void SpdySession::OnHeaders(SpdyStreamId stream_id,
                             bool fin,
                             const SpdyHeaderBlock& headers) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   if (net_log().IsCapturing()) {
     net_log().AddEvent(NetLog::TYPE_HTTP2_SESSION_RECV_HEADERS,
@@ -2480,6 +2563,7 @@ bool SpdySession::OnUnknownFrame(SpdyStreamId stream_id, int frame_type) {
 void SpdySession::OnRstStream(SpdyStreamId stream_id,
                               SpdyRstStreamStatus status) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   std::string description;
   net_log().AddEvent(
@@ -2522,6 +2606,7 @@ void SpdySession::OnGoAway(SpdyStreamId last_accepted_stream_id,
                            SpdyGoAwayStatus status,
                            StringPiece debug_data) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   // TODO(jgraettinger): UMA histogram on |status|.
 
@@ -2546,6 +2631,7 @@ void SpdySession::OnGoAway(SpdyStreamId last_accepted_stream_id,
 
 void SpdySession::OnPing(SpdyPingId unique_id, bool is_ack) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   net_log_.AddEvent(
       NetLog::TYPE_HTTP2_SESSION_PING,
@@ -2571,12 +2657,21 @@ void SpdySession::OnPing(SpdyPingId unique_id, bool is_ack) {
 
   // We will record RTT in histogram when there are no more client sent
   // pings_in_flight_.
-  RecordPingRTTHistogram(time_func_() - last_ping_sent_time_);
+  base::TimeDelta ping_rtt = time_func_() - last_ping_sent_time_;
+  RecordPingRTTHistogram(ping_rtt);
+
+  // Feed the RTT estimate used for receive-window auto-tuning: standard
+  // EWMA with a gain of 1/8, seeded by the first sample.
+  if (rtt_estimate_ == base::TimeDelta())
+    rtt_estimate_ = ping_rtt;
+  else
+    rtt_estimate_ += (ping_rtt - rtt_estimate_) / 8;
 }
 
 void SpdySession::OnWindowUpdate(SpdyStreamId stream_id,
                                  int delta_window_size) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   net_log_.AddEvent(NetLog::TYPE_HTTP2_SESSION_RECEIVED_WINDOW_UPDATE_FRAME,
                     base::Bind(&NetLogSpdyWindowUpdateFrameCallback, stream_id,
@@ -2801,6 +2896,7 @@ void SpdySession::OnPushPromise(SpdyStreamId stream_id,
                                 SpdyStreamId promised_stream_id,
                                 const SpdyHeaderBlock& headers) {
   CHECK(in_io_loop_);
+  RecordFrameReceived();
 
   if (net_log_.IsCapturing()) {
     net_log_.AddEvent(NetLog::TYPE_HTTP2_SESSION_RECV_PUSH_PROMISE,
@@ -2921,9 +3017,9 @@ void SpdySession::HandleSetting(uint32_t id, uint32_t value) {
       }
 
       if (value > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
-        net_log().AddEvent(
+        net_log().AddEventWithIntParams(
             NetLog::TYPE_HTTP2_SESSION_INITIAL_WINDOW_SIZE_OUT_OF_RANGE,
-            NetLog::IntCallback("initial_window_size", value));
+            "initial_window_size", value);
         return;
       }
 
@@ -2932,9 +3028,9 @@ void SpdySession::HandleSetting(uint32_t id, uint32_t value) {
           static_cast<int32_t>(value) - stream_initial_send_window_size_;
       stream_initial_send_window_size_ = static_cast<int32_t>(value);
       UpdateStreamsSendWindowSize(delta_window_size);
-      net_log().AddEvent(
+      net_log().AddEventWithIntParams(
           NetLog::TYPE_HTTP2_SESSION_UPDATE_STREAMS_SEND_WINDOW_SIZE,
-          NetLog::IntCallback("delta_window_size", delta_window_size));
+          "delta_window_size", delta_window_size);
       break;
     }
   }
@@ -3062,6 +3158,20 @@ void SpdySession::RecordProtocolErrorHistogram(
   }
 }
 
+void SpdySession::RecordFrameReceived() {
+  if (pool_ && pool_->session_counters()) {
+    pool_->session_counters()->Increment(
+        HttpSessionCounters::SPDY_FRAMES_RECEIVED);
+  }
+}
+
+void SpdySession::RecordFrameSent() {
+  if (pool_ && pool_->session_counters()) {
+    pool_->session_counters()->Increment(
+        HttpSessionCounters::SPDY_FRAMES_SENT);
+  }
+}
+
 void SpdySession::RecordHistograms() {
   UMA_HISTOGRAM_CUSTOM_COUNTS("Net.SpdyStreamsPerSession",
                               streams_initiated_count_,
@@ -3255,6 +3365,19 @@ void SpdySession::IncreaseRecvWindowSize(int32_t delta_window_size) {
 
   session_unacked_recv_window_bytes_ += delta_window_size;
   if (session_unacked_recv_window_bytes_ > session_max_recv_window_size_ / 2) {
+    int32_t growth =
+        GetWindowUpdateGrowth(&last_session_window_update_time_,
+                              session_max_recv_window_size_,
+                              kSessionMaxRecvWindowSizeCap);
+    if (growth > 0) {
+      session_max_recv_window_size_ += growth;
+      session_recv_window_size_ += growth;
+      net_log_.AddEvent(NetLog::TYPE_HTTP2_STREAM_UPDATE_RECV_WINDOW,
+                        base::Bind(&NetLogSpdySessionWindowUpdateCallback,
+                                   growth, session_recv_window_size_));
+      // The extra window rides along in the WINDOW_UPDATE sent below.
+      session_unacked_recv_window_bytes_ += growth;
+    }
     SendWindowUpdateFrame(kSessionFlowControlStreamId,
                           session_unacked_recv_window_bytes_,
                           HIGHEST);
@@ -3262,6 +3385,29 @@ void SpdySession::IncreaseRecvWindowSize(int32_t delta_window_size) {
   }
 }
 
+int32_t SpdySession::GetWindowUpdateGrowth(
+    base::TimeTicks* last_window_update_time,
+    int32_t max_recv_window_size,
+    int32_t max_recv_window_size_cap) {
+  base::TimeTicks now = time_func_();
+  base::TimeTicks last_update_time = *last_window_update_time;
+  *last_window_update_time = now;
+  // Without an RTT measurement there is no BDP to tune against.
+  if (rtt_estimate_ == base::TimeDelta())
+    return 0;
+  if (max_recv_window_size >= max_recv_window_size_cap)
+    return 0;
+  // A WINDOW_UPDATE goes out each time half the window has been delivered.
+  // If that took less than two round trips, the measured delivery rate
+  // times the round trip time - the path's bandwidth-delay product -
+  // exceeds the current window, so double the window toward the cap.
+  if (last_update_time.is_null() ||
+      now - last_update_time >= 2 * rtt_estimate_)
+    return 0;
+  return std::min(max_recv_window_size_cap, 2 * max_recv_window_size) -
+         max_recv_window_size;
+}
+
 void SpdySession::DecreaseRecvWindowSize(int32_t delta_window_size) {
   CHECK(in_io_loop_);
   DCHECK_EQ(flow_control_state_, FLOW_CONTROL_STREAM_AND_SESSION);
@@ -368,6 +368,19 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   void SendStreamWindowUpdate(SpdyStreamId stream_id,
                               uint32_t delta_window_size);
 
+  // Receive-window auto-tuning, shared by the session window and individual
+  // streams. Called when a WINDOW_UPDATE for a window capped at
+  // |max_recv_window_size| is about to be sent: updates
+  // |*last_window_update_time| and returns the amount by which the window
+  // should grow. The growth is nonzero when updates go out more often than
+  // twice the PING-measured round trip time - meaning the peer drains the
+  // window faster than updates replenish it, so the window and not the link
+  // is the throughput bottleneck - and |max_recv_window_size| is still below
+  // |max_recv_window_size_cap|.
+  int32_t GetWindowUpdateGrowth(base::TimeTicks* last_window_update_time,
+                                int32_t max_recv_window_size,
+                                int32_t max_recv_window_size_cap);
+
   // Accessors for the session's availability state.
   bool IsAvailable() const { return availability_state_ == STATE_AVAILABLE; }
   bool IsGoingAway() const { return availability_state_ == STATE_GOING_AWAY; }
@@ -707,6 +720,10 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   int DoWrite();
   int DoWriteComplete(int result);
 
+  // Deletes the buffers of all writes in |in_flight_writes_| (which
+  // invokes their consume callbacks) and clears it.
+  void ClearInFlightWrites();
+
   // TODO(akalin): Rename the Send* and Write* functions below to
   // Enqueue*.
 
@@ -795,6 +812,10 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   void RecordHistograms();
   void RecordProtocolErrorHistogram(SpdyProtocolErrorDetails details);
 
+  // Bump the owning pool's hot path frame counters, if the pool has any.
+  void RecordFrameReceived();
+  void RecordFrameSent();
+
   // DCHECKs that |availability_state_| >= STATE_GOING_AWAY, that
   // there are no pending stream creation requests, and that there are
   // no created streams.
@@ -843,9 +864,6 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
                          size_t len,
                          bool fin) override;
   void OnStreamPadding(SpdyStreamId stream_id, size_t len) override;
-  SpdyHeadersHandlerInterface* OnHeaderFrameStart(
-      SpdyStreamId stream_id) override;
-  void OnHeaderFrameEnd(SpdyStreamId stream_id, bool end_headers) override;
   void OnSettings(bool clear_persisted) override;
   void OnSetting(SpdySettingsIds id, uint8_t flags, uint32_t value) override;
   void OnWindowUpdate(SpdyStreamId stream_id, int delta_window_size) override;
@@ -1051,17 +1069,36 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // The write queue.
   SpdyWriteQueue write_queue_;
 
-  // Data for the frame we are currently sending.
+  // Data for the frames we are currently sending.
+
+  // A frame dequeued from |write_queue_| that is being written to the
+  // socket, along with the bookkeeping needed to notify its stream
+  // once it has been fully written.
+  struct InFlightWrite {
+    InFlightWrite();
+    InFlightWrite(SpdyBuffer* buffer,
+                  SpdyFrameType frame_type,
+                  size_t frame_size,
+                  const base::WeakPtr<SpdyStream>& stream);
+    ~InFlightWrite();
+
+    // This has to be a raw pointer since we store this in an STL
+    // container. It is owned by |in_flight_writes_|.
+    SpdyBuffer* buffer;
+    // The type of the frame in |buffer|.
+    SpdyFrameType frame_type;
+    // The size of the frame in |buffer|.
+    size_t frame_size;
+    // The stream to notify when |buffer| has been written to the
+    // socket completely.
+    base::WeakPtr<SpdyStream> stream;
+  };
 
-  // The buffer we're currently writing.
-  scoped_ptr<SpdyBuffer> in_flight_write_;
-  // The type of the frame in |in_flight_write_|.
-  SpdyFrameType in_flight_write_frame_type_;
-  // The size of the frame in |in_flight_write_|.
-  size_t in_flight_write_frame_size_;
-  // The stream to notify when |in_flight_write_| has been written to
-  // the socket completely.
-  base::WeakPtr<SpdyStream> in_flight_write_stream_;
+  // The frames currently being written to the socket, in the order in
+  // which they were dequeued from |write_queue_|. DoWrite() coalesces
+  // the frames into a single socket write, so this has more than one
+  // entry only when several small frames were queued at once.
+  std::deque<InFlightWrite> in_flight_writes_;
 
   // Flag if we're using an SSL connection for this SpdySession.
   bool is_secure_;
@@ -1150,6 +1187,14 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // are sent.  Zero unless session flow control is turned on.
   int32_t session_unacked_recv_window_bytes_;
 
+  // When the last session WINDOW_UPDATE frame was sent, for receive-window
+  // auto-tuning.
+  base::TimeTicks last_session_window_update_time_;
+
+  // Smoothed round trip time measured from PING acks. Stays zero, which
+  // disables window auto-tuning, until the first sample arrives.
+  base::TimeDelta rtt_estimate_;
+
   // Initial send window size for this session's streams. Can be
   // changed by an arriving SETTINGS frame. Newly created streams use
   // this value for the initial send window size.
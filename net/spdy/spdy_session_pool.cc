@@ -58,7 +58,8 @@ SpdySessionPool::SpdySessionPool(
       stream_max_recv_window_size_(stream_max_recv_window_size),
       initial_max_concurrent_streams_(initial_max_concurrent_streams),
       time_func_(time_func),
-      trusted_spdy_proxy_(HostPortPair::FromString(trusted_spdy_proxy)) {
+      trusted_spdy_proxy_(HostPortPair::FromString(trusted_spdy_proxy)),
+      session_counters_(NULL) {
   DCHECK(default_protocol_ >= kProtoSPDYMinimumVersion &&
          default_protocol_ <= kProtoSPDYMaximumVersion);
   NetworkChangeNotifier::AddIPAddressObserver(this);
@@ -121,7 +122,7 @@ base::WeakPtr<SpdySession> SpdySessionPool::CreateAvailableSessionFromSocket(
   if (key.proxy_server().is_direct()) {
     IPEndPoint address;
     if (available_session->GetPeerAddress(&address) == OK)
-      aliases_[address] = key;
+      MapAlias(address, key);
   }
 
   return available_session;
@@ -335,18 +336,41 @@ void SpdySessionPool::UnmapKey(const SpdySessionKey& key) {
   available_sessions_.erase(it);
 }
 
+void SpdySessionPool::MapAlias(const IPEndPoint& address,
+                               const SpdySessionKey& key) {
+  std::pair<AliasMap::iterator, bool> result =
+      aliases_.insert(std::make_pair(address, key));
+  if (!result.second) {
+    // |address| was aliased to another session's key; repoint it to
+    // |key| and drop it from the old key's reverse index entry.
+    const SpdySessionKey& old_key = result.first->second;
+    if (old_key.Equals(key))
+      return;
+    AliasesByKeyMap::iterator old_it = aliases_by_key_.find(old_key);
+    DCHECK(old_it != aliases_by_key_.end());
+    old_it->second.erase(address);
+    if (old_it->second.empty())
+      aliases_by_key_.erase(old_it);
+    result.first->second = key;
+  }
+  aliases_by_key_[key].insert(address);
+}
+
 void SpdySessionPool::RemoveAliases(const SpdySessionKey& key) {
-  // Walk the aliases map, find references to this pair.
-  // TODO(mbelshe):  Figure out if this is too expensive.
-  for (AliasMap::iterator it = aliases_.begin(); it != aliases_.end(); ) {
-    if (it->second.Equals(key)) {
-      AliasMap::iterator old_it = it;
-      ++it;
-      aliases_.erase(old_it);
-    } else {
-      ++it;
-    }
+  AliasesByKeyMap::iterator it = aliases_by_key_.find(key);
+  if (it == aliases_by_key_.end())
+    return;
+  // Erase exactly the endpoints aliased to |key|, rather than walking
+  // the whole aliases map.
+  const std::set<IPEndPoint>& addresses = it->second;
+  for (std::set<IPEndPoint>::const_iterator address_it = addresses.begin();
+       address_it != addresses.end(); ++address_it) {
+    AliasMap::iterator alias_it = aliases_.find(*address_it);
+    DCHECK(alias_it != aliases_.end());
+    DCHECK(alias_it->second.Equals(key));
+    aliases_.erase(alias_it);
   }
+  aliases_by_key_.erase(it);
 }
 
 SpdySessionPool::WeakSessionList SpdySessionPool::GetCurrentSessions() const {
@@ -32,6 +32,7 @@ class BoundNetLog;
 class ClientSocketHandle;
 class HostResolver;
 class HttpServerProperties;
+class HttpSessionCounters;
 class SpdySession;
 class TransportSecurityState;
 
@@ -125,6 +126,14 @@ class NET_EXPORT SpdySessionPool
     return http_server_properties_;
   }
 
+  // The owning HttpNetworkSession's hot path counters, or NULL when this
+  // pool was created without one (e.g. in tests).  The counters must
+  // outlive this pool.
+  HttpSessionCounters* session_counters() const { return session_counters_; }
+  void set_session_counters(HttpSessionCounters* counters) {
+    session_counters_ = counters;
+  }
+
   // NetworkChangeNotifier::IPAddressObserver methods:
 
   // We flush all idle sessions and release references to the active ones so
@@ -152,6 +161,7 @@ class NET_EXPORT SpdySessionPool
   typedef std::map<SpdySessionKey, base::WeakPtr<SpdySession> >
       AvailableSessionMap;
   typedef std::map<IPEndPoint, SpdySessionKey> AliasMap;
+  typedef std::map<SpdySessionKey, std::set<IPEndPoint> > AliasesByKeyMap;
 
   // Returns true iff |session| is in |available_sessions_|.
   bool IsSessionAvailable(const base::WeakPtr<SpdySession>& session) const;
@@ -169,7 +179,12 @@ class NET_EXPORT SpdySessionPool
   // Remove the mapping of the given key, which must exist.
   void UnmapKey(const SpdySessionKey& key);
 
-  // Remove all aliases for |key| from the aliases table.
+  // Alias the given resolved endpoint to the given key, updating both
+  // |aliases_| and |aliases_by_key_|. If |address| was already aliased
+  // to another key, it is repointed to |key|.
+  void MapAlias(const IPEndPoint& address, const SpdySessionKey& key);
+
+  // Remove all aliases for |key| from the aliases tables.
   void RemoveAliases(const SpdySessionKey& key);
 
   // Get a copy of the current sessions as a list of WeakPtrs. Used by
@@ -201,6 +216,11 @@ class NET_EXPORT SpdySessionPool
   // A map of IPEndPoint aliases for sessions.
   AliasMap aliases_;
 
+  // The reverse index of |aliases_|: for each aliased key, the set of
+  // endpoints mapped to it. Lets RemoveAliases() erase just a session's
+  // own aliases instead of walking the whole |aliases_| map.
+  AliasesByKeyMap aliases_by_key_;
+
   const scoped_refptr<SSLConfigService> ssl_config_service_;
   HostResolver* const resolver_;
 
@@ -219,6 +239,9 @@ class NET_EXPORT SpdySessionPool
   // different from those of their associated streams.
   HostPortPair trusted_spdy_proxy_;
 
+  // Unowned; may be NULL.
+  HttpSessionCounters* session_counters_;
+
   DISALLOW_COPY_AND_ASSIGN(SpdySessionPool);
 };
 
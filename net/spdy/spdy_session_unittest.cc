@@ -1855,6 +1855,77 @@ TEST_P(SpdySessionTest, OutOfOrderSynStreams) {
   EXPECT_EQ(1u, delegate_highest.stream_id());
 }
 
+// Frames enqueued while a write is not in flight should be coalesced
+// into a single socket write.
+TEST_P(SpdySessionTest, CoalescedWrites) {
+  // Construct the requests.
+  scoped_ptr<SpdyFrame> req1(
+      spdy_util_.ConstructSpdyGet(nullptr, 0, false, 1, MEDIUM, true));
+  scoped_ptr<SpdyFrame> req2(
+      spdy_util_.ConstructSpdyGet(nullptr, 0, false, 3, MEDIUM, true));
+
+  // Both requests should be sent with a single socket write.
+  std::string coalesced_data;
+  coalesced_data.append(req1->data(), req1->size());
+  coalesced_data.append(req2->data(), req2->size());
+  MockWrite writes[] = {
+      MockWrite(ASYNC, coalesced_data.data(), coalesced_data.size(), 0),
+  };
+
+  scoped_ptr<SpdyFrame> resp1(
+      spdy_util_.ConstructSpdyGetSynReply(nullptr, 0, 1));
+  scoped_ptr<SpdyFrame> body1(spdy_util_.ConstructSpdyBodyFrame(1, true));
+  scoped_ptr<SpdyFrame> resp2(
+      spdy_util_.ConstructSpdyGetSynReply(nullptr, 0, 3));
+  scoped_ptr<SpdyFrame> body2(spdy_util_.ConstructSpdyBodyFrame(3, true));
+  MockRead reads[] = {
+    CreateMockRead(*resp1, 1),
+    CreateMockRead(*body1, 2),
+    CreateMockRead(*resp2, 3),
+    CreateMockRead(*body2, 4),
+    MockRead(ASYNC, 0, 5)  // EOF
+  };
+
+  session_deps_.host_resolver->set_synchronous_mode(true);
+
+  SequencedSocketData data(reads, arraysize(reads), writes, arraysize(writes));
+  session_deps_.socket_factory->AddSocketDataProvider(&data);
+
+  CreateNetworkSession();
+  CreateInsecureSpdySession();
+
+  base::WeakPtr<SpdyStream> spdy_stream1 = CreateStreamSynchronously(
+      SPDY_REQUEST_RESPONSE_STREAM, session_, test_url_, MEDIUM, BoundNetLog());
+  ASSERT_TRUE(spdy_stream1);
+  test::StreamDelegateDoNothing delegate1(spdy_stream1);
+  spdy_stream1->SetDelegate(&delegate1);
+
+  base::WeakPtr<SpdyStream> spdy_stream2 = CreateStreamSynchronously(
+      SPDY_REQUEST_RESPONSE_STREAM, session_, test_url_, MEDIUM, BoundNetLog());
+  ASSERT_TRUE(spdy_stream2);
+  test::StreamDelegateDoNothing delegate2(spdy_stream2);
+  spdy_stream2->SetDelegate(&delegate2);
+
+  // Queue both requests before the write loop runs.
+
+  scoped_ptr<SpdyHeaderBlock> headers1(
+      spdy_util_.ConstructGetHeaderBlock(kDefaultURL));
+  spdy_stream1->SendRequestHeaders(headers1.Pass(), NO_MORE_DATA_TO_SEND);
+  EXPECT_TRUE(spdy_stream1->HasUrlFromHeaders());
+
+  scoped_ptr<SpdyHeaderBlock> headers2(
+      spdy_util_.ConstructGetHeaderBlock(kDefaultURL));
+  spdy_stream2->SendRequestHeaders(headers2.Pass(), NO_MORE_DATA_TO_SEND);
+  EXPECT_TRUE(spdy_stream2->HasUrlFromHeaders());
+
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_FALSE(spdy_stream1);
+  EXPECT_FALSE(spdy_stream2);
+  EXPECT_EQ(1u, delegate1.stream_id());
+  EXPECT_EQ(3u, delegate2.stream_id());
+}
+
 TEST_P(SpdySessionTest, CancelStream) {
   // Request 1, at HIGHEST priority, will be cancelled before it writes data.
   // Request 2, at LOWEST priority, will be a full request and will be id 1.
@@ -3499,6 +3570,44 @@ TEST_P(SpdySessionTest, AdjustRecvWindowSize) {
   EXPECT_FALSE(session_);
 }
 
+// Receive-window auto-tuning should grow a window only when WINDOW_UPDATE
+// frames go out more often than twice the measured round trip time, and
+// never without an RTT sample or beyond the cap.
+TEST_P(SpdySessionTest, ReceiveWindowAutoTuneGrowth) {
+  session_deps_.host_resolver->set_synchronous_mode(true);
+  session_deps_.time_func = TheNearFuture;
+
+  MockRead reads[] = {
+    MockRead(SYNCHRONOUS, 0, 0)  // EOF
+  };
+  StaticSocketDataProvider data(reads, arraysize(reads), nullptr, 0);
+  session_deps_.socket_factory->AddSocketDataProvider(&data);
+
+  CreateNetworkSession();
+  session_ = CreateFakeSpdySession(spdy_session_pool_, key_);
+
+  // Without an RTT sample there is no growth, even for back-to-back updates.
+  base::TimeTicks last_update;
+  EXPECT_EQ(0, session_->GetWindowUpdateGrowth(&last_update, 1000, 4000));
+  EXPECT_EQ(0, session_->GetWindowUpdateGrowth(&last_update, 1000, 4000));
+
+  session_->rtt_estimate_ = base::TimeDelta::FromMilliseconds(100);
+
+  // The first update only records the time; a second update within two
+  // round trips doubles the window.
+  last_update = base::TimeTicks();
+  EXPECT_EQ(0, session_->GetWindowUpdateGrowth(&last_update, 1000, 4000));
+  EXPECT_EQ(1000, session_->GetWindowUpdateGrowth(&last_update, 1000, 4000));
+
+  // Growth is clamped to the cap, and stops entirely once the cap is hit.
+  EXPECT_EQ(1000, session_->GetWindowUpdateGrowth(&last_update, 3000, 4000));
+  EXPECT_EQ(0, session_->GetWindowUpdateGrowth(&last_update, 4000, 4000));
+
+  // Updates spaced more than two round trips apart do not grow the window.
+  g_time_delta += base::TimeDelta::FromMilliseconds(300);
+  EXPECT_EQ(0, session_->GetWindowUpdateGrowth(&last_update, 1000, 4000));
+}
+
 // SpdySession::{Increase,Decrease}SendWindowSize should properly
 // adjust the session send window size when the "enable_spdy_31" flag
 // is set.
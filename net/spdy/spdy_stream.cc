@@ -24,6 +24,9 @@ namespace net {
 
 namespace {
 
+// Largest stream receive window that auto-tuning will grow to.
+const int32_t kStreamMaxRecvWindowSizeCap = 6 * 1024 * 1024;  // 6 MB
+
 scoped_ptr<base::Value> NetLogSpdyStreamErrorCallback(
     SpdyStreamId stream_id,
     int status,
@@ -347,6 +350,19 @@ void SpdyStream::IncreaseRecvWindowSize(int32_t delta_window_size) {
 
   unacked_recv_window_bytes_ += delta_window_size;
   if (unacked_recv_window_bytes_ > max_recv_window_size_ / 2) {
+    int32_t growth = session_->GetWindowUpdateGrowth(
+        &last_window_update_time_, max_recv_window_size_,
+        kStreamMaxRecvWindowSizeCap);
+    if (growth > 0) {
+      max_recv_window_size_ += growth;
+      recv_window_size_ += growth;
+      net_log_.AddEvent(
+          NetLog::TYPE_HTTP2_STREAM_UPDATE_RECV_WINDOW,
+          base::Bind(&NetLogSpdyStreamWindowUpdateCallback, stream_id_,
+                     growth, recv_window_size_));
+      // The extra window rides along in the WINDOW_UPDATE sent below.
+      unacked_recv_window_bytes_ += growth;
+    }
     session_->SendStreamWindowUpdate(
         stream_id_, static_cast<uint32_t>(unacked_recv_window_bytes_));
     unacked_recv_window_bytes_ = 0;
@@ -735,8 +751,9 @@ void SpdyStream::PossiblyResumeIfSendStalled() {
   }
   if (send_stalled_by_flow_control_ && !session_->IsSendStalled() &&
       send_window_size_ > 0) {
-    net_log_.AddEvent(NetLog::TYPE_HTTP2_STREAM_FLOW_CONTROL_UNSTALLED,
-                      NetLog::IntCallback("stream_id", stream_id_));
+    net_log_.AddEventWithIntParams(
+        NetLog::TYPE_HTTP2_STREAM_FLOW_CONTROL_UNSTALLED, "stream_id",
+        stream_id_);
     send_stalled_by_flow_control_ = false;
     QueueNextDataFrame();
   }
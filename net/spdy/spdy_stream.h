@@ -525,6 +525,10 @@ class NET_EXPORT_PRIVATE SpdyStream {
   // are sent.
   int32_t unacked_recv_window_bytes_;
 
+  // When the last WINDOW_UPDATE frame was sent for this stream, for
+  // receive-window auto-tuning.
+  base::TimeTicks last_window_update_time_;
+
   const base::WeakPtr<SpdySession> session_;
 
   // The transaction should own the delegate.
@@ -5,6 +5,7 @@
 #include "net/spdy/spdy_write_queue.h"
 
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "base/logging.h"
@@ -53,6 +54,15 @@ void SpdyWriteQueue::Enqueue(RequestPriority priority,
     DCHECK_EQ(stream->priority(), priority);
   queue_[priority].push_back(
       PendingWrite(frame_type, frame_producer.release(), stream));
+  if (stream.get()) {
+    PendingWriteList::iterator write_it = --queue_[priority].end();
+    StreamWriteMap::iterator map_it =
+        stream_writes_.insert(std::make_pair(stream.get(), StreamWriteList()))
+            .first;
+    map_it->second.push_back(write_it);
+    write_it->stream_map_entry = map_it;
+    write_it->stream_link = --map_it->second.end();
+  }
 }
 
 bool SpdyWriteQueue::Dequeue(SpdyFrameType* frame_type,
@@ -62,6 +72,8 @@ bool SpdyWriteQueue::Dequeue(SpdyFrameType* frame_type,
   for (int i = MAXIMUM_PRIORITY; i >= MINIMUM_PRIORITY; --i) {
     if (!queue_[i].empty()) {
       PendingWrite pending_write = queue_[i].front();
+      if (pending_write.has_stream)
+        UnlinkStreamWrite(pending_write);
       queue_[i].pop_front();
       *frame_type = pending_write.frame_type;
       frame_producer->reset(pending_write.frame_producer);
@@ -89,30 +101,27 @@ void SpdyWriteQueue::RemovePendingWritesForStream(
   for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
     if (priority == i)
       continue;
-    for (std::deque<PendingWrite>::const_iterator it = queue_[i].begin();
+    for (PendingWriteList::const_iterator it = queue_[i].begin();
          it != queue_[i].end(); ++it) {
       DCHECK_NE(it->stream.get(), stream.get());
     }
   }
 #endif
 
-  // Defer deletion until queue iteration is complete, as
+  // Defer deletion until queue manipulation is complete, as
   // SpdyBuffer::~SpdyBuffer() can result in callbacks into SpdyWriteQueue.
   std::vector<SpdyBufferProducer*> erased_buffer_producers;
 
-  // Do the actual deletion and removal, preserving FIFO-ness.
-  std::deque<PendingWrite>* queue = &queue_[priority];
-  std::deque<PendingWrite>::iterator out_it = queue->begin();
-  for (std::deque<PendingWrite>::const_iterator it = queue->begin();
-       it != queue->end(); ++it) {
-    if (it->stream.get() == stream.get()) {
-      erased_buffer_producers.push_back(it->frame_producer);
-    } else {
-      *out_it = *it;
-      ++out_it;
+  // Unlink all of the stream's writes via the index, in queue order.
+  StreamWriteMap::iterator map_it = stream_writes_.find(stream.get());
+  if (map_it != stream_writes_.end()) {
+    for (StreamWriteList::const_iterator it = map_it->second.begin();
+         it != map_it->second.end(); ++it) {
+      erased_buffer_producers.push_back((*it)->frame_producer);
+      queue_[priority].erase(*it);
     }
+    stream_writes_.erase(map_it);
   }
-  queue->erase(out_it, queue->end());
   removing_writes_ = false;
   STLDeleteElements(&erased_buffer_producers);  // Invokes callbacks.
 }
@@ -125,19 +134,19 @@ void SpdyWriteQueue::RemovePendingWritesForStreamsAfter(
 
   for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
     // Do the actual deletion and removal, preserving FIFO-ness.
-    std::deque<PendingWrite>* queue = &queue_[i];
-    std::deque<PendingWrite>::iterator out_it = queue->begin();
-    for (std::deque<PendingWrite>::const_iterator it = queue->begin();
-         it != queue->end(); ++it) {
+    PendingWriteList* queue = &queue_[i];
+    for (PendingWriteList::iterator it = queue->begin();
+         it != queue->end();) {
       if (it->stream.get() && (it->stream->stream_id() > last_good_stream_id ||
                                it->stream->stream_id() == 0)) {
         erased_buffer_producers.push_back(it->frame_producer);
+        if (it->has_stream)
+          UnlinkStreamWrite(*it);
+        it = queue->erase(it);
       } else {
-        *out_it = *it;
-        ++out_it;
+        ++it;
       }
     }
-    queue->erase(out_it, queue->end());
   }
   removing_writes_ = false;
   STLDeleteElements(&erased_buffer_producers);  // Invokes callbacks.
@@ -149,14 +158,23 @@ void SpdyWriteQueue::Clear() {
   std::vector<SpdyBufferProducer*> erased_buffer_producers;
 
   for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
-    for (std::deque<PendingWrite>::iterator it = queue_[i].begin();
+    for (PendingWriteList::iterator it = queue_[i].begin();
          it != queue_[i].end(); ++it) {
       erased_buffer_producers.push_back(it->frame_producer);
     }
     queue_[i].clear();
   }
+  stream_writes_.clear();
   removing_writes_ = false;
   STLDeleteElements(&erased_buffer_producers);  // Invokes callbacks.
 }
 
+void SpdyWriteQueue::UnlinkStreamWrite(const PendingWrite& write) {
+  DCHECK(write.has_stream);
+  StreamWriteList* stream_writes = &write.stream_map_entry->second;
+  stream_writes->erase(write.stream_link);
+  if (stream_writes->empty())
+    stream_writes_.erase(write.stream_map_entry);
+}
+
 }  // namespace net
@@ -5,7 +5,8 @@
 #ifndef NET_SPDY_SPDY_WRITE_QUEUE_H_
 #define NET_SPDY_SPDY_WRITE_QUEUE_H_
 
-#include <deque>
+#include <list>
+#include <map>
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
@@ -61,6 +62,14 @@ class NET_EXPORT_PRIVATE SpdyWriteQueue {
   void Clear();
 
  private:
+  struct PendingWrite;
+  typedef std::list<PendingWrite> PendingWriteList;
+  // A stream's pending writes within its priority queue, in queue order.
+  typedef std::list<PendingWriteList::iterator> StreamWriteList;
+  // Index of each stream's pending writes. Keys are only used for identity
+  // and are never dereferenced.
+  typedef std::map<const SpdyStream*, StreamWriteList> StreamWriteMap;
+
   // A struct holding a frame producer and its associated stream.
   struct PendingWrite {
     SpdyFrameType frame_type;
@@ -70,6 +79,10 @@ class NET_EXPORT_PRIVATE SpdyWriteQueue {
     base::WeakPtr<SpdyStream> stream;
     // Whether |stream| was non-NULL when enqueued.
     bool has_stream;
+    // Links back to this write's entry in |stream_writes_|, so that
+    // dequeuing can unlink it in O(1). Valid only if |has_stream|.
+    StreamWriteMap::iterator stream_map_entry;
+    StreamWriteList::iterator stream_link;
 
     PendingWrite();
     PendingWrite(SpdyFrameType frame_type,
@@ -78,10 +91,15 @@ class NET_EXPORT_PRIVATE SpdyWriteQueue {
     ~PendingWrite();
   };
 
+  // Unlinks |write| from |stream_writes_|. |write| must have a stream.
+  void UnlinkStreamWrite(const PendingWrite& write);
+
   bool removing_writes_;
 
   // The actual write queue, binned by priority.
-  std::deque<PendingWrite> queue_[NUM_PRIORITIES];
+  PendingWriteList queue_[NUM_PRIORITIES];
+
+  StreamWriteMap stream_writes_;
 
   DISALLOW_COPY_AND_ASSIGN(SpdyWriteQueue);
 };
@@ -216,6 +216,47 @@ TEST_F(SpdyWriteQueueTest, RemovePendingWritesForStream) {
   EXPECT_FALSE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
 }
 
+// Dequeue some of a stream's writes before removing the rest, then
+// enqueue for the same stream again. The per-stream index must stay
+// consistent across all three operations.
+TEST_F(SpdyWriteQueueTest, DequeueRemoveThenEnqueueAgain) {
+  SpdyWriteQueue write_queue;
+
+  scoped_ptr<SpdyStream> stream1(MakeTestStream(DEFAULT_PRIORITY));
+  scoped_ptr<SpdyStream> stream2(MakeTestStream(DEFAULT_PRIORITY));
+
+  for (int i = 0; i < 10; ++i) {
+    base::WeakPtr<SpdyStream> stream =
+        (((i % 2) == 0) ? stream1 : stream2)->GetWeakPtr();
+    write_queue.Enqueue(DEFAULT_PRIORITY, SYN_STREAM, IntToProducer(i), stream);
+  }
+
+  // Dequeue the first two writes, one per stream.
+  SpdyFrameType frame_type = DATA;
+  scoped_ptr<SpdyBufferProducer> frame_producer;
+  base::WeakPtr<SpdyStream> stream;
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(0, ProducerToInt(frame_producer.Pass()));
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(1, ProducerToInt(frame_producer.Pass()));
+
+  write_queue.RemovePendingWritesForStream(stream2->GetWeakPtr());
+
+  for (int i = 2; i < 10; i += 2) {
+    ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+    EXPECT_EQ(i, ProducerToInt(frame_producer.Pass()));
+    EXPECT_EQ(stream1.get(), stream.get());
+  }
+  EXPECT_FALSE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+
+  // |stream2| can enqueue again after its writes were removed.
+  write_queue.Enqueue(DEFAULT_PRIORITY, SYN_STREAM, IntToProducer(100),
+                      stream2->GetWeakPtr());
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(100, ProducerToInt(frame_producer.Pass()));
+  EXPECT_EQ(stream2.get(), stream.get());
+}
+
 // Enqueue a bunch of writes and then call
 // RemovePendingWritesForStreamsAfter(). No dequeued write should be for
 // those streams without a stream id, or with a stream_id after that
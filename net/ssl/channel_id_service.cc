@@ -107,6 +107,27 @@ scoped_ptr<ChannelIDStore::ChannelID> GenerateChannelID(
   return result.Pass();
 }
 
+// The number of EC key pairs kept pre-generated for future channel IDs, so
+// that a channel ID for a new domain can usually be created without waiting
+// on the worker pool. Replenishment is prompt, so the pool only needs to
+// cover a short burst of connections to distinct new domains.
+const size_t kDefaultKeyPoolDepth = 4;
+
+// Generates a new EC key pair on a worker thread. The key is not yet bound
+// to a domain; ChannelIDService pools such keys so that channel IDs for new
+// domains can be created without waiting for key generation.
+void GeneratePooledKey(
+    const scoped_refptr<base::SequencedTaskRunner>& origin_task_runner,
+    const base::Callback<void(scoped_ptr<crypto::ECPrivateKey>)>& callback) {
+  scoped_ptr<crypto::ECPrivateKey> key(crypto::ECPrivateKey::Create());
+#if !defined(USE_OPENSSL)
+  // Detach the thread from NSPR. See ChannelIDServiceWorker::Run.
+  PR_DetachThread();
+#endif
+  origin_task_runner->PostTask(FROM_HERE,
+                               base::Bind(callback, base::Passed(&key)));
+}
+
 }  // namespace
 
 // ChannelIDServiceWorker runs on a worker thread and takes care of the
@@ -286,10 +307,13 @@ ChannelIDService::ChannelIDService(
     const scoped_refptr<base::TaskRunner>& task_runner)
     : channel_id_store_(channel_id_store),
       task_runner_(task_runner),
+      pregenerations_inflight_(0),
+      key_pool_depth_(kDefaultKeyPoolDepth),
       requests_(0),
       key_store_hits_(0),
       inflight_joins_(0),
       workers_created_(0),
+      key_pool_hits_(0),
       weak_ptr_factory_(this) {
 }
 
@@ -339,7 +363,22 @@ int ChannelIDService::GetOrCreateChannelID(
   int err = LookupChannelID(request_start, domain, key, create_if_missing,
                             callback, out_req);
   if (err == ERR_FILE_NOT_FOUND) {
-    // Sync lookup did not find a valid channel ID.  Start generating a new one.
+    // Sync lookup did not find a valid channel ID.  Use a pre-generated key
+    // if one is ready; otherwise start generating a new one.
+    scoped_ptr<crypto::ECPrivateKey> pooled_key = TakePreGeneratedKey();
+    if (pooled_key) {
+      key_pool_hits_++;
+      key->reset(pooled_key->Copy());
+      channel_id_store_->SetChannelID(
+          make_scoped_ptr(new ChannelIDStore::ChannelID(
+              domain, base::Time::Now(), pooled_key.Pass())));
+      RecordGetChannelIDResult(SYNC_SUCCESS);
+      base::TimeDelta request_time = base::TimeTicks::Now() - request_start;
+      UMA_HISTOGRAM_TIMES("DomainBoundCerts.GetCertTimeSync", request_time);
+      RecordGetChannelIDTime(request_time);
+      return OK;
+    }
+    ReplenishKeyPool();
     workers_created_++;
     ChannelIDServiceWorker* worker = new ChannelIDServiceWorker(
         domain,
@@ -422,8 +461,19 @@ void ChannelIDService::GotChannelID(int err,
     HandleResult(err, server_identifier, key.Pass());
     return;
   }
-  // At least one request asked to create a channel ID => start generating a new
-  // one.
+  // At least one request asked to create a channel ID => use a pre-generated
+  // key if one is ready, otherwise start generating a new one.
+  scoped_ptr<crypto::ECPrivateKey> pooled_key = TakePreGeneratedKey();
+  if (pooled_key) {
+    key_pool_hits_++;
+    scoped_ptr<crypto::ECPrivateKey> key_copy(pooled_key->Copy());
+    channel_id_store_->SetChannelID(
+        make_scoped_ptr(new ChannelIDStore::ChannelID(
+            server_identifier, base::Time::Now(), pooled_key.Pass())));
+    HandleResult(OK, server_identifier, key_copy.Pass());
+    return;
+  }
+  ReplenishKeyPool();
   workers_created_++;
   ChannelIDServiceWorker* worker = new ChannelIDServiceWorker(
       server_identifier,
@@ -531,6 +581,49 @@ int ChannelIDService::LookupChannelID(const base::TimeTicks& request_start,
   return err;
 }
 
+scoped_ptr<crypto::ECPrivateKey> ChannelIDService::TakePreGeneratedKey() {
+  DCHECK(CalledOnValidThread());
+
+  if (key_pool_depth_ == 0 || pregenerated_keys_.empty())
+    return nullptr;
+
+  scoped_ptr<crypto::ECPrivateKey> key(pregenerated_keys_.back());
+  pregenerated_keys_.weak_erase(pregenerated_keys_.end() - 1);
+  ReplenishKeyPool();
+  return key.Pass();
+}
+
+void ChannelIDService::ReplenishKeyPool() {
+  DCHECK(CalledOnValidThread());
+
+  while (pregenerated_keys_.size() + pregenerations_inflight_ <
+         key_pool_depth_) {
+    if (!task_runner_->PostTask(
+            FROM_HERE,
+            base::Bind(&GeneratePooledKey, base::ThreadTaskRunnerHandle::Get(),
+                       base::Bind(&ChannelIDService::PreGeneratedKeyReady,
+                                  weak_ptr_factory_.GetWeakPtr())))) {
+      // The task runner is shutting down. Requests will fall back to
+      // generating keys through ChannelIDServiceWorker, which reports
+      // errors per request if that fails as well.
+      return;
+    }
+    pregenerations_inflight_++;
+  }
+}
+
+void ChannelIDService::PreGeneratedKeyReady(
+    scoped_ptr<crypto::ECPrivateKey> key) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_GT(pregenerations_inflight_, 0u);
+
+  pregenerations_inflight_--;
+  // On generation failure, leave the pool short rather than retrying in a
+  // loop; requests simply fall back to the worker path.
+  if (key && pregenerated_keys_.size() < key_pool_depth_)
+    pregenerated_keys_.push_back(key.release());
+}
+
 int ChannelIDService::channel_id_count() {
   return channel_id_store_->GetChannelIDCount();
 }
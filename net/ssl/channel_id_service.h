@@ -11,6 +11,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time/time.h"
@@ -127,12 +128,19 @@ class NET_EXPORT ChannelIDService
   // Returns the backing ChannelIDStore.
   ChannelIDStore* GetChannelIDStore();
 
+  // Sets the number of EC key pairs the service keeps pre-generated for
+  // future channel IDs. The pool is replenished on the worker pool after
+  // each use, starting with the first request that needs a new key. A depth
+  // of 0 disables pre-generation.
+  void set_key_pool_depth(size_t depth) { key_pool_depth_ = depth; }
+
   // Public only for unit testing.
   int channel_id_count();
   uint64 requests() const { return requests_; }
   uint64 key_store_hits() const { return key_store_hits_; }
   uint64 inflight_joins() const { return inflight_joins_; }
   uint64 workers_created() const { return workers_created_; }
+  uint64 key_pool_hits() const { return key_pool_hits_; }
 
  private:
   void GotChannelID(int err,
@@ -167,6 +175,18 @@ class NET_EXPORT ChannelIDService
                       const CompletionCallback& callback,
                       Request* out_req);
 
+  // Takes a pre-generated key from the pool, or returns NULL if none is
+  // ready (or the pool is disabled). Triggers a replenish for each key
+  // taken.
+  scoped_ptr<crypto::ECPrivateKey> TakePreGeneratedKey();
+
+  // Posts key generation tasks to |task_runner_| until the number of pooled
+  // and in-flight keys reaches the configured pool depth.
+  void ReplenishKeyPool();
+
+  // Called with a key generated on the worker pool by ReplenishKeyPool().
+  void PreGeneratedKeyReady(scoped_ptr<crypto::ECPrivateKey> key);
+
   scoped_ptr<ChannelIDStore> channel_id_store_;
   scoped_refptr<base::TaskRunner> task_runner_;
 
@@ -174,10 +194,19 @@ class NET_EXPORT ChannelIDService
   // place.
   std::map<std::string, ChannelIDServiceJob*> inflight_;
 
+  // Keys generated ahead of time, so that a channel ID for a new domain
+  // usually does not have to wait on a worker-pool round trip. Replenished
+  // lazily, starting with the first request that needs a new key.
+  ScopedVector<crypto::ECPrivateKey> pregenerated_keys_;
+  // The number of keys currently being generated for the pool.
+  size_t pregenerations_inflight_;
+  size_t key_pool_depth_;
+
   uint64 requests_;
   uint64 key_store_hits_;
   uint64 inflight_joins_;
   uint64 workers_created_;
+  uint64 key_pool_hits_;
 
   base::WeakPtrFactory<ChannelIDService> weak_ptr_factory_;
 
@@ -207,13 +207,12 @@ TEST_F(ChannelIDServiceTest, StoreChannelIDs) {
   EXPECT_EQ(OK, error);
   EXPECT_EQ(1, service_->channel_id_count());
 
+  // Generating the first channel ID filled the pre-generated key pool, so
+  // subsequent creations for new domains complete synchronously.
   std::string host2("www.verisign.com");
   scoped_ptr<crypto::ECPrivateKey> key2;
   error = service_->GetOrCreateChannelID(host2, &key2, callback.callback(),
                                          &request);
-  EXPECT_EQ(ERR_IO_PENDING, error);
-  EXPECT_TRUE(request.is_active());
-  error = callback.WaitForResult();
   EXPECT_EQ(OK, error);
   EXPECT_EQ(2, service_->channel_id_count());
 
@@ -221,9 +220,6 @@ TEST_F(ChannelIDServiceTest, StoreChannelIDs) {
   scoped_ptr<crypto::ECPrivateKey> key3;
   error = service_->GetOrCreateChannelID(host3, &key3, callback.callback(),
                                          &request);
-  EXPECT_EQ(ERR_IO_PENDING, error);
-  EXPECT_TRUE(request.is_active());
-  error = callback.WaitForResult();
   EXPECT_EQ(OK, error);
   EXPECT_EQ(3, service_->channel_id_count());
 
@@ -232,6 +228,50 @@ TEST_F(ChannelIDServiceTest, StoreChannelIDs) {
   EXPECT_FALSE(KeysEqual(key2.get(), key3.get()));
 }
 
+// Tests that, once a request has warmed the pre-generated key pool, channel
+// IDs for new domains are created synchronously from the pool, and that
+// disabling the pool restores worker-based generation.
+TEST_F(ChannelIDServiceTest, PreGeneratedKeyPool) {
+  int error;
+  TestCompletionCallback callback;
+  ChannelIDService::Request request;
+
+  // The pool is replenished lazily, so the first creation goes through a
+  // worker.
+  std::string host1("encrypted.google.com");
+  scoped_ptr<crypto::ECPrivateKey> key1;
+  error = service_->GetOrCreateChannelID(host1, &key1, callback.callback(),
+                                         &request);
+  EXPECT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  EXPECT_EQ(OK, error);
+  EXPECT_EQ(0u, service_->key_pool_hits());
+  EXPECT_EQ(1u, service_->workers_created());
+
+  // The second creation is served from the pool.
+  std::string host2("www.verisign.com");
+  scoped_ptr<crypto::ECPrivateKey> key2;
+  error = service_->GetOrCreateChannelID(host2, &key2, callback.callback(),
+                                         &request);
+  EXPECT_EQ(OK, error);
+  EXPECT_TRUE(key2);
+  EXPECT_EQ(1u, service_->key_pool_hits());
+  EXPECT_EQ(1u, service_->workers_created());
+  EXPECT_FALSE(KeysEqual(key1.get(), key2.get()));
+
+  // With the pool disabled, creation falls back to a worker.
+  service_->set_key_pool_depth(0);
+  std::string host3("www.twitter.com");
+  scoped_ptr<crypto::ECPrivateKey> key3;
+  error = service_->GetOrCreateChannelID(host3, &key3, callback.callback(),
+                                         &request);
+  EXPECT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  EXPECT_EQ(OK, error);
+  EXPECT_EQ(1u, service_->key_pool_hits());
+  EXPECT_EQ(2u, service_->workers_created());
+}
+
 // Tests an inflight join.
 TEST_F(ChannelIDServiceTest, InflightJoin) {
   std::string host("encrypted.google.com");
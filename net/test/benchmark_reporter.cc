@@ -0,0 +1,127 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/test/benchmark_reporter.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+
+namespace net {
+namespace test {
+
+namespace {
+
+// Every result reported in this process, in reporting order.  Benchmarks
+// run single-threaded from the harness main, so no locking is needed.
+base::LazyInstance<base::ListValue>::Leaky g_results =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns the sample at |fraction| of the sorted distribution.
+int64 SampleAtFraction(const std::vector<int64>& sorted, double fraction) {
+  size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+}  // namespace
+
+BenchmarkReporter::BenchmarkReporter(const std::string& name)
+    : name_(name),
+      start_wall_(base::TimeTicks::Now()),
+      has_wall_time_override_(false),
+      iterations_(0),
+      throughput_per_second_(0.0),
+      done_(false) {
+  if (base::TimeTicks::IsThreadNowSupported())
+    start_cpu_ = base::TimeTicks::ThreadNow();
+}
+
+BenchmarkReporter::~BenchmarkReporter() {
+  Done();
+}
+
+void BenchmarkReporter::Done() {
+  if (done_)
+    return;
+  done_ = true;
+
+  base::TimeDelta wall = has_wall_time_override_
+                             ? wall_time_override_
+                             : base::TimeTicks::Now() - start_wall_;
+
+  scoped_ptr<base::DictionaryValue> result(new base::DictionaryValue);
+  result->SetString("name", name_);
+  result->SetDouble("wall_time_ms", wall.InMillisecondsF());
+  if (!has_wall_time_override_ && base::TimeTicks::IsThreadNowSupported()) {
+    result->SetDouble(
+        "cpu_time_ms",
+        (base::TimeTicks::ThreadNow() - start_cpu_).InMillisecondsF());
+  }
+  if (iterations_ > 0)
+    result->SetDouble("iterations", static_cast<double>(iterations_));
+  if (!throughput_unit_.empty()) {
+    result->SetString("throughput_unit", throughput_unit_);
+    result->SetDouble("throughput_per_second", throughput_per_second_);
+  }
+  if (!latency_samples_us_.empty()) {
+    std::sort(latency_samples_us_.begin(), latency_samples_us_.end());
+    base::DictionaryValue* latency = new base::DictionaryValue;
+    latency->SetDouble("samples",
+                       static_cast<double>(latency_samples_us_.size()));
+    latency->SetDouble("min_us",
+                       static_cast<double>(latency_samples_us_.front()));
+    latency->SetDouble(
+        "p50_us",
+        static_cast<double>(SampleAtFraction(latency_samples_us_, 0.50)));
+    latency->SetDouble(
+        "p90_us",
+        static_cast<double>(SampleAtFraction(latency_samples_us_, 0.90)));
+    latency->SetDouble(
+        "p99_us",
+        static_cast<double>(SampleAtFraction(latency_samples_us_, 0.99)));
+    latency->SetDouble("max_us",
+                       static_cast<double>(latency_samples_us_.back()));
+    result->Set("latency", latency);
+  }
+
+  // Keep the line base::PerfTimeLogger used to print, so existing log
+  // scrapers keep working until they move to the JSON output.
+  printf("%s\t%g\tms\n", name_.c_str(), wall.InMillisecondsF());
+  fflush(stdout);
+
+  g_results.Get().Append(result.release());
+}
+
+void BenchmarkReporter::set_wall_time(base::TimeDelta wall_time) {
+  wall_time_override_ = wall_time;
+  has_wall_time_override_ = true;
+}
+
+void BenchmarkReporter::SetThroughput(const std::string& unit,
+                                      double per_second) {
+  throughput_unit_ = unit;
+  throughput_per_second_ = per_second;
+}
+
+void BenchmarkReporter::AddLatencySampleUs(int64 value_us) {
+  latency_samples_us_.push_back(value_us);
+}
+
+// static
+void BenchmarkReporter::GetAllResults(base::ListValue* results) {
+  results->Clear();
+  const base::ListValue& all = g_results.Get();
+  for (size_t i = 0; i < all.GetSize(); ++i) {
+    const base::Value* result = NULL;
+    if (all.Get(i, &result))
+      results->Append(result->DeepCopy());
+  }
+}
+
+}  // namespace test
+}  // namespace net
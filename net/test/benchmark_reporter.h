@@ -0,0 +1,74 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TEST_BENCHMARK_REPORTER_H_
+#define NET_TEST_BENCHMARK_REPORTER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/time/time.h"
+
+namespace base {
+class ListValue;
+}
+
+namespace net {
+namespace test {
+
+// Times one benchmark and reports its measurements through the common
+// harness: a human-readable line on stdout when it finishes, and a record
+// in the JSON document that run_all_benchmarks.cc writes when the binary
+// runs with --json-output.  A drop-in replacement for the timing half of
+// base::PerfTimeLogger, with optional iteration, throughput and latency
+// metrics on top.
+class BenchmarkReporter {
+ public:
+  // |name| identifies the benchmark in both output formats.
+  explicit BenchmarkReporter(const std::string& name);
+
+  // Calls Done() if it has not run yet.
+  ~BenchmarkReporter();
+
+  // Stops the timer and emits the result.  Idempotent.
+  void Done();
+
+  // The optional metrics below must be set before Done().
+
+  // Replaces the constructor-to-Done() wall time with an externally
+  // measured one, e.g. to exclude warm-up runs.
+  void set_wall_time(base::TimeDelta wall_time);
+
+  void set_iterations(int64 iterations) { iterations_ = iterations; }
+
+  // |unit| names what |per_second| counts each second ("KB", "requests").
+  void SetThroughput(const std::string& unit, double per_second);
+
+  // Adds one latency sample; percentiles are derived when Done() runs.
+  void AddLatencySampleUs(int64 value_us);
+
+  // Fills |results| with a dictionary per benchmark reported so far in this
+  // process.  Used by the harness main to emit JSON output.
+  static void GetAllResults(base::ListValue* results);
+
+ private:
+  const std::string name_;
+  base::TimeTicks start_wall_;
+  base::TimeTicks start_cpu_;
+  base::TimeDelta wall_time_override_;
+  bool has_wall_time_override_;
+  int64 iterations_;
+  std::string throughput_unit_;
+  double throughput_per_second_;
+  std::vector<int64> latency_samples_us_;
+  bool done_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkReporter);
+};
+
+}  // namespace test
+}  // namespace net
+
+#endif  // NET_TEST_BENCHMARK_REPORTER_H_
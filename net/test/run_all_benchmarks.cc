@@ -0,0 +1,57 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// The main for net_benchmarks: runs every gtest-registered perf suite,
+// optionally narrowed with --benchmark-filter=<substring>, and writes the
+// measurements collected through net::test::BenchmarkReporter as a JSON
+// array when --json-output=<path> is given.
+
+#include <stdio.h>
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/json_writer.h"
+#include "base/test/perf_test_suite.h"
+#include "base/values.h"
+#include "net/test/benchmark_reporter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const char kBenchmarkFilter[] = "benchmark-filter";
+const char kJsonOutput[] = "json-output";
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::PerfTestSuite suite(argc, argv);
+
+  base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
+  if (command_line->HasSwitch(kBenchmarkFilter)) {
+    // A friendlier spelling of --gtest_filter that matches anywhere in a
+    // benchmark's name.
+    testing::GTEST_FLAG(filter) =
+        "*" + command_line->GetSwitchValueASCII(kBenchmarkFilter) + "*";
+  }
+
+  int result = suite.Run();
+
+  if (command_line->HasSwitch(kJsonOutput)) {
+    base::ListValue results;
+    net::test::BenchmarkReporter::GetAllResults(&results);
+    std::string json;
+    base::JSONWriter::WriteWithOptions(
+        results, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+    base::FilePath path = command_line->GetSwitchValuePath(kJsonOutput);
+    if (base::WriteFile(path, json.data(), json.size()) < 0) {
+      fprintf(stderr, "Failed to write benchmark results to %s\n",
+              path.AsUTF8Unsafe().c_str());
+      return 1;
+    }
+  }
+  return result;
+}
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <malloc.h>
+
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -22,9 +24,13 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/thread_task_runner_handle.h"
+#include "base/time/time.h"
 #include "net/base/cache_type.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/disk_cache/blockfile/backend_impl.h"
 #include "net/disk_cache/disk_cache.h"
+#include "net/disk_cache/memory/mem_backend_impl.h"
 #include "net/disk_cache/simple/simple_backend_impl.h"
 #include "net/disk_cache/simple/simple_index.h"
 
@@ -33,6 +39,7 @@ namespace {
 
 const char kBlockFileBackendType[] = "block_file";
 const char kSimpleBackendType[] = "simple";
+const char kMemoryBackendType[] = "memory";
 
 const char kDiskCacheType[] = "disk_cache";
 const char kAppCacheType[] = "app_cache";
@@ -49,28 +56,39 @@ struct CacheSpec {
         spec_string, ":", base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
     if (tokens.size() != 3)
       return scoped_ptr<CacheSpec>();
-    if (tokens[0] != kBlockFileBackendType && tokens[0] != kSimpleBackendType)
+    if (tokens[0] != kBlockFileBackendType && tokens[0] != kSimpleBackendType &&
+        tokens[0] != kMemoryBackendType)
       return scoped_ptr<CacheSpec>();
     if (tokens[1] != kDiskCacheType && tokens[1] != kAppCacheType)
       return scoped_ptr<CacheSpec>();
+    // The memory backend is selected through the cache type; its path token
+    // is accepted but unused.
+    if (tokens[0] == kMemoryBackendType) {
+      return scoped_ptr<CacheSpec>(
+          new CacheSpec(net::CACHE_BACKEND_DEFAULT, net::MEMORY_CACHE,
+                        base::FilePath(tokens[2]), tokens[0]));
+    }
     return scoped_ptr<CacheSpec>(new CacheSpec(
         tokens[0] == kBlockFileBackendType ? net::CACHE_BACKEND_BLOCKFILE
                                            : net::CACHE_BACKEND_SIMPLE,
         tokens[1] == kDiskCacheType ? net::DISK_CACHE : net::APP_CACHE,
-        base::FilePath(tokens[2])));
+        base::FilePath(tokens[2]), tokens[0]));
   }
 
   const net::BackendType backend_type;
   const net::CacheType cache_type;
   const base::FilePath path;
+  const std::string name;  // The backend type token, for the timeline header.
 
  private:
   CacheSpec(net::BackendType backend_type,
             net::CacheType cache_type,
-            const base::FilePath& path)
+            const base::FilePath& path,
+            const std::string& name)
       : backend_type(backend_type),
         cache_type(cache_type),
-        path(path) {
+        path(path),
+        name(name) {
   }
 };
 
@@ -223,7 +241,155 @@ uint64 GetMemoryConsumption() {
   return total_size;
 }
 
-bool CacheMemTest(const std::vector<scoped_ptr<CacheSpec>>& specs) {
+// Heap allocator statistics, in kB. On Linux and Android this comes from
+// mallinfo(); the fields are ints, which is sufficient for the cache sizes
+// this tool profiles.
+struct HeapStats {
+  uint64 footprint_kb;  // Memory obtained from the system by the allocator.
+  uint64 allocated_kb;  // Memory handed out to live allocations.
+};
+
+HeapStats GetHeapStats() {
+  struct mallinfo info = mallinfo();
+  HeapStats stats;
+  stats.footprint_kb =
+      (static_cast<uint64>(info.arena) + info.hblkhd) / 1024;
+  stats.allocated_kb =
+      (static_cast<uint64>(info.uordblks) + info.hblkhd) / 1024;
+  return stats;
+}
+
+// Returns the backend's own estimate of the memory held by its in-memory
+// index structures, in kB.
+uint64 GetComponentMemoryKb(const CacheSpec& spec, Backend* backend) {
+  size_t bytes = 0;
+  if (spec.cache_type == net::MEMORY_CACHE) {
+    bytes = static_cast<MemBackendImpl*>(backend)->EstimateMemoryUsage();
+  } else if (spec.backend_type == net::CACHE_BACKEND_SIMPLE) {
+    bytes = static_cast<SimpleBackendImpl*>(backend)
+                ->index()->EstimateMemoryUsage();
+  } else {
+    bytes = static_cast<BackendImpl*>(backend)->EstimateMemoryUsage();
+  }
+  return bytes / 1024;
+}
+
+// Adapts one cache operation into a synchronous call, pumping the message
+// loop while the operation is pending.
+class CompletionWaiter {
+ public:
+  CompletionWaiter() : result_(net::ERR_IO_PENDING) {}
+
+  net::CompletionCallback callback() {
+    return base::Bind(&CompletionWaiter::OnComplete, base::Unretained(this));
+  }
+
+  int WaitForResult(int rv) {
+    if (rv != net::ERR_IO_PENDING)
+      return rv;
+    run_loop_.Run();
+    return result_;
+  }
+
+ private:
+  void OnComplete(int result) {
+    result_ = result;
+    run_loop_.Quit();
+  }
+
+  base::RunLoop run_loop_;
+  int result_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompletionWaiter);
+};
+
+// Runs one replayed operation against |backend|: a read of |key|, or a write
+// of |entry_size| bytes when |write| is set or the entry does not exist yet.
+void RunWorkloadOp(Backend* backend,
+                   const std::string& key,
+                   bool write,
+                   net::IOBuffer* buffer,
+                   int entry_size) {
+  Entry* entry = NULL;
+  CompletionWaiter open_waiter;
+  int rv = open_waiter.WaitForResult(
+      backend->OpenEntry(key, &entry, open_waiter.callback()));
+  if (rv != net::OK) {
+    CompletionWaiter create_waiter;
+    rv = create_waiter.WaitForResult(
+        backend->CreateEntry(key, &entry, create_waiter.callback()));
+    if (rv != net::OK)
+      return;
+    write = true;
+  }
+  CompletionWaiter io_waiter;
+  if (write) {
+    io_waiter.WaitForResult(entry->WriteData(
+        0, 0, buffer, entry_size, io_waiter.callback(), true));
+  } else {
+    io_waiter.WaitForResult(
+        entry->ReadData(0, 0, buffer, entry_size, io_waiter.callback()));
+  }
+  entry->Close();
+}
+
+// Emits one timeline sample.
+void PrintSample(const std::vector<scoped_ptr<CacheSpec>>& specs,
+                 const std::vector<scoped_ptr<Backend>>& backends,
+                 base::TimeTicks start,
+                 int ops_done) {
+  const HeapStats heap = GetHeapStats();
+  std::cout << (base::TimeTicks::Now() - start).InMilliseconds() << "\t"
+            << ops_done << "\t" << GetMemoryConsumption() << "\t"
+            << heap.footprint_kb << "\t" << heap.allocated_kb;
+  for (size_t i = 0; i < backends.size(); ++i)
+    std::cout << "\t" << GetComponentMemoryKb(*specs[i], backends[i].get());
+  std::cout << std::endl;
+}
+
+// Replays |ops| operations round-robin over the backends, sampling the
+// process and per-component memory every |interval|. The timeline goes to
+// stdout as tab-separated columns, one row per sample.
+void RunProfile(const std::vector<scoped_ptr<CacheSpec>>& specs,
+                const std::vector<scoped_ptr<Backend>>& backends,
+                int ops,
+                int keys,
+                int entry_size,
+                base::TimeDelta interval,
+                int write_percent) {
+  std::cout << "time_ms\tops\tprivate_dirty_kb\theap_footprint_kb\t"
+            << "heap_allocated_kb";
+  for (const auto& spec : specs)
+    std::cout << "\t" << spec->name << "_index_kb";
+  std::cout << std::endl;
+
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(entry_size));
+  memset(buffer->data(), 'm', entry_size);
+
+  // A fixed seed keeps the replayed sequence identical across runs.
+  srand(0x5eed);
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  base::TimeTicks next_sample = start;
+  for (int i = 0; i < ops; ++i) {
+    if (base::TimeTicks::Now() >= next_sample) {
+      PrintSample(specs, backends, start, i);
+      next_sample = base::TimeTicks::Now() + interval;
+    }
+    const std::string key = base::StringPrintf("key-%06d", rand() % keys);
+    const bool write = rand() % 100 < write_percent;
+    RunWorkloadOp(backends[i % backends.size()].get(), key, write,
+                  buffer.get(), entry_size);
+  }
+  PrintSample(specs, backends, start, ops);
+}
+
+bool CacheMemTest(const std::vector<scoped_ptr<CacheSpec>>& specs,
+                  int ops,
+                  int keys,
+                  int entry_size,
+                  base::TimeDelta interval,
+                  int write_percent) {
   std::vector<scoped_ptr<Backend>> backends;
   for (const auto& it : specs) {
     scoped_ptr<Backend> backend = CreateAndInitBackend(*it);
@@ -233,6 +399,11 @@ bool CacheMemTest(const std::vector<scoped_ptr<CacheSpec>>& specs) {
               << backend->GetEntryCount() << std::endl;
     backends.push_back(std::move(backend));
   }
+  if (ops > 0) {
+    RunProfile(specs, backends, ops, keys, entry_size, interval,
+               write_percent);
+    return true;
+  }
   const uint64 memory_consumption = GetMemoryConsumption();
   std::cout << "Private dirty memory: " << memory_consumption << " kB"
             << std::endl;
@@ -242,13 +413,41 @@ bool CacheMemTest(const std::vector<scoped_ptr<CacheSpec>>& specs) {
 void PrintUsage(std::ostream* stream) {
   *stream << "Usage: disk_cache_mem_test "
           << "--spec-1=<spec> "
-          << "[--spec-2=<spec>]"
+          << "[--spec-2=<spec>] [workload switches]"
           << std::endl
           << "  with <cache_spec>=<backend_type>:<cache_type>:<cache_path>"
           << std::endl
-          << "       <backend_type>='block_file'|'simple'" << std::endl
+          << "       <backend_type>='block_file'|'simple'|'memory'"
+          << std::endl
           << "       <cache_type>='disk_cache'|'app_cache'" << std::endl
-          << "       <cache_path>=file system path" << std::endl;
+          << "       <cache_path>=file system path (unused for 'memory')"
+          << std::endl
+          << "Without workload switches the tool reports private dirty"
+          << std::endl
+          << "memory once over the caches as given. With --ops=<n> it"
+          << std::endl
+          << "replays a workload and emits a memory timeline instead:"
+          << std::endl
+          << "  --ops=<n>           operations to replay (default 0)"
+          << std::endl
+          << "  --keys=<n>          distinct keys (default 10000)"
+          << std::endl
+          << "  --entry-size=<n>    bytes per entry (default 4096)"
+          << std::endl
+          << "  --interval-ms=<n>   sampling period (default 1000)"
+          << std::endl
+          << "  --write-percent=<n> writes in the mix (default 30)"
+          << std::endl;
+}
+
+// Reads --|name|=value into |*value|, leaving the default in place when the
+// switch is absent. Returns false on a malformed value.
+bool ReadIntSwitch(const base::CommandLine& command_line,
+                   const char* name,
+                   int* value) {
+  if (!command_line.HasSwitch(name))
+    return true;
+  return base::StringToInt(command_line.GetSwitchValueASCII(name), value);
 }
 
 bool ParseAndStoreSpec(const std::string& spec_str,
@@ -272,11 +471,7 @@ bool Main(int argc, char** argv) {
     PrintUsage(&std::cout);
     return true;
   }
-  if ((command_line.GetSwitches().size() != 1 &&
-       command_line.GetSwitches().size() != 2) ||
-      !command_line.HasSwitch("spec-1") ||
-      (command_line.GetSwitches().size() == 2 &&
-       !command_line.HasSwitch("spec-2"))) {
+  if (!command_line.HasSwitch("spec-1")) {
     PrintUsage(&std::cerr);
     return false;
   }
@@ -289,7 +484,24 @@ bool Main(int argc, char** argv) {
     if (!ParseAndStoreSpec(spec_str_2, &specs))
       return false;
   }
-  return CacheMemTest(specs);
+  int ops = 0;
+  int keys = 10000;
+  int entry_size = 4096;
+  int interval_ms = 1000;
+  int write_percent = 30;
+  if (!ReadIntSwitch(command_line, "ops", &ops) ||
+      !ReadIntSwitch(command_line, "keys", &keys) ||
+      !ReadIntSwitch(command_line, "entry-size", &entry_size) ||
+      !ReadIntSwitch(command_line, "interval-ms", &interval_ms) ||
+      !ReadIntSwitch(command_line, "write-percent", &write_percent) ||
+      keys < 1 || entry_size < 1 || interval_ms < 1 || write_percent < 0 ||
+      write_percent > 100) {
+    PrintUsage(&std::cerr);
+    return false;
+  }
+  return CacheMemTest(specs, ops, keys, entry_size,
+                      base::TimeDelta::FromMilliseconds(interval_ms),
+                      write_percent);
 }
 
 }  // namespace
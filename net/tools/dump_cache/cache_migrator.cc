@@ -0,0 +1,301 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/dump_cache/cache_migrator.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace {
+
+// HTTP cache entries have up to three data streams.
+const int kNumStreams = 3;
+
+// Shared state for one migration run.
+struct MigrationData {
+  MigrationData()
+      : src_iterating(true),
+        fetch_in_flight(false),
+        active_workers(0),
+        entries_copied(0),
+        entries_failed(0),
+        bytes_copied(0) {}
+
+  scoped_ptr<disk_cache::Backend> src;
+  scoped_ptr<disk_cache::Backend> dest;
+  scoped_ptr<disk_cache::Backend::Iterator> iterator;
+  bool src_iterating;     // More entries may come out of the iterator.
+  bool fetch_in_flight;   // An OpenNextEntry call is outstanding.
+  int active_workers;     // Workers currently copying an entry.
+  int64 entries_copied;
+  int64 entries_failed;
+  int64 bytes_copied;
+  base::Closure all_done;
+};
+
+MigrationData* g_data = NULL;
+
+void FetchNextEntry();
+
+// Streams one entry from the source cache to the destination: creates the
+// destination entry, then copies each data stream in chunks. A fixed pool of
+// workers runs concurrently; the backends' own threads do the actual I/O, so
+// keeping several entries in flight overlaps source reads with destination
+// writes.
+class EntryWorker {
+ public:
+  explicit EntryWorker(int chunk_size)
+      : src_entry_(NULL),
+        dest_entry_(NULL),
+        stream_(0),
+        offset_(0),
+        stream_size_(0),
+        entry_bytes_(0),
+        buffer_(new net::IOBuffer(chunk_size)),
+        chunk_size_(chunk_size) {}
+
+  ~EntryWorker() {
+    DCHECK(!src_entry_);
+    DCHECK(!dest_entry_);
+  }
+
+  bool idle() const { return !src_entry_; }
+
+  // Takes ownership of |src_entry| (it is closed when the copy finishes).
+  void Start(disk_cache::Entry* src_entry) {
+    DCHECK(idle());
+    src_entry_ = src_entry;
+    entry_bytes_ = 0;
+    g_data->active_workers++;
+    int rv = g_data->dest->CreateEntry(
+        src_entry_->GetKey(), &dest_entry_,
+        base::Bind(&EntryWorker::OnCreateDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnCreateDone(rv);
+  }
+
+ private:
+  void OnCreateDone(int result) {
+    if (result != net::OK)
+      return Finish(false);
+    stream_ = -1;
+    NextStream();
+  }
+
+  void NextStream() {
+    if (++stream_ == kNumStreams)
+      return Finish(true);
+    offset_ = 0;
+    stream_size_ = src_entry_->GetDataSize(stream_);
+    if (!stream_size_)
+      return NextStream();
+    ReadChunk();
+  }
+
+  void ReadChunk() {
+    int len = std::min(chunk_size_, stream_size_ - offset_);
+    int rv = src_entry_->ReadData(
+        stream_, offset_, buffer_.get(), len,
+        base::Bind(&EntryWorker::OnReadDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnReadDone(rv);
+  }
+
+  void OnReadDone(int result) {
+    if (result <= 0)
+      return Finish(false);
+    int rv = dest_entry_->WriteData(
+        stream_, offset_, buffer_.get(), result,
+        base::Bind(&EntryWorker::OnWriteDone, base::Unretained(this), result),
+        false);
+    if (rv != net::ERR_IO_PENDING)
+      OnWriteDone(result, rv);
+  }
+
+  void OnWriteDone(int expected, int result) {
+    if (result != expected)
+      return Finish(false);
+    offset_ += result;
+    entry_bytes_ += result;
+    if (offset_ == stream_size_)
+      return NextStream();
+    ReadChunk();
+  }
+
+  void Finish(bool success) {
+    if (dest_entry_) {
+      if (!success)
+        dest_entry_->Doom();
+      dest_entry_->Close();
+      dest_entry_ = NULL;
+    }
+    src_entry_->Close();
+    src_entry_ = NULL;
+    if (success) {
+      g_data->bytes_copied += entry_bytes_;
+      if (!(++g_data->entries_copied % 1000)) {
+        printf("Copied %" PRId64 " entries\r", g_data->entries_copied);
+        fflush(stdout);
+      }
+    } else {
+      g_data->entries_failed++;
+    }
+    g_data->active_workers--;
+
+    // Keep the pipeline full, or finish the run once the iterator is
+    // exhausted and the last copy has drained.
+    if (g_data->src_iterating) {
+      if (!g_data->fetch_in_flight)
+        FetchNextEntry();
+    } else if (!g_data->active_workers) {
+      g_data->all_done.Run();
+    }
+  }
+
+  disk_cache::Entry* src_entry_;
+  disk_cache::Entry* dest_entry_;
+  int stream_;       // The data stream being copied.
+  int offset_;       // Next byte to copy within |stream_|.
+  int stream_size_;
+  int64 entry_bytes_;
+  scoped_refptr<net::IOBuffer> buffer_;
+  const int chunk_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(EntryWorker);
+};
+
+ScopedVector<EntryWorker>* g_workers = NULL;
+
+EntryWorker* FindIdleWorker() {
+  for (size_t i = 0; i < g_workers->size(); i++) {
+    if ((*g_workers)[i]->idle())
+      return (*g_workers)[i];
+  }
+  return NULL;
+}
+
+disk_cache::Entry* g_next_entry = NULL;
+
+void OnNextEntry(int result) {
+  g_data->fetch_in_flight = false;
+  if (result != net::OK) {
+    // End of enumeration (or the source failed); let the workers drain.
+    g_data->src_iterating = false;
+    if (!g_data->active_workers)
+      g_data->all_done.Run();
+    return;
+  }
+
+  disk_cache::Entry* entry = g_next_entry;
+  g_next_entry = NULL;
+  EntryWorker* worker = FindIdleWorker();
+  DCHECK(worker);
+  worker->Start(entry);
+
+  // Only one OpenNextEntry may be outstanding, and a worker must be free to
+  // take the result; fetch again only while both hold.
+  if (FindIdleWorker())
+    FetchNextEntry();
+}
+
+void FetchNextEntry() {
+  DCHECK(!g_data->fetch_in_flight);
+  g_data->fetch_in_flight = true;
+  int rv = g_data->iterator->OpenNextEntry(&g_next_entry,
+                                           base::Bind(&OnNextEntry));
+  if (rv != net::ERR_IO_PENDING)
+    OnNextEntry(rv);
+}
+
+void StoreResultAndQuit(base::RunLoop* run_loop, int* out, int result) {
+  *out = result;
+  run_loop->Quit();
+}
+
+// Creates and initializes a backend, waiting for completion. Returns NULL on
+// failure.
+scoped_ptr<disk_cache::Backend> OpenBackend(const base::FilePath& path,
+                                            net::BackendType backend_type,
+                                            bool force) {
+  scoped_ptr<disk_cache::Backend> backend;
+  base::RunLoop run_loop;
+  int result = net::ERR_IO_PENDING;
+  int rv = disk_cache::CreateCacheBackend(
+      net::DISK_CACHE, backend_type, path, 0, force,
+      base::ThreadTaskRunnerHandle::Get(), NULL, &backend,
+      base::Bind(&StoreResultAndQuit, base::Unretained(&run_loop),
+                 base::Unretained(&result)));
+  if (rv == net::ERR_IO_PENDING)
+    run_loop.Run();
+  else
+    result = rv;
+  if (result != net::OK)
+    return scoped_ptr<disk_cache::Backend>();
+  return backend.Pass();
+}
+
+}  // namespace
+
+bool MigrateCache(const base::FilePath& input_path,
+                  const base::FilePath& output_path,
+                  net::BackendType output_backend,
+                  int num_workers,
+                  int chunk_kb) {
+  base::MessageLoopForIO message_loop;
+
+  MigrationData data;
+  g_data = &data;
+  data.src = OpenBackend(input_path, net::CACHE_BACKEND_BLOCKFILE, false);
+  if (!data.src) {
+    printf("Unable to open the source cache\n");
+    return false;
+  }
+  data.dest = OpenBackend(output_path, output_backend, true);
+  if (!data.dest) {
+    printf("Unable to create the destination cache\n");
+    return false;
+  }
+
+  ScopedVector<EntryWorker> workers;
+  for (int i = 0; i < num_workers; i++)
+    workers.push_back(new EntryWorker(chunk_kb * 1024));
+  g_workers = &workers;
+
+  const int32 src_entries = data.src->GetEntryCount();
+  printf("Migrating %d entries with %d workers\n", src_entries, num_workers);
+
+  data.iterator = data.src->CreateIterator();
+  base::RunLoop run_loop;
+  data.all_done = run_loop.QuitClosure();
+  base::TimeTicks start = base::TimeTicks::Now();
+  FetchNextEntry();
+  run_loop.Run();
+  double elapsed = (base::TimeTicks::Now() - start).InSecondsF();
+
+  printf("Copied %" PRId64 " entries (%" PRId64 " failed), %" PRId64
+         " bytes in %.1f s (%.1f MB/s)\n",
+         data.entries_copied, data.entries_failed, data.bytes_copied, elapsed,
+         data.bytes_copied / (1024.0 * 1024.0) / (elapsed ? elapsed : 1));
+
+  // Let the destination flush its index before tearing down.
+  data.iterator.reset();
+  g_workers = NULL;
+  g_data = NULL;
+  return true;
+}
@@ -0,0 +1,30 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_DUMP_CACHE_CACHE_MIGRATOR_H_
+#define NET_TOOLS_DUMP_CACHE_CACHE_MIGRATOR_H_
+
+// Copies a cache into a new cache of a possibly different backend type,
+// streaming many entries in parallel. This is how a node's blockfile cache
+// is converted to the simple backend in place of the old entry-by-entry
+// master/slave copy.
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "net/base/cache_type.h"
+
+// Copies every entry from the cache at |input_path| into a freshly created
+// cache at |output_path| using |output_backend| ('simple' or 'block_file').
+// |num_workers| entries are streamed concurrently, each read and written in
+// chunks of |chunk_kb| kilobytes. Progress and a final summary go to stdout.
+// Returns true if the copy completed (individual entry failures are counted
+// and reported, but do not abort the migration).
+bool MigrateCache(const base::FilePath& input_path,
+                  const base::FilePath& output_path,
+                  net::BackendType output_backend,
+                  int num_workers,
+                  int chunk_kb);
+
+#endif  // NET_TOOLS_DUMP_CACHE_CACHE_MIGRATOR_H_
@@ -11,9 +11,12 @@
 #include "base/at_exit.h"
 #include "base/command_line.h"
 #include "base/strings/string16.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "net/base/cache_type.h"
 #include "net/disk_cache/blockfile/disk_format.h"
+#include "net/tools/dump_cache/cache_migrator.h"
 #include "net/tools/dump_cache/dump_files.h"
 
 enum Errors {
@@ -46,6 +49,22 @@ const char kDumpAllocation[] = "dump-allocation";
 // The file to look at.
 const char kDumpFile[] = "file";
 
+// Copies the cache into a new cache (see kOutput, kOutputBackend).
+const char kMigrate[] = "migrate";
+
+// The destination path of a migration.
+const char kOutput[] = "output";
+
+// The backend type of the destination cache: 'simple' or 'block_file'
+// (default 'simple').
+const char kOutputBackend[] = "output-backend";
+
+// The number of entries streamed concurrently by a migration (default 8).
+const char kWorkers[] = "workers";
+
+// The size of each migration read/write, in KB (default 512).
+const char kChunkKb[] = "chunk-kb";
+
 int Help() {
   printf("dump_cache path_to_files [options]\n");
   printf("Dumps internal cache structures.\n");
@@ -64,9 +83,50 @@ int Help() {
       "--full-key: show up to 160 chars for the key. Use either -v or the"
       " key address for longer keys\n");
   printf("-v: detailed output (verbose)\n");
+  printf(
+      "--migrate --output=<path> [--output-backend=simple|block_file]"
+      " [--workers=8] [--chunk-kb=512]: copy the cache into a new cache,"
+      " streaming multiple entries in parallel\n");
   return INVALID_ARGUMENT;
 }
 
+// Handles the --migrate switch. The input was already validated as a
+// blockfile cache.
+int Migrate(const base::FilePath& input_path,
+            const base::CommandLine& command_line) {
+  base::FilePath output_path = command_line.GetSwitchValuePath(kOutput);
+  if (output_path.empty())
+    return Help();
+
+  net::BackendType output_backend = net::CACHE_BACKEND_SIMPLE;
+  std::string backend_str = command_line.GetSwitchValueASCII(kOutputBackend);
+  if (backend_str == "block_file")
+    output_backend = net::CACHE_BACKEND_BLOCKFILE;
+  else if (!backend_str.empty() && backend_str != "simple")
+    return Help();
+
+  int workers = 8;
+  if (command_line.HasSwitch(kWorkers) &&
+      (!base::StringToInt(command_line.GetSwitchValueASCII(kWorkers),
+                          &workers) ||
+       workers < 1)) {
+    return Help();
+  }
+  int chunk_kb = 512;
+  if (command_line.HasSwitch(kChunkKb) &&
+      (!base::StringToInt(command_line.GetSwitchValueASCII(kChunkKb),
+                          &chunk_kb) ||
+       chunk_kb < 1)) {
+    return Help();
+  }
+
+  if (!MigrateCache(input_path, output_path, output_backend, workers,
+                    chunk_kb)) {
+    return GENERIC;
+  }
+  return ALL_GOOD;
+}
+
 // -----------------------------------------------------------------------
 
 int main(int argc, const char* argv[]) {
@@ -89,6 +149,9 @@ int main(int argc, const char* argv[]) {
   if (version != 2)
     return FILE_ACCESS_ERROR;
 
+  if (command_line.HasSwitch(kMigrate))
+    return Migrate(input_path, command_line);
+
   if (command_line.HasSwitch(kDumpContents))
     return DumpContents(input_path);
 
@@ -471,6 +471,27 @@ class EpollServer {
   //   Accessor for the current value of timeout_in_us.
   int timeout_in_us() const { return timeout_in_us_; }
 
+  // Summary:
+  //   Sets the busy-poll window.  When nonzero, and the epoll server would
+  //   otherwise block, WaitForEventsAndExecuteCallbacks() first spins calling
+  //   epoll_wait with a zero timeout for up to window_in_us microseconds.
+  //   Events which arrive during the spin window are handled without paying
+  //   the sleep/wake latency of a blocked epoll_wait.  The spinning burns a
+  //   full CPU, so this is only appropriate for latency-critical servers
+  //   pinned to dedicated cores.  A window of 0 (the default) disables
+  //   spinning.
+  // Args:
+  //   window_in_us - how long to spin before blocking, in microseconds.
+  void set_busy_poll_window_in_us(int64 window_in_us) {
+    busy_poll_window_in_us_ = window_in_us;
+  }
+
+  ////////////////////////////////////////
+
+  // Summary:
+  //   Accessor for the current value of busy_poll_window_in_us.
+  int64 busy_poll_window_in_us() const { return busy_poll_window_in_us_; }
+
   // Summary:
   // Returns true when the EpollServer() is being destroyed.
   bool in_shutdown() const { return in_shutdown_; }
@@ -681,6 +702,10 @@ class EpollServer {
   // If this is zero, never wait for an event.
   int64 timeout_in_us_;
 
+  // How long to spin with zero-timeout epoll_wait calls before blocking, in
+  // microseconds.  Zero disables the busy-poll phase.
+  int64 busy_poll_window_in_us_;
+
   // This is nonzero only after the invocation of epoll_wait_impl within
   // WaitForEventsAndCallHandleEvents and before the function
   // WaitForEventsAndExecuteCallbacks returns.  At all other times, this is
@@ -12,6 +12,21 @@
 
 namespace net {
 
+namespace {
+
+// A DataFrame whose bytes point directly into a shared cache body.  The
+// reference keeps the body alive until the frame has been written, even if
+// the cache entry is replaced while connections are still draining it.
+class SharedBodyDataFrame : public DataFrame {
+ public:
+  explicit SharedBodyDataFrame(FileDataBody* body) : body_(body) {}
+
+ private:
+  scoped_refptr<FileDataBody> body_;
+};
+
+}  // namespace
+
 HttpSM::HttpSM(SMConnection* connection,
                SMInterface* sm_spdy_interface,
                MemoryCache* memory_cache,
@@ -326,11 +341,31 @@ void HttpSM::GetOutput() {
   if (num_to_write > mci->max_segment_size)
     num_to_write = mci->max_segment_size;
 
-  SendDataFrame(mci->stream_id,
-                mci->file_data->body().data() + mci->body_bytes_consumed,
-                num_to_write,
-                0,
-                true);
+  // The chunked-transfer framing is tiny and is copied; the body bytes
+  // themselves are enqueued as a slice of the shared cache body so that
+  // serving the same file to many connections does not multiply the memcpy
+  // and memory cost per connection.
+  char chunk_buf[128];
+  int chunk_buf_len = snprintf(chunk_buf, sizeof(chunk_buf), "%x\r\n",
+                               static_cast<unsigned int>(num_to_write));
+  DataFrame* chunk_begin = new DataFrame;
+  char* buffer = new char[chunk_buf_len];
+  memcpy(buffer, chunk_buf, chunk_buf_len);
+  chunk_begin->data = buffer;
+  chunk_begin->size = chunk_buf_len;
+  chunk_begin->delete_when_done = true;
+  EnqueueDataFrame(chunk_begin);
+
+  DataFrame* body_frame =
+      new SharedBodyDataFrame(mci->file_data->shared_body());
+  body_frame->data = mci->file_data->body().data() + mci->body_bytes_consumed;
+  body_frame->size = num_to_write;
+  EnqueueDataFrame(body_frame);
+
+  DataFrame* chunk_end = new DataFrame;
+  chunk_end->data = "\r\n";
+  chunk_end->size = 2;
+  EnqueueDataFrame(chunk_end);
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendDataFrame["
           << mci->stream_id << "]: " << num_to_write;
   mci->body_bytes_consumed += num_to_write;
@@ -53,14 +53,14 @@ void StoreBodyAndHeadersVisitor::HandleBodyError(BalsaFrame* framer) {
 FileData::FileData(const BalsaHeaders* headers,
                    const std::string& filename,
                    const std::string& body)
-    : filename_(filename), body_(body) {
+    : filename_(filename), body_(new FileDataBody(body)) {
   if (headers) {
     headers_.reset(new BalsaHeaders);
     headers_->CopyFrom(*headers);
   }
 }
 
-FileData::FileData() {}
+FileData::FileData() : body_(new FileDataBody(std::string())) {}
 
 FileData::~FileData() {}
 
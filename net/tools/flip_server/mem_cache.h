@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/tools/balsa/balsa_headers.h"
 #include "net/tools/balsa/balsa_visitor_interface.h"
@@ -59,6 +60,26 @@ class StoreBodyAndHeadersVisitor : public BalsaVisitorInterface {
   bool error_;
 };
 
+// An immutable response body, shared by reference between every connection
+// which serves the same file (and between the per-acceptor-thread cache
+// clones).  Connections which write slices of the body directly to their
+// sockets hold a reference, so a cache entry may be replaced while it is
+// still being drained.
+class FileDataBody : public base::RefCountedThreadSafe<FileDataBody> {
+ public:
+  explicit FileDataBody(const std::string& data) : data_(data) {}
+
+  const std::string& data() const { return data_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<FileDataBody>;
+  ~FileDataBody() {}
+
+  const std::string data_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileDataBody);
+};
+
 class FileData {
  public:
   FileData();
@@ -71,12 +92,13 @@ class FileData {
   const BalsaHeaders* headers() const { return headers_.get(); }
 
   const std::string& filename() { return filename_; }
-  const std::string& body() { return body_; }
+  const std::string& body() { return body_->data(); }
+  FileDataBody* shared_body() { return body_.get(); }
 
  private:
   scoped_ptr<BalsaHeaders> headers_;
   std::string filename_;
-  std::string body_;
+  scoped_refptr<FileDataBody> body_;
 
   DISALLOW_COPY_AND_ASSIGN(FileData);
 };
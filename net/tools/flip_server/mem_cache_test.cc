@@ -80,6 +80,21 @@ TEST_F(FlipMemoryCacheTest, ReadAndStoreFileContents) {
   ASSERT_EQ("hello", hello->filename());
 }
 
+TEST_F(FlipMemoryCacheTest, SharedBodyOutlivesCacheEntry) {
+  BalsaHeaders headers;
+  mem_cache_->InsertFile(&headers, "foobar", "old body");
+
+  scoped_refptr<FileDataBody> body =
+      mem_cache_->GetFileData("foobar")->shared_body();
+  ASSERT_EQ("old body", body->data());
+
+  // Replacing the entry deletes the old FileData, but connections which hold
+  // a reference to the body can still drain it.
+  mem_cache_->InsertFile(&headers, "foobar", "new body");
+  ASSERT_EQ("old body", body->data());
+  ASSERT_EQ("new body", mem_cache_->GetFileData("foobar")->body());
+}
+
 TEST_F(FlipMemoryCacheTest, GetFileDataForHtmlFile) {
   FileData* hello_html;
 
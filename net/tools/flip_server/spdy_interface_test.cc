@@ -67,10 +67,6 @@ class SpdyFramerVisitor : public BufferedSpdyFramerVisitorInterface {
                                        size_t,
                                        bool));
   MOCK_METHOD2(OnStreamPadding, void(SpdyStreamId, size_t));
-  MOCK_METHOD1(OnHeaderFrameStart,
-               SpdyHeadersHandlerInterface*(SpdyStreamId stream_id));
-  MOCK_METHOD2(OnHeaderFrameEnd,
-               void(SpdyStreamId stream_id, bool end_headers));
   MOCK_METHOD1(OnSettings, void(bool clear_persisted));
   MOCK_METHOD3(OnSetting, void(SpdySettingsIds, uint8, uint32));
   MOCK_METHOD2(OnPing, void(SpdyPingId unique_id, bool is_ack));
@@ -3,7 +3,10 @@
 // found in the LICENSE file.
 
 #include <stdio.h>
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/at_exit.h"
 #include "base/basictypes.h"
@@ -100,6 +103,61 @@ std::string DnsHostsToString(const DnsHosts& dns_hosts) {
   return output;
 }
 
+// A hostname and its relative weight in the benchmark query distribution.
+typedef std::pair<std::string, int> WeightedHost;
+typedef std::vector<WeightedHost> WeightedHostList;
+
+// Loads a weighted hostname list for benchmark mode and fills |hosts| and
+// |total_weight|. Returns whether the operation was successful.
+//
+// Each non-empty line contains
+//
+//   domain_name [weight]
+//
+// where weight is a positive integer defaulting to 1. Queries are drawn
+// from the list with probability proportional to weight.
+bool LoadHostsFile(const base::FilePath& file_path,
+                   WeightedHostList* hosts,
+                   int* total_weight) {
+  std::string contents;
+  if (!base::ReadFileToString(file_path, &contents)) {
+    fprintf(stderr, "Unable to open hosts file %s\n",
+            file_path.MaybeAsASCII().c_str());
+    return false;
+  }
+  std::string stripped_contents;
+  base::RemoveChars(contents, "\r", &stripped_contents);
+
+  std::vector<std::string> lines = base::SplitString(
+      stripped_contents, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
+  *total_weight = 0;
+  for (unsigned i = 0; i < lines.size(); ++i) {
+    if (lines[i].empty())
+      continue;
+    std::vector<std::string> name_and_weight = base::SplitString(
+        lines[i], " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    int weight = 1;
+    if (name_and_weight.size() == 2) {
+      if (!base::StringToInt(name_and_weight[1], &weight) || weight <= 0) {
+        fprintf(stderr,
+                "[%s %u] hosts file should have format 'domain_name "
+                "[weight]\\n'\n",
+                file_path.MaybeAsASCII().c_str(), i + 1);
+        return false;
+      }
+    } else if (name_and_weight.size() != 1) {
+      fprintf(stderr,
+              "[%s %u] hosts file should have format 'domain_name "
+              "[weight]\\n'\n",
+              file_path.MaybeAsASCII().c_str(), i + 1);
+      return false;
+    }
+    hosts->push_back(WeightedHost(name_and_weight[0], weight));
+    *total_weight += weight;
+  }
+  return !hosts->empty();
+}
+
 struct ReplayLogEntry {
   base::TimeDelta start_time;
   std::string domain_name;
@@ -211,6 +269,15 @@ class GDig {
   void OnTimeout();
   void ReplayNextEntry();
 
+  // Benchmark mode.
+  void StartBenchmark();
+  void IssueBenchmarkQuery();
+  void OnBenchmarkResolveComplete(AddressList* address_list,
+                                  base::TimeTicks query_start_ticks,
+                                  int val);
+  void PrintBenchmarkSummary();
+  const std::string& PickBenchmarkHost();
+
   base::TimeDelta config_timeout_;
   bool print_config_;
   bool print_hosts_;
@@ -218,6 +285,20 @@ class GDig {
   base::TimeDelta timeout_;
   int parallellism_;
   ReplayLog replay_log_;
+
+  // Benchmark mode state. |benchmark_queries_| of zero disables the mode;
+  // |benchmark_qps_| of zero means closed-loop issue, bounded only by
+  // |parallellism_|.
+  int benchmark_queries_;
+  int benchmark_qps_;
+  bool benchmark_cache_enabled_;
+  WeightedHostList benchmark_hosts_;
+  int benchmark_total_weight_;
+  int benchmark_issued_;
+  int benchmark_errors_;
+  std::vector<int64> benchmark_latencies_us_;
+  uint32 benchmark_rng_state_;
+  base::TimeTicks benchmark_start_ticks_;
   unsigned replay_log_index_;
   base::Time start_time_;
   int active_resolves_;
@@ -243,6 +324,13 @@ GDig::GDig()
       print_config_(false),
       print_hosts_(false),
       parallellism_(6),
+      benchmark_queries_(0),
+      benchmark_qps_(0),
+      benchmark_cache_enabled_(true),
+      benchmark_total_weight_(0),
+      benchmark_issued_(0),
+      benchmark_errors_(0),
+      benchmark_rng_state_(1u),
       replay_log_index_(0u),
       active_resolves_(0) {
 }
@@ -262,6 +350,8 @@ GDig::Result GDig::Main(int argc, const char* argv[]) {
               " [--config_timeout=<seconds>]"
               " [--j=<parallel resolves>]"
               " [--replay_file=<path>]"
+              " [--benchmark=<queries> [--qps=<rate>] [--no_cache]"
+              " [--hosts_file=<path>]]"
               " [domain_name]\n",
               argv[0]);
       return RESULT_WRONG_USAGE;
@@ -353,6 +443,41 @@ bool GDig::ParseCommandLine(int argc, const char* argv[]) {
       return false;
   }
 
+  if (parsed_command_line.HasSwitch("benchmark")) {
+    int queries = 0;
+    bool parsed = base::StringToInt(
+        parsed_command_line.GetSwitchValueASCII("benchmark"), &queries);
+    if (parsed && queries > 0) {
+      benchmark_queries_ = queries;
+    } else {
+      fprintf(stderr, "Invalid benchmark parameter\n");
+      return false;
+    }
+  }
+
+  if (parsed_command_line.HasSwitch("qps")) {
+    int qps = 0;
+    bool parsed =
+        base::StringToInt(parsed_command_line.GetSwitchValueASCII("qps"), &qps);
+    if (parsed && qps > 0) {
+      benchmark_qps_ = qps;
+    } else {
+      fprintf(stderr, "Invalid qps parameter\n");
+      return false;
+    }
+  }
+
+  benchmark_cache_enabled_ = !parsed_command_line.HasSwitch("no_cache");
+
+  if (parsed_command_line.HasSwitch("hosts_file")) {
+    base::FilePath hosts_path =
+        parsed_command_line.GetSwitchValuePath("hosts_file");
+    if (!LoadHostsFile(hosts_path, &benchmark_hosts_,
+                       &benchmark_total_weight_)) {
+      return false;
+    }
+  }
+
   if (parsed_command_line.HasSwitch("j")) {
     int parallellism = 0;
     bool parsed = base::StringToInt(
@@ -377,7 +502,24 @@ bool GDig::ParseCommandLine(int argc, const char* argv[]) {
   } else if (parsed_command_line.GetArgs().size() != 0) {
     return false;
   }
-  return print_config_ || print_hosts_ || !replay_log_.empty();
+  if (benchmark_queries_ > 0 && benchmark_hosts_.empty()) {
+    // Fall back to the replay log (or single domain argument) as a uniform
+    // query distribution.
+    for (unsigned i = 0; i < replay_log_.size(); ++i) {
+      benchmark_hosts_.push_back(WeightedHost(replay_log_[i].domain_name, 1));
+      ++benchmark_total_weight_;
+    }
+    if (benchmark_hosts_.empty()) {
+      fprintf(stderr,
+              "benchmark mode needs --hosts_file, --replay_file or a "
+              "domain_name
+");
+      return false;
+    }
+  }
+
+  return print_config_ || print_hosts_ || !replay_log_.empty() ||
+         benchmark_queries_ > 0;
 }
 
 void GDig::Start() {
@@ -420,7 +562,7 @@ void GDig::OnDnsConfig(const DnsConfig& dns_config_const) {
            "%s", DnsHostsToString(dns_config.hosts).c_str());
   }
 
-  if (replay_log_.empty()) {
+  if (replay_log_.empty() && benchmark_queries_ == 0) {
     Finish(RESULT_OK);
     return;
   }
@@ -430,6 +572,7 @@ void GDig::OnDnsConfig(const DnsConfig& dns_config_const) {
   HostResolver::Options options;
   options.max_concurrent_resolves = parallellism_;
   options.max_retry_attempts = 1u;
+  options.enable_caching = benchmark_cache_enabled_;
   scoped_ptr<HostResolverImpl> resolver(
       new HostResolverImpl(options, log_.get()));
   resolver->SetDnsClient(dns_client.Pass());
@@ -437,9 +580,123 @@ void GDig::OnDnsConfig(const DnsConfig& dns_config_const) {
 
   start_time_ = base::Time::Now();
 
+  if (benchmark_queries_ > 0) {
+    StartBenchmark();
+    return;
+  }
+
   ReplayNextEntry();
 }
 
+void GDig::StartBenchmark() {
+  benchmark_start_ticks_ = base::TimeTicks::Now();
+  if (benchmark_qps_ > 0) {
+    // Open loop: schedule every query up front at its ideal issue time, so
+    // slow responses do not throttle the offered load.
+    for (int i = 0; i < benchmark_queries_; ++i) {
+      base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&GDig::IssueBenchmarkQuery, base::Unretained(this)),
+          base::TimeDelta::FromMicroseconds(
+              static_cast<int64>(i) * base::Time::kMicrosecondsPerSecond /
+              benchmark_qps_));
+    }
+    return;
+  }
+  // Closed loop: keep |parallellism_| queries in flight; each completion
+  // issues the next one.
+  int initial = std::min(parallellism_, benchmark_queries_);
+  for (int i = 0; i < initial; ++i)
+    IssueBenchmarkQuery();
+}
+
+const std::string& GDig::PickBenchmarkHost() {
+  // Deterministic LCG so a given command line replays the same weighted
+  // query sequence on every run.
+  benchmark_rng_state_ = benchmark_rng_state_ * 1664525u + 1013904223u;
+  int pick = static_cast<int>(benchmark_rng_state_ %
+                              static_cast<uint32>(benchmark_total_weight_));
+  for (unsigned i = 0; i < benchmark_hosts_.size(); ++i) {
+    pick -= benchmark_hosts_[i].second;
+    if (pick < 0)
+      return benchmark_hosts_[i].first;
+  }
+  return benchmark_hosts_.back().first;
+}
+
+void GDig::IssueBenchmarkQuery() {
+  DCHECK_LT(benchmark_issued_, benchmark_queries_);
+  HostResolver::RequestInfo info(HostPortPair(PickBenchmarkHost().c_str(), 80));
+  AddressList* addrlist = new AddressList();
+  ++active_resolves_;
+  ++benchmark_issued_;
+  CompletionCallback callback = base::Bind(
+      &GDig::OnBenchmarkResolveComplete, base::Unretained(this),
+      base::Owned(addrlist), base::TimeTicks::Now());
+  int ret = resolver_->Resolve(
+      info, DEFAULT_PRIORITY, addrlist, callback, NULL,
+      BoundNetLog::Make(log_.get(), net::NetLog::SOURCE_NONE));
+  if (ret != ERR_IO_PENDING)
+    callback.Run(ret);
+}
+
+void GDig::OnBenchmarkResolveComplete(AddressList* address_list,
+                                      base::TimeTicks query_start_ticks,
+                                      int val) {
+  DCHECK_GT(active_resolves_, 0);
+  --active_resolves_;
+  benchmark_latencies_us_.push_back(
+      (base::TimeTicks::Now() - query_start_ticks).InMicroseconds());
+  if (val != OK)
+    ++benchmark_errors_;
+
+  if (benchmark_qps_ == 0 && benchmark_issued_ < benchmark_queries_)
+    IssueBenchmarkQuery();
+  if (active_resolves_ == 0 && benchmark_issued_ >= benchmark_queries_) {
+    PrintBenchmarkSummary();
+    Finish(RESULT_OK);
+  }
+}
+
+void GDig::PrintBenchmarkSummary() {
+  std::vector<int64> sorted = benchmark_latencies_us_;
+  std::sort(sorted.begin(), sorted.end());
+  size_t n = sorted.size();
+  DCHECK_GT(n, 0u);
+
+  int64 sum_us = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum_us += sorted[i];
+  base::TimeDelta wall = base::TimeTicks::Now() - benchmark_start_ticks_;
+  double wall_seconds = wall.InSecondsF();
+
+  printf("# Benchmark summary
+");
+  printf("queries %u
+", static_cast<unsigned>(n));
+  printf("errors %d
+", benchmark_errors_);
+  printf("cache %s
+", benchmark_cache_enabled_ ? "on" : "off");
+  printf("wall_time_ms %d
+", static_cast<int>(wall.InMilliseconds()));
+  if (wall_seconds > 0)
+    printf("achieved_qps %.1f
+", n / wall_seconds);
+  printf("min_us %d
+", static_cast<int>(sorted[0]));
+  printf("mean_us %d
+", static_cast<int>(sum_us / n));
+  printf("p50_us %d
+", static_cast<int>(sorted[n / 2]));
+  printf("p90_us %d
+", static_cast<int>(sorted[n * 9 / 10]));
+  printf("p99_us %d
+", static_cast<int>(sorted[n * 99 / 100]));
+  printf("max_us %d
+", static_cast<int>(sorted[n - 1]));
+}
+
 void GDig::ReplayNextEntry() {
   DCHECK_LT(replay_log_index_, replay_log_.size());
 
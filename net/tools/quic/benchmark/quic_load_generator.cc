@@ -0,0 +1,312 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/benchmark/quic_load_generator.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/rand_util.h"
+#include "net/base/net_errors.h"
+#include "net/cert/cert_verifier.h"
+#include "net/cert/multi_log_ct_verifier.h"
+#include "net/http/transport_security_state.h"
+#include "net/quic/crypto/proof_verifier_chromium.h"
+#include "net/quic/quic_session.h"
+#include "net/tools/balsa/balsa_headers.h"
+#include "net/tools/quic/quic_spdy_client_stream.h"
+#include "net/tools/quic/spdy_balsa_utils.h"
+
+namespace net {
+namespace tools {
+
+namespace {
+
+// The generator measures latency, not certificate chains; accept whatever
+// the server presents.
+class FakeCertVerifier : public CertVerifier {
+ public:
+  int Verify(X509Certificate* cert,
+             const std::string& hostname,
+             const std::string& ocsp_response,
+             int flags,
+             CRLSet* crl_set,
+             CertVerifyResult* verify_result,
+             const CompletionCallback& callback,
+             scoped_ptr<CertVerifier::Request>* out_req,
+             const BoundNetLog& net_log) override {
+    return OK;
+  }
+
+  bool SupportsOCSPStapling() override { return false; }
+};
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0), min_us_(kint64max), max_us_(0) {
+  memset(counts_, 0, sizeof(counts_));
+}
+
+void LatencyHistogram::RecordUs(int64 value_us) {
+  if (value_us < 0)
+    value_us = 0;
+  ++counts_[BucketIndex(value_us)];
+  ++count_;
+  min_us_ = std::min(min_us_, value_us);
+  max_us_ = std::max(max_us_, value_us);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kNumBuckets; ++i)
+    counts_[i] += other.counts_[i];
+  count_ += other.count_;
+  min_us_ = std::min(min_us_, other.min_us_);
+  max_us_ = std::max(max_us_, other.max_us_);
+}
+
+int64 LatencyHistogram::PercentileUs(double percentile) const {
+  if (count_ == 0)
+    return 0;
+  int64 target = static_cast<int64>(count_ * (percentile / 100.0) + 0.5);
+  target = std::max(target, static_cast<int64>(1));
+  target = std::min(target, count_);
+  int64 seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      // Never report a bound beyond the largest recorded value.
+      return std::min(BucketUpperBoundUs(i), max_us_);
+    }
+  }
+  return max_us_;
+}
+
+// static
+int LatencyHistogram::BucketIndex(int64 value_us) {
+  DCHECK_GE(value_us, 0);
+  if (value_us < (1 << kSubBucketBits))
+    return static_cast<int>(value_us);
+  int log = kSubBucketBits;
+  while ((value_us >> (log + 1)) != 0)
+    ++log;
+  int octave = log - kSubBucketBits + 1;
+  if (octave >= kNumOctaves)
+    return kNumBuckets - 1;
+  int sub = static_cast<int>((value_us >> (log - kSubBucketBits)) &
+                             ((1 << kSubBucketBits) - 1));
+  return (octave << kSubBucketBits) + sub;
+}
+
+// static
+int64 LatencyHistogram::BucketUpperBoundUs(int index) {
+  int octave = index >> kSubBucketBits;
+  int sub = index & ((1 << kSubBucketBits) - 1);
+  if (octave == 0)
+    return sub;
+  return (static_cast<int64>((1 << kSubBucketBits) + sub + 1)
+          << (octave - 1)) -
+         1;
+}
+
+// Issues arrivals on the worker's schedule.  Returning the next arrival
+// time reregisters the alarm; returning 0 stops it.
+class QuicLoadGenerator::Worker::SendAlarm : public EpollAlarm {
+ public:
+  explicit SendAlarm(Worker* worker) : worker_(worker) {}
+
+  int64 OnAlarm() override {
+    EpollAlarm::OnAlarm();
+    return worker_->OnSendAlarm();
+  }
+
+ private:
+  Worker* worker_;
+};
+
+// Relays stream completions back to the worker; the client owns its
+// response listener, so this cannot be the worker itself.
+class QuicLoadGenerator::Worker::ResponseForwarder
+    : public QuicClient::ResponseListener {
+ public:
+  explicit ResponseForwarder(Worker* worker) : worker_(worker) {}
+
+  void OnCompleteResponse(QuicStreamId id,
+                          const BalsaHeaders& response_headers,
+                          const std::string& response_body) override {
+    worker_->OnResponseComplete(id);
+  }
+
+ private:
+  Worker* worker_;
+};
+
+QuicLoadGenerator::Worker::Worker(const IPEndPoint& server_address,
+                                  const QuicServerId& server_id,
+                                  const QuicVersionVector& supported_versions,
+                                  const std::vector<std::string>& urls,
+                                  size_t first_url,
+                                  double mean_interarrival_us,
+                                  int64 duration_us)
+    : base::SimpleThread("quic_load_generator_worker"),
+      server_address_(server_address),
+      server_id_(server_id),
+      supported_versions_(supported_versions),
+      urls_(urls),
+      next_url_(first_url),
+      mean_interarrival_us_(mean_interarrival_us),
+      duration_us_(duration_us),
+      next_arrival_us_(0),
+      end_time_us_(0),
+      num_sent_(0),
+      num_dropped_(0),
+      connect_failed_(false) {}
+
+QuicLoadGenerator::Worker::~Worker() {}
+
+void QuicLoadGenerator::Worker::Run() {
+  cert_verifier_.reset(new FakeCertVerifier);
+  transport_security_state_.reset(new TransportSecurityState);
+  ct_verifier_.reset(new MultiLogCTVerifier);
+  client_.reset(new QuicClient(
+      server_address_, server_id_, supported_versions_, &epoll_server_,
+      new ProofVerifierChromium(cert_verifier_.get(), nullptr,
+                                transport_security_state_.get(),
+                                ct_verifier_.get())));
+  client_->set_response_listener(new ResponseForwarder(this));
+  if (!client_->Initialize() || !client_->Connect()) {
+    connect_failed_ = true;
+    return;
+  }
+
+  int64 now = epoll_server_.NowInUsec();
+  end_time_us_ = now + duration_us_;
+  next_arrival_us_ = now + NextArrivalDeltaUs();
+  send_alarm_.reset(new SendAlarm(this));
+  epoll_server_.RegisterAlarm(next_arrival_us_, send_alarm_.get());
+
+  // Pump events until the schedule is exhausted and the responses still in
+  // flight have drained; give stragglers one extra schedule length before
+  // abandoning them.
+  const int64 drain_deadline_us = end_time_us_ + duration_us_;
+  while (client_->connected()) {
+    now = epoll_server_.NowInUsec();
+    if (now >= end_time_us_ &&
+        (in_flight_.empty() || now >= drain_deadline_us)) {
+      break;
+    }
+    client_->WaitForEvents();
+  }
+
+  // Anything still in flight was abandoned; don't let the teardown of its
+  // stream record a bogus latency.
+  in_flight_.clear();
+  client_->Disconnect();
+}
+
+void QuicLoadGenerator::Worker::OnResponseComplete(QuicStreamId id) {
+  std::map<QuicStreamId, int64>::iterator it = in_flight_.find(id);
+  if (it == in_flight_.end())
+    return;
+  latencies_.RecordUs(epoll_server_.NowInUsec() - it->second);
+  in_flight_.erase(it);
+}
+
+int64 QuicLoadGenerator::Worker::OnSendAlarm() {
+  int64 now = epoll_server_.NowInUsec();
+  // Issue every arrival whose time has come.  If the event loop fell
+  // behind, the backlog goes out as a burst: an open-loop generator must
+  // not let its own lateness reduce the offered rate.
+  while (next_arrival_us_ <= now && next_arrival_us_ < end_time_us_) {
+    SendOne(next_arrival_us_);
+    next_arrival_us_ += NextArrivalDeltaUs();
+  }
+  if (next_arrival_us_ >= end_time_us_)
+    return 0;
+  return next_arrival_us_;
+}
+
+void QuicLoadGenerator::Worker::SendOne(int64 intended_send_time_us) {
+  const std::string& url = urls_[next_url_];
+  next_url_ = (next_url_ + 1) % urls_.size();
+
+  QuicSession* session = client_->session();
+  if (session->GetNumActiveStreams() >= session->get_max_open_streams()) {
+    // Out of streams; under sustained overload this is the server (or the
+    // stream limit) pushing back on the offered load.
+    ++num_dropped_;
+    return;
+  }
+  QuicSpdyClientStream* stream = client_->CreateReliableClientStream();
+  if (stream == nullptr) {
+    ++num_dropped_;
+    return;
+  }
+  stream->set_visitor(client_.get());
+
+  BalsaHeaders headers;
+  headers.SetRequestFirstlineFromStringPieces("GET", url, "HTTP/1.1");
+  stream->SendRequest(SpdyBalsaUtils::RequestHeadersToSpdyHeaders(headers),
+                      "", true);
+  in_flight_[stream->id()] = intended_send_time_us;
+  ++num_sent_;
+}
+
+int64 QuicLoadGenerator::Worker::NextArrivalDeltaUs() {
+  // Inverse-transform sampling: exponential inter-arrival gaps make the
+  // arrival process Poisson.
+  double uniform = base::RandDouble();
+  return static_cast<int64>(-log(1.0 - uniform) * mean_interarrival_us_);
+}
+
+QuicLoadGenerator::QuicLoadGenerator(
+    const IPEndPoint& server_address,
+    const QuicServerId& server_id,
+    const QuicVersionVector& supported_versions,
+    const std::vector<std::string>& urls,
+    double target_qps,
+    int num_workers,
+    int64 duration_us)
+    : urls_(urls), num_sent_(0), num_dropped_(0) {
+  DCHECK(!urls_.empty());
+  DCHECK_GT(target_qps, 0.0);
+  DCHECK_GT(num_workers, 0);
+  // The aggregate rate is split evenly; each worker replays the trace from
+  // its own offset so the mix, not one slice of it, hits the server.
+  double mean_interarrival_us = 1e6 * num_workers / target_qps;
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.push_back(new Worker(
+        server_address, server_id, supported_versions, urls_,
+        (i * urls_.size()) / num_workers, mean_interarrival_us, duration_us));
+  }
+}
+
+QuicLoadGenerator::~QuicLoadGenerator() {}
+
+bool QuicLoadGenerator::Run() {
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->Start();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->Join();
+
+  bool all_connected = true;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    Worker* worker = workers_[i];
+    if (worker->connect_failed()) {
+      LOG(ERROR) << "worker " << i << " failed to connect";
+      all_connected = false;
+      continue;
+    }
+    latencies_.Merge(worker->latencies());
+    num_sent_ += worker->num_sent();
+    num_dropped_ += worker->num_dropped();
+  }
+  return all_connected;
+}
+
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,187 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// An open-loop QUIC load generator.  Each worker thread runs its own epoll
+// event loop and QUIC connection, issues GET requests for the URLs of a
+// replay trace at Poisson-distributed arrival times, and records response
+// latencies in an HDR-style log-linear histogram.  Because arrivals are
+// scheduled independently of completions, a slow server shows up as
+// queueing delay in the measured latencies instead of silently throttling
+// the offered load, which is what a closed-loop client would do.
+
+#ifndef NET_TOOLS_QUIC_BENCHMARK_QUIC_LOAD_GENERATOR_H_
+#define NET_TOOLS_QUIC_BENCHMARK_QUIC_LOAD_GENERATOR_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_server_id.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/quic_client.h"
+
+namespace net {
+
+class CertVerifier;
+class CTVerifier;
+class TransportSecurityState;
+
+namespace tools {
+
+// A log-linear latency histogram in the style of HdrHistogram: values keep
+// kSubBucketBits significant bits, so buckets are a constant relative width
+// at every magnitude and recording is O(1) with a fixed footprint.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  // Records one latency of |value_us|; negative values count as zero.
+  void RecordUs(int64 value_us);
+
+  // Adds all recordings of |other| into this histogram.
+  void Merge(const LatencyHistogram& other);
+
+  // Returns an upper bound on the latency at |percentile| (in (0, 100]), or
+  // 0 if nothing was recorded.
+  int64 PercentileUs(double percentile) const;
+
+  int64 count() const { return count_; }
+  int64 min_us() const { return count_ == 0 ? 0 : min_us_; }
+  int64 max_us() const { return max_us_; }
+
+ private:
+  // 32 linear sub-buckets per power of two keeps bucket error under ~3%.
+  static const int kSubBucketBits = 5;
+  static const int kNumOctaves = 40;
+  static const int kNumBuckets = kNumOctaves << kSubBucketBits;
+
+  static int BucketIndex(int64 value_us);
+  static int64 BucketUpperBoundUs(int index);
+
+  int64 counts_[kNumBuckets];
+  int64 count_;
+  int64 min_us_;
+  int64 max_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+// Replays a URL trace against one server from several independent event
+// loops and merges the workers' measurements.
+class QuicLoadGenerator {
+ public:
+  // |urls| is the request mix; each worker replays it round-robin from a
+  // different starting offset.  |target_qps| is the aggregate Poisson
+  // arrival rate, split evenly across |num_workers| event loops, and the
+  // send schedule runs for |duration_us| before the workers drain.
+  QuicLoadGenerator(const IPEndPoint& server_address,
+                    const QuicServerId& server_id,
+                    const QuicVersionVector& supported_versions,
+                    const std::vector<std::string>& urls,
+                    double target_qps,
+                    int num_workers,
+                    int64 duration_us);
+  ~QuicLoadGenerator();
+
+  // Runs the configured load and blocks until every worker has finished.
+  // Returns false if any worker failed to connect.
+  bool Run();
+
+  // The results below are valid after Run().
+  const LatencyHistogram& latencies() const { return latencies_; }
+  int64 num_sent() const { return num_sent_; }
+  // Arrivals that could not be issued because the connection was out of
+  // streams; under open-loop overload this is the server pushing back.
+  int64 num_dropped() const { return num_dropped_; }
+
+ private:
+  // A worker owns one epoll loop and one connection; after Start() it is
+  // only touched from its own thread until Join() returns.
+  class Worker : public base::SimpleThread {
+   public:
+    Worker(const IPEndPoint& server_address,
+           const QuicServerId& server_id,
+           const QuicVersionVector& supported_versions,
+           const std::vector<std::string>& urls,
+           size_t first_url,
+           double mean_interarrival_us,
+           int64 duration_us);
+    ~Worker() override;
+
+    // base::SimpleThread
+    void Run() override;
+
+    // Called on the worker thread when the stream carrying a request
+    // closes.
+    void OnResponseComplete(QuicStreamId id);
+
+    bool connect_failed() const { return connect_failed_; }
+    const LatencyHistogram& latencies() const { return latencies_; }
+    int64 num_sent() const { return num_sent_; }
+    int64 num_dropped() const { return num_dropped_; }
+
+   private:
+    class SendAlarm;
+    class ResponseForwarder;
+
+    // Issues every arrival whose scheduled time has passed and returns the
+    // absolute time of the next one, or 0 once the run is over.
+    int64 OnSendAlarm();
+
+    // Issues one request from the trace. |intended_send_time_us| is the
+    // scheduled arrival time; latencies are measured from it so that a
+    // stalled event loop counts against the server, not the schedule.
+    void SendOne(int64 intended_send_time_us);
+
+    // Samples the exponential inter-arrival gap of a Poisson process.
+    int64 NextArrivalDeltaUs();
+
+    const IPEndPoint server_address_;
+    const QuicServerId server_id_;
+    const QuicVersionVector supported_versions_;
+    const std::vector<std::string>& urls_;
+    size_t next_url_;
+    const double mean_interarrival_us_;
+    const int64 duration_us_;
+
+    EpollServer epoll_server_;
+    scoped_ptr<CertVerifier> cert_verifier_;
+    scoped_ptr<TransportSecurityState> transport_security_state_;
+    scoped_ptr<CTVerifier> ct_verifier_;
+    scoped_ptr<QuicClient> client_;
+    scoped_ptr<SendAlarm> send_alarm_;
+
+    int64 next_arrival_us_;
+    int64 end_time_us_;
+    // Intended send time of each request still in flight, by stream id.
+    std::map<QuicStreamId, int64> in_flight_;
+
+    LatencyHistogram latencies_;
+    int64 num_sent_;
+    int64 num_dropped_;
+    bool connect_failed_;
+
+    DISALLOW_COPY_AND_ASSIGN(Worker);
+  };
+
+  const std::vector<std::string> urls_;
+  ScopedVector<Worker> workers_;
+
+  LatencyHistogram latencies_;
+  int64 num_sent_;
+  int64 num_dropped_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicLoadGenerator);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_BENCHMARK_QUIC_LOAD_GENERATOR_H_
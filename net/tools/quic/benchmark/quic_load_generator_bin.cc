@@ -0,0 +1,196 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// An open-loop QUIC load generator.  Replays the URLs of a trace file
+// against a server at a Poisson arrival rate spread over several event
+// loops, and prints latency percentiles from an HDR-style histogram.
+//
+// Example, 4 event loops offering 2000 requests/sec for 30 seconds:
+//   quic_load_generator --address=127.0.0.1 --port=6121 \
+//       --trace_file=urls.txt --qps=2000 --workers=4 --duration=30
+
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "net/base/ip_address_number.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/privacy_mode.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_server_id.h"
+#include "net/tools/quic/benchmark/quic_load_generator.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace {
+
+string FLAGS_address = "127.0.0.1";
+// The port the server is listening on.
+int32 FLAGS_port = 6121;
+// The file with one request URL per line; '#' starts a comment.
+string FLAGS_trace_file = "";
+// Aggregate Poisson arrival rate, in requests per second.
+double FLAGS_qps = 100.0;
+// The number of worker threads, each with its own event loop and
+// connection.
+int32 FLAGS_workers = 1;
+// How long to offer load for, in seconds.
+int32 FLAGS_duration = 10;
+// The QUIC version to speak, or -1 for the latest.
+int32 FLAGS_quic_version = -1;
+
+// Reads the replay trace, skipping blank lines and comments. Returns false
+// if the file cannot be read or holds no URLs.
+bool ReadTraceFile(const string& path, vector<string>* urls) {
+  string contents;
+  if (!base::ReadFileToString(base::FilePath::FromUTF8Unsafe(path),
+                              &contents)) {
+    return false;
+  }
+  for (const string& line :
+       base::SplitString(contents, "\n", base::TRIM_WHITESPACE,
+                         base::SPLIT_WANT_NONEMPTY)) {
+    if (line[0] == '#')
+      continue;
+    urls->push_back(line);
+  }
+  return !urls->empty();
+}
+
+void PrintPercentile(const net::tools::LatencyHistogram& latencies,
+                     double percentile) {
+  printf("  p%-7g %10" PRId64 " us\n", percentile,
+         latencies.PercentileUs(percentile));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager exit_manager;
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  logging::LoggingSettings settings;
+  settings.logging_dest = logging::LOG_TO_SYSTEM_DEBUG_LOG;
+  CHECK(logging::InitLogging(settings));
+
+  if (line->HasSwitch("h") || line->HasSwitch("help")) {
+    const char* help_str =
+        "Usage: quic_load_generator [options]\n"
+        "\n"
+        "Options:\n"
+        "-h, --help                  show this help message and exit\n"
+        "--address=<address>         IP address of the server\n"
+        "--port=<port>               server port\n"
+        "--trace_file=<path>         file with one request URL per line\n"
+        "--qps=<qps>                 aggregate Poisson arrival rate\n"
+        "--workers=<count>           number of event loops to spread the\n"
+        "                            load across\n"
+        "--duration=<seconds>        how long to offer load\n"
+        "--quic_version=<version>    QUIC version to speak\n";
+    cout << help_str;
+    return 0;
+  }
+
+  if (line->HasSwitch("address"))
+    FLAGS_address = line->GetSwitchValueASCII("address");
+  if (line->HasSwitch("port") &&
+      !base::StringToInt(line->GetSwitchValueASCII("port"), &FLAGS_port)) {
+    cerr << "--port must be an integer" << endl;
+    return 1;
+  }
+  if (line->HasSwitch("trace_file"))
+    FLAGS_trace_file = line->GetSwitchValueASCII("trace_file");
+  if (line->HasSwitch("qps") &&
+      !base::StringToDouble(line->GetSwitchValueASCII("qps"), &FLAGS_qps)) {
+    cerr << "--qps must be a number" << endl;
+    return 1;
+  }
+  if (line->HasSwitch("workers") &&
+      !base::StringToInt(line->GetSwitchValueASCII("workers"),
+                         &FLAGS_workers)) {
+    cerr << "--workers must be an integer" << endl;
+    return 1;
+  }
+  if (line->HasSwitch("duration") &&
+      !base::StringToInt(line->GetSwitchValueASCII("duration"),
+                         &FLAGS_duration)) {
+    cerr << "--duration must be an integer" << endl;
+    return 1;
+  }
+  if (line->HasSwitch("quic_version") &&
+      !base::StringToInt(line->GetSwitchValueASCII("quic_version"),
+                         &FLAGS_quic_version)) {
+    cerr << "--quic_version must be an integer" << endl;
+    return 1;
+  }
+  if (FLAGS_qps <= 0 || FLAGS_workers <= 0 || FLAGS_duration <= 0) {
+    cerr << "--qps, --workers and --duration must be positive" << endl;
+    return 1;
+  }
+
+  net::IPAddressNumber ip_addr;
+  if (!net::ParseIPLiteralToNumber(FLAGS_address, &ip_addr)) {
+    cerr << "--address must be an IP literal" << endl;
+    return 1;
+  }
+
+  vector<string> urls;
+  if (!ReadTraceFile(FLAGS_trace_file, &urls)) {
+    cerr << "could not read any URLs from --trace_file=" << FLAGS_trace_file
+         << endl;
+    return 1;
+  }
+
+  net::QuicVersionVector versions = net::QuicSupportedVersions();
+  if (FLAGS_quic_version != -1) {
+    versions.clear();
+    versions.push_back(static_cast<net::QuicVersion>(FLAGS_quic_version));
+  }
+
+  net::QuicServerId server_id(FLAGS_address, FLAGS_port,
+                              net::PRIVACY_MODE_DISABLED);
+  net::tools::QuicLoadGenerator generator(
+      net::IPEndPoint(ip_addr, FLAGS_port), server_id, versions, urls,
+      FLAGS_qps, FLAGS_workers,
+      static_cast<int64>(FLAGS_duration) * 1000 * 1000);
+
+  cout << "Offering " << FLAGS_qps << " qps over " << FLAGS_workers
+       << " event loop(s) for " << FLAGS_duration << "s..." << endl;
+  if (!generator.Run()) {
+    cerr << "at least one worker failed to connect" << endl;
+    return 1;
+  }
+
+  const net::tools::LatencyHistogram& latencies = generator.latencies();
+  printf("requests sent:      %" PRId64 "\n", generator.num_sent());
+  printf("responses received: %" PRId64 "\n", latencies.count());
+  printf("arrivals dropped:   %" PRId64 "\n", generator.num_dropped());
+  printf("achieved rate:      %.1f qps\n",
+         static_cast<double>(latencies.count()) / FLAGS_duration);
+  printf("response latency (min %" PRId64 " us, max %" PRId64 " us):\n",
+         latencies.min_us(), latencies.max_us());
+  PrintPercentile(latencies, 50);
+  PrintPercentile(latencies, 90);
+  PrintPercentile(latencies, 95);
+  PrintPercentile(latencies, 99);
+  PrintPercentile(latencies, 99.9);
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/benchmark/quic_load_generator.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace tools {
+namespace test {
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.min_us());
+  EXPECT_EQ(0, histogram.max_us());
+  EXPECT_EQ(0, histogram.PercentileUs(50));
+  EXPECT_EQ(0, histogram.PercentileUs(100));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  histogram.RecordUs(1);
+  histogram.RecordUs(2);
+  histogram.RecordUs(3);
+  histogram.RecordUs(4);
+  EXPECT_EQ(4, histogram.count());
+  EXPECT_EQ(1, histogram.min_us());
+  EXPECT_EQ(4, histogram.max_us());
+  EXPECT_EQ(2, histogram.PercentileUs(50));
+  EXPECT_EQ(4, histogram.PercentileUs(100));
+}
+
+TEST(LatencyHistogramTest, LargeValuesKeepRelativePrecision) {
+  LatencyHistogram histogram;
+  // One sample, so every percentile reports its bucket's upper bound; the
+  // log-linear bucketing must keep that within ~3% of the true value.
+  const int64 kValueUs = 1000000;
+  histogram.RecordUs(kValueUs);
+  int64 reported = histogram.PercentileUs(50);
+  EXPECT_GE(reported, kValueUs - kValueUs / 32);
+  EXPECT_LE(reported, kValueUs + kValueUs / 32);
+}
+
+TEST(LatencyHistogramTest, PercentilesSplitTheDistribution) {
+  LatencyHistogram histogram;
+  // 90 fast responses and 10 slow ones.
+  for (int i = 0; i < 90; ++i)
+    histogram.RecordUs(100);
+  for (int i = 0; i < 10; ++i)
+    histogram.RecordUs(1000000);
+  EXPECT_LE(histogram.PercentileUs(50), 110);
+  EXPECT_LE(histogram.PercentileUs(90), 110);
+  EXPECT_GE(histogram.PercentileUs(99), 900000);
+  EXPECT_EQ(1000000, histogram.PercentileUs(100));
+}
+
+TEST(LatencyHistogramTest, NegativeValuesCountAsZero) {
+  LatencyHistogram histogram;
+  histogram.RecordUs(-5);
+  EXPECT_EQ(1, histogram.count());
+  EXPECT_EQ(0, histogram.min_us());
+  EXPECT_EQ(0, histogram.max_us());
+  EXPECT_EQ(0, histogram.PercentileUs(100));
+}
+
+TEST(LatencyHistogramTest, MergeCombinesRecordings) {
+  LatencyHistogram left;
+  LatencyHistogram right;
+  for (int i = 0; i < 50; ++i)
+    left.RecordUs(100);
+  for (int i = 0; i < 50; ++i)
+    right.RecordUs(1000000);
+  left.Merge(right);
+  EXPECT_EQ(100, left.count());
+  EXPECT_EQ(100, left.min_us());
+  EXPECT_EQ(1000000, left.max_us());
+  EXPECT_LE(left.PercentileUs(50), 110);
+  EXPECT_GE(left.PercentileUs(99), 900000);
+}
+
+}  // namespace test
+}  // namespace tools
+}  // namespace net
@@ -42,6 +42,7 @@
 #include "net/tools/quic/quic_spdy_client_stream.h"
 #include "net/tools/quic/quic_spdy_server_stream.h"
 #include "net/tools/quic/test_tools/http_message.h"
+#include "net/tools/quic/test_tools/network_emulation_writer.h"
 #include "net/tools/quic/test_tools/packet_dropping_test_writer.h"
 #include "net/tools/quic/test_tools/quic_client_peer.h"
 #include "net/tools/quic/test_tools/quic_dispatcher_peer.h"
@@ -2165,6 +2166,93 @@ TEST_P(EndToEndTest, Trailers) {
   EXPECT_EQ(trailers, client_->response_trailers());
 }
 
+// End to end tests run over an emulated network path rather than raw
+// loopback, giving congestion control and loss recovery changes reproducible
+// in-tree throughput numbers.  The emulation is deterministic (fixed seed),
+// so the assertions below are tight enough to catch regressions but loose
+// enough to absorb scheduling noise on loaded bots.
+class EndToEndEmulatedNetworkTest : public EndToEndTest {
+ protected:
+  void SetUp() override {
+    // Replace the default writers before Initialize() hands them off to the
+    // client and the server.
+    emulated_client_writer_ = new NetworkEmulationWriter();
+    emulated_server_writer_ = new NetworkEmulationWriter();
+    client_writer_ = emulated_client_writer_;
+    server_writer_ = emulated_server_writer_;
+  }
+
+  // Downloads a |response_bytes| response over |profile| (applied in both
+  // directions after the handshake completes) and expects the achieved
+  // goodput to be at least |min_utilization| of the emulated bottleneck.
+  void RunDownloadThroughputTest(const NetworkEmulationProfile& profile,
+                                 size_t response_bytes,
+                                 double min_utilization) {
+    string body;
+    GenerateBody(&body, response_bytes);
+    AddToCache("/perf", 200, body);
+
+    ASSERT_TRUE(Initialize());
+    // Run the handshake over the unimpaired path so connection setup cost
+    // does not pollute the transfer measurement.
+    client_->client()->WaitForCryptoHandshakeConfirmed();
+    emulated_client_writer_->ApplyProfile(profile);
+    emulated_server_writer_->ApplyProfile(profile);
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    EXPECT_EQ(body, client_->SendSynchronousRequest("/perf"));
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+    const double achieved_bps =
+        response_bytes * 8 * base::Time::kMicrosecondsPerSecond /
+        static_cast<double>(elapsed.InMicroseconds());
+    const double link_bps =
+        static_cast<double>(profile.bandwidth.ToBitsPerSecond());
+    LOG(INFO) << "Emulated profile '" << profile.name << "': "
+              << response_bytes << " bytes in " << elapsed.InMilliseconds()
+              << "ms, " << static_cast<int64>(achieved_bps / 1000)
+              << " kbps of " << profile.bandwidth.ToKBitsPerSecond()
+              << " kbps link";
+    EXPECT_GE(achieved_bps, min_utilization * link_bps);
+    // Goodput cannot exceed the emulated bottleneck; the slack covers the
+    // initial unshaped token-bucket burst.
+    EXPECT_LE(achieved_bps, 1.25 * link_bps);
+  }
+
+  NetworkEmulationWriter* emulated_client_writer_;
+  NetworkEmulationWriter* emulated_server_writer_;
+};
+
+// The perf assertions only need to run once per configuration, not over the
+// full version/option matrix.
+vector<TestParams> GetEmulatedNetworkTestParams() {
+  QuicVersionVector all_supported_versions = QuicSupportedVersions();
+  vector<TestParams> params;
+  params.push_back(TestParams(all_supported_versions, all_supported_versions,
+                              all_supported_versions.front(), false, false,
+                              false, kQBIC, false));
+  return params;
+}
+
+INSTANTIATE_TEST_CASE_P(EndToEndEmulatedNetworkTests,
+                        EndToEndEmulatedNetworkTest,
+                        ::testing::ValuesIn(GetEmulatedNetworkTestParams()));
+
+TEST_P(EndToEndEmulatedNetworkTest, LTEProfileThroughput) {
+  RunDownloadThroughputTest(LTEProfile(), 512 * 1024, 0.3);
+}
+
+TEST_P(EndToEndEmulatedNetworkTest, TranspacificProfileThroughput) {
+  RunDownloadThroughputTest(TranspacificProfile(), 1024 * 1024, 0.3);
+}
+
+TEST_P(EndToEndEmulatedNetworkTest, DatacenterProfileThroughput) {
+  // Loopback plus test overhead cannot saturate the emulated 1Gbps link, so
+  // only a weak lower bound is asserted; the upper bound inherited from
+  // RunDownloadThroughputTest still validates the token bucket.
+  RunDownloadThroughputTest(DatacenterProfile(), 2 * 1024 * 1024, 0.05);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace tools
@@ -0,0 +1,138 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <string.h>
+#include <vector>
+
+#include "base/logging.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+namespace tools {
+
+QuicBatchPacketWriter::QuicBatchPacketWriter(int fd)
+    : QuicDefaultPacketWriter(fd),
+      queue_(new QueuedPacket[kMaxPacketsPerFlush]),
+      head_(0),
+      count_(0) {}
+
+QuicBatchPacketWriter::~QuicBatchPacketWriter() {}
+
+WriteResult QuicBatchPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const IPAddressNumber& self_address,
+    const IPEndPoint& peer_address) {
+  DCHECK(!IsWriteBlocked());
+  DCHECK_LE(buf_len, kMaxPacketSize);
+  DCHECK_LT(count_, kMaxPacketsPerFlush);
+
+  QueuedPacket* packet = &queue_[(head_ + count_) % kMaxPacketsPerFlush];
+  memcpy(packet->buffer, buffer, buf_len);
+  packet->buf_len = buf_len;
+  packet->self_address = self_address;
+  packet->peer_address = peer_address;
+  ++count_;
+
+  if (count_ < kMaxPacketsPerFlush) {
+    return WriteResult(WRITE_STATUS_OK, buf_len);
+  }
+  WriteResult result = Flush();
+  if (result.status != WRITE_STATUS_OK) {
+    // On WRITE_STATUS_BLOCKED the packet remains queued and will be written
+    // once the socket drains; the caller treats it as consumed because
+    // IsWriteBlockedDataBuffered() is true.
+    return result;
+  }
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+bool QuicBatchPacketWriter::IsWriteBlockedDataBuffered() const {
+  return true;
+}
+
+void QuicBatchPacketWriter::SetWritable() {
+  QuicDefaultPacketWriter::SetWritable();
+  if (count_ > 0) {
+    // May block the writer again if the socket is still full.
+    Flush();
+  }
+}
+
+size_t QuicBatchPacketWriter::LeadingTrainLength() const {
+  // A train is a run of packets to the same peer where every segment but the
+  // last has the first packet's length; a shorter segment ends the train.
+  const QueuedPacket& first = queue_[head_];
+  size_t train_packets = 1;
+  while (train_packets < count_) {
+    const QueuedPacket& prev =
+        queue_[(head_ + train_packets - 1) % kMaxPacketsPerFlush];
+    const QueuedPacket& next =
+        queue_[(head_ + train_packets) % kMaxPacketsPerFlush];
+    if (prev.buf_len != first.buf_len || next.buf_len > first.buf_len ||
+        !(next.peer_address == first.peer_address) ||
+        next.self_address != first.self_address) {
+      break;
+    }
+    ++train_packets;
+  }
+  return train_packets;
+}
+
+WriteResult QuicBatchPacketWriter::Flush() {
+  while (count_ > 0) {
+    WriteResult result(WRITE_STATUS_OK, 0);
+    int num_packets_sent = 0;
+    const size_t train_packets =
+        QuicSocketUtils::HasUdpSegmentationOffload() ? LeadingTrainLength() : 1;
+    if (train_packets > 1) {
+      // Pack the train contiguously and let the kernel cut it into packets.
+      if (train_.get() == nullptr) {
+        train_.reset(new char[kMaxPacketsPerFlush * kMaxPacketSize]);
+      }
+      size_t train_len = 0;
+      for (size_t i = 0; i < train_packets; ++i) {
+        const QueuedPacket& packet =
+            queue_[(head_ + i) % kMaxPacketsPerFlush];
+        memcpy(train_.get() + train_len, packet.buffer, packet.buf_len);
+        train_len += packet.buf_len;
+      }
+      const QueuedPacket& first = queue_[head_];
+      result = QuicSocketUtils::WriteSegmentedPackets(
+          fd(), train_.get(), train_len, first.buf_len, first.self_address,
+          first.peer_address, &num_packets_sent);
+    } else {
+      std::vector<BufferedWrite> writes;
+      writes.reserve(count_);
+      for (size_t i = 0; i < count_; ++i) {
+        const QueuedPacket& packet = queue_[(head_ + i) % kMaxPacketsPerFlush];
+        writes.push_back(BufferedWrite(packet.buffer, packet.buf_len,
+                                       packet.self_address,
+                                       packet.peer_address));
+      }
+      result = QuicSocketUtils::WriteMultiplePackets(fd(), writes,
+                                                     &num_packets_sent);
+    }
+    head_ = (head_ + num_packets_sent) % kMaxPacketsPerFlush;
+    count_ -= num_packets_sent;
+    if (result.status == WRITE_STATUS_BLOCKED) {
+      set_write_blocked(true);
+      return result;
+    }
+    if (result.status == WRITE_STATUS_ERROR) {
+      LOG(ERROR) << "sendmmsg failed with error " << result.error_code
+                 << "; dropping " << count_ << " queued packets.";
+      head_ = 0;
+      count_ = 0;
+      return result;
+    }
+  }
+  head_ = 0;
+  return WriteResult(WRITE_STATUS_OK, 0);
+}
+
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,80 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_default_packet_writer.h"
+
+namespace net {
+namespace tools {
+
+// Packet writer which queues outgoing packets and writes them to the socket
+// in batches with a single sendmmsg() call, amortizing syscall overhead
+// across the packets produced while dispatching a burst of reads. The queue
+// is flushed when it fills up, when the owner calls Flush() at the end of an
+// event loop pass, and when the socket becomes writable again.
+//
+// Queued packets are owned by the writer, so a write which returns
+// WRITE_STATUS_BLOCKED has still consumed the packet
+// (IsWriteBlockedDataBuffered() is true) and will be retried once the socket
+// drains.
+class QuicBatchPacketWriter : public QuicDefaultPacketWriter {
+ public:
+  // Maximum number of packets queued before WritePacket() flushes, mirroring
+  // kNumPacketsPerReadMmsgCall on the read side.
+  static const size_t kMaxPacketsPerFlush = 16;
+
+  explicit QuicBatchPacketWriter(int fd);
+  ~QuicBatchPacketWriter() override;
+
+  // QuicPacketWriter
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const IPAddressNumber& self_address,
+                          const IPEndPoint& peer_address) override;
+  bool IsWriteBlockedDataBuffered() const override;
+  void SetWritable() override;
+
+  // Writes as many queued packets as the socket will accept. Marks the
+  // writer blocked, keeping the unsent packets queued, if the socket blocks.
+  WriteResult Flush();
+
+  bool HasQueuedPackets() const { return count_ > 0; }
+
+ private:
+  struct QueuedPacket {
+    char buffer[kMaxPacketSize];
+    size_t buf_len;
+    IPAddressNumber self_address;
+    IPEndPoint peer_address;
+  };
+
+  // Returns the number of queued packets, starting at |head_|, which form a
+  // train of equal-sized segments to one peer and can be written with a
+  // single segmented write.
+  size_t LeadingTrainLength() const;
+
+  // Ring of queued packets; the |count_| packets starting at |head_| (modulo
+  // kMaxPacketsPerFlush) are waiting to be written.
+  scoped_ptr<QueuedPacket[]> queue_;
+  size_t head_;
+  size_t count_;
+
+  // Scratch space used to pack a train of packets contiguously for a
+  // segmented write. Allocated on first use; unused when the kernel has no
+  // segmentation offload.
+  scoped_ptr<char[]> train_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicBatchPacketWriter);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
@@ -22,6 +22,14 @@ using std::string;
 namespace net {
 namespace tools {
 
+namespace {
+
+// In file backed mode only the headers of each corpus file are read at
+// startup; this bounds how far into a file the end of headers may be.
+const size_t kMaxHeaderBytes = 64 * 1024;
+
+}  // namespace
+
 QuicInMemoryCache::ServerPushInfo::ServerPushInfo(
     GURL request_url,
     const SpdyHeaderBlock& headers,
@@ -32,7 +40,11 @@ QuicInMemoryCache::ServerPushInfo::ServerPushInfo(
       priority(priority),
       body(body) {}
 
-QuicInMemoryCache::Response::Response() : response_type_(REGULAR_RESPONSE) {}
+QuicInMemoryCache::Response::Response()
+    : response_type_(REGULAR_RESPONSE),
+      file_backed_(false),
+      body_file_offset_(0),
+      body_file_length_(0) {}
 
 QuicInMemoryCache::Response::~Response() {}
 
@@ -51,6 +63,9 @@ const QuicInMemoryCache::Response* QuicInMemoryCache::GetResponse(
     }
     return nullptr;
   }
+  if (it->second->file_backed()) {
+    MapFileBackedBody(it->second);
+  }
   return it->second;
 }
 
@@ -105,11 +120,18 @@ void QuicInMemoryCache::AddSpecialResponse(StringPiece host,
                   SpdyHeaderBlock());
 }
 
-QuicInMemoryCache::QuicInMemoryCache() {}
+QuicInMemoryCache::QuicInMemoryCache() : use_file_backed_bodies_(false) {}
 
 void QuicInMemoryCache::ResetForTests() {
   STLDeleteValues(&responses_);
   server_push_resources_.clear();
+  use_file_backed_bodies_ = false;
+  hot_mappings_.reset();
+}
+
+void QuicInMemoryCache::EnableFileBackedBodies(size_t max_mapped_files) {
+  use_file_backed_bodies_ = true;
+  hot_mappings_.reset(new MappingCache(max_mapped_files));
 }
 
 void QuicInMemoryCache::InitializeFromDirectory(const string& cache_directory) {
@@ -138,8 +160,14 @@ void QuicInMemoryCache::InitializeFromDirectory(const string& cache_directory) {
       file.erase(0, 1);
     }
 
+    int64 file_size = file_list.GetInfo().GetSize();
     string file_contents;
-    base::ReadFileToString(file_iter, &file_contents);
+    if (use_file_backed_bodies_) {
+      // Only the headers are needed up front; the body stays on disk.
+      base::ReadFileToString(file_iter, &file_contents, kMaxHeaderBytes);
+    } else {
+      base::ReadFileToString(file_iter, &file_contents);
+    }
     int file_len = static_cast<int>(file_contents.length());
     int headers_end = HttpUtil::LocateEndOfHeaders(file_contents.data(),
                                                    file_len);
@@ -175,11 +203,16 @@ void QuicInMemoryCache::InitializeFromDirectory(const string& cache_directory) {
     if (path[path.length() - 1] == ',') {
       path.remove_suffix(1);
     }
-    StringPiece body(file_contents.data() + headers_end,
-                     file_contents.size() - headers_end);
     SpdyHeaderBlock header_block;
     CreateSpdyHeadersFromHttpResponse(*response_headers, HTTP2, &header_block);
-    AddResponse(host, path, header_block, body);
+    if (use_file_backed_bodies_) {
+      AddFileBackedResponse(host, path, header_block, file_iter, headers_end,
+                            file_size - headers_end);
+    } else {
+      StringPiece body(file_contents.data() + headers_end,
+                       file_contents.size() - headers_end);
+      AddResponse(host, path, header_block, body);
+    }
   }
 }
 
@@ -217,6 +250,47 @@ void QuicInMemoryCache::AddResponseImpl(
   responses_[key] = new_response;
 }
 
+void QuicInMemoryCache::AddFileBackedResponse(
+    StringPiece host,
+    StringPiece path,
+    const SpdyHeaderBlock& response_headers,
+    const FilePath& file,
+    size_t body_offset,
+    size_t body_length) {
+  string key = GetKey(host, path);
+  if (ContainsKey(responses_, key)) {
+    LOG(DFATAL) << "Response for '" << key << "' already exists!";
+    return;
+  }
+  Response* new_response = new Response();
+  new_response->set_response_type(REGULAR_RESPONSE);
+  new_response->set_headers(response_headers);
+  new_response->set_file_backed_body(file, body_offset, body_length);
+  responses_[key] = new_response;
+}
+
+void QuicInMemoryCache::MapFileBackedBody(Response* response) const {
+  DCHECK(hot_mappings_.get());
+  const string key = response->body_file().AsUTF8Unsafe();
+  MappingCache::iterator it = hot_mappings_->Get(key);
+  if (it == hot_mappings_->end()) {
+    linked_ptr<base::MemoryMappedFile> mapping(new base::MemoryMappedFile);
+    if (!mapping->Initialize(response->body_file())) {
+      LOG(DFATAL) << "Unable to map response body file: " << key;
+      response->set_mapped_body(StringPiece());
+      return;
+    }
+    it = hot_mappings_->Put(key, mapping);
+  }
+  const base::MemoryMappedFile* mapping = it->second.get();
+  DCHECK_LE(response->body_file_offset() + response->body_file_length(),
+            mapping->length());
+  response->set_mapped_body(StringPiece(
+      reinterpret_cast<const char*>(mapping->data()) +
+          response->body_file_offset(),
+      response->body_file_length()));
+}
+
 string QuicInMemoryCache::GetKey(StringPiece host, StringPiece path) const {
   return host.as_string() + path.as_string();
 }
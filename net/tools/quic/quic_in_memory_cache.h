@@ -9,6 +9,10 @@
 #include <string>
 
 #include "base/containers/hash_tables.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/linked_ptr.h"
 #include "base/memory/singleton.h"
 #include "base/strings/string_piece.h"
 #include "net/quic/spdy_utils.h"
@@ -67,7 +71,15 @@ class QuicInMemoryCache {
     SpecialResponseType response_type() const { return response_type_; }
     const SpdyHeaderBlock& headers() const { return headers_; }
     const SpdyHeaderBlock& trailers() const { return trailers_; }
-    const base::StringPiece body() const { return base::StringPiece(body_); }
+    // For a file backed response, body() is only valid until the next call
+    // to QuicInMemoryCache::GetResponse(), which may recycle the mapping.
+    const base::StringPiece body() const {
+      return file_backed_ ? mapped_body_ : base::StringPiece(body_);
+    }
+    bool file_backed() const { return file_backed_; }
+    const base::FilePath& body_file() const { return body_file_; }
+    size_t body_file_offset() const { return body_file_offset_; }
+    size_t body_file_length() const { return body_file_length_; }
 
     void set_response_type(SpecialResponseType response_type) {
       response_type_ = response_type;
@@ -79,6 +91,19 @@ class QuicInMemoryCache {
     void set_body(base::StringPiece body) {
       body.CopyToString(&body_);
     }
+    // Marks the body as living in |file| at |offset| for |length| bytes
+    // instead of on the heap. The cache maps the file in on demand.
+    void set_file_backed_body(const base::FilePath& file,
+                              size_t offset,
+                              size_t length) {
+      file_backed_ = true;
+      body_file_ = file;
+      body_file_offset_ = offset;
+      body_file_length_ = length;
+    }
+    void set_mapped_body(base::StringPiece mapped_body) {
+      mapped_body_ = mapped_body;
+    }
 
    private:
     SpecialResponseType response_type_;
@@ -86,6 +111,14 @@ class QuicInMemoryCache {
     SpdyHeaderBlock trailers_;
     std::string body_;
 
+    // Set when the body lives in body_file_ rather than in body_.
+    bool file_backed_;
+    base::FilePath body_file_;
+    size_t body_file_offset_;
+    size_t body_file_length_;
+    // Points into the mapping of body_file_ after the cache has mapped it.
+    base::StringPiece mapped_body_;
+
     DISALLOW_COPY_AND_ASSIGN(Response);
   };
 
@@ -137,6 +170,14 @@ class QuicInMemoryCache {
   // 'response'.
   void AddDefaultResponse(Response* response);
 
+  // When enabled, InitializeFromDirectory() leaves response bodies on disk:
+  // each response records where its body lives in the corpus file and
+  // GetResponse() memory-maps the file on demand, keeping at most
+  // |max_mapped_files| mappings resident. This allows serving corpora much
+  // larger than memory without reading every body at startup. Must be
+  // called before InitializeFromDirectory().
+  void EnableFileBackedBodies(size_t max_mapped_files);
+
   // |cache_cirectory| can be generated using `wget -p --save-headers <url>`.
   void InitializeFromDirectory(const string& cache_directory);
 
@@ -145,6 +186,8 @@ class QuicInMemoryCache {
 
  private:
   typedef base::hash_map<string, Response*> ResponseMap;
+  typedef base::MRUCache<string, linked_ptr<base::MemoryMappedFile> >
+      MappingCache;
 
   friend struct base::DefaultSingletonTraits<QuicInMemoryCache>;
   friend class test::QuicInMemoryCachePeer;
@@ -161,6 +204,20 @@ class QuicInMemoryCache {
                        base::StringPiece response_body,
                        const SpdyHeaderBlock& response_trailers);
 
+  // Adds a response whose body stays in |file| at |body_offset| for
+  // |body_length| bytes rather than being copied onto the heap.
+  void AddFileBackedResponse(base::StringPiece host,
+                             base::StringPiece path,
+                             const SpdyHeaderBlock& response_headers,
+                             const base::FilePath& file,
+                             size_t body_offset,
+                             size_t body_length);
+
+  // Points |response|'s body into a mapping of its backing file, reusing a
+  // resident mapping when one exists and evicting the least recently used
+  // mapping once hot_mappings_ is full.
+  void MapFileBackedBody(Response* response) const;
+
   string GetKey(base::StringPiece host, base::StringPiece path) const;
 
   // Add some server push urls with given responses for specified
@@ -183,6 +240,13 @@ class QuicInMemoryCache {
   // A map from request URL to associated server push responses (if any).
   std::multimap<string, ServerPushInfo> server_push_resources_;
 
+  // Whether InitializeFromDirectory() leaves bodies file backed.
+  bool use_file_backed_bodies_;
+
+  // Memory mappings of corpus files for file backed responses, most
+  // recently used first. nullptr until EnableFileBackedBodies() is called.
+  mutable scoped_ptr<MappingCache> hot_mappings_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicInMemoryCache);
 };
 
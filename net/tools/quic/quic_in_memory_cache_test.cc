@@ -115,6 +115,33 @@ TEST_F(QuicInMemoryCacheTest, ReadsCacheDir) {
   EXPECT_LT(0U, response->body().length());
 }
 
+TEST_F(QuicInMemoryCacheTest, FileBackedBodies) {
+  QuicInMemoryCache* cache = QuicInMemoryCache::GetInstance();
+  cache->EnableFileBackedBodies(1);
+  cache->InitializeFromDirectory(CacheDirectory());
+
+  const QuicInMemoryCache::Response* response =
+      cache->GetResponse("quic.test.url", "/index.html");
+  ASSERT_TRUE(response);
+  ASSERT_TRUE(ContainsKey(response->headers(), ":status"));
+  EXPECT_EQ("200", response->headers().find(":status")->second);
+  ASSERT_LT(0U, response->body().length());
+  string file_backed_body = response->body().as_string();
+
+  // A second lookup reuses the resident mapping.
+  response = cache->GetResponse("quic.test.url", "/index.html");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(file_backed_body, response->body());
+
+  // The file backed body matches what an in-memory load produces.
+  QuicInMemoryCachePeer::ResetForTests();
+  QuicInMemoryCache::GetInstance()->InitializeFromDirectory(CacheDirectory());
+  response = QuicInMemoryCache::GetInstance()->GetResponse("quic.test.url",
+                                                           "/index.html");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(file_backed_body, response->body());
+}
+
 TEST_F(QuicInMemoryCacheTest, UsesOriginalUrl) {
   QuicInMemoryCache::GetInstance()->InitializeFromDirectory(CacheDirectory());
   const QuicInMemoryCache::Response* response =
@@ -63,7 +63,8 @@ QuicServer::QuicServer(ProofSource* proof_source,
                      QuicRandom::GetInstance(),
                      proof_source),
       supported_versions_(supported_versions),
-      packet_reader_(new QuicPacketReader()) {
+      packet_reader_(new QuicPacketReader()),
+      batch_writer_(nullptr) {
   Initialize();
 }
 
@@ -133,6 +134,18 @@ bool QuicServer::Listen(const IPEndPoint& address) {
     overflow_supported_ = true;
   }
 
+#if defined(SO_REUSEPORT)
+  // Allow several sockets, one per server shard, to bind the same address;
+  // the kernel hashes each flow to one of them, keeping every packet of a
+  // connection on the same shard.
+  int reuse_port = 1;
+  rc = setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &reuse_port,
+                  sizeof(reuse_port));
+  if (rc < 0) {
+    DLOG(WARNING) << "SO_REUSEPORT not supported";
+  }
+#endif
+
   // These send and receive buffer sizes are sized for a single connection,
   // because the default usage of QuicServer is as a test server with one or
   // two clients.  Adjust higher for use with many clients.
@@ -172,13 +185,14 @@ bool QuicServer::Listen(const IPEndPoint& address) {
 
   epoll_server_.RegisterFD(fd_, this, kEpollFlags);
   dispatcher_.reset(CreateQuicDispatcher());
-  dispatcher_->InitializeWithWriter(CreateWriter(fd_));
+  batch_writer_ = CreateWriter(fd_);
+  dispatcher_->InitializeWithWriter(batch_writer_);
 
   return true;
 }
 
-QuicDefaultPacketWriter* QuicServer::CreateWriter(int fd) {
-  return new QuicDefaultPacketWriter(fd);
+QuicBatchPacketWriter* QuicServer::CreateWriter(int fd) {
+  return new QuicBatchPacketWriter(fd);
 }
 
 QuicDispatcher* QuicServer::CreateQuicDispatcher() {
@@ -221,6 +235,13 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
             overflow_supported_ ? &packets_dropped_ : nullptr);
       }
     }
+    // Flush packets queued while dispatching this burst of reads.
+    if (batch_writer_ != nullptr && !batch_writer_->IsWriteBlocked()) {
+      batch_writer_->Flush();
+    }
+    if (batch_writer_ != nullptr && batch_writer_->HasQueuedPackets()) {
+      event->out_ready_mask |= EPOLLOUT;
+    }
   }
   if (event->in_events & EPOLLOUT) {
     dispatcher_->OnCanWrite();
@@ -19,7 +19,7 @@
 #include "net/quic/quic_connection_helper.h"
 #include "net/quic/quic_framer.h"
 #include "net/tools/epoll_server/epoll_server.h"
-#include "net/tools/quic/quic_default_packet_writer.h"
+#include "net/tools/quic/quic_batch_packet_writer.h"
 
 namespace net {
 namespace tools {
@@ -73,7 +73,7 @@ class QuicServer : public EpollCallbackInterface {
   int port() { return port_; }
 
  protected:
-  virtual QuicDefaultPacketWriter* CreateWriter(int fd);
+  virtual QuicBatchPacketWriter* CreateWriter(int fd);
 
   virtual QuicDispatcher* CreateQuicDispatcher();
 
@@ -131,6 +131,11 @@ class QuicServer : public EpollCallbackInterface {
 
   scoped_ptr<QuicPacketReader> packet_reader_;
 
+  // The writer the dispatcher sends packets through. Owned by the
+  // dispatcher; kept here so queued packets can be flushed after each burst
+  // of reads has been dispatched.
+  QuicBatchPacketWriter* batch_writer_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicServer);
 };
 
@@ -13,14 +13,23 @@
 #include "base/logging.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
 #include "net/base/ip_endpoint.h"
 #include "net/quic/crypto/proof_source_chromium.h"
 #include "net/quic/quic_protocol.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
 #include "net/tools/quic/quic_server.h"
+#include "net/tools/quic/quic_sharded_server.h"
 
 // The port the quic server will listen on.
 int32 FLAGS_port = 6121;
+// The number of server shards (threads with their own event loop and
+// SO_REUSEPORT socket) to run.
+int32 FLAGS_num_shards = 1;
+// The maximum number of memory-mapped response body files kept resident
+// when --mmap_response_bodies is set.
+int32 FLAGS_max_mapped_files = 64;
 
 net::ProofSource* CreateProofSource(const base::FilePath& cert_path,
                                     const base::FilePath& key_path) {
@@ -29,6 +38,27 @@ net::ProofSource* CreateProofSource(const base::FilePath& cert_path,
   return proof_source;
 }
 
+class ShardedServerFactory
+    : public net::tools::QuicShardedServer::ServerFactory {
+ public:
+  ShardedServerFactory(const base::FilePath& cert_path,
+                       const base::FilePath& key_path)
+      : cert_path_(cert_path), key_path_(key_path) {}
+
+  net::tools::QuicServer* CreateServer() override {
+    net::QuicConfig config;
+    net::tools::QuicServer* server = new net::tools::QuicServer(
+        CreateProofSource(cert_path_, key_path_), config,
+        net::QuicSupportedVersions());
+    server->SetStrikeRegisterNoStartupPeriod();
+    return server;
+  }
+
+ private:
+  base::FilePath cert_path_;
+  base::FilePath key_path_;
+};
+
 int main(int argc, char *argv[]) {
   base::AtExitManager exit_manager;
   base::MessageLoopForIO message_loop;
@@ -47,14 +77,33 @@ int main(int argc, char *argv[]) {
         "Options:\n"
         "-h, --help                  show this help message and exit\n"
         "--port=<port>               specify the port to listen on\n"
+        "--num_shards=<n>            number of server threads, each with\n"
+        "                            its own event loop and socket\n"
         "--quic_in_memory_cache_dir  directory containing response data\n"
         "                            to load\n"
+        "--mmap_response_bodies      leave response bodies on disk and\n"
+        "                            memory-map them on demand\n"
+        "--max_mapped_files=<n>      mapped body files kept resident\n"
         "--certificate_file=<file>   path to the certificate chain\n"
         "--key_file=<file>           path to the pkcs8 private key\n";
     std::cout << help_str;
     exit(0);
   }
 
+  if (line->HasSwitch("max_mapped_files")) {
+    if (!base::StringToInt(line->GetSwitchValueASCII("max_mapped_files"),
+                           &FLAGS_max_mapped_files) ||
+        FLAGS_max_mapped_files < 1) {
+      LOG(ERROR) << "--max_mapped_files must be a positive integer\n";
+      return 1;
+    }
+  }
+
+  if (line->HasSwitch("mmap_response_bodies")) {
+    net::tools::QuicInMemoryCache::GetInstance()->EnableFileBackedBodies(
+        FLAGS_max_mapped_files);
+  }
+
   if (line->HasSwitch("quic_in_memory_cache_dir")) {
     net::tools::QuicInMemoryCache::GetInstance()->InitializeFromDirectory(
         line->GetSwitchValueASCII("quic_in_memory_cache_dir"));
@@ -67,6 +116,15 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (line->HasSwitch("num_shards")) {
+    if (!base::StringToInt(line->GetSwitchValueASCII("num_shards"),
+                           &FLAGS_num_shards) ||
+        FLAGS_num_shards < 1) {
+      LOG(ERROR) << "--num_shards must be a positive integer\n";
+      return 1;
+    }
+  }
+
   if (!line->HasSwitch("certificate_file")) {
     LOG(ERROR) << "missing --certificate_file";
     return 1;
@@ -80,6 +138,20 @@ int main(int argc, char *argv[]) {
   net::IPAddressNumber ip;
   CHECK(net::ParseIPLiteralToNumber("::", &ip));
 
+  if (FLAGS_num_shards > 1) {
+    net::tools::QuicShardedServer sharded_server(
+        new ShardedServerFactory(line->GetSwitchValuePath("certificate_file"),
+                                 line->GetSwitchValuePath("key_file")),
+        FLAGS_num_shards);
+    if (!sharded_server.Listen(net::IPEndPoint(ip, FLAGS_port))) {
+      return 1;
+    }
+    // The shard threads do all the work; park the main thread.
+    while (1) {
+      base::PlatformThread::Sleep(base::TimeDelta::FromSeconds(1));
+    }
+  }
+
   net::QuicConfig config;
   net::tools::QuicServer server(
       CreateProofSource(line->GetSwitchValuePath("certificate_file"),
@@ -0,0 +1,82 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_sharded_server.h"
+
+#include "base/logging.h"
+#include "base/stl_util.h"
+
+namespace net {
+namespace tools {
+
+QuicShardedServer::Shard::Shard(QuicServer* server)
+    : base::SimpleThread("quic_server_shard"), server_(server) {}
+
+QuicShardedServer::Shard::~Shard() {}
+
+bool QuicShardedServer::Shard::Listen(const IPEndPoint& address) {
+  return server_->Listen(address);
+}
+
+void QuicShardedServer::Shard::Run() {
+  // WaitForEvents() returns at least every 50ms, so the quit flag is
+  // observed promptly.
+  while (!quit_.IsSet()) {
+    server_->WaitForEvents();
+  }
+  server_->Shutdown();
+}
+
+void QuicShardedServer::Shard::Quit() {
+  quit_.Set();
+}
+
+QuicShardedServer::QuicShardedServer(ServerFactory* server_factory,
+                                     size_t num_shards)
+    : server_factory_(server_factory), num_shards_(num_shards), port_(0) {
+  DCHECK_LT(0u, num_shards);
+}
+
+QuicShardedServer::~QuicShardedServer() {
+  Shutdown();
+  STLDeleteElements(&shards_);
+}
+
+bool QuicShardedServer::Listen(const IPEndPoint& address) {
+  DCHECK(shards_.empty());
+  // Bind the first shard alone, so that when the port was chosen by the
+  // kernel the remaining shards can bind to the same one.
+  IPEndPoint shard_address = address;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    Shard* shard = new Shard(server_factory_->CreateServer());
+    shards_.push_back(shard);
+    if (!shard->Listen(shard_address)) {
+      LOG(ERROR) << "Shard " << i << " failed to listen on "
+                 << shard_address.ToString();
+      return false;
+    }
+    if (i == 0) {
+      port_ = shard->server()->port();
+      shard_address = IPEndPoint(address.address(), port_);
+    }
+  }
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i]->Start();
+  }
+  return true;
+}
+
+void QuicShardedServer::Shutdown() {
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i]->Quit();
+  }
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (shards_[i]->HasBeenStarted() && !shards_[i]->HasBeenJoined()) {
+      shards_[i]->Join();
+    }
+  }
+}
+
+}  // namespace tools
+}  // namespace net
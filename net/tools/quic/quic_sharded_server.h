@@ -0,0 +1,96 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Runs several QuicServer shards in one process, one per thread. Each shard
+// owns its own EpollServer, dispatcher and SO_REUSEPORT socket bound to the
+// same address, so the kernel spreads incoming flows across the shards and a
+// multi-core machine is no longer limited to a single event loop thread.
+
+#ifndef NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
+#define NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "base/threading/simple_thread.h"
+#include "net/base/ip_endpoint.h"
+#include "net/tools/quic/quic_server.h"
+
+namespace net {
+namespace tools {
+
+class QuicShardedServer {
+ public:
+  // Creates the server each shard runs. Called once per shard from the
+  // thread calling Listen(); the sharded server owns the returned servers.
+  class ServerFactory {
+   public:
+    virtual ~ServerFactory() {}
+    virtual QuicServer* CreateServer() = 0;
+  };
+
+  // Takes ownership of |server_factory|.
+  QuicShardedServer(ServerFactory* server_factory, size_t num_shards);
+  ~QuicShardedServer();
+
+  // Binds every shard to |address| and starts the shard threads. Returns
+  // false if any shard fails to bind.
+  bool Listen(const IPEndPoint& address);
+
+  // Signals every shard thread to drain its sessions and joins them.
+  void Shutdown();
+
+  // The port the shards are listening on; valid after Listen().
+  int port() const { return port_; }
+
+  size_t num_shards() const { return shards_.size(); }
+
+ private:
+  // A shard's thread runs its server's event loop until told to quit; the
+  // server is only ever touched from this thread once it starts, so the
+  // shards share no state and need no locks.
+  class Shard : public base::SimpleThread {
+   public:
+    explicit Shard(QuicServer* server);
+    ~Shard() override;
+
+    // Binds this shard's socket; called before the thread starts.
+    bool Listen(const IPEndPoint& address);
+
+    // base::SimpleThread
+    void Run() override;
+
+    // Signals Run() to shut the server down and return. May be called from
+    // any thread.
+    void Quit();
+
+    QuicServer* server() { return server_.get(); }
+
+   private:
+    scoped_ptr<QuicServer> server_;
+    base::CancellationFlag quit_;
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  scoped_ptr<ServerFactory> server_factory_;
+
+  // The shards, owned by this class. Empty until Listen() is called.
+  std::vector<Shard*> shards_;
+
+  // Number of shards to create in Listen().
+  const size_t num_shards_;
+
+  // The port the shards are bound to.
+  int port_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicShardedServer);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
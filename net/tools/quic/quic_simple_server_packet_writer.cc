@@ -4,6 +4,8 @@
 
 #include "net/tools/quic/quic_simple_server_packet_writer.h"
 
+#include <string.h>
+
 #include "base/callback_helpers.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -68,8 +70,8 @@ WriteResult QuicSimpleServerPacketWriter::WritePacket(
     size_t buf_len,
     const IPAddressNumber& self_address,
     const IPEndPoint& peer_address) {
-  scoped_refptr<StringIOBuffer> buf(
-      new StringIOBuffer(std::string(buffer, buf_len)));
+  scoped_refptr<IOBuffer> buf = buffer_pool_.Acquire(buf_len);
+  memcpy(buf->data(), buffer, buf_len);
   DCHECK(!IsWriteBlocked());
   DCHECK(!callback_.is_null());
   int rv;
@@ -10,6 +10,7 @@
 #include "base/memory/weak_ptr.h"
 #include "net/base/ip_endpoint.h"
 #include "net/quic/quic_connection.h"
+#include "net/quic/quic_packet_buffer_pool.h"
 #include "net/quic/quic_packet_writer.h"
 #include "net/quic/quic_protocol.h"
 
@@ -68,6 +69,10 @@ class QuicSimpleServerPacketWriter : public QuicPacketWriter {
   // Whether a write is currently in flight.
   bool write_blocked_;
 
+  // Reusable buffers the serialized packets are copied into before being
+  // handed to the socket.
+  QuicPacketBufferPool buffer_pool_;
+
   base::WeakPtrFactory<QuicSimpleServerPacketWriter> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicSimpleServerPacketWriter);
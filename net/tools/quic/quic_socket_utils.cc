@@ -19,9 +19,29 @@
 #define SO_RXQ_OVFL 40
 #endif
 
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+#define MMSG_MORE 0
+
+// TODO: Enable once the kernels on our servers expose UDP_SEGMENT.
+#define UDP_SEGMENTATION_OFFLOAD 0
+
 namespace net {
 namespace tools {
 
+BufferedWrite::BufferedWrite(const char* buffer,
+                             size_t buf_len,
+                             const IPAddressNumber& self_address,
+                             const IPEndPoint& peer_address)
+    : buffer(buffer),
+      buf_len(buf_len),
+      self_address(self_address),
+      peer_address(peer_address) {}
+
+BufferedWrite::~BufferedWrite() {}
+
 // static
 IPAddressNumber QuicSocketUtils::GetAddressFromMsghdr(struct msghdr* hdr) {
   if (hdr->msg_controllen > 0) {
@@ -95,6 +115,16 @@ bool QuicSocketUtils::SetReceiveBufferSize(int fd, size_t size) {
   return true;
 }
 
+// static
+bool QuicSocketUtils::SetBusyPoll(int fd, int busy_poll_in_us) {
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_in_us,
+                 sizeof(busy_poll_in_us)) != 0) {
+    DLOG(WARNING) << "Socket busy polling not supported";
+    return false;
+  }
+  return true;
+}
+
 // static
 int QuicSocketUtils::ReadPacket(int fd, char* buffer, size_t buf_len,
                                 QuicPacketCount* dropped_packets,
@@ -219,5 +249,161 @@ WriteResult QuicSocketUtils::WritePacket(int fd,
       WRITE_STATUS_BLOCKED : WRITE_STATUS_ERROR, errno);
 }
 
+// static
+WriteResult QuicSocketUtils::WriteMultiplePackets(
+    int fd,
+    const std::vector<BufferedWrite>& buffered_writes,
+    int* num_packets_sent) {
+  *num_packets_sent = 0;
+  if (buffered_writes.empty()) {
+    return WriteResult(WRITE_STATUS_OK, 0);
+  }
+#if MMSG_MORE
+  const size_t kCmsgSpace = CMSG_SPACE(sizeof(in6_pktinfo));
+  const size_t num_packets = buffered_writes.size();
+  std::vector<mmsghdr> mmsg_hdr(num_packets);
+  std::vector<iovec> iov(num_packets);
+  std::vector<sockaddr_storage> raw_address(num_packets);
+  std::vector<char> cbuf(num_packets * kCmsgSpace, 0);
+  for (size_t i = 0; i < num_packets; ++i) {
+    const BufferedWrite& buffered = buffered_writes[i];
+    iov[i].iov_base = const_cast<char*>(buffered.buffer);
+    iov[i].iov_len = buffered.buf_len;
+
+    socklen_t address_len = sizeof(raw_address[i]);
+    CHECK(buffered.peer_address.ToSockAddr(
+        reinterpret_cast<struct sockaddr*>(&raw_address[i]), &address_len));
+
+    msghdr* hdr = &mmsg_hdr[i].msg_hdr;
+    hdr->msg_name = &raw_address[i];
+    hdr->msg_namelen = address_len;
+    hdr->msg_iov = &iov[i];
+    hdr->msg_iovlen = 1;
+    hdr->msg_flags = 0;
+    if (buffered.self_address.empty()) {
+      hdr->msg_control = nullptr;
+      hdr->msg_controllen = 0;
+    } else {
+      hdr->msg_control = &cbuf[i * kCmsgSpace];
+      hdr->msg_controllen = kCmsgSpace;
+      cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+      SetIpInfoInCmsg(buffered.self_address, cmsg);
+      hdr->msg_controllen = cmsg->cmsg_len;
+    }
+  }
+
+  int rc = sendmmsg(fd, &mmsg_hdr[0], num_packets, 0);
+  if (rc > 0) {
+    *num_packets_sent = rc;
+    int bytes_written = 0;
+    for (int i = 0; i < rc; ++i) {
+      bytes_written += mmsg_hdr[i].msg_len;
+    }
+    return WriteResult(WRITE_STATUS_OK, bytes_written);
+  }
+  return WriteResult((errno == EAGAIN || errno == EWOULDBLOCK)
+                         ? WRITE_STATUS_BLOCKED
+                         : WRITE_STATUS_ERROR,
+                     errno);
+#else
+  int bytes_written = 0;
+  for (size_t i = 0; i < buffered_writes.size(); ++i) {
+    const BufferedWrite& buffered = buffered_writes[i];
+    WriteResult result = WritePacket(fd, buffered.buffer, buffered.buf_len,
+                                     buffered.self_address,
+                                     buffered.peer_address);
+    if (result.status != WRITE_STATUS_OK) {
+      return result;
+    }
+    ++*num_packets_sent;
+    bytes_written += result.bytes_written;
+  }
+  return WriteResult(WRITE_STATUS_OK, bytes_written);
+#endif
+}
+
+// static
+bool QuicSocketUtils::HasUdpSegmentationOffload() {
+#if UDP_SEGMENTATION_OFFLOAD
+  return true;
+#else
+  return false;
+#endif
+}
+
+// static
+WriteResult QuicSocketUtils::WriteSegmentedPackets(
+    int fd,
+    const char* buffer,
+    size_t buf_len,
+    size_t segment_size,
+    const IPAddressNumber& self_address,
+    const IPEndPoint& peer_address,
+    int* num_packets_sent) {
+  DCHECK_GT(segment_size, 0u);
+  *num_packets_sent = 0;
+  if (buf_len == 0) {
+    return WriteResult(WRITE_STATUS_OK, 0);
+  }
+#if UDP_SEGMENTATION_OFFLOAD
+  sockaddr_storage raw_address;
+  socklen_t address_len = sizeof(raw_address);
+  CHECK(peer_address.ToSockAddr(reinterpret_cast<struct sockaddr*>(&raw_address),
+                                &address_len));
+  iovec iov = {const_cast<char*>(buffer), buf_len};
+
+  msghdr hdr;
+  hdr.msg_name = &raw_address;
+  hdr.msg_namelen = address_len;
+  hdr.msg_iov = &iov;
+  hdr.msg_iovlen = 1;
+  hdr.msg_flags = 0;
+
+  const int kSpaceForIp = CMSG_SPACE(sizeof(in6_pktinfo));
+  const int kSpaceForSegment = CMSG_SPACE(sizeof(uint16));
+  char cbuf[kSpaceForIp + kSpaceForSegment];
+  memset(cbuf, 0, arraysize(cbuf));
+  hdr.msg_control = cbuf;
+  hdr.msg_controllen = arraysize(cbuf);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+  *reinterpret_cast<uint16*>(CMSG_DATA(cmsg)) =
+      static_cast<uint16>(segment_size);
+  size_t controllen = CMSG_SPACE(sizeof(uint16));
+  if (!self_address.empty()) {
+    cmsg = CMSG_NXTHDR(&hdr, cmsg);
+    size_t info_len = SetIpInfoInCmsg(self_address, cmsg);
+    controllen += CMSG_SPACE(info_len);
+  }
+  hdr.msg_controllen = controllen;
+
+  int rc = sendmsg(fd, &hdr, 0);
+  if (rc >= 0) {
+    *num_packets_sent =
+        static_cast<int>((rc + segment_size - 1) / segment_size);
+    return WriteResult(WRITE_STATUS_OK, rc);
+  }
+  return WriteResult((errno == EAGAIN || errno == EWOULDBLOCK)
+                         ? WRITE_STATUS_BLOCKED
+                         : WRITE_STATUS_ERROR,
+                     errno);
+#else
+  // No kernel segmentation support: cut the train into its segments and
+  // batch them with a single sendmmsg() call instead.
+  std::vector<BufferedWrite> writes;
+  writes.reserve((buf_len + segment_size - 1) / segment_size);
+  for (size_t offset = 0; offset < buf_len; offset += segment_size) {
+    const size_t length =
+        (buf_len - offset < segment_size) ? buf_len - offset : segment_size;
+    writes.push_back(
+        BufferedWrite(buffer + offset, length, self_address, peer_address));
+  }
+  return WriteMultiplePackets(fd, writes, num_packets_sent);
+#endif
+}
+
 }  // namespace tools
 }  // namespace net
@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <sys/socket.h>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "net/base/ip_endpoint.h"
@@ -19,6 +20,21 @@
 namespace net {
 namespace tools {
 
+// A packet ready to be written to the wire, queued for a batched
+// sendmmsg() call. Does not own |buffer|.
+struct BufferedWrite {
+  BufferedWrite(const char* buffer,
+                size_t buf_len,
+                const IPAddressNumber& self_address,
+                const IPEndPoint& peer_address);
+  ~BufferedWrite();
+
+  const char* buffer;
+  size_t buf_len;
+  IPAddressNumber self_address;
+  IPEndPoint peer_address;
+};
+
 class QuicSocketUtils {
  public:
   // If the msghdr contains IP_PKTINFO or IPV6_PKTINFO, this will return the
@@ -41,6 +57,11 @@ class QuicSocketUtils {
   // Sets the receive buffer size to |size| and returns false if it fails.
   static bool SetReceiveBufferSize(int fd, size_t size);
 
+  // Asks the kernel to busy poll the device queue for up to |busy_poll_in_us|
+  // microseconds on blocking receives (SO_BUSY_POLL), trading CPU for lower
+  // wakeup latency.  Returns false if the kernel does not support it.
+  static bool SetBusyPoll(int fd, int busy_poll_in_us);
+
   // Reads buf_len from the socket.  If reading is successful, returns bytes
   // read and sets peer_address to the peer address.  Otherwise returns -1.
   //
@@ -67,6 +88,35 @@ class QuicSocketUtils {
                                  const IPAddressNumber& self_address,
                                  const IPEndPoint& peer_address);
 
+  // Writes the packets in |buffered_writes| to the socket, using a single
+  // sendmmsg() call where the kernel supports it and one sendmsg() call per
+  // packet otherwise. Stops at the first blocked or failed write. Sets
+  // |*num_packets_sent| to the number of packets the kernel accepted, and
+  // returns WRITE_STATUS_OK with the total bytes written if every packet was
+  // sent, or the status of the write which stopped the batch.
+  static WriteResult WriteMultiplePackets(
+      int fd,
+      const std::vector<BufferedWrite>& buffered_writes,
+      int* num_packets_sent);
+
+  // Returns true if the kernel can segment one large UDP write into
+  // MTU-sized packets on the wire (UDP generic segmentation offload).
+  static bool HasUdpSegmentationOffload();
+
+  // Writes a train of packets stored contiguously in |buffer|, where every
+  // packet is |segment_size| bytes except for a possibly shorter final one,
+  // as a single segmented write which the kernel cuts into individual
+  // packets. Falls back to one sendmmsg() call over the segments when
+  // segmentation offload is unavailable. Sets |*num_packets_sent| and
+  // returns a result as WriteMultiplePackets() does.
+  static WriteResult WriteSegmentedPackets(int fd,
+                                           const char* buffer,
+                                           size_t buf_len,
+                                           size_t segment_size,
+                                           const IPAddressNumber& self_address,
+                                           const IPEndPoint& peer_address,
+                                           int* num_packets_sent);
+
   // A helper for WritePacket which fills in the cmsg with the supplied self
   // address.
   // Returns the length of the packet info structure used.
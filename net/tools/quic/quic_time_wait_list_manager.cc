@@ -5,6 +5,7 @@
 #include "net/tools/quic/quic_time_wait_list_manager.h"
 
 #include <errno.h>
+#include <string.h>
 
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -25,6 +26,16 @@ using base::StringPiece;
 namespace net {
 namespace tools {
 
+namespace {
+
+// A counting Bloom filter slot that reaches this value sticks there, since
+// it may be shared by more additions than it can count.
+const uint8 kFilterSlotSaturated = 0xff;
+
+}  // namespace
+
+const size_t QuicTimeWaitListManager::kTimeWaitFilterSize;
+
 // A very simple alarm that just informs the QuicTimeWaitListManager to clean
 // up old connection_ids. This alarm should be cancelled  and deleted before
 // the QuicTimeWaitListManager is deleted.
@@ -88,6 +99,7 @@ QuicTimeWaitListManager::QuicTimeWaitListManager(
       clock_(helper->GetClock()),
       writer_(writer),
       visitor_(visitor) {
+  memset(time_wait_filter_, 0, sizeof(time_wait_filter_));
   SetConnectionIdCleanUpAlarm();
 }
 
@@ -118,16 +130,30 @@ void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
     num_packets = it->second.num_packets;
     STLDeleteElements(&it->second.termination_packets);
     connection_id_map_.erase(it);
+    RemoveFromFilter(connection_id);
   }
   TrimTimeWaitListIfNeeded();
   DCHECK_LT(num_connections(),
             static_cast<size_t>(FLAGS_quic_time_wait_list_max_connections));
-  ConnectionIdData data(num_packets, version, clock_->ApproximateNow(),
+  const QuicTime time_added = clock_->ApproximateNow();
+  ConnectionIdData data(num_packets, version, time_added,
                         connection_rejected_statelessly);
   if (termination_packets != nullptr) {
     data.termination_packets.swap(*termination_packets);
   }
   connection_id_map_.insert(std::make_pair(connection_id, data));
+  AddToFilter(connection_id);
+
+  // File the connection id in the expiry wheel bucket for its add tick. A
+  // clock that stands still (or steps backwards) reuses the newest bucket
+  // so that buckets stay in tick order.
+  const int64 tick = time_added.Subtract(QuicTime::Zero()).ToSeconds();
+  if (expiry_buckets_.empty() || expiry_buckets_.back().tick < tick) {
+    expiry_buckets_.push_back(ExpiryBucket(tick));
+  }
+  expiry_buckets_.back().entries.push_back(
+      std::make_pair(connection_id, time_added));
+
   if (new_connection_id) {
     visitor_->OnConnectionAddedToTimeWaitList(connection_id);
   }
@@ -135,9 +161,51 @@ void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
 
 bool QuicTimeWaitListManager::IsConnectionIdInTimeWait(
     QuicConnectionId connection_id) const {
+  if (!MightBeInTimeWait(connection_id)) {
+    // The filter has no false negatives.
+    return false;
+  }
   return ContainsKey(connection_id_map_, connection_id);
 }
 
+void QuicTimeWaitListManager::GetFilterIndices(QuicConnectionId connection_id,
+                                               size_t indices[2]) const {
+  const uint64 hash = QuicUtils::FNV1a_64_Hash(
+      reinterpret_cast<const char*>(&connection_id), sizeof(connection_id));
+  indices[0] = hash % kTimeWaitFilterSize;
+  indices[1] = (hash >> 32) % kTimeWaitFilterSize;
+}
+
+void QuicTimeWaitListManager::AddToFilter(QuicConnectionId connection_id) {
+  size_t indices[2];
+  GetFilterIndices(connection_id, indices);
+  for (size_t i = 0; i < arraysize(indices); ++i) {
+    if (time_wait_filter_[indices[i]] != kFilterSlotSaturated) {
+      ++time_wait_filter_[indices[i]];
+    }
+  }
+}
+
+void QuicTimeWaitListManager::RemoveFromFilter(
+    QuicConnectionId connection_id) {
+  size_t indices[2];
+  GetFilterIndices(connection_id, indices);
+  for (size_t i = 0; i < arraysize(indices); ++i) {
+    if (time_wait_filter_[indices[i]] != 0 &&
+        time_wait_filter_[indices[i]] != kFilterSlotSaturated) {
+      --time_wait_filter_[indices[i]];
+    }
+  }
+}
+
+bool QuicTimeWaitListManager::MightBeInTimeWait(
+    QuicConnectionId connection_id) const {
+  size_t indices[2];
+  GetFilterIndices(connection_id, indices);
+  return time_wait_filter_[indices[0]] != 0 &&
+         time_wait_filter_[indices[1]] != 0;
+}
+
 QuicVersion QuicTimeWaitListManager::GetQuicVersionFromConnectionId(
     QuicConnectionId connection_id) {
   ConnectionIdMap::iterator it = connection_id_map_.find(connection_id);
@@ -263,9 +331,8 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
 void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
   connection_id_clean_up_alarm_->Cancel();
   QuicTime::Delta next_alarm_interval = QuicTime::Delta::Zero();
-  if (!connection_id_map_.empty()) {
-    QuicTime oldest_connection_id =
-        connection_id_map_.begin()->second.time_added;
+  QuicTime oldest_connection_id = QuicTime::Zero();
+  if (GetOldestConnectionTime(&oldest_connection_id)) {
     QuicTime now = clock_->ApproximateNow();
     if (now.Subtract(oldest_connection_id) < time_wait_period_) {
       next_alarm_interval =
@@ -282,23 +349,58 @@ void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
       clock_->ApproximateNow().Add(next_alarm_interval));
 }
 
+bool QuicTimeWaitListManager::GetOldestConnectionTime(
+    QuicTime* oldest_time_added) {
+  while (!expiry_buckets_.empty()) {
+    ExpiryBucket& bucket = expiry_buckets_.front();
+    while (bucket.index < bucket.entries.size()) {
+      const std::pair<QuicConnectionId, QuicTime>& entry =
+          bucket.entries[bucket.index];
+      ConnectionIdMap::iterator it = connection_id_map_.find(entry.first);
+      if (it == connection_id_map_.end() ||
+          it->second.time_added != entry.second) {
+        // Stale: the connection id was trimmed or reinserted.
+        ++bucket.index;
+        continue;
+      }
+      *oldest_time_added = entry.second;
+      return true;
+    }
+    expiry_buckets_.pop_front();
+  }
+  return false;
+}
+
 bool QuicTimeWaitListManager::MaybeExpireOldestConnection(
     QuicTime expiration_time) {
-  if (connection_id_map_.empty()) {
-    return false;
-  }
-  ConnectionIdMap::iterator it = connection_id_map_.begin();
-  QuicTime oldest_connection_id_time = it->second.time_added;
-  if (oldest_connection_id_time > expiration_time) {
-    // Too recent, don't retire.
-    return false;
+  while (!expiry_buckets_.empty()) {
+    ExpiryBucket& bucket = expiry_buckets_.front();
+    while (bucket.index < bucket.entries.size()) {
+      const std::pair<QuicConnectionId, QuicTime>& entry =
+          bucket.entries[bucket.index];
+      ConnectionIdMap::iterator it = connection_id_map_.find(entry.first);
+      if (it == connection_id_map_.end() ||
+          it->second.time_added != entry.second) {
+        // Stale: the connection id was trimmed or reinserted.
+        ++bucket.index;
+        continue;
+      }
+      if (it->second.time_added > expiration_time) {
+        // Too recent, don't retire.
+        return false;
+      }
+      // This connection_id has lived its age, retire it now.
+      ++bucket.index;
+      const QuicConnectionId connection_id = entry.first;
+      STLDeleteElements(&it->second.termination_packets);
+      connection_id_map_.erase(it);
+      RemoveFromFilter(connection_id);
+      visitor_->OnConnectionRemovedFromTimeWaitList(connection_id);
+      return true;
+    }
+    expiry_buckets_.pop_front();
   }
-  // This connection_id has lived its age, retire it now.
-  const QuicConnectionId connection_id = it->first;
-  STLDeleteElements(&it->second.termination_packets);
-  connection_id_map_.erase(it);
-  visitor_->OnConnectionRemovedFromTimeWaitList(connection_id);
-  return true;
+  return false;
 }
 
 void QuicTimeWaitListManager::CleanUpOldConnectionIds() {
@@ -333,5 +435,10 @@ QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
 
 QuicTimeWaitListManager::ConnectionIdData::~ConnectionIdData() {}
 
+QuicTimeWaitListManager::ExpiryBucket::ExpiryBucket(int64 tick)
+    : tick(tick), index(0) {}
+
+QuicTimeWaitListManager::ExpiryBucket::~ExpiryBucket() {}
+
 }  // namespace tools
 }  // namespace net
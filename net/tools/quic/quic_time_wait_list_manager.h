@@ -10,9 +10,11 @@
 #define NET_TOOLS_QUIC_QUIC_TIME_WAIT_LIST_MANAGER_H_
 
 #include <deque>
+#include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
-#include "net/base/linked_hash_map.h"
+#include "base/containers/hash_tables.h"
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_connection.h"
 #include "net/quic/quic_framer.h"
@@ -139,6 +141,22 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
   // false if the map is empty or the oldest connection has not expired.
   bool MaybeExpireOldestConnection(QuicTime expiration_time);
 
+  // Finds the add time of the oldest connection still in time wait,
+  // discarding stale expiry wheel entries along the way. Returns false if
+  // the list is empty.
+  bool GetOldestConnectionTime(QuicTime* oldest_time_added);
+
+  // Computes the two counting Bloom filter slots for |connection_id|.
+  void GetFilterIndices(QuicConnectionId connection_id,
+                        size_t indices[2]) const;
+
+  // Adds |connection_id| to / removes it from the counting Bloom filter.
+  void AddToFilter(QuicConnectionId connection_id);
+  void RemoveFromFilter(QuicConnectionId connection_id);
+
+  // Returns false iff |connection_id| is definitely not in time wait.
+  bool MightBeInTimeWait(QuicConnectionId connection_id) const;
+
   // A map from a recently closed connection_id to the number of packets
   // received after the termination of the connection bound to the
   // connection_id.
@@ -158,10 +176,40 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
     bool connection_rejected_statelessly;
   };
 
-  // linked_hash_map allows lookup by ConnectionId and traversal in add order.
-  typedef linked_hash_map<QuicConnectionId, ConnectionIdData> ConnectionIdMap;
+  // Lookup by ConnectionId is through the hash map; add (and thus expiry)
+  // order is tracked separately by the expiry wheel below.
+  typedef base::hash_map<QuicConnectionId, ConnectionIdData> ConnectionIdMap;
   ConnectionIdMap connection_id_map_;
 
+  // One tick's worth of time-wait additions, in add order. Each entry
+  // records the add time so that an entry orphaned by expiry or
+  // reinsertion can be recognized as stale and skipped when its bucket is
+  // drained.
+  struct ExpiryBucket {
+    explicit ExpiryBucket(int64 tick);
+    ~ExpiryBucket();
+
+    // The bucket's expiry wheel tick (add time in seconds).
+    int64 tick;
+    // The first entry not yet examined for expiry.
+    size_t index;
+    std::vector<std::pair<QuicConnectionId, QuicTime> > entries;
+  };
+
+  // The expiry wheel: buckets in tick order, oldest first. Since every
+  // connection waits for the same time_wait_period_, draining buckets from
+  // the front visits connections in expiry order without scanning the map.
+  std::deque<ExpiryBucket> expiry_buckets_;
+
+  // Counting Bloom filter over the connection ids in time wait. Gives the
+  // dispatcher's per-packet IsConnectionIdInTimeWait() lookup an O(1)
+  // negative answer without probing connection_id_map_; the map remains
+  // authoritative for positive hits. A slot that reaches the saturation
+  // value is never decremented again, which can only cause false
+  // positives.
+  static const size_t kTimeWaitFilterSize = 1 << 16;
+  uint8 time_wait_filter_[kTimeWaitFilterSize];
+
   // Pending public reset packets that need to be sent out to the client
   // when we are given a chance to write by the dispatcher.
   std::deque<QueuedPacket*> pending_packets_queue_;
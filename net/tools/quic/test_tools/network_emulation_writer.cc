@@ -0,0 +1,142 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/test_tools/network_emulation_writer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+namespace tools {
+namespace test {
+
+namespace {
+
+// All profiles use the same fixed seed so that a given test binary sees the
+// same loss, reordering and jitter pattern on every run.
+const uint64 kEmulationSeed = 0x420aeed1234abcdeull;
+
+}  // namespace
+
+NetworkEmulationProfile DatacenterProfile() {
+  NetworkEmulationProfile profile;
+  profile.name = "datacenter";
+  profile.bandwidth = QuicBandwidth::FromKBitsPerSecond(1000 * 1000);  // 1Gbps
+  profile.propagation_delay = QuicTime::Delta::FromMicroseconds(100);
+  profile.jitter = QuicTime::Delta::FromMicroseconds(50);
+  profile.loss_percentage = 0;
+  profile.reorder_percentage = 0;
+  profile.queue_bytes = 512 * 1024;
+  profile.burst_bytes = 64 * 1024;
+  return profile;
+}
+
+NetworkEmulationProfile LTEProfile() {
+  NetworkEmulationProfile profile;
+  profile.name = "lte";
+  profile.bandwidth = QuicBandwidth::FromKBitsPerSecond(12 * 1000);  // 12Mbps
+  profile.propagation_delay = QuicTime::Delta::FromMilliseconds(35);
+  profile.jitter = QuicTime::Delta::FromMilliseconds(10);
+  profile.loss_percentage = 1;
+  profile.reorder_percentage = 1;
+  profile.queue_bytes = 128 * 1024;
+  profile.burst_bytes = 32 * 1024;
+  return profile;
+}
+
+NetworkEmulationProfile TranspacificProfile() {
+  NetworkEmulationProfile profile;
+  profile.name = "transpacific";
+  profile.bandwidth = QuicBandwidth::FromKBitsPerSecond(20 * 1000);  // 20Mbps
+  profile.propagation_delay = QuicTime::Delta::FromMilliseconds(75);
+  profile.jitter = QuicTime::Delta::FromMilliseconds(5);
+  profile.loss_percentage = 0;
+  profile.reorder_percentage = 0;
+  profile.queue_bytes = 256 * 1024;
+  profile.burst_bytes = 48 * 1024;
+  return profile;
+}
+
+NetworkEmulationWriter::NetworkEmulationWriter()
+    : profile_applied_(false),
+      token_bytes_(0),
+      last_refill_(QuicTime::Zero()) {
+}
+
+NetworkEmulationWriter::~NetworkEmulationWriter() {}
+
+void NetworkEmulationWriter::ApplyProfile(
+    const NetworkEmulationProfile& profile) {
+  DCHECK(clock());
+  profile_ = profile;
+
+  set_seed(kEmulationSeed);
+  jitter_random_.set_seed(kEmulationSeed);
+
+  // The bucket starts full; the first burst of a connection is unshaped.
+  token_bytes_ = profile.burst_bytes;
+  last_refill_ = clock()->ApproximateNow();
+
+  set_fake_packet_loss_percentage(profile.loss_percentage);
+  // The base delay must be set before enabling reordering; the per-packet
+  // delay (including jitter and shaping) is recomputed in WritePacket().
+  set_fake_packet_delay(profile.propagation_delay);
+  if (profile.reorder_percentage > 0) {
+    set_fake_reorder_percentage(profile.reorder_percentage);
+  }
+  // Drop-tail queueing only; the rate limit is imposed by the token bucket
+  // rather than the base class' bandwidth model.
+  set_max_bandwidth_and_buffer_size(QuicBandwidth::Zero(),
+                                    profile.queue_bytes);
+
+  profile_applied_ = true;
+  VLOG(1) << "Applied network emulation profile '" << profile.name << "'";
+}
+
+WriteResult NetworkEmulationWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const IPAddressNumber& self_address,
+    const IPEndPoint& peer_address) {
+  if (!profile_applied_) {
+    return PacketDroppingTestWriter::WritePacket(buffer, buf_len, self_address,
+                                                 peer_address);
+  }
+
+  QuicTime::Delta delay = profile_.propagation_delay;
+  delay = delay.Add(ConsumeTokens(buf_len));
+  if (!profile_.jitter.IsZero()) {
+    delay = delay.Add(QuicTime::Delta::FromMicroseconds(
+        jitter_random_.RandUint64() %
+        static_cast<uint64>(profile_.jitter.ToMicroseconds())));
+  }
+  set_fake_packet_delay(delay);
+
+  return PacketDroppingTestWriter::WritePacket(buffer, buf_len, self_address,
+                                               peer_address);
+}
+
+QuicTime::Delta NetworkEmulationWriter::ConsumeTokens(size_t buf_len) {
+  QuicTime now = clock()->ApproximateNow();
+  if (now > last_refill_) {
+    int64 refill_bytes =
+        (profile_.bandwidth.ToBytesPerSecond() *
+         now.Subtract(last_refill_).ToMicroseconds()) / kNumMicrosPerSecond;
+    token_bytes_ = std::min<int64>(
+        token_bytes_ + refill_bytes, profile_.burst_bytes);
+    last_refill_ = now;
+  }
+  token_bytes_ -= buf_len;
+  if (token_bytes_ >= 0) {
+    return QuicTime::Delta::Zero();
+  }
+  // The deficit is the backlog already admitted to the link; this packet is
+  // transmitted once the bucket would have refilled past zero.
+  return profile_.bandwidth.TransferTime(-token_bytes_);
+}
+
+}  // namespace test
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,94 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_TEST_TOOLS_NETWORK_EMULATION_WRITER_H_
+#define NET_TOOLS_QUIC_TEST_TOOLS_NETWORK_EMULATION_WRITER_H_
+
+#include "base/basictypes.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+#include "net/quic/test_tools/simple_random.h"
+#include "net/tools/quic/test_tools/packet_dropping_test_writer.h"
+
+namespace net {
+namespace tools {
+namespace test {
+
+// A description of an emulated network path.  All parameters describe one
+// direction of the path; installing a writer configured with the same profile
+// on both the client and the server emulates a symmetric link.
+struct NetworkEmulationProfile {
+  // Human readable name, used in logging and perf output.
+  const char* name;
+  // Bottleneck rate enforced by the token bucket.
+  QuicBandwidth bandwidth;
+  // One-way propagation delay added to every packet.
+  QuicTime::Delta propagation_delay;
+  // Maximum additional per-packet delay, drawn uniformly from
+  // [0, jitter) with a deterministic seed.
+  QuicTime::Delta jitter;
+  // Percentage of packets dropped at the link.
+  int32 loss_percentage;
+  // Percentage of queued packets delivered out of order.
+  int32 reorder_percentage;
+  // Drop-tail queue limit at the bottleneck.
+  QuicByteCount queue_bytes;
+  // Token bucket depth; bursts up to this many bytes pass unshaped.
+  QuicByteCount burst_bytes;
+};
+
+// Canonical profiles used by the end to end perf tests.  Keeping them here
+// rather than in the test file lets other harnesses (e.g. the load generator)
+// run against the same emulated networks.
+NetworkEmulationProfile DatacenterProfile();
+NetworkEmulationProfile LTEProfile();
+NetworkEmulationProfile TranspacificProfile();
+
+// A packet writer which emulates a network path with a deterministic
+// token-bucket rate limit plus configurable delay, jitter, loss and
+// reordering.  Loss, reordering and drop-tail queueing are delegated to
+// PacketDroppingTestWriter; this class layers the token bucket and jitter on
+// top by computing a per-packet delay before handing the packet down.
+//
+// Inbound impairment is emulated the same way the existing end to end tests
+// do it: by installing a writer configured with the peer-direction profile on
+// the other endpoint.
+class NetworkEmulationWriter : public PacketDroppingTestWriter {
+ public:
+  NetworkEmulationWriter();
+
+  ~NetworkEmulationWriter() override;
+
+  // Configures this writer from |profile|.  Must be called after
+  // Initialize(), and only while the writer is not actively used.
+  void ApplyProfile(const NetworkEmulationProfile& profile);
+
+  // QuicPacketWriter methods:
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const IPAddressNumber& self_address,
+                          const IPEndPoint& peer_address) override;
+
+ private:
+  // Consumes |buf_len| tokens and returns the shaping delay imposed by the
+  // token bucket, refilled deterministically from the clock.
+  QuicTime::Delta ConsumeTokens(size_t buf_len);
+
+  bool profile_applied_;
+  NetworkEmulationProfile profile_;
+  net::test::SimpleRandom jitter_random_;
+  // May go negative while a deficit drains; a negative balance is the byte
+  // backlog which has already been admitted but not yet "transmitted".
+  int64 token_bytes_;
+  QuicTime last_refill_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkEmulationWriter);
+};
+
+}  // namespace test
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_TEST_TOOLS_NETWORK_EMULATION_WRITER_H_
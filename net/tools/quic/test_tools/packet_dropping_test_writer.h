@@ -115,6 +115,11 @@ class PacketDroppingTestWriter : public QuicPacketWriterWrapper {
     simple_random_.set_seed(seed);
   }
 
+ protected:
+  // The clock supplied via Initialize(), or nullptr beforehand.  Exposed so
+  // subclasses (e.g. NetworkEmulationWriter) can compute their own timings.
+  const QuicClock* clock() const { return clock_; }
+
  private:
   // Writes out the next packet to the contained writer and returns the time
   // for the next delayed packet to be written.
@@ -14,6 +14,11 @@
 // To test that the disk cache doesn't generate critical errors with regular
 // application level crashes, edit stress_support.h.
 
+// Passing --benchmark selects a different mode that measures the cache
+// under concurrent load instead of crashing it; see the benchmark section
+// below for the available switches.
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -23,8 +28,11 @@
 #include "base/command_line.h"
 #include "base/debug/debugger.h"
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/format_macros.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop/message_loop.h"
 #include "base/path_service.h"
 #include "base/process/launch.h"
@@ -33,6 +41,7 @@
 #include "base/single_thread_task_runner.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread.h"
@@ -40,6 +49,7 @@
 #include "net/base/net_errors.h"
 #include "net/base/test_completion_callback.h"
 #include "net/disk_cache/blockfile/backend_impl.h"
+#include "net/disk_cache/blockfile/sharded_backend.h"
 #include "net/disk_cache/blockfile/stress_support.h"
 #include "net/disk_cache/blockfile/trace.h"
 #include "net/disk_cache/disk_cache.h"
@@ -399,6 +409,416 @@ bool MessageHandler(int severity, const char* file, int line,
 
 // -----------------------------------------------------------------------
 
+// Benchmark mode.
+//
+// --benchmark runs a fixed number of cache operations against one cache and
+// reports per-operation latency distributions and aggregate throughput,
+// instead of looping until a crash. The blockfile cache is not multi-process
+// safe, and a backend can only be driven from the thread that created it
+// (completions are posted back to that thread), so contention is generated
+// with N concurrent client streams on one client thread: every stream keeps
+// one composite operation outstanding at all times, which keeps the cache
+// threads of a sharded backend busy in parallel and gives the per-task
+// operation batching real batches to merge.
+//
+// Switches:
+//   --benchmark        select this mode.
+//   --clients=N        concurrent operation streams (default 16).
+//   --shards=N         use a sharded backend with N shards (default: plain
+//                      blockfile backend).
+//   --ops=N            composite operations to run (default 100000).
+//   --keys=N           distinct keys in the working set (default 5000).
+//   --write-percent=N  percentage of operations that write (default 30).
+//   --doom-percent=N   percentage of operations that doom (default 5).
+//                      The remaining operations read.
+//   --entry-size=N     bytes written or read per operation (default 4096).
+//   --cache-size-mb=N  maximum cache size (default 32).
+
+const char kBenchmarkSwitch[] = "benchmark";
+
+struct BenchmarkConfig {
+  BenchmarkConfig()
+      : clients(16),
+        shards(0),
+        ops(100000),
+        keys(5000),
+        write_percent(30),
+        doom_percent(5),
+        entry_size(4096),
+        cache_size_mb(32) {}
+
+  int clients;
+  int shards;
+  int ops;
+  int keys;
+  int write_percent;
+  int doom_percent;
+  int entry_size;
+  int cache_size_mb;
+};
+
+// Reads --|name|=value into |*value|, leaving the default in place when the
+// switch is absent.
+void ReadIntSwitch(const base::CommandLine& command_line,
+                   const char* name,
+                   int* value) {
+  if (!command_line.HasSwitch(name))
+    return;
+  int parsed;
+  if (base::StringToInt(command_line.GetSwitchValueASCII(name), &parsed))
+    *value = parsed;
+}
+
+// Collects the latencies of one kind of backend operation and prints their
+// distribution.
+class LatencyRecorder {
+ public:
+  LatencyRecorder() {}
+
+  void Add(base::TimeDelta sample) {
+    samples_.push_back(sample.InMicroseconds());
+  }
+
+  void Report(const char* name) {
+    if (samples_.empty())
+      return;
+    std::sort(samples_.begin(), samples_.end());
+    printf("%-8s %8" PRIuS " ops   min %6" PRId64 " us   p50 %6" PRId64
+           " us   p90 %6" PRId64 " us   p99 %6" PRId64 " us   max %6" PRId64
+           " us\n",
+           name, samples_.size(), samples_.front(), Percentile(50),
+           Percentile(90), Percentile(99), samples_.back());
+  }
+
+ private:
+  // Valid only after the sort in Report().
+  int64 Percentile(int percent) const {
+    size_t index = samples_.size() * percent / 100;
+    return samples_[std::min(index, samples_.size() - 1)];
+  }
+
+  std::vector<int64> samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyRecorder);
+};
+
+// State shared by all benchmark clients.
+struct BenchmarkData {
+  BenchmarkData() : cache(nullptr), remaining_ops(0), running_clients(0) {}
+
+  BenchmarkConfig config;
+  disk_cache::Backend* cache;
+  int remaining_ops;    // Composite operations not started yet.
+  int running_clients;  // Clients that have not reached Finish() yet.
+  std::vector<std::string> keys;
+  LatencyRecorder open_latency;
+  LatencyRecorder create_latency;
+  LatencyRecorder read_latency;
+  LatencyRecorder write_latency;
+  LatencyRecorder doom_latency;
+  base::Closure all_done;
+};
+
+BenchmarkData* g_benchmark = nullptr;
+
+// One client stream. A stream runs one composite operation at a time: a
+// doom, a read (open + read data) or a write (open or create + write data),
+// chosen by the configured mix, and times every backend call from issue to
+// completion. During the populate phase the stream instead writes each key
+// of its slice once, untimed, so the measured phase runs against a warm
+// cache.
+class BenchmarkClient {
+ public:
+  BenchmarkClient() : entry_(nullptr), writing_(false), populate_key_(0),
+                      populate_end_(0) {
+    buffer_ = new net::IOBuffer(g_benchmark->config.entry_size);
+    memset(buffer_->data(), 'b', g_benchmark->config.entry_size);
+  }
+
+  // Writes every key in [first_key, last_key) once, then finishes.
+  void Populate(int first_key, int last_key) {
+    populate_key_ = first_key;
+    populate_end_ = last_key;
+    PopulateNext();
+  }
+
+  // Runs composite operations until the shared budget is exhausted.
+  void Start() { NextOp(); }
+
+ private:
+  void PopulateNext() {
+    if (populate_key_ == populate_end_)
+      return Finish();
+    int rv = g_benchmark->cache->CreateEntry(
+        g_benchmark->keys[populate_key_++], &entry_,
+        base::Bind(&BenchmarkClient::OnPopulateCreateDone,
+                   base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnPopulateCreateDone(rv);
+  }
+
+  void OnPopulateCreateDone(int result) {
+    CHECK_EQ(net::OK, result);
+    int rv = entry_->WriteData(
+        0, 0, buffer_.get(), g_benchmark->config.entry_size,
+        base::Bind(&BenchmarkClient::OnPopulateWriteDone,
+                   base::Unretained(this)),
+        true);
+    if (rv != net::ERR_IO_PENDING)
+      OnPopulateWriteDone(rv);
+  }
+
+  void OnPopulateWriteDone(int result) {
+    CHECK_EQ(g_benchmark->config.entry_size, result);
+    entry_->Close();
+    entry_ = nullptr;
+    // Post instead of recursing so that a long synchronous run of
+    // completions cannot overflow the stack.
+    base::MessageLoop::current()->task_runner()->PostTask(
+        FROM_HERE,
+        base::Bind(&BenchmarkClient::PopulateNext, base::Unretained(this)));
+  }
+
+  void NextOp() {
+    if (g_benchmark->remaining_ops <= 0)
+      return Finish();
+    g_benchmark->remaining_ops--;
+
+    key_ = rand() % g_benchmark->keys.size();
+    int mix = rand() % 100;
+    if (mix < g_benchmark->config.doom_percent)
+      return DoDoom();
+    writing_ = mix < g_benchmark->config.doom_percent +
+                         g_benchmark->config.write_percent;
+    DoOpen();
+  }
+
+  void DoOpen() {
+    op_start_ = base::TimeTicks::Now();
+    int rv = g_benchmark->cache->OpenEntry(
+        g_benchmark->keys[key_], &entry_,
+        base::Bind(&BenchmarkClient::OnOpenDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnOpenDone(rv);
+  }
+
+  void OnOpenDone(int result) {
+    g_benchmark->open_latency.Add(base::TimeTicks::Now() - op_start_);
+    if (result != net::OK)
+      return DoCreate();  // The key was doomed earlier; rebuild it.
+    if (writing_)
+      return DoWrite();
+    DoRead();
+  }
+
+  void DoCreate() {
+    op_start_ = base::TimeTicks::Now();
+    int rv = g_benchmark->cache->CreateEntry(
+        g_benchmark->keys[key_], &entry_,
+        base::Bind(&BenchmarkClient::OnCreateDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnCreateDone(rv);
+  }
+
+  void OnCreateDone(int result) {
+    g_benchmark->create_latency.Add(base::TimeTicks::Now() - op_start_);
+    CHECK_EQ(net::OK, result);
+    DoWrite();
+  }
+
+  void DoRead() {
+    op_start_ = base::TimeTicks::Now();
+    int rv = entry_->ReadData(
+        0, 0, buffer_.get(), g_benchmark->config.entry_size,
+        base::Bind(&BenchmarkClient::OnReadDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnReadDone(rv);
+  }
+
+  void OnReadDone(int result) {
+    g_benchmark->read_latency.Add(base::TimeTicks::Now() - op_start_);
+    CHECK_GE(result, 0);
+    CloseAndNext();
+  }
+
+  void DoWrite() {
+    op_start_ = base::TimeTicks::Now();
+    int rv = entry_->WriteData(
+        0, 0, buffer_.get(), g_benchmark->config.entry_size,
+        base::Bind(&BenchmarkClient::OnWriteDone, base::Unretained(this)),
+        true);
+    if (rv != net::ERR_IO_PENDING)
+      OnWriteDone(rv);
+  }
+
+  void OnWriteDone(int result) {
+    g_benchmark->write_latency.Add(base::TimeTicks::Now() - op_start_);
+    CHECK_EQ(g_benchmark->config.entry_size, result);
+    CloseAndNext();
+  }
+
+  void DoDoom() {
+    op_start_ = base::TimeTicks::Now();
+    int rv = g_benchmark->cache->DoomEntry(
+        g_benchmark->keys[key_],
+        base::Bind(&BenchmarkClient::OnDoomDone, base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnDoomDone(rv);
+  }
+
+  void OnDoomDone(int result) {
+    // Dooming an already-doomed key fails; that is part of the mix.
+    g_benchmark->doom_latency.Add(base::TimeTicks::Now() - op_start_);
+    PostNextOp();
+  }
+
+  void CloseAndNext() {
+    entry_->Close();
+    entry_ = nullptr;
+    PostNextOp();
+  }
+
+  void PostNextOp() {
+    base::MessageLoop::current()->task_runner()->PostTask(
+        FROM_HERE,
+        base::Bind(&BenchmarkClient::NextOp, base::Unretained(this)));
+  }
+
+  void Finish() {
+    if (!--g_benchmark->running_clients)
+      g_benchmark->all_done.Run();
+  }
+
+  disk_cache::Entry* entry_;
+  scoped_refptr<net::IOBuffer> buffer_;
+  bool writing_;        // Whether the composite operation in flight writes.
+  int key_;             // Index of the key the operation works on.
+  base::TimeTicks op_start_;
+  int populate_key_;
+  int populate_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkClient);
+};
+
+// Creates and initializes the backend under test. Returns NULL on failure.
+// |cache_thread| must outlive the returned backend; it is only used without
+// --shards, as the sharded backend runs its own threads.
+disk_cache::Backend* CreateBenchmarkCache(const base::FilePath& path,
+                                          base::Thread* cache_thread) {
+  const BenchmarkConfig& config = g_benchmark->config;
+  int cache_size = config.cache_size_mb * 1024 * 1024;
+  net::TestCompletionCallback cb;
+
+  if (config.shards > 1) {
+    scoped_ptr<disk_cache::ShardedBackend> cache(new disk_cache::ShardedBackend(
+        path, config.shards, net::DISK_CACHE, NULL));
+    cache->SetMaxSize(cache_size);
+    int rv = cache->Init(cb.callback());
+    if (cb.GetResult(rv) != net::OK)
+      return NULL;
+    return cache.release();
+  }
+
+  scoped_ptr<disk_cache::BackendImpl> cache(new disk_cache::BackendImpl(
+      path, cache_thread->task_runner(), NULL));
+  cache->SetMaxSize(cache_size);
+  int rv = cache->Init(cb.callback());
+  if (cb.GetResult(rv) != net::OK)
+    return NULL;
+  return cache.release();
+}
+
+// Waits until all |clients| streams have called Finish().
+void RunClientsToCompletion(int clients) {
+  g_benchmark->running_clients = clients;
+  base::RunLoop run_loop;
+  g_benchmark->all_done = run_loop.QuitClosure();
+  run_loop.Run();
+}
+
+int RunBenchmark() {
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+
+  g_benchmark = new BenchmarkData();
+  BenchmarkConfig* config = &g_benchmark->config;
+  ReadIntSwitch(command_line, "clients", &config->clients);
+  ReadIntSwitch(command_line, "shards", &config->shards);
+  ReadIntSwitch(command_line, "ops", &config->ops);
+  ReadIntSwitch(command_line, "keys", &config->keys);
+  ReadIntSwitch(command_line, "write-percent", &config->write_percent);
+  ReadIntSwitch(command_line, "doom-percent", &config->doom_percent);
+  ReadIntSwitch(command_line, "entry-size", &config->entry_size);
+  ReadIntSwitch(command_line, "cache-size-mb", &config->cache_size_mb);
+  if (config->clients < 1 || config->keys < config->clients ||
+      config->write_percent + config->doom_percent > 100 ||
+      config->shards > disk_cache::ShardedBackend::kMaxShards) {
+    printf("Invalid benchmark configuration\n");
+    return kError;
+  }
+
+  base::MessageLoopForIO message_loop;
+
+  base::FilePath path;
+  PathService::Get(base::DIR_TEMP, &path);
+  path = path.AppendASCII("cache_test_benchmark");
+  base::DeleteFile(path, true);
+
+  base::Thread cache_thread("CacheThread");
+  if (!cache_thread.StartWithOptions(
+          base::Thread::Options(base::MessageLoop::TYPE_IO, 0)))
+    return kError;
+
+  g_benchmark->cache = CreateBenchmarkCache(path, &cache_thread);
+  if (!g_benchmark->cache) {
+    printf("Unable to initialize cache\n");
+    return kError;
+  }
+
+  g_benchmark->keys.reserve(config->keys);
+  for (int i = 0; i < config->keys; i++)
+    g_benchmark->keys.push_back(base::StringPrintf("key-%06d", i));
+
+  // A fixed seed keeps the operation sequence identical across runs, so
+  // numbers from different backends and revisions are comparable.
+  srand(0x5eed);
+
+  ScopedVector<BenchmarkClient> clients;
+  for (int i = 0; i < config->clients; i++)
+    clients.push_back(new BenchmarkClient());
+
+  // Populate phase: write every key once, untimed.
+  int keys_per_client = config->keys / config->clients;
+  for (int i = 0; i < config->clients; i++) {
+    int last = (i == config->clients - 1) ? config->keys
+                                          : (i + 1) * keys_per_client;
+    clients[i]->Populate(i * keys_per_client, last);
+  }
+  RunClientsToCompletion(config->clients);
+
+  // Measured phase.
+  g_benchmark->remaining_ops = config->ops;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < config->clients; i++)
+    clients[i]->Start();
+  RunClientsToCompletion(config->clients);
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  printf("%d ops, %d clients, %d shards: %.0f ops/s\n", config->ops,
+         config->clients, config->shards,
+         config->ops / elapsed.InSecondsF());
+  g_benchmark->open_latency.Report("open");
+  g_benchmark->create_latency.Report("create");
+  g_benchmark->read_latency.Report("read");
+  g_benchmark->write_latency.Report("write");
+  g_benchmark->doom_latency.Report("doom");
+
+  delete g_benchmark->cache;
+  return 0;
+}
+
+// -----------------------------------------------------------------------
+
 #if defined(OS_WIN)
 // {B9A153D4-31C3-48e4-9ABF-D54383F14A0D}
 const GUID kStressCacheTraceProviderName = {
@@ -409,6 +829,10 @@ const GUID kStressCacheTraceProviderName = {
 int main(int argc, const char* argv[]) {
   // Setup an AtExitManager so Singleton objects will be destructed.
   base::AtExitManager at_exit_manager;
+  base::CommandLine::Init(argc, argv);
+
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(kBenchmarkSwitch))
+    return RunBenchmark();
 
   if (argc < 2)
     return MasterCode();
@@ -419,7 +843,6 @@ int main(int argc, const char* argv[]) {
 #if defined(OS_WIN)
   logging::LogEventProvider::Initialize(kStressCacheTraceProviderName);
 #else
-  base::CommandLine::Init(argc, argv);
   logging::LoggingSettings settings;
   settings.logging_dest = logging::LOG_TO_SYSTEM_DEBUG_LOG;
   logging::InitLogging(settings);
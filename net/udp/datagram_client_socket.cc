@@ -0,0 +1,48 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/udp/datagram_client_socket.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+
+namespace net {
+
+namespace {
+
+// Adapts the completion of a single Read() to ReadBatch() semantics: the
+// datagram size is recorded in |results| and the result becomes a count.
+void CompleteSingleDatagramRead(std::vector<int>* results,
+                                const CompletionCallback& callback,
+                                int rv) {
+  if (rv >= 0) {
+    results->clear();
+    results->push_back(rv);
+    rv = 1;
+  }
+  callback.Run(rv);
+}
+
+}  // namespace
+
+int DatagramClientSocket::ReadBatch(
+    const std::vector<scoped_refptr<IOBuffer>>& buffers,
+    int buf_len,
+    std::vector<int>* results,
+    const CompletionCallback& callback) {
+  DCHECK(!buffers.empty());
+  DCHECK(results);
+
+  int rv = Read(buffers.front().get(), buf_len,
+                base::Bind(&CompleteSingleDatagramRead, results, callback));
+  if (rv < 0)  // Includes ERR_IO_PENDING.
+    return rv;
+  results->clear();
+  results->push_back(rv);
+  return 1;
+}
+
+}  // namespace net
@@ -5,6 +5,9 @@
 #ifndef NET_UDP_DATAGRAM_CLIENT_SOCKET_H_
 #define NET_UDP_DATAGRAM_CLIENT_SOCKET_H_
 
+#include <vector>
+
+#include "base/memory/ref_counted.h"
 #include "net/base/network_change_notifier.h"
 #include "net/socket/socket.h"
 #include "net/udp/datagram_socket.h"
@@ -37,6 +40,19 @@ class NET_EXPORT_PRIVATE DatagramClientSocket : public DatagramSocket,
   // Initialize this socket as a client socket to server at |address|.
   // Returns a network error code.
   virtual int Connect(const IPEndPoint& address) = 0;
+
+  // Reads up to |buffers.size()| datagrams from the socket in one call where
+  // the platform supports it. Each datagram is read into the corresponding
+  // entry of |buffers|, which must each have room for |buf_len| bytes, and
+  // its size is recorded in |results|. Returns the number of datagrams
+  // received, a net error code, or ERR_IO_PENDING, in which case |callback|
+  // is run later with one of the first two. The caller must keep |buffers|
+  // and |results| alive until the operation completes. The default
+  // implementation reads a single datagram with Read().
+  virtual int ReadBatch(const std::vector<scoped_refptr<IOBuffer>>& buffers,
+                        int buf_len,
+                        std::vector<int>* results,
+                        const CompletionCallback& callback);
 };
 
 }  // namespace net
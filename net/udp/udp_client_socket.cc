@@ -70,6 +70,19 @@ int UDPClientSocket::Read(IOBuffer* buf,
   return socket_.Read(buf, buf_len, callback);
 }
 
+int UDPClientSocket::ReadBatch(
+    const std::vector<scoped_refptr<IOBuffer>>& buffers,
+    int buf_len,
+    std::vector<int>* results,
+    const CompletionCallback& callback) {
+#if defined(OS_WIN)
+  // UDPSocketWin has no batch read; fall back to one datagram per call.
+  return DatagramClientSocket::ReadBatch(buffers, buf_len, results, callback);
+#else
+  return socket_.ReadBatch(buffers, buf_len, results, callback);
+#endif
+}
+
 int UDPClientSocket::Write(IOBuffer* buf,
                           int buf_len,
                           const CompletionCallback& callback) {
@@ -33,6 +33,10 @@ class NET_EXPORT_PRIVATE UDPClientSocket : public DatagramClientSocket {
   int Read(IOBuffer* buf,
            int buf_len,
            const CompletionCallback& callback) override;
+  int ReadBatch(const std::vector<scoped_refptr<IOBuffer>>& buffers,
+                int buf_len,
+                std::vector<int>* results,
+                const CompletionCallback& callback) override;
   int Write(IOBuffer* buf,
             int buf_len,
             const CompletionCallback& callback) override;
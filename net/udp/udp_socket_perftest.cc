@@ -6,12 +6,12 @@
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
-#include "base/test/perf_time_logger.h"
 #include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
 #include "net/base/test_completion_callback.h"
+#include "net/test/benchmark_reporter.h"
 #include "net/test/net_test_suite.h"
 #include "net/udp/udp_client_socket.h"
 #include "net/udp/udp_server_socket.h"
@@ -83,7 +83,8 @@ void UDPSocketPerfTest::WritePacketsToSocket(UDPClientSocket* socket,
   }
 }
 
-void UDPSocketPerfTest::WriteBenchmark(bool use_nonblocking_io) {
+void UDPSocketPerfTest::WriteBenchmark(bool use_nonblocking_io,
+                                       net::test::BenchmarkReporter* timer) {
   base::MessageLoopForIO message_loop;
   const uint16_t kPort = 9999;
 
@@ -120,18 +121,19 @@ void UDPSocketPerfTest::WriteBenchmark(bool use_nonblocking_io) {
   run_loop.Run();
 
   double elapsed = (base::TimeTicks::Now() - start_ticks).InSecondsF();
-  LOG(INFO) << "Write speed: " << packets / 1024 / elapsed << " MB/s";
+  timer->set_iterations(packets);
+  timer->SetThroughput("MB", packets / 1024 / elapsed);
 }
 
 TEST_F(UDPSocketPerfTest, Write) {
-  base::PerfTimeLogger timer("UDP_socket_write");
-  WriteBenchmark(false);
+  net::test::BenchmarkReporter timer("UDP_socket_write");
+  WriteBenchmark(false, &timer);
 }
 
 #if defined(OS_WIN)
 TEST_F(UDPSocketPerfTest, WriteNonBlocking) {
-  base::PerfTimeLogger timer("UDP_socket_write_nonblocking");
-  WriteBenchmark(true);
+  net::test::BenchmarkReporter timer("UDP_socket_write_nonblocking");
+  WriteBenchmark(true, &timer);
 }
 #endif
 
@@ -9,8 +9,12 @@
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
 
 #include "base/callback.h"
 #include "base/debug/alias.h"
@@ -42,6 +46,10 @@ const int kBindRetries = 10;
 const int kPortStart = 1024;
 const int kPortEnd = 65535;
 
+// Maximum number of datagrams transferred by one recvmmsg()/sendmmsg() call;
+// bounds the stack space used for the mmsghdr and iovec arrays.
+const size_t kMaxBatchDatagrams = 32;
+
 #if defined(OS_MACOSX)
 
 // Returns IPv4 address in network order.
@@ -81,6 +89,7 @@ UDPSocketPosix::UDPSocketPosix(DatagramSocket::BindType bind_type,
       write_watcher_(this),
       read_buf_len_(0),
       recv_from_address_(NULL),
+      read_results_(NULL),
       write_buf_len_(0),
       net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_UDP_SOCKET)) {
   net_log_.BeginEvent(NetLog::TYPE_SOCKET_ALIVE,
@@ -119,10 +128,13 @@ void UDPSocketPosix::Close() {
   // Zero out any pending read/write callback state.
   read_buf_ = NULL;
   read_buf_len_ = 0;
+  read_buf_list_.clear();
+  read_results_ = NULL;
   read_callback_.Reset();
   recv_from_address_ = NULL;
   write_buf_ = NULL;
   write_buf_len_ = 0;
+  write_buf_list_.clear();
   write_callback_.Reset();
   send_to_address_.reset();
 
@@ -223,6 +235,69 @@ int UDPSocketPosix::Write(IOBuffer* buf,
   return SendToOrWrite(buf, buf_len, NULL, callback);
 }
 
+int UDPSocketPosix::ReadBatch(
+    const std::vector<scoped_refptr<IOBuffer>>& buffers,
+    int buf_len,
+    std::vector<int>* results,
+    const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(is_connected_);
+  CHECK(read_callback_.is_null());
+  DCHECK(!recv_from_address_);
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+  DCHECK(!buffers.empty());
+  DCHECK(results);
+  DCHECK_GT(buf_len, 0);
+
+  int result = InternalReadBatch(buffers, buf_len, results);
+  if (result != ERR_IO_PENDING)
+    return result;
+
+  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+          socket_, true, base::MessageLoopForIO::WATCH_READ,
+          &read_socket_watcher_, &read_watcher_)) {
+    PLOG(ERROR) << "WatchFileDescriptor failed on read";
+    int result = MapSystemError(errno);
+    LogRead(result, NULL, 0, NULL);
+    return result;
+  }
+
+  read_buf_list_ = buffers;
+  read_buf_len_ = buf_len;
+  read_results_ = results;
+  read_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
+int UDPSocketPosix::WriteBatch(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+    const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(is_connected_);
+  CHECK(write_callback_.is_null());
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+  DCHECK(!buffers.empty());
+
+  int result = InternalWriteBatch(buffers);
+  if (result != ERR_IO_PENDING)
+    return result;
+
+  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+          socket_, true, base::MessageLoopForIO::WATCH_WRITE,
+          &write_socket_watcher_, &write_watcher_)) {
+    DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
+    int result = MapSystemError(errno);
+    LogWrite(result, NULL, NULL);
+    return result;
+  }
+
+  write_buf_list_ = buffers;
+  write_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int UDPSocketPosix::SendTo(IOBuffer* buf,
                            int buf_len,
                            const IPEndPoint& address,
@@ -441,11 +516,18 @@ void UDPSocketPosix::DoWriteCallback(int rv) {
 }
 
 void UDPSocketPosix::DidCompleteRead() {
-  int result =
-      InternalRecvFrom(read_buf_.get(), read_buf_len_, recv_from_address_);
+  int result;
+  if (!read_buf_list_.empty()) {
+    result = InternalReadBatch(read_buf_list_, read_buf_len_, read_results_);
+  } else {
+    result =
+        InternalRecvFrom(read_buf_.get(), read_buf_len_, recv_from_address_);
+  }
   if (result != ERR_IO_PENDING) {
     read_buf_ = NULL;
     read_buf_len_ = 0;
+    read_buf_list_.clear();
+    read_results_ = NULL;
     recv_from_address_ = NULL;
     bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
     DCHECK(ok);
@@ -479,12 +561,18 @@ void UDPSocketPosix::LogRead(int result,
 }
 
 void UDPSocketPosix::DidCompleteWrite() {
-  int result =
-      InternalSendTo(write_buf_.get(), write_buf_len_, send_to_address_.get());
+  int result;
+  if (!write_buf_list_.empty()) {
+    result = InternalWriteBatch(write_buf_list_);
+  } else {
+    result =
+        InternalSendTo(write_buf_.get(), write_buf_len_, send_to_address_.get());
+  }
 
   if (result != ERR_IO_PENDING) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
+    write_buf_list_.clear();
     send_to_address_.reset();
     write_socket_watcher_.StopWatchingFileDescriptor();
     DoWriteCallback(result);
@@ -565,6 +653,112 @@ int UDPSocketPosix::InternalSendTo(IOBuffer* buf,
   return result;
 }
 
+int UDPSocketPosix::InternalReadBatch(
+    const std::vector<scoped_refptr<IOBuffer>>& buffers,
+    int buf_len,
+    std::vector<int>* results) {
+// recvmmsg()/sendmmsg() are not declared by older Android NDK headers, so the
+// native batch path is Linux-only; other POSIX platforms loop over the
+// one-datagram syscalls below.
+#if defined(OS_LINUX)
+  size_t count = std::min(buffers.size(), kMaxBatchDatagrams);
+  struct iovec iov[kMaxBatchDatagrams];
+  struct mmsghdr msgs[kMaxBatchDatagrams];
+  SockaddrStorage storages[kMaxBatchDatagrams];
+  memset(msgs, 0, count * sizeof(msgs[0]));
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = buffers[i]->data();
+    iov[i].iov_len = buf_len;
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = storages[i].addr;
+    msgs[i].msg_hdr.msg_namelen = storages[i].addr_len;
+  }
+
+  int result = HANDLE_EINTR(recvmmsg(socket_, msgs, count, 0, NULL));
+  if (result < 0) {
+    result = MapSystemError(errno);
+    if (result != ERR_IO_PENDING)
+      LogRead(result, NULL, 0, NULL);
+    return result;
+  }
+
+  results->clear();
+  for (int i = 0; i < result; ++i) {
+    results->push_back(msgs[i].msg_len);
+    LogRead(msgs[i].msg_len, buffers[i]->data(), msgs[i].msg_hdr.msg_namelen,
+            storages[i].addr);
+  }
+  return result;
+#else
+  // No recvmmsg() on this platform; drain as many queued datagrams as fit
+  // in |buffers| with one recvfrom() each. Still one wakeup per batch.
+  results->clear();
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    int result = InternalRecvFrom(buffers[i].get(), buf_len, NULL);
+    if (result == ERR_IO_PENDING)
+      break;
+    if (result < 0) {
+      // Surface the error if nothing was read; otherwise deliver what we
+      // have and let the error show up on the next batch.
+      if (results->empty())
+        return result;
+      break;
+    }
+    results->push_back(result);
+  }
+  if (results->empty())
+    return ERR_IO_PENDING;
+  return static_cast<int>(results->size());
+#endif
+}
+
+int UDPSocketPosix::InternalWriteBatch(
+    const std::vector<scoped_refptr<IOBufferWithSize>>& buffers) {
+#if defined(OS_LINUX)
+  size_t count = std::min(buffers.size(), kMaxBatchDatagrams);
+  struct iovec iov[kMaxBatchDatagrams];
+  struct mmsghdr msgs[kMaxBatchDatagrams];
+  memset(msgs, 0, count * sizeof(msgs[0]));
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = buffers[i]->data();
+    iov[i].iov_len = buffers[i]->size();
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int result = HANDLE_EINTR(sendmmsg(socket_, msgs, count, 0));
+  if (result < 0) {
+    result = MapSystemError(errno);
+    if (result != ERR_IO_PENDING)
+      LogWrite(result, NULL, NULL);
+    return result;
+  }
+
+  for (int i = 0; i < result; ++i)
+    LogWrite(buffers[i]->size(), buffers[i]->data(), NULL);
+  return result;
+#else
+  // No sendmmsg() on this platform; send as many datagrams as the socket
+  // accepts with one sendto() each.
+  size_t sent = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    int result = InternalSendTo(buffers[i].get(), buffers[i]->size(), NULL);
+    if (result == ERR_IO_PENDING)
+      break;
+    if (result < 0) {
+      if (sent == 0)
+        return result;
+      break;
+    }
+    ++sent;
+  }
+  if (sent == 0)
+    return ERR_IO_PENDING;
+  return static_cast<int>(sent);
+#endif
+}
+
 int UDPSocketPosix::SetMulticastOptions() {
   if (!(socket_options_ & SOCKET_OPTION_MULTICAST_LOOP)) {
     int rv;
@@ -7,6 +7,8 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop/message_loop.h"
@@ -79,6 +81,28 @@ class NET_EXPORT UDPSocketPosix : public base::NonThreadSafe {
   // has been connected.
   int Write(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
 
+  // Reads up to |buffers.size()| datagrams from the socket with a single
+  // recvmmsg() where available. Each datagram is read into the corresponding
+  // entry of |buffers|, which must each have room for |buf_len| bytes, and
+  // its size is recorded in |results|. Returns the number of datagrams
+  // received, a net error code, or ERR_IO_PENDING if no datagram is ready;
+  // |callback| is then run later with one of the first two. The caller must
+  // keep |buffers| and |results| alive until completion. Only usable from
+  // the client-side of a UDP socket, after the socket has been connected.
+  int ReadBatch(const std::vector<scoped_refptr<IOBuffer>>& buffers,
+                int buf_len,
+                std::vector<int>* results,
+                const CompletionCallback& callback);
+
+  // Sends each entry of |buffers| as one datagram with a single sendmmsg()
+  // where available. Returns the number of datagrams sent, which may be only
+  // a prefix of |buffers|; the caller submits the rest again. Returns
+  // ERR_IO_PENDING if no datagram can be sent right now; |callback| is then
+  // run later with the result of the retried batch. Only usable from the
+  // client-side of a UDP socket, after the socket has been connected.
+  int WriteBatch(const std::vector<scoped_refptr<IOBufferWithSize>>& buffers,
+                 const CompletionCallback& callback);
+
   // Reads from a socket and receive sender address information.
   // |buf| is the buffer to read data into.
   // |buf_len| is the maximum amount of data to read.
@@ -248,6 +272,11 @@ class NET_EXPORT UDPSocketPosix : public base::NonThreadSafe {
   int InternalConnect(const IPEndPoint& address);
   int InternalRecvFrom(IOBuffer* buf, int buf_len, IPEndPoint* address);
   int InternalSendTo(IOBuffer* buf, int buf_len, const IPEndPoint* address);
+  int InternalReadBatch(const std::vector<scoped_refptr<IOBuffer>>& buffers,
+                        int buf_len,
+                        std::vector<int>* results);
+  int InternalWriteBatch(
+      const std::vector<scoped_refptr<IOBufferWithSize>>& buffers);
 
   // Applies |socket_options_| to |socket_|. Should be called before
   // Bind().
@@ -297,11 +326,21 @@ class NET_EXPORT UDPSocketPosix : public base::NonThreadSafe {
   int read_buf_len_;
   IPEndPoint* recv_from_address_;
 
+  // The buffers used to retry a ReadBatch request. A batch read is pending
+  // iff |read_buf_list_| is non-empty; |read_results_| then points at the
+  // caller's result vector.
+  std::vector<scoped_refptr<IOBuffer>> read_buf_list_;
+  std::vector<int>* read_results_;
+
   // The buffer used by InternalWrite() to retry Write requests
   scoped_refptr<IOBuffer> write_buf_;
   int write_buf_len_;
   scoped_ptr<IPEndPoint> send_to_address_;
 
+  // The buffers used to retry a WriteBatch request. A batch write is pending
+  // iff |write_buf_list_| is non-empty.
+  std::vector<scoped_refptr<IOBufferWithSize>> write_buf_list_;
+
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
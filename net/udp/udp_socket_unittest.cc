@@ -263,6 +263,63 @@ TEST_F(UDPSocketTest, ConnectNonBlocking) {
 }
 #endif
 
+TEST_F(UDPSocketTest, ReadBatch) {
+  const uint16_t kPort = 9999;
+
+  // Setup the server to listen.
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", kPort, &bind_address);
+  TestNetLog server_log;
+  scoped_ptr<UDPServerSocket> server(
+      new UDPServerSocket(&server_log, NetLog::Source()));
+  server->AllowAddressReuse();
+  ASSERT_EQ(OK, server->Listen(bind_address));
+
+  // Setup the client.
+  IPEndPoint server_address;
+  CreateUDPAddress("127.0.0.1", kPort, &server_address);
+  TestNetLog client_log;
+  scoped_ptr<UDPClientSocket> client(
+      new UDPClientSocket(DatagramSocket::DEFAULT_BIND, RandIntCallback(),
+                          &client_log, NetLog::Source()));
+  ASSERT_EQ(OK, client->Connect(server_address));
+
+  // Client sends to the server so that the server learns its address.
+  std::string ping_message("ping");
+  int rv = WriteSocket(client.get(), ping_message);
+  ASSERT_EQ(static_cast<int>(ping_message.length()), rv);
+  ASSERT_EQ(ping_message, RecvFromSocket(server.get()));
+
+  // Server sends several datagrams back to back.
+  const std::string kMessages[] = {"first", "second datagram", "third"};
+  for (size_t i = 0; i < arraysize(kMessages); ++i) {
+    rv = SendToSocket(server.get(), kMessages[i]);
+    ASSERT_EQ(static_cast<int>(kMessages[i].length()), rv);
+  }
+
+  // Client reads them back in batches. Depending on delivery timing a batch
+  // may hold any non-empty prefix of the outstanding datagrams, so keep
+  // reading until all of them have arrived.
+  std::vector<scoped_refptr<IOBuffer>> buffers;
+  for (size_t i = 0; i < arraysize(kMessages); ++i)
+    buffers.push_back(new IOBufferWithSize(kMaxRead));
+  std::vector<int> results;
+  std::vector<std::string> received;
+  while (received.size() < arraysize(kMessages)) {
+    TestCompletionCallback callback;
+    rv = client->ReadBatch(buffers, kMaxRead, &results, callback.callback());
+    if (rv == ERR_IO_PENDING)
+      rv = callback.WaitForResult();
+    ASSERT_GT(rv, 0);
+    ASSERT_EQ(static_cast<size_t>(rv), results.size());
+    for (int i = 0; i < rv; ++i)
+      received.push_back(std::string(buffers[i]->data(), results[i]));
+  }
+  ASSERT_EQ(arraysize(kMessages), received.size());
+  for (size_t i = 0; i < arraysize(kMessages); ++i)
+    EXPECT_EQ(kMessages[i], received[i]);
+}
+
 #if defined(OS_MACOSX)
 // UDPSocketPrivate_Broadcast is disabled for OSX because it requires
 // root permissions on OSX 10.7+.
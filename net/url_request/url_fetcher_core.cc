@@ -33,7 +33,10 @@
 
 namespace {
 
-const int kBufferSize = 4096;
+// Size of the buffer that response bytes are read into. Large enough that a
+// fast response does not pay a URLRequest::Read round trip every few packets,
+// small enough to be cheap for the many fetchers that read short responses.
+const int kBufferSize = 32768;
 const int kUploadProgressTimerInterval = 100;
 bool g_ignore_certificate_requests = false;
 
@@ -4,6 +4,11 @@
 
 #include "net/url_request/url_fetcher_response_writer.h"
 
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/callback_helpers.h"
 #include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/sequenced_task_runner.h"
@@ -14,6 +19,14 @@
 
 namespace net {
 
+namespace {
+
+// Size of the two buffers URLFetcherFileWriter uses to coalesce small
+// response chunks into large sequential file writes.
+const int kCoalesceBufferSize = 256 * 1024;
+
+}  // namespace
+
 URLFetcherStringWriter* URLFetcherResponseWriter::AsStringWriter() {
   return NULL;
 }
@@ -55,6 +68,8 @@ URLFetcherFileWriter::URLFetcherFileWriter(
     : file_task_runner_(file_task_runner),
       file_path_(file_path),
       owns_file_(false),
+      fill_buffer_length_(0),
+      flush_error_(OK),
       weak_factory_(this) {
   DCHECK(file_task_runner_.get());
 }
@@ -66,6 +81,10 @@ URLFetcherFileWriter::~URLFetcherFileWriter() {
 int URLFetcherFileWriter::Initialize(const CompletionCallback& callback) {
   file_stream_.reset(new FileStream(file_task_runner_));
 
+  fill_buffer_ = new IOBuffer(kCoalesceBufferSize);
+  fill_buffer_length_ = 0;
+  flush_error_ = OK;
+
   int result = ERR_IO_PENDING;
   if (file_path_.empty()) {
     base::FilePath* temp_file_path = new base::FilePath;
@@ -93,30 +112,45 @@ int URLFetcherFileWriter::Initialize(const CompletionCallback& callback) {
 int URLFetcherFileWriter::Write(IOBuffer* buffer,
                                 int num_bytes,
                                 const CompletionCallback& callback) {
+  DCHECK(pending_write_callback_.is_null());
+
+  if (flush_error_ != OK)
+    return flush_error_;
+
   DCHECK(file_stream_);
   DCHECK(owns_file_);
 
-  int result = file_stream_->Write(buffer, num_bytes,
-                                   base::Bind(&URLFetcherFileWriter::DidWrite,
-                                              weak_factory_.GetWeakPtr(),
-                                              callback));
-  if (result < 0 && result != ERR_IO_PENDING)
-    CloseAndDeleteFile();
+  const int space = kCoalesceBufferSize - fill_buffer_length_;
+  if (space == 0) {
+    // Both buffers are busy; wait for the in-flight flush to make room.
+    DCHECK(flush_buffer_.get());
+    pending_write_callback_ = callback;
+    return ERR_IO_PENDING;
+  }
 
-  return result;
+  const int bytes_to_copy = std::min(num_bytes, space);
+  memcpy(fill_buffer_->data() + fill_buffer_length_, buffer->data(),
+         bytes_to_copy);
+  fill_buffer_length_ += bytes_to_copy;
+  if (fill_buffer_length_ == kCoalesceBufferSize && !flush_buffer_.get())
+    StartFlush();
+  return bytes_to_copy;
 }
 
 int URLFetcherFileWriter::Finish(const CompletionCallback& callback) {
-  // If the file_stream_ still exists at this point, close it.
-  if (file_stream_) {
-    int result = file_stream_->Close(base::Bind(
-        &URLFetcherFileWriter::CloseComplete,
-        weak_factory_.GetWeakPtr(), callback));
-    if (result != ERR_IO_PENDING)
-      file_stream_.reset();
-    return result;
+  if (flush_error_ != OK)
+    return flush_error_;
+
+  // Flush any coalesced data before closing the file.
+  if (file_stream_ && owns_file_ &&
+      (flush_buffer_.get() || fill_buffer_length_ > 0)) {
+    DCHECK(finish_callback_.is_null());
+    finish_callback_ = callback;
+    if (!flush_buffer_.get())
+      StartFlush();
+    return ERR_IO_PENDING;
   }
-  return OK;
+  return CloseFile(callback);
 }
 
 URLFetcherFileWriter* URLFetcherFileWriter::AsFileWriter() {
@@ -131,12 +165,90 @@ void URLFetcherFileWriter::DisownFile() {
   owns_file_ = false;
 }
 
-void URLFetcherFileWriter::DidWrite(const CompletionCallback& callback,
-                                    int result) {
-  if (result < 0)
+void URLFetcherFileWriter::StartFlush() {
+  DCHECK(!flush_buffer_.get());
+  DCHECK_GT(fill_buffer_length_, 0);
+
+  flush_base_buffer_ = fill_buffer_;
+  flush_buffer_ = new DrainableIOBuffer(flush_base_buffer_.get(),
+                                        fill_buffer_length_);
+  if (spare_buffer_.get()) {
+    fill_buffer_ = spare_buffer_;
+    spare_buffer_ = NULL;
+  } else {
+    fill_buffer_ = new IOBuffer(kCoalesceBufferSize);
+  }
+  fill_buffer_length_ = 0;
+
+  const int result = file_stream_->Write(
+      flush_buffer_.get(), flush_buffer_->BytesRemaining(),
+      base::Bind(&URLFetcherFileWriter::DidFlush, weak_factory_.GetWeakPtr()));
+  if (result != ERR_IO_PENDING)
+    DidFlush(result);
+}
+
+void URLFetcherFileWriter::DidFlush(int result) {
+  if (result < 0) {
     CloseAndDeleteFile();
+    flush_error_ = result;
+    flush_buffer_ = NULL;
+    flush_base_buffer_ = NULL;
+    if (!pending_write_callback_.is_null())
+      base::ResetAndReturn(&pending_write_callback_).Run(result);
+    else if (!finish_callback_.is_null())
+      base::ResetAndReturn(&finish_callback_).Run(result);
+    return;
+  }
 
-  callback.Run(result);
+  flush_buffer_->DidConsume(result);
+  if (flush_buffer_->BytesRemaining() > 0) {
+    const int rv = file_stream_->Write(
+        flush_buffer_.get(), flush_buffer_->BytesRemaining(),
+        base::Bind(&URLFetcherFileWriter::DidFlush,
+                   weak_factory_.GetWeakPtr()));
+    if (rv != ERR_IO_PENDING)
+      DidFlush(rv);
+    return;
+  }
+
+  // The flushed buffer is empty again; keep it for reuse.
+  flush_buffer_ = NULL;
+  spare_buffer_ = flush_base_buffer_;
+  flush_base_buffer_ = NULL;
+
+  if (!finish_callback_.is_null()) {
+    if (fill_buffer_length_ > 0) {
+      StartFlush();
+      return;
+    }
+    // All data is on disk; close the file and report to Finish()'s caller.
+    CompletionCallback callback = base::ResetAndReturn(&finish_callback_);
+    const int rv = CloseFile(callback);
+    if (rv != ERR_IO_PENDING)
+      callback.Run(rv);
+    return;
+  }
+
+  // If the other buffer filled up in the meantime, flush it right away.
+  if (fill_buffer_length_ == kCoalesceBufferSize)
+    StartFlush();
+
+  // A stalled Write() can now make progress; it will re-submit its data.
+  if (!pending_write_callback_.is_null())
+    base::ResetAndReturn(&pending_write_callback_).Run(0);
+}
+
+int URLFetcherFileWriter::CloseFile(const CompletionCallback& callback) {
+  // If the file_stream_ still exists at this point, close it.
+  if (file_stream_) {
+    int result = file_stream_->Close(base::Bind(
+        &URLFetcherFileWriter::CloseComplete,
+        weak_factory_.GetWeakPtr(), callback));
+    if (result != ERR_IO_PENDING)
+      file_stream_.reset();
+    return result;
+  }
+  return OK;
 }
 
 void URLFetcherFileWriter::CloseAndDeleteFile() {
@@ -79,6 +79,11 @@ class NET_EXPORT URLFetcherStringWriter : public URLFetcherResponseWriter {
 };
 
 // URLFetcherResponseWriter implementation for files.
+//
+// Response bytes are coalesced into large buffers and written to disk in big
+// sequential chunks. While a chunk is being flushed, Write() keeps accepting
+// data into a second buffer, so network reads overlap disk writes; Write()
+// only returns ERR_IO_PENDING when both buffers are busy.
 class NET_EXPORT URLFetcherFileWriter : public URLFetcherResponseWriter {
  public:
   // |file_path| is used as the destination path. If |file_path| is empty,
@@ -103,8 +108,17 @@ class NET_EXPORT URLFetcherFileWriter : public URLFetcherResponseWriter {
   void DisownFile();
 
  private:
-  // Called when a write has been done.
-  void DidWrite(const CompletionCallback& callback, int result);
+  // Hands the filled part of |fill_buffer_| to |file_stream_| in a single
+  // asynchronous write and swaps in an empty buffer so that Write() can keep
+  // accepting data while the flush is in flight.
+  void StartFlush();
+
+  // Called when a FileStream write issued by StartFlush() has been done.
+  void DidFlush(int result);
+
+  // Closes |file_stream_|. Returns a network error code, running |callback|
+  // later if ERR_IO_PENDING is returned.
+  int CloseFile(const CompletionCallback& callback);
 
   // Closes the file if it is open and then delete it.
   void CloseAndDeleteFile();
@@ -133,6 +147,29 @@ class NET_EXPORT URLFetcherFileWriter : public URLFetcherResponseWriter {
 
   scoped_ptr<FileStream> file_stream_;
 
+  // Write() coalesces response chunks here until a buffer's worth is ready
+  // for one large file write.
+  scoped_refptr<IOBuffer> fill_buffer_;
+  int fill_buffer_length_;
+
+  // Non-null while a flush is in flight; drains |flush_base_buffer_|.
+  scoped_refptr<DrainableIOBuffer> flush_buffer_;
+  scoped_refptr<IOBuffer> flush_base_buffer_;
+
+  // The most recently flushed buffer, kept for reuse.
+  scoped_refptr<IOBuffer> spare_buffer_;
+
+  // The first error produced by a background flush, surfaced to the next
+  // Write() or Finish() call.
+  int flush_error_;
+
+  // Completion callback of a Write() that stalled because both buffers were
+  // busy; run with 0 once the in-flight flush makes room again.
+  CompletionCallback pending_write_callback_;
+
+  // Completion callback of a Finish() waiting for the final flush.
+  CompletionCallback finish_callback_;
+
   // Callbacks are created for use with base::FileUtilProxy.
   base::WeakPtrFactory<URLFetcherFileWriter> weak_factory_;
 
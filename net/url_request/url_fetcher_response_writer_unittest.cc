@@ -4,6 +4,8 @@
 
 #include "net/url_request/url_fetcher_response_writer.h"
 
+#include <algorithm>
+
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/run_loop.h"
@@ -91,6 +93,38 @@ TEST_F(URLFetcherFileWriterTest, WriteToFile) {
   EXPECT_FALSE(base::PathExists(file_path_));
 }
 
+// Writes a response body spanning several coalescing buffers in small
+// chunks, driving Write() through its buffered, flushing and stalled states.
+TEST_F(URLFetcherFileWriterTest, WriteLargeResponseInChunks) {
+  const int kChunkSize = 16 * 1024;
+  std::string large_data;
+  while (large_data.size() < 600 * 1024)
+    large_data += "The quick brown fox jumps over the lazy dog.";
+  scoped_refptr<StringIOBuffer> large_buf(new StringIOBuffer(large_data));
+  scoped_refptr<DrainableIOBuffer> drainable(
+      new DrainableIOBuffer(large_buf.get(), large_buf->size()));
+
+  TestCompletionCallback callback;
+  int rv = writer_->Initialize(callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+  while (drainable->BytesRemaining() > 0) {
+    TestCompletionCallback write_callback;
+    rv = writer_->Write(drainable.get(),
+                        std::min(kChunkSize, drainable->BytesRemaining()),
+                        write_callback.callback());
+    rv = write_callback.GetResult(rv);
+    ASSERT_GE(rv, 0);
+    drainable->DidConsume(rv);
+  }
+  rv = writer_->Finish(callback.callback());
+  EXPECT_EQ(OK, callback.GetResult(rv));
+
+  // Verify the result.
+  std::string file_contents;
+  EXPECT_TRUE(base::ReadFileToString(writer_->file_path(), &file_contents));
+  EXPECT_EQ(large_data, file_contents);
+}
+
 TEST_F(URLFetcherFileWriterTest, InitializeAgain) {
   int rv = 0;
   // Initialize(), Write() and Finish().
@@ -26,6 +26,7 @@
 #include "net/base/load_flags.h"
 #include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
+#include "net/base/net_allocation_tracker.h"
 #include "net/base/network_change_notifier.h"
 #include "net/base/network_delegate.h"
 #include "net/base/upload_data_stream.h"
@@ -588,9 +589,8 @@ void URLRequest::BeforeRequestComplete(int error) {
   OnCallToDelegateComplete();
 
   if (error != OK) {
-    std::string source("delegate");
-    net_log_.AddEvent(NetLog::TYPE_CANCELLED,
-                      NetLog::StringCallback("source", &source));
+    net_log_.AddEventWithStringLiteral(NetLog::TYPE_CANCELLED, "source",
+                                       "delegate");
     StartJob(new URLRequestErrorJob(this, network_delegate_, error));
   } else if (!delegate_redirect_url_.is_empty()) {
     GURL new_url;
@@ -643,9 +643,8 @@ void URLRequest::StartJob(URLRequestJob* job) {
       // We need to clear the referrer anyway to avoid an infinite recursion
       // when starting the error job.
       referrer_.clear();
-      std::string source("delegate");
-      net_log_.AddEvent(NetLog::TYPE_CANCELLED,
-                        NetLog::StringCallback("source", &source));
+      net_log_.AddEventWithStringLiteral(NetLog::TYPE_CANCELLED, "source",
+                                         "delegate");
       RestartWithJob(new URLRequestErrorJob(
           this, network_delegate_, ERR_BLOCKED_BY_CLIENT));
       return;
@@ -1028,8 +1027,8 @@ void URLRequest::SetPriority(RequestPriority priority) {
 
   priority_ = priority;
   if (job_.get()) {
-    net_log_.AddEvent(NetLog::TYPE_URL_REQUEST_SET_PRIORITY,
-                      NetLog::IntCallback("priority", priority_));
+    net_log_.AddEventWithIntParams(NetLog::TYPE_URL_REQUEST_SET_PRIORITY,
+                                   "priority", priority_);
     job_->SetPriority(priority_);
   }
 }
@@ -1192,6 +1191,7 @@ void URLRequest::NotifyRequestCompleted() {
   is_pending_ = false;
   is_redirecting_ = false;
   has_notified_completion_ = true;
+  NET_TRACK_REQUEST_COMPLETED();
   if (network_delegate_)
     network_delegate_->NotifyCompleted(this, job_.get() != NULL);
 }
@@ -13,12 +13,14 @@
 #include "base/strings/string_util.h"
 #include "base/thread_task_runner_handle.h"
 #include "base/threading/thread.h"
+#include "base/threading/worker_pool.h"
 #include "net/base/cache_type.h"
 #include "net/base/net_errors.h"
 #include "net/base/network_delegate_impl.h"
 #include "net/base/sdch_manager.h"
 #include "net/cert/cert_verifier.h"
 #include "net/cookies/cookie_monster.h"
+#include "net/disk_cache/disk_cache.h"
 #include "net/dns/host_resolver.h"
 #include "net/ftp/ftp_network_layer.h"
 #include "net/http/http_auth_handler_factory.h"
@@ -164,6 +166,47 @@ class ContainerURLRequestContext : public URLRequestContext {
   DISALLOW_COPY_AND_ASSIGN(ContainerURLRequestContext);
 };
 
+// A disk cache backend factory that asks its context for the file task
+// runner only once the backend is actually created. Since HttpCache opens
+// its backend on the first transaction, contexts that never issue a request
+// (or never hit the cache) don't pay for the file thread.
+class ContainerBackendFactory : public HttpCache::BackendFactory {
+ public:
+  ContainerBackendFactory(BackendType backend_type,
+                          const base::FilePath& path,
+                          int max_bytes,
+                          ContainerURLRequestContext* context)
+      : backend_type_(backend_type),
+        path_(path),
+        max_bytes_(max_bytes),
+        context_(context) {}
+  ~ContainerBackendFactory() override {}
+
+  // HttpCache::BackendFactory implementation.
+  int CreateBackend(NetLog* net_log,
+                    scoped_ptr<disk_cache::Backend>* backend,
+                    const CompletionCallback& callback) override {
+    DCHECK_GE(max_bytes_, 0);
+    return disk_cache::CreateCacheBackend(DISK_CACHE,
+                                          backend_type_,
+                                          path_,
+                                          max_bytes_,
+                                          true,
+                                          context_->GetFileTaskRunner(),
+                                          net_log,
+                                          backend,
+                                          callback);
+  }
+
+ private:
+  const BackendType backend_type_;
+  const base::FilePath path_;
+  const int max_bytes_;
+  ContainerURLRequestContext* const context_;  // Owns |this| transitively.
+
+  DISALLOW_COPY_AND_ASSIGN(ContainerBackendFactory);
+};
+
 }  // namespace
 
 URLRequestContextBuilder::HttpCacheParams::HttpCacheParams()
@@ -327,10 +370,12 @@ scoped_ptr<URLRequestContext> URLRequestContextBuilder::Build() {
     storage->set_channel_id_service(channel_id_service_.Pass());
   } else {
     storage->set_cookie_store(new CookieMonster(NULL, NULL));
-    // TODO(mmenke):  This always creates a file thread, even when it ends up
-    // not being used.  Consider lazily creating the thread.
+    // Channel ID generation is documented as safe for the worker pool;
+    // using it avoids spinning up the context's file thread for contexts
+    // that otherwise never touch a file.
     storage->set_channel_id_service(make_scoped_ptr(new ChannelIDService(
-        new DefaultChannelIDStore(NULL), context->GetFileTaskRunner())));
+        new DefaultChannelIDStore(NULL),
+        base::WorkerPool::GetTaskRunner(true))));
   }
 
   if (sdch_enabled_) {
@@ -413,9 +458,9 @@ scoped_ptr<URLRequestContext> URLRequestContextBuilder::Build() {
           http_cache_params_.type == HttpCacheParams::DISK
               ? CACHE_BACKEND_DEFAULT
               : CACHE_BACKEND_SIMPLE;
-      http_cache_backend.reset(new HttpCache::DefaultBackend(
-          DISK_CACHE, backend_type, http_cache_params_.path,
-          http_cache_params_.max_size, context->GetFileTaskRunner()));
+      http_cache_backend.reset(new ContainerBackendFactory(
+          backend_type, http_cache_params_.path, http_cache_params_.max_size,
+          context.get()));
     } else {
       http_cache_backend =
           HttpCache::DefaultBackend::InMemory(http_cache_params_.max_size);
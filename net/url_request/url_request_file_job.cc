@@ -20,8 +20,10 @@
 #include "net/url_request/url_request_file_job.h"
 
 #include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/message_loop/message_loop.h"
 #include "base/strings/string_util.h"
 #include "base/synchronization/lock.h"
@@ -39,12 +41,26 @@
 #include "net/url_request/url_request_file_dir_job.h"
 #include "url/gurl.h"
 
+#if defined(OS_POSIX)
+#include <sys/mman.h>
+#endif
+
 #if defined(OS_WIN)
 #include "base/win/shortcut.h"
 #endif
 
 namespace net {
 
+namespace {
+
+// Files at least this large are served out of a memory mapping instead of
+// FileStream reads: each read then costs a single copy out of the page cache
+// with no round trip to the file thread. Small files stay on the FileStream
+// path, which avoids mapping churn for the common case.
+const int64 kMmapFileThreshold = 1024 * 1024;
+
+}  // namespace
+
 URLRequestFileJob::FileMetaInfo::FileMetaInfo()
     : file_size(0),
       mime_type_result(false),
@@ -60,6 +76,7 @@ URLRequestFileJob::URLRequestFileJob(
     : URLRequestJob(request, network_delegate),
       file_path_(file_path),
       stream_(new FileStream(file_task_runner)),
+      mmap_offset_(0),
       file_task_runner_(file_task_runner),
       remaining_bytes_(0),
       range_parse_result_(OK),
@@ -78,6 +95,12 @@ void URLRequestFileJob::Start() {
 
 void URLRequestFileJob::Kill() {
   stream_.reset();
+  if (mmap_file_) {
+    // Unmapping closes the file; do it where blocking is allowed.
+    file_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&base::DeletePointer<base::MemoryMappedFile>,
+                              mmap_file_.release()));
+  }
   weak_ptr_factory_.InvalidateWeakPtrs();
 
   URLRequestJob::Kill();
@@ -95,6 +118,17 @@ int URLRequestFileJob::ReadRawData(IOBuffer* dest, int dest_size) {
   if (!dest_size)
     return 0;
 
+  if (mmap_file_) {
+    // Serve straight from the mapping; the kernel faults pages in on demand,
+    // helped along by the sequential readahead hint.
+    memcpy(dest->data(), mmap_file_->data() + mmap_offset_, dest_size);
+    mmap_offset_ += dest_size;
+    remaining_bytes_ -= dest_size;
+    DCHECK_GE(remaining_bytes_, 0);
+    OnReadComplete(dest, dest_size);
+    return dest_size;
+  }
+
   int rv = stream_->Read(dest,
                          dest_size,
                          base::Bind(&URLRequestFileJob::DidRead,
@@ -191,6 +225,13 @@ void URLRequestFileJob::OnReadComplete(IOBuffer* buf, int result) {
 }
 
 URLRequestFileJob::~URLRequestFileJob() {
+  if (mmap_file_) {
+    // As in Kill(), unmapping closes the file, so hand the mapping to the
+    // file thread for destruction.
+    file_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&base::DeletePointer<base::MemoryMappedFile>,
+                              mmap_file_.release()));
+  }
 }
 
 void URLRequestFileJob::FetchMetaInfo(const base::FilePath& file_path,
@@ -227,6 +268,60 @@ void URLRequestFileJob::DidFetchMetaInfo(const FileMetaInfo* meta_info) {
     return;
   }
 
+  if (meta_info_.file_size >= kMmapFileThreshold) {
+    scoped_ptr<base::MemoryMappedFile> mmap_file(new base::MemoryMappedFile);
+    base::MemoryMappedFile* mmap_file_ptr = mmap_file.get();
+    file_task_runner_->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&URLRequestFileJob::MmapFile, file_path_,
+                   base::Unretained(mmap_file_ptr)),
+        base::Bind(&URLRequestFileJob::DidMmapFile,
+                   weak_ptr_factory_.GetWeakPtr(), file_task_runner_,
+                   base::Passed(&mmap_file)));
+    return;
+  }
+
+  OpenWithStream();
+}
+
+// static
+void URLRequestFileJob::MmapFile(const base::FilePath& file_path,
+                                 base::MemoryMappedFile* mmap_file) {
+  if (!mmap_file->Initialize(file_path))
+    return;
+#if defined(OS_POSIX)
+  // The body is shipped front to back; let the kernel read ahead
+  // aggressively instead of waiting for each page fault.
+  madvise(const_cast<uint8*>(mmap_file->data()), mmap_file->length(),
+          MADV_SEQUENTIAL);
+#endif
+}
+
+// static
+void URLRequestFileJob::DidMmapFile(
+    const base::WeakPtr<URLRequestFileJob>& job,
+    const scoped_refptr<base::TaskRunner>& file_task_runner,
+    scoped_ptr<base::MemoryMappedFile> mmap_file) {
+  if (!job) {
+    // The job was killed while the file was being mapped; unmapping closes
+    // the file, so push the mapping back to the file thread.
+    file_task_runner->PostTask(
+        FROM_HERE, base::Bind(&base::DeletePointer<base::MemoryMappedFile>,
+                              mmap_file.release()));
+    return;
+  }
+
+  if (mmap_file->IsValid()) {
+    job->mmap_file_ = mmap_file.Pass();
+    job->DidOpen(OK);
+    return;
+  }
+
+  // Mapping failed (e.g. an exotic filesystem); fall back to FileStream.
+  job->OpenWithStream();
+}
+
+void URLRequestFileJob::OpenWithStream() {
   int flags = base::File::FLAG_OPEN |
               base::File::FLAG_READ |
               base::File::FLAG_ASYNC;
@@ -259,7 +354,11 @@ void URLRequestFileJob::DidOpen(int result) {
                      byte_range_.first_byte_position() + 1;
   DCHECK_GE(remaining_bytes_, 0);
 
-  if (remaining_bytes_ > 0 && byte_range_.first_byte_position() != 0) {
+  if (mmap_file_) {
+    // Reads index the mapping directly; there is no stream to reposition.
+    mmap_offset_ = byte_range_.first_byte_position();
+    DidSeek(mmap_offset_);
+  } else if (remaining_bytes_ > 0 && byte_range_.first_byte_position() != 0) {
     int rv = stream_->Seek(byte_range_.first_byte_position(),
                            base::Bind(&URLRequestFileJob::DidSeek,
                                       weak_ptr_factory_.GetWeakPtr()));
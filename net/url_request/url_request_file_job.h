@@ -10,6 +10,7 @@
 
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_export.h"
@@ -18,6 +19,7 @@
 #include "net/url_request/url_request_job.h"
 
 namespace base {
+class MemoryMappedFile;
 class TaskRunner;
 }
 namespace file_util {
@@ -84,6 +86,24 @@ class NET_EXPORT URLRequestFileJob : public URLRequestJob {
   // Callback after fetching file info on a background thread.
   void DidFetchMetaInfo(const FileMetaInfo* meta_info);
 
+  // Maps the file on a background thread and applies a sequential readahead
+  // hint. Used instead of |stream_| for files at least as large as the
+  // mapping threshold.
+  static void MmapFile(const base::FilePath& file_path,
+                       base::MemoryMappedFile* mmap_file);
+
+  // Callback after mapping the file on a background thread. Static because
+  // it owns |mmap_file| and must dispose of it on |file_task_runner| even
+  // when the job has been killed in the meantime.
+  static void DidMmapFile(
+      const base::WeakPtr<URLRequestFileJob>& job,
+      const scoped_refptr<base::TaskRunner>& file_task_runner,
+      scoped_ptr<base::MemoryMappedFile> mmap_file);
+
+  // Opens the file with |stream_|. Used for small files and as a fallback
+  // when mapping fails.
+  void OpenWithStream();
+
   // Callback after opening file on a background thread.
   void DidOpen(int result);
 
@@ -95,6 +115,12 @@ class NET_EXPORT URLRequestFileJob : public URLRequestJob {
   void DidRead(scoped_refptr<IOBuffer> buf, int result);
 
   scoped_ptr<FileStream> stream_;
+
+  // When set, the file is served out of this memory mapping instead of
+  // |stream_|, and |mmap_offset_| is the position of the next read.
+  scoped_ptr<base::MemoryMappedFile> mmap_file_;
+  int64 mmap_offset_;
+
   FileMetaInfo meta_info_;
   const scoped_refptr<base::TaskRunner> file_task_runner_;
 
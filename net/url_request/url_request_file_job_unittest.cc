@@ -248,6 +248,12 @@ TEST_F(URLRequestFileJobEventsTest, BigFile) {
   RunRequest(MakeContentOfSize(3 * 1024 * 1024), NULL);
 }
 
+TEST_F(URLRequestFileJobEventsTest, BigFileRange) {
+  // A range inside a file large enough to be served from a memory mapping.
+  Range range(11 * 1024, (2 * 1024 * 1024) + 13);
+  RunRequest(MakeContentOfSize(3 * 1024 * 1024), &range);
+}
+
 TEST_F(URLRequestFileJobEventsTest, Range) {
   // Use a 15KB content file and read a range chosen somewhat arbitrarily but
   // not aligned on any likely page boundaries.
@@ -68,6 +68,7 @@ class URLRequestHttpJob::HttpFilterContext : public FilterContext {
   base::Time GetRequestTime() const override;
   bool IsCachedContent() const override;
   SdchManager::DictionarySet* SdchDictionariesAdvertised() const override;
+  int64 GetContentLength() const override;
   int64 GetByteReadCount() const override;
   int GetResponseCode() const override;
   const URLRequestContext* GetURLRequestContext() const override;
@@ -117,6 +118,12 @@ URLRequestHttpJob::HttpFilterContext::SdchDictionariesAdvertised() const {
   return job_->dictionaries_advertised_.get();
 }
 
+int64 URLRequestHttpJob::HttpFilterContext::GetContentLength() const {
+  if (!job_->response_info_ || !job_->response_info_->headers.get())
+    return -1;
+  return job_->GetResponseHeaders()->GetContentLength();
+}
+
 int64 URLRequestHttpJob::HttpFilterContext::GetByteReadCount() const {
   return job_->prefilter_bytes_read();
 }
@@ -466,9 +473,8 @@ void URLRequestHttpJob::MaybeStartTransactionInternal(int result) {
   if (result == OK) {
     StartTransactionInternal();
   } else {
-    std::string source("delegate");
-    request_->net_log().AddEvent(NetLog::TYPE_CANCELLED,
-                                 NetLog::StringCallback("source", &source));
+    request_->net_log().AddEventWithStringLiteral(NetLog::TYPE_CANCELLED,
+                                                  "source", "delegate");
     NotifyCanceled();
     NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, result));
   }
@@ -700,9 +706,8 @@ void URLRequestHttpJob::SaveCookiesAndNotifyHeadersComplete(int result) {
   OnCallToDelegateComplete();
 
   if (result != OK) {
-    std::string source("delegate");
-    request_->net_log().AddEvent(NetLog::TYPE_CANCELLED,
-                                 NetLog::StringCallback("source", &source));
+    request_->net_log().AddEventWithStringLiteral(NetLog::TYPE_CANCELLED,
+                                                  "source", "delegate");
     NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, result));
     return;
   }
@@ -948,10 +953,8 @@ void URLRequestHttpJob::OnStartCompleted(int result) {
         if (error == ERR_IO_PENDING) {
           awaiting_callback_ = true;
         } else {
-          std::string source("delegate");
-          request_->net_log().AddEvent(NetLog::TYPE_CANCELLED,
-                                       NetLog::StringCallback("source",
-                                                              &source));
+          request_->net_log().AddEventWithStringLiteral(NetLog::TYPE_CANCELLED,
+                                                        "source", "delegate");
           OnCallToDelegateComplete();
           NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, error));
         }
@@ -57,7 +57,14 @@ scoped_refptr<URLRequestThrottlerEntryInterface>
   GarbageCollectEntriesIfNecessary();
 
   // Find the entry in the map or create a new NULL entry.
-  scoped_refptr<URLRequestThrottlerEntry>& entry = url_entries_[url_id];
+  UrlEntryMap::iterator it = url_entries_.find(url_id);
+  if (it == url_entries_.end()) {
+    it = url_entries_.insert(
+        std::make_pair(url_id,
+                       scoped_refptr<URLRequestThrottlerEntry>())).first;
+    ScheduleExpiry(url_id);
+  }
+  scoped_refptr<URLRequestThrottlerEntry>& entry = it->second;
 
   // If the entry exists but could be garbage collected at this point, we
   // start with a fresh entry so that we possibly back off a bit less
@@ -101,6 +108,8 @@ void URLRequestThrottlerManager::OverrideEntryForTests(
   // Periodically garbage collect old entries.
   GarbageCollectEntriesIfNecessary();
 
+  if (url_entries_.find(url_id) == url_entries_.end())
+    ScheduleExpiry(url_id);
   url_entries_[url_id] = entry;
 }
 
@@ -141,17 +150,57 @@ std::string URLRequestThrottlerManager::GetIdFromUrl(const GURL& url) const {
   if (!url.is_valid())
     return url.possibly_invalid_spec();
 
+  // Fast path: the spec is already canonical with a lowercase scheme and
+  // host, so unless there is a username or password to strip out, the ID is
+  // just the spec up to the end of the path (dropping any query and
+  // fragment), lowercased because the path may contain uppercase characters.
+  if (!url.has_username() && !url.has_password()) {
+    const std::string& spec = url.spec();
+    const url::Component& path = url.parsed_for_possibly_invalid_spec().path;
+    size_t id_length =
+        path.is_valid() ? static_cast<size_t>(path.end()) : spec.length();
+    return base::ToLowerASCII(spec.substr(0, id_length));
+  }
+
   GURL id = url.ReplaceComponents(url_id_replacements_);
   return base::ToLowerASCII(id.spec());
 }
 
+void URLRequestThrottlerManager::ScheduleExpiry(const std::string& url_id) {
+  expiry_heap_.push(ExpiryRecord(
+      base::TimeTicks::Now() +
+          base::TimeDelta::FromMilliseconds(
+              URLRequestThrottlerEntry::kDefaultEntryLifetimeMs),
+      url_id));
+}
+
 void URLRequestThrottlerManager::GarbageCollectEntriesIfNecessary() {
   requests_since_last_gc_++;
   if (requests_since_last_gc_ < kRequestsBetweenCollecting)
     return;
   requests_since_last_gc_ = 0;
 
-  GarbageCollectEntries();
+  // Only look at the entries whose expiry deadline has passed, instead of
+  // sweeping the whole map on the request path.
+  base::TimeTicks now = base::TimeTicks::Now();
+  while (!expiry_heap_.empty() && expiry_heap_.top().time <= now) {
+    std::string url_id = expiry_heap_.top().url_id;
+    expiry_heap_.pop();
+    UrlEntryMap::iterator it = url_entries_.find(url_id);
+    if (it == url_entries_.end())
+      continue;  // Already removed by a full sweep or a network change.
+    if (it->second->IsEntryOutdated()) {
+      url_entries_.erase(it);
+    } else {
+      // Still in use; check again one entry lifetime from now.
+      ScheduleExpiry(url_id);
+    }
+  }
+
+  // In case something broke we want to make sure not to grow indefinitely.
+  while (url_entries_.size() > kMaximumNumberOfEntries) {
+    url_entries_.erase(url_entries_.begin());
+  }
 }
 
 void URLRequestThrottlerManager::GarbageCollectEntries() {
@@ -176,6 +225,7 @@ void URLRequestThrottlerManager::OnNetworkChange() {
   // inconsistent with new entries for the same URLs, but since what we
   // want is a clean slate for the new connection type, this is OK.
   url_entries_.clear();
+  expiry_heap_ = ExpiryHeap();
   requests_since_last_gc_ = 0;
 }
 
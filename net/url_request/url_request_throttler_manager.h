@@ -5,12 +5,15 @@
 #ifndef NET_URL_REQUEST_URL_REQUEST_THROTTLER_MANAGER_H_
 #define NET_URL_REQUEST_URL_REQUEST_THROTTLER_MANAGER_H_
 
-#include <map>
+#include <queue>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/threading/platform_thread.h"
 #include "net/base/net_export.h"
@@ -88,10 +91,14 @@ class NET_EXPORT URLRequestThrottlerManager
 
   // Method that ensures the map gets cleaned from time to time. The period at
   // which garbage collecting happens is adjustable with the
-  // kRequestBetweenCollecting constant.
+  // kRequestBetweenCollecting constant.  Collection is incremental: only
+  // entries whose conservative expiry deadline has passed are examined,
+  // rather than sweeping the whole map on the request path.
   void GarbageCollectEntriesIfNecessary();
 
-  // Method that does the actual work of garbage collecting.
+  // Method that does a full sweep of the map, discarding every outdated
+  // entry.  Used as a safety net and by tests; the per-request path uses
+  // the incremental collection above.
   void GarbageCollectEntries();
 
   // When we switch from online to offline or change IP addresses, we
@@ -109,9 +116,33 @@ class NET_EXPORT URLRequestThrottlerManager
  private:
   // From each URL we generate an ID composed of the scheme, host, port and path
   // that allows us to uniquely map an entry to it.
-  typedef std::map<std::string, scoped_refptr<URLRequestThrottlerEntry> >
+  typedef base::hash_map<std::string, scoped_refptr<URLRequestThrottlerEntry> >
       UrlEntryMap;
 
+  // A record scheduling a URL ID to be checked for expiry.  Records are kept
+  // in a min-heap ordered by deadline, so incremental garbage collection only
+  // has to look at the entries that may actually be discardable.  A record's
+  // deadline is a conservative lower bound; when it fires for an entry that
+  // is still in use, a new record is scheduled one entry lifetime out.
+  struct ExpiryRecord {
+    ExpiryRecord(const base::TimeTicks& time, const std::string& url_id)
+        : time(time), url_id(url_id) {}
+
+    base::TimeTicks time;
+    std::string url_id;
+  };
+  struct ExpiryRecordGreater {
+    bool operator()(const ExpiryRecord& a, const ExpiryRecord& b) const {
+      return a.time > b.time;
+    }
+  };
+  typedef std::priority_queue<ExpiryRecord,
+                              std::vector<ExpiryRecord>,
+                              ExpiryRecordGreater> ExpiryHeap;
+
+  // Schedules an expiry check for |url_id| one entry lifetime from now.
+  void ScheduleExpiry(const std::string& url_id);
+
   // Maximum number of entries that we are willing to collect in our map.
   static const unsigned int kMaximumNumberOfEntries;
   // Number of requests that will be made between garbage collection.
@@ -121,6 +152,11 @@ class NET_EXPORT URLRequestThrottlerManager
   // URLRequestThrottlerEntry.
   UrlEntryMap url_entries_;
 
+  // Min-heap of expiry deadlines for the keys of |url_entries_|.  May
+  // contain records for keys that a full sweep or network change has
+  // already removed; those are skipped when popped.
+  ExpiryHeap expiry_heap_;
+
   // This keeps track of how many requests have been made. Used with
   // GarbageCollectEntries.
   unsigned int requests_since_last_gc_;
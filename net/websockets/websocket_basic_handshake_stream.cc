@@ -482,8 +482,9 @@ scoped_ptr<WebSocketStream> WebSocketBasicHandshakeStream::Upgrade() {
 
     return scoped_ptr<WebSocketStream>(new WebSocketDeflateStream(
         basic_stream.Pass(), extension_params_->deflate_parameters,
-        scoped_ptr<WebSocketDeflatePredictor>(
-            new WebSocketDeflatePredictorImpl)));
+        scoped_ptr<WebSocketDeflatePredictor>(new WebSocketDeflatePredictorImpl(
+            extension_params_->deflate_parameters
+                .client_context_take_over_mode()))));
   } else {
     return basic_stream.Pass();
   }
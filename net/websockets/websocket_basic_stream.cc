@@ -42,6 +42,12 @@ const uint64_t kMaxControlFramePayload = 125;
 //     packet sizes / encryption block sizes / IPC alignment issues, etc.
 const int kReadBufferSize = 32 * 1024;
 
+// Serialized batches of frames up to this size are written from a pooled
+// buffer that is reused between calls to WriteFrames(), rather than
+// allocating an exact-size buffer per batch. This is sized to comfortably fit
+// typical batches of small frames while wasting little memory per connection.
+const int kPooledWriteBufferSize = 8 * 1024;
+
 // Returns the total serialized size of |frames|. This function assumes that
 // |frames| will be serialized with mask field. This function forces the
 // masked bit of the frames on.
@@ -141,8 +147,18 @@ int WebSocketBasicStream::WriteFrames(
   //
   // First calculate the size of the buffer we need to allocate.
   int total_size = CalculateSerializedSizeAndTurnOnMaskBit(frames);
-  scoped_refptr<IOBufferWithSize> combined_buffer(
-      new IOBufferWithSize(total_size));
+  scoped_refptr<IOBufferWithSize> combined_buffer;
+  if (total_size <= kPooledWriteBufferSize) {
+    // HasOneRef() is false while a previous write still holds a reference to
+    // the pooled buffer (for example, when WriteFrames() is re-entered from
+    // the completion callback of an asynchronous write); in that case it
+    // cannot be touched and a fresh buffer is used for this batch.
+    if (!pooled_write_buffer_.get() || !pooled_write_buffer_->HasOneRef())
+      pooled_write_buffer_ = new IOBufferWithSize(kPooledWriteBufferSize);
+    combined_buffer = pooled_write_buffer_;
+  } else {
+    combined_buffer = new IOBufferWithSize(total_size);
+  }
 
   char* dest = combined_buffer->data();
   int remaining_size = total_size;
@@ -124,6 +124,13 @@ class NET_EXPORT_PRIVATE WebSocketBasicStream : public WebSocketStream {
   // this between sockets.
   scoped_refptr<IOBufferWithSize> read_buffer_;
 
+  // Serialization buffer reused across WriteFrames() calls for small batches
+  // of frames, so that a steady stream of small frames does not allocate a
+  // fresh buffer per batch. NULL until the first such write. Only reused once
+  // any previous write has dropped its reference; oversized batches get a
+  // one-off exact-size buffer instead.
+  scoped_refptr<IOBufferWithSize> pooled_write_buffer_;
+
   // The connection, wrapped in a ClientSocketHandle so that we can prevent it
   // from being returned to the pool.
   scoped_ptr<ClientSocketHandle> connection_;
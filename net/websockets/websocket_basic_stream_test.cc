@@ -863,6 +863,21 @@ TEST_F(WebSocketBasicStreamSocketWriteTest, WriteAtOnce) {
   EXPECT_EQ(OK, stream_->WriteFrames(&frames_, cb_.callback()));
 }
 
+// Check that successive small writes serialize correctly. Small batches are
+// serialized into a pooled buffer that is reused between calls to
+// WriteFrames(), so this verifies that the second write is not corrupted by
+// the first.
+TEST_F(WebSocketBasicStreamSocketWriteTest, WriteTwice) {
+  MockWrite writes[] = {MockWrite(SYNCHRONOUS, kWriteFrame, kWriteFrameSize),
+                        MockWrite(SYNCHRONOUS, kWriteFrame, kWriteFrameSize)};
+  CreateWriteOnly(writes);
+
+  EXPECT_EQ(OK, stream_->WriteFrames(&frames_, cb_.callback()));
+  frames_.clear();
+  PrepareWriteFrame();
+  EXPECT_EQ(OK, stream_->WriteFrames(&frames_, cb_.callback()));
+}
+
 // Check that completely async writing works.
 TEST_F(WebSocketBasicStreamSocketWriteTest, AsyncWriteAtOnce) {
   MockWrite writes[] = {MockWrite(ASYNC, kWriteFrame, kWriteFrameSize)};
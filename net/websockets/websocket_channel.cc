@@ -431,6 +431,8 @@ void WebSocketChannel::SendFlowControl(int64_t quota) {
   // value or > INT_MAX.
   DCHECK_GE(quota, 0);
   DCHECK_LE(quota, INT_MAX);
+  // Batched frames never survive beyond the frame-handling loop.
+  DCHECK(pending_data_frames_.empty());
   if (!pending_received_frames_.empty()) {
     DCHECK_EQ(0u, current_receive_quota_);
   }
@@ -744,6 +746,9 @@ ChannelState WebSocketChannel::OnReadDone(bool synchronous, int result) {
           return CHANNEL_DELETED;
       }
       read_frames_.clear();
+      // Deliver the data frames accepted above in one batched event.
+      if (FlushPendingDataFrames() == CHANNEL_DELETED)
+        return CHANNEL_DELETED;
       // There should always be a call to ReadFrames pending.
       // TODO(ricea): Unless we are out of quota.
       DCHECK_NE(CLOSED, state_);
@@ -826,6 +831,12 @@ ChannelState WebSocketChannel::HandleFrameByState(
     return FailChannel(
         frame_name + " received after close", kWebSocketErrorProtocolError, "");
   }
+  if (!WebSocketFrameHeader::IsKnownDataOpCode(opcode)) {
+    // Control frames can generate events and responses of their own; deliver
+    // any batched data frames first so that events are never reordered.
+    if (FlushPendingDataFrames() == CHANNEL_DELETED)
+      return CHANNEL_DELETED;
+  }
   switch (opcode) {
     case WebSocketFrameHeader::kOpCodeText:  // fall-thru
     case WebSocketFrameHeader::kOpCodeBinary:
@@ -988,11 +999,24 @@ ChannelState WebSocketChannel::HandleDataFrame(
   // TODO(ricea): Can this copy be eliminated?
   const char* const data_begin = size ? data_buffer->data() : NULL;
   const char* const data_end = data_begin + size;
-  const std::vector<char> data(data_begin, data_end);
   current_receive_quota_ -= size;
 
-  // Sends the received frame to the renderer process.
-  return event_interface_->OnDataFrame(final, opcode_to_send, data);
+  // Accept the frame for delivery; all the data frames handled in the current
+  // frame-handling loop are sent to the renderer in one batched event.
+  pending_data_frames_.push_back(
+      WebSocketEventInterface::DataFrame(final, opcode_to_send));
+  pending_data_frames_.back().data.assign(data_begin, data_end);
+  return CHANNEL_ALIVE;
+}
+
+ChannelState WebSocketChannel::FlushPendingDataFrames() {
+  if (pending_data_frames_.empty())
+    return CHANNEL_ALIVE;
+  // Swap to a local so that no member is touched if the event deletes the
+  // channel.
+  std::vector<WebSocketEventInterface::DataFrame> frames;
+  frames.swap(pending_data_frames_);
+  return event_interface_->OnDataFrames(&frames);
 }
 
 ChannelState WebSocketChannel::SendFrameFromIOBuffer(
@@ -1033,6 +1057,10 @@ ChannelState WebSocketChannel::FailChannel(const std::string& message,
   DCHECK_NE(CONNECTING, state_);
   DCHECK_NE(CLOSED, state_);
 
+  // Deliver any batched data frames before the failure events.
+  if (FlushPendingDataFrames() == CHANNEL_DELETED)
+    return CHANNEL_DELETED;
+
   // TODO(ricea): Logging.
   if (state_ == CONNECTED) {
     if (SendClose(code, reason) == CHANNEL_DELETED)
@@ -273,6 +273,12 @@ class NET_EXPORT WebSocketChannel {
                                const scoped_refptr<IOBuffer>& data_buffer,
                                uint64_t size) WARN_UNUSED_RESULT;
 
+  // Forwards the contents of |pending_data_frames_| to the renderer in a
+  // single OnDataFrames() event and empties it. Does nothing if it is already
+  // empty. Called at the end of the frame-handling loop and before any other
+  // event is sent, so that batching never reorders events.
+  ChannelState FlushPendingDataFrames() WARN_UNUSED_RESULT;
+
   // Low-level method to send a single frame. Used for both data and control
   // frames. Either sends the frame immediately or buffers it to be scheduled
   // when the current write finishes. |fin| and |op_code| are defined as for
@@ -356,6 +362,11 @@ class NET_EXPORT WebSocketChannel {
   // lack of quota.
   std::queue<PendingReceivedFrame> pending_received_frames_;
 
+  // Data frames accepted within the current frame-handling loop, delivered to
+  // the renderer in one batched OnDataFrames() event by
+  // FlushPendingDataFrames(). Always empty outside that loop.
+  std::vector<WebSocketEventInterface::DataFrame> pending_data_frames_;
+
   // Handle to an in-progress WebSocketStream creation request. Only non-NULL
   // during the connection process.
   scoped_ptr<WebSocketStreamRequest> stream_request_;
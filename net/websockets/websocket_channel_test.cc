@@ -1381,6 +1381,52 @@ TEST_F(WebSocketChannelEventInterfaceTest, DataLeftFromHandshake) {
   CreateChannelAndConnectSuccessfully();
 }
 
+// An event interface that records the sizes of the batches passed to
+// OnDataFrames(), for verifying that frames read together are delivered
+// together.
+class BatchRecordingEventInterface : public FakeWebSocketEventInterface {
+ public:
+  explicit BatchRecordingEventInterface(std::vector<size_t>* batch_sizes)
+      : batch_sizes_(batch_sizes) {}
+
+  ChannelState OnDataFrames(std::vector<DataFrame>* frames) override {
+    batch_sizes_->push_back(frames->size());
+    return CHANNEL_ALIVE;
+  }
+
+ private:
+  std::vector<size_t>* const batch_sizes_;
+};
+
+class WebSocketChannelBatchTest : public WebSocketChannelTest {
+ protected:
+  scoped_ptr<WebSocketEventInterface> CreateEventInterface() override {
+    return scoped_ptr<WebSocketEventInterface>(
+        new BatchRecordingEventInterface(&batch_sizes_));
+  }
+
+  std::vector<size_t> batch_sizes_;
+};
+
+// Data frames that arrive in one read should be delivered to the event
+// interface in one OnDataFrames() event.
+TEST_F(WebSocketChannelBatchTest, FramesReadTogetherAreDeliveredTogether) {
+  scoped_ptr<ReadableFakeWebSocketStream> stream(
+      new ReadableFakeWebSocketStream);
+  static const InitFrame frames[] = {
+      {NOT_FINAL_FRAME, WebSocketFrameHeader::kOpCodeText, NOT_MASKED, "HEL"},
+      {NOT_FINAL_FRAME, WebSocketFrameHeader::kOpCodeContinuation,
+       NOT_MASKED, "LO"},
+      {FINAL_FRAME, WebSocketFrameHeader::kOpCodeContinuation,
+       NOT_MASKED, "!"}};
+  stream->PrepareReadFrames(ReadableFakeWebSocketStream::SYNC, OK, frames);
+  set_stream(stream.Pass());
+
+  CreateChannelAndConnectSuccessfully();
+  ASSERT_EQ(1U, batch_sizes_.size());
+  EXPECT_EQ(3U, batch_sizes_[0]);
+}
+
 // A remote server could accept the handshake, but then immediately send a
 // Close frame.
 TEST_F(WebSocketChannelEventInterfaceTest, CloseAfterHandshake) {
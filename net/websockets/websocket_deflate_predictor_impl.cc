@@ -4,20 +4,131 @@
 
 #include "net/websockets/websocket_deflate_predictor_impl.h"
 
+#include "net/websockets/websocket_frame.h"
+
 namespace net {
 
+namespace {
+
+// Messages smaller than this never shrink: a compressed message carries a
+// few bytes of deflate block framing even for incompressible input.
+const uint64_t kMinimumMessageSize = 16;
+
+// Compression history is only consulted once at least this many payload
+// bytes of compressed messages have been sampled.
+const uint64_t kMinimumSampleBytes = 4 * 1024;
+
+// When the sampled input size exceeds this, both counters are halved so the
+// estimate follows changes in the traffic.
+const uint64_t kSampleWindowBytes = 128 * 1024;
+
+// After skipping compression for this many messages in a row, compress one
+// message to refresh the sample.
+const size_t kMaxConsecutiveSkippedMessages = 16;
+
+}  // namespace
+
 typedef WebSocketDeflatePredictor::Result Result;
 
+WebSocketDeflatePredictorImpl::WebSocketDeflatePredictorImpl(
+    WebSocketDeflater::ContextTakeOverMode mode)
+    : mode_(mode),
+      sampled_input_bytes_(0),
+      sampled_written_bytes_(0),
+      current_input_message_size_(0),
+      last_input_message_size_(0),
+      current_written_message_size_(0),
+      is_recording_written_message_(false),
+      current_written_message_compressed_(false),
+      consecutive_skipped_messages_(0) {}
+
 Result WebSocketDeflatePredictorImpl::Predict(
     const std::vector<scoped_ptr<WebSocketFrame>>& frames,
     size_t frame_index) {
+  const WebSocketFrameHeader& header = frames[frame_index]->header;
+  if (header.final && header.payload_length < kMinimumMessageSize)
+    return DO_NOT_DEFLATE;
+
+  // When the context is reset between messages, the deflater output for one
+  // message does not affect the next, so the stream can compress the message
+  // speculatively and send whichever of the original and compressed forms is
+  // smaller. This is exact and needs no guessing, but requires the whole
+  // message to be visible.
+  if (mode_ == WebSocketDeflater::DO_NOT_TAKE_OVER_CONTEXT &&
+      IsMessageComplete(frames, frame_index)) {
+    return TRY_DEFLATE;
+  }
+
+  // Binary payloads are often compressed already (images, media, encrypted
+  // blobs). If compression has not been paying for itself recently, stop
+  // deflating binary messages, but retry periodically in case the traffic
+  // changes.
+  if (header.opcode == WebSocketFrameHeader::kOpCodeBinary &&
+      HasPoorCompressionHistory()) {
+    if (consecutive_skipped_messages_ < kMaxConsecutiveSkippedMessages) {
+      ++consecutive_skipped_messages_;
+      return DO_NOT_DEFLATE;
+    }
+    consecutive_skipped_messages_ = 0;
+  }
   return DEFLATE;
 }
 
 void WebSocketDeflatePredictorImpl::RecordInputDataFrame(
-    const WebSocketFrame* frame) {}
+    const WebSocketFrame* frame) {
+  current_input_message_size_ += frame->header.payload_length;
+  if (frame->header.final) {
+    last_input_message_size_ = current_input_message_size_;
+    current_input_message_size_ = 0;
+  }
+}
 
 void WebSocketDeflatePredictorImpl::RecordWrittenDataFrame(
-    const WebSocketFrame* frame) {}
+    const WebSocketFrame* frame) {
+  if (!is_recording_written_message_) {
+    is_recording_written_message_ = true;
+    current_written_message_compressed_ = frame->header.reserved1;
+    current_written_message_size_ = 0;
+  }
+  current_written_message_size_ += frame->header.payload_length;
+  if (frame->header.final) {
+    is_recording_written_message_ = false;
+    // Only compressed messages say anything about compressibility; the input
+    // size of the message was recorded before its written frames.
+    if (current_written_message_compressed_) {
+      AddCompressedSample(last_input_message_size_,
+                          current_written_message_size_);
+    }
+  }
+}
+
+bool WebSocketDeflatePredictorImpl::IsMessageComplete(
+    const std::vector<scoped_ptr<WebSocketFrame>>& frames,
+    size_t frame_index) {
+  for (size_t i = frame_index; i < frames.size(); ++i) {
+    const WebSocketFrameHeader& header = frames[i]->header;
+    if (!WebSocketFrameHeader::IsKnownDataOpCode(header.opcode))
+      continue;
+    if (header.final)
+      return true;
+  }
+  return false;
+}
+
+bool WebSocketDeflatePredictorImpl::HasPoorCompressionHistory() const {
+  // "Poor" means less than 10% of the sampled payload bytes were saved.
+  return sampled_input_bytes_ >= kMinimumSampleBytes &&
+         sampled_written_bytes_ * 10 >= sampled_input_bytes_ * 9;
+}
+
+void WebSocketDeflatePredictorImpl::AddCompressedSample(uint64_t input_size,
+                                                        uint64_t written_size) {
+  sampled_input_bytes_ += input_size;
+  sampled_written_bytes_ += written_size;
+  if (sampled_input_bytes_ > kSampleWindowBytes) {
+    sampled_input_bytes_ /= 2;
+    sampled_written_bytes_ /= 2;
+  }
+}
 
 }  // namespace net
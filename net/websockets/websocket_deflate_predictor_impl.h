@@ -6,25 +6,72 @@
 #define NET_WEBSOCKETS_WEBSOCKET_DEFLATE_PREDICTOR_IMPL_H_
 
 #include <stddef.h>
+#include <stdint.h>
 #include <vector>
 
 #include "base/memory/scoped_ptr.h"
 #include "net/base/net_export.h"
 #include "net/websockets/websocket_deflate_predictor.h"
+#include "net/websockets/websocket_deflater.h"
 
 namespace net {
 
 struct WebSocketFrame;
 
+// Predictor that skips compression for messages that are unlikely to shrink.
+// When the context is reset between messages (no-context-takeover mode) it
+// asks the stream to compress speculatively and keep the smaller of the two
+// forms; otherwise it estimates compressibility from the recent ratio of
+// input to written payload sizes.
 class NET_EXPORT_PRIVATE WebSocketDeflatePredictorImpl
     : public WebSocketDeflatePredictor {
  public:
+  explicit WebSocketDeflatePredictorImpl(
+      WebSocketDeflater::ContextTakeOverMode mode);
   ~WebSocketDeflatePredictorImpl() override {}
 
   Result Predict(const std::vector<scoped_ptr<WebSocketFrame>>& frames,
                  size_t frame_index) override;
   void RecordInputDataFrame(const WebSocketFrame* frame) override;
   void RecordWrittenDataFrame(const WebSocketFrame* frame) override;
+
+ private:
+  // Returns true when the data message starting at |frames[frame_index]|
+  // ends within |frames|. Control frames may be interleaved with the
+  // message.
+  static bool IsMessageComplete(
+      const std::vector<scoped_ptr<WebSocketFrame>>& frames,
+      size_t frame_index);
+
+  // Returns true when the recorded samples show that compression has not
+  // been shrinking messages meaningfully.
+  bool HasPoorCompressionHistory() const;
+
+  // Records the original and written payload sizes of a compressed message.
+  void AddCompressedSample(uint64_t input_size, uint64_t written_size);
+
+  const WebSocketDeflater::ContextTakeOverMode mode_;
+
+  // Recent input and written payload sizes of compressed messages. Periodic
+  // halving of both keeps the ratio tracking changes in the traffic.
+  uint64_t sampled_input_bytes_;
+  uint64_t sampled_written_bytes_;
+
+  // Payload size of the data message currently being recorded as input, and
+  // the completed size of the most recently finished one.
+  uint64_t current_input_message_size_;
+  uint64_t last_input_message_size_;
+
+  // Accumulated payload size of the data message currently being recorded as
+  // written, and whether its first frame had the compressed bit set.
+  uint64_t current_written_message_size_;
+  bool is_recording_written_message_;
+  bool current_written_message_compressed_;
+
+  // Number of messages in a row sent uncompressed because of a poor
+  // compression history; used to retry compression periodically in case the
+  // traffic changes.
+  size_t consecutive_skipped_messages_;
 };
 
 }  // namespace net
@@ -15,16 +15,115 @@ namespace {
 
 typedef WebSocketDeflatePredictor::Result Result;
 
+scoped_ptr<WebSocketFrame> MakeFrame(WebSocketFrameHeader::OpCode opcode,
+                                     bool final,
+                                     uint64_t payload_length) {
+  scoped_ptr<WebSocketFrame> frame(new WebSocketFrame(opcode));
+  frame->header.final = final;
+  frame->header.payload_length = payload_length;
+  return frame.Pass();
+}
+
 TEST(WebSocketDeflatePredictorImpl, Predict) {
-  WebSocketDeflatePredictorImpl predictor;
+  WebSocketDeflatePredictorImpl predictor(WebSocketDeflater::TAKE_OVER_CONTEXT);
   std::vector<scoped_ptr<WebSocketFrame>> frames;
   frames.push_back(
-      make_scoped_ptr(new WebSocketFrame(WebSocketFrameHeader::kOpCodeText)));
+      MakeFrame(WebSocketFrameHeader::kOpCodeText, true, 1024));
   Result result = predictor.Predict(frames, 0);
 
   EXPECT_EQ(WebSocketDeflatePredictor::DEFLATE, result);
 }
 
+TEST(WebSocketDeflatePredictorImpl, DoNotDeflateTinyMessage) {
+  WebSocketDeflatePredictorImpl predictor(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  std::vector<scoped_ptr<WebSocketFrame>> frames;
+  frames.push_back(MakeFrame(WebSocketFrameHeader::kOpCodeText, true, 2));
+
+  EXPECT_EQ(WebSocketDeflatePredictor::DO_NOT_DEFLATE,
+            predictor.Predict(frames, 0));
+}
+
+TEST(WebSocketDeflatePredictorImpl, TryDeflateWithoutContextTakeOver) {
+  WebSocketDeflatePredictorImpl predictor(
+      WebSocketDeflater::DO_NOT_TAKE_OVER_CONTEXT);
+  std::vector<scoped_ptr<WebSocketFrame>> frames;
+  frames.push_back(
+      MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024));
+
+  EXPECT_EQ(WebSocketDeflatePredictor::TRY_DEFLATE,
+            predictor.Predict(frames, 0));
+}
+
+// TRY_DEFLATE requires the entire message to be visible; an unfinished
+// message must be deflated unconditionally.
+TEST(WebSocketDeflatePredictorImpl, DeflateIncompleteMessage) {
+  WebSocketDeflatePredictorImpl predictor(
+      WebSocketDeflater::DO_NOT_TAKE_OVER_CONTEXT);
+  std::vector<scoped_ptr<WebSocketFrame>> frames;
+  frames.push_back(
+      MakeFrame(WebSocketFrameHeader::kOpCodeText, false, 1024));
+
+  EXPECT_EQ(WebSocketDeflatePredictor::DEFLATE, predictor.Predict(frames, 0));
+}
+
+TEST(WebSocketDeflatePredictorImpl, SkipIncompressibleBinaryMessages) {
+  WebSocketDeflatePredictorImpl predictor(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  // Record a run of compressed messages whose written size equals their
+  // input size, i.e. compression achieved nothing.
+  for (int i = 0; i < 8; ++i) {
+    scoped_ptr<WebSocketFrame> input =
+        MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024);
+    predictor.RecordInputDataFrame(input.get());
+    scoped_ptr<WebSocketFrame> written =
+        MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024);
+    written->header.reserved1 = true;
+    predictor.RecordWrittenDataFrame(written.get());
+  }
+
+  std::vector<scoped_ptr<WebSocketFrame>> frames;
+  frames.push_back(
+      MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024));
+  EXPECT_EQ(WebSocketDeflatePredictor::DO_NOT_DEFLATE,
+            predictor.Predict(frames, 0));
+
+  // Text messages are still compressed.
+  std::vector<scoped_ptr<WebSocketFrame>> text_frames;
+  text_frames.push_back(
+      MakeFrame(WebSocketFrameHeader::kOpCodeText, true, 1024));
+  EXPECT_EQ(WebSocketDeflatePredictor::DEFLATE,
+            predictor.Predict(text_frames, 0));
+}
+
+// After skipping many binary messages in a row the predictor compresses one
+// message again to refresh its sample of the traffic.
+TEST(WebSocketDeflatePredictorImpl, RetryCompressionPeriodically) {
+  WebSocketDeflatePredictorImpl predictor(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  for (int i = 0; i < 8; ++i) {
+    scoped_ptr<WebSocketFrame> input =
+        MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024);
+    predictor.RecordInputDataFrame(input.get());
+    scoped_ptr<WebSocketFrame> written =
+        MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024);
+    written->header.reserved1 = true;
+    predictor.RecordWrittenDataFrame(written.get());
+  }
+
+  std::vector<scoped_ptr<WebSocketFrame>> frames;
+  frames.push_back(
+      MakeFrame(WebSocketFrameHeader::kOpCodeBinary, true, 1024));
+  int skipped = 0;
+  Result result = WebSocketDeflatePredictor::DO_NOT_DEFLATE;
+  do {
+    result = predictor.Predict(frames, 0);
+    if (result == WebSocketDeflatePredictor::DO_NOT_DEFLATE)
+      ++skipped;
+  } while (result == WebSocketDeflatePredictor::DO_NOT_DEFLATE &&
+           skipped < 1000);
+
+  EXPECT_EQ(WebSocketDeflatePredictor::DEFLATE, result);
+  EXPECT_EQ(16, skipped);
+}
+
 }  // namespace
 
 }  // namespace net
@@ -9,40 +9,125 @@
 #include <deque>
 #include <vector>
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/threading/thread_local.h"
 #include "net/base/io_buffer.h"
 #include "third_party/zlib/zlib.h"
 
 namespace net {
 
+namespace {
+
+// Maximum number of idle deflate contexts kept per thread.
+const size_t kMaxPooledStreams = 2;
+
+class DeflateStreamPool;
+
+base::LazyInstance<base::ThreadLocalPointer<DeflateStreamPool> >::Leaky
+    g_deflate_stream_pool_tls = LAZY_INSTANCE_INITIALIZER;
+
+// A per-thread pool of initialized deflate contexts, mirroring the inflate
+// context pool in net/filter/gzip_filter.cc.  deflateInit2 with the default
+// memory level allocates roughly 256KB of state per stream.  In
+// no-context-takeover mode the context carries no state from one message to
+// the next, so between messages a connection can hand its context back to
+// the pool instead of keeping that state alive while idle.  WebSocket
+// streams live on the IO thread, so no locking is needed.
+class DeflateStreamPool {
+ public:
+  // Returns the pool for the calling thread, creating it on first use.  The
+  // pool is intentionally never freed.
+  static DeflateStreamPool* GetForCurrentThread() {
+    DeflateStreamPool* pool = g_deflate_stream_pool_tls.Get().Get();
+    if (!pool) {
+      pool = new DeflateStreamPool();
+      g_deflate_stream_pool_tls.Get().Set(pool);
+    }
+    return pool;
+  }
+
+  // Returns a z_stream ready to produce raw deflate data with |window_bits|,
+  // recycled from the pool when possible.  Returns NULL on failure.
+  z_stream* Acquire(int window_bits) {
+    // deflateReset() cannot change the window size, so only recycle contexts
+    // that were initialized with the same |window_bits|.
+    for (size_t i = 0; i < streams_.size();) {
+      if (streams_[i].window_bits != window_bits) {
+        ++i;
+        continue;
+      }
+      z_stream* stream = streams_[i].stream;
+      streams_.erase(streams_.begin() + i);
+      if (deflateReset(stream) == Z_OK)
+        return stream;
+      // The recycled context was unusable; dispose of it and keep looking.
+      deflateEnd(stream);
+      delete stream;
+    }
+    scoped_ptr<z_stream> stream(new z_stream);
+    memset(stream.get(), 0, sizeof(z_stream));
+    int result = deflateInit2(stream.get(),
+                              Z_DEFAULT_COMPRESSION,
+                              Z_DEFLATED,
+                              -window_bits,  // Negative value for raw deflate
+                              8,  // default mem level
+                              Z_DEFAULT_STRATEGY);
+    if (result != Z_OK) {
+      deflateEnd(stream.get());
+      return NULL;
+    }
+    return stream.release();
+  }
+
+  // Takes ownership of the initialized |stream|, keeping it for reuse or
+  // freeing it if the pool is full.
+  void Release(z_stream* stream, int window_bits) {
+    DCHECK(stream);
+    if (streams_.size() < kMaxPooledStreams) {
+      PooledStream entry = {window_bits, stream};
+      streams_.push_back(entry);
+      return;
+    }
+    deflateEnd(stream);
+    delete stream;
+  }
+
+ private:
+  struct PooledStream {
+    int window_bits;
+    z_stream* stream;
+  };
+
+  DeflateStreamPool() {}
+  ~DeflateStreamPool() {}
+
+  std::vector<PooledStream> streams_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeflateStreamPool);
+};
+
+}  // namespace
+
 WebSocketDeflater::WebSocketDeflater(ContextTakeOverMode mode)
-    : mode_(mode), are_bytes_added_(false) {}
+    : mode_(mode), window_bits_(0), are_bytes_added_(false) {}
 
 WebSocketDeflater::~WebSocketDeflater() {
   if (stream_) {
-    deflateEnd(stream_.get());
-    stream_.reset(NULL);
+    DeflateStreamPool::GetForCurrentThread()->Release(stream_.release(),
+                                                      window_bits_);
   }
 }
 
 bool WebSocketDeflater::Initialize(int window_bits) {
   DCHECK(!stream_);
-  stream_.reset(new z_stream);
-
   DCHECK_LE(8, window_bits);
   DCHECK_GE(15, window_bits);
-  memset(stream_.get(), 0, sizeof(*stream_));
-  int result = deflateInit2(stream_.get(),
-                            Z_DEFAULT_COMPRESSION,
-                            Z_DEFLATED,
-                            -window_bits,  // Negative value for raw deflate
-                            8,  // default mem level
-                            Z_DEFAULT_STRATEGY);
-  if (result != Z_OK) {
-    deflateEnd(stream_.get());
-    stream_.reset();
+  window_bits_ = window_bits;
+  stream_.reset(
+      DeflateStreamPool::GetForCurrentThread()->Acquire(window_bits_));
+  if (!stream_)
     return false;
-  }
   const size_t kFixedBufferSize = 4096;
   fixed_buffer_.resize(kFixedBufferSize);
   return true;
@@ -51,6 +136,8 @@ bool WebSocketDeflater::Initialize(int window_bits) {
 bool WebSocketDeflater::AddBytes(const char* data, size_t size) {
   if (!size)
     return true;
+  if (!EnsureStream())
+    return false;
 
   are_bytes_added_ = true;
   stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
@@ -108,11 +195,25 @@ scoped_refptr<IOBufferWithSize> WebSocketDeflater::GetOutput(size_t size) {
 }
 
 void WebSocketDeflater::ResetContext() {
-  if (mode_ == DO_NOT_TAKE_OVER_CONTEXT)
-    deflateReset(stream_.get());
+  if (mode_ == DO_NOT_TAKE_OVER_CONTEXT && stream_) {
+    // The context carries no state into the next message; keep it in the
+    // per-thread pool rather than tying the deflate state to a possibly idle
+    // connection.  EnsureStream() gets one back when the next message
+    // starts.
+    DeflateStreamPool::GetForCurrentThread()->Release(stream_.release(),
+                                                      window_bits_);
+  }
   are_bytes_added_ = false;
 }
 
+bool WebSocketDeflater::EnsureStream() {
+  if (stream_)
+    return true;
+  stream_.reset(
+      DeflateStreamPool::GetForCurrentThread()->Acquire(window_bits_));
+  return stream_.get() != NULL;
+}
+
 int WebSocketDeflater::Deflate(int flush) {
   int result = Z_OK;
   do {
@@ -62,10 +62,16 @@ class NET_EXPORT_PRIVATE WebSocketDeflater {
 
  private:
   void ResetContext();
+  // Reacquires a deflate context if ResetContext() gave the previous one
+  // back to the per-thread pool. Returns false on failure.
+  bool EnsureStream();
   int Deflate(int flush);
 
   scoped_ptr<z_stream_s> stream_;
   ContextTakeOverMode mode_;
+  // The window size this deflater was initialized with; needed to reacquire
+  // a matching context from the pool.
+  int window_bits_;
   std::deque<char> buffer_;
   std::vector<char> fixed_buffer_;
   // true if bytes were added after last Finish().
@@ -0,0 +1,25 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_event_interface.h"
+
+namespace net {
+
+WebSocketEventInterface::DataFrame::DataFrame(bool fin,
+                                              WebSocketMessageType type)
+    : fin(fin), type(type) {}
+
+WebSocketEventInterface::DataFrame::~DataFrame() {}
+
+WebSocketEventInterface::ChannelState WebSocketEventInterface::OnDataFrames(
+    std::vector<DataFrame>* frames) {
+  for (size_t i = 0; i < frames->size(); ++i) {
+    const DataFrame& frame = (*frames)[i];
+    if (OnDataFrame(frame.fin, frame.type, frame.data) == CHANNEL_DELETED)
+      return CHANNEL_DELETED;
+  }
+  return CHANNEL_ALIVE;
+}
+
+}  // namespace net
@@ -43,6 +43,16 @@ class NET_EXPORT WebSocketEventInterface {
       const std::string& selected_subprotocol,
       const std::string& extensions) WARN_UNUSED_RESULT = 0;
 
+  // A received data frame ready for delivery to the renderer process.
+  struct NET_EXPORT DataFrame {
+    DataFrame(bool fin, WebSocketMessageType type);
+    ~DataFrame();
+
+    bool fin;
+    WebSocketMessageType type;
+    std::vector<char> data;
+  };
+
   // Called when a data frame has been received from the remote host and needs
   // to be forwarded to the renderer process.
   virtual ChannelState OnDataFrame(
@@ -50,6 +60,15 @@ class NET_EXPORT WebSocketEventInterface {
       WebSocketMessageType type,
       const std::vector<char>& data) WARN_UNUSED_RESULT = 0;
 
+  // Called when one or more data frames have been received in a single read
+  // from the network, so that per-event costs can be amortized over the whole
+  // batch. |frames| is non-empty and may be modified. The default
+  // implementation forwards the frames one at a time through OnDataFrame();
+  // implementations that can deliver a whole batch in one IPC should
+  // override it.
+  virtual ChannelState OnDataFrames(std::vector<DataFrame>* frames)
+      WARN_UNUSED_RESULT;
+
   // Called to provide more send quota for this channel to the renderer
   // process. Currently the quota units are always bytes of message body
   // data. In future it might depend on the type of multiplexing in use.
@@ -8,7 +8,7 @@
 #include <vector>
 
 #include "base/macros.h"
-#include "base/test/perf_time_logger.h"
+#include "net/test/benchmark_reporter.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -33,7 +33,7 @@ class WebSocketFrameTestMaskBenchmark : public ::testing::Test {
     std::copy(kMaskingKey,
               kMaskingKey + WebSocketFrameHeader::kMaskingKeyLength,
               masking_key.key);
-    base::PerfTimeLogger timer(name);
+    net::test::BenchmarkReporter timer(name);
     for (int x = 0; x < kIterations; ++x) {
       MaskWebSocketFramePayload(
           masking_key, x % size, &scratch.front(), scratch.size());
@@ -267,8 +267,8 @@ TEST(WebSocketFrameTest, MaskPayload) {
 // MaskWebSocketFramePayload() is ever optimised for a dedicated vector
 // architecture.
 TEST(WebSocketFrameTest, MaskPayloadAlignment) {
-  // This reflects what might be implemented in the future, rather than
-  // the current implementation. FMA3 and FMA4 support 256-bit vector ops.
+  // This matches the AVX2 kernel, which masks with 256-bit vector ops on
+  // CPUs that support them.
   static const size_t kMaxVectorSizeInBits = 256;
   static const size_t kMaxVectorSize = kMaxVectorSizeInBits / 8;
   static const size_t kMaxVectorAlignment = kMaxVectorSize;